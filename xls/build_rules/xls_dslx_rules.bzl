@@ -108,6 +108,8 @@ def _get_dslx_test_cmdline(ctx, src, all_srcs, append_cmd_line_args = True):
         "enable_warnings",
         "max_ticks",
         "format_preference",
+        "jobs",
+        "tiered_tick_threshold",
     )
 
     dslx_test_args = dict(_dslx_test_args)
@@ -303,10 +305,13 @@ xls_dslx_test_common_attrs = {
     ),
     "evaluator": attr.string(
         default = "dslx-interpreter",
-        values = ["dslx-interpreter", "ir-jit", "ir-interpreter"],
+        values = ["dslx-interpreter", "ir-jit", "ir-interpreter", "tiered"],
         doc = "What type of evaluator to use. 'ir-jit' will execute the tests faster " +
-              "but has higher startup time and less helpful failure messages. Options: " +
-              '["dslx-interpreter" (default), "ir-jit", "ir-interpreter"]. Note: The ' +
+              "but has higher startup time and less helpful failure messages. 'tiered' " +
+              "uses the DSLX interpreter but moves test procs that run for long to the " +
+              "IR JIT. Options: " +
+              '["dslx-interpreter" (default), "ir-jit", "ir-interpreter", "tiered"]. ' +
+              "Note: The " +
               "'compare' dslx_test_arg is only available with the default 'dslx-interpreter' " +
               "evaluator.",
     ),
@@ -734,6 +739,8 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
 
     if ctx.attr.namespace:
         my_args.add("--namespaces={}".format(ctx.attr.namespace))
+    if ctx.attr.native_layout:
+        my_args.add("--native_layout")
 
     ctx.actions.run(
         outputs = [cc_file, h_file],
@@ -759,6 +766,10 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
 
 xls_dslx_generate_cpp_type_files_attrs = {
     "namespace": attr.string(doc = "The C++ namespace to generate the code in (e.g., `foo::bar`)."),
+    "native_layout": attr.bool(
+        doc = "Also generate conversions to and from the JIT native layout.",
+        default = False,
+    ),
     "source_file": attr.output(
         doc = "The filename of the generated source file. The filename must " +
               "have a '" + _CC_FILE_EXTENSION + "' extension.",
@@ -140,6 +140,7 @@ def _convert_to_ir(ctx, src):
         "disable_warnings",
         "convert_tests",
         "default_fifo_config",
+        "ir_cache_dir",
     )
 
     # With runs outside a monorepo, the execution root for the workspace of
@@ -369,6 +370,9 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
         "use_llvm_jit",
         "test_llvm_jit",
         "llvm_opt_level",
+        "threads",
+        "streaming",
+        "value_file_format",
         "test_only_inject_jit_result",
         "dslx_path",
     )
@@ -381,7 +381,8 @@ def xls_dslx_cpp_type_library(
         name,
         src,
         deps = [],
-        namespace = None):
+        namespace = None,
+        native_layout = False):
     """Creates a cc_library target for transpiled DSLX types.
 
     This macros invokes the DSLX-to-C++ transpiler and compiles the result as
@@ -390,7 +391,11 @@ def xls_dslx_cpp_type_library(
     Args:
       name: The name of the eventual cc_library.
       src: The DSLX file whose types to compile as C++.
+      deps: DSLX libraries imported by `src`.
       namespace: The C++ namespace to generate the code in (e.g., `foo::bar`).
+      native_layout: Whether to also generate conversions to and from the JIT
+        native layout, which let values be passed to the JIT without building
+        an xls::Value.
     """
     xls_dslx_generate_cpp_type_files(
         name = name + "_generate_sources",
@@ -399,6 +404,7 @@ def xls_dslx_cpp_type_library(
         header_file = name + ".h",
         deps = deps,
         namespace = namespace,
+        native_layout = native_layout,
     )
 
     native.cc_library(
@@ -413,7 +419,7 @@ def xls_dslx_cpp_type_library(
             "@com_google_absl//absl/types:span",
             "//xls/public:status_macros",
             "//xls/public:value",
-        ],
+        ] + (["//xls/jit:type_layout"] if native_layout else []),
         data = [
             ":" + name + "_generate_sources",
         ],
@@ -120,6 +120,16 @@ CODEGEN_FIELDS = {
     "register_merge_strategy": "The strategy to use for merging registers. Either " +
                                "'IdentityOnly' or 'None'",
     "emit_sv_types": "Whether or not to honor the #[sv_type(NAME)] annotations in the source DSLX.",
+    "block_generation_threads": "Number of threads used to generate the " +
+                                "Verilog modules of independent blocks.",
+    "retime_pipeline_registers": "Whether to retime pipeline registers to " +
+                                 "balance the delay of the pipeline stages.",
+    "verilog_cache_dir": "Directory in which the Verilog module generated " +
+                         "for each block is cached across invocations.",
+    "rom_init_dir": "Directory into which large literal arrays are written " +
+                    "as $readmemh initialization files.",
+    "rom_init_threshold": "Minimum number of elements of the literal arrays " +
+                          "written to initialization files.",
 }
 
 SCHEDULING_FIELDS = {
@@ -128,6 +138,8 @@ SCHEDULING_FIELDS = {
                        "scheduling.",
     "pipeline_stages": "Optional(string): The number of pipeline stages.",
     "delay_model": "Optional(string) Delay model used in codegen.",
+    "delay_cache_path": "Optional(string) File in which delay estimates are " +
+                        "cached across runs.",
     "clock_margin_percent": "The percentage of clock period to set aside as " +
                             "a margin to ensure timing is met.",
     "period_relaxation_percent": "The percentage of clock period that will " +
@@ -185,7 +197,18 @@ SCHEDULING_FIELDS = {
     "fdo_synthesis_libraries": "Synthesis and STA libraries.",
     "fdo_default_driver_cell": "Cell to assume is driving primary inputs.",
     "fdo_default_load": "Cell to assume is being driven by primary outputs.",
+    "fdo_max_concurrent_syntheses": "Maximum number of concurrent syntheses; " +
+                                    "0 means one per CPU.",
+    "fdo_synthesis_cache_dir": "Directory in which synthesized delays are " +
+                               "cached across runs.",
     "multi_proc": "If true, schedule all procs and codegen them all.",
+    "prune_critical_path_distances": "If true, only compute the critical-path " +
+                                     "distances which can violate the clock " +
+                                     "period.",
+    "schedule_bounds_threads": "Number of threads used to propagate the " +
+                               "ASAP/ALAP scheduling bounds.",
+    "schedule_partitions": "Number of regions scheduled independently with " +
+                           "the min-cut algorithm.",
     "simulation_macro_name": "Name of the Verilog macro used to guard simulation-only " +
                              "constructs. If prefixed with `!` the polarity of the guard " +
                              "is inverted.",
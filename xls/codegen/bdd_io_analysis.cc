@@ -18,15 +18,21 @@
 #include <cstdint>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
 
@@ -48,9 +54,44 @@ bool UseNodeInBddEngine(const Node* node) {
          node->Is<CompareOp>();
 }
 
+// Returns the nodes of the fan-in cone of `roots` in topological order. The
+// cone stops at nodes the BDD engine does not evaluate, as their bits are
+// fresh BDD variables regardless of their operands.
+std::vector<Node*> GetBddFanInCone(Proc* proc, absl::Span<Node* const> roots) {
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> worklist;
+  for (Node* root : roots) {
+    if (cone.insert(root).second) {
+      worklist.push_back(root);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (!UseNodeInBddEngine(node)) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      if (cone.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+
+  std::vector<Node*> sorted_cone;
+  sorted_cone.reserve(cone.size());
+  for (Node* node : TopoSort(proc)) {
+    if (cone.contains(node)) {
+      sorted_cone.push_back(node);
+    }
+  }
+  return sorted_cone;
+}
+
 }  // namespace
 
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, int64_t cone_node_limit) {
   // Find all send nodes associated with streaming channels.
   int64_t streaming_send_count = 0;
   std::vector<Node*> send_predicates;
@@ -88,10 +129,22 @@ absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
   }
 
   // Use BDD query engine to determine predicates are such that
-  // if one is true, the rest are false.
+  // if one is true, the rest are false. Only the fan-in cone of the
+  // predicates matters, so the BDD is limited to it.
+  std::vector<Node*> cone = GetBddFanInCone(proc, send_predicates);
+  if (cone.size() > cone_node_limit) {
+    VLOG(3) << absl::StreamFormat(
+        "Fan-in cone of the send predicates of %s has %d nodes (limit %d); "
+        "using ternary analysis",
+        proc->name(), cone.size(), cone_node_limit);
+    LazyTernaryQueryEngine query_engine;
+    XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+    return query_engine.AtMostOneNodeTrue(send_predicates);
+  }
+
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
                               UseNodeInBddEngine);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+  XLS_RETURN_IF_ERROR(query_engine.PopulateWithNodes(proc, cone).status());
 
   return query_engine.AtMostOneNodeTrue(send_predicates);
 }
@@ -15,16 +15,28 @@
 #ifndef XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 #define XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function_base.h"
 
 namespace xls {
 
+// Default limit on the number of nodes in the fan-in cone of the queried I/O
+// signals for which BDDs are built.
+inline constexpr int64_t kDefaultBddIoConeNodeLimit = 4096;
+
 // Determines if streaming outputs are mutually exclusive.
 //
+// BDDs are only built for the fan-in cone of the send predicates, cut at nodes
+// too expensive to analyze with BDDs (e.g. arithmetic), so the datapath of a
+// proc is skipped. If that cone has more than `cone_node_limit` nodes, the
+// cheaper (and less precise) ternary analysis is used instead.
+//
 // TODO(tedhong): 2022-02-09 Add analysis of I/O dependencies
 // TODO(tedhong): 2022-02-09 Add additional exclusivity analysis
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc);
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, int64_t cone_node_limit = kDefaultBddIoConeNodeLimit);
 
 }  // namespace xls
 
@@ -14,6 +14,7 @@
 
 #include "xls/codegen/bdd_io_analysis.h"
 
+#include <cstdint>
 #include <memory>
 
 #include "gtest/gtest.h"
@@ -212,5 +213,58 @@ TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveSendIf) {
   EXPECT_EQ(mutually_exclusive, false);
 }
 
+TEST_F(BddIOAnalysisPassTest, MutuallyExclusiveSendIfBeyondConeLimit) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel,
+      package.CreateStreamingChannel("sel", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_val = pb.Receive(sel);
+
+  // A datapath outside the fan-in cone of the predicates.
+  BValue data = in_val;
+  for (int64_t i = 0; i < 16; ++i) {
+    data = pb.UMul(pb.Add(data, in_val), data);
+  }
+
+  BValue zero = pb.Literal(UBits(0, 32));
+  BValue one = pb.Literal(UBits(1, 32));
+
+  pb.SendIf(out0, pb.Eq(sel_val, zero), data);
+  pb.SendIf(out1, pb.Eq(sel_val, one), data);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  // The fan-in cone of the predicates (the comparisons, their literals and the
+  // received selector) is well within the limit, though the proc is not.
+  ASSERT_GT(proc->node_count(), 16);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(proc, /*cone_node_limit=*/16));
+  EXPECT_EQ(mutually_exclusive, true);
+
+  // Beyond the limit, ternary analysis cannot tell that the predicates are
+  // exclusive.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(proc, /*cone_node_limit=*/0));
+  EXPECT_EQ(mutually_exclusive, false);
+}
+
 }  // namespace
 }  // namespace xls
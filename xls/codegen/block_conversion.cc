@@ -112,20 +112,22 @@ std::optional<PackageInterfaceProto::Proc> FindProcInterface(
   }
   return std::nullopt;
 }
-std::optional<PackageInterfaceProto::Channel> FindChannelInterface(
-    const std::optional<PackageInterfaceProto>& src,
-    std::string_view chan_name) {
+// Returns the channel interfaces of `src` indexed by channel name. Channel
+// operations look up their interface by name so building the index once keeps
+// block conversion linear in the number of channels.
+absl::flat_hash_map<std::string_view, const PackageInterfaceProto::Channel*>
+IndexChannelInterfaces(const std::optional<PackageInterfaceProto>& src) {
+  absl::flat_hash_map<std::string_view, const PackageInterfaceProto::Channel*>
+      result;
   if (!src) {
-    return std::nullopt;
+    return result;
   }
-  auto it = absl::c_find_if(src->channels(),
-                            [&](const PackageInterfaceProto::Channel& f) {
-                              return f.name() == chan_name;
-                            });
-  if (it != src->channels().end()) {
-    return *it;
+  result.reserve(src->channels_size());
+  for (const PackageInterfaceProto::Channel& channel : src->channels()) {
+    // Keep the first interface for a name, as a linear search would.
+    result.try_emplace(channel.name(), &channel);
   }
-  return std::nullopt;
+  return result;
 }
 
 // If options specify it, adds and returns an input for a reset signal.
@@ -2167,22 +2169,33 @@ class CloneNodesIntoBlockHandler {
   //
   // If the block is to be a combinational block, stage_count should be
   // set to 0;
+  // `loopback_channel_ids` is the result of GetLoopbackChannelIds() for the
+  // package. It is computed by the caller so that converting a package with
+  // many procs scans the package only once.
   CloneNodesIntoBlockHandler(FunctionBase* proc_or_function,
                              int64_t stage_count, const CodegenOptions& options,
-                             Block* block)
+                             Block* block,
+                             absl::flat_hash_set<int64_t> loopback_channel_ids)
       : is_proc_(proc_or_function->IsProc()),
         function_base_(proc_or_function),
         options_(options),
         block_(block),
-        fifo_instantiations_({}) {
-    absl::StatusOr<absl::flat_hash_set<int64_t>>
-        loopback_channel_ids_or_status =
-            GetLoopbackChannelIds(proc_or_function->package());
-    CHECK_OK(loopback_channel_ids_or_status.status());
-    loopback_channel_ids_ = std::move(loopback_channel_ids_or_status.value());
+        loopback_channel_ids_(std::move(loopback_channel_ids)),
+        fifo_instantiations_({}),
+        channel_interfaces_(
+            IndexChannelInterfaces(options.package_interface())) {
     if (is_proc_) {
       Proc* proc = function_base_->AsProcOrDie();
       result_.state_registers.resize(proc->GetStateElementCount());
+      state_param_indices_.reserve(proc->GetStateElementCount());
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        state_param_indices_[proc->GetStateParam(i)] = i;
+      }
+    }
+    node_order_.reserve(function_base_->node_count());
+    int64_t position = 0;
+    for (Node* node : function_base_->nodes()) {
+      node_order_[node] = position++;
     }
     if (stage_count > 1) {
       result_.pipeline_registers.resize(stage_count - 1);
@@ -2268,9 +2281,27 @@ class CloneNodesIntoBlockHandler {
 
   // Add pipeline registers. A register is needed for each node which is
   // scheduled at or before this cycle and has a use after this cycle.
+  //
+  // Only nodes which were live out of the previous stage or are scheduled in
+  // this stage are considered: once a node is no longer live it never becomes
+  // live again. Registers are created in the order of the nodes in the
+  // function base, which keeps the output independent of this optimization.
   absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
                                     int64_t stage) {
-    for (Node* function_base_node : function_base_->nodes()) {
+    std::vector<Node*> stage_nodes(schedule.nodes_in_cycle(stage).begin(),
+                                   schedule.nodes_in_cycle(stage).end());
+    auto by_node_order = [&](Node* a, Node* b) {
+      return node_order_.at(a) < node_order_.at(b);
+    };
+    std::sort(stage_nodes.begin(), stage_nodes.end(), by_node_order);
+    std::vector<Node*> candidates;
+    candidates.reserve(live_nodes_.size() + stage_nodes.size());
+    std::merge(live_nodes_.begin(), live_nodes_.end(), stage_nodes.begin(),
+               stage_nodes.end(), std::back_inserter(candidates),
+               by_node_order);
+
+    live_nodes_.clear();
+    for (Node* function_base_node : candidates) {
       if (schedule.IsLiveOutOfCycle(function_base_node, stage)) {
         Node* node = node_map_.at(function_base_node);
 
@@ -2281,6 +2312,7 @@ class CloneNodesIntoBlockHandler {
                 result_.pipeline_registers.at(stage)));
 
         node_map_[function_base_node] = node_after_stage;
+        live_nodes_.push_back(function_base_node);
       }
     }
 
@@ -2339,7 +2371,7 @@ class CloneNodesIntoBlockHandler {
 
     Proc* proc = function_base_->AsProcOrDie();
     Param* param = node->As<Param>();
-    XLS_ASSIGN_OR_RETURN(int64_t index, proc->GetStateParamIndex(param));
+    XLS_ASSIGN_OR_RETURN(int64_t index, StateParamIndex(param));
 
     Register* reg = nullptr;
     RegisterRead* reg_read = nullptr;
@@ -2406,7 +2438,7 @@ class CloneNodesIntoBlockHandler {
     Proc* proc = function_base_->AsProcOrDie();
     Next* next = node->As<Next>();
     Param* param = next->param()->As<Param>();
-    XLS_ASSIGN_OR_RETURN(int64_t index, proc->GetStateParamIndex(param));
+    XLS_ASSIGN_OR_RETURN(int64_t index, StateParamIndex(param));
 
     CHECK_EQ(proc->GetNextStateElement(index), param);
     StateRegister& state_register = *result_.state_registers.at(index);
@@ -2507,9 +2539,9 @@ class CloneNodesIntoBlockHandler {
         block()->AddInputPort(absl::StrCat(channel->name(), data_suffix),
                               channel->type()));
 
-    if (std::optional<PackageInterfaceProto::Channel> c =
-            FindChannelInterface(options_.package_interface(), channel->name());
-        c && c->has_sv_type()) {
+    if (const PackageInterfaceProto::Channel* c =
+            FindChannelInterface(channel->name());
+        c != nullptr && c->has_sv_type()) {
       result_.input_port_sv_type[input_port] = c->sv_type();
     }
 
@@ -2645,9 +2677,9 @@ class CloneNodesIntoBlockHandler {
         block()->AddOutputPort(absl::StrCat(channel->name(), data_suffix),
                                node_map_.at(send->data())));
 
-    if (std::optional<PackageInterfaceProto::Channel> c =
-            FindChannelInterface(options_.package_interface(), channel->name());
-        c && c->has_sv_type()) {
+    if (const PackageInterfaceProto::Channel* c =
+            FindChannelInterface(channel->name());
+        c != nullptr && c->has_sv_type()) {
       result_.output_port_sv_type[output_port] = c->sv_type();
     }
     // Map the Send node to the token operand of the Send in the
@@ -2908,6 +2940,20 @@ class CloneNodesIntoBlockHandler {
 
   Block* block() const { return block_; };
 
+  absl::StatusOr<int64_t> StateParamIndex(Param* param) const {
+    auto it = state_param_indices_.find(param);
+    XLS_RET_CHECK(it != state_param_indices_.end())
+        << "Given param is not a state parameter of this proc: "
+        << param->ToString();
+    return it->second;
+  }
+
+  const PackageInterfaceProto::Channel* FindChannelInterface(
+      std::string_view channel_name) const {
+    auto it = channel_interfaces_.find(channel_name);
+    return it == channel_interfaces_.end() ? nullptr : it->second;
+  }
+
   bool is_proc_;
   FunctionBase* function_base_;
 
@@ -2919,6 +2965,14 @@ class CloneNodesIntoBlockHandler {
   absl::flat_hash_map<Node*, Node*> node_map_;
   absl::flat_hash_set<int64_t> loopback_channel_ids_;
   absl::flat_hash_map<int64_t, xls::Instantiation*> fifo_instantiations_;
+  absl::flat_hash_map<std::string_view, const PackageInterfaceProto::Channel*>
+      channel_interfaces_;
+  absl::flat_hash_map<Param*, int64_t> state_param_indices_;
+  // Position of each node in function_base_->nodes().
+  absl::flat_hash_map<Node*, int64_t> node_order_;
+  // Nodes which were live out of the most recently added pipeline stage, in
+  // node order.
+  std::vector<Node*> live_nodes_;
 };
 
 // Adds the nodes in the given schedule to the block. Pipeline registers are
@@ -2931,13 +2985,14 @@ class CloneNodesIntoBlockHandler {
 // IR.
 static absl::StatusOr<
     std::tuple<StreamingIOPipeline, std::optional<ConcurrentStageGroups>>>
-CloneNodesIntoPipelinedBlock(const PipelineSchedule& schedule,
-                             const CodegenOptions& options, Block* block) {
+CloneNodesIntoPipelinedBlock(
+    const PipelineSchedule& schedule, const CodegenOptions& options,
+    Block* block, absl::flat_hash_set<int64_t> loopback_channel_ids) {
   FunctionBase* function_base = schedule.function_base();
   XLS_RET_CHECK(function_base->IsProc() || function_base->IsFunction());
 
   CloneNodesIntoBlockHandler cloner(function_base, schedule.length(), options,
-                                    block);
+                                    block, std::move(loopback_channel_ids));
   for (int64_t stage = 0; stage < schedule.length(); ++stage) {
     XLS_RET_CHECK_OK(cloner.CloneNodes(schedule.nodes_in_cycle(stage), stage));
     XLS_RET_CHECK_OK(cloner.AddNextPipelineStage(schedule, stage));
@@ -2953,7 +3008,11 @@ CloneNodesIntoPipelinedBlock(const PipelineSchedule& schedule,
 // handled specially.  See CloneNodesIntoBlockHandler for details.
 static absl::StatusOr<StreamingIOPipeline> CloneProcNodesIntoBlock(
     Proc* proc, const CodegenOptions& options, Block* block) {
-  CloneNodesIntoBlockHandler cloner(proc, /*stage_count=*/0, options, block);
+  XLS_ASSIGN_OR_RETURN(
+      absl::flat_hash_set<int64_t> loopback_channel_ids,
+      CloneNodesIntoBlockHandler::GetLoopbackChannelIds(proc->package()));
+  CloneNodesIntoBlockHandler cloner(proc, /*stage_count=*/0, options, block,
+                                    std::move(loopback_channel_ids));
   XLS_RET_CHECK_OK(cloner.CloneNodes(TopoSort(proc), /*stage=*/0));
   return cloner.GetResult();
 }
@@ -2993,8 +3052,9 @@ absl::StatusOr<CodegenPassUnit> FunctionToPipelinedBlock(
                        MaybeAddInputOutputFlopsToSchedule(schedule, options));
 
   XLS_ASSIGN_OR_RETURN((auto [streaming_io_and_pipeline, concurrent_stages]),
-                       CloneNodesIntoPipelinedBlock(transformed_schedule,
-                                                    options, unit.top_block));
+                       CloneNodesIntoPipelinedBlock(
+                           transformed_schedule, options, unit.top_block,
+                           /*loopback_channel_ids=*/{}));
 
   XLS_RET_CHECK_OK(MaybeAddResetPort(unit.top_block, options));
 
@@ -3043,10 +3103,10 @@ absl::StatusOr<CodegenPassUnit> FunctionToPipelinedBlock(
   return unit;
 }
 
-absl::Status SingleProcToPipelinedBlock(const PipelineSchedule& schedule,
-                                        const CodegenOptions& options,
-                                        CodegenPassUnit& unit, Proc* proc,
-                                        absl::Nonnull<Block*> block) {
+absl::Status SingleProcToPipelinedBlock(
+    const PipelineSchedule& schedule, const CodegenOptions& options,
+    CodegenPassUnit& unit, Proc* proc, absl::Nonnull<Block*> block,
+    const absl::flat_hash_set<int64_t>& loopback_channel_ids) {
   XLS_RET_CHECK_EQ(schedule.function_base(), proc);
   if (std::optional<int64_t> ii = proc->GetInitiationInterval();
       ii.has_value()) {
@@ -3058,7 +3118,8 @@ absl::Status SingleProcToPipelinedBlock(const PipelineSchedule& schedule,
   XLS_VLOG_LINES(3, schedule.ToString());
 
   XLS_ASSIGN_OR_RETURN((auto [streaming_io_and_pipeline, concurrent_stages]),
-                       CloneNodesIntoPipelinedBlock(schedule, options, block));
+                       CloneNodesIntoPipelinedBlock(schedule, options, block,
+                                                    loopback_channel_ids));
 
   VLOG(3) << "After Pipeline";
   XLS_VLOG_LINES(3, block->DumpIr());
@@ -3405,6 +3466,9 @@ absl::StatusOr<CodegenPassUnit> PackageToPipelinedBlocks(
   XLS_RET_CHECK_EQ(block_name_uniquer.GetSanitizedUniqueName(module_name),
                    module_name);
   CodegenPassUnit unit(package, top_block);
+  XLS_ASSIGN_OR_RETURN(
+      absl::flat_hash_set<int64_t> loopback_channel_ids,
+      CloneNodesIntoBlockHandler::GetLoopbackChannelIds(package));
 
   for (const auto& [fb, schedule] : sorted_schedules) {
     std::string sub_block_name = block_name_uniquer.GetSanitizedUniqueName(
@@ -3417,8 +3481,9 @@ absl::StatusOr<CodegenPassUnit> PackageToPipelinedBlocks(
           package->AddBlock(std::make_unique<Block>(sub_block_name, package));
     }
     if (fb->IsProc()) {
-      XLS_RETURN_IF_ERROR(SingleProcToPipelinedBlock(
-          schedule, options, unit, fb->AsProcOrDie(), sub_block));
+      XLS_RETURN_IF_ERROR(
+          SingleProcToPipelinedBlock(schedule, options, unit, fb->AsProcOrDie(),
+                                     sub_block, loopback_channel_ids));
     } else if (fb->IsFunction()) {
       XLS_RET_CHECK_EQ(sorted_schedules.size(), 1);
       XLS_RET_CHECK_EQ(fb, top);
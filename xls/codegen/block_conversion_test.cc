@@ -31,6 +31,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -68,6 +69,7 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
 #include "xls/ir/verifier.h"
+#include "xls/ir/xls_ir_interface.pb.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -5840,6 +5842,112 @@ TEST_F(ProcConversionTestFixture, SimpleMultiProcConversion) {
   }
 }
 
+// Adds a proc to `p` with `channel_count` input and output streaming channels.
+// Output channel `i` carries the running sum of the values received on input
+// channel `i`, which is held in a state element.
+absl::StatusOr<Proc*> BuildManyChannelProc(Package* p, int64_t channel_count) {
+  Type* u32 = p->GetBitsType(32);
+  TokenlessProcBuilder b("many_channels", "tkn", p);
+  for (int64_t i = 0; i < channel_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Channel * in,
+        p->CreateStreamingChannel(absl::StrCat("in", i),
+                                  ChannelOps::kReceiveOnly, u32));
+    XLS_ASSIGN_OR_RETURN(Channel * out,
+                         p->CreateStreamingChannel(absl::StrCat("out", i),
+                                                   ChannelOps::kSendOnly, u32));
+    BValue sum = b.StateElement(absl::StrCat("sum", i), Value(UBits(0, 32)));
+    BValue next_sum = b.Add(sum, b.Receive(in));
+    b.Send(out, next_sum);
+    b.Next(/*param=*/sum, /*value=*/next_sum);
+  }
+  return b.Build();
+}
+
+CodegenOptions ManyChannelCodegenOptions() {
+  CodegenOptions options;
+  options.flop_inputs(true).flop_outputs(true).clock_name("clk");
+  options.reset("rst", false, false, false);
+  options.streaming_channel_data_suffix("_data");
+  options.streaming_channel_valid_suffix("_valid");
+  options.streaming_channel_ready_suffix("_ready");
+  options.module_name("many_channels");
+  return options;
+}
+
+TEST_F(BlockConversionTest, ManyChannelProcRecordsChannelSvTypes) {
+  constexpr int64_t kChannelCount = 8;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                           BuildManyChannelProc(p.get(), kChannelCount));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(3)));
+
+  // Give every other channel a SystemVerilog type.
+  PackageInterfaceProto interface;
+  for (int64_t i = 0; i < kChannelCount; i += 2) {
+    PackageInterfaceProto::Channel* in = interface.add_channels();
+    in->set_name(absl::StrCat("in", i));
+    in->set_sv_type(absl::StrCat("in", i, "_t"));
+    PackageInterfaceProto::Channel* out = interface.add_channels();
+    out->set_name(absl::StrCat("out", i));
+    out->set_sv_type(absl::StrCat("out", i, "_t"));
+  }
+  CodegenOptions options = ManyChannelCodegenOptions();
+  options.package_interface(interface);
+
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit, FunctionBaseToPipelinedBlock(
+                                                     schedule, options, proc));
+  const StreamingIOPipeline& io =
+      unit.metadata.at(unit.top_block).streaming_io_and_pipeline;
+  absl::flat_hash_map<std::string, std::string> input_types;
+  for (const auto& [port, sv_type] : io.input_port_sv_type) {
+    input_types[port->GetName()] = sv_type;
+  }
+  absl::flat_hash_map<std::string, std::string> output_types;
+  for (const auto& [port, sv_type] : io.output_port_sv_type) {
+    output_types[port->GetName()] = sv_type;
+  }
+  EXPECT_THAT(input_types, UnorderedElementsAre(Pair("in0_data", "in0_t"),
+                                                Pair("in2_data", "in2_t"),
+                                                Pair("in4_data", "in4_t"),
+                                                Pair("in6_data", "in6_t")));
+  EXPECT_THAT(output_types, UnorderedElementsAre(Pair("out0_data", "out0_t"),
+                                                 Pair("out2_data", "out2_t"),
+                                                 Pair("out4_data", "out4_t"),
+                                                 Pair("out6_data", "out6_t")));
+  int64_t input_count = 0;
+  for (const std::vector<StreamingInput>& inputs : io.inputs) {
+    input_count += inputs.size();
+  }
+  EXPECT_EQ(input_count, kChannelCount);
+}
+
+// Converts a proc with many channels and state elements to a pipelined block.
+// Block conversion should scale linearly with the number of channels.
+void BM_ManyChannelProcToPipelinedBlock(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto p = std::make_unique<Package>("many_channels_pkg");
+    Proc* proc = BuildManyChannelProc(p.get(), state.range(0)).value();
+    PipelineSchedule schedule =
+        RunPipelineSchedule(proc, TestDelayEstimator(),
+                            SchedulingOptions().pipeline_stages(4))
+            .value();
+    state.ResumeTiming();
+    CHECK_OK(FunctionBaseToPipelinedBlock(schedule, ManyChannelCodegenOptions(),
+                                          proc)
+                 .status());
+    state.PauseTiming();
+    p.reset();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(BM_ManyChannelProcToPipelinedBlock)->Range(16, 2048);
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -16,9 +16,11 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <initializer_list>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -37,6 +39,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_verilog_cache.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
 #include "xls/codegen/module_builder.h"
@@ -44,12 +48,14 @@
 #include "xls/codegen/node_expressions.h"
 #include "xls/codegen/node_representation.h"
 #include "xls/codegen/op_override.h"
+#include "xls/codegen/vast/emit_sink.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/format_preference.h"
@@ -979,10 +985,119 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// Adds the mappings from IR source locations to Verilog lines recorded in
+// `line_info` to `verilog_line_map`.
+absl::Status AddLineMappings(Block* top, const LineInfo& line_info,
+                             VerilogLineMap* verilog_line_map) {
+  for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+        mapping->set_source_file(
+            top->package()->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine());
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine());
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Generates and emits the module of a single block into its own VerilogFile.
+// The line map of the entry is only populated if `record_line_map`. If `cache`
+// is given, a previously generated module is returned when one exists and a
+// newly generated module is stored in it.
+absl::StatusOr<BlockVerilogCacheEntryProto> GenerateBlockVerilog(
+    Block* block, const CodegenOptions& options,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types,
+    bool record_line_map, const BlockVerilogCache* cache) {
+  std::string key;
+  if (cache != nullptr) {
+    key = cache->Key(block, input_port_sv_types, output_port_sv_types);
+    std::optional<BlockVerilogCacheEntryProto> entry = cache->LookUp(key);
+    if (entry.has_value()) {
+      VLOG(2) << absl::StreamFormat("Reusing cached Verilog for block `%s`",
+                                    block->name());
+      return *std::move(entry);
+    }
+  }
+
+  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                : FileType::kVerilog);
+  XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
+      block, &file, options, input_port_sv_types, output_port_sv_types));
+  LineInfo line_info;
+  StringEmitSink sink;
+  file.EmitTo(&sink, &line_info);
+
+  BlockVerilogCacheEntryProto entry;
+  entry.set_verilog_text(std::move(sink).str());
+  entry.set_line_count(line_info.current_line_number());
+  // Cached entries always carry a line map so they can serve any later
+  // invocation.
+  if (record_line_map || cache != nullptr) {
+    XLS_RETURN_IF_ERROR(
+        AddLineMappings(block, line_info, entry.mutable_line_map()));
+  }
+  if (cache != nullptr) {
+    cache->Store(key, entry);
+  }
+  return entry;
+}
+
+// Generates the module of each of `blocks` separately using
+// `options.block_generation_threads()` threads. Blocks refer to the modules of
+// the blocks they instantiate only by name, so each module can be generated
+// independently. The results are indexed like `blocks`.
+std::vector<absl::StatusOr<BlockVerilogCacheEntryProto>> GenerateBlocksVerilog(
+    absl::Span<Block* const> blocks, const CodegenOptions& options,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types,
+    bool record_line_map, const BlockVerilogCache* cache) {
+  std::vector<absl::StatusOr<BlockVerilogCacheEntryProto>> generated(
+      blocks.size());
+  std::atomic<int64_t> next_block = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_block++; i < blocks.size(); i = next_block++) {
+      generated[i] = GenerateBlockVerilog(blocks[i], options,
+                                          input_port_sv_types,
+                                          output_port_sv_types,
+                                          record_line_map, cache);
+    }
+  };
+  int64_t thread_count = std::min<int64_t>(options.block_generation_threads(),
+                                           blocks.size());
+  if (thread_count <= 1) {
+    worker();
+    return generated;
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return generated;
+}
+
 }  // namespace
 
-absl::StatusOr<std::string> GenerateVerilog(
-    Block* top, const CodegenOptions& options, VerilogLineMap* verilog_line_map,
+absl::Status GenerateVerilog(
+    Block* top, const CodegenOptions& options, EmitSink* sink,
+    VerilogLineMap* verilog_line_map,
     const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
     const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
   VLOG(2) << absl::StreamFormat(
@@ -992,6 +1107,46 @@ absl::StatusOr<std::string> GenerateVerilog(
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
+  std::optional<BlockVerilogCache> cache;
+  if (options.verilog_cache_dir().has_value()) {
+    cache.emplace(*options.verilog_cache_dir(), options.verilog_cache_key());
+  }
+  if (cache.has_value() ||
+      (options.block_generation_threads() > 1 && blocks.size() > 1)) {
+    std::vector<absl::StatusOr<BlockVerilogCacheEntryProto>> generated =
+        GenerateBlocksVerilog(blocks, options, input_port_sv_types,
+                              output_port_sv_types,
+                              /*record_line_map=*/verilog_line_map != nullptr,
+                              cache.has_value() ? &*cache : nullptr);
+    // Report the error of the first failing block so the result does not
+    // depend on scheduling.
+    for (const absl::StatusOr<BlockVerilogCacheEntryProto>& entry :
+         generated) {
+      XLS_RETURN_IF_ERROR(entry.status());
+    }
+    int64_t line_offset = 0;
+    for (int64_t i = 0; i < generated.size(); ++i) {
+      const BlockVerilogCacheEntryProto& entry = *generated[i];
+      sink->Write(entry.verilog_text());
+      if (verilog_line_map != nullptr) {
+        for (const VerilogLineMapping& mapping : entry.line_map().mapping()) {
+          VerilogLineMapping* shifted = verilog_line_map->add_mapping();
+          *shifted = mapping;
+          SourceSpan* span = shifted->mutable_verilog_span();
+          span->set_line_start(line_offset + span->line_start());
+          span->set_line_end(line_offset + span->line_end());
+        }
+      }
+      line_offset += entry.line_count();
+      if (i != generated.size() - 1) {
+        // Two blank lines between modules, as below.
+        sink->Write("\n\n");
+        line_offset += 2;
+      }
+    }
+    return absl::OkStatus();
+  }
+
   VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
                                                 : FileType::kVerilog);
   for (Block* block : blocks) {
@@ -1004,31 +1159,22 @@ absl::StatusOr<std::string> GenerateVerilog(
   }
 
   LineInfo line_info;
-  std::string text = file.Emit(&line_info);
+  file.EmitTo(sink, &line_info);
   if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
-      }
-    }
+    XLS_RETURN_IF_ERROR(AddLineMappings(top, line_info, verilog_line_map));
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> GenerateVerilog(
+    Block* top, const CodegenOptions& options, VerilogLineMap* verilog_line_map,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  StringEmitSink sink;
+  XLS_RETURN_IF_ERROR(GenerateVerilog(top, options, &sink, verilog_line_map,
+                                      input_port_sv_types,
+                                      output_port_sv_types));
+  std::string text = std::move(sink).str();
 
   VLOG(2) << "Verilog output:";
   XLS_VLOG_LINES(2, text);
@@ -18,8 +18,10 @@
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/vast/emit_sink.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/ir/block.h"
 #include "xls/ir/nodes.h"
@@ -38,6 +40,17 @@ absl::StatusOr<std::string> GenerateVerilog(
     const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types =
         {});
 
+// As above, but writes the text into `sink` rather than returning it. This
+// avoids holding the text of very large designs in memory as a single string,
+// e.g. when writing it directly to a file with a FileEmitSink.
+absl::Status GenerateVerilog(
+    Block* top, const CodegenOptions& options, EmitSink* sink,
+    VerilogLineMap* verilog_line_map = nullptr,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types =
+        {},
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types =
+        {});
+
 }  // namespace verilog
 }  // namespace xls
 
@@ -14,6 +14,7 @@
 
 #include "xls/codegen/block_generator.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <initializer_list>
@@ -36,12 +37,16 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_verilog_cache.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/codegen_pass_pipeline.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
@@ -81,6 +86,7 @@ namespace xls {
 namespace verilog {
 namespace {
 
+using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
 
@@ -1505,6 +1511,89 @@ TEST_P(BlockGeneratorTest, DiamondDependencyInstantiations) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, ConcurrentBlockGenerationMatchesSequential) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  BlockBuilder bb("my_block", &package);
+  BValue j = bb.InputPort("j", u32);
+  BValue k = bb.InputPort("k", u32);
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Block * delegator,
+        MakeDelegatingBlock(absl::StrCat("delegator", i), sub_block, &package));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        xls::Instantiation * instantiation,
+        bb.block()->AddBlockInstantiation(absl::StrCat("deleg", i), delegator));
+    bb.InstantiationInput(instantiation, "x", j);
+    bb.InstantiationInput(instantiation, "y", k);
+    bb.OutputPort(absl::StrCat("out", i),
+                  bb.InstantiationOutput(instantiation, "z"));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  // The order of the line mappings depends on hash map iteration, so compare
+  // them as sorted strings.
+  auto sorted_mappings = [](const VerilogLineMap& line_map) {
+    std::vector<std::string> mappings;
+    for (const VerilogLineMapping& mapping : line_map.mapping()) {
+      mappings.push_back(mapping.ShortDebugString());
+    }
+    std::sort(mappings.begin(), mappings.end());
+    return mappings;
+  };
+
+  VerilogLineMap expected_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string expected,
+      GenerateVerilog(block, codegen_options(), &expected_line_map));
+  for (int64_t threads : {2, 3, 8}) {
+    VerilogLineMap line_map;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string verilog,
+        GenerateVerilog(block,
+                        codegen_options().block_generation_threads(threads),
+                        &line_map));
+    EXPECT_EQ(verilog, expected) << threads;
+    EXPECT_EQ(sorted_mappings(line_map), sorted_mappings(expected_line_map))
+        << threads;
+  }
+}
+
+TEST_P(BlockGeneratorTest, VerilogCacheReusesModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block, MakeDelegatingBlock("delegator", sub_block, &package));
+
+  CodegenOptions options = codegen_options();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string expected,
+                           GenerateVerilog(block, options));
+  options.verilog_cache_dir(cache_dir.path().string()).verilog_cache_key("key");
+  EXPECT_THAT(GenerateVerilog(block, options), IsOkAndHolds(expected));
+
+  // Alter the cached module of the subtractor to show that it is reused rather
+  // than regenerated. It is emitted first as it is instantiated by the
+  // delegator.
+  BlockVerilogCache cache(cache_dir.path(), "key");
+  std::string key = cache.Key(sub_block, {}, {});
+  std::optional<BlockVerilogCacheEntryProto> entry = cache.LookUp(key);
+  ASSERT_TRUE(entry.has_value());
+  entry->set_verilog_text(absl::StrCat("// cached\n", entry->verilog_text()));
+  entry->set_line_count(entry->line_count() + 1);
+  cache.Store(key, *entry);
+  EXPECT_THAT(GenerateVerilog(block, options),
+              IsOkAndHolds(absl::StrCat("// cached\n", expected)));
+
+  // Entries are not shared between different options.
+  options.verilog_cache_key("other key");
+  EXPECT_THAT(GenerateVerilog(block, options), IsOkAndHolds(expected));
+}
+
 TEST_P(BlockGeneratorTest, LoopbackFifoInstantiation) {
   constexpr std::string_view ir_text = R"(package test
 
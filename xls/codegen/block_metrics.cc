@@ -51,59 +51,39 @@ int64_t GenerateFlopCount(Block* block) {
   return count;
 }
 
-// Returns true if there is a combinational feedthrough path from an input port
-// to an output port.
-bool HasFeedthroughPass(Block* block) {
-  // Nodes which have a combinational path from an input port.
-  absl::flat_hash_set<Node*> input_path_nodes;
-  for (Node* node : TopoSort(block)) {
-    if (node->Is<InputPort>()) {
-      input_path_nodes.insert(node);
-      continue;
-    }
-    for (Node* operand : node->operands()) {
-      if (operand->GetType()->GetFlatBitCount() > 0 &&
-          input_path_nodes.contains(operand)) {
-        input_path_nodes.insert(node);
-        break;
-      }
-    }
-    if (node->Is<OutputPort>() && input_path_nodes.contains(node)) {
-      return true;
-    }
-  }
-  return false;
-}
-
-// Sets the delay fields of `proto` based on analysis of `block`.
-absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
-                            BlockMetricsProto* proto) {
-  // Maximum delay from input to each node.
+// Walks `block` once, setting the feedthrough field of `proto` and, if
+// `set_delays` is true, the delay fields using the delays from `node_delay`.
+template <typename NodeDelayFn>
+void SetPathFields(Block* block, NodeDelayFn node_delay_fn, bool set_delays,
+                   BlockMetricsProto* proto) {
+  // Maximum delay from input to each node. Contains exactly the nodes which
+  // have a combinational path from an input port.
   absl::flat_hash_map<Node*, int64_t> input_delay_map;
   // Maximum delay from a register read to each node.
   absl::flat_hash_map<Node*, int64_t> reg_delay_map;
 
+  bool feedthrough_path_exists = false;
+
   // Delay metrics to set on the proto.
   std::optional<int64_t> max_reg_to_reg_delay;
   std::optional<int64_t> max_input_to_reg_delay;
   std::optional<int64_t> max_reg_to_output_delay;
   std::optional<int64_t> max_feedthrough_path_delay;
 
+  auto optional_max = [](int64_t value, std::optional<int64_t> opt_value) {
+    if (opt_value.has_value()) {
+      return std::max(value, opt_value.value());
+    }
+    return value;
+  };
+
   for (Node* node : TopoSort(block)) {
     if (node->Is<InputPort>()) {
       input_delay_map[node] = 0;
       continue;
     }
 
-    auto optional_max = [](int64_t value, std::optional<int64_t> opt_value) {
-      if (opt_value.has_value()) {
-        return std::max(value, opt_value.value());
-      }
-      return value;
-    };
-    absl::StatusOr<int64_t> node_delay_or =
-        delay_estimator.GetOperationDelayInPs(node);
-    int64_t node_delay = node_delay_or.ok() ? node_delay_or.value() : 0;
+    int64_t node_delay = node_delay_fn(node);
 
     std::optional<int64_t> input_delay;
     std::optional<int64_t> reg_delay;
@@ -129,6 +109,7 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
     if (node->Is<OutputPort>()) {
       Node* data = node->operand(0);
       if (input_delay_map.contains(data)) {
+        feedthrough_path_exists |= data->GetType()->GetFlatBitCount() > 0;
         max_feedthrough_path_delay =
             optional_max(input_delay_map.at(data), max_feedthrough_path_delay);
       }
@@ -165,6 +146,10 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
     }
   }
 
+  proto->set_feedthrough_path_exists(feedthrough_path_exists);
+  if (!set_delays) {
+    return;
+  }
   if (max_reg_to_reg_delay.has_value()) {
     proto->set_max_reg_to_reg_delay_ps(max_reg_to_reg_delay.value());
   }
@@ -178,8 +163,6 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
     proto->set_max_feedthrough_path_delay_ps(
         max_feedthrough_path_delay.value());
   }
-
-  return absl::OkStatus();
 }
 
 BomKindProto OpToBomKind(Op op) {
@@ -349,20 +332,65 @@ absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
 
 }  // namespace
 
-absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, const DelayEstimator* delay_estimator) {
-  BlockMetricsProto proto;
-  proto.set_flop_count(GenerateFlopCount(block));
-  proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
+int64_t BlockMetricsGenerator::GetNodeDelay(Node* node) {
+  auto same_operand = [](int64_t id, Node* operand) {
+    return id == operand->id();
+  };
+  auto it = delay_cache_.find(node->id());
+  if (it != delay_cache_.end() && it->second.op == node->op() &&
+      it->second.type == node->GetType() &&
+      it->second.operand_ids.size() == node->operand_count() &&
+      std::equal(it->second.operand_ids.begin(), it->second.operand_ids.end(),
+                 node->operands().begin(), same_operand)) {
+    return it->second.delay;
+  }
+
+  absl::StatusOr<int64_t> node_delay_or =
+      delay_estimator_->GetOperationDelayInPs(node);
+  ++estimated_node_count_;
+  CachedDelay& entry = delay_cache_[node->id()];
+  entry.op = node->op();
+  entry.type = node->GetType();
+  entry.operand_ids.clear();
+  for (Node* operand : node->operands()) {
+    entry.operand_ids.push_back(operand->id());
+  }
+  entry.delay = node_delay_or.ok() ? node_delay_or.value() : 0;
+  return entry.delay;
+}
 
-  if (delay_estimator != nullptr) {
-    proto.set_delay_model(delay_estimator->name());
-    XLS_RETURN_IF_ERROR(SetDelayFields(block, *delay_estimator, &proto));
+absl::StatusOr<BlockMetricsProto> BlockMetricsGenerator::Generate() {
+  BlockMetricsProto proto;
+  proto.set_flop_count(GenerateFlopCount(block_));
+  estimated_node_count_ = 0;
+
+  if (delay_estimator_ != nullptr) {
+    proto.set_delay_model(delay_estimator_->name());
+    // Drop the entries of nodes which have been removed from the block.
+    absl::flat_hash_set<int64_t> node_ids;
+    for (Node* node : block_->nodes()) {
+      node_ids.insert(node->id());
+    }
+    absl::erase_if(delay_cache_, [&](const auto& entry) {
+      return !node_ids.contains(entry.first);
+    });
+    SetPathFields(
+        block_, [&](Node* node) { return GetNodeDelay(node); },
+        /*set_delays=*/true, &proto);
+  } else {
+    SetPathFields(
+        block_, [](Node*) { return int64_t{0}; },
+        /*set_delays=*/false, &proto);
   }
 
-  XLS_RETURN_IF_ERROR(GenerateBom(block, &proto));
+  XLS_RETURN_IF_ERROR(GenerateBom(block_, &proto));
 
   return proto;
 }
 
+absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
+    Block* block, const DelayEstimator* delay_estimator) {
+  return BlockMetricsGenerator(block, delay_estimator).Generate();
+}
+
 }  // namespace xls::verilog
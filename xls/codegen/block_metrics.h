@@ -15,11 +15,17 @@
 #ifndef XLS_CODEGEN_BLOCK_METRICS_H_
 #define XLS_CODEGEN_BLOCK_METRICS_H_
 
+#include <cstdint>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
 
 namespace xls::verilog {
 
@@ -30,6 +36,42 @@ namespace xls::verilog {
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
     Block* block, const DelayEstimator* delay_estimator = nullptr);
 
+// Generates the metrics of a single block, caching the delay estimate of each
+// node between calls. Regenerating the metrics after the block has been
+// modified (e.g., between the points of a design-space sweep) only queries the
+// delay estimator for nodes which were added or whose operands changed.
+class BlockMetricsGenerator {
+ public:
+  explicit BlockMetricsGenerator(
+      Block* block, const DelayEstimator* delay_estimator = nullptr)
+      : block_(block), delay_estimator_(delay_estimator) {}
+
+  // Generates the metrics of the current contents of the block.
+  absl::StatusOr<BlockMetricsProto> Generate();
+
+  // Returns the number of nodes whose delay was estimated, rather than reused
+  // from the cache, by the most recent call to Generate().
+  int64_t estimated_node_count() const { return estimated_node_count_; }
+
+ private:
+  struct CachedDelay {
+    Op op;
+    Type* type;
+    std::vector<int64_t> operand_ids;
+    int64_t delay;
+  };
+
+  // Returns the delay of `node`, estimating it only if the cached entry is
+  // missing or stale.
+  int64_t GetNodeDelay(Node* node);
+
+  Block* block_;
+  const DelayEstimator* delay_estimator_;
+  // Cached delays keyed by node id.
+  absl::flat_hash_map<int64_t, CachedDelay> delay_cache_;
+  int64_t estimated_node_count_ = 0;
+};
+
 }  // namespace xls::verilog
 
 #endif  // XLS_CODEGEN_BLOCK_METRICS_H_
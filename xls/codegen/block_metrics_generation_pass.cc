@@ -34,6 +34,9 @@ absl::StatusOr<bool> BlockMetricsGenerationPass::RunInternal(
     }
     XLS_ASSIGN_OR_RETURN(BlockMetricsProto block_metrics,
                          GenerateBlockMetrics(block, options.delay_estimator));
+    if (metadata.retiming_metrics.has_value()) {
+      *block_metrics.mutable_retiming() = *metadata.retiming_metrics;
+    }
     XLS_RETURN_IF_ERROR(metadata.signature->ReplaceBlockMetrics(block_metrics));
     changed = true;
   }
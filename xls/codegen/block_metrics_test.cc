@@ -26,6 +26,8 @@
 #include "xls/ir/block.h"
 #include "xls/ir/fileno.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/register.h"
@@ -433,6 +435,52 @@ TEST(BlockMetricsGeneratorTest, DelayMetrics) {
   }
 }
 
+TEST(BlockMetricsGeneratorTest, IncrementalRegeneration) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  BlockBuilder bb("incremental", &package);
+  BValue x_d = bb.InsertRegister("x_d", bb.InputPort("x", u32));
+  BValue y_d = bb.InsertRegister("y_d", bb.InputPort("y", u32));
+  BValue sum = bb.Add(x_d, y_d);
+  bb.OutputPort("out", bb.InsertRegister("sum", sum));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  BlockMetricsGenerator generator(block, delay_estimator);
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto, generator.Generate());
+  EXPECT_EQ(proto.max_reg_to_reg_delay_ps(), 1);
+  EXPECT_GT(generator.estimated_node_count(), 0);
+
+  // Nothing changed so every delay is reused.
+  XLS_ASSERT_OK_AND_ASSIGN(proto, generator.Generate());
+  EXPECT_EQ(proto.max_reg_to_reg_delay_ps(), 1);
+  EXPECT_EQ(generator.estimated_node_count(), 0);
+
+  // Replace `x + y` with `x + ~y`. Only the new nodes and the register write
+  // whose operand changed are estimated.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_y,
+                           block->MakeNode<UnOp>(SourceInfo(), y_d.node(),
+                                                 Op::kNot));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_sum, block->MakeNode<BinOp>(SourceInfo(), x_d.node(), not_y,
+                                             Op::kAdd));
+  XLS_ASSERT_OK(sum.node()->ReplaceUsesWith(new_sum));
+  XLS_ASSERT_OK(block->RemoveNode(sum.node()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(proto, generator.Generate());
+  EXPECT_EQ(generator.estimated_node_count(), 3);
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto expected,
+                           GenerateBlockMetrics(block, delay_estimator));
+  EXPECT_EQ(proto.max_reg_to_reg_delay_ps(), 2);
+  EXPECT_EQ(proto.max_reg_to_reg_delay_ps(),
+            expected.max_reg_to_reg_delay_ps());
+  EXPECT_EQ(proto.flop_count(), expected.flop_count());
+  EXPECT_EQ(proto.bill_of_materials_size(), expected.bill_of_materials_size());
+}
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -0,0 +1,144 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_stitching_pass.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/codegen.h"
+
+namespace xls::verilog {
+namespace {
+
+// Measures block stitching of large proc networks, whose cost should grow
+// linearly with the number of channels stitched.
+
+CodegenOptions StitchingCodegenOptions() {
+  return CodegenOptions()
+      .module_name("top")
+      .flop_inputs(false)
+      .flop_outputs(false)
+      .clock_name("clk")
+      .reset("rst", false, false, true)
+      .streaming_channel_data_suffix("_data")
+      .streaming_channel_valid_suffix("_valid")
+      .streaming_channel_ready_suffix("_ready");
+}
+
+// Returns a package with a pipeline of `proc_count` procs, each connected to
+// the next by `channels_per_link` channels with FIFOs. The first proc receives
+// from and the last proc sends to external channels.
+absl::StatusOr<std::unique_ptr<Package>> MakeProcPipeline(
+    int64_t proc_count, int64_t channels_per_link) {
+  auto p = std::make_unique<Package>("stitching_benchmark");
+  Type* u32 = p->GetBitsType(32);
+  std::vector<std::vector<StreamingChannel*>> links(proc_count + 1);
+  for (int64_t link = 0; link <= proc_count; ++link) {
+    ChannelOps ops = link == 0            ? ChannelOps::kReceiveOnly
+                     : link == proc_count ? ChannelOps::kSendOnly
+                                          : ChannelOps::kSendReceive;
+    for (int64_t i = 0; i < channels_per_link; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          StreamingChannel * channel,
+          p->CreateStreamingChannel(
+              absl::StrCat("ch", link, "_", i), ops, u32,
+              /*initial_values=*/{},
+              FifoConfig(/*depth=*/1, /*bypass=*/false,
+                         /*register_push_outputs=*/false,
+                         /*register_pop_outputs=*/false)));
+      links[link].push_back(channel);
+    }
+  }
+  for (int64_t proc = 0; proc < proc_count; ++proc) {
+    ProcBuilder pb(absl::StrCat("proc", proc), p.get());
+    for (int64_t i = 0; i < channels_per_link; ++i) {
+      BValue receive = pb.Receive(links[proc][i], pb.AfterAll({}));
+      pb.Send(links[proc + 1][i], pb.TupleIndex(receive, 0),
+              pb.TupleIndex(receive, 1));
+    }
+    XLS_ASSIGN_OR_RETURN(Proc * built, pb.Build());
+    if (proc == 0) {
+      XLS_RETURN_IF_ERROR(p->SetTop(built));
+    }
+  }
+  return p;
+}
+
+// Schedules every proc of `p` and converts them to blocks, ready for
+// stitching.
+absl::StatusOr<CodegenPassUnit> ConvertToBlocks(Package* p,
+                                                const CodegenOptions& options) {
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       GetDelayEstimator("unit"));
+  XLS_ASSIGN_OR_RETURN(
+      PipelineScheduleOrGroup schedules,
+      Schedule(p,
+               SchedulingOptions().pipeline_stages(1).schedule_all_procs(true),
+               delay_estimator));
+  XLS_RET_CHECK(std::holds_alternative<PackagePipelineSchedules>(schedules));
+  return PackageToPipelinedBlocks(std::get<PackagePipelineSchedules>(schedules),
+                                  options, p);
+}
+
+void BM_StitchProcPipeline(benchmark::State& state) {
+  const int64_t proc_count = state.range(0);
+  const int64_t channels_per_link = state.range(1);
+  const CodegenOptions options = StitchingCodegenOptions();
+  std::unique_ptr<Package> package;
+  std::optional<CodegenPassUnit> unit;
+  for (auto _ : state) {
+    state.PauseTiming();
+    unit.reset();
+    package = MakeProcPipeline(proc_count, channels_per_link).value();
+    unit.emplace(ConvertToBlocks(package.get(), options).value());
+    state.ResumeTiming();
+
+    CodegenPassResults results;
+    CHECK_OK(BlockStitchingPass()
+                 .Run(&*unit, CodegenPassOptions{.codegen_options = options},
+                      &results)
+                 .status());
+  }
+  state.SetComplexityN(proc_count * channels_per_link);
+}
+
+BENCHMARK(BM_StitchProcPipeline)
+    ->ArgsProduct({{16, 64, 256}, {4, 16}})
+    ->Complexity(benchmark::oN)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls::verilog
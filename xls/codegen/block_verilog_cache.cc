@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/block_verilog_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
+#include "xls/common/file/cache_key.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls::verilog {
+namespace {
+
+// Bump when the layout of the key or of the entries changes.
+constexpr std::string_view kCacheVersion = "1";
+
+}  // namespace
+
+std::string BlockVerilogCache::Key(
+    Block* block,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types)
+    const {
+  // Only the types of this block's ports affect its module. Ports are visited
+  // in block order so the key is deterministic.
+  std::vector<std::string> sv_types;
+  for (InputPort* port : block->GetInputPorts()) {
+    auto it = input_port_sv_types.find(port);
+    if (it != input_port_sv_types.end()) {
+      sv_types.push_back(absl::StrCat(port->GetName(), "=", it->second));
+    }
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    auto it = output_port_sv_types.find(port);
+    if (it != output_port_sv_types.end()) {
+      sv_types.push_back(absl::StrCat(port->GetName(), "=", it->second));
+    }
+  }
+  // Source locations in the IR refer to files by number; the line map records
+  // their names.
+  std::vector<std::string> filenames;
+  for (const auto& [fileno, name] : block->package()->fileno_to_name()) {
+    filenames.push_back(absl::StrCat(static_cast<int64_t>(fileno), "=", name));
+  }
+  std::sort(filenames.begin(), filenames.end());
+
+  std::string ir = block->DumpIr();
+  std::string sv_types_str = absl::StrJoin(sv_types, ",");
+  std::string filenames_str = absl::StrJoin(filenames, ",");
+  return CacheKey(
+      {kCacheVersion, options_key_, ir, sv_types_str, filenames_str});
+}
+
+std::optional<BlockVerilogCacheEntryProto> BlockVerilogCache::LookUp(
+    std::string_view key) const {
+  absl::StatusOr<std::string> contents = GetFileContents(directory_ / key);
+  if (!contents.ok()) {
+    return std::nullopt;
+  }
+  BlockVerilogCacheEntryProto entry;
+  if (!entry.ParseFromString(*contents)) {
+    LOG(WARNING) << "Ignoring malformed Verilog cache entry "
+                 << (directory_ / key).string();
+    return std::nullopt;
+  }
+  return entry;
+}
+
+void BlockVerilogCache::Store(std::string_view key,
+                              const BlockVerilogCacheEntryProto& entry) const {
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to create Verilog cache directory %s: %s", directory_.string(),
+        ec.message());
+    return;
+  }
+  std::filesystem::path path = directory_ / key;
+  absl::Status status = AtomicSetFileContents(path, entry.SerializeAsString());
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write Verilog cache entry %s: %s", path.string(),
+        status.ToString());
+  }
+}
+
+}  // namespace xls::verilog
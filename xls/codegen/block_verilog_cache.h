@@ -0,0 +1,70 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
+#define XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+
+// A directory holding the Verilog module previously generated for each block,
+// so unchanged blocks need not be regenerated by later codegen invocations.
+//
+// Entries are keyed by a hash of everything which determines the generated
+// module: the block IR (which reflects the schedule and all codegen passes
+// applied to the block), the SystemVerilog types of its ports, the source file
+// names used by the line map, and an opaque key identifying the codegen
+// options. The cache is safe to share between concurrent processes.
+class BlockVerilogCache {
+ public:
+  // `options_key` must change whenever any codegen option which affects
+  // Verilog generation changes.
+  BlockVerilogCache(std::filesystem::path directory,
+                    std::string_view options_key)
+      : directory_(std::move(directory)), options_key_(options_key) {}
+
+  // Returns the cache key of the module generated for `block`.
+  std::string Key(
+      Block* block,
+      const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+      const absl::flat_hash_map<OutputPort*, std::string>&
+          output_port_sv_types) const;
+
+  // Returns the entry with the given key, or std::nullopt if there is none or
+  // it cannot be read.
+  std::optional<BlockVerilogCacheEntryProto> LookUp(std::string_view key) const;
+
+  // Stores an entry under the given key. Failures are logged rather than
+  // returned, since they only affect later invocations.
+  void Store(std::string_view key,
+             const BlockVerilogCacheEntryProto& entry) const;
+
+ private:
+  std::filesystem::path directory_;
+  std::string options_key_;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
@@ -0,0 +1,91 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/block_verilog_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls::verilog {
+namespace {
+
+class BlockVerilogCacheTest : public IrTestBase {
+ protected:
+  // Returns a block with an input `a` and an output `out` which adds `value`
+  // to it.
+  Block* MakeBlock(Package* p, int64_t value) {
+    BlockBuilder bb(TestName(), p);
+    BValue a = bb.InputPort("a", p->GetBitsType(32));
+    bb.OutputPort("out", bb.Add(a, bb.Literal(UBits(value, 32))));
+    return bb.Build().value();
+  }
+};
+
+TEST_F(BlockVerilogCacheTest, KeyDependsOnIrOptionsAndTypes) {
+  auto p0 = CreatePackage();
+  auto p1 = CreatePackage();
+  auto p2 = CreatePackage();
+  Block* block = MakeBlock(p0.get(), 1);
+  Block* same_block = MakeBlock(p1.get(), 1);
+  Block* other_block = MakeBlock(p2.get(), 2);
+
+  BlockVerilogCache cache("/unused", "options");
+  EXPECT_EQ(cache.Key(block, {}, {}), cache.Key(same_block, {}, {}));
+  EXPECT_NE(cache.Key(block, {}, {}), cache.Key(other_block, {}, {}));
+  EXPECT_NE(cache.Key(block, {}, {}),
+            BlockVerilogCache("/unused", "other options").Key(block, {}, {}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(InputPort * a, block->GetInputPort("a"));
+  absl::flat_hash_map<InputPort*, std::string> sv_types = {{a, "my_type_t"}};
+  EXPECT_NE(cache.Key(block, sv_types, {}), cache.Key(block, {}, {}));
+}
+
+TEST_F(BlockVerilogCacheTest, StoreAndLookUp) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  // Entries are stored in a subdirectory which does not exist yet.
+  BlockVerilogCache cache(temp_dir.path() / "cache", "options");
+  auto p = CreatePackage();
+  std::string key = cache.Key(MakeBlock(p.get(), 1), {}, {});
+  EXPECT_EQ(cache.LookUp(key), std::nullopt);
+
+  BlockVerilogCacheEntryProto entry;
+  entry.set_verilog_text("module foo;\nendmodule\n");
+  entry.set_line_count(2);
+  entry.mutable_line_map()->add_mapping()->set_source_file("foo.x");
+  cache.Store(key, entry);
+
+  std::optional<BlockVerilogCacheEntryProto> found = cache.LookUp(key);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->verilog_text(), entry.verilog_text());
+  EXPECT_EQ(found->line_count(), 2);
+  ASSERT_EQ(found->line_map().mapping_size(), 1);
+  EXPECT_EQ(found->line_map().mapping(0).source_file(), "foo.x");
+}
+
+}  // namespace
+}  // namespace xls::verilog
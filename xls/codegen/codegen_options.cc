@@ -70,7 +70,13 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       register_merge_strategy_(options.register_merge_strategy_),
       package_interface_(options.package_interface_),
       emit_sv_types_(options.emit_sv_types_),
-      simulation_macro_name_(options.simulation_macro_name_) {
+      simulation_macro_name_(options.simulation_macro_name_),
+      block_generation_threads_(options.block_generation_threads_),
+      retime_pipeline_registers_(options.retime_pipeline_registers_),
+      verilog_cache_dir_(options.verilog_cache_dir_),
+      verilog_cache_key_(options.verilog_cache_key_),
+      rom_init_dir_(options.rom_init_dir_),
+      rom_init_threshold_(options.rom_init_threshold_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -106,6 +112,12 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   package_interface_ = options.package_interface_;
   emit_sv_types_ = options.emit_sv_types_;
   simulation_macro_name_ = options.simulation_macro_name_;
+  block_generation_threads_ = options.block_generation_threads_;
+  retime_pipeline_registers_ = options.retime_pipeline_registers_;
+  verilog_cache_dir_ = options.verilog_cache_dir_;
+  verilog_cache_key_ = options.verilog_cache_key_;
+  rom_init_dir_ = options.rom_init_dir_;
+  rom_init_threshold_ = options.rom_init_threshold_;
 
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
@@ -280,6 +280,59 @@ class CodegenOptions {
     return *this;
   }
 
+  // Number of threads used to generate and emit the Verilog modules of
+  // independent blocks (e.g., the blocks of a multi-proc design). The modules
+  // are emitted in the same order regardless of the number of threads.
+  CodegenOptions& block_generation_threads(int64_t value) {
+    block_generation_threads_ = value;
+    return *this;
+  }
+  int64_t block_generation_threads() const { return block_generation_threads_; }
+
+  // Whether to retime pipeline registers after scheduling to shorten the
+  // longest register-to-register path (see RegisterRetimingPass). Requires a
+  // delay estimator.
+  CodegenOptions& retime_pipeline_registers(bool value) {
+    retime_pipeline_registers_ = value;
+    return *this;
+  }
+  bool retime_pipeline_registers() const { return retime_pipeline_registers_; }
+
+  // Directory in which the Verilog module generated for each block is cached
+  // and from which it is reused by later invocations. Entries are keyed by the
+  // block IR and `verilog_cache_key`, which must identify every other option
+  // affecting Verilog generation (see BlockVerilogCache).
+  CodegenOptions& verilog_cache_dir(std::optional<std::string> value) {
+    verilog_cache_dir_ = std::move(value);
+    return *this;
+  }
+  const std::optional<std::string>& verilog_cache_dir() const {
+    return verilog_cache_dir_;
+  }
+  CodegenOptions& verilog_cache_key(std::string value) {
+    verilog_cache_key_ = std::move(value);
+    return *this;
+  }
+  const std::string& verilog_cache_key() const { return verilog_cache_key_; }
+
+  // Directory into which the contents of large literal arrays (e.g., ROMs and
+  // coefficient tables) are written as `$readmemh` initialization files rather
+  // than being emitted inline. Only one-dimensional arrays of bits with at
+  // least `rom_init_threshold` elements are written out. The generated Verilog
+  // refers to the files by their path in this directory.
+  CodegenOptions& rom_init_dir(std::optional<std::string> value) {
+    rom_init_dir_ = std::move(value);
+    return *this;
+  }
+  const std::optional<std::string>& rom_init_dir() const {
+    return rom_init_dir_;
+  }
+  CodegenOptions& rom_init_threshold(int64_t value) {
+    rom_init_threshold_ = value;
+    return *this;
+  }
+  int64_t rom_init_threshold() const { return rom_init_threshold_; }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -311,6 +364,12 @@ class CodegenOptions {
   std::vector<std::string> includes_;
   bool emit_sv_types_ = true;
   std::string simulation_macro_name_ = "SIMULATION";
+  int64_t block_generation_threads_ = 1;
+  bool retime_pipeline_registers_ = false;
+  std::optional<std::string> verilog_cache_dir_;
+  std::string verilog_cache_key_;
+  std::optional<std::string> rom_init_dir_;
+  int64_t rom_init_threshold_ = 256;
 };
 
 template <typename Sink>
@@ -30,6 +30,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/concurrent_stage_groups.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/codegen/xls_metrics.pb.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
@@ -268,6 +269,9 @@ struct CodegenMetadata {
   // If absent all stages should be considered potentially concurrently active
   // with one another.
   std::optional<ConcurrentStageGroups> concurrent_stages;
+
+  // The effect of register retiming, set if it ran on the block.
+  std::optional<RetimingMetricsProto> retiming_metrics;
 };
 
 // Data structure operated on by codegen passes. Contains the IR and associated
@@ -33,6 +33,7 @@
 #include "xls/codegen/ram_rewrite_pass.h"
 #include "xls/codegen/register_combining_pass.h"
 #include "xls/codegen/register_legalization_pass.h"
+#include "xls/codegen/register_retiming_pass.h"
 #include "xls/codegen/side_effect_condition_pass.h"
 #include "xls/codegen/signature_generation_pass.h"
 #include "xls/codegen/trace_verbosity_pass.h"
@@ -92,6 +93,10 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
   // Update assert conditions to be guarded by pipeline_valid signals.
   top->Add<SideEffectConditionPass>();
 
+  // Balance the delay of the pipeline stages by moving operations across
+  // pipeline registers.
+  top->Add<RegisterRetimingPass>();
+
   // Deduplicate registers across mutually exclusive stages.
   top->Add<RegisterCombiningPass>();
 
@@ -35,7 +35,7 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator) {
+    const DelayEstimator* delay_estimator, CodegenPassResults* pass_results) {
   XLS_ASSIGN_OR_RETURN(CodegenPassUnit unit,
                        FunctionBaseToCombinationalBlock(module, options));
 
@@ -43,7 +43,9 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
   codegen_pass_options.codegen_options = options;
   codegen_pass_options.delay_estimator = delay_estimator;
 
-  CodegenPassResults results;
+  CodegenPassResults local_results;
+  CodegenPassResults& results =
+      pass_results == nullptr ? local_results : *pass_results;
   XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
                           ->Run(&unit, codegen_pass_options, &results)
                           .status());
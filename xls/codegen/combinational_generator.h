@@ -17,6 +17,7 @@
 
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
@@ -28,9 +29,12 @@ namespace verilog {
 // use_system_verilog is true the generated module will be SystemVerilog
 // otherwise it will be Verilog. This adds a proc to the package which
 // represents the combinational module. This proc is used for code generation.
+// If `pass_results` is non-null it is set to the results of the codegen pass
+// pipeline, including the per-pass invocation statistics.
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    CodegenPassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
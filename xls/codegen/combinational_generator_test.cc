@@ -15,6 +15,7 @@
 #include "xls/codegen/combinational_generator.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <random>
@@ -27,7 +28,10 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/codegen/codegen_options.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/interpreter/function_interpreter.h"
@@ -49,6 +53,10 @@ namespace verilog {
 namespace {
 
 using status_testing::IsOkAndHolds;
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
 
 constexpr char kTestName[] = "combinational_generator_test";
 constexpr char kTestdataPath[] = "xls/codegen/testdata";
@@ -1006,6 +1014,50 @@ TEST_P(CombinationalGeneratorTest, ArrayIndexWithBoundsCheck) {
   XLS_EXPECT_OK(tb->Run());
 }
 
+TEST_P(CombinationalGeneratorTest, LiteralArrayIndexFromRomInitFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory rom_dir, TempDirectory::Create());
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  std::vector<uint64_t> table;
+  for (int64_t i = 0; i < 64; ++i) {
+    table.push_back((i * 37 + 5) % 4096);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value rom, Value::UBitsArray(table, 12));
+  fb.ArrayIndex(fb.Literal(rom, SourceInfo(), "rom"),
+                {fb.Param("index", package.GetBitsType(6))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto inline_result, GenerateCombinationalModule(f, codegen_options()));
+  EXPECT_THAT(inline_result.verilog_text, Not(HasSubstr("$readmemh")));
+
+  // Arrays below the threshold are still emitted inline.
+  CodegenOptions options = codegen_options();
+  options.rom_init_dir(rom_dir.path().string()).rom_init_threshold(65);
+  XLS_ASSERT_OK_AND_ASSIGN(auto result,
+                           GenerateCombinationalModule(f, options));
+  EXPECT_EQ(result.verilog_text, inline_result.verilog_text);
+
+  options.rom_init_threshold(64);
+  XLS_ASSERT_OK_AND_ASSIGN(result, GenerateCombinationalModule(f, options));
+  EXPECT_THAT(result.verilog_text, HasSubstr("$readmemh"));
+  EXPECT_LT(result.verilog_text.size(), inline_result.verilog_text.size());
+  std::vector<std::filesystem::path> files(
+      std::filesystem::directory_iterator(rom_dir.path()),
+      std::filesystem::directory_iterator());
+  ASSERT_EQ(files.size(), 1);
+  EXPECT_THAT(files[0].filename().string(), EndsWith("_rom.hex"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(files[0]));
+  EXPECT_THAT(contents, StartsWith("5\n2a\n4f\n"));
+
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  for (int64_t i : {0, 1, 17, 63}) {
+    EXPECT_THAT(simulator.RunFunction({{"index", Value(UBits(i, 6))}}),
+                IsOkAndHolds(Value(UBits(table[i], 12))));
+  }
+}
+
 TEST_P(CombinationalGeneratorTest, ArrayIndexWithoutBoundsCheck) {
   Package package(TestBaseName());
   FunctionBuilder fb(TestBaseName(), &package);
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <initializer_list>
 #include <iterator>
@@ -43,6 +44,7 @@
 #include "xls/codegen/node_expressions.h"
 #include "xls/codegen/node_representation.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -481,9 +483,52 @@ absl::Status ModuleBuilder::AddOutputPort(
   return absl::OkStatus();
 }
 
+bool ModuleBuilder::ShouldEmitAsRomInitFile(Type* type) const {
+  if (!options_.rom_init_dir().has_value() || !type->IsArray()) {
+    return false;
+  }
+  ArrayType* array_type = type->AsArrayOrDie();
+  return array_type->element_type()->IsBits() &&
+         array_type->element_type()->GetFlatBitCount() > 0 &&
+         array_type->size() >= options_.rom_init_threshold();
+}
+
+absl::StatusOr<LogicRef*> ModuleBuilder::DeclareRomFromInitFile(
+    std::string_view name, const Value& value) {
+  ArrayType* array_type = package_.GetTypeForValue(value)->AsArrayOrDie();
+  std::string identifier = SanitizeIdentifier(name);
+  std::filesystem::path path =
+      std::filesystem::path(*options_.rom_init_dir()) /
+      absl::StrCat(module_name_, "_", identifier, ".hex");
+  std::string contents;
+  for (const Value& element : value.elements()) {
+    absl::StrAppend(&contents,
+                    BitsToString(element.bits(), FormatPreference::kPlainHex),
+                    "\n");
+  }
+  XLS_RETURN_IF_ERROR(SetFileContents(path, contents));
+
+  // The array is a reg rather than a wire as it is assigned by $readmemh in an
+  // initial block.
+  LogicRef* ref = module_->AddReg(
+      identifier,
+      file_->UnpackedArrayType(array_type->element_type()->GetFlatBitCount(),
+                               {array_type->size()}, SourceInfo()),
+      SourceInfo(), /*init=*/nullptr, constants_section());
+  Initial* initial = constants_section()->Add<Initial>(SourceInfo());
+  initial->statements()->Add<SystemTaskCall>(
+      SourceInfo(), "readmemh",
+      std::initializer_list<Expression*>{
+          file_->Make<QuotedString>(SourceInfo(), path.string()), ref});
+  return ref;
+}
+
 absl::StatusOr<LogicRef*> ModuleBuilder::DeclareModuleConstant(
     std::string_view name, const Value& value) {
   Type* type = package_.GetTypeForValue(value);
+  if (ShouldEmitAsRomInitFile(type)) {
+    return DeclareRomFromInitFile(name, value);
+  }
   DataType* data_type;
   if (type->IsArray()) {
     ArrayType* array_type = type->AsArrayOrDie();
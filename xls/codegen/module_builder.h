@@ -143,7 +143,9 @@ class ModuleBuilder {
   absl::Status Assign(LogicRef* lhs, Expression* rhs, Type* type);
 
   // Declares variable with the given name and assigns the given value to
-  // it. Returns a reference to the variable.
+  // it. Returns a reference to the variable. Arrays large enough to be emitted
+  // as ROMs (see `CodegenOptions::rom_init_dir`) are declared as a reg loaded
+  // from an initialization file written into the ROM directory.
   absl::StatusOr<LogicRef*> DeclareModuleConstant(std::string_view name,
                                                   const Value& Value);
 
@@ -312,6 +314,16 @@ class ModuleBuilder {
       Expression* lhs, Expression* rhs, Type* xls_type, int64_t slice_start,
       std::function<void(Expression*, Expression*)> add_assignment);
 
+  // Returns true if constants of the given type are emitted as ROMs loaded
+  // from an initialization file (see `CodegenOptions::rom_init_dir`).
+  bool ShouldEmitAsRomInitFile(Type* type) const;
+
+  // Writes the elements of the array 'value' to an initialization file in the
+  // ROM directory and declares a reg array of the given name loaded from it
+  // with $readmemh.
+  absl::StatusOr<LogicRef*> DeclareRomFromInitFile(std::string_view name,
+                                                   const Value& value);
+
   // Returns true if the node must be emitted as a function.
   bool MustEmitAsFunction(Node* node);
 
@@ -50,7 +50,8 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    CodegenPassResults* pass_results) {
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -70,7 +71,9 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     pass_options.codegen_options.emit_as_pipeline(false);
   }
 
-  CodegenPassResults results;
+  CodegenPassResults local_results;
+  CodegenPassResults& results =
+      pass_results == nullptr ? local_results : *pass_results;
   XLS_RETURN_IF_ERROR(
       CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
   XLS_RET_CHECK(unit.top_block != nullptr &&
@@ -94,7 +97,8 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PackagePipelineSchedules& schedules, Package* package,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    CodegenPassResults* pass_results) {
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, package->DumpIr());
   if (VLOG_IS_ON(2)) {
@@ -122,7 +126,9 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     pass_options.codegen_options.emit_as_pipeline(false);
   }
 
-  CodegenPassResults results;
+  CodegenPassResults local_results;
+  CodegenPassResults& results =
+      pass_results == nullptr ? local_results : *pass_results;
   XLS_RETURN_IF_ERROR(
       CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
   XLS_RET_CHECK(unit.top_block != nullptr &&
@@ -18,6 +18,7 @@
 
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
@@ -51,20 +52,25 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 // schedule. The module is pipelined with a latency and initiation interval
 // given in the signature.
 // If a delay estimator is provided, the signature also includes delay
-// information about the pipeline stages.
+// information about the pipeline stages. If `pass_results` is non-null it is
+// set to the results of the codegen pass pipeline, including the per-pass
+// invocation statistics.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    CodegenPassResults* pass_results = nullptr);
 
 // Emits the given package as a verilog module which follows the given
 // schedules. Modules are pipelined with a latency and initiation interval
 // given in the signature. If a delay estimator is provided, the signature also
-// includes delay information about the pipeline stages.
+// includes delay information about the pipeline stages. If `pass_results` is
+// non-null it is set to the results of the codegen pass pipeline.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PackagePipelineSchedules& schedules, Package* package,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    CodegenPassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
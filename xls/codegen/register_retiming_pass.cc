@@ -0,0 +1,442 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/codegen/xls_metrics.pb.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls::verilog {
+
+namespace {
+
+int64_t NodeDelay(Node* node, const DelayEstimator& delay_estimator) {
+  absl::StatusOr<int64_t> delay = delay_estimator.GetOperationDelayInPs(node);
+  return delay.ok() ? *delay : 0;
+}
+
+int64_t FlopCount(Block* block) {
+  int64_t count = 0;
+  for (Register* reg : block->GetRegisters()) {
+    count += reg->type()->GetFlatBitCount();
+  }
+  return count;
+}
+
+// Returns the operands of `node` through which a combinational path passes.
+// The reset of a register is not considered, as in the block metrics.
+std::vector<Node*> TimedOperands(Node* node) {
+  std::vector<Node*> operands;
+  if (node->Is<RegisterRead>()) {
+    return operands;
+  }
+  if (node->Is<RegisterWrite>()) {
+    operands.push_back(node->As<RegisterWrite>()->data());
+    if (node->As<RegisterWrite>()->load_enable().has_value()) {
+      operands.push_back(*node->As<RegisterWrite>()->load_enable());
+    }
+  } else {
+    operands.assign(node->operands().begin(), node->operands().end());
+  }
+  std::erase_if(operands, [](Node* operand) {
+    return operand->GetType()->GetFlatBitCount() == 0;
+  });
+  return operands;
+}
+
+bool IsPathEnd(Node* node) {
+  return node->Is<RegisterWrite>() || node->Is<OutputPort>() ||
+         node->Is<InstantiationInput>();
+}
+
+// Combinational delays of the nodes of a block. Paths start at register reads
+// (with their clock-to-output delay) and input ports.
+struct BlockTiming {
+  // Delay of the longest path ending at the output of each node.
+  absl::flat_hash_map<Node*, int64_t> arrival;
+  // The longest path delay and the node at which that path ends, if any.
+  int64_t max_delay = 0;
+  Node* critical_end = nullptr;
+};
+
+BlockTiming AnalyzeTiming(Block* block, const DelayEstimator& delay_estimator) {
+  BlockTiming timing;
+  for (Node* node : TopoSort(block)) {
+    int64_t arrival = 0;
+    for (Node* operand : TimedOperands(node)) {
+      arrival = std::max(arrival, timing.arrival.at(operand));
+    }
+    if (IsPathEnd(node)) {
+      if (timing.critical_end == nullptr || arrival > timing.max_delay) {
+        timing.max_delay = arrival;
+        timing.critical_end = node;
+      }
+    } else if (!node->Is<InputPort>()) {
+      arrival += NodeDelay(node, delay_estimator);
+    }
+    timing.arrival[node] = arrival;
+  }
+  return timing;
+}
+
+// Returns the first node after a register read on the longest path of the
+// block, or nullopt if that path does not start at a register read.
+std::optional<Node*> CriticalPathStart(const BlockTiming& timing) {
+  Node* node = timing.critical_end;
+  while (node != nullptr) {
+    Node* critical_operand = nullptr;
+    for (Node* operand : TimedOperands(node)) {
+      if (critical_operand == nullptr ||
+          timing.arrival.at(operand) > timing.arrival.at(critical_operand)) {
+        critical_operand = operand;
+      }
+    }
+    if (critical_operand == nullptr || critical_operand->Is<InputPort>()) {
+      return std::nullopt;
+    }
+    if (critical_operand->Is<RegisterRead>()) {
+      return node;
+    }
+    node = critical_operand;
+  }
+  return std::nullopt;
+}
+
+// Returns the nodes referred to by the metadata of a block. These are not
+// moved or removed by retiming.
+absl::flat_hash_set<Node*> MetadataNodes(const CodegenMetadata& metadata) {
+  const StreamingIOPipeline& pipeline = metadata.streaming_io_and_pipeline;
+  absl::flat_hash_set<Node*> nodes;
+  auto add = [&](std::optional<Node*> node) {
+    if (node.has_value() && *node != nullptr) {
+      nodes.insert(*node);
+    }
+  };
+  for (const std::vector<StreamingInput>& inputs : pipeline.inputs) {
+    for (const StreamingInput& input : inputs) {
+      add(input.port);
+      add(input.port_valid);
+      add(input.port_ready);
+      add(input.signal_data);
+      add(input.signal_valid);
+      add(input.predicate);
+    }
+  }
+  for (const std::vector<StreamingOutput>& outputs : pipeline.outputs) {
+    for (const StreamingOutput& output : outputs) {
+      add(output.port);
+      add(output.port_valid);
+      add(output.port_ready);
+      add(output.predicate);
+    }
+  }
+  for (const std::optional<StateRegister>& state : pipeline.state_registers) {
+    if (!state.has_value()) {
+      continue;
+    }
+    for (const StateRegister::NextValue& next_value : state->next_values) {
+      add(next_value.value);
+      add(next_value.predicate);
+    }
+    add(state->reg_read);
+    add(state->reg_write);
+    add(state->reg_full_read);
+    add(state->reg_full_write);
+  }
+  for (const SingleValueInput& input : pipeline.single_value_inputs) {
+    add(input.port);
+  }
+  for (const SingleValueOutput& output : pipeline.single_value_outputs) {
+    add(output.port);
+  }
+  if (pipeline.idle_port.has_value()) {
+    add(*pipeline.idle_port);
+  }
+  for (const std::vector<std::optional<Node*>>* signals :
+       {&pipeline.pipeline_valid, &pipeline.stage_valid, &pipeline.stage_done}) {
+    for (std::optional<Node*> signal : *signals) {
+      add(signal);
+    }
+  }
+  if (const ProcConversionMetadata* proc_metadata =
+          std::get_if<ProcConversionMetadata>(&metadata.conversion_metadata)) {
+    for (std::optional<Node*> valid_flop : proc_metadata->valid_flops) {
+      add(valid_flop);
+    }
+  }
+  return nodes;
+}
+
+// A pipeline register along with the stage which writes it.
+struct StagedRegister {
+  Stage write_stage;
+  PipelineRegister reg;
+};
+
+// Moving `node` from `stage` back into stage `stage - depth`.
+struct RetimingMove {
+  Node* node;
+  Stage stage;
+  int64_t depth;
+  // The operands of the moved node in its new stage.
+  std::vector<Node*> operands;
+  // The load enable of the new register written by each stage from
+  // `stage - depth` to `stage - 1`.
+  std::vector<std::optional<Node*>> load_enables;
+  // The registers through which the operands were carried to `stage`.
+  std::vector<StagedRegister> crossed_registers;
+  // The delay of the path ending at the new register written in stage
+  // `stage - depth`.
+  int64_t delay;
+};
+
+// Returns the best move of `node` into an earlier stage, if it can be moved.
+// The operands are followed back through as many stages as they are carried
+// unchanged by chains of pipeline registers, and the stage which gives the
+// shortest path ending at the moved node is chosen.
+std::optional<RetimingMove> FindMove(
+    Node* node, const CodegenMetadata& metadata,
+    const absl::flat_hash_set<Node*>& metadata_nodes,
+    const absl::flat_hash_map<Node*, StagedRegister>& register_reads,
+    const BlockTiming& timing, const DelayEstimator& delay_estimator) {
+  if (metadata_nodes.contains(node) || OpIsSideEffecting(node->op()) ||
+      node->Is<Literal>() || node->GetType()->GetFlatBitCount() == 0) {
+    return std::nullopt;
+  }
+  const absl::flat_hash_map<Node*, Stage>& node_to_stage_map =
+      metadata.streaming_io_and_pipeline.node_to_stage_map;
+  auto stage_it = node_to_stage_map.find(node);
+  if (stage_it == node_to_stage_map.end()) {
+    return std::nullopt;
+  }
+  const Stage stage = stage_it->second;
+  const int64_t node_delay = NodeDelay(node, delay_estimator);
+  if (node_delay <= 0) {
+    // Nothing is gained by moving the node.
+    return std::nullopt;
+  }
+
+  std::optional<RetimingMove> best;
+  std::vector<Node*> operands(node->operands().begin(),
+                              node->operands().end());
+  std::vector<std::optional<Node*>> load_enables;
+  std::vector<StagedRegister> crossed_registers;
+  for (int64_t depth = 1; depth <= stage; ++depth) {
+    // Step each operand back across the register written in the previous
+    // stage. All of these registers must share a load enable so a single
+    // register can replace them.
+    std::optional<std::optional<Node*>> load_enable;
+    std::vector<Node*> previous_operands;
+    bool crossed_all = true;
+    for (Node* operand : operands) {
+      if (operand->Is<Literal>()) {
+        previous_operands.push_back(operand);
+        continue;
+      }
+      auto reg_it = register_reads.find(operand);
+      if (reg_it == register_reads.end() ||
+          reg_it->second.write_stage != stage - depth ||
+          reg_it->second.reg.reg->reset().has_value() ||
+          (load_enable.has_value() &&
+           *load_enable != reg_it->second.reg.reg_write->load_enable())) {
+        crossed_all = false;
+        break;
+      }
+      load_enable = reg_it->second.reg.reg_write->load_enable();
+      previous_operands.push_back(reg_it->second.reg.reg_write->data());
+      crossed_registers.push_back(reg_it->second);
+    }
+    if (!crossed_all || !load_enable.has_value()) {
+      break;
+    }
+    operands = std::move(previous_operands);
+    load_enables.insert(load_enables.begin(), *load_enable);
+
+    int64_t delay = node_delay;
+    for (Node* operand : operands) {
+      delay = std::max(delay, timing.arrival.at(operand) + node_delay);
+    }
+    if (!best.has_value() || delay < best->delay) {
+      best = RetimingMove{.node = node,
+                          .stage = stage,
+                          .depth = depth,
+                          .operands = operands,
+                          .load_enables = load_enables,
+                          .crossed_registers = crossed_registers,
+                          .delay = delay};
+    }
+  }
+  return best;
+}
+
+absl::Status ApplyMove(const RetimingMove& move,
+                       const absl::flat_hash_set<Node*>& metadata_nodes,
+                       Block* block, CodegenMetadata& metadata) {
+  StreamingIOPipeline& pipeline = metadata.streaming_io_and_pipeline;
+  VLOG(2) << absl::StreamFormat("Retiming %s from stage %d to stage %d",
+                                move.node->GetName(), move.stage,
+                                move.stage - move.depth);
+  XLS_ASSIGN_OR_RETURN(Node * moved, move.node->Clone(move.operands));
+  Stage first_stage = move.stage - move.depth;
+  pipeline.node_to_stage_map[moved] = first_stage;
+
+  // Carry the result to the original stage of the node.
+  Node* value = moved;
+  for (Stage stage = first_stage; stage < move.stage; ++stage) {
+    XLS_RET_CHECK_LT(stage, pipeline.pipeline_registers.size());
+    XLS_ASSIGN_OR_RETURN(
+        Register * reg,
+        block->AddRegister(
+            absl::StrFormat("p%d_%s", stage, move.node->GetName()),
+            move.node->GetType()));
+    XLS_ASSIGN_OR_RETURN(
+        RegisterWrite * reg_write,
+        block->MakeNode<RegisterWrite>(
+            move.node->loc(), value,
+            /*load_enable=*/move.load_enables[stage - first_stage],
+            /*reset=*/std::nullopt, reg));
+    XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read,
+                         block->MakeNode<RegisterRead>(move.node->loc(), reg));
+    pipeline.node_to_stage_map[reg_write] = stage;
+    pipeline.node_to_stage_map[reg_read] = stage + 1;
+    pipeline.pipeline_registers[stage].push_back(PipelineRegister{
+        .reg = reg, .reg_write = reg_write, .reg_read = reg_read});
+    value = reg_read;
+  }
+  XLS_RETURN_IF_ERROR(move.node->ReplaceUsesWith(value));
+  pipeline.node_to_stage_map.erase(move.node);
+  XLS_RETURN_IF_ERROR(block->RemoveNode(move.node));
+
+  // Remove the crossed registers which are no longer used, latest first since
+  // removing a register may leave the register feeding it unused.
+  std::vector<StagedRegister> crossed = move.crossed_registers;
+  std::stable_sort(crossed.begin(), crossed.end(),
+                   [](const StagedRegister& a, const StagedRegister& b) {
+                     return a.write_stage > b.write_stage;
+                   });
+  absl::flat_hash_set<Register*> removed;
+  for (const StagedRegister& staged : crossed) {
+    const PipelineRegister& reg = staged.reg;
+    if (removed.contains(reg.reg) || !reg.reg_read->users().empty() ||
+        metadata_nodes.contains(reg.reg_read) ||
+        metadata_nodes.contains(reg.reg_write)) {
+      continue;
+    }
+    removed.insert(reg.reg);
+    std::erase_if(pipeline.pipeline_registers[staged.write_stage],
+                  [&](const PipelineRegister& pr) { return pr.reg == reg.reg; });
+    pipeline.node_to_stage_map.erase(reg.reg_read);
+    pipeline.node_to_stage_map.erase(reg.reg_write);
+    XLS_RETURN_IF_ERROR(block->RemoveNode(reg.reg_read));
+    XLS_RETURN_IF_ERROR(block->RemoveNode(reg.reg_write));
+    XLS_RETURN_IF_ERROR(block->RemoveRegister(reg.reg));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> RunOnBlock(Block* block, CodegenMetadata& metadata,
+                                const DelayEstimator& delay_estimator) {
+  if (metadata.streaming_io_and_pipeline.pipeline_registers.empty()) {
+    return false;
+  }
+  const absl::flat_hash_set<Node*> metadata_nodes = MetadataNodes(metadata);
+
+  BlockTiming timing = AnalyzeTiming(block, delay_estimator);
+  RetimingMetricsProto retiming_metrics;
+  retiming_metrics.set_initial_max_reg_to_reg_delay_ps(timing.max_delay);
+  retiming_metrics.set_initial_flop_count(FlopCount(block));
+
+  // Every move strictly shortens a path and moves a node into an earlier
+  // stage, but bound the number of moves regardless.
+  const int64_t max_moves = block->node_count();
+  int64_t move_count = 0;
+  while (move_count < max_moves) {
+    std::optional<Node*> start = CriticalPathStart(timing);
+    if (!start.has_value()) {
+      break;
+    }
+    absl::flat_hash_map<Node*, StagedRegister> register_reads;
+    const std::vector<PipelineStageRegisters>& pipeline_registers =
+        metadata.streaming_io_and_pipeline.pipeline_registers;
+    for (Stage stage = 0; stage < pipeline_registers.size(); ++stage) {
+      for (const PipelineRegister& reg : pipeline_registers[stage]) {
+        register_reads[reg.reg_read] =
+            StagedRegister{.write_stage = stage, .reg = reg};
+      }
+    }
+    std::optional<RetimingMove> move =
+        FindMove(*start, metadata, metadata_nodes, register_reads, timing,
+                 delay_estimator);
+    if (!move.has_value() || move->delay >= timing.max_delay) {
+      break;
+    }
+    XLS_RETURN_IF_ERROR(ApplyMove(*move, metadata_nodes, block, metadata));
+    ++move_count;
+    timing = AnalyzeTiming(block, delay_estimator);
+  }
+
+  retiming_metrics.set_retimed_node_count(move_count);
+  retiming_metrics.set_final_max_reg_to_reg_delay_ps(timing.max_delay);
+  retiming_metrics.set_final_flop_count(FlopCount(block));
+  metadata.retiming_metrics = retiming_metrics;
+  return move_count > 0;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> RegisterRetimingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    CodegenPassResults* results) const {
+  if (!options.codegen_options.retime_pipeline_registers()) {
+    return false;
+  }
+  if (options.delay_estimator == nullptr) {
+    VLOG(2) << "Not retiming registers as no delay estimator was given.";
+    return false;
+  }
+  bool changed = false;
+  for (auto& [block, metadata] : unit->metadata) {
+    XLS_ASSIGN_OR_RETURN(
+        bool block_changed,
+        RunOnBlock(block, metadata, *options.delay_estimator));
+    changed = changed || block_changed;
+  }
+  if (changed) {
+    unit->GcMetadata();
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+#define XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Retimes pipeline registers to balance the combinational delay of the pipeline
+// stages after scheduling.
+//
+// When the longest register-to-register path of the block starts at an
+// operation whose operands are all pipeline registers written by the previous
+// stage (or literals), the operation is moved into an earlier stage and its
+// result is registered in place of its operands. If those registers are in
+// turn the end of a chain of pipeline registers carrying the values unchanged
+// through several stages, the operation may move back along the chain to
+// whichever stage leaves the shortest path. Operations are moved one at a time,
+// each move strictly shortening the path it is on, until the longest path no
+// longer starts at a movable operation. Operand registers left without users
+// are removed.
+//
+// Only registers without reset which share a load enable are retimed, so the
+// behavior of the block is unchanged. Requires a delay estimator; the initial
+// and final delays are recorded in the block metrics.
+class RegisterRetimingPass : public CodegenPass {
+ public:
+  RegisterRetimingPass()
+      : CodegenPass("register_retiming",
+                    "Retime pipeline registers to balance stage delays") {}
+  ~RegisterRetimingPass() override = default;
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   CodegenPassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
@@ -0,0 +1,191 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/codegen/xls_metrics.pb.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/source_location.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOk;
+using status_testing::IsOkAndHolds;
+
+class RegisterRetimingPassTest : public IrTestBase {
+ public:
+  absl::StatusOr<bool> Run(CodegenPassUnit& unit) {
+    CodegenPassResults results;
+    return RegisterRetimingPass().Run(
+        &unit,
+        CodegenPassOptions{
+            .codegen_options = CodegenOptions().retime_pipeline_registers(true),
+            .delay_estimator = &delay_estimator_},
+        &results);
+  }
+
+  // Runs the block on `inputs` and returns the values of the `out` port
+  // `latency` cycles after each set of inputs.
+  std::vector<uint64_t> Evaluate(
+      Block* block,
+      const std::vector<absl::flat_hash_map<std::string, uint64_t>>& inputs,
+      int64_t latency) {
+    std::vector<absl::flat_hash_map<std::string, uint64_t>> padded = inputs;
+    for (int64_t i = 0; i < latency; ++i) {
+      padded.push_back(inputs.back());
+    }
+    std::vector<absl::flat_hash_map<std::string, uint64_t>> outputs =
+        kInterpreterBlockEvaluator.EvaluateSequentialBlock(block, padded)
+            .value();
+    std::vector<uint64_t> result;
+    for (int64_t i = latency; i < outputs.size(); ++i) {
+      result.push_back(outputs[i].at("out"));
+    }
+    return result;
+  }
+
+ private:
+  TestDelayEstimator delay_estimator_;
+};
+
+TEST_F(RegisterRetimingPassTest, MovesOperationsIntoEarlierStage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue z = fb.Param("z", p->GetBitsType(32));
+  BValue not_z = fb.Not(z);
+  BValue a = fb.Add(x, y);
+  BValue b = fb.Add(a, not_z);
+  BValue c = fb.UMul(b, b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+  // All of the work except `not_z` is in the second stage.
+  PipelineSchedule schedule(f,
+                            {{x.node(), 0},
+                             {y.node(), 0},
+                             {z.node(), 0},
+                             {not_z.node(), 0},
+                             {a.node(), 1},
+                             {b.node(), 1},
+                             {c.node(), 1}},
+                            2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionBaseToPipelinedBlock(schedule, CodegenOptions().clock_name("clk"),
+                                   f));
+  Block* block = unit.top_block;
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs = {
+      {{"x", 1}, {"y", 2}, {"z", 0xfffffff0}},
+      {{"x", 10}, {"y", 20}, {"z", 0xffffff00}},
+      {{"x", 7}, {"y", 0}, {"z", 0xffffffff}}};
+  std::vector<uint64_t> expected = Evaluate(block, inputs, /*latency=*/1);
+
+  EXPECT_THAT(Run(unit), IsOkAndHolds(true));
+  EXPECT_EQ(Evaluate(block, inputs, /*latency=*/1), expected);
+
+  // `a` and `b` move into the first stage, so only `b` is registered.
+  ASSERT_EQ(block->GetRegisters().size(), 1);
+  EXPECT_EQ(block->GetRegisters()[0]->type(), p->GetBitsType(32));
+  CodegenMetadata& metadata = unit.metadata.at(block);
+  ASSERT_TRUE(metadata.retiming_metrics.has_value());
+  EXPECT_EQ(metadata.retiming_metrics->retimed_node_count(), 2);
+  EXPECT_EQ(metadata.retiming_metrics->initial_max_reg_to_reg_delay_ps(), 4);
+  EXPECT_EQ(metadata.retiming_metrics->final_max_reg_to_reg_delay_ps(), 2);
+  EXPECT_EQ(metadata.retiming_metrics->initial_flop_count(), 96);
+  EXPECT_EQ(metadata.retiming_metrics->final_flop_count(), 32);
+}
+
+TEST_F(RegisterRetimingPassTest, MovesAlongRegisterChain) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue z = fb.Param("z", p->GetBitsType(32));
+  BValue a = fb.Add(x, y, SourceInfo(), "a");
+  BValue c = fb.UMul(a, z);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+  // `x` and `y` are carried unchanged through the first two stages.
+  PipelineSchedule schedule(
+      f,
+      {{x.node(), 0}, {y.node(), 0}, {z.node(), 0}, {a.node(), 2}, {c.node(), 2}},
+      3);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionBaseToPipelinedBlock(schedule, CodegenOptions().clock_name("clk"),
+                                   f));
+  Block* block = unit.top_block;
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs = {
+      {{"x", 1}, {"y", 2}, {"z", 3}},
+      {{"x", 10}, {"y", 20}, {"z", 30}},
+      {{"x", 0xffffffff}, {"y", 2}, {"z", 5}}};
+  std::vector<uint64_t> expected = Evaluate(block, inputs, /*latency=*/2);
+
+  EXPECT_THAT(Run(unit), IsOkAndHolds(true));
+  EXPECT_EQ(Evaluate(block, inputs, /*latency=*/2), expected);
+
+  // `a` moves back to the first stage, where its operands arrive earliest, and
+  // its result replaces the registers of `x` and `y` in both stages.
+  EXPECT_THAT(block->GetRegister("p0_a"), IsOk());
+  EXPECT_THAT(block->GetRegister("p1_a"), IsOk());
+  EXPECT_EQ(block->GetRegisters().size(), 4);
+  CodegenMetadata& metadata = unit.metadata.at(block);
+  ASSERT_TRUE(metadata.retiming_metrics.has_value());
+  EXPECT_EQ(metadata.retiming_metrics->retimed_node_count(), 1);
+  EXPECT_EQ(metadata.retiming_metrics->initial_max_reg_to_reg_delay_ps(), 3);
+  EXPECT_EQ(metadata.retiming_metrics->final_max_reg_to_reg_delay_ps(), 2);
+}
+
+TEST_F(RegisterRetimingPassTest, RegistersWithResetAreNotRetimed) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = fb.Add(x, y);
+  BValue c = fb.UMul(a, a);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+  PipelineSchedule schedule(
+      f, {{x.node(), 0}, {y.node(), 0}, {a.node(), 1}, {c.node(), 1}}, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionBaseToPipelinedBlock(
+          schedule,
+          CodegenOptions().clock_name("clk").reset(
+              "rst", /*asynchronous=*/false, /*active_low=*/false,
+              /*reset_data_path=*/true),
+          f));
+  int64_t register_count = unit.top_block->GetRegisters().size();
+
+  EXPECT_THAT(Run(unit), IsOkAndHolds(false));
+  EXPECT_EQ(unit.top_block->GetRegisters().size(), register_count);
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/vast/emit_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <ios>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+
+namespace xls {
+namespace verilog {
+
+void EmitSink::Write(std::string_view text) {
+  while (!text.empty()) {
+    if (at_line_start_ && !indent_.empty() && text.front() != '\n') {
+      Append(indent_);
+    }
+    size_t newline = text.find('\n');
+    if (newline == std::string_view::npos) {
+      Append(text);
+      at_line_start_ = false;
+      return;
+    }
+    Append(text.substr(0, newline + 1));
+    at_line_start_ = true;
+    text.remove_prefix(newline + 1);
+  }
+}
+
+void EmitSink::Indent(int64_t spaces) {
+  CHECK_GE(spaces, 0);
+  indent_.append(spaces, ' ');
+}
+
+void EmitSink::Dedent(int64_t spaces) {
+  CHECK_GE(spaces, 0);
+  CHECK_LE(spaces, indentation());
+  indent_.resize(indent_.size() - spaces);
+}
+
+void CordEmitSink::Append(std::string_view text) {
+  buffer_.append(text);
+  if (buffer_.size() >= kChunkSize) {
+    cord_.Append(std::move(buffer_));
+    buffer_.clear();
+  }
+}
+
+absl::Cord CordEmitSink::Release() && {
+  cord_.Append(std::move(buffer_));
+  buffer_.clear();
+  return std::move(cord_);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<FileEmitSink>> FileEmitSink::Create(
+    const std::filesystem::path& path) {
+  auto sink = absl::WrapUnique(new FileEmitSink(path));
+  sink->stream_.open(path, std::ios::binary | std::ios::trunc);
+  if (!sink->stream_) {
+    return absl::PermissionDeniedError(
+        absl::StrCat("Unable to open file for writing: ", path.string()));
+  }
+  return sink;
+}
+
+void FileEmitSink::Append(std::string_view text) {
+  stream_.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+absl::Status FileEmitSink::Close() {
+  stream_.close();
+  if (!stream_) {
+    return absl::DataLossError(
+        absl::StrCat("Error writing file: ", path_.string()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,132 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_VAST_EMIT_SINK_H_
+#define XLS_CODEGEN_VAST_EMIT_SINK_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+
+namespace xls {
+namespace verilog {
+
+// Destination for emitted Verilog text. Text is appended incrementally rather
+// than being built up as nested temporary strings, so large modules can be
+// emitted directly to their final destination.
+//
+// The sink tracks the current indentation: every non-empty line which starts
+// while an indentation is active is prefixed by that many spaces. This matches
+// the behavior of xls::Indent applied to the same text.
+class EmitSink {
+ public:
+  virtual ~EmitSink() = default;
+
+  // Appends `text`, indenting each non-empty line started within it.
+  void Write(std::string_view text);
+
+  // Increases or decreases the indentation of subsequently started lines.
+  void Indent(int64_t spaces = 2);
+  void Dedent(int64_t spaces = 2);
+
+  int64_t indentation() const { return static_cast<int64_t>(indent_.size()); }
+
+ protected:
+  // Appends `text` verbatim to the destination.
+  virtual void Append(std::string_view text) = 0;
+
+ private:
+  std::string indent_;
+  bool at_line_start_ = true;
+};
+
+// Indents the given sink for the lifetime of the object.
+class ScopedEmitIndent {
+ public:
+  explicit ScopedEmitIndent(EmitSink* sink, int64_t spaces = 2)
+      : sink_(sink), spaces_(spaces) {
+    sink_->Indent(spaces_);
+  }
+  ~ScopedEmitIndent() { sink_->Dedent(spaces_); }
+
+  ScopedEmitIndent(const ScopedEmitIndent&) = delete;
+  ScopedEmitIndent& operator=(const ScopedEmitIndent&) = delete;
+
+ private:
+  EmitSink* sink_;
+  int64_t spaces_;
+};
+
+// Sink which accumulates the emitted text in a string.
+class StringEmitSink final : public EmitSink {
+ public:
+  const std::string& str() const& { return str_; }
+  std::string str() && { return std::move(str_); }
+
+ protected:
+  void Append(std::string_view text) final { str_.append(text); }
+
+ private:
+  std::string str_;
+};
+
+// Sink which accumulates the emitted text in a cord. Text is buffered and
+// appended to the cord in large chunks, so the cord is not fragmented into
+// many small pieces.
+class CordEmitSink final : public EmitSink {
+ public:
+  // Returns the emitted text. The sink may not be written to afterwards.
+  absl::Cord Release() &&;
+
+ protected:
+  void Append(std::string_view text) final;
+
+ private:
+  static constexpr int64_t kChunkSize = 64 * 1024;
+
+  absl::Cord cord_;
+  std::string buffer_;
+};
+
+// Sink which writes the emitted text to a file through a buffered stream.
+class FileEmitSink final : public EmitSink {
+ public:
+  static absl::StatusOr<std::unique_ptr<FileEmitSink>> Create(
+      const std::filesystem::path& path);
+
+  // Flushes and closes the file, returning an error if any write failed.
+  absl::Status Close();
+
+ protected:
+  void Append(std::string_view text) final;
+
+ private:
+  explicit FileEmitSink(std::filesystem::path path) : path_(std::move(path)) {}
+
+  std::filesystem::path path_;
+  std::ofstream stream_;
+};
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_CODEGEN_VAST_EMIT_SINK_H_
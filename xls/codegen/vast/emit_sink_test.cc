@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/vast/emit_sink.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/indent.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+TEST(EmitSinkTest, WritesText) {
+  StringEmitSink sink;
+  sink.Write("foo");
+  sink.Write("\nbar\n");
+  EXPECT_EQ(sink.str(), "foo\nbar\n");
+}
+
+TEST(EmitSinkTest, IndentationMatchesIndent) {
+  const std::string text = "begin\n  x = 1;\n\n  y = 2;\nend";
+  StringEmitSink sink;
+  sink.Write("module m;\n");
+  sink.Indent();
+  // Write the text in pieces which split lines to check that indentation is
+  // only applied at the start of each line.
+  sink.Write("beg");
+  sink.Write("in\n  x = 1;\n");
+  sink.Write("\n  y = 2;");
+  sink.Write("\nend");
+  sink.Dedent();
+  sink.Write("\nendmodule");
+  EXPECT_EQ(sink.str(),
+            absl::StrCat("module m;\n", Indent(text), "\nendmodule"));
+}
+
+TEST(EmitSinkTest, ScopedIndentNests) {
+  StringEmitSink sink;
+  {
+    ScopedEmitIndent outer(&sink);
+    sink.Write("a\n");
+    {
+      ScopedEmitIndent inner(&sink, 4);
+      EXPECT_EQ(sink.indentation(), 6);
+      sink.Write("b\n");
+    }
+    sink.Write("c\n");
+  }
+  sink.Write("d");
+  EXPECT_EQ(sink.indentation(), 0);
+  EXPECT_EQ(sink.str(), "  a\n      b\n  c\nd");
+}
+
+TEST(EmitSinkTest, CordSink) {
+  CordEmitSink sink;
+  std::string expected;
+  for (int64_t i = 0; i < 10000; ++i) {
+    std::string line = absl::StrCat("assign x", i, " = y", i, ";\n");
+    sink.Write(line);
+    expected += line;
+  }
+  absl::Cord cord = std::move(sink).Release();
+  EXPECT_EQ(std::string(cord), expected);
+}
+
+TEST(EmitSinkTest, FileSink) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FileEmitSink> sink,
+                           FileEmitSink::Create(file.path()));
+  sink->Write("module m;\n");
+  sink->Indent();
+  sink->Write("wire x;\n");
+  sink->Dedent();
+  sink->Write("endmodule\n");
+  XLS_ASSERT_OK(sink->Close());
+  EXPECT_THAT(GetFileContents(file.path()),
+              IsOkAndHolds("module m;\n  wire x;\nendmodule\n"));
+}
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -36,6 +36,7 @@
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/codegen/module_signature.pb.h"
+#include "xls/codegen/vast/emit_sink.h"
 #include "xls/common/indent.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
@@ -387,16 +388,17 @@ UnpackedArrayType* VerilogFile::UnpackedArrayType(
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit([=](auto* m) { return m->Emit(line_info); }, member);
-  };
+  StringEmitSink sink;
+  EmitTo(&sink, line_info);
+  return std::move(sink).str();
+}
 
-  std::string out;
+void VerilogFile::EmitTo(EmitSink* sink, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit([=](auto* m) { m->EmitTo(sink, line_info); }, member);
+    sink->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name, Expression* value,
@@ -907,55 +909,65 @@ IntegerDef::IntegerDef(std::string_view name, DataType* data_type,
 
 namespace {
 
-// "Match" statement for emitting a ModuleMember.
-std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
-  return absl::visit([=](auto* d) { return d->Emit(line_info); }, member);
-}
-
-// Visitor for emitting a VerilogPackageMember.
-std::string EmitVerilogPackageMember(LineInfo* line_info,
-                                     const VerilogPackageMember& member) {
-  return absl::visit([=](auto* d) { return d->Emit(line_info); }, member);
+// Emits the given node into a string via its EmitTo method.
+std::string EmitToString(const VastNode* node, LineInfo* line_info) {
+  StringEmitSink sink;
+  node->EmitTo(&sink, line_info);
+  return std::move(sink).str();
 }
 
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  return EmitToString(this, line_info);
+}
+
+void ModuleSection::EmitTo(EmitSink* sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool emitted = false;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    if (emitted) {
+      sink->Write("\n");
+    }
+    absl::visit([=](auto* d) { d->EmitTo(sink, line_info); }, member);
     LineInfoIncrease(line_info, 1);
+    emitted = true;
   }
-  if (!elements.empty()) {
+  if (emitted) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string VerilogPackageSection::Emit(LineInfo* line_info) const {
+  return EmitToString(this, line_info);
+}
+
+void VerilogPackageSection::EmitTo(EmitSink* sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool emitted = false;
   for (const VerilogPackageMember& member : members_) {
     if (std::holds_alternative<VerilogPackageSection*>(member)) {
       if (std::get<VerilogPackageSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitVerilogPackageMember(line_info, member));
+    if (emitted) {
+      sink->Write("\n");
+    }
+    absl::visit([=](auto* d) { d->EmitTo(sink, line_info); }, member);
     LineInfoIncrease(line_info, 1);
+    emitted = true;
   }
-  if (!elements.empty()) {
+  if (emitted) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -1094,43 +1106,58 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  return EmitToString(this, line_info);
+}
+
+void Module::EmitTo(EmitSink* sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  sink->Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    sink->Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    sink->Write("(\n  ");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
-                                port.wire->EmitNoSemi(line_info));
-          LineInfoIncrease(line_info, 1);
-        }));
-    absl::StrAppend(&result, "\n);\n");
+    for (int64_t i = 0; i < ports_.size(); ++i) {
+      if (i != 0) {
+        sink->Write(",\n  ");
+      }
+      sink->Write(absl::StrFormat("%s %s", ToString(ports_[i].direction),
+                                  ports_[i].wire->EmitNoSemi(line_info)));
+      LineInfoIncrease(line_info, 1);
+    }
+    sink->Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  {
+    ScopedEmitIndent indent(sink);
+    top_.EmitTo(sink, line_info);
+  }
+  sink->Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  sink->Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string VerilogPackage::Emit(LineInfo* line_info) const {
+  return EmitToString(this, line_info);
+}
+
+void VerilogPackage::EmitTo(EmitSink* sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
 
-  std::string result = absl::StrCat("package ", name_, ";\n");
+  sink->Write(absl::StrCat("package ", name_, ";\n"));
   LineInfoIncrease(line_info, 1);
 
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  {
+    ScopedEmitIndent indent(sink);
+    top_.EmitTo(sink, line_info);
+  }
+  sink->Write("\n");
   LineInfoIncrease(line_info, 1);
 
-  absl::StrAppend(&result, "endpackage");
+  sink->Write("endpackage");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
@@ -39,6 +39,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
+#include "xls/codegen/vast/emit_sink.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -136,6 +137,9 @@ class LineInfo {
   // sequence of calls that does not include negative numbers.
   void Increase(int64_t delta);
 
+  // Returns the current line number, i.e. the number of lines recorded so far.
+  int64_t current_line_number() const { return current_line_number_; }
+
   // Returns the underlying relation between nodes and spans.
   const absl::flat_hash_map<const VastNode*, PartialLineSpans>& Spans() const {
     return spans_;
@@ -169,6 +173,13 @@ class VastNode {
 
   virtual std::string Emit(LineInfo* line_info) const = 0;
 
+  // Emits the node into `sink`. By default this writes the result of `Emit`;
+  // nodes with many children (modules and their sections) override this to
+  // write each child to the sink directly rather than concatenating them.
+  virtual void EmitTo(EmitSink* sink, LineInfo* line_info) const {
+    sink->Write(Emit(line_info));
+  }
+
  private:
   VerilogFile* file_;
   SourceInfo loc_;
@@ -2126,6 +2137,7 @@ class ModuleSection final : public VastNode {
   const std::vector<ModuleMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(EmitSink* sink, LineInfo* line_info) const final;
 
  private:
   std::vector<ModuleMember> members_;
@@ -2224,6 +2236,7 @@ class Module final : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(EmitSink* sink, LineInfo* line_info) const final;
 
  private:
   // Add the given Def as a port on the module.
@@ -2294,6 +2307,7 @@ class VerilogPackageSection final : public VastNode {
   const std::vector<VerilogPackageMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(EmitSink* sink, LineInfo* line_info) const final;
 
  private:
   std::vector<VerilogPackageMember> members_;
@@ -2323,6 +2337,7 @@ class VerilogPackage final : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(EmitSink* sink, LineInfo* line_info) const final;
 
  private:
   std::string name_;
@@ -2377,6 +2392,10 @@ class VerilogFile {
 
   std::string Emit(LineInfo* line_info = nullptr) const;
 
+  // Emits the file into `sink`. This avoids materializing the text of the
+  // entire file, which may be very large, as a single string.
+  void EmitTo(EmitSink* sink, LineInfo* line_info = nullptr) const;
+
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
     return Make<verilog::Slice>(loc, subject, hi, lo);
@@ -26,6 +26,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/codegen/vast/emit_sink.h"
+#include "xls/common/indent.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
@@ -1644,6 +1646,45 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, EmitToSinkMatchesEmit) {
+  VerilogFile f(GetFileType());
+  Module* m = f.AddModule("top", SourceInfo());
+  LogicRef* clk =
+      m->AddInput("clk", f.BitVectorType(1, SourceInfo()), SourceInfo());
+  LogicRef* in =
+      m->AddInput("in", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* out =
+      m->AddOutput("out", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  ModuleSection* section = m->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "registers");
+  LogicRef* r = m->AddReg("r", f.BitVectorType(8, SourceInfo()), SourceInfo(),
+                          /*init=*/nullptr, /*section=*/section);
+  m->Add<BlankLine>(SourceInfo());
+  AlwaysFlop* af = m->Add<AlwaysFlop>(SourceInfo(), clk);
+  af->AddRegister(r, in, SourceInfo());
+  m->Add<ContinuousAssignment>(SourceInfo(), out, r);
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  f.AddModule("empty", SourceInfo());
+
+  LineInfo expected_line_info;
+  std::string expected = f.Emit(&expected_line_info);
+
+  LineInfo line_info;
+  StringEmitSink sink;
+  f.EmitTo(&sink, &line_info);
+  EXPECT_EQ(sink.str(), expected);
+  EXPECT_EQ(line_info.LookupNode(m), expected_line_info.LookupNode(m));
+  EXPECT_EQ(line_info.LookupNode(section),
+            expected_line_info.LookupNode(section));
+  EXPECT_EQ(line_info.LookupNode(af), expected_line_info.LookupNode(af));
+
+  // Emitting into an already indented sink indents the module as a whole.
+  StringEmitSink indented_sink;
+  indented_sink.Indent(4);
+  m->EmitTo(&indented_sink, nullptr);
+  EXPECT_EQ(indented_sink.str(), Indent(m->Emit(nullptr), 4));
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
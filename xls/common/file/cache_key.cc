@@ -0,0 +1,43 @@
+// Copyright 2020 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/cache_key.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "openssl/sha.h"
+
+namespace xls {
+
+std::string CacheKey(absl::Span<const std::string_view> components) {
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  for (std::string_view component : components) {
+    std::string prefix = absl::StrCat(component.size(), ":");
+    SHA256_Update(&ctx, prefix.data(), prefix.size());
+    SHA256_Update(&ctx, component.data(), component.size());
+  }
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256_Final(digest.data(), &ctx);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
+}  // namespace xls
@@ -0,0 +1,33 @@
+// Copyright 2020 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_CACHE_KEY_H_
+#define XLS_COMMON_FILE_CACHE_KEY_H_
+
+#include <string>
+#include <string_view>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+// Returns the hex SHA-256 digest of `components`, for use as the file name of
+// an on-disk cache entry. Each component is length-prefixed before hashing so
+// the concatenation is unambiguous, e.g. {"ab", "c"} and {"a", "bc"} produce
+// different keys.
+std::string CacheKey(absl::Span<const std::string_view> components);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_CACHE_KEY_H_
@@ -0,0 +1,36 @@
+// Copyright 2020 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/cache_key.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(CacheKeyTest, KnownDigest) {
+  // SHA-256 of "3:abc".
+  EXPECT_EQ(CacheKey({"abc"}),
+            "aab5f9ae99b2e38fb462025c8f72f570c9c811705d2a4277dc855d7fa293fe97");
+}
+
+TEST(CacheKeyTest, ComponentBoundariesMatter) {
+  EXPECT_NE(CacheKey({"ab", "c"}), CacheKey({"a", "bc"}));
+  EXPECT_NE(CacheKey({"abc"}), CacheKey({"abc", ""}));
+  EXPECT_EQ(CacheKey({"a", "bc"}), CacheKey({"a", "bc"}));
+}
+
+}  // namespace
+}  // namespace xls
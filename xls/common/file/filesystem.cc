@@ -20,7 +20,9 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>  // NOLINT
 #include <sstream>
@@ -34,6 +36,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/io/tokenizer.h"
 #include "google/protobuf/io/zero_copy_stream_impl_lite.h"
@@ -204,6 +207,25 @@ absl::Status SetFileContents(const std::filesystem::path& file_name,
   return SetFileContentsOrAppend(file_name, content, SetOrAppend::kSet);
 }
 
+absl::Status AtomicSetFileContents(const std::filesystem::path& file_name,
+                                   std::string_view content) {
+  // The process ID keeps names unique across processes and the counter keeps
+  // them unique across calls within one, including concurrent ones.
+  static std::atomic<uint64_t> next_temp_id = 0;
+  std::filesystem::path temp_path = file_name;
+  temp_path += absl::StrFormat(
+      ".tmp.%d.%d", getpid(),
+      next_temp_id.fetch_add(1, std::memory_order_relaxed));
+  absl::Status status = SetFileContents(temp_path, content);
+  if (status.ok() && rename(temp_path.c_str(), file_name.c_str()) == -1) {
+    status = ErrNoToStatusWithFilename(errno, file_name);
+  }
+  if (!status.ok()) {
+    unlink(temp_path.c_str());
+  }
+  return status;
+}
+
 absl::Status AppendStringToFile(const std::filesystem::path& file_name,
                                 std::string_view content) {
   return SetFileContentsOrAppend(file_name, content, SetOrAppend::kAppend);
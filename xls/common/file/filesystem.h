@@ -98,6 +98,16 @@ absl::StatusOr<std::string> GetFileContents(
 absl::Status SetFileContents(const std::filesystem::path& file_name,
                              std::string_view content);
 
+// Atomically replaces the contents of the file `file_name` with `content`.
+//
+// The data is written to a temporary file next to `file_name`, which is then
+// renamed over it, so readers see either the previous file or the complete
+// new one. Each call uses its own temporary file, so concurrent writers of the
+// same path, in this process or others, do not interfere. On failure the
+// temporary file is removed and `file_name` is left untouched.
+absl::Status AtomicSetFileContents(const std::filesystem::path& file_name,
+                                   std::string_view content);
+
 // Writes the contents of data into the file file_name, appending to any
 // existing content.
 //
@@ -21,6 +21,8 @@
 #include <ios>
 #include <string>
 #include <system_error>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -38,6 +40,7 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::AnyOf;
 using ::testing::Contains;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::HasSubstr;
 
@@ -269,6 +272,61 @@ TEST(FilesystemTest, SetFileContentsOfDirectoryFails) {
   EXPECT_THAT(contents, StatusIs(absl::StatusCode::kFailedPrecondition));
 }
 
+TEST(FilesystemTest, AtomicSetFileContentsReplacesFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path file_path = temp_dir.path() / "file";
+
+  XLS_ASSERT_OK(AtomicSetFileContents(file_path, "hello"));
+  EXPECT_THAT(GetFileContents(file_path), IsOkAndHolds("hello"));
+  XLS_ASSERT_OK(AtomicSetFileContents(file_path, "bye"));
+  EXPECT_THAT(GetFileContents(file_path), IsOkAndHolds("bye"));
+
+  // No temporary files are left behind.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path()));
+  EXPECT_THAT(entries, ElementsAre(file_path));
+}
+
+TEST(FilesystemTest, AtomicSetFileContentsFromManyThreads) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path file_path = temp_dir.path() / "file";
+
+  // Every writer's file must be complete, so the result is exactly one of the
+  // contents written.
+  constexpr int kThreadCount = 8;
+  std::vector<std::string> contents;
+  for (int i = 0; i < kThreadCount; ++i) {
+    contents.push_back(std::string(64 * 1024, 'a' + i));
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < 16; ++j) {
+        XLS_EXPECT_OK(AtomicSetFileContents(file_path, contents[i]));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string result, GetFileContents(file_path));
+  EXPECT_THAT(contents, Contains(result));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path()));
+  EXPECT_THAT(entries, ElementsAre(file_path));
+}
+
+TEST(FilesystemTest, AtomicSetFileContentsOfDirectoryFails) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::create_directory(temp_dir.path() / "dir");
+
+  EXPECT_FALSE(AtomicSetFileContents(temp_dir.path() / "dir", "hello").ok());
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path()));
+  EXPECT_THAT(entries, ElementsAre(temp_dir.path() / "dir"));
+}
+
 TEST(FilesystemTest, AppendStringToFileCreatesFileWhenMissing) {
   absl::StatusOr<TempDirectory> temp_dir = TempDirectory::Create();
   XLS_ASSERT_OK(temp_dir);
@@ -0,0 +1,156 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_usage.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/no_destructor.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/memory_profile.pb.h"
+
+ABSL_FLAG(std::string, memory_profile_path, "",
+          "If nonempty, write a profile of the memory usage of the process at "
+          "the end of each of its stages (e.g. parsing, optimization, "
+          "scheduling, codegen, JIT compilation, simulation) to this path as "
+          "a MemoryProfileProto text proto.");
+
+// Defined by tcmalloc, which provides MallocExtension on top of it; null when
+// the binary is not linked with tcmalloc.
+extern "C" bool MallocExtension_Internal_GetNumericProperty(
+    const char* name_data, size_t name_size, size_t* value) ABSL_ATTRIBUTE_WEAK;
+
+namespace xls {
+namespace {
+
+int64_t GetRssBytes() {
+#ifdef __linux__
+  // The second field of statm is the resident set size in pages.
+  absl::StatusOr<std::string> statm = GetFileContents("/proc/self/statm");
+  if (!statm.ok()) {
+    return 0;
+  }
+  std::vector<std::string_view> fields =
+      absl::StrSplit(*statm, ' ', absl::SkipEmpty());
+  int64_t pages;
+  if (fields.size() < 2 || !absl::SimpleAtoi(fields[1], &pages)) {
+    return 0;
+  }
+  return pages * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+std::optional<int64_t> GetHeapAllocatedBytes() {
+  if (&MallocExtension_Internal_GetNumericProperty == nullptr) {
+    return std::nullopt;
+  }
+  constexpr std::string_view kProperty = "generic.current_allocated_bytes";
+  size_t value;
+  if (!MallocExtension_Internal_GetNumericProperty(kProperty.data(),
+                                                   kProperty.size(), &value)) {
+    return std::nullopt;
+  }
+  return static_cast<int64_t>(value);
+}
+
+}  // namespace
+
+int64_t GetPeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // On macOS ru_maxrss is reported in bytes.
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  // On Linux ru_maxrss is reported in kilobytes.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+MemoryUsage GetMemoryUsage() {
+  return MemoryUsage{.rss_bytes = GetRssBytes(),
+                     .peak_rss_bytes = GetPeakRssBytes(),
+                     .heap_allocated_bytes = GetHeapAllocatedBytes()};
+}
+
+void MemoryProfile::EndStage(std::string_view stage) {
+  MemoryUsage usage = GetMemoryUsage();
+  absl::Time end = absl::Now();
+  absl::MutexLock lock(&mutex_);
+  stages_.push_back(
+      Stage{.name = std::string(stage), .end = end, .usage = usage});
+}
+
+MemoryProfileProto MemoryProfile::ToProto() const {
+  MemoryProfileProto profile;
+  absl::MutexLock lock(&mutex_);
+  absl::Time previous_end = start_;
+  int64_t peak_rss_bytes = 0;
+  for (const Stage& stage : stages_) {
+    MemoryStageProfileProto* proto = profile.add_stages();
+    proto->set_stage(stage.name);
+    proto->set_duration_us(
+        absl::ToInt64Microseconds(stage.end - previous_end));
+    proto->set_rss_bytes(stage.usage.rss_bytes);
+    proto->set_peak_rss_bytes(stage.usage.peak_rss_bytes);
+    // The first stage is charged with everything used since the process
+    // started, as there is no earlier measurement to compare against.
+    proto->set_peak_rss_growth_bytes(
+        std::max<int64_t>(0, stage.usage.peak_rss_bytes - peak_rss_bytes));
+    if (stage.usage.heap_allocated_bytes.has_value()) {
+      proto->set_heap_allocated_bytes(*stage.usage.heap_allocated_bytes);
+    }
+    previous_end = stage.end;
+    peak_rss_bytes = std::max(peak_rss_bytes, stage.usage.peak_rss_bytes);
+  }
+  profile.set_peak_rss_bytes(peak_rss_bytes);
+  return profile;
+}
+
+MemoryProfile& ProcessMemoryProfile() {
+  static absl::NoDestructor<MemoryProfile> profile;
+  return *profile;
+}
+
+absl::Status WriteProcessMemoryProfile() {
+  std::string path = absl::GetFlag(FLAGS_memory_profile_path);
+  if (path.empty()) {
+    return absl::OkStatus();
+  }
+  return SetTextProtoFile(path, ProcessMemoryProfile().ToProto());
+}
+
+}  // namespace xls
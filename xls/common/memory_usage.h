@@ -0,0 +1,91 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_MEMORY_USAGE_H_
+#define XLS_COMMON_MEMORY_USAGE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/memory_profile.pb.h"
+
+namespace xls {
+
+// Memory usage of the current process at a point in time.
+struct MemoryUsage {
+  // Current resident memory, or zero if it cannot be determined.
+  int64_t rss_bytes = 0;
+  // High-water mark of the resident memory, or zero if it cannot be
+  // determined.
+  int64_t peak_rss_bytes = 0;
+  // Bytes currently allocated on the heap. Only available when the binary is
+  // linked with tcmalloc.
+  std::optional<int64_t> heap_allocated_bytes;
+};
+
+// Returns the current memory usage of the process.
+MemoryUsage GetMemoryUsage();
+
+// Returns the peak resident memory of the current process in bytes, or zero if
+// it cannot be determined.
+int64_t GetPeakRssBytes();
+
+// Records the memory usage of a process at the boundaries between the stages
+// of its work, so that the stage responsible for its peak memory can be
+// identified. Thread-safe.
+class MemoryProfile {
+ public:
+  MemoryProfile() : start_(absl::Now()) {}
+
+  // Samples the memory usage of the process at the end of a stage named
+  // `stage`.
+  void EndStage(std::string_view stage);
+
+  MemoryProfileProto ToProto() const;
+
+ private:
+  struct Stage {
+    std::string name;
+    absl::Time end;
+    MemoryUsage usage;
+  };
+
+  const absl::Time start_;
+  mutable absl::Mutex mutex_;
+  std::vector<Stage> stages_ ABSL_GUARDED_BY(mutex_);
+};
+
+// The profile of the stages of the current process which tools and libraries
+// record stage boundaries in, and which WriteProcessMemoryProfile() writes out.
+MemoryProfile& ProcessMemoryProfile();
+
+// Abbreviation for ProcessMemoryProfile().EndStage(stage).
+inline void EndMemoryStage(std::string_view stage) {
+  ProcessMemoryProfile().EndStage(stage);
+}
+
+// Writes the process memory profile as a text proto to the path given by
+// --memory_profile_path, if any.
+absl::Status WriteProcessMemoryProfile();
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_MEMORY_USAGE_H_
@@ -0,0 +1,62 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_usage.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/memory_profile.pb.h"
+
+namespace xls {
+namespace {
+
+TEST(MemoryUsageTest, ReportsResidentMemory) {
+  MemoryUsage usage = GetMemoryUsage();
+#ifdef __linux__
+  EXPECT_GT(usage.rss_bytes, 0);
+#endif
+  EXPECT_GT(usage.peak_rss_bytes, 0);
+  EXPECT_GE(usage.peak_rss_bytes, usage.rss_bytes);
+}
+
+TEST(MemoryUsageTest, ProfileRecordsStagesInOrder) {
+  MemoryProfile profile;
+  profile.EndStage("parse");
+  // Touch enough memory that the peak is likely to rise during this stage.
+  auto buffer = std::make_unique<std::vector<int64_t>>(int64_t{1} << 22, 1);
+  profile.EndStage("optimize");
+  buffer.reset();
+  profile.EndStage("codegen");
+
+  MemoryProfileProto proto = profile.ToProto();
+  ASSERT_EQ(proto.stages_size(), 3);
+  EXPECT_EQ(proto.stages(0).stage(), "parse");
+  EXPECT_EQ(proto.stages(1).stage(), "optimize");
+  EXPECT_EQ(proto.stages(2).stage(), "codegen");
+  int64_t peak = 0;
+  for (const MemoryStageProfileProto& stage : proto.stages()) {
+    EXPECT_GE(stage.duration_us(), 0);
+    EXPECT_GE(stage.peak_rss_bytes(), peak);
+    EXPECT_EQ(stage.peak_rss_growth_bytes(), stage.peak_rss_bytes() - peak);
+    peak = stage.peak_rss_bytes();
+  }
+  EXPECT_EQ(proto.peak_rss_bytes(), peak);
+}
+
+}  // namespace
+}  // namespace xls
@@ -23,11 +23,14 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <ctime>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -36,6 +39,8 @@
 #include <vector>
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -175,16 +180,16 @@ absl::StatusOr<pid_t> ExecInChildProcess(
   return pid;
 }
 
-// Takes a list of file descriptor data streams and reads them into a list of
-// strings, one for each provided file descriptor.
+// Takes a list of file descriptor data streams and passes the data read from
+// each to the callback at the same index as it arrives.
 //
-// The 'result' vector is populated with all the data that was read in from the
-// fd's regardless to the status that is returned. Non-OK status will still
-// populate what it can into 'result'.
-absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
-                                 std::vector<std::string>& result) {
+// The callbacks receive all the data that was read in from the fd's
+// regardless to the status that is returned.
+absl::Status ReadFileDescriptors(
+    absl::Span<FileDescriptor*> fds,
+    absl::Span<const SubprocessOutputCallback> callbacks) {
+  CHECK_EQ(fds.size(), callbacks.size());
   absl::FixedArray<char> buffer(4096);
-  result.resize(fds.size());
   std::vector<pollfd> poll_list;
   poll_list.resize(fds.size());
   for (int i = 0; i < fds.size(); i++) {
@@ -226,7 +231,7 @@ absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
           // All data is read.
           close_fd_by_index(i);
         } else if (bytes > 0) {
-          result[i].append(buffer.data(), bytes);
+          callbacks[i](std::string_view(buffer.data(), bytes));
         } else if (errno != EINTR) {
           close_fd_by_index(i);
         }
@@ -250,12 +255,30 @@ absl::StatusOr<int> WaitForPid(pid_t pid) {
   return wait_status;
 }
 
-}  // namespace
+// Waits for a process to finish without reaping it, so its pid cannot be
+// reused until WaitForPid is called.
+absl::Status WaitForExitWithoutReaping(pid_t pid) {
+  siginfo_t info;
+  while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1) {
+    if (errno == EINTR) {
+      continue;
+    }
+    return absl::InternalError(
+        absl::StrCat("waitid failed: ", Strerror(errno)));
+  }
+  return absl::OkStatus();
+}
 
-absl::StatusOr<SubprocessResult> InvokeSubprocess(
+// A spawned subprocess along with the pipes its output is read from.
+struct Child {
+  pid_t pid;
+  Pipe stdout_pipe;
+  Pipe stderr_pipe;
+};
+
+absl::StatusOr<Child> SpawnChild(
     absl::Span<const std::string> argv,
-    std::optional<std::filesystem::path> cwd,
-    std::optional<absl::Duration> optional_timeout) {
+    const std::optional<std::filesystem::path>& cwd) {
   if (argv.empty()) {
     return absl::InvalidArgumentError("Cannot invoke empty argv list.");
   }
@@ -278,6 +301,43 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
 
   XLS_ASSIGN_OR_RETURN(pid_t pid, ExecInChildProcess(argv_pointers, cwd,
                                                      stdout_pipe, stderr_pipe));
+  return Child{.pid = pid,
+               .stdout_pipe = std::move(stdout_pipe),
+               .stderr_pipe = std::move(stderr_pipe)};
+}
+
+// Reads the output of `child` into the given callbacks, or into
+// `stdout_content` and `stderr_content` for callbacks that are not set.
+void ReadChildOutput(Child& child, std::string_view bin_name,
+                     const SubprocessOutputCallback& stdout_callback,
+                     const SubprocessOutputCallback& stderr_callback,
+                     std::string& stdout_content,
+                     std::string& stderr_content) {
+  SubprocessOutputCallback callbacks[] = {stdout_callback, stderr_callback};
+  if (!callbacks[0]) {
+    callbacks[0] = [&](std::string_view data) { stdout_content.append(data); };
+  }
+  if (!callbacks[1]) {
+    callbacks[1] = [&](std::string_view data) { stderr_content.append(data); };
+  }
+  FileDescriptor* fds[] = {&child.stdout_pipe.exit, &child.stderr_pipe.exit};
+  absl::Status read_status = ReadFileDescriptors(fds, callbacks);
+  if (!read_status.ok()) {
+    VLOG(1) << "ReadFileDescriptors non-ok status: " << read_status;
+  }
+
+  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stdout:\n ", stdout_content));
+  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stderr:\n ", stderr_content));
+}
+
+}  // namespace
+
+absl::StatusOr<SubprocessResult> InvokeSubprocess(
+    absl::Span<const std::string> argv,
+    std::optional<std::filesystem::path> cwd,
+    std::optional<absl::Duration> optional_timeout) {
+  XLS_ASSIGN_OR_RETURN(Child child, SpawnChild(argv, cwd));
+  pid_t pid = child.pid;
 
   // Order is important here. The optional<Thread> must appear after the mutex
   // because the thread's destructor calls Join() and because the thread has
@@ -311,17 +371,10 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   }
 
   // Read from the output streams of the subprocess.
-  FileDescriptor* fds[] = {&stdout_pipe.exit, &stderr_pipe.exit};
-  std::vector<std::string> output_strings;
-  absl::Status read_status = ReadFileDescriptors(fds, output_strings);
-  if (!read_status.ok()) {
-    VLOG(1) << "ReadFileDescriptors non-ok status: " << read_status;
-  }
-  const std::string& stdout_output = output_strings[0];
-  const std::string& stderr_output = output_strings[1];
-
-  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stdout:\n ", stdout_output));
-  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stderr:\n ", stderr_output));
+  std::string stdout_output;
+  std::string stderr_output;
+  ReadChildOutput(child, std::filesystem::path(argv[0]).filename().string(),
+                  nullptr, nullptr, stdout_output, stderr_output);
 
   XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(pid));
 
@@ -337,6 +390,136 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
                           .timeout_expired = timeout_expired.load()};
 }
 
+const absl::StatusOr<SubprocessResult>& SubprocessFuture::Get() const {
+  absl::MutexLock lock(&state_->mutex);
+  state_->mutex.Await(absl::Condition(
+      +[](std::optional<absl::StatusOr<SubprocessResult>>* result) {
+        return result->has_value();
+      },
+      &state_->result));
+  // The result is never modified once set, so it's safe to refer to it
+  // without holding the lock.
+  return *state_->result;
+}
+
+bool SubprocessFuture::IsReady() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->result.has_value();
+}
+
+SubprocessPool::SubprocessPool(int64_t max_concurrency) {
+  CHECK_GT(max_concurrency, 0);
+  workers_.reserve(max_concurrency);
+  for (int64_t i = 0; i < max_concurrency; ++i) {
+    workers_.push_back(std::make_unique<Thread>([this] { WorkerLoop(); }));
+  }
+  watchdog_ = std::make_unique<Thread>([this] { WatchdogLoop(); });
+}
+
+SubprocessPool::~SubprocessPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutting_down_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+  watchdog_->Join();
+}
+
+SubprocessFuture SubprocessPool::Submit(SubprocessRequest request) {
+  auto state = std::make_shared<SubprocessFuture::State>();
+  absl::MutexLock lock(&mutex_);
+  queue_.push_back(Task{.request = std::move(request), .state = state});
+  return SubprocessFuture(std::move(state));
+}
+
+void SubprocessPool::WorkerLoop() {
+  while (true) {
+    Task task;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto has_work = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+        return !queue_.empty() || shutting_down_;
+      };
+      mutex_.Await(absl::Condition(&has_work));
+      // Drain the queue before shutting down so every future gets a result.
+      if (queue_.empty()) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    absl::StatusOr<SubprocessResult> result = Run(task.request);
+    absl::MutexLock lock(&task.state->mutex);
+    task.state->result = std::move(result);
+  }
+}
+
+void SubprocessPool::WatchdogLoop() {
+  absl::MutexLock lock(&mutex_);
+  while (!shutting_down_) {
+    absl::Time next_deadline = absl::InfiniteFuture();
+    for (const auto& [pid, deadline] : deadlines_) {
+      next_deadline = std::min(next_deadline, deadline);
+    }
+    int64_t generation = deadlines_generation_;
+    auto changed = [this, generation]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return shutting_down_ || deadlines_generation_ != generation;
+    };
+    mutex_.AwaitWithDeadline(absl::Condition(&changed), next_deadline);
+
+    absl::Time now = absl::Now();
+    absl::erase_if(deadlines_, [&](const auto& entry) {
+      const auto& [pid, deadline] = entry;
+      if (deadline > now) {
+        return false;
+      }
+      // The worker doesn't reap the child until it has removed its deadline,
+      // so `pid` still refers to the child.
+      timed_out_.insert(pid);
+      if (kill(pid, SIGKILL) == 0) {
+        VLOG(1) << "Watchdog killed " << pid;
+      }
+      return true;
+    });
+  }
+}
+
+absl::StatusOr<SubprocessResult> SubprocessPool::Run(
+    const SubprocessRequest& request) {
+  XLS_ASSIGN_OR_RETURN(Child child, SpawnChild(request.argv, request.cwd));
+  if (request.timeout.has_value() && *request.timeout > absl::ZeroDuration()) {
+    absl::MutexLock lock(&mutex_);
+    deadlines_[child.pid] = absl::Now() + *request.timeout;
+    ++deadlines_generation_;
+  }
+
+  std::string stdout_content;
+  std::string stderr_content;
+  ReadChildOutput(child,
+                  std::filesystem::path(request.argv[0]).filename().string(),
+                  request.stdout_callback, request.stderr_callback,
+                  stdout_content, stderr_content);
+
+  XLS_RETURN_IF_ERROR(WaitForExitWithoutReaping(child.pid));
+  bool timeout_expired;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (deadlines_.erase(child.pid) > 0) {
+      ++deadlines_generation_;
+    }
+    timeout_expired = timed_out_.erase(child.pid) > 0;
+  }
+  XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(child.pid));
+
+  return SubprocessResult{.stdout_content = std::move(stdout_content),
+                          .stderr_content = std::move(stderr_content),
+                          .exit_status = WEXITSTATUS(wait_status),
+                          .normal_termination = WIFEXITED(wait_status),
+                          .timeout_expired = timeout_expired};
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> SubprocessResultToStrings(
     absl::StatusOr<SubprocessResult> result) {
   if (result.ok()) {
@@ -15,16 +15,29 @@
 #ifndef XLS_COMMON_SUBPROCESS_H_
 #define XLS_COMMON_SUBPROCESS_H_
 
+#include <sys/types.h>
+
+#include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 
@@ -97,5 +110,100 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     std::optional<std::filesystem::path> cwd = std::nullopt,
     std::optional<absl::Duration> optional_timeout = std::nullopt);
 
+// Receives a chunk of a subprocess's output as soon as it is read.
+using SubprocessOutputCallback = std::function<void(std::string_view)>;
+
+// A subprocess to run in a SubprocessPool; the fields are as for
+// InvokeSubprocess.
+struct SubprocessRequest {
+  std::vector<std::string> argv;
+  std::optional<std::filesystem::path> cwd;
+  std::optional<absl::Duration> timeout;
+
+  // If set, the corresponding output stream is passed to the callback as it
+  // is produced, from one of the pool's threads, instead of being collected
+  // into the result.
+  SubprocessOutputCallback stdout_callback;
+  SubprocessOutputCallback stderr_callback;
+};
+
+// The eventual result of a subprocess submitted to a SubprocessPool. Copies
+// refer to the same result.
+class SubprocessFuture {
+ public:
+  // Blocks until the subprocess has finished and returns its result.
+  const absl::StatusOr<SubprocessResult>& Get() const;
+
+  // Returns whether Get() would return without blocking.
+  bool IsReady() const;
+
+ private:
+  friend class SubprocessPool;
+
+  struct State {
+    mutable absl::Mutex mutex;
+    std::optional<absl::StatusOr<SubprocessResult>> result
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  explicit SubprocessFuture(std::shared_ptr<State> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<State> state_;
+};
+
+// Runs subprocesses asynchronously with at most `max_concurrency` of them
+// alive at once. A fixed set of worker threads is shared by every subprocess
+// and a single thread enforces all timeouts, so the cost of managing children
+// does not grow with the number submitted.
+//
+// Ex:
+//   SubprocessPool pool(/*max_concurrency=*/8);
+//   std::vector<SubprocessFuture> futures;
+//   for (const std::vector<std::string>& argv : commands) {
+//     futures.push_back(pool.Submit({.argv = argv}));
+//   }
+//   for (const SubprocessFuture& future : futures) {
+//     XLS_RETURN_IF_ERROR(SubprocessErrorAsStatus(future.Get()).status());
+//   }
+class SubprocessPool {
+ public:
+  explicit SubprocessPool(int64_t max_concurrency = AvailableCPUs());
+
+  // Waits for every submitted subprocess to finish.
+  ~SubprocessPool();
+
+  SubprocessPool(const SubprocessPool&) = delete;
+  SubprocessPool& operator=(const SubprocessPool&) = delete;
+
+  // Queues the subprocess to run as soon as fewer than `max_concurrency` are
+  // running.
+  SubprocessFuture Submit(SubprocessRequest request);
+
+ private:
+  struct Task {
+    SubprocessRequest request;
+    std::shared_ptr<SubprocessFuture::State> state;
+  };
+
+  void WorkerLoop();
+  void WatchdogLoop();
+  absl::StatusOr<SubprocessResult> Run(const SubprocessRequest& request);
+
+  absl::Mutex mutex_;
+  std::deque<Task> queue_ ABSL_GUARDED_BY(mutex_);
+  bool shutting_down_ ABSL_GUARDED_BY(mutex_) = false;
+  // Deadlines of running subprocesses with a timeout, and the subprocesses the
+  // watchdog has killed for exceeding theirs.
+  absl::flat_hash_map<pid_t, absl::Time> deadlines_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_set<pid_t> timed_out_ ABSL_GUARDED_BY(mutex_);
+  int64_t deadlines_generation_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Declared last so the threads are joined before the state they use is
+  // destroyed.
+  std::vector<std::unique_ptr<Thread>> workers_;
+  std::unique_ptr<Thread> watchdog_;
+};
+
 }  // namespace xls
 #endif  // XLS_COMMON_SUBPROCESS_H_
@@ -16,12 +16,15 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
@@ -186,5 +189,73 @@ TEST(SubprocessTest, ResultsUnpackToStringPair) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("bad arg")));
 }
 
+TEST(SubprocessPoolTest, RunsAllSubmittedSubprocesses) {
+  SubprocessPool pool(/*max_concurrency=*/4);
+  std::vector<SubprocessFuture> futures;
+  for (int i = 0; i < 16; ++i) {
+    futures.push_back(pool.Submit(
+        {.argv = {"/usr/bin/env", "bash", "-c",
+                  absl::StrCat("echo -n ", i, " && exit ", i % 3)}}));
+  }
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_THAT(futures[i].Get(),
+                IsOkAndHolds(FieldsAre(
+                    /*stdout_content=*/absl::StrCat(i),
+                    /*stderr_content=*/"",
+                    /*exit_status=*/i % 3,
+                    /*normal_termination=*/true,
+                    /*timeout_expired=*/false)));
+    EXPECT_TRUE(futures[i].IsReady());
+  }
+}
+
+TEST(SubprocessPoolTest, StreamsOutputToCallbacks) {
+  SubprocessPool pool(/*max_concurrency=*/1);
+  std::string streamed_stdout;
+  SubprocessFuture future = pool.Submit(
+      {.argv = {"/usr/bin/env", "bash", "-c",
+                "/usr/bin/env seq 10000 && echo hello >&2"},
+       .stdout_callback = [&](std::string_view data) {
+         streamed_stdout.append(data);
+       }});
+
+  EXPECT_THAT(future.Get(), IsOkAndHolds(FieldsAre(
+                                /*stdout_content=*/"",
+                                /*stderr_content=*/"hello\n",
+                                /*exit_status=*/0,
+                                /*normal_termination=*/true,
+                                /*timeout_expired=*/false)));
+  EXPECT_THAT(streamed_stdout, HasSubstr("\n10000\n"));
+}
+
+TEST(SubprocessPoolTest, WatchdogWorks) {
+  SubprocessPool pool(/*max_concurrency=*/2);
+  SubprocessFuture slow =
+      pool.Submit({.argv = {"/usr/bin/env", "bash", "-c", "sleep 10"},
+                   .timeout = absl::Milliseconds(50)});
+  SubprocessFuture fast =
+      pool.Submit({.argv = {"/usr/bin/env", "bash", "-c", "exit 0"},
+                   .timeout = absl::Seconds(60)});
+
+  EXPECT_THAT(slow.Get(), IsOkAndHolds(FieldsAre(
+                              /*stdout_content=*/"",
+                              /*stderr_content=*/"",
+                              /*exit_status=*/_,
+                              /*normal_termination=*/false,
+                              /*timeout_expired=*/true)));
+  EXPECT_THAT(fast.Get(), IsOkAndHolds(FieldsAre(
+                              /*stdout_content=*/"",
+                              /*stderr_content=*/"",
+                              /*exit_status=*/0,
+                              /*normal_termination=*/true,
+                              /*timeout_expired=*/false)));
+}
+
+TEST(SubprocessPoolTest, EmptyArgvFails) {
+  SubprocessPool pool(/*max_concurrency=*/1);
+  EXPECT_THAT(pool.Submit({}).Get(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,209 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/thread.h"
+
+ABSL_FLAG(int64_t, xls_threads, 0,
+          "Number of threads used for parallel work. Zero means one per "
+          "available CPU.");
+
+namespace xls {
+namespace {
+
+// The pool and queue index of the pool thread running on this thread, if any.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local int64_t current_queue = 0;
+
+// How long TaskGroup::Wait blocks before looking for pool tasks to help with.
+constexpr absl::Duration kWaitPollInterval = absl::Milliseconds(1);
+
+}  // namespace
+
+int64_t XlsThreadCount() {
+  int64_t threads = absl::GetFlag(FLAGS_xls_threads);
+  if (threads > 0) {
+    return threads;
+  }
+  return std::max(AvailableCPUs(), 1);
+}
+
+ThreadPool::ThreadPool(int64_t thread_count) {
+  thread_count = std::max<int64_t>(thread_count, 1);
+  queues_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  threads_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(
+        std::make_unique<Thread>([this, i]() { WorkerLoop(i); }));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  for (std::unique_ptr<Thread>& thread : threads_) {
+    thread->Join();
+  }
+}
+
+void ThreadPool::Schedule(Task task) {
+  if (current_pool == this) {
+    TaskQueue& queue = *queues_[current_queue];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_front(std::move(task));
+  } else {
+    TaskQueue& queue =
+        *queues_[next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                 queues_.size()];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  absl::MutexLock lock(&mutex_);
+  ++pending_task_count_;
+}
+
+bool ThreadPool::InPoolThread() const { return current_pool == this; }
+
+bool ThreadPool::RunPendingTask() {
+  std::optional<Task> task =
+      TakeTask(current_pool == this ? current_queue : 0);
+  if (!task.has_value()) {
+    return false;
+  }
+  std::move(*task)();
+  return true;
+}
+
+std::optional<ThreadPool::Task> ThreadPool::TakeTask(int64_t index) {
+  std::optional<Task> task;
+  for (int64_t i = 0; i < queues_.size() && !task.has_value(); ++i) {
+    TaskQueue& queue = *queues_[(index + i) % queues_.size()];
+    absl::MutexLock lock(&queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    // Threads run their own most recently scheduled tasks first, which are
+    // the most likely to be cache-warm, and steal the oldest tasks of others.
+    if (i == 0) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    } else {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+  }
+  if (task.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    --pending_task_count_;
+  }
+  return task;
+}
+
+bool ThreadPool::HasTasksOrStopping() const {
+  return pending_task_count_ > 0 || stopping_;
+}
+
+void ThreadPool::WorkerLoop(int64_t index) {
+  current_pool = this;
+  current_queue = index;
+  while (true) {
+    if (std::optional<Task> task = TakeTask(index); task.has_value()) {
+      std::move(*task)();
+      continue;
+    }
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &ThreadPool::HasTasksOrStopping));
+    if (stopping_ && pending_task_count_ == 0) {
+      return;
+    }
+  }
+}
+
+ThreadPool& SharedThreadPool() {
+  static ThreadPool* pool = new ThreadPool(XlsThreadCount());
+  return *pool;
+}
+
+TaskGroup::~TaskGroup() { Wait().IgnoreError(); }
+
+void TaskGroup::Schedule(ThreadPool::Task task) {
+  if (cancelled()) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    ++pending_task_count_;
+  }
+  pool_.Schedule([this, task = std::move(task)]() mutable {
+    if (!cancelled()) {
+      std::move(task)();
+    }
+    absl::MutexLock lock(&mutex_);
+    --pending_task_count_;
+  });
+}
+
+absl::Status TaskGroup::Wait(absl::Time deadline) {
+  const bool help = pool_.InPoolThread();
+  bool deadline_exceeded = false;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (Done()) {
+        break;
+      }
+    }
+    if (!deadline_exceeded && absl::Now() >= deadline) {
+      Cancel();
+      deadline_exceeded = true;
+    }
+    if (help && pool_.RunPendingTask()) {
+      continue;
+    }
+    absl::Time poll_deadline = absl::Now() + kWaitPollInterval;
+    if (!deadline_exceeded) {
+      poll_deadline = std::min(poll_deadline, deadline);
+    }
+    absl::MutexLock lock(&mutex_);
+    mutex_.AwaitWithDeadline(absl::Condition(this, &TaskGroup::Done),
+                             poll_deadline);
+  }
+  if (deadline_exceeded) {
+    return absl::DeadlineExceededError(
+        "Tasks did not finish before the deadline");
+  }
+  if (cancelled()) {
+    return absl::CancelledError("Tasks were cancelled");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,138 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_THREAD_POOL_H_
+#define XLS_COMMON_THREAD_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/thread.h"
+
+// Number of threads used for parallel work throughout XLS. Zero means one per
+// available CPU.
+ABSL_DECLARE_FLAG(int64_t, xls_threads);
+
+namespace xls {
+
+// Returns the number of threads parallel work should use: the value of
+// --xls_threads, or the number of available CPUs if it is zero.
+int64_t XlsThreadCount();
+
+// Work-stealing pool of threads. Each thread has its own queue of tasks; tasks
+// scheduled from a pool thread go to the front of that thread's queue and
+// idle threads steal from the backs of the others'. The destructor runs all
+// scheduled tasks before joining the threads.
+class ThreadPool {
+ public:
+  using Task = absl::AnyInvocable<void() &&>;
+
+  explicit ThreadPool(int64_t thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int64_t thread_count() const { return queues_.size(); }
+
+  void Schedule(Task task);
+
+  // Returns whether the calling thread is one of this pool's threads.
+  bool InPoolThread() const;
+
+  // Runs one scheduled task on the calling thread, if there is any. Returns
+  // whether a task ran. Lets pool threads waiting on other tasks help with
+  // them rather than block.
+  bool RunPendingTask();
+
+ private:
+  struct TaskQueue {
+    absl::Mutex mutex;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  // Takes a task from the queue of thread `index`, or steals one from another
+  // thread's queue if that is empty.
+  std::optional<Task> TakeTask(int64_t index);
+  void WorkerLoop(int64_t index);
+  bool HasTasksOrStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::unique_ptr<Thread>> threads_;
+  std::atomic<int64_t> next_queue_ = 0;
+
+  absl::Mutex mutex_;
+  int64_t pending_task_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// Returns the pool shared by the whole process, created on first use with
+// XlsThreadCount() threads. Passes, schedulers, compilers and runtimes should
+// schedule their parallel work here rather than starting their own threads
+// so that together they do not oversubscribe the machine.
+ThreadPool& SharedThreadPool();
+
+// A set of tasks on a thread pool which are waited for and cancelled together.
+//
+// Cancellation is cooperative: tasks which have not started when the group is
+// cancelled are skipped, and long-running tasks should poll `cancelled()`.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool = SharedThreadPool()) : pool_(pool) {}
+  // Waits for the tasks; see Wait.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Schedules `task` on the pool. Does nothing if the group is cancelled.
+  void Schedule(ThreadPool::Task task);
+
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+  bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+  // Waits until every scheduled task has finished or been skipped. If
+  // `deadline` passes first, the group is cancelled and, once its running
+  // tasks finish, a DeadlineExceeded error is returned. Returns a Cancelled
+  // error if the group was cancelled otherwise.
+  //
+  // Called from a thread of the pool, it runs pool tasks in the meantime so
+  // that nested waits cannot starve the pool; the deadline is then only
+  // checked between tasks.
+  absl::Status Wait(absl::Time deadline = absl::InfiniteFuture());
+
+ private:
+  bool Done() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_task_count_ == 0;
+  }
+
+  ThreadPool& pool_;
+  std::atomic<bool> cancelled_ = false;
+  absl::Mutex mutex_;
+  int64_t pending_task_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_THREAD_POOL_H_
@@ -0,0 +1,121 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+TEST(ThreadPoolTest, XlsThreadCount) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_xls_threads, 3);
+  EXPECT_EQ(XlsThreadCount(), 3);
+  absl::SetFlag(&FLAGS_xls_threads, 0);
+  EXPECT_GE(XlsThreadCount(), 1);
+}
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+  ThreadPool pool(4);
+  std::atomic<int64_t> sum = 0;
+  {
+    TaskGroup group(pool);
+    for (int64_t i = 1; i <= 100; ++i) {
+      group.Schedule([&sum, i]() { sum += i; });
+    }
+    XLS_EXPECT_OK(group.Wait());
+  }
+  EXPECT_EQ(sum, 5050);
+}
+
+TEST(ThreadPoolTest, NestedWaitsDoNotDeadlock) {
+  // With a single thread the outer tasks can only finish if waiting on the
+  // inner groups runs their tasks.
+  ThreadPool pool(1);
+  std::atomic<int64_t> count = 0;
+  TaskGroup outer(pool);
+  for (int64_t i = 0; i < 4; ++i) {
+    outer.Schedule([&]() {
+      TaskGroup inner(pool);
+      for (int64_t j = 0; j < 4; ++j) {
+        inner.Schedule([&count]() { ++count; });
+      }
+      XLS_EXPECT_OK(inner.Wait());
+    });
+  }
+  XLS_EXPECT_OK(outer.Wait());
+  EXPECT_EQ(count, 16);
+}
+
+TEST(ThreadPoolTest, CancelSkipsTasksNotStarted) {
+  ThreadPool pool(1);
+  absl::Notification started;
+  absl::Notification release;
+  std::atomic<int64_t> count = 0;
+  TaskGroup group(pool);
+  group.Schedule([&]() {
+    started.Notify();
+    release.WaitForNotification();
+  });
+  started.WaitForNotification();
+  for (int64_t i = 0; i < 10; ++i) {
+    group.Schedule([&count]() { ++count; });
+  }
+  group.Cancel();
+  release.Notify();
+  EXPECT_THAT(group.Wait(), StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_EQ(count, 0);
+}
+
+TEST(ThreadPoolTest, WaitWithDeadlineCancelsGroup) {
+  ThreadPool pool(2);
+  TaskGroup group(pool);
+  // Runs until the group is cancelled.
+  group.Schedule([&group]() {
+    while (!group.cancelled()) {
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+  });
+  EXPECT_THAT(group.Wait(absl::Now() + absl::Milliseconds(10)),
+              StatusIs(absl::StatusCode::kDeadlineExceeded));
+  EXPECT_TRUE(group.cancelled());
+}
+
+TEST(ThreadPoolTest, DestructorRunsScheduledTasks) {
+  std::atomic<int64_t> count = 0;
+  {
+    ThreadPool pool(2);
+    for (int64_t i = 0; i < 10; ++i) {
+      pool.Schedule([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 10);
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,11 +14,15 @@
 
 #include "xls/contrib/integrator/integration_algorithms/basic_integration_algorithm.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
@@ -36,12 +40,42 @@ void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
       integration_function_->AllOperandsHaveMapping(node)) {
     ready_nodes_.push_back(node);
     queued_nodes_.insert(node);
+    ready_node_signatures_[node] =
+        IntegrationFunction::GetMergeSignature(node);
+  }
+}
+
+void BasicIntegrationAlgorithm::AddMappingTarget(Node* node) {
+  std::vector<Node*>& targets =
+      mapping_targets_by_signature_[IntegrationFunction::GetMergeSignature(
+          node)];
+  if (!absl::c_linear_search(targets, node)) {
+    targets.push_back(node);
+  }
+}
+
+void BasicIntegrationAlgorithm::RemoveMappingTarget(Node* node) {
+  auto it = mapping_targets_by_signature_.find(
+      IntegrationFunction::GetMergeSignature(node));
+  if (it == mapping_targets_by_signature_.end()) {
+    return;
+  }
+  std::vector<Node*>& targets = it->second;
+  targets.erase(std::remove(targets.begin(), targets.end(), node),
+                targets.end());
+  if (targets.empty()) {
+    mapping_targets_by_signature_.erase(it);
   }
 }
 
 absl::Status BasicIntegrationAlgorithm::Initialize() {
   // Make integration function.
   XLS_ASSIGN_OR_RETURN(integration_function_, NewIntegrationFunction());
+  for (Node* node : integration_function_->function()->nodes()) {
+    if (integration_function_->IsMappingTarget(node)) {
+      AddMappingTarget(node);
+    }
+  }
 
   // ID initial nodes with all operands ready.
   for (const Function* func : source_functions_) {
@@ -67,14 +101,16 @@ BasicIntegrationAlgorithm::Run() {
         move = MakeInsertMove(node_itr, insert_cost);
       }
 
-      // Check merge cost.
-      for (Node* internal_node : integration_function_->function()->nodes()) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes.
-        if (!integration_function_->IsMappingTarget(internal_node)) {
-          continue;
-        }
-
+      // Check merge cost. Only mapping targets with the same merge signature
+      // can be merged with the node.
+      // TODO(jbaileyhandle): Relax the requirement that merged nodes are
+      // mapping targets so that it only applies to integration-generated muxes.
+      auto targets_it = mapping_targets_by_signature_.find(
+          ready_node_signatures_.at(*node_itr));
+      if (targets_it == mapping_targets_by_signature_.end()) {
+        continue;
+      }
+      for (Node* internal_node : targets_it->second) {
         // Check if mergeable
         XLS_ASSIGN_OR_RETURN(
             std::optional<int64_t> merge_cost,
@@ -93,10 +129,19 @@ BasicIntegrationAlgorithm::Run() {
 
     // Execute lowest-cost move.
     XLS_RET_CHECK(move.has_value());
-    XLS_RETURN_IF_ERROR(
-        ExecuteMove(integration_function_.get(), move.value()).status());
+    if (move.value().move_type == IntegrationMoveType::kMerge) {
+      // The integration node is replaced by the result of the merge.
+      RemoveMappingTarget(move.value().merge_node);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> targets,
+        ExecuteMove(integration_function_.get(), move.value()));
+    for (Node* target : targets) {
+      AddMappingTarget(target);
+    }
 
     // Update ready_nodes_.
+    ready_node_signatures_.erase(move.value().node);
     ready_nodes_.erase(move.value().node_itr);
     for (Node* user : move.value().node->users()) {
       EnqueueNodeIfReady(user);
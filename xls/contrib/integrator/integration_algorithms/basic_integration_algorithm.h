@@ -19,7 +19,10 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -36,7 +39,9 @@ namespace xls {
 // integration function when all of its operands have already been added.
 // At each step, adds the eligible node for which the cost of adding it to
 // the function (either by inserting or merging with any integeration function
-// node) is the lowest.
+// node) is the lowest. Merges are only evaluated with integration function
+// nodes of the same merge signature (see
+// IntegrationFunction::GetMergeSignature).
 class BasicIntegrationAlgorithm
     : public IntegrationAlgorithm<BasicIntegrationAlgorithm> {
  public:
@@ -94,6 +99,11 @@ class BasicIntegrationAlgorithm
   // and node has not already been queued for processing.
   void EnqueueNodeIfReady(Node* node);
 
+  // Add (if not already present) or remove a mapping target of
+  // integration_function_ in mapping_targets_by_signature_.
+  void AddMappingTarget(Node* node);
+  void RemoveMappingTarget(Node* node);
+
   // Track nodes for which all operands are already mapped and
   // are ready to be added to the integration_function_
   std::list<Node*> ready_nodes_;
@@ -101,6 +111,15 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Merge signatures of the nodes in 'ready_nodes_'.
+  absl::flat_hash_map<const Node*, std::string> ready_node_signatures_;
+
+  // Mapping targets of integration_function_ grouped by merge signature, each
+  // group in the order the nodes appear in the integration function. Kept up
+  // to date as moves are executed rather than rebuilt for every move.
+  absl::flat_hash_map<std::string, std::vector<Node*>>
+      mapping_targets_by_signature_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
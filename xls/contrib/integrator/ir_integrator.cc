@@ -630,7 +630,8 @@ IntegrationFunction::MergeNodesBackend(const Node* node_a, const Node* node_b) {
     }
   }
 
-  // Identical nodes can always be merged.
+  // Identical nodes can always be merged. Note that GetMergeSignature must
+  // distinguish any nodes which cannot be merged here.
   if (node_a->IsDefinitelyEqualTo(node_b)) {
     XLS_ASSIGN_OR_RETURN(UnifiedOperands unified_operands,
                          UnifyNodeOperands(node_a, node_b));
@@ -655,6 +656,21 @@ IntegrationFunction::MergeNodesBackend(const Node* node_a, const Node* node_b) {
   return MergeNodesBackendResult{.can_merge = false};
 }
 
+/* static */ std::string IntegrationFunction::GetMergeSignature(
+    const Node* node) {
+  // Mirrors Node::IsDefinitelyEqualTo, which side-effecting nodes only satisfy
+  // for themselves.
+  if (OpIsSideEffecting(node->op())) {
+    return absl::StrCat("node ", node->id());
+  }
+  std::string signature =
+      absl::StrCat(OpToString(node->op()), " ", node->GetType()->ToString());
+  for (const Node* operand : node->operands()) {
+    absl::StrAppend(&signature, " ", operand->GetType()->ToString());
+  }
+  return signature;
+}
+
 absl::StatusOr<std::optional<int64_t>> IntegrationFunction::GetMergeNodesCost(
     const Node* node_a, const Node* node_b) {
   XLS_ASSIGN_OR_RETURN(MergeNodesBackendResult merge_result,
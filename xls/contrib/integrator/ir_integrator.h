@@ -81,6 +81,11 @@ class IntegrationFunction {
   absl::StatusOr<std::optional<int64_t>> GetMergeNodesCost(const Node* node_a,
                                                            const Node* node_b);
 
+  // Returns a summary of the structure of 'node' such that two different nodes
+  // can only be merged if their signatures are equal. Lets integration
+  // algorithms skip evaluating merges which cannot succeed.
+  static std::string GetMergeSignature(const Node* node);
+
   // Merge node_a and node_b. Operands are automatically multiplexed.
   // Returns the nodes that node_a and node_b map to after merging (vector
   // contains a single node if they map to the same node).
@@ -2862,5 +2862,25 @@ TEST_F(IntegratorTest, NodeSourceFunctionsCollideTest) {
       IsOkAndHolds(true));
 }
 
+TEST_F(IntegratorTest, MergeSignature) {
+  auto p = CreatePackage();
+  FunctionBuilder fb("func", p.get());
+  BValue a = fb.Param("a", p->GetBitsType(8));
+  BValue b = fb.Param("b", p->GetBitsType(8));
+  BValue c = fb.Param("c", p->GetBitsType(16));
+  BValue add_ab = fb.Add(a, b);
+  BValue add_ba = fb.Add(b, a);
+  BValue sub_ab = fb.Subtract(a, b);
+  BValue add_cc = fb.Add(c, c);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  auto signature = [](BValue v) {
+    return IntegrationFunction::GetMergeSignature(v.node());
+  };
+  EXPECT_EQ(signature(add_ab), signature(add_ba));
+  EXPECT_NE(signature(add_ab), signature(sub_ab));
+  EXPECT_NE(signature(add_ab), signature(add_cc));
+}
+
 }  // namespace
 }  // namespace xls
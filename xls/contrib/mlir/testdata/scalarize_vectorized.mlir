@@ -0,0 +1,40 @@
+// RUN: xls/contrib/mlir/xls_opt -scalarize="vectorize-elementwise=true" %s 2>&1 | FileCheck %s
+
+// CHECK-LABEL: @elementwise
+// CHECK: %[[ZERO:.*]] = "xls.array_zero"() : () -> !xls.array<1024 x i32>
+// CHECK: %[[RESULT:.*]] = xls.for inits(%[[ZERO]]) invariants(%arg0, %arg1)
+// CHECK-NEXT: ^bb0(%[[I:.*]]: i32, %[[CARRY:.*]]: !xls.array<1024 x i32>, %[[LHS:.*]]: !xls.array<1024 x i32>, %[[RHS:.*]]: !xls.array<1024 x i32>):
+// CHECK-DAG: %[[A:.*]] = "xls.array_index"(%[[LHS]], %[[I]])
+// CHECK-DAG: %[[B:.*]] = "xls.array_index"(%[[RHS]], %[[I]])
+// CHECK: %[[SUM:.*]] = xls.add %[[A]], %[[B]] : i32
+// CHECK: %[[UPDATED:.*]] = "xls.array_update"(%[[CARRY]], %[[SUM]], %[[I]])
+// CHECK: xls.yield %[[UPDATED]]
+// CHECK: trip_count = 1024
+// CHECK: return %[[RESULT]] : !xls.array<1024 x i32>
+func.func @elementwise(%arg0: tensor<1024xi32>, %arg1: tensor<1024xi32>) -> tensor<1024xi32> attributes { "xls" = true } {
+  %0 = xls.add %arg0, %arg1 : tensor<1024xi32>
+  return %0 : tensor<1024xi32>
+}
+
+// CHECK-LABEL: @multidimensional
+// CHECK: "xls.array_zero"() : () -> !xls.array<32 x i32>
+// CHECK: xls.for
+// CHECK: xls.sub
+// CHECK: trip_count = 32
+func.func @multidimensional(%arg0: tensor<4x8xi32>, %arg1: tensor<4x8xi32>) -> tensor<4x8xi32> attributes { "xls" = true } {
+  %0 = xls.sub %arg0, %arg1 : tensor<4x8xi32>
+  return %0 : tensor<4x8xi32>
+}
+
+func.func private @callee(%arg0: i8) -> i8
+
+// CHECK-LABEL: @vectorized_call
+// CHECK: xls.for
+// CHECK: %[[E:.*]] = "xls.array_index"
+// CHECK: %[[R:.*]] = {{.*}}call @callee(%[[E]]) : (i8) -> i8
+// CHECK: "xls.array_update"(%{{.*}}, %[[R]], %{{.*}})
+// CHECK: trip_count = 256
+func.func @vectorized_call(%arg0: tensor<256xi8>) -> tensor<256xi8> attributes {xls = true} {
+  %0 = xls.vectorized_call @callee(%arg0) : (tensor<256xi8>) -> tensor<256xi8>
+  return %0 : tensor<256xi8>
+}
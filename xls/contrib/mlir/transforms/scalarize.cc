@@ -24,6 +24,7 @@
 #include "absl/algorithm/container.h"
 #include "llvm/include/llvm/ADT/ArrayRef.h"
 #include "llvm/include/llvm/ADT/STLExtras.h"
+#include "llvm/include/llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
 #include "llvm/include/llvm/Support/Casting.h"
@@ -44,6 +45,7 @@
 #include "mlir/include/mlir/IR/MLIRContext.h"
 #include "mlir/include/mlir/IR/OpDefinition.h"
 #include "mlir/include/mlir/IR/PatternMatch.h"
+#include "mlir/include/mlir/IR/TypeRange.h"
 #include "mlir/include/mlir/IR/TypeUtilities.h"
 #include "mlir/include/mlir/IR/ValueRange.h"
 #include "mlir/include/mlir/IR/Visitors.h"
@@ -506,6 +508,56 @@ int getArraySize(ValueRange operands) {
   return 0;
 }
 
+// Builds an `xls.for` loop over the `size` elements of the arrays in
+// `operands`, building the scalar ops for each element with `buildScalarOps`
+// and collecting their results into arrays of types `resultTypes`. Array
+// operands are indexed by the induction variable; other operands are passed to
+// `buildScalarOps` unchanged. Returns the results of the loop.
+//
+// Unlike unrolling the op into one op per element, this keeps the size of the
+// IR independent of the number of elements.
+SmallVector<Value> buildElementwiseLoop(
+    Location loc, int size, ValueRange operands, TypeRange resultTypes,
+    ConversionPatternRewriter& rewriter,
+    llvm::function_ref<SmallVector<Value>(ValueRange)> buildScalarOps) {
+  SmallVector<Value> inits;
+  for (Type type : resultTypes) {
+    inits.push_back(rewriter.create<ArrayZeroOp>(loc, type));
+  }
+  auto forOp = rewriter.create<ForOp>(loc, resultTypes, inits, operands,
+                                      rewriter.getI64IntegerAttr(size));
+
+  // The body takes the induction variable, one carried array per result and
+  // the operands as invariants.
+  SmallVector<Type> argTypes = {rewriter.getI32Type()};
+  llvm::append_range(argTypes, resultTypes);
+  llvm::append_range(argTypes, operands.getTypes());
+  SmallVector<Location> argLocs(argTypes.size(), loc);
+  OpBuilder::InsertionGuard guard(rewriter);
+  Block* body = rewriter.createBlock(&forOp.getBody(), {}, argTypes, argLocs);
+  Value index = body->getArgument(0);
+  auto carries = body->getArguments().slice(1, resultTypes.size());
+  auto invariants = body->getArguments().drop_front(1 + resultTypes.size());
+
+  SmallVector<Value> elements;
+  for (Value invariant : invariants) {
+    if (ArrayType atype = dyn_cast<ArrayType>(invariant.getType())) {
+      elements.push_back(rewriter.create<ArrayIndexOp>(
+          loc, atype.getElementType(), invariant, index));
+    } else {
+      elements.push_back(invariant);
+    }
+  }
+  SmallVector<Value> results = buildScalarOps(elements);
+  SmallVector<Value> updated;
+  for (auto [carry, result] : llvm::zip(carries, results)) {
+    updated.push_back(rewriter.create<ArrayUpdateOp>(loc, carry.getType(),
+                                                     carry, result, index));
+  }
+  rewriter.create<YieldOp>(loc, updated);
+  return SmallVector<Value>(forOp.getResults());
+}
+
 // Legalizes any scalarizable op.
 class LegalizeScalarizableOpPattern
     : public OpTraitConversionPattern<OpTrait::Scalarizable> {
@@ -567,6 +619,49 @@ class LegalizeScalarizableOpPattern
   }
 };
 
+// Legalizes any scalarizable op on arrays to a loop applying the op to each
+// element. Used instead of LegalizeScalarizableOpPattern when vectorizing.
+class LegalizeScalarizableOpAsLoopPattern
+    : public OpTraitConversionPattern<OpTrait::Scalarizable> {
+ public:
+  using OpTraitConversionPattern::OpTraitConversionPattern;
+
+  LogicalResult matchAndRewrite(
+      Operation* op, ArrayRef<Value> operands,
+      ConversionPatternRewriter& rewriter) const override {
+    // Generic pattern but only apply it to XLS ops.
+    if (op->getDialect()->getTypeID() != TypeID::get<XlsDialect>()) {
+      return failure();
+    }
+
+    int size = getArraySize(operands);
+    if (size == 0) {
+      // No vectors to unwrap.
+      return failure();
+    }
+
+    SmallVector<Type> elementTypes;
+    SmallVector<Type> resultTypes;
+    for (Type type : op->getResultTypes()) {
+      Type elementType = mlir::getElementTypeOrSelf(type);
+      elementTypes.push_back(elementType);
+      resultTypes.push_back(
+          ArrayType::get(rewriter.getContext(), size, elementType));
+    }
+
+    SmallVector<Value> results = buildElementwiseLoop(
+        op->getLoc(), size, operands, resultTypes, rewriter,
+        [&](ValueRange elements) {
+          Operation* newOp =
+              rewriter.create(op->getLoc(), op->getName().getIdentifier(),
+                              elements, elementTypes, op->getAttrs());
+          return SmallVector<Value>(newOp->getResults());
+        });
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
 // Propagates type legalization through ForOp.
 class ConvertForOpTypes : public OpConversionPattern<ForOp> {
  public:
@@ -668,6 +763,49 @@ class LegalizeVectorizedCallPattern
     return success();
   }
 };
+
+// Legalizes a vectorized call on arrays to a loop calling the callee on each
+// element. Used instead of LegalizeVectorizedCallPattern when vectorizing.
+class LegalizeVectorizedCallAsLoopPattern
+    : public OpConversionPattern<VectorizedCallOp> {
+ public:
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult matchAndRewrite(
+      VectorizedCallOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter& rewriter) const override {
+    auto callee =
+        op->getParentOfType<mlir::ModuleOp>().lookupSymbol<mlir::func::FuncOp>(
+            adaptor.getCallee());
+    if (!callee) {
+      return failure();
+    }
+
+    int size = getArraySize(adaptor.getOperands());
+    if (size == 0) {
+      // No vectors to unwrap - just call.
+      rewriter.replaceOpWithNewOp<mlir::func::CallOp>(op, callee,
+                                                      adaptor.getOperands());
+      return success();
+    }
+
+    SmallVector<Type> resultTypes;
+    for (Type type : callee.getFunctionType().getResults()) {
+      resultTypes.push_back(ArrayType::get(rewriter.getContext(), size, type));
+    }
+
+    SmallVector<Value> results = buildElementwiseLoop(
+        op->getLoc(), size, adaptor.getOperands(), resultTypes, rewriter,
+        [&](ValueRange elements) {
+          auto callOp = rewriter.create<mlir::func::CallOp>(op->getLoc(),
+                                                            callee, elements);
+          return SmallVector<Value>(callOp->getResults());
+        });
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+};
+
 class LegalizeCallDslxPattern : public OpConversionPattern<CallDslxOp> {
  public:
   using OpConversionPattern::OpConversionPattern;
@@ -733,6 +871,8 @@ class LegalizeCallDslxPattern : public OpConversionPattern<CallDslxOp> {
 
 class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
  public:
+  using ScalarizePassBase::ScalarizePassBase;
+
   void runOnOperation() override {
     getOperation()->walk([&](Operation* op) {
       if (auto interface = dyn_cast<XlsRegionOpInterface>(op)) {
@@ -774,6 +914,15 @@ class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
     });
     target.addIllegalOp<VectorizedCallOp>();
     RewritePatternSet patterns(&getContext());
+    if (vectorizeElementwise) {
+      patterns.add<LegalizeScalarizableOpAsLoopPattern,
+                   LegalizeVectorizedCallAsLoopPattern>(typeConverter,
+                                                        &getContext());
+    } else {
+      patterns.add<LegalizeScalarizableOpPattern,
+                   LegalizeVectorizedCallPattern>(typeConverter,
+                                                  &getContext());
+    }
     patterns.add<
         // clang-format off
         ConvertForOpTypes,
@@ -781,7 +930,6 @@ class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
         LegalizeChanOpPattern,
         LegalizeConcatPattern,
         LegalizeConstantTensorPattern,
-        LegalizeScalarizableOpPattern,
         LegalizeTensorArrayTypeFungiblePattern,
         LegalizeTensorEmptyPattern,
         LegalizeTensorExtractPattern,
@@ -789,7 +937,6 @@ class ScalarizePass : public impl::ScalarizePassBase<ScalarizePass> {
         LegalizeTensorExtractSliceUnrollPattern,
         LegalizeTensorFromElementsPattern,
         LegalizeTensorInsertPattern,
-        LegalizeVectorizedCallPattern,
         ReturnLikeOpPattern
         // clang-format on
         >(typeConverter, &getContext());
@@ -32,8 +32,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "clang/include/clang/AST/ASTConsumer.h"
@@ -46,8 +48,10 @@
 #include "clang/include/clang/Basic/LLVM.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
 #include "clang/include/clang/Basic/TokenKinds.h"
+#include "clang/include/clang/Basic/Version.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
 #include "clang/include/clang/Frontend/FrontendAction.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Lex/PPCallbacks.h"
 #include "clang/include/clang/Lex/Pragma.h"
@@ -57,6 +61,7 @@
 #include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/VirtualFileSystem.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
+#include "xls/common/file/cache_key.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
@@ -67,6 +72,140 @@
 #include "re2/re2.h"
 
 namespace xlscc {
+namespace {
+
+constexpr std::string_view kXlsBuiltinHeader = R"(
+#ifndef __XLS_BUILTIN_H
+#define __XLS_BUILTIN_H
+template<int N>
+struct __xls_bits { };
+
+// Should match OpType
+enum __xls_channel_dir {
+  __xls_channel_dir_Unknown=0,    // OpType::kNull
+  __xls_channel_dir_Out=1,        // OpType::kSend
+  __xls_channel_dir_In=2,         // OpType::kRecv
+  __xls_channel_dir_InOut=3       // OpType::kSendRecv
+};
+
+template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
+class __xls_channel {
+ public:
+  T read()const {
+    return T();
+  }
+  T write(T val)const {
+    return val;
+  }
+  void read(T& out)const {
+    (void)out;
+  }
+  bool nb_read(T& out)const {
+    (void)out;
+    return true;
+  }
+};
+
+template<typename T, unsigned long long Size>
+class __xls_memory {
+ public:
+  unsigned long long size()const {
+    return Size;
+  };
+
+  T& operator[](long long int addr)const {
+    static T ret;
+    return ret;
+  }
+  void write(long long int addr, const T& value) const {
+    return;
+  }
+  T read(long long int addr) const {
+    return T();
+  }
+};
+
+
+// Bypass no outputs error
+int __xlscc_unimplemented() { return 0; }
+
+void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
+
+// See XLS IR trace op format
+void __xlscc_trace(const char*fmt, ...) { }
+
+bool __xlscc_on_reset = false;
+
+// Returns bits for 32.32 fixed point representation
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
+
+// For use with loops
+void __xlscc_pipeline(long long factor) { }
+void __xlscc_unroll(long long factor) { }
+
+// Place at the beginning of the token graph, connected to the end, in parallel
+// to anything else, rather than serializing as by default
+void __xlscc_asap() { }
+
+#endif//__XLS_BUILTIN_H
+          )";
+
+// Separate input for the precompiled header, which clang requires to exist
+// whenever the precompiled header is used.
+constexpr std::string_view kPrecompiledHeaderSource = "/xls_pch.h";
+
+// Arguments for clang shared by parsing and precompilation, with these
+// followed by `input`.
+std::vector<std::string> ClangArgv(
+    std::string_view input, absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back(input);
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  argv.emplace_back("-I.");
+  argv.emplace_back("-std=c++17");
+  argv.emplace_back("-nostdinc");
+  argv.emplace_back("-Wno-unused-label");
+  argv.emplace_back("-Wno-constant-logical-operand");
+  argv.emplace_back("-Wno-unused-but-set-variable");
+  argv.emplace_back("-Wno-c++11-narrowing");
+  argv.emplace_back("-Wno-conversion");
+  argv.emplace_back("-Wno-missing-template-arg-list-after-template-kw");
+  return argv;
+}
+
+// Overlays /xls_builtin.h and the in-memory `files` onto the real filesystem.
+llvm::IntrusiveRefCntPtr<clang::FileManager> CreateFileManager(
+    absl::Span<const std::pair<std::string, std::string>> files) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile("/xls_builtin.h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  for (const auto& [path, contents] : files) {
+    mem_fs->addFile(path, 0, llvm::MemoryBuffer::getMemBufferCopy(contents));
+  }
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+
+  overlay_fs->pushOverlay(mem_fs);
+
+  return new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+}
+
+std::string PrecompiledHeaderSource(absl::Span<const std::string> headers) {
+  std::string source = "#include \"/xls_builtin.h\"\n";
+  for (const std::string& header : headers) {
+    absl::StrAppend(&source, "#include \"", header, "\"\n");
+  }
+  return source;
+}
+
+}  // namespace
 
 class LibToolVisitor : public clang::RecursiveASTVisitor<LibToolVisitor> {
  public:
@@ -309,6 +448,38 @@ class UnknownPragmaHandler : public clang::PragmaHandler {
   };
 };
 
+namespace {
+
+void AddHlsPragmaHandlers(clang::CompilerInstance* compiler_instance,
+                          CCParser& parser) {
+  clang::Preprocessor& preprocessor = compiler_instance->getPreprocessor();
+  preprocessor.AddPragmaHandler(
+      "", new HlsNoParamPragmaHandler(compiler_instance, parser, "hls_top",
+                                      Pragma_Top));
+  preprocessor.AddPragmaHandler(
+      "", new HlsDesignPragmaHandler(compiler_instance, parser));
+  preprocessor.AddPragmaHandler(
+      "", new HlsPipelineInitIntervalPragmaHandler(compiler_instance, parser));
+  preprocessor.AddPragmaHandler(
+      "", new HlsNoParamPragmaHandler(compiler_instance, parser,
+                                      "hls_array_allow_default_pad",
+                                      Pragma_ArrayAllowDefaultPad));
+  preprocessor.AddPragmaHandler(
+      "", new HlsNoParamPragmaHandler(compiler_instance, parser,
+                                      "hls_no_tuple", Pragma_NoTuples));
+  preprocessor.AddPragmaHandler(
+      "", new HlsNoParamPragmaHandler(compiler_instance, parser,
+                                      "hls_synthetic_int",
+                                      Pragma_SyntheticInt));
+  preprocessor.AddPragmaHandler(
+      "", new HlsUnrollPragmaHandler(compiler_instance, parser));
+  preprocessor.AddPragmaHandler(
+      "", new HlsChannelStrictnessPragmaHandler(compiler_instance, parser));
+  preprocessor.AddPragmaHandler("", new UnknownPragmaHandler());
+}
+
+}  // namespace
+
 class LibToolASTConsumer : public clang::ASTConsumer {
  public:
   explicit LibToolASTConsumer(clang::CompilerInstance& CI, CCParser& parser)
@@ -332,32 +503,7 @@ class LibToolFrontendAction : public clang::ASTFrontendAction {
         new LibToolASTConsumer(CI, parser_));
   }
   void ExecuteAction() override {
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsNoParamPragmaHandler(compiler_instance_, parser_, "hls_top",
-                                        Pragma_Top));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsDesignPragmaHandler(compiler_instance_, parser_));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "",
-        new HlsPipelineInitIntervalPragmaHandler(compiler_instance_, parser_));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsNoParamPragmaHandler(compiler_instance_, parser_,
-                                        "hls_array_allow_default_pad",
-                                        Pragma_ArrayAllowDefaultPad));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsNoParamPragmaHandler(compiler_instance_, parser_,
-                                        "hls_no_tuple", Pragma_NoTuples));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "",
-        new HlsNoParamPragmaHandler(compiler_instance_, parser_,
-                                    "hls_synthetic_int", Pragma_SyntheticInt));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsUnrollPragmaHandler(compiler_instance_, parser_));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new HlsChannelStrictnessPragmaHandler(compiler_instance_, parser_));
-    getCompilerInstance().getPreprocessor().AddPragmaHandler(
-        "", new UnknownPragmaHandler());
-
+    AddHlsPragmaHandlers(compiler_instance_, parser_);
     clang::ASTFrontendAction::ExecuteAction();
   }
 
@@ -365,6 +511,18 @@ class LibToolFrontendAction : public clang::ASTFrontendAction {
   CCParser& parser_;
   clang::CompilerInstance* compiler_instance_;
 };
+// Records the HLS pragmas in the precompiled headers while writing them.
+class PrecompiledHeaderAction : public clang::GeneratePCHAction {
+ public:
+  explicit PrecompiledHeaderAction(CCParser& parser) : parser_(parser) {}
+  void ExecuteAction() override {
+    AddHlsPragmaHandlers(&getCompilerInstance(), parser_);
+    clang::GeneratePCHAction::ExecuteAction();
+  }
+
+ private:
+  CCParser& parser_;
+};
 class DiagnosticInterceptor : public clang::TextDiagnosticPrinter {
  public:
   DiagnosticInterceptor(CCParser& translator, llvm::raw_ostream& os,
@@ -420,6 +578,10 @@ absl::Status CCParser::ScanFile(
   CHECK_EQ(libtool_thread_.get(), nullptr);
   CHECK_EQ(libtool_wait_for_destruct_.get(), nullptr);
 
+  if (!precompiled_headers_.empty()) {
+    XLS_RETURN_IF_ERROR(LoadPrecompiledHeaders(command_line_args));
+  }
+
   // The AST is destroyed after ToolInvocation::run() returns
   //
   // However, we want to preserve it to access it across multiple passes and
@@ -438,6 +600,117 @@ absl::Status CCParser::ScanFile(
   return libtool_visit_status_;
 }
 
+void CCParser::UsePrecompiledHeaders(
+    std::vector<std::string> headers, std::filesystem::path cache_directory) {
+  precompiled_headers_ = std::move(headers);
+  precompiled_header_cache_directory_ = std::move(cache_directory);
+}
+
+absl::Status CCParser::LoadPrecompiledHeaders(
+    absl::Span<std::string_view> command_line_args) {
+  const std::string clang_version = clang::getClangFullVersion();
+  std::vector<std::string> header_contents;
+  header_contents.reserve(precompiled_headers_.size());
+  for (const std::string& header : precompiled_headers_) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, xls::GetFileContents(header));
+    header_contents.push_back(std::move(contents));
+  }
+  std::vector<std::string_view> components = {clang_version,
+                                              kXlsBuiltinHeader};
+  components.insert(components.end(), command_line_args.begin(),
+                    command_line_args.end());
+  for (int64_t i = 0; i < precompiled_headers_.size(); ++i) {
+    components.push_back(precompiled_headers_[i]);
+    components.push_back(header_contents[i]);
+  }
+  const std::string key = xls::CacheKey(components);
+  const std::filesystem::path pch_path =
+      precompiled_header_cache_directory_ / absl::StrCat(key, ".pch");
+  const std::filesystem::path pragmas_path =
+      precompiled_header_cache_directory_ / absl::StrCat(key, ".pragmas");
+
+  // The pragmas are written after the precompiled header, so both exist once
+  // they have been written.
+  if (xls::FileExists(pch_path).ok()) {
+    absl::StatusOr<std::string> pragmas = xls::GetFileContents(pragmas_path);
+    if (pragmas.ok()) {
+      XLS_RETURN_IF_ERROR(ParsePragmas(*pragmas));
+      precompiled_header_path_ = pch_path;
+      return absl::OkStatus();
+    }
+  }
+
+  XLS_RETURN_IF_ERROR(
+      xls::RecursivelyCreateDir(precompiled_header_cache_directory_));
+  std::vector<std::string> argv =
+      ClangArgv(kPrecompiledHeaderSource, command_line_args);
+  argv.insert(argv.begin() + 1, {"-x", "c++-header"});
+  argv.emplace_back("-o");
+  argv.emplace_back(pch_path.string());
+  const std::vector<std::pair<std::string, std::string>> files = {
+      {std::string(kPrecompiledHeaderSource),
+       PrecompiledHeaderSource(precompiled_headers_)}};
+  llvm::IntrusiveRefCntPtr<clang::FileManager> pch_files =
+      CreateFileManager(files);
+  clang::tooling::ToolInvocation pch_inv(
+      argv, std::make_unique<PrecompiledHeaderAction>(*this), pch_files.get());
+
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_opts =
+      new clang::DiagnosticOptions();
+  DiagnosticInterceptor diag_print(*this, llvm::errs(), &*diag_opts);
+  pch_inv.setDiagnosticConsumer(&diag_print);
+
+  libtool_visit_status_ = absl::OkStatus();
+  if (!pch_inv.run() && libtool_visit_status_.ok()) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to precompile headers: %s",
+        absl::StrJoin(precompiled_headers_, ", ")));
+  }
+  XLS_RETURN_IF_ERROR(libtool_visit_status_);
+
+  XLS_RETURN_IF_ERROR(
+      xls::AtomicSetFileContents(pragmas_path, SerializePragmas()));
+  precompiled_header_path_ = pch_path;
+  return absl::OkStatus();
+}
+
+std::string CCParser::SerializePragmas() const {
+  // One pragma per line, with the file name last since it may contain tabs.
+  std::vector<std::string> lines;
+  lines.reserve(hls_pragmas_.size());
+  for (const auto& [loc, pragma] : hls_pragmas_) {
+    const auto& [filename, line] = loc;
+    lines.push_back(absl::StrFormat("%d\t%d\t%d\t%s\t%s",
+                                    static_cast<int>(pragma.type()),
+                                    pragma.int_argument(), line,
+                                    pragma.str_argument(), filename));
+  }
+  std::sort(lines.begin(), lines.end());
+  return absl::StrJoin(lines, "\n");
+}
+
+absl::Status CCParser::ParsePragmas(std::string_view serialized) {
+  for (std::string_view line :
+       absl::StrSplit(serialized, '\n', absl::SkipEmpty())) {
+    std::vector<std::string_view> fields =
+        absl::StrSplit(line, absl::MaxSplits('\t', 4));
+    int type = 0;
+    int64_t int_argument = 0;
+    int lineno = 0;
+    if (fields.size() != 5 || !absl::SimpleAtoi(fields[0], &type) ||
+        !absl::SimpleAtoi(fields[1], &int_argument) ||
+        !absl::SimpleAtoi(fields[2], &lineno)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Malformed precompiled header pragma: %s", line));
+    }
+    const PragmaType pragma_type = static_cast<PragmaType>(type);
+    hls_pragmas_[PragmaLoc(std::string(fields[4]), lineno)] =
+        fields[3].empty() ? Pragma(pragma_type, int_argument)
+                          : Pragma(pragma_type, std::string(fields[3]));
+  }
+  return absl::OkStatus();
+}
+
 void CCParser::AddSourceInfoToMetadata(xlscc_metadata::MetadataOutput& output) {
   for (const auto& [path, number] : file_numbers_) {
     xlscc_metadata::SourceName* source = output.add_sources();
@@ -673,110 +946,19 @@ void LibToolThread::Start() {
 void LibToolThread::Join() { thread_->Join(); }
 
 void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
+  std::vector<std::string> argv = ClangArgv("/xls_top.cc", command_line_args_);
   argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
-  argv.emplace_back("-Wno-conversion");
-  argv.emplace_back("-Wno-missing-template-arg-list-after-template-kw");
-
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
+  std::vector<std::pair<std::string, std::string>> files;
+  if (!parser_.precompiled_header_path_.empty()) {
+    argv.emplace_back("-include-pch");
+    argv.emplace_back(parser_.precompiled_header_path_.string());
+    files.emplace_back(kPrecompiledHeaderSource,
+                       PrecompiledHeaderSource(parser_.precompiled_headers_));
+  }
 
   std::unique_ptr<LibToolFrontendAction> libtool_action(
       new LibToolFrontendAction(parser_));
 
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
-#ifndef __XLS_BUILTIN_H
-#define __XLS_BUILTIN_H
-template<int N>
-struct __xls_bits { };
-
-// Should match OpType
-enum __xls_channel_dir {
-  __xls_channel_dir_Unknown=0,    // OpType::kNull
-  __xls_channel_dir_Out=1,        // OpType::kSend
-  __xls_channel_dir_In=2,         // OpType::kRecv
-  __xls_channel_dir_InOut=3       // OpType::kSendRecv
-};
-
-template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
-class __xls_channel {
- public:
-  T read()const {
-    return T();
-  }
-  T write(T val)const {
-    return val;
-  }
-  void read(T& out)const {
-    (void)out;
-  }
-  bool nb_read(T& out)const {
-    (void)out;
-    return true;
-  }
-};
-
-template<typename T, unsigned long long Size>
-class __xls_memory {
- public:
-  unsigned long long size()const {
-    return Size;
-  };
-
-  T& operator[](long long int addr)const {
-    static T ret;
-    return ret;
-  }
-  void write(long long int addr, const T& value) const {
-    return;
-  }
-  T read(long long int addr) const {
-    return T();
-  }
-};
-
-
-// Bypass no outputs error
-int __xlscc_unimplemented() { return 0; }
-
-void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
-
-// See XLS IR trace op format
-void __xlscc_trace(const char*fmt, ...) { }
-
-bool __xlscc_on_reset = false;
-
-// Returns bits for 32.32 fixed point representation
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
-
-// For use with loops
-void __xlscc_pipeline(long long factor) { }
-void __xlscc_unroll(long long factor) { }
-
-// Place at the beginning of the token graph, connected to the end, in parallel
-// to anything else, rather than serializing as by default
-void __xlscc_asap() { }
-
-#endif//__XLS_BUILTIN_H
-          )"));
-
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
                                              ? ""
@@ -804,15 +986,10 @@ void __xlscc_top_class_instance_ref2() {
           )",
                       source_filename_, top_class_inst_injection);
 
-  mem_fs->addFile("/xls_top.cc", 0, llvm::MemoryBuffer::getMemBuffer(top_src));
-
-  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
-      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
-
-  overlay_fs->pushOverlay(mem_fs);
+  files.emplace_back("/xls_top.cc", top_src);
 
-  libtool_files =
-      new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files =
+      CreateFileManager(files);
 
   std::unique_ptr<clang::tooling::ToolInvocation> libtool_inv(
       new clang::tooling::ToolInvocation(argv, std::move(libtool_action),
@@ -16,11 +16,13 @@
 #define XLS_CONTRIB_XLSCC_PARSE_CPP_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -106,6 +108,7 @@ class CCParser {
   friend class HlsUnrollPragmaHandler;
   friend class HlsChannelStrictnessPragmaHandler;
   friend class HlsNoParamPragmaHandler;
+  friend class LibToolThread;
 
  public:
   // Deletes the AST
@@ -132,6 +135,20 @@ class CCParser {
   absl::Status ScanFile(std::string_view source_filename,
                         absl::Span<std::string_view> command_line_args);
 
+  // Parses `headers` through a clang precompiled header instead of from
+  // source. The precompiled header is kept in `cache_directory`, keyed on the
+  // contents of the headers and the command line, and is built by ScanFile
+  // when missing.
+  //
+  // The headers are included before the source file, so they must have
+  // include guards and must not depend on anything declared before their
+  // #include in the source. Headers they include in turn are not part of the
+  // key; clang rejects the precompiled header if those have changed.
+  //
+  // Must be called before ScanFile.
+  void UsePrecompiledHeaders(std::vector<std::string> headers,
+                             std::filesystem::path cache_directory);
+
   // Call after ScanFile, as the top function may be specified by #pragma
   // If none was found, an error is returned
   absl::StatusOr<std::string> GetEntryFunctionName() const;
@@ -175,6 +192,18 @@ class CCParser {
   absl::Status VisitVarDecl(const clang::VarDecl* funcdecl);
   absl::Status ScanFileForPragmas(std::string_view filename);
 
+  // Finds or builds the precompiled header, and loads the pragmas which were
+  // recorded while building it, since clang does not replay them.
+  absl::Status LoadPrecompiledHeaders(
+      absl::Span<std::string_view> command_line_args);
+  std::string SerializePragmas() const;
+  absl::Status ParsePragmas(std::string_view serialized);
+
+  std::vector<std::string> precompiled_headers_;
+  std::filesystem::path precompiled_header_cache_directory_;
+  // Empty unless precompiled headers are used
+  std::filesystem::path precompiled_header_path_;
+
   using PragmaLoc = std::tuple<std::string, int>;
   absl::flat_hash_map<PragmaLoc, Pragma> hls_pragmas_;
   absl::flat_hash_set<std::string> files_scanned_for_pragmas_;
@@ -84,6 +84,15 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::vector<std::string>, precompiled_headers,
+          std::vector<std::string>(),
+          "Comma separated list of headers to parse through a clang "
+          "precompiled header, which is cached between runs. Requires "
+          "--precompiled_header_cache_dir.");
+
+ABSL_FLAG(std::string, precompiled_header_cache_dir, "",
+          "Directory in which to cache precompiled headers.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -250,6 +259,18 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argv.push_back(i);
   }
 
+  const std::vector<std::string> precompiled_headers =
+      absl::GetFlag(FLAGS_precompiled_headers);
+  if (!precompiled_headers.empty()) {
+    const std::string cache_dir =
+        absl::GetFlag(FLAGS_precompiled_header_cache_dir);
+    if (cache_dir.empty()) {
+      return absl::InvalidArgumentError(
+          "--precompiled_headers requires --precompiled_header_cache_dir");
+    }
+    translator.UsePrecompiledHeaders(precompiled_headers, cache_dir);
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << '\n';
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
@@ -33,7 +33,11 @@
 #include "absl/time/time.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/Expr.h"
+#include "clang/include/clang/AST/OperationKinds.h"
+#include "clang/include/clang/AST/RecursiveASTVisitor.h"
+#include "clang/include/clang/AST/Stmt.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "llvm/include/llvm/ADT/APSInt.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
 #include "xls/contrib/xlscc/cc_parser.h"
@@ -59,6 +63,76 @@ ABSL_FLAG(bool, log_slow_unroll_iterations, false,
           "If true, log warnings when unrolling is slow.");
 
 namespace xlscc {
+namespace {
+
+// Constants in counted loops are limited to this many bits, so that trip count
+// arithmetic on them cannot overflow.
+constexpr int64_t kCountedLoopConstantBits = 62;
+
+std::optional<int64_t> EvaluateCountedLoopConstant(
+    const clang::Expr* expr, const clang::ASTContext& ctx) {
+  clang::Expr::EvalResult result;
+  if (!expr->EvaluateAsInt(result, ctx, clang::Expr::SE_NoSideEffects,
+                           /*InConstantContext=*/false)) {
+    return std::nullopt;
+  }
+  const llvm::APSInt& value = result.Val.getInt();
+  if (value.isSigned() ? !value.isSignedIntN(kCountedLoopConstantBits)
+                       : !value.isIntN(kCountedLoopConstantBits - 1)) {
+    return std::nullopt;
+  }
+  return value.getExtValue();
+}
+
+// Counts the references to an induction variable, and how many of them only
+// read its value, along with any statements which could leave the loop early.
+class InductionVarUseVisitor
+    : public clang::RecursiveASTVisitor<InductionVarUseVisitor> {
+ public:
+  explicit InductionVarUseVisitor(const clang::VarDecl* var) : var_(var) {}
+
+  bool VisitDeclRefExpr(clang::DeclRefExpr* ref) {
+    if (ref->getDecl() == var_) {
+      ++references_;
+    }
+    return true;
+  }
+  bool VisitImplicitCastExpr(clang::ImplicitCastExpr* cast) {
+    if (cast->getCastKind() != clang::CK_LValueToRValue) {
+      return true;
+    }
+    auto ref =
+        clang::dyn_cast<clang::DeclRefExpr>(cast->getSubExpr()->IgnoreParens());
+    if (ref != nullptr && ref->getDecl() == var_) {
+      ++reads_;
+    }
+    return true;
+  }
+  bool VisitBreakStmt(clang::BreakStmt*) {
+    exits_ = true;
+    return true;
+  }
+  bool VisitReturnStmt(clang::ReturnStmt*) {
+    exits_ = true;
+    return true;
+  }
+  bool VisitGotoStmt(clang::GotoStmt*) {
+    exits_ = true;
+    return true;
+  }
+
+  // True if the statements visited so far only read the variable and always
+  // fall through to the increment.
+  bool OnlyReadsVar() const { return !exits_ && reads_ == references_; }
+
+ private:
+  const clang::VarDecl* var_;
+  int64_t references_ = 0;
+  int64_t reads_ = 0;
+  bool exits_ = false;
+};
+
+}  // namespace
 
 absl::Status Translator::GenerateIR_Loop(
     bool always_first_iter, const clang::Stmt* init,
@@ -190,6 +264,15 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
     XLS_RETURN_IF_ERROR(GenerateIR_Stmt(init, ctx));
   }
 
+  // Counted loops skip generating and checking the condition at each
+  // iteration, and bind the induction variable to a literal so that each copy
+  // of the body is translated with it constant.
+  std::optional<CountedLoop> counted_loop;
+  if (!always_first_iter) {
+    XLS_ASSIGN_OR_RETURN(counted_loop, AnalyzeCountedLoop(init, cond_expr, inc,
+                                                          body, ctx, loc));
+  }
+
   // Loop unrolling causes duplicate NamedDecls which fail the soundness
   // check. Reset the known set before each iteration.
   auto saved_check_ids = unique_decl_ids_;
@@ -214,13 +297,39 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
           loc, "Loop unrolling has reached %i iterations", warn_unroll_iters_);
     }
 
+    if (counted_loop.has_value()) {
+      if (nIters == counted_loop->trip_count) {
+        break;
+      }
+      if (first_iter) {
+        // The enclosing condition may still be known to be false.
+        XLS_ASSIGN_OR_RETURN(
+            bool condition_must_be_false,
+            BitMustBe(false, context().relative_condition, solver,
+                      z3_translator_parent->ctx(), loc));
+        if (condition_must_be_false) {
+          break;
+        }
+      }
+      const int64_t value =
+          counted_loop->start + nIters * counted_loop->step;
+      const int64_t width = counted_loop->type->width();
+      xls::BValue literal = context().fb->Literal(
+          counted_loop->type->is_signed() ? xls::SBits(value, width)
+                                          : xls::UBits(value, width),
+          loc);
+      XLS_RETURN_IF_ERROR(Assign(counted_loop->induction_var,
+                                 CValue(literal, counted_loop->type), loc));
+    }
+
     // Generate condition.
     //
     // Outside of body context guard so it applies to increment
     // Also, if this is inside the body context guard then the break condition
     // feeds back on itself in an explosion of complexity
     // via assignments to any variables used in the condition.
-    if (!always_this_iter && cond_expr != nullptr) {
+    if (!counted_loop.has_value() && !always_this_iter &&
+        cond_expr != nullptr) {
       XLS_ASSIGN_OR_RETURN(CValue cond_expr_cval,
                            GenerateIR_Expr(cond_expr, loc));
       CHECK(cond_expr_cval.type()->Is<CBoolType>());
@@ -230,7 +339,7 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
       XLS_RETURN_IF_ERROR(and_condition(cond_expr_cval.rvalue(), loc));
     }
 
-    {
+    if (!counted_loop.has_value()) {
       // We use the relative condition so that returns also stop unrolling
       XLS_ASSIGN_OR_RETURN(bool condition_must_be_false,
                            BitMustBe(false, context().relative_condition,
@@ -251,7 +360,8 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
 
     // Generate increment
     // Outside of body guard because continue would skip.
-    if (inc != nullptr) {
+    // Counted loops instead bind the next value at the start of the iteration.
+    if (inc != nullptr && !counted_loop.has_value()) {
       XLS_RETURN_IF_ERROR(GenerateIR_Stmt(inc, ctx));
     }
     // Print slow unrolling warning
@@ -267,6 +377,147 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::optional<Translator::CountedLoop>>
+Translator::AnalyzeCountedLoop(const clang::Stmt* init,
+                               const clang::Expr* cond_expr,
+                               const clang::Stmt* inc, const clang::Stmt* body,
+                               clang::ASTContext& ctx,
+                               const xls::SourceInfo& loc) {
+  auto decl_stmt = clang::dyn_cast_or_null<clang::DeclStmt>(init);
+  auto inc_expr = clang::dyn_cast_or_null<clang::Expr>(inc);
+  if (decl_stmt == nullptr || !decl_stmt->isSingleDecl() ||
+      cond_expr == nullptr || inc_expr == nullptr) {
+    return std::nullopt;
+  }
+  auto var = clang::dyn_cast<clang::VarDecl>(decl_stmt->getSingleDecl());
+  if (var == nullptr || var->getInit() == nullptr ||
+      !var->getType()->isIntegerType() ||
+      var->getType().isVolatileQualified()) {
+    return std::nullopt;
+  }
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<CType> ctype,
+                       TranslateTypeFromClang(var->getType(), loc));
+  auto type = std::dynamic_pointer_cast<CIntType>(ctype);
+  if (type == nullptr) {
+    return std::nullopt;
+  }
+  auto is_var = [var](const clang::Expr* expr) {
+    auto ref = clang::dyn_cast<clang::DeclRefExpr>(expr);
+    return ref != nullptr && ref->getDecl() == var;
+  };
+
+  std::optional<int64_t> start =
+      EvaluateCountedLoopConstant(var->getInit(), ctx);
+  if (!start.has_value()) {
+    return std::nullopt;
+  }
+
+  // The condition must compare the variable against a constant, without
+  // converting a signed variable to unsigned.
+  auto cond = clang::dyn_cast<clang::BinaryOperator>(cond_expr->IgnoreParens());
+  if (cond == nullptr || !is_var(cond->getLHS()->IgnoreImpCasts()) ||
+      (cond->getLHS()->getType()->isUnsignedIntegerType() &&
+       var->getType()->isSignedIntegerType())) {
+    return std::nullopt;
+  }
+  std::optional<int64_t> bound =
+      EvaluateCountedLoopConstant(cond->getRHS(), ctx);
+  if (!bound.has_value()) {
+    return std::nullopt;
+  }
+
+  // The increment must step the variable by a non-zero constant.
+  int64_t step = 0;
+  inc_expr = inc_expr->IgnoreParens();
+  if (auto uop = clang::dyn_cast<clang::UnaryOperator>(inc_expr)) {
+    if (!uop->isIncrementDecrementOp() ||
+        !is_var(uop->getSubExpr()->IgnoreParens())) {
+      return std::nullopt;
+    }
+    step = uop->isIncrementOp() ? 1 : -1;
+  } else if (auto cop = clang::dyn_cast<clang::CompoundAssignOperator>(
+                 inc_expr)) {
+    if ((cop->getOpcode() != clang::BO_AddAssign &&
+         cop->getOpcode() != clang::BO_SubAssign) ||
+        !is_var(cop->getLHS()->IgnoreParens())) {
+      return std::nullopt;
+    }
+    std::optional<int64_t> amount =
+        EvaluateCountedLoopConstant(cop->getRHS(), ctx);
+    if (!amount.has_value()) {
+      return std::nullopt;
+    }
+    step = cop->getOpcode() == clang::BO_AddAssign ? *amount : -*amount;
+  }
+  if (step == 0) {
+    return std::nullopt;
+  }
+
+  InductionVarUseVisitor visitor(var);
+  visitor.TraverseStmt(const_cast<clang::Expr*>(cond_expr));
+  visitor.TraverseStmt(const_cast<clang::Stmt*>(body));
+  if (!visitor.OnlyReadsVar()) {
+    return std::nullopt;
+  }
+
+  int64_t trip_count = 0;
+  switch (cond->getOpcode()) {
+    case clang::BO_LE:
+      ++*bound;
+      [[fallthrough]];
+    case clang::BO_LT:
+      if (step < 0) {
+        return std::nullopt;
+      }
+      if (*start < *bound) {
+        trip_count = (*bound - *start + step - 1) / step;
+      }
+      break;
+    case clang::BO_GE:
+      --*bound;
+      [[fallthrough]];
+    case clang::BO_GT:
+      if (step > 0) {
+        return std::nullopt;
+      }
+      if (*start > *bound) {
+        trip_count = (*start - *bound - step - 1) / -step;
+      }
+      break;
+    case clang::BO_NE:
+      if ((*bound - *start) % step != 0 || (*bound - *start) / step < 0) {
+        return std::nullopt;
+      }
+      trip_count = (*bound - *start) / step;
+      break;
+    default:
+      return std::nullopt;
+  }
+
+  // Values of the variable between the first and the last must then fit in
+  // its type, so the loop cannot wrap around.
+  auto fits_type = [&type](int64_t value) {
+    const int64_t width = type->width();
+    if (!type->is_signed()) {
+      return value >= 0 && (width >= kCountedLoopConstantBits ||
+                            value < (int64_t{1} << width));
+    }
+    return width > kCountedLoopConstantBits ||
+           (value >= -(int64_t{1} << (width - 1)) &&
+            value < (int64_t{1} << (width - 1)));
+  };
+  if (!fits_type(*start) || !fits_type(*start + trip_count * step) ||
+      trip_count > max_unroll_iters_) {
+    return std::nullopt;
+  }
+
+  return CountedLoop{.induction_var = var,
+                     .type = type,
+                     .start = *start,
+                     .step = step,
+                     .trip_count = trip_count};
+}
+
 bool Translator::LValueContainsOnlyChannels(
     const std::shared_ptr<LValue>& lvalue) {
   if (lvalue == nullptr) {
@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <iterator>
 #include <list>
@@ -5884,6 +5885,13 @@ absl::Status Translator::ScanFile(
   return parser_->ScanFile(source_filename, command_line_args);
 }
 
+void Translator::UsePrecompiledHeaders(std::vector<std::string> headers,
+                                       std::filesystem::path cache_directory) {
+  CHECK_NE(parser_.get(), nullptr);
+  parser_->UsePrecompiledHeaders(std::move(headers),
+                                 std::move(cache_directory));
+}
+
 absl::StatusOr<std::string> Translator::GetEntryFunctionName() const {
   CHECK_NE(parser_.get(), nullptr);
   return parser_->GetEntryFunctionName();
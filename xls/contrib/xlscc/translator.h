@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <iostream>
 #include <list>
@@ -1134,6 +1135,10 @@ class Translator {
   absl::Status ScanFile(std::string_view source_filename,
                         absl::Span<std::string_view> command_line_args);
 
+  // See CCParser::UsePrecompiledHeaders()
+  void UsePrecompiledHeaders(std::vector<std::string> headers,
+                             std::filesystem::path cache_directory);
+
   // Call after ScanFile, as the top function may be specified by #pragma
   // If none was found, an error is returned
   absl::StatusOr<std::string> GetEntryFunctionName() const;
@@ -1900,6 +1905,26 @@ class Translator {
                                        const clang::Stmt* body,
                                        clang::ASTContext& ctx,
                                        const xls::SourceInfo& loc);
+
+  // A for loop whose trip count is known before unrolling: an integer
+  // induction variable is declared with a constant initializer, compared
+  // against a constant bound, stepped by a constant, and only read by the
+  // condition and the body.
+  struct CountedLoop {
+    const clang::VarDecl* induction_var;
+    std::shared_ptr<CIntType> type;
+    int64_t start;
+    int64_t step;
+    int64_t trip_count;
+  };
+
+  // Returns std::nullopt if the loop is not a counted loop, in which case the
+  // condition must be evaluated at each unrolled iteration.
+  absl::StatusOr<std::optional<CountedLoop>> AnalyzeCountedLoop(
+      const clang::Stmt* init, const clang::Expr* cond_expr,
+      const clang::Stmt* inc, const clang::Stmt* body, clang::ASTContext& ctx,
+      const xls::SourceInfo& loc);
+
   // init, cond, and inc can be nullptr
   absl::Status GenerateIR_PipelinedLoop(
       bool always_first_iter, const clang::Stmt* init,
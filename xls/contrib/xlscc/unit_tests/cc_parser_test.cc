@@ -15,15 +15,21 @@
 #include "xls/contrib/xlscc/cc_parser.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/unit_tests/unit_test.h"
@@ -965,4 +971,38 @@ TEST_F(CCParserTest, TemplateArgsCanBeInferred) {
       ScanTempFileWithContent(cpp_src, {}, &parser, /*top_name=*/"top"));
 }
 
+TEST_F(CCParserTest, PrecompiledHeaderKeepsPragmas) {
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempDirectory cache,
+                           xls::TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile header,
+                           xls::TempFile::CreateWithContent(R"(
+    #ifndef FOO_H
+    #define FOO_H
+    #pragma hls_top
+    int foo(int a, int b) {
+      return a + b;
+    }
+    #endif
+  )",
+                                                            ".h"));
+  const std::string cpp_src =
+      absl::StrFormat("#include \"%s\"\n", header.path().string());
+
+  // The first parse builds the precompiled header, and the second uses it.
+  for (int64_t i = 0; i < 2; ++i) {
+    xlscc::CCParser parser;
+    parser.UsePrecompiledHeaders({header.path().string()}, cache.path());
+    XLS_ASSERT_OK(
+        ScanTempFileWithContent(cpp_src, {}, &parser, /*top_name=*/nullptr));
+    XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+    ASSERT_NE(top_ptr, nullptr);
+    EXPECT_EQ(top_ptr->getNameAsString(), "foo");
+  }
+
+  // The precompiled header and its pragmas.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           xls::GetDirectoryEntries(cache.path()));
+  EXPECT_EQ(entries.size(), 2);
+}
+
 }  // namespace
@@ -1821,6 +1821,31 @@ TEST_F(TranslatorLogicTest, ForNestedUnroll) {
   Run({{"a", 200}, {"b", 20}}, 1000, content);
 }
 
+TEST_F(TranslatorLogicTest, ForUnrollCountedDown) {
+  std::string_view content = R"(
+      long long my_package(long long a, long long b) {
+        #pragma hls_unroll yes
+        for(int i=10;i>=0;i-=3) {
+          a += i*b;
+        }
+        return a;
+      })";
+  Run({{"a", 1}, {"b", 2}}, 45, content);
+}
+
+TEST_F(TranslatorLogicTest, ForUnrollCountedIndex) {
+  std::string_view content = R"(
+      long long my_package(long long a, long long b) {
+        int arr[4] = {1, 2, 3, 4};
+        #pragma hls_unroll yes
+        for(unsigned i=0;i!=4;++i) {
+          a += arr[i] * b;
+        }
+        return a;
+      })";
+  Run({{"a", 5}, {"b", 3}}, 35, content);
+}
+
 TEST_F(TranslatorLogicTest, ForUnrollInfinite) {
   std::string_view content = R"(
        long long my_package(long long a, long long b) {
@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_ADJACENCY_BITMAP_H_
+#define XLS_DATA_STRUCTURES_ADJACENCY_BITMAP_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+
+// An undirected graph over the vertices [0, n), stored as a row of n bits per
+// vertex: vertices i and j are adjacent iff adjacency[i].Get(j), which must
+// be the same as adjacency[j].Get(i). Vertices must not be adjacent to
+// themselves.
+using AdjacencyBitmap = std::vector<InlineBitmap>;
+
+// Returns the number of bits set in both bitmaps, which must be the same size.
+inline int64_t CountCommonBits(const InlineBitmap& a, const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t wordno = 0; wordno < a.word_count(); ++wordno) {
+    count += absl::popcount(a.GetWord(wordno) & b.GetWord(wordno));
+  }
+  return count;
+}
+
+// Calls f on the index of each set bit of the bitmap, in increasing order.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  constexpr int64_t kBitsPerWord = 64;
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    for (uint64_t word = bitmap.GetWord(wordno); word != 0; word &= word - 1) {
+      f(wordno * kBitsPerWord + absl::countr_zero(word));
+    }
+  }
+}
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_ADJACENCY_BITMAP_H_
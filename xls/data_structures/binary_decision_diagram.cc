@@ -29,8 +29,16 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
+namespace {
+
+// While sifting a variable, stop moving it in a direction once the BDD grows
+// to this multiple of the smallest size seen.
+constexpr int64_t kMaxSiftingGrowth = 2;
+
+}  // namespace
 
 BinaryDecisionDiagram::BinaryDecisionDiagram() {
   // Leaf node 0.
@@ -70,7 +78,7 @@ BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
   }
 
   const BddNode& node = GetNode(expr);
-  CHECK_LE(var, node.variable);
+  CHECK_LE(level(var), level(node.variable));
   if (node.variable == var) {
     return value ? node.high : node.low;
   }
@@ -102,15 +110,15 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   // decompose the expression by peeling away the first variable and performing
   // a Shannon decomposition.
 
-  // First, find the lowest-index variable amongst all expressions. In all paths
-  // through the BDD the variable indices are strictly increasing.
+  // First, find the lowest-level variable amongst all expressions. In all
+  // paths through the BDD the variable levels are strictly increasing.
   BddVariable min_var = GetNode(cond).variable;
   // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
-    min_var = std::min(min_var, GetNode(if_true).variable);
-  }
-  if (if_false != zero() && if_false != one()) {
-    min_var = std::min(min_var, GetNode(if_false).variable);
+  for (BddNodeIndex expr : {if_true, if_false}) {
+    if (expr != zero() && expr != one() &&
+        level(GetNode(expr).variable) < level(min_var)) {
+      min_var = GetNode(expr).variable;
+    }
   }
 
   // Perform a Shannon expansion about the variable where Shannon expansion is
@@ -137,9 +145,214 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
+  var_to_level_.push_back(level_to_var_.size());
+  level_to_var_.push_back(var);
   return GetOrCreateNode(var, one(), zero());
 }
 
+std::vector<bool> BinaryDecisionDiagram::MarkLiveNodes(
+    absl::Span<const BddNodeIndex> roots) const {
+  std::vector<bool> live(nodes_.size(), false);
+  std::vector<BddNodeIndex> worklist(roots.begin(), roots.end());
+  worklist.push_back(zero());
+  worklist.push_back(one());
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    if (IsVariableBaseNode(BddNodeIndex(i))) {
+      worklist.push_back(BddNodeIndex(i));
+    }
+  }
+  while (!worklist.empty()) {
+    BddNodeIndex expr = worklist.back();
+    worklist.pop_back();
+    if (live[expr.value()]) {
+      continue;
+    }
+    live[expr.value()] = true;
+    if (expr != zero() && expr != one()) {
+      worklist.push_back(GetNode(expr).high);
+      worklist.push_back(GetNode(expr).low);
+    }
+  }
+  return live;
+}
+
+int64_t BinaryDecisionDiagram::LiveNodeCount(
+    absl::Span<const BddNodeIndex> roots) const {
+  std::vector<bool> live = MarkLiveNodes(roots);
+  return std::count(live.begin(), live.end(), true);
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(absl::Span<BddNodeIndex> roots) {
+  std::vector<bool> live = MarkLiveNodes(roots);
+  std::vector<BddNodeIndex> new_index(nodes_.size(), BddNodeIndex(-1));
+  int32_t live_count = 0;
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    if (live[i]) {
+      new_index[i] = BddNodeIndex(live_count++);
+    }
+  }
+  int64_t removed = nodes_.size() - live_count;
+  if (removed == 0) {
+    return 0;
+  }
+  auto remap = [&](BddNodeIndex expr) { return new_index[expr.value()]; };
+  auto is_live = [&](BddNodeIndex expr) { return live[expr.value()]; };
+
+  // The terminals are always live so keep their indices.
+  std::vector<BddNode> new_nodes = {nodes_[0], nodes_[1]};
+  new_nodes.reserve(live_count);
+  node_map_.clear();
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    if (!live[i]) {
+      continue;
+    }
+    BddNode node = nodes_[i];
+    node.high = remap(node.high);
+    node.low = remap(node.low);
+    node_map_[{node.variable, node.high, node.low}] =
+        BddNodeIndex(new_nodes.size());
+    new_nodes.push_back(node);
+  }
+  nodes_ = std::move(new_nodes);
+
+  // Keep the cached results which only refer to live nodes.
+  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map;
+  for (const auto& [key, expr] : ite_map_) {
+    const auto& [cond, if_true, if_false] = key;
+    if (is_live(cond) && is_live(if_true) && is_live(if_false) &&
+        is_live(expr)) {
+      ite_map[{remap(cond), remap(if_true), remap(if_false)}] = remap(expr);
+    }
+  }
+  ite_map_ = std::move(ite_map);
+
+  for (BddNodeIndex& root : roots) {
+    root = remap(root);
+  }
+  VLOG(3) << absl::StreamFormat("Garbage collected %d BDD nodes, %d remain",
+                                removed, nodes_.size());
+  return removed;
+}
+
+void BinaryDecisionDiagram::SwapAdjacentLevels(int64_t level) {
+  BddVariable x = level_to_var_.at(level);
+  BddVariable y = level_to_var_.at(level + 1);
+  auto has_var = [&](BddNodeIndex expr, BddVariable var) {
+    return expr != zero() && expr != one() && GetNode(expr).variable == var;
+  };
+  // A node for `x` whose children depend on `y` computes
+  //
+  //   x ? (y ? f11 : f10) : (y ? f01 : f00)
+  //
+  // which is rewritten in place as
+  //
+  //   y ? (x ? f11 : f01) : (x ? f10 : f00).
+  //
+  // Nodes for `x` which don't depend on `y`, and nodes for `y`, are unchanged
+  // by the swap. New nodes are appended, so only the existing nodes need to be
+  // visited.
+  int64_t node_count = nodes_.size();
+  for (int64_t i = 2; i < node_count; ++i) {
+    if (nodes_[i].variable != x) {
+      continue;
+    }
+    BddNodeIndex high = nodes_[i].high;
+    BddNodeIndex low = nodes_[i].low;
+    bool high_has_y = has_var(high, y);
+    bool low_has_y = has_var(low, y);
+    if (!high_has_y && !low_has_y) {
+      continue;
+    }
+    BddNodeIndex f11 = high_has_y ? GetNode(high).high : high;
+    BddNodeIndex f10 = high_has_y ? GetNode(high).low : high;
+    BddNodeIndex f01 = low_has_y ? GetNode(low).high : low;
+    BddNodeIndex f00 = low_has_y ? GetNode(low).low : low;
+    node_map_.erase({x, high, low});
+    BddNodeIndex new_high = GetOrCreateNode(x, f11, f01);
+    BddNodeIndex new_low = GetOrCreateNode(x, f10, f00);
+    nodes_[i].variable = y;
+    nodes_[i].high = new_high;
+    nodes_[i].low = new_low;
+    bool inserted =
+        node_map_.insert({{y, new_high, new_low}, BddNodeIndex(i)}).second;
+    DCHECK(inserted);
+  }
+  std::swap(level_to_var_[level], level_to_var_[level + 1]);
+  var_to_level_[x.value()] = level + 1;
+  var_to_level_[y.value()] = level;
+}
+
+void BinaryDecisionDiagram::RecomputePathCounts() {
+  // Children are at strictly greater levels than their parents.
+  std::vector<int64_t> order;
+  order.reserve(nodes_.size());
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return level(nodes_[a].variable) > level(nodes_[b].variable);
+  });
+  for (int64_t i : order) {
+    BddNode& node = nodes_[i];
+    node.path_count = std::min(
+        static_cast<int64_t>(GetNode(node.low).path_count) +
+            GetNode(node.high).path_count,
+        static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
+  }
+}
+
+void BinaryDecisionDiagram::SiftVariables(absl::Span<BddNodeIndex> roots) {
+  GarbageCollect(roots);
+  int64_t var_count = variable_count();
+  if (var_count < 2) {
+    return;
+  }
+  // Sift the variables with the most nodes first.
+  std::vector<int64_t> var_node_counts(var_count, 0);
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    ++var_node_counts[nodes_[i].variable.value()];
+  }
+  std::vector<BddVariable> vars;
+  for (int64_t i = 0; i < var_count; ++i) {
+    vars.push_back(BddVariable(i));
+  }
+  std::stable_sort(vars.begin(), vars.end(), [&](BddVariable a, BddVariable b) {
+    return var_node_counts[a.value()] > var_node_counts[b.value()];
+  });
+
+  for (BddVariable var : vars) {
+    int64_t best_size = LiveNodeCount(roots);
+    int64_t best_level = level(var);
+    // Swaps the levels `l` and `l + 1`, returning whether the BDD is still
+    // small enough to keep moving `var` in the same direction.
+    auto swap = [&](int64_t l) {
+      SwapAdjacentLevels(l);
+      int64_t size = LiveNodeCount(roots);
+      if (size < best_size) {
+        best_size = size;
+        best_level = level(var);
+      }
+      if (nodes_.size() > 2 * size) {
+        GarbageCollect(roots);
+      }
+      return size <= kMaxSiftingGrowth * best_size;
+    };
+    while (level(var) < var_count - 1 && swap(level(var))) {
+    }
+    while (level(var) > 0 && swap(level(var) - 1)) {
+    }
+    while (level(var) < best_level) {
+      SwapAdjacentLevels(level(var));
+    }
+    while (level(var) > best_level) {
+      SwapAdjacentLevels(level(var) - 1);
+    }
+    GarbageCollect(roots);
+  }
+  RecomputePathCounts();
+  VLOG(2) << absl::StreamFormat("Sifted BDD to %d nodes", nodes_.size());
+}
+
 BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
   return IfThenElse(expr, zero(), one());
 }
@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -98,6 +99,14 @@ class BinaryDecisionDiagram {
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
 
+  // Returns the position of the given variable in the variable order. Along
+  // every path from a node to the terminal nodes the levels of the variables
+  // are strictly increasing. Variables are initially ordered by creation, and
+  // may be reordered by SiftVariables.
+  int64_t level(BddVariable variable) const {
+    return var_to_level_.at(variable.value());
+  }
+
   // Returns the number of paths in the given expression.
   int64_t path_count(BddNodeIndex expr) const {
     return GetNode(expr).path_count;
@@ -119,6 +128,25 @@ class BinaryDecisionDiagram {
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Removes every node which is not reachable from `roots`, compacting the
+  // remaining nodes, and rewrites each element of `roots` to the new index of
+  // the node it referred to. Nodes are only ever appended otherwise, so
+  // clients which build and discard many intermediate expressions should call
+  // this periodically with every node index they hold; any index not passed
+  // in `roots` is invalidated. Variable base nodes are always retained.
+  // Returns the number of nodes removed.
+  int64_t GarbageCollect(absl::Span<BddNodeIndex> roots);
+
+  // Reorders the variables to reduce the number of nodes reachable from
+  // `roots` using Rudell's sifting algorithm: each variable in turn is moved
+  // through every level of the order by swapping adjacent levels, and left at
+  // the level which minimizes the size of the BDD. The expressions of the
+  // nodes are unchanged, but because nodes are rewritten and garbage
+  // collected, `roots` is rewritten as by GarbageCollect. Path counts are
+  // recomputed for the new order. Each swap is linear in the size of the BDD
+  // so this is quadratic in the number of variables.
+  void SiftVariables(absl::Span<BddNodeIndex> roots);
+
  private:
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
@@ -139,10 +167,26 @@ class BinaryDecisionDiagram {
     return node_map_.at({variable, one(), zero()});
   }
 
+  // Returns whether each node is reachable from `roots` or is a variable base
+  // node or terminal.
+  std::vector<bool> MarkLiveNodes(absl::Span<const BddNodeIndex> roots) const;
+  int64_t LiveNodeCount(absl::Span<const BddNodeIndex> roots) const;
+
+  // Swaps the variables at `level` and `level + 1` in the variable order,
+  // rewriting nodes in place so that every node index keeps its expression.
+  void SwapAdjacentLevels(int64_t level);
+
+  // Recomputes the path counts of every node from its children.
+  void RecomputePathCounts();
+
   // The numeric id to use for the next created variable. Increments with each
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
+  // The level of each variable in the variable order, and its inverse.
+  std::vector<int64_t> var_to_level_;
+  std::vector<BddVariable> level_to_var_;
+
   // The vector of all the nodes in the BDD.
   std::vector<BddNode> nodes_;
 
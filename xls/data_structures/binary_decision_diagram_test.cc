@@ -15,6 +15,7 @@
 #include "xls/data_structures/binary_decision_diagram.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <limits>
 #include <string>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 
 namespace xls {
@@ -314,5 +316,116 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+// Returns the truth table of `expr` over `vars`, where bit i of the index of
+// each entry gives the value of vars[i].
+std::vector<bool> TruthTable(const BinaryDecisionDiagram& bdd,
+                             BddNodeIndex expr,
+                             const std::vector<BddNodeIndex>& vars) {
+  std::vector<bool> table;
+  for (int64_t assignment = 0; assignment < (int64_t{1} << vars.size());
+       ++assignment) {
+    absl::flat_hash_map<BddNodeIndex, bool> values;
+    for (int64_t i = 0; i < vars.size(); ++i) {
+      values[vars[i]] = ((assignment >> i) & 1) != 0;
+    }
+    table.push_back(bdd.Evaluate(expr, values).value());
+  }
+  return table;
+}
+
+// Returns (a0 & b0) | (a1 & b1) | ... for `n` pairs of variables, with all of
+// the a's ordered before the b's. This order makes the BDD exponential in `n`,
+// while interleaving the pairs makes it linear. `vars` is set to the variables
+// in the order a0, b0, a1, b1, ... .
+BddNodeIndex PairwiseOr(BinaryDecisionDiagram& bdd, int64_t n,
+                        std::vector<BddNodeIndex>& vars) {
+  std::vector<BddNodeIndex> a;
+  std::vector<BddNodeIndex> b;
+  for (int64_t i = 0; i < n; ++i) {
+    a.push_back(bdd.NewVariable());
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    b.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex result = bdd.zero();
+  for (int64_t i = 0; i < n; ++i) {
+    result = bdd.Or(result, bdd.And(a[i], b[i]));
+    vars.push_back(a[i]);
+    vars.push_back(b[i]);
+  }
+  return result;
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  BddNodeIndex discarded = PairwiseOr(bdd, 3, vars);
+  BddNodeIndex kept = bdd.And(vars[0], bdd.Not(vars[5]));
+  std::vector<bool> discarded_table = TruthTable(bdd, discarded, vars);
+  std::vector<bool> kept_table = TruthTable(bdd, kept, vars);
+  int64_t size = bdd.size();
+
+  std::vector<BddNodeIndex> roots = vars;
+  roots.push_back(kept);
+  int64_t removed = bdd.GarbageCollect(absl::MakeSpan(roots));
+  EXPECT_GT(removed, 0);
+  EXPECT_EQ(bdd.size(), size - removed);
+  // Nothing more to collect.
+  EXPECT_EQ(bdd.GarbageCollect(absl::MakeSpan(roots)), 0);
+  kept = roots.back();
+  roots.pop_back();
+  vars = roots;
+  for (BddNodeIndex var : vars) {
+    EXPECT_TRUE(bdd.IsVariableBaseNode(var));
+  }
+  EXPECT_EQ(TruthTable(bdd, kept, vars), kept_table);
+  EXPECT_EQ(bdd.path_count(kept), 3);
+
+  // Rebuilding the discarded expression works as before.
+  BddNodeIndex rebuilt = bdd.zero();
+  for (int64_t i = 0; i < 3; ++i) {
+    rebuilt = bdd.Or(rebuilt, bdd.And(vars[2 * i], vars[2 * i + 1]));
+  }
+  EXPECT_EQ(TruthTable(bdd, rebuilt, vars), discarded_table);
+}
+
+TEST(BinaryDecisionDiagramTest, SiftVariables) {
+  constexpr int64_t kPairs = 4;
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  BddNodeIndex expr = PairwiseOr(bdd, kPairs, vars);
+  std::vector<bool> table = TruthTable(bdd, expr, vars);
+
+  std::vector<BddNodeIndex> roots = vars;
+  roots.push_back(expr);
+  bdd.GarbageCollect(absl::MakeSpan(roots));
+  int64_t size = bdd.size();
+  int64_t path_count = bdd.path_count(roots.back());
+
+  bdd.SiftVariables(absl::MakeSpan(roots));
+  expr = roots.back();
+  roots.pop_back();
+  vars = roots;
+  EXPECT_LT(bdd.size(), size);
+  EXPECT_LT(bdd.path_count(expr), path_count);
+  EXPECT_EQ(TruthTable(bdd, expr, vars), table);
+
+  // Each pair of variables is adjacent in the sifted order.
+  for (int64_t i = 0; i < kPairs; ++i) {
+    EXPECT_EQ(std::abs(bdd.level(bdd.GetNode(vars[2 * i]).variable) -
+                       bdd.level(bdd.GetNode(vars[2 * i + 1]).variable)),
+              1)
+        << i;
+  }
+
+  // Operations use the new order.
+  BddNodeIndex conjunction = bdd.And(expr, bdd.Not(vars[0]));
+  std::vector<bool> expected = table;
+  for (int64_t i = 0; i < expected.size(); ++i) {
+    expected[i] = expected[i] && (i & 1) == 0;
+  }
+  EXPECT_EQ(TruthTable(bdd, conjunction, vars), expected);
+}
+
 }  // namespace
 }  // namespace xls
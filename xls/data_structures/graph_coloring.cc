@@ -0,0 +1,382 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/adjacency_bitmap.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kBitsPerWord = 64;
+
+// Returns the number of colors used by a coloring.
+int64_t ColorCount(const std::vector<int64_t>& coloring) {
+  return coloring.empty()
+             ? 0
+             : *std::max_element(coloring.begin(), coloring.end()) + 1;
+}
+
+// Finds a maximal independent set in the subgraph induced by `vertices`,
+// making the same choices as FindMaximalIndependentSet.
+InlineBitmap FindMaximalIndependentSet(const AdjacencyBitmap& adjacency,
+                                       const InlineBitmap& vertices) {
+  const int64_t n = adjacency.size();
+  InlineBitmap result(n);              // named S in the book
+  InlineBitmap available = vertices;   // named X
+  InlineBitmap neighboring_result(n);  // named Y
+
+  auto add_to_result = [&](int64_t vertex) {
+    result.Set(vertex);
+    InlineBitmap neighbors = adjacency[vertex];
+    neighbors.Intersect(vertices);
+    neighboring_result.Union(neighbors);
+    available.Set(vertex, false);
+  };
+
+  // Initialize result to contain only the vertex with highest degree.
+  {
+    int64_t largest_neighborhood = 0;
+    int64_t vertex_with_most_neighbors = -1;
+    ForEachSetBit(available, [&](int64_t vertex) {
+      int64_t neighborhood_size = CountCommonBits(adjacency[vertex], vertices);
+      if (neighborhood_size >= largest_neighborhood) {
+        largest_neighborhood = neighborhood_size;
+        vertex_with_most_neighbors = vertex;
+      }
+    });
+    CHECK_NE(vertex_with_most_neighbors, -1);
+    add_to_result(vertex_with_most_neighbors);
+  }
+
+  while (!available.IsAllZeroes()) {
+    // Choose the vertex with the most neighbors in Y, breaking ties by the
+    // fewest neighbors in X.
+    std::pair<int64_t, int64_t> measure = {-1, -1};
+    int64_t best = -1;
+    ForEachSetBit(available, [&](int64_t vertex) {
+      if (neighboring_result.Get(vertex)) {
+        return;
+      }
+      std::pair<int64_t, int64_t> vertex_measure{
+          CountCommonBits(adjacency[vertex], neighboring_result),
+          -CountCommonBits(adjacency[vertex], available)};
+      if (vertex_measure > measure) {
+        best = vertex;
+        measure = vertex_measure;
+      }
+    });
+    if (best == -1) {
+      break;
+    }
+    add_to_result(best);
+  }
+
+  return result;
+}
+
+// Returns the number of vertices of a clique of the graph, found greedily by
+// adding the candidate with the most candidate neighbors.
+int64_t GreedyCliqueSize(const AdjacencyBitmap& adjacency) {
+  const int64_t n = adjacency.size();
+  InlineBitmap candidates(n, /*fill=*/true);
+  int64_t clique_size = 0;
+  while (!candidates.IsAllZeroes()) {
+    int64_t best = -1;
+    int64_t best_degree = -1;
+    ForEachSetBit(candidates, [&](int64_t vertex) {
+      int64_t degree = CountCommonBits(adjacency[vertex], candidates);
+      if (degree > best_degree) {
+        best = vertex;
+        best_degree = degree;
+      }
+    });
+    ++clique_size;
+    candidates.Intersect(adjacency[best]);
+  }
+  return clique_size;
+}
+
+// Searches for a coloring with fewer colors than the best one known, trying
+// the colors of each vertex in DSatur order and pruning colorings which use
+// as many colors as the best one.
+class BranchAndBoundColoring {
+ public:
+  BranchAndBoundColoring(const AdjacencyBitmap& adjacency, int64_t lower_bound,
+                         absl::Time deadline, std::vector<int64_t>& best)
+      : adjacency_(adjacency),
+        lower_bound_(lower_bound),
+        deadline_(deadline),
+        best_(best),
+        best_count_(ColorCount(best)),
+        color_(adjacency.size(), -1) {}
+
+  // Returns true if the search finished before the deadline, proving the best
+  // coloring optimal.
+  bool Run() {
+    Search(/*colored_count=*/0, /*used_count=*/0);
+    return !timed_out_;
+  }
+
+ private:
+  // How many search nodes are visited between reads of the clock.
+  static constexpr int64_t kNodesPerDeadlineCheck = 1024;
+
+  void Search(int64_t colored_count, int64_t used_count) {
+    if (timed_out_ || best_count_ == lower_bound_) {
+      return;
+    }
+    if (++node_count_ % kNodesPerDeadlineCheck == 0 &&
+        absl::Now() > deadline_) {
+      timed_out_ = true;
+      return;
+    }
+    const int64_t n = adjacency_.size();
+    if (colored_count == n) {
+      best_ = color_;
+      best_count_ = used_count;
+      return;
+    }
+
+    // Choose the uncolored vertex with the most distinct neighbor colors,
+    // then the most uncolored neighbors.
+    std::vector<bool> neighbor_colors;
+    std::pair<int64_t, int64_t> best_measure = {-1, -1};
+    int64_t vertex = -1;
+    for (int64_t v = 0; v < n; ++v) {
+      if (color_[v] != -1) {
+        continue;
+      }
+      neighbor_colors.assign(used_count, false);
+      std::pair<int64_t, int64_t> measure = {0, 0};
+      ForEachSetBit(adjacency_[v], [&](int64_t neighbor) {
+        if (color_[neighbor] == -1) {
+          ++measure.second;
+        } else if (!neighbor_colors[color_[neighbor]]) {
+          neighbor_colors[color_[neighbor]] = true;
+          ++measure.first;
+        }
+      });
+      if (measure > best_measure) {
+        best_measure = measure;
+        vertex = v;
+      }
+    }
+
+    neighbor_colors.assign(used_count, false);
+    ForEachSetBit(adjacency_[vertex], [&](int64_t neighbor) {
+      if (color_[neighbor] != -1) {
+        neighbor_colors[color_[neighbor]] = true;
+      }
+    });
+    for (int64_t color = 0; color < used_count; ++color) {
+      if (!neighbor_colors[color]) {
+        color_[vertex] = color;
+        Search(colored_count + 1, used_count);
+      }
+    }
+    if (used_count + 1 < best_count_) {
+      color_[vertex] = used_count;
+      Search(colored_count + 1, used_count + 1);
+    }
+    color_[vertex] = -1;
+  }
+
+  const AdjacencyBitmap& adjacency_;
+  const int64_t lower_bound_;
+  const absl::Time deadline_;
+  std::vector<int64_t>& best_;
+  int64_t best_count_;
+  std::vector<int64_t> color_;
+  int64_t node_count_ = 0;
+  bool timed_out_ = false;
+};
+
+// Colors a connected graph, see ExactColoring.
+std::vector<int64_t> ColorComponent(const AdjacencyBitmap& adjacency,
+                                    absl::Time deadline,
+                                    int64_t max_z3_vertex_count) {
+  std::vector<int64_t> best = RecursiveLargestFirstColoring(adjacency);
+  std::vector<int64_t> dsatur = DSaturColoring(adjacency);
+  if (ColorCount(dsatur) < ColorCount(best)) {
+    best = std::move(dsatur);
+  }
+
+  int64_t lower_bound = GreedyCliqueSize(adjacency);
+  if (ColorCount(best) == lower_bound) {
+    return best;
+  }
+  if (BranchAndBoundColoring(adjacency, lower_bound, deadline, best).Run()) {
+    return best;
+  }
+
+  // The search ran out of time, so leave small components to Z3.
+  const int64_t n = adjacency.size();
+  if (n > max_z3_vertex_count) {
+    return best;
+  }
+  absl::flat_hash_set<int64_t> vertices;
+  for (int64_t v = 0; v < n; ++v) {
+    vertices.insert(v);
+  }
+  std::vector<absl::flat_hash_set<int64_t>> color_classes =
+      Z3Coloring<int64_t>(vertices, [&](const int64_t& v) {
+        absl::flat_hash_set<int64_t> neighbors;
+        ForEachSetBit(adjacency[v],
+                      [&](int64_t neighbor) { neighbors.insert(neighbor); });
+        return neighbors;
+      });
+  std::vector<int64_t> z3_coloring(n, -1);
+  int64_t color_count = 0;
+  for (const absl::flat_hash_set<int64_t>& color_class : color_classes) {
+    if (color_class.empty()) {
+      continue;
+    }
+    for (int64_t v : color_class) {
+      z3_coloring[v] = color_count;
+    }
+    ++color_count;
+  }
+  if (color_count < ColorCount(best)) {
+    return z3_coloring;
+  }
+  return best;
+}
+
+}  // namespace
+
+std::vector<int64_t> RecursiveLargestFirstColoring(
+    const AdjacencyBitmap& adjacency) {
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> coloring(n, -1);
+  InlineBitmap available(n, /*fill=*/true);
+  for (int64_t color = 0; !available.IsAllZeroes(); ++color) {
+    // Find the maximal independent set in the subgraph induced by `available`.
+    InlineBitmap chosen = FindMaximalIndependentSet(adjacency, available);
+    ForEachSetBit(chosen, [&](int64_t vertex) {
+      coloring[vertex] = color;
+      available.Set(vertex, false);
+    });
+  }
+  return coloring;
+}
+
+std::vector<int64_t> DSaturColoring(const AdjacencyBitmap& adjacency) {
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> coloring(n, -1);
+  // The colors of the neighbors of each vertex, and how many there are.
+  std::vector<InlineBitmap> neighbor_colors(n, InlineBitmap(n));
+  std::vector<int64_t> saturation(n, 0);
+  std::vector<int64_t> uncolored_degree(n);
+  for (int64_t v = 0; v < n; ++v) {
+    CHECK_EQ(adjacency[v].bit_count(), n);
+    uncolored_degree[v] = CountCommonBits(adjacency[v], adjacency[v]);
+  }
+
+  for (int64_t step = 0; step < n; ++step) {
+    int64_t vertex = -1;
+    for (int64_t v = 0; v < n; ++v) {
+      if (coloring[v] != -1) {
+        continue;
+      }
+      if (vertex == -1 ||
+          std::make_pair(saturation[v], uncolored_degree[v]) >
+              std::make_pair(saturation[vertex], uncolored_degree[vertex])) {
+        vertex = v;
+      }
+    }
+
+    // A vertex has fewer than n neighbors, so a free color is always found.
+    int64_t color = -1;
+    const InlineBitmap& used = neighbor_colors[vertex];
+    for (int64_t wordno = 0; color == -1; ++wordno) {
+      uint64_t free = ~used.GetWord(wordno);
+      if (free != 0) {
+        color = wordno * kBitsPerWord + absl::countr_zero(free);
+      }
+    }
+    coloring[vertex] = color;
+
+    ForEachSetBit(adjacency[vertex], [&](int64_t neighbor) {
+      if (coloring[neighbor] != -1) {
+        return;
+      }
+      --uncolored_degree[neighbor];
+      if (!neighbor_colors[neighbor].Get(color)) {
+        neighbor_colors[neighbor].Set(color);
+        ++saturation[neighbor];
+      }
+    });
+  }
+  return coloring;
+}
+
+std::vector<int64_t> ExactColoring(const AdjacencyBitmap& adjacency,
+                                   absl::Duration time_limit,
+                                   int64_t max_z3_vertex_count) {
+  const int64_t n = adjacency.size();
+  const absl::Time deadline = absl::Now() + time_limit;
+  std::vector<int64_t> coloring(n, -1);
+
+  // Color each connected component on its own, renumbering its vertices.
+  InlineBitmap unvisited(n, /*fill=*/true);
+  std::vector<int64_t> local_index(n, -1);
+  for (int64_t root = 0; root < n; ++root) {
+    if (!unvisited.Get(root)) {
+      continue;
+    }
+    std::vector<int64_t> members = {root};
+    unvisited.Set(root, false);
+    for (int64_t i = 0; i < members.size(); ++i) {
+      ForEachSetBit(adjacency[members[i]], [&](int64_t neighbor) {
+        if (unvisited.Get(neighbor)) {
+          unvisited.Set(neighbor, false);
+          members.push_back(neighbor);
+        }
+      });
+    }
+    std::sort(members.begin(), members.end());
+
+    const int64_t m = members.size();
+    for (int64_t i = 0; i < m; ++i) {
+      local_index[members[i]] = i;
+    }
+    AdjacencyBitmap component(m, InlineBitmap(m));
+    for (int64_t i = 0; i < m; ++i) {
+      ForEachSetBit(adjacency[members[i]], [&](int64_t neighbor) {
+        component[i].Set(local_index[neighbor]);
+      });
+    }
+
+    std::vector<int64_t> component_coloring =
+        ColorComponent(component, deadline, max_z3_vertex_count);
+    for (int64_t i = 0; i < m; ++i) {
+      coloring[members[i]] = component_coloring[i];
+    }
+  }
+  return coloring;
+}
+
+}  // namespace xls
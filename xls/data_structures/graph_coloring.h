@@ -29,7 +29,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "external/z3/src/api/c++/z3++.h"
+#include "xls/data_structures/adjacency_bitmap.h"
 
 namespace xls {
 
@@ -227,6 +229,43 @@ std::vector<absl::flat_hash_set<V>> Z3Coloring(
   return result;
 }
 
+// Color the given graph using the Recursive Largest First (RLF) algorithm.
+//
+// This is the same algorithm as the RecursiveLargestFirstColoring above, with
+// the same choices, but the neighborhoods are intersected and counted a word
+// at a time. Given the vertex indices as integer vertices, the template
+// version finds the same color classes in the same order.
+//
+// Returns the color of each vertex; colors are numbered from zero.
+std::vector<int64_t> RecursiveLargestFirstColoring(
+    const AdjacencyBitmap& adjacency);
+
+// Color the given graph using the DSatur algorithm: the uncolored vertex with
+// the most distinct colors among its neighbors (ties broken by the number of
+// uncolored neighbors, then by the lowest index) is given the lowest color
+// not used by its neighbors.
+//
+// This algorithm is explained on page 39 of "Guide to Graph Colouring" second
+// edition by R. M. R. Lewis. https://doi.org/10.1007%2F978-3-030-81054-2
+//
+// Returns the color of each vertex; colors are numbered from zero.
+std::vector<int64_t> DSaturColoring(const AdjacencyBitmap& adjacency);
+
+// Color the given graph with as few colors as can be found within a time
+// limit.
+//
+// Each connected component is colored with the better of the RLF and DSatur
+// colorings, which is optimal if it uses as many colors as a clique of the
+// component has vertices. Otherwise a branch and bound search over DSatur
+// orders looks for a better coloring until the time limit (shared by all
+// components) runs out. Components the search could not prove optimal which
+// have at most max_z3_vertex_count vertices are then colored by Z3Coloring.
+//
+// Returns the color of each vertex; colors are numbered from zero.
+std::vector<int64_t> ExactColoring(const AdjacencyBitmap& adjacency,
+                                   absl::Duration time_limit,
+                                   int64_t max_z3_vertex_count = 32);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
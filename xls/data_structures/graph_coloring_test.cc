@@ -14,12 +14,18 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
 #include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -143,5 +149,184 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+// Returns the graph as an adjacency bitmap over the vertices in sorted order.
+AdjacencyBitmap BitmapFromMap(
+    const absl::flat_hash_map<V, absl::flat_hash_set<V>>& neighborhood) {
+  absl::btree_set<V> nodes;
+  for (const auto& [node, neighbors] : neighborhood) {
+    for (const auto& neighbor : neighbors) {
+      nodes.insert(node);
+      nodes.insert(neighbor);
+    }
+  }
+  std::vector<V> ordered_nodes(nodes.begin(), nodes.end());
+  auto index = [&](const V& node) {
+    return std::lower_bound(ordered_nodes.begin(), ordered_nodes.end(), node) -
+           ordered_nodes.begin();
+  };
+  AdjacencyBitmap adjacency(ordered_nodes.size(),
+                            InlineBitmap(ordered_nodes.size()));
+  for (const auto& [node, neighbors] : neighborhood) {
+    for (const auto& neighbor : neighbors) {
+      adjacency[index(node)].Set(index(neighbor));
+      adjacency[index(neighbor)].Set(index(node));
+    }
+  }
+  return adjacency;
+}
+
+// Returns the number of colors used, or -1 if the coloring is invalid.
+int64_t CheckedColorCount(const AdjacencyBitmap& adjacency,
+                          const std::vector<int64_t>& coloring) {
+  if (coloring.size() != adjacency.size()) {
+    return -1;
+  }
+  int64_t color_count = 0;
+  for (int64_t i = 0; i < adjacency.size(); ++i) {
+    if (coloring[i] < 0) {
+      return -1;
+    }
+    color_count = std::max(color_count, coloring[i] + 1);
+    for (int64_t j = 0; j < adjacency.size(); ++j) {
+      if (adjacency[i].Get(j) && coloring[i] == coloring[j]) {
+        return -1;
+      }
+    }
+  }
+  return color_count;
+}
+
+// Returns a random graph over n vertices with each edge present with
+// probability percent / 100.
+AdjacencyBitmap RandomGraph(int64_t n, int64_t percent, int64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> distribution(0, 99);
+  AdjacencyBitmap adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = i + 1; j < n; ++j) {
+      if (distribution(rng) < percent) {
+        adjacency[i].Set(j);
+        adjacency[j].Set(i);
+      }
+    }
+  }
+  return adjacency;
+}
+
+TEST(GraphColoringTest, BitmapColorings) {
+  absl::flat_hash_map<V, absl::flat_hash_set<V>> cycle;
+  cycle["a"].insert("b");
+  cycle["b"].insert("c");
+  cycle["c"].insert("d");
+  cycle["d"].insert("e");
+  cycle["e"].insert("a");
+  AdjacencyBitmap adjacency = BitmapFromMap(cycle);
+  EXPECT_EQ(CheckedColorCount(adjacency,
+                              RecursiveLargestFirstColoring(adjacency)),
+            3);
+  EXPECT_EQ(CheckedColorCount(adjacency, DSaturColoring(adjacency)), 3);
+  EXPECT_EQ(CheckedColorCount(adjacency,
+                              ExactColoring(adjacency, absl::Seconds(10))),
+            3);
+
+  // A wheel with an even rim needs three colors, and a separate edge two.
+  absl::flat_hash_map<V, absl::flat_hash_set<V>> graph = cycle;
+  graph.erase("e");
+  graph["d"].erase("e");
+  graph["d"].insert("a");
+  for (const V& rim : {"a", "b", "c", "d"}) {
+    graph["center"].insert(rim);
+  }
+  graph["x"].insert("y");
+  adjacency = BitmapFromMap(graph);
+  EXPECT_EQ(CheckedColorCount(adjacency,
+                              RecursiveLargestFirstColoring(adjacency)),
+            3);
+  EXPECT_EQ(CheckedColorCount(adjacency, DSaturColoring(adjacency)), 3);
+  EXPECT_EQ(CheckedColorCount(adjacency,
+                              ExactColoring(adjacency, absl::Seconds(10))),
+            3);
+
+  EXPECT_TRUE(RecursiveLargestFirstColoring(AdjacencyBitmap()).empty());
+  EXPECT_TRUE(DSaturColoring(AdjacencyBitmap()).empty());
+  EXPECT_TRUE(ExactColoring(AdjacencyBitmap(), absl::Seconds(1)).empty());
+}
+
+TEST(GraphColoringTest, BitmapRLFMatchesRLF) {
+  for (int64_t seed = 0; seed < 4; ++seed) {
+    AdjacencyBitmap adjacency = RandomGraph(/*n=*/40, /*percent=*/30, seed);
+    absl::flat_hash_set<int64_t> vertices;
+    for (int64_t v = 0; v < adjacency.size(); ++v) {
+      vertices.insert(v);
+    }
+    std::vector<absl::flat_hash_set<int64_t>> expected =
+        RecursiveLargestFirstColoring<int64_t>(
+            vertices, [&](const int64_t& v) {
+              absl::flat_hash_set<int64_t> neighbors;
+              for (int64_t u = 0; u < adjacency.size(); ++u) {
+                if (adjacency[v].Get(u)) {
+                  neighbors.insert(u);
+                }
+              }
+              return neighbors;
+            });
+
+    std::vector<int64_t> coloring = RecursiveLargestFirstColoring(adjacency);
+    std::vector<absl::flat_hash_set<int64_t>> color_classes(expected.size());
+    for (int64_t v = 0; v < coloring.size(); ++v) {
+      ASSERT_LT(coloring[v], color_classes.size());
+      color_classes[coloring[v]].insert(v);
+    }
+    EXPECT_EQ(color_classes, expected) << "seed: " << seed;
+  }
+}
+
+TEST(GraphColoringTest, ExactColoringIsOptimal) {
+  for (int64_t seed = 0; seed < 8; ++seed) {
+    AdjacencyBitmap adjacency = RandomGraph(/*n=*/14, /*percent=*/50, seed);
+    absl::flat_hash_set<int64_t> vertices;
+    for (int64_t v = 0; v < adjacency.size(); ++v) {
+      vertices.insert(v);
+    }
+    int64_t chromatic_number = 0;
+    for (const absl::flat_hash_set<int64_t>& color_class :
+         Z3Coloring<int64_t>(vertices, [&](const int64_t& v) {
+           absl::flat_hash_set<int64_t> neighbors;
+           for (int64_t u = 0; u < adjacency.size(); ++u) {
+             if (adjacency[v].Get(u)) {
+               neighbors.insert(u);
+             }
+           }
+           return neighbors;
+         })) {
+      if (!color_class.empty()) {
+        ++chromatic_number;
+      }
+    }
+
+    EXPECT_EQ(CheckedColorCount(adjacency,
+                                ExactColoring(adjacency, absl::Seconds(10),
+                                              /*max_z3_vertex_count=*/0)),
+              chromatic_number)
+        << "seed: " << seed;
+    int64_t heuristic_count = CheckedColorCount(adjacency,
+                                                DSaturColoring(adjacency));
+    EXPECT_GE(heuristic_count, chromatic_number) << "seed: " << seed;
+  }
+}
+
+TEST(GraphColoringTest, ExactColoringOutOfTime) {
+  AdjacencyBitmap adjacency = RandomGraph(/*n=*/300, /*percent=*/50, 0);
+  std::vector<int64_t> coloring =
+      ExactColoring(adjacency, absl::ZeroDuration());
+  int64_t color_count = CheckedColorCount(adjacency, coloring);
+  EXPECT_GT(color_count, 0);
+  EXPECT_LE(color_count, CheckedColorCount(adjacency,
+                                           DSaturColoring(adjacency)));
+  EXPECT_LE(color_count,
+            CheckedColorCount(adjacency,
+                              RecursiveLargestFirstColoring(adjacency)));
+}
+
 }  // namespace
 }  // namespace xls
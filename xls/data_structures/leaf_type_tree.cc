@@ -83,29 +83,9 @@ std::pair<Type*, int64_t> GetSubtypeAndOffsetHelper(
   CHECK(t->IsTuple());
   TupleType* tuple_type = t->AsTupleOrDie();
   CHECK_LT(index[0], tuple_type->size());
-  int64_t element_offset = 0;
-  for (int64_t i = 0; i < index[0]; ++i) {
-    element_offset += tuple_type->element_type(i)->leaf_count();
-  }
-  return GetSubtypeAndOffsetHelper(tuple_type->element_type(index[0]),
-                                   index.subspan(1), offset + element_offset);
-}
-
-void GetLeafTypesHelper(Type* t, absl::InlinedVector<Type*, 1>* leaf_types) {
-  if (IsLeafType(t)) {
-    leaf_types->push_back(t);
-    return;
-  }
-  if (t->IsArray()) {
-    for (int64_t i = 0; i < t->AsArrayOrDie()->size(); ++i) {
-      GetLeafTypesHelper(t->AsArrayOrDie()->element_type(), leaf_types);
-    }
-    return;
-  }
-  CHECK(t->IsTuple());
-  for (int64_t i = 0; i < t->AsTupleOrDie()->size(); ++i) {
-    GetLeafTypesHelper(t->AsTupleOrDie()->element_type(i), leaf_types);
-  }
+  return GetSubtypeAndOffsetHelper(
+      tuple_type->element_type(index[0]), index.subspan(1),
+      offset + tuple_type->element_leaf_offset(index[0]));
 }
 
 std::string ToStringHelper(Type* subtype,
@@ -153,7 +133,8 @@ std::string ToStringHelper(Type* subtype,
 // Returns the index of the first leaf element in the type. This requires
 // searching through the type as some branches of the type may be dead-ends due
 // to empty tuples.
-std::optional<Type*> FirstLeafIndex(Type* type, std::vector<int64_t>* index) {
+std::optional<Type*> FirstLeafIndex(Type* type,
+                                    LeafTypeTreeIterator::TypeIndex* index) {
   if (IsLeafType(type)) {
     return type;
   }
@@ -205,7 +186,8 @@ int64_t TypeSize(Type* type) {
 // they are inbounds. Calling after incrementing the last element of `index`
 // advances the type index. Returns the leaf type of the next index or
 // std::nullopt if the iteration is at the end.
-std::optional<Type*> AdvanceHelper(Type* type, std::vector<int64_t>* index,
+std::optional<Type*> AdvanceHelper(Type* type,
+                                   LeafTypeTreeIterator::TypeIndex* index,
                                    int64_t depth) {
   if (depth == index->size()) {
     if (IsLeafType(type)) {
@@ -235,9 +217,8 @@ std::pair<Type*, int64_t> GetSubtypeAndOffset(Type* t,
 }
 
 absl::InlinedVector<Type*, 1> GetLeafTypes(Type* t) {
-  absl::InlinedVector<Type*, 1> leaf_types;
-  GetLeafTypesHelper(t, &leaf_types);
-  return leaf_types;
+  absl::Span<Type* const> leaf_types = t->leaf_types();
+  return absl::InlinedVector<Type*, 1>(leaf_types.begin(), leaf_types.end());
 }
 
 int64_t GetLeafTypeOffset(Type* t, absl::Span<int64_t const> index) {
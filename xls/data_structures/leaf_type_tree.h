@@ -264,6 +264,9 @@ namespace leaf_type_tree_internal {
 // position.
 class LeafTypeTreeIterator {
  public:
+  // Inlined so iterating over types of typical nesting depth doesn't allocate.
+  using TypeIndex = absl::InlinedVector<int64_t, 4>;
+
   // Create a type iterator for the given type. `index_prefix` is a sequence of
   // indices which prefixes the indices returned by `type_index`; it does not
   // affect the size of the iteration space.
@@ -305,7 +308,7 @@ class LeafTypeTreeIterator {
 
  private:
   Type* root_type_;
-  std::vector<int64_t> type_index_;
+  TypeIndex type_index_;
   // Number of elements in the index_prefix.
   int64_t prefix_size_;
   int64_t linear_index_;
@@ -347,7 +350,9 @@ template <typename T>
 class LeafTypeTree {
  public:
   using DataContainerT = absl::InlinedVector<T, 1>;
-  using TypeContainerT = absl::InlinedVector<Type*, 1>;
+  // The leaf types are cached by the type itself (see Type::leaf_types) so
+  // trees only own storage for their elements.
+  using TypeContainerT = absl::Span<Type* const>;
 
   LeafTypeTree() : type_(nullptr) {}
   LeafTypeTree(const LeafTypeTree<T>& other) = default;
@@ -361,19 +366,19 @@ class LeafTypeTree {
   explicit LeafTypeTree(Type* type)
       : type_(type),
         elements_(type->leaf_count()),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {}
+        leaf_types_(type->leaf_types()) {}
 
   // Creates a leaf type tree in which each data member set to `init_value`.
   LeafTypeTree(Type* type, const T& init_value)
       : type_(type),
         elements_(type->leaf_count(), init_value),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {}
+        leaf_types_(type->leaf_types()) {}
 
   // Constructor which takes a flattened representation of the leaf elements.
   LeafTypeTree(Type* type, absl::Span<const T> elements)
       : type_(type),
         elements_(elements.begin(), elements.end()),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {
+        leaf_types_(type->leaf_types()) {
     CHECK_EQ(elements_.size(), leaf_types_.size());
   }
 
@@ -385,7 +390,7 @@ class LeafTypeTree {
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
     ltt.elements_ = std::move(elements);
-    ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
+    ltt.leaf_types_ = type->leaf_types();
     return ltt;
   }
 
@@ -395,7 +400,7 @@ class LeafTypeTree {
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
     ltt.elements_ = {element};
-    ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
+    ltt.leaf_types_ = type->leaf_types();
     return ltt;
   }
 
@@ -406,7 +411,7 @@ class LeafTypeTree {
       Type* type, std::function<absl::StatusOr<T>(Type* leaf_type)> f) {
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
-    ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
+    ltt.leaf_types_ = type->leaf_types();
     ltt.elements_.reserve(ltt.leaf_types_.size());
     for (Type* leaf_type : ltt.leaf_types_) {
       XLS_ASSIGN_OR_RETURN(T value, f(leaf_type));
@@ -743,14 +748,14 @@ absl::StatusOr<LeafTypeTree<T>> ZipIndex(
 template <typename T, typename A>
 LeafTypeTree<T> Zip(LeafTypeTreeView<A> a, LeafTypeTreeView<A> b,
                     std::function<T(const A&, const A&)> f) {
-  absl::StatusOr<LeafTypeTree<T>> result = ZipIndex<T, A>(
-      {a, b},
-      [&](Type* element_type, absl::Span<const A* const> elements,
-          absl::Span<const int64_t> index) -> absl::StatusOr<T> {
-        return f(*elements[0], *elements[1]);
-      });
-  CHECK_OK(result);
-  return result.value();
+  CHECK_EQ(a.type(), b.type());
+  // Walk the flattened elements directly; no type index is needed.
+  typename LeafTypeTree<T>::DataContainerT new_elements;
+  new_elements.reserve(a.size());
+  for (int64_t i = 0; i < a.size(); ++i) {
+    new_elements.push_back(f(a.elements()[i], b.elements()[i]));
+  }
+  return LeafTypeTree<T>::CreateFromVector(a.type(), std::move(new_elements));
 }
 
 // Produce a new `LeafTypeTree` from this one `LeafTypeTreeView` with a
@@ -772,13 +777,12 @@ absl::StatusOr<LeafTypeTree<T>> MapIndex(
 template <typename T, typename R>
 LeafTypeTree<T> Map(LeafTypeTreeView<R> ltt,
                     std::function<T(const R& element)> function) {
-  return MapIndex<T, R>(
-             {ltt},
-             [&](Type* element_type, const R& element,
-                 absl::Span<const int64_t> index) -> absl::StatusOr<T> {
-               return function(element);
-             })
-      .value();
+  typename LeafTypeTree<T>::DataContainerT new_elements;
+  new_elements.reserve(ltt.size());
+  for (const R& element : ltt.elements()) {
+    new_elements.push_back(function(element));
+  }
+  return LeafTypeTree<T>::CreateFromVector(ltt.type(), std::move(new_elements));
 }
 
 // Use the given function to update each leaf element in this `LeafTypeTree`
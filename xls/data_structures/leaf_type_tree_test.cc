@@ -96,6 +96,19 @@ TEST_F(LeafTypeTreeTest, BitsTypes) {
   EXPECT_EQ(tree_with_init.Get({}), 123456);
 }
 
+TEST_F(LeafTypeTreeTest, LeafTypesAreSharedWithType) {
+  Type* type = AsType("(bits[1], bits[2][3], token)");
+  LeafTypeTree<int64_t> tree(type, 42);
+  LeafTypeTree<int64_t> copy = tree;
+  LeafTypeTree<bool> mapped = leaf_type_tree::Map<bool, int64_t>(
+      tree.AsView(), [](int64_t x) { return x == 42; });
+
+  EXPECT_EQ(tree.leaf_types().data(), type->leaf_types().data());
+  EXPECT_EQ(copy.leaf_types().data(), type->leaf_types().data());
+  EXPECT_EQ(mapped.leaf_types().data(), type->leaf_types().data());
+  EXPECT_THAT(mapped.elements(), Each(true));
+}
+
 TEST_F(LeafTypeTreeTest, TupleType) {
   LeafTypeTree<Bits> tree(AsType("(bits[123], bits[2], bits[42])"));
 
@@ -0,0 +1,229 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/maximum_clique.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/adjacency_bitmap.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kBitsPerWord = 64;
+
+// Returns the index of the lowest set bit of the bitmap, or -1 if none is set.
+int64_t FirstSetBit(const InlineBitmap& bitmap) {
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    if (uint64_t word = bitmap.GetWord(wordno); word != 0) {
+      return wordno * kBitsPerWord + absl::countr_zero(word);
+    }
+  }
+  return -1;
+}
+
+// Clears the bits of 'bitmap' which are set in 'other'.
+void Subtract(InlineBitmap& bitmap, const InlineBitmap& other) {
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    bitmap.SetWord(wordno, bitmap.GetWord(wordno) & ~other.GetWord(wordno));
+  }
+}
+
+// Returns the vertices of the graph in the given order.
+std::vector<int64_t> OrderVertices(const AdjacencyBitmap& adjacency,
+                                   CliqueVertexOrder order) {
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> vertices(n);
+  std::iota(vertices.begin(), vertices.end(), 0);
+  std::vector<int64_t> degree(n);
+  for (int64_t v = 0; v < n; ++v) {
+    degree[v] = CountCommonBits(adjacency[v], adjacency[v]);
+  }
+  switch (order) {
+    case CliqueVertexOrder::kIndex:
+      return vertices;
+    case CliqueVertexOrder::kDegree:
+      std::stable_sort(vertices.begin(), vertices.end(),
+                       [&](int64_t a, int64_t b) {
+                         return degree[a] > degree[b];
+                       });
+      return vertices;
+    case CliqueVertexOrder::kDegeneracy: {
+      std::vector<bool> removed(n, false);
+      std::vector<int64_t> removal_order;
+      removal_order.reserve(n);
+      for (int64_t step = 0; step < n; ++step) {
+        int64_t vertex = -1;
+        for (int64_t v = 0; v < n; ++v) {
+          if (!removed[v] && (vertex == -1 || degree[v] < degree[vertex])) {
+            vertex = v;
+          }
+        }
+        removed[vertex] = true;
+        removal_order.push_back(vertex);
+        ForEachSetBit(adjacency[vertex], [&](int64_t neighbor) {
+          if (!removed[neighbor]) {
+            --degree[neighbor];
+          }
+        });
+      }
+      std::reverse(removal_order.begin(), removal_order.end());
+      return removal_order;
+    }
+  }
+  return vertices;
+}
+
+// Searches for a clique larger than the best one known. Vertices are numbered
+// by their position in the search order.
+class CliqueSearch {
+ public:
+  CliqueSearch(AdjacencyBitmap adjacency, absl::Time deadline)
+      : adjacency_(std::move(adjacency)), deadline_(deadline) {}
+
+  // Returns the largest clique found, and sets 'optimal' if the search
+  // finished before the deadline.
+  std::vector<int64_t> Run(bool& optimal) {
+    const int64_t n = adjacency_.size();
+    FindGreedyClique();
+    InlineBitmap candidates(n, /*fill=*/true);
+    Expand(candidates);
+    optimal = !timed_out_;
+    return best_;
+  }
+
+ private:
+  // How many search nodes are visited between reads of the clock.
+  static constexpr int64_t kNodesPerDeadlineCheck = 1024;
+
+  // Starts from the clique found by repeatedly adding the candidate with the
+  // most candidate neighbors, so a search which times out at once still
+  // returns a reasonable clique.
+  void FindGreedyClique() {
+    const int64_t n = adjacency_.size();
+    InlineBitmap candidates(n, /*fill=*/true);
+    while (!candidates.IsAllZeroes()) {
+      int64_t best = -1;
+      int64_t best_degree = -1;
+      ForEachSetBit(candidates, [&](int64_t vertex) {
+        int64_t degree = CountCommonBits(adjacency_[vertex], candidates);
+        if (degree > best_degree) {
+          best = vertex;
+          best_degree = degree;
+        }
+      });
+      best_.push_back(best);
+      candidates.Intersect(adjacency_[best]);
+    }
+  }
+
+  // Extends 'clique_' with each of 'candidates' in turn, all of which are
+  // adjacent to every vertex of 'clique_'.
+  void Expand(InlineBitmap& candidates) {
+    if (++node_count_ % kNodesPerDeadlineCheck == 0 &&
+        absl::Now() > deadline_) {
+      timed_out_ = true;
+    }
+    if (timed_out_) {
+      return;
+    }
+
+    // Greedily color the candidates in order. A clique has at most one vertex
+    // of each color, so a clique of the candidates up to and including the
+    // i-th colored vertex has at most colors[i] vertices.
+    std::vector<int64_t> vertices;
+    std::vector<int64_t> colors;
+    InlineBitmap uncolored = candidates;
+    for (int64_t color = 1; !uncolored.IsAllZeroes(); ++color) {
+      InlineBitmap available = uncolored;
+      for (int64_t v = FirstSetBit(available); v != -1;
+           v = FirstSetBit(available)) {
+        vertices.push_back(v);
+        colors.push_back(color);
+        uncolored.Set(v, false);
+        available.Set(v, false);
+        Subtract(available, adjacency_[v]);
+      }
+    }
+
+    // Branch on the vertices with the highest colors first, dropping each
+    // from the candidates once its cliques have been searched.
+    for (int64_t i = vertices.size() - 1; i >= 0; --i) {
+      if (clique_.size() + colors[i] <= best_.size()) {
+        return;
+      }
+      int64_t v = vertices[i];
+      clique_.push_back(v);
+      InlineBitmap next = candidates;
+      next.Intersect(adjacency_[v]);
+      if (next.IsAllZeroes()) {
+        if (clique_.size() > best_.size()) {
+          best_ = clique_;
+        }
+      } else {
+        Expand(next);
+      }
+      clique_.pop_back();
+      candidates.Set(v, false);
+      if (timed_out_) {
+        return;
+      }
+    }
+  }
+
+  const AdjacencyBitmap adjacency_;
+  const absl::Time deadline_;
+  std::vector<int64_t> clique_;
+  std::vector<int64_t> best_;
+  int64_t node_count_ = 0;
+  bool timed_out_ = false;
+};
+
+}  // namespace
+
+CliqueResult MaximumCliqueWithDeadline(const AdjacencyBitmap& adjacency,
+                                       absl::Time deadline,
+                                       CliqueVertexOrder order) {
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> vertices = OrderVertices(adjacency, order);
+  std::vector<int64_t> position(n);
+  for (int64_t i = 0; i < n; ++i) {
+    position[vertices[i]] = i;
+  }
+  AdjacencyBitmap ordered(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    ForEachSetBit(adjacency[vertices[i]], [&](int64_t neighbor) {
+      ordered[i].Set(position[neighbor]);
+    });
+  }
+
+  CliqueResult result;
+  std::vector<int64_t> clique =
+      CliqueSearch(std::move(ordered), deadline).Run(result.optimal);
+  for (int64_t i : clique) {
+    result.vertices.push_back(vertices[i]);
+  }
+  std::sort(result.vertices.begin(), result.vertices.end());
+  return result;
+}
+
+}  // namespace xls
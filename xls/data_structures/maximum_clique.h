@@ -19,6 +19,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
@@ -26,7 +27,9 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "ortools/linear_solver/linear_solver.h"
+#include "xls/data_structures/adjacency_bitmap.h"
 
 namespace xls {
 
@@ -95,6 +98,39 @@ absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
   return result;
 }
 
+// The order in which MaximumCliqueWithDeadline initially considers vertices.
+// Good orders make large cliques be found early, which prunes more of the
+// search.
+enum class CliqueVertexOrder {
+  // Vertices in increasing index order.
+  kIndex,
+  // Vertices in non-increasing order of degree.
+  kDegree,
+  // Vertices in the reverse of the order in which they are removed when
+  // repeatedly removing a vertex of minimum degree, so vertices of the
+  // densest cores come first.
+  kDegeneracy,
+};
+
+struct CliqueResult {
+  // The vertices of the clique, in increasing order.
+  std::vector<int64_t> vertices;
+
+  // Whether the search finished, proving the clique maximum.
+  bool optimal;
+};
+
+// Computes a maximum clique of the given graph with a bitset branch and bound
+// search, bounding each branch by a greedy coloring of its candidates as in
+// Tomita's MCS algorithm. Unlike MaximumClique this handles dense graphs of
+// many hundreds of vertices. If the search doesn't finish before the deadline
+// the largest clique found so far is returned, which is at least as large as
+// a greedily found one.
+CliqueResult MaximumCliqueWithDeadline(
+    const AdjacencyBitmap& adjacency,
+    absl::Time deadline = absl::InfiniteFuture(),
+    CliqueVertexOrder order = CliqueVertexOrder::kDegeneracy);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
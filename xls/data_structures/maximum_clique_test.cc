@@ -18,6 +18,7 @@
 #include <functional>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -25,6 +26,9 @@
 #include "absl/container/btree_set.h"
 #include "absl/random/distributions.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/adjacency_bitmap.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -158,5 +162,85 @@ TEST(MaximumCliqueTest, Big) {
   EXPECT_TRUE(IsValidClique(graph, clique));
 }
 
+// Returns a random graph where each pair of vertices is adjacent with the
+// given probability.
+AdjacencyBitmap RandomAdjacency(int64_t n, double p) {
+  std::mt19937_64 bit_gen;
+  AdjacencyBitmap adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = i + 1; j < n; ++j) {
+      if (absl::Bernoulli(bit_gen, p)) {
+        adjacency[i].Set(j);
+        adjacency[j].Set(i);
+      }
+    }
+  }
+  return adjacency;
+}
+
+bool IsValidBitmapClique(const AdjacencyBitmap& adjacency,
+                         const std::vector<int64_t>& clique) {
+  for (int64_t x : clique) {
+    for (int64_t y : clique) {
+      if (x != y && !adjacency[x].Get(y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(MaximumCliqueTest, BitmapConnectedUnionOfCG4AndCG3) {
+  // a, b, c, d = 0, 1, 2, 3 and x, y, z = 4, 5, 6.
+  AdjacencyBitmap adjacency(7, InlineBitmap(7));
+  auto add_edge = [&](int64_t x, int64_t y) {
+    adjacency[x].Set(y);
+    adjacency[y].Set(x);
+  };
+  for (auto [x, y] : std::vector<std::pair<int64_t, int64_t>>{
+           {0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3},
+           {4, 5}, {4, 6}, {5, 6}, {0, 4}, {1, 5}, {2, 6}}) {
+    add_edge(x, y);
+  }
+  for (CliqueVertexOrder order :
+       {CliqueVertexOrder::kIndex, CliqueVertexOrder::kDegree,
+        CliqueVertexOrder::kDegeneracy}) {
+    CliqueResult result =
+        MaximumCliqueWithDeadline(adjacency, absl::InfiniteFuture(), order);
+    EXPECT_TRUE(result.optimal);
+    EXPECT_EQ(result.vertices, (std::vector<int64_t>{0, 1, 2, 3}));
+  }
+}
+
+TEST(MaximumCliqueTest, BitmapEmptyGraph) {
+  CliqueResult result = MaximumCliqueWithDeadline(AdjacencyBitmap());
+  EXPECT_TRUE(result.optimal);
+  EXPECT_TRUE(result.vertices.empty());
+}
+
+TEST(MaximumCliqueTest, BitmapDense) {
+  AdjacencyBitmap adjacency = RandomAdjacency(100, 0.9);
+  CliqueResult degeneracy = MaximumCliqueWithDeadline(adjacency);
+  EXPECT_TRUE(degeneracy.optimal);
+  EXPECT_TRUE(IsValidBitmapClique(adjacency, degeneracy.vertices));
+  for (CliqueVertexOrder order :
+       {CliqueVertexOrder::kIndex, CliqueVertexOrder::kDegree}) {
+    CliqueResult result =
+        MaximumCliqueWithDeadline(adjacency, absl::InfiniteFuture(), order);
+    EXPECT_TRUE(result.optimal);
+    EXPECT_EQ(result.vertices.size(), degeneracy.vertices.size());
+    EXPECT_TRUE(IsValidBitmapClique(adjacency, result.vertices));
+  }
+}
+
+TEST(MaximumCliqueTest, BitmapDeadlineReturnsBestSoFar) {
+  AdjacencyBitmap adjacency = RandomAdjacency(1000, 0.95);
+  CliqueResult result =
+      MaximumCliqueWithDeadline(adjacency, absl::InfinitePast());
+  EXPECT_FALSE(result.optimal);
+  EXPECT_GT(result.vertices.size(), 1);
+  EXPECT_TRUE(IsValidBitmapClique(adjacency, result.vertices));
+}
+
 }  // namespace
 }  // namespace xls
@@ -26,6 +26,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -274,6 +275,30 @@ int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
   return 0;
 }
 
+// Returns the cut whose source partition is the nodes marked in 'source_side'.
+GraphCut MakeGraphCut(const Graph& graph,
+                      const std::vector<bool>& source_side) {
+  GraphCut min_cut;
+  min_cut.weight = 0;
+  for (NodeId node_id = NodeId(0); node_id <= graph.max_node_id(); ++node_id) {
+    if (source_side[int64_t{node_id}]) {
+      min_cut.source_partition.push_back(node_id);
+    } else {
+      min_cut.sink_partition.push_back(node_id);
+    }
+    for (EdgeId edge_id : graph.successors(node_id)) {
+      const Edge& edge = graph.edge(edge_id);
+      if (source_side[int64_t{edge.from}] && !source_side[int64_t{edge.to}]) {
+        min_cut.weight += edge.weight;
+      }
+    }
+  }
+
+  XLS_VLOG_LINES(4, min_cut.ToString(graph));
+
+  return min_cut;
+}
+
 }  // namespace
 
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
@@ -304,26 +329,161 @@ GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
   }
   CHECK(!reachable_from_source.contains(sink));
 
-  GraphCut min_cut;
-  min_cut.weight = 0;
-  for (NodeId node_id = NodeId(0); node_id <= graph.max_node_id(); ++node_id) {
-    if (reachable_from_source.contains(node_id)) {
-      min_cut.source_partition.push_back(node_id);
-    } else {
-      min_cut.sink_partition.push_back(node_id);
+  std::vector<bool> source_side(graph.node_count());
+  for (NodeId node : reachable_from_source) {
+    source_side[int64_t{node}] = true;
+  }
+  return MakeGraphCut(graph, source_side);
+}
+
+void PushRelabelMinCut::Initialize(const Graph& graph) {
+  const int64_t node_count = graph.node_count();
+  const int64_t edge_count = graph.edge_count();
+  first_arc_.assign(node_count + 1, 0);
+  for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+       edge_id += EdgeId{1}) {
+    const Edge& edge = graph.edge(edge_id);
+    ++first_arc_[int64_t{edge.from} + 1];
+    ++first_arc_[int64_t{edge.to} + 1];
+  }
+  for (int64_t i = 0; i < node_count; ++i) {
+    first_arc_[i + 1] += first_arc_[i];
+  }
+
+  // The forward edge starts with the capacity of the input edge and the
+  // backward edge with none.
+  arc_to_.resize(2 * edge_count);
+  arc_capacity_.resize(2 * edge_count);
+  arc_dual_.resize(2 * edge_count);
+  current_arc_.assign(first_arc_.begin(), first_arc_.end() - 1);
+  for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+       edge_id += EdgeId{1}) {
+    const Edge& edge = graph.edge(edge_id);
+    int64_t forward = current_arc_[int64_t{edge.from}]++;
+    int64_t backward = current_arc_[int64_t{edge.to}]++;
+    arc_to_[forward] = int64_t{edge.to};
+    arc_capacity_[forward] = edge.weight;
+    arc_dual_[forward] = backward;
+    arc_to_[backward] = int64_t{edge.from};
+    arc_capacity_[backward] = 0;
+    arc_dual_[backward] = forward;
+  }
+  current_arc_.assign(first_arc_.begin(), first_arc_.end() - 1);
+
+  excess_.assign(node_count, 0);
+  height_.assign(node_count, 0);
+  active_.assign(node_count, false);
+  // A node with excess always has a residual edge back toward the source, so
+  // no height exceeds 2 * node_count - 1.
+  height_count_.assign(2 * node_count + 1, 0);
+  queue_.clear();
+}
+
+void PushRelabelMinCut::Push(int64_t from, int64_t arc, int64_t amount,
+                             int64_t source, int64_t sink) {
+  int64_t to = arc_to_[arc];
+  arc_capacity_[arc] -= amount;
+  arc_capacity_[arc_dual_[arc]] += amount;
+  excess_[from] -= amount;
+  excess_[to] += amount;
+  if (to != source && to != sink && !active_[to]) {
+    active_[to] = true;
+    queue_.push_back(to);
+  }
+}
+
+void PushRelabelMinCut::Gap(int64_t height, int64_t source) {
+  const int64_t node_count = height_.size();
+  for (int64_t node = 0; node < node_count; ++node) {
+    if (node != source && height_[node] > height &&
+        height_[node] < node_count) {
+      --height_count_[height_[node]];
+      height_[node] = node_count + 1;
+      ++height_count_[node_count + 1];
+      current_arc_[node] = first_arc_[node];
     }
-    for (EdgeId edge_id : graph.successors(node_id)) {
-      const Edge& edge = graph.edge(edge_id);
-      if (reachable_from_source.contains(edge.from) &&
-          !reachable_from_source.contains(edge.to)) {
-        min_cut.weight += edge.weight;
+  }
+}
+
+void PushRelabelMinCut::Discharge(int64_t node, int64_t source, int64_t sink) {
+  const int64_t node_count = height_.size();
+  while (excess_[node] > 0) {
+    if (current_arc_[node] == first_arc_[node + 1]) {
+      // No admissible edge is left, so lift the node just above its lowest
+      // neighbor with residual capacity.
+      int64_t old_height = height_[node];
+      int64_t new_height = 2 * node_count;
+      for (int64_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc) {
+        if (arc_capacity_[arc] > 0) {
+          new_height = std::min(new_height, height_[arc_to_[arc]] + 1);
+        }
+      }
+      CHECK_LT(new_height, 2 * node_count);
+      --height_count_[old_height];
+      height_[node] = new_height;
+      ++height_count_[new_height];
+      current_arc_[node] = first_arc_[node];
+      if (height_count_[old_height] == 0 && old_height < node_count) {
+        Gap(old_height, source);
       }
+      continue;
+    }
+    int64_t arc = current_arc_[node];
+    if (arc_capacity_[arc] > 0 && height_[node] == height_[arc_to_[arc]] + 1) {
+      int64_t amount =
+          excess_[node] < arc_capacity_[arc]
+              ? static_cast<int64_t>(excess_[node])
+              : arc_capacity_[arc];
+      Push(node, arc, amount, source, sink);
+    } else {
+      ++current_arc_[node];
     }
   }
+}
 
-  XLS_VLOG_LINES(4, min_cut.ToString(graph));
+GraphCut PushRelabelMinCut::MinCutBetweenNodes(const Graph& graph,
+                                               NodeId source, NodeId sink) {
+  Initialize(graph);
+  const int64_t node_count = graph.node_count();
+  const int64_t s = int64_t{source};
+  const int64_t t = int64_t{sink};
+
+  // Saturate every edge out of the source, then discharge active nodes until
+  // the preflow is a maximum flow. Nodes which can't reach the sink end up
+  // above the source and return their excess to it.
+  height_[s] = node_count;
+  height_count_[0] = node_count - 1;
+  height_count_[node_count] = 1;
+  for (int64_t arc = first_arc_[s]; arc < first_arc_[s + 1]; ++arc) {
+    if (arc_capacity_[arc] > 0) {
+      excess_[s] += arc_capacity_[arc];
+      Push(s, arc, arc_capacity_[arc], s, t);
+    }
+  }
+  while (!queue_.empty()) {
+    int64_t node = queue_.front();
+    queue_.pop_front();
+    active_[node] = false;
+    Discharge(node, s, t);
+  }
 
-  return min_cut;
+  // As with Dinic's algorithm, the source partition is the set of nodes
+  // reachable from the source in the residual graph.
+  std::vector<bool> source_side(node_count);
+  std::vector<int64_t> frontier = {s};
+  source_side[s] = true;
+  while (!frontier.empty()) {
+    int64_t node = frontier.back();
+    frontier.pop_back();
+    for (int64_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc) {
+      if (arc_capacity_[arc] > 0 && !source_side[arc_to_[arc]]) {
+        source_side[arc_to_[arc]] = true;
+        frontier.push_back(arc_to_[arc]);
+      }
+    }
+  }
+  CHECK(!source_side[t]);
+  return MakeGraphCut(graph, source_side);
 }
 
 }  // namespace min_cut
@@ -16,10 +16,12 @@
 #define XLS_DATA_STRUCTURES_MIN_CUT_H_
 
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
 #include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
@@ -102,6 +104,59 @@ struct GraphCut {
 // a worst case run time of O(V^2 * E).
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
 
+// Computes minimum cuts via the push-relabel method, discharging active nodes
+// in FIFO order with the gap heuristic. This has a worst case run time of
+// O(V^3) and is typically much faster than MinCutBetweenNodes on the large,
+// densely connected graphs built by the min-cut scheduler. The returned cut is
+// the same one MinCutBetweenNodes returns: its source partition is the set of
+// nodes reachable from the source in the residual graph of a maximum flow.
+//
+// The residual graph and the per-node state are kept between calls so a solver
+// reused for a sequence of cuts, such as one cut per pipeline stage boundary,
+// only allocates when it sees a larger graph than before. A solver must not be
+// used from more than one thread at a time.
+class PushRelabelMinCut {
+ public:
+  GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
+
+ private:
+  // Builds the residual graph of 'graph' with zero flow.
+  void Initialize(const Graph& graph);
+
+  // Pushes the excess of 'node' to its neighbors, relabeling it as needed.
+  void Discharge(int64_t node, int64_t source, int64_t sink);
+
+  // Pushes 'amount' of flow along residual edge 'arc' out of 'from'.
+  void Push(int64_t from, int64_t arc, int64_t amount, int64_t source,
+            int64_t sink);
+
+  // Lifts every node other than the source with a height in (height, n)
+  // above the source, as none of them can reach the sink any more.
+  void Gap(int64_t height, int64_t source);
+
+  // The residual graph in compressed sparse row form. The residual edges of
+  // node i are [first_arc_[i], first_arc_[i + 1]), and each edge of the input
+  // graph maps to a forward and backward residual edge which are each other's
+  // 'arc_dual_'.
+  std::vector<int64_t> first_arc_;
+  std::vector<int64_t> arc_to_;
+  std::vector<int64_t> arc_capacity_;
+  std::vector<int64_t> arc_dual_;
+
+  // Per-node state. Excess can exceed the range of int64_t when many
+  // maximum-weight edges enter a node.
+  std::vector<absl::int128> excess_;
+  std::vector<int64_t> height_;
+  std::vector<int64_t> current_arc_;
+  std::vector<bool> active_;
+
+  // The number of nodes with each height.
+  std::vector<int64_t> height_count_;
+
+  // Active nodes in the order they will be discharged.
+  std::deque<int64_t> queue_;
+};
+
 }  // namespace min_cut
 }  // namespace xls
 
@@ -362,6 +362,66 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
   EXPECT_EQ(min_cut.weight, 2);
 }
 
+TEST(MinCutTest, PushRelabelDiamondGraph) {
+  Graph graph;
+  auto a = graph.AddNode("a");
+  auto b = graph.AddNode("b");
+  auto c = graph.AddNode("c");
+  auto d = graph.AddNode("d");
+  graph.AddEdge(a, b, 100);
+  graph.AddEdge(a, c, 1);
+  graph.AddEdge(b, d, 42);
+  graph.AddEdge(c, d, 1234);
+  PushRelabelMinCut solver;
+  GraphCut min_cut = solver.MinCutBetweenNodes(graph, a, d);
+  EXPECT_EQ(min_cut.weight, 43);
+  EXPECT_THAT(min_cut.source_partition, UnorderedElementsAre(a, b));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(c, d));
+}
+
+TEST(MinCutTest, PushRelabelMatchesDinic) {
+  // The source partition of both algorithms is the smallest one of any min
+  // cut, so the cuts are identical. Reuse one solver across graphs of
+  // different sizes.
+  PushRelabelMinCut solver;
+  for (bool acyclic : {false, true}) {
+    for (int64_t layer_count = 19; layer_count >= 5; layer_count -= 2) {
+      for (int64_t nodes_in_layer = 5; nodes_in_layer < 20;
+           nodes_in_layer += 2) {
+        NodeId source;
+        NodeId sink;
+        Graph graph = MakeLargeGraph(acyclic, &source, &sink, layer_count,
+                                     nodes_in_layer);
+        GraphCut expected = MinCutBetweenNodes(graph, source, sink);
+        GraphCut min_cut = solver.MinCutBetweenNodes(graph, source, sink);
+        EXPECT_EQ(min_cut.weight, expected.weight);
+        EXPECT_EQ(min_cut.source_partition, expected.source_partition);
+        EXPECT_EQ(min_cut.sink_partition, expected.sink_partition);
+      }
+    }
+  }
+}
+
+TEST(MinCutTest, PushRelabelMaximumWeightEdges) {
+  // Many maximum weight edges entering one node overflow a 64-bit excess.
+  Graph graph;
+  auto source = graph.AddNode("source");
+  auto a = graph.AddNode("a");
+  auto b = graph.AddNode("b");
+  auto c = graph.AddNode("c");
+  auto sink = graph.AddNode("sink");
+  for (NodeId node : {a, b}) {
+    graph.AddEdge(source, node, std::numeric_limits<int64_t>::max());
+    graph.AddEdge(node, c, std::numeric_limits<int64_t>::max());
+  }
+  graph.AddEdge(c, sink, 5);
+  PushRelabelMinCut solver;
+  GraphCut min_cut = solver.MinCutBetweenNodes(graph, source, sink);
+  EXPECT_EQ(min_cut.weight, 5);
+  EXPECT_THAT(min_cut.source_partition, UnorderedElementsAre(source, a, b, c));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(sink));
+}
+
 }  // namespace
 }  // namespace min_cut
 }  // namespace xls
@@ -0,0 +1,205 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/transitive_closure.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kBitsPerWord = 64;
+
+// Ranges with fewer rows than this per thread are closed by fewer threads,
+// as scheduling a task would cost more than closing the rows.
+constexpr int64_t kMinRowsPerThread = 64;
+
+// Calls f on the index of each set bit of the bitmap.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    for (uint64_t word = bitmap.GetWord(wordno); word != 0; word &= word - 1) {
+      f(wordno * kBitsPerWord + absl::countr_zero(word));
+    }
+  }
+}
+
+// Calls f(begin, end) on consecutive chunks of [0, size), each as its own task
+// on the shared thread pool, using at most thread_count chunks. The first chunk
+// runs on the calling thread.
+void ParallelFor(int64_t size, int64_t thread_count,
+                 absl::FunctionRef<void(int64_t, int64_t)> f) {
+  int64_t active_threads =
+      std::clamp<int64_t>(size / kMinRowsPerThread, 1, thread_count);
+  int64_t chunk = (size + active_threads - 1) / active_threads;
+  TaskGroup group;
+  for (int64_t i = 1; i < active_threads; ++i) {
+    int64_t begin = i * chunk;
+    int64_t end = std::min(begin + chunk, size);
+    group.Schedule([f, begin, end]() { f(begin, end); });
+  }
+  f(0, std::min(chunk, size));
+  CHECK_OK(group.Wait());
+}
+
+}  // namespace
+
+BitRelation DenseTransitiveClosure(const BitRelation& relation,
+                                   int64_t thread_count) {
+  const int64_t n = relation.size();
+  std::vector<std::vector<int64_t>> successors(n);
+  for (int64_t i = 0; i < n; ++i) {
+    CHECK_EQ(relation[i].bit_count(), n);
+    ForEachSetBit(relation[i], [&](int64_t j) { successors[i].push_back(j); });
+  }
+
+  // Find the strongly connected components with Tarjan's algorithm. Every
+  // vertex of a component has the same closure, so components are closed as
+  // a whole. Components are completed in reverse topological order, i.e. all
+  // successors of a component are completed before it.
+  std::vector<int64_t> component(n, -1);
+  std::vector<std::vector<int64_t>> components;
+  {
+    std::vector<int64_t> index(n, -1);
+    std::vector<int64_t> lowlink(n);
+    std::vector<bool> on_stack(n, false);
+    std::vector<int64_t> scc_stack;
+    // Vertices being visited and the position of their next successor.
+    std::vector<std::pair<int64_t, int64_t>> call_stack;
+    int64_t next_index = 0;
+    auto visit = [&](int64_t vertex) {
+      index[vertex] = lowlink[vertex] = next_index++;
+      scc_stack.push_back(vertex);
+      on_stack[vertex] = true;
+      call_stack.push_back({vertex, 0});
+    };
+    for (int64_t root = 0; root < n; ++root) {
+      if (index[root] != -1) {
+        continue;
+      }
+      visit(root);
+      while (!call_stack.empty()) {
+        auto [vertex, position] = call_stack.back();
+        if (position < successors[vertex].size()) {
+          ++call_stack.back().second;
+          int64_t successor = successors[vertex][position];
+          if (index[successor] == -1) {
+            visit(successor);
+          } else if (on_stack[successor]) {
+            lowlink[vertex] = std::min(lowlink[vertex], index[successor]);
+          }
+          continue;
+        }
+        call_stack.pop_back();
+        if (!call_stack.empty()) {
+          int64_t parent = call_stack.back().first;
+          lowlink[parent] = std::min(lowlink[parent], lowlink[vertex]);
+        }
+        if (lowlink[vertex] == index[vertex]) {
+          std::vector<int64_t>& members = components.emplace_back();
+          int64_t member;
+          do {
+            member = scc_stack.back();
+            scc_stack.pop_back();
+            on_stack[member] = false;
+            component[member] = components.size() - 1;
+            members.push_back(member);
+          } while (member != vertex);
+        }
+      }
+    }
+  }
+
+  // The height of a component is zero if it has no successors, and otherwise
+  // one more than the greatest height of its successors. The successors of a
+  // component all have lower heights, so the components are closed level by
+  // level and the components of a level are independent of each other.
+  const int64_t component_count = components.size();
+  std::vector<int64_t> height(component_count, 0);
+  int64_t level_count = 0;
+  for (int64_t c = 0; c < component_count; ++c) {
+    for (int64_t member : components[c]) {
+      for (int64_t successor : successors[member]) {
+        if (component[successor] != c) {
+          height[c] = std::max(height[c], height[component[successor]] + 1);
+        }
+      }
+    }
+    level_count = std::max(level_count, height[c] + 1);
+  }
+  std::vector<int64_t> level_offsets(level_count + 1, 0);
+  for (int64_t c = 0; c < component_count; ++c) {
+    ++level_offsets[height[c] + 1];
+  }
+  for (int64_t level = 0; level < level_count; ++level) {
+    level_offsets[level + 1] += level_offsets[level];
+  }
+  std::vector<int64_t> level_order(component_count);
+  std::vector<int64_t> next_offset = level_offsets;
+  for (int64_t c = 0; c < component_count; ++c) {
+    level_order[next_offset[height[c]]++] = c;
+  }
+
+  // The closure of a component is held in the row of its first member.
+  BitRelation closure = relation;
+  auto close_component = [&](int64_t c) {
+    const std::vector<int64_t>& members = components[c];
+    InlineBitmap& row = closure[members.front()];
+    for (int64_t member : members) {
+      row.Union(relation[member]);
+      for (int64_t successor : successors[member]) {
+        if (component[successor] != c) {
+          row.Union(closure[components[component[successor]].front()]);
+        }
+      }
+    }
+    // Members of a cycle reach each other (and themselves).
+    if (members.size() > 1) {
+      for (int64_t member : members) {
+        row.Set(member);
+      }
+    }
+  };
+  for (int64_t level = 0; level < level_count; ++level) {
+    int64_t begin = level_offsets[level];
+    ParallelFor(level_offsets[level + 1] - begin, thread_count,
+                [&](int64_t chunk_begin, int64_t chunk_end) {
+                  for (int64_t i = chunk_begin; i < chunk_end; ++i) {
+                    close_component(level_order[begin + i]);
+                  }
+                });
+  }
+
+  // Copy the closure of each component to its other members.
+  ParallelFor(n, thread_count, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t vertex = chunk_begin; vertex < chunk_end; ++vertex) {
+      int64_t representative = components[component[vertex]].front();
+      if (representative != vertex) {
+        closure[vertex] = closure[representative];
+      }
+    }
+  });
+  return closure;
+}
+
+}  // namespace xls
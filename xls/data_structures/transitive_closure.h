@@ -15,11 +15,14 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
@@ -95,6 +98,68 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
   return result;
 }
 
+// A relation over the vertices [0, n), stored as a row of n bits per vertex:
+// vertex i is related to vertex j iff relation[i].Get(j).
+using BitRelation = std::vector<InlineBitmap>;
+
+// Compute the transitive closure of a dense relation.
+//
+// The strongly connected components of the relation (single vertices for a
+// DAG) are closed in a single pass in topological order, the row of each
+// component becoming the union of the rows of its successors, a word at a
+// time. Components which do not depend on each other are closed on up to
+// thread_count threads.
+BitRelation DenseTransitiveClosure(const BitRelation& relation,
+                                   int64_t thread_count = 1);
+
+// Compute the transitive closure of a relation, like TransitiveClosure(), by
+// mapping the vertices to dense indices and closing the relation with the
+// BitRelation overload above. Uses far less time and memory on large
+// relations.
+template <typename V>
+HashRelation<V> DenseTransitiveClosure(const HashRelation<V>& relation,
+                                       int64_t thread_count = 1) {
+  std::vector<V> nodes;
+  absl::flat_hash_map<V, int64_t> node_to_index;
+  auto add_node = [&](const V& node) {
+    if (node_to_index.try_emplace(node, nodes.size()).second) {
+      nodes.push_back(node);
+    }
+  };
+  for (const auto& [node, children] : relation) {
+    add_node(node);
+    for (const auto& child : children) {
+      add_node(child);
+    }
+  }
+
+  const int64_t n = nodes.size();
+  BitRelation rows(n, InlineBitmap(n));
+  for (const auto& [node, children] : relation) {
+    InlineBitmap& row = rows[node_to_index.at(node)];
+    for (const auto& child : children) {
+      row.Set(node_to_index.at(child));
+    }
+  }
+
+  BitRelation closure = DenseTransitiveClosure(rows, thread_count);
+
+  HashRelation<V> result;
+  for (int64_t i = 0; i < n; ++i) {
+    if (closure[i].IsAllZeroes()) {
+      continue;
+    }
+    absl::flat_hash_set<V>& children = result[nodes[i]];
+    for (int64_t wordno = 0; wordno < closure[i].word_count(); ++wordno) {
+      for (uint64_t word = closure[i].GetWord(wordno); word != 0;
+           word &= word - 1) {
+        children.insert(nodes[wordno * 64 + absl::countr_zero(word)]);
+      }
+    }
+  }
+  return result;
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
@@ -14,12 +14,19 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
 #include <string>
+#include <tuple>
+#include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -43,5 +50,125 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, DenseSimple) {
+  HashRelation<V> rel;
+  rel["foo"].insert("bar");
+  rel["bar"].insert("baz");
+  rel["bar"].insert("qux");
+  rel["baz"].insert("qux");
+  rel["foo2"].insert("baz");
+  HashRelation<V> tc = DenseTransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("foo"), UnorderedElementsAre("bar", "baz", "qux"));
+  EXPECT_THAT(tc.at("foo2"), UnorderedElementsAre("baz", "qux"));
+  EXPECT_THAT(tc.at("bar"), UnorderedElementsAre("baz", "qux"));
+  EXPECT_THAT(tc.at("baz"), UnorderedElementsAre("qux"));
+  EXPECT_FALSE(tc.contains("qux"));
+}
+
+TEST(TransitiveClosureTest, DenseCycle) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("c");
+  rel["c"].insert("a");
+  rel["c"].insert("d");
+  HashRelation<V> tc = DenseTransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("c"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_FALSE(tc.contains("d"));
+}
+
+// Returns a random relation over n vertices with about edge_count edges. If
+// acyclic, vertices are only related to vertices with greater indices.
+HashRelation<int64_t> RandomRelation(int64_t n, int64_t edge_count,
+                                     bool acyclic, int64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> vertex(0, n - 1);
+  HashRelation<int64_t> rel;
+  for (int64_t i = 0; i < edge_count; ++i) {
+    int64_t from = vertex(rng);
+    int64_t to = vertex(rng);
+    if (acyclic) {
+      if (from == to) {
+        continue;
+      }
+      std::tie(from, to) = std::minmax(from, to);
+    }
+    rel[from].insert(to);
+  }
+  return rel;
+}
+
+TEST(TransitiveClosureTest, DenseMatchesHashClosure) {
+  for (bool acyclic : {true, false}) {
+    for (int64_t seed = 0; seed < 4; ++seed) {
+      HashRelation<int64_t> rel =
+          RandomRelation(/*n=*/150, /*edge_count=*/200, acyclic, seed);
+      HashRelation<int64_t> expected = TransitiveClosure<int64_t>(rel);
+      EXPECT_EQ(DenseTransitiveClosure<int64_t>(rel), expected)
+          << "acyclic: " << acyclic << " seed: " << seed;
+      EXPECT_EQ(DenseTransitiveClosure<int64_t>(rel, /*thread_count=*/4),
+                expected)
+          << "acyclic: " << acyclic << " seed: " << seed;
+    }
+  }
+}
+
+TEST(TransitiveClosureTest, DenseParallelMatchesSerial) {
+  for (bool acyclic : {true, false}) {
+    HashRelation<int64_t> rel = RandomRelation(
+        /*n=*/2000, /*edge_count=*/4000, acyclic, /*seed=*/1);
+    EXPECT_EQ(DenseTransitiveClosure<int64_t>(rel, /*thread_count=*/4),
+              DenseTransitiveClosure<int64_t>(rel))
+        << "acyclic: " << acyclic;
+  }
+}
+
+TEST(TransitiveClosureTest, DenseEmpty) {
+  EXPECT_TRUE(DenseTransitiveClosure(BitRelation()).empty());
+  EXPECT_TRUE(DenseTransitiveClosure<V>(HashRelation<V>()).empty());
+}
+
+void BM_HashTransitiveClosure(benchmark::State& state) {
+  HashRelation<int64_t> rel =
+      RandomRelation(state.range(0), 4 * state.range(0), /*acyclic=*/true,
+                     /*seed=*/0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TransitiveClosure<int64_t>(rel));
+  }
+}
+
+void BM_DenseTransitiveClosure(benchmark::State& state) {
+  HashRelation<int64_t> rel =
+      RandomRelation(state.range(0), 4 * state.range(0), /*acyclic=*/true,
+                     /*seed=*/0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        DenseTransitiveClosure<int64_t>(rel, /*thread_count=*/state.range(1)));
+  }
+}
+
+void BM_DenseTransitiveClosureOfBitRelation(benchmark::State& state) {
+  int64_t n = state.range(0);
+  BitRelation rel(n, InlineBitmap(n));
+  for (const auto& [from, to_set] :
+       RandomRelation(n, 4 * n, /*acyclic=*/state.range(1) != 0,
+                      /*seed=*/0)) {
+    for (int64_t to : to_set) {
+      rel[from].Set(to);
+    }
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        DenseTransitiveClosure(rel, /*thread_count=*/state.range(2)));
+  }
+}
+
+BENCHMARK(BM_HashTransitiveClosure)->Range(16, 256);
+BENCHMARK(BM_DenseTransitiveClosure)
+    ->ArgsProduct({benchmark::CreateRange(16, 4096, 4), {1, 4}});
+BENCHMARK(BM_DenseTransitiveClosureOfBitRelation)
+    ->ArgsProduct({benchmark::CreateRange(256, 16384, 4), {0, 1}, {1, 4}});
+
 }  // namespace
 }  // namespace xls
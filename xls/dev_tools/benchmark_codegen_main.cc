@@ -29,6 +29,7 @@
 #include "absl/time/time.h"
 #include "xls/codegen/block_metrics.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/combinational_generator.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/pipeline_generator.h"
@@ -42,6 +43,8 @@
 #include "xls/ir/block.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/passes/pass_profile.pb.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -62,6 +65,13 @@ Usage:
 
 ABSL_FLAG(bool, measure_codegen_timing, true,
           "Measure timing of codegen (including scheduling).");
+ABSL_FLAG(std::string, codegen_pass_profile_path, "",
+          "If specified along with --measure_codegen_timing, write a "
+          "PassPipelineProfileProto text proto of the codegen pass pipeline "
+          "to this path. The format matches opt_main's --pass_profile_path.");
+ABSL_FLAG(std::string, codegen_pass_profile_csv_path, "",
+          "If specified along with --measure_codegen_timing, write per-pass "
+          "codegen profile summaries as CSV to this path.");
 
 namespace xls {
 namespace {
@@ -85,32 +95,64 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
   return schedule;
 }
 
+// Prints the time spent in each codegen pass and the size of each generated
+// block, and writes the profile files requested by flags.
+absl::Status PrintCodegenPassProfile(
+    Package* package, const verilog::CodegenPassResults& results) {
+  PassPipelineProfileProto profile = PassResultsToProfileProto(results);
+  AddBlockSizesToProfile(*package, &profile);
+  for (const PassSummaryProfileProto& summary : profile.summaries()) {
+    std::cout << absl::StreamFormat("Codegen pass time (%s): %dus\n",
+                                    summary.pass_name(),
+                                    summary.total_duration_us());
+  }
+  for (const BlockSizeProfileProto& block : profile.block_sizes()) {
+    std::cout << absl::StreamFormat("Block node count (%s): %d\n",
+                                    block.block_name(), block.node_count());
+  }
+  if (!absl::GetFlag(FLAGS_codegen_pass_profile_path).empty()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        absl::GetFlag(FLAGS_codegen_pass_profile_path), profile));
+  }
+  if (!absl::GetFlag(FLAGS_codegen_pass_profile_csv_path).empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(absl::GetFlag(FLAGS_codegen_pass_profile_csv_path),
+                        PassProfileToCsv(profile)));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status PrintCombinationalCodegenInfo(
     FunctionBase* f, const verilog::CodegenOptions& codegen_options,
     const DelayEstimator* delay_estimator) {
+  verilog::CodegenPassResults pass_results;
   absl::Time start = absl::Now();
-  XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult result,
-                       verilog::GenerateCombinationalModule(f, codegen_options,
-                                                            delay_estimator));
+  XLS_ASSIGN_OR_RETURN(
+      verilog::ModuleGeneratorResult result,
+      verilog::GenerateCombinationalModule(f, codegen_options, delay_estimator,
+                                           &pass_results));
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Codegen time: %dms\n",
                                   total_time / absl::Milliseconds(1));
 
-  return absl::OkStatus();
+  return PrintCodegenPassProfile(f->package(), pass_results);
 }
 
 absl::Status PrintPipelinedCodegenInfo(
     FunctionBase* f, const PipelineSchedule& schedule,
     const verilog::CodegenOptions& codegen_options) {
+  verilog::CodegenPassResults pass_results;
   absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(
       verilog::ModuleGeneratorResult codegen_result,
-      verilog::ToPipelineModuleText(schedule, f, codegen_options));
+      verilog::ToPipelineModuleText(schedule, f, codegen_options,
+                                    /*delay_estimator=*/nullptr,
+                                    &pass_results));
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Codegen time: %dms\n",
                                   total_time / absl::Milliseconds(1));
 
-  return absl::OkStatus();
+  return PrintCodegenPassProfile(f->package(), pass_results);
 }
 
 absl::StatusOr<Block*> GetTopBlock(Package* package) {
@@ -117,6 +117,7 @@ class CodeGenMainTest(test_base.TestCase):
     self.assertIn('Max reg-to-output delay: 2ps', output)
     self.assertIn('Lines of Verilog: 7', output)
     self.assertIn('Codegen time:', output)
+    self.assertIn('Codegen pass time (', output)
     self.assertIn('Scheduling time:', output)
 
   def test_simple_block_no_delay_model(self):
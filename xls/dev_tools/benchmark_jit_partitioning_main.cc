@@ -0,0 +1,174 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/observer.h"
+
+static constexpr std::string_view kUsage = R"(
+JIT compiles the top function of each given IR file with each of the given
+maximum partition costs and reports the number of partitions, the compile time
+and the mean run time of the compiled function, showing the tradeoff between
+compile time and run time made by the JIT partitioner.
+
+Usage:
+   benchmark_jit_partitioning_main [--max_partition_costs=50,150,600] \
+     [--single_partition_cost=N] [--run_iterations=N] IR_FILE...
+)";
+
+ABSL_FLAG(std::vector<std::string>, max_partition_costs,
+          std::vector<std::string>({"50", "150", "600", "2400"}),
+          "Maximum partition costs to benchmark.");
+ABSL_FLAG(int64_t, single_partition_cost,
+          xls::JitPartitionOptions().single_partition_cost,
+          "Functions with at most this total cost are emitted as a single "
+          "partition.");
+ABSL_FLAG(int64_t, opt_level, 3, "LLVM optimization level.");
+ABSL_FLAG(int64_t, run_iterations, 1000,
+          "Number of times to run each compiled function.");
+
+namespace xls {
+namespace {
+
+// Counts the partition functions in the unoptimized module.
+class PartitionCountingObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.unoptimized_module = true};
+  }
+  void UnoptimizedModule(const llvm::Module* module) override {
+    partition_count_ = 0;
+    for (const llvm::Function& function : module->functions()) {
+      if (absl::StrContains(function.getName().str(), "_partition_")) {
+        ++partition_count_;
+      }
+    }
+  }
+  int64_t partition_count() const { return partition_count_; }
+
+ private:
+  int64_t partition_count_ = 0;
+};
+
+absl::Status BenchmarkFunction(std::string_view name, Function* f,
+                               absl::Span<const int64_t> max_partition_costs) {
+  std::minstd_rand rng;
+  std::vector<Value> args;
+  for (Param* param : f->params()) {
+    args.push_back(RandomValue(param->GetType(), rng));
+  }
+  const int64_t run_iterations = absl::GetFlag(FLAGS_run_iterations);
+  for (int64_t max_partition_cost : max_partition_costs) {
+    SetJitPartitionOptions(JitPartitionOptions{
+        .max_partition_cost = max_partition_cost,
+        .single_partition_cost = absl::GetFlag(FLAGS_single_partition_cost)});
+    PartitionCountingObserver observer;
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::Create(f, absl::GetFlag(FLAGS_opt_level),
+                            /*include_observer_callbacks=*/false, &observer));
+    absl::Duration compile_time = absl::Now() - start;
+
+    start = absl::Now();
+    for (int64_t i = 0; i < run_iterations; ++i) {
+      XLS_RETURN_IF_ERROR(jit->Run(args).status());
+    }
+    absl::Duration run_time = (absl::Now() - start) / run_iterations;
+
+    std::cout << absl::StreamFormat("%-24s %8d %10d %6d %12.1f %12.3f\n", name,
+                                    f->node_count(), max_partition_cost,
+                                    observer.partition_count(),
+                                    absl::ToDoubleMilliseconds(compile_time),
+                                    absl::ToDoubleMicroseconds(run_time));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths) {
+  std::vector<int64_t> max_partition_costs;
+  for (const std::string& cost : absl::GetFlag(FLAGS_max_partition_costs)) {
+    int64_t value;
+    if (!absl::SimpleAtoi(cost, &value) || value < 1) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid maximum partition cost: %s", cost));
+    }
+    max_partition_costs.push_back(value);
+  }
+
+  std::cout << absl::StreamFormat("%-24s %8s %10s %6s %12s %12s\n", "ir",
+                                  "nodes", "max_cost", "parts", "compile_ms",
+                                  "run_us");
+  for (std::string_view ir_path : ir_paths) {
+    XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_contents, ir_path));
+    absl::StatusOr<Function*> top = package->GetTopAsFunction();
+    if (!top.ok()) {
+      LOG(WARNING) << "Skipping " << ir_path
+                   << " whose top is not a function: " << top.status();
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(BenchmarkFunction(
+        std::filesystem::path(ir_path).filename().string(), *top,
+        max_partition_costs));
+  }
+  SetJitPartitionOptions(JitPartitionOptions());
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation:\n  %s IR_FILE...",
+                                      argv[0]);
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
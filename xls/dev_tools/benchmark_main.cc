@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <iostream>
 #include <iterator>
@@ -21,6 +22,7 @@
 #include <memory>
 #include <optional>
 #include <random>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -41,13 +43,17 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "google/protobuf/util/json_util.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/binary_decision_diagram.h"
+#include "xls/dev_tools/benchmark_report.pb.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
@@ -57,8 +63,8 @@
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_interpreter.h"
 #include "xls/interpreter/function_interpreter.h"
-#include "xls/interpreter/random_value.h"
 #include "xls/ir/block.h"
+#include "xls/ir/clone_package.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
@@ -75,6 +81,8 @@
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 #include "xls/jit/proc_jit.h"
+#include "xls/jit/random_native_value.h"
+#include "xls/jit/type_layout.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
@@ -130,7 +138,24 @@ ABSL_FLAG(bool, compare_delay_to_synthesis, false,
 ABSL_FLAG(std::string, synthesis_server, "ipv4:///0.0.0.0:10000",
           "The address, including port, of the gRPC server to use with "
           "--compare_delay_to_synthesis.");
+ABSL_FLAG(std::string, synthesis_cache_dir, "",
+          "If non-empty, a directory in which to cache synthesis results for "
+          "--compare_delay_to_synthesis across runs.");
+ABSL_FLAG(int64_t, synthesis_max_concurrent_requests, 16,
+          "The maximum number of synthesis requests in flight at once for "
+          "--compare_delay_to_synthesis.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(bool, parallel_analyses, true,
+          "Run the independent analyses of the optimized IR (BDD, critical "
+          "path, scheduling and codegen, and evaluators) on separate threads. "
+          "The evaluator throughput measured may be lower as the evaluators "
+          "then share the machine with the other analyses.");
+ABSL_FLAG(std::string, output_report_path, "",
+          "If specified, write a BenchmarkReportProto text proto with all of "
+          "the printed metrics to this path.");
+ABSL_FLAG(std::string, output_report_json_path, "",
+          "If specified, write the BenchmarkReportProto with all of the "
+          "printed metrics as JSON to this path.");
 
 namespace xls {
 namespace {
@@ -142,9 +167,11 @@ std::string KnownBitString(Node* node, const QueryEngine& query_engine) {
   return query_engine.ToString(node);
 }
 
-void PrintNodeBreakdown(FunctionBase* f) {
-  std::cout << absl::StreamFormat("Entry function (%s) node count: %d nodes\n",
-                                  f->name(), f->node_count());
+void PrintNodeBreakdown(FunctionBase* f, std::ostream& os,
+                        BenchmarkReportProto& report) {
+  os << absl::StreamFormat("Entry function (%s) node count: %d nodes\n",
+                           f->name(), f->node_count());
+  report.set_node_count(f->node_count());
   std::vector<Op> ops;
   absl::flat_hash_map<Op, int64_t> op_count;
   for (Node* node : f->nodes()) {
@@ -155,11 +182,15 @@ void PrintNodeBreakdown(FunctionBase* f) {
   }
   std::sort(ops.begin(), ops.end(),
             [&](Op a, Op b) { return op_count.at(a) > op_count.at(b); });
-  std::cout << "Breakdown by op of all nodes in the graph:" << '\n';
+  os << "Breakdown by op of all nodes in the graph:" << '\n';
   for (Op op : ops) {
-    std::cout << absl::StreamFormat("  %15s : %5d (%5.2f%%)\n", OpToString(op),
-                                    op_count.at(op),
-                                    100.0 * op_count.at(op) / f->node_count());
+    os << absl::StreamFormat("  %15s : %5d (%5.2f%%)\n", OpToString(op),
+                             op_count.at(op),
+                             100.0 * op_count.at(op) / f->node_count());
+    BenchmarkReportProto::OpCountProto* op_count_proto =
+        report.add_op_counts();
+    op_count_proto->set_op(OpToString(op));
+    op_count_proto->set_count(op_count.at(op));
   }
 }
 
@@ -169,7 +200,8 @@ int64_t DurationToMs(absl::Duration duration) {
 
 // Run the standard pipeline on the given package and prints stats about the
 // passes and execution time.
-absl::Status RunOptimizationAndPrintStats(Package* package) {
+absl::Status RunOptimizationAndPrintStats(Package* package, std::ostream& os,
+                                          BenchmarkReportProto& report) {
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline();
 
@@ -194,10 +226,13 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package, pass_options, &pass_results).status());
   absl::Duration total_time = absl::Now() - start;
-  std::cout << absl::StreamFormat("Optimization time: %dms\n",
-                                  DurationToMs(total_time));
-  std::cout << absl::StreamFormat("Dynamic pass count: %d\n",
-                                  pass_results.invocations.size());
+  EndMemoryStage("optimize");
+  os << absl::StreamFormat("Optimization time: %dms\n",
+                           DurationToMs(total_time));
+  os << absl::StreamFormat("Dynamic pass count: %d\n",
+                           pass_results.invocations.size());
+  report.set_optimization_time_ms(DurationToMs(total_time));
+  report.set_dynamic_pass_count(pass_results.invocations.size());
 
   // Aggregate run times by the pass name and print a table of the aggregate
   // execution time of each pass in descending order.
@@ -239,31 +274,38 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
               }
               return a > b;
             });
-  std::cout << "Pass run durations (# of times pass changed IR / # of times "
-               "pass was run):"
-            << '\n';
+  os << "Pass run durations (# of times pass changed IR / # of times "
+        "pass was run):"
+     << '\n';
   for (const std::string& name : pass_names) {
-    std::cout << absl::StreamFormat("  %-20s : %-5dms (%3d / %3d)\n", name,
-                                    DurationToMs(pass_times.at(name)),
-                                    changed_counts.at(name),
-                                    pass_counts.at(name));
+    os << absl::StreamFormat("  %-20s : %-5dms (%3d / %3d)\n", name,
+                             DurationToMs(pass_times.at(name)),
+                             changed_counts.at(name), pass_counts.at(name));
+    BenchmarkReportProto::PassProto* pass = report.add_passes();
+    pass->set_name(name);
+    pass->set_duration_ms(DurationToMs(pass_times.at(name)));
+    pass->set_run_count(pass_counts.at(name));
+    pass->set_changed_count(changed_counts.at(name));
   }
   return absl::OkStatus();
 }
 
 absl::Status PrintCriticalPath(
     FunctionBase* f, const QueryEngine& query_engine,
-    const synthesis::SynthesizedDelayDiffByStage& delay_diff) {
+    const synthesis::SynthesizedDelayDiffByStage& delay_diff, std::ostream& os,
+    BenchmarkReportProto& report) {
   const std::vector<CriticalPathEntry>& critical_path =
       delay_diff.total_diff.critical_path;
-  std::cout << absl::StrFormat("Critical path delay: %dps\n",
-                               critical_path.front().path_delay_ps);
-  std::cout << absl::StrFormat("Critical path entry count: %d\n",
-                               critical_path.size());
+  os << absl::StrFormat("Critical path delay: %dps\n",
+                        critical_path.front().path_delay_ps);
+  os << absl::StrFormat("Critical path entry count: %d\n",
+                        critical_path.size());
+  report.set_critical_path_delay_ps(critical_path.front().path_delay_ps);
+  report.set_critical_path_entry_count(critical_path.size());
 
   absl::flat_hash_map<Op, std::pair<int64_t, int64_t>> op_to_sum;
-  std::cout << "Critical path:" << '\n';
-  std::cout << SynthesizedDelayDiffToString(
+  os << "Critical path:" << '\n';
+  os << SynthesizedDelayDiffToString(
       delay_diff.total_diff, [&query_engine](Node* n) -> std::string {
         if (absl::GetFlag(FLAGS_show_known_bits)) {
           return absl::StrFormat(
@@ -284,8 +326,7 @@ absl::Status PrintCriticalPath(
   }
 
   int64_t total_delay = critical_path.front().path_delay_ps;
-  std::cout << absl::StrFormat("Contribution by op (total %dps):\n",
-                               total_delay);
+  os << absl::StrFormat("Contribution by op (total %dps):\n", total_delay);
   std::vector<Op> ops(kAllOps.begin(), kAllOps.end());
   std::sort(ops.begin(), ops.end(), [&](Op lhs, Op rhs) {
     return op_to_sum[lhs].first > op_to_sum[rhs].first;
@@ -294,33 +335,39 @@ absl::Status PrintCriticalPath(
     if (op_to_sum[op].second == 0) {
       continue;
     }
-    std::cout << absl::StreamFormat(
+    os << absl::StreamFormat(
         " %20s: %4d (%5.2f%%, %4d nodes, %5.1f avg)\n", OpToString(op),
         op_to_sum[op].first,
         static_cast<double>(op_to_sum[op].first) / total_delay * 100.0,
         op_to_sum[op].second,
         static_cast<double>(op_to_sum[op].first) / op_to_sum[op].second);
+    BenchmarkReportProto::OpDelayProto* op_delay =
+        report.add_critical_path_op_delays();
+    op_delay->set_op(OpToString(op));
+    op_delay->set_delay_ps(op_to_sum[op].first);
+    op_delay->set_node_count(op_to_sum[op].second);
   }
-  std::cout << "\nOverall delay: "
-            << synthesis::SynthesizedDelayDiffToStringHeaderWithPercent(
-                   delay_diff.total_diff)
-            << "\nTotal synthesized stage weight diff: "
-            << absl::StrFormat("%.2f", delay_diff.total_stage_percent_diff_abs)
-            << "\nMax synthesized stage weight diff: "
-            << absl::StrFormat("%.2f", delay_diff.max_stage_percent_diff_abs)
-            << "\n";
+  os << "\nOverall delay: "
+     << synthesis::SynthesizedDelayDiffToStringHeaderWithPercent(
+            delay_diff.total_diff)
+     << "\nTotal synthesized stage weight diff: "
+     << absl::StrFormat("%.2f", delay_diff.total_stage_percent_diff_abs)
+     << "\nMax synthesized stage weight diff: "
+     << absl::StrFormat("%.2f", delay_diff.max_stage_percent_diff_abs) << "\n";
   return absl::OkStatus();
 }
 
 absl::Status PrintTotalDelay(FunctionBase* f,
-                             const DelayEstimator& delay_estimator) {
+                             const DelayEstimator& delay_estimator,
+                             std::ostream& os, BenchmarkReportProto& report) {
   int64_t total_delay = 0;
   for (Node* node : f->nodes()) {
     XLS_ASSIGN_OR_RETURN(int64_t op_delay,
                          delay_estimator.GetOperationDelayInPs(node));
     total_delay += op_delay;
   }
-  std::cout << absl::StrFormat("Total delay: %dps\n", total_delay);
+  os << absl::StrFormat("Total delay: %dps\n", total_delay);
+  report.set_total_delay_ps(total_delay);
   return absl::OkStatus();
 }
 
@@ -347,11 +394,12 @@ absl::StatusOr<std::vector<int64_t>> GetDelayPerStageInPs(
   return delay_per_stage;
 }
 
-absl::Status PrintScheduleInfo(FunctionBase* f,
-                               const PipelineSchedule& schedule,
-                               const BddQueryEngine& bdd_query_engine,
-                               const DelayEstimator& delay_estimator,
-                               std::optional<int64_t> clock_period_ps) {
+absl::Status PrintScheduleInfo(
+    FunctionBase* f, const PipelineSchedule& schedule,
+    const BddQueryEngine& bdd_query_engine,
+    const DelayEstimator& delay_estimator,
+    std::optional<int64_t> clock_period_ps, std::ostream& os,
+    BenchmarkReportProto::ScheduleProto& schedule_report) {
   int64_t total_flops = 0;
   int64_t total_duplicates = 0;
   int64_t total_constants = 0;
@@ -396,7 +444,8 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                        GetDelayPerStageInPs(f, schedule, delay_estimator));
 
   // TODO(tedhong) 2023-03-06 - Add functionality to report I/O flop count.
-  std::cout << "Pipeline:\n";
+  schedule_report.set_function(f->name());
+  os << "Pipeline:\n";
   for (int64_t i = 0; i < schedule.length(); ++i) {
     std::string stage_str = absl::StrFormat(
         "  [Stage %2d] flops: %4d (%4d dups, %4d constant)\n", i,
@@ -405,25 +454,35 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
     // Horizontally offset the information about the logic in the stage from
     // the information about stage registers to make it easier to scan the
     // information vertically without register and logic info intermixing.
-    std::cout << std::string(stage_str.size(), ' ');
-    std::cout << absl::StreamFormat("nodes: %4d, delay: %4dps\n",
-                                    schedule.nodes_in_cycle(i).size(),
-                                    delay_per_stage[i]);
+    os << std::string(stage_str.size(), ' ');
+    os << absl::StreamFormat("nodes: %4d, delay: %4dps\n",
+                             schedule.nodes_in_cycle(i).size(),
+                             delay_per_stage[i]);
 
     if (i + 1 != schedule.length()) {
-      std::cout << stage_str;
+      os << stage_str;
     }
+    BenchmarkReportProto::StageProto* stage = schedule_report.add_stages();
+    stage->set_flops(flops_per_stage[i]);
+    stage->set_duplicate_flops(duplicates_per_stage[i]);
+    stage->set_constant_flops(constants_per_stage[i]);
+    stage->set_node_count(schedule.nodes_in_cycle(i).size());
+    stage->set_delay_ps(delay_per_stage[i]);
   }
-  std::cout << absl::StreamFormat(
+  os << absl::StreamFormat(
       "Total pipeline flops: %d (%d dups, %4d constant)\n", total_flops,
       total_duplicates, total_constants);
+  schedule_report.set_total_flops(total_flops);
+  schedule_report.set_total_duplicate_flops(total_duplicates);
+  schedule_report.set_total_constant_flops(total_constants);
 
   if (clock_period_ps.has_value()) {
     int64_t min_slack = std::numeric_limits<int64_t>::max();
     for (int64_t stage_delay : delay_per_stage) {
       min_slack = std::min(min_slack, *clock_period_ps - stage_delay);
     }
-    std::cout << absl::StreamFormat("Min stage slack: %d\n", min_slack);
+    os << absl::StreamFormat("Min stage slack: %d\n", min_slack);
+    schedule_report.set_min_stage_slack_ps(min_slack);
   }
 
   return absl::OkStatus();
@@ -433,29 +492,34 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineScheduleOrGroup& schedules,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
-                               std::optional<int64_t> clock_period_ps) {
+                               std::optional<int64_t> clock_period_ps,
+                               std::ostream& os, BenchmarkReportProto& report) {
   if (std::holds_alternative<PipelineSchedule>(schedules)) {
     const PipelineSchedule& schedule = std::get<PipelineSchedule>(schedules);
+    BenchmarkReportProto::ScheduleProto* schedule_report =
+        report.add_schedules();
     if (schedule.min_clock_period_ps().has_value()) {
-      std::cout << absl::StreamFormat("Min clock period ps: %d\n",
-                                      *schedule.min_clock_period_ps());
+      os << absl::StreamFormat("Min clock period ps: %d\n",
+                               *schedule.min_clock_period_ps());
+      schedule_report->set_min_clock_period_ps(*schedule.min_clock_period_ps());
     }
     return PrintScheduleInfo(f, schedule, bdd_query_engine, delay_estimator,
-                             clock_period_ps);
+                             clock_period_ps, os, *schedule_report);
   }
 
   CHECK(std::holds_alternative<PackagePipelineSchedules>(schedules));
   for (auto& [function_base, schedule] :
        std::get<PackagePipelineSchedules>(schedules)) {
-    std::cout << "\n\nFunction: " << function_base->name() << "\n";
-    XLS_RETURN_IF_ERROR(PrintScheduleInfo(function_base, schedule,
-                                          bdd_query_engine, delay_estimator,
-                                          clock_period_ps));
+    os << "\n\nFunction: " << function_base->name() << "\n";
+    XLS_RETURN_IF_ERROR(PrintScheduleInfo(
+        function_base, schedule, bdd_query_engine, delay_estimator,
+        clock_period_ps, os, *report.add_schedules()));
   }
   return absl::OkStatus();
 }
 
-absl::Status PrintProcInfo(Proc* p) {
+absl::Status PrintProcInfo(Proc* p, std::ostream& os,
+                           BenchmarkReportProto& report) {
   XLS_RET_CHECK(p != nullptr);
 
   int64_t total_flops = 0;
@@ -463,7 +527,8 @@ absl::Status PrintProcInfo(Proc* p) {
     total_flops += param->GetType()->GetFlatBitCount();
   }
 
-  std::cout << absl::StreamFormat("Total state flops: %d\n", total_flops);
+  os << absl::StreamFormat("Total state flops: %d\n", total_flops);
+  report.set_total_state_flops(total_flops);
 
   return absl::OkStatus();
 }
@@ -493,80 +558,94 @@ absl::StatusOr<float> CountRate(const std::function<void()>& f,
   return elapsed_ms == 0 ? 0.0f : (1000.0 * call_count) / elapsed_ms;
 }
 
-template <typename ParamNode, typename Rng>
-std::vector<std::vector<Value>> GetRandomParams(
-    FunctionBase* function, int64_t input_count,
-    absl::Span<ParamNode* const> params, Rng& rng_engine) {
-  std::vector<std::vector<Value>> arg_set(input_count);
-  for (std::vector<Value>& args : arg_set) {
-    args.reserve(params.size());
-    for (Node* param : params) {
-      args.push_back(RandomValue(param->GetType(), rng_engine));
-    }
-  }
-  return arg_set;
-}
-
 struct JitArguments {
   std::vector<std::vector<std::vector<uint8_t>>> arg_buffers;
   std::vector<std::vector<uint8_t*>> arg_pointers;
 };
 
-absl::StatusOr<JitArguments> ConvertToJitArguments(
-    const std::vector<std::vector<Value>>& arg_set,
-    absl::Span<Type* const> params, JitRuntime* runtime) {
-  std::vector<std::vector<std::vector<uint8_t>>> arg_buffers;
-  std::vector<std::vector<uint8_t*>> arg_pointers;
-  for (const std::vector<Value>& args : arg_set) {
-    std::vector<std::vector<uint8_t>> buffers;
-    std::vector<uint8_t*> pointers;
-    buffers.reserve(args.size());
-    pointers.reserve(args.size());
-    for (int64_t i = 0; i < args.size(); ++i) {
-      buffers.push_back(
+// Generates `input_count` sets of random arguments of types `params` directly
+// in the native layout of the JIT, without constructing Values.
+template <typename Rng>
+JitArguments GetRandomJitArguments(int64_t input_count,
+                                   absl::Span<Type* const> params,
+                                   JitRuntime* runtime, Rng& rng_engine) {
+  std::vector<RandomNativeValueGenerator> generators;
+  generators.reserve(params.size());
+  for (Type* param : params) {
+    generators.push_back(RandomNativeValueGenerator(
+        runtime->CreateTypeLayout(param),
+        std::uniform_int_distribution<uint64_t>()(rng_engine)));
+  }
+  std::vector<std::vector<std::vector<uint8_t>>> arg_buffers(input_count);
+  std::vector<std::vector<uint8_t*>> arg_pointers(input_count);
+  for (int64_t i = 0; i < input_count; ++i) {
+    arg_buffers[i].reserve(params.size());
+    arg_pointers[i].reserve(params.size());
+    for (int64_t j = 0; j < params.size(); ++j) {
+      arg_buffers[i].push_back(
           std::vector<uint8_t>(runtime->ShouldAllocateForAlignment(
-                                   runtime->GetTypeByteSize(params[i]),
-                                   runtime->GetTypeAlignment(params[i])),
+                                   runtime->GetTypeByteSize(params[j]),
+                                   runtime->GetTypeAlignment(params[j])),
                                0));
-      pointers.push_back(runtime
-                             ->AsAligned(absl::MakeSpan(buffers.back()),
-                                         runtime->GetTypeAlignment(params[i]))
-                             .data());
-      CHECK_NE(pointers.back(), nullptr);
+      arg_pointers[i].push_back(
+          runtime
+              ->AsAligned(absl::MakeSpan(arg_buffers[i].back()),
+                          runtime->GetTypeAlignment(params[j]))
+              .data());
+      CHECK_NE(arg_pointers[i].back(), nullptr);
+      generators[j].Generate(arg_pointers[i].back());
     }
-    arg_buffers.push_back(std::move(buffers));
-    arg_pointers.push_back(pointers);
-    XLS_RETURN_IF_ERROR(runtime->PackArgs(args, params, arg_pointers.back()));
   }
   return JitArguments{std::move(arg_buffers), std::move(arg_pointers)};
 }
 
+// Returns the values of the JIT arguments, for the interpreters.
+std::vector<std::vector<Value>> JitArgumentsToValues(
+    const JitArguments& jit_args, absl::Span<Type* const> params,
+    JitRuntime* runtime) {
+  std::vector<TypeLayout> layouts;
+  layouts.reserve(params.size());
+  for (Type* param : params) {
+    layouts.push_back(runtime->CreateTypeLayout(param));
+  }
+  std::vector<std::vector<Value>> arg_set;
+  arg_set.reserve(jit_args.arg_pointers.size());
+  for (const std::vector<uint8_t*>& pointers : jit_args.arg_pointers) {
+    std::vector<Value>& args = arg_set.emplace_back();
+    args.reserve(pointers.size());
+    for (int64_t i = 0; i < pointers.size(); ++i) {
+      args.push_back(layouts[i].NativeLayoutToValue(pointers[i]));
+    }
+  }
+  return arg_set;
+}
+
 // Run the interpreter/JIT for a fixed amount of time and measure the rate of
 // calls per second.
 constexpr int64_t kRunDurationMs = 500;
 constexpr int64_t kJitRunMultiplier = 1000;
 
 template <typename Rng>
-absl::Status RunFunctionInterpreterAndJit(Function* function,
-                                          std::string_view description,
-                                          Rng& rng_engine) {
+absl::Status RunFunctionInterpreterAndJit(
+    Function* function, std::string_view description, Rng& rng_engine,
+    std::ostream& os, BenchmarkReportProto::EvaluatorProto& evaluator_report) {
   absl::Time start_jit_compile = absl::Now();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
                        FunctionJit::Create(function));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
-
-  const int64_t kInputCount = 100;
-  auto arg_set =
-      GetRandomParams(function, kInputCount, function->params(), rng_engine);
+  int64_t jit_compile_time_ms = DurationToMs(absl::Now() - start_jit_compile);
+  os << absl::StreamFormat("JIT compile time (%s): %dms\n", description,
+                           jit_compile_time_ms);
+  evaluator_report.set_jit_compile_time_ms(jit_compile_time_ms);
+  EndMemoryStage(absl::StrCat("jit_compile/", description));
 
   // To avoid being dominated by xls::Value conversion to native
-  // format, preconvert the arguments.
-  XLS_ASSIGN_OR_RETURN(
-      JitArguments jit_args,
-      ConvertToJitArguments(arg_set, function->GetType()->parameters(),
-                            jit->runtime()));
+  // format, generate the arguments in the native format.
+  const int64_t kInputCount = 100;
+  JitArguments jit_args =
+      GetRandomJitArguments(kInputCount, function->GetType()->parameters(),
+                            jit->runtime(), rng_engine);
+  std::vector<std::vector<Value>> arg_set = JitArgumentsToValues(
+      jit_args, function->GetType()->parameters(), jit->runtime());
   auto [jit_arg_buffers, jit_arg_pointers] = std::move(jit_args);
 
   // The JIT is much faster so run many times.
@@ -587,9 +666,10 @@ absl::Status RunFunctionInterpreterAndJit(Function* function,
             return absl::OkStatus();
           },
           kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "JIT run time (%s): %d Kcalls/s\n", description,
-      static_cast<int64_t>(kInputCount * jit_run_rate));
+  os << absl::StreamFormat("JIT run time (%s): %d Kcalls/s\n", description,
+                           static_cast<int64_t>(kInputCount * jit_run_rate));
+  evaluator_report.set_jit_calls_per_second(kInputCount * kJitRunMultiplier *
+                                            jit_run_rate);
 
   XLS_ASSIGN_OR_RETURN(
       float interpreter_run_rate,
@@ -601,25 +681,56 @@ absl::Status RunFunctionInterpreterAndJit(Function* function,
             return absl::OkStatus();
           },
           kRunDurationMs));
-  std::cout << absl::StreamFormat(
+  os << absl::StreamFormat(
       "Interpreter run time (%s): %d calls/s\n", description,
       static_cast<int64_t>(kInputCount * interpreter_run_rate));
+  evaluator_report.set_interpreter_calls_per_second(kInputCount *
+                                                    interpreter_run_rate);
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled_interpreter,
+      CompiledFunctionInterpreter::Create(function));
+  XLS_ASSIGN_OR_RETURN(
+      float compiled_interpreter_run_rate,
+      CountRate(
+          [&]() -> absl::Status {
+            for (const std::vector<Value>& args : arg_set) {
+              CHECK_OK(compiled_interpreter->Run(args).status());
+            }
+            return absl::OkStatus();
+          },
+          kRunDurationMs));
+  os << absl::StreamFormat(
+      "Compiled interpreter run time (%s): %d calls/s\n", description,
+      static_cast<int64_t>(kInputCount * compiled_interpreter_run_rate));
+  evaluator_report.set_compiled_interpreter_calls_per_second(
+      kInputCount * compiled_interpreter_run_rate);
   return absl::OkStatus();
 }
 
 template <typename Rng>
-absl::Status RunBlockInterpreterAndJit(Block* block,
-                                       std::string_view description,
-                                       Rng& rng_engine) {
+absl::Status RunBlockInterpreterAndJit(
+    Block* block, std::string_view description, Rng& rng_engine,
+    std::ostream& os, BenchmarkReportProto::EvaluatorProto& evaluator_report) {
   absl::Time start_jit_compile = absl::Now();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit, BlockJit::Create(block));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
+  int64_t jit_compile_time_ms = DurationToMs(absl::Now() - start_jit_compile);
+  os << absl::StreamFormat("JIT compile time (%s): %dms\n", description,
+                           jit_compile_time_ms);
+  evaluator_report.set_jit_compile_time_ms(jit_compile_time_ms);
+  EndMemoryStage(absl::StrCat("jit_compile/", description));
 
+  // To avoid being dominated by xls::Value conversion to native
+  // format, generate the arguments in the native format.
+  std::vector<Type*> input_types;
+  input_types.reserve(block->GetInputPorts().size());
+  absl::c_transform(block->GetInputPorts(), std::back_inserter(input_types),
+                    [](InputPort* v) { return v->GetType(); });
   const int64_t kInputCount = 100;
+  JitArguments jit_args = GetRandomJitArguments(kInputCount, input_types,
+                                                jit->runtime(), rng_engine);
   std::vector<std::vector<Value>> arg_set =
-      GetRandomParams(block, kInputCount, block->GetInputPorts(), rng_engine);
+      JitArgumentsToValues(jit_args, input_types, jit->runtime());
   std::vector<absl::flat_hash_map<std::string, Value>> port_set;
   port_set.reserve(arg_set.size());
   absl::c_transform(arg_set, std::back_inserter(port_set),
@@ -631,16 +742,6 @@ absl::Status RunBlockInterpreterAndJit(Block* block,
                       }
                       return out;
                     });
-
-  // To avoid being dominated by xls::Value conversion to native
-  // format, preconvert the arguments.
-  std::vector<Type*> input_types;
-  input_types.reserve(block->GetInputPorts().size());
-  absl::c_transform(block->GetInputPorts(), std::back_inserter(input_types),
-                    [](InputPort* v) { return v->GetType(); });
-  XLS_ASSIGN_OR_RETURN(
-      auto jit_args,
-      ConvertToJitArguments(arg_set, input_types, jit->runtime()));
   auto [jit_arg_buffers, jit_arg_pointers] = std::move(jit_args);
 
   // The JIT is much faster so run many times.
@@ -658,9 +759,10 @@ absl::Status RunBlockInterpreterAndJit(Block* block,
             return absl::OkStatus();
           },
           kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "JIT run time (%s): %d Kcalls/s\n", description,
-      static_cast<int64_t>(kInputCount * jit_run_rate));
+  os << absl::StreamFormat("JIT run time (%s): %d Kcalls/s\n", description,
+                           static_cast<int64_t>(kInputCount * jit_run_rate));
+  evaluator_report.set_jit_calls_per_second(kInputCount * kJitRunMultiplier *
+                                            jit_run_rate);
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
                        kInterpreterBlockEvaluator.NewContinuation(block));
@@ -675,15 +777,18 @@ absl::Status RunBlockInterpreterAndJit(Block* block,
             return absl::OkStatus();
           },
           kRunDurationMs));
-  std::cout << absl::StreamFormat(
+  os << absl::StreamFormat(
       "Interpreter run time (%s): %d calls/s\n", description,
       static_cast<int64_t>(kInputCount * interpreter_run_rate));
+  evaluator_report.set_interpreter_calls_per_second(kInputCount *
+                                                    interpreter_run_rate);
   return absl::OkStatus();
 }
 
 template <typename Rng>
-absl::Status RunProcInterpreterAndJit(Proc* proc, std::string_view description,
-                                      Rng& rng_engine) {
+absl::Status RunProcInterpreterAndJit(
+    Proc* proc, std::string_view description, Rng& rng_engine,
+    std::ostream& os, BenchmarkReportProto::EvaluatorProto& evaluator_report) {
   absl::Time start_jit_compile = absl::Now();
   // Technically the creation cost to get the data layout is amortized over all
   // the procs in the elaboration.
@@ -696,30 +801,165 @@ absl::Status RunProcInterpreterAndJit(Proc* proc, std::string_view description,
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<ProcJit> jit,
       ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
+  int64_t jit_compile_time_ms = DurationToMs(absl::Now() - start_jit_compile);
+  os << absl::StreamFormat("JIT compile time (%s): %dms\n", description,
+                           jit_compile_time_ms);
+  evaluator_report.set_jit_compile_time_ms(jit_compile_time_ms);
+  EndMemoryStage(absl::StrCat("jit_compile/", description));
   // TODO(meheff): 2022/5/16 Run the proc as well.
 
   return absl::OkStatus();
 }
 
 absl::Status RunInterpreterAndJit(FunctionBase* function_base,
-                                  std::string_view description) {
+                                  std::string_view description,
+                                  std::ostream& os,
+                                  BenchmarkReportProto& report) {
   std::minstd_rand rng_engine;
+  BenchmarkReportProto::EvaluatorProto* evaluator_report =
+      report.add_evaluators();
+  evaluator_report->set_description(description);
   if (function_base->IsFunction()) {
     Function* function = function_base->AsFunctionOrDie();
-    return RunFunctionInterpreterAndJit(function, description, rng_engine);
+    return RunFunctionInterpreterAndJit(function, description, rng_engine, os,
+                                        *evaluator_report);
   }
 
   if (function_base->IsBlock()) {
     Block* block = function_base->AsBlockOrDie();
-    return RunBlockInterpreterAndJit(block, description, rng_engine);
+    return RunBlockInterpreterAndJit(block, description, rng_engine, os,
+                                     *evaluator_report);
   }
 
   XLS_RET_CHECK(function_base->IsProc());
   Proc* proc = function_base->AsProcOrDie();
-  return RunProcInterpreterAndJit(proc, description, rng_engine);
+  return RunProcInterpreterAndJit(proc, description, rng_engine, os,
+                                  *evaluator_report);
+}
+
+// Returns a copy of `p` with the same top, for analyses which modify the
+// package or must not share it with analyses running concurrently.
+absl::StatusOr<std::unique_ptr<Package>> CloneWithTop(Package* p) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> clone, ClonePackage(p));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top,
+                       clone->GetFunctionBaseByName((*p->GetTop())->name()));
+  XLS_RETURN_IF_ERROR(clone->SetTop(top));
+  return clone;
+}
+
+// The output of an analysis which may run concurrently with others. It is
+// emitted once all of them are done, in a fixed order, so the output does not
+// depend on how the analyses were scheduled.
+struct AnalysisOutput {
+  std::ostringstream text;
+  BenchmarkReportProto report;
+};
+
+// Runs the given analyses, on separate threads if --parallel_analyses is set.
+// Returns the first error of any of them.
+absl::Status RunAnalyses(
+    absl::Span<const std::function<absl::Status()>> analyses) {
+  std::vector<absl::Status> statuses(analyses.size());
+  if (absl::GetFlag(FLAGS_parallel_analyses)) {
+    TaskGroup group;
+    for (int64_t i = 0; i < analyses.size(); ++i) {
+      group.Schedule(
+          [&analyses, &statuses, i] { statuses[i] = analyses[i](); });
+    }
+    XLS_RETURN_IF_ERROR(group.Wait());
+  } else {
+    for (int64_t i = 0; i < analyses.size(); ++i) {
+      statuses[i] = analyses[i]();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+// Schedules and generates a pipeline for the top of `p` and prints metrics of
+// the result. Also benchmarks the evaluators on the generated block if
+// --run_evaluators is set. With a synthesizer, sets `delay_diff` to the
+// synthesized delay of each stage.
+absl::Status BenchmarkCodegen(
+    Package* p,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    const CodegenFlagsProto& codegen_flags_proto, bool delay_model_flag_passed,
+    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer,
+    synthesis::SynthesizedDelayDiffByStage& delay_diff, std::ostream& os,
+    BenchmarkReportProto& report) {
+  FunctionBase* f = *p->GetTop();
+  TimingReport timing_report;
+  PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult codegen_result,
+      ScheduleAndCodegen(p, scheduling_options_flags_proto, codegen_flags_proto,
+                         delay_model_flag_passed, &timing_report, &schedules));
+  if (synthesizer != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        delay_diff,
+        CreateDelayDiffByStage(f, std::get<PipelineSchedule>(schedules),
+                               delay_estimator, synthesizer));
+  }
+
+  os << absl::StreamFormat("Scheduling time: %dms\n",
+                           DurationToMs(timing_report.scheduling_time));
+  os << absl::StreamFormat("Codegen time: %dms\n",
+                           DurationToMs(timing_report.codegen_time));
+  report.set_scheduling_time_ms(DurationToMs(timing_report.scheduling_time));
+  report.set_codegen_time_ms(DurationToMs(timing_report.codegen_time));
+
+  // TODO(meheff): Add an estimate of total number of gates.
+  int64_t verilog_line_count =
+      std::vector<std::string>(
+          absl::StrSplit(codegen_result.module_generator_result.verilog_text,
+                         '\n'))
+          .size();
+  os << absl::StreamFormat("Lines of Verilog: %d\n", verilog_line_count);
+  report.set_verilog_line_count(verilog_line_count);
+
+  // Scheduling can change the nodes in f slightly so we need to recompute the
+  // bdd.
+  BddQueryEngine sched_qe(BddFunction::kDefaultPathLimit);
+  XLS_RETURN_IF_ERROR(sched_qe.Populate(f).status());
+  XLS_RETURN_IF_ERROR(PrintScheduleInfo(
+      f, schedules, sched_qe, delay_estimator,
+      scheduling_options_flags_proto.has_clock_period_ps()
+          ? std::make_optional(scheduling_options_flags_proto.clock_period_ps())
+          : std::nullopt,
+      os, report));
+
+  // Print out state information for procs.
+  if (f->IsProc()) {
+    XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie(), os, report));
+  }
+  if (absl::GetFlag(FLAGS_run_evaluators)) {
+    XLS_RETURN_IF_ERROR(
+        RunInterpreterAndJit(p->blocks()[0].get(), "block", os, report));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteReport(const BenchmarkReportProto& report) {
+  if (std::string path = absl::GetFlag(FLAGS_output_report_path);
+      !path.empty()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(path, report));
+  }
+  if (std::string path = absl::GetFlag(FLAGS_output_report_json_path);
+      !path.empty()) {
+    std::string json;
+    google::protobuf::util::JsonPrintOptions print_options;
+    print_options.add_whitespace = true;
+    print_options.preserve_proto_field_names = true;
+    auto status = google::protobuf::util::MessageToJsonString(
+        report, &json, print_options);
+    if (!status.ok()) {
+      return absl::InternalError(std::string{status.message()});
+    }
+    XLS_RETURN_IF_ERROR(SetFileContents(path, json));
+  }
+  return absl::OkStatus();
 }
 
 absl::Status RealMain(std::string_view path) {
@@ -727,6 +967,7 @@ absl::Status RealMain(std::string_view path) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(contents));
+  EndMemoryStage("parse");
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -744,16 +985,17 @@ absl::Status RealMain(std::string_view path) {
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
+  BenchmarkReportProto report;
+  report.set_top((*package->GetTop())->name());
   if (absl::GetFlag(FLAGS_run_evaluators)) {
-    XLS_RETURN_IF_ERROR(
-        RunInterpreterAndJit(package->GetTop().value(), "unoptimized"));
+    XLS_RETURN_IF_ERROR(RunInterpreterAndJit(package->GetTop().value(),
+                                             "unoptimized", std::cout, report));
   }
-  XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get()));
+  XLS_RETURN_IF_ERROR(
+      RunOptimizationAndPrintStats(package.get(), std::cout, report));
 
   FunctionBase* f = package->GetTop().value();
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
-  PrintNodeBreakdown(f);
+  PrintNodeBreakdown(f, std::cout, report);
 
   std::optional<int64_t> effective_clock_period_ps;
   if (scheduling_options_flags_proto.has_clock_period_ps() &&
@@ -773,97 +1015,100 @@ absl::Status RealMain(std::string_view path) {
   if (!delay_model_flag_passed) {
     pdelay_estimator = &GetStandardDelayEstimator();
   } else {
-    XLS_ASSIGN_OR_RETURN(
-        pdelay_estimator,
-        GetDelayEstimator(scheduling_options_flags_proto.delay_model()));
+    XLS_ASSIGN_OR_RETURN(pdelay_estimator,
+                         SetUpDelayEstimator(scheduling_options_flags_proto));
   }
   const auto& delay_estimator = *pdelay_estimator;
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<CriticalPathEntry> critical_path,
-      AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
   std::unique_ptr<synthesis::Synthesizer> synthesizer;
   if (absl::GetFlag(FLAGS_compare_delay_to_synthesis)) {
+    std::optional<std::filesystem::path> cache_dir;
+    if (!absl::GetFlag(FLAGS_synthesis_cache_dir).empty()) {
+      cache_dir = absl::GetFlag(FLAGS_synthesis_cache_dir);
+    }
     synthesis::GrpcSynthesizerParameters parameters(
-        absl::GetFlag(FLAGS_synthesis_server));
+        absl::GetFlag(FLAGS_synthesis_server), synthesis::kDefaultFrequencyHz,
+        std::move(cache_dir),
+        absl::GetFlag(FLAGS_synthesis_max_concurrent_requests));
     XLS_ASSIGN_OR_RETURN(
         synthesizer,
         synthesis::GetSynthesizerManagerSingleton().MakeSynthesizer(
             parameters.name(), parameters));
   }
-  if (absl::GetFlag(FLAGS_run_evaluators)) {
-    XLS_RETURN_IF_ERROR(RunInterpreterAndJit(f, "optimized"));
-  }
   const bool benchmark_codegen =
       scheduling_options_flags_proto.clock_period_ps() > 0 ||
       scheduling_options_flags_proto.pipeline_stages() > 0;
+
+  // The analyses of the optimized IR are independent of each other, so they
+  // may run concurrently. The BDD and critical path analyses only read the
+  // IR; the evaluators and codegen get their own copies of the package as
+  // they add types and blocks to it.
+  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
+  std::vector<CriticalPathEntry> critical_path;
+  std::vector<std::function<absl::Status()>> analyses = {
+      [&] { return query_engine.Populate(f).status(); },
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(
+            critical_path,
+            AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
+        return absl::OkStatus();
+      },
+  };
+  std::unique_ptr<Package> evaluator_package;
+  AnalysisOutput evaluator_output;
+  if (absl::GetFlag(FLAGS_run_evaluators)) {
+    XLS_ASSIGN_OR_RETURN(evaluator_package, CloneWithTop(package.get()));
+    analyses.push_back([&] {
+      return RunInterpreterAndJit(*evaluator_package->GetTop(), "optimized",
+                                  evaluator_output.text,
+                                  evaluator_output.report);
+    });
+  }
+  std::unique_ptr<Package> codegen_package;
+  AnalysisOutput codegen_output;
+  synthesis::SynthesizedDelayDiffByStage delay_diff;
+  if (benchmark_codegen) {
+    XLS_ASSIGN_OR_RETURN(codegen_package, CloneWithTop(package.get()));
+    analyses.push_back([&] {
+      return BenchmarkCodegen(
+          codegen_package.get(), scheduling_options_flags_proto,
+          codegen_flags_proto, delay_model_flag_passed, delay_estimator,
+          synthesizer.get(), delay_diff, codegen_output.text,
+          codegen_output.report);
+    });
+  }
+  XLS_RETURN_IF_ERROR(RunAnalyses(analyses));
+
+  std::cout << evaluator_output.text.str();
+  report.MergeFrom(evaluator_output.report);
   if (!f->IsProc() && !benchmark_codegen) {
-    synthesis::SynthesizedDelayDiff delay_diff;
+    synthesis::SynthesizedDelayDiff total_diff;
     if (synthesizer) {
       XLS_ASSIGN_OR_RETURN(
-          delay_diff,
+          total_diff,
           SynthesizeAndGetDelayDiff(f, critical_path, synthesizer.get()));
     } else {
-      delay_diff.critical_path = std::move(critical_path);
+      total_diff.critical_path = std::move(critical_path);
     }
     XLS_RETURN_IF_ERROR(PrintCriticalPath(
-        f, query_engine, {.total_diff = std::move(delay_diff)}));
-    XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
+        f, query_engine, {.total_diff = std::move(total_diff)}, std::cout,
+        report));
+    XLS_RETURN_IF_ERROR(
+        PrintTotalDelay(f, delay_estimator, std::cout, report));
   } else if (benchmark_codegen) {
-    TimingReport timing_report;
-    PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
-    XLS_ASSIGN_OR_RETURN(
-        CodegenResult codegen_result,
-        ScheduleAndCodegen(package.get(), scheduling_options_flags_proto,
-                           codegen_flags_proto, delay_model_flag_passed,
-                           &timing_report, &schedules));
-    synthesis::SynthesizedDelayDiffByStage delay_diff;
-    if (synthesizer) {
-      XLS_ASSIGN_OR_RETURN(
-          delay_diff,
-          CreateDelayDiffByStage(f, std::get<PipelineSchedule>(schedules),
-                                 *pdelay_estimator, synthesizer.get()));
-    }
     delay_diff.total_diff.critical_path = std::move(critical_path);
-    XLS_RETURN_IF_ERROR(PrintCriticalPath(f, query_engine, delay_diff));
-    XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
-
-    std::cout << absl::StreamFormat(
-        "Scheduling time: %dms\n",
-        timing_report.scheduling_time / absl::Milliseconds(1));
-    std::cout << absl::StreamFormat(
-        "Codegen time: %dms\n",
-        timing_report.codegen_time / absl::Milliseconds(1));
-
-    // TODO(meheff): Add an estimate of total number of gates.
-    std::cout << absl::StreamFormat(
-        "Lines of Verilog: %d\n",
-        std::vector<std::string>(
-            absl::StrSplit(codegen_result.module_generator_result.verilog_text,
-                           '\n'))
-            .size());
-
-    // Scheduling can change the nodes in f slightly so we need to recompute the
-    // bdd.
-    BddQueryEngine sched_qe(BddFunction::kDefaultPathLimit);
-    XLS_RETURN_IF_ERROR(sched_qe.Populate(f).status());
-    XLS_RETURN_IF_ERROR(PrintScheduleInfo(
-        f, schedules, sched_qe, delay_estimator,
-        scheduling_options_flags_proto.has_clock_period_ps()
-            ? std::make_optional(
-                  scheduling_options_flags_proto.clock_period_ps())
-            : std::nullopt));
-
-    // Print out state information for procs.
-    if (f->IsProc()) {
-      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie()));
-    }
-    if (absl::GetFlag(FLAGS_run_evaluators)) {
-      XLS_RETURN_IF_ERROR(
-          RunInterpreterAndJit(package->blocks()[0].get(), "block"));
-    }
+    XLS_RETURN_IF_ERROR(
+        PrintCriticalPath(f, query_engine, delay_diff, std::cout, report));
+    XLS_RETURN_IF_ERROR(
+        PrintTotalDelay(f, delay_estimator, std::cout, report));
+    std::cout << codegen_output.text.str();
+    report.MergeFrom(codegen_output.report);
   }
 
-  return absl::OkStatus();
+  int64_t peak_rss_bytes = GetPeakRssBytes();
+  std::cout << absl::StreamFormat("Peak RSS: %dMiB\n", peak_rss_bytes >> 20);
+  report.set_peak_rss_bytes(peak_rss_bytes);
+  XLS_RETURN_IF_ERROR(WriteReport(report));
+  return WriteProcessMemoryProfile();
 }
 
 }  // namespace
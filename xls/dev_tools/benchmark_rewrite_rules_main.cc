@@ -0,0 +1,137 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/passes/arith_simplification_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_rule_set.h"
+
+static constexpr std::string_view kUsage = R"(
+Runs the arithmetic simplification pass over each given IR file with the
+rewrite rules dispatched on the op of each node and with every rule checked
+against every node, and reports the mean pass time of each. The IR produced by
+both is checked to be identical.
+
+Usage:
+   benchmark_rewrite_rules_main [--iterations=N] IR_FILE...
+)";
+
+ABSL_FLAG(int64_t, iterations, 20,
+          "Number of times to run the pass in each configuration.");
+
+namespace xls {
+namespace {
+
+struct PassRun {
+  absl::Duration time;
+  std::string ir;
+};
+
+// Runs the pass `iterations` times on freshly parsed copies of `ir_contents`
+// and returns the mean time of the pass alone and the resulting IR.
+absl::StatusOr<PassRun> RunPass(std::string_view ir_contents,
+                                std::string_view ir_path, bool indexing,
+                                int64_t iterations) {
+  SetRewriteRuleIndexing(indexing);
+  ArithSimplificationPass pass;
+  PassRun run{.time = absl::ZeroDuration()};
+  for (int64_t i = 0; i < iterations; ++i) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_contents, ir_path));
+    PassResults results;
+    absl::Time start = absl::Now();
+    XLS_RETURN_IF_ERROR(
+        pass.Run(package.get(), OptimizationPassOptions(), &results).status());
+    run.time += absl::Now() - start;
+    if (i == 0) {
+      run.ir = package->DumpIr();
+    }
+  }
+  run.time /= iterations;
+  return run;
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths) {
+  const int64_t iterations = absl::GetFlag(FLAGS_iterations);
+  if (iterations < 1) {
+    return absl::InvalidArgumentError("--iterations must be positive");
+  }
+  std::cout << absl::StreamFormat("%-24s %8s %12s %12s %8s\n", "ir", "nodes",
+                                  "indexed_ms", "linear_ms", "speedup");
+  for (std::string_view ir_path : ir_paths) {
+    XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+    int64_t node_count = 0;
+    {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_contents, ir_path));
+      node_count = package->GetNodeCount();
+    }
+    XLS_ASSIGN_OR_RETURN(PassRun indexed,
+                         RunPass(ir_contents, ir_path, /*indexing=*/true,
+                                 iterations));
+    XLS_ASSIGN_OR_RETURN(PassRun linear,
+                         RunPass(ir_contents, ir_path, /*indexing=*/false,
+                                 iterations));
+    if (indexed.ir != linear.ir) {
+      return absl::InternalError(absl::StrFormat(
+          "Indexed and linear rule dispatch produced different IR for %s",
+          ir_path));
+    }
+    std::cout << absl::StreamFormat(
+        "%-24s %8d %12.3f %12.3f %8.2f\n",
+        std::filesystem::path(ir_path).filename().string(), node_count,
+        absl::ToDoubleMilliseconds(indexed.time),
+        absl::ToDoubleMilliseconds(linear.time),
+        absl::FDivDuration(linear.time, indexed.time));
+  }
+  SetRewriteRuleIndexing(true);
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation:\n  %s IR_FILE...",
+                                      argv[0]);
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
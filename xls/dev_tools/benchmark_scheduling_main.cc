@@ -0,0 +1,340 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/resource.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "google/protobuf/text_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/scheduling_benchmark.pb.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/sdc_scheduler.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+static constexpr std::string_view kUsage = R"(
+Schedules the top of each given IR file with each of the given scheduling
+strategies and records the scheduling time, peak memory, LP size and resulting
+pipeline as a SchedulingBenchmarkResultsProto. Scheduling flags such as
+--delay_model, --clock_period_ps and --pipeline_stages apply to every file.
+
+If --baseline_textproto is given, exits with an error if any result regressed
+compared to the baseline: if scheduling fails, produces a longer pipeline or
+more pipeline registers, or takes too much longer or more memory.
+
+Usage:
+   benchmark_scheduling_main --delay_model=DELAY_MODEL --clock_period_ps=PS \
+     [--strategies=sdc,min_cut,asap] [--output_textproto=FILE] \
+     [--baseline_textproto=FILE] IR_FILE...
+)";
+
+ABSL_FLAG(std::vector<std::string>, strategies,
+          std::vector<std::string>({"sdc", "min_cut", "asap"}),
+          "Scheduling strategies to benchmark: any of sdc, min_cut and asap.");
+ABSL_FLAG(std::string, output_textproto, "",
+          "File to write the results to as a SchedulingBenchmarkResultsProto. "
+          "If empty, the results are printed to stdout.");
+ABSL_FLAG(std::string, baseline_textproto, "",
+          "SchedulingBenchmarkResultsProto to compare the results against.");
+ABSL_FLAG(double, max_time_regression_percent, 25.0,
+          "Scheduling time increase over the baseline, in percent, which is "
+          "reported as a regression.");
+ABSL_FLAG(double, max_rss_regression_percent, 10.0,
+          "Peak memory increase over the baseline, in percent, which is "
+          "reported as a regression.");
+
+namespace xls {
+namespace {
+
+absl::StatusOr<SchedulingStrategy> ParseStrategy(std::string_view name) {
+  if (name == "sdc") {
+    return SchedulingStrategy::SDC;
+  }
+  if (name == "min_cut") {
+    return SchedulingStrategy::MIN_CUT;
+  }
+  if (name == "asap") {
+    return SchedulingStrategy::ASAP;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown scheduling strategy '%s'; expected sdc, min_cut or asap.",
+      name));
+}
+
+// Resets the peak resident set size reported by the kernel so that
+// GetPeakRssBytes measures each run separately. This is only supported on
+// Linux; elsewhere the peak covers the whole process.
+void ResetPeakRss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (clear_refs) {
+    clear_refs << "5";
+  }
+}
+
+int64_t GetPeakRssBytes() {
+  absl::StatusOr<std::string> status = GetFileContents("/proc/self/status");
+  if (status.ok()) {
+    for (std::string_view line : absl::StrSplit(*status, '\n')) {
+      if (absl::ConsumePrefix(&line, "VmHWM:") &&
+          absl::ConsumeSuffix(&line, "kB")) {
+        int64_t kilobytes;
+        if (absl::SimpleAtoi(line, &kilobytes)) {
+          return kilobytes * 1024;
+        }
+      }
+    }
+  }
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // On macOS ru_maxrss is reported in bytes.
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  // On Linux ru_maxrss is reported in kilobytes.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Rebuilds and solves the LP for the final schedule of `f` to measure its
+// size and solve time, which RunPipelineSchedule doesn't expose.
+absl::Status MeasureLp(FunctionBase* f, const DelayEstimator& delay_estimator,
+                       const SchedulingOptions& options,
+                       SchedulingBenchmarkProto& result) {
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SDCScheduler> sdc_scheduler,
+      SDCScheduler::Create(f, delay_estimator,
+                           options.prune_critical_path_distances()));
+  XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
+  XLS_RETURN_IF_ERROR(sdc_scheduler
+                          ->Schedule(result.pipeline_length(),
+                                     result.clock_period_ps(),
+                                     options.failure_behavior())
+                          .status());
+  result.set_lp_solve_time_us((absl::Now() - start) / absl::Microseconds(1));
+  result.set_lp_variables(sdc_scheduler->lp_variable_count());
+  result.set_lp_constraints(sdc_scheduler->lp_constraint_count());
+  return absl::OkStatus();
+}
+
+SchedulingBenchmarkProto RunBenchmark(FunctionBase* f,
+                                      const DelayEstimator& delay_estimator,
+                                      SchedulingOptions options,
+                                      std::string_view strategy_name,
+                                      SchedulingStrategy strategy) {
+  SchedulingBenchmarkProto result;
+  result.set_top(f->name());
+  result.set_strategy(strategy_name);
+  result.set_node_count(f->node_count());
+  options.strategy(strategy);
+
+  ResetPeakRss();
+  absl::Time start = absl::Now();
+  absl::StatusOr<PipelineSchedule> schedule =
+      RunPipelineSchedule(f, delay_estimator, options);
+  result.set_schedule_time_us((absl::Now() - start) / absl::Microseconds(1));
+  result.set_peak_rss_bytes(GetPeakRssBytes());
+  if (!schedule.ok()) {
+    result.set_error(schedule.status().ToString());
+    return result;
+  }
+  result.set_pipeline_length(schedule->length());
+  result.set_clock_period_ps(schedule->min_clock_period_ps().value_or(
+      options.clock_period_ps().value_or(0)));
+  result.set_pipeline_registers(
+      schedule->CountFinalInteriorPipelineRegisters());
+
+  if (strategy == SchedulingStrategy::SDC && result.clock_period_ps() > 0) {
+    absl::Status status = MeasureLp(f, delay_estimator, options, result);
+    if (!status.ok()) {
+      LOG(WARNING) << "Unable to measure the LP for " << f->name() << ": "
+                   << status;
+    }
+  }
+  return result;
+}
+
+std::string Describe(const SchedulingBenchmarkProto& result) {
+  return absl::StrFormat("%s (%s)", result.name(), result.strategy());
+}
+
+bool Exceeds(int64_t value, int64_t baseline, double percent) {
+  return baseline > 0 &&
+         static_cast<double>(value) >
+             static_cast<double>(baseline) * (1.0 + percent / 100.0);
+}
+
+absl::Status CheckForRegressions(
+    const SchedulingBenchmarkResultsProto& results,
+    const SchedulingBenchmarkResultsProto& baseline) {
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      const SchedulingBenchmarkProto*>
+      baseline_results;
+  for (const SchedulingBenchmarkProto& result : baseline.results()) {
+    baseline_results[{result.name(), result.strategy()}] = &result;
+  }
+  const double max_time_percent =
+      absl::GetFlag(FLAGS_max_time_regression_percent);
+  const double max_rss_percent =
+      absl::GetFlag(FLAGS_max_rss_regression_percent);
+  std::vector<std::string> regressions;
+  for (const SchedulingBenchmarkProto& result : results.results()) {
+    auto it = baseline_results.find({result.name(), result.strategy()});
+    if (it == baseline_results.end() || !it->second->error().empty()) {
+      continue;
+    }
+    const SchedulingBenchmarkProto& base = *it->second;
+    if (!result.error().empty()) {
+      regressions.push_back(
+          absl::StrFormat("%s failed: %s", Describe(result), result.error()));
+      continue;
+    }
+    if (result.pipeline_length() > base.pipeline_length()) {
+      regressions.push_back(absl::StrFormat(
+          "%s pipeline length increased from %d to %d", Describe(result),
+          base.pipeline_length(), result.pipeline_length()));
+    }
+    if (result.pipeline_registers() > base.pipeline_registers()) {
+      regressions.push_back(absl::StrFormat(
+          "%s pipeline registers increased from %d to %d", Describe(result),
+          base.pipeline_registers(), result.pipeline_registers()));
+    }
+    if (Exceeds(result.schedule_time_us(), base.schedule_time_us(),
+                max_time_percent)) {
+      regressions.push_back(absl::StrFormat(
+          "%s scheduling time increased from %dus to %dus", Describe(result),
+          base.schedule_time_us(), result.schedule_time_us()));
+    }
+    if (Exceeds(result.peak_rss_bytes(), base.peak_rss_bytes(),
+                max_rss_percent)) {
+      regressions.push_back(absl::StrFormat(
+          "%s peak memory increased from %d to %d bytes", Describe(result),
+          base.peak_rss_bytes(), result.peak_rss_bytes()));
+    }
+  }
+  if (!regressions.empty()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Scheduling regressions:\n  ", absl::StrJoin(regressions, "\n  ")));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths) {
+  XLS_ASSIGN_OR_RETURN(SchedulingOptionsFlagsProto scheduling_options_flags,
+                       GetSchedulingOptionsFlagsProto());
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       SetUpDelayEstimator(scheduling_options_flags));
+  std::vector<std::pair<std::string, SchedulingStrategy>> strategies;
+  for (const std::string& name : absl::GetFlag(FLAGS_strategies)) {
+    XLS_ASSIGN_OR_RETURN(SchedulingStrategy strategy, ParseStrategy(name));
+    strategies.push_back({name, strategy});
+  }
+
+  SchedulingBenchmarkResultsProto results;
+  for (std::string_view ir_path : ir_paths) {
+    XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_contents, ir_path));
+    std::optional<FunctionBase*> top = package->GetTop();
+    if (!top.has_value()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Package in %s has no top defined.", ir_path));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        SchedulingOptions options,
+        SetUpSchedulingOptions(scheduling_options_flags, package.get()));
+    for (const auto& [name, strategy] : strategies) {
+      SchedulingBenchmarkProto* result = results.add_results();
+      *result = RunBenchmark(*top, *delay_estimator, options, name, strategy);
+      result->set_name(std::filesystem::path(ir_path).filename().string());
+      result->set_ir_path(ir_path);
+      if (result->error().empty()) {
+        LOG(INFO) << absl::StreamFormat(
+            "%s: %d stages, %d registers, %dus, %d bytes peak RSS",
+            Describe(*result), result->pipeline_length(),
+            result->pipeline_registers(), result->schedule_time_us(),
+            result->peak_rss_bytes());
+      } else {
+        LOG(INFO) << Describe(*result) << ": " << result->error();
+      }
+    }
+  }
+
+  if (absl::GetFlag(FLAGS_output_textproto).empty()) {
+    std::string text;
+    google::protobuf::TextFormat::PrintToString(results, &text);
+    std::cout << text;
+  } else {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(absl::GetFlag(FLAGS_output_textproto), results));
+  }
+
+  if (!absl::GetFlag(FLAGS_baseline_textproto).empty()) {
+    XLS_ASSIGN_OR_RETURN(SchedulingBenchmarkResultsProto baseline,
+                         ParseTextProtoFile<SchedulingBenchmarkResultsProto>(
+                             absl::GetFlag(FLAGS_baseline_textproto)));
+    XLS_RETURN_IF_ERROR(CheckForRegressions(results, baseline));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation:\n  %s IR_FILE...",
+                                      argv[0]);
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
@@ -0,0 +1,91 @@
+#
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.dev_tools.benchmark_scheduling_main."""
+
+import subprocess
+
+from absl.testing import absltest
+from xls.common import runfiles
+from xls.common import test_base
+
+BENCHMARK_SCHEDULING_MAIN_PATH = runfiles.get_path(
+    'xls/dev_tools/benchmark_scheduling_main'
+)
+
+OPT_IR = """package add
+
+top fn my_function(a: bits[32], b: bits[32]) -> bits[32] {
+  sum: bits[32] = add(a, b)
+  not_sum: bits[32] = not(sum)
+  ret not_not_sum: bits[32] = not(not_sum)
+}
+"""
+
+
+class BenchmarkSchedulingMainTest(test_base.TestCase):
+
+  def test_all_strategies(self):
+    ir_file = self.create_tempfile(content=OPT_IR)
+    output = subprocess.check_output([
+        BENCHMARK_SCHEDULING_MAIN_PATH,
+        '--delay_model=unit',
+        '--clock_period_ps=1',
+        ir_file.full_path,
+    ]).decode('utf-8')
+
+    for strategy in ('sdc', 'min_cut', 'asap'):
+      self.assertIn(f'strategy: "{strategy}"', output)
+    self.assertEqual(output.count('pipeline_length: 3'), 3)
+    self.assertIn('top: "my_function"', output)
+    self.assertIn('schedule_time_us:', output)
+    self.assertIn('peak_rss_bytes:', output)
+    # The LP is only measured for SDC.
+    self.assertEqual(output.count('lp_variables:'), 1)
+    self.assertNotIn('error:', output)
+
+  def test_regression_against_baseline(self):
+    ir_file = self.create_tempfile(content=OPT_IR)
+    output_file = self.create_tempfile()
+    baseline_file = self.create_tempfile(content=f"""
+results {{
+  name: "{ir_file.full_path.split('/')[-1]}"
+  strategy: "sdc"
+  pipeline_length: 2
+}}
+""")
+    result = subprocess.run(
+        [
+            BENCHMARK_SCHEDULING_MAIN_PATH,
+            '--delay_model=unit',
+            '--clock_period_ps=1',
+            '--strategies=sdc',
+            f'--output_textproto={output_file.full_path}',
+            f'--baseline_textproto={baseline_file.full_path}',
+            ir_file.full_path,
+        ],
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+
+    self.assertNotEqual(result.returncode, 0)
+    self.assertIn(
+        'pipeline length increased from 2 to 3', result.stderr.decode('utf-8')
+    )
+    self.assertIn('pipeline_length: 3', output_file.read_text())
+
+
+if __name__ == '__main__':
+  absltest.main()
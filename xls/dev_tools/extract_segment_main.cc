@@ -25,14 +25,13 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/extract_segment.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
-#include "xls/public/ir_parser.h"
+#include "xls/ir/streaming_ir_parser.h"
 
 const char kUsage[] = R"(
 Extract a segment of a graph either emerging from or draining to a set of nodes.
@@ -67,16 +66,12 @@ namespace xls {
 namespace {
 
 absl::Status RealMain(std::string_view ir_file) {
-  XLS_ASSIGN_OR_RETURN(auto ir_text, GetFileContents(ir_file));
-  XLS_ASSIGN_OR_RETURN(auto package, ParsePackage(ir_text, ir_file));
-  FunctionBase* fb;
-  if (absl::GetFlag(FLAGS_top)) {
-    XLS_ASSIGN_OR_RETURN(
-        fb, package->GetFunctionBaseByName(*absl::GetFlag(FLAGS_top)));
-  } else {
-    XLS_RET_CHECK(package->GetTop());
-    fb = *package->GetTop();
-  }
+  // Only the entity of interest and its dependencies are parsed so that
+  // extracting from very large IR dumps is quick.
+  std::optional<std::string> top = absl::GetFlag(FLAGS_top);
+  XLS_ASSIGN_OR_RETURN(auto package, ReadPackageFileForEntity(ir_file, top));
+  XLS_RET_CHECK(package->GetTop());
+  FunctionBase* fb = *package->GetTop();
   auto get_node = [&](std::string_view s) -> absl::StatusOr<Node*> {
     int64_t id;
     if (absl::SimpleAtoi(s, &id)) {
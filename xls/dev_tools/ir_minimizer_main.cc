@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
@@ -51,6 +52,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/dev_tools/extract_segment.h"
@@ -209,6 +211,12 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
           "Number of simplifications to do in-between tests. Increasing this "
           "value may speed minimization for large designs, especially when "
           "--test_executable is long-running.");
+ABSL_FLAG(int64_t, candidates_per_round, 1,
+          "Number of independent simplifications of the last known failing IR "
+          "to generate and test concurrently in each round; the smallest "
+          "candidate which still fails is accepted. With the default of 1, "
+          "simplifications are tested one after another as configured by "
+          "--simplifications_between_tests.");
 ABSL_FLAG(int64_t, failed_attempts_between_tests_limit, 16,
           "Failed simplification attempts between tests before we conclude we "
           "need to check our changes so far.");
@@ -1217,10 +1225,204 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Picks the function base of `package` to simplify: the top if
+// --simplify_top_only is given, otherwise a random non-empty function base
+// weighted by node count. Returns nullptr if there is nothing left to simplify.
+FunctionBase* PickFunctionToSimplify(Package* package, absl::BitGenRef rng) {
+  if (absl::GetFlag(FLAGS_simplify_top_only)) {
+    return package->GetTop().value();
+  }
+  std::vector<FunctionBase*> bases = package->GetFunctionBases();
+  std::vector<int64_t> node_counts;
+  node_counts.reserve(bases.size());
+  for (auto it = bases.begin(); it != bases.end();) {
+    FunctionBase* f = *it;
+    int64_t node_count = f->node_count();
+    if (node_count == 0) {
+      // This is an empty function.
+      it = bases.erase(it);
+      continue;
+    }
+    node_counts.push_back(node_count);
+    it++;
+  }
+  if (bases.empty()) {
+    return nullptr;
+  }
+  absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
+                                                   node_counts.cend());
+  return bases[distribution(rng)];
+}
+
+// An independent candidate simplification of the last known failing IR.
+struct BatchCandidate {
+  std::string which_transform;
+  std::string ir_text;
+  int64_t node_count;
+  bool still_fails = false;
+};
+
+// Tests each of `candidates` which is not already in `test_cache`,
+// concurrently on up to `thread_count` threads, and records the results in
+// `still_fails` and `test_cache`.
+absl::Status TestCandidates(
+    absl::Span<BatchCandidate> candidates,
+    const std::optional<std::vector<Value>>& inputs, int64_t thread_count,
+    absl::flat_hash_map<std::string, bool>& test_cache) {
+  std::vector<BatchCandidate*> untested;
+  for (BatchCandidate& candidate : candidates) {
+    auto it = test_cache.find(candidate.ir_text);
+    if (it != test_cache.end()) {
+      LOG(INFO) << absl::StreamFormat("Found result in cache (failed = %d)",
+                                      it->second);
+      candidate.still_fails = it->second;
+    } else {
+      untested.push_back(&candidate);
+    }
+  }
+
+  std::vector<absl::StatusOr<bool>> results(untested.size(), false);
+  std::atomic<int64_t> next = 0;
+  auto worker = [&] {
+    for (int64_t i = next++; i < untested.size(); i = next++) {
+      results[i] = StillFailsHelper(untested[i]->ir_text, inputs);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min<int64_t>(thread_count, untested.size());
+       ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (int64_t i = 0; i < untested.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(untested[i]->still_fails, results[i]);
+    test_cache[untested[i]->ir_text] = untested[i]->still_fails;
+  }
+  return absl::OkStatus();
+}
+
+// Minimizes `knownf_ir_text` in rounds: each round generates up to
+// `candidates_per_round` independent simplifications of the last known failing
+// IR, tests them concurrently, and greedily accepts the smallest candidate
+// which still fails. Returns the minimized IR.
+absl::StatusOr<std::string> MinimizeWithCandidateRounds(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    int64_t failed_attempt_limit, int64_t total_attempt_limit,
+    int64_t candidates_per_round, absl::BitGenRef rng,
+    absl::flat_hash_map<std::string, bool>& test_cache) {
+  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
+  const int64_t thread_count =
+      std::min<int64_t>(candidates_per_round, std::max(AvailableCPUs(), 1));
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  bool done = false;
+  while (!done) {
+    LOG(INFO) << "Total attempts " << total_attempts << "/"
+              << total_attempt_limit;
+    LOG(INFO) << "Failed attempt count " << failed_simplification_attempts
+              << "/" << failed_attempt_limit;
+
+    std::vector<BatchCandidate> candidates;
+    absl::flat_hash_set<std::string> candidate_ir_texts;
+    while (candidates.size() < candidates_per_round) {
+      if (failed_simplification_attempts >= failed_attempt_limit) {
+        LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                  << failed_simplification_attempts;
+        done = true;
+        break;
+      }
+      total_attempts++;
+      if (total_attempts >= total_attempt_limit) {
+        LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+        done = true;
+        break;
+      }
+
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      FunctionBase* f = PickFunctionToSimplify(package.get(), rng);
+      if (f == nullptr) {
+        LOG(INFO) << "Nothing left to simplify";
+        done = true;
+        break;
+      }
+      std::string which_transform;
+      XLS_ASSIGN_OR_RETURN(SimplifiedIr simplification,
+                           Simplify(f, inputs, rng, &which_transform));
+      if (simplification.result == SimplificationResult::kCannotChange) {
+        LOG(INFO) << "Cannot simplify any further, done!";
+        done = true;
+        break;
+      }
+      if (simplification.result == SimplificationResult::kDidNotChange) {
+        VLOG(1) << "Did not change the sample.";
+        failed_simplification_attempts++;
+        continue;
+      }
+      if (simplification.in_place()) {
+        XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+      }
+      std::string ir_text = simplification.ir();
+      if (!candidate_ir_texts.insert(ir_text).second) {
+        // Another candidate of this round made the same simplification.
+        failed_simplification_attempts++;
+        continue;
+      }
+      int64_t node_count;
+      if (simplification.in_place()) {
+        node_count = package->GetNodeCount();
+      } else {
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> new_package,
+                             ParsePackage(ir_text));
+        node_count = new_package->GetNodeCount();
+      }
+      LOG(INFO) << "Candidate " << candidates.size() << ": " << which_transform
+                << " (" << node_count << " nodes)";
+      candidates.push_back({.which_transform = which_transform,
+                            .ir_text = std::move(ir_text),
+                            .node_count = node_count});
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+
+    XLS_RETURN_IF_ERROR(TestCandidates(absl::MakeSpan(candidates), inputs,
+                                       thread_count, test_cache));
+    const BatchCandidate* best = nullptr;
+    for (const BatchCandidate& candidate : candidates) {
+      if (candidate.still_fails &&
+          (best == nullptr || candidate.node_count < best->node_count ||
+           (candidate.node_count == best->node_count &&
+            candidate.ir_text.size() < best->ir_text.size()))) {
+        best = &candidate;
+      }
+    }
+    if (best == nullptr) {
+      failed_simplification_attempts += candidates.size();
+      LOG(INFO) << "No candidate still fails; failed simplification attempts "
+                   "now: "
+                << failed_simplification_attempts;
+      continue;
+    }
+
+    knownf_ir_text = best->ir_text;
+    std::cerr << "---\ntransform: " << best->which_transform << "\n"
+              << (best->node_count > 50 ? "" : best->ir_text) << "("
+              << best->node_count << " nodes)\n";
+    failed_simplification_attempts = 0;
+  }
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests,
-                      const int64_t failed_attempts_between_tests_limit) {
+                      const int64_t failed_attempts_between_tests_limit,
+                      const int64_t candidates_per_round) {
   XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
   // Cache of test results to avoid duplicate invocations of the
   // test_executable.
@@ -1271,6 +1473,18 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
+  if (candidates_per_round > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeWithCandidateRounds(knownf_ir_text, inputs,
+                                    failed_attempt_limit, total_attempt_limit,
+                                    candidates_per_round, rng, test_cache));
+    std::cout << knownf_ir_text;
+    return VerifyStillFails(knownf_ir_text, inputs,
+                            "Minimized function does not fail!",
+                            /*test_cache=*/nullptr);
+  }
+
   int64_t failed_simplification_attempts = 0;
   int64_t total_attempts = 0;
   int64_t simplification_iterations = 0;
@@ -1307,31 +1521,10 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
 
     VLOG(1) << "=== Simplification attempt " << total_attempts;
 
-    FunctionBase* candidate;
-    if (absl::GetFlag(FLAGS_simplify_top_only)) {
-      candidate = package->GetTop().value();
-    } else {
-      std::vector<FunctionBase*> bases = package->GetFunctionBases();
-      std::vector<int64_t> node_counts;
-      node_counts.reserve(bases.size());
-      for (auto it = bases.begin(); it != bases.end();) {
-        FunctionBase* f = *it;
-        int64_t node_count = f->node_count();
-        if (node_count == 0) {
-          // This is an empty function.
-          it = bases.erase(it);
-          continue;
-        }
-        node_counts.push_back(node_count);
-        it++;
-      }
-      if (bases.empty()) {
-        LOG(INFO) << "Nothing left to simplify";
-        break;
-      }
-      absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
-                                                       node_counts.cend());
-      candidate = bases[distribution(rng)];
+    FunctionBase* candidate = PickFunctionToSimplify(package.get(), rng);
+    if (candidate == nullptr) {
+      LOG(INFO) << "Nothing left to simplify";
+      break;
     }
     std::string candidate_name = candidate->name();
     XLS_VLOG_LINES(2,
@@ -1499,6 +1692,13 @@ int main(int argc, char** argv) {
       << "Must specify exactly one of --test_executable, --test_llvm_jit, or "
          "--test_optimizer";
 
+  QCHECK(absl::GetFlag(FLAGS_candidates_per_round) >= 1)
+      << "--candidates_per_round must be positive";
+  QCHECK(absl::GetFlag(FLAGS_candidates_per_round) == 1 ||
+         absl::GetFlag(FLAGS_simplifications_between_tests) == 1)
+      << "--candidates_per_round cannot be combined with "
+         "--simplifications_between_tests";
+
   if (absl::GetFlag(FLAGS_can_extract_segments)) {
     std::vector<std::string> failures;
     bool failed = false;
@@ -1528,5 +1728,6 @@ int main(int argc, char** argv) {
       positional_arguments[0], absl::GetFlag(FLAGS_failed_attempt_limit),
       absl::GetFlag(FLAGS_total_attempt_limit),
       absl::GetFlag(FLAGS_simplifications_between_tests),
-      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit)));
+      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit),
+      absl::GetFlag(FLAGS_candidates_per_round)));
 }
@@ -669,6 +669,27 @@ top proc foo<input: bits[32] in kind=streaming, output:bits[32] out kind=streami
           ir_file.full_path,
       ])
 
+  def test_minimize_add_with_concurrent_candidates(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(
+        test_sh_file.full_path, ['/usr/bin/env grep myadd $1']
+    )
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--can_remove_params=false',
+            '--candidates_per_round=4',
+            ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    self._maybe_record_property('output', minimized_ir)
+    self.assertEqual(function_count(minimized_ir), 1)
+    self.assertEqual(node_count(minimized_ir), 1)
+    self.assertIn('ret myadd', minimized_ir)
+
   def test_minimize_jit_mismatch(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     minimized_ir = subprocess.check_output(
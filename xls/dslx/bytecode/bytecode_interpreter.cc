@@ -26,6 +26,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/die_if_null.h"
 #include "absl/log/log.h"
@@ -256,8 +257,7 @@ absl::StatusOr<std::vector<InterpValue>>
 BytecodeInterpreter::PopArgsRightToLeft(size_t count) {
   std::vector<InterpValue> args(count, InterpValue::MakeToken());
   for (int i = 0; i < count; i++) {
-    XLS_ASSIGN_OR_RETURN(InterpValue arg, Pop());
-    args[count - i - 1] = arg;
+    XLS_ASSIGN_OR_RETURN(args[count - i - 1], Pop());
   }
   return args;
 }
@@ -493,8 +493,9 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
 }
 
 absl::Status BytecodeInterpreter::EvalBinop(
-    const std::function<absl::StatusOr<InterpValue>(
-        const InterpValue& lhs, const InterpValue& rhs)>& op) {
+    absl::FunctionRef<absl::StatusOr<InterpValue>(const InterpValue& lhs,
+                                                  const InterpValue& rhs)>
+        op) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
@@ -539,7 +540,9 @@ absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
   const Frame& frame = frames_.back();
   const TypeInfo* caller_type_info = frame.type_info();
 
-  BytecodeCacheInterface* cache = import_data_->bytecode_cache();
+  BytecodeCacheInterface* cache = options_.bytecode_cache() != nullptr
+                                      ? options_.bytecode_cache()
+                                      : import_data_->bytecode_cache();
   XLS_RET_CHECK(cache != nullptr);
 
   std::optional<ParametricEnv> callee_bindings;
@@ -645,7 +648,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
     XLS_RET_CHECK_EQ(converted.GetBitCount().value(),
                      to_bits_like->size.GetAsInt64().value());
 
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -660,7 +663,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -681,7 +684,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -697,7 +700,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
     }
     XLS_ASSIGN_OR_RETURN(InterpValue casted,
                          CastBitsToArray(from_value, *to_array));
-    stack_.Push(casted);
+    stack_.Push(std::move(casted));
     return absl::OkStatus();
   }
 
@@ -706,7 +709,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
       to_enum != nullptr) {
     XLS_ASSIGN_OR_RETURN(InterpValue converted,
                          CastBitsToEnum(from_value, *to_enum));
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -730,12 +733,13 @@ absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
   elements.reserve(array_size.value());
   for (int64_t i = 0; i < array_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
-  XLS_ASSIGN_OR_RETURN(InterpValue array, InterpValue::MakeArray(elements));
-  stack_.Push(array);
+  XLS_ASSIGN_OR_RETURN(InterpValue array,
+                       InterpValue::MakeArray(std::move(elements)));
+  stack_.Push(std::move(array));
   return absl::OkStatus();
 }
 
@@ -748,12 +752,12 @@ absl::Status BytecodeInterpreter::EvalCreateTuple(const Bytecode& bytecode) {
   elements.reserve(tuple_size.value());
   for (int64_t i = 0; i < tuple_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
 
-  stack_.Push(InterpValue::MakeTuple(elements));
+  stack_.Push(InterpValue::MakeTuple(std::move(elements)));
   return absl::OkStatus();
 }
 
@@ -822,7 +826,7 @@ absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
   for (int64_t i = tuple_size - 1; i >= 0; i--) {
     XLS_ASSIGN_OR_RETURN(InterpValue element,
                          tuple.Index(InterpValue::MakeUBits(64, i)));
-    stack_.Push(element);
+    stack_.Push(std::move(element));
   }
 
   return absl::OkStatus();
@@ -862,7 +866,7 @@ absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(
       InterpValue result, basis.Index(index),
       _ << " while processing " << bytecode.ToString(file_table()));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -880,14 +884,14 @@ absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(
       InterpValue result, basis.Index(index),
       _ << " while processing " << bytecode.ToString(file_table()));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.BitwiseNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -933,7 +937,7 @@ absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseAnd(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -954,7 +958,7 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseOr(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1082,7 +1086,7 @@ absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.ArithmeticNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1143,12 +1147,13 @@ absl::Status BytecodeInterpreter::EvalRecv(const Bytecode& bytecode) {
   if (condition.IsTrue()) {
     if (channel->empty()) {
       // Restore the stack!
-      stack_.Push(channel_value);
-      stack_.Push(condition);
-      stack_.Push(default_value);
+      stack_.Push(std::move(channel_value));
+      stack_.Push(std::move(condition));
+      stack_.Push(std::move(default_value));
       blocked_channel_info_ = BlockedChannelInfo{
           .name = std::string(channel_data->channel_name()),
           .span = bytecode.source_span(),
+          .channel = channel,
       };
       return absl::UnavailableError("Channel is empty.");
     }
@@ -1196,9 +1201,9 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
                           FormatChannelNameForTracing(*channel_data),
                           formatted_data));
     }
-    channel->push_back(payload);
+    channel->push_back(std::move(payload));
   }
-  stack_.Push(token);
+  stack_.Push(std::move(token));
   return absl::OkStatus();
 }
 
@@ -1267,7 +1272,7 @@ absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
   start = InterpValue::MakeBits(/*is_signed=*/false, start.GetBitsOrDie());
   length = InterpValue::MakeBits(/*is_signed=*/false, length.GetBitsOrDie());
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Slice(start, length));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1279,7 +1284,7 @@ absl::Status BytecodeInterpreter::EvalStore(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-  frames_.back().StoreSlot(slot, value);
+  frames_.back().StoreSlot(slot, std::move(value));
   return absl::OkStatus();
 }
 
@@ -1322,8 +1327,8 @@ absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue tos0, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue tos1, Pop());
-  stack_.Push(tos0);
-  stack_.Push(tos1);
+  stack_.Push(std::move(tos0));
+  stack_.Push(std::move(tos1));
   return absl::OkStatus();
 }
 
@@ -1421,7 +1426,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
       bits_type->is_signed() ? InterpValueTag::kSBits : InterpValueTag::kUBits;
   XLS_ASSIGN_OR_RETURN(InterpValue result,
                        InterpValue::MakeBits(tag, result_bits));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -62,6 +63,9 @@ inline void InfoLoggingTraceHook(const FileTable& file_table,
 struct BlockedChannelInfo {
   std::string name;
   Span span;
+  // The channel itself: the blocked proc cannot make progress until a value
+  // is sent on it, so schedulers need not run the proc again until then.
+  std::shared_ptr<InterpValue::Channel> channel;
 };
 
 // Bytecode interpreter for DSLX. Accepts sequence of "bytecode" "instructions"
@@ -188,8 +192,9 @@ class BytecodeInterpreter {
   absl::Status EvalXor(const Bytecode& bytecode);
 
   absl::Status EvalBinop(
-      const std::function<absl::StatusOr<InterpValue>(
-          const InterpValue& lhs, const InterpValue& rhs)>& op);
+      absl::FunctionRef<absl::StatusOr<InterpValue>(const InterpValue& lhs,
+                                                    const InterpValue& rhs)>
+          op);
 
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function& function, const Invocation* invocation,
@@ -0,0 +1,131 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the bytecode interpreter on the kinds of programs exercised by
+// bytecode_interpreter_test: a function with a counted loop, and a test proc
+// network that ticks until it has seen a given number of messages.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter_options.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/proc_id.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type_info.h"
+
+namespace xls::dslx {
+namespace {
+
+static void BM_FunctionLoop(benchmark::State& state) {
+  std::string program = absl::StrFormat(R"(
+fn main(x: u32) -> u32 {
+  for (i, acc): (u32, u32) in u32:0..u32:%d {
+    (acc + i * x) ^ (acc >> u32:3)
+  }(u32:0)
+})",
+                                        state.range(0));
+  ImportData import_data = CreateImportDataForTest();
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "test.x", "test", &import_data).value();
+  Function* f = tm.module->GetMemberOrError<Function>("main").value();
+  std::unique_ptr<BytecodeFunction> bf =
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, ParametricEnv())
+          .value();
+  std::vector<InterpValue> args = {InterpValue::MakeU32(7)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), args).value());
+  }
+}
+
+static void BM_ProcTicks(benchmark::State& state) {
+  std::string program = absl::StrFormat(R"(
+proc Counter {
+  data_out: chan<u32> out;
+
+  init { u32:0 }
+
+  config(data_out: chan<u32> out) { (data_out,) }
+
+  next(count: u32) {
+    let tok = send(join(), data_out, count);
+    count + u32:1
+  }
+}
+
+#[test_proc]
+proc CounterTest {
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { u32:0 }
+
+  config(terminator: chan<bool> out) {
+    let (data_out, data_in) = chan<u32>("data");
+    spawn Counter(data_out);
+    (data_in, terminator)
+  }
+
+  next(expected: u32) {
+    let (tok, count) = recv(join(), data_in);
+    assert_eq(count, expected);
+    let tok = send_if(tok, terminator, count == u32:%d, true);
+    expected + u32:1
+  }
+})",
+                                        state.range(0));
+  ImportData import_data = CreateImportDataForTest();
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "test.x", "test", &import_data).value();
+  TestProc* test_proc = tm.module->GetTestProc("CounterTest").value();
+  TypeInfo* ti =
+      tm.type_info->GetTopLevelProcTypeInfo(test_proc->proc()).value();
+  for (auto _ : state) {
+    InterpValue terminator =
+        ti->GetConstExpr(test_proc->proc()->config().params()[0]).value();
+    std::vector<ProcInstance> proc_instances;
+    ProcIdFactory proc_id_factory;
+    CHECK_OK(ProcConfigBytecodeInterpreter::InitializeProcNetwork(
+        &import_data, &proc_id_factory, ti, test_proc->proc(), terminator,
+        &proc_instances, BytecodeInterpreterOptions()));
+    std::shared_ptr<InterpValue::Channel> term_chan =
+        terminator.GetChannelOrDie();
+    while (term_chan->empty()) {
+      for (ProcInstance& p : proc_instances) {
+        CHECK_OK(p.Run().status());
+      }
+    }
+    // The terminator channel is shared between iterations.
+    term_chan->clear();
+  }
+}
+
+BENCHMARK(BM_FunctionLoop)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_ProcTicks)->Arg(1024)->Arg(16384);
+
+}  // namespace
+}  // namespace xls::dslx
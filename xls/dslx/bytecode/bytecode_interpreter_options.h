@@ -23,6 +23,7 @@
 
 #include "absl/status/status.h"
 #include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/interp_value.h"
@@ -97,6 +98,16 @@ class BytecodeInterpreterOptions {
   }
   FormatPreference format_preference() const { return format_preference_; }
 
+  // The cache from which bytecode functions are retrieved when they are
+  // invoked. If null, the cache owned by the ImportData is used. Interpreters
+  // running concurrently on the same ImportData must each be given their own
+  // cache.
+  BytecodeInterpreterOptions& bytecode_cache(BytecodeCacheInterface* value) {
+    bytecode_cache_ = value;
+    return *this;
+  }
+  BytecodeCacheInterface* bytecode_cache() const { return bytecode_cache_; }
+
  private:
   PostFnEvalHook post_fn_eval_hook_ = nullptr;
   TraceHook trace_hook_ = nullptr;
@@ -105,6 +116,7 @@ class BytecodeInterpreterOptions {
   std::optional<int64_t> max_ticks_;
   bool validate_final_stack_depth_ = true;
   FormatPreference format_preference_ = FormatPreference::kDefault;
+  BytecodeCacheInterface* bytecode_cache_ = nullptr;
 };
 
 }  // namespace xls::dslx
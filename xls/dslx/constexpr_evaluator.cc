@@ -674,10 +674,30 @@ absl::Status ConstexprEvaluator::HandleXlsTuple(const XlsTuple* expr) {
 
 absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
   absl::flat_hash_map<std::string, InterpValue> env;
+  // Note: the environment is made even when the result is cached, as doing so
+  // also notes the constexpr values of free variables in `type_info_`.
   XLS_ASSIGN_OR_RETURN(
       env, MakeConstexprEnv(import_data_, type_info_, warning_collector_, expr,
                             bindings_));
 
+  auto note_result = [&](const CachedConstexpr& result) {
+    if (warning_collector_ != nullptr) {
+      for (const Span& s : result.rollovers) {
+        warning_collector_->Add(
+            s, WarningKind::kConstexprEvalRollover,
+            "constexpr evaluation detected rollover in operation");
+      }
+    }
+    type_info_->NoteConstExpr(expr, result.value);
+  };
+
+  TypeInfoOwner& owner = import_data_->type_info_owner();
+  if (const CachedConstexpr* cached = owner.GetCachedConstexpr(expr, bindings_);
+      cached != nullptr) {
+    note_result(*cached);
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
                        BytecodeEmitter::EmitExpression(import_data_, type_info_,
                                                        expr, env, bindings_));
@@ -688,14 +708,10 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
   XLS_ASSIGN_OR_RETURN(InterpValue constexpr_value,
                        BytecodeInterpreter::Interpret(import_data_, bf.get(),
                                                       /*args=*/{}));
-  if (warning_collector_ != nullptr) {
-    for (const Span& s : rollovers) {
-      warning_collector_->Add(
-          s, WarningKind::kConstexprEvalRollover,
-          "constexpr evaluation detected rollover in operation");
-    }
-  }
-  type_info_->NoteConstExpr(expr, constexpr_value);
+  CachedConstexpr result{.value = std::move(constexpr_value),
+                         .rollovers = std::move(rollovers)};
+  note_result(result);
+  owner.NoteCachedConstexpr(expr, bindings_, std::move(result));
 
   return absl::OkStatus();
 }
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/dslx/constexpr_evaluator.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -619,5 +620,39 @@ fn main() -> MyArray {
   EXPECT_THAT(value.GetLength(), IsOkAndHolds(4));
 }
 
+TEST(ConstexprEvaluatorTest, InterpretedValuesAreCached) {
+  constexpr std::string_view kModule = R"(
+const TABLE = u32[4]:[u32:10, u32:20, u32:30, u32:40];
+
+fn Foo() -> u32 {
+  TABLE[u32:2]
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(TestData test_data, CreateTestData(kModule));
+  Module* module = test_data.module.get();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           module->GetMemberOrError<Function>("Foo"));
+  Expr* index = GetSingleBodyExpr(f);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue value,
+      ConstexprEvaluator::EvaluateToValue(
+          test_data.import_data.get(), test_data.type_info,
+          /*warning_collector=*/nullptr, ParametricEnv(), index));
+  EXPECT_THAT(value.GetBitValueViaSign(), IsOkAndHolds(30));
+
+  // Interpreting the index expression noted its value for reuse under the same
+  // parametric environment.
+  TypeInfoOwner& owner = test_data.import_data->type_info_owner();
+  int64_t hits = owner.constexpr_cache_stats().hits;
+  const CachedConstexpr* cached =
+      owner.GetCachedConstexpr(index, ParametricEnv());
+  ASSERT_NE(cached, nullptr);
+  EXPECT_THAT(cached->value.GetBitValueViaSign(), IsOkAndHolds(30));
+  EXPECT_TRUE(cached->rollovers.empty());
+  EXPECT_EQ(owner.constexpr_cache_stats().hits, hits + 1);
+  EXPECT_GE(owner.constexpr_cache_stats().misses, 1);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -225,6 +225,25 @@ class BitVectorCppEmitter : public CppEmitter {
                         ValueAsDslxString(identifier), ";");
   }
 
+  std::string NativeLeafCount() const override { return "1"; }
+
+  std::string AssignToNativeLayout(std::string_view rhs,
+                                   int64_t nesting) const override {
+    return absl::StrFormat(
+        "__WriteNativeBits(elements[leaf++], %d, static_cast<uint64_t>(%s), "
+        "buffer);",
+        dslx_bit_count(), rhs);
+  }
+
+  std::string AssignFromNativeLayout(std::string_view lhs,
+                                     int64_t nesting) const override {
+    std::string bits = "__ReadNativeBits(elements[leaf++], buffer)";
+    if (is_signed()) {
+      bits = absl::StrFormat("__SignExtend(%s, %d)", bits, dslx_bit_count());
+    }
+    return absl::StrFormat("%s = static_cast<%s>(%s);", lhs, cpp_type(), bits);
+  }
+
   std::optional<int64_t> GetBitCountIfBitVector() const override {
     return dslx_bit_count_;
   }
@@ -333,6 +352,39 @@ class TypeRefCppEmitter : public CppEmitter {
                               indent_amount));
   }
 
+  std::string NativeLeafCount() const override {
+    return TypeHasMethods()
+               ? absl::StrFormat("%s::kNativeLeafCount", cpp_type())
+               : absl::StrFormat("k%sNativeLeafCount", cpp_type());
+  }
+
+  std::string AssignToNativeLayout(std::string_view rhs,
+                                   int64_t nesting) const override {
+    std::string elements =
+        absl::StrFormat("elements.subspan(leaf, %s)", NativeLeafCount());
+    return absl::StrFormat(
+        "%s;\nleaf += %s;",
+        TypeHasMethods()
+            ? absl::StrFormat("%s.ToNativeLayout(%s, buffer)", rhs, elements)
+            : absl::StrFormat("%sToNativeLayout(%s, %s, buffer)", cpp_type(),
+                              rhs, elements),
+        NativeLeafCount());
+  }
+
+  std::string AssignFromNativeLayout(std::string_view lhs,
+                                     int64_t nesting) const override {
+    std::string elements =
+        absl::StrFormat("elements.subspan(leaf, %s)", NativeLeafCount());
+    return absl::StrFormat(
+        "%s = %s;\nleaf += %s;", lhs,
+        TypeHasMethods()
+            ? absl::StrFormat("%s::FromNativeLayout(%s, buffer)", cpp_type(),
+                              elements)
+            : absl::StrFormat("%sFromNativeLayout(%s, buffer)", cpp_type(),
+                              elements),
+        NativeLeafCount());
+  }
+
   bool TypeHasMethods() const {
     return std::holds_alternative<StructDef*>(
         typeref_type_annotation_->type_ref()->type_definition());
@@ -467,6 +519,39 @@ class ArrayCppEmitter : public CppEmitter {
                         });
   }
 
+  std::string NativeLeafCount() const override {
+    return absl::StrFormat("(%d * %s)", array_size(),
+                           element_emitter_->NativeLeafCount());
+  }
+
+  std::string AssignToNativeLayout(std::string_view rhs,
+                                   int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    pieces.push_back(Indent(
+        element_emitter_->AssignToNativeLayout(
+            absl::StrFormat("%s[%s]", rhs, ind_var), nesting + 1),
+        2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromNativeLayout(std::string_view lhs,
+                                     int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    pieces.push_back(Indent(
+        element_emitter_->AssignFromNativeLayout(
+            absl::StrFormat("%s[%s]", lhs, ind_var), nesting + 1),
+        2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
   int64_t array_size() const { return array_size_; }
 
  protected:
@@ -620,6 +705,39 @@ class TupleCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string NativeLeafCount() const override {
+    if (element_emitters_.empty()) {
+      return "0";
+    }
+    return absl::StrFormat(
+        "(%s)", absl::StrJoin(element_emitters_, " + ",
+                              [](std::string* out,
+                                 const std::unique_ptr<CppEmitter>& emitter) {
+                                absl::StrAppend(out,
+                                                emitter->NativeLeafCount());
+                              }));
+  }
+
+  std::string AssignToNativeLayout(std::string_view rhs,
+                                   int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignToNativeLayout(
+          absl::StrFormat("std::get<%d>(%s)", i, rhs), nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromNativeLayout(std::string_view lhs,
+                                     int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignFromNativeLayout(
+          absl::StrFormat("std::get<%d>(%s)", i, lhs), nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
   int64_t size() const { return element_emitters_.size(); }
 
  protected:
@@ -107,6 +107,26 @@ class CppEmitter {
                                    std::string_view identifier,
                                    int64_t nesting) const = 0;
 
+  // Returns a C++ constant expression for the number of leaf elements of the
+  // type, which is the number of element layouts it occupies in the JIT native
+  // layout (see xls/jit/type_layout.h).
+  virtual std::string NativeLeafCount() const = 0;
+
+  // Emits and returns c++ code which writes `rhs` of `cpp_type()` to the JIT
+  // native layout. The emitted code expects the variables `elements` (a span
+  // of ::xls::ElementLayout), `leaf` (an int64_t index into `elements`) and
+  // `buffer` (a uint8_t*) to be in scope. It writes the value's leaves using
+  // the element layouts starting at `elements[leaf]` and advances `leaf` past
+  // them. Values are not verified; bits beyond the DSLX width are dropped.
+  virtual std::string AssignToNativeLayout(std::string_view rhs,
+                                           int64_t nesting) const = 0;
+
+  // Emits and returns c++ code which reads `lhs` of `cpp_type()` from the JIT
+  // native layout in `buffer` (a const uint8_t*), with the same conventions as
+  // AssignToNativeLayout.
+  virtual std::string AssignFromNativeLayout(std::string_view lhs,
+                                             int64_t nesting) const = 0;
+
   // If the underlying DSLX type is a bit vector then return its bit
   // count. Otherwise return std::nullopt.
   virtual std::optional<int64_t> GetBitCountIfBitVector() const {
@@ -37,7 +37,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces) {
+                                         std::string_view namespaces,
+                                         bool emit_native_layout) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
@@ -49,8 +50,8 @@ absl::StatusOr<CppSource> TranspileToCpp(Module* module,
 #include <vector>
 
 #include "absl/status/statusor.h"
-#include "xls/public/value.h"
-
+$4#include "xls/public/value.h"
+$5
 $2$1$3
 
 #endif  // $0
@@ -94,7 +95,44 @@ static std::string __indent(int64_t amount) {
   return std::string(amount * 2, ' ');
 }
 
-%s%s%s
+%s%s%s%s
+)";
+
+  // Helpers for the generated conversions to and from the JIT native layout,
+  // which is little-endian with each leaf padded out with zeros.
+  constexpr std::string_view kNativeLayoutHelpers =
+      R"(static void __WriteNativeBits(const ::xls::ElementLayout& element,
+                              int64_t bit_count, uint64_t value,
+                              uint8_t* buffer) {
+  if (bit_count < 64) {
+    value &= (uint64_t{1} << bit_count) - 1;
+  }
+  uint8_t* bytes = buffer + element.offset;
+  for (int64_t i = 0; i < element.padded_size; ++i) {
+    bytes[i] = i < element.data_size && i < 8
+                   ? static_cast<uint8_t>(value >> (8 * i))
+                   : 0;
+  }
+}
+
+static uint64_t __ReadNativeBits(const ::xls::ElementLayout& element,
+                                 const uint8_t* buffer) {
+  const uint8_t* bytes = buffer + element.offset;
+  uint64_t value = 0;
+  for (int64_t i = 0; i < element.data_size && i < 8; ++i) {
+    value |= uint64_t{bytes[i]} << (8 * i);
+  }
+  return value;
+}
+
+static int64_t __SignExtend(uint64_t value, int64_t bit_count) {
+  if (bit_count >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  uint64_t sign = uint64_t{1} << (bit_count - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
@@ -105,7 +143,8 @@ static std::string __indent(int64_t amount) {
   // that types defined in imported files can be used.
   for (const TypeDefinition& def : module->GetTypeDefinitions()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
-                         CppTypeGenerator::Create(def, type_info, import_data));
+                         CppTypeGenerator::Create(def, type_info, import_data,
+                                                  emit_native_layout));
     XLS_ASSIGN_OR_RETURN(CppSource result, generator->GetCppSource());
     header.push_back(result.header);
     source.push_back(result.source);
@@ -129,11 +168,15 @@ static std::string __indent(int64_t amount) {
   }
 
   return CppSource{
-      absl::Substitute(kHeaderTemplate, header_guard,
-                       absl::StrJoin(header, "\n\n"), namespace_begin,
-                       namespace_end),
-      absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
-                      absl::StrJoin(source, "\n\n"), namespace_end)};
+      absl::Substitute(
+          kHeaderTemplate, header_guard, absl::StrJoin(header, "\n\n"),
+          namespace_begin, namespace_end,
+          emit_native_layout ? "#include \"absl/types/span.h\"\n" : "",
+          emit_native_layout ? "#include \"xls/jit/type_layout.h\"\n" : ""),
+      absl::StrFormat(kSourceTemplate, output_header_path,
+                      emit_native_layout ? kNativeLayoutHelpers : "",
+                      namespace_begin, absl::StrJoin(source, "\n\n"),
+                      namespace_end)};
 }
 
 }  // namespace xls::dslx
@@ -38,10 +38,16 @@ namespace xls::dslx {
 // should be infrequent, so users should feel comfortable using these
 // interfaces, but should also be aware of the potential for change in the
 // future.
+//
+// If `emit_native_layout` is true, each type also gets conversions to and from
+// the JIT native layout described by an xls::TypeLayout's element layouts, and
+// a constexpr count of its leaf elements. These let C++ callers pack values
+// straight into JIT argument buffers without building an xls::Value.
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces = "");
+                                         std::string_view namespaces = "",
+                                         bool emit_native_layout = false);
 
 }  // namespace xls::dslx
 
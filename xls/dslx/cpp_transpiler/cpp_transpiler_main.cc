@@ -48,6 +48,10 @@ ABSL_FLAG(std::string, dslx_stdlib_path,
           "Path to DSLX standard library");
 ABSL_FLAG(std::string, dslx_path, "",
           "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(bool, native_layout, false,
+          "Also generate conversions of each type to and from the JIT native "
+          "layout, for passing values to the JIT without building an "
+          "xls::Value.");
 
 namespace xls {
 namespace dslx {
@@ -67,7 +71,7 @@ absl::Status RealMain(const std::filesystem::path& module_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       std::string_view output_header_path,
                       std::string_view output_source_path,
-                      std::string_view namespaces) {
+                      std::string_view namespaces, bool native_layout) {
   XLS_ASSIGN_OR_RETURN(std::string module_text, GetFileContents(module_path));
 
   ImportData import_data(
@@ -79,7 +83,7 @@ absl::Status RealMain(const std::filesystem::path& module_path,
   XLS_ASSIGN_OR_RETURN(
       CppSource sources,
       TranspileToCpp(module.module, &import_data, output_header_path,
-                     std::string(namespaces)));
+                     std::string(namespaces), native_layout));
 
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, sources.header));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, sources.source));
@@ -115,7 +119,8 @@ int main(int argc, char* argv[]) {
 
   return xls::ExitStatus(xls::dslx::RealMain(
       args[0], absl::GetFlag(FLAGS_dslx_stdlib_path), dslx_paths,
-      output_header_path, output_source_path, absl::GetFlag(FLAGS_namespaces)));
+      output_header_path, output_source_path, absl::GetFlag(FLAGS_namespaces),
+      absl::GetFlag(FLAGS_native_layout)));
 
   return 0;
 }
@@ -54,6 +54,12 @@ absl::StatusOr<InterpValue> InterpretExpr(
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{});
 }
 
+// Parameters of the functions converting to and from the JIT native layout.
+constexpr std::string_view kToNativeLayoutParams =
+    "absl::Span<const ::xls::ElementLayout> elements, uint8_t* buffer";
+constexpr std::string_view kFromNativeLayoutParams =
+    "absl::Span<const ::xls::ElementLayout> elements, const uint8_t* buffer";
+
 // A type generator for emitting a C++ enum representing a dslx::EnumDef.
 class EnumCppTypeGenerator : public CppTypeGenerator {
  public:
@@ -96,15 +102,25 @@ class EnumCppTypeGenerator : public CppTypeGenerator {
     CppSource from_value = FromValueFunction();
     CppSource verify = VerifyFunction();
 
-    return CppSource{.header = absl::StrJoin(
-                         {enum_decl, num_elements_def, width_def,
-                          to_string.header, to_dslx_string.header,
-                          to_value.header, from_value.header, verify.header},
-                         "\n"),
-                     .source = absl::StrJoin(
-                         {to_string.source, to_dslx_string.source,
-                          to_value.source, from_value.source, verify.source},
-                         "\n\n")};
+    std::vector<std::string> hdr_pieces = {
+        enum_decl,       num_elements_def,  width_def,
+        to_string.header, to_dslx_string.header, to_value.header,
+        from_value.header, verify.header};
+    std::vector<std::string> src_pieces = {
+        to_string.source, to_dslx_string.source, to_value.source,
+        from_value.source, verify.source};
+    if (emit_native_layout()) {
+      CppSource to_native_layout = ToNativeLayoutFunction();
+      CppSource from_native_layout = FromNativeLayoutFunction();
+      hdr_pieces.push_back(absl::StrFormat(
+          "constexpr int64_t k%sNativeLeafCount = 1;", cpp_type()));
+      hdr_pieces.push_back(to_native_layout.header);
+      hdr_pieces.push_back(from_native_layout.header);
+      src_pieces.push_back(to_native_layout.source);
+      src_pieces.push_back(from_native_layout.source);
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
   int64_t dslx_bit_count() const {
@@ -255,6 +271,37 @@ class EnumCppTypeGenerator : public CppTypeGenerator {
         .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
   }
 
+  CppSource ToNativeLayoutFunction() const {
+    std::string signature =
+        absl::StrFormat("void %sToNativeLayout(%s value, %s)", cpp_type(),
+                        cpp_type(), kToNativeLayoutParams);
+    std::vector<std::string> pieces;
+    pieces.push_back("int64_t leaf = 0;");
+    pieces.push_back(emitter_->AssignToNativeLayout(CastToCppBaseType("value"),
+                                                    /*nesting=*/0));
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
+  CppSource FromNativeLayoutFunction() const {
+    std::string signature =
+        absl::StrFormat("%s %sFromNativeLayout(%s)", cpp_type(), cpp_type(),
+                        kFromNativeLayoutParams);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("%s result_base;", emitter_->cpp_type()));
+    pieces.push_back("int64_t leaf = 0;");
+    pieces.push_back(
+        emitter_->AssignFromNativeLayout("result_base", /*nesting=*/0));
+    pieces.push_back(
+        absl::StrFormat("return static_cast<%s>(result_base);", cpp_type()));
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
   std::vector<EnumValue> enum_values_;
   std::unique_ptr<CppEmitter> emitter_;
 };
@@ -301,12 +348,22 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
     hdr_pieces.push_back(to_dslx_string_src.header);
     hdr_pieces.push_back(to_value_src.header);
     hdr_pieces.push_back(from_value_src.header);
-    return CppSource{
-        .header = absl::StrJoin(hdr_pieces, "\n"),
-        .source = absl::StrJoin(
-            {verify_src.source, to_string_src.source, to_dslx_string_src.source,
-             to_value_src.source, from_value_src.source},
-            "\n\n")};
+    std::vector<std::string> src_pieces = {
+        verify_src.source, to_string_src.source, to_dslx_string_src.source,
+        to_value_src.source, from_value_src.source};
+    if (emit_native_layout()) {
+      CppSource to_native_layout_src = ToNativeLayoutFunction();
+      CppSource from_native_layout_src = FromNativeLayoutFunction();
+      hdr_pieces.push_back(
+          absl::StrFormat("constexpr int64_t k%sNativeLeafCount = %s;",
+                          cpp_type(), emitter_->NativeLeafCount()));
+      hdr_pieces.push_back(to_native_layout_src.header);
+      hdr_pieces.push_back(from_native_layout_src.header);
+      src_pieces.push_back(to_native_layout_src.source);
+      src_pieces.push_back(from_native_layout_src.source);
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
  protected:
@@ -406,6 +463,34 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
         .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
   }
 
+  CppSource ToNativeLayoutFunction() const {
+    std::string signature =
+        absl::StrFormat("void %sToNativeLayout(%s, %s)", cpp_type(),
+                        GetValueParameter("value"), kToNativeLayoutParams);
+    std::vector<std::string> pieces;
+    pieces.push_back("[[maybe_unused]] int64_t leaf = 0;");
+    pieces.push_back(emitter_->AssignToNativeLayout("value", /*nesting=*/0));
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
+  CppSource FromNativeLayoutFunction() const {
+    std::string signature =
+        absl::StrFormat("%s %sFromNativeLayout(%s)", cpp_type(), cpp_type(),
+                        kFromNativeLayoutParams);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    pieces.push_back("[[maybe_unused]] int64_t leaf = 0;");
+    pieces.push_back(emitter_->AssignFromNativeLayout("result", /*nesting=*/0));
+    pieces.push_back("return result;");
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
   std::unique_ptr<CppEmitter> emitter_;
 };
 
@@ -487,17 +572,29 @@ class StructCppTypeGenerator : public CppTypeGenerator {
         "bool operator!=(const %s& other) const { return !(*this == other); }",
         cpp_type()));
     hdr_pieces.push_back(operator_stream_method.header);
+    std::vector<std::string> src_pieces = {
+        from_value_method.source, to_value_method.source,
+        to_string_method.source,  to_dslx_string_method.source,
+        verify_method.source,     operator_eq_method.source,
+        operator_stream_method.source};
+    if (emit_native_layout()) {
+      CppSource to_native_layout_method = ToNativeLayoutMethod();
+      CppSource from_native_layout_method = FromNativeLayoutMethod();
+      hdr_pieces.push_back("");
+      hdr_pieces.push_back(
+          absl::StrFormat("static constexpr int64_t kNativeLeafCount = %s;",
+                          NativeLeafCount()));
+      hdr_pieces.push_back(to_native_layout_method.header);
+      hdr_pieces.push_back(from_native_layout_method.header);
+      src_pieces.push_back(to_native_layout_method.source);
+      src_pieces.push_back(from_native_layout_method.source);
+    }
 
     std::string members = absl::StrJoin(hdr_pieces, "\n");
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
-    std::string source =
-        absl::StrJoin({from_value_method.source, to_value_method.source,
-                       to_string_method.source, to_dslx_string_method.source,
-                       verify_method.source, operator_eq_method.source,
-                       operator_stream_method.source},
-                      "\n\n");
+    std::string source = absl::StrJoin(src_pieces, "\n\n");
     return CppSource{.header = header, .source = source};
   }
 
@@ -654,6 +751,53 @@ class StructCppTypeGenerator : public CppTypeGenerator {
     };
   }
 
+  std::string NativeLeafCount() const {
+    if (member_emitters_.empty()) {
+      return "0";
+    }
+    return absl::StrJoin(member_emitters_, " + ",
+                         [](std::string* out,
+                            const std::unique_ptr<CppEmitter>& emitter) {
+                           absl::StrAppend(out, emitter->NativeLeafCount());
+                         });
+  }
+
+  CppSource ToNativeLayoutMethod() const {
+    std::vector<std::string> pieces;
+    pieces.push_back("[[maybe_unused]] int64_t leaf = 0;");
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignToNativeLayout(
+          cpp_member_names_[i], /*nesting=*/0));
+    }
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = absl::StrFormat("void ToNativeLayout(%s) const;",
+                                  kToNativeLayoutParams),
+        .source = absl::StrFormat("void %s::ToNativeLayout(%s) const {\n%s\n}",
+                                  cpp_type(), kToNativeLayoutParams,
+                                  Indent(body, 2))};
+  }
+
+  CppSource FromNativeLayoutMethod() const {
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    pieces.push_back("[[maybe_unused]] int64_t leaf = 0;");
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignFromNativeLayout(
+          absl::StrFormat("result.%s", cpp_member_names_[i]), /*nesting=*/0));
+    }
+    pieces.push_back("return result;");
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = absl::StrFormat("static %s FromNativeLayout(%s);", cpp_type(),
+                                  kFromNativeLayoutParams),
+        .source = absl::StrFormat("%s %s::FromNativeLayout(%s) {\n%s\n}",
+                                  cpp_type(), cpp_type(),
+                                  kFromNativeLayoutParams, Indent(body, 2))};
+  }
+
   const StructDef* struct_def_;
   std::vector<std::unique_ptr<CppEmitter>> member_emitters_;
   std::vector<std::string> cpp_member_names_;
@@ -663,29 +807,30 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
 /* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
 CppTypeGenerator::Create(const TypeDefinition& type_definition,
-                         TypeInfo* type_info, ImportData* import_data) {
-  return absl::visit(
-      Visitor{[&](const TypeAlias* type_alias)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return TypeAliasCppTypeGenerator::Create(type_alias, type_info,
-                                                         import_data);
-              },
-              [&](const StructDef* struct_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return StructCppTypeGenerator::Create(struct_def, type_info,
-                                                      import_data);
-              },
-              [&](const EnumDef* enum_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return EnumCppTypeGenerator::Create(enum_def, type_info,
-                                                    import_data);
-              },
-              [&](const ColonRef* colon_ref)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return absl::UnimplementedError(absl::StrFormat(
-                    "Unsupported type: %s", colon_ref->ToString()));
-              }},
-      type_definition);
+                         TypeInfo* type_info, ImportData* import_data,
+                         bool emit_native_layout) {
+  using GeneratorOr = absl::StatusOr<std::unique_ptr<CppTypeGenerator>>;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CppTypeGenerator> generator,
+      absl::visit(Visitor{[&](const TypeAlias* type_alias) -> GeneratorOr {
+                            return TypeAliasCppTypeGenerator::Create(
+                                type_alias, type_info, import_data);
+                          },
+                          [&](const StructDef* struct_def) -> GeneratorOr {
+                            return StructCppTypeGenerator::Create(
+                                struct_def, type_info, import_data);
+                          },
+                          [&](const EnumDef* enum_def) -> GeneratorOr {
+                            return EnumCppTypeGenerator::Create(
+                                enum_def, type_info, import_data);
+                          },
+                          [&](const ColonRef* colon_ref) -> GeneratorOr {
+                            return absl::UnimplementedError(absl::StrFormat(
+                                "Unsupported type: %s", colon_ref->ToString()));
+                          }},
+                  type_definition));
+  generator->emit_native_layout_ = emit_native_layout;
+  return generator;
 }
 
 }  // namespace xls::dslx
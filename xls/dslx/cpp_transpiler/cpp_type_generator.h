@@ -52,14 +52,20 @@ class CppTypeGenerator {
   // not a tuple or array).
   std::string dslx_type() const { return dslx_type_; }
 
+  // Returns whether conversions to and from the JIT native layout (see
+  // xls/jit/type_layout.h) are generated alongside those to and from
+  // xls::Value.
+  bool emit_native_layout() const { return emit_native_layout_; }
+
   // Returns a type generator for the given TypeDefinition.
   static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> Create(
       const TypeDefinition& type_definition, TypeInfo* type_info,
-      ImportData* import_data);
+      ImportData* import_data, bool emit_native_layout = false);
 
  protected:
   std::string cpp_type_;
   std::string dslx_type_;
+  bool emit_native_layout_ = false;
 };
 
 }  // namespace xls::dslx
@@ -12,13 +12,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/cpp_transpiler/test_types_lib.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -27,6 +35,32 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using testing::HasSubstr;
 
+// Returns the JIT native layout of the type of `value`.
+TypeLayout CreateTypeLayout(Package* package, const Value& value) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(package->GetTypeForValue(value));
+}
+
+// Checks that converting `data` to the native layout matches converting its
+// Value, and that converting back yields `data` again.
+template <typename T>
+void ExpectNativeLayoutMatchesValue(const T& data) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, data.ToValue());
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(&package, value);
+  ASSERT_EQ(static_cast<int64_t>(layout.elements().size()),
+            T::kNativeLeafCount);
+
+  std::vector<uint8_t> expected(layout.size());
+  layout.ValueToNativeLayout(value, expected.data());
+  std::vector<uint8_t> actual(layout.size());
+  data.ToNativeLayout(layout.elements(), actual.data());
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(T::FromNativeLayout(layout.elements(), expected.data()), data);
+}
+
 TEST(TestTypesTest, EnumToString) {
   EXPECT_EQ(MyEnumToString(test::MyEnum::kA), "MyEnum::kA (0)");
   EXPECT_EQ(MyEnumToString(test::MyEnum::kB), "MyEnum::kB (1)");
@@ -457,6 +491,29 @@ TEST(TestTypesTest, StructWithLotsOfTypes) {
 })");
 }
 
+TEST(TestTypesTest, StructWithLotsOfTypesNativeLayout) {
+  ExpectNativeLayoutMatchesValue(test::StructWithLotsOfTypes{
+      .v = true, .w = 5, .x = true, .y = 0xabcdef12345, .z = -3});
+  ExpectNativeLayoutMatchesValue(test::StructWithLotsOfTypes{
+      .v = false, .w = 0, .x = false, .y = 0, .z = -1024});
+}
+
+TEST(TestTypesTest, TupleNativeLayout) {
+  static_assert(test::kMyTupleNativeLeafCount == 4);
+  test::MyTuple t{42, -3, 123, -1};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, test::MyTupleToValue(t));
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(&package, value);
+
+  std::vector<uint8_t> expected(layout.size());
+  layout.ValueToNativeLayout(value, expected.data());
+  std::vector<uint8_t> actual(layout.size());
+  test::MyTupleToNativeLayout(t, layout.elements(), actual.data());
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(test::MyTupleFromNativeLayout(layout.elements(), expected.data()),
+            t);
+}
+
 TEST(TestTypesTest, StructWithTuplesArrayToString) {
   test::StructWithTuplesArray s{{}, {4, 100}};
   EXPECT_EQ(s.ToString(), R"(StructWithTuplesArray {
@@ -592,6 +649,15 @@ TEST(TestTypesTest, DoublyNestedStructToString) {
 })");
 }
 
+TEST(TestTypesTest, DoublyNestedStructNativeLayout) {
+  static_assert(test::OuterOuterStruct::kNativeLeafCount == 9);
+  test::InnerStruct a{.x = 42, .y = test::MyEnum::kB};
+  test::InnerStruct b{.x = 123, .y = test::MyEnum::kC};
+  test::OuterStruct o{.a = a, .b = b, .c = 0xdead, .v = test::MyEnum::kA};
+  ExpectNativeLayoutMatchesValue(test::OuterOuterStruct{
+      .q = test::EmptyStruct(), .some_array = {1, 2, 3}, .s = o});
+}
+
 TEST(TestTypesTest, VerifyDoublyNestedStruct) {
   test::InnerStruct a{.x = 42, .y = test::MyEnum::kB};
   test::InnerStruct b{.x = 1234567, .y = test::MyEnum::kC};
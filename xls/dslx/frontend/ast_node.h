@@ -149,6 +149,12 @@ class AstNode {
 
   Module* owner() const { return owner_; }
 
+  // Sequential ID of this node within its owning module, assigned in creation
+  // (i.e. parse) order; see `Module::Make()`. Lets per-node information such
+  // as deduced types be kept in dense tables instead of hash maps. The module
+  // node itself has ID -1.
+  int64_t id() const { return id_; }
+
   // Marks this node as the parent of all its child nodes.
   void SetParentage();
 
@@ -164,10 +170,13 @@ class AstNode {
   void SetParentNonLexical(AstNode* parent) { parent_ = parent; }
 
  private:
+  friend class Module;
+
   void set_parent(AstNode* parent) { parent_ = parent; }
 
   Module* owner_;
   AstNode* parent_ = nullptr;
+  int64_t id_ = -1;
 };
 
 // Visits transitively from the root down using post-order visitation (visit
@@ -260,6 +260,7 @@ class Module : public AstNode {
     std::unique_ptr<T> node =
         std::make_unique<T>(this, std::forward<Args>(args)...);
     T* ptr = node.get();
+    ptr->id_ = static_cast<int64_t>(nodes_.size());
     ptr->SetParentage();
     nodes_.push_back(std::move(node));
     return ptr;
@@ -0,0 +1,96 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/parser.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/frontend/token.h"
+
+namespace xls::dslx {
+namespace {
+
+// Measures scanning and parsing of large DSLX modules shaped like generated
+// sources: big constant lookup tables and long unrolled function bodies.
+
+// Returns a module of `count` tables and `count` functions, each `size`
+// entries/statements long, so the line count grows as `2 * count * size`.
+std::string MakeModule(int64_t count, int64_t size) {
+  std::string text;
+  for (int64_t i = 0; i < count; ++i) {
+    absl::StrAppendFormat(&text, "const TABLE_%d = u32[%d]:[\n", i, size);
+    for (int64_t j = 0; j < size; ++j) {
+      absl::StrAppendFormat(&text, "  u32:0x%08x,\n",
+                            (i * 0x9e3779b9 + j * 0x85ebca6b) & 0xffffffff);
+    }
+    absl::StrAppend(&text, "];\n\n");
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    absl::StrAppendFormat(&text, "pub fn step_%d(x: u32, y: u32) -> u32 {\n",
+                          i);
+    absl::StrAppend(&text, "  let acc_0 = x;\n");
+    for (int64_t j = 1; j < size; ++j) {
+      absl::StrAppendFormat(&text,
+                            "  let acc_%d = (acc_%d ^ TABLE_%d[u32:%d]) + "
+                            "(y >> u32:%d);\n",
+                            j, j - 1, i, j, j % 32);
+    }
+    absl::StrAppendFormat(&text, "  acc_%d\n}\n\n", size - 1);
+  }
+  return text;
+}
+
+void BM_Scan(benchmark::State& state) {
+  std::string text = MakeModule(state.range(0), state.range(1));
+  FileTable file_table;
+  Fileno fileno = file_table.GetOrCreate("bench.x");
+  for (auto _ : state) {
+    Scanner scanner(file_table, fileno, text);
+    absl::StatusOr<std::vector<Token>> tokens = scanner.PopAll();
+    CHECK_OK(tokens.status());
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void BM_Parse(benchmark::State& state) {
+  std::string text = MakeModule(state.range(0), state.range(1));
+  FileTable file_table;
+  Fileno fileno = file_table.GetOrCreate("bench.x");
+  for (auto _ : state) {
+    Scanner scanner(file_table, fileno, text);
+    Parser parser("bench", &scanner);
+    absl::StatusOr<std::unique_ptr<Module>> module = parser.ParseModule();
+    CHECK_OK(module.status());
+    benchmark::DoNotOptimize(module);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// Arguments are {tables/functions, entries/statements per table/function}; the
+// largest is about 130k lines.
+BENCHMARK(BM_Scan)->Args({4, 256})->Args({16, 1024})->Args({64, 1024});
+BENCHMARK(BM_Parse)->Args({4, 256})->Args({16, 1024})->Args({64, 1024});
+
+}  // namespace
+}  // namespace xls::dslx
@@ -16,7 +16,6 @@
 #define XLS_DSLX_FRONTEND_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -147,19 +146,17 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached, and returns the text from `start` (an index into the character
+  // stream at or before the current position) up to the new position.
+  //
+  // The result is a view into `text_` so that keywords can be recognized
+  // without materializing a string for them.
+  template <typename F>
+  std::string_view ScanWhile(int64_t start, F ftake) {
+    while (!AtCharEof() && ftake(PeekChar())) {
+      (void)PopChar();
     }
-    return s;
-  }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+    return std::string_view(text_).substr(start, index_ - start);
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -145,11 +145,13 @@ class Token {
   bool IsKeyword(Keyword target) const {
     return kind_ == TokenKind::kKeyword && GetKeyword() == target;
   }
+  // Note: these compare against the payload in place rather than via
+  // GetValue(), which would copy it; they are hot in the parser's lookahead.
   bool IsIdentifier(std::string_view target) const {
-    return kind_ == TokenKind::kIdentifier && *GetValue() == target;
+    return kind_ == TokenKind::kIdentifier && GetStringValue() == target;
   }
   bool IsNumber(std::string_view target) const {
-    return kind_ == TokenKind::kNumber && *GetValue() == target;
+    return kind_ == TokenKind::kNumber && GetStringValue() == target;
   }
 
   bool IsKindIn(
@@ -16,12 +16,11 @@
 #define XLS_DSLX_FRONTEND_TOKEN_PARSER_H_
 
 #include <cstdint>
-#include <memory>
+#include <deque>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
-#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/die_if_null.h"
@@ -59,7 +58,7 @@ class TokenParser {
   // position the token stream.
   Pos GetPos() const {
     if (index_ < tokens_.size()) {
-      return tokens_[index_]->span().start();
+      return tokens_[index_].span().start();
     }
     return scanner_->GetPos();
   }
@@ -120,9 +119,9 @@ class TokenParser {
   absl::StatusOr<const Token*> PeekToken() {
     if (index_ >= tokens_.size()) {
       XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
-      tokens_.push_back(std::make_unique<Token>(std::move(token)));
+      tokens_.push_back(std::move(token));
     }
-    return tokens_[index_].get();
+    return &tokens_[index_];
   }
 
   // Returns a token that has been popped destructively from the token stream.
@@ -130,7 +129,7 @@ class TokenParser {
     if (index_ >= tokens_.size()) {
       XLS_RETURN_IF_ERROR(PeekToken().status());
     }
-    Token token = *tokens_[index_];
+    Token token = tokens_[index_];
     index_ += 1;
     return token;
   }
@@ -140,7 +139,7 @@ class TokenParser {
     if (span_out != nullptr) {
       *span_out = tok.span();
     }
-    return *tok.GetValue();
+    return tok.GetStringValue();
   }
 
   // For use only when the caller knows there is lookahead present (in which
@@ -192,9 +191,10 @@ class TokenParser {
  private:
   Scanner* scanner_;
   int64_t index_;
-  // A vector of std::unique_ptrs is used for pointer stability as pointers are
-  // handed out by PeekToken
-  std::vector<std::unique_ptr<Token>> tokens_;
+  // Every token scanned so far, kept for backtracking. A deque gives the
+  // pointer stability needed by PeekToken while allocating tokens in blocks
+  // rather than one heap allocation apiece.
+  std::deque<Token> tokens_;
 };
 
 }  // namespace xls::dslx
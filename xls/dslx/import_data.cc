@@ -14,6 +14,7 @@
 
 #include "xls/dslx/import_data.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -32,6 +33,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
@@ -72,6 +74,44 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+void ImportData::PutParsedImport(const ImportTokens& subject,
+                                 std::filesystem::path path,
+                                 std::unique_ptr<Module> module) {
+  absl::MutexLock lock(&parsed_imports_->mutex);
+  parsed_imports_->modules.insert_or_assign(
+      subject, ParsedImport{std::move(path), std::move(module)});
+}
+
+std::unique_ptr<Module> ImportData::TakeParsedImport(
+    const ImportTokens& subject, const std::filesystem::path& path) {
+  absl::MutexLock lock(&parsed_imports_->mutex);
+  auto it = parsed_imports_->modules.find(subject);
+  if (it == parsed_imports_->modules.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<Module> module;
+  if (it->second.path == path) {
+    module = std::move(it->second.module);
+  }
+  parsed_imports_->modules.erase(it);
+  return module;
+}
+
+bool ImportData::HasParsedImport(const ImportTokens& subject) const {
+  absl::MutexLock lock(&parsed_imports_->mutex);
+  return parsed_imports_->modules.contains(subject);
+}
+
+std::vector<std::filesystem::path> ImportData::GetModulePaths() const {
+  std::vector<std::filesystem::path> paths;
+  paths.reserve(path_to_module_info_.size());
+  for (const auto& [path, module_info] : path_to_module_info_) {
+    paths.push_back(path);
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
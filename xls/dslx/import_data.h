@@ -28,6 +28,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -133,6 +134,28 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Stages a module that was parsed ahead of its import, see
+  // ParseImportsConcurrently(). DoImport() takes the module instead of parsing
+  // the file at `path` again. Safe to call from multiple threads.
+  void PutParsedImport(const ImportTokens& subject, std::filesystem::path path,
+                       std::unique_ptr<Module> module);
+
+  // Returns the module staged for `subject` if it was parsed from `path`, or
+  // nullptr otherwise. Safe to call from multiple threads.
+  std::unique_ptr<Module> TakeParsedImport(const ImportTokens& subject,
+                                           const std::filesystem::path& path);
+
+  // Returns whether a module is staged for `subject`.
+  bool HasParsedImport(const ImportTokens& subject) const;
+
+  // Number of threads used to parse the imports of a module before it is
+  // typechecked; with one job imports are parsed as they are typechecked.
+  int64_t import_jobs() const { return import_jobs_; }
+  void set_import_jobs(int64_t jobs) { import_jobs_ = jobs; }
+
+  // Returns the paths of the files of all the modules in this set, sorted.
+  std::vector<std::filesystem::path> GetModulePaths() const;
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -227,6 +250,18 @@ class ImportData {
   // module is not available.
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
+  // Modules parsed ahead of their import. Held behind a pointer so ImportData
+  // stays movable.
+  struct ParsedImport {
+    std::filesystem::path path;
+    std::unique_ptr<Module> module;
+  };
+  struct ParsedImports {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<ImportTokens, ParsedImport> modules
+        ABSL_GUARDED_BY(mutex);
+  };
+
   FileTable file_table_;
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
@@ -239,6 +274,9 @@ class ImportData {
   absl::Span<const std::filesystem::path> additional_search_paths_;
   WarningKindSet enabled_warnings_;
   std::unique_ptr<BytecodeCacheInterface> bytecode_cache_;
+  std::unique_ptr<ParsedImports> parsed_imports_ =
+      std::make_unique<ParsedImports>();
+  int64_t import_jobs_ = 1;
 
   // See comment on AddToImporterStack() above.
   std::vector<ImportRecord> importer_stack_;
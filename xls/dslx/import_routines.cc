@@ -14,11 +14,15 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
@@ -36,6 +40,7 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
@@ -141,6 +146,17 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
       GetCurrentDirectory().value(), stdlib_path));
 }
 
+// Reads and parses the module at `path`, which was found for `subject`.
+static absl::StatusOr<std::unique_ptr<Module>> ParseImport(
+    const ImportTokens& subject, const std::filesystem::path& path,
+    FileTable& file_table) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  Fileno fileno = file_table.GetOrCreate(path.c_str());
+  Scanner scanner(file_table, fileno, contents);
+  Parser parser(/*module_name=*/subject.ToString(), &scanner);
+  return parser.ParseModule();
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -163,16 +179,15 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   absl::Cleanup cleanup = absl::MakeCleanup(
       [&] { CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
-
   absl::Span<std::string const> pieces = subject.pieces();
   std::string fully_qualified_name = absl::StrJoin(pieces, ".");
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": start";
 
-  Fileno fileno = file_table.GetOrCreate(found_path.c_str());
-  Scanner scanner(file_table, fileno, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  std::unique_ptr<Module> module =
+      import_data->TakeParsedImport(subject, found_path);
+  if (module == nullptr) {
+    XLS_ASSIGN_OR_RETURN(module, ParseImport(subject, found_path, file_table));
+  }
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
 
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": done";
@@ -182,4 +197,85 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                             std::move(found_path)));
 }
 
+// Returns the imports of `module` in the order they appear.
+static std::vector<Import*> GetImports(const Module& module) {
+  std::vector<Import*> imports;
+  for (const ModuleMember& member : module.top()) {
+    if (std::holds_alternative<Import*>(member)) {
+      imports.push_back(std::get<Import*>(member));
+    }
+  }
+  return imports;
+}
+
+absl::Status ParseImportsConcurrently(const Module& module,
+                                      ImportData* import_data, int64_t jobs) {
+  XLS_RET_CHECK(import_data != nullptr);
+  FileTable& file_table = import_data->file_table();
+  // The parser only reads the file table, except for the span it gives builtin
+  // names in errors, so register that name up front as well.
+  file_table.GetOrCreate("<builtin>");
+
+  absl::flat_hash_set<ImportTokens> seen;
+  std::vector<Import*> frontier = GetImports(module);
+  while (!frontier.empty()) {
+    // Locate the imports of this depth; the paths are resolved serially since
+    // the file table is not thread-safe.
+    std::vector<ImportTokens> subjects;
+    std::vector<std::filesystem::path> paths;
+    for (Import* import : frontier) {
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject) ||
+          import_data->HasParsedImport(subject) ||
+          !seen.insert(subject).second) {
+        continue;
+      }
+      absl::StatusOr<std::filesystem::path> path = FindExistingPath(
+          subject, import_data->stdlib_path(),
+          import_data->additional_search_paths(), import->span(), file_table);
+      if (!path.ok()) {
+        continue;
+      }
+      file_table.GetOrCreate(path->c_str());
+      subjects.push_back(std::move(subject));
+      paths.push_back(*std::move(path));
+    }
+    VLOG(3) << "Parsing " << subjects.size() << " imports concurrently";
+
+    std::vector<const Module*> parsed(subjects.size(), nullptr);
+    std::atomic<int64_t> next = 0;
+    auto worker = [&]() {
+      for (int64_t i = next++; i < subjects.size(); i = next++) {
+        absl::StatusOr<std::unique_ptr<Module>> parsed_module =
+            ParseImport(subjects[i], paths[i], file_table);
+        if (!parsed_module.ok()) {
+          continue;
+        }
+        parsed[i] = parsed_module->get();
+        import_data->PutParsedImport(subjects[i], paths[i],
+                                     *std::move(parsed_module));
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < std::min<int64_t>(jobs, subjects.size()); ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    frontier.clear();
+    for (const Module* parsed_module : parsed) {
+      if (parsed_module == nullptr) {
+        continue;
+      }
+      for (Import* import : GetImports(*parsed_module)) {
+        frontier.push_back(import);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::dslx
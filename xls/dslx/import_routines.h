@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/statusor.h"
@@ -50,6 +51,17 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      ImportData* import_data,
                                      const Span& import_span);
 
+// Parses the transitive imports of `module` that are not yet in `import_data`
+// on up to `jobs` threads, and stages them in `import_data` so DoImport() can
+// typecheck them without parsing them again.
+//
+// The import DAG is walked breadth-first: all the imports found at one depth
+// are located and then parsed concurrently, and their own imports form the
+// next depth. Imports that cannot be located or parsed are left for DoImport()
+// to report with the usual importer context.
+absl::Status ParseImportsConcurrently(const Module& module,
+                                      ImportData* import_data, int64_t jobs);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
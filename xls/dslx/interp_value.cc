@@ -14,6 +14,7 @@
 
 #include "xls/dslx/interp_value.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
@@ -383,6 +384,10 @@ bool InterpValue::Eq(const InterpValue& other) const {
   auto values_equal = [&] {
     const std::vector<InterpValue>& lhs = GetValuesOrDie();
     const std::vector<InterpValue>& rhs = other.GetValuesOrDie();
+    if (&lhs == &rhs) {
+      // Copies of the same value share their elements.
+      return true;
+    }
     if (lhs.size() != rhs.size()) {
       return false;
     }
@@ -627,12 +632,20 @@ absl::StatusOr<InterpValue> InterpValue::Index(const InterpValue& other) const {
   return (*lhs)[index];
 }
 
+std::vector<InterpValue>& InterpValue::GetMutableValues() {
+  SharedValues& values = std::get<SharedValues>(payload_);
+  if (values.use_count() > 1) {
+    values = std::make_shared<std::vector<InterpValue>>(*values);
+  }
+  return *values;
+}
+
 absl::StatusOr<InterpValue> InterpValue::Update(
     const InterpValue& index, const InterpValue& value) const {
   absl::Span<const xls::dslx::InterpValue> indices;
   if (index.IsTuple()) {
     indices =
-        absl::MakeConstSpan(std::get<std::vector<InterpValue>>(index.payload_));
+        absl::MakeConstSpan(index.GetValuesOrDie());
   } else {
     indices = absl::MakeConstSpan(&index, 1);
   }
@@ -643,8 +656,7 @@ absl::StatusOr<InterpValue> InterpValue::Update(
       return absl::InvalidArgumentError(absl::StrFormat(
           "Update of non-array element: %s", element->ToString()));
     }
-    std::vector<InterpValue>& values =
-        std::get<std::vector<InterpValue>>(element->payload_);
+    std::vector<InterpValue>& values = element->GetMutableValues();
     XLS_ASSIGN_OR_RETURN(Bits index_bits, i.GetBits());
     XLS_ASSIGN_OR_RETURN(uint64_t index_value, index_bits.ToUint64());
     if (index_value >= values.size()) {
@@ -702,6 +714,20 @@ absl::StatusOr<std::shared_ptr<InterpValue::Channel>> InterpValue::GetChannel()
   return absl::InvalidArgumentError("Value does not contain a channel.");
 }
 
+void InterpValue::Channel::push_back(InterpValue value) {
+  if (size_ == slots_.size()) {
+    std::vector<std::optional<InterpValue>> slots(
+        std::max<int64_t>(4, 2 * slots_.size()));
+    for (int64_t i = 0; i < size_; ++i) {
+      slots[i] = std::move(slots_[(head_ + i) % slots_.size()]);
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+  slots_[(head_ + size_) % slots_.size()] = std::move(value);
+  ++size_;
+}
+
 // Returns the minimum of the given bits value interpreted as an unsigned
 // number and limit.
 static int64_t ClampedUnsignedValue(const Bits& bits, int64_t limit) {
@@ -15,8 +15,9 @@
 #ifndef XLS_DSLX_INTERP_VALUE_H_
 #define XLS_DSLX_INTERP_VALUE_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <deque>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -75,7 +76,7 @@ class InterpValue {
     Function* function;
   };
   using FnData = std::variant<Builtin, UserFnData>;
-  using Channel = std::deque<InterpValue>;
+  class Channel;
 
   // Factories
 
@@ -119,9 +120,7 @@ class InterpValue {
         std::move(bits));
   }
   static InterpValue MakeTuple(std::vector<InterpValue> members);
-  static InterpValue MakeChannel() {
-    return InterpValue(InterpValueTag::kChannel, std::make_shared<Channel>());
-  }
+  static InterpValue MakeChannel();
   static absl::StatusOr<InterpValue> MakeArray(
       std::vector<InterpValue> elements);
   static InterpValue MakeBool(bool value) {
@@ -298,13 +297,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<SharedValues>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return std::get<SharedValues>(payload_).get();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return *std::get<SharedValues>(payload_);
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -346,7 +345,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<SharedValues>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -395,12 +394,25 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  //
+  // The elements of tuples and arrays are shared between copies of a value and
+  // only copied when a copy is modified, so that passing around large
+  // aggregates (e.g. constant lookup tables) is cheap.
+  using SharedValues = std::shared_ptr<std::vector<InterpValue>>;
+  using Payload = std::variant<Bits, EnumData, SharedValues, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
+  InterpValue(InterpValueTag tag, std::vector<InterpValue> values)
+      : tag_(tag),
+        payload_(std::make_shared<std::vector<InterpValue>>(
+            std::move(values))) {}
+
+  // Returns the elements of this tuple or array for modification, first
+  // copying them if they are shared with another value.
+  std::vector<InterpValue>& GetMutableValues();
 
   using CompareF = bool (*)(const Bits& lhs, const Bits& rhs);
 
@@ -413,6 +425,89 @@ class InterpValue {
   Payload payload_;
 };
 
+// The FIFO of values in flight on a channel.
+//
+// Values are kept in a ring buffer that only grows (geometrically) when it is
+// full, so a channel in steady state does not allocate per value sent the way
+// a std::deque does.
+class InterpValue::Channel {
+ public:
+  // Iterates over the values in the channel from the front (oldest) to the
+  // back (newest).
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = InterpValue;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const InterpValue*;
+    using reference = const InterpValue&;
+
+    const_iterator(const Channel* channel, int64_t index)
+        : channel_(channel), index_(index) {}
+
+    reference operator*() const { return channel_->at(index_); }
+    pointer operator->() const { return &channel_->at(index_); }
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++index_;
+      return result;
+    }
+    bool operator==(const const_iterator& other) const {
+      return channel_ == other.channel_ && index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    const Channel* channel_;
+    int64_t index_;
+  };
+
+  bool empty() const { return size_ == 0; }
+  int64_t size() const { return size_; }
+
+  const InterpValue& front() const {
+    CHECK(!empty());
+    return *slots_[head_];
+  }
+
+  void push_back(InterpValue value);
+
+  void pop_front() {
+    CHECK(!empty());
+    slots_[head_].reset();
+    head_ = (head_ + 1) % slots_.size();
+    --size_;
+  }
+
+  void clear() {
+    while (!empty()) {
+      pop_front();
+    }
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+ private:
+  const InterpValue& at(int64_t index) const {
+    return *slots_[(head_ + index) % slots_.size()];
+  }
+
+  std::vector<std::optional<InterpValue>> slots_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+inline InterpValue InterpValue::MakeChannel() {
+  return InterpValue(InterpValueTag::kChannel, std::make_shared<Channel>());
+}
+
 template <typename H>
 H AbslHashValue(H state, const InterpValue::UserFnData& v) {
   return H::combine(std::move(state), v.module, v.function);
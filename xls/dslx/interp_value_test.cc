@@ -14,9 +14,11 @@
 
 #include "xls/dslx/interp_value.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -343,6 +345,27 @@ TEST(InterpValueTest, MakeMaxValue) {
             "s16:32767");
 }
 
+TEST(InterpValueTest, CopiesShareElementsUntilUpdated) {
+  std::vector<InterpValue> elements;
+  for (int64_t i = 0; i < 256; ++i) {
+    elements.push_back(InterpValue::MakeU8(i));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue table,
+                           InterpValue::MakeArray(std::move(elements)));
+  InterpValue copy = table;
+  EXPECT_EQ(&table.GetValuesOrDie(), &copy.GetValuesOrDie());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue updated,
+      table.Update(InterpValue::MakeU32(3), InterpValue::MakeU8(42)));
+  EXPECT_NE(&table.GetValuesOrDie(), &updated.GetValuesOrDie());
+  EXPECT_THAT(table.Index(3), IsOkAndHolds(InterpValue::MakeU8(3)));
+  EXPECT_THAT(updated.Index(3), IsOkAndHolds(InterpValue::MakeU8(42)));
+  EXPECT_THAT(copy.Index(3), IsOkAndHolds(InterpValue::MakeU8(3)));
+  EXPECT_TRUE(table.Eq(copy));
+  EXPECT_FALSE(table.Eq(updated));
+}
+
 TEST(InterpValueTest, FormatEnum) {
   constexpr std::string_view kProgram = R"(enum MyEnum : u32 {
     FOO = 0,
@@ -366,5 +389,41 @@ TEST(InterpValueTest, FormatEnum) {
   EXPECT_EQ(bar.ToFormattedString(fmt_desc).value(), "MyEnum::BAR  // u32:1");
 }
 
+TEST(InterpValueTest, ChannelIsFifoAcrossWrapAroundAndGrowth) {
+  InterpValue channel_value = InterpValue::MakeChannel();
+  std::shared_ptr<InterpValue::Channel> channel =
+      channel_value.GetChannelOrDie();
+  EXPECT_TRUE(channel->empty());
+
+  // Interleave sends and receives so the ring buffer wraps around before it
+  // has to grow.
+  int64_t next_sent = 0;
+  int64_t next_received = 0;
+  for (int64_t round = 0; round < 10; ++round) {
+    for (int64_t i = 0; i < round + 2; ++i) {
+      channel->push_back(InterpValue::MakeU32(next_sent++));
+    }
+    for (int64_t i = 0; i < round + 1; ++i) {
+      EXPECT_THAT(channel->front().GetBitValueUnsigned(),
+                  IsOkAndHolds(static_cast<uint64_t>(next_received++)));
+      channel->pop_front();
+    }
+  }
+  EXPECT_EQ(channel->size(), next_sent - next_received);
+
+  std::vector<int64_t> remaining;
+  for (const InterpValue& value : *channel) {
+    remaining.push_back(value.GetBitValueUnsigned().value());
+  }
+  std::vector<int64_t> expected;
+  for (int64_t i = next_received; i < next_sent; ++i) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(remaining, expected);
+
+  channel->clear();
+  EXPECT_TRUE(channel->empty());
+}
+
 }  // namespace
 }  // namespace xls::dslx
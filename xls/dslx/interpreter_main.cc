@@ -87,7 +87,16 @@ ABSL_FLAG(int64_t, max_ticks, 100000,
 ABSL_FLAG(std::string, evaluator, "dslx-interpreter",
           "What evaluator should be used to actually execute the dslx test. "
           "'dslx-interpreter' is the DSLX bytecode interpreter. 'ir-jit' is "
-          "the XLS-IR JIT. ir-interpreter' is the XLS-IR interpreter.");
+          "the XLS-IR JIT. ir-interpreter' is the XLS-IR interpreter. "
+          "'tiered' is the DSLX bytecode interpreter, moving test procs which "
+          "run for more than --tiered_tick_threshold ticks to the XLS-IR JIT.");
+ABSL_FLAG(int64_t, tiered_tick_threshold, 1000,
+          "With --evaluator=tiered, the number of ticks a test proc runs in "
+          "the DSLX interpreter before it is restarted in the XLS-IR JIT.");
+ABSL_FLAG(int64_t, jobs, 1,
+          "Number of tests to execute concurrently, and of threads evaluating "
+          "the samples of each quickcheck. Test results are reported in the "
+          "same order regardless.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -102,6 +111,7 @@ enum class EvaluatorType : uint8_t {
   kDslxInterpreter,
   kIrInterpreter,
   kIrJit,
+  kTiered,
 };
 
 absl::StatusOr<EvaluatorType> GetEvaluatorType(std::string_view text) {
@@ -114,9 +124,12 @@ absl::StatusOr<EvaluatorType> GetEvaluatorType(std::string_view text) {
   if (text == "ir-interpreter") {
     return EvaluatorType::kIrInterpreter;
   }
+  if (text == "tiered") {
+    return EvaluatorType::kTiered;
+  }
   return absl::InvalidArgumentError(
       "Unknown evaluator. Options are ['dslx-interpreter', 'ir-jit', "
-      "'ir-interpreter']");
+      "'ir-interpreter', 'tiered']");
 }
 static constexpr std::string_view kUsage = R"(
 Parses, typechecks, and executes all tests inside of a DSLX module.
@@ -130,6 +143,9 @@ std::unique_ptr<AbstractTestRunner> GetTestRunner(EvaluatorType evaluator) {
       return std::make_unique<IrInterpreterTestRunner>();
     case EvaluatorType::kIrJit:
       return std::make_unique<IrJitTestRunner>();
+    case EvaluatorType::kTiered:
+      return std::make_unique<TieredTestRunner>(
+          absl::GetFlag(FLAGS_tiered_tick_threshold));
   }
 }
 
@@ -141,7 +157,8 @@ absl::StatusOr<TestResult> RealMain(
     FormatPreference format_preference, CompareFlag compare_flag, bool execute,
     bool warnings_as_errors, std::optional<int64_t> seed, bool trace_channels,
     std::optional<int64_t> max_ticks,
-    std::optional<std::string_view> xml_output_file, EvaluatorType evaluator) {
+    std::optional<std::string_view> xml_output_file, EvaluatorType evaluator,
+    int64_t jobs) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
       WarningKindSetFromDisabledString(absl::GetFlag(FLAGS_disable_warnings)));
@@ -191,7 +208,8 @@ absl::StatusOr<TestResult> RealMain(
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .jobs = jobs};
 
   std::unique_ptr<AbstractTestRunner> test_runner = GetTestRunner(evaluator);
   XLS_ASSIGN_OR_RETURN(TestResultData test_result,
@@ -313,7 +331,7 @@ int main(int argc, char* argv[]) {
   absl::StatusOr<xls::dslx::TestResult> test_result = xls::dslx::RealMain(
       args[0], dslx_paths, dslx_stdlib_path, test_filter, preference,
       compare_flag, execute, warnings_as_errors, seed, trace_channels,
-      max_ticks, xml_output_file, evaluator.value());
+      max_ticks, xml_output_file, evaluator.value(), absl::GetFlag(FLAGS_jobs));
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
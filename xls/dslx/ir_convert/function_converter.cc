@@ -1150,7 +1150,7 @@ absl::StatusOr<FunctionConverter::RangeData> FunctionConverter::GetRangeData(
   // Easy case first: using the `..` range operator.
   InterpValue start_value(InterpValue::MakeToken());
   InterpValue limit_value(InterpValue::MakeToken());
-  ParametricEnv bindings(parametric_env_map_);
+  const ParametricEnv& bindings = parametric_env_;
 
   const auto* range_op = dynamic_cast<const Range*>(iterable);
   if (range_op != nullptr) {
@@ -1329,9 +1329,8 @@ absl::Status FunctionConverter::HandleFor(const For* node) {
     // still want to make the loop with the same pattern.
     AstNode* accum = carry_node;
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> carry_type, ResolveType(accum));
-    XLS_ASSIGN_OR_RETURN(
-        xls::Type * carry_ir_type,
-        TypeToIr(package(), *carry_type, ParametricEnv(parametric_env_map_)));
+    XLS_ASSIGN_OR_RETURN(xls::Type * carry_ir_type,
+                         TypeToIr(package(), *carry_type, parametric_env_));
     BValue carry;
     if (implicit_token_data_.has_value()) {
       carry = body_converter.AddTokenWrappedParam(carry_ir_type);
@@ -1396,9 +1395,8 @@ absl::Status FunctionConverter::HandleFor(const For* node) {
       // Otherwise, pass in the variable to the loop body function as
       // a parameter.
       relevant_name_defs.push_back(freevar_name_def);
-      XLS_ASSIGN_OR_RETURN(
-          xls::Type * name_def_type,
-          TypeToIr(package(), **type, ParametricEnv(parametric_env_map_)));
+      XLS_ASSIGN_OR_RETURN(xls::Type * name_def_type,
+                           TypeToIr(package(), **type, parametric_env_));
       body_converter.SetNodeToIr(
           freevar_name_def, body_converter.AddParam(
                                 freevar_name_def->identifier(), name_def_type));
@@ -1803,7 +1801,7 @@ absl::Status FunctionConverter::HandleUdfInvocation(const Invocation* node,
 absl::StatusOr<FunctionConverter::AssertionLabelData>
 FunctionConverter::GetAssertionLabel(std::string_view caller_name,
                                      const Expr* label_expr, const Span& span) {
-  ParametricEnv bindings(parametric_env_map_);
+  const ParametricEnv& bindings = parametric_env_;
   XLS_RETURN_IF_ERROR(
       ConstexprEvaluator::Evaluate(import_data_, current_type_info_,
                                    kNoWarningCollector, bindings, label_expr));
@@ -2904,8 +2902,7 @@ absl::StatusOr<std::string> FunctionConverter::GetCalleeIdentifier(
 
 std::optional<const Expr*> FunctionConverter::GetUnrolledForLoop(
     const UnrollFor* loop) {
-  return current_type_info_->GetUnrolledLoop(
-      loop, ParametricEnv(parametric_env_map_));
+  return current_type_info_->GetUnrolledLoop(loop, parametric_env_);
 }
 
 absl::Status FunctionConverter::HandleUnrollFor(const UnrollFor* node) {
@@ -3610,7 +3607,7 @@ absl::StatusOr<std::unique_ptr<Type>> FunctionConverter::ResolveType(
   }
 
   return t.value()->MapSize([this](const TypeDim& dim) {
-    return ResolveDim(dim, ParametricEnv(parametric_env_map_));
+    return ResolveDim(dim, parametric_env_);
   });
 }
 
@@ -3647,7 +3644,7 @@ absl::StatusOr<xls::Type*> FunctionConverter::ResolveTypeToIr(
     const AstNode* node) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> type, ResolveType(node));
   return TypeToIr(package_data_.conversion_info->package.get(), *type,
-                  ParametricEnv(parametric_env_map_));
+                  parametric_env_);
 }
 
 absl::StatusOr<Value> InterpValueToValue(const InterpValue& iv) {
@@ -260,9 +260,11 @@ class FunctionConverter {
 
   void SetParametricEnv(const ParametricEnv* value) {
     parametric_env_map_ = value->ToMap();
+    parametric_env_ = *value;
   }
   void set_parametric_env_map(
       absl::flat_hash_map<std::string, InterpValue> map) {
+    parametric_env_ = ParametricEnv(map);
     parametric_env_map_ = std::move(map);
   }
 
@@ -283,11 +285,7 @@ class FunctionConverter {
     return it->second;
   }
 
-  // Note: this object holds a map, but we can return a ParametricEnv object
-  // on demand.
-  ParametricEnv GetParametricEnv() const {
-    return ParametricEnv(parametric_env_map_);
-  }
+  const ParametricEnv& GetParametricEnv() const { return parametric_env_; }
 
   // Returns the parametric env to be used in the callee for this invocation.
   //
@@ -528,6 +526,10 @@ class FunctionConverter {
   // integral values parametrics are taking on).
   absl::flat_hash_map<std::string, InterpValue> parametric_env_map_;
 
+  // The same bindings as `parametric_env_map_`, kept in sync with it so that
+  // resolving types (which happens for most nodes) does not rebuild the env.
+  ParametricEnv parametric_env_;
+
   // File number for use in source positions.
   xls::Fileno ir_fileno_;
 
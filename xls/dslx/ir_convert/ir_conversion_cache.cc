@@ -0,0 +1,97 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/ir_convert/ir_conversion_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/ir_convert/ir_conversion_cache.pb.h"
+#include "xls/ir/xls_ir_interface.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+// Returns the 64-bit FNV-1a hash of `s`. Unlike absl::Hash this is stable
+// across processes. It only names the entry files, each entry holds its full
+// invocation so a collision is a cache miss rather than a wrong result.
+uint64_t StableHash(std::string_view s) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : s) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+}  // namespace
+
+std::filesystem::path IrConversionCache::GetEntryPath(
+    std::string_view invocation) const {
+  return directory_ /
+         absl::StrFormat("%016x.ir_conversion", StableHash(invocation));
+}
+
+absl::StatusOr<std::optional<IrConversionCacheEntryProto>>
+IrConversionCache::Lookup(std::string_view invocation) const {
+  std::filesystem::path entry_path = GetEntryPath(invocation);
+  if (!FileExists(entry_path).ok()) {
+    return std::nullopt;
+  }
+  IrConversionCacheEntryProto entry;
+  if (!ParseProtobinFile(entry_path, &entry).ok() ||
+      entry.invocation() != invocation) {
+    return std::nullopt;
+  }
+  for (const IrConversionCacheEntryProto::Dependency& dependency :
+       entry.dependencies()) {
+    absl::StatusOr<std::string> contents = GetFileContents(dependency.path());
+    if (!contents.ok() || *contents != dependency.contents()) {
+      return std::nullopt;
+    }
+  }
+  return entry;
+}
+
+absl::Status IrConversionCache::Store(
+    std::string_view invocation,
+    absl::Span<const std::filesystem::path> dependencies, std::string_view ir,
+    const PackageInterfaceProto& interface) const {
+  IrConversionCacheEntryProto entry;
+  entry.set_invocation(invocation);
+  for (const std::filesystem::path& path : dependencies) {
+    IrConversionCacheEntryProto::Dependency* dependency =
+        entry.add_dependencies();
+    dependency->set_path(path.string());
+    XLS_ASSIGN_OR_RETURN(*dependency->mutable_contents(),
+                         GetFileContents(path));
+  }
+  entry.set_ir(ir);
+  *entry.mutable_interface() = interface;
+
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  return AtomicSetFileContents(GetEntryPath(invocation),
+                               entry.SerializeAsString());
+}
+
+}  // namespace xls::dslx
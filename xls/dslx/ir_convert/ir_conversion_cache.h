@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_IR_CONVERT_IR_CONVERSION_CACHE_H_
+#define XLS_DSLX_IR_CONVERT_IR_CONVERSION_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/dslx/ir_convert/ir_conversion_cache.pb.h"
+#include "xls/ir/xls_ir_interface.pb.h"
+
+namespace xls::dslx {
+
+// On-disk cache of DSLX-to-IR conversion results, so that converting files
+// whose sources (and imports) are unchanged does not parse, typecheck and
+// convert them again.
+//
+// Entries are keyed by an "invocation" string describing the inputs and
+// options of the conversion. Each entry records the contents of every DSLX
+// file the conversion read, and is only used while all of those files still
+// have the same contents.
+class IrConversionCache {
+ public:
+  explicit IrConversionCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Returns the cached entry for `invocation`, or nullopt if there is none or
+  // any of its dependencies has changed.
+  absl::StatusOr<std::optional<IrConversionCacheEntryProto>> Lookup(
+      std::string_view invocation) const;
+
+  // Stores the result of the conversion described by `invocation`, which read
+  // the files in `dependencies`, replacing any previous entry.
+  absl::Status Store(std::string_view invocation,
+                     absl::Span<const std::filesystem::path> dependencies,
+                     std::string_view ir,
+                     const PackageInterfaceProto& interface) const;
+
+  // Returns the file holding the entry for `invocation`.
+  std::filesystem::path GetEntryPath(std::string_view invocation) const;
+
+ private:
+  std::filesystem::path directory_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_IR_CONVERT_IR_CONVERSION_CACHE_H_
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/ir_convert/ir_conversion_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/ir_convert/ir_conversion_cache.pb.h"
+#include "xls/ir/xls_ir_interface.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Eq;
+using ::testing::Optional;
+using ::testing::Property;
+
+class IrConversionCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    top_path_ = temp_dir_->path() / "top.x";
+    import_path_ = temp_dir_->path() / "imported.x";
+    XLS_ASSERT_OK(SetFileContents(top_path_, "import imported;"));
+    XLS_ASSERT_OK(SetFileContents(import_path_, "pub const X = u32:1;"));
+  }
+
+  std::filesystem::path cache_dir() const {
+    return temp_dir_->path() / "cache";
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+  std::filesystem::path top_path_;
+  std::filesystem::path import_path_;
+};
+
+TEST_F(IrConversionCacheTest, HitWhileDependenciesAreUnchanged) {
+  IrConversionCache cache(cache_dir());
+  EXPECT_THAT(cache.Lookup("convert top.x"), IsOkAndHolds(Eq(std::nullopt)));
+
+  PackageInterfaceProto interface;
+  interface.set_name("top");
+  XLS_ASSERT_OK(cache.Store("convert top.x", {top_path_, import_path_},
+                            "package top", interface));
+  EXPECT_THAT(cache.Lookup("convert top.x"),
+              IsOkAndHolds(Optional(
+                  Property(&IrConversionCacheEntryProto::ir, "package top"))));
+
+  // A different invocation does not see the entry.
+  EXPECT_THAT(cache.Lookup("convert top.x --convert_tests"),
+              IsOkAndHolds(Eq(std::nullopt)));
+
+  // Nor does the same invocation once an import has changed.
+  XLS_ASSERT_OK(SetFileContents(import_path_, "pub const X = u32:2;"));
+  EXPECT_THAT(cache.Lookup("convert top.x"), IsOkAndHolds(Eq(std::nullopt)));
+}
+
+TEST_F(IrConversionCacheTest, StoreReplacesEntry) {
+  IrConversionCache cache(cache_dir());
+  XLS_ASSERT_OK(cache.Store("convert top.x", {top_path_}, "package old",
+                            PackageInterfaceProto()));
+  XLS_ASSERT_OK(cache.Store("convert top.x", {top_path_}, "package new",
+                            PackageInterfaceProto()));
+  EXPECT_THAT(cache.Lookup("convert top.x"),
+              IsOkAndHolds(Optional(
+                  Property(&IrConversionCacheEntryProto::ir, "package new"))));
+}
+
+}  // namespace
+}  // namespace xls::dslx
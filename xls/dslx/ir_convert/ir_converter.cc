@@ -24,6 +24,8 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
@@ -45,6 +47,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/constexpr_evaluator.h"
@@ -160,12 +163,45 @@ absl::Status WrapEntryIfImplicitToken(const PackageData& package_data,
   return absl::OkStatus();
 }
 
-absl::Status ConvertOneFunctionInternal(PackageData& package_data,
-                                        const ConversionRecord& record,
-                                        ImportData* import_data,
-                                        ProcConversionData* proc_data,
-                                        ChannelScope* channel_scope,
-                                        const ConvertOptions& options) {
+// Computes the constant definitions referenced by the body of each distinct
+// function in `order`.
+//
+// Parametric functions appear in the conversion order once per instantiation
+// but their constant dependencies only depend on the AST, so each body is
+// analyzed once. The analysis only reads the AST, so the bodies are analyzed
+// concurrently on the shared thread pool; IR construction itself remains
+// serial, as it mutates the package and (via constexpr evaluation) the
+// TypeInfo.
+absl::StatusOr<absl::flat_hash_map<Function*, std::vector<ConstantDef*>>>
+GetConstantDeps(absl::Span<const ConversionRecord> order) {
+  std::vector<Function*> functions;
+  absl::flat_hash_set<Function*> seen;
+  for (const ConversionRecord& record : order) {
+    if (seen.insert(record.f()).second) {
+      functions.push_back(record.f());
+    }
+  }
+  std::vector<absl::StatusOr<std::vector<ConstantDef*>>> deps(
+      functions.size());
+  TaskGroup group;
+  for (int64_t i = 0; i < functions.size(); ++i) {
+    group.Schedule([&functions, &deps, i] {
+      deps[i] = GetConstantDepFreevars(functions[i]->body());
+    });
+  }
+  XLS_RETURN_IF_ERROR(group.Wait());
+  absl::flat_hash_map<Function*, std::vector<ConstantDef*>> result;
+  for (int64_t i = 0; i < functions.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(result[functions[i]], std::move(deps[i]));
+  }
+  return result;
+}
+
+absl::Status ConvertOneFunctionInternal(
+    PackageData& package_data, const ConversionRecord& record,
+    absl::Span<ConstantDef* const> constant_deps, ImportData* import_data,
+    ProcConversionData* proc_data, ChannelScope* channel_scope,
+    const ConvertOptions& options) {
   // Validate the requested conversion looks sound in terms of provided
   // parametrics.
   XLS_RETURN_IF_ERROR(ConversionRecord::ValidateParametrics(
@@ -174,9 +210,7 @@ absl::Status ConvertOneFunctionInternal(PackageData& package_data,
   FunctionConverter converter(package_data, record.module(), import_data,
                               options, proc_data, channel_scope,
                               record.IsTop());
-  XLS_ASSIGN_OR_RETURN(auto constant_deps,
-                       GetConstantDepFreevars(record.f()->body()));
-  for (const auto& dep : constant_deps) {
+  for (ConstantDef* dep : constant_deps) {
     converter.AddConstantDep(dep);
   }
 
@@ -346,13 +380,16 @@ absl::Status ConvertCallGraph(absl::Span<const ConversionRecord> order,
         first_proc_config->type_info(), package_data, &proc_data));
   }
 
+  XLS_ASSIGN_OR_RETURN(
+      (absl::flat_hash_map<Function*, std::vector<ConstantDef*>> constant_deps),
+      GetConstantDeps(order));
   for (const ConversionRecord& record : order) {
     VLOG(3) << "Converting to IR: " << record.ToString();
     channel_scope.EnterFunctionContext(record.type_info(),
                                        record.parametric_env());
-    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(package_data, record,
-                                                   import_data, &proc_data,
-                                                   &channel_scope, options));
+    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
+        package_data, record, constant_deps.at(record.f()), import_data,
+        &proc_data, &channel_scope, options));
   }
 
   VLOG(3) << "Verifying converted package";
@@ -552,7 +589,8 @@ absl::StatusOr<PackageConversionData> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, std::string_view stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options, std::optional<std::string_view> top,
-    std::optional<std::string_view> package_name, bool* printed_error) {
+    std::optional<std::string_view> package_name, bool* printed_error,
+    std::vector<std::filesystem::path>* dependencies) {
   std::string resolved_package_name;
   if (package_name.has_value()) {
     resolved_package_name = package_name.value();
@@ -587,6 +625,18 @@ absl::StatusOr<PackageConversionData> ConvertFilesToPackage(
     XLS_RETURN_IF_ERROR(AddContentsToPackage(
         text, module_name, /*path=*/path, /*entry=*/top, convert_options,
         &import_data, &conversion_data, printed_error));
+    if (dependencies != nullptr) {
+      dependencies->push_back(std::filesystem::path(path));
+      for (std::filesystem::path& module_path : import_data.GetModulePaths()) {
+        dependencies->push_back(std::move(module_path));
+      }
+    }
+  }
+  if (dependencies != nullptr) {
+    std::sort(dependencies->begin(), dependencies->end());
+    dependencies->erase(
+        std::unique(dependencies->begin(), dependencies->end()),
+        dependencies->end());
   }
   return conversion_data;
 }
@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -110,13 +111,17 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module, Function* fn,
 //   package_name: Optionally, the name of the package.
 //   printed_error: If a non-null pointer is passes, sets the contents to a
 //     boolean value indicating if an error was printed during conversion.
+//   dependencies: If a non-null pointer is passed, sets the contents to the
+//     paths of every DSLX file read by the conversion (the inputs and all of
+//     their transitive imports).
 absl::StatusOr<PackageConversionData> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, std::string_view stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options,
     std::optional<std::string_view> top = std::nullopt,
     std::optional<std::string_view> package_name = std::nullopt,
-    bool* printed_error = nullptr);
+    bool* printed_error = nullptr,
+    std::vector<std::filesystem::path>* dependencies = nullptr);
 
 }  // namespace xls::dslx
 
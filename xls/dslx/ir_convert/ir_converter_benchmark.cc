@@ -0,0 +1,74 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of IR conversion for functions dominated by large `unroll_for!`
+// loops, whose unrolled bodies are converted node by node.
+
+#include <string>
+
+#include "absl/strings/str_format.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+// Typechecks `program` once and converts it to IR on every iteration.
+static void ConvertRepeatedly(benchmark::State& state,
+                              const std::string& program) {
+  ImportData import_data = CreateImportDataForTest();
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "test.x", "test", &import_data).value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ConvertModuleToPackage(tm.module, &import_data, ConvertOptions())
+            .value());
+  }
+}
+
+static void BM_ConvertUnrolledLoop(benchmark::State& state) {
+  ConvertRepeatedly(state, absl::StrFormat(R"(
+fn main(x: u32) -> u32 {
+  unroll_for!(i, acc): (u32, u32) in u32:0..u32:%d {
+    let y = acc + i * x;
+    y ^ (y >> u32:3)
+  }(u32:0)
+})",
+                                           state.range(0)));
+}
+
+// As above but within a parametric function, so every node is converted under
+// a non-empty parametric environment.
+static void BM_ConvertParametricUnrolledLoop(benchmark::State& state) {
+  ConvertRepeatedly(state, absl::StrFormat(R"(
+fn f<N: u32, M: u32 = {N * u32:2}>(x: uN[N]) -> uN[M] {
+  unroll_for!(i, acc): (u32, uN[M]) in u32:0..u32:%d {
+    let y = acc + (x as uN[M]) * (i as uN[M]);
+    y ^ (y >> u32:3)
+  }(uN[M]:0)
+}
+
+fn main(x: u16) -> u32 { f(x) })",
+                                           state.range(0)));
+}
+
+BENCHMARK(BM_ConvertUnrolledLoop)->Arg(256)->Arg(4096);
+BENCHMARK(BM_ConvertParametricUnrolledLoop)->Arg(256)->Arg(4096);
+
+}  // namespace
+}  // namespace xls::dslx
@@ -18,11 +18,13 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
@@ -34,12 +36,15 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/ir_convert/conversion_info.h"
 #include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_conversion_cache.h"
+#include "xls/dslx/ir_convert/ir_conversion_cache.pb.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/ir_convert/ir_converter_options_flags.h"
 #include "xls/dslx/ir_convert/ir_converter_options_flags.pb.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
+#include "xls/ir/xls_ir_interface.pb.h"
 
 namespace xls::dslx {
 namespace {
@@ -125,25 +130,65 @@ absl::Status RealMain(absl::Span<const std::string_view> paths) {
            "input path to know where to resolve the entry function)";
   }
 
+  // The conversion is described by the input paths and the options which
+  // affect its result (i.e., not where the outputs are written).
+  std::optional<IrConversionCache> cache;
+  std::string invocation;
+  if (ir_converter_options.has_ir_cache_dir()) {
+    cache.emplace(ir_converter_options.ir_cache_dir());
+    IrConverterOptionsFlagsProto invocation_options = ir_converter_options;
+    invocation_options.clear_output_file();
+    invocation_options.clear_interface_proto_file();
+    invocation_options.clear_interface_textproto_file();
+    invocation_options.clear_ir_cache_dir();
+    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(
+        invocation_options, &invocation));
+    absl::StrAppend(&invocation, "paths: ", absl::StrJoin(paths, ":"), "\n");
+  }
+
+  std::optional<IrConversionCacheEntryProto> cached;
+  if (cache.has_value()) {
+    XLS_ASSIGN_OR_RETURN(cached, cache->Lookup(invocation));
+  }
+
   bool printed_error = false;
-  XLS_ASSIGN_OR_RETURN(PackageConversionData result,
-                       ConvertFilesToPackage(
-                           paths, dslx_stdlib_path, dslx_paths, convert_options,
-                           /*top=*/top,
-                           /*package_name=*/package_name, &printed_error));
+  std::string ir;
+  PackageInterfaceProto interface;
+  if (cached.has_value()) {
+    ir = std::move(*cached->mutable_ir());
+    interface = std::move(*cached->mutable_interface());
+  } else {
+    std::vector<std::filesystem::path> dependencies;
+    XLS_ASSIGN_OR_RETURN(
+        PackageConversionData result,
+        ConvertFilesToPackage(paths, dslx_stdlib_path, dslx_paths,
+                              convert_options,
+                              /*top=*/top,
+                              /*package_name=*/package_name, &printed_error,
+                              &dependencies));
+    ir = result.DumpIr();
+    interface = std::move(result.interface);
+    // Only successful conversions are cached, so a cache hit never hides an
+    // error.
+    if (cache.has_value() && !printed_error) {
+      XLS_RETURN_IF_ERROR(
+          cache->Store(invocation, dependencies, ir, interface));
+    }
+  }
+
   if (output_file) {
-    XLS_RETURN_IF_ERROR(SetFileContents(*output_file, result.DumpIr()));
+    XLS_RETURN_IF_ERROR(SetFileContents(*output_file, ir));
   } else {
-    std::cout << result.package->DumpIr();
+    std::cout << ir;
   }
   if (ir_converter_options.has_interface_proto_file()) {
     XLS_RETURN_IF_ERROR(
         SetFileContents(ir_converter_options.interface_proto_file(),
-                        result.interface.SerializeAsString()));
+                        interface.SerializeAsString()));
   }
   if (ir_converter_options.has_interface_textproto_file()) {
     std::string res;
-    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(result.interface, &res));
+    XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(interface, &res));
     XLS_RETURN_IF_ERROR(
         SetFileContents(ir_converter_options.interface_textproto_file(), res));
   }
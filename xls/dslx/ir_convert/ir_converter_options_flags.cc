@@ -67,6 +67,11 @@ ABSL_FLAG(std::optional<std::string>, ir_converter_options_proto, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, default_fifo_config, std::nullopt,
           "Textproto description of a default FifoConfigProto. If unspecified, "
           "no default FIFO config is specified and codegen may fail.");
+ABSL_FLAG(std::optional<std::string>, ir_cache_dir, std::nullopt,
+          "Directory of a cache of conversion results. When given, converting "
+          "files whose sources and transitive imports are unchanged since a "
+          "previous conversion with the same options reuses its result "
+          "instead of typechecking and converting again.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 ABSL_FLAG(std::optional<std::string>, ir_converter_options_used_textproto_file,
           std::nullopt,
@@ -103,6 +108,7 @@ absl::StatusOr<bool> SetOptionsFromFlags(IrConverterOptionsFlagsProto& proto) {
   POPULATE_FLAG(warnings_as_errors);
   POPULATE_OPTIONAL_FLAG(interface_proto_file);
   POPULATE_OPTIONAL_FLAG(interface_textproto_file);
+  POPULATE_OPTIONAL_FLAG(ir_cache_dir);
 
 #undef POPULATE_FLAG
 
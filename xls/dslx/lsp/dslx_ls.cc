@@ -15,13 +15,15 @@
 // Very simple language server for dslx that
 //  - keeps track of open files and updates them whenever they are
 //    changed in the editor (hidden under the hood).
-//  - On every change, attempts to parse and send back diagnostics
+//  - Once changes pause, attempts to parse and send back diagnostics
 //    on errors/warnings.
 //
 // Heavily commented below as this serves as a sample.
 
+#include <poll.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -31,6 +33,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_split.h"
@@ -52,6 +55,10 @@ ABSL_FLAG(std::string, dslx_path,
           getenv(kDslxPath) != nullptr ? getenv(kDslxPath) : "",
           "Additional paths to search for modules (colon delimited).");
 
+ABSL_FLAG(int64_t, diagnostics_debounce_ms, 200,
+          "Milliseconds without further edits to wait before parsing a changed "
+          "buffer and publishing its diagnostics. Zero parses on every edit.");
+
 namespace xls::dslx {
 namespace {
 
@@ -91,21 +98,58 @@ InitializeResult InitializeServer(const nlohmann::json& params) {
   };
 }
 
-// On text change: attempt to parse the buffer and emit diagnostics if needed.
-void TextChangeHandler(const std::string& file_uri,
-                       const EditTextBuffer& text_buffer,
-                       verible::lsp::JsonRpcDispatcher& dispatcher,
-                       LanguageServerAdapter& adapter) {
-  text_buffer.RequestContent([&](std::string_view file_content) {
+// Parses changed buffers and emits their diagnostics. Updates are held back
+// until edits pause (or a request needs the buffer), so that a burst of
+// keystrokes is parsed and typechecked only once.
+class PendingUpdates {
+ public:
+  PendingUpdates(JsonRpcDispatcher& dispatcher, LanguageServerAdapter& adapter,
+                 int64_t debounce_ms)
+      : dispatcher_(dispatcher), adapter_(adapter), debounce_ms_(debounce_ms) {}
+
+  // On text change: note the contents, to be parsed once edits pause.
+  void Add(const std::string& file_uri, const EditTextBuffer& text_buffer) {
+    text_buffer.RequestContent([&](std::string_view file_content) {
+      pending_[file_uri] = std::string{file_content};
+    });
+    if (debounce_ms_ == 0) {
+      Flush(file_uri);
+    }
+  }
+
+  // Parses the buffer for `file_uri`, if it has changed, and emits
+  // diagnostics.
+  void Flush(const std::string& file_uri) {
+    auto it = pending_.find(file_uri);
+    if (it == pending_.end()) {
+      return;
+    }
     // Note: this returns a status, but we don't need to surface it from here.
-    adapter.Update(file_uri, file_content).IgnoreError();
-  });
-  verible::lsp::PublishDiagnosticsParams params{
-      .uri = file_uri,
-      .diagnostics = adapter.GenerateParseDiagnostics(file_uri),
-  };
-  dispatcher.SendNotification("textDocument/publishDiagnostics", params);
-}
+    adapter_.Update(file_uri, it->second).IgnoreError();
+    pending_.erase(it);
+    verible::lsp::PublishDiagnosticsParams params{
+        .uri = file_uri,
+        .diagnostics = adapter_.GenerateParseDiagnostics(file_uri),
+    };
+    dispatcher_.SendNotification("textDocument/publishDiagnostics", params);
+  }
+
+  void FlushAll() {
+    while (!pending_.empty()) {
+      std::string file_uri = pending_.begin()->first;
+      Flush(file_uri);
+    }
+  }
+
+  bool empty() const { return pending_.empty(); }
+  int64_t debounce_ms() const { return debounce_ms_; }
+
+ private:
+  JsonRpcDispatcher& dispatcher_;
+  LanguageServerAdapter& adapter_;
+  int64_t debounce_ms_;
+  absl::flat_hash_map<std::string, std::string> pending_;
+};
 
 absl::Status RealMain() {
   const std::string stdlib_path = absl::GetFlag(FLAGS_stdlib_path);
@@ -154,6 +198,9 @@ absl::Status RealMain() {
                                  return nullptr;
                                });
 
+  PendingUpdates pending_updates(dispatcher, language_server_adapter,
+                                 absl::GetFlag(FLAGS_diagnostics_debounce_ms));
+
   // The buffer collection keeps track of all the buffers opened in the editor.
   // It registers multiple notification request handlers (for open, edit,
   // remove) on the dispatcher to keep an up-to-date copy of all open editor
@@ -168,12 +215,13 @@ absl::Status RealMain() {
         if (buffer == nullptr) {
           return;  // buffer got deleted. No interest.
         }
-        TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+        pending_updates.Add(uri, *buffer);
       });
 
   dispatcher.AddRequestHandler(
       "textDocument/documentSymbol",
       [&](const verible::lsp::DocumentSymbolParams& params) {
+        pending_updates.Flush(params.textDocument.uri);
         return language_server_adapter.GenerateDocumentSymbols(
             params.textDocument.uri);
       });
@@ -181,6 +229,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/definition",
       [&](const verible::lsp::DefinitionParams& params) {
+        pending_updates.Flush(params.textDocument.uri);
         auto values_or = language_server_adapter.FindDefinitions(
             params.textDocument.uri, params.position);
         if (values_or.ok()) {
@@ -194,6 +243,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/formatting",
       [&](const verible::lsp::DocumentFormattingParams& params) {
+        pending_updates.Flush(params.textDocument.uri);
         auto values_or =
             language_server_adapter.FormatDocument(params.textDocument.uri);
         if (values_or.ok()) {
@@ -207,6 +257,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/documentLink",
       [&](const verible::lsp::DocumentLinkParams& params) {
+        pending_updates.Flush(params.textDocument.uri);
         return language_server_adapter.ProvideImportLinks(
             params.textDocument.uri);
       });
@@ -214,6 +265,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/inlayHint",
       [&](const verible::lsp::InlayHintParams& params) {
+        pending_updates.Flush(params.textDocument.uri);
         auto inlay_hints_or = language_server_adapter.InlayHint(
             params.textDocument.uri, params.range);
         if (inlay_hints_or.ok()) {
@@ -225,8 +277,18 @@ absl::Status RealMain() {
       });
 
   // Main loop. Feeding the stream-splitter that then calls the dispatcher.
+  // While updates are pending, wait for input for at most the debounce time,
+  // and parse the changed buffers if none arrives.
   absl::Status status = absl::OkStatus();
   while (status.ok() && !shutdown_requested) {
+    if (!pending_updates.empty()) {
+      pollfd stdin_poll{.fd = STDIN_FILENO, .events = POLLIN, .revents = 0};
+      if (poll(&stdin_poll, 1,
+               static_cast<int>(pending_updates.debounce_ms())) == 0) {
+        pending_updates.FlushAll();
+        continue;
+      }
+    }
     status = stream_splitter.PullFrom([](char* buf, int size) -> int {  //
       return static_cast<int>(read(STDIN_FILENO, buf, size));
     });
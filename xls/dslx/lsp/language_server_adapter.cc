@@ -159,6 +159,9 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
 
   auto inserted = uri_parse_data_.emplace(file_uri, nullptr);
   std::unique_ptr<ParseData>& insert_value = inserted.first->second;
+  if (insert_value != nullptr && insert_value->contents == dslx_code) {
+    return insert_value->status();
+  }
 
   ImportData import_data =
       CreateImportData(stdlib_, dslx_paths_, kAllWarningsSet);
@@ -179,6 +182,7 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
     insert_value.reset(
         new ParseData{std::move(import_data), typechecked_module.status()});
   }
+  insert_value->contents = std::string{dslx_code};
 
   const absl::Duration duration = absl::Now() - start;
   if (duration > absl::Milliseconds(200)) {
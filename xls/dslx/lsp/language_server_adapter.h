@@ -51,7 +51,8 @@ class LanguageServerAdapter {
 
   // Note: this is parsing is triggered for every keystroke. Fine for now.
   // Successful and unsuccessful parses are memoized so that their status
-  // and can be queried.
+  // and can be queried; an update with the same contents as the memoized
+  // parse returns its status without parsing again.
   // Implementation note: since we currently do not react to buffer closed
   // events in the buffer change listener, we keep track of every file ever
   // opened and never delete.
@@ -101,6 +102,8 @@ class LanguageServerAdapter {
   struct ParseData {
     ImportData import_data;
     absl::StatusOr<TypecheckedModuleWithComments> tmc;
+    // The buffer contents this was parsed from.
+    std::string contents;
 
     bool ok() const { return tmc.ok(); }
     absl::Status status() const { return tmc.status(); }
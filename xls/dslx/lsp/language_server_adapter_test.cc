@@ -23,6 +23,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
 #include "xls/common/file/filesystem.h"
@@ -264,5 +265,27 @@ fn main() { imported::f() }
   EXPECT_TRUE(definition_location.range == kWantRange);
 }
 
+TEST(LanguageServerAdapterTest, UnchangedContentsAreNotParsedAgain) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory tempdir, TempDirectory::Create());
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath,
+                                /*dslx_paths=*/{tempdir.path()});
+  XLS_ASSERT_OK(
+      SetFileContents(tempdir.path() / "imported.x", "pub fn f() { () }"));
+
+  std::string importer_uri =
+      absl::StrFormat("file://%s/importer.x", tempdir.path());
+  const std::string_view kImporterContents = R"(import imported;
+
+fn main() { imported::f() }
+)";
+  XLS_ASSERT_OK(adapter.Update(importer_uri, kImporterContents));
+
+  // Breaking the import only shows up once the buffer itself changes.
+  XLS_ASSERT_OK(SetFileContents(tempdir.path() / "imported.x", "blah"));
+  XLS_EXPECT_OK(adapter.Update(importer_uri, kImporterContents));
+  EXPECT_FALSE(
+      adapter.Update(importer_uri, absl::StrCat(kImporterContents, "\n")).ok());
+}
+
 }  // namespace
 }  // namespace xls::dslx
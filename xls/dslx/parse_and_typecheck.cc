@@ -34,6 +34,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/warning_collector.h"
@@ -59,6 +60,10 @@ absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
                        ParseModule(text, path, module_name,
                                    import_data->file_table(), comments));
+  if (import_data->import_jobs() > 1) {
+    XLS_RETURN_IF_ERROR(ParseImportsConcurrently(*module, import_data,
+                                                 import_data->import_jobs()));
+  }
   return TypecheckModule(std::move(module), path, import_data);
 }
 
@@ -33,6 +33,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -233,11 +234,9 @@ absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> MakeRunner(
       std::move(packages), std::move(finish_chan_names), std::move(proc),
       std::move(func), import_data);
 }
-}  // namespace
 
-absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
-IrJitTestRunner::CreateTestRunner(ImportData* import_data, TypeInfo* type_info,
-                                  Module* module) const {
+absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> MakeJitRunner(
+    ImportData* import_data, TypeInfo* type_info, Module* module) {
   return MakeRunner(
       import_data, type_info, module,
       [](xls::Function* f,
@@ -250,6 +249,92 @@ IrJitTestRunner::CreateTestRunner(ImportData* import_data, TypeInfo* type_info,
       });
 }
 
+class TieredRunner : public AbstractParsedTestRunner {
+ public:
+  TieredRunner(ImportData* import_data, TypeInfo* type_info, Module* module,
+               int64_t tick_threshold)
+      : interpreter_(import_data, type_info, module),
+        import_data_(import_data),
+        type_info_(type_info),
+        module_(module),
+        tick_threshold_(tick_threshold) {}
+
+  absl::StatusOr<RunResult> RunTestProc(
+      std::string_view name,
+      const BytecodeInterpreterOptions& options) override {
+    // Hooks only work in the interpreter, and a proc whose whole budget is
+    // within the threshold would never move to the JIT.
+    if (options.post_fn_eval_hook() != nullptr ||
+        (options.max_ticks().has_value() &&
+         *options.max_ticks() <= tick_threshold_)) {
+      return interpreter_.RunTestProc(name, options);
+    }
+
+    std::vector<std::pair<Span, std::string>> traces;
+    BytecodeInterpreterOptions interpreter_options = options;
+    interpreter_options.max_ticks(tick_threshold_)
+        .trace_hook([&](const Span& span, std::string_view message) {
+          traces.push_back({span, std::string(message)});
+        });
+    XLS_ASSIGN_OR_RETURN(RunResult result,
+                         interpreter_.RunTestProc(name, interpreter_options));
+    if (!IsProcTickLimitError(result.result)) {
+      if (options.trace_hook() != nullptr) {
+        for (const auto& [span, message] : traces) {
+          options.trace_hook()(span, message);
+        }
+      }
+      return result;
+    }
+
+    VLOG(1) << "Test proc " << name << " still running after "
+            << tick_threshold_ << " ticks; moving it to the JIT";
+    XLS_ASSIGN_OR_RETURN(AbstractParsedTestRunner * jit, GetJitRunner());
+    return jit->RunTestProc(name, options);
+  }
+
+  absl::StatusOr<RunResult> RunTestFunction(
+      std::string_view name,
+      const BytecodeInterpreterOptions& options) override {
+    return interpreter_.RunTestFunction(name, options);
+  }
+
+ private:
+  // Converts the module's tests to IR the first time a proc needs the JIT.
+  // Tests may run concurrently, so conversion happens under a lock.
+  absl::StatusOr<AbstractParsedTestRunner*> GetJitRunner() {
+    absl::MutexLock lock(&mutex_);
+    if (jit_ == nullptr) {
+      XLS_ASSIGN_OR_RETURN(jit_,
+                           MakeJitRunner(import_data_, type_info_, module_));
+    }
+    return jit_.get();
+  }
+
+  DslxInterpreterParsedTestRunner interpreter_;
+  ImportData* import_data_;
+  TypeInfo* type_info_;
+  Module* module_;
+  int64_t tick_threshold_;
+
+  absl::Mutex mutex_;
+  std::unique_ptr<AbstractParsedTestRunner> jit_ ABSL_GUARDED_BY(mutex_);
+};
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
+IrJitTestRunner::CreateTestRunner(ImportData* import_data, TypeInfo* type_info,
+                                  Module* module) const {
+  return MakeJitRunner(import_data, type_info, module);
+}
+
+absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
+TieredTestRunner::CreateTestRunner(ImportData* import_data,
+                                   TypeInfo* type_info, Module* module) const {
+  return std::make_unique<TieredRunner>(import_data, type_info, module,
+                                        tick_threshold_);
+}
+
 absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
 IrInterpreterTestRunner::CreateTestRunner(ImportData* import_data,
                                           TypeInfo* type_info,
@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_RUN_ROUTINES_IR_TEST_RUNNER_H_
 #define XLS_DSLX_RUN_ROUTINES_IR_TEST_RUNNER_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "absl/status/statusor.h"
@@ -39,6 +40,27 @@ class IrJitTestRunner : public AbstractTestRunner {
       Module* module) const override;
 };
 
+// Runs tests in the DSLX interpreter, except for test procs which are still
+// running after `tick_threshold` ticks. Those are converted to IR and run
+// again from the start in the JIT, so short tests avoid the conversion and
+// compilation cost while long-running ones execute natively.
+//
+// Traces emitted by the interpreter before a proc moves to the JIT are
+// discarded, since the JIT run emits them again.
+class TieredTestRunner : public AbstractTestRunner {
+ public:
+  explicit TieredTestRunner(int64_t tick_threshold)
+      : tick_threshold_(tick_threshold) {}
+
+ protected:
+  absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> CreateTestRunner(
+      ImportData* import_data, TypeInfo* type_info,
+      Module* module) const override;
+
+ private:
+  int64_t tick_threshold_;
+};
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_RUN_ROUTINES_IR_TEST_RUNNER_H_
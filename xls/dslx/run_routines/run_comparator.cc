@@ -14,6 +14,7 @@
 
 #include "xls/dslx/run_routines/run_comparator.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -24,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -146,4 +148,21 @@ absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
   return jit->Run(ir_args);
 }
 
+absl::Status RunComparator::RunIrFunctionOnClone(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_args,
+    absl::Span<InterpreterResult<xls::Value>> results) {
+  std::unique_ptr<FunctionJit> jit;
+  {
+    absl::MutexLock lock(&jit_cache_mutex_);
+    XLS_ASSIGN_OR_RETURN(FunctionJit * cached,
+                         GetOrCompileJitFunction(ir_name, ir_function));
+    jit = cached->Clone();
+  }
+  for (int64_t i = 0; i < ir_args.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(results[i], jit->Run(ir_args[i]));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::dslx
@@ -19,10 +19,12 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
 #include "xls/dslx/frontend/ast.h"
@@ -63,6 +65,12 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Thread-safe: each call runs on its own clone of the cached JIT.
+  absl::Status RunIrFunctionOnClone(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_args,
+      absl::Span<InterpreterResult<xls::Value>> results) override;
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
@@ -78,6 +86,8 @@ class RunComparator : public AbstractRunComparator {
   XLS_FRIEND_TEST(RunRoutinesTest, NoSeedStillQuickChecks);
 
   absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
+  // Guards `jit_cache_` against concurrent RunIrFunctionOnClone calls.
+  absl::Mutex jit_cache_mutex_;
   CompareMode mode_;
 };
 
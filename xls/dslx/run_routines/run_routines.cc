@@ -17,6 +17,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <functional>
@@ -32,18 +33,22 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
@@ -82,11 +87,19 @@
 
 namespace xls::dslx {
 namespace {
+
+// Marks the error returned when a test proc exceeds its tick limit, see
+// IsProcTickLimitError().
+constexpr std::string_view kProcTickLimitPayloadUrl =
+    "xls.dslx.ProcTickLimitExceeded";
 // A few constants relating to the number of spaces to use in text formatting
 // our test-runner output.
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
+// Number of quickcheck samples evaluated by one task on one thread.
+constexpr int64_t kQuickCheckBlockSize = 1024;
+
 void HandleError(TestResultData& result, const absl::Status& status,
                  std::string_view test_name, const Pos& start_pos,
                  const absl::Time& start, const absl::Duration& duration,
@@ -130,11 +143,39 @@ void HandleError(TestResultData& result, const absl::Status& status,
             << "\n";
 };
 
+// Calls `f(i)` for each `i` in [0, count) on up to `jobs` threads, returning
+// once all of the calls have completed. Runs inline if `jobs` <= 1.
+void RunConcurrently(int64_t count, int64_t jobs,
+                     absl::FunctionRef<void(int64_t)> f) {
+  std::atomic<int64_t> next = 0;
+  auto worker = [&]() {
+    for (int64_t i = next++; i < count; i = next++) {
+      f(i);
+    }
+  };
+  int64_t thread_count = std::min(jobs, count);
+  if (thread_count <= 1) {
+    worker();
+    return;
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
 absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
                                  Module* module, TestFunction* tf,
                                  const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
+  // Each test uses its own bytecode cache so that tests sharing `import_data`
+  // may run concurrently.
+  BytecodeCache cache(import_data);
+  BytecodeInterpreterOptions test_options = options;
+  test_options.bytecode_cache(&cache);
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
@@ -142,15 +183,17 @@ absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
           BytecodeEmitterOptions{.format_preference =
                                      options.format_preference()}));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{},
-                                        options)
+                                        test_options)
       .status();
 }
 
 absl::Status RunDslxTestProc(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestProc* tp,
-                             const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
+                             const BytecodeInterpreterOptions& test_options) {
+  // As above, the test uses its own bytecode cache.
+  BytecodeCache cache(import_data);
+  BytecodeInterpreterOptions options = test_options;
+  options.bytecode_cache(&cache);
 
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
@@ -165,29 +208,43 @@ absl::Status RunDslxTestProc(ImportData* import_data, TypeInfo* type_info,
 
   std::shared_ptr<InterpValue::Channel> term_chan =
       terminator.GetChannelOrDie();
+  // The receive each proc was blocked on as of its last run, if any. Running a
+  // proc blocked on a channel that is still empty would just block again
+  // without executing anything, so such procs are skipped until a value is
+  // sent on the channel; in large networks most procs are blocked most ticks.
+  std::vector<std::optional<BlockedChannelInfo>> blocked_on(
+      proc_instances.size());
   int64_t tick_count = 0;
   while (term_chan->empty()) {
     bool progress_made = false;
     if (options.max_ticks().has_value() &&
         tick_count > options.max_ticks().value()) {
-      return absl::DeadlineExceededError(
+      absl::Status status = absl::DeadlineExceededError(
           absl::StrFormat("Exceeded limit of %d proc ticks before terminating",
                           options.max_ticks().value()));
+      status.SetPayload(kProcTickLimitPayloadUrl, absl::Cord());
+      return status;
     }
 
     std::vector<std::string> blocked_channels;
-    for (auto& p : proc_instances) {
-      XLS_ASSIGN_OR_RETURN(ProcRunResult run_result, p.Run());
-      if (run_result.execution_state == ProcExecutionState::kBlockedOnReceive) {
-        XLS_RET_CHECK(run_result.blocked_channel_info.has_value());
-        BlockedChannelInfo channel_info =
-            run_result.blocked_channel_info.value();
+    for (int64_t i = 0; i < proc_instances.size(); ++i) {
+      ProcInstance& p = proc_instances[i];
+      if (!blocked_on[i].has_value() || !blocked_on[i]->channel->empty()) {
+        XLS_ASSIGN_OR_RETURN(ProcRunResult run_result, p.Run());
+        blocked_on[i] = std::nullopt;
+        if (run_result.execution_state ==
+            ProcExecutionState::kBlockedOnReceive) {
+          XLS_RET_CHECK(run_result.blocked_channel_info.has_value());
+          blocked_on[i] = std::move(run_result.blocked_channel_info);
+        }
+        progress_made |= run_result.progress_made;
+      }
+      if (blocked_on[i].has_value()) {
         blocked_channels.push_back(absl::StrFormat(
             "%s: proc `%s` is blocked on receive on channel `%s`",
-            channel_info.span.ToString(import_data->file_table()),
-            p.proc()->identifier(), channel_info.name));
+            blocked_on[i]->span.ToString(import_data->file_table()),
+            p.proc()->identifier(), blocked_on[i]->name));
       }
-      progress_made |= run_result.progress_made;
     }
 
     if (!progress_made) {
@@ -230,6 +287,10 @@ absl::StatusOr<RunResult> DslxInterpreterParsedTestRunner::RunTestProc(
                                              entry_module_, tp, options)};
 }
 
+bool IsProcTickLimitError(const absl::Status& status) {
+  return status.GetPayload(kProcTickLimitPayloadUrl).has_value();
+}
+
 TestResultData::TestResultData(absl::Time start_time,
                                std::vector<test_xml::TestCase> test_cases)
     : start_time_(start_time), test_cases_(std::move(test_cases)) {}
@@ -295,36 +356,92 @@ static bool TestMatchesFilter(std::string_view test_name,
   return RE2::FullMatch(test_name, *test_filter);
 }
 
+// Returns the value of the quickcheck'd predicate from one evaluation.
+static absl::StatusOr<Value> GetQuickCheckResultValue(
+    InterpreterResult<Value> evaluation) {
+  // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+  // Assertion failures should work out, but we should consciously decide
+  // if/how we want to dump traces when running QuickChecks (always, for
+  // failures, flag-controlled, ...).
+  XLS_ASSIGN_OR_RETURN(Value result,
+                       InterpreterResultToStatusOrValue(std::move(evaluation)));
+
+  // In the case of an implicit token signature we get (token, bool) as the
+  // result of the quickcheck'd function, so we unbox the boolean here.
+  if (result.IsTuple()) {
+    result = result.elements()[1];
+    XLS_RET_CHECK(result.IsBits());
+  }
+  return result;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t jobs) {
   QuickCheckResults results;
   std::minstd_rand rng_engine(seed);
 
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-
-    // In the case of an implicit token signature we get (token, bool) as the
-    // result of the quickcheck'd function, so we unbox the boolean here.
-    if (result.IsTuple()) {
-      result = result.elements()[1];
-      XLS_RET_CHECK(result.IsBits());
+  const int64_t thread_count = std::max<int64_t>(jobs, 1);
+  while (results.arg_sets.size() < num_tests) {
+    // Arguments are generated sequentially, a round of blocks at a time, so
+    // they are the same however many jobs evaluate them.
+    const int64_t round_start = results.arg_sets.size();
+    const int64_t round_size =
+        std::min(num_tests - round_start, thread_count * kQuickCheckBlockSize);
+    for (int64_t i = 0; i < round_size; ++i) {
+      results.arg_sets.push_back(
+          RandomFunctionArguments(xls_function, rng_engine));
     }
+    absl::Span<const std::vector<Value>> round_args =
+        absl::MakeConstSpan(results.arg_sets).subspan(round_start);
+
+    const int64_t block_count =
+        (round_size + kQuickCheckBlockSize - 1) / kQuickCheckBlockSize;
+    std::vector<absl::Status> block_statuses(block_count);
+    std::vector<absl::StatusOr<Value>> values(round_size);
+    // Blocks after one containing a counterexample need not be evaluated.
+    std::atomic<int64_t> first_falsified_block = block_count;
+    RunConcurrently(block_count, thread_count, [&](int64_t block) {
+      if (block > first_falsified_block) {
+        return;
+      }
+      const int64_t start = block * kQuickCheckBlockSize;
+      const int64_t size = std::min(kQuickCheckBlockSize, round_size - start);
+      std::vector<InterpreterResult<Value>> evaluations(size);
+      block_statuses[block] = run_comparator->RunIrFunctionOnClone(
+          ir_name, xls_function, round_args.subspan(start, size),
+          absl::MakeSpan(evaluations));
+      if (!block_statuses[block].ok()) {
+        return;
+      }
+      for (int64_t i = 0; i < size; ++i) {
+        values[start + i] =
+            GetQuickCheckResultValue(std::move(evaluations[i]));
+        if (values[start + i].ok() && values[start + i]->IsAllZeros()) {
+          int64_t first = first_falsified_block;
+          while (block < first &&
+                 !first_falsified_block.compare_exchange_weak(first, block)) {
+          }
+          return;
+        }
+      }
+    });
 
-    results.results.push_back(result);
-
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+    // Report the results in order up to the first counterexample (or error).
+    for (int64_t i = 0; i < round_size; ++i) {
+      if (i % kQuickCheckBlockSize == 0) {
+        XLS_RETURN_IF_ERROR(block_statuses[i / kQuickCheckBlockSize]);
+      }
+      XLS_ASSIGN_OR_RETURN(Value result, std::move(values[i]));
+      results.results.push_back(result);
+
+      if (result.IsAllZeros()) {
+        // We were able to falsify the xls_function (predicate), bail out early
+        // and present this evidence.
+        results.arg_sets.resize(results.results.size());
+        return results;
+      }
     }
   }
 
@@ -366,7 +483,8 @@ static absl::StatusOr<QuickcheckIrFn> FindQuickcheckIrFn(Function* fn,
 
 static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                                   Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+                                  TypeInfo* type_info, int64_t seed,
+                                  int64_t jobs) {
   // Note: DSLX function.
   Function* fn = quickcheck->f();
 
@@ -376,7 +494,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
       DoQuickCheck(qc_fn.ir_function, qc_fn.ir_name, run_comparator, seed,
-                   quickcheck->GetTestCountOrDefault()));
+                   quickcheck->GetTestCountOrDefault(), jobs));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -411,7 +529,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
 static absl::Status RunQuickChecksIfJitEnabled(
     const RE2* test_filter, Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, TestResultData& result) {
+    std::optional<int64_t> seed, int64_t jobs, TestResultData& result) {
   if (run_comparator == nullptr) {
     // TODO(leary): 2024-02-08 Note that this skips /all/ the quickchecks so we
     // don't make an entry for it right now in the test XML.
@@ -452,7 +570,8 @@ static absl::Status RunQuickChecksIfJitEnabled(
     std::cerr << "[ RUN QUICKCHECK        ] " << quickcheck_name
               << " count: " << quickcheck->GetTestCountOrDefault() << "\n";
     const absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed,
+                      jobs);
     const absl::Duration duration = absl::Now() - test_case_start;
     if (!status.ok()) {
       HandleError(result, status, quickcheck_name, start_pos, test_case_start,
@@ -659,6 +778,7 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
 
   auto import_data = CreateImportData(options.dslx_stdlib_path,
                                       options.dslx_paths, options.warnings);
+  import_data.set_import_jobs(options.jobs);
   FileTable& file_table = import_data.file_table();
 
   absl::StatusOr<TypecheckedModule> tm_or =
@@ -696,6 +816,7 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   // with the interpreter.
   std::unique_ptr<Package> ir_package;
   PostFnEvalHook post_fn_eval_hook;
+  absl::Mutex comparator_mutex;
   if (options.run_comparator != nullptr) {
     absl::StatusOr<dslx::PackageConversionData> ir_package_or =
         ConvertModuleToPackage(entry_module, &import_data,
@@ -711,11 +832,15 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
                 "turning off comparison with `--compare=none`: ";
     }
     ir_package = std::move(ir_package_or).value().package;
-    post_fn_eval_hook = [&ir_package, &import_data, &options](
+    post_fn_eval_hook = [&ir_package, &import_data, &options,
+                         &comparator_mutex](
                             const Function* f,
                             absl::Span<const InterpValue> args,
                             const ParametricEnv* parametric_env,
                             const InterpValue& got) -> absl::Status {
+      // The comparator is not thread-safe, so concurrently running tests take
+      // turns comparing their results.
+      absl::MutexLock lock(&comparator_mutex);
       XLS_RET_CHECK(f != nullptr);
       std::optional<bool> requires_implicit_token =
           import_data.GetRootTypeInfoForNode(f)
@@ -731,56 +856,95 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<AbstractParsedTestRunner> runner,
       CreateTestRunner(&import_data, tm_or.value().type_info, entry_module));
-  // Run unit tests.
+
+  // Unit tests to run, in module order.
+  struct UnitTest {
+    std::string name;
+    ModuleMember* member;
+    Pos start_pos;
+    bool filtered;
+    absl::Time start;
+    absl::Time end;
+    absl::StatusOr<RunResult> out;
+  };
+  std::vector<UnitTest> tests;
   for (const std::string& test_name : entry_module->GetTestNames()) {
-    auto test_case_start = absl::Now();
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
-    const Pos start_pos = GetPos(*member);
+    tests.push_back(UnitTest{
+        .name = test_name,
+        .member = member,
+        .start_pos = GetPos(*member),
+        .filtered = !TestMatchesFilter(test_name, options.test_filter),
+        .start = absl::Now(),
+        .end = absl::Now(),
+        .out = absl::UnknownError("Test has not run")});
+  }
 
-    if (!TestMatchesFilter(test_name, options.test_filter)) {
-      auto test_case_end = absl::Now();
+  BytecodeInterpreterOptions interpreter_options;
+  interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
+      .trace_hook(absl::bind_front(InfoLoggingTraceHook, file_table))
+      .trace_channels(options.trace_channels)
+      .max_ticks(options.max_ticks)
+      .format_preference(options.format_preference);
+  auto run_test = [&](UnitTest& test) {
+    test.start = absl::Now();
+    if (std::holds_alternative<TestFunction*>(*test.member)) {
+      test.out = runner->RunTestFunction(test.name, interpreter_options);
+    } else {
+      test.out = runner->RunTestProc(test.name, interpreter_options);
+    }
+    test.end = absl::Now();
+  };
+
+  // When running concurrently all of the tests complete before any of them is
+  // reported, so the output and the test case order match sequential runs.
+  std::vector<UnitTest*> to_run;
+  for (UnitTest& test : tests) {
+    if (!test.filtered) {
+      to_run.push_back(&test);
+    }
+  }
+  const bool concurrent = options.jobs > 1 && to_run.size() > 1;
+  if (concurrent) {
+    RunConcurrently(to_run.size(), options.jobs,
+                    [&](int64_t i) { run_test(*to_run[i]); });
+  }
+
+  // Run (if not already run) and report the unit tests.
+  for (UnitTest& test : tests) {
+    const Pos& start_pos = test.start_pos;
+    if (test.filtered) {
       result.AddTestCase(test_xml::TestCase{
-          .name = test_name,
+          .name = test.name,
           .file = std::string{start_pos.GetFilename(file_table)},
           .line = start_pos.GetHumanLineno(),
           .status = test_xml::RunStatus::kRun,
           .result = test_xml::RunResult::kFiltered,
-          .time = test_case_end - test_case_start,
-          .timestamp = test_case_start});
+          .time = test.end - test.start,
+          .timestamp = test.start});
       continue;
     }
 
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << '\n';
-    RunResult out;
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(absl::bind_front(InfoLoggingTraceHook, file_table))
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks)
-        .format_preference(options.format_preference);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(
-          out, runner->RunTestFunction(test_name, interpreter_options));
-    } else {
-      XLS_ASSIGN_OR_RETURN(out,
-                           runner->RunTestProc(test_name, interpreter_options));
+    std::cerr << "[ RUN UNITTEST  ] " << test.name << '\n';
+    if (!concurrent) {
+      run_test(test);
     }
-    auto test_case_end = absl::Now();
+    XLS_ASSIGN_OR_RETURN(RunResult out, std::move(test.out));
 
     if (out.result.ok()) {
       // Add to the tracking data.
       result.AddTestCase(test_xml::TestCase{
-          .name = test_name,
+          .name = test.name,
           .file = std::string{start_pos.GetFilename(file_table)},
           .line = start_pos.GetHumanLineno(),
           .status = test_xml::RunStatus::kRun,
           .result = test_xml::RunResult::kCompleted,
-          .time = test_case_end - test_case_start,
-          .timestamp = test_case_start});
+          .time = test.end - test.start,
+          .timestamp = test.start});
       std::cerr << "[            OK ]" << '\n';
     } else {
-      HandleError(result, out.result, test_name, start_pos, test_case_start,
-                  test_case_end - test_case_start,
+      HandleError(result, out.result, test.name, start_pos, test.start,
+                  test.end - test.start,
                   /*is_quickcheck=*/false, file_table);
     }
   }
@@ -795,7 +959,8 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         options.test_filter, entry_module, tm_or.value().type_info,
-        options.run_comparator, ir_package.get(), options.seed, result));
+        options.run_comparator, ir_package.get(), options.seed, options.jobs,
+        result));
   }
 
   result.Finish(
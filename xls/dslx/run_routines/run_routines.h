@@ -80,6 +80,15 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // Runs the IR function once for each argument set in `ir_args`, storing the
+  // result of `ir_args[i]` in `results[i]`. `results` must be the same size as
+  // `ir_args`. Unlike the methods above, this may be called concurrently from
+  // multiple threads.
+  virtual absl::Status RunIrFunctionOnClone(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_args,
+      absl::Span<InterpreterResult<xls::Value>> results) = 0;
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -95,6 +104,10 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   jobs: Number of unit tests (`#[test]` and `#[test_proc]`) to execute
+//    concurrently, of threads evaluating the samples of each quickcheck, and
+//    of threads parsing the imports of the module. Results are reported in
+//    module order regardless.
 struct ParseAndTestOptions {
   std::filesystem::path dslx_stdlib_path;
   absl::Span<const std::filesystem::path> dslx_paths;
@@ -108,6 +121,7 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kDefaultWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t jobs = 1;
 };
 
 // As above, but a subset of the options required for the ParseAndProve()
@@ -227,6 +241,10 @@ struct RunResult {
   absl::Status result;
 };
 
+// Returns whether `status` is the error with which the DSLX interpreter stops
+// a test proc that exceeds BytecodeInterpreterOptions::max_ticks().
+bool IsProcTickLimitError(const absl::Status& status);
+
 class AbstractParsedTestRunner {
  public:
   virtual ~AbstractParsedTestRunner() = default;
@@ -288,9 +306,14 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// The arguments are evaluated in batches on up to `jobs` threads; the returned
+// vectors (which end at the first falsifying example, if any) do not depend on
+// the number of jobs.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t jobs = 1);
 
 }  // namespace xls::dslx
 
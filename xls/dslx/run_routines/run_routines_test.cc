@@ -27,6 +27,7 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/run_routines/ir_test_runner.h"
 #include "xls/dslx/run_routines/run_comparator.h"
 #include "xls/ir/bits.h"
@@ -414,6 +415,79 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// The samples evaluated, and the counterexample found, do not depend on the
+// number of jobs evaluating them.
+TEST(QuickcheckTest, ConcurrentJobsMatchSequentialResults) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn ne_seven(x: bits[12]) -> bits[1] {
+    literal.2: bits[12] = literal(value=7)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 20000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults sequential,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults concurrent,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                   /*jobs=*/4));
+
+  EXPECT_EQ(concurrent.arg_sets, sequential.arg_sets);
+  EXPECT_EQ(concurrent.results, sequential.results);
+  EXPECT_EQ(concurrent.arg_sets.size(), concurrent.results.size());
+}
+
+TEST(TieredTestRunnerTest, LongRunningProcsMoveToJit) {
+  constexpr std::string_view kProgram = R"(
+#[test_proc]
+proc short_proc {
+  terminator: chan<bool> out;
+  init { u32:0 }
+  config(terminator: chan<bool> out) { (terminator,) }
+  next(count: u32) {
+    let tok = send_if(join(), terminator, count == u32:2, true);
+    count + u32:1
+  }
+}
+
+#[test_proc]
+proc long_proc {
+  terminator: chan<bool> out;
+  init { u32:0 }
+  config(terminator: chan<bool> out) { (terminator,) }
+  next(count: u32) {
+    let tok = send_if(join(), terminator, count == u32:50, true);
+    count + u32:1
+  }
+}
+
+#[test_proc]
+proc long_failing_proc {
+  terminator: chan<bool> out;
+  init { u32:0 }
+  config(terminator: chan<bool> out) { (terminator,) }
+  next(count: u32) {
+    assert_eq(count < u32:40, true);
+    let tok = send_if(join(), terminator, count == u32:50, true);
+    count + u32:1
+  }
+}
+)";
+  TieredTestRunner runner(/*tick_threshold=*/10);
+  ParseAndTestOptions options;
+  options.max_ticks = 1000;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      runner.ParseAndTest(kProgram, "test_module", "test.x", options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 3, 0, 1));
+}
+
 TEST_P(ParseAndTestTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -562,6 +636,47 @@ TEST_P(ParseAndTestTest, TestFilterSelectBoth) {
   EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
 }
 
+TEST_P(ParseAndTestTest, ConcurrentJobsMatchSequentialResults) {
+  constexpr std::string_view kProgram = R"(
+fn double<N: u32>(x: uN[N]) -> uN[N] { x + x }
+
+#[test] fn test_u8() { assert_eq(double(u8:3), u8:6) }
+#[test] fn test_u16() { assert_eq(double(u16:300), u16:600) }
+#[test] fn test_bad() { assert_eq(double(u32:1), u32:3) }
+#[test] fn test_u32() { assert_eq(double(u32:7), u32:14) }
+#[test] fn test_worse() { assert_eq(double(u4:1), u4:0) }
+)";
+  ParseAndTestOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData sequential,
+                           ParseAndTest(kProgram, "test", "test.x", options));
+  EXPECT_THAT(sequential, IsTestResult(TestResult::kSomeFailed, 5, 0, 2));
+
+  options.jobs = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData concurrent,
+                           ParseAndTest(kProgram, "test", "test.x", options));
+  EXPECT_THAT(concurrent, IsTestResult(TestResult::kSomeFailed, 5, 0, 2));
+  EXPECT_EQ(concurrent.failures(), sequential.failures());
+}
+
+TEST_P(ParseAndTestTest, ConcurrentImportParsing) {
+  constexpr std::string_view kProgram = R"(
+import apfloat;
+import float32;
+import std;
+
+#[test] fn test_umax() { assert_eq(std::umax(u32:3, u32:5), u32:5) }
+#[test] fn test_zero() {
+  assert_eq(apfloat::is_zero_or_subnormal(float32::zero(u1:0)), true)
+}
+)";
+  ParseAndTestOptions options;
+  options.dslx_stdlib_path = kDefaultDslxStdlibPath;
+  options.jobs = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData result,
+                           ParseAndTest(kProgram, "test", "test.x", options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
+}
+
 // Exercises https://github.com/google/xls/issues/1368
 TEST_P(ParseAndTestTest, StructParametricFromProcParametric) {
   constexpr std::string_view kProgram = R"(
@@ -19,6 +19,7 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_add_jit_wrapper.h"
@@ -30,6 +31,9 @@ ABSL_FLAG(int, num_threads, 0,
           "Number of threads to use. Set to 0 to use all.");
 ABSL_FLAG(int64_t, num_samples, 1024 * 1024,
           "Number of random samples to test.");
+ABSL_FLAG(int64_t, batch_size, 4096,
+          "Number of consecutive samples each thread claims at a time. Set "
+          "to 0 to partition the samples across threads up front.");
 
 namespace xls {
 
@@ -51,17 +55,30 @@ static float ComputeActual(fp::Float32Add* jit_wrapper, Float2x32 input) {
   return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
 }
 
+// Computes FP addition of a block of inputs via DSLX & the JIT.
+static void ComputeActualBatch(fp::Float32Add* jit_wrapper,
+                               absl::Span<const Float2x32> inputs,
+                               absl::Span<float> results) {
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    results[i] = ComputeActual(jit_wrapper, inputs[i]);
+  }
+}
+
 static std::unique_ptr<fp::Float32Add> CreateJit() {
   return fp::Float32Add::Create().value();
 }
 
-static absl::Status RealMain(uint64_t num_samples, int num_threads) {
+static absl::Status RealMain(uint64_t num_samples, int num_threads,
+                             int64_t batch_size) {
   TestbenchBuilder<Float2x32, float, fp::Float32Add> builder(
       ComputeExpected, ComputeActual, CreateJit);
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
+  if (batch_size != 0) {
+    builder.SetComputeActualBatchFn(ComputeActualBatch, batch_size);
+  }
   return builder.Build().Run();
 }
 
@@ -70,5 +87,6 @@ static absl::Status RealMain(uint64_t num_samples, int num_threads) {
 int main(int argc, char** argv) {
   xls::InitXls(argv[0], argc, argv);
   return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_num_samples),
-                                       absl::GetFlag(FLAGS_num_threads)));
+                                       absl::GetFlag(FLAGS_num_threads),
+                                       absl::GetFlag(FLAGS_batch_size)));
 }
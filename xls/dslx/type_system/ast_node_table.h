@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPE_SYSTEM_AST_NODE_TABLE_H_
+#define XLS_DSLX_TYPE_SYSTEM_AST_NODE_TABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "xls/dslx/frontend/ast_node.h"
+
+namespace xls::dslx {
+
+// Mapping from the AST nodes of a single module to values of type `V`, indexed
+// by node ID (see `AstNode::id()`).
+//
+// Nodes get sequential IDs in parse order, so the nodes a type information
+// object has entries for -- the whole module for a root type info, a function
+// body for a parametric instantiation -- mostly occupy a contiguous range of
+// IDs. That range is kept as a flat array, so lookups are an index rather than
+// a hash probe. Entries whose IDs are far from the rest (e.g. for nodes created
+// after parsing, like the expansions of `unroll_for!`) would make the array
+// mostly holes, and are kept in a hash map instead.
+template <typename V>
+class AstNodeTable {
+ public:
+  // Returns the value for `node`, or nullptr if there is none.
+  const V* Find(const AstNode* node) const {
+    return const_cast<AstNodeTable*>(this)->Find(node);
+  }
+  V* Find(const AstNode* node) {
+    int64_t id = node->id();
+    if (InDenseRange(id)) {
+      Slot& slot = dense_[id - base_id_];
+      return slot.node == nullptr ? nullptr : &slot.value;
+    }
+    if (sparse_.empty()) {
+      return nullptr;
+    }
+    auto it = sparse_.find(id);
+    return it == sparse_.end() ? nullptr : &it->second.value;
+  }
+
+  bool contains(const AstNode* node) const { return Find(node) != nullptr; }
+
+  void InsertOrAssign(const AstNode* node, V value) {
+    int64_t id = node->id();
+    if (!InDenseRange(id) && !GrowDenseRange(id)) {
+      auto [it, inserted] =
+          sparse_.insert_or_assign(id, Slot{node, std::move(value)});
+      size_ += inserted ? 1 : 0;
+      return;
+    }
+    Slot& slot = dense_[id - base_id_];
+    size_ += slot.node == nullptr ? 1 : 0;
+    slot = Slot{node, std::move(value)};
+  }
+
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Calls `f` on every entry, in node ID order for the dense range.
+  void ForEach(absl::FunctionRef<void(const AstNode*, const V&)> f) const {
+    for (const Slot& slot : dense_) {
+      if (slot.node != nullptr) {
+        f(slot.node, slot.value);
+      }
+    }
+    for (const auto& [id, slot] : sparse_) {
+      f(slot.node, slot.value);
+    }
+  }
+
+ private:
+  struct Slot {
+    const AstNode* node = nullptr;
+    V value{};
+  };
+
+  // Slack below which the dense range may always grow, so that small tables
+  // do not bother with the hash map.
+  static constexpr int64_t kMinDenseSpan = 64;
+
+  bool InDenseRange(int64_t id) const {
+    return id >= base_id_ &&
+           id < base_id_ + static_cast<int64_t>(dense_.size());
+  }
+
+  // Grows the dense range to cover `id` if it stays at least half full (or
+  // small), leaving room to grow further in the same direction. Returns whether
+  // it did.
+  bool GrowDenseRange(int64_t id) {
+    if (id < 0) {
+      return false;
+    }
+    if (dense_.empty()) {
+      dense_.resize(1);
+      base_id_ = id;
+      return true;
+    }
+    int64_t limit = base_id_ + static_cast<int64_t>(dense_.size());
+    int64_t new_base = std::min(base_id_, id);
+    int64_t new_limit = std::max(limit, id + 1);
+    if (new_limit - new_base > 2 * (size_ + 1) + kMinDenseSpan) {
+      return false;
+    }
+    // Leave as much slack as the range already spans on the side it grew, so
+    // growing one ID at a time is amortized constant.
+    int64_t span = limit - base_id_;
+    if (new_base < base_id_) {
+      new_base = std::max(int64_t{0}, std::min(new_base, base_id_ - span));
+    } else {
+      new_limit = std::max(new_limit, limit + span);
+    }
+    std::vector<Slot> grown(new_limit - new_base);
+    std::move(dense_.begin(), dense_.end(),
+              grown.begin() + (base_id_ - new_base));
+    dense_ = std::move(grown);
+    base_id_ = new_base;
+    // Entries now covered by the dense range must only be found there.
+    for (auto it = sparse_.begin(); it != sparse_.end();) {
+      if (InDenseRange(it->first)) {
+        dense_[it->first - base_id_] = std::move(it->second);
+        sparse_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    return true;
+  }
+
+  int64_t base_id_ = 0;
+  std::vector<Slot> dense_;
+  absl::flat_hash_map<int64_t, Slot> sparse_;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_SYSTEM_AST_NODE_TABLE_H_
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_system/ast_node_table.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/pos.h"
+
+namespace xls::dslx {
+namespace {
+
+class AstNodeTableTest : public ::testing::Test {
+ protected:
+  AstNodeTableTest() : module_("test", /*fs_path=*/std::nullopt, file_table_) {
+    for (int64_t i = 0; i < 1000; ++i) {
+      nodes_.push_back(module_.Make<NameDef>(
+          Span(), absl::StrCat("x", i), /*definer=*/nullptr));
+    }
+  }
+
+  FileTable file_table_;
+  Module module_;
+  std::vector<NameDef*> nodes_;
+};
+
+TEST_F(AstNodeTableTest, IdsAreSequential) {
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    EXPECT_EQ(nodes_[i]->id(), i);
+  }
+  EXPECT_EQ(module_.id(), -1);
+}
+
+TEST_F(AstNodeTableTest, InsertInReverseOrder) {
+  AstNodeTable<int64_t> table;
+  for (int64_t i = nodes_.size() - 1; i >= 0; --i) {
+    table.InsertOrAssign(nodes_[i], i);
+  }
+  EXPECT_EQ(table.size(), nodes_.size());
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    ASSERT_NE(table.Find(nodes_[i]), nullptr);
+    EXPECT_EQ(*table.Find(nodes_[i]), i);
+  }
+  EXPECT_EQ(table.Find(&module_), nullptr);
+}
+
+TEST_F(AstNodeTableTest, FarApartEntriesThenFill) {
+  AstNodeTable<int64_t> table;
+  table.InsertOrAssign(nodes_.front(), 0);
+  table.InsertOrAssign(nodes_.back(), 1);
+  table.InsertOrAssign(&module_, 2);
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_FALSE(table.contains(nodes_[500]));
+
+  // Filling in the gap eventually covers the far entry with the dense range,
+  // which must neither lose nor duplicate it.
+  for (int64_t i = 1; i < nodes_.size() - 1; ++i) {
+    table.InsertOrAssign(nodes_[i], 10);
+  }
+  table.InsertOrAssign(nodes_.back(), 3);
+  EXPECT_EQ(table.size(), nodes_.size() + 1);
+  EXPECT_EQ(*table.Find(nodes_.front()), 0);
+  EXPECT_EQ(*table.Find(nodes_.back()), 3);
+  EXPECT_EQ(*table.Find(&module_), 2);
+
+  int64_t count = 0;
+  table.ForEach([&](const AstNode*, const int64_t&) { ++count; });
+  EXPECT_EQ(count, table.size());
+}
+
+}  // namespace
+}  // namespace xls::dslx
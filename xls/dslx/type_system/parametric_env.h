@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/ir/bits.h"
 
 namespace xls::dslx {
 
@@ -73,7 +74,15 @@ class ParametricEnv {
   template <typename H>
   friend H AbslHashValue(H h, const ParametricEnv& self) {
     for (const ParametricEnvItem& sb : self.bindings_) {
-      h = H::combine(std::move(h), sb.identifier, sb.value.ToString());
+      h = H::combine(std::move(h), sb.identifier);
+      // Bindings are almost always bits-valued, so we hash those bits directly
+      // instead of formatting the value. Values that are equal have equal bits,
+      // so this is consistent with `operator==`.
+      if (sb.value.HasBits()) {
+        h = H::combine(std::move(h), sb.value.GetBitsOrDie());
+      } else {
+        h = H::combine(std::move(h), sb.value.ToString());
+      }
     }
     return h;
   }
@@ -17,6 +17,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -127,7 +128,7 @@ absl::Status InvocationData::ValidateEnvForCaller(
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
   // Note: private constructor so not using make_unique.
-  type_infos_.push_back(absl::WrapUnique(new TypeInfo(module, parent)));
+  type_infos_.push_back(absl::WrapUnique(new TypeInfo(this, module, parent)));
   TypeInfo* result = type_infos_.back().get();
   if (parent == nullptr) {
     // Check we only have a single nullptr-parent TypeInfo for a given module.
@@ -160,6 +161,59 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   return it->second;
 }
 
+std::optional<TypeInfo*> TypeInfoOwner::GetCachedInstantiation(
+    const Function* f, const ParametricEnv& env) {
+  auto it = instantiations_.find(std::make_pair(f, env));
+  if (it == instantiations_.end()) {
+    ++instantiation_cache_stats_.misses;
+    return std::nullopt;
+  }
+  ++instantiation_cache_stats_.hits;
+  VLOG(5) << "Reusing derived type info " << it->second << " for "
+          << f->identifier() << " with env: " << env;
+  return it->second;
+}
+
+void TypeInfoOwner::NoteCachedInstantiation(const Function* f,
+                                            const ParametricEnv& env,
+                                            TypeInfo* derived_type_info) {
+  instantiations_.emplace(std::make_pair(f, env), derived_type_info);
+}
+
+const CachedConstexpr* TypeInfoOwner::GetCachedConstexpr(
+    const Expr* expr, const ParametricEnv& env) {
+  auto it = constexprs_.find(std::make_pair(expr, env));
+  if (it == constexprs_.end()) {
+    ++constexpr_cache_stats_.misses;
+    return nullptr;
+  }
+  ++constexpr_cache_stats_.hits;
+  VLOG(5) << "Reusing constexpr value for `" << expr->ToString()
+          << "` with env: " << env;
+  return &it->second;
+}
+
+void TypeInfoOwner::NoteCachedConstexpr(const Expr* expr,
+                                        const ParametricEnv& env,
+                                        CachedConstexpr result) {
+  constexprs_.emplace(std::make_pair(expr, env), std::move(result));
+}
+
+Type* TypeInfoOwner::InternType(const Type& type) {
+  std::vector<std::unique_ptr<Type>>& bucket = interned_types_[type.ToString()];
+  // Type equality is equivalence, which holds across some kinds of types (e.g.
+  // `uN[N]` and `xN[false][N]`), so the kinds must match as well.
+  for (const std::unique_ptr<Type>& interned : bucket) {
+    Type& candidate = *interned;
+    if (typeid(candidate) == typeid(type) && candidate == type) {
+      return &candidate;
+    }
+  }
+  bucket.push_back(type.CloneToUnique());
+  ++interned_type_count_;
+  return bucket.back().get();
+}
+
 // -- class TypeInfo
 
 void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
@@ -181,7 +235,7 @@ void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
   //   }
   // }
 
-  const_exprs_.insert_or_assign(const_expr, std::move(value));
+  const_exprs_.InsertOrAssign(const_expr, std::move(value));
 }
 
 absl::StatusOr<InterpValue> TypeInfo::GetConstExpr(
@@ -190,8 +244,9 @@ absl::StatusOr<InterpValue> TypeInfo::GetConstExpr(
       << const_expr->owner()->name() << " vs " << module_->name()
       << " node: " << const_expr->ToString();
 
-  if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
-    return it->second.value();
+  if (const std::optional<InterpValue>* value = const_exprs_.Find(const_expr);
+      value != nullptr) {
+    return value->value();
   }
 
   if (parent_ != nullptr) {
@@ -213,8 +268,9 @@ std::optional<InterpValue> TypeInfo::GetConstExprOption(
       << const_expr->owner()->name() << " vs " << module_->name()
       << " node: " << const_expr->ToString();
 
-  if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
-    return it->second;
+  if (const std::optional<InterpValue>* value = const_exprs_.Find(const_expr);
+      value != nullptr) {
+    return *value;
   }
 
   if (parent_ != nullptr) {
@@ -228,8 +284,9 @@ std::optional<InterpValue> TypeInfo::GetConstExprOption(
 }
 
 bool TypeInfo::IsKnownConstExpr(const AstNode* node) const {
-  if (const_exprs_.contains(node)) {
-    return const_exprs_.at(node).has_value();
+  if (const std::optional<InterpValue>* value = const_exprs_.Find(node);
+      value != nullptr) {
+    return value->has_value();
   }
 
   if (parent_ != nullptr) {
@@ -240,8 +297,9 @@ bool TypeInfo::IsKnownConstExpr(const AstNode* node) const {
 }
 
 bool TypeInfo::IsKnownNonConstExpr(const AstNode* node) const {
-  if (const_exprs_.contains(node)) {
-    return !const_exprs_.at(node).has_value();
+  if (const std::optional<InterpValue>* value = const_exprs_.Find(node);
+      value != nullptr) {
+    return !value->has_value();
   }
 
   if (parent_ != nullptr) {
@@ -375,9 +433,8 @@ std::optional<Type*> TypeInfo::GetItem(const AstNode* key) const {
       "attempted to get type information for AST node: `%s`; but it is from "
       "module `%s` and type information is for module `%s`",
       key->ToString(), key->owner()->name(), module_->name());
-  auto it = dict_.find(key);
-  if (it != dict_.end()) {
-    return it->second.get();
+  if (Type* const* type = dict_.Find(key); type != nullptr) {
+    return *type;
   }
   if (parent_ != nullptr) {
     return parent_->GetItem(key);
@@ -622,8 +679,8 @@ std::optional<TypeInfo*> TypeInfo::GetImportedTypeInfo(Module* m) {
   return std::nullopt;
 }
 
-TypeInfo::TypeInfo(Module* module, TypeInfo* parent)
-    : module_(module), parent_(parent) {
+TypeInfo::TypeInfo(TypeInfoOwner* owner, Module* module, TypeInfo* parent)
+    : owner_(owner), module_(module), parent_(parent) {
   VLOG(6) << "Created type info for module \"" << module_->name() << "\" @ "
           << this << " parent " << parent << " root " << GetRoot();
 }
@@ -21,10 +21,12 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -33,6 +35,7 @@
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/ast_node_table.h"
 #include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type.h"
 
@@ -116,6 +119,30 @@ struct InvocationData {
   absl::flat_hash_map<ParametricEnv, InvocationCalleeData> env_to_callee_data_;
 };
 
+// Counts of how often the derived type information for a parametric
+// instantiation was reused vs. deduced from scratch, see
+// `TypeInfoOwner::GetCachedInstantiation()`.
+struct InstantiationCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
+// The memoized result of interpreting a constexpr expression, see
+// `TypeInfoOwner::GetCachedConstexpr()`.
+struct CachedConstexpr {
+  InterpValue value;
+  // Spans of operations that rolled over during the interpretation, so that
+  // the corresponding warnings can be reported again when the result is reused.
+  std::vector<Span> rollovers;
+};
+
+// Counts of how often a constexpr interpretation result was reused vs.
+// interpreted from scratch, see `TypeInfoOwner::GetCachedConstexpr()`.
+struct ConstexprCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
 // Owns "type information" objects created during the type checking process.
 //
 // In the process of type checking we may instantiate "sub type-infos" for
@@ -136,6 +163,53 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Returns the derived type information noted for the body of `f` when
+  // instantiated with parametric environment `env`, if there is one. The body
+  // types depend only on the environment, so invocations that bind the same
+  // environment can share a single derived type information.
+  //
+  // Every lookup counts as a hit or a miss in `instantiation_cache_stats()`.
+  std::optional<TypeInfo*> GetCachedInstantiation(const Function* f,
+                                                  const ParametricEnv& env);
+
+  // Notes `derived_type_info` as the result of typechecking the body of `f`
+  // with parametric environment `env`.
+  void NoteCachedInstantiation(const Function* f, const ParametricEnv& env,
+                               TypeInfo* derived_type_info);
+
+  const InstantiationCacheStats& instantiation_cache_stats() const {
+    return instantiation_cache_stats_;
+  }
+
+  // Returns the result noted for interpreting `expr` as a constexpr under
+  // parametric environment `env`, or nullptr if there is none. The result of
+  // interpreting an expression depends only on the environment, so derived
+  // type information objects that bind the same environment (e.g. for procs or
+  // for invocations typechecked in different contexts) can share it rather
+  // than re-running the bytecode interpreter, which is costly for e.g. large
+  // constant tables.
+  //
+  // Every lookup counts as a hit or a miss in `constexpr_cache_stats()`.
+  const CachedConstexpr* GetCachedConstexpr(const Expr* expr,
+                                            const ParametricEnv& env);
+
+  // Notes `result` as the result of interpreting `expr` under parametric
+  // environment `env`.
+  void NoteCachedConstexpr(const Expr* expr, const ParametricEnv& env,
+                           CachedConstexpr result);
+
+  const ConstexprCacheStats& constexpr_cache_stats() const {
+    return constexpr_cache_stats_;
+  }
+
+  // Returns the canonical copy of `type` owned by this object. Most AST nodes
+  // in a program have one of a few types (e.g. `u32`, or a handful of struct
+  // types), so type information objects share these copies instead of owning
+  // a clone per node.
+  Type* InternType(const Type& type);
+
+  int64_t interned_type_count() const { return interned_type_count_; }
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -145,6 +219,25 @@ class TypeInfoOwner {
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
   // these.
   std::vector<std::unique_ptr<TypeInfo>> type_infos_;
+
+  // Derived type information by the instantiated function and its parametric
+  // environment, see `GetCachedInstantiation()`.
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      instantiations_;
+  InstantiationCacheStats instantiation_cache_stats_;
+
+  // Constexpr interpretation results by expression and parametric environment,
+  // see `GetCachedConstexpr()`.
+  absl::flat_hash_map<std::pair<const Expr*, ParametricEnv>, CachedConstexpr>
+      constexprs_;
+  ConstexprCacheStats constexpr_cache_stats_;
+
+  // Interned types by their string representation, see `InternType()`. Types
+  // with the same string may still differ (e.g. same-named structs from
+  // different modules), so each bucket holds the distinct ones.
+  absl::flat_hash_map<std::string, std::vector<std::unique_ptr<Type>>>
+      interned_types_;
+  int64_t interned_type_count_ = 0;
 };
 
 class TypeInfo {
@@ -209,7 +302,7 @@ class TypeInfo {
   // Sets the type associated with the given AST node.
   void SetItem(const AstNode* key, const Type& value) {
     CHECK_EQ(key->owner(), module_);
-    dict_[key] = value.CloneToUnique();
+    dict_.InsertOrAssign(key, owner_->InternType(value));
   }
 
   // Attempts to resolve AST node 'key' in the node-to-type dictionary.
@@ -324,11 +417,13 @@ class TypeInfo {
     return GetRoot()->invocations();
   }
 
-  // Returns a reference to the underlying mapping that associates an AST node
-  // with its deduced type.
-  const absl::flat_hash_map<const AstNode*, std::unique_ptr<Type>>& dict()
-      const {
-    return dict_;
+  // Calls `f` with every AST node that has a deduced type in this (and not a
+  // parent) type information object, and that type.
+  void ForEachItem(
+      absl::FunctionRef<void(const AstNode*, const Type&)> f) const {
+    dict_.ForEach([&](const AstNode* node, Type* const& type) {
+      f(node, *type);
+    });
   }
 
   const FileTable& file_table() const;
@@ -344,12 +439,14 @@ class TypeInfo {
   }
 
   // Args:
+  //  owner: The owner of this object, which also owns the (interned) types it
+  //    refers to.
   //  module: The module that owns the AST nodes referenced in the (member)
   //    maps.
   //  parent: Type information that should be queried from the same scope (i.e.
   //    if an AST node is not resolved in the local member maps, the lookup is
   //    then performed in the parent, and so on transitively).
-  explicit TypeInfo(Module* module, TypeInfo* parent = nullptr);
+  TypeInfo(TypeInfoOwner* owner, Module* module, TypeInfo* parent = nullptr);
 
   // Traverses to the 'root' (AKA 'most parent') TypeInfo. This is a place to
   // stash context-free information (e.g. that is found in a parametric
@@ -370,17 +467,18 @@ class TypeInfo {
   // dervied type info for e.g. a parametric instantiation context).
   bool IsRoot() const { return this == GetRoot(); }
 
+  TypeInfoOwner* owner_;
   Module* module_;
 
   // Node to type mapping -- this is present on "derived" type info (i.e. for
   // instantiated parametric type info) as well as the root type information for
-  // a module.
-  absl::flat_hash_map<const AstNode*, std::unique_ptr<Type>> dict_;
+  // a module. The types are interned in `owner_`.
+  AstNodeTable<Type*> dict_;
 
   // Node to constexpr-value mapping -- this is also present on "derived" type
   // info as constexprs take on different values in different parametric
   // instantiation contexts.
-  absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
+  AstNodeTable<std::optional<InterpValue>> const_exprs_;
 
   // Unrolled versions of `unroll_for!` loops.
   absl::flat_hash_map<const UnrollFor*,
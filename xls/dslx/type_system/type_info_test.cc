@@ -14,8 +14,10 @@
 
 #include "xls/dslx/type_system/type_info.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <variant>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -88,5 +90,64 @@ fn main() -> u32 {
                                  "present in parametric keys: {}")));
 }
 
+TEST(TypeInfoTest, InstantiationsWithSameEnvShareDerivedTypeInfo) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn p<X: u32, Y: u32>() -> u32 {
+  X+Y
+}
+
+fn main() -> u32 {
+  let a = p<u32:2, u32:3>();
+  let b = p<u32:2, u32:3>();
+  let c = p<u32:1, u32:1>();
+  a + b + c
+})",
+                                             "test.x", "test", &import_data));
+
+  Function* main = tm.module->GetFunctionByName().at("main");
+  auto get_invocation_type_info = [&](int64_t index) {
+    const Let* let =
+        std::get<Let*>(main->body()->statements().at(index)->wrapped());
+    const Invocation* invocation = down_cast<const Invocation*>(let->rhs());
+    return tm.type_info->GetInvocationTypeInfo(invocation, ParametricEnv());
+  };
+  std::optional<TypeInfo*> a = get_invocation_type_info(0);
+  std::optional<TypeInfo*> b = get_invocation_type_info(1);
+  std::optional<TypeInfo*> c = get_invocation_type_info(2);
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  ASSERT_TRUE(c.has_value());
+  EXPECT_EQ(a.value(), b.value());
+  EXPECT_NE(a.value(), c.value());
+
+  const InstantiationCacheStats& stats =
+      import_data.type_info_owner().instantiation_cache_stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+}
+
+TEST(TypeInfoTest, EqualTypesAreInterned) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn main(x: u32, y: u32, z: u8) -> u32 {
+  x + y + (z as u32)
+})",
+                                             "test.x", "test", &import_data));
+
+  Function* main = tm.module->GetFunctionByName().at("main");
+  XLS_ASSERT_OK_AND_ASSIGN(Type * x, tm.type_info->GetItemOrError(
+                                         main->params().at(0)));
+  XLS_ASSERT_OK_AND_ASSIGN(Type * y, tm.type_info->GetItemOrError(
+                                         main->params().at(1)));
+  XLS_ASSERT_OK_AND_ASSIGN(Type * z, tm.type_info->GetItemOrError(
+                                         main->params().at(2)));
+  EXPECT_EQ(x, y);
+  EXPECT_NE(x, z);
+  EXPECT_EQ(x->ToString(), "uN[32]");
+}
+
 }  // namespace
 }  // namespace xls::dslx
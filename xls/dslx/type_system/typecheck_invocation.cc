@@ -423,9 +423,28 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn.name_def(), instantiated_ft);
 
+  // A function body instantiated with an environment we've already checked
+  // deduces to the same types, so we reuse that derived type info instead of
+  // typechecking the body again. Procs are excluded as every instantiation
+  // needs its own constexpr values for its members (see below), as are
+  // invocations with constexpr arguments.
+  TypeInfo* const original_ti = parent_ctx->type_info();
+  const bool cacheable =
+      !callee_fn.proc().has_value() && constexpr_env.empty();
+  if (cacheable) {
+    std::optional<TypeInfo*> cached =
+        ctx->type_info_owner().GetCachedInstantiation(
+            &callee_fn, callee_tab.parametric_env);
+    if (cached.has_value()) {
+      XLS_RETURN_IF_ERROR(original_ti->AddInvocationTypeInfo(
+          *invocation, caller, caller_parametric_env,
+          callee_tab.parametric_env, cached.value()));
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* const original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(FnStackEntry::Make(
       callee_fn, callee_tab.parametric_env, invocation,
       callee_fn.proc().has_value() ? WithinProc::kYes : WithinProc::kNo));
@@ -519,6 +538,10 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo(derived_type_info));
   ctx->PopFnStackEntry();
+  if (cacheable) {
+    ctx->type_info_owner().NoteCachedInstantiation(
+        &callee_fn, callee_tab.parametric_env, derived_type_info);
+  }
 
   // Implementation note: though we could have all functions have
   // NoteRequiresImplicitToken() be false unless otherwise noted, this helps
@@ -17,16 +17,24 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/base/no_destructor.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/estimators/estimate_cache.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 
@@ -37,6 +45,92 @@ absl::StatusOr<double> AreaEstimator::GetRegisterAreaInSquareMicrons(
   return one_bit_register_area * static_cast<double>(register_width);
 }
 
+absl::StatusOr<std::vector<double>>
+AreaEstimator::GetFunctionBaseAreasInSquareMicrons(
+    absl::Span<FunctionBase* const> fs, int64_t thread_count) const {
+  std::vector<Node*> nodes;
+  std::vector<int64_t> node_counts;
+  node_counts.reserve(fs.size());
+  for (FunctionBase* f : fs) {
+    nodes.insert(nodes.end(), f->nodes().begin(), f->nodes().end());
+    node_counts.push_back(f->node_count());
+  }
+
+  // Estimates nodes [begin, end) into `node_areas`.
+  std::vector<double> node_areas(nodes.size());
+  auto estimate_range = [&](int64_t begin, int64_t end) -> absl::Status {
+    for (int64_t i = begin; i < end; ++i) {
+      XLS_ASSIGN_OR_RETURN(node_areas[i],
+                           GetOperationAreaInSquareMicrons(nodes[i]));
+    }
+    return absl::OkStatus();
+  };
+  thread_count = std::min<int64_t>(thread_count, nodes.size());
+  if (thread_count <= 1) {
+    XLS_RETURN_IF_ERROR(estimate_range(0, nodes.size()));
+  } else {
+    int64_t chunk_size = CeilOfRatio<int64_t>(nodes.size(), thread_count);
+    std::vector<absl::Status> statuses(thread_count);
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      int64_t begin = std::min<int64_t>(t * chunk_size, nodes.size());
+      int64_t end = std::min<int64_t>(begin + chunk_size, nodes.size());
+      threads.push_back(std::make_unique<Thread>(
+          [&, t, begin, end]() { statuses[t] = estimate_range(begin, end); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+  }
+
+  std::vector<double> areas;
+  areas.reserve(fs.size());
+  int64_t next_node = 0;
+  for (int64_t node_count : node_counts) {
+    double area = 0.0;
+    for (int64_t i = 0; i < node_count; ++i) {
+      area += node_areas[next_node++];
+    }
+    areas.push_back(area);
+  }
+  return areas;
+}
+
+absl::StatusOr<double> AreaEstimator::GetFunctionBaseAreaInSquareMicrons(
+    FunctionBase* f, int64_t thread_count) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<double> areas,
+                       GetFunctionBaseAreasInSquareMicrons({f}, thread_count));
+  return areas.front();
+}
+
+CachingAreaEstimator::CachingAreaEstimator(std::string_view name,
+                                           const AreaEstimator& cached,
+                                           EstimateCache* shared_cache)
+    : AreaEstimator(name), cached_(cached) {
+  if (shared_cache == nullptr) {
+    own_cache_ = std::make_unique<EstimateCache>();
+    shared_cache = own_cache_.get();
+  }
+  cache_ = shared_cache;
+}
+
+absl::StatusOr<double> CachingAreaEstimator::GetOperationAreaInSquareMicrons(
+    Node* node) const {
+  std::string signature = NodeSignature(node);
+  std::optional<double> area = cache_->GetArea(cached_.name(), signature);
+  if (area.has_value()) {
+    return *area;
+  }
+  XLS_ASSIGN_OR_RETURN(double result,
+                       cached_.GetOperationAreaInSquareMicrons(node));
+  cache_->AddArea(cached_.name(), signature, result);
+  return result;
+}
+
 AreaEstimatorManager& GetAreaEstimatorManagerSingleton() {
   static absl::NoDestructor<AreaEstimatorManager> manager;
   return *manager;
@@ -25,6 +25,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/estimators/estimate_cache.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -52,10 +54,46 @@ class AreaEstimator {
   absl::StatusOr<double> GetRegisterAreaInSquareMicrons(
       const uint64_t& register_width) const;
 
+  // Returns the estimated total area of the operations in each of `fs` in
+  // square micrometers, not including any pipeline registers. The nodes of
+  // all of `fs` are estimated on up to `thread_count` threads, so
+  // `GetOperationAreaInSquareMicrons` must be safe to call concurrently when
+  // `thread_count` > 1, as it is for the estimators in this repository. The
+  // per-node estimates are summed in node order, so the result does not
+  // depend on `thread_count`.
+  //
+  // Wrap the estimator in a `CachingAreaEstimator` to estimate each distinct
+  // operation only once across calls.
+  absl::StatusOr<std::vector<double>> GetFunctionBaseAreasInSquareMicrons(
+      absl::Span<FunctionBase* const> fs, int64_t thread_count = 1) const;
+  absl::StatusOr<double> GetFunctionBaseAreaInSquareMicrons(
+      FunctionBase* f, int64_t thread_count = 1) const;
+
  private:
   std::string name_;
 };
 
+// Caches the area of an underlying area estimator by `NodeSignature`, in
+// `shared_cache` if given or in a cache private to this estimator otherwise.
+// This class is safe for concurrent access.
+class CachingAreaEstimator : public AreaEstimator {
+ public:
+  CachingAreaEstimator(std::string_view name, const AreaEstimator& cached,
+                       EstimateCache* shared_cache = nullptr);
+
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override;
+
+ private:
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return cached_.GetRegisterAreaInSquareMicrons(1);
+  }
+
+  const AreaEstimator& cached_;
+  std::unique_ptr<EstimateCache> own_cache_;
+  EstimateCache* cache_;
+};
+
 // A manager holding multiple Area Estimator singletons
 class AreaEstimatorManager {
  public:
@@ -21,10 +21,13 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
 
 namespace xls {
@@ -46,6 +49,19 @@ class FakeAreaEstimator : public AreaEstimator {
   double area_;
 };
 
+// Estimates the area of a node as the flat bit count of its type.
+class BitCountAreaEstimator : public AreaEstimator {
+ public:
+  BitCountAreaEstimator() : AreaEstimator("bit_count") {}
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override {
+    return static_cast<double>(node->GetType()->GetFlatBitCount());
+  }
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return 1.0;
+  }
+};
+
 class AreaEstimatorTest : public IrTestBase {};
 
 TEST_F(AreaEstimatorTest, AreaEstimatorManager) {
@@ -82,5 +98,31 @@ TEST_F(AreaEstimatorTest, AreaEstimatorManager) {
               status_testing::IsOkAndHolds(420.0));
 }
 
+TEST_F(AreaEstimatorTest, FunctionBaseAreas) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1(absl::StrCat(TestName(), "_1"), p.get());
+  BValue x = fb1.Param("x", p->GetBitsType(8));
+  fb1.Add(x, fb1.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  FunctionBuilder fb2(absl::StrCat(TestName(), "_2"), p.get());
+  BValue y = fb2.Param("y", p->GetBitsType(16));
+  fb2.Concat({y, y});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  BitCountAreaEstimator estimator;
+  EXPECT_THAT(estimator.GetFunctionBaseAreaInSquareMicrons(f1),
+              status_testing::IsOkAndHolds(24.0));
+  EXPECT_THAT(estimator.GetFunctionBaseAreasInSquareMicrons({f1, f2}),
+              status_testing::IsOkAndHolds(testing::ElementsAre(24.0, 48.0)));
+  EXPECT_THAT(estimator.GetFunctionBaseAreasInSquareMicrons(
+                  {f1, f2}, /*thread_count=*/4),
+              status_testing::IsOkAndHolds(testing::ElementsAre(24.0, 48.0)));
+
+  CachingAreaEstimator caching("caching", estimator);
+  EXPECT_THAT(caching.GetFunctionBaseAreasInSquareMicrons({f1, f2},
+                                                          /*thread_count=*/3),
+              status_testing::IsOkAndHolds(testing::ElementsAre(24.0, 48.0)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,15 +14,22 @@
 
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <optional>
+#include <set>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -39,6 +46,43 @@
 
 namespace xls {
 
+namespace {
+
+// A path from a node to the end of a path, which AnalyzeTopCriticalPaths
+// extends toward the start of the path.
+struct PathCandidate {
+  // The delay of the longest path through the candidate: `suffix_delay` plus
+  // the delay of the longest path up to and including `node`.
+  int64_t total_delay;
+
+  // The topological position of the first node of the candidate.
+  int64_t node;
+
+  // The total delay of the nodes after `node`.
+  int64_t suffix_delay;
+
+  // The index of the PathLink for the node after `node`, or -1 if `node` ends
+  // the path.
+  int64_t next;
+
+  // Orders candidates from longest to shortest.
+  bool operator<(const PathCandidate& other) const {
+    if (total_delay != other.total_delay) {
+      return total_delay > other.total_delay;
+    }
+    return std::tie(node, next) < std::tie(other.node, other.next);
+  }
+};
+
+// A node on a path, linked toward the end of the path. Candidates sharing an
+// end share the links for it.
+struct PathLink {
+  int64_t node;
+  int64_t next;
+};
+
+}  // namespace
+
 absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
     FunctionBase* f, std::optional<int64_t> clock_period_ps,
     const DelayEstimator& delay_estimator) {
@@ -65,7 +109,14 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
   // The node with the greatest critical path delay.
   std::optional<NodeEntry> latest_entry;
 
-  for (Node* node : TopoSort(f)) {
+  std::vector<Node*> topo_sort = TopoSort(f);
+  std::vector<int64_t> node_delays(topo_sort.size());
+  XLS_RETURN_IF_ERROR(delay_estimator.GetOperationDelaysInPs(
+      topo_sort, absl::MakeSpan(node_delays)));
+  node_entries.reserve(topo_sort.size());
+
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    Node* node = topo_sort[i];
     NodeEntry& entry = node_entries[node];
     entry.node = node;
 
@@ -78,8 +129,7 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
         entry.critical_path_predecessor = operand;
       }
     }
-    XLS_ASSIGN_OR_RETURN(entry.node_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
+    entry.node_delay = node_delays[i];
 
     // If the dependency straddles a clock boundary we have to make our delay
     // start from the clock time.
@@ -121,6 +171,114 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
   return std::move(critical_path);
 }
 
+absl::Status AnalyzeTopCriticalPaths(
+    FunctionBase* f, int64_t path_count, const DelayEstimator& delay_estimator,
+    const CriticalPathCallback& callback,
+    std::optional<std::function<int64_t(Node*)>> node_stage) {
+  XLS_RET_CHECK_GT(path_count, 0);
+  std::vector<Node*> topo_sort = TopoSort(f);
+  std::vector<int64_t> node_delays(topo_sort.size());
+  XLS_RETURN_IF_ERROR(delay_estimator.GetOperationDelaysInPs(
+      topo_sort, absl::MakeSpan(node_delays)));
+  absl::flat_hash_map<Node*, int64_t> positions;
+  positions.reserve(topo_sort.size());
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    positions[topo_sort[i]] = i;
+  }
+  std::vector<int64_t> stages;
+  if (node_stage.has_value()) {
+    stages.reserve(topo_sort.size());
+    for (Node* node : topo_sort) {
+      stages.push_back((*node_stage)(node));
+    }
+  }
+  auto stage_of = [&](Node* node) -> int64_t {
+    return stages.empty() ? 0 : stages[positions.at(node)];
+  };
+
+  // Compute the delay of the longest path up to and including each node, and
+  // keep the `path_count` longest paths ending in each stage as the starting
+  // candidates.
+  std::vector<int64_t> arrivals(topo_sort.size());
+  std::map<int64_t, std::set<PathCandidate>> candidates_by_stage;
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    Node* node = topo_sort[i];
+    const int64_t stage = stage_of(node);
+    int64_t max_operand_arrival = 0;
+    for (Node* operand : node->operands()) {
+      if (stage_of(operand) == stage) {
+        max_operand_arrival =
+            std::max(max_operand_arrival, arrivals[positions.at(operand)]);
+      }
+    }
+    arrivals[i] = max_operand_arrival + node_delays[i];
+    if (absl::c_any_of(node->users(),
+                       [&](Node* user) { return stage_of(user) == stage; })) {
+      continue;
+    }
+    std::set<PathCandidate>& candidates = candidates_by_stage[stage];
+    candidates.insert(PathCandidate{
+        .total_delay = arrivals[i], .node = i, .suffix_delay = 0, .next = -1});
+    if (candidates.size() > path_count) {
+      candidates.erase(std::prev(candidates.end()));
+    }
+  }
+
+  // Extend the longest candidate by each of its operands until it reaches the
+  // start of a path. The arrival times are exact, so the extension through the
+  // latest operand is as long as the candidate and paths are completed in
+  // order of decreasing delay. Each candidate leads to a distinct path at
+  // least as long as any candidate after it, so only as many candidates as
+  // paths remaining need to be kept.
+  std::vector<PathLink> links;
+  std::vector<CriticalPathEntry> critical_path;
+  for (auto& [stage, candidates] : candidates_by_stage) {
+    links.clear();
+    int64_t remaining = path_count;
+    while (remaining > 0 && !candidates.empty()) {
+      PathCandidate candidate = *candidates.begin();
+      candidates.erase(candidates.begin());
+      const int64_t link = links.size();
+      links.push_back(PathLink{.node = candidate.node, .next = candidate.next});
+      const int64_t suffix_delay =
+          candidate.suffix_delay + node_delays[candidate.node];
+      bool starts_path = true;
+      for (Node* operand : topo_sort[candidate.node]->operands()) {
+        if (stage_of(operand) != stage) {
+          continue;
+        }
+        starts_path = false;
+        const int64_t position = positions.at(operand);
+        candidates.insert(
+            PathCandidate{.total_delay = arrivals[position] + suffix_delay,
+                          .node = position,
+                          .suffix_delay = suffix_delay,
+                          .next = link});
+      }
+      if (starts_path) {
+        critical_path.clear();
+        int64_t path_delay = 0;
+        for (int64_t l = link; l != -1; l = links[l].next) {
+          path_delay += node_delays[links[l].node];
+          critical_path.push_back(
+              CriticalPathEntry{.node = topo_sort[links[l].node],
+                                .node_delay_ps = node_delays[links[l].node],
+                                .path_delay_ps = path_delay,
+                                .delayed_by_cycle_boundary = false});
+        }
+        std::reverse(critical_path.begin(), critical_path.end());
+        XLS_RETURN_IF_ERROR(callback(stage, critical_path));
+        --remaining;
+      }
+      while (candidates.size() > remaining) {
+        candidates.erase(std::prev(candidates.end()));
+      }
+    }
+    candidates.clear();
+  }
+  return absl::OkStatus();
+}
+
 std::string CriticalPathToString(
     absl::Span<const CriticalPathEntry> critical_path,
     std::optional<std::function<std::string(Node*)>> extra_info) {
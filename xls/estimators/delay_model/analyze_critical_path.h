@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
@@ -62,6 +63,29 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
     FunctionBase* f, std::optional<int64_t> clock_period_ps,
     const DelayEstimator& delay_estimator);
 
+// Called by AnalyzeTopCriticalPaths with each path it finds, laid out as by
+// AnalyzeCriticalPath with the end of the path at the front. `stage` is the
+// pipeline stage containing the path, or zero if no stages were given.
+// Returning an error stops the analysis.
+using CriticalPathCallback = std::function<absl::Status(
+    int64_t stage, absl::Span<const CriticalPathEntry> critical_path)>;
+
+// Finds the `path_count` longest combinational paths through `f` and passes
+// each to `callback` as it's found, longest first. Paths end at nodes without
+// users, and two paths differ if they pass through different nodes.
+//
+// If `node_stage` is given, it returns the pipeline stage of each node; only
+// operands in the same stage as their user are followed, and the
+// `path_count` longest paths of each stage are reported, stage by stage.
+//
+// Unlike AnalyzeCriticalPath, memory use beyond a few words per node is
+// bounded by `path_count` and the length of the paths, not the size of `f`,
+// and paths never straddle cycle boundaries.
+absl::Status AnalyzeTopCriticalPaths(
+    FunctionBase* f, int64_t path_count, const DelayEstimator& delay_estimator,
+    const CriticalPathCallback& callback,
+    std::optional<std::function<int64_t(Node*)>> node_stage = std::nullopt);
+
 // Returns a string representation of the critical-path. Includes delay
 // information for each node as well as cumulative delay.
 //
@@ -14,12 +14,17 @@
 
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 
+#include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
@@ -40,6 +45,8 @@ namespace {
 using ::testing::_;
 using ::testing::ElementsAre;
 using ::testing::FieldsAre;
+using ::testing::Pair;
+using status_testing::StatusIs;
 
 class AnalyzeCriticalPathTest : public IrTestBase {
  protected:
@@ -160,5 +167,80 @@ TEST_F(AnalyzeCriticalPathTest, ProcWithSendReceive) {
                               FieldsAre(m::Literal(Value::Token()), _, _, _)));
 }
 
+TEST_F(AnalyzeCriticalPathTest, TopCriticalPaths) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue a = fb.Negate(x);
+  BValue b = fb.Not(a);
+  BValue c = fb.Negate(x);
+  BValue d = fb.Add(b, c);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(d));
+
+  std::vector<std::vector<CriticalPathEntry>> paths;
+  XLS_ASSERT_OK(AnalyzeTopCriticalPaths(
+      f, /*path_count=*/3, *delay_estimator_,
+      [&](int64_t stage, absl::Span<const CriticalPathEntry> path) {
+        EXPECT_EQ(stage, 0);
+        paths.emplace_back(path.begin(), path.end());
+        return absl::OkStatus();
+      }));
+  EXPECT_THAT(paths,
+              ElementsAre(ElementsAre(FieldsAre(d.node(), 1, 3, false),
+                                      FieldsAre(b.node(), 1, 2, false),
+                                      FieldsAre(a.node(), 1, 1, false),
+                                      FieldsAre(x.node(), 0, 0, false)),
+                          ElementsAre(FieldsAre(d.node(), 1, 2, false),
+                                      FieldsAre(c.node(), 1, 1, false),
+                                      FieldsAre(x.node(), 0, 0, false))));
+
+  // Only as many paths as requested are reported, and errors stop the
+  // analysis.
+  int64_t call_count = 0;
+  EXPECT_THAT(AnalyzeTopCriticalPaths(
+                  f, /*path_count=*/1, *delay_estimator_,
+                  [&](int64_t stage, absl::Span<const CriticalPathEntry> path) {
+                    ++call_count;
+                    return absl::CancelledError();
+                  }),
+              StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_EQ(call_count, 1);
+}
+
+TEST_F(AnalyzeCriticalPathTest, TopCriticalPathsPerStage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue a = fb.Negate(x);
+  BValue b = fb.Not(a);
+  BValue c = fb.Not(b);
+  BValue d = fb.Add(c, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(d));
+  absl::flat_hash_map<Node*, int64_t> stages = {{x.node(), 0},
+                                                {a.node(), 0},
+                                                {b.node(), 0},
+                                                {c.node(), 1},
+                                                {d.node(), 1}};
+
+  std::vector<std::pair<int64_t, std::vector<CriticalPathEntry>>> paths;
+  XLS_ASSERT_OK(AnalyzeTopCriticalPaths(
+      f, /*path_count=*/2, *delay_estimator_,
+      [&](int64_t stage, absl::Span<const CriticalPathEntry> path) {
+        paths.push_back(
+            {stage, std::vector<CriticalPathEntry>(path.begin(), path.end())});
+        return absl::OkStatus();
+      },
+      [&](Node* node) { return stages.at(node); }));
+  // Operands in other stages are not followed, so `x` only starts a path in
+  // stage 0.
+  EXPECT_THAT(
+      paths,
+      ElementsAre(Pair(0, ElementsAre(FieldsAre(b.node(), 1, 2, false),
+                                      FieldsAre(a.node(), 1, 1, false),
+                                      FieldsAre(x.node(), 0, 0, false))),
+                  Pair(1, ElementsAre(FieldsAre(d.node(), 1, 2, false),
+                                      FieldsAre(c.node(), 1, 1, false)))));
+}
+
 }  // namespace
 }  // namespace xls
@@ -66,8 +66,12 @@ def delay_model(
             "@com_google_absl//absl/status",
             "//xls/common:module_initializer",
             "@com_google_absl//absl/status:statusor",
+            "@com_google_absl//absl/types:span",
+            "//xls/common/status:ret_check",
+            "//xls/common/status:status_macros",
             "//xls/estimators/delay_model:delay_estimator",
             "//xls/ir",
+            "//xls/ir:op",
         ],
         **kwargs
     )
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -30,7 +31,11 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -226,6 +231,15 @@ DecoratingDelayEstimator::DecoratingDelayEstimator(
       decorated_(decorated),
       modifier_(ABSL_DIE_IF_NULL(std::move(modifier))) {}
 
+absl::Status DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes, absl::Span<int64_t> delays) const {
+  XLS_RET_CHECK_EQ(nodes.size(), delays.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(delays[i], GetOperationDelayInPs(nodes[i]));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
   XLS_ASSIGN_OR_RETURN(int64_t original,
@@ -233,6 +247,15 @@ absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
   return modifier_(node, original);
 }
 
+absl::Status DecoratingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes, absl::Span<int64_t> delays) const {
+  XLS_RETURN_IF_ERROR(decorated_.GetOperationDelaysInPs(nodes, delays));
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    delays[i] = modifier_(nodes[i], delays[i]);
+  }
+  return absl::OkStatus();
+}
+
 FirstMatchDelayEstimator::FirstMatchDelayEstimator(
     std::string_view name, std::vector<const DelayEstimator*> estimators)
     : DelayEstimator(name), estimators_(std::move(estimators)) {}
@@ -250,11 +273,24 @@ absl::StatusOr<int64_t> FirstMatchDelayEstimator::GetOperationDelayInPs(
 }
 
 CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
-                                             const DelayEstimator& cached)
-    : DelayEstimator(name), cached_(cached) {}
+                                             const DelayEstimator& cached,
+                                             EstimateCache* shared_cache)
+    : DelayEstimator(name), cached_(cached), shared_cache_(shared_cache) {}
 
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
+  if (shared_cache_ != nullptr) {
+    std::string signature = NodeSignature(node);
+    std::optional<int64_t> cached_delay =
+        shared_cache_->GetDelay(cached_.name(), signature);
+    if (cached_delay.has_value()) {
+      return *cached_delay;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
+    shared_cache_->AddDelay(cached_.name(), signature, delay);
+    return delay;
+  }
+
   if (ContainsNodeDelay(node)) {
     return GetNodeDelay(node);
   }
@@ -264,6 +300,63 @@ absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
   return delay;
 }
 
+absl::Status CachingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes, absl::Span<int64_t> delays) const {
+  XLS_RET_CHECK_EQ(nodes.size(), delays.size());
+  std::vector<std::string> signatures;
+  std::vector<int64_t> misses;
+  if (shared_cache_ != nullptr) {
+    signatures.reserve(nodes.size());
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      signatures.push_back(NodeSignature(nodes[i]));
+      std::optional<int64_t> cached_delay =
+          shared_cache_->GetDelay(cached_.name(), signatures.back());
+      if (cached_delay.has_value()) {
+        delays[i] = *cached_delay;
+      } else {
+        misses.push_back(i);
+      }
+    }
+  } else {
+    absl::ReaderMutexLock lock(&cache_mutex_);
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      auto it = cache_.find(nodes[i]);
+      if (it != cache_.end()) {
+        delays[i] = it->second;
+      } else {
+        misses.push_back(i);
+      }
+    }
+  }
+  if (misses.empty()) {
+    return absl::OkStatus();
+  }
+
+  std::vector<Node*> miss_nodes;
+  miss_nodes.reserve(misses.size());
+  for (int64_t i : misses) {
+    miss_nodes.push_back(nodes[i]);
+  }
+  std::vector<int64_t> miss_delays(misses.size());
+  XLS_RETURN_IF_ERROR(
+      cached_.GetOperationDelaysInPs(miss_nodes, absl::MakeSpan(miss_delays)));
+  for (int64_t j = 0; j < misses.size(); ++j) {
+    delays[misses[j]] = miss_delays[j];
+  }
+  if (shared_cache_ != nullptr) {
+    for (int64_t j = 0; j < misses.size(); ++j) {
+      shared_cache_->AddDelay(cached_.name(), signatures[misses[j]],
+                              miss_delays[j]);
+    }
+    return absl::OkStatus();
+  }
+  absl::WriterMutexLock lock(&cache_mutex_);
+  for (int64_t j = 0; j < misses.size(); ++j) {
+    cache_.emplace(miss_nodes[j], miss_delays[j]);
+  }
+  return absl::OkStatus();
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
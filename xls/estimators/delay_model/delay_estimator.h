@@ -30,6 +30,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -45,6 +46,14 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Sets `delays[i]` to the estimated delay of `nodes[i]` in picoseconds;
+  // `delays` must be the same size as `nodes`. Returns the error for the first
+  // node which can't be estimated, in which case `delays` is partially
+  // written. Estimators may override this to amortize per-node overhead across
+  // the batch; by default each node is estimated in turn.
+  virtual absl::Status GetOperationDelaysInPs(absl::Span<Node* const> nodes,
+                                              absl::Span<int64_t> delays) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -65,6 +74,9 @@ class DecoratingDelayEstimator : public DelayEstimator {
   ~DecoratingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+  absl::Status GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes,
+      absl::Span<int64_t> delays) const override;
 
  private:
   const DelayEstimator& decorated_;
@@ -90,14 +102,28 @@ class FirstMatchDelayEstimator : public DelayEstimator {
 
 // Cache the delay of an underlying delay estimator. This class is safe for
 // concurrent access.
+//
+// Delays are cached per node, unless `shared_cache` is given, in which case
+// they are cached in it by `NodeSignature` instead. Identical operations in
+// other functions, packages or (for file-backed caches) runs then reuse the
+// delay, and the estimator may outlive the nodes it was queried with. This
+// requires the delay returned by `cached` to depend only on the node's
+// signature, which holds for the delay models in this repository.
 class CachingDelayEstimator : public DelayEstimator {
  public:
-  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
+  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached,
+                        EstimateCache* shared_cache = nullptr);
 
   ~CachingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
+  // Looks up all of `nodes` at once and estimates the ones not yet cached
+  // with a single batch query of the underlying estimator.
+  absl::Status GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes,
+      absl::Span<int64_t> delays) const override;
+
  private:
   bool ContainsNodeDelay(Node* node) const {
     absl::ReaderMutexLock lock(&cache_mutex_);
@@ -117,6 +143,7 @@ class CachingDelayEstimator : public DelayEstimator {
   XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
 
   const DelayEstimator& cached_;
+  EstimateCache* shared_cache_;
   mutable absl::Mutex cache_mutex_;
   mutable absl::flat_hash_map<Node*, int64_t> cache_
       ABSL_GUARDED_BY(cache_mutex_);
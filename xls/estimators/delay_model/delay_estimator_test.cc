@@ -14,6 +14,7 @@
 
 #include "xls/estimators/delay_model/delay_estimator.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string_view>
@@ -23,10 +24,13 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
 
 namespace xls {
@@ -303,6 +307,67 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
 }
 
+// A delay estimator which counts its queries.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++query_count_;
+    return node->BitCountOrDie();
+  }
+
+  int64_t query_count() const { return query_count_; }
+
+ private:
+  mutable std::atomic<int64_t> query_count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorWithSharedCache) {
+  CountingDelayEstimator counting;
+  EstimateCache shared_cache;
+  CachingDelayEstimator caching("caching", counting, &shared_cache);
+  for (int64_t i = 0; i < 2; ++i) {
+    // Identical operations in different packages share the cached delay.
+    auto p = CreatePackage();
+    FunctionBuilder fb(TestName(), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(4));
+    BValue y = fb.Param("y", p->GetBitsType(4));
+    BValue sum = fb.Add(x, y);
+    BValue wide = fb.ZeroExtend(sum, 8);
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(wide).status());
+    EXPECT_THAT(caching.GetOperationDelayInPs(sum.node()), IsOkAndHolds(4));
+    EXPECT_THAT(caching.GetOperationDelayInPs(wide.node()), IsOkAndHolds(8));
+  }
+  EXPECT_EQ(counting.query_count(), 2);
+  EXPECT_EQ(shared_cache.size(), 2);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorBatch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue sum = fb.Add(x, x);
+  BValue wide = fb.ZeroExtend(sum, 8);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(wide).status());
+  std::vector<Node*> nodes = {sum.node(), wide.node(), sum.node()};
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(sum.node()).status());
+  std::vector<int64_t> delays(nodes.size());
+  XLS_ASSERT_OK(caching.GetOperationDelaysInPs(nodes, absl::MakeSpan(delays)));
+  EXPECT_THAT(delays, ElementsAre(4, 8, 4));
+  // Only the uncached node is passed on to the underlying estimator.
+  EXPECT_EQ(counting.query_count(), 2);
+  XLS_ASSERT_OK(caching.GetOperationDelaysInPs(nodes, absl::MakeSpan(delays)));
+  EXPECT_EQ(counting.query_count(), 2);
+
+  EXPECT_THAT(caching.GetOperationDelaysInPs(nodes, absl::MakeSpan(delays)
+                                                        .subspan(0, 2)),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 // A Delay Estimator that can only handle one kind of operation.
 class TestNodeMatchEstimator : public DelayEstimator {
  public:
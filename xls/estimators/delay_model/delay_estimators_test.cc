@@ -14,12 +14,20 @@
 
 #include "xls/estimators/delay_model/delay_estimators.h"
 
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 namespace {
@@ -48,5 +56,33 @@ TEST_F(DelayEstimatorsTest, UnitDelayModel) {
   EXPECT_THAT(estimator->GetOperationDelayInPs(tuple.node()), IsOkAndHolds(1));
 }
 
+TEST_F(DelayEstimatorsTest, BatchedDelaysMatchPerNodeDelays) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue sum = fb.Add(x, x);
+  BValue product = fb.UMul(x, fb.ZeroExtend(y, 32));
+  BValue shifted = fb.Shll(sum, fb.Literal(UBits(3, 32)));
+  BValue narrow_sum = fb.Add(y, y);
+  BValue selected = fb.Select(fb.ULt(sum, product), {shifted, product});
+  fb.Concat({selected, narrow_sum, fb.Negate(y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+
+  for (std::string_view model : {"unit", "asap7", "sky130"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * estimator,
+                             GetDelayEstimator(model));
+    std::vector<int64_t> delays(nodes.size());
+    XLS_ASSERT_OK(
+        estimator->GetOperationDelaysInPs(nodes, absl::MakeSpan(delays)));
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      EXPECT_THAT(estimator->GetOperationDelayInPs(nodes[i]),
+                  IsOkAndHolds(delays[i]))
+          << model << ": " << nodes[i]->ToString();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,240 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/estimate_cache.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kDelayKind = "delay";
+constexpr std::string_view kAreaKind = "area";
+
+std::string MakeKey(std::string_view estimator, std::string_view signature) {
+  return absl::StrCat(estimator, "\t", signature);
+}
+
+std::string AttributeString(Node* node) {
+  switch (node->op()) {
+    case Op::kBitSlice:
+      return absl::StrFormat("start=%d", node->As<BitSlice>()->start());
+    case Op::kTupleIndex:
+      return absl::StrFormat("index=%d", node->As<TupleIndex>()->index());
+    case Op::kOneHot:
+      return absl::StrFormat(
+          "lsb_prio=%v", node->As<OneHot>()->priority() == LsbOrMsb::kLsb);
+    case Op::kSel:
+      return absl::StrFormat(
+          "default=%v", node->As<Select>()->default_value().has_value());
+    case Op::kMinDelay:
+      return absl::StrFormat("delay=%d", node->As<MinDelay>()->delay());
+    case Op::kReceive:
+      return absl::StrFormat("channel=%s, blocking=%v",
+                             node->As<Receive>()->channel_name(),
+                             node->As<Receive>()->is_blocking());
+    case Op::kSend:
+      return absl::StrFormat("channel=%s", node->As<Send>()->channel_name());
+    case Op::kInvoke:
+      return absl::StrFormat("to_apply=%s",
+                             node->As<Invoke>()->to_apply()->name());
+    case Op::kMap:
+      return absl::StrFormat("to_apply=%s",
+                             node->As<Map>()->to_apply()->name());
+    case Op::kCountedFor:
+      return absl::StrFormat("trip_count=%d, stride=%d, body=%s",
+                             node->As<CountedFor>()->trip_count(),
+                             node->As<CountedFor>()->stride(),
+                             node->As<CountedFor>()->body()->name());
+    case Op::kDynamicCountedFor:
+      return absl::StrFormat("body=%s",
+                             node->As<DynamicCountedFor>()->body()->name());
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+std::string NodeSignature(Node* node) {
+  std::vector<std::string> operands;
+  operands.reserve(node->operand_count());
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    std::string description = operand->GetType()->ToString();
+    // Models specialize on repeated and literal operands.
+    for (int64_t j = 0; j < i; ++j) {
+      if (node->operand(j) == operand) {
+        absl::StrAppendFormat(&description, " same_as=%d", j);
+        break;
+      }
+    }
+    if (operand->Is<Literal>()) {
+      absl::StrAppend(&description, " literal=",
+                      operand->As<Literal>()->value().ToHumanString());
+    }
+    operands.push_back(std::move(description));
+  }
+  return absl::StrFormat("%s(%s) -> %s [%s]", OpToString(node->op()),
+                         absl::StrJoin(operands, ", "),
+                         node->GetType()->ToString(), AttributeString(node));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<EstimateCache>> EstimateCache::Open(
+    const std::filesystem::path& path) {
+  auto cache = std::make_unique<EstimateCache>();
+  XLS_ASSIGN_OR_RETURN(bool exists, FileExists(path));
+  if (exists) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    absl::MutexLock lock(&cache->mutex_);
+    for (std::string_view line :
+         absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+      std::vector<std::string_view> fields = absl::StrSplit(line, '\t');
+      if (fields.size() != 4) {
+        continue;
+      }
+      std::string key = MakeKey(fields[1], fields[2]);
+      int64_t delay;
+      double area;
+      if (fields[0] == kDelayKind && absl::SimpleAtoi(fields[3], &delay)) {
+        cache->delays_[key] = delay;
+      } else if (fields[0] == kAreaKind &&
+                 absl::SimpleAtod(fields[3], &area)) {
+        cache->areas_[key] = area;
+      } else {
+        // Tolerate lines truncated by a process which died mid-write.
+        VLOG(1) << "Skipping malformed estimate cache entry: " << line;
+      }
+    }
+  }
+  std::FILE* file = std::fopen(path.c_str(), "a");
+  if (file == nullptr) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to open estimate cache %s: %s", path.string(),
+        std::strerror(errno)));
+  }
+  absl::MutexLock lock(&cache->mutex_);
+  cache->file_ = file;
+  return cache;
+}
+
+EstimateCache::~EstimateCache() {
+  absl::MutexLock lock(&mutex_);
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+std::optional<int64_t> EstimateCache::GetDelay(
+    std::string_view estimator, std::string_view signature) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = delays_.find(MakeKey(estimator, signature));
+  if (it == delays_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void EstimateCache::AddDelay(std::string_view estimator,
+                             std::string_view signature, int64_t delay) {
+  std::string key = MakeKey(estimator, signature);
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = delays_.insert_or_assign(key, delay);
+  Append(kDelayKind, it->first, absl::StrCat(delay));
+}
+
+std::optional<double> EstimateCache::GetArea(
+    std::string_view estimator, std::string_view signature) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = areas_.find(MakeKey(estimator, signature));
+  if (it == areas_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void EstimateCache::AddArea(std::string_view estimator,
+                            std::string_view signature, double area) {
+  std::string key = MakeKey(estimator, signature);
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = areas_.insert_or_assign(key, area);
+  Append(kAreaKind, it->first, absl::StrFormat("%.17g", area));
+}
+
+int64_t EstimateCache::size() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return delays_.size() + areas_.size();
+}
+
+void EstimateCache::Append(std::string_view kind, std::string_view key,
+                           std::string_view value) {
+  if (file_ == nullptr) {
+    return;
+  }
+  // Each entry is written with a single call so entries appended by
+  // concurrent processes don't interleave.
+  std::string line = absl::StrCat(kind, "\t", key, "\t", value, "\n");
+  if (std::fwrite(line.data(), 1, line.size(), file_) != line.size() ||
+      std::fflush(file_) != 0) {
+    LOG(WARNING) << "Unable to write estimate cache entry: "
+                 << std::strerror(errno);
+  }
+}
+
+absl::StatusOr<EstimateCache*> GetSharedEstimateCache(
+    const std::filesystem::path& path) {
+  static absl::NoDestructor<absl::Mutex> mutex;
+  static absl::NoDestructor<
+      absl::flat_hash_map<std::string, std::unique_ptr<EstimateCache>>>
+      caches;
+  std::string key = std::filesystem::absolute(path).lexically_normal();
+  absl::MutexLock lock(mutex.get());
+  auto it = caches->find(key);
+  if (it == caches->end()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<EstimateCache> cache,
+                         EstimateCache::Open(path));
+    it = caches->emplace(key, std::move(cache)).first;
+  }
+  return it->second.get();
+}
+
+}  // namespace xls
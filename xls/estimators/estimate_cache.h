@@ -0,0 +1,96 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ESTIMATORS_ESTIMATE_CACHE_H_
+#define XLS_ESTIMATORS_ESTIMATE_CACHE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Returns a key describing everything about `node` that delay and area models
+// look at: its op, result type and operand types, which operands are literals
+// (and their values) or repeated, and op-specific attributes such as slice
+// starts or callee names. Nodes with the same signature get the same estimate
+// from any of the estimators in this repository, regardless of which function
+// or package they are in.
+//
+// Estimators which inspect the graph beyond a node's immediate operands, for
+// example through a DecoratingDelayEstimator, must not be cached by signature.
+std::string NodeSignature(Node* node);
+
+// A thread-safe store of delay and area estimates keyed by estimator name and
+// node signature.
+//
+// A cache may be backed by a file, in which case it's loaded when opened and
+// every new estimate is appended to the file as it's added. Appending one
+// line at a time lets concurrent processes share a file: duplicate entries are
+// harmless, and the last one wins when the file is loaded.
+class EstimateCache {
+ public:
+  // Creates a cache held in memory only.
+  EstimateCache() = default;
+
+  // Opens the cache file at `path`, creating it if it doesn't exist.
+  static absl::StatusOr<std::unique_ptr<EstimateCache>> Open(
+      const std::filesystem::path& path);
+
+  ~EstimateCache();
+
+  EstimateCache(const EstimateCache&) = delete;
+  EstimateCache& operator=(const EstimateCache&) = delete;
+
+  std::optional<int64_t> GetDelay(std::string_view estimator,
+                                  std::string_view signature) const;
+  void AddDelay(std::string_view estimator, std::string_view signature,
+                int64_t delay);
+
+  std::optional<double> GetArea(std::string_view estimator,
+                                std::string_view signature) const;
+  void AddArea(std::string_view estimator, std::string_view signature,
+               double area);
+
+  // The number of delay and area estimates held.
+  int64_t size() const;
+
+ private:
+  void Append(std::string_view kind, std::string_view key,
+              std::string_view value) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> delays_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, double> areas_ ABSL_GUARDED_BY(mutex_);
+  std::FILE* file_ ABSL_GUARDED_BY(mutex_) = nullptr;
+};
+
+// Returns the process-wide cache backed by the file at `path`, opening it on
+// first use. Every caller passing the same path shares the same cache.
+absl::StatusOr<EstimateCache*> GetSharedEstimateCache(
+    const std::filesystem::path& path);
+
+}  // namespace xls
+
+#endif  // XLS_ESTIMATORS_ESTIMATE_CACHE_H_
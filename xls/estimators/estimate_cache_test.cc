@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/estimate_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+
+class EstimateCacheTest : public IrTestBase {};
+
+TEST_F(EstimateCacheTest, SignatureIgnoresNamesAndLocation) {
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1("f", p1.get());
+  BValue a = fb1.Param("a", p1->GetBitsType(8));
+  BValue b = fb1.Param("b", p1->GetBitsType(8));
+  BValue add1 = fb1.Add(a, b);
+  BValue square1 = fb1.UMul(a, a);
+  BValue shift1 = fb1.Shll(a, fb1.Literal(UBits(3, 8)));
+  XLS_ASSERT_OK(fb1.Build().status());
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2("g", p2.get());
+  BValue x = fb2.Param("x", p2->GetBitsType(8));
+  BValue y = fb2.Param("y", p2->GetBitsType(8));
+  BValue add2 = fb2.Add(y, x);
+  BValue product2 = fb2.UMul(x, y);
+  BValue shift2 = fb2.Shll(x, fb2.Literal(UBits(4, 8)));
+  BValue wide_add = fb2.Add(fb2.Param("z", p2->GetBitsType(16)),
+                            fb2.Param("w", p2->GetBitsType(16)));
+  XLS_ASSERT_OK(fb2.Build().status());
+
+  EXPECT_EQ(NodeSignature(add1.node()), NodeSignature(add2.node()));
+  EXPECT_NE(NodeSignature(add1.node()), NodeSignature(wide_add.node()));
+  // Repeated and literal operands are part of the signature.
+  EXPECT_NE(NodeSignature(square1.node()), NodeSignature(product2.node()));
+  EXPECT_NE(NodeSignature(shift1.node()), NodeSignature(shift2.node()));
+}
+
+TEST_F(EstimateCacheTest, InMemory) {
+  EstimateCache cache;
+  EXPECT_EQ(cache.GetDelay("model", "sig"), std::nullopt);
+  cache.AddDelay("model", "sig", 42);
+  cache.AddArea("model", "sig", 1.5);
+  EXPECT_THAT(cache.GetDelay("model", "sig"), Optional(42));
+  EXPECT_THAT(cache.GetArea("model", "sig"), Optional(1.5));
+  // Estimates are separated by estimator.
+  EXPECT_EQ(cache.GetDelay("other_model", "sig"), std::nullopt);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST_F(EstimateCacheTest, PersistsAcrossOpens) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  std::filesystem::path path = dir.path() / "estimates";
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<EstimateCache> cache,
+                             EstimateCache::Open(path));
+    EXPECT_EQ(cache->size(), 0);
+    cache->AddDelay("model", "add(bits[8], bits[8]) -> bits[8] []", 7);
+    cache->AddArea("model", "add(bits[8], bits[8]) -> bits[8] []", 0.25);
+    cache->AddDelay("model", "neg(bits[8]) -> bits[8] []", 3);
+    cache->AddDelay("model", "neg(bits[8]) -> bits[8] []", 4);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<EstimateCache> cache,
+                           EstimateCache::Open(path));
+  EXPECT_EQ(cache->size(), 3);
+  EXPECT_THAT(cache->GetDelay("model", "add(bits[8], bits[8]) -> bits[8] []"),
+              Optional(7));
+  EXPECT_THAT(cache->GetArea("model", "add(bits[8], bits[8]) -> bits[8] []"),
+              Optional(0.25));
+  // The last entry for a key wins.
+  EXPECT_THAT(cache->GetDelay("model", "neg(bits[8]) -> bits[8] []"),
+              Optional(4));
+
+  XLS_ASSERT_OK_AND_ASSIGN(EstimateCache * shared,
+                           GetSharedEstimateCache(path));
+  XLS_ASSERT_OK_AND_ASSIGN(EstimateCache * shared_again,
+                           GetSharedEstimateCache(dir.path() / "." /
+                                                  "estimates"));
+  EXPECT_EQ(shared, shared_again);
+}
+
+}  // namespace
+}  // namespace xls
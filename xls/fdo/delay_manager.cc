@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <tuple>
 #include <vector>
 
@@ -27,6 +28,8 @@
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
@@ -35,33 +38,24 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/critical_path_distances.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
 
 DelayManager::DelayManager(FunctionBase *function,
                            const DelayEstimator &delay_estimator)
-    : function_(function),
-      index_to_node_(function_->node_count()),
-      indices_to_delay_(function_->node_count(),
-                        std::vector<int64_t>(function_->node_count(), -1)),
-      indices_to_critical_operand_(
-          function_->node_count(),
-          std::vector<Node *>(function_->node_count(), nullptr)),
-      name_(delay_estimator.name()) {
-  // Get the mapping between function node and their index. Also, estimate the
-  // delay of each node.
-  node_to_index_.reserve(function_->node_count());
-  int32_t index = 0;
-  for (Node *node : function_->nodes()) {
-    node_to_index_[node] = index;
-    index_to_node_[index] = node;
-    absl::StatusOr<int64_t> maybe_delay =
-        delay_estimator.GetOperationDelayInPs(node);
-    CHECK_OK(maybe_delay.status());
-    indices_to_delay_[index][index] = maybe_delay.value();
-    index++;
-  }
+    : function_(function), name_(delay_estimator.name()) {
+  // Estimate the delay of each node, and compute the delays of all paths from
+  // them.
+  distances_ = CriticalPathDistances::Compute(
+      TopoSort(function_), [&](Node *node) -> int64_t {
+        absl::StatusOr<int64_t> maybe_delay =
+            delay_estimator.GetOperationDelayInPs(node);
+        CHECK_OK(maybe_delay.status());
+        return maybe_delay.value();
+      });
+  critical_operands_.assign(distances_.pair_count(), -1);
   PropagateDelays();
 }
 
@@ -69,8 +63,7 @@ absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
   if (node->function_base() != function_) {
     return absl::InvalidArgumentError("invalid node");
   }
-  int64_t node_index = node_to_index_.at(node);
-  return indices_to_delay_[node_index][node_index];
+  return NodeDelay(distances_.index(node));
 }
 
 absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
@@ -78,9 +71,7 @@ absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
   if (from->function_base() != function_ || to->function_base() != function_) {
     return absl::InvalidArgumentError("invalid path");
   }
-  int64_t from_index = node_to_index_.at(from);
-  int64_t to_index = node_to_index_.at(to);
-  return indices_to_delay_[from_index][to_index];
+  return distances_.GetDistance(from, to).value_or(-1);
 }
 
 absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
@@ -89,103 +80,124 @@ absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
   if (from->function_base() != function_ || to->function_base() != function_) {
     return absl::InvalidArgumentError("invalid path");
   }
-  int64_t from_index = node_to_index_.at(from);
-  int64_t to_index = node_to_index_.at(to);
-  int64_t &current_delay = indices_to_delay_[from_index][to_index];
-  if (!if_shorter || current_delay > delay) {
-    if (!if_exist || current_delay != -1) {
-      current_delay = delay;
+  int32_t to_index = distances_.index(to);
+  std::optional<int64_t> pair =
+      distances_.PairIndex(distances_.index(from), to_index);
+  if (!pair.has_value()) {
+    if (!if_exist) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("no path from %s to %s", from->GetName(),
+                          to->GetName()));
     }
+    return absl::OkStatus();
+  }
+  int64_t &current_delay = distances_.MutableDistancesTo(
+      to_index)[*pair - distances_.RowOffset(to_index)];
+  if (!if_shorter || current_delay > delay) {
+    current_delay = delay;
   }
   return absl::OkStatus();
 }
 
 absl::StatusOr<std::vector<Node *>> DelayManager::GetFullCriticalPath(
     Node *from, Node *to) const {
-  int64_t from_index = node_to_index_.at(from);
-  int64_t to_index = node_to_index_.at(to);
+  int32_t from_index = distances_.index(from);
   std::vector<Node *> critical_path;
 
-  Node *critical_operand = indices_to_critical_operand_[from_index][to_index];
+  auto critical_operand = [&](int32_t to_index) -> Node * {
+    std::optional<int64_t> pair = distances_.PairIndex(from_index, to_index);
+    if (!pair.has_value() || critical_operands_[*pair] < 0) {
+      return nullptr;
+    }
+    return distances_.node(critical_operands_[*pair]);
+  };
+  Node *operand = critical_operand(distances_.index(to));
   critical_path.push_back(to);
-  while (critical_operand != nullptr && critical_operand != from) {
-    critical_path.push_back(critical_operand);
-    int64_t critical_operand_index = node_to_index_.at(critical_operand);
-    critical_operand =
-        indices_to_critical_operand_[from_index][critical_operand_index];
+  while (operand != nullptr && operand != from) {
+    critical_path.push_back(operand);
+    operand = critical_operand(distances_.index(operand));
   }
-  XLS_RET_CHECK(critical_operand == from);
+  XLS_RET_CHECK(operand == from);
   critical_path.push_back(from);
   std::reverse(critical_path.begin(), critical_path.end());
   return critical_path;
 }
 
 void DelayManager::PropagateDelays() {
-  // Traverse the function in a reversed topological order.
-  for (Node *node : ReverseTopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
+  // Scratch space holding the delays from each node to the current target, or
+  // -1 if there is no path.
+  std::vector<int64_t> delays_to_target(distances_.node_count(), -1);
 
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
-    for (Node *user : node->users()) {
-      int64_t user_index = node_to_index_[user];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t from_user_delay = indices_to_delay_[user_index][i];
+  // Traverse the sources of the paths to each target in a reversed topological
+  // order.
+  for (int32_t target = 0; target < distances_.node_count(); ++target) {
+    absl::Span<const int32_t> sources = distances_.SourcesTo(target);
+    absl::Span<int64_t> delays = distances_.MutableDistancesTo(target);
+    for (int64_t i = 0; i < sources.size(); ++i) {
+      delays_to_target[sources[i]] = delays[i];
+    }
+    for (int64_t i = sources.size() - 1; i >= 0; --i) {
+      if (sources[i] == target) {
+        continue;
+      }
+      Node *node = distances_.node(sources[i]);
+      int64_t node_delay = NodeDelay(sources[i]);
+
+      // Compute the critical-path distance from `node` to the target from the
+      // delays of each user of `node` to the target.
+      int64_t new_delay = -1;
+      for (Node *user : node->users()) {
+        int64_t from_user_delay = delays_to_target[distances_.index(user)];
         if (from_user_delay != -1) {
           // Always pick the critical path.
-          if (new_delays[i] < from_user_delay + node_delay) {
-            new_delays[i] = from_user_delay + node_delay;
-          }
+          new_delay = std::max(new_delay, from_user_delay + node_delay);
         }
       }
-    }
 
-    // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[node_index][i];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-        }
+      // Update the original delay if the newly calculated delay is smaller.
+      if (new_delay != -1 && delays[i] >= new_delay) {
+        delays[i] = new_delay;
+        delays_to_target[sources[i]] = new_delay;
       }
     }
+    for (int32_t source : sources) {
+      delays_to_target[source] = -1;
+    }
   }
 
   // Traverse the function in a topological order.
-  for (Node *node : TopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-    std::vector<Node *> new_critical_operands(function_->node_count(), nullptr);
+  std::vector<int32_t> new_critical_operands(distances_.node_count(), -1);
+  for (int32_t target = 0; target < distances_.node_count(); ++target) {
+    Node *node = distances_.node(target);
+    int64_t node_delay = NodeDelay(target);
 
     // Compute the critical-path distance from `a` to `node` for all nodes `a`
     // from the delays of `a` to each operand of `node`.
     for (Node *operand : node->operands()) {
-      int64_t operand_index = node_to_index_[operand];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t to_operand_delay = indices_to_delay_[i][operand_index];
-        if (to_operand_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < to_operand_delay + node_delay) {
-            new_delays[i] = to_operand_delay + node_delay;
-            new_critical_operands[i] = operand;
-          }
+      int32_t operand_index = distances_.index(operand);
+      absl::Span<const int32_t> sources = distances_.SourcesTo(operand_index);
+      absl::Span<const int64_t> delays = distances_.DistancesTo(operand_index);
+      for (int64_t i = 0; i < sources.size(); ++i) {
+        // Always pick the critical path.
+        if (delays_to_target[sources[i]] < delays[i] + node_delay) {
+          delays_to_target[sources[i]] = delays[i] + node_delay;
+          new_critical_operands[sources[i]] = operand_index;
         }
       }
     }
 
     // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[i][node_index];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-          indices_to_critical_operand_[i][node_index] =
-              new_critical_operands[i];
-        }
+    absl::Span<const int32_t> sources = distances_.SourcesTo(target);
+    absl::Span<int64_t> delays = distances_.MutableDistancesTo(target);
+    for (int64_t i = 0; i < sources.size(); ++i) {
+      int64_t new_delay = delays_to_target[sources[i]];
+      if (new_delay != -1 && delays[i] >= new_delay) {
+        delays[i] = new_delay;
+        critical_operands_[distances_.RowOffset(target) + i] =
+            new_critical_operands[sources[i]];
       }
+      delays_to_target[sources[i]] = -1;
+      new_critical_operands[sources[i]] = -1;
     }
   }
 }
@@ -196,12 +208,13 @@ DelayManager::GetPathsOverDelayThreshold(int64_t delay_threshold) const {
   if (delay_threshold < 0) {
     return paths;
   }
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
-    Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
-      Node *to = index_to_node_[j];
-      if (indices_to_delay_[i][j] > delay_threshold) {
-        paths[from].push_back(to);
+  for (int32_t target = 0; target < distances_.node_count(); ++target) {
+    Node *to = distances_.node(target);
+    absl::Span<const int32_t> sources = distances_.SourcesTo(target);
+    absl::Span<const int64_t> delays = distances_.DistancesTo(target);
+    for (int64_t i = 0; i < sources.size(); ++i) {
+      if (delays[i] > delay_threshold) {
+        paths[distances_.node(sources[i])].push_back(to);
       }
     }
   }
@@ -220,15 +233,14 @@ absl::StatusOr<std::vector<PathInfo>> DelayManager::GetTopNPaths(
   // Traverse all nodes in the function and construct a worklist with score of
   // each path.
   std::vector<std::tuple<float, int64_t, Node *, Node *>> worklist;
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
-    Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
-      Node *to = index_to_node_[j];
-      int64_t delay = indices_to_delay_[i][j];
+  for (int32_t target = 0; target < distances_.node_count(); ++target) {
+    Node *to = distances_.node(target);
+    absl::Span<const int32_t> sources = distances_.SourcesTo(target);
+    absl::Span<const int64_t> delays = distances_.DistancesTo(target);
+    for (int64_t i = 0; i < sources.size(); ++i) {
+      Node *from = distances_.node(sources[i]);
+      int64_t delay = delays[i];
 
-      if (delay < 0) {
-        continue;
-      }
       if (options.exclude_single_node_path && from == to) {
         continue;
       }
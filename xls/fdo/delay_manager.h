@@ -27,6 +27,7 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/scheduling/critical_path_distances.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
@@ -71,7 +72,8 @@ struct PathExtractOptions {
 // This class manages the delay estimations of all pairs of nodes in a function
 // or proc. It allows users to update the delay between a certain pair of nodes,
 // re-calculate the critical delay of all pairs of nodes, extract paths longer
-// than a threshold, extract top-N longest paths, etc.
+// than a threshold, extract top-N longest paths, etc. Only pairs of nodes
+// connected by a path are stored (see CriticalPathDistances).
 class DelayManager {
  public:
   explicit DelayManager(FunctionBase *function,
@@ -81,6 +83,10 @@ class DelayManager {
 
   absl::StatusOr<int64_t> GetCriticalPathDelay(Node *from, Node *to) const;
 
+  // Sets the critical path delay between "from" and "to". If "if_shorter" is
+  // set, only a delay shorter than the current one is set. If "if_exist" is
+  // cleared, it is an error to set the delay between nodes not connected by a
+  // path; otherwise such calls are ignored.
   absl::Status SetCriticalPathDelay(Node *from, Node *to, int64_t delay,
                                     bool if_shorter = true,
                                     bool if_exist = true);
@@ -133,22 +139,22 @@ class DelayManager {
   static float GetZeroScore(Node *from, Node *to) { return 0.0; }
   static bool GetFalse(Node *from, Node *to) { return false; }
 
-  FunctionBase *function_;
-
-  // A mapping from a node to its index in the function.
-  absl::flat_hash_map<Node *, int64_t> node_to_index_;
+  // Returns the delay of the node at `index`, which is stored as the delay of
+  // the path from the node to itself.
+  int64_t NodeDelay(int32_t index) const {
+    return distances_.DistancesTo(index).back();
+  }
 
-  // A mapping from a node index to the corresponding node.
-  std::vector<Node *> index_to_node_;
+  FunctionBase *function_;
 
-  // An all-to-all delay mapping. The self-to-self delay of a node is defined as
-  // the delay of itself. If there is no valid path exists, the delay is defined
-  // as -1. Both the source and target node delays are counted.
-  std::vector<std::vector<int64_t>> indices_to_delay_;
+  // The delays of all pairs of nodes connected by a path. The self-to-self
+  // delay of a node is defined as the delay of itself. Both the source and
+  // target node delays are counted.
+  CriticalPathDistances distances_;
 
-  // A all-to-all mapping from the source and target node indices to the
-  // critical operand of the target node.
-  std::vector<std::vector<Node *>> indices_to_critical_operand_;
+  // The index of the critical operand of the target node of each pair in
+  // `distances_`, or -1 if there is none.
+  std::vector<int32_t> critical_operands_;
 
   // Name of the delay estimator.
   const std::string name_;
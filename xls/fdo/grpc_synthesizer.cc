@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <utility>
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
@@ -35,8 +36,9 @@ namespace {
 // client.
 class GrpcSynthesizer : public Synthesizer {
  public:
-  explicit GrpcSynthesizer(const GrpcSynthesizerParameters& params)
-      : Synthesizer("grpc"), params_(params) {}
+  GrpcSynthesizer(const GrpcSynthesizerParameters& params,
+                  std::unique_ptr<SynthesisClient> client)
+      : Synthesizer("grpc"), params_(params), client_(std::move(client)) {}
 
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
@@ -47,8 +49,7 @@ class GrpcSynthesizer : public Synthesizer {
     request.set_module_text(verilog_text);
 
     XLS_ASSIGN_OR_RETURN(CompileResponse response,
-                         xls::synthesis::SynthesizeViaClient(
-                             params_.server_and_port(), request));
+                         client_->Synthesize(request));
     if (response.max_frequency_hz() > 0) {
       return static_cast<int64_t>(1e12) / response.max_frequency_hz();
     }
@@ -59,6 +60,9 @@ class GrpcSynthesizer : public Synthesizer {
 
  private:
   const GrpcSynthesizerParameters params_;
+  // Shared by all threads synthesizing through this synthesizer, so it bounds
+  // the total number of requests in flight.
+  std::unique_ptr<SynthesisClient> client_;
 };
 
 }  // namespace
@@ -66,8 +70,17 @@ class GrpcSynthesizer : public Synthesizer {
 absl::StatusOr<std::unique_ptr<Synthesizer>>
 GrpcSynthesizerFactory::CreateSynthesizer(
     const SynthesizerParameters& parameters) {
-  return std::make_unique<GrpcSynthesizer>(
-      down_cast<const GrpcSynthesizerParameters&>(parameters));
+  const auto& grpc_parameters =
+      down_cast<const GrpcSynthesizerParameters&>(parameters);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SynthesisClient> client,
+      SynthesisClient::Create(SynthesisClientOptions{
+          .server = grpc_parameters.server_and_port(),
+          .max_concurrent_requests =
+              grpc_parameters.max_concurrent_requests(),
+          .cache_dir = grpc_parameters.cache_dir(),
+      }));
+  return std::make_unique<GrpcSynthesizer>(grpc_parameters, std::move(client));
 }
 
 XLS_REGISTER_MODULE_INITIALIZER(grpc_synthesizer_factory, {
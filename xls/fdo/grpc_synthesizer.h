@@ -16,9 +16,12 @@
 #define XLS_FDO_GRPC_SYNTHESIZER_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "xls/fdo/synthesizer.h"
@@ -32,21 +35,38 @@ inline constexpr int64_t kDefaultFrequencyHz = 1e9;
 // `server_and_port`: The gRPC endpoint that the `Synthesizer` object should
 //      send requests to. e.g.: "ipv4:///0.0.0.0:10000"
 // `frequency_hz`: The target frequency any designs that will be synthesized.
+// `cache_dir`: If set, a directory in which synthesis results are cached
+//      across runs; see `SynthesisClientOptions::cache_dir`.
+// `max_concurrent_requests`: The maximum number of requests in flight, e.g.
+//      when synthesizing nodes concurrently.
 class GrpcSynthesizerParameters : public SynthesizerParameters {
  public:
-  explicit GrpcSynthesizerParameters(std::string_view server_and_port,
-                                     int64_t frequency_hz = kDefaultFrequencyHz)
+  explicit GrpcSynthesizerParameters(
+      std::string_view server_and_port,
+      int64_t frequency_hz = kDefaultFrequencyHz,
+      std::optional<std::filesystem::path> cache_dir = std::nullopt,
+      int64_t max_concurrent_requests = 16)
       : SynthesizerParameters("grpc"),
         server_and_port_(server_and_port),
-        frequency_hz_(frequency_hz) {}
+        frequency_hz_(frequency_hz),
+        cache_dir_(std::move(cache_dir)),
+        max_concurrent_requests_(max_concurrent_requests) {}
 
   const std::string& server_and_port() const { return server_and_port_; }
 
   int64_t frequency_hz() const { return frequency_hz_; }
 
+  const std::optional<std::filesystem::path>& cache_dir() const {
+    return cache_dir_;
+  }
+
+  int64_t max_concurrent_requests() const { return max_concurrent_requests_; }
+
  private:
   const std::string server_and_port_;
   const int64_t frequency_hz_;
+  const std::optional<std::filesystem::path> cache_dir_;
+  const int64_t max_concurrent_requests_;
 };
 
 // A factory that deals out `Synthesizer` objects that use a gRPC client to talk
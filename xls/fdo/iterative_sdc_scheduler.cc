@@ -39,6 +39,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/fdo/delay_manager.h"
 #include "xls/fdo/node_cut.h"
+#include "xls/fdo/synthesis_dispatcher.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -170,12 +171,13 @@ absl::Status GetMergedWindows(const std::vector<PathInfo> &paths,
 // timing analysis (STA). Then, the results are fed back to the delay manager to
 // refine its estimations. We use node cut as signature to distinguish different
 // subgraphs. The evaluated subgraphs are recorded in "evaluated_cuts" to avoid
-// duplicated evaluation.
+// duplicated evaluation; structurally identical subgraphs with different cuts
+// are deduplicated by the dispatcher.
 absl::Status RefineDelayEstimations(
     FunctionBase *f, const ScheduleCycleMap &cycle_map,
     DelayManager &delay_manager, absl::flat_hash_set<NodeCut> &evaluated_cuts,
     int64_t min_pipeline_length, const IterativeSDCSchedulingOptions &options,
-    absl::BitGenRef bit_gen) {
+    synthesis::SynthesisDispatcher &dispatcher, absl::BitGenRef bit_gen) {
   XLS_ASSIGN_OR_RETURN(
       NodeCutMap cut_map,
       EnumerateMaxCutInSchedule(f, min_pipeline_length, cycle_map));
@@ -241,9 +243,8 @@ absl::Status RefineDelayEstimations(
         GetMergedWindows(targeted_paths, cut_map, nodes_list, evaluated_cuts));
   }
 
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<int64_t> delay_list,
-      options.synthesizer->SynthesizeNodesConcurrentlyAndGetDelays(nodes_list));
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delay_list,
+                       dispatcher.SynthesizeNodesAndGetDelays(nodes_list));
 
   VLOG(1) << "Number of modules generated is " << nodes_list.size();
   for (int64_t j = 0; j < delay_list.size(); ++j) {
@@ -399,6 +400,8 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
 
   ScheduleCycleMap cycle_map;
   absl::flat_hash_set<NodeCut> evaluated_cuts;
+  synthesis::SynthesisDispatcher dispatcher(*options.synthesizer,
+                                            options.dispatcher_options);
   std::mt19937_64 bit_gen;
   for (int64_t i = 0; i < options.iteration_number; ++i) {
     IterativeSDCSchedulingModel model(f, delay_manager);
@@ -485,9 +488,9 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
 
     // Run delay estimation refinement except the last iteration.
     if (i != options.iteration_number - 1) {
-      XLS_RET_CHECK_OK(
-          RefineDelayEstimations(f, cycle_map, delay_manager, evaluated_cuts,
-                                 min_pipeline_length, options, bit_gen));
+      XLS_RET_CHECK_OK(RefineDelayEstimations(
+          f, cycle_map, delay_manager, evaluated_cuts, min_pipeline_length,
+          options, dispatcher, bit_gen));
     }
   }
   return cycle_map;
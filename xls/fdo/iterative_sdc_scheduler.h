@@ -23,6 +23,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/fdo/delay_manager.h"
+#include "xls/fdo/synthesis_dispatcher.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -56,6 +57,9 @@ struct IterativeSDCSchedulingOptions {
   int64_t fanout_driven_path_number = 0;
   float stochastic_ratio = 1.0;
   PathEvaluateStrategy path_evaluate_strategy = PathEvaluateStrategy::WINDOW;
+  // Controls how the subgraphs extracted in each iteration are dispatched to
+  // `synthesizer`.
+  synthesis::SynthesisDispatcherOptions dispatcher_options;
 };
 
 // Runs iterative SDC scheduling. Compared to the original SDC, the iterative
@@ -17,14 +17,18 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/fdo/delay_manager.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -69,14 +73,28 @@ absl::flat_hash_set<Node *> NodeCut::GetNodeCone() const {
   return cone;
 }
 
+namespace {
+
+// A cut together with the estimated delay of the longest path from its leaves
+// to its root, used to rank the cuts of a node.
+struct RankedCut {
+  NodeCut cut;
+  int64_t delay;
+};
+
+using RankedCutsMap = absl::flat_hash_map<Node *, std::vector<RankedCut>>;
+
+}  // namespace
+
 // Add a new cut into the cut set. This method ensures there are no duplicated
 // or dominated cuts.
-static absl::Status AddCut(const NodeCut &cut, std::vector<NodeCut> &cuts) {
+static absl::Status AddCut(const RankedCut &cut, std::vector<RankedCut> &cuts) {
   // Replace an existing cut with the incoming one if the existing cut is a
   // superset. Because a superset means the existing cut has redundant leaves.
   auto super_cut = std::find_if(
-      cuts.begin(), cuts.end(),
-      [&](const NodeCut &exist_cut) { return exist_cut.Includes(cut); });
+      cuts.begin(), cuts.end(), [&](const RankedCut &exist_cut) {
+        return exist_cut.cut.Includes(cut.cut);
+      });
   if (super_cut != cuts.end()) {
     *super_cut = cut;
     return absl::OkStatus();
@@ -84,8 +102,9 @@ static absl::Status AddCut(const NodeCut &cut, std::vector<NodeCut> &cuts) {
 
   // Do nothing and return if the existing cut is a subset of the incoming one.
   auto sub_cut = std::find_if(
-      cuts.begin(), cuts.end(),
-      [&](const NodeCut &exist_cut) { return cut.Includes(exist_cut); });
+      cuts.begin(), cuts.end(), [&](const RankedCut &exist_cut) {
+        return cut.cut.Includes(exist_cut.cut);
+      });
   if (sub_cut != cuts.end()) {
     return absl::OkStatus();
   }
@@ -95,6 +114,95 @@ static absl::Status AddCut(const NodeCut &cut, std::vector<NodeCut> &cuts) {
   return absl::OkStatus();
 }
 
+// Enumerate the cuts of `node` in `cycle` from the (already enumerated) cuts of
+// its operands. The returned cuts are ranked best first, with the trivial cut,
+// if any, in front.
+static absl::StatusOr<std::vector<RankedCut>> EnumerateNodeCuts(
+    Node *node, int64_t cycle, const ScheduleCycleMap &cycle_map,
+    const RankedCutsMap &cuts_map, const CutEnumerationOptions &options) {
+  int64_t node_delay = 0;
+  if (options.delay_manager != nullptr) {
+    XLS_ASSIGN_OR_RETURN(node_delay,
+                         options.delay_manager->GetNodeDelay(node));
+  }
+
+  // Holds the non-trivial cuts owned by the current node.
+  std::vector<RankedCut> cuts;
+
+  // Enumerate and merge every combination of operands' cuts. We adapt a
+  // worklist algorithm for the enumeration. Each item also carries the largest
+  // delay of the operand cuts merged so far.
+  struct WorkItem {
+    NodeCut cut;
+    Node *const *operand;
+    int64_t delay;
+  };
+  std::vector<WorkItem> worklist(
+      {WorkItem{NodeCut(node), node->operands().begin(), 0}});
+
+  while (!worklist.empty()) {
+    WorkItem current = std::move(worklist.back());
+    worklist.pop_back();
+
+    // Leaves are only ever added by merging, so a partial cut over the leaf
+    // limit can be dropped right away.
+    if (options.max_leaves.has_value() &&
+        current.cut.leaves().size() > *options.max_leaves) {
+      continue;
+    }
+
+    // Continue if we already finished the merging.
+    if (current.operand == node->operands().end()) {
+      XLS_RETURN_IF_ERROR(
+          AddCut(RankedCut{std::move(current.cut), node_delay + current.delay},
+                 cuts));
+      continue;
+    }
+
+    // The operand cycle should not be larger than the current cycle.
+    Node *operand = *current.operand;
+    int64_t operand_cycle = cycle_map.at(operand);
+    XLS_RET_CHECK_LE(operand_cycle, cycle);
+    if (operand_cycle < cycle || operand->Is<Param>()) {
+      // If the operand cycle is smaller than the current cycle, the operand
+      // is considered as a PI.
+      worklist.push_back(WorkItem{
+          NodeCut::GetMergedCut(node, current.cut,
+                                NodeCut::GetTrivialCut(operand)),
+          std::next(current.operand), current.delay});
+    } else {
+      // Otherwise, the operand is internal node whose cuts are merged.
+      for (const RankedCut &cut : cuts_map.at(operand)) {
+        worklist.push_back(
+            WorkItem{NodeCut::GetMergedCut(node, current.cut, cut.cut),
+                     std::next(current.operand),
+                     std::max(current.delay, cut.delay)});
+      }
+    }
+  }
+
+  // Rank the cuts, longest path first and then fewest leaves. The sort is
+  // stable so that ties keep the deterministic enumeration order.
+  std::stable_sort(cuts.begin(), cuts.end(),
+                   [](const RankedCut &lhs, const RankedCut &rhs) {
+                     if (lhs.delay != rhs.delay) {
+                       return lhs.delay > rhs.delay;
+                     }
+                     return lhs.cut.leaves().size() < rhs.cut.leaves().size();
+                   });
+  if (options.max_cuts_per_node.has_value() &&
+      cuts.size() > *options.max_cuts_per_node) {
+    cuts.erase(cuts.begin() + *options.max_cuts_per_node, cuts.end());
+  }
+
+  // If we only allow PI to be cut leaves, we will not add the trivial cut of
+  // any internal node. Its leaf is the root itself, so it has no delay.
+  if (!options.input_leaves_only) {
+    cuts.insert(cuts.begin(), RankedCut{NodeCut::GetTrivialCut(node), 0});
+  }
+  return cuts;
+}
+
 absl::StatusOr<NodeCutMap> EnumerateMaxCutInSchedule(
     FunctionBase *f, int64_t pipeline_length,
     const ScheduleCycleMap &cycle_map) {
@@ -112,76 +220,84 @@ absl::StatusOr<NodeCutMap> EnumerateMaxCutInSchedule(
 absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
     FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
     bool input_leaves_only) {
-  // First, we topologically sort the nodes in every cycle of the schedule.
-  std::vector<std::vector<Node *>> cycle_to_sorted_nodes;
-  cycle_to_sorted_nodes.resize(pipeline_length);
+  CutEnumerationOptions options;
+  options.input_leaves_only = input_leaves_only;
+  return EnumerateCutsInSchedule(f, pipeline_length, cycle_map, options);
+}
+
+absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
+    FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
+    const CutEnumerationOptions &options) {
+  // First, we topologically sort the nodes and group them into frontiers: the
+  // level of a node is one more than the largest level of its operands in the
+  // same pipeline cycle. Operands from earlier cycles and params are cut
+  // leaves, so the cuts of the nodes at one level only depend on the cuts of
+  // lower levels, whichever cycle they are in.
+  std::vector<std::vector<Node *>> level_to_sorted_nodes;
+  absl::flat_hash_map<Node *, int64_t> levels;
   for (Node *node : TopoSort(f)) {
-    cycle_to_sorted_nodes[cycle_map.at(node)].emplace_back(node);
+    // Param operation is considered as a primary input (PI).
+    if (node->Is<Param>()) {
+      continue;
+    }
+    int64_t cycle = cycle_map.at(node);
+    XLS_RET_CHECK_LT(cycle, pipeline_length);
+    int64_t level = 0;
+    for (Node *operand : node->operands()) {
+      auto it = levels.find(operand);
+      if (it != levels.end() && cycle_map.at(operand) == cycle) {
+        level = std::max(level, it->second + 1);
+      }
+    }
+    levels.emplace(node, level);
+    if (level >= level_to_sorted_nodes.size()) {
+      level_to_sorted_nodes.resize(level + 1);
+    }
+    level_to_sorted_nodes[level].push_back(node);
   }
 
-  // Then, we traverse the nodes in every cycle to enumerate the cuts of every
-  // node. As we have topologically sorted the nodes, for each node, we can
-  // enumerate and merge every combination of its operands' cuts. For the input
-  // nodes, a.k.a. a node with only live-in operands of the current pipeline
-  // cycle or no operand, the cuts should only contain the trivial cut.
-  int64_t cycle = 0;
-  NodeCutsMap cuts_map;
-  for (const std::vector<Node *> &sorted_nodes : cycle_to_sorted_nodes) {
-    for (Node *node : sorted_nodes) {
-      // Param operation is considered as a primary input (PI).
-      if (node->Is<Param>()) {
-        continue;
+  // Then, we traverse the levels in order to enumerate the cuts of every node.
+  // As the operands of a node are at lower levels, we can enumerate and merge
+  // every combination of its operands' cuts. For the input nodes, a.k.a. a
+  // node with only live-in operands of the current pipeline cycle or no
+  // operand, the cuts should only contain the trivial cut. The nodes of a level
+  // only read the cuts map, so they are enumerated concurrently and their cuts
+  // are added to the map once the whole level is done.
+  RankedCutsMap cuts_map;
+  for (const std::vector<Node *> &sorted_nodes : level_to_sorted_nodes) {
+    std::vector<absl::StatusOr<std::vector<RankedCut>>> level_cuts(
+        sorted_nodes.size());
+    auto enumerate = [&](int64_t i) {
+      Node *node = sorted_nodes[i];
+      level_cuts[i] = EnumerateNodeCuts(node, cycle_map.at(node), cycle_map,
+                                        cuts_map, options);
+    };
+    if (options.parallel && sorted_nodes.size() > 1) {
+      TaskGroup group;
+      for (int64_t i = 0; i < sorted_nodes.size(); ++i) {
+        group.Schedule([&enumerate, i] { enumerate(i); });
       }
-
-      // Holds the cuts owned by the current node.
-      std::vector<NodeCut> cuts;
-
-      // If we only allow PI to be cut leaves, we will not add the trivial cut
-      // of any internal node.
-      if (!input_leaves_only) {
-        XLS_RET_CHECK_OK(AddCut(NodeCut::GetTrivialCut(node), cuts));
+      XLS_RETURN_IF_ERROR(group.Wait());
+    } else {
+      for (int64_t i = 0; i < sorted_nodes.size(); ++i) {
+        enumerate(i);
       }
+    }
+    for (int64_t i = 0; i < sorted_nodes.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(cuts_map[sorted_nodes[i]], std::move(level_cuts[i]));
+    }
+  }
 
-      // Enumerate and merge every combination of operands' cuts. We adapt a
-      // worklist algorithm for the enumeration.
-      std::vector<std::pair<NodeCut, Node *const *>> worklist(
-          {std::make_pair(NodeCut(node), node->operands().begin())});
-
-      while (!worklist.empty()) {
-        NodeCut current_cut = worklist.back().first;
-        Node *const *operand = worklist.back().second;
-        worklist.pop_back();
-
-        // Continue if we already finished the merging.
-        if (operand == node->operands().end()) {
-          XLS_RET_CHECK_OK(AddCut(current_cut, cuts));
-          continue;
-        }
-
-        // The operand cycle should not be larger than the current cycle.
-        int64_t operand_cycle = cycle_map.at(*operand);
-        XLS_RET_CHECK_LE(operand_cycle, cycle);
-        if (operand_cycle < cycle || (*operand)->Is<Param>()) {
-          // If the operand cycle is smaller than the current cycle, the operand
-          // is considered as a PI.
-          worklist.emplace_back(std::make_pair(
-              NodeCut::GetMergedCut(node, current_cut,
-                                    NodeCut::GetTrivialCut(*operand)),
-              std::next(operand)));
-        } else {
-          // Otherwise, the operand is internal node whose cuts are merged.
-          for (const NodeCut &cut : cuts_map.at(*operand)) {
-            worklist.emplace_back(
-                std::make_pair(NodeCut::GetMergedCut(node, current_cut, cut),
-                               std::next(operand)));
-          }
-        }
-      }
-      cuts_map.emplace(node, cuts);
+  NodeCutsMap result;
+  result.reserve(cuts_map.size());
+  for (auto &[node, ranked_cuts] : cuts_map) {
+    std::vector<NodeCut> &cuts = result[node];
+    cuts.reserve(ranked_cuts.size());
+    for (RankedCut &ranked_cut : ranked_cuts) {
+      cuts.push_back(std::move(ranked_cut.cut));
     }
-    cycle++;
   }
-  return cuts_map;
+  return result;
 }
 
 }  // namespace xls
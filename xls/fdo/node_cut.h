@@ -16,12 +16,14 @@
 #define XLS_FDO_NODE_CUT_H_
 
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "xls/fdo/delay_manager.h"
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -103,12 +105,40 @@ absl::StatusOr<NodeCutMap> EnumerateMaxCutInSchedule(
     FunctionBase *f, int64_t pipeline_length,
     const ScheduleCycleMap &cycle_map);
 
+// Options controlling how many cuts are kept per node during enumeration.
+struct CutEnumerationOptions {
+  // All cuts will have primary input (PI) or pipeline register as leaves if
+  // set true. There is then at most one cut per node.
+  bool input_leaves_only = true;
+
+  // Priority cuts: keep at most this many non-trivial cuts per node, chosen by
+  // rank (see `delay_manager`). The trivial cut is kept in addition. Operand
+  // cut sets are truncated before they are merged, so this also bounds the
+  // number of merges per node to max_cuts_per_node^operand_count.
+  std::optional<int64_t> max_cuts_per_node;
+
+  // Drop cuts with more leaves than this. Nodes all of whose cuts are dropped
+  // only have the trivial cut, or no cut at all if input_leaves_only is set.
+  std::optional<int64_t> max_leaves;
+
+  // Delay estimations used to rank cuts: the cut whose cone has the longest
+  // path from its leaves to its root ranks first, as it covers the most of the
+  // critical path in a single synthesized subgraph. Ties, and all cuts when
+  // this is null, are ranked by fewer leaves.
+  const DelayManager *delay_manager = nullptr;
+
+  // Enumerate the cuts of the nodes at the same topological level (within
+  // their pipeline cycle) concurrently on the shared thread pool.
+  bool parallel = true;
+};
+
 // Cuts enumeration is used to construct a cuts map. Note that the enumeration
 // will be applied to each pipeline cycle separately. As a result, there will be
-// no cut crossing different pipeline cycles. All cuts will have primary input
-// (PI) or pipeline register as leaves if input_leaves_only is set true.
-// TODO(hanchenye): 2023-08-14 We should add an optional argument to constrain
-// the maximum number of leaves.
+// no cut crossing different pipeline cycles. The cuts of every node are sorted
+// by rank, best first; see CutEnumerationOptions.
+absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
+    FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
+    const CutEnumerationOptions &options);
 absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
     FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
     bool input_leaves_only = true);
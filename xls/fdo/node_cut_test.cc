@@ -14,12 +14,14 @@
 
 #include "xls/fdo/node_cut.h"
 
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
+#include "xls/fdo/delay_manager.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -124,5 +126,77 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   }
 }
 
+TEST_F(NodeCutTest, PriorityCutsEnumeration) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  sub.2: bits[3] = sub(add.1, i1)
+  ret udiv.3: bits[3] = udiv(sub.2, add.1)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  Node *i0 = FindNode("i0", function);
+  Node *i1 = FindNode("i1", function);
+  Node *add1 = FindNode("add.1", function);
+  Node *sub2 = FindNode("sub.2", function);
+  Node *udiv3 = FindNode("udiv.3", function);
+
+  ScheduleCycleMap cycle_map;
+  for (Node *node : function->nodes()) {
+    cycle_map[node] = 0;
+  }
+
+  DelayManager delay_manager(function, TestDelayEstimator());
+  CutEnumerationOptions options;
+  options.input_leaves_only = false;
+  options.delay_manager = &delay_manager;
+
+  // The cuts of udiv.3 are ranked by the delay of their cones: {i0, i1} covers
+  // add.1, sub.2 and udiv.3 (4), {add.1, i1} covers sub.2 and udiv.3 (3) and
+  // {sub.2, add.1} only covers udiv.3 (2).
+  options.max_cuts_per_node = 2;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NodeCutsMap cuts_map,
+      EnumerateCutsInSchedule(function, 1, cycle_map, options));
+  const std::vector<NodeCut> &udiv3_cuts = cuts_map.at(udiv3);
+  EXPECT_EQ(udiv3_cuts.size(), 3);
+  if (udiv3_cuts.size() == 3) {
+    EXPECT_TRUE(udiv3_cuts.at(0).IsTrivial());
+    EXPECT_TRUE(udiv3_cuts.at(1) == NodeCut(udiv3, {i0, i1}));
+    EXPECT_TRUE(udiv3_cuts.at(2) == NodeCut(udiv3, {add1, i1}));
+  }
+
+  options.max_cuts_per_node = 1;
+  options.parallel = false;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      cuts_map, EnumerateCutsInSchedule(function, 1, cycle_map, options));
+  const std::vector<NodeCut> &sub2_cuts = cuts_map.at(sub2);
+  EXPECT_EQ(sub2_cuts.size(), 2);
+  if (sub2_cuts.size() == 2) {
+    EXPECT_TRUE(sub2_cuts.at(0).IsTrivial());
+    EXPECT_TRUE(sub2_cuts.at(1) == NodeCut(sub2, {i0, i1}));
+  }
+  const std::vector<NodeCut> &udiv3_top_cuts = cuts_map.at(udiv3);
+  EXPECT_EQ(udiv3_top_cuts.size(), 2);
+  if (udiv3_top_cuts.size() == 2) {
+    EXPECT_TRUE(udiv3_top_cuts.at(0).IsTrivial());
+    EXPECT_TRUE(udiv3_top_cuts.at(1) == NodeCut(udiv3, {i0, i1}));
+  }
+
+  // With a single leaf allowed, only the trivial cuts remain.
+  options.max_cuts_per_node = std::nullopt;
+  options.max_leaves = 1;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      cuts_map, EnumerateCutsInSchedule(function, 1, cycle_map, options));
+  for (Node *node : {add1, sub2, udiv3}) {
+    EXPECT_EQ(cuts_map.at(node).size(), 1);
+    EXPECT_TRUE(cuts_map.at(node).front().IsTrivial());
+  }
+}
+
 }  // namespace
 }  // namespace xls
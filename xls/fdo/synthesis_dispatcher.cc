@@ -0,0 +1,234 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesis_dispatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/cache_key.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/fdo/extract_nodes.h"
+#include "xls/fdo/synthesizer.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+constexpr std::string_view kTopName = "tmp_module";
+
+// Calls `fn(i)` for each `i` in [0, count), with at most `max_in_flight` calls
+// running at once on the shared thread pool.
+absl::Status ParallelFor(int64_t count, int64_t max_in_flight,
+                         absl::FunctionRef<void(int64_t)> fn) {
+  int64_t task_count = std::min(count, max_in_flight);
+  if (task_count <= 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return absl::OkStatus();
+  }
+  std::atomic<int64_t> next_index = 0;
+  TaskGroup group;
+  for (int64_t t = 0; t < task_count; ++t) {
+    group.Schedule([&]() {
+      for (int64_t i = next_index.fetch_add(1); i < count;
+           i = next_index.fetch_add(1)) {
+        fn(i);
+      }
+    });
+  }
+  return group.Wait();
+}
+
+}  // namespace
+
+SynthesisDispatcher::SynthesisDispatcher(const Synthesizer& synthesizer,
+                                         SynthesisDispatcherOptions options)
+    : synthesizer_(synthesizer), options_(std::move(options)) {
+  if (options_.max_in_flight <= 0) {
+    options_.max_in_flight = std::max(AvailableCPUs(), 1);
+  }
+  if (options_.cache_directory.has_value()) {
+    pdk_directory_ = *options_.cache_directory /
+                     CacheKey({options_.pdk}).substr(0, 16);
+  }
+}
+
+absl::StatusOr<std::string> SynthesisDispatcher::CanonicalVerilog(
+    const absl::flat_hash_set<Node*>& nodes) const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> tmp_package,
+                       ExtractNodes(nodes, kTopName));
+  XLS_ASSIGN_OR_RETURN(Function * f, tmp_package->GetFunction(kTopName));
+  // Names and source locations are inherited from the original function and
+  // would otherwise make every subgraph unique.
+  int64_t index = 0;
+  for (Node* node : TopoSort(f)) {
+    node->SetName(
+        absl::StrFormat("%s%d", node->Is<Param>() ? "p" : "n", index++));
+    node->SetLoc(SourceInfo());
+  }
+  return synthesizer_.FunctionBaseToVerilog(f, /*flop_inputs_outputs=*/true);
+}
+
+std::string SynthesisDispatcher::ComputeKey(
+    std::string_view verilog_text) const {
+  return CacheKey({options_.pdk, verilog_text});
+}
+
+std::optional<int64_t> SynthesisDispatcher::LookUp(const std::string& key) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = delays_.find(key);
+    if (it != delays_.end()) {
+      ++cache_hit_count_;
+      return it->second;
+    }
+  }
+  if (!pdk_directory_.has_value()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> contents =
+      GetFileContents(*pdk_directory_ / key);
+  int64_t delay;
+  if (!contents.ok() ||
+      !absl::SimpleAtoi(absl::StripAsciiWhitespace(*contents), &delay)) {
+    return std::nullopt;
+  }
+  absl::MutexLock lock(&mutex_);
+  ++cache_hit_count_;
+  delays_[key] = delay;
+  return delay;
+}
+
+void SynthesisDispatcher::Store(const std::string& key, int64_t delay) {
+  {
+    absl::MutexLock lock(&mutex_);
+    delays_[key] = delay;
+  }
+  if (!pdk_directory_.has_value()) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(*pdk_directory_, ec);
+  if (ec) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to create synthesis cache directory %s: %s",
+        pdk_directory_->string(), ec.message());
+    return;
+  }
+  std::filesystem::path path = *pdk_directory_ / key;
+  absl::Status status =
+      AtomicSetFileContents(path, absl::StrCat(delay, "\n"));
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write synthesis cache entry %s: %s", path.string(),
+        status.ToString());
+  }
+}
+
+absl::StatusOr<std::vector<int64_t>>
+SynthesisDispatcher::SynthesizeNodesAndGetDelays(
+    absl::Span<const absl::flat_hash_set<Node*>> nodes_list) {
+  // Generating Verilog runs codegen, so it is spread over the workers too.
+  std::vector<absl::StatusOr<std::string>> verilog_texts(nodes_list.size());
+  XLS_RETURN_IF_ERROR(
+      ParallelFor(nodes_list.size(), options_.max_in_flight, [&](int64_t i) {
+        verilog_texts[i] = CanonicalVerilog(nodes_list[i]);
+      }));
+
+  // Resolve what we can from the caches; everything else is synthesized once
+  // per distinct key.
+  std::vector<std::optional<int64_t>> delays(nodes_list.size());
+  std::vector<std::string> keys(nodes_list.size());
+  std::vector<int64_t> pending;
+  absl::flat_hash_map<std::string, int64_t> first_pending_with_key;
+  for (int64_t i = 0; i < nodes_list.size(); ++i) {
+    XLS_RETURN_IF_ERROR(verilog_texts[i].status());
+    if (verilog_texts[i]->empty()) {
+      delays[i] = 0;
+      continue;
+    }
+    keys[i] = ComputeKey(*verilog_texts[i]);
+    delays[i] = LookUp(keys[i]);
+    if (!delays[i].has_value() &&
+        first_pending_with_key.emplace(keys[i], i).second) {
+      pending.push_back(i);
+    }
+  }
+
+  std::vector<absl::StatusOr<int64_t>> results(pending.size(), 0);
+  XLS_RETURN_IF_ERROR(
+      ParallelFor(pending.size(), options_.max_in_flight, [&](int64_t j) {
+        results[j] = synthesizer_.SynthesizeVerilogAndGetDelay(
+            *verilog_texts[pending[j]], kTopName);
+      }));
+  {
+    absl::MutexLock lock(&mutex_);
+    synthesis_count_ += pending.size();
+  }
+  absl::flat_hash_map<std::string, int64_t> synthesized;
+  for (int64_t j = 0; j < pending.size(); ++j) {
+    XLS_RETURN_IF_ERROR(results[j].status());
+    Store(keys[pending[j]], *results[j]);
+    synthesized[keys[pending[j]]] = *results[j];
+  }
+
+  std::vector<int64_t> delay_list;
+  delay_list.reserve(nodes_list.size());
+  for (int64_t i = 0; i < nodes_list.size(); ++i) {
+    if (!delays[i].has_value()) {
+      // Duplicates of a subgraph synthesized in this batch count as hits.
+      if (first_pending_with_key.at(keys[i]) != i) {
+        absl::MutexLock lock(&mutex_);
+        ++cache_hit_count_;
+      }
+      delays[i] = synthesized.at(keys[i]);
+    }
+    delay_list.push_back(*delays[i]);
+  }
+  return delay_list;
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FDO_SYNTHESIS_DISPATCHER_H_
+#define XLS_FDO_SYNTHESIS_DISPATCHER_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/fdo/synthesizer.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace synthesis {
+
+struct SynthesisDispatcherOptions {
+  // The maximum number of syntheses in flight at once. Zero means one per
+  // available CPU.
+  int64_t max_in_flight = 0;
+
+  // If set, synthesized delays are persisted in this directory and reused by
+  // later runs with the same `pdk`.
+  std::optional<std::filesystem::path> cache_directory;
+
+  // Identifies the process design kit and synthesis settings the delays are
+  // obtained with, e.g. the synthesizer name and Liberty files. Delays cached
+  // for one PDK are never returned for another.
+  std::string pdk;
+};
+
+// Dispatches batches of subgraphs to a `Synthesizer` and collects their
+// delays. Compared to `Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays`,
+// the dispatcher:
+//
+//  * bounds the number of syntheses running concurrently,
+//  * synthesizes structurally identical subgraphs once, identifying them by a
+//    hash of their Verilog with nodes named by position, and
+//  * remembers the delay of every subgraph it has synthesized, both for the
+//    lifetime of the dispatcher and, optionally, on disk.
+//
+// The dispatcher uses the synthesizer's `FunctionBaseToVerilog` and
+// `SynthesizeVerilogAndGetDelay`; overrides of `SynthesizeNodesAndGetDelay`
+// are bypassed.
+class SynthesisDispatcher {
+ public:
+  explicit SynthesisDispatcher(const Synthesizer& synthesizer,
+                               SynthesisDispatcherOptions options = {});
+
+  // Returns the delay of each set of nodes in `nodes_list`, in order.
+  absl::StatusOr<std::vector<int64_t>> SynthesizeNodesAndGetDelays(
+      absl::Span<const absl::flat_hash_set<Node*>> nodes_list);
+
+  // Returns the Verilog module synthesized for `nodes`, in which every node is
+  // named after its position in topological order so that structurally
+  // identical subgraphs produce identical text. Returns an empty string if
+  // there is nothing to synthesize.
+  absl::StatusOr<std::string> CanonicalVerilog(
+      const absl::flat_hash_set<Node*>& nodes) const;
+
+  // The number of syntheses actually run, and the number of subgraphs whose
+  // delay was found in the in-memory or on-disk cache instead.
+  int64_t synthesis_count() const {
+    absl::MutexLock lock(&mutex_);
+    return synthesis_count_;
+  }
+  int64_t cache_hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return cache_hit_count_;
+  }
+
+ private:
+  std::string ComputeKey(std::string_view verilog_text) const;
+  std::optional<int64_t> LookUp(const std::string& key);
+  void Store(const std::string& key, int64_t delay);
+
+  const Synthesizer& synthesizer_;
+  SynthesisDispatcherOptions options_;
+  // Directory holding the on-disk cache entries for `options_.pdk`.
+  std::optional<std::filesystem::path> pdk_directory_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> delays_ ABSL_GUARDED_BY(mutex_);
+  int64_t synthesis_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t cache_hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_FDO_SYNTHESIS_DISPATCHER_H_
@@ -0,0 +1,181 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesis_dispatcher.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fdo/synthesizer.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+using NodeSet = absl::flat_hash_set<Node*>;
+
+// Reports the length of the Verilog as its delay and records how many
+// syntheses it ran, and how many of them overlapped at most.
+class CountingSynthesizer : public synthesis::Synthesizer {
+ public:
+  CountingSynthesizer() : synthesis::Synthesizer("CountingSynthesizer") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    ++call_count_;
+    int64_t in_flight = ++in_flight_;
+    int64_t max_in_flight = max_in_flight_.load();
+    while (in_flight > max_in_flight &&
+           !max_in_flight_.compare_exchange_weak(max_in_flight, in_flight)) {
+    }
+    absl::SleepFor(absl::Milliseconds(10));
+    --in_flight_;
+    return verilog_text.size();
+  }
+
+  int64_t call_count() const { return call_count_; }
+  int64_t max_in_flight() const { return max_in_flight_; }
+
+ private:
+  mutable std::atomic<int64_t> call_count_ = 0;
+  mutable std::atomic<int64_t> in_flight_ = 0;
+  mutable std::atomic<int64_t> max_in_flight_ = 0;
+};
+
+class SynthesisDispatcherTest : public IrTestBase {};
+
+TEST_F(SynthesisDispatcherTest, DeduplicatesIdenticalSubgraphs) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue a = fb.Param("a", p->GetBitsType(8));
+  BValue b = fb.Param("b", p->GetBitsType(8));
+  BValue add0 = fb.Add(x, y);
+  BValue not0 = fb.Not(add0);
+  BValue add1 = fb.Add(a, b);
+  BValue not1 = fb.Not(add1);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple({not0, not1})).status());
+
+  CountingSynthesizer synthesizer;
+  synthesis::SynthesisDispatcher dispatcher(synthesizer);
+  std::vector<NodeSet> nodes_list = {{add0.node(), not0.node()},
+                                     {add1.node(), not1.node()},
+                                     {add0.node()}};
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> delays,
+                           dispatcher.SynthesizeNodesAndGetDelays(nodes_list));
+  ASSERT_EQ(delays.size(), 3);
+  EXPECT_EQ(delays[0], delays[1]);
+  EXPECT_NE(delays[0], delays[2]);
+  EXPECT_EQ(synthesizer.call_count(), 2);
+  EXPECT_EQ(dispatcher.synthesis_count(), 2);
+  EXPECT_EQ(dispatcher.cache_hit_count(), 1);
+
+  // Subgraphs seen before are not synthesized again.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> again,
+      dispatcher.SynthesizeNodesAndGetDelays({NodeSet{add1.node()}}));
+  EXPECT_THAT(again, ElementsAre(delays[2]));
+  EXPECT_EQ(synthesizer.call_count(), 2);
+  EXPECT_EQ(dispatcher.cache_hit_count(), 2);
+}
+
+TEST_F(SynthesisDispatcherTest, LimitsInFlightSyntheses) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<NodeSet> nodes_list;
+  std::vector<BValue> elements;
+  for (int64_t width = 1; width <= 8; ++width) {
+    BValue x = fb.Param(absl::StrCat("x", width), p->GetBitsType(width));
+    BValue negated = fb.Negate(x);
+    elements.push_back(negated);
+    nodes_list.push_back({negated.node()});
+  }
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple(elements)).status());
+
+  CountingSynthesizer synthesizer;
+  synthesis::SynthesisDispatcher dispatcher(
+      synthesizer, synthesis::SynthesisDispatcherOptions{.max_in_flight = 2});
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> delays,
+                           dispatcher.SynthesizeNodesAndGetDelays(nodes_list));
+  EXPECT_EQ(delays.size(), nodes_list.size());
+  EXPECT_EQ(synthesizer.call_count(), nodes_list.size());
+  EXPECT_LE(synthesizer.max_in_flight(), 2);
+}
+
+TEST_F(SynthesisDispatcherTest, PersistsDelaysPerPdk) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue product = fb.UMul(x, y);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(product).status());
+  std::vector<NodeSet> nodes_list = {{product.node()}};
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  auto options_for_pdk = [&](std::string_view pdk) {
+    return synthesis::SynthesisDispatcherOptions{
+        .cache_directory = cache_dir.path(), .pdk = std::string(pdk)};
+  };
+
+  CountingSynthesizer synthesizer;
+  int64_t delay;
+  {
+    synthesis::SynthesisDispatcher dispatcher(synthesizer,
+                                              options_for_pdk("pdk_a"));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> delays,
+        dispatcher.SynthesizeNodesAndGetDelays(nodes_list));
+    ASSERT_EQ(delays.size(), 1);
+    delay = delays[0];
+    EXPECT_EQ(synthesizer.call_count(), 1);
+  }
+  {
+    // A new dispatcher for the same PDK reads the delay back from disk.
+    synthesis::SynthesisDispatcher dispatcher(synthesizer,
+                                              options_for_pdk("pdk_a"));
+    EXPECT_THAT(dispatcher.SynthesizeNodesAndGetDelays(nodes_list),
+                status_testing::IsOkAndHolds(ElementsAre(delay)));
+    EXPECT_EQ(synthesizer.call_count(), 1);
+    EXPECT_EQ(dispatcher.cache_hit_count(), 1);
+  }
+  {
+    // Delays cached for one PDK are not used for another.
+    synthesis::SynthesisDispatcher dispatcher(synthesizer,
+                                              options_for_pdk("pdk_b"));
+    XLS_ASSERT_OK(dispatcher.SynthesizeNodesAndGetDelays(nodes_list).status());
+    EXPECT_EQ(synthesizer.call_count(), 2);
+    EXPECT_EQ(dispatcher.cache_hit_count(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace xls
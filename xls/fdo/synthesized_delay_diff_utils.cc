@@ -121,13 +121,35 @@ absl::StatusOr<SynthesizedDelayDiffByStage> CreateDelayDiffByStage(
   SynthesizedDelayDiffByStage result;
   result.stage_diffs.reserve(schedule.length());
   result.stage_percent_diffs.resize(schedule.length());
+  // Extract and analyze every stage first so that the stages can then be
+  // synthesized concurrently.
+  std::vector<FunctionBase*> stage_functions;
+  stage_functions.reserve(schedule.length());
   for (int i = 0; i < schedule.length(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Function * stage_function,
+                         ExtractStage(f, schedule, i));
     XLS_ASSIGN_OR_RETURN(
-        SynthesizedDelayDiff stage_diff,
-        CreateDelayDiffForStage(f, schedule, delay_estimator, synthesizer, i));
+        std::vector<CriticalPathEntry> critical_path,
+        AnalyzeCriticalPath(stage_function, /*clock_period_ps=*/std::nullopt,
+                            delay_estimator));
+    SynthesizedDelayDiff& stage_diff = result.stage_diffs.emplace_back();
+    stage_diff.xls_delay_ps =
+        critical_path.empty() ? 0 : critical_path[0].path_delay_ps;
+    stage_diff.critical_path = std::move(critical_path);
+    stage_functions.push_back(stage_function);
+  }
+  if (synthesizer) {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<int64_t> delays,
+        synthesizer->SynthesizeFunctionBasesConcurrentlyAndGetDelays(
+            stage_functions));
+    for (int i = 0; i < schedule.length(); ++i) {
+      result.stage_diffs[i].synthesized_delay_ps = delays[i];
+    }
+  }
+  for (const SynthesizedDelayDiff& stage_diff : result.stage_diffs) {
     result.total_diff.synthesized_delay_ps += stage_diff.synthesized_delay_ps;
     result.total_diff.xls_delay_ps += stage_diff.xls_delay_ps;
-    result.stage_diffs.emplace_back(std::move(stage_diff));
   }
   for (int i = 0; i < schedule.length(); ++i) {
     const SynthesizedDelayDiff& stage_diff = result.stage_diffs[i];
@@ -77,6 +77,41 @@ Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
   return delay_list;
 }
 
+absl::StatusOr<std::vector<int64_t>>
+Synthesizer::SynthesizeFunctionBasesConcurrentlyAndGetDelays(
+    absl::Span<FunctionBase *const> fs) const {
+  std::vector<std::string> verilog_texts;
+  verilog_texts.reserve(fs.size());
+  for (FunctionBase *f : fs) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string verilog_text,
+        FunctionBaseToVerilog(f, /*flop_inputs_outputs=*/true));
+    verilog_texts.push_back(std::move(verilog_text));
+  }
+
+  std::vector<absl::StatusOr<int64_t>> results(fs.size(), 0);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < fs.size(); ++i) {
+    if (verilog_texts[i].empty()) {
+      continue;
+    }
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      results[i] =
+          SynthesizeVerilogAndGetDelay(verilog_texts[i], fs[i]->name());
+    }));
+  }
+  for (auto &t : threads) {
+    t->Join();
+  }
+  std::vector<int64_t> delay_list;
+  delay_list.reserve(results.size());
+  for (absl::StatusOr<int64_t> result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    delay_list.push_back(result.value());
+  }
+  return delay_list;
+}
+
 absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
     const absl::flat_hash_set<Node *> &nodes) const {
   std::string top_name = "tmp_module";
@@ -75,6 +75,13 @@ class Synthesizer {
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
+  // Variant of `SynthesizeFunctionBaseAndGetDelay` for several functions or
+  // procs. The Verilog is generated sequentially, since codegen modifies the
+  // package, and then synthesized concurrently.
+  absl::StatusOr<std::vector<int64_t>>
+  SynthesizeFunctionBasesConcurrentlyAndGetDelays(
+      absl::Span<FunctionBase *const> fs) const;
+
  private:
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
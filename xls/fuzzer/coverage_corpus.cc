@@ -0,0 +1,176 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_corpus.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/discrete_distribution.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+// Buckets widths so that features distinguish the width classes which take
+// different paths through the passes and the JIT without making every width
+// a new feature.
+std::string_view WidthBucket(int64_t width) {
+  if (width == 0) {
+    return "0";
+  }
+  if (width == 1) {
+    return "1";
+  }
+  if (width <= 8) {
+    return "<=8";
+  }
+  if (width <= 32) {
+    return "<=32";
+  }
+  if (width <= 64) {
+    return "<=64";
+  }
+  return ">64";
+}
+
+// Adds the IR features of the package in the file `path`, if it exists.
+absl::Status AddIrFileFeatures(const std::filesystem::path& path,
+                               std::string_view stage,
+                               SampleFeatures& features) {
+  if (!FileExists(path).ok()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, path.string()));
+  AddIrFeatures(package.get(), stage, features);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+void AddIrFeatures(Package* package, std::string_view stage,
+                   SampleFeatures& features) {
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    for (Node* node : f->nodes()) {
+      Type* type = node->GetType();
+      features.insert(absl::StrCat(stage, ":", OpToString(node->op()), ":",
+                                   TypeKindToString(type->kind()), ":",
+                                   WidthBucket(type->GetFlatBitCount())));
+    }
+  }
+}
+
+void AddPassFeatures(const PassPipelineProfileProto& profile,
+                     SampleFeatures& features) {
+  for (const PassInvocationProfileProto& invocation : profile.invocations()) {
+    if (invocation.ir_changed()) {
+      features.insert(absl::StrCat("pass:", invocation.pass_name()));
+    }
+  }
+}
+
+absl::StatusOr<SampleFeatures> GetSampleFeatures(
+    const std::filesystem::path& run_dir) {
+  SampleFeatures features;
+  XLS_RETURN_IF_ERROR(
+      AddIrFileFeatures(run_dir / "sample.ir", "unopt", features));
+  XLS_RETURN_IF_ERROR(
+      AddIrFileFeatures(run_dir / "sample.opt.ir", "opt", features));
+  std::filesystem::path profile_path = run_dir / kPassProfileFileName;
+  if (FileExists(profile_path).ok()) {
+    PassPipelineProfileProto profile;
+    XLS_RETURN_IF_ERROR(ParseTextProtoFile(profile_path, &profile));
+    AddPassFeatures(profile, features);
+  }
+  return features;
+}
+
+int64_t CoverageCorpus::AddSample(const Sample& sample,
+                                  const SampleFeatures& features) {
+  absl::MutexLock lock(&mutex_);
+  int64_t new_features = 0;
+  for (const std::string& feature : features) {
+    if (features_.insert(feature).second) {
+      ++new_features;
+    }
+  }
+  if (new_features == 0 || max_size_ <= 0) {
+    return new_features;
+  }
+  if (entries_.size() >= max_size_) {
+    auto lowest = absl::c_min_element(
+        entries_, [](const Entry& a, const Entry& b) {
+          return a.weight() < b.weight();
+        });
+    if (lowest->weight() >= new_features) {
+      return new_features;
+    }
+    entries_.erase(lowest);
+  }
+  entries_.push_back(Entry{.sample = sample, .new_features = new_features});
+  return new_features;
+}
+
+std::optional<Sample> CoverageCorpus::PickSample(absl::BitGenRef bit_gen) {
+  absl::MutexLock lock(&mutex_);
+  if (entries_.empty()) {
+    return std::nullopt;
+  }
+  std::vector<double> weights;
+  weights.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    weights.push_back(entry.weight());
+  }
+  absl::discrete_distribution<size_t> distribution(weights.begin(),
+                                                   weights.end());
+  Entry& entry = entries_[distribution(bit_gen)];
+  ++entry.times_picked;
+  return entry.sample;
+}
+
+int64_t CoverageCorpus::size() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+int64_t CoverageCorpus::feature_count() const {
+  absl::MutexLock lock(&mutex_);
+  return features_.size();
+}
+
+}  // namespace xls
@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_COVERAGE_CORPUS_H_
+#define XLS_FUZZER_COVERAGE_CORPUS_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+// The coverage features of a sample run: the combinations of op, type kind and
+// (bucketed) width of the nodes of the unoptimized and optimized IR, and the
+// optimization passes which changed the IR.
+using SampleFeatures = absl::flat_hash_set<std::string>;
+
+// Adds the op/type/width features of the nodes of `package` to `features`,
+// prefixing them with `stage` (e.g. "opt").
+void AddIrFeatures(Package* package, std::string_view stage,
+                   SampleFeatures& features);
+
+// Adds a feature for each pass which changed the IR in `profile`.
+void AddPassFeatures(const PassPipelineProfileProto& profile,
+                     SampleFeatures& features);
+
+// Returns the features of the sample run in `run_dir`, read from the
+// unoptimized and optimized IR and the pass profile (see
+// SampleOptions::record_pass_profile) the sample runner left there. Missing
+// files contribute no features.
+absl::StatusOr<SampleFeatures> GetSampleFeatures(
+    const std::filesystem::path& run_dir);
+
+// A corpus of samples for coverage-guided fuzzing. A sample is kept if its run
+// covered a feature no earlier sample covered. Samples are picked for mutation
+// in proportion to the number of new features they covered, discounted by the
+// number of times they have been picked before, so that productive samples are
+// mutated more while others still get a turn. Thread-safe.
+class CoverageCorpus {
+ public:
+  explicit CoverageCorpus(int64_t max_size = 1024) : max_size_(max_size) {}
+
+  // Records the features of a successful run of `sample`, adding the sample
+  // to the corpus if any of them is new. Returns the number of new features.
+  // When the corpus is full, the sample replaces the entry with the lowest
+  // weight if it covered more new features than that weight.
+  int64_t AddSample(const Sample& sample, const SampleFeatures& features);
+
+  // Returns a sample of the corpus to mutate, or std::nullopt if the corpus is
+  // empty.
+  std::optional<Sample> PickSample(absl::BitGenRef bit_gen);
+
+  int64_t size() const;
+  int64_t feature_count() const;
+
+ private:
+  struct Entry {
+    Sample sample;
+    int64_t new_features;
+    int64_t times_picked = 0;
+
+    double weight() const {
+      return static_cast<double>(new_features) / (1 + times_picked);
+    }
+  };
+
+  const int64_t max_size_;
+  mutable absl::Mutex mutex_;
+  std::vector<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  SampleFeatures features_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_COVERAGE_CORPUS_H_
@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_corpus.h"
+
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Not;
+using ::testing::UnorderedElementsAre;
+
+Sample MakeSample(std::string text) {
+  return Sample(std::move(text), SampleOptions(), {});
+}
+
+TEST(CoverageCorpusTest, IrAndPassFeatures) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(R"(
+package p
+
+top fn f(x: bits[32], y: bits[1]) -> bits[32] {
+  ret add.1: bits[32] = add(x, x, id=1)
+}
+)"));
+  SampleFeatures features;
+  AddIrFeatures(package.get(), "opt", features);
+  EXPECT_THAT(features, UnorderedElementsAre("opt:param:bits:<=32",
+                                             "opt:param:bits:1",
+                                             "opt:add:bits:<=32"));
+
+  PassPipelineProfileProto profile;
+  profile.add_invocations()->set_pass_name("dce");
+  PassInvocationProfileProto* changed = profile.add_invocations();
+  changed->set_pass_name("cse");
+  changed->set_ir_changed(true);
+  AddPassFeatures(profile, features);
+  EXPECT_THAT(features, Contains("pass:cse"));
+  EXPECT_THAT(features, Not(Contains("pass:dce")));
+}
+
+TEST(CoverageCorpusTest, KeepsSamplesWithNewFeatures) {
+  CoverageCorpus corpus;
+  std::mt19937_64 rng;
+  EXPECT_EQ(corpus.PickSample(rng), std::nullopt);
+
+  EXPECT_EQ(corpus.AddSample(MakeSample("a"), {"x", "y"}), 2);
+  EXPECT_EQ(corpus.AddSample(MakeSample("b"), {"x"}), 0);
+  EXPECT_EQ(corpus.AddSample(MakeSample("c"), {"x", "z"}), 1);
+  EXPECT_EQ(corpus.size(), 2);
+  EXPECT_EQ(corpus.feature_count(), 3);
+
+  std::optional<Sample> picked = corpus.PickSample(rng);
+  ASSERT_TRUE(picked.has_value());
+  EXPECT_THAT(picked->input_text(), testing::AnyOf("a", "c"));
+}
+
+TEST(CoverageCorpusTest, EvictsLowestWeightWhenFull) {
+  CoverageCorpus corpus(/*max_size=*/1);
+  std::mt19937_64 rng;
+  EXPECT_EQ(corpus.AddSample(MakeSample("a"), {"x"}), 1);
+  // Not productive enough to replace "a".
+  EXPECT_EQ(corpus.AddSample(MakeSample("b"), {"y"}), 1);
+  EXPECT_EQ(corpus.PickSample(rng)->input_text(), "a");
+  // "a" has now been picked once, halving its weight.
+  EXPECT_EQ(corpus.AddSample(MakeSample("c"), {"z"}), 1);
+  EXPECT_EQ(corpus.size(), 1);
+  EXPECT_EQ(corpus.PickSample(rng)->input_text(), "c");
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,263 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/dslx_minimizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/frontend/token.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+
+namespace xls {
+namespace {
+
+bool IsRemovable(const dslx::Token& token) {
+  return token.kind() != dslx::TokenKind::kWhitespace &&
+         token.kind() != dslx::TokenKind::kComment;
+}
+
+// Returns the text of `tokens` with only the removable tokens at the (sorted)
+// indices `kept`. Comments are dropped, and each run of whitespace left
+// between the remaining tokens is collapsed to its first whitespace token.
+std::string Render(absl::Span<const dslx::Token> tokens,
+                   absl::Span<const int64_t> kept) {
+  std::string result;
+  bool last_was_whitespace = false;
+  auto kept_it = kept.begin();
+  for (int64_t i = 0; i < tokens.size(); ++i) {
+    if (!IsRemovable(tokens[i])) {
+      if (!last_was_whitespace) {
+        result += tokens[i].kind() == dslx::TokenKind::kWhitespace
+                      ? tokens[i].ToString()
+                      : "\n";
+        last_was_whitespace = true;
+      }
+      continue;
+    }
+    if (kept_it != kept.end() && *kept_it == i) {
+      result += tokens[i].ToString();
+      last_was_whitespace = false;
+      ++kept_it;
+    }
+  }
+  return result;
+}
+
+// A candidate of one delta debugging round: the remaining tokens without one
+// chunk.
+struct Candidate {
+  std::vector<int64_t> kept;
+  std::string text;
+  bool still_fails = false;
+};
+
+// Tests each of `candidates` which is not already in `test_cache`,
+// concurrently on up to `thread_count` threads, and records the results in
+// `still_fails` and `test_cache`. Returns the number of candidates tested.
+absl::StatusOr<int64_t> TestCandidates(
+    absl::Span<Candidate> candidates, const DslxFailurePredicate& still_fails,
+    int64_t thread_count, absl::flat_hash_map<std::string, bool>& test_cache) {
+  std::vector<Candidate*> untested;
+  for (Candidate& candidate : candidates) {
+    auto it = test_cache.find(candidate.text);
+    if (it != test_cache.end()) {
+      candidate.still_fails = it->second;
+    } else {
+      untested.push_back(&candidate);
+    }
+  }
+
+  std::vector<absl::StatusOr<bool>> results(untested.size(), false);
+  std::atomic<int64_t> next = 0;
+  auto worker = [&] {
+    for (int64_t i = next++; i < untested.size(); i = next++) {
+      results[i] = still_fails(untested[i]->text);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min<int64_t>(thread_count, untested.size());
+       ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (int64_t i = 0; i < untested.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(untested[i]->still_fails, results[i]);
+    test_cache[untested[i]->text] = untested[i]->still_fails;
+  }
+  return untested.size();
+}
+
+// Returns whether `dslx_text` parses and type checks.
+bool Typechecks(std::string_view dslx_text) {
+  dslx::ImportData import_data(dslx::CreateImportData(
+      std::string(kDefaultDslxStdlibPath),
+      /*additional_search_paths=*/{}, dslx::kDefaultWarningsSet));
+  return dslx::ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data)
+      .ok();
+}
+
+// Runs `sample` with its input replaced by `dslx_text` using the in-process
+// tools, and returns the result of the run.
+absl::StatusOr<absl::Status> RunInProcess(const Sample& sample,
+                                          std::string_view dslx_text) {
+  XLS_ASSIGN_OR_RETURN(TempDirectory run_dir, TempDirectory::Create());
+  SampleRunner runner(run_dir.path(), SampleRunner::InProcessCommands());
+  return runner.Run(Sample(std::string(dslx_text), sample.options(),
+                           sample.args_batch(), sample.ir_channel_names()));
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> MinimizeDslx(
+    std::string_view dslx_text, const DslxFailurePredicate& still_fails,
+    const DslxMinimizerOptions& options) {
+  XLS_RET_CHECK_GE(options.thread_count, 1);
+  dslx::FileTable file_table;
+  dslx::Scanner scanner(file_table, dslx::Fileno(0), std::string(dslx_text),
+                        /*include_whitespace_and_comments=*/true);
+  XLS_ASSIGN_OR_RETURN(std::vector<dslx::Token> tokens, scanner.PopAll());
+
+  std::vector<int64_t> kept;
+  for (int64_t i = 0; i < tokens.size(); ++i) {
+    if (IsRemovable(tokens[i])) {
+      kept.push_back(i);
+    }
+  }
+  std::string text = Render(tokens, kept);
+  XLS_ASSIGN_OR_RETURN(bool fails, still_fails(text));
+  if (!fails) {
+    return absl::InvalidArgumentError(
+        "The DSLX to minimize does not exhibit the failure.");
+  }
+
+  absl::flat_hash_map<std::string, bool> test_cache = {{text, true}};
+  int64_t trials = 1;
+  int64_t chunk_count = 2;
+  while (kept.size() >= 2 &&
+         (!options.max_trials.has_value() || trials < *options.max_trials)) {
+    chunk_count = std::min<int64_t>(chunk_count, kept.size());
+    std::vector<Candidate> candidates(chunk_count);
+    for (int64_t i = 0; i < chunk_count; ++i) {
+      int64_t chunk_start = kept.size() * i / chunk_count;
+      int64_t chunk_end = kept.size() * (i + 1) / chunk_count;
+      candidates[i].kept.insert(candidates[i].kept.end(), kept.begin(),
+                                kept.begin() + chunk_start);
+      candidates[i].kept.insert(candidates[i].kept.end(),
+                                kept.begin() + chunk_end, kept.end());
+      candidates[i].text = Render(tokens, candidates[i].kept);
+    }
+    if (options.max_trials.has_value()) {
+      // Only test as many new candidates as the budget allows.
+      int64_t budget = *options.max_trials - trials;
+      int64_t new_candidates = 0;
+      auto it = candidates.begin();
+      for (; it != candidates.end(); ++it) {
+        if (!test_cache.contains(it->text) && new_candidates++ == budget) {
+          break;
+        }
+      }
+      candidates.erase(it, candidates.end());
+    }
+    XLS_ASSIGN_OR_RETURN(
+        int64_t tested,
+        TestCandidates(absl::MakeSpan(candidates), still_fails,
+                       options.thread_count, test_cache));
+    trials += tested;
+
+    auto failing = absl::c_find_if(
+        candidates, [](const Candidate& c) { return c.still_fails; });
+    if (failing != candidates.end()) {
+      kept = std::move(failing->kept);
+      text = std::move(failing->text);
+      chunk_count = std::max<int64_t>(chunk_count - 1, 2);
+      VLOG(1) << absl::StreamFormat(
+          "Reduced to %d tokens after %d trials", kept.size(), trials);
+      continue;
+    }
+    if (chunk_count == kept.size()) {
+      // Removing any single token makes the failure go away.
+      break;
+    }
+    chunk_count = std::min<int64_t>(chunk_count * 2, kept.size());
+  }
+  return text;
+}
+
+absl::StatusOr<DslxFailurePredicate> MakeSampleFailurePredicate(
+    const Sample& sample, std::optional<std::string> error_substring) {
+  if (!sample.options().input_is_dslx()) {
+    return absl::InvalidArgumentError("Only DSLX samples can be minimized.");
+  }
+  XLS_ASSIGN_OR_RETURN(absl::Status original_status,
+                       RunInProcess(sample, sample.input_text()));
+  if (original_status.ok()) {
+    return absl::InvalidArgumentError("The sample does not fail.");
+  }
+  if (error_substring.has_value() &&
+      !absl::StrContains(original_status.message(), *error_substring)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "The sample fails without the expected error \"%s\": %s",
+        *error_substring, original_status.ToString()));
+  }
+  bool require_typechecks = Typechecks(sample.input_text());
+  return [sample, error_substring, require_typechecks,
+          code = original_status.code()](
+             std::string_view dslx_text) -> absl::StatusOr<bool> {
+    if (require_typechecks && !Typechecks(dslx_text)) {
+      return false;
+    }
+    XLS_ASSIGN_OR_RETURN(absl::Status status, RunInProcess(sample, dslx_text));
+    if (status.ok()) {
+      return false;
+    }
+    if (error_substring.has_value()) {
+      return absl::StrContains(status.message(), *error_substring);
+    }
+    return status.code() == code;
+  };
+}
+
+}  // namespace xls
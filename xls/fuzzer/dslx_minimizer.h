@@ -0,0 +1,70 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_DSLX_MINIMIZER_H_
+#define XLS_FUZZER_DSLX_MINIMIZER_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Returns whether the given DSLX text still exhibits the failure being
+// minimized. Must be safe to call concurrently.
+using DslxFailurePredicate =
+    std::function<absl::StatusOr<bool>(std::string_view dslx_text)>;
+
+struct DslxMinimizerOptions {
+  // The number of candidates tested concurrently.
+  int64_t thread_count = 1;
+
+  // The maximum number of candidates to test; unbounded if unspecified.
+  std::optional<int64_t> max_trials;
+};
+
+// Minimizes `dslx_text` by delta debugging over its tokens, keeping the token
+// stream in memory rather than rescanning the text on each attempt. Each
+// round splits the remaining tokens into chunks and tests the text without
+// each chunk, concurrently on up to `options.thread_count` threads; the first
+// chunk whose removal keeps `still_fails` true is dropped, otherwise the
+// chunks are refined. Comments are dropped and whitespace is kept (collapsed
+// between removed tokens), so the result is one-minimal with respect to the
+// other tokens: removing any one of them makes the failure go away.
+//
+// Returns an error if `dslx_text` does not fail to begin with.
+absl::StatusOr<std::string> MinimizeDslx(
+    std::string_view dslx_text, const DslxFailurePredicate& still_fails,
+    const DslxMinimizerOptions& options = {});
+
+// Returns a predicate which runs `sample` with its DSLX replaced by the
+// candidate, entirely in-process (see SampleRunner::InProcessCommands), in a
+// fresh temporary directory. A candidate fails if its run fails with an error
+// containing `error_substring`, or, if that is not specified, with the same
+// status code as `sample` itself. If `sample` type checks, candidates which do
+// not are rejected before anything is run.
+//
+// Returns an error if `sample` is not DSLX or does not fail.
+absl::StatusOr<DslxFailurePredicate> MakeSampleFailurePredicate(
+    const Sample& sample,
+    std::optional<std::string> error_substring = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_DSLX_MINIMIZER_H_
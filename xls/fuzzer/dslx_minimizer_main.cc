@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimizes the DSLX of a fuzzer crasher in-process, keeping the failure.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/fuzzer/dslx_minimizer.h"
+#include "xls/fuzzer/sample.h"
+
+ABSL_FLAG(std::optional<std::string>, error_substring, std::nullopt,
+          "Substring which must be in the error of a failing candidate. If not "
+          "specified, a candidate fails if its run fails with the same status "
+          "code as the crasher.");
+ABSL_FLAG(std::optional<int64_t>, max_trials, std::nullopt,
+          "Maximum number of candidates to test; unbounded if not specified.");
+ABSL_FLAG(std::optional<std::string>, output_path, std::nullopt,
+          "Path at which to write the minimized crasher; it is written to "
+          "stdout if not specified.");
+ABSL_FLAG(std::optional<int64_t>, threads, std::nullopt,
+          "Number of candidates to test concurrently; defaults to the number "
+          "of available CPUs.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(const std::filesystem::path& crasher_path,
+                      const std::optional<std::string>& error_substring,
+                      std::optional<int64_t> max_trials,
+                      const std::optional<std::filesystem::path>& output_path,
+                      std::optional<int64_t> threads) {
+  XLS_ASSIGN_OR_RETURN(std::string serialized_crasher,
+                       GetFileContents(crasher_path));
+  XLS_ASSIGN_OR_RETURN(Sample crasher, Sample::Deserialize(serialized_crasher));
+  XLS_ASSIGN_OR_RETURN(DslxFailurePredicate still_fails,
+                       MakeSampleFailurePredicate(crasher, error_substring));
+  XLS_ASSIGN_OR_RETURN(
+      std::string minimized,
+      MinimizeDslx(crasher.input_text(), still_fails,
+                   DslxMinimizerOptions{
+                       .thread_count = threads.value_or(
+                           std::max(AvailableCPUs(), 1)),
+                       .max_trials = max_trials}));
+  LOG(INFO) << "Minimized DSLX from " << crasher.input_text().size() << " to "
+            << minimized.size() << " characters";
+
+  std::string serialized =
+      Sample(minimized, crasher.options(), crasher.args_batch(),
+             crasher.ir_channel_names())
+          .Serialize();
+  if (output_path.has_value()) {
+    return SetFileContents(*output_path, serialized);
+  }
+  std::cout << serialized;
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  const std::string usage = absl::StrCat(
+      "Invalid command-line arguments; want ", argv[0], " <crasher path>");
+
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(usage, argc, argv);
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << usage;
+    return EXIT_FAILURE;
+  }
+
+  std::optional<std::filesystem::path> output_path;
+  if (absl::GetFlag(FLAGS_output_path).has_value()) {
+    output_path = *absl::GetFlag(FLAGS_output_path);
+  }
+  return xls::ExitStatus(xls::RealMain(
+      /*crasher_path=*/positional_arguments[0],
+      absl::GetFlag(FLAGS_error_substring), absl::GetFlag(FLAGS_max_trials),
+      output_path, absl::GetFlag(FLAGS_threads)));
+}
@@ -0,0 +1,138 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/dslx_minimizer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kDslx = R"(// A comment.
+fn main(x: u32) -> u32 {
+  let a = x + u32:1;
+  let b = a * u32:2;
+  b ^ u32:7
+})";
+
+TEST(DslxMinimizerTest, MinimizesToFailingTokens) {
+  auto still_fails = [](std::string_view text) -> absl::StatusOr<bool> {
+    return absl::StrContains(text, "a * u32:2");
+  };
+  for (int64_t thread_count : {1, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string minimized,
+        MinimizeDslx(kDslx, still_fails,
+                     DslxMinimizerOptions{.thread_count = thread_count}));
+    EXPECT_EQ(absl::StripAsciiWhitespace(minimized), "a * u32:2");
+  }
+}
+
+TEST(DslxMinimizerTest, DropsComments) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string minimized,
+      MinimizeDslx(
+          kDslx,
+          [](std::string_view text) -> absl::StatusOr<bool> {
+            return absl::StrContains(text, "fn main");
+          },
+          DslxMinimizerOptions{.max_trials = 1}));
+  EXPECT_THAT(minimized, HasSubstr("b ^ u32:7"));
+  EXPECT_FALSE(absl::StrContains(minimized, "comment"));
+}
+
+TEST(DslxMinimizerTest, StopsAfterMaxTrials) {
+  std::atomic<int64_t> trials = 0;
+  auto still_fails = [&](std::string_view text) -> absl::StatusOr<bool> {
+    ++trials;
+    return absl::StrContains(text, "u32:7");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string minimized,
+      MinimizeDslx(kDslx, still_fails,
+                   DslxMinimizerOptions{.thread_count = 2, .max_trials = 5}));
+  EXPECT_EQ(trials, 5);
+  EXPECT_THAT(minimized, HasSubstr("u32:7"));
+}
+
+TEST(DslxMinimizerTest, RequiresFailingInput) {
+  EXPECT_THAT(MinimizeDslx(kDslx,
+                           [](std::string_view) -> absl::StatusOr<bool> {
+                             return false;
+                           }),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not exhibit the failure")));
+}
+
+TEST(DslxMinimizerTest, SampleFailurePredicate) {
+  constexpr std::string_view kFailingDslx = R"(
+fn main(x: u32) -> u32 {
+  let y = x + u32:1;
+  assert!(y == u32:0, "boom");
+  y
+})";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  std::vector<std::vector<dslx::InterpValue>> args_batch = {
+      {dslx::InterpValue::MakeU32(42)}};
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      DslxFailurePredicate still_fails,
+      MakeSampleFailurePredicate(
+          Sample(std::string(kFailingDslx), options, args_batch),
+          /*error_substring=*/"boom"));
+  EXPECT_THAT(still_fails(kFailingDslx), IsOkAndHolds(true));
+  EXPECT_THAT(still_fails("fn main(x: u32) -> u32 { x }"),
+              IsOkAndHolds(false));
+  // Candidates which do not type check are rejected.
+  EXPECT_THAT(still_fails(R"(fn main(x: u32) -> u32 {
+  assert!(x == u32:0, "boom");
+  y
+})"),
+              IsOkAndHolds(false));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string minimized,
+      MinimizeDslx(kFailingDslx, still_fails,
+                   DslxMinimizerOptions{.thread_count = 2}));
+  EXPECT_THAT(minimized, HasSubstr("\"boom\""));
+  EXPECT_LT(minimized.size(), kFailingDslx.size());
+
+  EXPECT_THAT(
+      MakeSampleFailurePredicate(
+          Sample("fn main(x: u32) -> u32 { x }", options, args_batch)),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("does not fail")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -79,6 +79,8 @@ absl::Status RealMain(std::string_view ir_path, std::string_view inputs_path) {
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
                        FunctionJit::Create(f));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+                       CompiledFunctionInterpreter::Create(f));
   for (const std::vector<Value>& args : inputs) {
     InterpreterResult<Value> jit_result;
     if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
@@ -92,7 +94,7 @@ absl::Status RealMain(std::string_view ir_path, std::string_view inputs_path) {
     // events once the JIT fully supports events (and we have decided how to
     // handle event mismatches).
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
-                         InterpretFunction(f, args));
+                         interpreter->Run(args));
     if (jit_result.value != interpreter_result.value) {
       std::cout << absl::StrJoin(args, "; ", ValueFormatterHex);
       return absl::OkStatus();
@@ -0,0 +1,287 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/fuzz_coordinator.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "openssl/sha.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/fuzz_coordinator.pb.h"
+
+namespace xls {
+namespace {
+
+bool IsHexPrefix(std::string_view s) {
+  return s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'b') &&
+         std::isxdigit(static_cast<unsigned char>(s[2]));
+}
+
+}  // namespace
+
+std::string CrasherSignature(std::string_view exception) {
+  std::string_view line = exception.substr(0, exception.find('\n'));
+  std::string signature;
+  int64_t i = 0;
+  while (i < line.size()) {
+    if (IsHexPrefix(line.substr(i))) {
+      i += 2;
+      while (i < line.size() &&
+             (std::isxdigit(static_cast<unsigned char>(line[i])) ||
+              line[i] == '_')) {
+        ++i;
+      }
+      signature.push_back('N');
+    } else if (std::isdigit(static_cast<unsigned char>(line[i]))) {
+      while (i < line.size() &&
+             (std::isdigit(static_cast<unsigned char>(line[i])) ||
+              line[i] == '_')) {
+        ++i;
+      }
+      signature.push_back('N');
+    } else {
+      signature.push_back(line[i]);
+      ++i;
+    }
+  }
+  return signature;
+}
+
+std::optional<fuzzer::WorkUnitProto> FuzzCoordinator::NextWorkUnit(
+    std::string_view worker, absl::Time now) {
+  absl::MutexLock lock(&mutex_);
+  bool duration_used_up =
+      options_.duration.has_value() && now - start_ >= *options_.duration;
+  if (!duration_used_up) {
+    // Hand out again the units of workers which have not reported in time.
+    for (auto& [id, outstanding] : outstanding_) {
+      if (now - outstanding.issued >= options_.work_unit_timeout) {
+        LOG(WARNING) << absl::StreamFormat(
+            "Work unit %d timed out; handing it out to %s", id, worker);
+        outstanding.issued = now;
+        return outstanding.unit;
+      }
+    }
+  }
+  if (WorkExhausted(now)) {
+    return std::nullopt;
+  }
+  int64_t sample_count = options_.samples_per_work_unit;
+  if (options_.sample_count.has_value()) {
+    sample_count =
+        std::min(sample_count, *options_.sample_count - samples_handed_out_);
+  }
+  fuzzer::WorkUnitProto unit;
+  unit.set_id(next_unit_id_);
+  unit.set_seed(options_.seed + next_unit_id_ * kWorkUnitSeedStride);
+  unit.set_sample_count(sample_count);
+  ++next_unit_id_;
+  samples_handed_out_ += sample_count;
+  outstanding_[unit.id()] = Outstanding{.unit = unit, .issued = now};
+  VLOG(1) << absl::StreamFormat("Handing out work unit %d to %s", unit.id(),
+                                worker);
+  return unit;
+}
+
+absl::StatusOr<int64_t> FuzzCoordinator::AddResults(
+    const fuzzer::ReportResultsRequest& results) {
+  absl::MutexLock lock(&mutex_);
+  if (results.work_unit_id() < 0 || results.work_unit_id() >= next_unit_id_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "No work unit %d was handed out", results.work_unit_id()));
+  }
+  if (!reported_.insert(results.work_unit_id()).second) {
+    // A unit handed out again after timing out may be reported twice.
+    LOG(INFO) << absl::StreamFormat(
+        "Ignoring results of work unit %d from %s; already reported",
+        results.work_unit_id(), results.worker());
+    return 0;
+  }
+  outstanding_.erase(results.work_unit_id());
+  results_added_.SignalAll();
+
+  WorkerStats& worker = workers_[results.worker()];
+  worker.samples_run += results.samples_run();
+  worker.elapsed += absl::Nanoseconds(results.elapsed_ns());
+
+  int64_t new_crashers = 0;
+  for (const fuzzer::CrasherProto& crasher : results.crashers()) {
+    std::string signature = CrasherSignature(crasher.exception());
+    auto [it, inserted] = crashers_.try_emplace(signature);
+    ++it->second.count;
+    if (!inserted) {
+      continue;
+    }
+    ++new_crashers;
+    if (options_.crasher_dir.has_value()) {
+      XLS_ASSIGN_OR_RETURN(it->second.path, SaveCrasher(signature, crasher));
+      LOG(INFO) << "Saved new crasher from " << results.worker() << " to "
+                << it->second.path;
+    }
+  }
+
+  if (options_.summary_dir.has_value() && results.has_summaries()) {
+    // Appending to the summary file concatenates the repeated fields; see
+    // summarize_ir_main.
+    XLS_RETURN_IF_ERROR(AppendStringToFile(
+        *options_.summary_dir /
+            absl::StrCat("summary_", results.worker(), ".binarypb"),
+        results.summaries().SerializeAsString()));
+  }
+  return new_crashers;
+}
+
+absl::StatusOr<std::filesystem::path> FuzzCoordinator::SaveCrasher(
+    std::string_view signature, const fuzzer::CrasherProto& crasher) const {
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(signature.data()), signature.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  // Name the directory by the first 4 bytes of the digest, as run_fuzz does.
+  std::string hex_digest = absl::BytesToHexString({digest.data(), 4});
+  std::filesystem::path dir = *options_.crasher_dir / hex_digest;
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(dir));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(dir / "exception.txt", crasher.exception()));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      dir / absl::StrFormat("crasher_%s_%s.x",
+                            absl::FormatTime("%Y-%m-%d", absl::Now(),
+                                             absl::LocalTimeZone()),
+                            hex_digest.substr(0, 4)),
+      crasher.crasher()));
+  return dir;
+}
+
+bool FuzzCoordinator::WorkExhausted(absl::Time now) const {
+  return (options_.sample_count.has_value() &&
+          samples_handed_out_ >= *options_.sample_count) ||
+         (options_.duration.has_value() && now - start_ >= *options_.duration);
+}
+
+bool FuzzCoordinator::DoneLocked(absl::Time now) const {
+  if (!WorkExhausted(now)) {
+    return false;
+  }
+  bool duration_used_up =
+      options_.duration.has_value() && now - start_ >= *options_.duration;
+  return std::all_of(
+      outstanding_.begin(), outstanding_.end(), [&](const auto& entry) {
+        return duration_used_up &&
+               now - entry.second.issued >= options_.work_unit_timeout;
+      });
+}
+
+bool FuzzCoordinator::Done(absl::Time now) const {
+  absl::MutexLock lock(&mutex_);
+  return DoneLocked(now);
+}
+
+void FuzzCoordinator::WaitUntilDone() const {
+  absl::MutexLock lock(&mutex_);
+  // The duration runs out without any results being added, so wake up
+  // periodically.
+  while (!DoneLocked(absl::Now())) {
+    results_added_.WaitWithTimeout(&mutex_, absl::Seconds(1));
+  }
+}
+
+int64_t FuzzCoordinator::samples_run() const {
+  absl::MutexLock lock(&mutex_);
+  int64_t samples_run = 0;
+  for (const auto& [_, worker] : workers_) {
+    samples_run += worker.samples_run;
+  }
+  return samples_run;
+}
+
+int64_t FuzzCoordinator::distinct_crasher_count() const {
+  absl::MutexLock lock(&mutex_);
+  return crashers_.size();
+}
+
+std::string FuzzCoordinator::Report(absl::Time now) const {
+  absl::MutexLock lock(&mutex_);
+  int64_t samples_run = 0;
+  for (const auto& [_, worker] : workers_) {
+    samples_run += worker.samples_run;
+  }
+  int64_t crasher_count = 0;
+  for (const auto& [_, crasher] : crashers_) {
+    crasher_count += crasher.count;
+  }
+  absl::Duration elapsed = now - start_;
+  std::string report = absl::StrFormat(
+      "Ran %d samples on %d workers in %s (%.2f samples/s); %d crashers with "
+      "%d distinct signatures\n",
+      samples_run, workers_.size(), absl::FormatDuration(elapsed),
+      static_cast<double>(samples_run) / absl::ToDoubleSeconds(elapsed),
+      crasher_count, crashers_.size());
+  for (const auto& [name, worker] : workers_) {
+    absl::StrAppendFormat(
+        &report, "  Worker %s: %d samples (%.2f samples/s)\n", name,
+        worker.samples_run,
+        static_cast<double>(worker.samples_run) /
+            absl::ToDoubleSeconds(worker.elapsed));
+  }
+  for (const auto& [signature, crasher] : crashers_) {
+    absl::StrAppendFormat(&report, "  %d x %s\n", crasher.count, signature);
+  }
+  return report;
+}
+
+::grpc::Status FuzzCoordinatorServiceImpl::GetWork(
+    ::grpc::ServerContext* context, const fuzzer::GetWorkRequest* request,
+    fuzzer::GetWorkResponse* response) {
+  std::optional<fuzzer::WorkUnitProto> unit =
+      coordinator_->NextWorkUnit(request->worker());
+  if (unit.has_value()) {
+    *response->mutable_work_unit() = *std::move(unit);
+  }
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status FuzzCoordinatorServiceImpl::ReportResults(
+    ::grpc::ServerContext* context, const fuzzer::ReportResultsRequest* request,
+    fuzzer::ReportResultsResponse* response) {
+  absl::StatusOr<int64_t> new_crashers = coordinator_->AddResults(*request);
+  if (!new_crashers.ok()) {
+    // absl and gRPC status codes have the same values.
+    return ::grpc::Status(
+        static_cast<::grpc::StatusCode>(new_crashers.status().code()),
+        std::string(new_crashers.status().message()));
+  }
+  response->set_new_crashers(*new_crashers);
+  return ::grpc::Status::OK;
+}
+
+}  // namespace xls
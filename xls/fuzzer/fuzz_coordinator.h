@@ -0,0 +1,157 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_FUZZ_COORDINATOR_H_
+#define XLS_FUZZER_FUZZ_COORDINATOR_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/fuzzer/fuzz_coordinator.grpc.pb.h"
+#include "xls/fuzzer/fuzz_coordinator.pb.h"
+
+namespace xls {
+
+struct FuzzCoordinatorOptions {
+  // Seed of the first work unit.
+  uint64_t seed = 0;
+  int64_t samples_per_work_unit = 64;
+  // Total number of samples to hand out (unbounded if unspecified).
+  std::optional<int64_t> sample_count;
+  // Time after which no more work is handed out (unbounded if unspecified).
+  std::optional<absl::Duration> duration;
+  // A unit not reported within this time is handed out again, so the samples
+  // of a worker which died are still run.
+  absl::Duration work_unit_timeout = absl::Hours(1);
+  // Directory in which each distinct crasher is saved.
+  std::optional<std::filesystem::path> crasher_dir;
+  // Directory in which the summaries reported by each worker are appended to
+  // one file per worker.
+  std::optional<std::filesystem::path> summary_dir;
+};
+
+// Central work queue of distributed fuzzing. Hands out work units (a seed and
+// a sample count) to workers on any number of machines so that no two workers
+// run the same samples, deduplicates the crashers they report by signature
+// (see CrasherSignature) and aggregates their throughput. Thread-safe.
+class FuzzCoordinator {
+ public:
+  explicit FuzzCoordinator(FuzzCoordinatorOptions options,
+                           absl::Time start = absl::Now())
+      : options_(std::move(options)), start_(start) {}
+
+  // Returns the next unit of work for `worker`, or std::nullopt if the sample
+  // count or duration is used up.
+  std::optional<fuzzer::WorkUnitProto> NextWorkUnit(
+      std::string_view worker, absl::Time now = absl::Now());
+
+  // Records the results of a work unit. Saves the crashers with new
+  // signatures and returns how many there were. Results of a unit which has
+  // already been reported are ignored.
+  absl::StatusOr<int64_t> AddResults(
+      const fuzzer::ReportResultsRequest& results);
+
+  // Returns true once no more work will be handed out and every unit handed
+  // out has been reported. Once the duration is used up, units which have
+  // timed out are no longer waited for.
+  bool Done(absl::Time now = absl::Now()) const;
+
+  // Blocks until Done.
+  void WaitUntilDone() const;
+
+  int64_t samples_run() const;
+  int64_t distinct_crasher_count() const;
+
+  // Returns the aggregate and per-worker throughput and the crasher
+  // signatures seen, as text.
+  std::string Report(absl::Time now = absl::Now()) const;
+
+ private:
+  struct Outstanding {
+    fuzzer::WorkUnitProto unit;
+    absl::Time issued;
+  };
+  struct WorkerStats {
+    int64_t samples_run = 0;
+    absl::Duration elapsed;
+  };
+  struct CrasherStats {
+    std::filesystem::path path;
+    int64_t count = 0;
+  };
+
+  bool WorkExhausted(absl::Time now) const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  bool DoneLocked(absl::Time now) const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  absl::StatusOr<std::filesystem::path> SaveCrasher(
+      std::string_view signature, const fuzzer::CrasherProto& crasher) const;
+
+  const FuzzCoordinatorOptions options_;
+  const absl::Time start_;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::CondVar results_added_;
+  int64_t next_unit_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t samples_handed_out_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::btree_map<int64_t, Outstanding> outstanding_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_set<int64_t> reported_ ABSL_GUARDED_BY(mutex_);
+  absl::btree_map<std::string, WorkerStats> workers_ ABSL_GUARDED_BY(mutex_);
+  absl::btree_map<std::string, CrasherStats> crashers_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Seeds of consecutive work units are this far apart; each of the sample
+// generators of a worker uses the seed of its unit plus its index.
+inline constexpr uint64_t kWorkUnitSeedStride = uint64_t{1} << 20;
+
+// Returns the signature by which crashers are deduplicated: the first line of
+// the error they failed with, with numbers replaced by `N` so that errors
+// differing only in values, widths or node ids have the same signature.
+std::string CrasherSignature(std::string_view exception);
+
+// gRPC service forwarding to a FuzzCoordinator.
+class FuzzCoordinatorServiceImpl
+    : public fuzzer::FuzzCoordinatorService::Service {
+ public:
+  explicit FuzzCoordinatorServiceImpl(FuzzCoordinator* coordinator)
+      : coordinator_(coordinator) {}
+
+  ::grpc::Status GetWork(::grpc::ServerContext* context,
+                         const fuzzer::GetWorkRequest* request,
+                         fuzzer::GetWorkResponse* response) override;
+  ::grpc::Status ReportResults(
+      ::grpc::ServerContext* context,
+      const fuzzer::ReportResultsRequest* request,
+      fuzzer::ReportResultsResponse* response) override;
+
+ private:
+  FuzzCoordinator* coordinator_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_FUZZ_COORDINATOR_H_
@@ -0,0 +1,150 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/fuzz_coordinator.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/fuzz_coordinator.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+fuzzer::ReportResultsRequest Results(const fuzzer::WorkUnitProto& unit,
+                                     std::vector<std::string> exceptions) {
+  fuzzer::ReportResultsRequest results;
+  results.set_worker("w");
+  results.set_work_unit_id(unit.id());
+  results.set_samples_run(unit.sample_count());
+  results.set_elapsed_ns(absl::ToInt64Nanoseconds(absl::Seconds(1)));
+  for (std::string& exception : exceptions) {
+    fuzzer::CrasherProto* crasher = results.add_crashers();
+    crasher->set_crasher("// crasher");
+    crasher->set_exception(std::move(exception));
+  }
+  return results;
+}
+
+TEST(FuzzCoordinatorTest, HandsOutSampleCount) {
+  absl::Time start = absl::UnixEpoch();
+  FuzzCoordinator coordinator(
+      {.seed = 42, .samples_per_work_unit = 4, .sample_count = 10}, start);
+  std::vector<fuzzer::WorkUnitProto> units;
+  while (std::optional<fuzzer::WorkUnitProto> unit =
+             coordinator.NextWorkUnit("w", start)) {
+    units.push_back(*unit);
+  }
+  ASSERT_THAT(units, SizeIs(3));
+  EXPECT_EQ(units[0].seed(), 42);
+  EXPECT_EQ(units[1].seed(), 42 + kWorkUnitSeedStride);
+  EXPECT_EQ(units[2].sample_count(), 2);
+  EXPECT_FALSE(coordinator.Done(start));
+
+  for (const fuzzer::WorkUnitProto& unit : units) {
+    XLS_ASSERT_OK(coordinator.AddResults(Results(unit, {})).status());
+  }
+  EXPECT_TRUE(coordinator.Done(start));
+  EXPECT_EQ(coordinator.samples_run(), 10);
+}
+
+TEST(FuzzCoordinatorTest, ReissuesTimedOutUnits) {
+  absl::Time start = absl::UnixEpoch();
+  FuzzCoordinator coordinator({.samples_per_work_unit = 4,
+                               .sample_count = 4,
+                               .work_unit_timeout = absl::Minutes(1)},
+                              start);
+  std::optional<fuzzer::WorkUnitProto> unit =
+      coordinator.NextWorkUnit("w", start);
+  ASSERT_TRUE(unit.has_value());
+  EXPECT_EQ(coordinator.NextWorkUnit("x", start), std::nullopt);
+
+  std::optional<fuzzer::WorkUnitProto> reissued =
+      coordinator.NextWorkUnit("x", start + absl::Minutes(2));
+  ASSERT_TRUE(reissued.has_value());
+  EXPECT_EQ(reissued->id(), unit->id());
+
+  // Only the first report of the unit counts.
+  XLS_ASSERT_OK(coordinator.AddResults(Results(*unit, {})).status());
+  XLS_ASSERT_OK(coordinator.AddResults(Results(*reissued, {})).status());
+  EXPECT_EQ(coordinator.samples_run(), 4);
+  EXPECT_TRUE(coordinator.Done(start + absl::Minutes(2)));
+}
+
+TEST(FuzzCoordinatorTest, DurationEndsWork) {
+  absl::Time start = absl::UnixEpoch();
+  FuzzCoordinator coordinator({.duration = absl::Minutes(1)}, start);
+  EXPECT_TRUE(coordinator.NextWorkUnit("w", start).has_value());
+  EXPECT_FALSE(coordinator.Done(start + absl::Minutes(2)));
+  EXPECT_EQ(coordinator.NextWorkUnit("w", start + absl::Minutes(2)),
+            std::nullopt);
+}
+
+TEST(FuzzCoordinatorTest, RejectsUnknownWorkUnit) {
+  FuzzCoordinator coordinator({});
+  fuzzer::WorkUnitProto unit;
+  unit.set_id(3);
+  EXPECT_FALSE(coordinator.AddResults(Results(unit, {})).ok());
+}
+
+TEST(FuzzCoordinatorTest, DeduplicatesCrashers) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory crasher_dir, TempDirectory::Create());
+  FuzzCoordinator coordinator({.crasher_dir = crasher_dir.path()});
+  std::optional<fuzzer::WorkUnitProto> first = coordinator.NextWorkUnit("w");
+  std::optional<fuzzer::WorkUnitProto> second = coordinator.NextWorkUnit("w");
+  ASSERT_TRUE(first.has_value() && second.has_value());
+
+  EXPECT_THAT(coordinator.AddResults(Results(
+                  *first, {"INTERNAL: Result miscompare for sample 3:\nargs",
+                           "INTERNAL: Result miscompare for sample 7:\nargs"})),
+              IsOkAndHolds(1));
+  EXPECT_THAT(coordinator.AddResults(Results(
+                  *second, {"INTERNAL: Result miscompare for sample 12:\nargs",
+                            "DEADLINE_EXCEEDED: Timed out"})),
+              IsOkAndHolds(1));
+  EXPECT_EQ(coordinator.distinct_crasher_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> saved,
+                           GetDirectoryEntries(crasher_dir.path()));
+  ASSERT_THAT(saved, SizeIs(2));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> files,
+                           GetDirectoryEntries(saved[0]));
+  EXPECT_THAT(files, SizeIs(2));
+  EXPECT_THAT(coordinator.Report(), HasSubstr("3 crashers with 2 distinct"));
+}
+
+TEST(FuzzCoordinatorTest, CrasherSignature) {
+  EXPECT_EQ(CrasherSignature("INTERNAL: bits[32]:0x1f != bits[32]:0xa_bc\n"
+                             "more details"),
+            "INTERNAL: bits[N]:N != bits[N]:N");
+  EXPECT_EQ(CrasherSignature("Node add.123 has width 0b101"),
+            "Node add.N has width N");
+  EXPECT_EQ(CrasherSignature("no numbers"), "no numbers");
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of fuzzer throughput on a fixed-seed sequence of samples. Runs
+// report samples per second and the median latency of each stage of running a
+// sample; the full latency percentiles are logged at the end of each run.
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/stopwatch.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/stage_latency_histograms.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kCallsPerSample = 8;
+
+SampleOptions GetSampleOptions(bool codegen) {
+  SampleOptions options;
+  options.set_calls_per_sample(kCallsPerSample);
+  options.set_codegen(codegen);
+  return options;
+}
+
+// Reports the samples run per second and the median latency of each stage.
+void ReportCounters(benchmark::State& state, int64_t samples,
+                    const StageLatencyHistograms& histograms) {
+  state.counters["samples_per_second"] =
+      benchmark::Counter(samples, benchmark::Counter::kIsRate);
+  for (std::string_view stage : StageLatencyHistograms::StageNames()) {
+    std::optional<LatencyHistogram> histogram = histograms.GetHistogram(stage);
+    if (histogram.has_value()) {
+      state.counters[absl::StrCat(stage, "_p50_ms")] =
+          absl::ToDoubleMilliseconds(histogram->Percentile(0.5));
+    }
+  }
+  LOG(INFO) << "Stage latencies:\n" << histograms.ToString();
+}
+
+static void BM_GenerateSample(benchmark::State& state) {
+  dslx::FileTable file_table;
+  std::mt19937_64 rng(/*seed=*/0);
+  SampleOptions sample_options = GetSampleOptions(/*codegen=*/false);
+  StageLatencyHistograms histograms;
+  int64_t samples = 0;
+  for (auto _ : state) {
+    Stopwatch stopwatch;
+    benchmark::DoNotOptimize(GenerateSample(dslx::AstGeneratorOptions{},
+                                            sample_options, rng, file_table)
+                                 .value());
+    histograms.AddLatency("generate_sample", stopwatch.GetElapsedTime());
+    ++samples;
+  }
+  ReportCounters(state, samples, histograms);
+}
+
+// Generates samples from a fixed seed, untimed, and runs each one with the
+// in-process tools. The argument selects whether the samples are also
+// code-generated.
+static void BM_RunSample(benchmark::State& state) {
+  dslx::FileTable file_table;
+  std::mt19937_64 rng(/*seed=*/0);
+  SampleOptions sample_options = GetSampleOptions(state.range(0) != 0);
+  StageLatencyHistograms histograms;
+  int64_t samples = 0;
+  // Outside the loop so the previous run directory is removed untimed.
+  std::optional<TempDirectory> run_dir;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Stopwatch stopwatch;
+    Sample sample = GenerateSample(dslx::AstGeneratorOptions{}, sample_options,
+                                   rng, file_table)
+                        .value();
+    histograms.AddLatency("generate_sample", stopwatch.GetElapsedTime());
+    run_dir = TempDirectory::Create().value();
+    SampleRunner runner(run_dir->path(), SampleRunner::InProcessCommands());
+    runner.set_latency_histograms(&histograms);
+    state.ResumeTiming();
+
+    stopwatch.Reset();
+    CHECK_OK(runner.Run(sample));
+    histograms.AddLatency("total", stopwatch.GetElapsedTime());
+    ++samples;
+  }
+  ReportCounters(state, samples, histograms);
+}
+
+BENCHMARK(BM_GenerateSample)->UseRealTime();
+BENCHMARK(BM_RunSample)->Arg(0)->Arg(1)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
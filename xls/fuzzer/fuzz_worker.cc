@@ -0,0 +1,165 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/fuzz_worker.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/fuzz_coordinator.grpc.pb.h"
+#include "xls/fuzzer/fuzz_coordinator.pb.h"
+#include "xls/fuzzer/run_fuzz_multiprocess.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/synthesis/credentials.h"
+
+namespace xls {
+namespace {
+
+absl::Status FromGrpcStatus(const ::grpc::Status& status) {
+  // absl and gRPC status codes have the same values.
+  return absl::Status(static_cast<absl::StatusCode>(status.error_code()),
+                      status.error_message());
+}
+
+// Adds the crashers saved by ParallelGenerateAndRunSamples in `crasher_dir` to
+// `results`.
+absl::Status CollectCrashers(const std::filesystem::path& crasher_dir,
+                             fuzzer::ReportResultsRequest& results) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> sample_dirs,
+                       GetDirectoryEntries(crasher_dir));
+  for (const std::filesystem::path& sample_dir : sample_dirs) {
+    fuzzer::CrasherProto crasher;
+    XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> files,
+                         GetDirectoryEntries(sample_dir));
+    for (const std::filesystem::path& file : files) {
+      std::string filename = file.filename().string();
+      if (filename == "exception.txt") {
+        XLS_ASSIGN_OR_RETURN(*crasher.mutable_exception(),
+                             GetFileContents(file));
+      } else if (absl::StartsWith(filename, "crasher_") &&
+                 absl::EndsWith(filename, ".x")) {
+        XLS_ASSIGN_OR_RETURN(*crasher.mutable_crasher(),
+                             GetFileContents(file));
+      }
+    }
+    *results.add_crashers() = std::move(crasher);
+  }
+  return absl::OkStatus();
+}
+
+// Merges the summary files written by ParallelGenerateAndRunSamples in
+// `summary_dir` into `results`.
+absl::Status CollectSummaries(const std::filesystem::path& summary_dir,
+                              fuzzer::ReportResultsRequest& results) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> files,
+                       GetDirectoryEntries(summary_dir));
+  fuzzer::SampleSummariesProto* summaries = results.mutable_summaries();
+  for (const std::filesystem::path& file : files) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(file));
+    fuzzer::SampleSummariesProto file_summaries;
+    if (!file_summaries.ParseFromString(contents)) {
+      return absl::InternalError(
+          absl::StrFormat("Malformed summary file %s", file.string()));
+    }
+    summaries->MergeFrom(file_summaries);
+  }
+  int64_t samples_run = 0;
+  for (const fuzzer::WorkerUtilizationProto& utilization :
+       summaries->worker_utilization()) {
+    samples_run += utilization.samples_run();
+  }
+  results.set_samples_run(samples_run);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<fuzzer::ReportResultsRequest> RunWorkUnit(
+    const FuzzWorkerOptions& options, const fuzzer::WorkUnitProto& unit) {
+  XLS_ASSIGN_OR_RETURN(TempDirectory crasher_dir, TempDirectory::Create());
+  XLS_ASSIGN_OR_RETURN(TempDirectory summary_dir, TempDirectory::Create());
+  absl::Time start = absl::Now();
+  XLS_RETURN_IF_ERROR(ParallelGenerateAndRunSamples(
+      options.worker_count, options.ast_generator_options,
+      options.sample_options, unit.seed(), /*top_run_dir=*/std::nullopt,
+      crasher_dir.path(), summary_dir.path(), unit.sample_count(),
+      /*duration=*/std::nullopt, options.force_failure,
+      options.low_priority_after, /*coverage_guided=*/false,
+      options.ir_generator_options));
+
+  fuzzer::ReportResultsRequest results;
+  results.set_worker(options.name);
+  results.set_work_unit_id(unit.id());
+  results.set_elapsed_ns(absl::ToInt64Nanoseconds(absl::Now() - start));
+  XLS_RETURN_IF_ERROR(CollectCrashers(crasher_dir.path(), results));
+  XLS_RETURN_IF_ERROR(CollectSummaries(summary_dir.path(), results));
+  return results;
+}
+
+absl::Status RunFuzzWorker(const std::string& coordinator,
+                           const FuzzWorkerOptions& options) {
+  std::shared_ptr<::grpc::Channel> channel = ::grpc::CreateChannel(
+      coordinator, synthesis::GetChannelCredentials());
+  std::unique_ptr<fuzzer::FuzzCoordinatorService::Stub> stub =
+      fuzzer::FuzzCoordinatorService::NewStub(channel);
+  while (true) {
+    fuzzer::GetWorkRequest request;
+    request.set_worker(options.name);
+    fuzzer::GetWorkResponse response;
+    {
+      ::grpc::ClientContext context;
+      XLS_RETURN_IF_ERROR(
+          FromGrpcStatus(stub->GetWork(&context, request, &response)));
+    }
+    if (!response.has_work_unit()) {
+      LOG(INFO) << "Coordinator has no more work; exiting";
+      return absl::OkStatus();
+    }
+    const fuzzer::WorkUnitProto& unit = response.work_unit();
+    XLS_ASSIGN_OR_RETURN(fuzzer::ReportResultsRequest results,
+                         RunWorkUnit(options, unit));
+    fuzzer::ReportResultsResponse report_response;
+    {
+      ::grpc::ClientContext context;
+      XLS_RETURN_IF_ERROR(FromGrpcStatus(
+          stub->ReportResults(&context, results, &report_response)));
+    }
+    LOG(INFO) << absl::StreamFormat(
+        "Work unit %d: ran %d samples in %s; %d crashers, %d new",
+        unit.id(), results.samples_run(),
+        absl::FormatDuration(absl::Nanoseconds(results.elapsed_ns())),
+        results.crashers_size(), report_response.new_crashers());
+  }
+}
+
+}  // namespace xls
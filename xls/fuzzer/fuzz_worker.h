@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_FUZZ_WORKER_H_
+#define XLS_FUZZER_FUZZ_WORKER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/fuzz_coordinator.pb.h"
+#include "xls/fuzzer/ir_generator.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+struct FuzzWorkerOptions {
+  // Name reported to the coordinator; must be unique across the fleet.
+  std::string name;
+  // Number of threads on which to run the samples of each work unit.
+  int64_t worker_count = 1;
+  dslx::AstGeneratorOptions ast_generator_options;
+  SampleOptions sample_options;
+  std::optional<IrGeneratorOptions> ir_generator_options;
+  bool force_failure = false;
+  std::optional<absl::Duration> low_priority_after;
+};
+
+// Runs the samples of `unit` with ParallelGenerateAndRunSamples and returns
+// the crashers, summaries and throughput to report for it.
+absl::StatusOr<fuzzer::ReportResultsRequest> RunWorkUnit(
+    const FuzzWorkerOptions& options, const fuzzer::WorkUnitProto& unit);
+
+// Runs work units from the FuzzCoordinatorService at `coordinator` (a gRPC
+// address) and reports their results, until it has no more work to hand out.
+absl::Status RunFuzzWorker(const std::string& coordinator,
+                           const FuzzWorkerOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_FUZZ_WORKER_H_
@@ -0,0 +1,589 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_tools.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+namespace xls {
+namespace {
+
+// The flags and positional arguments of a tool invocation. Flags are consumed
+// as the tool recognizes them, so that any left over can be reported as
+// unsupported.
+class ToolArgs {
+ public:
+  explicit ToolArgs(absl::Span<const std::string> args) {
+    for (const std::string& arg : args) {
+      if (!absl::StartsWith(arg, "--")) {
+        positional_.push_back(arg);
+        continue;
+      }
+      std::vector<std::string> name_and_value = absl::StrSplit(
+          std::string_view(arg).substr(2), absl::MaxSplits('=', 1));
+      if (name_and_value.size() == 1) {
+        flags_[name_and_value[0]] = std::nullopt;
+      } else {
+        flags_[name_and_value[0]] = name_and_value[1];
+      }
+    }
+  }
+
+  const std::vector<std::string>& positional() const { return positional_; }
+
+  // Removes and returns the value of the flag `name`, if given.
+  absl::StatusOr<std::optional<std::string>> TakeFlag(std::string_view name) {
+    auto it = flags_.find(name);
+    if (it == flags_.end()) {
+      return std::nullopt;
+    }
+    if (!it->second.has_value()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing value for flag --%s", name));
+    }
+    std::string value = *it->second;
+    flags_.erase(it);
+    return value;
+  }
+
+  // Removes and returns the value of the boolean flag `name`, which may also be
+  // given as `--name` or `--noname`.
+  absl::StatusOr<std::optional<bool>> TakeBoolFlag(std::string_view name) {
+    if (auto it = flags_.find(absl::StrCat("no", name));
+        it != flags_.end() && !it->second.has_value()) {
+      flags_.erase(it);
+      return false;
+    }
+    auto it = flags_.find(name);
+    if (it == flags_.end()) {
+      return std::nullopt;
+    }
+    bool value = true;
+    if (it->second.has_value() && !absl::SimpleAtob(*it->second, &value)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid value for boolean flag --%s: %s", name, *it->second));
+    }
+    flags_.erase(it);
+    return value;
+  }
+
+  absl::StatusOr<std::optional<int64_t>> TakeInt64Flag(std::string_view name) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> text, TakeFlag(name));
+    if (!text.has_value()) {
+      return std::nullopt;
+    }
+    int64_t value;
+    if (!absl::SimpleAtoi(*text, &value)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid value for integer flag --%s: %s", name, *text));
+    }
+    return value;
+  }
+
+  // Sets each scalar (or repeated string) field of `message` from the flag of
+  // the same name, parsed as absl parses a flag of the field's type.
+  absl::Status TakeFields(google::protobuf::Message& message) {
+    const google::protobuf::Descriptor* descriptor = message.GetDescriptor();
+    const google::protobuf::Reflection* reflection = message.GetReflection();
+    for (int i = 0; i < descriptor->field_count(); ++i) {
+      const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+      if (field->is_repeated()) {
+        if (field->cpp_type() !=
+            google::protobuf::FieldDescriptor::CPPTYPE_STRING) {
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(std::optional<std::string> text,
+                             TakeFlag(field->name()));
+        if (text.has_value()) {
+          reflection->ClearField(&message, field);
+          for (std::string_view element :
+               absl::StrSplit(*text, ',', absl::SkipEmpty())) {
+            reflection->AddString(&message, field, std::string(element));
+          }
+        }
+        continue;
+      }
+      switch (field->cpp_type()) {
+        case google::protobuf::FieldDescriptor::CPPTYPE_BOOL: {
+          XLS_ASSIGN_OR_RETURN(std::optional<bool> value,
+                               TakeBoolFlag(field->name()));
+          if (value.has_value()) {
+            reflection->SetBool(&message, field, *value);
+          }
+          break;
+        }
+        case google::protobuf::FieldDescriptor::CPPTYPE_INT64: {
+          XLS_ASSIGN_OR_RETURN(std::optional<int64_t> value,
+                               TakeInt64Flag(field->name()));
+          if (value.has_value()) {
+            reflection->SetInt64(&message, field, *value);
+          }
+          break;
+        }
+        case google::protobuf::FieldDescriptor::CPPTYPE_STRING: {
+          XLS_ASSIGN_OR_RETURN(std::optional<std::string> value,
+                               TakeFlag(field->name()));
+          if (value.has_value()) {
+            reflection->SetString(&message, field, *value);
+          }
+          break;
+        }
+        default:
+          // Enums, messages and floating-point fields have no uniform flag
+          // syntax; flags for them are left to be reported as unsupported.
+          break;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns an UnimplementedError naming the flags which were not taken, if
+  // any.
+  absl::Status CheckAllTaken(std::string_view tool) const {
+    if (flags_.empty()) {
+      return absl::OkStatus();
+    }
+    std::vector<std::string_view> names;
+    for (const auto& [name, value] : flags_) {
+      names.push_back(name);
+    }
+    return absl::UnimplementedError(
+        absl::StrFormat("Flags not supported by in-process %s: --%s", tool,
+                        absl::StrJoin(names, ", --")));
+  }
+
+  // Returns the single positional argument, resolved against `run_dir`.
+  absl::StatusOr<std::filesystem::path> SinglePath(
+      std::string_view tool, const std::filesystem::path& run_dir) const {
+    if (positional_.size() != 1) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "In-process %s requires a single input file; got %d arguments", tool,
+          positional_.size()));
+    }
+    return run_dir / positional_.front();
+  }
+
+ private:
+  absl::btree_map<std::string, std::optional<std::string>, std::less<>>
+      flags_;
+  std::vector<std::string> positional_;
+};
+
+// The codegen_main flag defaults which differ from those of the proto.
+CodegenFlagsProto DefaultCodegenFlags() {
+  CodegenFlagsProto proto;
+  proto.set_generator(GENERATOR_KIND_PIPELINE);
+  proto.set_flop_inputs(true);
+  proto.set_flop_outputs(true);
+  proto.set_flop_inputs_kind(IO_KIND_FLOP);
+  proto.set_flop_outputs_kind(IO_KIND_FLOP);
+  proto.set_flop_single_value_channels(true);
+  proto.set_output_port_name("out");
+  proto.set_reset_data_path(true);
+  proto.set_use_system_verilog(true);
+  proto.set_streaming_channel_valid_suffix("_vld");
+  proto.set_streaming_channel_ready_suffix("_rdy");
+  proto.set_gate_recvs(true);
+  proto.set_array_index_bounds_checking(true);
+  proto.set_register_merge_strategy(STRATEGY_IDENTITY_ONLY);
+  proto.set_emit_sv_types(true);
+  proto.set_simulation_macro_name("SIMULATION");
+  proto.set_block_generation_threads(1);
+  return proto;
+}
+
+// The codegen_main scheduling flag defaults which differ from those of the
+// proto.
+SchedulingOptionsFlagsProto DefaultSchedulingOptionsFlags() {
+  SchedulingOptionsFlagsProto proto;
+  proto.set_opt_level(kMaxOptLevel);
+  proto.set_worst_case_throughput(1);
+  proto.set_minimize_clock_on_failure(true);
+  proto.set_mutual_exclusion_z3_rlimit(-1);
+  proto.set_default_next_value_z3_rlimit(-1);
+  proto.mutable_failure_behavior()->set_explain_infeasibility(true);
+  return proto;
+}
+
+absl::StatusOr<IOKindProto> IOKindFromFlag(std::string_view s) {
+  if (s == "flop") {
+    return IO_KIND_FLOP;
+  }
+  if (s == "skid") {
+    return IO_KIND_SKID_BUFFER;
+  }
+  if (s == "zerolatency") {
+    return IO_KIND_ZERO_LATENCY_BUFFER;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Invalid I/O kind specified: `%s`; choices: flop, skid, zerolatency", s));
+}
+
+// Sets the fields of `proto` which codegen_main parses from strings rather than
+// by type.
+absl::Status TakeCodegenEnumFlags(ToolArgs& args, CodegenFlagsProto& proto) {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> generator,
+                       args.TakeFlag("generator"));
+  if (generator.has_value()) {
+    if (*generator == "pipeline") {
+      proto.set_generator(GENERATOR_KIND_PIPELINE);
+    } else if (*generator == "combinational") {
+      proto.set_generator(GENERATOR_KIND_COMBINATIONAL);
+    } else {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid flag given for -generator; got `%s`", *generator));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> flop_inputs_kind,
+                       args.TakeFlag("flop_inputs_kind"));
+  if (flop_inputs_kind.has_value()) {
+    XLS_ASSIGN_OR_RETURN(IOKindProto kind, IOKindFromFlag(*flop_inputs_kind));
+    proto.set_flop_inputs_kind(kind);
+  }
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> flop_outputs_kind,
+                       args.TakeFlag("flop_outputs_kind"));
+  if (flop_outputs_kind.has_value()) {
+    XLS_ASSIGN_OR_RETURN(IOKindProto kind, IOKindFromFlag(*flop_outputs_kind));
+    proto.set_flop_outputs_kind(kind);
+  }
+  return absl::OkStatus();
+}
+
+// A least-recently-used cache of JIT compilations, shared by all of the
+// EvalIrMainInProcess calls in the process (e.g. those of each worker of a
+// multi-threaded fuzzer). Entries are keyed by the IR of the top function and
+// its callees, so packages which differ only in their name or in unrelated
+// functions share a compilation.
+class JitCache {
+ public:
+  struct Entry {
+    std::unique_ptr<Package> package;
+    std::unique_ptr<FunctionJit> jit;
+  };
+
+  static JitCache& Get() {
+    static absl::NoDestructor<JitCache> cache;
+    return *cache;
+  }
+
+  void set_capacity(int64_t capacity) {
+    absl::MutexLock lock(&mutex_);
+    capacity_ = capacity;
+    EvictToCapacity();
+  }
+
+  // Returns the compilation of the top function of `package`, compiling it
+  // (and taking ownership of `package`) if it is not cached. The entry may be
+  // shared with other threads, so callers must run a Clone() of its JIT.
+  absl::StatusOr<std::shared_ptr<const Entry>> GetOrCompile(
+      std::unique_ptr<Package> package) {
+    XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+    std::string key;
+    for (FunctionBase* function_base : GetDependentFunctions(f)) {
+      absl::StrAppend(&key, function_base->DumpIr(), "\n");
+    }
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        return it->second.entry;
+      }
+    }
+    // Compile without holding the lock so that other workers are not blocked;
+    // should two compile the same function, the first to finish is kept.
+    auto entry = std::make_shared<Entry>();
+    XLS_ASSIGN_OR_RETURN(entry->jit, FunctionJit::Create(f));
+    entry->package = std::move(package);
+
+    absl::MutexLock lock(&mutex_);
+    if (capacity_ <= 0) {
+      return entry;
+    }
+    auto [it, inserted] = entries_.try_emplace(key);
+    if (inserted) {
+      recency_.push_front(key);
+      it->second = Slot{.entry = std::move(entry), .recency = recency_.begin()};
+      EvictToCapacity();
+    }
+    return it->second.entry;
+  }
+
+ private:
+  struct Slot {
+    std::shared_ptr<const Entry> entry;
+    std::list<std::string>::iterator recency;
+  };
+
+  void EvictToCapacity() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    while (entries_.size() > std::max<int64_t>(capacity_, 0)) {
+      entries_.erase(recency_.back());
+      recency_.pop_back();
+    }
+  }
+
+  absl::Mutex mutex_;
+  int64_t capacity_ ABSL_GUARDED_BY(mutex_) = 64;
+  absl::flat_hash_map<std::string, Slot> entries_ ABSL_GUARDED_BY(mutex_);
+  // The keys of `entries_`, most recently used first.
+  std::list<std::string> recency_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+void SetInProcessJitCacheCapacity(int64_t capacity) {
+  JitCache::Get().set_capacity(capacity);
+}
+
+absl::StatusOr<std::string> IrConverterMainInProcess(
+    const std::vector<std::string>& args,
+    const std::filesystem::path& run_dir) {
+  ToolArgs tool_args(args);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> top,
+                       tool_args.TakeFlag("top"));
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> dslx_stdlib_path,
+                       tool_args.TakeFlag("dslx_stdlib_path"));
+  dslx::ConvertOptions convert_options;
+  XLS_ASSIGN_OR_RETURN(std::optional<bool> emit_fail_as_assert,
+                       tool_args.TakeBoolFlag("emit_fail_as_assert"));
+  convert_options.emit_fail_as_assert = emit_fail_as_assert.value_or(true);
+  XLS_ASSIGN_OR_RETURN(std::optional<bool> verify,
+                       tool_args.TakeBoolFlag("verify"));
+  convert_options.verify_ir = verify.value_or(true);
+  XLS_ASSIGN_OR_RETURN(std::optional<bool> warnings_as_errors,
+                       tool_args.TakeBoolFlag("warnings_as_errors"));
+  convert_options.warnings_as_errors = warnings_as_errors.value_or(true);
+  XLS_ASSIGN_OR_RETURN(std::optional<bool> convert_tests,
+                       tool_args.TakeBoolFlag("convert_tests"));
+  convert_options.convert_tests = convert_tests.value_or(false);
+  XLS_RETURN_IF_ERROR(tool_args.CheckAllTaken("ir_converter_main"));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path input_path,
+                       tool_args.SinglePath("ir_converter_main", run_dir));
+
+  const std::string input_path_string = input_path.string();
+  std::vector<std::string_view> paths = {input_path_string};
+  std::optional<std::string_view> top_name;
+  if (top.has_value()) {
+    top_name = *top;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      dslx::PackageConversionData result,
+      dslx::ConvertFilesToPackage(
+          paths, dslx_stdlib_path.value_or(std::string(kDefaultDslxStdlibPath)),
+          /*dslx_paths=*/{}, convert_options, top_name));
+  return result.DumpIr();
+}
+
+absl::StatusOr<std::string> OptMainInProcess(
+    const std::vector<std::string>& args,
+    const std::filesystem::path& run_dir) {
+  ToolArgs tool_args(args);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> top,
+                       tool_args.TakeFlag("top"));
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> opt_level,
+                       tool_args.TakeInt64Flag("opt_level"));
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> pass_profile_path,
+                       tool_args.TakeFlag("pass_profile_path"));
+  XLS_RETURN_IF_ERROR(tool_args.CheckAllTaken("opt_main"));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                       tool_args.SinglePath("opt_main", run_dir));
+
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  const std::string top_name = top.value_or("");
+  // These match the opt_main flag defaults.
+  tools::OptOptions options{
+      .opt_level = opt_level.value_or(kMaxOptLevel),
+      .top = top_name,
+      .split_next_value_selects = 4,
+      .inline_procs = false,
+      .use_context_narrowing_analysis = false,
+  };
+  PassResults pass_results;
+  if (pass_profile_path.has_value()) {
+    options.pass_results = &pass_results;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string opt_ir,
+                       tools::OptimizeIrForTop(ir_text, options));
+  if (pass_profile_path.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(run_dir / *pass_profile_path,
+                         PassResultsToProfileProto(pass_results)));
+  }
+  return opt_ir;
+}
+
+absl::StatusOr<std::string> EvalIrMainInProcess(
+    const std::vector<std::string>& args,
+    const std::filesystem::path& run_dir) {
+  ToolArgs tool_args(args);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> input_file,
+                       tool_args.TakeFlag("input_file"));
+  XLS_ASSIGN_OR_RETURN(std::optional<bool> use_llvm_jit,
+                       tool_args.TakeBoolFlag("use_llvm_jit"));
+  XLS_RETURN_IF_ERROR(tool_args.CheckAllTaken("eval_ir_main"));
+  if (!input_file.has_value()) {
+    return absl::UnimplementedError(
+        "In-process eval_ir_main requires --input_file");
+  }
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                       tool_args.SinglePath("eval_ir_main", run_dir));
+
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path.string()));
+  // Only used by the interpreter; the JIT path hands `package` to the cache.
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+
+  XLS_ASSIGN_OR_RETURN(std::string inputs_text,
+                       GetFileContents(run_dir / *input_file));
+  std::vector<std::vector<Value>> arg_sets;
+  for (std::string_view line : absl::StrSplit(inputs_text, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<Value> arg_set;
+    for (std::string_view value_text : absl::StrSplit(line, ';')) {
+      XLS_ASSIGN_OR_RETURN(Value arg, Parser::ParseTypedValue(value_text),
+                           _ << "Invalid line in input file: " << line);
+      arg_set.push_back(std::move(arg));
+    }
+    arg_sets.push_back(std::move(arg_set));
+  }
+
+  // The JIT is owned by (and runs the function of) a cache entry, which is
+  // kept alive while it is in use.
+  std::shared_ptr<const JitCache::Entry> jit_entry;
+  std::unique_ptr<FunctionJit> jit;
+  if (use_llvm_jit.value_or(true)) {
+    XLS_ASSIGN_OR_RETURN(jit_entry,
+                         JitCache::Get().GetOrCompile(std::move(package)));
+    jit = jit_entry->jit->Clone();
+  }
+  std::string results;
+  for (const std::vector<Value>& arg_set : arg_sets) {
+    Value result;
+    if (jit != nullptr) {
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(jit->Run(arg_set)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          result, DropInterpreterEvents(InterpretFunction(f, arg_set)));
+    }
+    absl::StrAppend(&results, result.ToString(FormatPreference::kHex), "\n");
+  }
+  return results;
+}
+
+absl::StatusOr<std::string> CodegenMainInProcess(
+    const std::vector<std::string>& args,
+    const std::filesystem::path& run_dir) {
+  ToolArgs tool_args(args);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> signature_path,
+                       tool_args.TakeFlag("output_signature_path"));
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> block_ir_path,
+                       tool_args.TakeFlag("output_block_ir_path"));
+  CodegenFlagsProto codegen_flags = DefaultCodegenFlags();
+  SchedulingOptionsFlagsProto scheduling_flags =
+      DefaultSchedulingOptionsFlags();
+  XLS_RETURN_IF_ERROR(TakeCodegenEnumFlags(tool_args, codegen_flags));
+  XLS_RETURN_IF_ERROR(tool_args.TakeFields(codegen_flags));
+  XLS_RETURN_IF_ERROR(tool_args.TakeFields(scheduling_flags));
+  XLS_RETURN_IF_ERROR(tool_args.CheckAllTaken("codegen_main"));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                       tool_args.SinglePath("codegen_main", run_dir));
+  // codegen_main dies rather than returning an error for this.
+  if (codegen_flags.generator() == GENERATOR_KIND_PIPELINE &&
+      scheduling_flags.pipeline_stages() == 0 &&
+      scheduling_flags.clock_period_ps() == 0) {
+    return absl::InvalidArgumentError(
+        "Must specify --pipeline_stages or --clock_period_ps (or both).");
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path.string()));
+  if (!codegen_flags.top().empty()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(codegen_flags.top()));
+  }
+  XLS_RET_CHECK(package->GetTop().has_value())
+      << "Package " << package->name() << " needs a top function/proc.";
+
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult result,
+      ScheduleAndCodegen(package.get(), scheduling_flags, codegen_flags,
+                         /*with_delay_model=*/
+                         !scheduling_flags.delay_model().empty()));
+  if (block_ir_path.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir / *block_ir_path, package->DumpIr()));
+  }
+  if (signature_path.has_value()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        run_dir / *signature_path,
+        result.module_generator_result.signature.proto()));
+  }
+  return result.module_generator_result.verilog_text;
+}
+
+}  // namespace xls
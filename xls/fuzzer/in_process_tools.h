@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_IN_PROCESS_TOOLS_H_
+#define XLS_FUZZER_IN_PROCESS_TOOLS_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// In-process implementations of the tools the SampleRunner otherwise invokes as
+// subprocesses, built directly on the IR converter, optimizer, interpreter, JIT
+// and codegen libraries.
+//
+// Each takes the arguments the SampleRunner passes to the corresponding binary
+// and returns what the binary would print to stdout; any other files the binary
+// would write (e.g. the module signature) are written too. Relative paths are
+// resolved against `run_dir`, in which the binary would have been run.
+//
+// Only the flags used by the fuzzer are supported. For any other flag these
+// return an UnimplementedError before doing any work, and the caller should
+// run the binary instead.
+
+// As ir_converter_main.
+absl::StatusOr<std::string> IrConverterMainInProcess(
+    const std::vector<std::string>& args, const std::filesystem::path& run_dir);
+
+// As opt_main.
+absl::StatusOr<std::string> OptMainInProcess(
+    const std::vector<std::string>& args, const std::filesystem::path& run_dir);
+
+// As eval_ir_main with --input_file, for a package with a function as top.
+//
+// JIT compilations are cached (see SetInProcessJitCacheCapacity), so that
+// evaluating the same function again, e.g. when optimization leaves it
+// unchanged or a crasher is rerun, only runs the compiled code.
+absl::StatusOr<std::string> EvalIrMainInProcess(
+    const std::vector<std::string>& args, const std::filesystem::path& run_dir);
+
+// As codegen_main.
+absl::StatusOr<std::string> CodegenMainInProcess(
+    const std::vector<std::string>& args, const std::filesystem::path& run_dir);
+
+// Sets the maximum number of JIT compilations cached by EvalIrMainInProcess,
+// least recently used first evicted; 0 disables the cache. 64 by default.
+void SetInProcessJitCacheCapacity(int64_t capacity);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_IN_PROCESS_TOOLS_H_
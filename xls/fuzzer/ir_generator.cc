@@ -0,0 +1,351 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/ir_generator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/discrete_distribution.h"
+#include "absl/random/distributions.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+enum class OpKind {
+  kArithmetic,
+  kLogical,
+  kComparison,
+  kShift,
+  kBitManipulation,
+  kSelect,
+  kReduction,
+};
+
+// Returns the weights of the kinds of operations, indexed by OpKind.
+std::vector<int64_t> KindWeights(const IrGeneratorOptions& options) {
+  return {options.arithmetic_weight,       options.logical_weight,
+          options.comparison_weight,       options.shift_weight,
+          options.bit_manipulation_weight, options.select_weight,
+          options.reduction_weight};
+}
+
+// Adds random operations on bits-typed values to a function or proc builder.
+class IrGenerator {
+ public:
+  IrGenerator(const IrGeneratorOptions& options, absl::BitGenRef bit_gen,
+              BuilderBase& builder)
+      : options_(options),
+        bit_gen_(bit_gen),
+        b_(builder),
+        kind_distribution_([&] {
+          std::vector<int64_t> weights = KindWeights(options);
+          return absl::discrete_distribution<int>(weights.begin(),
+                                                  weights.end());
+        }()) {}
+
+  // Returns a random width of a generated value.
+  int64_t RandomWidth() {
+    return absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen_, 1,
+                                  options_.max_bit_width);
+  }
+
+  // Adds between `min_op_count` and `max_op_count` operations whose operands
+  // are in `values`, appending each result to `values`.
+  void AddOperations(std::vector<BValue>& values) {
+    int64_t op_count = absl::Uniform<int64_t>(
+        absl::IntervalClosed, bit_gen_, options_.min_op_count,
+        options_.max_op_count);
+    for (int64_t i = 0; i < op_count; ++i) {
+      values.push_back(AddOperation(values));
+    }
+  }
+
+  // Returns `value` truncated or zero-extended to `width` bits.
+  BValue Coerce(BValue value, int64_t width) {
+    int64_t value_width = value.BitCountOrDie();
+    if (value_width > width) {
+      return b_.BitSlice(value, /*start=*/0, width);
+    }
+    if (value_width < width) {
+      return b_.ZeroExtend(value, width);
+    }
+    return value;
+  }
+
+ private:
+  BValue Operand(absl::Span<const BValue> values) {
+    return values[absl::Uniform<size_t>(bit_gen_, 0, values.size())];
+  }
+
+  template <typename T>
+  T Choose(absl::Span<const T> choices) {
+    return choices[absl::Uniform<size_t>(bit_gen_, 0, choices.size())];
+  }
+
+  BValue AddOperation(absl::Span<const BValue> values) {
+    BValue x = Operand(values);
+    int64_t width = x.BitCountOrDie();
+    switch (static_cast<OpKind>(kind_distribution_(bit_gen_))) {
+      case OpKind::kArithmetic: {
+        Op op = Choose<Op>({Op::kAdd, Op::kSub, Op::kNeg, Op::kUMul, Op::kSMul,
+                            Op::kUDiv, Op::kSDiv, Op::kUMod, Op::kSMod});
+        if (op == Op::kNeg) {
+          return b_.Negate(x);
+        }
+        BValue y = Coerce(Operand(values), width);
+        if (op == Op::kUMul || op == Op::kSMul) {
+          std::optional<int64_t> result_width;
+          if (absl::Bernoulli(bit_gen_, 0.5)) {
+            result_width = RandomWidth();
+          }
+          return b_.AddArithOp(op, x, y, result_width);
+        }
+        return b_.AddBinOp(op, x, y);
+      }
+      case OpKind::kLogical: {
+        Op op = Choose<Op>(
+            {Op::kAnd, Op::kOr, Op::kXor, Op::kNand, Op::kNor, Op::kNot});
+        if (op == Op::kNot) {
+          return b_.Not(x);
+        }
+        std::vector<BValue> operands = {x};
+        int64_t operand_count = absl::Uniform<int64_t>(absl::IntervalClosed,
+                                                       bit_gen_, 2, 3);
+        while (operands.size() < operand_count) {
+          operands.push_back(Coerce(Operand(values), width));
+        }
+        return b_.AddNaryOp(op, operands);
+      }
+      case OpKind::kComparison: {
+        Op op = Choose<Op>({Op::kEq, Op::kNe, Op::kULt, Op::kULe, Op::kUGt,
+                            Op::kUGe, Op::kSLt, Op::kSLe, Op::kSGt, Op::kSGe});
+        return b_.AddCompareOp(op, x, Coerce(Operand(values), width));
+      }
+      case OpKind::kShift: {
+        Op op = Choose<Op>({Op::kShll, Op::kShrl, Op::kShra});
+        return b_.AddBinOp(op, x, Operand(values));
+      }
+      case OpKind::kBitManipulation:
+        return AddBitManipulation(x, values);
+      case OpKind::kSelect:
+        return AddSelect(x, values);
+      case OpKind::kReduction: {
+        Op op = Choose<Op>({Op::kAndReduce, Op::kOrReduce, Op::kXorReduce});
+        return b_.AddBitwiseReductionOp(op, x);
+      }
+    }
+    return x;
+  }
+
+  BValue AddBitManipulation(BValue x, absl::Span<const BValue> values) {
+    int64_t width = x.BitCountOrDie();
+    switch (absl::Uniform<int>(bit_gen_, 0, 8)) {
+      case 0: {
+        BValue concat = b_.Concat({x, Operand(values)});
+        return Coerce(concat,
+                      std::min(concat.BitCountOrDie(), options_.max_bit_width));
+      }
+      case 1: {
+        int64_t start = absl::Uniform<int64_t>(bit_gen_, 0, width);
+        return b_.BitSlice(x, start,
+                           absl::Uniform<int64_t>(absl::IntervalClosed,
+                                                  bit_gen_, 1, width - start));
+      }
+      case 2:
+        return b_.DynamicBitSlice(
+            x, Operand(values),
+            absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen_, 1, width));
+      case 3:
+        return b_.ZeroExtend(x, std::max(width, RandomWidth()));
+      case 4:
+        return b_.SignExtend(x, std::max(width, RandomWidth()));
+      case 5:
+        return b_.Reverse(x);
+      case 6: {
+        // The width of a decode is at most 2**width.
+        int64_t max_width = width >= 62 ? options_.max_bit_width
+                                        : std::min(options_.max_bit_width,
+                                                   int64_t{1} << width);
+        return b_.Decode(x, absl::Uniform<int64_t>(absl::IntervalClosed,
+                                                   bit_gen_, 1, max_width));
+      }
+      default:
+        // An encode of a single bit would be zero-width.
+        return width > 1 ? b_.Encode(x) : b_.Reverse(x);
+    }
+  }
+
+  BValue AddSelect(BValue x, absl::Span<const BValue> values) {
+    int64_t width = x.BitCountOrDie();
+    auto cases = [&](int64_t count) {
+      std::vector<BValue> result = {x};
+      while (result.size() < count) {
+        result.push_back(Coerce(Operand(values), width));
+      }
+      return result;
+    };
+    int64_t selector_width =
+        absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen_, 1, 3);
+    BValue selector = Coerce(Operand(values), selector_width);
+    switch (absl::Uniform<int>(bit_gen_, 0, 3)) {
+      case 0: {
+        // A select with fewer cases than selector values needs a default.
+        int64_t case_count = absl::Uniform<int64_t>(
+            absl::IntervalClosed, bit_gen_, 1, int64_t{1} << selector_width);
+        std::optional<BValue> default_value;
+        if (case_count < (int64_t{1} << selector_width)) {
+          default_value = Coerce(Operand(values), width);
+        }
+        return b_.Select(selector, cases(case_count), default_value);
+      }
+      case 1:
+        return b_.PrioritySelect(selector, cases(selector_width),
+                                 Coerce(Operand(values), width));
+      default:
+        return b_.OneHotSelect(selector, cases(selector_width));
+    }
+  }
+
+  const IrGeneratorOptions& options_;
+  absl::BitGenRef bit_gen_;
+  BuilderBase& b_;
+  absl::discrete_distribution<int> kind_distribution_;
+};
+
+// Returns the values which have no users, or the last value if all are used.
+std::vector<BValue> UnusedValues(absl::Span<const BValue> values) {
+  std::vector<BValue> unused;
+  for (const BValue& value : values) {
+    if (value.node()->users().empty()) {
+      unused.push_back(value);
+    }
+  }
+  if (unused.empty()) {
+    unused.push_back(values.back());
+  }
+  return unused;
+}
+
+absl::Status GenerateFunction(const IrGeneratorOptions& options,
+                              absl::BitGenRef bit_gen, Package* package) {
+  FunctionBuilder fb("main", package);
+  IrGenerator generator(options, bit_gen, fb);
+  std::vector<BValue> values;
+  int64_t param_count = absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen,
+                                               1, options.max_param_count);
+  for (int64_t i = 0; i < param_count; ++i) {
+    values.push_back(fb.Param(absl::StrCat("p", i),
+                              package->GetBitsType(generator.RandomWidth())));
+  }
+  generator.AddOperations(values);
+  XLS_ASSIGN_OR_RETURN(Function * f,
+                       fb.BuildWithReturnValue(fb.Tuple(UnusedValues(values))));
+  return package->SetTop(f);
+}
+
+absl::Status GenerateProc(const IrGeneratorOptions& options,
+                          absl::BitGenRef bit_gen, Package* package) {
+  TokenlessProcBuilder pb("main", "tkn", package);
+  IrGenerator generator(options, bit_gen, pb);
+  std::vector<BValue> values;
+  int64_t input_count = absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen,
+                                               1, options.max_input_channels);
+  for (int64_t i = 0; i < input_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        StreamingChannel * channel,
+        package->CreateStreamingChannel(
+            absl::StrCat("main__in", i), ChannelOps::kReceiveOnly,
+            package->GetBitsType(generator.RandomWidth())));
+    values.push_back(pb.Receive(channel));
+  }
+  std::vector<BValue> state;
+  int64_t state_count = absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen,
+                                               0, options.max_state_elements);
+  for (int64_t i = 0; i < state_count; ++i) {
+    Type* type = package->GetBitsType(generator.RandomWidth());
+    state.push_back(
+        pb.StateElement(absl::StrCat("s", i), RandomValue(type, bit_gen)));
+    values.push_back(state.back());
+  }
+  generator.AddOperations(values);
+
+  // Send the unused values, cycling through them if there are more output
+  // channels, and feed the most recent values back into the state.
+  std::vector<BValue> unused = UnusedValues(values);
+  int64_t output_count = absl::Uniform<int64_t>(absl::IntervalClosed, bit_gen,
+                                                1, options.max_output_channels);
+  for (int64_t i = 0; i < output_count; ++i) {
+    BValue data = unused[i % unused.size()];
+    XLS_ASSIGN_OR_RETURN(StreamingChannel * channel,
+                         package->CreateStreamingChannel(
+                             absl::StrCat("main__out", i),
+                             ChannelOps::kSendOnly, data.GetType()));
+    pb.Send(channel, data);
+  }
+  std::vector<BValue> next_state;
+  for (int64_t i = 0; i < state.size(); ++i) {
+    next_state.push_back(generator.Coerce(values[values.size() - 1 - i],
+                                          state[i].BitCountOrDie()));
+  }
+  XLS_ASSIGN_OR_RETURN(Proc * proc, pb.Build(next_state));
+  return package->SetTop(proc);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<Package>> GenerateIrPackage(
+    const IrGeneratorOptions& options, absl::BitGenRef bit_gen) {
+  if (options.max_bit_width < 1 || options.max_param_count < 1 ||
+      options.max_input_channels < 1 || options.max_output_channels < 1 ||
+      options.max_state_elements < 0 || options.min_op_count < 0 ||
+      options.max_op_count < options.min_op_count) {
+    return absl::InvalidArgumentError("Invalid IR generator options.");
+  }
+  std::vector<int64_t> weights = KindWeights(options);
+  if (absl::c_any_of(weights, [](int64_t w) { return w < 0; }) ||
+      absl::c_all_of(weights, [](int64_t w) { return w == 0; })) {
+    return absl::InvalidArgumentError(
+        "Operation weights must be non-negative with at least one positive.");
+  }
+  auto package = std::make_unique<Package>("sample");
+  if (options.generate_proc) {
+    XLS_RETURN_IF_ERROR(GenerateProc(options, bit_gen, package.get()));
+  } else {
+    XLS_RETURN_IF_ERROR(GenerateFunction(options, bit_gen, package.get()));
+  }
+  return package;
+}
+
+}  // namespace xls
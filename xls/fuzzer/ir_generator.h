@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_IR_GENERATOR_H_
+#define XLS_FUZZER_IR_GENERATOR_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Options for generating random IR packages (see GenerateIrPackage).
+struct IrGeneratorOptions {
+  // Whether the top of the package is a proc rather than a function.
+  bool generate_proc = false;
+
+  // The range of the number of operations generated in the top, besides its
+  // parameters, receives, sends and state.
+  int64_t min_op_count = 4;
+  int64_t max_op_count = 32;
+
+  // The maximum width of the generated bits values.
+  int64_t max_bit_width = 64;
+
+  // The maximum number of parameters of a function top (at least one).
+  int64_t max_param_count = 4;
+
+  // The topology of a proc top: the maximum number of input channels (at least
+  // one), output channels (at least one) and state elements (possibly none).
+  // Each input channel is received from and each output channel sent on once
+  // per activation.
+  int64_t max_input_channels = 2;
+  int64_t max_output_channels = 2;
+  int64_t max_state_elements = 2;
+
+  // The relative weights of the kinds of operations generated. A kind with
+  // weight zero is not generated.
+  //
+  // add, sub, neg, umul, smul, udiv, sdiv, umod, smod.
+  int64_t arithmetic_weight = 4;
+  // and, or, xor, nand, nor, not.
+  int64_t logical_weight = 4;
+  // eq, ne, ult, ule, ugt, uge, slt, sle, sgt, sge.
+  int64_t comparison_weight = 2;
+  // shll, shrl, shra.
+  int64_t shift_weight = 2;
+  // concat, bit_slice, dynamic_bit_slice, zero_ext, sign_ext, reverse,
+  // decode, encode.
+  int64_t bit_manipulation_weight = 3;
+  // sel, priority_sel, one_hot_sel.
+  int64_t select_weight = 2;
+  // and_reduce, or_reduce, xor_reduce.
+  int64_t reduction_weight = 1;
+};
+
+// Returns a random well-formed package whose top, named "main", is a function
+// or proc of bits-typed values satisfying `options`. A function returns a
+// tuple of the values it computes which are not otherwise used. The input
+// channels of a proc are named "main__in<i>" and its output channels
+// "main__out<i>".
+absl::StatusOr<std::unique_ptr<Package>> GenerateIrPackage(
+    const IrGeneratorOptions& options, absl::BitGenRef bit_gen);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_IR_GENERATOR_H_
@@ -0,0 +1,133 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/ir_generator.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+TEST(IrGeneratorTest, GeneratesWellFormedFunctions) {
+  IrGeneratorOptions options;
+  options.max_bit_width = 16;
+  options.max_param_count = 3;
+  for (uint64_t seed = 0; seed < 100; ++seed) {
+    std::mt19937_64 rng(seed);
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             GenerateIrPackage(options, rng));
+    XLS_ASSERT_OK(VerifyPackage(package.get()));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+    EXPECT_EQ(f->name(), "main");
+    EXPECT_GE(f->params().size(), 1);
+    EXPECT_LE(f->params().size(), 3);
+    EXPECT_GE(f->node_count(), f->params().size() + options.min_op_count);
+    for (Node* node : f->nodes()) {
+      if (node->GetType()->IsBits()) {
+        EXPECT_LE(node->BitCountOrDie(), 16) << node->ToString();
+      }
+    }
+  }
+}
+
+TEST(IrGeneratorTest, GeneratesWellFormedProcs) {
+  IrGeneratorOptions options;
+  options.generate_proc = true;
+  options.max_input_channels = 3;
+  options.max_output_channels = 2;
+  options.max_state_elements = 2;
+  for (uint64_t seed = 0; seed < 100; ++seed) {
+    std::mt19937_64 rng(seed);
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             GenerateIrPackage(options, rng));
+    XLS_ASSERT_OK(VerifyPackage(package.get()));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetTopAsProc());
+    EXPECT_LE(proc->GetStateElementCount(), 2);
+    int64_t receives = 0;
+    int64_t sends = 0;
+    for (Node* node : proc->nodes()) {
+      receives += node->Is<Receive>() ? 1 : 0;
+      sends += node->Is<Send>() ? 1 : 0;
+    }
+    EXPECT_GE(receives, 1);
+    EXPECT_LE(receives, 3);
+    EXPECT_GE(sends, 1);
+    EXPECT_LE(sends, 2);
+    EXPECT_EQ(package->channels().size(), receives + sends);
+  }
+}
+
+TEST(IrGeneratorTest, OpWeightsSelectOperations) {
+  IrGeneratorOptions options;
+  options.arithmetic_weight = 0;
+  options.logical_weight = 0;
+  options.comparison_weight = 1;
+  options.shift_weight = 0;
+  options.bit_manipulation_weight = 0;
+  options.select_weight = 0;
+  options.reduction_weight = 0;
+  std::mt19937_64 rng(0);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           GenerateIrPackage(options, rng));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+  int64_t comparisons = 0;
+  for (Node* node : f->nodes()) {
+    // Only comparisons and the slices and extensions of their operands.
+    EXPECT_TRUE(node->Is<Param>() || node->Is<Tuple>() ||
+                OpIsCompare(node->op()) || node->op() == Op::kBitSlice ||
+                node->op() == Op::kZeroExt)
+        << node->ToString();
+    comparisons += OpIsCompare(node->op()) ? 1 : 0;
+  }
+  EXPECT_GE(comparisons, options.min_op_count);
+}
+
+TEST(IrGeneratorTest, InvalidOptions) {
+  std::mt19937_64 rng(0);
+  IrGeneratorOptions options;
+  options.min_op_count = 10;
+  options.max_op_count = 5;
+  EXPECT_THAT(GenerateIrPackage(options, rng),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  IrGeneratorOptions no_ops;
+  no_ops.arithmetic_weight = 0;
+  no_ops.logical_weight = 0;
+  no_ops.comparison_weight = 0;
+  no_ops.shift_weight = 0;
+  no_ops.bit_manipulation_weight = 0;
+  no_ops.select_weight = 0;
+  no_ops.reduction_weight = 0;
+  EXPECT_THAT(GenerateIrPackage(no_ops, rng),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -30,6 +30,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/stage_latency_histograms.h"
 #include "xls/ir/op.h"
 
 static constexpr std::string_view kUsage = R"(
@@ -88,11 +89,17 @@ struct SummaryInfo {
   fuzzer::SampleTimingProto total_timing;
   // The maximum time spent on a single same for the various fuzzer operations.
   fuzzer::SampleTimingProto max_timing;
+  // The distribution of the time spent on a single sample for the various
+  // fuzzer operations.
+  StageLatencyHistograms latency_histograms;
+  // The utilization of the fuzzer workers, if recorded.
+  std::vector<fuzzer::WorkerUtilizationProto> worker_utilization;
 };
 
 // Aggregates the summary data in 'summary' into 'info'.
 void AggregateSummary(const fuzzer::SampleSummaryProto& summary,
                       SummaryInfo* info) {
+  info->latency_histograms.AddSampleTiming(summary.timing());
   for (bool optimized : {false, true}) {
     SampleInfo& sample_info =
         optimized ? info->optimized_info : info->unoptimized_info;
@@ -208,6 +215,28 @@ void DumpTimingInfo(const SummaryInfo& info) {
 #undef PRINT_ROW
 }
 
+// Print the worker utilization contained in 'info' to stdout.
+void DumpUtilizationInfo(const SummaryInfo& info) {
+  auto percent = [&](int64_t num, int64_t denom) {
+    return denom == 0 ? 0.0f : 100.0f * num / denom;
+  };
+  fuzzer::WorkerUtilizationProto total;
+  for (const fuzzer::WorkerUtilizationProto& worker :
+       info.worker_utilization) {
+    std::cout << absl::StreamFormat(
+        "Worker %-4d %8d samples (%d stolen, %d deprioritized), %4.1f%% busy, "
+        "%4.1f%% idle\n",
+        worker.worker(), worker.samples_run(), worker.samples_stolen(),
+        worker.samples_deprioritized(),
+        percent(worker.busy_ns(), worker.total_ns()),
+        percent(worker.idle_ns(), worker.total_ns()));
+    total.set_busy_ns(total.busy_ns() + worker.busy_ns());
+    total.set_total_ns(total.total_ns() + worker.total_ns());
+  }
+  std::cout << absl::StreamFormat("Overall utilization: %.1f%%\n",
+                                  percent(total.busy_ns(), total.total_ns()));
+}
+
 // Dumps aggregate information about the generated samples described in 'info'
 // to stdout.
 void DumpSampleInfo(const SampleInfo& info) {
@@ -258,6 +287,10 @@ absl::Status RealMain(absl::Span<const std::string_view> input_paths) {
     for (const fuzzer::SampleSummaryProto& summary : summaries.samples()) {
       AggregateSummary(summary, &summary_info);
     }
+    summary_info.worker_utilization.insert(
+        summary_info.worker_utilization.end(),
+        summaries.worker_utilization().begin(),
+        summaries.worker_utilization().end());
   }
 
   std::cout << "Before optimizations:\n";
@@ -271,6 +304,16 @@ absl::Status RealMain(absl::Span<const std::string_view> input_paths) {
   std::cout << "\nTiming\n";
   std::cout << "------\n";
   DumpTimingInfo(summary_info);
+
+  std::cout << "\nLatency percentiles\n";
+  std::cout << "-------------------\n";
+  std::cout << summary_info.latency_histograms.ToString();
+
+  if (!summary_info.worker_utilization.empty()) {
+    std::cout << "\nWorker utilization\n";
+    std::cout << "------------------\n";
+    DumpUtilizationInfo(summary_info);
+  }
   return absl::OkStatus();
 }
 
@@ -55,6 +55,10 @@
 ABSL_DECLARE_FLAG(int32_t, v);
 ABSL_DECLARE_FLAG(std::string, vmodule);
 
+ABSL_FLAG(bool, in_process_tools, false,
+          "If true, the tools of the sample runner run within the fuzzer "
+          "process rather than as subprocesses where possible.");
+
 namespace xls {
 
 namespace {
@@ -178,7 +182,8 @@ absl::StatusOr<std::filesystem::path> SaveCrasher(
 
 absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
                        const std::optional<std::filesystem::path>& summary_file,
-                       std::optional<absl::Duration> generate_sample_elapsed) {
+                       std::optional<absl::Duration> generate_sample_elapsed,
+                       StageLatencyHistograms* latency_histograms) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_runner_main_path,
                        GetXlsRunfilePath(kSampleRunnerMainPath));
 
@@ -220,6 +225,11 @@ absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
     argv.push_back("--ir_channel_names_file=ir_channel_names.txt");
   }
 
+  const bool in_process_tools = absl::GetFlag(FLAGS_in_process_tools);
+  if (in_process_tools) {
+    argv.push_back("--in_process_tools");
+  }
+
   argv.push_back("\"$RUNDIR\"");
 
   std::filesystem::path run_script_path = run_dir / "run.sh";
@@ -236,7 +246,10 @@ cd "$RUNDIR"
 
   VLOG(1) << "Starting to run sample";
   VLOG(2) << smp.input_text();
-  SampleRunner runner(run_dir);
+  SampleRunner runner(run_dir, in_process_tools
+                                   ? SampleRunner::InProcessCommands()
+                                   : SampleRunner::Commands());
+  runner.set_latency_histograms(latency_histograms);
   XLS_RETURN_IF_ERROR(runner.RunFromFiles(sample_file_name, options_file_name,
                                           args_file_name,
                                           ir_channel_names_file_name));
@@ -253,6 +266,14 @@ cd "$RUNDIR"
     total_elapsed += *generate_sample_elapsed;
   }
   timing.set_total_ns(absl::ToInt64Nanoseconds(total_elapsed));
+  if (latency_histograms != nullptr) {
+    // The runner added the latencies of the stages it ran.
+    if (generate_sample_elapsed.has_value()) {
+      latency_histograms->AddLatency("generate_sample",
+                                     *generate_sample_elapsed);
+    }
+    latency_histograms->AddLatency("total", total_elapsed);
+  }
 
   VLOG(1) << "Completed running sample, elapsed: " << total_elapsed;
 
@@ -262,26 +283,19 @@ cd "$RUNDIR"
   return absl::OkStatus();
 }
 
-absl::StatusOr<Sample> GenerateSampleAndRun(
-    dslx::FileTable& file_table, absl::BitGenRef bit_gen,
-    const dslx::AstGeneratorOptions& ast_generator_options,
-    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_file,
-    bool force_failure) {
-  Stopwatch stopwatch;
-  XLS_ASSIGN_OR_RETURN(
-      Sample smp, GenerateSample(ast_generator_options, sample_options, bit_gen,
-                                 file_table));
-  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
-
-  absl::Status status =
-      RunSample(smp, run_dir, summary_file, generate_sample_elapsed);
+    std::optional<absl::Duration> generate_sample_elapsed, bool force_failure,
+    StageLatencyHistograms* latency_histograms) {
+  absl::Status status = RunSample(smp, run_dir, summary_file,
+                                  generate_sample_elapsed, latency_histograms);
   if (force_failure) {
     status = absl::InternalError("Forced sample failure.");
   }
   if (status.ok()) {
-    return smp;
+    return absl::OkStatus();
   }
 
   LOG(ERROR) << "Sample failed: " << status;
@@ -291,9 +305,9 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
     if (!absl::IsDeadlineExceeded(status)) {
       LOG(INFO) << "Attempting to minimize IR...";
       std::optional<absl::Duration> timeout =
-          sample_options.timeout_seconds().has_value()
+          smp.options().timeout_seconds().has_value()
               ? std::optional<absl::Duration>(
-                    absl::Seconds(*sample_options.timeout_seconds()))
+                    absl::Seconds(*smp.options().timeout_seconds()))
               : std::nullopt;
       XLS_ASSIGN_OR_RETURN(
           std::optional<std::filesystem::path> minimized_path,
@@ -311,4 +325,24 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
   return status;
 }
 
+absl::StatusOr<Sample> GenerateSampleAndRun(
+    dslx::FileTable& file_table, absl::BitGenRef bit_gen,
+    const dslx::AstGeneratorOptions& ast_generator_options,
+    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir,
+    const std::optional<std::filesystem::path>& summary_file,
+    bool force_failure) {
+  Stopwatch stopwatch;
+  XLS_ASSIGN_OR_RETURN(
+      Sample smp, GenerateSample(ast_generator_options, sample_options, bit_gen,
+                                 file_table));
+  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
+
+  XLS_RETURN_IF_ERROR(RunSampleAndSaveCrasher(smp, run_dir, crasher_dir,
+                                              summary_file,
+                                              generate_sample_elapsed,
+                                              force_failure));
+  return smp;
+}
+
 }  // namespace xls
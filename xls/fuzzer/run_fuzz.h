@@ -25,19 +25,36 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/stage_latency_histograms.h"
 
 namespace xls {
 
 // Runs the given sample in `run_dir`. If `summary_file` is given, the sample
 // summary will be appended to this file; if `generate_sample_elapsed` is also
-// given, it will be recorded in the timings in the sample summary.
+// given, it will be recorded in the timings in the sample summary. If
+// `latency_histograms` is given, the stage latencies of the run are added to
+// it.
 //
 // `run_dir` must be an empty directory.
 absl::Status RunSample(
     const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt);
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    StageLatencyHistograms* latency_histograms = nullptr);
 
+// Runs the given sample in `run_dir` as RunSample does. If the sample fails
+// (or `force_failure` is true), it is saved to a new directory in
+// `crasher_dir` if given, and its IR is minimized. Returns the status of the
+// sample run.
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
+    const std::optional<std::filesystem::path>& summary_file = std::nullopt,
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    bool force_failure = false,
+    StageLatencyHistograms* latency_histograms = nullptr);
+
+// Generates a sample and runs it with RunSampleAndSaveCrasher.
 absl::StatusOr<Sample> GenerateSampleAndRun(
     dslx::FileTable& file_table, absl::BitGenRef bit_gen,
     const dslx::AstGeneratorOptions& ast_generator_options,
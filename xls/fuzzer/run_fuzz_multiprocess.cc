@@ -14,15 +14,27 @@
 
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
@@ -31,6 +43,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
@@ -39,8 +53,14 @@
 #include "xls/common/thread.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/coverage_corpus.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/run_fuzz.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_archive.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/stage_latency_histograms.h"
+#include "xls/fuzzer/sample_summary.pb.h"
 
 namespace xls {
 namespace {
@@ -49,59 +69,298 @@ static constexpr std::string_view kBlueText = "\033[34m";
 static constexpr std::string_view kRedText = "\033[31m";
 static constexpr std::string_view kDefaultColor = "\033[0m";
 
-absl::Status GenerateAndRunSamples(
-    int64_t worker_number,
-    const dslx::AstGeneratorOptions& ast_generator_options,
-    const SampleOptions& sample_options, const std::optional<uint64_t>& seed,
-    const std::optional<std::filesystem::path>& top_run_dir,
-    const std::optional<std::filesystem::path>& crasher_dir,
-    const std::optional<std::filesystem::path>& summary_dir,
-    std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
-  int64_t crashers = 0;
-  LOG(INFO) << "--- Started worker " << worker_number;
-  Stopwatch stopwatch;
+// Generation is much cheaper than running a sample, so a single generator
+// keeps several workers busy.
+static constexpr int64_t kWorkersPerGenerator = 8;
 
-  std::optional<std::filesystem::path> summary_file;
-  if (summary_dir.has_value()) {
-    summary_file =
-        *summary_dir / absl::StrCat("summary_", worker_number, ".binarypb");
+// Number of generated samples queued per worker.
+static constexpr int64_t kQueuedSamplesPerWorker = 2;
+
+// Increment to the nice value of samples which are deprioritized.
+static constexpr int kLowPriorityNiceIncrement = 10;
+
+// In coverage-guided mode, the probability that a generator mutates a corpus
+// sample rather than generating a new one.
+static constexpr double kMutationProbability = 0.5;
+
+// A generated sample waiting to be run.
+struct GeneratedSample {
+  Sample sample;
+  absl::Duration generate_elapsed;
+};
+
+// A bounded queue of generated samples, split into one deque per worker.
+// Generators distribute samples over the deques round-robin. Each worker takes
+// the oldest sample of its own deque, and when that is empty steals the newest
+// sample of the fullest other deque, so that no worker idles while samples are
+// waiting behind a long-running one.
+class SampleQueue {
+ public:
+  SampleQueue(int64_t worker_count, int64_t capacity, int64_t generator_count)
+      : capacity_(capacity),
+        deques_(worker_count),
+        generators_(generator_count) {}
+
+  // Adds a sample to the queue, blocking while the queue is full. Returns
+  // false (dropping the sample) if the queue has been closed.
+  bool Push(GeneratedSample sample) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &SampleQueue::CanPush));
+    if (closed_) {
+      return false;
+    }
+    deques_[next_deque_].push_back(std::move(sample));
+    next_deque_ = (next_deque_ + 1) % deques_.size();
+    ++size_;
+    return true;
+  }
+
+  // Records that a generator will not push any more samples.
+  void GeneratorDone() {
+    absl::MutexLock lock(&mu_);
+    --generators_;
+  }
+
+  // Closes the queue; pending and future pushes are dropped.
+  void Close() {
+    absl::MutexLock lock(&mu_);
+    closed_ = true;
+  }
+
+  // Removes the next sample for `worker`, blocking until one is available.
+  // Sets `stolen` if the sample was taken from another worker's deque. Returns
+  // std::nullopt once the queue is empty and all generators are done.
+  std::optional<GeneratedSample> Pop(int64_t worker, bool& stolen) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &SampleQueue::CanPop));
+    if (size_ == 0) {
+      return std::nullopt;
+    }
+    std::deque<GeneratedSample>* deque = &deques_[worker];
+    stolen = deque->empty();
+    if (stolen) {
+      deque = &*absl::c_max_element(
+          deques_,
+          [](const std::deque<GeneratedSample>& a,
+             const std::deque<GeneratedSample>& b) {
+            return a.size() < b.size();
+          });
+    }
+    GeneratedSample sample = stolen ? std::move(deque->back())
+                                    : std::move(deque->front());
+    if (stolen) {
+      deque->pop_back();
+    } else {
+      deque->pop_front();
+    }
+    --size_;
+    return sample;
+  }
+
+ private:
+  bool CanPush() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return closed_ || size_ < capacity_;
   }
+  bool CanPop() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return size_ > 0 || generators_ == 0;
+  }
+
+  const int64_t capacity_;
+  absl::Mutex mu_;
+  std::vector<std::deque<GeneratedSample>> deques_ ABSL_GUARDED_BY(mu_);
+  int64_t size_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t next_deque_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t generators_ ABSL_GUARDED_BY(mu_);
+  bool closed_ ABSL_GUARDED_BY(mu_) = false;
+};
 
+// Options shared by all workers.
+struct WorkerOptions {
+  std::optional<std::filesystem::path> top_run_dir;
+  std::optional<std::filesystem::path> crasher_dir;
+  std::optional<std::filesystem::path> summary_dir;
+  std::optional<absl::Duration> duration;
+  std::optional<absl::Duration> low_priority_after;
+  bool force_failure;
+  // The corpus of coverage-guided mode; nullptr otherwise.
+  CoverageCorpus* corpus;
+  // The stage latencies of all the samples run.
+  StageLatencyHistograms* latency_histograms;
+  // If specified, each worker appends the artifacts of its samples to an
+  // archive in this directory.
+  std::optional<std::filesystem::path> archive_dir;
+};
+
+// Generates up to `sample_count` samples (unbounded if unspecified) for up to
+// `duration` time and pushes them onto `queue`.
+// If `corpus` is given, samples are mutated from it with probability
+// kMutationProbability. If `ir_generator_options` is given, samples are
+// generated as IR.
+void GenerateSamples(int64_t generator_number,
+                     const dslx::AstGeneratorOptions& ast_generator_options,
+                     const std::optional<IrGeneratorOptions>&
+                         ir_generator_options,
+                     const SampleOptions& sample_options,
+                     const std::optional<uint64_t>& seed,
+                     std::optional<int64_t> sample_count,
+                     const std::optional<absl::Duration>& duration,
+                     CoverageCorpus* corpus, SampleQueue& queue) {
+  Stopwatch stopwatch;
   uint64_t rng_seed;
   if (seed.has_value()) {
-    // Set seed deterministically based on the worker number so different
-    // workers generate different samples.
-    rng_seed = *seed + worker_number;
+    // Set seed deterministically based on the generator number so different
+    // generators generate different samples.
+    rng_seed = *seed + generator_number;
   } else {
     // Choose a nondeterministic seed.
     rng_seed = absl::Uniform<uint64_t>(absl::BitGen());
-    LOG(INFO) << kBlueText << "--- NOTE: Worker #" << worker_number
+    LOG(INFO) << kBlueText << "--- NOTE: Generator #" << generator_number
               << " chose a nondeterministic seed for value generation: "
               << absl::StreamFormat("0x%16X", rng_seed) << kDefaultColor;
   }
   std::mt19937_64 rng{rng_seed};
   dslx::FileTable file_table;
 
-  int64_t sample = 0;
-  while (true) {
-    std::filesystem::path run_dir;
-    std::optional<TempDirectory> temp_run_dir;
-    if (top_run_dir.has_value()) {
-      run_dir = *top_run_dir /
-                absl::StrFormat("worker%d-sample%d", worker_number, sample);
-      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
-    } else {
-      XLS_ASSIGN_OR_RETURN(temp_run_dir, TempDirectory::Create());
-      run_dir = temp_run_dir->path();
+  for (int64_t sample = 0;
+       !sample_count.has_value() || sample < *sample_count; ++sample) {
+    if (duration.has_value() && stopwatch.GetElapsedTime() >= *duration) {
+      break;
+    }
+    Stopwatch generate_stopwatch;
+    std::optional<Sample> parent;
+    if (corpus != nullptr && absl::Bernoulli(rng, kMutationProbability)) {
+      parent = corpus->PickSample(rng);
+    }
+    absl::StatusOr<Sample> smp = absl::NotFoundError("no parent sample");
+    if (parent.has_value()) {
+      smp = GenerateMutatedSample(*parent, rng);
+    }
+    if (ir_generator_options.has_value()) {
+      smp = GenerateIrSample(*ir_generator_options, sample_options, rng);
+    } else if (absl::IsNotFound(smp.status())) {
+      smp = GenerateSample(ast_generator_options, sample_options, rng,
+                           file_table);
+    }
+    if (!smp.ok()) {
+      LOG(ERROR) << kRedText
+                 << absl::StreamFormat(
+                        "--- Generator #%d failed to generate sample number "
+                        "%d: %s",
+                        generator_number, sample, smp.status().ToString())
+                 << kDefaultColor;
+      continue;
+    }
+    absl::Duration generate_elapsed = generate_stopwatch.GetElapsedTime();
+    if (!queue.Push({.sample = *std::move(smp),
+                     .generate_elapsed = generate_elapsed})) {
+      break;
+    }
+  }
+  queue.GeneratorDone();
+}
+
+// Raises the nice value of the thread `tid`, which also applies to any
+// subprocess the thread starts from then on.
+void LowerThreadPriority(int64_t tid) {
+#if defined(__linux__)
+  // On Linux, the nice value is a per-thread attribute.
+  errno = 0;
+  int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+  if (errno != 0 ||
+      setpriority(PRIO_PROCESS, static_cast<id_t>(tid),
+                  std::min(nice + kLowPriorityNiceIncrement, 19)) != 0) {
+    LOG(WARNING) << "Failed to lower the priority of thread " << tid;
+  }
+#endif
+}
+
+int64_t CurrentThreadId() {
+#if defined(__linux__)
+  return static_cast<int64_t>(syscall(SYS_gettid));
+#else
+  return 0;
+#endif
+}
+
+// Runs `generated` in `run_dir`. In coverage-guided mode, the features of a
+// successful run are added to the corpus. If `archive` is given, the artifacts
+// of the run are appended to it as `name`.
+absl::Status RunGeneratedSample(
+    const GeneratedSample& generated, std::string_view name,
+    const std::filesystem::path& run_dir, const WorkerOptions& options,
+    const std::optional<std::filesystem::path>& summary_file,
+    SampleArchiveWriter* archive) {
+  absl::Status status = RunSampleAndSaveCrasher(
+      generated.sample, run_dir, options.crasher_dir, summary_file,
+      generated.generate_elapsed, options.force_failure,
+      options.latency_histograms);
+  if (archive != nullptr) {
+    absl::Status archive_status =
+        archive->Append(name, generated.sample, status, run_dir);
+    if (!archive_status.ok()) {
+      LOG(WARNING) << "Failed to archive sample " << name << ": "
+                   << archive_status;
     }
+  }
+  XLS_RETURN_IF_ERROR(status);
+  if (options.corpus != nullptr) {
+    absl::StatusOr<SampleFeatures> features = GetSampleFeatures(run_dir);
+    if (!features.ok()) {
+      LOG(WARNING) << "Failed to read the coverage features of the sample: "
+                   << features.status();
+      return absl::OkStatus();
+    }
+    int64_t new_features =
+        options.corpus->AddSample(generated.sample, *features);
+    if (new_features > 0) {
+      VLOG(1) << "Sample covered " << new_features << " new features";
+    }
+  }
+  return absl::OkStatus();
+}
+
+// A sample running on its own thread, so that it can finish at reduced
+// priority while its worker moves on to other samples.
+struct BackgroundRun {
+  int64_t sample_number;
+  std::string name;
+  std::optional<GeneratedSample> generated;
+  std::filesystem::path run_dir;
+  std::optional<TempDirectory> temp_run_dir;
+  int64_t tid;
+  absl::Notification started;
+  absl::Notification done;
+  absl::Status status;
+  std::unique_ptr<Thread> thread;
+};
+
+// Runs samples from `queue` until it is exhausted or `duration` has elapsed,
+// recording how the worker spent its time in `utilization`.
+absl::Status RunSamples(int64_t worker_number, const WorkerOptions& options,
+                        SampleQueue& queue,
+                        fuzzer::WorkerUtilizationProto& utilization) {
+  int64_t crashers = 0;
+  LOG(INFO) << "--- Started worker " << worker_number;
+  Stopwatch stopwatch;
+  absl::Duration busy;
+  absl::Duration idle;
+
+  std::optional<std::filesystem::path> summary_file;
+  if (options.summary_dir.has_value()) {
+    summary_file = *options.summary_dir /
+                   absl::StrCat("summary_", worker_number, ".binarypb");
+  }
 
-    absl::Status sample_status =
-        GenerateSampleAndRun(file_table, rng, ast_generator_options,
-                             sample_options, run_dir, crasher_dir, summary_file,
-                             force_failure)
-            .status();
-    if (!sample_status.ok()) {
+  std::optional<SampleArchiveWriter> archive;
+  if (options.archive_dir.has_value()) {
+    archive.emplace(*options.archive_dir /
+                    absl::StrCat("samples_", worker_number, ".archive"));
+  }
+  SampleArchiveWriter* archive_writer =
+      archive.has_value() ? &*archive : nullptr;
+
+  auto record_status = [&](const absl::Status& status, int64_t sample) {
+    if (!status.ok()) {
       LOG(INFO) << kRedText
                 << absl::StreamFormat(
                        "--- Worker #%d noted crasher #%d for sample number %d",
@@ -109,53 +368,118 @@ absl::Status GenerateAndRunSamples(
                 << kDefaultColor;
       crashers++;
     }
+  };
 
-    absl::Duration elapsed = stopwatch.GetElapsedTime();
-    if (sample > 0 && sample % 16 == 0) {
-      std::vector<std::string> metrics;
-      metrics.reserve(3);
-      if (sample_count.has_value()) {
-        metrics.push_back(
-            absl::StrFormat("%d/%d samples", sample, *sample_count));
-      } else {
-        metrics.push_back(absl::StrCat(sample, " samples"));
-      }
-      metrics.push_back(absl::StrFormat(
-          "%.2f samples/s",
-          static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed)));
-      if (duration.has_value()) {
-        metrics.push_back(absl::StrFormat("running for %s (limit %s)",
-                                          absl::FormatDuration(elapsed),
-                                          absl::FormatDuration(*duration)));
-      } else {
-        metrics.push_back(
-            absl::StrFormat("running for %s", absl::FormatDuration(elapsed)));
-      }
-      LOG(INFO) << absl::StreamFormat("--- Worker #%d: %s", worker_number,
-                                      absl::StrJoin(metrics, ", "));
+  // The most recent sample which outlived `low_priority_after`, if it is still
+  // running. At most one such sample per worker is outstanding.
+  std::unique_ptr<BackgroundRun> deprioritized;
+  auto finish_deprioritized = [&] {
+    if (deprioritized == nullptr) {
+      return;
     }
+    Stopwatch join_stopwatch;
+    deprioritized->thread->Join();
+    busy += join_stopwatch.GetElapsedTime();
+    record_status(deprioritized->status, deprioritized->sample_number);
+    deprioritized.reset();
+  };
 
-    if (duration.has_value() && elapsed >= *duration) {
-      LOG(INFO) << absl::StreamFormat("--- Worker #%d: Ran for %s. Exiting.",
-                                      worker_number,
-                                      absl::FormatDuration(elapsed));
+  int64_t sample = 0;
+  while (!options.duration.has_value() ||
+         stopwatch.GetElapsedTime() < *options.duration) {
+    bool stolen = false;
+    Stopwatch pop_stopwatch;
+    std::optional<GeneratedSample> generated = queue.Pop(worker_number, stolen);
+    idle += pop_stopwatch.GetElapsedTime();
+    if (!generated.has_value()) {
       break;
     }
+    utilization.set_samples_stolen(utilization.samples_stolen() +
+                                   (stolen ? 1 : 0));
+
+    std::string name =
+        absl::StrFormat("worker%d-sample%d", worker_number, sample);
+    std::filesystem::path run_dir;
+    std::optional<TempDirectory> temp_run_dir;
+    if (options.top_run_dir.has_value()) {
+      run_dir = *options.top_run_dir / name;
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+    } else {
+      XLS_ASSIGN_OR_RETURN(temp_run_dir, TempDirectory::Create());
+      run_dir = temp_run_dir->path();
+    }
+
+    Stopwatch run_stopwatch;
+    if (!options.low_priority_after.has_value()) {
+      record_status(RunGeneratedSample(*generated, name, run_dir, options,
+                                       summary_file, archive_writer),
+                    sample);
+    } else {
+      auto run = std::make_unique<BackgroundRun>();
+      run->sample_number = sample;
+      run->name = name;
+      run->generated = std::move(generated);
+      run->run_dir = run_dir;
+      run->temp_run_dir = std::move(temp_run_dir);
+      run->thread = std::make_unique<Thread>([&options, &summary_file,
+                                              archive_writer, run = run.get()] {
+        run->tid = CurrentThreadId();
+        run->started.Notify();
+        run->status =
+            RunGeneratedSample(*run->generated, run->name, run->run_dir,
+                               options, summary_file, archive_writer);
+        run->done.Notify();
+      });
+      if (run->done.WaitForNotificationWithTimeout(
+              *options.low_priority_after)) {
+        run->thread->Join();
+        record_status(run->status, sample);
+      } else {
+        run->started.WaitForNotification();
+        LowerThreadPriority(run->tid);
+        utilization.set_samples_deprioritized(
+            utilization.samples_deprioritized() + 1);
+        finish_deprioritized();
+        deprioritized = std::move(run);
+      }
+    }
+    busy += run_stopwatch.GetElapsedTime();
+
     ++sample;
-    if (sample_count.has_value() && sample >= *sample_count) {
+    absl::Duration elapsed = stopwatch.GetElapsedTime();
+    if (sample % 16 == 0) {
       LOG(INFO) << absl::StreamFormat(
-          "--- Worker #%d: Ran %d samples. Exiting.", worker_number, sample);
-      break;
+          "--- Worker #%d: %d samples, %.2f samples/s, %.1f%% busy, running "
+          "for %s",
+          worker_number, sample,
+          static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed),
+          100.0 * (busy / elapsed), absl::FormatDuration(elapsed));
     }
   }
+  finish_deprioritized();
 
   absl::Duration elapsed = stopwatch.GetElapsedTime();
+  utilization.set_worker(worker_number);
+  utilization.set_samples_run(sample);
+  utilization.set_busy_ns(absl::ToInt64Nanoseconds(busy));
+  utilization.set_idle_ns(absl::ToInt64Nanoseconds(idle));
+  utilization.set_total_ns(absl::ToInt64Nanoseconds(elapsed));
   LOG(INFO) << absl::StreamFormat(
-      "--- Worker #%d finished! %d samples; %d crashers; %.2f samples/s; ran "
-      "for %s",
-      worker_number, sample, crashers,
+      "--- Worker #%d finished! %d samples (%d stolen, %d deprioritized); %d "
+      "crashers; %.2f samples/s; %.1f%% busy; ran for %s",
+      worker_number, sample, utilization.samples_stolen(),
+      utilization.samples_deprioritized(), crashers,
       static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed),
-      absl::FormatDuration(elapsed));
+      100.0 * (busy / elapsed), absl::FormatDuration(elapsed));
+
+  if (summary_file.has_value()) {
+    // Appending to the summary file concatenates the repeated fields; see
+    // summarize_ir_main.
+    fuzzer::SampleSummariesProto summaries;
+    *summaries.add_worker_utilization() = utilization;
+    XLS_RETURN_IF_ERROR(
+        AppendStringToFile(*summary_file, summaries.SerializeAsString()));
+  }
   return absl::OkStatus();
 }
 
@@ -169,25 +493,68 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
+    bool force_failure, std::optional<absl::Duration> low_priority_after,
+    bool coverage_guided,
+    const std::optional<IrGeneratorOptions>& ir_generator_options,
+    const std::optional<std::filesystem::path>& archive_dir) {
+  if (coverage_guided && ir_generator_options.has_value()) {
+    return absl::InvalidArgumentError(
+        "Coverage-guided fuzzing mutates DSLX samples and cannot be combined "
+        "with IR sample generation.");
+  }
+  std::optional<CoverageCorpus> corpus;
+  SampleOptions generator_sample_options = sample_options;
+  if (coverage_guided) {
+    corpus.emplace();
+    generator_sample_options.set_record_pass_profile(true);
+  }
+
+  const int64_t generator_count =
+      (worker_count + kWorkersPerGenerator - 1) / kWorkersPerGenerator;
+  SampleQueue queue(worker_count,
+                    /*capacity=*/kQueuedSamplesPerWorker * worker_count,
+                    generator_count);
+
+  std::vector<std::unique_ptr<Thread>> generators;
+  generators.reserve(generator_count);
+  for (int64_t i = 0; i < generator_count; ++i) {
+    std::optional<int64_t> generator_sample_count =
+        sample_count.has_value()
+            ? std::make_optional((*sample_count + i) / generator_count)
+            : std::nullopt;
+    generators.push_back(std::make_unique<Thread>([&, i,
+                                                   generator_sample_count] {
+      GenerateSamples(i, ast_generator_options, ir_generator_options,
+                      generator_sample_options, seed, generator_sample_count,
+                      duration, corpus.has_value() ? &*corpus : nullptr, queue);
+    }));
+  }
+
+  StageLatencyHistograms latency_histograms;
+  WorkerOptions options{.top_run_dir = top_run_dir,
+                        .crasher_dir = crasher_dir,
+                        .summary_dir = summary_dir,
+                        .duration = duration,
+                        .low_priority_after = low_priority_after,
+                        .force_failure = force_failure,
+                        .corpus = corpus.has_value() ? &*corpus : nullptr,
+                        .latency_histograms = &latency_histograms,
+                        .archive_dir = archive_dir};
   std::vector<std::unique_ptr<Thread>> workers;
   workers.resize(worker_count);
   std::vector<absl::Status> worker_status;
   worker_status.resize(workers.size(),
                        absl::InternalError("worker did not terminate."));
+  std::vector<fuzzer::WorkerUtilizationProto> utilization(workers.size());
   for (int64_t i = 0; i < workers.size(); ++i) {
-    std::optional<int64_t> worker_sample_count =
-        sample_count.has_value()
-            ? std::make_optional((*sample_count + i) / worker_count)
-            : std::nullopt;
-    workers[i] = std::make_unique<Thread>([&, i, worker_sample_count,
-                                           status = &worker_status[i]] {
-      *status =
-          GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
-                                top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
-    });
+    workers[i] = std::make_unique<Thread>(
+        [&, i, status = &worker_status[i], worker_utilization =
+                                               &utilization[i]] {
+          *status = RunSamples(i, options, queue, *worker_utilization);
+        });
   }
+  absl::Duration busy;
+  absl::Duration total;
   for (int64_t i = 0; i < workers.size(); ++i) {
     LOG(INFO) << "-- Waiting on worker " << i;
     workers[i]->Join();
@@ -195,7 +562,25 @@ absl::Status ParallelGenerateAndRunSamples(
       LOG(ERROR) << kRedText << "-- Worker #" << i
                  << " failed: " << worker_status[i] << kDefaultColor;
     }
+    busy += absl::Nanoseconds(utilization[i].busy_ns());
+    total += absl::Nanoseconds(utilization[i].total_ns());
+  }
+
+  // Unblock any generator still waiting for room in the queue.
+  queue.Close();
+  for (std::unique_ptr<Thread>& generator : generators) {
+    generator->Join();
+  }
+  if (total > absl::ZeroDuration()) {
+    LOG(INFO) << absl::StreamFormat("-- Worker utilization: %.1f%%",
+                                    100.0 * (busy / total));
+  }
+  if (corpus.has_value()) {
+    LOG(INFO) << absl::StreamFormat(
+        "-- Coverage: %d features; %d samples in the corpus",
+        corpus->feature_count(), corpus->size());
   }
+  LOG(INFO) << "-- Stage latencies:\n" << latency_histograms.ToString();
   return absl::OkStatus();
 }
 
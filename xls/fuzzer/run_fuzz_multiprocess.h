@@ -22,6 +22,7 @@
 #include "absl/status/status.h"
 #include "absl/time/time.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/sample.h"
 
 namespace xls {
@@ -29,6 +30,12 @@ namespace xls {
 // Generate and run fuzzer samples on `worker_count` threads; runs up to
 // `sample_count` samples (unbounded if unspecified) for up to `duration` time.
 //
+// Samples are generated on separate threads (one per few workers) into a
+// bounded queue, from which idle workers steal samples queued for busy ones.
+// If `low_priority_after` is specified, a sample which runs for longer than
+// that is finished at reduced priority while its worker moves on to the next
+// sample; each worker has at most one such sample outstanding.
+//
 // Generates samples according to `ast_generator_options`, and runs them
 // according to `sample_options`. Uses a nondeterministic seed if `seed` is not
 // specified. Creates run directories in `top_run_dir` if specified; otherwise
@@ -37,6 +44,21 @@ namespace xls {
 //
 // If `force_failure` is true, every sample run will be considered a failure.
 // This is useful for testing failure paths.
+//
+// If `coverage_guided` is true, samples whose runs cover new IR op/type/width
+// combinations or optimization pass rewrites are kept in a corpus (see
+// CoverageCorpus), and half of the samples are mutations of corpus samples.
+//
+// If `ir_generator_options` is specified, samples are generated directly as
+// IR (see GenerateIrSample) instead of as DSLX from `ast_generator_options`;
+// this cannot be combined with `coverage_guided`.
+//
+// If `archive_dir` is specified, each worker appends the artifacts of its
+// samples to one archive file there (see SampleArchiveWriter). Failing samples
+// are still saved in full to `crasher_dir`.
+//
+// Each worker appends its utilization (see WorkerUtilizationProto) to its file
+// in `summary_dir`.
 absl::Status ParallelGenerateAndRunSamples(
     int64_t worker_count,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -47,7 +69,12 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false,
+    std::optional<absl::Duration> low_priority_after = std::nullopt,
+    bool coverage_guided = false,
+    const std::optional<IrGeneratorOptions>& ir_generator_options =
+        std::nullopt,
+    const std::optional<std::filesystem::path>& archive_dir = std::nullopt);
 
 }  // namespace xls
 
@@ -12,41 +12,80 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/time/time.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/fuzz_coordinator.h"
+#include "xls/fuzzer/fuzz_worker.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/synthesis/credentials.h"
 
+ABSL_FLAG(std::optional<std::string>, archive_path, std::nullopt,
+          "Directory in which each worker appends the artifacts of its samples "
+          "to a single compressed archive file, rather than keeping a "
+          "directory per sample. Extract samples with sample_archive_main.");
 ABSL_FLAG(absl::Duration, duration, absl::InfiniteDuration(),
           "Duration to run the sample generator for.");
 ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
 ABSL_FLAG(std::optional<std::string>, crash_path, std::nullopt,
           "Path at which to place crash data.");
 ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(std::optional<std::string>, coordinator, std::nullopt,
+          "Address of a fuzzing coordinator (see --coordinator_port). If "
+          "given, runs the work units it hands out instead of choosing seeds "
+          "locally, and reports crashers and summaries to it.");
+ABSL_FLAG(std::optional<int64_t>, coordinator_port, std::nullopt,
+          "If given, runs no samples but serves as the coordinator of workers "
+          "started with --coordinator on any number of machines: hands out "
+          "disjoint seeds up to --sample_count samples or for --duration, and "
+          "saves the distinct crashers to --crash_path and the summaries to "
+          "--summary_path.");
+ABSL_FLAG(bool, coverage_guided, false,
+          "Keep a corpus of the samples which cover new IR op/type/width "
+          "combinations or optimization pass rewrites, and mutate samples of "
+          "the corpus instead of generating half of the samples.");
 ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
 ABSL_FLAG(
     bool, force_failure, false,
     "Forces the samples to fail. Can be used to test failure code paths.");
 ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(absl::Duration, low_priority_after, absl::InfiniteDuration(),
+          "Samples which run for longer than this are finished at reduced "
+          "priority, while their worker moves on to the next sample.");
+ABSL_FLAG(bool, ir_samples, false,
+          "Generate the samples directly as IR rather than as DSLX, to "
+          "exercise the optimizer and code generator with IR the DSLX "
+          "frontend does not produce.");
 ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
           "The maximum width of aggregate types (tuples and arrays) in the "
           "generated samples.");
@@ -56,6 +95,9 @@ ABSL_FLAG(int64_t, proc_ticks, 100,
           "Number of ticks to execute the generated procs.");
 ABSL_FLAG(std::optional<int64_t>, sample_count, std::nullopt,
           "Number of samples to generate.");
+ABSL_FLAG(int64_t, samples_per_work_unit, 64,
+          "With --coordinator_port, the number of samples in each unit of work "
+          "handed out to a worker.");
 ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
           "Path of directory in which to save temporary files. These temporary "
           "files include DSLX, IR, and arguments. A separate numerically-named "
@@ -88,17 +130,24 @@ namespace xls {
 namespace {
 
 struct Options {
+  std::optional<std::filesystem::path> archive_path;
   absl::Duration duration;
   int64_t calls_per_sample;
   std::optional<std::filesystem::path> crash_path;
   bool codegen;
+  std::optional<std::string> coordinator;
+  std::optional<int64_t> coordinator_port;
+  bool coverage_guided;
   bool emit_loops;
   bool force_failure;
   bool generate_proc;
+  bool ir_samples;
+  absl::Duration low_priority_after;
   int64_t max_width_aggregate_types;
   int64_t max_width_bits_types;
   int64_t proc_ticks;
   std::optional<int64_t> sample_count;
+  int64_t samples_per_work_unit;
   std::optional<std::filesystem::path> save_temps_path;
   std::optional<int64_t> seed;
   bool simulate;
@@ -124,13 +173,67 @@ absl::Status CheckOrCreateWritableDirectory(const std::filesystem::path& path) {
   return absl::OkStatus();
 }
 
+absl::Status RunCoordinator(const Options& options) {
+  FuzzCoordinatorOptions coordinator_options{
+      .seed = options.seed.has_value()
+                  ? static_cast<uint64_t>(*options.seed)
+                  : absl::Uniform<uint64_t>(absl::BitGen()),
+      .samples_per_work_unit = options.samples_per_work_unit,
+      .sample_count = options.sample_count,
+      .crasher_dir = options.crash_path,
+      .summary_dir = options.summary_path,
+  };
+  if (options.duration != absl::InfiniteDuration()) {
+    coordinator_options.duration = options.duration;
+  }
+  FuzzCoordinator coordinator(std::move(coordinator_options));
+  FuzzCoordinatorServiceImpl service(&coordinator);
+
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(absl::StrCat("0.0.0.0:", *options.coordinator_port),
+                           synthesis::GetServerCredentials());
+  builder.RegisterService(&service);
+  std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  if (server == nullptr) {
+    return absl::UnavailableError(absl::StrCat(
+        "Could not serve on port ", *options.coordinator_port));
+  }
+  LOG(INFO) << "Coordinating on port " << *options.coordinator_port;
+  coordinator.WaitUntilDone();
+  server->Shutdown();
+  LOG(INFO) << coordinator.Report();
+  return absl::OkStatus();
+}
+
+std::string WorkerName() {
+  std::array<char, 256> hostname{};
+  if (gethostname(hostname.data(), hostname.size() - 1) != 0) {
+    return absl::StrCat("localhost-", getpid());
+  }
+  return absl::StrCat(hostname.data(), "-", getpid());
+}
+
 absl::Status RealMain(const Options& options) {
+  if (options.coordinator_port.has_value()) {
+    if (options.crash_path.has_value()) {
+      XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.crash_path));
+    }
+    if (options.summary_path.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          CheckOrCreateWritableDirectory(*options.summary_path));
+    }
+    return RunCoordinator(options);
+  }
+
   if (options.crash_path.has_value()) {
     XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.crash_path));
   }
   if (options.summary_path.has_value()) {
     XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.summary_path));
   }
+  if (options.archive_path.has_value()) {
+    XLS_RETURN_IF_ERROR(CheckOrCreateWritableDirectory(*options.archive_path));
+  }
 
   int64_t worker_count;
   if (options.worker_count.has_value()) {
@@ -147,6 +250,13 @@ absl::Status RealMain(const Options& options) {
       options.max_width_aggregate_types;
   ast_generator_options.generate_proc = options.generate_proc;
 
+  std::optional<IrGeneratorOptions> ir_generator_options;
+  if (options.ir_samples) {
+    ir_generator_options.emplace();
+    ir_generator_options->generate_proc = options.generate_proc;
+    ir_generator_options->max_bit_width = options.max_width_bits_types;
+  }
+
   SampleOptions sample_options;
   sample_options.set_calls_per_sample(
       options.generate_proc ? 0 : options.calls_per_sample);
@@ -169,11 +279,36 @@ absl::Status RealMain(const Options& options) {
   sample_options.set_use_jit(options.use_llvm_jit);
   sample_options.set_use_system_verilog(options.use_system_verilog);
 
+  if (options.coordinator.has_value()) {
+    if (options.coverage_guided) {
+      return absl::InvalidArgumentError(
+          "--coverage_guided cannot be combined with --coordinator");
+    }
+    return RunFuzzWorker(
+        *options.coordinator,
+        FuzzWorkerOptions{
+            .name = WorkerName(),
+            .worker_count = worker_count,
+            .ast_generator_options = ast_generator_options,
+            .sample_options = sample_options,
+            .ir_generator_options = ir_generator_options,
+            .force_failure = options.force_failure,
+            .low_priority_after =
+                options.low_priority_after == absl::InfiniteDuration()
+                    ? std::nullopt
+                    : std::make_optional(options.low_priority_after),
+        });
+  }
+
   return ParallelGenerateAndRunSamples(
       worker_count, ast_generator_options, sample_options, options.seed,
       /*top_run_dir=*/options.save_temps_path,
       /*crasher_dir=*/options.crash_path, /*summary_dir=*/options.summary_path,
-      options.sample_count, options.duration, options.force_failure);
+      options.sample_count, options.duration, options.force_failure,
+      options.low_priority_after == absl::InfiniteDuration()
+          ? std::nullopt
+          : std::make_optional(options.low_priority_after),
+      options.coverage_guided, ir_generator_options, options.archive_path);
 }
 
 }  // namespace
@@ -193,20 +328,31 @@ int main(int argc, char** argv) {
   if (absl::GetFlag(FLAGS_simulate) && !absl::GetFlag(FLAGS_codegen)) {
     LOG(QFATAL) << "Must specify --codegen when --simulate is given.";
   }
+  if (absl::GetFlag(FLAGS_coordinator).has_value() &&
+      absl::GetFlag(FLAGS_coordinator_port).has_value()) {
+    LOG(QFATAL) << "--coordinator and --coordinator_port are exclusive.";
+  }
 
   return xls::ExitStatus(xls::RealMain({
+      .archive_path = absl::GetFlag(FLAGS_archive_path),
       .duration = absl::GetFlag(FLAGS_duration),
       .calls_per_sample = absl::GetFlag(FLAGS_calls_per_sample),
       .crash_path = absl::GetFlag(FLAGS_crash_path),
       .codegen = absl::GetFlag(FLAGS_codegen),
+      .coordinator = absl::GetFlag(FLAGS_coordinator),
+      .coordinator_port = absl::GetFlag(FLAGS_coordinator_port),
+      .coverage_guided = absl::GetFlag(FLAGS_coverage_guided),
       .emit_loops = absl::GetFlag(FLAGS_emit_loops),
       .force_failure = absl::GetFlag(FLAGS_force_failure),
       .generate_proc = absl::GetFlag(FLAGS_generate_proc),
+      .ir_samples = absl::GetFlag(FLAGS_ir_samples),
+      .low_priority_after = absl::GetFlag(FLAGS_low_priority_after),
       .max_width_aggregate_types =
           absl::GetFlag(FLAGS_max_width_aggregate_types),
       .max_width_bits_types = absl::GetFlag(FLAGS_max_width_bits_types),
       .proc_ticks = absl::GetFlag(FLAGS_proc_ticks),
       .sample_count = absl::GetFlag(FLAGS_sample_count),
+      .samples_per_work_unit = absl::GetFlag(FLAGS_samples_per_work_unit),
       .save_temps_path = absl::GetFlag(FLAGS_save_temps_path),
       .seed = absl::GetFlag(FLAGS_seed),
       .simulate = absl::GetFlag(FLAGS_simulate),
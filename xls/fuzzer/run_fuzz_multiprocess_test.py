@@ -23,6 +23,7 @@ from xls.common import test_base
 RUN_FUZZ_MULTIPROCESS_PATH = runfiles.get_path(
     'xls/fuzzer/run_fuzz_multiprocess'
 )
+SAMPLE_ARCHIVE_MAIN_PATH = runfiles.get_path('xls/fuzzer/sample_archive_main')
 
 
 class RunFuzzMultiprocessTest(test_base.TestCase):
@@ -110,6 +111,107 @@ class RunFuzzMultiprocessTest(test_base.TestCase):
     # Crasher directory should have 5 samples in it plus the `test` file.
     self.assertEqual(len(os.listdir(crasher_path)), 6)
 
+  def test_ir_samples(self):
+    crasher_path = self.create_tempdir().full_path
+    samples_path = self.create_tempdir().full_path
+
+    subprocess.check_call([
+        RUN_FUZZ_MULTIPROCESS_PATH,
+        '--seed=42',
+        '--crash_path=' + crasher_path,
+        '--save_temps_path=' + samples_path,
+        '--sample_count=10',
+        '--calls_per_sample=3',
+        '--worker_count=2',
+        '--ir_samples',
+    ])
+
+    # The samples are IR, so there is no DSLX to convert.
+    sample_dirs = os.listdir(samples_path)
+    self.assertEqual(len(sample_dirs), 10)
+    for d in sample_dirs:
+      with open(os.path.join(samples_path, d, 'options.pbtxt')) as f:
+        self.assertIn('input_is_dslx: false', f.read())
+      self.assertIn('sample.ir', os.listdir(os.path.join(samples_path, d)))
+
+    # No crashers were found.
+    self.assertSequenceEqual(os.listdir(crasher_path), ('test',))
+
+  def test_archive(self):
+    crasher_path = self.create_tempdir().full_path
+    archive_path = self.create_tempdir().full_path
+
+    subprocess.check_call([
+        RUN_FUZZ_MULTIPROCESS_PATH,
+        '--seed=42',
+        '--crash_path=' + crasher_path,
+        '--archive_path=' + archive_path,
+        '--sample_count=6',
+        '--calls_per_sample=3',
+        '--worker_count=2',
+    ])
+
+    # Each worker appends its samples to a single archive.
+    archives = sorted(f for f in os.listdir(archive_path) if f != 'test')
+    self.assertSequenceEqual(
+        archives, ['samples_0.archive', 'samples_1.archive']
+    )
+    listed = []
+    for archive in archives:
+      listed.extend(
+          subprocess.check_output([
+              SAMPLE_ARCHIVE_MAIN_PATH,
+              os.path.join(archive_path, archive),
+          ])
+          .decode('utf-8')
+          .splitlines()
+      )
+    self.assertLen(listed, 6)
+    for line in listed:
+      self.assertIn('passed', line)
+
+    # The archived samples can be extracted and rerun as crashers.
+    extract_path = self.create_tempdir().full_path
+    subprocess.check_call([
+        SAMPLE_ARCHIVE_MAIN_PATH,
+        os.path.join(archive_path, archives[0]),
+        '--extract_dir=' + extract_path,
+    ])
+    for d in os.listdir(extract_path):
+      files = os.listdir(os.path.join(extract_path, d))
+      self.assertIn('crasher.x', files)
+      self.assertIn('sample.ir', files)
+
+    # No crashers were found.
+    self.assertSequenceEqual(os.listdir(crasher_path), ('test',))
+
+  def test_coverage_guided(self):
+    crasher_path = self.create_tempdir().full_path
+    samples_path = self.create_tempdir().full_path
+
+    subprocess.check_call([
+        RUN_FUZZ_MULTIPROCESS_PATH,
+        '--seed=42',
+        '--crash_path=' + crasher_path,
+        '--save_temps_path=' + samples_path,
+        '--sample_count=10',
+        '--calls_per_sample=3',
+        '--worker_count=2',
+        '--coverage_guided',
+    ])
+
+    # Every run records the pass profile used for its coverage features.
+    sample_dirs = os.listdir(samples_path)
+    self.assertEqual(len(sample_dirs), 10)
+    for d in sample_dirs:
+      self.assertIn(
+          'sample.opt.pass_profile.textproto',
+          os.listdir(os.path.join(samples_path, d)),
+      )
+
+    # No crashers were found.
+    self.assertSequenceEqual(os.listdir(crasher_path), ('test',))
+
   def test_duration(self):
     samples_path = self.create_tempdir().full_path
     crasher_path = self.create_tempdir().full_path
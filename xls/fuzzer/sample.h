@@ -95,6 +95,11 @@ class SampleOptions {
   bool optimize_ir() const { return proto_.optimize_ir(); }
   void set_optimize_ir(bool value) { proto_.set_optimize_ir(value); }
 
+  bool record_pass_profile() const { return proto_.record_pass_profile(); }
+  void set_record_pass_profile(bool value) {
+    proto_.set_record_pass_profile(value);
+  }
+
   bool use_jit() const { return proto_.use_jit(); }
   void set_use_jit(bool value) { proto_.set_use_jit(value); }
 
@@ -119,6 +124,22 @@ class SampleOptions {
     }
   }
 
+  std::vector<std::vector<std::string>> codegen_variants() const {
+    std::vector<std::vector<std::string>> variants;
+    variants.reserve(proto_.codegen_variants_size());
+    for (const fuzzer::CodegenArgsProto& variant : proto_.codegen_variants()) {
+      variants.emplace_back(variant.codegen_args().begin(),
+                            variant.codegen_args().end());
+    }
+    return variants;
+  }
+  void add_codegen_variant(absl::Span<const std::string> args) {
+    fuzzer::CodegenArgsProto* variant = proto_.add_codegen_variants();
+    for (const std::string& arg : args) {
+      variant->add_codegen_args(arg);
+    }
+  }
+
   bool use_system_verilog() const { return proto_.use_system_verilog(); }
   void set_use_system_verilog(bool value) {
     proto_.set_use_system_verilog(value);
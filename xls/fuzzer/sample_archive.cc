@@ -0,0 +1,174 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_archive.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_archive.pb.h"
+#include "zlib.h"
+
+namespace xls {
+namespace {
+
+// Each record starts with the compressed and uncompressed sizes of its entry.
+constexpr int64_t kSizeBytes = 8;
+constexpr int64_t kHeaderBytes = 2 * kSizeBytes;
+
+void AppendSize(uint64_t size, std::string& out) {
+  for (int64_t i = 0; i < kSizeBytes; ++i) {
+    out.push_back(static_cast<char>((size >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t ReadSize(std::string_view bytes) {
+  uint64_t size = 0;
+  for (int64_t i = 0; i < kSizeBytes; ++i) {
+    size |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+  }
+  return size;
+}
+
+// Returns `entry` serialized and compressed as an archive record.
+absl::StatusOr<std::string> ToRecord(
+    const fuzzer::SampleArchiveEntryProto& entry) {
+  std::string serialized = entry.SerializeAsString();
+  uLongf compressed_size = compressBound(serialized.size());
+  std::string record(kHeaderBytes + compressed_size, '\0');
+  // Favor speed over size; the archive only has to be cheaper than the files
+  // it replaces.
+  int result = compress2(
+      reinterpret_cast<Bytef*>(record.data() + kHeaderBytes), &compressed_size,
+      reinterpret_cast<const Bytef*>(serialized.data()), serialized.size(),
+      Z_BEST_SPEED);
+  if (result != Z_OK) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to compress sample archive entry: %d", result));
+  }
+  record.resize(kHeaderBytes + compressed_size);
+  std::string header;
+  AppendSize(compressed_size, header);
+  AppendSize(serialized.size(), header);
+  record.replace(0, kHeaderBytes, header);
+  return record;
+}
+
+}  // namespace
+
+absl::Status SampleArchiveWriter::Append(std::string_view name,
+                                         const Sample& sample,
+                                         const absl::Status& run_status,
+                                         const std::filesystem::path& run_dir) {
+  fuzzer::SampleArchiveEntryProto entry;
+  entry.set_name(name);
+  entry.set_sample(sample.Serialize());
+  if (!run_status.ok()) {
+    entry.set_error(run_status.ToString());
+  }
+
+  std::vector<std::filesystem::path> files;
+  std::error_code ec;
+  for (const std::filesystem::directory_entry& file :
+       std::filesystem::recursive_directory_iterator(run_dir, ec)) {
+    if (file.is_regular_file()) {
+      files.push_back(file.path());
+    }
+  }
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to list the run directory %s: %s",
+                        run_dir.string(), ec.message()));
+  }
+  std::sort(files.begin(), files.end());
+  for (const std::filesystem::path& file : files) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(file));
+    fuzzer::SampleArtifactProto* artifact = entry.add_artifacts();
+    artifact->set_path(std::filesystem::relative(file, run_dir).string());
+    artifact->set_contents(std::move(contents));
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string record, ToRecord(entry));
+  absl::MutexLock lock(&mu_);
+  return AppendStringToFile(path_, record);
+}
+
+absl::StatusOr<std::vector<fuzzer::SampleArchiveEntryProto>>
+ReadSampleArchive(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string archive, GetFileContents(path));
+  std::string_view remaining = archive;
+  std::vector<fuzzer::SampleArchiveEntryProto> entries;
+  while (!remaining.empty()) {
+    if (remaining.size() < kHeaderBytes ||
+        remaining.size() - kHeaderBytes < ReadSize(remaining)) {
+      LOG(WARNING) << "Skipping the truncated last record of sample archive "
+                   << path;
+      break;
+    }
+    uint64_t compressed_size = ReadSize(remaining);
+    uLongf uncompressed_size = ReadSize(remaining.substr(kSizeBytes));
+    std::string serialized(uncompressed_size, '\0');
+    int result = uncompress(
+        reinterpret_cast<Bytef*>(serialized.data()), &uncompressed_size,
+        reinterpret_cast<const Bytef*>(remaining.data() + kHeaderBytes),
+        compressed_size);
+    fuzzer::SampleArchiveEntryProto entry;
+    if (result != Z_OK || uncompressed_size != serialized.size() ||
+        !entry.ParseFromString(serialized)) {
+      return absl::DataLossError(
+          absl::StrFormat("Corrupt record %d in sample archive %s",
+                          entries.size(), path.string()));
+    }
+    entries.push_back(std::move(entry));
+    remaining.remove_prefix(kHeaderBytes + compressed_size);
+  }
+  return entries;
+}
+
+absl::Status ExtractSampleArchiveEntry(
+    const fuzzer::SampleArchiveEntryProto& entry,
+    const std::filesystem::path& dir) {
+  for (const fuzzer::SampleArtifactProto& artifact : entry.artifacts()) {
+    std::filesystem::path path = dir / artifact.path();
+    XLS_RET_CHECK(!path.lexically_relative(dir).empty() &&
+                  *path.lexically_relative(dir).begin() != "..")
+        << "Artifact path escapes the extraction directory: "
+        << artifact.path();
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, artifact.contents()));
+  }
+  XLS_ASSIGN_OR_RETURN(Sample sample, Sample::Deserialize(entry.sample()));
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(dir));
+  return SetFileContents(dir / "crasher.x", entry.error().empty()
+                                                ? sample.Serialize()
+                                                : sample.ToCrasher(
+                                                      entry.error()));
+}
+
+}  // namespace xls
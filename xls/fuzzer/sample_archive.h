@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_ARCHIVE_H_
+#define XLS_FUZZER_SAMPLE_ARCHIVE_H_
+
+#include <filesystem>  // NOLINT
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_archive.pb.h"
+
+namespace xls {
+
+// A sample archive batches the artifacts of many sample runs into a single
+// append-only file, in place of one directory per sample. Each record of the
+// archive is a SampleArchiveEntryProto compressed with zlib, preceded by its
+// compressed and uncompressed sizes as 64-bit little-endian integers. Records
+// are complete once appended, so a writer which is interrupted loses at most
+// its last record.
+
+// Appends the runs of samples to a sample archive. Thread-safe.
+class SampleArchiveWriter {
+ public:
+  explicit SampleArchiveWriter(std::filesystem::path path)
+      : path_(std::move(path)) {}
+
+  // Appends a record named `name` for the run of `sample` with result
+  // `run_status`, holding every file under `run_dir`.
+  absl::Status Append(std::string_view name, const Sample& sample,
+                      const absl::Status& run_status,
+                      const std::filesystem::path& run_dir)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  const std::filesystem::path& path() const { return path_; }
+
+ private:
+  const std::filesystem::path path_;
+  absl::Mutex mu_;
+};
+
+// Returns the entries of the sample archive at `path` in the order they were
+// appended. A truncated last record, as left by an interrupted writer, is
+// skipped.
+absl::StatusOr<std::vector<fuzzer::SampleArchiveEntryProto>>
+ReadSampleArchive(const std::filesystem::path& path);
+
+// Writes the artifacts of `entry` to `dir`, along with the sample as
+// `crasher.x` so that it can be rerun with run_crasher.
+absl::Status ExtractSampleArchiveEntry(
+    const fuzzer::SampleArchiveEntryProto& entry,
+    const std::filesystem::path& dir);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_ARCHIVE_H_
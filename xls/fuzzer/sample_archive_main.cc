@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Lists or extracts the samples of a fuzzer sample archive.
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample_archive.h"
+#include "xls/fuzzer/sample_archive.pb.h"
+
+ABSL_FLAG(std::optional<std::string>, extract_dir, std::nullopt,
+          "Directory in which to extract the samples, one subdirectory per "
+          "sample. Each subdirectory holds the artifacts of the sample run "
+          "and a crasher.x file which can be rerun with run_crasher. If not "
+          "specified, the samples are listed.");
+ABSL_FLAG(bool, failed_only, false, "Only list or extract failed samples.");
+ABSL_FLAG(std::optional<std::string>, sample, std::nullopt,
+          "Only list or extract the sample with this name.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(const std::filesystem::path& archive_path,
+                      const std::optional<std::filesystem::path>& extract_dir,
+                      bool failed_only,
+                      const std::optional<std::string>& sample) {
+  XLS_ASSIGN_OR_RETURN(std::vector<fuzzer::SampleArchiveEntryProto> entries,
+                       ReadSampleArchive(archive_path));
+  for (const fuzzer::SampleArchiveEntryProto& entry : entries) {
+    if ((failed_only && entry.error().empty()) ||
+        (sample.has_value() && entry.name() != *sample)) {
+      continue;
+    }
+    if (extract_dir.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          ExtractSampleArchiveEntry(entry, *extract_dir / entry.name()));
+      continue;
+    }
+    int64_t bytes = 0;
+    for (const fuzzer::SampleArtifactProto& artifact : entry.artifacts()) {
+      bytes += artifact.contents().size();
+    }
+    std::cout << absl::StreamFormat(
+        "%s: %d artifacts, %d bytes, %s\n", entry.name(),
+        entry.artifacts_size(), bytes,
+        entry.error().empty() ? "passed" : "failed: " + entry.error());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  const std::string usage = absl::StrCat(
+      "Invalid command-line arguments; want ", argv[0], " <archive path>");
+
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(usage, argc, argv);
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << usage;
+    return EXIT_FAILURE;
+  }
+
+  std::optional<std::filesystem::path> extract_dir;
+  if (absl::GetFlag(FLAGS_extract_dir).has_value()) {
+    extract_dir = *absl::GetFlag(FLAGS_extract_dir);
+  }
+  return xls::ExitStatus(xls::RealMain(
+      /*archive_path=*/positional_arguments[0], extract_dir,
+      absl::GetFlag(FLAGS_failed_only), absl::GetFlag(FLAGS_sample)));
+}
@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_archive.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_archive.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+class SampleArchiveTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    run_dir_ = temp_dir_->path() / "run";
+    XLS_ASSERT_OK(RecursivelyCreateDir(run_dir_ / "sub"));
+    XLS_ASSERT_OK(SetFileContents(run_dir_ / "sample.x", kDslx));
+    XLS_ASSERT_OK(SetFileContents(run_dir_ / "sub" / "out.txt", "output"));
+  }
+
+  static constexpr char kDslx[] = "fn main(x: u32) -> u32 { x }";
+
+  Sample MakeSample() const {
+    return Sample(kDslx, SampleOptions(), {{dslx::InterpValue::MakeU32(42)}});
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+  std::filesystem::path run_dir_;
+};
+
+TEST_F(SampleArchiveTest, AppendAndRead) {
+  SampleArchiveWriter writer(temp_dir_->path() / "samples.archive");
+  XLS_ASSERT_OK(
+      writer.Append("passed", MakeSample(), absl::OkStatus(), run_dir_));
+  XLS_ASSERT_OK(writer.Append("failed", MakeSample(),
+                              absl::InternalError("boom"), run_dir_));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<fuzzer::SampleArchiveEntryProto> entries,
+                           ReadSampleArchive(writer.path()));
+  ASSERT_THAT(entries, SizeIs(2));
+  EXPECT_EQ(entries[0].name(), "passed");
+  EXPECT_THAT(entries[0].error(), IsEmpty());
+  EXPECT_EQ(entries[1].name(), "failed");
+  EXPECT_THAT(entries[1].error(), HasSubstr("boom"));
+
+  ASSERT_THAT(entries[0].artifacts(), SizeIs(2));
+  EXPECT_EQ(entries[0].artifacts(0).path(), "sample.x");
+  EXPECT_EQ(entries[0].artifacts(0).contents(), kDslx);
+  EXPECT_EQ(entries[0].artifacts(1).path(), "sub/out.txt");
+  EXPECT_EQ(entries[0].artifacts(1).contents(), "output");
+  EXPECT_THAT(Sample::Deserialize(entries[0].sample()),
+              IsOkAndHolds(MakeSample()));
+}
+
+TEST_F(SampleArchiveTest, SkipsTruncatedLastRecord) {
+  SampleArchiveWriter writer(temp_dir_->path() / "samples.archive");
+  XLS_ASSERT_OK(writer.Append("a", MakeSample(), absl::OkStatus(), run_dir_));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string archive, GetFileContents(writer.path()));
+  XLS_ASSERT_OK(writer.Append("b", MakeSample(), absl::OkStatus(), run_dir_));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string full_archive,
+                           GetFileContents(writer.path()));
+
+  // Drop the end of the second record, as an interrupted writer would.
+  for (int64_t cut : {1, 10, 20}) {
+    XLS_ASSERT_OK(SetFileContents(
+        writer.path(), full_archive.substr(0, full_archive.size() - cut)));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<fuzzer::SampleArchiveEntryProto> entries,
+        ReadSampleArchive(writer.path()));
+    ASSERT_THAT(entries, SizeIs(1));
+    EXPECT_EQ(entries[0].name(), "a");
+  }
+  XLS_ASSERT_OK(SetFileContents(writer.path(), archive + "0123"));
+  EXPECT_THAT(ReadSampleArchive(writer.path()), IsOkAndHolds(SizeIs(1)));
+}
+
+TEST_F(SampleArchiveTest, CorruptRecord) {
+  SampleArchiveWriter writer(temp_dir_->path() / "samples.archive");
+  XLS_ASSERT_OK(writer.Append("a", MakeSample(), absl::OkStatus(), run_dir_));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string archive, GetFileContents(writer.path()));
+  archive[archive.size() / 2] ^= 0xff;
+  archive[archive.size() / 2 + 1] ^= 0xff;
+  XLS_ASSERT_OK(SetFileContents(writer.path(), archive));
+  EXPECT_THAT(ReadSampleArchive(writer.path()),
+              StatusIs(absl::StatusCode::kDataLoss, HasSubstr("Corrupt")));
+}
+
+TEST_F(SampleArchiveTest, Extract) {
+  SampleArchiveWriter writer(temp_dir_->path() / "samples.archive");
+  XLS_ASSERT_OK(writer.Append("failed", MakeSample(),
+                              absl::InternalError("boom"), run_dir_));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<fuzzer::SampleArchiveEntryProto> entries,
+                           ReadSampleArchive(writer.path()));
+  ASSERT_THAT(entries, SizeIs(1));
+
+  std::filesystem::path extract_dir = temp_dir_->path() / "extracted";
+  XLS_ASSERT_OK(ExtractSampleArchiveEntry(entries[0], extract_dir));
+  EXPECT_THAT(GetFileContents(extract_dir / "sample.x"), IsOkAndHolds(kDslx));
+  EXPECT_THAT(GetFileContents(extract_dir / "sub" / "out.txt"),
+              IsOkAndHolds("output"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string crasher,
+                           GetFileContents(extract_dir / "crasher.x"));
+  EXPECT_THAT(crasher, HasSubstr("boom"));
+  EXPECT_THAT(Sample::Deserialize(crasher), IsOkAndHolds(MakeSample()));
+
+  fuzzer::SampleArchiveEntryProto escaping = entries[0];
+  escaping.mutable_artifacts(0)->set_path("../escaped.txt");
+  EXPECT_THAT(ExtractSampleArchiveEntry(escaping, extract_dir),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("escapes")));
+  EXPECT_FALSE(std::filesystem::exists(temp_dir_->path() / "escaped.txt"));
+}
+
+}  // namespace
+}  // namespace xls
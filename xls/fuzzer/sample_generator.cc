@@ -47,15 +47,25 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/dslx/interp_value_utils.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/unwrap_meta_type.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/dslx_mutator.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
 #include "xls/fuzzer/value_generator.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
 
 namespace xls {
 namespace {
@@ -428,4 +438,119 @@ absl::StatusOr<Sample> GenerateSample(
                                 sample_options_copy, bit_gen, dslx_text);
 }
 
+absl::StatusOr<Sample> GenerateMutatedSample(const Sample& parent,
+                                             absl::BitGenRef bit_gen,
+                                             int64_t max_attempts) {
+  constexpr std::string_view top_name = "main";
+  XLS_RET_CHECK(parent.options().input_is_dslx());
+  dslx::FileTable file_table;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> parent_module,
+                       ParseModule(parent.input_text(), "sample.x", "sample",
+                                   file_table));
+  const std::string parent_text = parent_module->ToString();
+  XLS_ASSIGN_OR_RETURN(bool parent_has_nb_recv,
+                       HasNonBlockingRecv(parent.input_text(), file_table));
+
+  for (int64_t attempt = 0; attempt < max_attempts; ++attempt) {
+    XLS_ASSIGN_OR_RETURN(std::string dslx_text,
+                         dslx::RemoveDslxToken(parent.input_text(), bit_gen));
+    ImportData import_data(
+        dslx::CreateImportData(/*stdlib_path=*/"",
+                               /*additional_search_paths=*/{},
+                               /*enabled_warnings=*/dslx::kAllWarningsSet));
+    absl::StatusOr<TypecheckedModule> tm =
+        ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data);
+    if (!tm.ok() || tm->module->ToString() == parent_text) {
+      // Most removals break the program, and removing whitespace or a
+      // comment leaves it unchanged.
+      continue;
+    }
+    std::optional<ModuleMember*> member =
+        tm->module->FindMemberWithName(top_name);
+    if (!member.has_value()) {
+      continue;
+    }
+    absl::StatusOr<bool> has_nb_recv =
+        HasNonBlockingRecv(dslx_text, file_table);
+    if (!has_nb_recv.ok() || *has_nb_recv != parent_has_nb_recv) {
+      continue;
+    }
+    if (parent.options().IsProcSample()) {
+      if (!std::holds_alternative<dslx::Proc*>(**member)) {
+        continue;
+      }
+      return GenerateProcSample(std::get<dslx::Proc*>(**member), *tm,
+                                parent.options(), bit_gen, dslx_text);
+    }
+    if (!std::holds_alternative<dslx::Function*>(**member)) {
+      continue;
+    }
+    return GenerateFunctionSample(std::get<dslx::Function*>(**member), *tm,
+                                  parent.options(), bit_gen, dslx_text);
+  }
+  return absl::NotFoundError(absl::StrFormat(
+      "No usable mutation of the sample found in %d attempts", max_attempts));
+}
+
+absl::StatusOr<Sample> GenerateIrSample(
+    const IrGeneratorOptions& generator_options,
+    const SampleOptions& sample_options, absl::BitGenRef bit_gen) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       GenerateIrPackage(generator_options, bit_gen));
+  std::optional<FunctionBase*> top_or = package->GetTop();
+  XLS_RET_CHECK(top_or.has_value());
+  FunctionBase* top = *top_or;
+
+  SampleOptions sample_options_copy = sample_options;
+  // The generated sample is IR so there is nothing to convert.
+  sample_options_copy.set_input_is_dslx(false);
+  sample_options_copy.set_convert_to_ir(false);
+  XLS_RET_CHECK(sample_options_copy.codegen_args().empty())
+      << "Setting codegen arguments is not supported, they are randomly "
+         "generated";
+  if (sample_options_copy.codegen()) {
+    bool has_registers =
+        top->IsProc() && top->AsProcOrDie()->GetStateElementCount() > 0;
+    sample_options_copy.set_codegen_args(GenerateCodegenArgs(
+        sample_options_copy.use_system_verilog(), top->IsProc(), has_registers,
+        /*min_stages=*/1, /*has_nb_recv=*/false, bit_gen));
+  }
+
+  // The arguments of a function, or the values on the input channels of a
+  // proc for each tick.
+  std::vector<::xls::Type*> arg_types;
+  std::vector<std::string> ir_channel_names;
+  int64_t arg_set_count;
+  if (top->IsProc()) {
+    CHECK_EQ(sample_options.calls_per_sample(), 0)
+        << "calls per sample must be zero when generating a proc sample.";
+    sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_PROC);
+    for (Channel* channel : package->channels()) {
+      if (channel->CanReceive()) {
+        arg_types.push_back(channel->type());
+        ir_channel_names.push_back(std::string(channel->name()));
+      }
+    }
+    arg_set_count = sample_options.proc_ticks();
+  } else {
+    CHECK_EQ(sample_options.proc_ticks(), 0)
+        << "proc ticks must be zero when generating a function sample.";
+    sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
+    for (Param* param : top->params()) {
+      arg_types.push_back(param->GetType());
+    }
+    arg_set_count = sample_options.calls_per_sample();
+  }
+  std::vector<std::vector<InterpValue>> args_batch(arg_set_count);
+  for (std::vector<InterpValue>& args : args_batch) {
+    for (::xls::Type* type : arg_types) {
+      XLS_ASSIGN_OR_RETURN(
+          args.emplace_back(),
+          dslx::ValueToInterpValue(RandomValue(type, bit_gen)));
+    }
+  }
+  return Sample(package->DumpIr(), sample_options_copy, std::move(args_batch),
+                std::move(ir_channel_names));
+}
+
 }  // namespace xls
@@ -15,10 +15,13 @@
 #ifndef XLS_FUZZER_SAMPLE_GENERATOR_H_
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
+#include <cstdint>
+
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/statusor.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/sample.h"
 
 namespace xls {
@@ -29,6 +32,24 @@ absl::StatusOr<Sample> GenerateSample(
     const SampleOptions& sample_options, absl::BitGenRef bit_gen,
     dslx::FileTable& file_table);
 
+// Returns a sample derived from the DSLX sample `parent` by removing a random
+// token of its program (see RemoveDslxToken), with newly generated arguments.
+// The sample options, including any codegen arguments, are those of `parent`.
+// Mutations which do not change the program, fail to type check, or change
+// the kind of the top entity or whether it has a non-blocking receive are
+// retried; returns a NotFoundError if none of `max_attempts` mutations is
+// usable.
+absl::StatusOr<Sample> GenerateMutatedSample(const Sample& parent,
+                                             absl::BitGenRef bit_gen,
+                                             int64_t max_attempts = 64);
+
+// Generates and returns a random IR sample (see GenerateIrPackage) with the
+// given options, skipping DSLX generation and conversion. Samples run from the
+// IR stage of the SampleRunner on.
+absl::StatusOr<Sample> GenerateIrSample(
+    const IrGeneratorOptions& generator_options,
+    const SampleOptions& sample_options, absl::BitGenRef bit_gen);
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_SAMPLE_GENERATOR_H_
@@ -17,17 +17,21 @@
 #include <cstdint>
 #include <memory>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample.pb.h"
 #include "xls/fuzzer/value_generator.h"
 
 namespace xls {
@@ -35,6 +39,7 @@ namespace {
 
 using ::testing::HasSubstr;
 using ::xls::status_testing::IsOkAndHolds;
+using ::xls::status_testing::StatusIs;
 
 TEST(SampleGeneratorTest, GenerateBasicSample) {
   dslx::FileTable file_table;
@@ -73,6 +78,35 @@ TEST(SampleGeneratorTest, GenerateCodegenSample) {
   EXPECT_TRUE(sample.args_batch().empty());
 }
 
+TEST(SampleGeneratorTest, GenerateMutatedSample) {
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  sample_options.set_calls_per_sample(2);
+  sample_options.set_codegen(true);
+  sample_options.set_codegen_args(
+      std::vector<std::string>{"--generator=combinational"});
+  Sample parent(
+      "fn main(x: u32, y: u32) -> u32 {\n  let z = x + y;\n  !z\n}\n",
+      sample_options, {});
+  XLS_ASSERT_OK_AND_ASSIGN(Sample mutated,
+                           GenerateMutatedSample(parent, rng,
+                                                 /*max_attempts=*/1000));
+  EXPECT_NE(mutated.input_text(), parent.input_text());
+  EXPECT_THAT(mutated.input_text(), HasSubstr("fn main"));
+  EXPECT_EQ(mutated.options(), parent.options());
+  EXPECT_EQ(mutated.args_batch().size(), 2);
+}
+
+TEST(SampleGeneratorTest, GenerateMutatedSampleGivesUp) {
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  // Removing any token of this program either breaks it or leaves it
+  // unchanged.
+  Sample parent("fn main() {}", sample_options, {});
+  EXPECT_THAT(GenerateMutatedSample(parent, rng, /*max_attempts=*/16),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 TEST(SampleGeneratorTest, GenerateChannelArgument) {
   std::mt19937_64 rng;
   std::vector<std::unique_ptr<dslx::Type>> param_types;
@@ -115,5 +149,42 @@ TEST(SampleGeneratorTest, GenerateBasicProcSample) {
   EXPECT_THAT(sample.input_text(), HasSubstr("proc main"));
 }
 
+TEST(SampleGeneratorTest, GenerateIrFunctionSample) {
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  sample_options.set_calls_per_sample(3);
+  sample_options.set_codegen(true);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Sample sample,
+      GenerateIrSample(IrGeneratorOptions{}, sample_options, rng));
+  EXPECT_FALSE(sample.options().input_is_dslx());
+  EXPECT_FALSE(sample.options().convert_to_ir());
+  EXPECT_TRUE(sample.options().optimize_ir());
+  EXPECT_EQ(sample.options().sample_type(), fuzzer::SAMPLE_TYPE_FUNCTION);
+  EXPECT_FALSE(sample.options().codegen_args().empty());
+  EXPECT_EQ(sample.args_batch().size(), 3);
+  EXPECT_THAT(sample.input_text(), HasSubstr("top fn main"));
+}
+
+TEST(SampleGeneratorTest, GenerateIrProcSample) {
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  sample_options.set_calls_per_sample(0);
+  sample_options.set_proc_ticks(5);
+  IrGeneratorOptions generator_options;
+  generator_options.generate_proc = true;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Sample sample,
+      GenerateIrSample(generator_options, sample_options, rng));
+  EXPECT_FALSE(sample.options().input_is_dslx());
+  EXPECT_EQ(sample.options().sample_type(), fuzzer::SAMPLE_TYPE_PROC);
+  EXPECT_THAT(sample.input_text(), HasSubstr("top proc main"));
+  ASSERT_EQ(sample.args_batch().size(), 5);
+  EXPECT_FALSE(sample.ir_channel_names().empty());
+  for (const std::vector<dslx::InterpValue>& values : sample.args_batch()) {
+    EXPECT_EQ(values.size(), sample.ir_channel_names().size());
+  }
+}
+
 }  // namespace
 }  // namespace xls
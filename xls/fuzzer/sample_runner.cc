@@ -15,14 +15,17 @@
 #include "xls/fuzzer/sample_runner.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <variant>
 #include <vector>
@@ -41,6 +44,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
@@ -51,6 +55,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
@@ -67,6 +72,7 @@
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/fuzzer/cpp_sample_runner.h"
+#include "xls/fuzzer/in_process_tools.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
 #include "xls/ir/format_preference.h"
@@ -168,18 +174,27 @@ absl::StatusOr<std::vector<dslx::InterpValue>> InterpretDslxFunction(
   return results;
 }
 
-absl::StatusOr<std::string> RunCommandFromExecutable(
-    std::string_view executable_name, std::vector<std::string> args,
-    const std::filesystem::path& run_dir, const SampleOptions& options) {
-  XLS_ASSIGN_OR_RETURN(std::filesystem::path executable,
-                       GetXlsRunfilePath(executable_name));
-  const std::string basename = executable.filename();
+// Returns the stderr regexps of the sample's known failures which apply to the
+// tool with the given basename.
+std::vector<std::shared_ptr<RE2>> KnownFailureFilters(
+    std::string_view basename, const SampleOptions& options) {
   std::vector<std::shared_ptr<RE2>> filters;
   for (const KnownFailure& filter : options.known_failures()) {
     if (filter.tool == nullptr || RE2::FullMatch(basename, *filter.tool)) {
       filters.emplace_back(filter.stderr_regex);
     }
   }
+  return filters;
+}
+
+absl::StatusOr<std::string> RunCommandFromExecutable(
+    std::string_view executable_name, std::vector<std::string> args,
+    const std::filesystem::path& run_dir, const SampleOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path executable,
+                       GetXlsRunfilePath(executable_name));
+  const std::string basename = executable.filename();
+  std::vector<std::shared_ptr<RE2>> filters =
+      KnownFailureFilters(basename, options);
 
   std::vector<std::string> argv = {executable.string()};
   absl::c_move(std::move(args), std::back_inserter(argv));
@@ -254,6 +269,91 @@ SampleRunner::Commands::Callable CallableFromExecutable(
   };
 }
 
+// An in-process implementation of a tool; see in_process_tools.h.
+using InProcessTool = absl::StatusOr<std::string> (*)(
+    const std::vector<std::string>& args, const std::filesystem::path& run_dir);
+
+// Runs `fn` and waits at most the sample's timeout for it to finish. `fn` runs
+// on its own thread, which is detached if the timeout expires and left to
+// finish in the background since it cannot be interrupted. Sets `*timed_out`
+// if that happens.
+absl::StatusOr<std::string> RunWithWatchdog(
+    std::function<absl::StatusOr<std::string>()> fn, std::string_view desc,
+    const SampleOptions& options, bool* timed_out) {
+  *timed_out = false;
+  if (!options.timeout_seconds().has_value()) {
+    return fn();
+  }
+  struct State {
+    absl::Notification done;
+    absl::StatusOr<std::string> result;
+  };
+  auto state = std::make_shared<State>();
+  std::thread([state, fn = std::move(fn)]() {
+    state->result = fn();
+    state->done.Notify();
+  }).detach();
+  if (!state->done.WaitForNotificationWithTimeout(
+          absl::Seconds(*options.timeout_seconds()))) {
+    *timed_out = true;
+    return absl::DeadlineExceededError(
+        absl::StrCat("In-process call timed out after ",
+                     *options.timeout_seconds(), " seconds: ", desc));
+  }
+  return std::move(state->result);
+}
+
+SampleRunner::Commands::Callable CallableFromInProcessTool(
+    std::string_view executable, InProcessTool tool) {
+  // Set once a call has timed out. That call keeps running on its detached
+  // thread, so all later calls run the binary, which is killed on timeout,
+  // rather than leaking another thread each.
+  auto abandoned = std::make_shared<std::atomic<bool>>(false);
+  return [executable, tool, abandoned](
+             const std::vector<std::string>& args,
+             const std::filesystem::path& run_dir,
+             const SampleOptions& options) -> absl::StatusOr<std::string> {
+    const std::string basename = std::filesystem::path(executable).filename();
+    if (abandoned->load()) {
+      return RunCommandFromExecutable(executable, args, run_dir, options);
+    }
+    const std::string desc =
+        absl::StrCat(basename, " ", absl::StrJoin(args, " "));
+    bool timed_out;
+    absl::StatusOr<std::string> result = RunWithWatchdog(
+        [tool, args, run_dir]() { return tool(args, run_dir); }, desc,
+        options, &timed_out);
+    if (timed_out && !abandoned->exchange(true)) {
+      LOG(WARNING) << basename
+                   << " timed out in-process; running it as a subprocess "
+                      "from now on.";
+    }
+    // Unsupported arguments are reported before the tool does any work, and
+    // any other Unimplemented error is reproduced by the binary.
+    if (absl::IsUnimplemented(result.status())) {
+      VLOG(1) << "Running " << basename
+              << " as a subprocess: " << result.status().message();
+      return RunCommandFromExecutable(executable, args, run_dir, options);
+    }
+    if (result.ok() || absl::IsDeadlineExceeded(result.status())) {
+      return result;
+    }
+    std::string error = result.status().ToString();
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir / absl::StrCat(basename, ".stderr"), error));
+    if (absl::c_any_of(KnownFailureFilters(basename, options),
+                       [&](const std::shared_ptr<RE2>& re) {
+                         return RE2::PartialMatch(error, *re);
+                       })) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "%s failed but failure was suppressed due to stderr regexp",
+          basename));
+    }
+    return absl::InternalError(
+        absl::StrFormat("In-process %s failed: %s", desc, error));
+  };
+}
+
 // Runs the given command, returning the command's stdout if successful, and
 // attaching the command's stderr to the resulting status if not.
 absl::StatusOr<std::string> RunCommand(
@@ -380,9 +480,14 @@ absl::StatusOr<std::filesystem::path> OptimizeIr(
     command = CallableFromExecutable(kBinary.ir_opt_main);
   }
 
+  std::vector<std::string> args = {ir_path};
+  if (options.record_pass_profile()) {
+    args.push_back(
+        absl::StrCat("--pass_profile_path=", kPassProfileFileName));
+  }
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir_text,
-      RunCommand("Optimizing IR", *command, {ir_path}, run_dir, options));
+      RunCommand("Optimizing IR", *command, args, run_dir, options));
   VLOG(3) << "Optimized IR:\n" << opt_ir_text;
   std::filesystem::path opt_ir_path = run_dir / "sample.opt.ir";
   XLS_RETURN_IF_ERROR(SetFileContents(opt_ir_path, opt_ir_text));
@@ -815,8 +920,86 @@ SimulateProc(const std::filesystem::path& verilog_path,
   return unordered_channel_values;
 }
 
+// A set of codegen arguments of a sample along with the directory in which
+// Verilog is generated and simulated for it.
+struct CodegenVariant {
+  std::vector<std::string> codegen_args;
+  std::filesystem::path run_dir;
+  // The name under which the simulation results are compared.
+  std::string results_name;
+};
+
+// Returns the codegen variants of the sample: `codegen_args` in `run_dir`
+// followed by each of `codegen_variants` in its own (newly created)
+// subdirectory of `run_dir`, so that concurrently running tools do not clobber
+// each other's outputs.
+absl::StatusOr<std::vector<CodegenVariant>> GetCodegenVariants(
+    const SampleOptions& options, const std::filesystem::path& run_dir) {
+  std::vector<CodegenVariant> variants;
+  variants.push_back(CodegenVariant{.codegen_args = options.codegen_args(),
+                                    .run_dir = run_dir,
+                                    .results_name = "simulated"});
+  std::vector<std::vector<std::string>> extra_variants =
+      options.codegen_variants();
+  for (int64_t i = 0; i < extra_variants.size(); ++i) {
+    std::filesystem::path variant_dir =
+        std::filesystem::absolute(run_dir) /
+        absl::StrCat("codegen_variant_", i + 1);
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(variant_dir));
+    variants.push_back(CodegenVariant{
+        .codegen_args = std::move(extra_variants[i]),
+        .run_dir = variant_dir,
+        .results_name = absl::StrCat("simulated (codegen variant ", i + 1, ")"),
+    });
+  }
+  return variants;
+}
+
+// Calls `fn` on each index in [0, count) on up to `parallelism` threads and
+// returns the first error in index order once all calls are complete.
+absl::Status RunConcurrently(int64_t count, int64_t parallelism,
+                             const std::function<absl::Status(int64_t)>& fn) {
+  std::vector<absl::Status> statuses(count);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < count; i = next_index++) {
+      statuses[i] = fn(i);
+    }
+  };
+  int64_t thread_count = std::min(parallelism, count);
+  if (thread_count <= 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
+SampleRunner::Commands SampleRunner::InProcessCommands() {
+  return Commands{
+      .codegen_main = CallableFromInProcessTool(kBinary.codegen_main,
+                                                CodegenMainInProcess),
+      .eval_ir_main = CallableFromInProcessTool(kBinary.eval_ir_main,
+                                                EvalIrMainInProcess),
+      .ir_converter_main = CallableFromInProcessTool(
+          kBinary.ir_converter_main, IrConverterMainInProcess),
+      .ir_opt_main =
+          CallableFromInProcessTool(kBinary.ir_opt_main, OptMainInProcess),
+  };
+}
+
 absl::Status SampleRunner::Run(const Sample& sample) {
   std::filesystem::path input_path = run_dir_;
   if (sample.options().input_is_dslx()) {
@@ -876,6 +1059,9 @@ absl::Status SampleRunner::RunFromFiles(
           fuzzer::SampleType_Name(options.sample_type()));
       break;
   }
+  if (latency_histograms_ != nullptr) {
+    latency_histograms_->AddSampleTiming(timing_);
+  }
   if (!status.ok()) {
     LOG(ERROR) << "Exception when running sample: " << status.ToString();
     XLS_RETURN_IF_ERROR(
@@ -973,20 +1159,40 @@ absl::Status SampleRunner::RunFunction(
     }
 
     if (options.codegen()) {
-      t.Reset();
-      XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
-                           Codegen(opt_ir_path, options.codegen_args(), options,
-                                   run_dir_, commands_));
-      timing_.set_codegen_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
-
+      XLS_RET_CHECK(!options.simulate() || args_path.has_value());
+      XLS_ASSIGN_OR_RETURN(std::vector<CodegenVariant> variants,
+                           GetCodegenVariants(options, run_dir_));
+      std::vector<std::vector<dslx::InterpValue>> simulated(variants.size());
+      std::vector<absl::Duration> codegen_times(variants.size());
+      std::vector<absl::Duration> simulate_times(variants.size());
+      XLS_RETURN_IF_ERROR(RunConcurrently(
+          variants.size(), codegen_parallelism_,
+          [&](int64_t i) -> absl::Status {
+            const CodegenVariant& variant = variants[i];
+            Stopwatch variant_timer;
+            XLS_ASSIGN_OR_RETURN(
+                std::filesystem::path verilog_path,
+                Codegen(std::filesystem::absolute(opt_ir_path),
+                        variant.codegen_args, options, variant.run_dir,
+                        commands_));
+            codegen_times[i] = variant_timer.GetElapsedTime();
+            if (options.simulate()) {
+              variant_timer.Reset();
+              XLS_ASSIGN_OR_RETURN(
+                  simulated[i],
+                  SimulateFunction(verilog_path, "module_sig.textproto",
+                                   std::filesystem::absolute(*args_path),
+                                   options, variant.run_dir, commands_));
+              simulate_times[i] = variant_timer.GetElapsedTime();
+            }
+            return absl::OkStatus();
+          }));
+      timing_.set_codegen_ns(absl::ToInt64Nanoseconds(codegen_times[0]));
       if (options.simulate()) {
-        XLS_RET_CHECK(args_path.has_value());
-        t.Reset();
-        XLS_ASSIGN_OR_RETURN(
-            results["simulated"],
-            SimulateFunction(verilog_path, "module_sig.textproto", *args_path,
-                             options, run_dir_, commands_));
-        timing_.set_simulate_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+        timing_.set_simulate_ns(absl::ToInt64Nanoseconds(simulate_times[0]));
+        for (int64_t i = 0; i < variants.size(); ++i) {
+          results[variants[i].results_name] = std::move(simulated[i]);
+        }
       }
     }
   }
@@ -1141,25 +1347,50 @@ absl::Status SampleRunner::RunProc(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
 
       if (options.codegen()) {
-        t.Reset();
-        XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
-                             Codegen(*opt_ir_path, options.codegen_args(),
-                                     options, run_dir_, commands_));
-        timing_.set_codegen_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
-
+        std::string output_channel_counts_str;
         if (options.simulate()) {
-          t.Reset();
           XLS_RET_CHECK(reference.has_value());
           absl::flat_hash_map<std::string, int64_t> output_channel_counts =
               GetOutputChannelCounts(*reference);
-          std::string output_channel_counts_str =
+          output_channel_counts_str =
               GetOutputChannelToString(output_channel_counts);
-          XLS_ASSIGN_OR_RETURN(
-              results["simulated"],
-              SimulateProc(verilog_path, "module_sig.textproto",
-                           ir_channel_values_path, output_channel_counts_str,
-                           options, run_dir_, commands_));
-          timing_.set_simulate_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+        }
+        XLS_ASSIGN_OR_RETURN(std::vector<CodegenVariant> variants,
+                             GetCodegenVariants(options, run_dir_));
+        std::vector<absl::flat_hash_map<std::string, std::vector<Value>>>
+            simulated(variants.size());
+        std::vector<absl::Duration> codegen_times(variants.size());
+        std::vector<absl::Duration> simulate_times(variants.size());
+        XLS_RETURN_IF_ERROR(RunConcurrently(
+            variants.size(), codegen_parallelism_,
+            [&](int64_t i) -> absl::Status {
+              const CodegenVariant& variant = variants[i];
+              Stopwatch variant_timer;
+              XLS_ASSIGN_OR_RETURN(
+                  std::filesystem::path verilog_path,
+                  Codegen(std::filesystem::absolute(*opt_ir_path),
+                          variant.codegen_args, options, variant.run_dir,
+                          commands_));
+              codegen_times[i] = variant_timer.GetElapsedTime();
+              if (options.simulate()) {
+                variant_timer.Reset();
+                XLS_ASSIGN_OR_RETURN(
+                    simulated[i],
+                    SimulateProc(
+                        verilog_path, "module_sig.textproto",
+                        std::filesystem::absolute(ir_channel_values_path),
+                        output_channel_counts_str, options, variant.run_dir,
+                        commands_));
+                simulate_times[i] = variant_timer.GetElapsedTime();
+              }
+              return absl::OkStatus();
+            }));
+        timing_.set_codegen_ns(absl::ToInt64Nanoseconds(codegen_times[0]));
+        if (options.simulate()) {
+          timing_.set_simulate_ns(absl::ToInt64Nanoseconds(simulate_times[0]));
+          for (int64_t i = 0; i < variants.size(); ++i) {
+            results[variants[i].results_name] = std::move(simulated[i]);
+          }
         }
       }
     }
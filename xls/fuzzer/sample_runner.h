@@ -15,10 +15,12 @@
 #ifndef XLS_FUZZER_SAMPLE_RUNNER_H_
 #define XLS_FUZZER_SAMPLE_RUNNER_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,9 +28,16 @@
 #include "absl/status/statusor.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/stage_latency_histograms.h"
 
 namespace xls {
 
+// Name of the file in the run directory to which the profile of the
+// optimization passes is written if SampleOptions::record_pass_profile() is
+// set.
+inline constexpr std::string_view kPassProfileFileName =
+    "sample.opt.pass_profile.textproto";
+
 // A class for performing various operations on a code sample.
 
 // Code sample can be in DSLX or IR. The possible operations include:
@@ -60,6 +69,17 @@ class SampleRunner {
     std::optional<Callable> simulate_module_main;
   };
 
+  // Returns commands which run the IR converter, optimizer, IR evaluator and
+  // code generator within this process (see in_process_tools.h) rather than
+  // as subprocesses, which saves the startup cost of each tool. A watchdog
+  // enforces the sample's timeout; since the tools cannot be interrupted, one
+  // which times out is left to finish on a detached thread, and that command
+  // runs its binary for every later call so at most one thread per tool is
+  // leaked. Each command also falls back to running its binary for arguments
+  // it does not support. Proc evaluation and simulation always run their
+  // binaries.
+  static Commands InProcessCommands();
+
   explicit SampleRunner(std::filesystem::path run_dir)
       : run_dir_(std::move(run_dir)) {}
   SampleRunner(std::filesystem::path run_dir, Commands commands)
@@ -79,6 +99,19 @@ class SampleRunner {
 
   const fuzzer::SampleTimingProto& timing() const { return timing_; }
 
+  // Sets histograms to which the latencies of the stages (see timing()) of
+  // each run are added, e.g. to aggregate them over many samples. The
+  // histograms must outlive the runner. None by default.
+  void set_latency_histograms(StageLatencyHistograms* histograms) {
+    latency_histograms_ = histograms;
+  }
+
+  // Sets the maximum number of codegen variants of a sample (its codegen_args
+  // and each of its codegen_variants) which are generated and simulated
+  // concurrently. Each variant other than the first runs in its own
+  // `codegen_variant_<n>` subdirectory of `run_dir`. 1 by default.
+  void set_codegen_parallelism(int64_t value) { codegen_parallelism_ = value; }
+
  private:
   // Runs a sample with a function as the top which is read from files.
   absl::Status RunFunction(
@@ -93,6 +126,8 @@ class SampleRunner {
   const std::filesystem::path run_dir_;
   const Commands commands_;
   fuzzer::SampleTimingProto timing_;
+  int64_t codegen_parallelism_ = 1;
+  StageLatencyHistograms* latency_histograms_ = nullptr;
 };
 
 }  // namespace xls
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -51,6 +52,12 @@ ABSL_FLAG(std::optional<std::string>, args_file, std::nullopt,
           "simulation.");
 ABSL_FLAG(std::optional<std::string>, ir_channel_names_file, std::nullopt,
           "Optional file containing IR names of input channels for a proc.");
+ABSL_FLAG(int64_t, codegen_parallelism, 1,
+          "Maximum number of codegen variants of the sample for which Verilog "
+          "is generated and simulated concurrently.");
+ABSL_FLAG(bool, in_process_tools, false,
+          "If true, the IR converter, optimizer, IR evaluator and code "
+          "generator run within this process rather than as subprocesses.");
 
 namespace xls {
 
@@ -78,7 +85,10 @@ static absl::Status RealMain(
     const std::filesystem::path& run_dir, const std::string& options_file,
     const std::string& input_file, const std::optional<std::string>& args_file,
     const std::optional<std::string>& ir_channel_names_file) {
-  SampleRunner runner(run_dir);
+  SampleRunner runner(run_dir, absl::GetFlag(FLAGS_in_process_tools)
+                                   ? SampleRunner::InProcessCommands()
+                                   : SampleRunner::Commands());
+  runner.set_codegen_parallelism(absl::GetFlag(FLAGS_codegen_parallelism));
   std::filesystem::path input_filename = MaybeCopyFile(input_file, run_dir);
   std::filesystem::path options_filename = MaybeCopyFile(options_file, run_dir);
   std::optional<std::filesystem::path> args_filename =
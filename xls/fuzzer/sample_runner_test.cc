@@ -14,9 +14,11 @@
 
 #include "xls/fuzzer/sample_runner.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <optional>
+#include <random>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -31,6 +33,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
@@ -39,8 +43,10 @@
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/interp_value_utils.h"
 #include "xls/fuzzer/cpp_sample_runner.h"
+#include "xls/fuzzer/ir_generator.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/fuzzer/sample_generator.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
@@ -634,6 +640,62 @@ TEST_F(SampleRunnerTest, CodegenCombinationalWrongResults) {
                        AllOf(HasSubstr("Result miscompare for sample 0"))));
 }
 
+TEST_F(SampleRunnerTest, CodegenVariants) {
+  // Each variant is generated and simulated in its own directory. The
+  // simulation of the second extra variant produces a wrong result.
+  SampleRunner runner(
+      GetTempPath(),
+      {.codegen_main =
+           [](const std::vector<std::string>& args,
+              const std::filesystem::path&,
+              const SampleOptions&) -> absl::StatusOr<std::string> {
+             return absl::StrCat("// ", absl::StrJoin(args, " "), "\n");
+           },
+       .simulate_module_main =
+           [](const std::vector<std::string>&,
+              const std::filesystem::path& run_dir,
+              const SampleOptions&) -> absl::StatusOr<std::string> {
+             return run_dir.filename() == "codegen_variant_2"
+                        ? "bits[8]:0x1\n"
+                        : "bits[8]:0x8e\n";
+           }});
+  runner.set_codegen_parallelism(3);
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=combinational"});
+  options.add_codegen_variant({"--generator=pipeline", "--pipeline_stages=1"});
+  options.add_codegen_variant({"--generator=pipeline", "--pipeline_stages=2"});
+  options.set_use_system_verilog(false);
+  options.set_simulate(true);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch, ToArgsBatch({
+                                                     {
+                                                         "bits[8]:42",
+                                                         "bits[8]:100",
+                                                     },
+                                                 }));
+  EXPECT_THAT(runner.Run(Sample(std::string(dslx_text), options, args_batch)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       AllOf(HasSubstr("Result miscompare for sample 0"),
+                             HasSubstr("simulated (codegen variant 2)"))));
+
+  EXPECT_THAT(GetFileContents(GetTempPath() / "sample.v"),
+              IsOkAndHolds(HasSubstr("--generator=combinational")));
+  EXPECT_THAT(GetFileContents(GetTempPath() / "codegen_variant_1/sample.v"),
+              IsOkAndHolds(HasSubstr("--pipeline_stages=1")));
+  EXPECT_THAT(GetFileContents(GetTempPath() / "codegen_variant_2/sample.v"),
+              IsOkAndHolds(HasSubstr("--pipeline_stages=2")));
+  EXPECT_THAT(
+      GetFileContents(GetTempPath() / "codegen_variant_1/sample.v.results"),
+      IsOkAndHolds(HasSubstr("bits[8]:0x8e")));
+  EXPECT_THAT(
+      GetFileContents(GetTempPath() / "codegen_variant_2/sample.v.results"),
+      IsOkAndHolds(HasSubstr("bits[8]:0x1")));
+}
+
 TEST_F(SampleRunnerTest, CodegenPipeline) {
   if (!DefaultSimulatorSupportsSystemVerilog()) {
     GTEST_SKIP() << "uses SystemVerilog, default simulator does not support";
@@ -674,6 +736,85 @@ TEST_F(SampleRunnerTest, CodegenPipeline) {
               ElementsAre("bits[8]:0x8e"));
 }
 
+TEST_F(SampleRunnerTest, CodegenPipelineInProcess) {
+  if (!DefaultSimulatorSupportsSystemVerilog()) {
+    GTEST_SKIP() << "uses SystemVerilog, default simulator does not support";
+  }
+  SampleRunner runner(GetTempPath(), SampleRunner::InProcessCommands());
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_codegen(true);
+  options.set_codegen_args({
+      "--generator=pipeline",
+      "--pipeline_stages=2",
+      "--reset_data_path=false",
+      "--output_block_ir_path=sample.block.ir",
+  });
+  options.set_use_system_verilog(true);
+  options.set_simulate(true);
+  options.set_timeout_seconds(600);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"},
+                                        {"bits[8]:222", "bits[8]:240"}}));
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+
+  for (std::string_view results_file :
+       {"sample.ir.results", "sample.opt.ir.results", "sample.sv.results"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string results,
+                             GetFileContents(GetTempPath() / results_file));
+    EXPECT_THAT(absl::StrSplit(absl::StripAsciiWhitespace(results), "\n",
+                               absl::SkipEmpty()),
+                ElementsAre("bits[8]:0x8e", "bits[8]:0xce"))
+        << results_file;
+  }
+  EXPECT_THAT(GetFileContents(GetTempPath() / "module_sig.textproto"),
+              IsOkAndHolds(HasSubstr("module_name")));
+  EXPECT_THAT(GetFileContents(GetTempPath() / "sample.block.ir"),
+              IsOkAndHolds(HasSubstr("block ")));
+}
+
+TEST_F(SampleRunnerTest, InProcessFallsBackForUnsupportedFlags) {
+  SampleRunner runner(GetTempPath(), SampleRunner::InProcessCommands());
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  // Only the binary supports --package_name, so conversion runs as a
+  // subprocess and the rest of the sample in-process.
+  options.set_ir_converter_args({"--top=main", "--package_name=renamed"});
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"}}));
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+  EXPECT_THAT(GetFileContents(GetTempPath() / "sample.ir"),
+              IsOkAndHolds(HasSubstr("package renamed")));
+  EXPECT_THAT(GetFileContents(GetTempPath() / "sample.opt.ir.results"),
+              IsOkAndHolds(HasSubstr("bits[8]:0x8e")));
+}
+
+TEST_F(SampleRunnerTest, InProcessReusesJitCompilations) {
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"}}));
+  // The second run (and the optimized IR, which is unchanged by optimization)
+  // reuses the compilation of the first run's unoptimized IR.
+  for (int64_t i = 0; i < 2; ++i) {
+    SampleRunner runner(GetTempPath(), SampleRunner::InProcessCommands());
+    XLS_ASSERT_OK(
+        runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+    EXPECT_THAT(GetFileContents(GetTempPath() / "sample.opt.ir.results"),
+                IsOkAndHolds(HasSubstr("bits[8]:0x8e")));
+  }
+}
+
 TEST_F(SampleRunnerTest, IRInput) {
   SampleRunner runner(GetTempPath());
   constexpr std::string_view ir_text = R"(
@@ -994,5 +1135,23 @@ TEST_F(SampleRunnerTest, MiscompareChannelValues) {
   EXPECT_THAT(exception, HasSubstr(expected_error));
 }
 
+TEST_F(SampleRunnerTest, RunGeneratedIrSamples) {
+  std::mt19937_64 rng;
+  for (bool generate_proc : {false, true}) {
+    IrGeneratorOptions generator_options;
+    generator_options.generate_proc = generate_proc;
+    SampleOptions options;
+    options.set_calls_per_sample(generate_proc ? 0 : 8);
+    options.set_proc_ticks(generate_proc ? 8 : 0);
+    for (int64_t i = 0; i < 5; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Sample sample, GenerateIrSample(generator_options, options, rng));
+      XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+      SampleRunner runner(run_dir.path());
+      XLS_EXPECT_OK(runner.Run(sample)) << sample.input_text();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,165 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/stage_latency_histograms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/no_destructor.h"
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+using fuzzer::SampleTimingProto;
+
+struct Stage {
+  std::string_view name;
+  bool (SampleTimingProto::*has)() const;
+  int64_t (SampleTimingProto::*get)() const;
+};
+
+#define XLS_STAGE(F) \
+  Stage { #F, &SampleTimingProto::has_##F##_ns, &SampleTimingProto::F##_ns }
+
+constexpr Stage kStages[] = {
+    XLS_STAGE(generate_sample),
+    XLS_STAGE(interpret_dslx),
+    XLS_STAGE(convert_ir),
+    XLS_STAGE(unoptimized_interpret_ir),
+    XLS_STAGE(unoptimized_jit),
+    XLS_STAGE(optimize),
+    XLS_STAGE(optimized_interpret_ir),
+    XLS_STAGE(optimized_jit),
+    XLS_STAGE(codegen),
+    XLS_STAGE(simulate),
+    XLS_STAGE(total),
+};
+
+#undef XLS_STAGE
+
+}  // namespace
+
+int64_t LatencyHistogram::BucketIndex(int64_t ns) {
+  if (ns < kSubBuckets) {
+    return std::max<int64_t>(ns, 0);
+  }
+  // The sub-bucket is given by the three bits below the leading one.
+  int64_t exponent = absl::bit_width(static_cast<uint64_t>(ns)) - 1;
+  int64_t sub_bucket = (ns >> (exponent - 3)) - kSubBuckets;
+  return kSubBuckets * (exponent - 2) + sub_bucket;
+}
+
+int64_t LatencyHistogram::BucketLowerBound(int64_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  int64_t exponent = index / kSubBuckets + 2;
+  int64_t sub_bucket = index % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (exponent - 3);
+}
+
+void LatencyHistogram::Add(absl::Duration latency) {
+  ++buckets_[BucketIndex(absl::ToInt64Nanoseconds(latency))];
+  ++count_;
+  max_ = std::max(max_, latency);
+}
+
+absl::Duration LatencyHistogram::Percentile(double p) const {
+  CHECK_GT(count_, 0);
+  int64_t rank = std::max<int64_t>(1, std::ceil(p * count_));
+  if (rank >= count_) {
+    return max_;
+  }
+  int64_t seen = 0;
+  for (int64_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min(absl::Nanoseconds(BucketLowerBound(i)), max_);
+    }
+  }
+  return max_;
+}
+
+absl::Span<const std::string_view> StageLatencyHistograms::StageNames() {
+  static const absl::NoDestructor<std::vector<std::string_view>> kStageNames(
+      [] {
+        std::vector<std::string_view> names;
+        for (const Stage& stage : kStages) {
+          names.push_back(stage.name);
+        }
+        return names;
+      }());
+  return *kStageNames;
+}
+
+void StageLatencyHistograms::AddLatency(std::string_view stage,
+                                        absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  histograms_[stage].Add(latency);
+}
+
+void StageLatencyHistograms::AddSampleTiming(const SampleTimingProto& timing) {
+  absl::MutexLock lock(&mutex_);
+  for (const Stage& stage : kStages) {
+    if ((timing.*stage.has)()) {
+      histograms_[stage.name].Add(absl::Nanoseconds((timing.*stage.get)()));
+    }
+  }
+}
+
+std::optional<LatencyHistogram> StageLatencyHistograms::GetHistogram(
+    std::string_view stage) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = histograms_.find(stage);
+  if (it == histograms_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::string StageLatencyHistograms::ToString() const {
+  auto ms = [](absl::Duration d) { return absl::ToDoubleMilliseconds(d); };
+  std::string result =
+      absl::StrFormat("%-26s %8s %10s %10s %10s %10s\n", "stage", "count",
+                      "p50 (ms)", "p90 (ms)", "p99 (ms)", "max (ms)");
+  absl::MutexLock lock(&mutex_);
+  for (const Stage& stage : kStages) {
+    auto it = histograms_.find(stage.name);
+    if (it == histograms_.end()) {
+      continue;
+    }
+    const LatencyHistogram& histogram = it->second;
+    absl::StrAppendFormat(&result, "%-26s %8d %10.3f %10.3f %10.3f %10.3f\n",
+                          stage.name, histogram.count(),
+                          ms(histogram.Percentile(0.5)),
+                          ms(histogram.Percentile(0.9)),
+                          ms(histogram.Percentile(0.99)), ms(histogram.max()));
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_STAGE_LATENCY_HISTOGRAMS_H_
+#define XLS_FUZZER_STAGE_LATENCY_HISTOGRAMS_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+
+// Histogram of latencies with logarithmic buckets: eight per power of two, so
+// percentiles are accurate to within 12.5%.
+class LatencyHistogram {
+ public:
+  void Add(absl::Duration latency);
+
+  int64_t count() const { return count_; }
+  absl::Duration max() const { return max_; }
+
+  // Returns the latency below which a fraction `p` of the added latencies
+  // fall, rounded down to its bucket; the maximum is exact. Requires a
+  // non-empty histogram.
+  absl::Duration Percentile(double p) const;
+
+ private:
+  static constexpr int64_t kSubBuckets = 8;
+  static constexpr int64_t kBucketCount = kSubBuckets * 64;
+
+  static int64_t BucketIndex(int64_t ns);
+  static int64_t BucketLowerBound(int64_t index);
+
+  std::array<int64_t, kBucketCount> buckets_ = {};
+  int64_t count_ = 0;
+  absl::Duration max_ = absl::ZeroDuration();
+};
+
+// Latency histograms of the stages of running fuzz samples (generate,
+// interpret_dslx, convert_ir, ..., simulate and total), aggregated over many
+// samples. May be shared by threads running samples concurrently.
+class StageLatencyHistograms {
+ public:
+  // The names of the stages, in the order they run. Each is the name of the
+  // corresponding SampleTimingProto field without its "_ns" suffix.
+  static absl::Span<const std::string_view> StageNames();
+
+  // Adds the latency of one run of `stage`, which is one of StageNames().
+  void AddLatency(std::string_view stage, absl::Duration latency);
+
+  // Adds the latencies of the stages recorded in `timing`. Stages which did
+  // not run (whose fields are not set) are not counted.
+  void AddSampleTiming(const fuzzer::SampleTimingProto& timing);
+
+  // Returns the histogram of `stage`, if any latencies of it were added.
+  std::optional<LatencyHistogram> GetHistogram(std::string_view stage) const;
+
+  // Returns a table of the number of runs and the median, 90th and 99th
+  // percentile and maximum latency of each stage which ran.
+  std::string ToString() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, LatencyHistogram> histograms_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_STAGE_LATENCY_HISTOGRAMS_H_
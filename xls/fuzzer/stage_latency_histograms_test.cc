@@ -0,0 +1,83 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/stage_latency_histograms.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  for (int64_t i = 1; i <= 100; ++i) {
+    histogram.Add(absl::Milliseconds(i));
+  }
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.max(), absl::Milliseconds(100));
+
+  // Percentiles are rounded down to their bucket, within 12.5%.
+  for (double p : {0.01, 0.5, 0.9, 0.99}) {
+    absl::Duration expected = absl::Milliseconds(100 * p);
+    EXPECT_LE(histogram.Percentile(p), expected) << p;
+    EXPECT_GT(histogram.Percentile(p), expected * 0.875) << p;
+  }
+  EXPECT_EQ(histogram.Percentile(1.0), absl::Milliseconds(100));
+}
+
+TEST(LatencyHistogramTest, SmallLatenciesAreExact) {
+  LatencyHistogram histogram;
+  histogram.Add(absl::Nanoseconds(3));
+  histogram.Add(absl::ZeroDuration());
+  EXPECT_EQ(histogram.Percentile(0.5), absl::ZeroDuration());
+  EXPECT_EQ(histogram.Percentile(1.0), absl::Nanoseconds(3));
+}
+
+TEST(StageLatencyHistogramsTest, AddSampleTiming) {
+  StageLatencyHistograms histograms;
+  fuzzer::SampleTimingProto timing;
+  timing.set_convert_ir_ns(absl::ToInt64Nanoseconds(absl::Milliseconds(2)));
+  timing.set_optimize_ns(absl::ToInt64Nanoseconds(absl::Milliseconds(5)));
+  histograms.AddSampleTiming(timing);
+  histograms.AddSampleTiming(timing);
+  histograms.AddLatency("generate_sample", absl::Milliseconds(1));
+
+  std::optional<LatencyHistogram> optimize =
+      histograms.GetHistogram("optimize");
+  ASSERT_TRUE(optimize.has_value());
+  EXPECT_EQ(optimize->count(), 2);
+  EXPECT_EQ(optimize->max(), absl::Milliseconds(5));
+  EXPECT_EQ(histograms.GetHistogram("generate_sample")->count(), 1);
+
+  // Stages which did not run have no histogram.
+  EXPECT_FALSE(histograms.GetHistogram("codegen").has_value());
+
+  std::string table = histograms.ToString();
+  EXPECT_THAT(table, HasSubstr("convert_ir"));
+  EXPECT_THAT(table, HasSubstr("optimize"));
+  EXPECT_THAT(table, Not(HasSubstr("simulate")));
+}
+
+}  // namespace
+}  // namespace xls
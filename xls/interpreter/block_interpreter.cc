@@ -23,10 +23,12 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -47,7 +49,9 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -934,12 +938,280 @@ class StatelessBlockContinuation final : public BlockContinuation {
 template <typename Evaluate>
 StatelessBlockContinuation(BlockElaboration&&, BlockRunResult&&,
                            Evaluate) -> StatelessBlockContinuation<Evaluate>;
-}  // namespace
 
-absl::StatusOr<std::unique_ptr<BlockContinuation>>
-InterpreterBlockEvaluator::MakeNewContinuation(
+// A continuation which evaluates a single block along a schedule computed
+// once at construction. Register state and output ports live in dense vectors
+// indexed by slots assigned up front, and the node values map is sized once
+// and recycled every cycle. Nodes which only depend on literals are evaluated
+// at construction and kept for the life of the continuation.
+class CompiledBlockContinuation final : public BlockContinuation {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledBlockContinuation>> Create(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers) {
+    Block* block = *elaboration.top()->block();
+    auto continuation = absl::WrapUnique(
+        new CompiledBlockContinuation(std::move(elaboration), block));
+    XLS_RETURN_IF_ERROR(continuation->Compile(initial_registers));
+    return continuation;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    return outputs_;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    if (registers_map_stale_) {
+      for (int64_t i = 0; i < registers_.size(); ++i) {
+        *register_map_slots_[i] = registers_[i];
+      }
+      registers_map_stale_ = false;
+    }
+    return registers_map_;
+  }
+
+  const InterpreterEvents& events() final { return events_; }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    for (const auto& [name, value] : inputs) {
+      // Empty tuples don't have data
+      if (value.GetFlatBitCount() == 0) {
+        continue;
+      }
+      if (!input_port_names_.contains(name)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Block has no input port '%s'", name));
+      }
+    }
+
+    events_ = InterpreterEvents();
+    IrInterpreter interpreter(&node_values_, &events_, observer_);
+    for (const Step& step : schedule_) {
+      Node* node = step.node;
+      if (step.kind == StepKind::kConstant) {
+        if (observer_.has_value()) {
+          (*observer_)->NodeEvaluated(node, node_values_.at(node));
+        }
+        continue;
+      }
+      node_values_.erase(node);
+      switch (step.kind) {
+        case StepKind::kInputPort: {
+          auto port_iter = inputs.find(node->As<InputPort>()->GetName());
+          if (port_iter == inputs.end()) {
+            return absl::InvalidArgumentError(
+                absl::StrFormat("Missing input for port '%s'",
+                                node->As<InputPort>()->GetName()));
+          }
+          XLS_RETURN_IF_ERROR(
+              interpreter.SetValueResult(node, port_iter->second));
+          break;
+        }
+        case StepKind::kRegisterRead:
+          XLS_RETURN_IF_ERROR(
+              interpreter.SetValueResult(node, registers_[step.slot]));
+          break;
+        case StepKind::kRegisterWrite:
+          next_registers_[step.slot] =
+              NextRegisterValue(interpreter, node->As<RegisterWrite>(),
+                                registers_[step.slot]);
+          // Register writes have empty tuple types.
+          XLS_RETURN_IF_ERROR(
+              interpreter.SetValueResult(node, Value::Tuple({})));
+          break;
+        case StepKind::kOutputPort:
+          *output_slots_[step.slot] =
+              interpreter.ResolveAsValue(node->operand(0));
+          // Output ports have empty tuple types.
+          XLS_RETURN_IF_ERROR(
+              interpreter.SetValueResult(node, Value::Tuple({})));
+          break;
+        case StepKind::kEvaluate:
+          XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+          break;
+        case StepKind::kConstant:
+          LOG(FATAL) << "Constant nodes are not re-evaluated";
+      }
+    }
+    std::swap(registers_, next_registers_);
+    registers_map_stale_ = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    XLS_RET_CHECK_EQ(regs.size(), registers_.size());
+    for (const auto& [key, v] : regs) {
+      auto slot_iter = register_slots_.find(key);
+      XLS_RET_CHECK(slot_iter != register_slots_.end()) << key;
+      const Value& current = registers_[slot_iter->second];
+      XLS_RET_CHECK(current.SameTypeAs(v))
+          << "'" << key << "' is incorrect type. Expected shape to match "
+          << current << " but value " << v << " does not match.";
+    }
+    for (const auto& [key, v] : regs) {
+      registers_[register_slots_.at(key)] = v;
+    }
+    registers_map_stale_ = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status SetObserver(EvaluationObserver* obs) override {
+    observer_ = obs;
+    return absl::OkStatus();
+  }
+  void ClearObserver() override { observer_.reset(); }
+
+ private:
+  enum class StepKind : uint8_t {
+    // The value was computed at construction and is never re-evaluated.
+    kConstant,
+    kInputPort,
+    kOutputPort,
+    kRegisterRead,
+    kRegisterWrite,
+    // Any other node, evaluated by the IR interpreter.
+    kEvaluate,
+  };
+
+  struct Step {
+    Node* node;
+    StepKind kind;
+    // Index into the register or output port storage, if any.
+    int64_t slot;
+  };
+
+  CompiledBlockContinuation(BlockElaboration&& elaboration, Block* block)
+      : elaboration_(std::move(elaboration)), block_(block) {}
+
+  absl::Status Compile(
+      const absl::flat_hash_map<std::string, Value>& initial_registers) {
+    absl::flat_hash_map<Register*, int64_t> register_slot;
+    for (Register* reg : block_->GetRegisters()) {
+      auto reg_value_iter = initial_registers.find(reg->name());
+      if (reg_value_iter == initial_registers.end()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing value for register '%s'", reg->name()));
+      }
+      // Every register must have exactly one write to produce its next state.
+      XLS_RETURN_IF_ERROR(block_->GetRegisterWrite(reg).status());
+      register_slot[reg] = registers_.size();
+      register_slots_[reg->name()] = registers_.size();
+      registers_.push_back(reg_value_iter->second);
+      registers_map_[reg->name()] = reg_value_iter->second;
+    }
+    for (const auto& [name, value] : initial_registers) {
+      if (!register_slots_.contains(name)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Block has no register '%s'", name));
+      }
+    }
+    // Pointers into the maps are stable since no keys are added after this.
+    for (Register* reg : block_->GetRegisters()) {
+      register_map_slots_.push_back(&registers_map_.at(reg->name()));
+    }
+    next_registers_ = registers_;
+
+    for (InputPort* port : block_->GetInputPorts()) {
+      input_port_names_.insert(port->GetName());
+    }
+    outputs_.reserve(block_->GetOutputPorts().size());
+    for (OutputPort* port : block_->GetOutputPorts()) {
+      outputs_[port->GetName()] = ZeroOfType(port->operand(0)->GetType());
+    }
+
+    node_values_.reserve(block_->node_count());
+    IrInterpreter interpreter(&node_values_, &events_);
+    absl::flat_hash_set<Node*> constant_nodes;
+    for (Node* node : TopoSort(block_)) {
+      Step step{.node = node, .kind = StepKind::kEvaluate, .slot = 0};
+      if (node->Is<InputPort>()) {
+        step.kind = StepKind::kInputPort;
+      } else if (node->Is<OutputPort>()) {
+        step.kind = StepKind::kOutputPort;
+        step.slot = output_slots_.size();
+        output_slots_.push_back(&outputs_.at(node->GetName()));
+      } else if (node->Is<RegisterRead>()) {
+        step.kind = StepKind::kRegisterRead;
+        step.slot = register_slot.at(node->As<RegisterRead>()->GetRegister());
+      } else if (node->Is<RegisterWrite>()) {
+        step.kind = StepKind::kRegisterWrite;
+        step.slot = register_slot.at(node->As<RegisterWrite>()->GetRegister());
+      } else if (IsConstant(node, constant_nodes)) {
+        XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+        constant_nodes.insert(node);
+        step.kind = StepKind::kConstant;
+      }
+      schedule_.push_back(step);
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns true if `node` is free of side effects and only depends on
+  // literals, so its value is the same on every cycle.
+  static bool IsConstant(Node* node,
+                         const absl::flat_hash_set<Node*>& constant_nodes) {
+    if (node->Is<Literal>()) {
+      return true;
+    }
+    if (OpIsSideEffecting(node->op()) || node->operand_count() == 0) {
+      return false;
+    }
+    return absl::c_all_of(node->operands(), [&](Node* operand) {
+      return constant_nodes.contains(operand);
+    });
+  }
+
+  static Value NextRegisterValue(const IrInterpreter& interpreter,
+                                 RegisterWrite* reg_write,
+                                 const Value& current) {
+    if (reg_write->reset().has_value()) {
+      bool reset_signal =
+          interpreter.ResolveAsValue(reg_write->reset().value()).IsAllOnes();
+      const Reset& reset = reg_write->GetRegister()->reset().value();
+      if (reset_signal != reset.active_low) {
+        // Reset is activated. Next register state is the reset value.
+        return reset.reset_value;
+      }
+    }
+    if (reg_write->load_enable().has_value() &&
+        !interpreter.ResolveAsValue(reg_write->load_enable().value())
+             .IsAllOnes()) {
+      // Load enable is not activated. Next register state is the previous
+      // register value.
+      return current;
+    }
+    // Next register state is the input data value.
+    return interpreter.ResolveAsValue(reg_write->data());
+  }
+
+  BlockElaboration elaboration_;
+  Block* block_;
+
+  std::vector<Step> schedule_;
+  absl::flat_hash_map<Node*, Value> node_values_;
+  InterpreterEvents events_;
+  std::optional<EvaluationObserver*> observer_;
+
+  absl::flat_hash_set<std::string> input_port_names_;
+  absl::flat_hash_map<std::string, Value> outputs_;
+  std::vector<Value*> output_slots_;
+
+  // Register state for the current and the next cycle, indexed by slot.
+  std::vector<Value> registers_;
+  std::vector<Value> next_registers_;
+  absl::flat_hash_map<std::string, int64_t> register_slots_;
+
+  // Name-keyed view of `registers_`, refreshed lazily by registers().
+  absl::flat_hash_map<std::string, Value> registers_map_;
+  std::vector<Value*> register_map_slots_;
+  bool registers_map_stale_ = false;
+};
+
+absl::StatusOr<std::unique_ptr<BlockContinuation>> MakeInterpretedContinuation(
     BlockElaboration&& elaboration,
-    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+    const absl::flat_hash_map<std::string, Value>& initial_registers) {
   // We implement fifos using some extra registers stashed in the
   // register-state. We need to add these here.
   absl::flat_hash_map<std::string, Value> ext_regs = initial_registers;
@@ -961,4 +1233,26 @@ InterpreterBlockEvaluator::MakeNewContinuation(
   return std::unique_ptr<BlockContinuation>(cont);
 }
 
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<BlockContinuation>>
+InterpreterBlockEvaluator::MakeNewContinuation(
+    BlockElaboration&& elaboration,
+    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  return MakeInterpretedContinuation(std::move(elaboration),
+                                     initial_registers);
+}
+
+absl::StatusOr<std::unique_ptr<BlockContinuation>>
+CompiledInterpreterBlockEvaluator::MakeNewContinuation(
+    BlockElaboration&& elaboration,
+    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  if (elaboration.instances().size() > 1) {
+    return MakeInterpretedContinuation(std::move(elaboration),
+                                       initial_registers);
+  }
+  return CompiledBlockContinuation::Create(std::move(elaboration),
+                                           initial_registers);
+}
+
 }  // namespace xls
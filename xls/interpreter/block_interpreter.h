@@ -43,6 +43,24 @@ class InterpreterBlockEvaluator final : public BlockEvaluator {
       const override;
 };
 
+// An interpreter which compiles a block into a fixed evaluation schedule once
+// and reuses its storage across cycles. Registers and ports are assigned dense
+// slots when the continuation is created, nodes which only depend on literals
+// are evaluated a single time, and each cycle only re-evaluates the remaining
+// combinational logic. Elaborations which instantiate other blocks or FIFOs
+// are evaluated as by the InterpreterBlockEvaluator.
+class CompiledInterpreterBlockEvaluator final : public BlockEvaluator {
+ public:
+  constexpr CompiledInterpreterBlockEvaluator()
+      : BlockEvaluator("CompiledInterpreter") {}
+
+ protected:
+  absl::StatusOr<std::unique_ptr<BlockContinuation>> MakeNewContinuation(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers)
+      const override;
+};
+
 // Runs the interpreter on a combinational block. `inputs` must contain a
 // value for each input port in the block. The returned map contains a value
 // for each output port of the block.
@@ -116,6 +134,10 @@ InterpretChannelizedSequentialBlockWithUint64(
 // A single evaluator which uses the interpreter.
 static const InterpreterBlockEvaluator kInterpreterBlockEvaluator;
 
+// A single evaluator which uses the compiled interpreter.
+static const CompiledInterpreterBlockEvaluator
+    kCompiledInterpreterBlockEvaluator;
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_BLOCK_INTERPRETER_H_
@@ -38,5 +38,22 @@ INSTANTIATE_TEST_SUITE_P(
     testing::ValuesIn(GenerateFifoTestParams(kBlockInterpreterTestParam)),
     FifoTestName);
 
+inline constexpr BlockEvaluatorTestParam kCompiledBlockInterpreterTestParam = {
+    .evaluator = &kCompiledInterpreterBlockEvaluator,
+    .supports_fifos = true,
+    .supports_observer = true};
+
+INSTANTIATE_TEST_SUITE_P(CompiledBlockInterpreterTest, BlockEvaluatorTest,
+                         testing::Values(kCompiledBlockInterpreterTestParam),
+                         [](const auto& v) -> std::string {
+                           return std::string(v.param.evaluator->name());
+                         });
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledBlockInterpreterFifoTest, FifoTest,
+    testing::ValuesIn(
+        GenerateFifoTestParams(kCompiledBlockInterpreterTestParam)),
+    FifoTestName);
+
 }  // namespace
 }  // namespace xls
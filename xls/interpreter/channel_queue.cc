@@ -30,6 +30,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
@@ -108,6 +109,68 @@ std::optional<Value> ChannelQueue::Read() {
   return value;
 }
 
+std::vector<Value> ChannelQueue::GetContents() {
+  absl::MutexLock lock(&mutex_);
+  // Rotate the elements through the queue with the callbacks detached. Reads
+  // are not destructive for single-value channels so at most one element is
+  // read for those.
+  std::vector<std::unique_ptr<ChannelQueueCallback>> callbacks =
+      std::move(callbacks_);
+  callbacks_.clear();
+  std::vector<Value> contents;
+  int64_t size = GetSizeInternal();
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    size = std::min(size, int64_t{1});
+  }
+  contents.reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    std::optional<Value> value = ReadInternal();
+    CHECK(value.has_value());
+    contents.push_back(*std::move(value));
+  }
+  if (channel()->kind() != ChannelKind::kSingleValue) {
+    for (const Value& value : contents) {
+      WriteInternal(value);
+    }
+  }
+  callbacks_ = std::move(callbacks);
+  return contents;
+}
+
+absl::Status ChannelQueue::SetContents(absl::Span<const Value> values) {
+  absl::MutexLock lock(&mutex_);
+  for (const Value& value : values) {
+    if (!ValueConformsToType(value, channel()->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel `%s` expects values to have type %s, got: %s",
+          channel()->name(), channel()->type()->ToString(), value.ToString()));
+    }
+  }
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    if (values.size() > 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Single-value channel `%s` cannot hold %d values", channel()->name(),
+          values.size()));
+    }
+    if (values.empty() && GetSizeInternal() > 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Single-value channel `%s` cannot be emptied", channel()->name()));
+    }
+  }
+  std::vector<std::unique_ptr<ChannelQueueCallback>> callbacks =
+      std::move(callbacks_);
+  callbacks_.clear();
+  if (channel()->kind() != ChannelKind::kSingleValue) {
+    while (ReadInternal().has_value()) {
+    }
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  callbacks_ = std::move(callbacks);
+  return absl::OkStatus();
+}
+
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
 std::optional<Value> ChannelQueue::ReadInternal() {
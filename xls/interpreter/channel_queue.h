@@ -91,11 +91,24 @@ class ChannelQueue {
   // the channel is empty.
   std::optional<Value> Read();
 
+  // Returns the elements currently in the queue, front first, without
+  // consuming them. Callbacks are not invoked and values not yet produced by
+  // an attached generator are not included.
+  std::vector<Value> GetContents();
+
+  // Replaces the contents of the queue with `values` without invoking
+  // callbacks. Used, with GetContents, to checkpoint and restore the queue.
+  absl::Status SetContents(absl::Span<const Value> values);
+
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
   // then calling `Write` returns an error.
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
+  bool HasGenerator() const {
+    absl::MutexLock lock(&mutex_);
+    return generator_.has_value();
+  }
 
   void AddCallback(std::unique_ptr<ChannelQueueCallback> callback) {
     callbacks_.push_back(std::move(callback));
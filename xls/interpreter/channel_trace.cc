@@ -0,0 +1,261 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/channel_trace.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_type.pb.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kMagic = "XLSCHTR\x01";
+
+// Buffered records are written out once the buffer exceeds this size.
+constexpr int64_t kFlushThreshold = int64_t{1} << 20;
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendValueBytes(const Value& value, std::string* out) {
+  if (value.IsBits()) {
+    int64_t byte_count = CeilOfRatio(value.bits().bit_count(), int64_t{8});
+    int64_t offset = out->size();
+    out->resize(offset + byte_count);
+    value.bits().ToBytes(absl::MakeSpan(
+        reinterpret_cast<uint8_t*>(out->data()) + offset, byte_count));
+    return;
+  }
+  if (value.IsTuple() || value.IsArray()) {
+    for (const Value& element : value.elements()) {
+      AppendValueBytes(element, out);
+    }
+  }
+}
+
+absl::StatusOr<uint64_t> ReadVarint(std::string_view& data) {
+  uint64_t value = 0;
+  for (int64_t shift = 0; shift < 64; shift += 7) {
+    if (data.empty()) {
+      return absl::InvalidArgumentError("Truncated channel trace");
+    }
+    uint8_t byte = static_cast<uint8_t>(data.front());
+    data.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  return absl::InvalidArgumentError("Malformed varint in channel trace");
+}
+
+absl::StatusOr<std::string_view> ReadBytes(std::string_view& data,
+                                           uint64_t size) {
+  if (data.size() < size) {
+    return absl::InvalidArgumentError("Truncated channel trace");
+  }
+  std::string_view bytes = data.substr(0, size);
+  data.remove_prefix(size);
+  return bytes;
+}
+
+absl::StatusOr<Value> ReadValue(const TypeProto& type,
+                                std::string_view& data) {
+  switch (type.type_enum()) {
+    case TypeProto::BITS: {
+      XLS_ASSIGN_OR_RETURN(
+          std::string_view bytes,
+          ReadBytes(data, CeilOfRatio(type.bit_count(), int64_t{8})));
+      return Value(Bits::FromBytes(
+          absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                              bytes.size()),
+          type.bit_count()));
+    }
+    case TypeProto::TUPLE: {
+      std::vector<Value> elements;
+      elements.reserve(type.tuple_elements_size());
+      for (const TypeProto& element_type : type.tuple_elements()) {
+        XLS_ASSIGN_OR_RETURN(Value element, ReadValue(element_type, data));
+        elements.push_back(std::move(element));
+      }
+      return Value::Tuple(elements);
+    }
+    case TypeProto::ARRAY: {
+      std::vector<Value> elements;
+      elements.reserve(type.array_size());
+      for (int64_t i = 0; i < type.array_size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Value element,
+                             ReadValue(type.array_element(), data));
+        elements.push_back(std::move(element));
+      }
+      return Value::Array(elements);
+    }
+    case TypeProto::TOKEN:
+      return Value::Token();
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type in channel trace: %s",
+                          TypeProto::TypeEnum_Name(type.type_enum())));
+  }
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelTraceWriter>>
+ChannelTraceWriter::Create(
+    const std::filesystem::path& path,
+    absl::Span<ChannelInstance* const> channel_instances) {
+  XLS_ASSIGN_OR_RETURN(FileStream file, FileStream::Open(path, "wb"));
+  auto writer = absl::WrapUnique(new ChannelTraceWriter(std::move(file)));
+  absl::MutexLock lock(&writer->mutex_);
+  writer->buffer_.append(kMagic);
+  AppendVarint(channel_instances.size(), &writer->buffer_);
+  for (ChannelInstance* channel_instance : channel_instances) {
+    std::string name = channel_instance->ToString();
+    AppendVarint(name.size(), &writer->buffer_);
+    writer->buffer_.append(name);
+    std::string type =
+        channel_instance->channel->type()->ToProto().SerializeAsString();
+    AppendVarint(type.size(), &writer->buffer_);
+    writer->buffer_.append(type);
+  }
+  return writer;
+}
+
+ChannelTraceWriter::~ChannelTraceWriter() {
+  absl::Status status = Flush();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to write channel trace: " << status;
+  }
+}
+
+void ChannelTraceWriter::Record(int64_t tick, int64_t channel_index,
+                                ChannelTraceOp op, const Value& value) {
+  absl::MutexLock lock(&mutex_);
+  AppendVarint(tick, &buffer_);
+  AppendVarint(channel_index, &buffer_);
+  buffer_.push_back(static_cast<char>(op));
+  AppendValueBytes(value, &buffer_);
+  if (buffer_.size() >= kFlushThreshold) {
+    FlushLocked();
+  }
+}
+
+absl::Status ChannelTraceWriter::Flush() {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  if (status_.ok() && fflush(file_.get()) != 0) {
+    status_ = ErrnoToStatus(errno);
+  }
+  return status_;
+}
+
+void ChannelTraceWriter::FlushLocked() {
+  if (status_.ok() && !buffer_.empty() &&
+      fwrite(buffer_.data(), 1, buffer_.size(), file_.get()) !=
+          buffer_.size()) {
+    status_ = ErrnoToStatus(errno);
+  }
+  buffer_.clear();
+}
+
+absl::StatusOr<ChannelTrace> ParseChannelTrace(std::string_view data) {
+  if (!data.starts_with(kMagic)) {
+    return absl::InvalidArgumentError("Data is not a binary channel trace");
+  }
+  data.remove_prefix(kMagic.size());
+  ChannelTrace trace;
+  XLS_ASSIGN_OR_RETURN(uint64_t channel_count, ReadVarint(data));
+  for (uint64_t i = 0; i < channel_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t name_size, ReadVarint(data));
+    XLS_ASSIGN_OR_RETURN(std::string_view name, ReadBytes(data, name_size));
+    trace.channel_names.push_back(std::string(name));
+    XLS_ASSIGN_OR_RETURN(uint64_t type_size, ReadVarint(data));
+    XLS_ASSIGN_OR_RETURN(std::string_view type, ReadBytes(data, type_size));
+    if (!trace.channel_types.emplace_back().ParseFromArray(
+            type.data(), type.size())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Malformed type of channel `%s` in channel trace", name));
+    }
+  }
+  while (!data.empty()) {
+    ChannelTraceRecord record;
+    XLS_ASSIGN_OR_RETURN(uint64_t tick, ReadVarint(data));
+    XLS_ASSIGN_OR_RETURN(uint64_t channel_index, ReadVarint(data));
+    if (channel_index >= channel_count) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid channel index %d in channel trace", channel_index));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string_view op, ReadBytes(data, 1));
+    if (op[0] != static_cast<char>(ChannelTraceOp::kRead) &&
+        op[0] != static_cast<char>(ChannelTraceOp::kWrite)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid operation %d in channel trace", static_cast<int>(op[0])));
+    }
+    record.tick = static_cast<int64_t>(tick);
+    record.channel_index = static_cast<int64_t>(channel_index);
+    record.op = static_cast<ChannelTraceOp>(op[0]);
+    XLS_ASSIGN_OR_RETURN(record.value,
+                         ReadValue(trace.channel_types[channel_index], data));
+    trace.records.push_back(std::move(record));
+  }
+  return trace;
+}
+
+std::string ChannelTraceToString(const ChannelTrace& trace,
+                                 FormatPreference format_preference) {
+  std::string result;
+  for (const ChannelTraceRecord& record : trace.records) {
+    absl::StrAppendFormat(
+        &result, "Tick %d: %s data on channel `%s`: %s\n", record.tick,
+        record.op == ChannelTraceOp::kRead ? "Received" : "Sent",
+        trace.channel_names[record.channel_index],
+        record.value.ToString(format_preference));
+  }
+  return result;
+}
+
+}  // namespace xls
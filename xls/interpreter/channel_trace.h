@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_CHANNEL_TRACE_H_
+#define XLS_INTERPRETER_CHANNEL_TRACE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_type.pb.h"
+
+namespace xls {
+
+// Binary trace of channel activity in a proc network.
+//
+// The trace starts with a header naming each channel instance and giving its
+// type, so it can be decoded without the IR. Each record then holds the tick
+// number and channel index as varints, one byte for the operation, and the
+// value as the little-endian bytes of each of its leaf bits elements in order,
+// with no per-record type information or padding.
+
+enum class ChannelTraceOp : uint8_t {
+  kRead = 0,
+  kWrite = 1,
+};
+
+// A channel operation decoded from a binary trace.
+struct ChannelTraceRecord {
+  int64_t tick;
+  // Index of the channel instance in `ChannelTrace::channel_names`.
+  int64_t channel_index;
+  ChannelTraceOp op;
+  Value value;
+};
+
+struct ChannelTrace {
+  std::vector<std::string> channel_names;
+  std::vector<TypeProto> channel_types;
+  std::vector<ChannelTraceRecord> records;
+};
+
+// Buffered writer of binary channel traces. Thread-safe so it can be shared by
+// channel queues ticked from different threads.
+class ChannelTraceWriter {
+ public:
+  // Creates a writer for a trace of the given channel instances. Records refer
+  // to channels by their index in `channel_instances`.
+  static absl::StatusOr<std::unique_ptr<ChannelTraceWriter>> Create(
+      const std::filesystem::path& path,
+      absl::Span<ChannelInstance* const> channel_instances);
+
+  ~ChannelTraceWriter();
+
+  // Appends a record to the trace. Write errors are reported by Flush.
+  void Record(int64_t tick, int64_t channel_index, ChannelTraceOp op,
+              const Value& value);
+
+  // Writes out any buffered records. Returns the first error encountered
+  // writing the trace.
+  absl::Status Flush();
+
+ private:
+  explicit ChannelTraceWriter(FileStream file) : file_(std::move(file)) {}
+
+  void FlushLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  absl::Mutex mutex_;
+  FileStream file_ ABSL_GUARDED_BY(mutex_);
+  std::string buffer_ ABSL_GUARDED_BY(mutex_);
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Decodes a binary channel trace.
+absl::StatusOr<ChannelTrace> ParseChannelTrace(std::string_view data);
+
+// Returns the trace as text, one record per line, in the format of the
+// messages recorded by `EvaluatorOptions::set_trace_channels`.
+std::string ChannelTraceToString(
+    const ChannelTrace& trace,
+    FormatPreference format_preference = FormatPreference::kDefault);
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_CHANNEL_TRACE_H_
@@ -15,6 +15,9 @@
 #ifndef XLS_INTERPRETER_EVALUATOR_OPTIONS_H_
 #define XLS_INTERPRETER_EVALUATOR_OPTIONS_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "xls/ir/format_preference.h"
 
 namespace xls {
@@ -42,10 +45,48 @@ class EvaluatorOptions {
   }
   bool support_observers() const { return support_observers_; }
 
+  // When set, proc runtimes tick the proc instances in dataflow order: as far
+  // as the channels between them allow, the senders on a channel are ticked
+  // before its receivers so data moves through an acyclic network in a single
+  // pass without receivers first blocking. A deterministic ParallelProcRuntime
+  // follows the same order as SerialProcRuntime; otherwise the parallel
+  // runtime only seeds its workers in that order. This is intended for
+  // statically scheduled networks which are only accessed from the thread
+  // ticking them; the JIT serial runtime then also uses channel queues which
+  // are not thread safe, avoiding locks on every channel operation.
+  EvaluatorOptions& set_dataflow_tick_order(bool value) {
+    dataflow_tick_order_ = value;
+    return *this;
+  }
+  bool dataflow_tick_order() const { return dataflow_tick_order_; }
+
+  // When set, interpreted procs reuse the values computed in the previous tick
+  // for nodes whose operands are unchanged, so only the logic fed by changed
+  // state elements and received values is re-evaluated. Ignored by the JIT.
+  EvaluatorOptions& set_incremental_evaluation(bool value) {
+    incremental_evaluation_ = value;
+    return *this;
+  }
+  bool incremental_evaluation() const { return incremental_evaluation_; }
+
+  // When set, trace operations with a greater verbosity record no message. The
+  // JIT skips them before formatting or copying any of their operands. Ignored
+  // by the interpreter.
+  EvaluatorOptions& set_max_trace_verbosity(std::optional<int64_t> value) {
+    max_trace_verbosity_ = value;
+    return *this;
+  }
+  std::optional<int64_t> max_trace_verbosity() const {
+    return max_trace_verbosity_;
+  }
+
  private:
   bool trace_channels_ = false;
   FormatPreference format_preference_ = FormatPreference::kDefault;
   bool support_observers_ = false;
+  bool dataflow_tick_order_ = false;
+  bool incremental_evaluation_ = false;
+  std::optional<int64_t> max_trace_verbosity_;
 };
 
 }  // namespace xls
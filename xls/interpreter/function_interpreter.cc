@@ -14,7 +14,9 @@
 
 #include "xls/interpreter/function_interpreter.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -22,16 +24,24 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function.h"
 #include "xls/ir/keyword_args.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
@@ -61,12 +71,7 @@ class FunctionInterpreter final : public IrInterpreter {
   std::vector<Value> args_;
 };
 
-}  // namespace
-
-absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args,
-    std::optional<EvaluationObserver*> observer) {
-  VLOG(3) << "Interpreting function " << function->name();
+absl::Status CheckArgs(Function* function, absl::Span<const Value> args) {
   if (args.size() != function->params().size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Function `%s` (type: `%s`) wants %d arguments, got %d.",
@@ -84,6 +89,35 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
           value.ToString(), argno, param_type->ToString()));
     }
   }
+  return absl::OkStatus();
+}
+
+// Returns the value of `bits`, or `upper_limit` if it is larger.
+uint64_t BoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (bits.FitsInUint64()) {
+    return std::min(bits.ToUint64().value(), upper_limit);
+  }
+  return upper_limit;
+}
+
+Bits Truncate(Bits bits, int64_t width, bool is_signed) {
+  if (bits.bit_count() > width) {
+    return bits.Slice(0, width);
+  }
+  if (bits.bit_count() < width) {
+    return is_signed ? bits_ops::SignExtend(std::move(bits), width)
+                     : bits_ops::ZeroExtend(std::move(bits), width);
+  }
+  return bits;
+}
+
+}  // namespace
+
+absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
+    Function* function, absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) {
+  VLOG(3) << "Interpreting function " << function->name();
+  XLS_RETURN_IF_ERROR(CheckArgs(function, args));
   FunctionInterpreter visitor(args, observer);
   XLS_RETURN_IF_ERROR(function->Accept(&visitor));
   Value result = visitor.ResolveAsValue(function->return_value());
@@ -101,4 +135,224 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
   return InterpretFunction(function, positional_args, observer);
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  auto compiled = absl::WrapUnique(new CompiledFunctionInterpreter(function));
+  absl::flat_hash_map<Node*, int64_t> slots;
+  for (Node* node : TopoSort(function)) {
+    Instruction instruction{
+        .node = node,
+        .operands_begin = static_cast<int64_t>(compiled->operand_slots_.size()),
+        .operand_count = node->operand_count()};
+    for (Node* operand : node->operands()) {
+      compiled->operand_slots_.push_back(slots.at(operand));
+    }
+    if (node->Is<Param>()) {
+      XLS_ASSIGN_OR_RETURN(instruction.param_index,
+                           function->GetParamIndex(node->As<Param>()));
+    }
+    slots[node] = compiled->instructions_.size();
+    compiled->instructions_.push_back(instruction);
+  }
+  compiled->return_slot_ = slots.at(function->return_value());
+  return compiled;
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) const {
+  XLS_RETURN_IF_ERROR(CheckArgs(function_, args));
+  std::vector<Value> slots(instructions_.size());
+  InterpreterEvents events;
+  for (int64_t i = 0; i < instructions_.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(slots[i], Execute(instructions_[i], args, slots,
+                                           events, observer));
+  }
+  return InterpreterResult<Value>{std::move(slots[return_slot_]),
+                                  std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>>
+CompiledFunctionInterpreter::RunWithKwargs(
+    const absl::flat_hash_map<std::string, Value>& args,
+    std::optional<EvaluationObserver*> observer) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
+                       KeywordArgsToPositional(*function_, args));
+  return Run(positional_args, observer);
+}
+
+absl::StatusOr<Value> CompiledFunctionInterpreter::Execute(
+    const Instruction& instruction, absl::Span<const Value> args,
+    absl::Span<const Value> slots, InterpreterEvents& events,
+    std::optional<EvaluationObserver*> observer) const {
+  Node* node = instruction.node;
+  auto operand = [&](int64_t i) -> const Value& {
+    return slots[operand_slots_[instruction.operands_begin + i]];
+  };
+  auto bits = [&](int64_t i) -> const Bits& { return operand(i).bits(); };
+  auto fold = [&](auto op) {
+    Bits result = bits(0);
+    for (int64_t i = 1; i < instruction.operand_count; ++i) {
+      result = op(result, bits(i));
+    }
+    return result;
+  };
+  auto shift_amount = [&]() -> int64_t {
+    return BoundedUint64(bits(1), bits(0).bit_count());
+  };
+
+  std::optional<Value> result;
+  switch (node->op()) {
+    case Op::kParam:
+      result = args[*instruction.param_index];
+      break;
+    case Op::kLiteral:
+      result = node->As<Literal>()->value();
+      break;
+    case Op::kIdentity:
+      result = operand(0);
+      break;
+    case Op::kAdd:
+      result = Value(bits_ops::Add(bits(0), bits(1)));
+      break;
+    case Op::kSub:
+      result = Value(bits_ops::Sub(bits(0), bits(1)));
+      break;
+    case Op::kNeg:
+      result = Value(bits_ops::Negate(bits(0)));
+      break;
+    case Op::kUMul:
+      result = Value(Truncate(bits_ops::UMul(bits(0), bits(1)),
+                              node->BitCountOrDie(), /*is_signed=*/false));
+      break;
+    case Op::kSMul:
+      result = Value(Truncate(bits_ops::SMul(bits(0), bits(1)),
+                              node->BitCountOrDie(), /*is_signed=*/true));
+      break;
+    case Op::kAnd:
+      result = Value(fold(bits_ops::And));
+      break;
+    case Op::kOr:
+      result = Value(fold(bits_ops::Or));
+      break;
+    case Op::kXor:
+      result = Value(fold(bits_ops::Xor));
+      break;
+    case Op::kNand:
+      result = Value(bits_ops::Not(fold(bits_ops::And)));
+      break;
+    case Op::kNor:
+      result = Value(bits_ops::Not(fold(bits_ops::Or)));
+      break;
+    case Op::kNot:
+      result = Value(bits_ops::Not(bits(0)));
+      break;
+    case Op::kShll:
+      result = Value(bits_ops::ShiftLeftLogical(bits(0), shift_amount()));
+      break;
+    case Op::kShrl:
+      result = Value(bits_ops::ShiftRightLogical(bits(0), shift_amount()));
+      break;
+    case Op::kShra:
+      result = Value(bits_ops::ShiftRightArith(bits(0), shift_amount()));
+      break;
+    case Op::kConcat: {
+      std::vector<Bits> inputs;
+      inputs.reserve(instruction.operand_count);
+      for (int64_t i = 0; i < instruction.operand_count; ++i) {
+        inputs.push_back(bits(i));
+      }
+      result = Value(bits_ops::Concat(inputs));
+      break;
+    }
+    case Op::kBitSlice: {
+      BitSlice* slice = node->As<BitSlice>();
+      result = Value(bits(0).Slice(slice->start(), slice->width()));
+      break;
+    }
+    case Op::kZeroExt:
+      result = Value(bits_ops::ZeroExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+      break;
+    case Op::kSignExt:
+      result = Value(bits_ops::SignExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+      break;
+    case Op::kEq:
+      result = Value(UBits(operand(0) == operand(1) ? 1 : 0, 1));
+      break;
+    case Op::kNe:
+      result = Value(UBits(operand(0) != operand(1) ? 1 : 0, 1));
+      break;
+    case Op::kULt:
+      result = Value(UBits(bits_ops::ULessThan(bits(0), bits(1)), 1));
+      break;
+    case Op::kULe:
+      result = Value(UBits(bits_ops::ULessThanOrEqual(bits(0), bits(1)), 1));
+      break;
+    case Op::kUGt:
+      result = Value(UBits(bits_ops::UGreaterThan(bits(0), bits(1)), 1));
+      break;
+    case Op::kUGe:
+      result =
+          Value(UBits(bits_ops::UGreaterThanOrEqual(bits(0), bits(1)), 1));
+      break;
+    case Op::kSLt:
+      result = Value(UBits(bits_ops::SLessThan(bits(0), bits(1)), 1));
+      break;
+    case Op::kSLe:
+      result = Value(UBits(bits_ops::SLessThanOrEqual(bits(0), bits(1)), 1));
+      break;
+    case Op::kSGt:
+      result = Value(UBits(bits_ops::SGreaterThan(bits(0), bits(1)), 1));
+      break;
+    case Op::kSGe:
+      result =
+          Value(UBits(bits_ops::SGreaterThanOrEqual(bits(0), bits(1)), 1));
+      break;
+    case Op::kSel: {
+      // Operand 0 is the selector, followed by the cases and then the default
+      // value, if any.
+      Select* sel = node->As<Select>();
+      int64_t case_count = sel->cases().size();
+      uint64_t selector = BoundedUint64(bits(0), case_count);
+      if (selector >= case_count) {
+        XLS_RET_CHECK(sel->default_value().has_value());
+        result = operand(1 + case_count);
+      } else {
+        result = operand(1 + selector);
+      }
+      break;
+    }
+    case Op::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(instruction.operand_count);
+      for (int64_t i = 0; i < instruction.operand_count; ++i) {
+        elements.push_back(operand(i));
+      }
+      result = Value::TupleOwned(std::move(elements));
+      break;
+    }
+    case Op::kTupleIndex:
+      result = operand(0).elements().at(node->As<TupleIndex>()->index());
+      break;
+    default: {
+      // Evaluate everything else, including operations with side effects and
+      // invocations of other functions, with the tree-walking interpreter. It
+      // records any events and notifies the observer itself.
+      absl::flat_hash_map<Node*, Value> values;
+      for (int64_t i = 0; i < instruction.operand_count; ++i) {
+        values.try_emplace(node->operand(i), operand(i));
+      }
+      IrInterpreter interpreter(&values, &events, observer);
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+      return std::move(values.at(node));
+    }
+  }
+  if (observer.has_value()) {
+    (*observer)->NodeEvaluated(node, *result);
+  }
+  return *std::move(result);
+}
+
 }  // namespace xls
@@ -15,7 +15,11 @@
 #ifndef XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
 #define XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -23,6 +27,7 @@
 #include "xls/interpreter/observer.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
 #include "xls/ir/value.h"
 
 namespace xls {
@@ -40,6 +45,57 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunctionKwargs(
     Function* function, const absl::flat_hash_map<std::string, Value>& args,
     std::optional<EvaluationObserver*> observer = std::nullopt);
 
+// A function prepared for repeated interpretation. Each node is assigned a
+// dense slot in topological order and the nodes are executed from a
+// precomputed instruction array, so evaluating a node reads its operands by
+// index rather than through a hash map. Common operations are evaluated
+// directly; the rest are delegated to IrInterpreter one node at a time.
+//
+// Produces the same results and events as InterpretFunction. Run is const and
+// may be called concurrently.
+class CompiledFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args,
+      std::optional<EvaluationObserver*> observer = std::nullopt) const;
+  absl::StatusOr<InterpreterResult<Value>> RunWithKwargs(
+      const absl::flat_hash_map<std::string, Value>& args,
+      std::optional<EvaluationObserver*> observer = std::nullopt) const;
+
+  Function* function() const { return function_; }
+
+ private:
+  struct Instruction {
+    Node* node;
+    // The slots of the node's operands are
+    // operand_slots_[operands_begin, operands_begin + operand_count).
+    int64_t operands_begin;
+    int64_t operand_count;
+    // For parameters, the index of the argument holding the value.
+    std::optional<int64_t> param_index;
+  };
+
+  explicit CompiledFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  absl::StatusOr<Value> Execute(const Instruction& instruction,
+                                absl::Span<const Value> args,
+                                absl::Span<const Value> slots,
+                                InterpreterEvents& events,
+                                std::optional<EvaluationObserver*> observer)
+      const;
+
+  Function* function_;
+  // One instruction per node; the result of instructions_[i] is stored in
+  // slot i.
+  std::vector<Instruction> instructions_;
+  std::vector<int64_t> operand_slots_;
+  int64_t return_slot_ = 0;
+};
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
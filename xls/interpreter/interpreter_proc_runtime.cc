@@ -42,8 +42,8 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
   for (Proc* proc : queue_manager->elaboration().procs()) {
-    proc_interpreters.push_back(
-        std::make_unique<ProcInterpreter>(proc, queue_manager.get()));
+    proc_interpreters.push_back(std::make_unique<ProcInterpreter>(
+        proc, queue_manager.get(), options.incremental_evaluation()));
   }
 
   // Create a runtime.
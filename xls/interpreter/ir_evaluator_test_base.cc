@@ -21,8 +21,10 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -33,6 +35,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
@@ -1503,6 +1506,93 @@ TEST_P(IrEvaluatorTestBase, InterpretShraBits64) {
   EXPECT_EQ(result.bits(), UBits(0xFF00000000000000ULL, 64));
 }
 
+// Arithmetic wider than 128 bits is lowered word by word by the JIT.
+TEST_P(IrEvaluatorTestBase, WideArithmetic) {
+  std::mt19937_64 rng(0);
+  auto random_bits = [&](int64_t bit_count) {
+    std::vector<uint8_t> bytes(CeilOfRatio(bit_count, int64_t{8}));
+    for (uint8_t& byte : bytes) {
+      byte = rng();
+    }
+    // Make narrow values common to exercise divisors of few words.
+    int64_t significant_bits = 1 + rng() % bit_count;
+    return bits_ops::ZeroExtend(
+        Bits::FromBytes(bytes, bit_count).Slice(0, significant_bits),
+        bit_count);
+  };
+  for (int64_t bit_count : {129, 256, 1000}) {
+    Package package("my_package");
+    std::vector<std::pair<Function*, std::function<Bits(Bits, Bits)>>> ops;
+    auto add_op = [&](std::string_view op,
+                      std::function<Bits(Bits, Bits)> expected) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Function * function,
+          ParseAndGetFunction(
+              &package,
+              absl::StrFormat(R"(
+  fn %1$s_%2$d(a: bits[%2$d], b: bits[%2$d]) -> bits[%2$d] {
+    ret result: bits[%2$d] = %1$s(a, b)
+  }
+  )",
+                              op, bit_count)));
+      ops.push_back({function, std::move(expected)});
+    };
+    add_op("umul", [&](Bits a, Bits b) {
+      return bits_ops::UMul(a, b).Slice(0, bit_count);
+    });
+    add_op("smul", [&](Bits a, Bits b) {
+      return bits_ops::SMul(a, b).Slice(0, bit_count);
+    });
+    add_op("udiv", bits_ops::UDiv);
+    add_op("sdiv", bits_ops::SDiv);
+    add_op("umod", bits_ops::UMod);
+    add_op("smod", bits_ops::SMod);
+    auto shift = [&](std::function<Bits(const Bits&, int64_t)> op,
+                     bool arithmetic) {
+      return [=](Bits a, Bits b) {
+        int64_t amount = bits_ops::ULessThan(b, UBits(bit_count, bit_count))
+                             ? b.ToUint64().value()
+                             : bit_count;
+        if (amount == bit_count) {
+          return arithmetic && a.msb() ? Bits::AllOnes(bit_count)
+                                       : Bits(bit_count);
+        }
+        return op(a, amount);
+      };
+    };
+    add_op("shll", shift(bits_ops::ShiftLeftLogical, false));
+    add_op("shrl", shift(bits_ops::ShiftRightLogical, false));
+    add_op("shra", shift(bits_ops::ShiftRightArith, true));
+
+    for (auto& [function, expected] : ops) {
+      for (int64_t i = 0; i < 64; ++i) {
+        Bits a = random_bits(bit_count);
+        Bits b;
+        switch (i) {
+          case 0:
+            b = Bits(bit_count);
+            break;
+          case 1:
+            b = Bits::AllOnes(bit_count);
+            break;
+          default:
+            b = absl::StartsWith(function->name(), "sh")
+                    ? UBits(rng() % (bit_count + 8), bit_count)
+                    : random_bits(bit_count);
+            break;
+        }
+        if (i == 2) {
+          a = Bits::MinSigned(bit_count);
+        }
+        EXPECT_THAT(RunWithBitsNoEvents(function, {a, b}),
+                    IsOkAndHolds(expected(a, b)))
+            << function->name() << "(" << a.ToDebugString() << ", "
+            << b.ToDebugString() << ")";
+      }
+    }
+  }
+}
+
 TEST_P(IrEvaluatorTestBase, InterpretFourSubOne) {
   Package package("my_package");
   XLS_ASSERT_OK_AND_ASSIGN(Function * function,
@@ -1977,6 +2067,86 @@ TEST_P(IrEvaluatorTestBase, InterpretManyWaySelWithDefault) {
               IsOkAndHolds(u32(0xdefa17)));
 }
 
+TEST_P(IrEvaluatorTestBase, InterpretWideSel) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           ParseAndGetFunction(&package, R"(
+  fn select(p: bits[3], x: bits[8]) -> bits[8] {
+    literal.1: bits[8] = literal(value=10)
+    literal.2: bits[8] = literal(value=11)
+    literal.3: bits[8] = literal(value=12)
+    literal.4: bits[8] = literal(value=13)
+    literal.5: bits[8] = literal(value=14)
+    literal.6: bits[8] = literal(value=15)
+    literal.7: bits[8] = literal(value=16)
+    ret sel.8: bits[8] = sel(p, cases=[literal.1, literal.2, literal.3, literal.4, literal.5, x, literal.6, literal.7])
+  }
+  )"));
+
+  std::vector<int64_t> expected = {10, 11, 12, 13, 14, 0xab, 15, 16};
+  for (int64_t p = 0; p < expected.size(); ++p) {
+    EXPECT_THAT(RunWithNoEvents(function,
+                                {Value(UBits(p, 3)), Value(UBits(0xab, 8))}),
+                IsOkAndHolds(Value(UBits(expected[p], 8))));
+  }
+}
+
+TEST_P(IrEvaluatorTestBase, InterpretWideSelWithDefaultCompoundType) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           ParseAndGetFunction(&package, R"(
+  fn select(p: bits[8], x: (bits[8], bits[8])) -> (bits[8], bits[8]) {
+    literal.1: (bits[8], bits[8]) = literal(value=(0, 0))
+    literal.2: (bits[8], bits[8]) = literal(value=(1, 1))
+    literal.3: (bits[8], bits[8]) = literal(value=(2, 4))
+    literal.4: (bits[8], bits[8]) = literal(value=(3, 9))
+    literal.5: (bits[8], bits[8]) = literal(value=(4, 16))
+    literal.6: (bits[8], bits[8]) = literal(value=(5, 25))
+    literal.7: (bits[8], bits[8]) = literal(value=(6, 36))
+    literal.8: (bits[8], bits[8]) = literal(value=(7, 49))
+    ret sel.9: (bits[8], bits[8]) = sel(p, cases=[literal.1, literal.2, literal.3, literal.4, literal.5, literal.6, literal.7, literal.8], default=x)
+  }
+  )"));
+
+  Value x = Value::Tuple({Value(UBits(0xaa, 8)), Value(UBits(0xbb, 8))});
+  for (int64_t p : {0, 1, 5, 7, 8, 9, 255}) {
+    Value expected =
+        p < 8 ? Value::Tuple({Value(UBits(p, 8)), Value(UBits(p * p, 8))})
+              : x;
+    EXPECT_THAT(RunWithNoEvents(function, {Value(UBits(p, 8)), x}),
+                IsOkAndHolds(expected));
+  }
+}
+
+TEST_P(IrEvaluatorTestBase, InterpretWidePrioritySelect) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           ParseAndGetFunction(&package, R"(
+  fn priority_select(p: bits[9], d: bits[8]) -> bits[8] {
+    literal.1: bits[8] = literal(value=10)
+    literal.2: bits[8] = literal(value=11)
+    literal.3: bits[8] = literal(value=12)
+    literal.4: bits[8] = literal(value=13)
+    literal.5: bits[8] = literal(value=14)
+    literal.6: bits[8] = literal(value=15)
+    literal.7: bits[8] = literal(value=16)
+    literal.8: bits[8] = literal(value=17)
+    literal.9: bits[8] = literal(value=18)
+    ret priority_sel.10: bits[8] = priority_sel(p, cases=[literal.1, literal.2, literal.3, literal.4, literal.5, literal.6, literal.7, literal.8, literal.9], default=d)
+  }
+  )"));
+
+  Value d(UBits(0xdd, 8));
+  EXPECT_THAT(RunWithNoEvents(function, {Value(UBits(0, 9)), d}),
+              IsOkAndHolds(d));
+  for (int64_t i = 0; i < 9; ++i) {
+    EXPECT_THAT(RunWithNoEvents(function, {Value(UBits(1 << i, 9)), d}),
+                IsOkAndHolds(Value(UBits(10 + i, 8))));
+  }
+  EXPECT_THAT(RunWithNoEvents(function, {Value(UBits(0b110100, 9)), d}),
+              IsOkAndHolds(Value(UBits(12, 8))));
+}
+
 TEST_P(IrEvaluatorTestBase, InterpretMap) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
                            Parser::ParsePackage(R"(
@@ -2483,6 +2653,34 @@ TEST_P(IrEvaluatorTestBase, InterpretArrayIndex) {
   EXPECT_THAT(RunWithNoEvents(function, /*args=*/{}),
               IsOkAndHolds(Value(UBits(123, 32))));
 }
+
+TEST_P(IrEvaluatorTestBase, InterpretArrayIndexLookupTable) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           ParseAndGetFunction(&package, R"(
+  fn lookup(i: bits[2], j: bits[3], k: bits[32]) -> (bits[8], bits[8], bits[8]) {
+    table: bits[8][5] = literal(value=[10, 20, 30, 40, 50])
+    array_index.1: bits[8] = array_index(table, indices=[i])
+    array_index.2: bits[8] = array_index(table, indices=[j])
+    array_index.3: bits[8] = array_index(table, indices=[k])
+    ret tuple.4: (bits[8], bits[8], bits[8]) = tuple(array_index.1, array_index.2, array_index.3)
+  }
+  )"));
+
+  std::vector<int64_t> table = {10, 20, 30, 40, 50};
+  for (int64_t i : {0, 1, 3, 4, 5, 7, 1000}) {
+    int64_t j = std::min<int64_t>(i % 8, 4);
+    int64_t k = std::min<int64_t>(i, 4);
+    Value expected = Value::Tuple({Value(UBits(table[i % 4], 8)),
+                                   Value(UBits(table[j], 8)),
+                                   Value(UBits(table[k], 8))});
+    EXPECT_THAT(RunWithNoEvents(function,
+                                {Value(UBits(i % 4, 2)), Value(UBits(i % 8, 3)),
+                                 Value(UBits(i, 32))}),
+                IsOkAndHolds(expected));
+  }
+}
+
 TEST_P(IrEvaluatorTestBase, InterpretArraySlice) {
   Package package("my_package");
   XLS_ASSERT_OK_AND_ASSIGN(Function * function,
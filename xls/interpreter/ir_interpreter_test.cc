@@ -14,15 +14,20 @@
 
 #include "xls/interpreter/ir_interpreter.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/observer.h"
@@ -60,10 +65,54 @@ INSTANTIATE_TEST_SUITE_P(
         },
         true)));
 
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->Run(args, obs);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->RunWithKwargs(kwargs, obs);
+        },
+        true)));
+
 // Fixture for IrInterpreter-only tests (i.e., those that aren't common to all
 // IR evaluators).
 class IrInterpreterOnlyTest : public IrTestBase {};
 
+TEST_F(IrInterpreterOnlyTest, CompiledInterpreterIsReusable) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.Tuple({fb.Add(x, y), fb.ULt(x, y), fb.Shll(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+      CompiledFunctionInterpreter::Create(f));
+  for (int64_t a = 0; a < 256; a += 17) {
+    for (int64_t b = 0; b < 256; b += 5) {
+      std::vector<Value> args = {Value(UBits(a, 8)), Value(UBits(b, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(f, args));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                               interpreter->Run(args));
+      EXPECT_EQ(actual.value, expected.value);
+    }
+  }
+}
+
 TEST_F(IrInterpreterOnlyTest, EvaluateNode) {
   Package package("my_package");
   std::string fn_text = R"(
@@ -0,0 +1,267 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+namespace {
+
+// Shared scheduling state for a single network tick.
+class TickScheduler {
+ public:
+  TickScheduler(ChannelQueueManager& queue_manager, int64_t worker_count)
+      : queue_manager_(queue_manager), ready_(worker_count) {}
+
+  // Seeds the ready list of the workers round-robin.
+  void AddInitial(absl::Span<ProcInstance* const> instances) {
+    absl::MutexLock lock(&mutex_);
+    for (int64_t i = 0; i < instances.size(); ++i) {
+      ready_[i % ready_.size()].push_back(instances[i]);
+      ++ready_count_;
+    }
+  }
+
+  // Blocks until there is work for `worker` or the tick is complete. Returns
+  // std::nullopt if the tick is complete.
+  std::optional<ProcInstance*> Next(int64_t worker) {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &TickScheduler::HasWorkOrIsDone));
+    if (ready_count_ == 0 || !status_.ok()) {
+      return std::nullopt;
+    }
+    ProcInstance* instance;
+    if (!ready_[worker].empty()) {
+      instance = ready_[worker].front();
+      ready_[worker].pop_front();
+    } else {
+      // Steal from the back of the longest ready list.
+      int64_t victim = 0;
+      for (int64_t i = 1; i < ready_.size(); ++i) {
+        if (ready_[i].size() > ready_[victim].size()) {
+          victim = i;
+        }
+      }
+      instance = ready_[victim].back();
+      ready_[victim].pop_back();
+    }
+    --ready_count_;
+    ++active_count_;
+    return instance;
+  }
+
+  // Records the result of ticking `instance` on `worker`.
+  void Finish(int64_t worker, ProcInstance* instance, bool has_io,
+              const absl::StatusOr<TickResult>& tick_result) {
+    absl::MutexLock lock(&mutex_);
+    --active_count_;
+    if (!tick_result.ok()) {
+      status_.Update(tick_result.status());
+      return;
+    }
+    progress_made_ |= tick_result->progress_made;
+    progress_made_on_io_procs_ |= tick_result->progress_made && has_io;
+    if (tick_result->execution_state == TickExecutionState::kSentOnChannel) {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      auto it = blocked_instances_.find(channel_instance);
+      if (it != blocked_instances_.end()) {
+        VLOG(3) << absl::StreamFormat(
+            "Unblocking proc instance `%s` and adding to ready list",
+            it->second->GetName());
+        ready_[worker].push_back(it->second);
+        ++ready_count_;
+        blocked_instances_.erase(it);
+      }
+      ready_[worker].push_back(instance);
+      ++ready_count_;
+    } else if (tick_result->execution_state ==
+               TickExecutionState::kBlockedOnReceive) {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      // Another worker may have sent on the channel after the receive was
+      // attempted but before the lock was taken. In that case the send did
+      // not observe this instance as blocked so it must be readied here.
+      if (!queue_manager_.GetQueue(channel_instance).IsEmpty()) {
+        ready_[worker].push_back(instance);
+        ++ready_count_;
+      } else {
+        VLOG(3) << absl::StreamFormat(
+            "Proc instance `%s` is now blocked on channel instance `%s`",
+            instance->GetName(), channel_instance->ToString());
+        blocked_instances_[channel_instance] = instance;
+      }
+    }
+  }
+
+  absl::Status status() const {
+    absl::MutexLock lock(&mutex_);
+    return status_;
+  }
+  bool progress_made() const {
+    absl::MutexLock lock(&mutex_);
+    return progress_made_;
+  }
+  bool progress_made_on_io_procs() const {
+    absl::MutexLock lock(&mutex_);
+    return progress_made_on_io_procs_;
+  }
+  bool IsBlocked(ChannelInstance* channel_instance) const {
+    absl::MutexLock lock(&mutex_);
+    return blocked_instances_.contains(channel_instance);
+  }
+
+ private:
+  bool HasWorkOrIsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return ready_count_ > 0 || active_count_ == 0 || !status_.ok();
+  }
+
+  ChannelQueueManager& queue_manager_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::deque<ProcInstance*>> ready_ ABSL_GUARDED_BY(mutex_);
+  // Total number of elements in all of the ready lists.
+  int64_t ready_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of proc instances currently being ticked.
+  int64_t active_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Map containing any blocked proc instances and the channels they are
+  // blocked on.
+  absl::flat_hash_map<ChannelInstance*, ProcInstance*> blocked_instances_
+      ABSL_GUARDED_BY(mutex_);
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_on_io_procs_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options,
+    const ParallelProcRuntimeOptions& parallel_options) {
+  XLS_RET_CHECK_GE(parallel_options.thread_count, 0);
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  XLS_ASSIGN_OR_RETURN(std::vector<ProcInstance*> tick_order,
+                       GetTickOrder(queue_manager->elaboration(), options));
+  int64_t thread_count = parallel_options.thread_count == 0
+                             ? std::max(AvailableCPUs(), 1)
+                             : parallel_options.thread_count;
+  return absl::WrapUnique(new ParallelProcRuntime(
+      std::move(evaluator_map), std::move(queue_manager),
+      std::move(tick_order), options, thread_count,
+      parallel_options.deterministic));
+}
+
+absl::StatusOr<ProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                package()->name());
+  // A single worker ticking its own ready list in FIFO order, seeded in the
+  // same tick order, matches the scheduling of SerialProcRuntime exactly.
+  int64_t worker_count =
+      (deterministic_ || observer_.has_value())
+          ? 1
+          : std::min<int64_t>(thread_count_,
+                              std::max<int64_t>(tick_order_.size(), 1));
+  TickScheduler scheduler(*queue_manager_, worker_count);
+  scheduler.AddInitial(tick_order_);
+
+  auto worker_body = [&](int64_t worker) {
+    while (std::optional<ProcInstance*> instance = scheduler.Next(worker)) {
+      ProcEvaluator* evaluator = evaluators_.at((*instance)->proc()).get();
+      VLOG(3) << absl::StreamFormat("Ticking proc instance `%s` on worker %d",
+                                    (*instance)->GetName(), worker);
+      absl::StatusOr<TickResult> tick_result =
+          evaluator->Tick(*continuations_.at(*instance));
+      if (tick_result.ok()) {
+        absl::Status events_status =
+            InterpreterEventsToStatus(GetInterpreterEvents(*instance));
+        if (!events_status.ok()) {
+          tick_result = events_status;
+        }
+      }
+      scheduler.Finish(worker, *instance, evaluator->ProcHasIoOperations(),
+                       tick_result);
+    }
+  };
+
+  if (worker_count == 1) {
+    worker_body(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(worker_count - 1);
+    for (int64_t i = 1; i < worker_count; ++i) {
+      threads.push_back(
+          std::make_unique<Thread>([&worker_body, i]() { worker_body(i); }));
+    }
+    worker_body(0);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  XLS_RETURN_IF_ERROR(scheduler.status());
+
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (scheduler.IsBlocked(instance)) {
+      blocked_channel_instances.push_back(instance);
+    }
+  }
+  return NetworkTickResult{
+      .progress_made = scheduler.progress_made(),
+      .progress_made_on_io_procs = scheduler.progress_made_on_io_procs(),
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,94 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+struct ParallelProcRuntimeOptions {
+  // Number of worker threads used to tick proc instances. A value of zero
+  // means use the number of available CPUs.
+  int64_t thread_count = 0;
+
+  // If true, proc instances are ticked one at a time in exactly the order
+  // SerialProcRuntime would tick them. This produces identical channel traces
+  // and events to SerialProcRuntime and is intended for regression diffing.
+  bool deterministic = false;
+};
+
+// Class for evaluating a network of procs using a pool of worker threads. Each
+// worker owns a ready list of proc instances; workers which run out of work
+// steal from the back of other workers' ready lists. Proc instances blocked on
+// a receive are parked until a send on the corresponding channel instance
+// wakes them up rather than being polled.
+//
+// The channel queues in the queue manager must be thread-safe (e.g., created
+// with JitChannelQueueManager::CreateThreadSafe). If an observer is attached
+// the network is ticked on a single thread as observers are not thread-safe.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options = EvaluatorOptions(),
+      const ParallelProcRuntimeOptions& parallel_options =
+          ParallelProcRuntimeOptions());
+
+  int64_t thread_count() const { return thread_count_; }
+  bool deterministic() const { return deterministic_; }
+
+  // The order in which proc instances are placed on the ready lists at the
+  // start of each network tick. This is the elaboration order unless the
+  // runtime was created with `EvaluatorOptions::dataflow_tick_order` set. In
+  // deterministic mode it is also the order of the first ticks, as for
+  // SerialProcRuntime.
+  absl::Span<ProcInstance* const> tick_order() const { return tick_order_; }
+
+ private:
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::vector<ProcInstance*> tick_order, const EvaluatorOptions& options,
+      int64_t thread_count, bool deterministic)
+      : ProcRuntime(std::move(evaluators), std::move(queue_manager), options),
+        tick_order_(std::move(tick_order)),
+        thread_count_(thread_count),
+        deterministic_(deterministic) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  std::vector<ProcInstance*> tick_order_;
+  int64_t thread_count_;
+  bool deterministic_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
@@ -0,0 +1,231 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class ParallelProcRuntimeTest : public IrTestBase {};
+
+std::vector<std::string> TraceMessages(ProcRuntime* runtime) {
+  std::vector<std::string> messages;
+  for (const TraceMessage& message : runtime->GetGlobalEvents().trace_msgs) {
+    messages.push_back(message.message);
+  }
+  return messages;
+}
+
+// Builds a chain of pass-through procs: in -> p0 -> p1 -> ... -> out. With
+// `reverse_stage_order` the stages are added to the package last to first, so
+// the elaboration order is the reverse of the dataflow order.
+absl::StatusOr<std::pair<Channel*, Channel*>> BuildPipeline(
+    int64_t stages, Package* package, bool reverse_stage_order = false) {
+  std::vector<Channel*> channels;
+  XLS_ASSIGN_OR_RETURN(
+      Channel * in, package->CreateStreamingChannel("in",
+                                                    ChannelOps::kReceiveOnly,
+                                                    package->GetBitsType(32)));
+  channels.push_back(in);
+  for (int64_t i = 0; i < stages; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Channel * next,
+        package->CreateStreamingChannel(
+            i == stages - 1 ? "out" : absl::StrFormat("c%d", i),
+            i == stages - 1 ? ChannelOps::kSendOnly : ChannelOps::kSendReceive,
+            package->GetBitsType(32)));
+    channels.push_back(next);
+  }
+  for (int64_t j = 0; j < stages; ++j) {
+    int64_t i = reverse_stage_order ? stages - 1 - j : j;
+    TokenlessProcBuilder pb(absl::StrFormat("stage%d", i), "tkn", package);
+    pb.Send(channels[i + 1],
+            pb.Add(pb.Receive(channels[i]), pb.Literal(UBits(1, 32))));
+    XLS_RETURN_IF_ERROR(pb.Build({}).status());
+  }
+  return std::make_pair(in, channels.back());
+}
+
+TEST_F(ParallelProcRuntimeTest, DeterministicModeMatchesSerialTrace) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto channels, BuildPipeline(8, package.get()));
+  auto [in, out] = channels;
+
+  EvaluatorOptions options = EvaluatorOptions().set_trace_channels(true);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> serial,
+                           CreateJitSerialProcRuntime(package.get(), options));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcRuntime> parallel,
+      CreateJitParallelProcRuntime(
+          package.get(), options,
+          ParallelProcRuntimeOptions{.thread_count = 4,
+                                     .deterministic = true}));
+  for (ProcRuntime* runtime : {serial.get(), parallel.get()}) {
+    for (int64_t i = 0; i < 16; ++i) {
+      XLS_ASSERT_OK(
+          runtime->queue_manager().GetQueue(in).Write(Value(UBits(i, 32))));
+    }
+    XLS_ASSERT_OK(runtime->TickUntilOutput({{out, 16}}).status());
+  }
+  EXPECT_THAT(TraceMessages(parallel.get()),
+              ElementsAreArray(TraceMessages(serial.get())));
+}
+
+TEST_F(ParallelProcRuntimeTest, DataflowTickOrderMatchesSerialTrace) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto channels,
+      BuildPipeline(8, package.get(), /*reverse_stage_order=*/true));
+  auto [in, out] = channels;
+
+  EvaluatorOptions options =
+      EvaluatorOptions().set_trace_channels(true).set_dataflow_tick_order(true);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> serial,
+                           CreateJitSerialProcRuntime(package.get(), options));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ParallelProcRuntime> parallel,
+      CreateJitParallelProcRuntime(
+          package.get(), options,
+          ParallelProcRuntimeOptions{.thread_count = 4,
+                                     .deterministic = true}));
+  EXPECT_EQ(parallel->tick_order().front()->proc()->name(), "stage0");
+  EXPECT_THAT(parallel->tick_order(), ElementsAreArray(serial->tick_order()));
+  for (ProcRuntime* runtime :
+       std::vector<ProcRuntime*>{serial.get(), parallel.get()}) {
+    for (int64_t i = 0; i < 16; ++i) {
+      XLS_ASSERT_OK(
+          runtime->queue_manager().GetQueue(in).Write(Value(UBits(i, 32))));
+    }
+    XLS_ASSERT_OK(runtime->TickUntilOutput({{out, 16}}).status());
+  }
+  EXPECT_THAT(TraceMessages(parallel.get()),
+              ElementsAreArray(TraceMessages(serial.get())));
+}
+
+TEST_F(ParallelProcRuntimeTest, ManyThreadsProduceSerialOutputs) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto channels, BuildPipeline(32, package.get()));
+  auto [in, out] = channels;
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ParallelProcRuntime> runtime,
+      CreateJitParallelProcRuntime(
+          package.get(), EvaluatorOptions(),
+          ParallelProcRuntimeOptions{.thread_count = 8}));
+  EXPECT_EQ(runtime->thread_count(), 8);
+  constexpr int64_t kCount = 100;
+  for (int64_t i = 0; i < kCount; ++i) {
+    XLS_ASSERT_OK(
+        runtime->queue_manager().GetQueue(in).Write(Value(UBits(i, 32))));
+  }
+  XLS_ASSERT_OK(runtime->TickUntilOutput({{out, kCount}}).status());
+  ChannelQueue& out_queue = runtime->queue_manager().GetQueue(out);
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(out_queue.Read(), Value(UBits(i + 32, 32)));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "parallel_jit",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         package, options,
+                         ParallelProcRuntimeOptions{.thread_count = 4})
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         top, options,
+                         ParallelProcRuntimeOptions{.thread_count = 4})
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "deterministic_parallel_jit",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         package, options,
+                         ParallelProcRuntimeOptions{.deterministic = true})
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         top, options,
+                         ParallelProcRuntimeOptions{.deterministic = true})
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "deterministic_parallel_jit_dataflow_tick_order",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_dataflow_tick_order(
+                             true),
+                         ParallelProcRuntimeOptions{.deterministic = true})
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_dataflow_tick_order(
+                             true),
+                         ParallelProcRuntimeOptions{.deterministic = true})
+                  .value();
+            },
+            /*supports_observers=*/true)),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
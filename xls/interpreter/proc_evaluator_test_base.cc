@@ -1063,6 +1063,81 @@ TEST_P(ProcEvaluatorTestBase, MultiStateElementProc) {
               ElementsAre(Value(UBits(31, 32)), Value(UBits(69, 32))));
 }
 
+TEST_P(ProcEvaluatorTestBase, ArrayStateUpdateProc) {
+  auto package = CreatePackage();
+
+  // Proc has two state elements:
+  //  arr: array updated at elements idx and idx + 1 each tick
+  //  idx: counter starting at 0
+  ProcBuilder pb("array_state", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros, Value::UBitsArray({0, 0, 0, 0}, 32));
+  BValue arr = pb.StateElement("arr", zeros);
+  BValue idx = pb.StateElement("idx", Value(UBits(0, 32)));
+  BValue next_idx = pb.Add(idx, pb.Literal(UBits(1, 32)));
+  BValue incremented =
+      pb.Add(pb.ArrayIndex(arr, {idx}), pb.Literal(UBits(1, 32)));
+  BValue updated = pb.ArrayUpdate(arr, incremented, {idx});
+  updated = pb.ArrayUpdate(updated, pb.Add(idx, pb.Literal(UBits(10, 32))),
+                           {next_idx});
+  pb.Next(/*param=*/arr, /*value=*/updated);
+  pb.Next(/*param=*/idx, /*value=*/next_idx);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      GetParam().CreateQueueManager(package.get());
+  std::unique_ptr<ProcEvaluator> evaluator =
+      GetParam().CreateEvaluator(proc, queue_manager.get());
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+
+  for (const auto& expected : std::vector<std::vector<uint64_t>>{
+           {1, 10, 0, 0}, {1, 11, 11, 0}, {1, 11, 12, 12}, {1, 11, 12, 13}}) {
+    EXPECT_THAT(evaluator->Tick(*continuation),
+                IsOkAndHolds(TickResult{
+                    .execution_state = TickExecutionState::kCompleted,
+                    .channel_instance = std::nullopt,
+                    .progress_made = true}));
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected_arr,
+                             Value::UBitsArray(expected, 32));
+    EXPECT_EQ(continuation->GetState().front(), expected_arr);
+  }
+}
+
+TEST_P(ProcEvaluatorTestBase, ConditionalArrayStateUpdateProc) {
+  auto package = CreatePackage();
+
+  // Proc sets element idx of its array state to idx on odd ticks only.
+  ProcBuilder pb("conditional_array_state", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros, Value::UBitsArray({0, 0, 0, 0}, 32));
+  BValue arr = pb.StateElement("arr", zeros);
+  BValue idx = pb.StateElement("idx", Value(UBits(0, 32)));
+  BValue odd_iteration = pb.Eq(pb.BitSlice(idx, /*start=*/0, /*width=*/1),
+                               pb.Literal(UBits(1, 1)));
+  pb.Next(/*param=*/arr, /*value=*/pb.ArrayUpdate(arr, idx, {idx}),
+          /*pred=*/odd_iteration);
+  pb.Next(/*param=*/idx, /*value=*/pb.Add(idx, pb.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      GetParam().CreateQueueManager(package.get());
+  std::unique_ptr<ProcEvaluator> evaluator =
+      GetParam().CreateEvaluator(proc, queue_manager.get());
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+
+  for (const auto& expected : std::vector<std::vector<uint64_t>>{
+           {0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 3}}) {
+    EXPECT_THAT(evaluator->Tick(*continuation),
+                IsOkAndHolds(TickResult{
+                    .execution_state = TickExecutionState::kCompleted,
+                    .channel_instance = std::nullopt,
+                    .progress_made = true}));
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected_arr,
+                             Value::UBitsArray(expected, 32));
+    EXPECT_EQ(continuation->GetState().front(), expected_arr);
+  }
+}
+
 TEST_P(ProcEvaluatorTestBase, NonBlockingReceives) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
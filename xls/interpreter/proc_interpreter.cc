@@ -18,8 +18,12 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -33,6 +37,7 @@
 #include "xls/ir/events.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/topo_sort.h"
@@ -47,8 +52,10 @@ class ProcInterpreterContinuation : public ProcContinuation {
  public:
   // Construct a new continuation. Execution the proc begins with the state set
   // to its initial values with no proc nodes yet executed.
-  explicit ProcInterpreterContinuation(ProcInstance* proc_instance)
+  ProcInterpreterContinuation(ProcInstance* proc_instance,
+                              bool incremental_evaluation)
       : ProcContinuation(proc_instance),
+        incremental_evaluation_(incremental_evaluation),
         node_index_(0),
         state_(proc()->InitValues().begin(), proc()->InitValues().end()) {}
 
@@ -81,9 +88,42 @@ class ProcInterpreterContinuation : public ProcContinuation {
   void NextTick(std::vector<Value>&& next_state) {
     node_index_ = 0;
     state_ = next_state;
+    if (incremental_evaluation_) {
+      previous_node_values_ = std::move(node_values_);
+      changed_nodes_.clear();
+    }
     node_values_.clear();
   }
 
+  bool incremental_evaluation() const { return incremental_evaluation_; }
+
+  // Returns true if `node` was evaluated in the previous tick and none of its
+  // operands have changed in this tick.
+  bool CanReusePreviousValue(Node* node) const {
+    return previous_node_values_.contains(node) &&
+           absl::c_none_of(node->operands(), [&](Node* operand) {
+             return changed_nodes_.contains(operand);
+           });
+  }
+
+  // Removes and returns the value `node` had in the previous tick.
+  Value TakePreviousValue(Node* node) {
+    auto it = previous_node_values_.find(node);
+    Value value = std::move(it->second);
+    previous_node_values_.erase(it);
+    return value;
+  }
+
+  // Records `node` as changed if its value in this tick differs from its
+  // value in the previous tick.
+  void RecordChange(Node* node) {
+    auto it = previous_node_values_.find(node);
+    if (it == previous_node_values_.end() ||
+        it->second != node_values_.at(node)) {
+      changed_nodes_.insert(node);
+    }
+  }
+
   // Gets/sets the index of the node to be executed next. This index refers to a
   // place in a topological sort of the proc nodes held by the ProcInterpreter.
   int64_t GetNodeExecutionIndex() const { return node_index_; }
@@ -96,12 +136,18 @@ class ProcInterpreterContinuation : public ProcContinuation {
   }
 
  private:
+  bool incremental_evaluation_;
   int64_t node_index_;
   std::vector<Value> state_;
 
   InterpreterEvents events_;
   absl::flat_hash_map<Node*, Value> node_values_;
   absl::flat_hash_map<Param*, std::vector<Next*>> active_next_values_;
+
+  // Node values of the last completed tick and the nodes whose values differ
+  // from them in this tick. Only used for incremental evaluation.
+  absl::flat_hash_map<Node*, Value> previous_node_values_;
+  absl::flat_hash_set<Node*> changed_nodes_;
 };
 
 // A visitor for interpreting procs. Adds handlers for send and receive
@@ -222,8 +268,7 @@ class ProcIrInterpreter : public IrInterpreter {
     if (proc_instance_->path().has_value()) {
       // New-style proc-scoped channel.
       XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
-                           queue_manager_->elaboration().GetChannelInstance(
-                               name, *proc_instance_->path()));
+                           proc_instance_->GetChannelInstance(name));
       return &queue_manager_->GetQueue(channel_instance);
     }
     // Old-style global channel.
@@ -242,16 +287,37 @@ class ProcIrInterpreter : public IrInterpreter {
   std::optional<ChannelInstance*> sent_channel_instance_;
 };
 
+// Returns true if the value of `node` is determined by its operand values
+// alone, so it may be reused across ticks when its operands are unchanged.
+bool IsReusableAcrossTicks(Node* node) {
+  if (OpIsSideEffecting(node->op())) {
+    return false;
+  }
+  // Params carry the proc state, next values record the state update, and the
+  // invoked functions may produce events.
+  return !(node->Is<Param>() || node->Is<Next>() || node->Is<Invoke>() ||
+           node->Is<Map>() || node->Is<CountedFor>() ||
+           node->Is<DynamicCountedFor>());
+}
+
 }  // namespace
 
-ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
+ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                                 bool incremental_evaluation)
     : ProcEvaluator(proc),
       queue_manager_(queue_manager),
-      execution_order_(TopoSort(proc)) {}
+      incremental_evaluation_(incremental_evaluation),
+      execution_order_(TopoSort(proc)) {
+  reusable_.reserve(execution_order_.size());
+  for (Node* node : execution_order_) {
+    reusable_.push_back(IsReusableAcrossTicks(node));
+  }
+}
 
 std::unique_ptr<ProcContinuation> ProcInterpreter::NewContinuation(
     ProcInstance* proc_instance) const {
-  return std::make_unique<ProcInterpreterContinuation>(proc_instance);
+  return std::make_unique<ProcInterpreterContinuation>(proc_instance,
+                                                       incremental_evaluation_);
 }
 
 absl::StatusOr<TickResult> ProcInterpreter::Tick(
@@ -271,8 +337,18 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
   int64_t starting_index = cont->GetNodeExecutionIndex();
   for (int64_t i = starting_index; i < execution_order_.size(); ++i) {
     Node* node = execution_order_[i];
+    if (cont->incremental_evaluation()) {
+      if (reusable_[i] && cont->CanReusePreviousValue(node)) {
+        XLS_RETURN_IF_ERROR(
+            ir_interpreter.SetValueResult(node, cont->TakePreviousValue(node)));
+        continue;
+      }
+    }
     XLS_ASSIGN_OR_RETURN(ProcIrInterpreter::NodeResult result,
                          ir_interpreter.ExecuteNode(node));
+    if (cont->incremental_evaluation() && ir_interpreter.HasResult(node)) {
+      cont->RecordChange(node);
+    }
     if (result.sent_channel_instance.has_value()) {
       // Early exit: proc sent on a channel. Execution should resume _after_ the
       // send.
@@ -30,9 +30,18 @@ namespace xls {
 // A interpreter for an individual proc. Incrementally executes Procs a single
 // tick at a time. Data is fed to the proc via ChannelQueues.  ProcInterpreters
 // are thread-safe if called with different continuations.
+//
+// With `incremental_evaluation` set, each continuation keeps the node values
+// of the last completed tick and tracks which nodes changed in the current
+// tick. Side-effect free nodes none of whose operands changed reuse their
+// previous value instead of being re-evaluated, so only the fanout cones of
+// changed state elements and received values are recomputed. Nodes with side
+// effects (sends, receives, asserts, traces, ...), state params, next values
+// and nodes which call other functions are always evaluated.
 class ProcInterpreter : public ProcEvaluator {
  public:
-  ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager);
+  ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                  bool incremental_evaluation = false);
   ProcInterpreter(const ProcInterpreter&) = delete;
   ProcInterpreter operator=(const ProcInterpreter&) = delete;
 
@@ -45,10 +54,15 @@ class ProcInterpreter : public ProcEvaluator {
 
  private:
   ChannelQueueManager* queue_manager_;
+  bool incremental_evaluation_;
 
   // A topological sort of the nodes of the proc which determines the execution
   // order of the proc.
   std::vector<Node*> execution_order_;
+
+  // Whether the node at the same index of `execution_order_` may reuse its
+  // value from the previous tick during incremental evaluation.
+  std::vector<bool> reusable_;
 };
 
 }  // namespace xls
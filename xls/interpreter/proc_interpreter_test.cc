@@ -38,5 +38,17 @@ INSTANTIATE_TEST_SUITE_P(
           return ChannelQueueManager::Create(package).value();
         })));
 
+INSTANTIATE_TEST_SUITE_P(
+    IncrementalProcInterpreterTest, ProcEvaluatorTestBase,
+    testing::Values(ProcEvaluatorTestParam(
+        [](Proc* proc, ChannelQueueManager* queue_manager)
+            -> std::unique_ptr<ProcEvaluator> {
+          return std::make_unique<ProcInterpreter>(
+              proc, queue_manager, /*incremental_evaluation=*/true);
+        },
+        [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
+          return ChannelQueueManager::Create(package).value();
+        })));
+
 }  // namespace
 }  // namespace xls
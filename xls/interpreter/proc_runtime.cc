@@ -15,13 +15,16 @@
 #include "xls/interpreter/proc_runtime.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -30,21 +33,115 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/channel_trace.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
+#include "xls/ir/xls_value.pb.h"
 #include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
+namespace {
+
+// Returns the proc instances of the elaboration ordered so that, as far as the
+// channels between them allow, the senders on each channel come before its
+// receivers. Where the channels form a cycle, the earliest proc instance in
+// elaboration order which remains is placed next.
+absl::StatusOr<std::vector<ProcInstance*>> DataflowTickOrder(
+    const ProcElaboration& elaboration) {
+  absl::Span<ProcInstance* const> instances = elaboration.proc_instances();
+  absl::flat_hash_map<ProcInstance*, int64_t> index;
+  for (int64_t i = 0; i < instances.size(); ++i) {
+    index[instances[i]] = i;
+  }
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<int64_t>> senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<int64_t>>
+      receivers;
+  for (ProcInstance* instance : instances) {
+    for (Node* node : instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ChannelRef channel_ref,
+                           GetChannelRefUsedByNode(node));
+      ChannelInstance* channel_instance =
+          instance->GetChannelBinding(channel_ref).instance;
+      if (node->Is<Send>()) {
+        senders[channel_instance].insert(index.at(instance));
+      } else {
+        receivers[channel_instance].insert(index.at(instance));
+      }
+    }
+  }
+  std::vector<absl::flat_hash_set<int64_t>> successors(instances.size());
+  for (const auto& [channel_instance, sending] : senders) {
+    auto it = receivers.find(channel_instance);
+    if (it == receivers.end()) {
+      continue;
+    }
+    for (int64_t sender : sending) {
+      for (int64_t receiver : it->second) {
+        if (sender != receiver) {
+          successors[sender].insert(receiver);
+        }
+      }
+    }
+  }
+  std::vector<int64_t> predecessor_count(instances.size(), 0);
+  for (const absl::flat_hash_set<int64_t>& succs : successors) {
+    for (int64_t succ : succs) {
+      ++predecessor_count[succ];
+    }
+  }
+  std::set<int64_t> ready;
+  std::set<int64_t> remaining;
+  for (int64_t i = 0; i < instances.size(); ++i) {
+    remaining.insert(i);
+    if (predecessor_count[i] == 0) {
+      ready.insert(i);
+    }
+  }
+  std::vector<ProcInstance*> order;
+  order.reserve(instances.size());
+  while (!remaining.empty()) {
+    // Break cycles by taking the earliest remaining instance.
+    int64_t next = ready.empty() ? *remaining.begin() : *ready.begin();
+    ready.erase(next);
+    remaining.erase(next);
+    order.push_back(instances[next]);
+    for (int64_t succ : successors[next]) {
+      if (--predecessor_count[succ] == 0 && remaining.contains(succ)) {
+        ready.insert(succ);
+      }
+    }
+  }
+  return order;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<ProcInstance*>> GetTickOrder(
+    const ProcElaboration& elaboration, const EvaluatorOptions& options) {
+  if (options.dataflow_tick_order()) {
+    return DataflowTickOrder(elaboration);
+  }
+  return std::vector<ProcInstance*>(elaboration.proc_instances().begin(),
+                                    elaboration.proc_instances().end());
+}
 
 // Functor for recording channel activity as trace messages.
 class ChannelTraceRecorder : public ChannelQueueCallback {
@@ -76,6 +173,32 @@ class ChannelTraceRecorder : public ChannelQueueCallback {
   FormatPreference format_preference_;
 };
 
+// Functor for recording channel activity to a binary channel trace.
+class BinaryChannelTraceRecorder : public ChannelQueueCallback {
+ public:
+  BinaryChannelTraceRecorder(ProcRuntime* runtime, ChannelTraceWriter* writer,
+                             int64_t channel_index)
+      : runtime_(runtime), writer_(writer), channel_index_(channel_index) {}
+  ~BinaryChannelTraceRecorder() override = default;
+
+  void ReadValue(ChannelInstance* channel_instance,
+                 const Value& value) override {
+    writer_->Record(runtime_->tick_count_, channel_index_,
+                    ChannelTraceOp::kRead, value);
+  }
+
+  void WriteValue(ChannelInstance* channel_instance,
+                  const Value& value) override {
+    writer_->Record(runtime_->tick_count_, channel_index_,
+                    ChannelTraceOp::kWrite, value);
+  }
+
+ private:
+  ProcRuntime* runtime_;
+  ChannelTraceWriter* writer_;
+  int64_t channel_index_;
+};
+
 void ProcRuntime::ClearObserver() {
   if (!observer_) {
     return;
@@ -124,6 +247,7 @@ ProcRuntime::ProcRuntime(
 absl::Status ProcRuntime::Tick() {
   std::vector<Channel*> blocked_channels;
   XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  ++tick_count_;
   if (!result.progress_made) {
     // Not a single instruction executed on any proc. This is necessarily a
     // deadlock.
@@ -214,6 +338,7 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
     XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    ++tick_count_;
     if (!result.progress_made_on_io_procs) {
       return ticks;
     }
@@ -235,6 +360,106 @@ void ProcRuntime::ResetState() {
   }
 }
 
+absl::StatusOr<ProcRuntimeCheckpointProto> ProcRuntime::SaveCheckpoint()
+    const {
+  ProcRuntimeCheckpointProto checkpoint;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    const ProcContinuation& continuation = *continuations_.at(instance);
+    if (!continuation.AtStartOfTick()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot checkpoint proc instance `%s` in the middle of a tick",
+          instance->GetName()));
+    }
+    ProcRuntimeCheckpointProto::ProcStateProto* proc_proto =
+        checkpoint.add_procs();
+    proc_proto->set_proc_instance(instance->GetName());
+    for (const Value& value : continuation.GetState()) {
+      XLS_ASSIGN_OR_RETURN(*proc_proto->add_state(), value.AsProto());
+    }
+  }
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    if (queue->HasGenerator()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot checkpoint channel instance `%s` which has a generator",
+          queue->channel_instance()->ToString()));
+    }
+    ProcRuntimeCheckpointProto::ChannelQueueProto* queue_proto =
+        checkpoint.add_channel_queues();
+    queue_proto->set_channel_instance(queue->channel_instance()->ToString());
+    for (const Value& value : queue->GetContents()) {
+      XLS_ASSIGN_OR_RETURN(*queue_proto->add_values(), value.AsProto());
+    }
+  }
+  return checkpoint;
+}
+
+absl::Status ProcRuntime::RestoreCheckpoint(
+    const ProcRuntimeCheckpointProto& checkpoint) {
+  absl::flat_hash_map<std::string, ProcInstance*> proc_instances;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    proc_instances[instance->GetName()] = instance;
+  }
+  absl::flat_hash_map<std::string, ChannelQueue*> queues;
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    queues[queue->channel_instance()->ToString()] = queue;
+  }
+  if (checkpoint.procs_size() != proc_instances.size() ||
+      checkpoint.channel_queues_size() != queues.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint has %d proc instances and %d channel instances, runtime "
+        "has %d and %d",
+        checkpoint.procs_size(), checkpoint.channel_queues_size(),
+        proc_instances.size(), queues.size()));
+  }
+
+  // Decode everything before modifying the runtime so a bad checkpoint leaves
+  // the runtime untouched.
+  std::vector<std::pair<ProcInstance*, std::vector<Value>>> states;
+  for (const ProcRuntimeCheckpointProto::ProcStateProto& proc_proto :
+       checkpoint.procs()) {
+    auto it = proc_instances.find(proc_proto.proc_instance());
+    if (it == proc_instances.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Checkpoint contains unknown proc instance `%s`",
+                          proc_proto.proc_instance()));
+    }
+    std::vector<Value> state;
+    state.reserve(proc_proto.state_size());
+    for (const ValueProto& value_proto : proc_proto.state()) {
+      XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(value_proto));
+      state.push_back(std::move(value));
+    }
+    states.push_back({it->second, std::move(state)});
+  }
+  std::vector<std::pair<ChannelQueue*, std::vector<Value>>> contents;
+  for (const ProcRuntimeCheckpointProto::ChannelQueueProto& queue_proto :
+       checkpoint.channel_queues()) {
+    auto it = queues.find(queue_proto.channel_instance());
+    if (it == queues.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Checkpoint contains unknown channel instance `%s`",
+                          queue_proto.channel_instance()));
+    }
+    std::vector<Value> values;
+    values.reserve(queue_proto.values_size());
+    for (const ValueProto& value_proto : queue_proto.values()) {
+      XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(value_proto));
+      values.push_back(std::move(value));
+    }
+    contents.push_back({it->second, std::move(values)});
+  }
+
+  ResetState();
+  for (auto& [instance, state] : states) {
+    XLS_RETURN_IF_ERROR(
+        continuations_.at(instance)->SetState(std::move(state)));
+  }
+  for (const auto& [queue, values] : contents) {
+    XLS_RETURN_IF_ERROR(queue->SetContents(values));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<JitChannelQueueManager*>
 ProcRuntime::GetJitChannelQueueManager() {
   auto* jit_qm = dynamic_cast<JitChannelQueueManager*>(queue_manager_.get());
@@ -244,6 +469,31 @@ ProcRuntime::GetJitChannelQueueManager() {
   return jit_qm;
 }
 
+absl::Status ProcRuntime::StartBinaryChannelTrace(
+    const std::filesystem::path& path) {
+  if (channel_trace_writer_ != nullptr) {
+    return absl::FailedPreconditionError(
+        "A binary channel trace is already being recorded");
+  }
+  absl::Span<ChannelInstance* const> channel_instances =
+      elaboration().channel_instances();
+  XLS_ASSIGN_OR_RETURN(channel_trace_writer_,
+                       ChannelTraceWriter::Create(path, channel_instances));
+  for (int64_t i = 0; i < channel_instances.size(); ++i) {
+    queue_manager_->GetQueue(channel_instances[i])
+        .AddCallback(std::make_unique<BinaryChannelTraceRecorder>(
+            this, channel_trace_writer_.get(), i));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ProcRuntime::FlushBinaryChannelTrace() {
+  if (channel_trace_writer_ == nullptr) {
+    return absl::OkStatus();
+  }
+  return channel_trace_writer_->Flush();
+}
+
 InterpreterEvents ProcRuntime::GetGlobalEvents() const {
   absl::MutexLock lock(&global_events_mutex_);
   return global_events_;
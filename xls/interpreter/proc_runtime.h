@@ -15,7 +15,9 @@
 #ifndef XLS_INTERPRETER_PROC_RUNTIME_H_
 #define XLS_INTERPRETER_PROC_RUNTIME_H_
 
+#include <atomic>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <utility>
@@ -27,9 +29,11 @@
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/channel_trace.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -38,6 +42,15 @@
 
 namespace xls {
 
+// Returns the order in which a runtime created with `options` first ticks the
+// proc instances of `elaboration` in each network tick. This is the
+// elaboration order unless `EvaluatorOptions::dataflow_tick_order` is set. In
+// that case, as far as the channels between them allow, the senders on each
+// channel come before its receivers. Where the channels form a cycle, the
+// earliest proc instance in elaboration order which remains is placed next.
+absl::StatusOr<std::vector<ProcInstance*>> GetTickOrder(
+    const ProcElaboration& elaboration, const EvaluatorOptions& options);
+
 // Abstract base class for interpreting the procs within a package.
 class ProcRuntime {
  public:
@@ -109,6 +122,17 @@ class ProcRuntime {
   // Reset the state of all of the procs to their initial state.
   void ResetState();
 
+  // Returns a checkpoint of the state of every proc instance and the contents
+  // of every channel queue. Must be called between ticks with every proc at
+  // the start of a tick. Queues with generators attached cannot be
+  // checkpointed.
+  absl::StatusOr<ProcRuntimeCheckpointProto> SaveCheckpoint() const;
+
+  // Restores the proc states and channel queue contents from `checkpoint`,
+  // which must cover exactly the proc and channel instances of this
+  // runtime. Partially executed ticks are discarded.
+  absl::Status RestoreCheckpoint(const ProcRuntimeCheckpointProto& checkpoint);
+
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(ProcInstance* instance) const {
     return continuations_.at(instance)->GetEvents();
@@ -118,6 +142,17 @@ class ProcRuntime {
         ->GetEvents();
   }
 
+  // Starts recording every value sent and received on the channels of the
+  // network to a binary channel trace (see channel_trace.h) at `path`. Much
+  // cheaper than `EvaluatorOptions::set_trace_channels` for long runs.
+  absl::Status StartBinaryChannelTrace(const std::filesystem::path& path);
+
+  // Writes out any buffered records of the binary channel trace.
+  absl::Status FlushBinaryChannelTrace();
+
+  // Returns the number of network ticks executed so far.
+  int64_t tick_count() const { return tick_count_; }
+
   // Return the events which are not associated with any particular proc (e.g.,
   // trace messages for channel activity).
   InterpreterEvents GetGlobalEvents() const;
@@ -143,6 +178,7 @@ class ProcRuntime {
 
  protected:
   friend class ChannelTraceRecorder;
+  friend class BinaryChannelTraceRecorder;
   void AddTraceMessage(TraceMessage message);
 
   // Execute (up to) a single iteration of every proc in the package.
@@ -167,6 +203,9 @@ class ProcRuntime {
 
   EvaluatorOptions options_;
   std::optional<EvaluationObserver*> observer_ = std::nullopt;
+
+  std::atomic<int64_t> tick_count_ = 0;
+  std::unique_ptr<ChannelTraceWriter> channel_trace_writer_;
 };
 
 }  // namespace xls
@@ -25,12 +25,17 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/channel_trace.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -1032,6 +1037,111 @@ TEST_P(ProcRuntimeTestBase, MultipleNewStyleProcs) {
   EXPECT_THAT(out_queue.Read(), Optional(Value(UBits(10, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, CheckpointAndRestore) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * iota,
+                           CreateIotaProc("iota", /*starting_value=*/0,
+                                          /*step=*/1, iota_accum_channel,
+                                          package.get()));
+  XLS_ASSERT_OK(
+      CreateAccumProc("accum", iota_accum_channel, out_channel, package.get())
+          .status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK_AND_ASSIGN(ProcRuntimeCheckpointProto checkpoint,
+                           runtime->SaveCheckpoint());
+  std::string serialized = checkpoint.SerializeAsString();
+
+  // Restore into a fresh runtime and check it resumes where the original
+  // left off, including the outputs already produced.
+  std::unique_ptr<ProcRuntime> restored =
+      GetParam().CreateRuntime(package.get());
+  ProcRuntimeCheckpointProto parsed;
+  ASSERT_TRUE(parsed.ParseFromString(serialized));
+  XLS_ASSERT_OK(restored->RestoreCheckpoint(parsed));
+  EXPECT_THAT(restored->ResolveState(iota), ElementsAre(Value(UBits(2, 32))));
+  XLS_ASSERT_OK(restored->Tick());
+  XLS_ASSERT_OK(restored->Tick());
+
+  ChannelQueue& queue = restored->queue_manager().GetQueue(out_channel);
+  EXPECT_EQ(queue.GetSize(), 4);
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(0, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(1, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(3, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(6, 32))));
+
+  // Saving the checkpoint does not consume the queue contents.
+  EXPECT_EQ(runtime->queue_manager().GetQueue(out_channel).GetSize(), 2);
+
+  // Restoring a checkpoint into a different network fails.
+  ProcRuntimeCheckpointProto bad = checkpoint;
+  bad.mutable_procs(0)->set_proc_instance("not_a_proc");
+  EXPECT_THAT(restored->RestoreCheckpoint(bad),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("unknown proc instance `not_a_proc`")));
+}
+
+TEST_P(ProcRuntimeTestBase, BinaryChannelTrace) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK(CreateIotaProc("iota", /*starting_value=*/5, /*step=*/1,
+                               iota_accum_channel, package.get())
+                    .status());
+  XLS_ASSERT_OK(
+      CreateAccumProc("accum", iota_accum_channel, out_channel, package.get())
+          .status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile trace_file, TempFile::Create());
+  XLS_ASSERT_OK(runtime->StartBinaryChannelTrace(trace_file.path()));
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->FlushBinaryChannelTrace());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents,
+                           GetFileContents(trace_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelTrace trace, ParseChannelTrace(contents));
+  EXPECT_THAT(trace.channel_names,
+              UnorderedElementsAre("iota_accum", "out"));
+
+  // Each tick sends and receives on `iota_accum` and sends on `out`; the
+  // relative order of operations within a tick depends on the runtime.
+  std::vector<std::string> records;
+  for (const ChannelTraceRecord& record : trace.records) {
+    records.push_back(absl::StrFormat(
+        "%d %s %s %s", record.tick, trace.channel_names[record.channel_index],
+        record.op == ChannelTraceOp::kRead ? "read" : "write",
+        record.value.ToString()));
+  }
+  EXPECT_THAT(records, UnorderedElementsAre("0 iota_accum write bits[32]:5",
+                                            "0 iota_accum read bits[32]:5",
+                                            "0 out write bits[32]:5",
+                                            "1 iota_accum write bits[32]:6",
+                                            "1 iota_accum read bits[32]:6",
+                                            "1 out write bits[32]:11"));
+  EXPECT_THAT(ChannelTraceToString(trace),
+              HasSubstr("Tick 1: Sent data on channel `out`: bits[32]:11"));
+}
+
 TEST_P(ProcRuntimeTestBase, ProcSetState) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(
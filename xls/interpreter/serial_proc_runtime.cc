@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
@@ -55,8 +57,11 @@ SerialProcRuntime::Create(
   XLS_RET_CHECK_EQ(evaluator_map.size(),
                    queue_manager->elaboration().procs().size())
       << "More evaluators than procs given.";
-  auto network_interpreter = absl::WrapUnique(new SerialProcRuntime(
-      std::move(evaluator_map), std::move(queue_manager), options));
+  XLS_ASSIGN_OR_RETURN(std::vector<ProcInstance*> tick_order,
+                       GetTickOrder(queue_manager->elaboration(), options));
+  auto network_interpreter = absl::WrapUnique(
+      new SerialProcRuntime(std::move(evaluator_map), std::move(queue_manager),
+                            std::move(tick_order), options));
   return std::move(network_interpreter);
 }
 
@@ -76,7 +81,7 @@ SerialProcRuntime::TickInternal() {
   std::deque<QueueElement> ready_instances;
 
   // Put all proc instances on the ready list.
-  for (ProcInstance* instance : elaboration().proc_instances()) {
+  for (ProcInstance* instance : tick_order_) {
     VLOG(3) << absl::StreamFormat("Proc instance `%s` added to ready list",
                                   instance->GetName());
     ready_instances.push_back(
@@ -21,11 +21,13 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
 
 namespace xls {
 
@@ -41,14 +43,23 @@ class SerialProcRuntime : public ProcRuntime {
       std::unique_ptr<ChannelQueueManager>&& queue_manager,
       const EvaluatorOptions& options = EvaluatorOptions());
 
+  // The order in which proc instances are first ticked in each network tick.
+  // This is the elaboration order unless the runtime was created with
+  // `EvaluatorOptions::dataflow_tick_order` set.
+  absl::Span<ProcInstance* const> tick_order() const { return tick_order_; }
+
  private:
   SerialProcRuntime(
       absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
       std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::vector<ProcInstance*> tick_order,
       const EvaluatorOptions& options = EvaluatorOptions())
-      : ProcRuntime(std::move(evaluators), std::move(queue_manager), options) {}
+      : ProcRuntime(std::move(evaluators), std::move(queue_manager), options),
+        tick_order_(std::move(tick_order)) {}
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+
+  std::vector<ProcInstance*> tick_order_;
 };
 
 }  // namespace xls
@@ -17,6 +17,7 @@
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,7 @@
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -48,6 +50,9 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
 constexpr const char kIrAssertPath[] = "xls/interpreter/force_assert.ir";
 
 // Create a SerialProcRuntime composed of a mix of ProcInterpreters and
@@ -148,6 +153,126 @@ TEST(SerialProcRuntimeTest, InterpreterAsserts) {
                   ::testing::HasSubstr("Assertion failure via fail!")));
 }
 
+std::vector<std::string> TickOrderNames(const SerialProcRuntime& runtime) {
+  std::vector<std::string> names;
+  for (ProcInstance* instance : runtime.tick_order()) {
+    names.push_back(instance->proc()->name());
+  }
+  return names;
+}
+
+TEST(SerialProcRuntimeTest, DataflowTickOrder) {
+  // The procs are declared consumers first: `c` receives from `b` which
+  // receives from `a`. `d` receives from `a` and sends back to itself.
+  constexpr std::string_view kIrText = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_b(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan a_d(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_c(bits[32], id=3, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan out(bits[32], id=4, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc c(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=b_c)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel=out)
+  next (snd, state)
+}
+
+proc b(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=a_b)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel=b_c)
+  next (snd, state)
+}
+
+proc d(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=a_d)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  next (rcv_tkn, state)
+}
+
+proc a(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=in)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd_b: token = send(rcv_tkn, data, channel=a_b)
+  snd_d: token = send(snd_b, data, channel=a_d)
+  next (snd_d, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> default_runtime,
+      CreateInterpreterSerialProcRuntime(package.get()));
+  EXPECT_THAT(TickOrderNames(*default_runtime),
+              ElementsAre("c", "b", "d", "a"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateJitSerialProcRuntime(
+          package.get(), EvaluatorOptions().set_dataflow_tick_order(true)));
+  EXPECT_THAT(TickOrderNames(*runtime), ElementsAre("a", "b", "c", "d"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in,
+                           runtime->queue_manager().GetQueueById(0));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out,
+                           runtime->queue_manager().GetQueueById(4));
+  XLS_ASSERT_OK(in->Write(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(out->Read(), Optional(Value(UBits(42, 32))));
+}
+
+TEST(SerialProcRuntimeTest, DataflowTickOrderWithCycle) {
+  // `b` and `c` form a cycle broken by the initial value on `c_b`.
+  constexpr std::string_view kIrText = R"(
+package p
+
+chan c_b(bits[32], initial_values={7}, id=0, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_c(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan a_b(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+
+proc c(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=b_c)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  snd: token = send(rcv_tkn, data, channel=c_b)
+  next (snd, state)
+}
+
+proc b(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=c_b)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  rcv_a: (token, bits[32]) = receive(rcv_tkn, channel=a_b)
+  rcv_a_tkn: token = tuple_index(rcv_a, index=0)
+  data_a: bits[32] = tuple_index(rcv_a, index=1)
+  sum: bits[32] = add(data, data_a)
+  snd: token = send(rcv_a_tkn, sum, channel=b_c)
+  next (snd, state)
+}
+
+proc a(tkn: token, state: bits[32], init={token, 1}) {
+  snd: token = send(tkn, state, channel=a_b)
+  lit: bits[32] = literal(value=1)
+  next_state: bits[32] = add(state, lit)
+  next (snd, next_state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateJitSerialProcRuntime(
+          package.get(), EvaluatorOptions().set_dataflow_tick_order(true)));
+  // `a` has no predecessors; the cycle is entered at `c`, the earliest of `b`
+  // and `c` in elaboration order.
+  EXPECT_THAT(TickOrderNames(*runtime), ElementsAre("a", "c", "b"));
+  XLS_ASSERT_OK(runtime->Tick());
+}
+
 // Instantiate and run all the tests in proc_runtime_test_base.cc using
 // proc interpreters.
 INSTANTIATE_TEST_SUITE_P(
@@ -165,6 +290,25 @@ INSTANTIATE_TEST_SUITE_P(
               return CreateInterpreterSerialProcRuntime(top, options).value();
             },
             /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "interpreter_incremental",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_incremental_evaluation(
+                             true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_incremental_evaluation(
+                             true))
+                  .value();
+            },
+            /*supports_observers=*/true),
         ProcRuntimeTestParam(
             "jit",
             [](Package* package, const EvaluatorOptions& options)
@@ -176,6 +320,24 @@ INSTANTIATE_TEST_SUITE_P(
               return CreateJitSerialProcRuntime(top, options).value();
             },
             /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit_dataflow_tick_order",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_dataflow_tick_order(
+                             true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         top, EvaluatorOptions(options).set_dataflow_tick_order(
+                                  true))
+                  .value();
+            },
+            /*supports_observers=*/true),
         ProcRuntimeTestParam(
             "mixed",
             [](Package* package, const EvaluatorOptions& options)
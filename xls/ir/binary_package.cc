@@ -0,0 +1,888 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_package.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_package.pb.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+// Size of the fixed header: magic, version, reserved word and metadata size.
+constexpr int64_t kHeaderSize = 8 + 4 + 4 + 8;
+constexpr int64_t kLiteralDataAlignment = 8;
+
+void AppendLittleEndian(uint64_t value, int64_t byte_count, std::string* out) {
+  for (int64_t i = 0; i < byte_count; ++i) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t ReadLittleEndian(std::string_view data, int64_t offset,
+                          int64_t byte_count) {
+  uint64_t value = 0;
+  for (int64_t i = 0; i < byte_count; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+// Textual form of a function base in a package dump including its attributes
+// and, if it is the top entity, the `top` keyword. Mirrors Package::DumpIr.
+std::string DumpWithAttributes(FunctionBase* fb, bool is_top) {
+  std::vector<std::string> attribute_strings = fb->AttributeIrStrings();
+  std::string out;
+  if (!attribute_strings.empty()) {
+    absl::StrAppend(&out, "#[", absl::StrJoin(attribute_strings, ", "), "]\n");
+  }
+  absl::StrAppend(&out, is_top ? "top " : "", fb->DumpIr(), "\n");
+  return out;
+}
+
+class PackageSerializer {
+ public:
+  explicit PackageSerializer(const Package& package) : package_(package) {}
+
+  absl::StatusOr<std::string> Serialize() {
+    BinaryPackageProto& proto = proto_;
+    proto.set_name(package_.name());
+    std::vector<std::pair<Fileno, std::string>> file_numbers(
+        package_.fileno_to_name().begin(), package_.fileno_to_name().end());
+    std::sort(file_numbers.begin(), file_numbers.end());
+    for (const auto& [fileno, filename] : file_numbers) {
+      BinaryFileNumberProto* file_number = proto.add_file_numbers();
+      file_number->set_file_number(static_cast<int32_t>(fileno.value()));
+      file_number->set_file_name(filename);
+    }
+
+    std::optional<FunctionBase*> top = package_.GetTop();
+    for (const std::unique_ptr<Function>& function : package_.functions()) {
+      function_indices_[function.get()] = proto.functions_size();
+      XLS_RETURN_IF_ERROR(
+          SerializeFunction(function.get(), proto.add_functions()));
+      if (top.has_value() && *top == function.get()) {
+        proto.set_top(function->name());
+      }
+    }
+
+    std::string declarations;
+    for (Channel* channel : package_.channels()) {
+      absl::StrAppend(&declarations, channel->ToString(), "\n");
+    }
+    for (const std::unique_ptr<Proc>& proc : package_.procs()) {
+      absl::StrAppend(&declarations,
+                      DumpWithAttributes(proc.get(), top == proc.get()));
+    }
+    for (const std::unique_ptr<Block>& block : package_.blocks()) {
+      absl::StrAppend(&declarations,
+                      DumpWithAttributes(block.get(), top == block.get()));
+    }
+    proto.set_declarations(std::move(declarations));
+
+    for (Type* type : types_) {
+      *proto.add_types() = type->ToProto();
+    }
+
+    std::string metadata;
+    XLS_RET_CHECK(proto.SerializeToString(&metadata));
+    std::string out;
+    out.reserve(kHeaderSize + metadata.size() + kLiteralDataAlignment +
+                literal_data_.size());
+    absl::StrAppend(&out, kBinaryPackageMagic);
+    AppendLittleEndian(kBinaryPackageVersion, 4, &out);
+    AppendLittleEndian(0, 4, &out);
+    AppendLittleEndian(metadata.size(), 8, &out);
+    absl::StrAppend(&out, metadata);
+    out.resize(RoundUpToNearest<int64_t>(out.size(), kLiteralDataAlignment),
+               '\0');
+    absl::StrAppend(&out, literal_data_);
+    return out;
+  }
+
+ private:
+  int64_t TypeIndex(Type* type) {
+    auto [it, inserted] = type_indices_.try_emplace(type, types_.size());
+    if (inserted) {
+      types_.push_back(type);
+    }
+    return it->second;
+  }
+
+  void AppendValueData(const Value& value) {
+    if (value.IsBits()) {
+      std::vector<uint8_t> bytes = value.bits().ToBytes();
+      literal_data_.append(reinterpret_cast<const char*>(bytes.data()),
+                           bytes.size());
+      return;
+    }
+    if (value.IsTuple() || value.IsArray()) {
+      for (const Value& element : value.elements()) {
+        AppendValueData(element);
+      }
+    }
+  }
+
+  int64_t LiteralIndex(Literal* literal, BinaryPackageProto* proto) {
+    auto [it, inserted] =
+        literal_indices_.try_emplace(literal->value(), proto->literals_size());
+    if (inserted) {
+      BinaryLiteralProto* literal_proto = proto->add_literals();
+      literal_proto->set_type(TypeIndex(literal->GetType()));
+      literal_proto->set_offset(literal_data_.size());
+      AppendValueData(literal->value());
+      literal_proto->set_size(literal_data_.size() - literal_proto->offset());
+    }
+    return it->second;
+  }
+
+  absl::Status SerializeFunction(Function* function,
+                                 BinaryFunctionProto* proto) {
+    proto->set_name(function->name());
+    // Nodes are emitted in the same order as Function::DumpIr so that loading
+    // allocates node ids exactly as parsing the textual dump would.
+    for (Param* param : function->params()) {
+      XLS_RETURN_IF_ERROR(SerializeNode(param, proto->add_nodes()));
+    }
+    for (Node* node : TopoSort(function)) {
+      if (node->Is<Param>()) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(SerializeNode(node, proto->add_nodes()));
+    }
+    if (function->return_value() != nullptr) {
+      proto->set_return_value(function->return_value()->id());
+    }
+    if (function->GetInitiationInterval().has_value()) {
+      proto->set_initiation_interval(*function->GetInitiationInterval());
+    }
+    if (function->ForeignFunctionData().has_value()) {
+      *proto->mutable_ffi() = *function->ForeignFunctionData();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<int64_t> FunctionIndex(Function* function) {
+    auto it = function_indices_.find(function);
+    XLS_RET_CHECK(it != function_indices_.end())
+        << "Function " << function->name()
+        << " is referenced before its definition";
+    return it->second;
+  }
+
+  absl::Status SerializeNode(Node* node, BinaryNodeProto* proto) {
+    proto->set_id(node->id());
+    proto->set_op(ToOpProto(node->op()));
+    proto->set_type(TypeIndex(node->GetType()));
+    for (Node* operand : node->operands()) {
+      proto->add_operands(operand->id());
+    }
+    if (node->HasAssignedName()) {
+      proto->set_name(node->GetName());
+    }
+    for (const SourceLocation& location : node->loc().locations) {
+      proto->add_locations(location.fileno().value());
+      proto->add_locations(location.lineno().value());
+      proto->add_locations(location.colno().value());
+    }
+
+    switch (node->op()) {
+      case Op::kArraySlice:
+        proto->set_width(node->As<ArraySlice>()->width());
+        break;
+      case Op::kAssert: {
+        Assert* assert = node->As<Assert>();
+        proto->set_message(assert->message());
+        if (assert->label().has_value()) {
+          proto->set_label(*assert->label());
+        }
+        if (assert->original_label().has_value()) {
+          proto->set_original_label(*assert->original_label());
+        }
+        break;
+      }
+      case Op::kBitSlice:
+        proto->set_start(node->As<BitSlice>()->start());
+        proto->set_width(node->As<BitSlice>()->width());
+        break;
+      case Op::kCountedFor: {
+        CountedFor* counted_for = node->As<CountedFor>();
+        proto->set_trip_count(counted_for->trip_count());
+        proto->set_stride(counted_for->stride());
+        XLS_ASSIGN_OR_RETURN(int64_t index, FunctionIndex(counted_for->body()));
+        proto->set_function(index);
+        break;
+      }
+      case Op::kCover: {
+        Cover* cover = node->As<Cover>();
+        proto->set_label(cover->label());
+        if (cover->original_label().has_value()) {
+          proto->set_original_label(*cover->original_label());
+        }
+        break;
+      }
+      case Op::kDecode:
+        proto->set_width(node->As<Decode>()->width());
+        break;
+      case Op::kDynamicBitSlice:
+        proto->set_width(node->As<DynamicBitSlice>()->width());
+        break;
+      case Op::kDynamicCountedFor: {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             FunctionIndex(node->As<DynamicCountedFor>()->body()));
+        proto->set_function(index);
+        break;
+      }
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             FunctionIndex(node->As<Invoke>()->to_apply()));
+        proto->set_function(index);
+        break;
+      }
+      case Op::kLiteral:
+        proto->set_literal(LiteralIndex(node->As<Literal>(), &proto_));
+        break;
+      case Op::kMap: {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             FunctionIndex(node->As<Map>()->to_apply()));
+        proto->set_function(index);
+        break;
+      }
+      case Op::kMinDelay:
+        proto->set_delay(node->As<MinDelay>()->delay());
+        break;
+      case Op::kOneHot:
+        proto->set_lsb_prio(node->As<OneHot>()->priority() ==
+                            LsbOrMsb::kLsb);
+        break;
+      case Op::kSel:
+        proto->set_has_default(
+            node->As<Select>()->default_value().has_value());
+        break;
+      case Op::kSignExt:
+      case Op::kZeroExt:
+        proto->set_width(node->As<ExtendOp>()->new_bit_count());
+        break;
+      case Op::kSMul:
+      case Op::kUMul:
+        proto->set_width(node->As<ArithOp>()->width());
+        break;
+      case Op::kSMulp:
+      case Op::kUMulp:
+        proto->set_width(node->As<PartialProductOp>()->width());
+        break;
+      case Op::kTrace:
+        proto->set_format(StepsToXlsFormatString(node->As<Trace>()->format()));
+        proto->set_verbosity(node->As<Trace>()->verbosity());
+        break;
+      case Op::kTupleIndex:
+        proto->set_index(node->As<TupleIndex>()->index());
+        break;
+      case Op::kInputPort:
+      case Op::kInstantiationInput:
+      case Op::kInstantiationOutput:
+      case Op::kNext:
+      case Op::kOutputPort:
+      case Op::kReceive:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+      case Op::kSend:
+        return absl::UnimplementedError(absl::StrFormat(
+            "Binary serialization of `%s` in function `%s` is not supported",
+            node->GetName(), node->function_base()->name()));
+      default:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  const Package& package_;
+  // Literals are recorded in the package proto as they are encountered.
+  BinaryPackageProto proto_;
+  std::vector<Type*> types_;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  absl::flat_hash_map<Value, int64_t> literal_indices_;
+  absl::flat_hash_map<Function*, int64_t> function_indices_;
+  std::string literal_data_;
+};
+
+class PackageDeserializer {
+ public:
+  PackageDeserializer(const BinaryPackageProto& proto,
+                      std::string_view literal_data)
+      : proto_(proto), literal_data_(literal_data) {}
+
+  absl::StatusOr<std::unique_ptr<Package>> Deserialize() {
+    auto package = std::make_unique<Package>(proto_.name());
+    package_ = package.get();
+    for (const BinaryFileNumberProto& file_number : proto_.file_numbers()) {
+      package_->SetFileno(Fileno(file_number.file_number()),
+                          file_number.file_name());
+    }
+    for (const TypeProto& type_proto : proto_.types()) {
+      XLS_ASSIGN_OR_RETURN(Type * type,
+                           package_->GetTypeFromProto(type_proto));
+      types_.push_back(type);
+    }
+    literals_.resize(proto_.literals_size());
+
+    for (const BinaryFunctionProto& function_proto : proto_.functions()) {
+      XLS_ASSIGN_OR_RETURN(Function * function,
+                           DeserializeFunction(function_proto));
+      functions_.push_back(function);
+    }
+    if (proto_.has_top()) {
+      XLS_RETURN_IF_ERROR(package_->SetTopByName(proto_.top()));
+    }
+    // Parsing the declarations also assigns ids to any nodes which lacked one
+    // in the textual form.
+    XLS_RETURN_IF_ERROR(Parser::ParseDeclarationsIntoPackageNoVerify(
+        proto_.declarations(), package_));
+    return package;
+  }
+
+ private:
+  absl::StatusOr<Type*> GetType(int64_t index) const {
+    if (index < 0 || index >= types_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type index %d", index));
+    }
+    return types_[index];
+  }
+
+  absl::StatusOr<Value> ValueFromData(Type* type, int64_t* offset) {
+    if (type->IsBits()) {
+      int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      int64_t byte_count = CeilOfRatio(bit_count, int64_t{8});
+      if (*offset + byte_count > literal_data_.size()) {
+        return absl::InvalidArgumentError("Literal data is truncated");
+      }
+      Bits bits = Bits::FromBytes(
+          absl::MakeConstSpan(
+              reinterpret_cast<const uint8_t*>(literal_data_.data()) + *offset,
+              byte_count),
+          bit_count);
+      *offset += byte_count;
+      return Value(std::move(bits));
+    }
+    if (type->IsTuple()) {
+      std::vector<Value> elements;
+      elements.reserve(type->AsTupleOrDie()->size());
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        XLS_ASSIGN_OR_RETURN(Value element, ValueFromData(element_type, offset));
+        elements.push_back(std::move(element));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    if (type->IsArray()) {
+      std::vector<Value> elements;
+      elements.reserve(type->AsArrayOrDie()->size());
+      for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            Value element,
+            ValueFromData(type->AsArrayOrDie()->element_type(), offset));
+        elements.push_back(std::move(element));
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
+    XLS_RET_CHECK(type->IsToken());
+    return Value::Token();
+  }
+
+  // Literal values are materialized once per interned literal and copied into
+  // each literal node which refers to it.
+  absl::StatusOr<const Value*> GetLiteral(int64_t index) {
+    if (index < 0 || index >= literals_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid literal index %d", index));
+    }
+    if (!literals_[index].has_value()) {
+      const BinaryLiteralProto& literal_proto = proto_.literals(index);
+      XLS_ASSIGN_OR_RETURN(Type * type, GetType(literal_proto.type()));
+      int64_t offset = literal_proto.offset();
+      XLS_ASSIGN_OR_RETURN(literals_[index], ValueFromData(type, &offset));
+      XLS_RET_CHECK_EQ(offset, literal_proto.offset() + literal_proto.size());
+    }
+    return &*literals_[index];
+  }
+
+  absl::StatusOr<Function*> GetFunction(int64_t index) const {
+    if (index < 0 || index >= functions_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid function index %d", index));
+    }
+    return functions_[index];
+  }
+
+  absl::StatusOr<Function*> DeserializeFunction(
+      const BinaryFunctionProto& proto) {
+    Function* function = package_->AddFunction(
+        std::make_unique<Function>(proto.name(), package_));
+    absl::flat_hash_map<int64_t, Node*> nodes_by_id;
+    for (const BinaryNodeProto& node_proto : proto.nodes()) {
+      std::vector<Node*> operands;
+      operands.reserve(node_proto.operands_size());
+      for (int64_t operand_id : node_proto.operands()) {
+        auto it = nodes_by_id.find(operand_id);
+        if (it == nodes_by_id.end()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Node %d in function `%s` refers to unknown operand id %d",
+              node_proto.id(), proto.name(), operand_id));
+        }
+        operands.push_back(it->second);
+      }
+      XLS_ASSIGN_OR_RETURN(Node * node,
+                           DeserializeNode(node_proto, operands, function));
+      // Mirror the parser which assigns the id from the text after
+      // construction.
+      node->SetId(node_proto.id());
+      nodes_by_id[node_proto.id()] = node;
+    }
+    if (proto.has_return_value()) {
+      auto it = nodes_by_id.find(proto.return_value());
+      if (it == nodes_by_id.end()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Unknown return value id %d in function `%s`",
+            proto.return_value(), proto.name()));
+      }
+      XLS_RETURN_IF_ERROR(function->set_return_value(it->second));
+    }
+    if (proto.has_initiation_interval()) {
+      function->SetInitiationInterval(proto.initiation_interval());
+    }
+    if (proto.has_ffi()) {
+      function->SetForeignFunctionData(proto.ffi());
+    }
+    return function;
+  }
+
+  absl::StatusOr<Node*> DeserializeNode(const BinaryNodeProto& proto,
+                                        absl::Span<Node* const> operands,
+                                        Function* f) {
+    XLS_ASSIGN_OR_RETURN(Type * type, GetType(proto.type()));
+    Op op = FromOpProto(proto.op());
+    SourceInfo loc;
+    if (proto.locations_size() % 3 != 0) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Malformed source locations on node %d", proto.id()));
+    }
+    for (int64_t i = 0; i < proto.locations_size(); i += 3) {
+      loc.locations.push_back(SourceLocation(Fileno(proto.locations(i)),
+                                             Lineno(proto.locations(i + 1)),
+                                             Colno(proto.locations(i + 2))));
+    }
+    const std::string& name = proto.name();
+    auto check_arity = [&](int64_t expected) -> absl::Status {
+      if (operands.size() != expected) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Node %d (%s) has %d operands, expected %d", proto.id(),
+            OpToString(op), operands.size(), expected));
+      }
+      return absl::OkStatus();
+    };
+    auto check_min_arity = [&](int64_t expected) -> absl::Status {
+      if (operands.size() < expected) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Node %d (%s) has %d operands, expected at least %d", proto.id(),
+            OpToString(op), operands.size(), expected));
+      }
+      return absl::OkStatus();
+    };
+    auto optional_string =
+        [](bool has, const std::string& s) -> std::optional<std::string> {
+      return has ? std::optional<std::string>(s) : std::nullopt;
+    };
+
+    switch (op) {
+      case Op::kParam:
+        return f->AddNode(std::make_unique<Param>(loc, type, name, f));
+      case Op::kAdd:
+      case Op::kSub:
+      case Op::kShll:
+      case Op::kShra:
+      case Op::kShrl:
+      case Op::kSDiv:
+      case Op::kUDiv:
+      case Op::kSMod:
+      case Op::kUMod:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(
+            std::make_unique<BinOp>(loc, operands[0], operands[1], op, name, f));
+      case Op::kEq:
+      case Op::kNe:
+      case Op::kSGe:
+      case Op::kSGt:
+      case Op::kSLe:
+      case Op::kSLt:
+      case Op::kUGe:
+      case Op::kUGt:
+      case Op::kULe:
+      case Op::kULt:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<CompareOp>(loc, operands[0],
+                                                      operands[1], op, name, f));
+      case Op::kAnd:
+      case Op::kNand:
+      case Op::kNor:
+      case Op::kOr:
+      case Op::kXor:
+        return f->AddNode(std::make_unique<NaryOp>(loc, operands, op, name, f));
+      case Op::kAndReduce:
+      case Op::kOrReduce:
+      case Op::kXorReduce:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<BitwiseReductionOp>(
+            loc, operands[0], op, name, f));
+      case Op::kIdentity:
+      case Op::kNeg:
+      case Op::kNot:
+      case Op::kReverse:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(
+            std::make_unique<UnOp>(loc, operands[0], op, name, f));
+      case Op::kSMul:
+      case Op::kUMul:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<ArithOp>(
+            loc, operands[0], operands[1], proto.width(), op, name, f));
+      case Op::kSMulp:
+      case Op::kUMulp:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<PartialProductOp>(
+            loc, operands[0], operands[1], proto.width(), op, name, f));
+      case Op::kSignExt:
+      case Op::kZeroExt:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<ExtendOp>(loc, operands[0],
+                                                     proto.width(), op, name, f));
+      case Op::kAfterAll:
+        return f->AddNode(std::make_unique<AfterAll>(loc, operands, name, f));
+      case Op::kArray: {
+        if (!type->IsArray()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Array node %d has non-array type %s", proto.id(),
+              type->ToString()));
+        }
+        return f->AddNode(std::make_unique<Array>(
+            loc, operands, type->AsArrayOrDie()->element_type(), name, f));
+      }
+      case Op::kArrayConcat:
+        return f->AddNode(std::make_unique<ArrayConcat>(loc, operands, name, f));
+      case Op::kArrayIndex:
+        XLS_RETURN_IF_ERROR(check_min_arity(1));
+        return f->AddNode(std::make_unique<ArrayIndex>(
+            loc, operands[0], operands.subspan(1), name, f));
+      case Op::kArraySlice:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<ArraySlice>(
+            loc, operands[0], operands[1], proto.width(), name, f));
+      case Op::kArrayUpdate:
+        XLS_RETURN_IF_ERROR(check_min_arity(2));
+        return f->AddNode(std::make_unique<ArrayUpdate>(
+            loc, operands[0], operands[1], operands.subspan(2), name, f));
+      case Op::kAssert:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<Assert>(
+            loc, operands[0], operands[1], proto.message(),
+            optional_string(proto.has_label(), proto.label()),
+            optional_string(proto.has_original_label(),
+                            proto.original_label()),
+            name, f));
+      case Op::kBitSlice:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<BitSlice>(
+            loc, operands[0], proto.start(), proto.width(), name, f));
+      case Op::kBitSliceUpdate:
+        XLS_RETURN_IF_ERROR(check_arity(3));
+        return f->AddNode(std::make_unique<BitSliceUpdate>(
+            loc, operands[0], operands[1], operands[2], name, f));
+      case Op::kConcat:
+        return f->AddNode(std::make_unique<Concat>(loc, operands, name, f));
+      case Op::kCountedFor: {
+        XLS_RETURN_IF_ERROR(check_min_arity(1));
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction(proto.function()));
+        return f->AddNode(std::make_unique<CountedFor>(
+            loc, operands[0], operands.subspan(1), proto.trip_count(),
+            proto.stride(), body, name, f));
+      }
+      case Op::kCover:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<Cover>(
+            loc, operands[0], proto.label(),
+            optional_string(proto.has_original_label(),
+                            proto.original_label()),
+            name, f));
+      case Op::kDecode:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<Decode>(loc, operands[0],
+                                                   proto.width(), name, f));
+      case Op::kDynamicBitSlice:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(std::make_unique<DynamicBitSlice>(
+            loc, operands[0], operands[1], proto.width(), name, f));
+      case Op::kDynamicCountedFor: {
+        XLS_RETURN_IF_ERROR(check_min_arity(3));
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction(proto.function()));
+        return f->AddNode(std::make_unique<DynamicCountedFor>(
+            loc, operands[0], operands[1], operands[2], operands.subspan(3),
+            body, name, f));
+      }
+      case Op::kEncode:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<Encode>(loc, operands[0], name, f));
+      case Op::kGate:
+        XLS_RETURN_IF_ERROR(check_arity(2));
+        return f->AddNode(
+            std::make_unique<Gate>(loc, operands[0], operands[1], name, f));
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction(proto.function()));
+        return f->AddNode(
+            std::make_unique<Invoke>(loc, operands, to_apply, name, f));
+      }
+      case Op::kLiteral: {
+        XLS_RETURN_IF_ERROR(check_arity(0));
+        XLS_ASSIGN_OR_RETURN(const Value* value, GetLiteral(proto.literal()));
+        return f->AddNode(std::make_unique<Literal>(loc, *value, name, f));
+      }
+      case Op::kMap: {
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction(proto.function()));
+        return f->AddNode(
+            std::make_unique<Map>(loc, operands[0], to_apply, name, f));
+      }
+      case Op::kMinDelay:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<MinDelay>(loc, operands[0],
+                                                     proto.delay(), name, f));
+      case Op::kOneHot:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<OneHot>(
+            loc, operands[0], proto.lsb_prio() ? LsbOrMsb::kLsb : LsbOrMsb::kMsb,
+            name, f));
+      case Op::kOneHotSel:
+        XLS_RETURN_IF_ERROR(check_min_arity(1));
+        return f->AddNode(std::make_unique<OneHotSelect>(
+            loc, operands[0], operands.subspan(1), name, f));
+      case Op::kPrioritySel:
+        XLS_RETURN_IF_ERROR(check_min_arity(2));
+        return f->AddNode(std::make_unique<PrioritySelect>(
+            loc, operands[0], operands.subspan(1, operands.size() - 2),
+            operands.back(), name, f));
+      case Op::kSel: {
+        XLS_RETURN_IF_ERROR(check_min_arity(proto.has_default() ? 2 : 1));
+        std::optional<Node*> default_value;
+        absl::Span<Node* const> cases = operands.subspan(1);
+        if (proto.has_default()) {
+          default_value = operands.back();
+          cases.remove_suffix(1);
+        }
+        return f->AddNode(std::make_unique<Select>(loc, operands[0], cases,
+                                                   default_value, name, f));
+      }
+      case Op::kTrace: {
+        XLS_RETURN_IF_ERROR(check_min_arity(2));
+        XLS_ASSIGN_OR_RETURN(std::vector<FormatStep> format,
+                             ParseFormatString(proto.format()));
+        return f->AddNode(std::make_unique<Trace>(
+            loc, operands[0], operands[1], operands.subspan(2), format,
+            proto.verbosity(), name, f));
+      }
+      case Op::kTuple:
+        return f->AddNode(std::make_unique<Tuple>(loc, operands, name, f));
+      case Op::kTupleIndex:
+        XLS_RETURN_IF_ERROR(check_arity(1));
+        return f->AddNode(std::make_unique<TupleIndex>(
+            loc, operands[0], proto.index(), name, f));
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Op `%s` is not supported in binary functions",
+                            OpToString(op)));
+    }
+  }
+
+  const BinaryPackageProto& proto_;
+  std::string_view literal_data_;
+  Package* package_ = nullptr;
+  std::vector<Type*> types_;
+  std::vector<std::optional<Value>> literals_;
+  std::vector<Function*> functions_;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  static absl::StatusOr<MappedFile> Open(const std::filesystem::path& path) {
+    FileDescriptor fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() == -1) {
+      return ErrnoToStatus(errno) << "Failed to open file: " << path;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0) {
+      return ErrnoToStatus(errno) << "Failed to stat file: " << path;
+    }
+    if (!S_ISREG(st.st_mode)) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Not a regular file: ", path.string()));
+    }
+    if (st.st_size == 0) {
+      return MappedFile(nullptr, 0);
+    }
+    void* data =
+        mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (data == MAP_FAILED) {
+      return ErrnoToStatus(errno) << "Failed to map file: " << path;
+    }
+    return MappedFile(data, st.st_size);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  MappedFile(MappedFile&& other)
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+  MappedFile& operator=(MappedFile&& other) = delete;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void* data_;
+  size_t size_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::string> SerializePackageToBinary(const Package& package) {
+  return PackageSerializer(package).Serialize();
+}
+
+bool IsBinaryPackage(std::string_view data) {
+  return data.starts_with(kBinaryPackageMagic);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryPackage(
+    std::string_view data) {
+  if (!IsBinaryPackage(data) || data.size() < kHeaderSize) {
+    return absl::InvalidArgumentError("Not a binary XLS IR package");
+  }
+  uint32_t version = ReadLittleEndian(data, kBinaryPackageMagic.size(), 4);
+  if (version != kBinaryPackageVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unsupported binary package version %d (expected %d)",
+                        version, kBinaryPackageVersion));
+  }
+  uint64_t metadata_size =
+      ReadLittleEndian(data, kBinaryPackageMagic.size() + 8, 8);
+  if (metadata_size > data.size() - kHeaderSize) {
+    return absl::InvalidArgumentError("Binary package metadata is truncated");
+  }
+  BinaryPackageProto proto;
+  if (!proto.ParseFromArray(data.data() + kHeaderSize, metadata_size)) {
+    return absl::InvalidArgumentError(
+        "Unable to parse binary package metadata");
+  }
+  int64_t literal_data_offset = std::min<int64_t>(
+      RoundUpToNearest<int64_t>(kHeaderSize + metadata_size,
+                                kLiteralDataAlignment),
+      data.size());
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      PackageDeserializer(proto, data.substr(literal_data_offset))
+          .Deserialize());
+  XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  return package;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageTextOrBinary(
+    std::string_view contents, std::optional<std::string_view> filename) {
+  if (IsBinaryPackage(contents)) {
+    return ParseBinaryPackage(contents);
+  }
+  return Parser::ParsePackage(contents, filename);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFile(
+    const std::filesystem::path& path) {
+  if (path != "-") {
+    absl::StatusOr<MappedFile> mapped = MappedFile::Open(path);
+    if (mapped.ok()) {
+      return ParsePackageTextOrBinary(mapped->contents(), path.string());
+    }
+    if (!absl::IsFailedPrecondition(mapped.status())) {
+      return mapped.status();
+    }
+  }
+  // Not mappable (e.g. stdin or a pipe), read the contents instead.
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return ParsePackageTextOrBinary(contents, path.string());
+}
+
+}  // namespace xls
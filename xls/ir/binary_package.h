@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BINARY_PACKAGE_H_
+#define XLS_IR_BINARY_PACKAGE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// A compact binary encoding of a package which is much cheaper to load than
+// the textual IR. The layout is:
+//
+//   magic             8 bytes, kBinaryPackageMagic
+//   version           uint32, kBinaryPackageVersion
+//   reserved          uint32
+//   metadata size     uint64
+//   metadata          BinaryPackageProto (binary_package.proto)
+//   padding           to an 8-byte boundary
+//   literal data      raw bytes of the interned literal values
+//
+// All integers are little-endian. Functions are encoded node by node with
+// interned types and literals. Procs, blocks and channels are carried in
+// textual form inside the metadata. Loading a binary package produces the
+// same package (including node ids) as parsing its textual dump.
+inline constexpr std::string_view kBinaryPackageMagic = "XLSIRBIN";
+inline constexpr uint32_t kBinaryPackageVersion = 1;
+
+// Serializes the given package into the binary format.
+absl::StatusOr<std::string> SerializePackageToBinary(const Package& package);
+
+// Returns true if `data` starts with the binary package magic.
+bool IsBinaryPackage(std::string_view data);
+
+// Loads a package from the binary format. The package is verified.
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryPackage(
+    std::string_view data);
+
+// Parses `contents` as either a binary package or textual IR, depending on
+// whether it begins with the binary package magic.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageTextOrBinary(
+    std::string_view contents,
+    std::optional<std::string_view> filename = std::nullopt);
+
+// Reads a package from the file at `path` in either format. Regular files are
+// memory-mapped so that large literal arrays in binary packages are decoded
+// directly from the mapping rather than first being copied into a buffer. The
+// path "-" reads from stdin.
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFile(
+    const std::filesystem::path& path);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_PACKAGE_H_
@@ -0,0 +1,208 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_package.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Checks that loading the binary form of `ir` gives the same package as
+// parsing the text.
+void ExpectRoundTrip(std::string_view ir) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinary(*package));
+  EXPECT_TRUE(IsBinaryPackage(binary));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> loaded,
+                           ParseBinaryPackage(binary));
+  EXPECT_EQ(loaded->DumpIr(), package->DumpIr());
+}
+
+TEST(BinaryPackageTest, Functions) {
+  ExpectRoundTrip(R"(package test
+
+file_number 0 "fake_file.x"
+
+fn body(i: bits[32], acc: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(i, acc)
+}
+
+fn double(x: bits[8]) -> bits[8] {
+  ret umul.2: bits[8] = umul(x, x, pos=[(0,3,4)])
+}
+
+#[initiation_interval(2)]
+top fn main(x: bits[8], a: bits[8][4], tkn: token, p: bits[1]) -> (bits[32], bits[8][4], bits[8], token) {
+  zero: bits[32] = literal(value=0, pos=[(0,1,2), (0,5,6)])
+  loop_result: bits[32] = counted_for(zero, trip_count=4, stride=2, body=body)
+  mapped: bits[8][4] = map(a, to_apply=double)
+  table_a: bits[8][4] = literal(value=[1, 2, 3, 4])
+  table_b: bits[8][4] = literal(value=[1, 2, 3, 4])
+  elem_a: bits[8] = array_index(table_a, indices=[x])
+  elem_b: bits[8] = array_index(table_b, indices=[x])
+  sum: bits[8] = add(elem_a, elem_b)
+  doubled: bits[8] = invoke(sum, to_apply=double)
+  oh: bits[9] = one_hot(x, lsb_prio=false)
+  slice: bits[8] = bit_slice(oh, start=1, width=8)
+  selector: bits[2] = zero_ext(p, new_bit_count=2)
+  choice: bits[8] = sel(selector, cases=[doubled, slice], default=x)
+  traced: token = trace(tkn, p, format="x is {}", data_operands=[x])
+  asserted: token = assert(traced, p, message="boom", label="lbl")
+  ret result: (bits[32], bits[8][4], bits[8], token) = tuple(loop_result, mapped, choice, asserted)
+}
+)");
+}
+
+TEST(BinaryPackageTest, ProcsBlocksAndChannels) {
+  ExpectRoundTrip(R"(package test
+
+chan in_ch(bits[32], id=0, kind=streaming, flow_control=none, ops=receive_only,
+           fifo_depth=42, metadata="")
+chan out_ch(bits[32], id=1, kind=streaming, flow_control=none, ops=send_only,
+            metadata="")
+
+fn inc(x: bits[32]) -> bits[32] {
+  one: bits[32] = literal(value=1)
+  ret add.2: bits[32] = add(x, one)
+}
+
+top proc my_proc(my_token: token, my_state: bits[32], init={token, 42}) {
+  receive.3: (token, bits[32]) = receive(my_token, channel=in_ch)
+  tuple_index.4: token = tuple_index(receive.3, index=0)
+  tuple_index.5: bits[32] = tuple_index(receive.3, index=1)
+  invoke.6: bits[32] = invoke(tuple_index.5, to_apply=inc)
+  add.7: bits[32] = add(my_state, invoke.6)
+  send.8: token = send(tuple_index.4, add.7, channel=out_ch)
+  next (send.8, add.7)
+}
+
+block my_block(a: bits[32], b: bits[32], out: bits[32]) {
+  a: bits[32] = input_port(name=a)
+  b: bits[32] = input_port(name=b)
+  add: bits[32] = add(a, b)
+  out: () = output_port(add, name=out)
+}
+)");
+}
+
+TEST(BinaryPackageTest, IdenticalLiteralsAreShared) {
+  std::vector<std::string> elements;
+  for (int64_t i = 0; i < 256; ++i) {
+    elements.push_back(absl::StrCat(i * 7919));
+  }
+  std::string literal = absl::StrCat("bits[32][256] = literal(value=[",
+                                     absl::StrJoin(elements, ", "), "])");
+  std::string one_literal = absl::StrCat(R"(package test
+
+fn f(i: bits[8]) -> bits[32] {
+  table_a: )",
+                                         literal, R"(
+  ret elem_a: bits[32] = array_index(table_a, indices=[i])
+}
+)");
+  std::string two_literals = absl::StrCat(R"(package test
+
+fn f(i: bits[8]) -> bits[32] {
+  table_a: )",
+                                          literal, R"(
+  table_b: )",
+                                          literal, R"(
+  elem_a: bits[32] = array_index(table_a, indices=[i])
+  elem_b: bits[32] = array_index(table_b, indices=[i])
+  ret sum: bits[32] = add(elem_a, elem_b)
+}
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p1,
+                           Parser::ParsePackage(one_literal));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p2,
+                           Parser::ParsePackage(two_literals));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string b1, SerializePackageToBinary(*p1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string b2, SerializePackageToBinary(*p2));
+  // The 1KiB literal is only stored once.
+  EXPECT_LT(b2.size() - b1.size(), 256 * 4);
+  // And it is much more compact than the text.
+  EXPECT_LT(b2.size(), two_literals.size() / 2);
+  ExpectRoundTrip(two_literals);
+}
+
+TEST(BinaryPackageTest, ReadPackageFileInEitherFormat) {
+  constexpr std::string_view kIr = R"(package test
+
+top fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinary(*package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile text_file,
+                           TempFile::CreateWithContent(kIr, ".ir"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_text,
+                           ReadPackageFile(text_file.path()));
+  EXPECT_EQ(from_text->DumpIr(), package->DumpIr());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile binary_file,
+                           TempFile::CreateWithContent(binary, ".irb"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_binary,
+                           ReadPackageFile(binary_file.path()));
+  EXPECT_EQ(from_binary->DumpIr(), package->DumpIr());
+  EXPECT_EQ(from_binary->GetTop().value()->name(), "f");
+}
+
+TEST(BinaryPackageTest, RejectsMalformedInput) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage("package test\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinary(*package));
+
+  EXPECT_THAT(ParseBinaryPackage("package test\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Not a binary")));
+
+  std::string bad_version = binary;
+  bad_version[kBinaryPackageMagic.size()] = 42;
+  EXPECT_THAT(ParseBinaryPackage(bad_version),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unsupported binary package version")));
+
+  // The fixed-size header followed by a fragment of the metadata.
+  EXPECT_THAT(ParseBinaryPackage(binary.substr(0, 26)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("truncated")));
+}
+
+}  // namespace
+}  // namespace xls
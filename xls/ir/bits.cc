@@ -30,6 +30,29 @@
 
 namespace xls {
 
+namespace {
+
+// Returns bits [start, start + width) of `bitmap`, assembling each word of the
+// result from at most two words of `bitmap`.
+InlineBitmap SliceBitmap(const InlineBitmap& bitmap, int64_t start,
+                         int64_t width) {
+  constexpr int64_t kWordBits = 64;
+  InlineBitmap result(width);
+  int64_t word_offset = start / kWordBits;
+  int64_t bit_offset = start % kWordBits;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    int64_t src = i + word_offset;
+    uint64_t word = bitmap.GetWord(src) >> bit_offset;
+    if (bit_offset != 0 && src + 1 < bitmap.word_count()) {
+      word |= bitmap.GetWord(src + 1) << (kWordBits - bit_offset);
+    }
+    result.SetWord(i, word);
+  }
+  return result;
+}
+
+}  // namespace
+
 /* static */ int64_t Bits::MinBitCountSigned(int64_t value) {
   if (value == 0) {
     return 0;
@@ -256,13 +279,7 @@ Bits Bits::Slice(int64_t start, int64_t width) && {
     // This is the most common slice so make it fast.
     return Bits::FromBitmap(std::move(bitmap_).WithSize(width));
   }
-  Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
-  return result;
+  return Bits::FromBitmap(SliceBitmap(bitmap_, start, width));
 }
 
 Bits Bits::Slice(int64_t start, int64_t width) const& {
@@ -275,13 +292,7 @@ Bits Bits::Slice(int64_t start, int64_t width) const& {
     // This is the most common slice so make it fast.
     return Bits::FromBitmap(bitmap_.WithSize(width));
   }
-  Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
-  return result;
+  return Bits::FromBitmap(SliceBitmap(bitmap_, start, width));
 }
 
 }  // namespace xls
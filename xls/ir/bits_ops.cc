@@ -23,6 +23,7 @@
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -50,6 +51,35 @@ Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
   return Truncate(std::move(bits), bit_count);
 }
 
+// Helpers for the fast paths for values of at most 128 bits, which avoid
+// converting to and from BigInt.
+absl::uint128 ToUint128(const Bits& bits) {
+  DCHECK_LE(bits.bit_count(), 128);
+  const InlineBitmap& bitmap = bits.bitmap();
+  uint64_t high = bitmap.word_count() > 1 ? bitmap.GetWord(1) : 0;
+  return absl::MakeUint128(high, bitmap.GetWord(0));
+}
+
+absl::int128 ToInt128(const Bits& bits) {
+  absl::uint128 value = ToUint128(bits);
+  if (bits.bit_count() > 0 && bits.bit_count() < 128 && bits.msb()) {
+    value |= ~absl::uint128(0) << bits.bit_count();
+  }
+  return static_cast<absl::int128>(value);
+}
+
+Bits FromUint128(absl::uint128 value, int64_t bit_count) {
+  DCHECK_LE(bit_count, 128);
+  InlineBitmap bitmap(bit_count);
+  if (bitmap.word_count() > 0) {
+    bitmap.SetWord(0, absl::Uint128Low64(value));
+  }
+  if (bitmap.word_count() > 1) {
+    bitmap.SetWord(1, absl::Uint128High64(value));
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
@@ -203,6 +233,9 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
+  if (lhs.bit_count() <= 128) {
+    return FromUint128(ToUint128(lhs) + ToUint128(rhs), lhs.bit_count());
+  }
 
   Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
                  .ToSignedBits();
@@ -217,6 +250,9 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
+  if (lhs.bit_count() <= 128) {
+    return FromUint128(ToUint128(lhs) - ToUint128(rhs), lhs.bit_count());
+  }
   Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
                   .ToSignedBits();
   return TruncateOrSignExtend(std::move(diff), lhs.bit_count());
@@ -256,6 +292,10 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
     int64_t result = lhs_int * rhs_int;
     return SBits(result, result_width);
   }
+  if (result_width <= 128) {
+    absl::int128 result = ToInt128(lhs) * ToInt128(rhs);
+    return FromUint128(static_cast<absl::uint128>(result), result_width);
+  }
 
   BigInt product =
       BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
@@ -270,6 +310,9 @@ Bits UMul(const Bits& lhs, const Bits& rhs) {
     uint64_t result = lhs_int * rhs_int;
     return UBits(result, result_width);
   }
+  if (result_width <= 128) {
+    return FromUint128(ToUint128(lhs) * ToUint128(rhs), result_width);
+  }
 
   BigInt product =
       BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
@@ -280,6 +323,10 @@ Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() / rhs.ToUint64().value(),
+                 lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -289,6 +336,10 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() % rhs.ToUint64().value(),
+                 rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -308,6 +359,16 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
     // 0b0111...111.
     return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    int64_t lhs_int = lhs.ToInt64().value();
+    int64_t rhs_int = rhs.ToInt64().value();
+    // Division rounds towards zero. Dividing the most negative value by -1
+    // overflows, and the result wraps around to the dividend.
+    uint64_t quotient = rhs_int == -1
+                            ? uint64_t{0} - static_cast<uint64_t>(lhs_int)
+                            : static_cast<uint64_t>(lhs_int / rhs_int);
+    return UBits(quotient & Mask(lhs.bit_count()), lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
@@ -317,6 +378,14 @@ Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    int64_t lhs_int = lhs.ToInt64().value();
+    int64_t rhs_int = rhs.ToInt64().value();
+    // The remainder takes the sign of the dividend.
+    int64_t modulo = rhs_int == -1 ? 0 : lhs_int % rhs_int;
+    return UBits(static_cast<uint64_t>(modulo) & Mask(rhs.bit_count()),
+                 rhs.bit_count());
+  }
   BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
 }
@@ -474,6 +543,19 @@ Bits Concat(absl::Span<const Bits> inputs) {
   for (const Bits& bits : inputs) {
     new_bit_count += bits.bit_count();
   }
+  if (new_bit_count <= 64) {
+    uint64_t result = 0;
+    for (const Bits& bits : inputs) {
+      if (bits.bit_count() == 0) {
+        continue;
+      }
+      // Shifting a 64-bit value by 64 is undefined. If this input is 64 bits
+      // wide every other input is empty.
+      result = bits.bit_count() == 64 ? 0 : result << bits.bit_count();
+      result |= bits.ToUint64().value();
+    }
+    return UBits(result, new_bit_count);
+  }
   // Iterate in reverse order because the first input becomes the
   // most-significant bits.
   BitsRope rope(new_bit_count);
@@ -25,10 +25,12 @@
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_utils.h"
 #include "xls/ir/format_preference.h"
@@ -214,6 +216,94 @@ void DecrementEqualsSub1(const Bits& bits) {
 }
 FUZZ_TEST(BitsOpsFuzzTest, DecrementEqualsSub1).WithDomains(NonemptyBits());
 
+// Returns interesting values of the given width for testing the fast paths for
+// narrow values.
+std::vector<Bits> EdgeValues(int64_t width) {
+  return {Bits(width),
+          UBits(1, width),
+          Bits::AllOnes(width),
+          Bits::PowerOfTwo(width - 1, width),
+          bits_ops::ZeroExtend(Bits::AllOnes(width - 1), width),
+          PrimeBits(width)};
+}
+
+Bits TruncateOrSignExtend(const Bits& bits, int64_t width) {
+  return bits.bit_count() >= width ? bits.Slice(0, width)
+                                   : bits_ops::SignExtend(bits, width);
+}
+
+// Checks the arithmetic fast paths for values of at most 128 bits against
+// BigInt, which the general paths use.
+TEST(BitsOpsTest, NarrowArithmeticMatchesBigInt) {
+  for (int64_t width : {1, 2, 7, 31, 32, 33, 63, 64, 65, 100, 127, 128, 129}) {
+    for (const Bits& lhs : EdgeValues(width)) {
+      for (const Bits& rhs : EdgeValues(width)) {
+        SCOPED_TRACE(absl::StrCat(width, ": ", lhs.ToDebugString(), ", ",
+                                  rhs.ToDebugString()));
+        BigInt slhs = BigInt::MakeSigned(lhs);
+        BigInt srhs = BigInt::MakeSigned(rhs);
+        BigInt ulhs = BigInt::MakeUnsigned(lhs);
+        BigInt urhs = BigInt::MakeUnsigned(rhs);
+        EXPECT_EQ(bits_ops::Add(lhs, rhs),
+                  TruncateOrSignExtend(BigInt::Add(slhs, srhs).ToSignedBits(),
+                                       width));
+        EXPECT_EQ(bits_ops::Sub(lhs, rhs),
+                  TruncateOrSignExtend(BigInt::Sub(slhs, srhs).ToSignedBits(),
+                                       width));
+        EXPECT_EQ(bits_ops::UMul(lhs, rhs),
+                  BigInt::Mul(ulhs, urhs)
+                      .ToUnsignedBitsWithBitCount(2 * width)
+                      .value());
+        EXPECT_EQ(bits_ops::SMul(lhs, rhs),
+                  BigInt::Mul(slhs, srhs)
+                      .ToSignedBitsWithBitCount(2 * width)
+                      .value());
+        if (rhs.IsZero()) {
+          continue;
+        }
+        EXPECT_EQ(bits_ops::UDiv(lhs, rhs),
+                  bits_ops::ZeroExtend(
+                      BigInt::Div(ulhs, urhs).ToUnsignedBits(), width));
+        EXPECT_EQ(bits_ops::UMod(lhs, rhs),
+                  bits_ops::ZeroExtend(
+                      BigInt::Mod(ulhs, urhs).ToUnsignedBits(), width));
+        EXPECT_EQ(bits_ops::SDiv(lhs, rhs),
+                  TruncateOrSignExtend(BigInt::Div(slhs, srhs).ToSignedBits(),
+                                       width));
+        EXPECT_EQ(bits_ops::SMod(lhs, rhs),
+                  TruncateOrSignExtend(BigInt::Mod(slhs, srhs).ToSignedBits(),
+                                       width));
+      }
+    }
+  }
+}
+
+TEST(BitsOpsTest, NarrowConcatAndSlice) {
+  Bits wide = PrimeBits(200);
+  for (int64_t start : {0, 1, 13, 63, 64, 65, 127, 150}) {
+    for (int64_t width : {0, 1, 17, 50, 64, 65, 128}) {
+      if (start + width > wide.bit_count()) {
+        continue;
+      }
+      InlineBitmap expected(width);
+      for (int64_t i = 0; i < width; ++i) {
+        expected.Set(i, wide.Get(start + i));
+      }
+      EXPECT_EQ(wide.Slice(start, width), Bits::FromBitmap(expected))
+          << start << ", " << width;
+    }
+  }
+
+  EXPECT_EQ(bits_ops::Concat({UBits(0b101, 3), Bits(), UBits(0x3f, 6)}),
+            UBits(0b101111111, 9));
+  EXPECT_EQ(bits_ops::Concat({Bits(), Bits::AllOnes(64), Bits()}),
+            Bits::AllOnes(64));
+  EXPECT_EQ(bits_ops::Concat({UBits(1, 1), UBits(0, 63)}),
+            Bits::PowerOfTwo(63, 64));
+  EXPECT_EQ(bits_ops::Concat({UBits(1, 1), UBits(0, 64)}),
+            Bits::PowerOfTwo(64, 65));
+}
+
 TEST(BitsOpsTest, UMul) {
   EXPECT_EQ(bits_ops::UMul(Bits(), Bits()), Bits());
   EXPECT_EQ(bits_ops::UMul(UBits(100, 24), UBits(55, 22)), UBits(5500, 46));
@@ -1107,6 +1197,56 @@ TEST(BitsOpsTest, ToRawDigitsValue0x55U17) {
             "00055");
 }
 
+// Benchmarks of operations on values of the given width, which exercise the
+// fast paths for narrow values.
+void BM_Add(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::Add(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Add)->Arg(8)->Arg(32)->Arg(64)->Arg(100)->Arg(128)->Arg(256);
+
+void BM_UMul(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::UMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UMul)->Arg(8)->Arg(32)->Arg(64)->Arg(100)->Arg(128)->Arg(256);
+
+void BM_UDiv(benchmark::State& state) {
+  Bits lhs = Bits::AllOnes(state.range(0));
+  Bits rhs = PrimeBits(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::UDiv(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UDiv)->Arg(8)->Arg(32)->Arg(64)->Arg(100)->Arg(128)->Arg(256);
+
+void BM_Concat(benchmark::State& state) {
+  std::vector<Bits> inputs(4, PrimeBits(state.range(0) / 4));
+  for (auto _ : state) {
+    auto v = bits_ops::Concat(inputs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Concat)->Arg(8)->Arg(32)->Arg(64)->Arg(100)->Arg(128)->Arg(256);
+
+void BM_BitSlice(benchmark::State& state) {
+  Bits bits = PrimeBits(state.range(0) + 3);
+  for (auto _ : state) {
+    auto v = bits.Slice(3, state.range(0));
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_BitSlice)->Arg(8)->Arg(32)->Arg(64)->Arg(100)->Arg(128)->Arg(256);
+
 void BM_Increment(benchmark::State& state) {
   Bits f = Bits::AllOnes(state.range(0));
   for (auto _ : state) {
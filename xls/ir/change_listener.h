@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CHANGE_LISTENER_H_
+#define XLS_IR_CHANGE_LISTENER_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// Interface for objects which want to be told about changes to the IR of a
+// function base, e.g. analyses which update cached results incrementally
+// rather than recomputing them from scratch. Listeners are registered with
+// FunctionBase::RegisterChangeListener and are called synchronously after the
+// change has been made (or, for NodeDeleted, just before the node is freed).
+//
+// Only structural changes are reported: nodes being added and removed and the
+// operands of a node being replaced. Changes to other node attributes are not.
+class ChangeListener {
+ public:
+  virtual ~ChangeListener() = default;
+
+  // Called after `node` has been added to its function base.
+  virtual void NodeAdded(Node* node) {}
+
+  // Called when `node` is being removed from its function base. The node is
+  // still valid during the call but is freed immediately afterwards.
+  virtual void NodeDeleted(Node* node) {}
+
+  // Called after the operands of `node` at the positions `operand_nos`, which
+  // previously were all `old_operand`, have been replaced.
+  virtual void OperandChanged(Node* node, Node* old_operand,
+                              absl::Span<const int64_t> operand_nos) {}
+
+  // Called when the function base `f` the listener is registered with is being
+  // destroyed. No further notifications are delivered for `f`.
+  virtual void FunctionBaseDeleted(FunctionBase* f) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CHANGE_LISTENER_H_
@@ -53,6 +53,7 @@ class Function : public FunctionBase {
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
     return_value_ = n;
+    InvalidateTopoSortCache();
     return absl::OkStatus();
   }
 
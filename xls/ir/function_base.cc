@@ -36,6 +36,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_scanner.h"
@@ -129,7 +130,7 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_removed;
+  ++transform_metrics().nodes_removed;
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
@@ -154,6 +155,10 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   }
   auto node_it = node_iterators_.find(node);
   XLS_RET_CHECK(node_it != node_iterators_.end());
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeDeleted(node);
+  }
+  InvalidateTopoSortCache();
   nodes_.erase(node_it->second);
   node_iterators_.erase(node_it);
   return absl::OkStatus();
@@ -228,10 +233,86 @@ Block* FunctionBase::AsBlockOrDie() {
   return down_cast<Block*>(this);
 }
 
+FunctionBase::~FunctionBase() {
+  // Copy the listeners as they may unregister themselves when notified.
+  std::vector<ChangeListener*> listeners = change_listeners_;
+  for (ChangeListener* listener : listeners) {
+    listener->FunctionBaseDeleted(this);
+  }
+}
+
+void FunctionBase::RegisterChangeListener(ChangeListener* listener) {
+  change_listeners_.push_back(listener);
+}
+
+void FunctionBase::UnregisterChangeListener(ChangeListener* listener) {
+  auto it = absl::c_find(change_listeners_, listener);
+  CHECK(it != change_listeners_.end())
+      << "Listener not registered with " << name();
+  change_listeners_.erase(it);
+}
+
+void FunctionBase::InvalidateTopoSortCache() {
+  absl::MutexLock lock(&topo_sort_mutex_);
+  reverse_topo_sort_cache_.reset();
+}
+
+int64_t FunctionBase::AllocateNodeId() {
+  if (private_node_id_base_.has_value()) {
+    return private_next_node_id_++;
+  }
+  return package()->GetNextNodeIdAndIncrement();
+}
+
+TransformMetrics& FunctionBase::transform_metrics() {
+  if (private_node_id_base_.has_value()) {
+    return isolated_transform_metrics_;
+  }
+  return package()->transform_metrics();
+}
+
+void FunctionBase::BeginIsolatedMutation() {
+  CHECK(!private_node_id_base_.has_value())
+      << "Isolated mutation already active for " << name();
+  private_node_id_base_ = package()->next_node_id();
+  private_next_node_id_ = *private_node_id_base_;
+  isolated_transform_metrics_ = TransformMetrics();
+}
+
+void FunctionBase::EndIsolatedMutation() {
+  CHECK(private_node_id_base_.has_value())
+      << "No isolated mutation active for " << name();
+  const int64_t base = *private_node_id_base_;
+  const int64_t consumed = private_next_node_id_ - base;
+  private_node_id_base_ = std::nullopt;
+  package()->transform_metrics() =
+      package()->transform_metrics() + isolated_transform_metrics_;
+
+  const int64_t package_next = package()->next_node_id();
+  const int64_t shift = package_next - base;
+  if (shift != 0) {
+    std::vector<Node*> renumbered;
+    for (Node* node : nodes()) {
+      if (node->id() >= base) {
+        renumbered.push_back(node);
+      }
+    }
+    // Shifting every id at or above `base` by the same amount keeps the
+    // relative order of all nodes in this function base, so structures sorted
+    // by node id stay valid. Visit the highest ids first so that a new id never
+    // collides with an id which has not been moved yet.
+    absl::c_sort(renumbered, [](Node* a, Node* b) { return a->id() > b->id(); });
+    for (Node* node : renumbered) {
+      node->SetId(node->id() + shift);
+    }
+  }
+  package()->set_next_node_id(package_next + consumed);
+}
+
 Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   VLOG(4) << absl::StrFormat("Adding node to FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_added;
+  ++transform_metrics().nodes_added;
   if (node->Is<Param>()) {
     params_.push_back(node->As<Param>());
     next_values_by_param_[node->As<Param>()];
@@ -244,6 +325,10 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   }
   Node* ptr = node.get();
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  InvalidateTopoSortCache();
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeAdded(ptr);
+  }
   return ptr;
 }
 
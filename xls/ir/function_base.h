@@ -24,14 +24,17 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/foreign_function_data.pb.h"
 #include "xls/ir/name_uniquer.h"
@@ -57,7 +60,7 @@ class FunctionBase {
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
-  virtual ~FunctionBase() = default;
+  virtual ~FunctionBase();
 
   Package* package() const { return package_; }
   const std::string& name() const { return name_; }
@@ -162,6 +165,47 @@ class FunctionBase {
   // function using the given visitor.
   absl::Status Accept(DfsVisitor* visitor);
 
+  // Registers `listener` to be told about changes to the IR of this function
+  // base. The listener must outlive its registration.
+  void RegisterChangeListener(ChangeListener* listener);
+
+  // Unregisters a listener previously passed to RegisterChangeListener.
+  void UnregisterChangeListener(ChangeListener* listener);
+
+  absl::Span<ChangeListener* const> GetChangeListeners() const {
+    return change_listeners_;
+  }
+
+  // Discards the cached topological order of the nodes (see TopoSort). Called
+  // on every change which may alter the order: nodes being added or removed,
+  // operands being replaced and the return value of a function being set.
+  void InvalidateTopoSortCache();
+
+  // Returns the id to assign to the next node created in this function base.
+  // Ids are normally drawn from the package-wide counter; see
+  // BeginIsolatedMutation.
+  int64_t AllocateNodeId();
+
+  // Returns the transform metrics to update for changes to this function base.
+  // This is the package's metrics unless an isolated mutation is active.
+  TransformMetrics& transform_metrics();
+
+  // Starts mutating this function base in isolation from the rest of the
+  // package so that several function bases of the same package can be changed
+  // concurrently. Until EndIsolatedMutation is called, node ids are handed out
+  // from a private counter starting at the package's current next node id, and
+  // transform metrics are accumulated locally. Must not be called concurrently
+  // with any other mutation of the package.
+  void BeginIsolatedMutation();
+
+  // Ends the isolated mutation started by BeginIsolatedMutation. The nodes
+  // which were given private ids are renumbered as if those ids had been drawn
+  // from the package-wide counter now, in the order they were handed out, and
+  // the local transform metrics are added to the package's. Ending the
+  // isolated mutations of several function bases in a fixed order thus yields
+  // exactly the ids which creating their nodes serially in that order would.
+  void EndIsolatedMutation();
+
   // Sanitizes and uniquifies the given name using the function's name
   // uniquer. Registers the uniquified name in the uniquer so it is not handed
   // out again.
@@ -241,6 +285,24 @@ class FunctionBase {
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
+
+  std::vector<ChangeListener*> change_listeners_;
+
+  // State of the active isolated mutation, if any: the first and next private
+  // node ids and the locally accumulated transform metrics.
+  std::optional<int64_t> private_node_id_base_;
+  int64_t private_next_node_id_ = 0;
+  TransformMetrics isolated_transform_metrics_;
+
+ private:
+  friend std::vector<Node*> ReverseTopoSort(FunctionBase* f);
+
+  // Result of the last ReverseTopoSort, kept until the graph changes. The mutex
+  // allows concurrent topo sorts of a function base which is not being
+  // modified.
+  absl::Mutex topo_sort_mutex_;
+  std::optional<std::vector<Node*>> reverse_topo_sort_cache_
+      ABSL_GUARDED_BY(topo_sort_mutex_);
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
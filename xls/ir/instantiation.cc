@@ -104,25 +104,30 @@ std::string BlockInstantiation::ToString() const {
                          instantiated_block()->name());
 }
 
+// Ports are looked up by name in the instantiated block's port map rather than
+// by scanning its ports, as containers made by block stitching instantiate
+// blocks with many ports and connect each of them.
 absl::StatusOr<InstantiationPort> BlockInstantiation::GetInputPort(
     std::string_view name) {
-  for (InputPort* input_port : instantiated_block()->GetInputPorts()) {
-    if (input_port->GetName() == name) {
-      return InstantiationPort{std::string{name}, input_port->GetType()};
-    }
+  absl::StatusOr<InputPort*> input_port =
+      instantiated_block()->GetInputPort(name);
+  if (!input_port.ok()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No such input port `%s`", name));
   }
-  return absl::NotFoundError(absl::StrFormat("No such input port `%s`", name));
+  return InstantiationPort{std::string{name}, (*input_port)->GetType()};
 }
 
 absl::StatusOr<InstantiationPort> BlockInstantiation::GetOutputPort(
     std::string_view name) {
-  for (OutputPort* output_port : instantiated_block()->GetOutputPorts()) {
-    if (output_port->GetName() == name) {
-      return InstantiationPort{.name = std::string{name},
-                               .type = output_port->operand(0)->GetType()};
-    }
+  absl::StatusOr<OutputPort*> output_port =
+      instantiated_block()->GetOutputPort(name);
+  if (!output_port.ok()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No such output port `%s`", name));
   }
-  return absl::NotFoundError(absl::StrFormat("No such output port `%s`", name));
+  return InstantiationPort{.name = std::string{name},
+                           .type = (*output_port)->operand(0)->GetType()};
 }
 
 absl::StatusOr<InstantiationType> BlockInstantiation::type() const {
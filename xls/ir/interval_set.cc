@@ -18,10 +18,13 @@
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -34,8 +37,21 @@
 namespace xls {
 
 IntervalSet IntervalSet::Maximal(int64_t bit_count) {
+  // Maximal sets are by far the most common, so all maximal sets of the same
+  // width created on a thread share one copy of their interval. The cache is
+  // per thread so passes running concurrently never contend on it.
+  CHECK_GE(bit_count, 0);
+  thread_local absl::flat_hash_map<int64_t,
+                                   std::shared_ptr<std::vector<Interval>>>
+      maximal_intervals;
+  std::shared_ptr<std::vector<Interval>>& intervals =
+      maximal_intervals[bit_count];
+  if (intervals == nullptr) {
+    intervals = std::make_shared<std::vector<Interval>>(
+        1, Interval::Maximal(bit_count));
+  }
   IntervalSet result(bit_count);
-  result.AddInterval(Interval::Maximal(bit_count));
+  result.intervals_ = intervals;
   result.is_normalized_ = true;
   return result;
 }
@@ -57,7 +73,7 @@ IntervalSet IntervalSet::Precise(const Bits& bits) {
 
 void IntervalSet::SetIntervals(absl::Span<const Interval> intervals) {
   is_normalized_ = false;
-  intervals_.clear();
+  intervals_.reset();
   if (intervals.empty()) {
     bit_count_ = -1;
   } else {
@@ -75,7 +91,7 @@ void IntervalSet::Normalize() {
   }
 
   // Fastpath single proper interval
-  if (intervals_.size() == 1 && !intervals_.front().IsImproper()) {
+  if (intervals().size() == 1 && !intervals().front().IsImproper()) {
     // A single proper interval is definitionally normalized.
     is_normalized_ = true;
     return;
@@ -84,7 +100,7 @@ void IntervalSet::Normalize() {
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
   std::vector<Interval> expand_improper;
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (interval.IsImproper()) {
       expand_improper.push_back(Interval(zero, interval.UpperBound()));
       expand_improper.push_back(Interval(interval.LowerBound(), max));
@@ -95,7 +111,8 @@ void IntervalSet::Normalize() {
 
   std::sort(expand_improper.begin(), expand_improper.end());
 
-  intervals_.clear();
+  std::vector<Interval>& normalized = MutableIntervals();
+  normalized.clear();
   for (int32_t i = 0; i < expand_improper.size();) {
     Interval interval = expand_improper[i++];
     while ((i < expand_improper.size()) &&
@@ -104,7 +121,7 @@ void IntervalSet::Normalize() {
       interval = Interval::ConvexHull(interval, expand_improper[i]);
       ++i;
     }
-    intervals_.push_back(interval);
+    normalized.push_back(interval);
   }
 
   is_normalized_ = true;
@@ -123,14 +140,14 @@ std::optional<Interval> IntervalSet::ConvexHull() const {
 std::optional<Bits> IntervalSet::LowerBound() const {
   CHECK_GE(bit_count_, 0);
   if (is_normalized_) {
-    if (intervals_.empty()) {
+    if (intervals().empty()) {
       return std::nullopt;
     }
-    return intervals_.front().LowerBound();
+    return intervals().front().LowerBound();
   }
 
   std::optional<Bits> lower;
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (lower.has_value()) {
       if (bits_ops::ULessThan(interval.LowerBound(), lower.value())) {
         lower = interval.LowerBound();
@@ -145,14 +162,14 @@ std::optional<Bits> IntervalSet::LowerBound() const {
 std::optional<Bits> IntervalSet::UpperBound() const {
   CHECK_GE(bit_count_, 0);
   if (is_normalized_) {
-    if (intervals_.empty()) {
+    if (intervals().empty()) {
       return std::nullopt;
     }
-    return intervals_.back().UpperBound();
+    return intervals().back().UpperBound();
   }
 
   std::optional<Bits> upper;
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (upper.has_value()) {
       if (bits_ops::UGreaterThan(interval.UpperBound(), upper.value())) {
         upper = interval.UpperBound();
@@ -177,7 +194,7 @@ IntervalSet IntervalSet::ZeroExtend(int64_t bit_width) const {
 bool IntervalSet::ForEachElement(
     const std::function<bool(const Bits&)>& callback) const {
   CHECK(is_normalized_);
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (interval.ForEachElement(callback)) {
       return true;
     }
@@ -222,10 +239,10 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
-  for (const Interval& interval : lhs.intervals_) {
+  for (const Interval& interval : lhs.intervals()) {
     combined.AddInterval(interval);
   }
-  for (const Interval& interval : rhs.intervals_) {
+  for (const Interval& interval : rhs.intervals()) {
     combined.AddInterval(interval);
   }
   combined.Normalize();
@@ -328,7 +345,7 @@ IntervalSet IntervalSet::Complement(const IntervalSet& set) {
 std::optional<int64_t> IntervalSet::Size() const {
   CHECK(is_normalized_);
   int64_t total_size = 0;
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (auto size = interval.Size()) {
       total_size += size.value();
     } else {
@@ -363,7 +380,7 @@ std::optional<Bits> IntervalSet::Index(const Bits& index) const {
 
 bool IntervalSet::IsTrueWhenMaskWith(const Bits& value) const {
   CHECK_EQ(value.bit_count(), BitCount());
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (interval.IsTrueWhenAndWith(value)) {
       return true;
     }
@@ -373,7 +390,7 @@ bool IntervalSet::IsTrueWhenMaskWith(const Bits& value) const {
 
 bool IntervalSet::Covers(const Bits& bits) const {
   CHECK_EQ(bits.bit_count(), BitCount());
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (interval.Covers(bits)) {
       return true;
     }
@@ -384,12 +401,12 @@ bool IntervalSet::Covers(const Bits& bits) const {
 bool IntervalSet::IsPrecise() const {
   CHECK_GE(bit_count_, 0);
   std::optional<Interval> precisely;
-  if (intervals_.empty()) {
+  if (intervals().empty()) {
     // A valueless interval is not precise. This can only happen if some
     // analysis hits a contradiction.
     return false;
   }
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (precisely.has_value() && !(precisely.value() == interval)) {
       return false;
     }
@@ -406,14 +423,14 @@ std::optional<Bits> IntervalSet::GetPreciseValue() const {
   if (!IsPrecise()) {
     return std::nullopt;
   }
-  CHECK_EQ(intervals_.size(), 1);
-  return intervals_.front().GetPreciseValue();
+  CHECK_EQ(intervals().size(), 1);
+  return intervals().front().GetPreciseValue();
 }
 
 bool IntervalSet::IsMaximal() const {
   CHECK(is_normalized_);
   CHECK_GE(bit_count_, 0);
-  for (const Interval& interval : intervals_) {
+  for (const Interval& interval : intervals()) {
     if (interval.IsMaximal()) {
       return true;
     }
@@ -425,19 +442,24 @@ bool IntervalSet::IsNormalized() const { return is_normalized_; }
 
 bool IntervalSet::IsEmpty() const {
   CHECK(IsNormalized());
-  return intervals_.empty();
+  return intervals().empty();
 }
 
 std::string IntervalSet::ToString() const {
   CHECK_GE(bit_count_, 0);
   std::vector<std::string> strings;
-  strings.reserve(intervals_.size());
-  for (const auto& interval : intervals_) {
+  strings.reserve(intervals().size());
+  for (const auto& interval : intervals()) {
     strings.push_back(interval.ToString());
   }
   return absl::StrFormat("[%s]", absl::StrJoin(strings, ", "));
 }
 
+IntervalSet IntervalSetInterner::Intern(IntervalSet set) {
+  CHECK(set.IsNormalized());
+  return *sets_.insert(std::move(set)).first;
+}
+
 xabsl::iterator_range<IntervalSet::SignedIntervalIterator>
 IntervalSet::SignedIntervals() const {
   return {
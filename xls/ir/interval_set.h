@@ -19,10 +19,14 @@
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
@@ -32,6 +36,10 @@
 namespace xls {
 
 // This type represents a set of intervals.
+//
+// The intervals are held in storage which is shared between copies and only
+// copied when a copy is modified, so copying an interval set is cheap. Equal
+// sets can also be made to share storage with an IntervalSetInterner.
 class IntervalSet {
  public:
   // Create an empty `IntervalSet` with a `BitCount()` of -1. Every method in
@@ -62,7 +70,7 @@ class IntervalSet {
   // Does not check for normalization, as this function can be used to check if
   // normalization is required (e.g.: to prevent blowup in memory usage while
   // building a large set of intervals).
-  int64_t NumberOfIntervals() const { return intervals_.size(); }
+  int64_t NumberOfIntervals() const { return intervals().size(); }
 
   // Returns the number of intervals in the set assuming that there is a cut
   // between INT_MAX and INT_MIN. This is either exactly NumberOfIntervals() or
@@ -79,12 +87,15 @@ class IntervalSet {
   // The set must be normalized prior to calling this.
   absl::Span<const Interval> Intervals() const& {
     CHECK(is_normalized_);
-    return intervals_;
+    return intervals();
   }
 
   std::vector<Interval> Intervals() && {
     CHECK(is_normalized_);
-    return intervals_;
+    if (intervals_ != nullptr && intervals_.use_count() == 1) {
+      return std::move(*intervals_);
+    }
+    return std::vector<Interval>(intervals().begin(), intervals().end());
   }
 
   class SignedIntervalIterator {
@@ -147,7 +158,7 @@ class IntervalSet {
   void AddInterval(const Interval& interval) {
     is_normalized_ = false;
     CHECK_EQ(BitCount(), interval.BitCount());
-    intervals_.push_back(interval);
+    MutableIntervals().push_back(interval);
   }
 
   // Modify the set of intervals in this to be exactly the given set.
@@ -274,17 +285,22 @@ class IntervalSet {
   std::string ToString() const;
 
   friend bool operator==(IntervalSet lhs, IntervalSet rhs) {
-    lhs.Normalize();
-    rhs.Normalize();
     if (lhs.bit_count_ != rhs.bit_count_) {
       return false;
     }
-    return lhs.intervals_ == rhs.intervals_;
+    // Sets sharing storage (e.g. interned sets) are trivially equal.
+    if (lhs.intervals_ == rhs.intervals_ && lhs.is_normalized_ &&
+        rhs.is_normalized_) {
+      return true;
+    }
+    lhs.Normalize();
+    rhs.Normalize();
+    return absl::c_equal(lhs.intervals(), rhs.intervals());
   }
 
   template <typename H>
   friend H AbslHashValue(H h, const IntervalSet& set) {
-    return H::combine(std::move(h), set.bit_count_, set.intervals_);
+    return H::combine(std::move(h), set.bit_count_, set.intervals());
   }
 
   template <typename Sink>
@@ -293,9 +309,46 @@ class IntervalSet {
   }
 
  private:
+  absl::Span<const Interval> intervals() const {
+    if (intervals_ == nullptr) {
+      return {};
+    }
+    return *intervals_;
+  }
+
+  // Returns the intervals for modification, first copying them if their
+  // storage is shared with another set.
+  std::vector<Interval>& MutableIntervals() {
+    if (intervals_ == nullptr) {
+      intervals_ = std::make_shared<std::vector<Interval>>();
+    } else if (intervals_.use_count() > 1) {
+      intervals_ = std::make_shared<std::vector<Interval>>(*intervals_);
+    }
+    return *intervals_;
+  }
+
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  // The intervals, or null if there are none. May be shared with other sets,
+  // in which case it must not be modified.
+  std::shared_ptr<std::vector<Interval>> intervals_;
+};
+
+// A table of normalized interval sets used to make equal sets share their
+// storage. A collection of many interval sets which are mostly equal, such as
+// the ranges of the nodes of a function, then holds a single copy of each
+// distinct set.
+class IntervalSetInterner {
+ public:
+  // Returns a set equal to `set` which shares storage with every equal set
+  // returned by this interner. `set` must be normalized.
+  IntervalSet Intern(IntervalSet set);
+
+  // Returns the number of distinct sets in the table.
+  int64_t size() const { return sets_.size(); }
+
+ private:
+  absl::flat_hash_set<IntervalSet> sets_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
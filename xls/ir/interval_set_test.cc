@@ -548,6 +548,48 @@ TEST(IntervalSetTest, SignedIterator) {
   }
 }
 
+TEST(IntervalSetTest, CopiesAreIndependent) {
+  IntervalSet original = Intervals({{1, 4}, {8, 12}});
+  IntervalSet copy = original;
+  EXPECT_EQ(copy.Intervals().data(), original.Intervals().data());
+  copy.AddInterval(MakeInterval(20, 30, 32));
+  copy.Normalize();
+  EXPECT_THAT(original.Intervals(),
+              testing::ElementsAre(IsInterval(1, 4, 32), IsInterval(8, 12, 32)));
+  EXPECT_THAT(copy.Intervals(),
+              testing::ElementsAre(IsInterval(1, 4, 32), IsInterval(8, 12, 32),
+                                   IsInterval(20, 30, 32)));
+
+  IntervalSet maximal = IntervalSet::Maximal(8);
+  IntervalSet other_maximal = IntervalSet::Maximal(8);
+  EXPECT_EQ(maximal.Intervals().data(), other_maximal.Intervals().data());
+  maximal.AddInterval(MakeInterval(1, 2, 8));
+  maximal.Normalize();
+  EXPECT_TRUE(maximal.IsMaximal());
+  EXPECT_TRUE(IntervalSet::Maximal(8).IsMaximal());
+  EXPECT_THAT(IntervalSet::Maximal(8).Intervals(),
+              testing::ElementsAre(IsInterval(0, 255, 8)));
+}
+
+TEST(IntervalSetTest, Interner) {
+  IntervalSetInterner interner;
+  IntervalSet a = interner.Intern(Intervals({{1, 4}, {8, 12}}));
+  IntervalSet b = interner.Intern(Intervals({{1, 4}, {8, 12}}));
+  IntervalSet c = interner.Intern(Intervals({{1, 4}}));
+  IntervalSet d = interner.Intern(Intervals({{1, 4}}, 8));
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.Intervals().data(), b.Intervals().data());
+  EXPECT_NE(a, c);
+  EXPECT_NE(c, d);
+  EXPECT_EQ(interner.size(), 3);
+
+  // Modifying an interned set doesn't affect the table.
+  a.AddInterval(MakeInterval(20, 30, 32));
+  a.Normalize();
+  EXPECT_EQ(interner.Intern(Intervals({{1, 4}, {8, 12}})), b);
+  EXPECT_EQ(interner.size(), 3);
+}
+
 void IntersectionIsSmaller(const IntervalSet& lhs, const IntervalSet& rhs) {
   IntervalSet intersection = IntervalSet::Intersect(lhs, rhs);
   std::optional<uint64_t> intersection_size = intersection.Size();
@@ -2711,6 +2711,87 @@ Parser::ParsePackageNoVerify(std::string_view input_string,
   return ParseDerivedPackageNoVerify<Package>(input_string, filename, entry);
 }
 
+/* static */ absl::Status Parser::ParseDeclarationsIntoPackageNoVerify(
+    std::string_view input_string, Package* package,
+    std::optional<std::string_view> filename) {
+  XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
+  Parser parser(std::move(scanner));
+  XLS_RETURN_IF_ERROR(parser.ParsePackageDeclarations(
+      package, filename.value_or("<unknown file>")));
+  SetUnassignedNodeIds(package);
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParsePackageDeclarations(Package* package,
+                                              std::string_view filename) {
+  std::optional<Token> previous_top_token;
+  while (!AtEof()) {
+    XLS_ASSIGN_OR_RETURN(DeclAttributes attributes, MaybeParseAttributes());
+
+    XLS_ASSIGN_OR_RETURN(Token peek, scanner_.PeekToken());
+
+    bool is_top = false;
+    // The fn, proc or block is a top entity.
+    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
+      is_top = true;
+      XLS_RETURN_IF_ERROR(scanner_.DropKeywordOrError("top"));
+      XLS_ASSIGN_OR_RETURN(peek, scanner_.PeekToken());
+      if (package->HasTop() && previous_top_token.has_value()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Top declared more than once, previous declaration @ %s",
+            previous_top_token.value().pos().ToHumanString()));
+      }
+      previous_top_token = peek;
+    }
+    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
+      XLS_ASSIGN_OR_RETURN(Function * fn, ParseFunction(package, attributes),
+                           _ << "@ " << filename);
+      if (is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(fn));
+      }
+      continue;
+    }
+    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
+      XLS_ASSIGN_OR_RETURN(Proc * proc, ParseProc(package, attributes),
+                           _ << "@ " << filename);
+      if (is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(proc));
+      }
+      continue;
+    }
+    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
+      XLS_ASSIGN_OR_RETURN(Block * block, ParseBlock(package, attributes),
+                           _ << "@ " << filename);
+      if (is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(block));
+      }
+      continue;
+    }
+    if (is_top) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                          peek.value(), peek.pos().ToHumanString()));
+    }
+    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
+      XLS_RETURN_IF_ERROR(ParseChannel(package, attributes).status())
+          << "@ " << filename;
+      continue;
+    }
+    if (peek.type() == LexicalTokenType::kKeyword &&
+        peek.value() == "file_number") {
+      XLS_RETURN_IF_ERROR(ParseFileNumber(package, attributes))
+          << "@ " << filename;
+      continue;
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected attribute or declaration "
+                        "(`fn`, `proc`, `block`, `chan`, `file_number`), "
+                        "got %s @ %s",
+                        peek.value(), peek.pos().ToHumanString()));
+  }
+  return absl::OkStatus();
+}
+
 /* static */ absl::StatusOr<Value> Parser::ParseValue(
     std::string_view input_string, Type* expected_type) {
   XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
@@ -120,6 +120,13 @@ class Parser {
       std::optional<std::string_view> filename = std::nullopt,
       std::optional<std::string_view> entry = std::nullopt);
 
+  // Parses top-level declarations from `input_string` into the existing
+  // `package`. Unlike the package parsing methods `input_string` has no
+  // `package` header. No verification is performed.
+  static absl::Status ParseDeclarationsIntoPackageNoVerify(
+      std::string_view input_string, Package* package,
+      std::optional<std::string_view> filename = std::nullopt);
+
   // Parses a literal value that should be of type "expected_type" and returns
   // it.
   static absl::StatusOr<Value> ParseValue(std::string_view input_string,
@@ -329,6 +336,12 @@ class Parser {
   absl::Status ParseFileNumber(Package* package,
                                const DeclAttributes& attributes = {});
 
+  // Parses top-level declarations (file numbers, channels, functions, procs
+  // and blocks) until the end of input, adding them to `package`. `filename`
+  // is only used in error messages.
+  absl::Status ParsePackageDeclarations(Package* package,
+                                        std::string_view filename);
+
   // Parse a sequence of attributes of the form:
   //
   // #[<ident>(<literal>)]
@@ -343,7 +356,6 @@ class Parser {
 absl::StatusOr<std::unique_ptr<PackageT>> Parser::ParseDerivedPackageNoVerify(
     std::string_view input_string, std::optional<std::string_view> filename,
     std::optional<std::string_view> entry) {
-  std::optional<Token> previous_top_token;
   XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
   Parser parser(std::move(scanner));
 
@@ -352,75 +364,8 @@ absl::StatusOr<std::unique_ptr<PackageT>> Parser::ParseDerivedPackageNoVerify(
   auto package = std::make_unique<PackageT>(package_name);
   std::string filename_str =
       (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
-  while (!parser.AtEof()) {
-    XLS_ASSIGN_OR_RETURN(DeclAttributes attributes,
-                         parser.MaybeParseAttributes());
-
-    XLS_ASSIGN_OR_RETURN(Token peek, parser.scanner_.PeekToken());
-
-    bool is_top = false;
-    // The fn, proc or block is a top entity.
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
-      is_top = true;
-      XLS_RETURN_IF_ERROR(parser.scanner_.DropKeywordOrError("top"));
-      XLS_ASSIGN_OR_RETURN(peek, parser.scanner_.PeekToken());
-      if (package.get()->HasTop() && previous_top_token.has_value()) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Top declared more than once, previous declaration @ %s",
-            previous_top_token.value().pos().ToHumanString()));
-      }
-      previous_top_token = peek;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
-      XLS_ASSIGN_OR_RETURN(Function * fn,
-                           parser.ParseFunction(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(fn));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
-      XLS_ASSIGN_OR_RETURN(Proc * proc,
-                           parser.ParseProc(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(proc));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
-      XLS_ASSIGN_OR_RETURN(Block * block,
-                           parser.ParseBlock(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(block));
-      }
-      continue;
-    }
-    if (is_top) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
-                          peek.value(), peek.pos().ToHumanString()));
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
-      XLS_RETURN_IF_ERROR(
-          parser.ParseChannel(package.get(), attributes).status())
-          << "@ " << filename_str;
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword &&
-        peek.value() == "file_number") {
-      XLS_RETURN_IF_ERROR(parser.ParseFileNumber(package.get(), attributes))
-          << "@ " << filename_str;
-      continue;
-    }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected attribute or declaration "
-                        "(`fn`, `proc`, `block`, `chan`, `file_number`), "
-                        "got %s @ %s",
-                        peek.value(), peek.pos().ToHumanString()));
-  }
+  XLS_RETURN_IF_ERROR(
+      parser.ParsePackageDeclarations(package.get(), filename_str));
 
   // Verify the given entry function exists in the package.
   if (entry.has_value()) {
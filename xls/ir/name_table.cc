@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/name_table.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+NameTable::Shard& NameTable::ShardFor(std::string_view name) {
+  return shards_[absl::HashOf(name) % kShardCount];
+}
+
+const std::string* NameTable::Intern(std::string_view name) {
+  Shard& shard = ShardFor(name);
+  absl::MutexLock lock(&shard.mutex);
+  auto [it, inserted] = shard.names.try_emplace(name, 0);
+  ++it->second;
+  return &it->first;
+}
+
+void NameTable::Release(const std::string* name) {
+  Shard& shard = ShardFor(*name);
+  absl::MutexLock lock(&shard.mutex);
+  auto it = shard.names.find(*name);
+  DCHECK(it != shard.names.end() && &it->first == name);
+  if (--it->second == 0) {
+    shard.names.erase(it);
+  }
+}
+
+int64_t NameTable::size() const {
+  int64_t size = 0;
+  for (const Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    size += shard.names.size();
+  }
+  return size;
+}
+
+}  // namespace xls
@@ -0,0 +1,74 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NAME_TABLE_H_
+#define XLS_IR_NAME_TABLE_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+
+// Table of interned node names, owned by a package.
+//
+// Nodes hold a pointer to their interned name rather than their own copy, so
+// the nodes which share a name (e.g. the nodes of clones of a function) share
+// its storage and moving a name from one node to another is a pointer copy.
+// Names are reference counted and removed once no node holds them, so the
+// table does not grow with the names of deleted nodes over a long pass
+// pipeline. Thread-safe so nodes can be created and named in different
+// functions of a package concurrently; the table is sharded by name hash so
+// such concurrent updates rarely contend.
+class NameTable {
+ public:
+  NameTable() = default;
+
+  NameTable(const NameTable&) = delete;
+  NameTable& operator=(const NameTable&) = delete;
+
+  // Returns the interned copy of `name`, adding it to the table if it is not
+  // already present, and takes a reference to it for the caller.
+  const std::string* Intern(std::string_view name);
+
+  // Drops a reference to `name`, which must have been returned by `Intern`.
+  // The name is removed from the table when its last reference is dropped.
+  void Release(const std::string* name);
+
+  // Returns the number of distinct names in the table.
+  int64_t size() const;
+
+ private:
+  static constexpr int64_t kShardCount = 16;
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    // Reference counts keyed by name. The keys do not move, so pointers to them
+    // serve as the interned names.
+    absl::node_hash_map<std::string, int64_t> names ABSL_GUARDED_BY(mutex);
+  };
+
+  Shard& ShardFor(std::string_view name);
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NAME_TABLE_H_
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/name_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+TEST(NameTableTest, InternsEachNameOnce) {
+  NameTable table;
+  const std::string* foo = table.Intern("foo");
+  const std::string* bar = table.Intern("bar");
+  EXPECT_EQ(*foo, "foo");
+  EXPECT_EQ(*bar, "bar");
+  EXPECT_NE(foo, bar);
+  EXPECT_EQ(table.Intern(std::string("foo")), foo);
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(NameTableTest, ReleasedNamesAreRemoved) {
+  NameTable table;
+  const std::string* foo = table.Intern("foo");
+  EXPECT_EQ(table.Intern("foo"), foo);
+  table.Intern("bar");
+  EXPECT_EQ(table.size(), 2);
+
+  table.Release(foo);
+  EXPECT_EQ(table.size(), 2);
+  table.Release(foo);
+  EXPECT_EQ(table.size(), 1);
+}
+
+TEST(NameTableTest, ClonedNodesShareNames) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  sum: bits[8] = add(x, y)
+  ret not.4: bits[8] = not(sum)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  const int64_t name_count = package->node_names().size();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * clone, f->Clone("f_clone"));
+  EXPECT_EQ(package->node_names().size(), name_count);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sum, f->GetNode("sum"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * cloned_sum, clone->GetNode("sum"));
+  EXPECT_EQ(sum->GetNameView().data(), cloned_sum->GetNameView().data());
+
+  // Names go away with the last node holding them.
+  XLS_ASSERT_OK(package->RemoveFunction(clone));
+  EXPECT_EQ(package->node_names().size(), name_count);
+  sum->ClearName();
+  EXPECT_EQ(package->node_names().size(), name_count - 1);
+
+  // Generated names are not interned.
+  EXPECT_FALSE(f->return_value()->HasAssignedName());
+  EXPECT_EQ(f->return_value()->GetName(),
+            absl::StrCat("not.", f->return_value()->id()));
+}
+
+}  // namespace
+}  // namespace xls
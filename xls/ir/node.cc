@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -36,9 +37,11 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/nodes.h"
@@ -55,19 +58,26 @@ namespace xls {
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
-      id_(function_base_->package()->GetNextNodeIdAndIncrement()),
+      id_(function_base_->AllocateNodeId()),
       op_(op),
       type_(type),
-      loc_(loc),
+      loc_(function_base_->package()->InternSourceInfo(loc)),
       name_(name.empty() ? nullptr
-                         : std::make_unique<std::string>(
+                         : function_base_->package()->InternNodeName(
                                function_base_->UniquifyNodeName(name))) {}
 
+Node::~Node() {
+  if (name_ != nullptr) {
+    package()->ReleaseNodeName(name_);
+  }
+}
+
 void Node::AddOperand(Node* operand) {
   VLOG(3) << " Adding operand " << operand->GetName() << " as #"
           << operands_.size() << " operand of " << GetName();
   operands_.push_back(operand);
   operand->AddUser(this);
+  function_base_->InvalidateTopoSortCache();
   VLOG(3) << " " << operand->GetName()
           << " user now: " << operand->GetUsersString();
 }
@@ -455,28 +465,35 @@ std::string_view Node::GetNameView() const {
 }
 
 void Node::SetName(std::string_view name) {
-  if (name.empty()) {
-    name_.reset();
-  } else {
-    name_ =
-        std::make_unique<std::string>(function_base()->UniquifyNodeName(name));
-  }
+  SetInternedName(name.empty() ? nullptr
+                               : package()->InternNodeName(
+                                     function_base()->UniquifyNodeName(name)));
 }
 
 void Node::SetNameDirectly(std::string_view name) {
-  if (name.empty()) {
-    name_.reset();
-  } else {
-    name_ = std::make_unique<std::string>(name);
-  }
+  SetInternedName(name.empty() ? nullptr : package()->InternNodeName(name));
 }
 
 void Node::ClearName() {
   CHECK(!Is<Param>());
-  name_.reset();
+  SetInternedName(nullptr);
+}
+
+void Node::SetInternedName(const std::string* name) {
+  if (name_ != nullptr) {
+    package()->ReleaseNodeName(name_);
+  }
+  name_ = name;
 }
 
-void Node::SetLoc(const SourceInfo& loc) { loc_ = loc; }
+void Node::SetLoc(const SourceInfo& loc) {
+  loc_ = package()->InternSourceInfo(loc);
+}
+
+void Node::MergeLoc(const Node* other) {
+  CHECK_EQ(package(), other->package());
+  loc_ = package()->source_infos().Merge(loc_, other->loc_);
+}
 
 std::string Node::ToStringInternal(bool include_operand_types) const {
   std::string ret = absl::StrCat(GetName(), ": ", GetType()->ToString(), " = ",
@@ -773,8 +790,9 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
   bool did_replace = false;
+  absl::InlinedVector<int64_t, 2> replaced_operand_nos;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
       if (!did_replace && new_operand != nullptr) {
@@ -783,9 +801,16 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
       }
       did_replace = true;
       operands_[i] = new_operand;
+      replaced_operand_nos.push_back(i);
     }
   }
   old_operand->RemoveUser(this);
+  if (did_replace) {
+    function_base()->InvalidateTopoSortCache();
+    for (ChangeListener* listener : function_base()->GetChangeListeners()) {
+      listener->OperandChanged(this, old_operand, replaced_operand_nos);
+    }
+  }
   return did_replace;
 }
 
@@ -797,12 +822,16 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
         << "old operand type: " << old_operand->GetType()->ToString()
         << " new operand type: " << new_operand->GetType()->ToString();
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
 
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  function_base()->InvalidateTopoSortCache();
+  for (ChangeListener* listener : function_base()->GetChangeListeners()) {
+    listener->OperandChanged(this, old_operand, {operand_no});
+  }
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -814,6 +843,19 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   return absl::OkStatus();
 }
 
+void Node::SwapOperands(int64_t a, int64_t b) {
+  // Operand/user chains already set up properly.
+  std::swap(operands_[a], operands_[b]);
+  if (operands_[a] == operands_[b]) {
+    return;
+  }
+  function_base()->InvalidateTopoSortCache();
+  for (ChangeListener* listener : function_base()->GetChangeListeners()) {
+    listener->OperandChanged(this, operands_[b], {a});
+    listener->OperandChanged(this, operands_[a], {b});
+  }
+}
+
 absl::Status Node::ReplaceUsesWith(Node* replacement,
                                    const std::function<bool(Node*)>& filter,
                                    bool replace_implicit_uses) {
@@ -821,7 +863,7 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  ++package()->transform_metrics().nodes_replaced;
+  ++function_base()->transform_metrics().nodes_replaced;
   bool all_replaced = true;
   std::vector<Node*> orig_users(users().begin(), users().end());
   for (Node* user : orig_users) {
@@ -849,9 +891,10 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
   if (all_replaced && !Is<Param>() && HasAssignedName() &&
       !replacement->HasAssignedName()) {
     // Do not use SetName because we do not want the name to be uniqued which
-    // would add a suffix because (clearly) the name already exists.
-    replacement->SetNameDirectly(*name_);
-    ClearName();
+    // would add a suffix because (clearly) the name already exists. The name is
+    // already interned so its reference is handed over directly.
+    replacement->name_ = name_;
+    name_ = nullptr;
   }
   return absl::OkStatus();
 }
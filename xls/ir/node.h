@@ -15,6 +15,7 @@
 #ifndef XLS_IR_NODE_H_
 #define XLS_IR_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -33,6 +34,7 @@
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/node_allocator.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -51,7 +53,16 @@ class DfsVisitor;
 // Node is subtyped and can be checked-converted via the As* methods below.
 class Node {
  public:
-  virtual ~Node() = default;
+  virtual ~Node();
+
+  // Nodes are allocated from the node arena rather than the global heap. See
+  // NodeAllocator.
+  static void* operator new(size_t size) {
+    return NodeAllocator::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    NodeAllocator::Deallocate(ptr, size);
+  }
 
   // Accepts the visitor, instructing it to visit this node.
   //
@@ -77,7 +88,7 @@ class Node {
   Op op() const { return op_; }
   FunctionBase* function_base() const { return function_base_; }
   Package* package() const;
-  const SourceInfo& loc() const { return loc_; }
+  const SourceInfo& loc() const { return *loc_; }
 
   // Returns the sequence of operands used by this node.
   //
@@ -142,10 +153,7 @@ class Node {
   absl::StatusOr<bool> ReplaceImplicitUsesWith(Node* replacement);
 
   // Swaps the operands at indices 'a' and 'b' in the operands sequence.
-  void SwapOperands(int64_t a, int64_t b) {
-    // Operand/user chains already set up properly.
-    std::swap(operands_[a], operands_[b]);
-  }
+  void SwapOperands(int64_t a, int64_t b);
 
   // Returns true if analysis indicates that this node always produces the
   // same value as 'other' when run with the same operands. The analysis is
@@ -201,6 +209,10 @@ class Node {
   // Set source location.
   void SetLoc(const SourceInfo& loc);
 
+  // Adds the source locations of `other`, which must be in the same package,
+  // to those of this node. For use when `other` is merged into this node.
+  void MergeLoc(const Node* other);
+
   // Returns the name of the node and any concise supplementary information.
   std::string ToString() const { return ToStringInternal(false); }
 
@@ -229,8 +241,12 @@ class Node {
     }
   };
 
+  // Set of users of a node sorted by id. Allocated from the node arena.
+  using UserSet =
+      absl::btree_set<Node*, NodeIdLessThan, NodeArenaAllocator<Node*>>;
+
   // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  const UserSet& users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -314,18 +330,24 @@ class Node {
   void AddUser(Node* user);
   void RemoveUser(Node* user);
 
+  // Replaces the interned name of this node, releasing the previous one.
+  void SetInternedName(const std::string* name);
+
   FunctionBase* function_base_;
   int64_t id_;
   Op op_;
   Type* type_;
-  SourceInfo loc_;
-  std::unique_ptr<std::string> name_;  // Non-null if name has been assigned.
+  // Interned in the package's SourceInfoTable.
+  const SourceInfo* loc_;
+  // Non-null if name has been assigned. Interned in the package's NameTable,
+  // holding one reference.
+  const std::string* name_;
 
   // Most nodes have <= 2 operands, so we keep those locally if we can.
-  absl::InlinedVector<Node*, 2> operands_;
+  absl::InlinedVector<Node*, 2, NodeArenaAllocator<Node*>> operands_;
 
   // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  UserSet users_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
@@ -0,0 +1,234 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_allocator.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xls {
+namespace {
+
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER)
+constexpr bool kUseSlabs = false;
+#else
+constexpr bool kUseSlabs = true;
+#endif
+
+constexpr size_t kNumSizeClasses =
+    NodeAllocator::kMaxSmallSize / NodeAllocator::kAlignment;
+constexpr size_t kSlabSize = size_t{64} * 1024;
+// Number of blocks moved between the global pool and a thread at a time.
+constexpr int64_t kTransferBatch = 256;
+// Number of free blocks of a size class a thread may hold before it returns a
+// batch of them to the global pool.
+constexpr int64_t kMaxCachedBlocks = 2 * kTransferBatch;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+size_t SizeClass(size_t size) {
+  return (size + NodeAllocator::kAlignment - 1) / NodeAllocator::kAlignment -
+         1;
+}
+
+size_t BlockSize(size_t size_class) {
+  return (size_class + 1) * NodeAllocator::kAlignment;
+}
+
+// Process-wide pool of blocks which no thread currently holds. Never destroyed
+// so nodes may be freed during static destruction.
+class GlobalPool {
+ public:
+  static GlobalPool& Get() {
+    static GlobalPool* pool = new GlobalPool();
+    return *pool;
+  }
+
+  // Returns a non-empty list of free blocks of the given class and sets
+  // `count` to its length, allocating a new slab if the pool has none.
+  FreeBlock* Take(size_t size_class, int64_t& count) {
+    absl::MutexLock lock(&mutex_);
+    FreeBlock*& list = free_lists_[size_class];
+    if (list == nullptr) {
+      return NewSlab(size_class, count);
+    }
+    FreeBlock* head = list;
+    FreeBlock* tail = head;
+    count = 1;
+    while (count < kTransferBatch && tail->next != nullptr) {
+      tail = tail->next;
+      ++count;
+    }
+    list = tail->next;
+    tail->next = nullptr;
+    return head;
+  }
+
+  // Returns the list of blocks starting at `head` to the pool.
+  void GiveList(size_t size_class, FreeBlock* head) {
+    if (head == nullptr) {
+      return;
+    }
+    FreeBlock* tail = head;
+    while (tail->next != nullptr) {
+      tail = tail->next;
+    }
+    absl::MutexLock lock(&mutex_);
+    tail->next = free_lists_[size_class];
+    free_lists_[size_class] = head;
+  }
+
+  // Returns a single block to the pool.
+  void GiveBlock(size_t size_class, FreeBlock* block) {
+    absl::MutexLock lock(&mutex_);
+    block->next = free_lists_[size_class];
+    free_lists_[size_class] = block;
+  }
+
+  int64_t SlabBytes() {
+    absl::MutexLock lock(&mutex_);
+    return static_cast<int64_t>(slabs_.size() * kSlabSize);
+  }
+
+ private:
+  FreeBlock* NewSlab(size_t size_class, int64_t& count)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    char* slab = static_cast<char*>(::operator new(
+        kSlabSize, std::align_val_t{NodeAllocator::kAlignment}));
+    slabs_.push_back(slab);
+    size_t block_size = BlockSize(size_class);
+    size_t block_count = kSlabSize / block_size;
+    count = static_cast<int64_t>(block_count);
+    FreeBlock* head = nullptr;
+    for (size_t i = block_count; i > 0; --i) {
+      FreeBlock* block =
+          reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+      block->next = head;
+      head = block;
+    }
+    return head;
+  }
+
+  absl::Mutex mutex_;
+  std::array<FreeBlock*, kNumSizeClasses> free_lists_ ABSL_GUARDED_BY(mutex_) =
+      {};
+  std::vector<char*> slabs_ ABSL_GUARDED_BY(mutex_);
+};
+
+class ThreadCache;
+
+// Pointer to the current thread's cache. Trivially destructible so it remains
+// readable after the cache itself has been destroyed at thread exit.
+ABSL_CONST_INIT thread_local ThreadCache* tls_cache = nullptr;
+ABSL_CONST_INIT thread_local bool tls_cache_destroyed = false;
+
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    for (size_t size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      GlobalPool::Get().GiveList(size_class, free_lists_[size_class]);
+    }
+    tls_cache = nullptr;
+    tls_cache_destroyed = true;
+  }
+
+  void* Allocate(size_t size_class) {
+    FreeBlock*& list = free_lists_[size_class];
+    if (list == nullptr) {
+      list = GlobalPool::Get().Take(size_class, counts_[size_class]);
+    }
+    FreeBlock* block = list;
+    list = block->next;
+    --counts_[size_class];
+    return block;
+  }
+
+  void Deallocate(void* ptr, size_t size_class) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = free_lists_[size_class];
+    free_lists_[size_class] = block;
+    if (++counts_[size_class] > kMaxCachedBlocks) {
+      // Keep the most recently freed blocks, which are likely still in cache,
+      // and hand a batch of older ones back so other threads can use them.
+      FreeBlock* tail = block;
+      for (int64_t i = 1; i < kMaxCachedBlocks - kTransferBatch; ++i) {
+        tail = tail->next;
+      }
+      GlobalPool::Get().GiveList(size_class, tail->next);
+      tail->next = nullptr;
+      counts_[size_class] = kMaxCachedBlocks - kTransferBatch;
+    }
+  }
+
+ private:
+  std::array<FreeBlock*, kNumSizeClasses> free_lists_ = {};
+  std::array<int64_t, kNumSizeClasses> counts_ = {};
+};
+
+// Returns the current thread's cache or nullptr if the thread is exiting and
+// its cache has already been destroyed.
+ThreadCache* GetThreadCache() {
+  if (tls_cache == nullptr && !tls_cache_destroyed) {
+    static thread_local ThreadCache cache;
+    tls_cache = &cache;
+  }
+  return tls_cache;
+}
+
+}  // namespace
+
+void* NodeAllocator::Allocate(size_t size) {
+  if (!kUseSlabs || size == 0 || size > kMaxSmallSize) {
+    return ::operator new(size, std::align_val_t{kAlignment});
+  }
+  size_t size_class = SizeClass(size);
+  if (ThreadCache* cache = GetThreadCache(); cache != nullptr) {
+    return cache->Allocate(size_class);
+  }
+  int64_t count;
+  FreeBlock* blocks = GlobalPool::Get().Take(size_class, count);
+  GlobalPool::Get().GiveList(size_class, blocks->next);
+  return blocks;
+}
+
+void NodeAllocator::Deallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (!kUseSlabs || size == 0 || size > kMaxSmallSize) {
+    ::operator delete(ptr, std::align_val_t{kAlignment});
+    return;
+  }
+  size_t size_class = SizeClass(size);
+  if (ThreadCache* cache = GetThreadCache(); cache != nullptr) {
+    cache->Deallocate(ptr, size_class);
+    return;
+  }
+  GlobalPool::Get().GiveBlock(size_class, static_cast<FreeBlock*>(ptr));
+}
+
+int64_t NodeAllocator::SlabBytes() { return GlobalPool::Get().SlabBytes(); }
+
+}  // namespace xls
@@ -0,0 +1,115 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "absl/container/btree_set.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/common/thread.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+TEST(NodeAllocatorTest, AllocationsAreAlignedAndDistinct) {
+  for (size_t size : {1, 8, 16, 17, 100, 1024, 1025, 4096}) {
+    void* a = NodeAllocator::Allocate(size);
+    void* b = NodeAllocator::Allocate(size);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % NodeAllocator::kAlignment, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % NodeAllocator::kAlignment, 0);
+    // The whole requested size must be writable.
+    std::memset(a, 0xab, size);
+    std::memset(b, 0xcd, size);
+    EXPECT_EQ(static_cast<unsigned char*>(a)[size - 1], 0xab);
+    NodeAllocator::Deallocate(a, size);
+    NodeAllocator::Deallocate(b, size);
+  }
+}
+
+TEST(NodeAllocatorTest, BlocksFreedOnOtherThreadsAreReused) {
+  constexpr int64_t kCount = 10000;
+  constexpr size_t kSize = 200;
+  std::vector<void*> blocks(kCount);
+  for (void*& block : blocks) {
+    block = NodeAllocator::Allocate(kSize);
+  }
+  int64_t slab_bytes = NodeAllocator::SlabBytes();
+  // Free everything on a thread which then exits, handing its free lists back
+  // to the global pool.
+  Thread thread([&]() {
+    for (void* block : blocks) {
+      NodeAllocator::Deallocate(block, kSize);
+    }
+  });
+  thread.Join();
+  for (void*& block : blocks) {
+    block = NodeAllocator::Allocate(kSize);
+  }
+  EXPECT_EQ(NodeAllocator::SlabBytes(), slab_bytes);
+  for (void* block : blocks) {
+    NodeAllocator::Deallocate(block, kSize);
+  }
+}
+
+TEST(NodeAllocatorTest, ContainerAdapter) {
+  absl::btree_set<int64_t, std::less<int64_t>, NodeArenaAllocator<int64_t>> s;
+  for (int64_t i = 0; i < 1000; ++i) {
+    s.insert(999 - i);
+  }
+  EXPECT_EQ(s.size(), 1000);
+  EXPECT_EQ(*s.begin(), 0);
+  EXPECT_EQ(*s.rbegin(), 999);
+}
+
+std::string DenseGraphIr(int64_t depth, int64_t width) {
+  Package p("dense_graph_pkg");
+  benchmark_support::strategy::DistinctLiteral selector;
+  benchmark_support::strategy::CaseSelect csts(selector);
+  benchmark_support::strategy::DistinctLiteral leaf;
+  CHECK_OK(benchmark_support::GenerateFullyConnectedLayerGraph(
+               &p, depth, width, csts, leaf)
+               .status());
+  return p.DumpIr();
+}
+
+// Parsing is dominated by creating nodes and linking operands to users.
+void BM_ParseDenseGraph(benchmark::State& state) {
+  std::string ir = DenseGraphIr(/*depth=*/state.range(0),
+                                /*width=*/state.range(1));
+  for (auto _ : state) {
+    absl::StatusOr<std::unique_ptr<Package>> p = Parser::ParsePackage(ir);
+    CHECK_OK(p.status());
+    benchmark::DoNotOptimize(p);
+  }
+}
+
+BENCHMARK(BM_ParseDenseGraph)->RangePair(8, 512, 4, 32);
+
+}  // namespace
+}  // namespace xls
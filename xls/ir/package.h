@@ -33,6 +33,8 @@
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/fileno.h"
+#include "xls/ir/name_table.h"
+#include "xls/ir/source_info_table.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
@@ -216,6 +218,22 @@ class Package {
   // increments the next node counter. For use in node construction.
   int64_t GetNextNodeIdAndIncrement() { return next_node_id_++; }
 
+  // Returns the interned copy of the given node name, holding a reference to it
+  // for the caller. See NameTable.
+  const std::string* InternNodeName(std::string_view name) {
+    return node_names_.Intern(name);
+  }
+  // Drops a reference to a name returned by InternNodeName.
+  void ReleaseNodeName(const std::string* name) { node_names_.Release(name); }
+  const NameTable& node_names() const { return node_names_; }
+
+  // Returns the interned copy of the given node source location. See
+  // SourceInfoTable.
+  const SourceInfo* InternSourceInfo(const SourceInfo& loc) {
+    return source_infos_.Intern(loc);
+  }
+  SourceInfoTable& source_infos() { return source_infos_; }
+
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
   Fileno GetOrCreateFileno(std::string_view filename);
@@ -445,6 +463,14 @@ class Package {
   // Ordinal to assign to the next node created in this package.
   int64_t next_node_id_ = 1;
 
+  // The names assigned to the nodes of this package. Declared before the
+  // function bases so that it outlives their nodes during destruction.
+  NameTable node_names_;
+
+  // The source locations of the nodes of this package. Declared before the
+  // function bases for the same reason.
+  SourceInfoTable source_infos_;
+
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
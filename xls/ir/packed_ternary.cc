@@ -0,0 +1,271 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kWordBits = 64;
+
+// Adds `a`, `b` and `carry` (0 or 1), updating `carry` to the carry out.
+uint64_t AddWithCarry(uint64_t a, uint64_t b, uint64_t& carry) {
+  uint64_t sum = a + b;
+  uint64_t carry_out = sum < a ? 1 : 0;
+  uint64_t result = sum + carry;
+  carry_out |= result < sum ? 1 : 0;
+  carry = carry_out;
+  return result;
+}
+
+// Returns the word at `wordno` of `bitmap` shifted by `amount` bits towards the
+// most significant bit (if `left`) or the least significant bit.
+uint64_t ShiftedWord(const InlineBitmap& bitmap, int64_t wordno,
+                     int64_t amount, bool left) {
+  int64_t word_shift = amount / kWordBits;
+  int64_t bit_shift = amount % kWordBits;
+  auto word = [&](int64_t i) -> uint64_t {
+    return i >= 0 && i < bitmap.word_count() ? bitmap.GetWord(i) : 0;
+  };
+  if (left) {
+    int64_t src = wordno - word_shift;
+    uint64_t result = word(src) << bit_shift;
+    if (bit_shift != 0) {
+      result |= word(src - 1) >> (kWordBits - bit_shift);
+    }
+    return result;
+  }
+  int64_t src = wordno + word_shift;
+  uint64_t result = word(src) >> bit_shift;
+  if (bit_shift != 0) {
+    result |= word(src + 1) << (kWordBits - bit_shift);
+  }
+  return result;
+}
+
+PackedTernaryVector Shift(const PackedTernaryVector& v, int64_t amount,
+                          bool left) {
+  CHECK_GE(amount, 0);
+  int64_t bit_count = v.bit_count();
+  if (amount >= bit_count) {
+    return PackedTernaryVector::Constant(Bits(bit_count));
+  }
+  // Shift the unknown mask rather than the known mask so the vacated bits
+  // become known (zeros).
+  InlineBitmap unknown(bit_count);
+  for (int64_t i = 0; i < unknown.word_count(); ++i) {
+    unknown.SetWord(i, ~v.known().GetWord(i));
+  }
+  InlineBitmap known(bit_count);
+  InlineBitmap value(bit_count);
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    known.SetWord(i, ~ShiftedWord(unknown, i, amount, left));
+    value.SetWord(i, ShiftedWord(v.value(), i, amount, left));
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), std::move(value));
+}
+
+}  // namespace
+
+PackedTernaryVector PackedTernaryVector::FromTernary(TernarySpan ternary) {
+  InlineBitmap known(ternary.size());
+  InlineBitmap value(ternary.size());
+  for (int64_t wordno = 0; wordno < known.word_count(); ++wordno) {
+    uint64_t known_word = 0;
+    uint64_t value_word = 0;
+    int64_t start = wordno * kWordBits;
+    int64_t end = std::min<int64_t>(start + kWordBits, ternary.size());
+    for (int64_t i = start; i < end; ++i) {
+      uint64_t bit = uint64_t{1} << (i - start);
+      if (ternary[i] != TernaryValue::kUnknown) {
+        known_word |= bit;
+        if (ternary[i] == TernaryValue::kKnownOne) {
+          value_word |= bit;
+        }
+      }
+    }
+    known.SetWord(wordno, known_word);
+    value.SetWord(wordno, value_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+PackedTernaryVector PackedTernaryVector::FromKnownBits(
+    const Bits& known_bits, const Bits& known_bits_values) {
+  CHECK_EQ(known_bits.bit_count(), known_bits_values.bit_count());
+  return FromBitmaps(known_bits.bitmap(), known_bits_values.bitmap());
+}
+
+PackedTernaryVector PackedTernaryVector::Constant(const Bits& bits) {
+  return PackedTernaryVector(InlineBitmap(bits.bit_count(), /*fill=*/true),
+                             bits.bitmap());
+}
+
+PackedTernaryVector PackedTernaryVector::FromBitmaps(InlineBitmap known,
+                                                     InlineBitmap value) {
+  CHECK_EQ(known.bit_count(), value.bit_count());
+  value.Intersect(known);
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+TernaryVector PackedTernaryVector::ToTernary() const {
+  TernaryVector result;
+  result.reserve(bit_count());
+  for (int64_t i = 0; i < bit_count(); ++i) {
+    result.push_back(Get(i));
+  }
+  return result;
+}
+
+int64_t PackedTernaryVector::KnownBitCount() const {
+  int64_t count = 0;
+  for (int64_t i = 0; i < known_.word_count(); ++i) {
+    count += std::popcount(known_.GetWord(i));
+  }
+  return count;
+}
+
+namespace packed_ternary_ops {
+
+PackedTernaryVector Not(const PackedTernaryVector& v) {
+  InlineBitmap value(v.bit_count());
+  for (int64_t i = 0; i < value.word_count(); ++i) {
+    value.SetWord(i, ~v.value().GetWord(i) & v.known().GetWord(i));
+  }
+  return PackedTernaryVector::FromBitmaps(v.known(), std::move(value));
+}
+
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap value(lhs.bit_count());
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    uint64_t lhs_known = lhs.known().GetWord(i);
+    uint64_t rhs_known = rhs.known().GetWord(i);
+    uint64_t lhs_value = lhs.value().GetWord(i);
+    uint64_t rhs_value = rhs.value().GetWord(i);
+    // A bit is known if it is known in both operands or known to be zero in
+    // either.
+    uint64_t lhs_zero = lhs_known & ~lhs_value;
+    uint64_t rhs_zero = rhs_known & ~rhs_value;
+    known.SetWord(i, (lhs_known & rhs_known) | lhs_zero | rhs_zero);
+    value.SetWord(i, lhs_value & rhs_value);
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap value(lhs.bit_count());
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    uint64_t lhs_known = lhs.known().GetWord(i);
+    uint64_t rhs_known = rhs.known().GetWord(i);
+    uint64_t lhs_value = lhs.value().GetWord(i);
+    uint64_t rhs_value = rhs.value().GetWord(i);
+    // A bit is known if it is known in both operands or known to be one in
+    // either.
+    known.SetWord(i, (lhs_known & rhs_known) | lhs_value | rhs_value);
+    value.SetWord(i, lhs_value | rhs_value);
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known = lhs.known();
+  known.Intersect(rhs.known());
+  InlineBitmap value(lhs.bit_count());
+  for (int64_t i = 0; i < value.word_count(); ++i) {
+    value.SetWord(i, lhs.value().GetWord(i) ^ rhs.value().GetWord(i));
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  // Compute the largest and smallest possible sums. Where each bit of the
+  // largest sum is consistent with the carry being known zero, or each bit of
+  // the smallest sum with the carry being known one, that carry is known; a
+  // sum bit is then known if both operand bits and the carry into it are
+  // known. This is the usual known-bits adder (see, e.g., LLVM's
+  // KnownBits::computeForAddCarry) applied to whole words.
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap value(lhs.bit_count());
+  uint64_t max_carry = 0;
+  uint64_t min_carry = 0;
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    uint64_t lhs_known = lhs.known().GetWord(i);
+    uint64_t rhs_known = rhs.known().GetWord(i);
+    uint64_t lhs_one = lhs.value().GetWord(i);
+    uint64_t rhs_one = rhs.value().GetWord(i);
+    uint64_t lhs_zero = lhs_known & ~lhs_one;
+    uint64_t rhs_zero = rhs_known & ~rhs_one;
+    uint64_t max_sum = AddWithCarry(~lhs_zero, ~rhs_zero, max_carry);
+    uint64_t min_sum = AddWithCarry(lhs_one, rhs_one, min_carry);
+    uint64_t carry_known_zero = ~(max_sum ^ lhs_zero ^ rhs_zero);
+    uint64_t carry_known_one = min_sum ^ lhs_one ^ rhs_one;
+    uint64_t known_word =
+        lhs_known & rhs_known & (carry_known_zero | carry_known_one);
+    known.SetWord(i, known_word);
+    value.SetWord(i, min_sum & known_word);
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Neg(const PackedTernaryVector& v) {
+  if (v.bit_count() == 0) {
+    return v;
+  }
+  return Add(Not(v), PackedTernaryVector::Constant(UBits(1, v.bit_count())));
+}
+
+PackedTernaryVector ShiftLeftLogical(const PackedTernaryVector& v,
+                                     int64_t amount) {
+  return Shift(v, amount, /*left=*/true);
+}
+
+PackedTernaryVector ShiftRightLogical(const PackedTernaryVector& v,
+                                      int64_t amount) {
+  return Shift(v, amount, /*left=*/false);
+}
+
+PackedTernaryVector Intersection(const PackedTernaryVector& lhs,
+                                 const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    known.SetWord(i, lhs.known().GetWord(i) & rhs.known().GetWord(i) &
+                         ~(lhs.value().GetWord(i) ^ rhs.value().GetWord(i)));
+  }
+  return PackedTernaryVector::FromBitmaps(std::move(known), lhs.value());
+}
+
+}  // namespace packed_ternary_ops
+
+}  // namespace xls
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_PACKED_TERNARY_H_
+#define XLS_IR_PACKED_TERNARY_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+
+// A ternary vector stored as two bitmaps: a mask of which bits are known and
+// the values of the known bits. Operations on this representation process 64
+// bits at a time rather than one TernaryValue at a time, which makes wide
+// bitwise, arithmetic and shift operations much cheaper to evaluate than on a
+// TernaryVector.
+//
+// Invariant: bits of `value()` which are not set in `known()` are zero.
+class PackedTernaryVector {
+ public:
+  // Creates a vector of `bit_count` unknown bits.
+  explicit PackedTernaryVector(int64_t bit_count)
+      : known_(bit_count), value_(bit_count) {}
+
+  static PackedTernaryVector FromTernary(TernarySpan ternary);
+  // Returns a vector with known bits as represented in `known_bits`, with
+  // values as given in `known_bits_values`.
+  static PackedTernaryVector FromKnownBits(const Bits& known_bits,
+                                           const Bits& known_bits_values);
+  // Returns a fully known vector with the given value.
+  static PackedTernaryVector Constant(const Bits& bits);
+  // Returns a vector whose known bits are those set in `known`, with values as
+  // given in `value`. `known` and `value` must have the same width.
+  static PackedTernaryVector FromBitmaps(InlineBitmap known,
+                                         InlineBitmap value);
+
+  TernaryVector ToTernary() const;
+
+  int64_t bit_count() const { return known_.bit_count(); }
+  const InlineBitmap& known() const { return known_; }
+  const InlineBitmap& value() const { return value_; }
+
+  TernaryValue Get(int64_t index) const {
+    if (!known_.Get(index)) {
+      return TernaryValue::kUnknown;
+    }
+    return value_.Get(index) ? TernaryValue::kKnownOne
+                             : TernaryValue::kKnownZero;
+  }
+
+  bool IsFullyKnown() const { return known_.IsAllOnes(); }
+  bool IsFullyUnknown() const { return known_.IsAllZeroes(); }
+  int64_t KnownBitCount() const;
+
+  std::string ToString() const { return xls::ToString(ToTernary()); }
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known_ == other.known_ && value_ == other.value_;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  PackedTernaryVector(InlineBitmap known, InlineBitmap value)
+      : known_(std::move(known)), value_(std::move(value)) {}
+
+  InlineBitmap known_;
+  InlineBitmap value_;
+};
+
+namespace packed_ternary_ops {
+
+PackedTernaryVector Not(const PackedTernaryVector& v);
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs);
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+
+// Returns the known bits of the sum of `lhs` and `rhs`, which must have the
+// same width. The result is exact: a bit is known iff it has the same value for
+// every possible value of the operands.
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+PackedTernaryVector Neg(const PackedTernaryVector& v);
+
+// Shifts by a known amount, shifting in known zeros.
+PackedTernaryVector ShiftLeftLogical(const PackedTernaryVector& v,
+                                     int64_t amount);
+PackedTernaryVector ShiftRightLogical(const PackedTernaryVector& v,
+                                      int64_t amount);
+
+// Returns a vector with known positions for each bit known to have the same
+// value in both `lhs` and `rhs`.
+PackedTernaryVector Intersection(const PackedTernaryVector& lhs,
+                                 const PackedTernaryVector& rhs);
+
+}  // namespace packed_ternary_ops
+
+}  // namespace xls
+
+#endif  // XLS_IR_PACKED_TERNARY_H_
@@ -0,0 +1,189 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+// Returns every ternary vector of the given width.
+std::vector<TernaryVector> AllTernaryVectors(int64_t width) {
+  std::vector<TernaryVector> result = {TernaryVector()};
+  for (int64_t i = 0; i < width; ++i) {
+    std::vector<TernaryVector> next;
+    for (const TernaryVector& v : result) {
+      for (TernaryValue t : {TernaryValue::kKnownZero, TernaryValue::kKnownOne,
+                             TernaryValue::kUnknown}) {
+        TernaryVector extended = v;
+        extended.push_back(t);
+        next.push_back(extended);
+      }
+    }
+    result = std::move(next);
+  }
+  return result;
+}
+
+// Returns the most precise ternary vector covering `f` applied to every value
+// of `lhs` and `rhs`.
+TernaryVector Exact(TernarySpan lhs, TernarySpan rhs,
+                    const std::function<Bits(const Bits&, const Bits&)>& f) {
+  std::optional<TernaryVector> result;
+  for (const Bits& l : ternary_ops::AllBitsValues(lhs)) {
+    for (const Bits& r : ternary_ops::AllBitsValues(rhs)) {
+      Bits value = f(l, r);
+      if (result.has_value()) {
+        ternary_ops::UpdateWithIntersection(*result, value);
+      } else {
+        result = ternary_ops::BitsToTernary(value);
+      }
+    }
+  }
+  return *result;
+}
+
+void ExpectExactBinaryOp(
+    const std::function<PackedTernaryVector(const PackedTernaryVector&,
+                                            const PackedTernaryVector&)>& op,
+    const std::function<Bits(const Bits&, const Bits&)>& f) {
+  for (const TernaryVector& lhs : AllTernaryVectors(3)) {
+    for (const TernaryVector& rhs : AllTernaryVectors(3)) {
+      EXPECT_EQ(op(PackedTernaryVector::FromTernary(lhs),
+                   PackedTernaryVector::FromTernary(rhs))
+                    .ToTernary(),
+                Exact(lhs, rhs, f))
+          << ToString(lhs) << ", " << ToString(rhs);
+    }
+  }
+}
+
+TEST(PackedTernaryTest, RoundTrip) {
+  TernaryVector v = *StringToTernaryVector(
+      "0b1X0X_1111_0000_XXXX_1010_0101_X1X0_0X0X_1111_0000_XXXX_1010_0101_X1X0_"
+      "0X0X_1111_01X");
+  PackedTernaryVector packed = PackedTernaryVector::FromTernary(v);
+  EXPECT_EQ(packed.bit_count(), v.size());
+  EXPECT_EQ(packed.ToTernary(), v);
+  EXPECT_EQ(packed.KnownBitCount(), ternary_ops::NumberOfKnownBits(v));
+  EXPECT_EQ(PackedTernaryVector::FromKnownBits(
+                ternary_ops::ToKnownBits(v), ternary_ops::ToKnownBitsValues(v)),
+            packed);
+  EXPECT_TRUE(PackedTernaryVector::Constant(UBits(5, 3)).IsFullyKnown());
+  EXPECT_TRUE(PackedTernaryVector(70).IsFullyUnknown());
+}
+
+TEST(PackedTernaryTest, Bitwise) {
+  ExpectExactBinaryOp(packed_ternary_ops::And, bits_ops::And);
+  ExpectExactBinaryOp(packed_ternary_ops::Or, bits_ops::Or);
+  ExpectExactBinaryOp(packed_ternary_ops::Xor, bits_ops::Xor);
+  for (const TernaryVector& v : AllTernaryVectors(3)) {
+    EXPECT_EQ(
+        packed_ternary_ops::Not(PackedTernaryVector::FromTernary(v))
+            .ToTernary(),
+        Exact(v, TernaryVector(), [](const Bits& b, const Bits&) {
+          return bits_ops::Not(b);
+        }));
+  }
+}
+
+TEST(PackedTernaryTest, Add) {
+  ExpectExactBinaryOp(packed_ternary_ops::Add, bits_ops::Add);
+  for (const TernaryVector& v : AllTernaryVectors(3)) {
+    EXPECT_EQ(
+        packed_ternary_ops::Neg(PackedTernaryVector::FromTernary(v))
+            .ToTernary(),
+        Exact(v, TernaryVector(), [](const Bits& b, const Bits&) {
+          return bits_ops::Negate(b);
+        }));
+  }
+}
+
+TEST(PackedTernaryTest, WideAddCarriesAcrossWords) {
+  // 0x0..0_ffff_ffff_ffff_ffff + 1, with an unknown bit above the carry.
+  TernaryVector lhs(130, TernaryValue::kKnownZero);
+  for (int64_t i = 0; i < 64; ++i) {
+    lhs[i] = TernaryValue::kKnownOne;
+  }
+  lhs[100] = TernaryValue::kUnknown;
+  PackedTernaryVector sum = packed_ternary_ops::Add(
+      PackedTernaryVector::FromTernary(lhs),
+      PackedTernaryVector::Constant(UBits(1, 130)));
+  TernaryVector expected(130, TernaryValue::kKnownZero);
+  expected[64] = TernaryValue::kKnownOne;
+  expected[100] = TernaryValue::kUnknown;
+  EXPECT_EQ(sum.ToTernary(), expected);
+
+  // An unknown low bit makes every bit it may carry into unknown.
+  lhs[0] = TernaryValue::kUnknown;
+  sum = packed_ternary_ops::Add(PackedTernaryVector::FromTernary(lhs),
+                                PackedTernaryVector::Constant(UBits(1, 130)));
+  for (int64_t i = 0; i <= 64; ++i) {
+    EXPECT_EQ(sum.Get(i), TernaryValue::kUnknown) << i;
+  }
+  EXPECT_EQ(sum.Get(65), TernaryValue::kKnownZero);
+}
+
+TEST(PackedTernaryTest, Shifts) {
+  TernaryVector v(150, TernaryValue::kUnknown);
+  for (int64_t i = 0; i < v.size(); i += 3) {
+    v[i] = i % 2 == 0 ? TernaryValue::kKnownOne : TernaryValue::kKnownZero;
+  }
+  PackedTernaryVector packed = PackedTernaryVector::FromTernary(v);
+  for (int64_t amount : {0, 1, 5, 63, 64, 65, 128, 149, 150, 1000}) {
+    TernaryVector left(v.size(), TernaryValue::kKnownZero);
+    TernaryVector right(v.size(), TernaryValue::kKnownZero);
+    for (int64_t i = 0; i < v.size(); ++i) {
+      if (i >= amount) {
+        left[i] = v[i - amount];
+      }
+      if (i + amount < v.size()) {
+        right[i] = v[i + amount];
+      }
+    }
+    EXPECT_EQ(packed_ternary_ops::ShiftLeftLogical(packed, amount).ToTernary(),
+              left)
+        << amount;
+    EXPECT_EQ(
+        packed_ternary_ops::ShiftRightLogical(packed, amount).ToTernary(),
+        right)
+        << amount;
+  }
+}
+
+TEST(PackedTernaryTest, Intersection) {
+  for (const TernaryVector& lhs : AllTernaryVectors(3)) {
+    for (const TernaryVector& rhs : AllTernaryVectors(3)) {
+      EXPECT_EQ(packed_ternary_ops::Intersection(
+                    PackedTernaryVector::FromTernary(lhs),
+                    PackedTernaryVector::FromTernary(rhs))
+                    .ToTernary(),
+                ternary_ops::Intersection(lhs, rhs))
+          << ToString(lhs) << ", " << ToString(rhs);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
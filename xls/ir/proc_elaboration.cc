@@ -201,13 +201,20 @@ std::string ProcInstance::ToString(int64_t indent_amount) const {
   return absl::StrJoin(pieces, "\n");
 }
 
-absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
+absl::Status ProcElaboration::BuildInstanceMaps(
+    ProcInstance* proc_instance, std::optional<int64_t> parent_id) {
   XLS_RET_CHECK(proc_instance->path().has_value());
 
+  proc_instance->id_ = proc_instance_ptrs_.size();
   proc_instance_ptrs_.push_back(proc_instance);
   instances_of_proc_[proc_instance->proc()].push_back(proc_instance);
 
-  proc_instances_by_path_[proc_instance->path().value()] = proc_instance;
+  if (parent_id.has_value()) {
+    XLS_RET_CHECK(proc_instance->proc_instantiation().has_value());
+    instance_ids_by_parent_[{*parent_id,
+                             *proc_instance->proc_instantiation()}] =
+        proc_instance->id();
+  }
   for (const std::unique_ptr<ChannelInstance>& channel_instance :
        proc_instance->channels()) {
     instances_of_channel_[channel_instance->channel].push_back(
@@ -220,16 +227,14 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
     XLS_ASSIGN_OR_RETURN(
         ChannelInstance * channel_instance,
         proc_instance->GetChannelInstance(channel_reference->name()));
-    channel_instances_by_path_[{std::string{channel_reference->name()},
-                                proc_instance->path().value()}] =
-        channel_instance;
     instances_of_channel_reference_[channel_reference.get()].push_back(
         channel_instance);
   }
 
   for (const std::unique_ptr<ProcInstance>& subinstance :
        proc_instance->instantiated_procs()) {
-    XLS_RETURN_IF_ERROR(BuildInstanceMaps(subinstance.get()));
+    XLS_RETURN_IF_ERROR(
+        BuildInstanceMaps(subinstance.get(), proc_instance->id()));
   }
 
   return absl::OkStatus();
@@ -293,7 +298,8 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
        elaboration.interface_channel_instances_) {
     elaboration.channel_instance_ptrs_.push_back(channel_instance.get());
   }
-  XLS_RETURN_IF_ERROR(elaboration.BuildInstanceMaps(elaboration.top_.get()));
+  XLS_RETURN_IF_ERROR(elaboration.BuildInstanceMaps(
+      elaboration.top_.get(), /*parent_id=*/std::nullopt));
 
   // Create the vector of procs which appear in this elaboration.
   absl::flat_hash_set<Proc*> proc_set;
@@ -320,13 +326,23 @@ std::string ProcElaboration::ToString() const {
 
 absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
     const ProcInstantiationPath& path) const {
-  auto it = proc_instances_by_path_.find(path);
-  if (it == proc_instances_by_path_.end()) {
+  auto not_found = [&]() {
     return absl::NotFoundError(absl::StrFormat(
         "Instantiation path `%s` does not exist in elaboration from proc `%s`",
         path.ToString(), top()->proc()->name()));
+  };
+  if (path.top != top()->proc()) {
+    return not_found();
+  }
+  int64_t id = top()->id();
+  for (ProcInstantiation* instantiation : path.path) {
+    auto it = instance_ids_by_parent_.find({id, instantiation});
+    if (it == instance_ids_by_parent_.end()) {
+      return not_found();
+    }
+    id = it->second;
   }
-  return it->second;
+  return proc_instance_ptrs_[id];
 }
 
 absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
@@ -340,14 +356,17 @@ absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
     std::string_view channel_name, const ProcInstantiationPath& path) const {
-  auto it = channel_instances_by_path_.find({std::string{channel_name}, path});
-  if (it == channel_instances_by_path_.end()) {
+  absl::StatusOr<ProcInstance*> proc_instance = GetProcInstance(path);
+  absl::StatusOr<ChannelInstance*> channel_instance =
+      proc_instance.ok() ? (*proc_instance)->GetChannelInstance(channel_name)
+                         : proc_instance.status();
+  if (!channel_instance.ok()) {
     return absl::NotFoundError(
         absl::StrFormat("No channel `%s` at instantiation path `%s` in "
                         "elaboration from proc `%s`",
                         channel_name, path.ToString(), top()->proc()->name()));
   }
-  return it->second;
+  return *channel_instance;
 }
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
@@ -400,6 +419,8 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
         /*channel_instances=*/std::vector<std::unique_ptr<ChannelInstance>>(),
         /*instantiated_procs=*/std::vector<std::unique_ptr<ProcInstance>>(),
         channel_bindings));
+    elaboration.proc_instances_.back()->id_ =
+        elaboration.proc_instance_ptrs_.size();
     elaboration.proc_instance_ptrs_.push_back(
         elaboration.proc_instances_.back().get());
 
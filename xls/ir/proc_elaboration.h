@@ -125,6 +125,11 @@ class ProcInstance {
 
   Proc* proc() const { return proc_; }
 
+  // A compact identifier of this proc instance which is unique within the
+  // elaboration. It is the index of the instance in
+  // ProcElaboration::proc_instances().
+  int64_t id() const { return id_; }
+
   // The ProcInstantiation IR construct which instantiates this proc
   // instance. This is std::nullopt if the proc corresponding to this
   // ProcInstance is the top proc.
@@ -182,7 +187,10 @@ class ProcInstance {
   std::string ToString(int64_t indent_amount = 0) const;
 
  private:
+  friend class ProcElaboration;
+
   Proc* proc_;
+  int64_t id_ = 0;
   std::optional<ProcInstantiation*> proc_instantiation_;
   std::optional<ProcInstantiationPath> path_;
 
@@ -275,7 +283,8 @@ class ProcElaboration {
  private:
   // Walks the hierarchy and builds the data member maps of instances.  Only
   // should be called for new-style procs.
-  absl::Status BuildInstanceMaps(ProcInstance* proc_instance);
+  absl::Status BuildInstanceMaps(ProcInstance* proc_instance,
+                                 std::optional<int64_t> parent_id);
 
   Package* package_;
 
@@ -305,15 +314,13 @@ class ProcElaboration {
   // Channel instances for the interface channels.
   std::vector<std::unique_ptr<ChannelInstance>> interface_channel_instances_;
 
-  // All proc instances in the elaboration indexed by instantiation path.
-  absl::flat_hash_map<ProcInstantiationPath, ProcInstance*>
-      proc_instances_by_path_;
-
-  // All channel instances in the elaboration indexed by channel reference name
-  // (new style) or channel name (old style) and instantiation path.
-  absl::flat_hash_map<std::pair<std::string, ProcInstantiationPath>,
-                      ChannelInstance*>
-      channel_instances_by_path_;
+  // Instantiation paths interned as proc instance ids: maps the id of a proc
+  // instance and one of the instantiations in its proc to the id of the
+  // instantiated proc instance. A path is resolved by walking it from the top
+  // instance, so no copies of paths are stored. Channel instances are found
+  // through the channel names of the resolved proc instance.
+  absl::flat_hash_map<std::pair<int64_t, ProcInstantiation*>, int64_t>
+      instance_ids_by_parent_;
 
   // List of instances of each Proc/Channel.
   absl::flat_hash_map<Proc*, std::vector<ProcInstance*>> instances_of_proc_;
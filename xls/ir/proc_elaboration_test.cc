@@ -15,6 +15,7 @@
 #include "xls/ir/proc_elaboration.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -320,6 +321,49 @@ TEST_F(ElaborationTest, MultipleInstantiations) {
   leaf<leaf_ch0=ch0, leaf_ch1=ch1> [top_proc_inst2])");
 }
 
+TEST_F(ElaborationTest, InstanceIdsAndPathLookup) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * leaf_proc,
+      CreateLeafProc("leaf", /*input_channel_count=*/2, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * middle_proc,
+      CreateMultipleInstantiationProc(
+          "middle", /*input_channel_count=*/2, /*instantiated_channel_count=*/2,
+          {leaf_proc, leaf_proc}, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * top,
+                           CreateMultipleInstantiationProc(
+                               "top_proc", /*input_channel_count=*/2,
+                               /*instantiated_channel_count=*/2,
+                               {middle_proc, middle_proc}, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elab,
+                           ProcElaboration::Elaborate(top));
+
+  ASSERT_EQ(elab.proc_instances().size(), 7);
+  for (int64_t i = 0; i < elab.proc_instances().size(); ++i) {
+    ProcInstance* instance = elab.proc_instances()[i];
+    EXPECT_EQ(instance->id(), i);
+    EXPECT_THAT(elab.GetProcInstance(instance->path().value()),
+                IsOkAndHolds(instance));
+    for (const std::unique_ptr<ChannelInstance>& channel :
+         instance->channels()) {
+      EXPECT_THAT(elab.GetChannelInstance(channel->channel->name(),
+                                          instance->path().value()),
+                  IsOkAndHolds(channel.get()));
+    }
+  }
+
+  // A path through an instantiation of a different proc does not exist.
+  ProcInstantiationPath bad_path = elab.proc_instances()[1]->path().value();
+  bad_path.path.push_back(top->proc_instantiations().front().get());
+  EXPECT_THAT(elab.GetProcInstance(bad_path),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("does not exist in elaboration")));
+  EXPECT_THAT(elab.GetChannelInstance("ch0", bad_path),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("No channel `ch0` at instantiation path")));
+}
+
 TEST_F(ElaborationTest, ProcInstantiatingProcWithNoChannels) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_info_table.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/no_destructor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+const SourceInfo* EmptySourceInfo() {
+  static const absl::NoDestructor<SourceInfo> kEmpty;
+  return kEmpty.get();
+}
+
+}  // namespace
+
+const SourceInfo* SourceInfoTable::Intern(const SourceInfo& loc) {
+  if (loc.Empty()) {
+    return EmptySourceInfo();
+  }
+  absl::MutexLock lock(&mutex_);
+  return InternLocked(loc);
+}
+
+const SourceInfo* SourceInfoTable::InternLocked(const SourceInfo& loc) {
+  auto it = infos_.find(loc);
+  if (it == infos_.end()) {
+    it = infos_.insert(loc).first;
+  }
+  return &*it;
+}
+
+const SourceInfo* SourceInfoTable::Merge(const SourceInfo* a,
+                                         const SourceInfo* b) {
+  if (a == b || b->Empty()) {
+    return a;
+  }
+  if (a->Empty()) {
+    return b;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = merges_.try_emplace({a, b}, nullptr);
+  if (inserted) {
+    SourceInfo merged = *a;
+    for (const SourceLocation& location : b->locations) {
+      if (!absl::c_linear_search(a->locations, location)) {
+        merged.locations.push_back(location);
+      }
+    }
+    it->second = InternLocked(merged);
+  }
+  return it->second;
+}
+
+int64_t SourceInfoTable::size() const {
+  absl::MutexLock lock(&mutex_);
+  return infos_.size();
+}
+
+}  // namespace xls
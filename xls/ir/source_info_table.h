@@ -0,0 +1,70 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_SOURCE_INFO_TABLE_H_
+#define XLS_IR_SOURCE_INFO_TABLE_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+
+// Table of interned node source locations, owned by a package.
+//
+// Nodes hold a pointer to their interned SourceInfo rather than their own
+// vector of locations, so the many nodes created from the same source
+// construct (e.g. by inlining or unrolling) share its storage and copying a
+// location from one node to another is a pointer copy. Entries are never
+// removed, so the pointers stay valid for the life of the table. Thread-safe
+// so nodes can be created in different functions of a package concurrently.
+class SourceInfoTable {
+ public:
+  SourceInfoTable() = default;
+
+  SourceInfoTable(const SourceInfoTable&) = delete;
+  SourceInfoTable& operator=(const SourceInfoTable&) = delete;
+
+  // Returns the interned copy of `loc`, adding it to the table if it is not
+  // already present. The empty SourceInfo is shared by all tables.
+  const SourceInfo* Intern(const SourceInfo& loc);
+
+  // Returns the interned SourceInfo holding the locations of `a` followed by
+  // those of `b` which are not in `a`. `a` and `b` must have been returned by
+  // this table. The result is cached, so merging the same pair again is a
+  // single lookup.
+  const SourceInfo* Merge(const SourceInfo* a, const SourceInfo* b);
+
+  // Returns the number of distinct non-empty SourceInfos in the table.
+  int64_t size() const;
+
+ private:
+  const SourceInfo* InternLocked(const SourceInfo& loc)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::node_hash_set<SourceInfo> infos_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::pair<const SourceInfo*, const SourceInfo*>,
+                      const SourceInfo*>
+      merges_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_SOURCE_INFO_TABLE_H_
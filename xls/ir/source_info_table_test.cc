@@ -0,0 +1,86 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/source_info_table.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+SourceLocation Loc(int32_t line) {
+  return SourceLocation(Fileno(1), Lineno(line), Colno(0));
+}
+
+TEST(SourceInfoTableTest, InternsEachSourceInfoOnce) {
+  SourceInfoTable table;
+  const SourceInfo* a = table.Intern(SourceInfo(Loc(1)));
+  const SourceInfo* b = table.Intern(SourceInfo(Loc(2)));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(table.Intern(SourceInfo(Loc(1))), a);
+  EXPECT_EQ(*a, SourceInfo(Loc(1)));
+  EXPECT_TRUE(table.Intern(SourceInfo())->Empty());
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(SourceInfoTableTest, Merge) {
+  SourceInfoTable table;
+  const SourceInfo* empty = table.Intern(SourceInfo());
+  const SourceInfo* a = table.Intern(SourceInfo({Loc(1), Loc(2)}));
+  const SourceInfo* b = table.Intern(SourceInfo({Loc(2), Loc(3)}));
+  EXPECT_EQ(table.Merge(a, empty), a);
+  EXPECT_EQ(table.Merge(empty, b), b);
+  EXPECT_EQ(table.Merge(a, a), a);
+
+  const SourceInfo* merged = table.Merge(a, b);
+  EXPECT_EQ(*merged, SourceInfo({Loc(1), Loc(2), Loc(3)}));
+  EXPECT_EQ(table.Merge(a, b), merged);
+  EXPECT_EQ(table.Intern(SourceInfo({Loc(1), Loc(2), Loc(3)})), merged);
+}
+
+TEST(SourceInfoTableTest, NodesShareLocations) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package p
+
+file_number 1 "a.x"
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.3: bits[8] = add(x, y, pos=[(1,2,3)])
+  ret not.4: bits[8] = not(add.3, pos=[(1,2,3)])
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, f->GetNode("add.3"));
+  Node* ret = f->return_value();
+  EXPECT_EQ(&add->loc(), &ret->loc());
+  EXPECT_EQ(add->loc().ToString(), "[(1,2,3)]");
+
+  ret->SetLoc(SourceInfo(SourceLocation(Fileno(1), Lineno(5), Colno(6))));
+  EXPECT_EQ(ret->loc().ToString(), "[(1,5,6)]");
+  ret->MergeLoc(add);
+  EXPECT_EQ(ret->loc().ToString(), "[(1,5,6), (1,2,3)]");
+}
+
+}  // namespace
+}  // namespace xls
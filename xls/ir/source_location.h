@@ -17,6 +17,7 @@
 
 #include <compare>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -54,6 +55,13 @@ class SourceLocation {
     }
     return colno_.value() <=> other.colno_.value();
   }
+  bool operator==(const SourceLocation& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceLocation& loc) {
+    return H::combine(std::move(h), loc.fileno_.value(), loc.lineno_.value(),
+                      loc.colno_.value());
+  }
 
  private:
   Fileno fileno_;
@@ -71,6 +79,13 @@ struct SourceInfo {
 
   bool Empty() const { return locations.empty(); }
 
+  bool operator==(const SourceInfo& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceInfo& info) {
+    return H::combine(std::move(h), info.locations);
+  }
+
   std::string ToString() const {
     std::vector<std::string> strings;
     strings.reserve(locations.size());
@@ -0,0 +1,127 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/speculative_edit.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+
+SpeculativeEdit::SpeculativeEdit(Package* package) : package_(package) {
+  Commit();
+}
+
+absl::Status SpeculativeEdit::PrepareToModify(Function* f) {
+  XLS_RET_CHECK_EQ(f->package(), package_);
+  if (!original_function_bases_.contains(f) ||
+      absl::c_any_of(saved_functions_, [&](const auto& saved) {
+        return saved.first == f;
+      })) {
+    // Functions added during the edit are removed rather than restored.
+    return absl::OkStatus();
+  }
+  if (saved_package_ == nullptr) {
+    saved_package_ =
+        std::make_unique<Package>(absl::StrCat(package_->name(), "_saved"));
+  }
+  XLS_ASSIGN_OR_RETURN(Function * copy,
+                       f->Clone(f->name(), saved_package_.get()));
+  saved_functions_.push_back({f, copy});
+  return absl::OkStatus();
+}
+
+absl::Status SpeculativeEdit::Revert() {
+  std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+  absl::flat_hash_set<FunctionBase*> current(function_bases.begin(),
+                                             function_bases.end());
+  for (FunctionBase* fb : original_function_bases_) {
+    XLS_RET_CHECK(current.contains(fb))
+        << "Function bases must not be removed during a speculative edit";
+  }
+  for (const auto& [f, copy] : saved_functions_) {
+    XLS_RETURN_IF_ERROR(RestoreFunction(copy, f));
+  }
+  XLS_RETURN_IF_ERROR(package_->SetTop(original_top_));
+  for (FunctionBase* fb : function_bases) {
+    if (!original_function_bases_.contains(fb)) {
+      XLS_RETURN_IF_ERROR(package_->RemoveFunctionBase(fb));
+    }
+  }
+  Commit();
+  return absl::OkStatus();
+}
+
+void SpeculativeEdit::Commit() {
+  std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+  original_function_bases_ = absl::flat_hash_set<FunctionBase*>(
+      function_bases.begin(), function_bases.end());
+  original_top_ = package_->GetTop();
+  saved_functions_.clear();
+  saved_package_.reset();
+}
+
+/* static */ absl::Status SpeculativeEdit::RestoreFunction(Function* copy,
+                                                           Function* f) {
+  // Build the saved graph next to the modified one, then remove the modified
+  // nodes. Users come before their operands in reverse topological order so
+  // each node is unused when it is removed.
+  std::vector<Node*> modified_nodes = ReverseTopoSort(f);
+  absl::flat_hash_map<Node*, Node*> restored;
+  for (Param* param : copy->params()) {
+    XLS_ASSIGN_OR_RETURN(restored[param], param->CloneInNewFunction({}, f));
+  }
+  for (Node* node : TopoSort(copy)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operands.push_back(restored.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(restored[node], node->CloneInNewFunction(operands, f));
+  }
+  XLS_RETURN_IF_ERROR(f->set_return_value(restored.at(copy->return_value())));
+  for (Node* node : modified_nodes) {
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+  }
+
+  // The restored nodes were given unique names while the modified nodes still
+  // existed; now they can take back their original names.
+  for (const auto& [saved, node] : restored) {
+    if (saved->HasAssignedName()) {
+      node->SetNameDirectly(saved->GetName());
+    }
+  }
+  f->SetName(copy->name());
+  f->SetForeignFunctionData(copy->ForeignFunctionData());
+  return absl::OkStatus();
+}
+
+}  // namespace xls
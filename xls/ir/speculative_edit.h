@@ -0,0 +1,87 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_SPECULATIVE_EDIT_H_
+#define XLS_IR_SPECULATIVE_EDIT_H_
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Allows speculative changes to the functions of a package to be undone,
+// as a cheaper alternative to cloning the whole package before trying a
+// transformation which may be discarded. Only the functions which are about to
+// be modified are copied, and only when they are first modified; all other
+// function bases are never copied. For example:
+//
+//   SpeculativeEdit edit(package);
+//   XLS_RETURN_IF_ERROR(edit.PrepareToModify(f));
+//   ... modify f, add new function bases ...
+//   if (!improved) {
+//     XLS_RETURN_IF_ERROR(edit.Revert());
+//   }
+//
+// Reverting restores each prepared function in place, so pointers to the
+// function itself (e.g., from invokes elsewhere in the package) remain valid,
+// but pointers to its nodes do not and node ids may differ. Function bases
+// added since the edit started are removed and the top entity is restored.
+// Procs and blocks cannot be prepared for modification, and function bases
+// existing when the edit started must not be removed; use ClonePackage for such
+// changes.
+class SpeculativeEdit {
+ public:
+  explicit SpeculativeEdit(Package* package);
+
+  SpeculativeEdit(const SpeculativeEdit&) = delete;
+  SpeculativeEdit& operator=(const SpeculativeEdit&) = delete;
+
+  // Saves a copy of `f` so changes to it can be reverted. Must be called before
+  // `f` is first modified; later calls for the same function do nothing.
+  absl::Status PrepareToModify(Function* f);
+
+  // Undoes all changes to the prepared functions and removes function bases
+  // added since the edit started (or was last reverted or committed). The edit
+  // can then be used for another speculative change.
+  absl::Status Revert();
+
+  // Keeps all changes made so far and starts a new speculative change.
+  void Commit();
+
+ private:
+  // Restores `f` to the state saved in `copy`.
+  static absl::Status RestoreFunction(Function* copy, Function* f);
+
+  Package* package_;
+
+  // Function bases and top entity of the package when the edit started.
+  absl::flat_hash_set<FunctionBase*> original_function_bases_;
+  std::optional<FunctionBase*> original_top_;
+
+  // Holds the copies of the prepared functions, in order of preparation.
+  std::unique_ptr<Package> saved_package_;
+  std::vector<std::pair<Function*, Function*>> saved_functions_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_SPECULATIVE_EDIT_H_
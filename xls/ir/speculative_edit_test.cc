@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/speculative_edit.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/verifier.h"
+
+namespace m = xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class SpeculativeEditTest : public IrTestBase {
+ protected:
+  // Builds `callee(x, y) = x + y` and `caller(a) = callee(a, a)`, with `caller`
+  // as top.
+  void BuildPackage(Package* p) {
+    FunctionBuilder fb("callee", p);
+    fb.Add(fb.Param("x", p->GetBitsType(32)), fb.Param("y", p->GetBitsType(32)),
+           SourceInfo(), "sum");
+    XLS_ASSERT_OK_AND_ASSIGN(callee_, fb.Build());
+    FunctionBuilder fb2("caller", p);
+    BValue a = fb2.Param("a", p->GetBitsType(32));
+    fb2.Invoke({a, a}, callee_);
+    XLS_ASSERT_OK_AND_ASSIGN(caller_, fb2.Build());
+    XLS_ASSERT_OK(p->SetTop(caller_));
+  }
+
+  Function* callee_ = nullptr;
+  Function* caller_ = nullptr;
+};
+
+TEST_F(SpeculativeEditTest, RevertRestoresPreparedFunctions) {
+  auto p = CreatePackage();
+  BuildPackage(p.get());
+  SpeculativeEdit edit(p.get());
+  XLS_ASSERT_OK(edit.PrepareToModify(callee_));
+  XLS_ASSERT_OK(edit.PrepareToModify(callee_));
+
+  Node* sum = callee_->return_value();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * diff,
+      callee_->MakeNodeWithName<BinOp>(SourceInfo(), sum->operand(0),
+                                       sum->operand(1), Op::kSub, "diff"));
+  XLS_ASSERT_OK(sum->ReplaceUsesWith(diff));
+  XLS_ASSERT_OK(callee_->RemoveNode(sum));
+  ASSERT_THAT(callee_->return_value(), m::Sub(m::Param("x"), m::Param("y")));
+
+  XLS_ASSERT_OK(edit.Revert());
+  EXPECT_THAT(callee_->return_value(), m::Add(m::Param("x"), m::Param("y")));
+  EXPECT_EQ(callee_->return_value()->GetName(), "sum");
+  ASSERT_EQ(callee_->params().size(), 2);
+  EXPECT_EQ(callee_->param(0)->GetName(), "x");
+  EXPECT_EQ(callee_->param(1)->GetName(), "y");
+  EXPECT_EQ(callee_->node_count(), 3);
+  EXPECT_EQ(caller_->return_value()->As<Invoke>()->to_apply(), callee_);
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+TEST_F(SpeculativeEditTest, RevertRemovesAddedFunctionBases) {
+  auto p = CreatePackage();
+  BuildPackage(p.get());
+  SpeculativeEdit edit(p.get());
+
+  FunctionBuilder fb("added", p.get());
+  fb.Not(fb.Param("z", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * added, fb.Build());
+  // Preparing a function added during the edit copies nothing.
+  XLS_ASSERT_OK(edit.PrepareToModify(added));
+  XLS_ASSERT_OK(p->SetTop(added));
+
+  XLS_ASSERT_OK(edit.Revert());
+  EXPECT_THAT(p->GetFunctionBases(), ElementsAre(callee_, caller_));
+  EXPECT_EQ(p->GetTop(), caller_);
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+TEST_F(SpeculativeEditTest, CommitKeepsChanges) {
+  auto p = CreatePackage();
+  BuildPackage(p.get());
+  SpeculativeEdit edit(p.get());
+  XLS_ASSERT_OK(edit.PrepareToModify(callee_));
+
+  Node* sum = callee_->return_value();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * negated,
+      callee_->MakeNode<UnOp>(SourceInfo(), sum, Op::kNeg));
+  XLS_ASSERT_OK(callee_->set_return_value(negated));
+  edit.Commit();
+
+  // Nothing was prepared since the commit, so reverting changes nothing.
+  XLS_ASSERT_OK(edit.Revert());
+  EXPECT_THAT(callee_->return_value(),
+              m::Neg(m::Add(m::Param("x"), m::Param("y"))));
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,510 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/streaming_ir_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_package.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using Declaration = StreamingIrParser::Declaration;
+
+constexpr std::string_view kTripleQuote = R"(""")";
+
+// Keyword arguments whose value names another function, proc or block.
+constexpr std::array<std::string_view, 4> kReferenceKeywords = {
+    "to_apply", "body", "proc", "block"};
+
+bool IsIdentifierStart(char c) { return absl::ascii_isalpha(c) || c == '_'; }
+
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(c) || c == '_' || c == '.';
+}
+
+// Returns the identifier at the start of `s` (possibly empty).
+std::string_view LeadingIdentifier(std::string_view s) {
+  if (s.empty() || !IsIdentifierStart(s.front())) {
+    return {};
+  }
+  int64_t length = 1;
+  while (length < s.size() && IsIdentifierChar(s[length])) {
+    ++length;
+  }
+  return s.substr(0, length);
+}
+
+// Removes leading `#[...]` attributes and whitespace from a declaration
+// header. String contents have already been removed from the header.
+std::string_view StripAttributes(std::string_view header) {
+  header = absl::StripLeadingAsciiWhitespace(header);
+  while (absl::StartsWith(header, "#[")) {
+    int64_t depth = 0;
+    int64_t i = 1;
+    for (; i < header.size(); ++i) {
+      if (header[i] == '[') {
+        ++depth;
+      } else if (header[i] == ']' && --depth == 0) {
+        break;
+      }
+    }
+    header = absl::StripLeadingAsciiWhitespace(header.substr(
+        std::min<int64_t>(i + 1, header.size())));
+  }
+  return header;
+}
+
+// Streams over the lines of a textual package and splits it into top-level
+// declarations. Braces, parentheses and brackets are matched outside of
+// strings and comments to find where each declaration ends.
+class DeclarationIndexer {
+ public:
+  absl::Status AddLine(std::string_view line, int64_t offset) {
+    ++lineno_;
+    code_.clear();
+    for (int64_t i = 0; i < line.size(); ++i) {
+      std::string_view rest = line.substr(i);
+      char c = line[i];
+      if (in_triple_quote_) {
+        if (absl::StartsWith(rest, kTripleQuote)) {
+          in_triple_quote_ = false;
+          i += kTripleQuote.size() - 1;
+        }
+        continue;
+      }
+      if (absl::StartsWith(rest, "//")) {
+        break;
+      }
+      if (absl::ascii_isspace(c)) {
+        AppendCode(' ');
+        continue;
+      }
+      if (!start_.has_value()) {
+        start_ = offset + i;
+        header_.clear();
+        header_done_ = false;
+        saw_brace_ = false;
+        references_.clear();
+      }
+      if (absl::StartsWith(rest, kTripleQuote)) {
+        in_triple_quote_ = true;
+        i += kTripleQuote.size() - 1;
+        AppendCode(' ');
+        continue;
+      }
+      if (c == '"') {
+        ++i;
+        while (i < line.size() && line[i] != '"') {
+          i += line[i] == '\\' ? 2 : 1;
+        }
+        if (i >= line.size()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Unterminated quoted string on line %d", lineno_));
+        }
+        AppendCode(' ');
+        continue;
+      }
+      if (!header_done_ && ((c == '(' && bracket_depth_ == 0) || c == '{')) {
+        header_done_ = true;
+      }
+      AppendCode(c);
+      switch (c) {
+        case '(':
+          ++paren_depth_;
+          break;
+        case ')':
+          --paren_depth_;
+          break;
+        case '[':
+          ++bracket_depth_;
+          break;
+        case ']':
+          --bracket_depth_;
+          break;
+        case '{':
+          ++brace_depth_;
+          if (paren_depth_ == 0) {
+            saw_brace_ = true;
+          }
+          break;
+        case '}':
+          --brace_depth_;
+          break;
+        default:
+          break;
+      }
+      if (paren_depth_ < 0 || bracket_depth_ < 0 || brace_depth_ < 0) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Unbalanced '%c' on line %d", c, lineno_));
+      }
+      if (c == '}' && saw_brace_ && AtTopLevel()) {
+        XLS_RETURN_IF_ERROR(EndDeclaration(offset + i + 1));
+      }
+    }
+    if (start_.has_value()) {
+      ScanReferences();
+      // Declarations without a body end with the line they are closed on.
+      if (!in_triple_quote_ && !saw_brace_ && AtTopLevel()) {
+        std::string_view header = StripAttributes(header_);
+        std::string_view keyword = LeadingIdentifier(header);
+        if (keyword == "package" || keyword == "chan" ||
+            keyword == "file_number") {
+          XLS_RETURN_IF_ERROR(EndDeclaration(offset + line.size()));
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Finish() {
+    if (start_.has_value() || in_triple_quote_) {
+      return absl::InvalidArgumentError(
+          "Unexpected end of input within a declaration");
+    }
+    if (!package_name_.has_value()) {
+      return absl::InvalidArgumentError("Expected `package` declaration");
+    }
+    return absl::OkStatus();
+  }
+
+  std::string package_name() const { return package_name_.value_or(""); }
+  std::vector<Declaration>& declarations() { return declarations_; }
+
+ private:
+  bool AtTopLevel() const {
+    return paren_depth_ == 0 && bracket_depth_ == 0 && brace_depth_ == 0;
+  }
+
+  void AppendCode(char c) {
+    if (start_.has_value()) {
+      code_.push_back(c);
+      if (!header_done_) {
+        header_.push_back(c);
+      }
+    }
+  }
+
+  // Records the names given to reference keywords in the code seen so far on
+  // the current line.
+  void ScanReferences() {
+    std::string_view code = code_;
+    for (int64_t i = 0; i < code.size(); ++i) {
+      if (code[i] != '=' || i == 0) {
+        continue;
+      }
+      int64_t start = i;
+      while (start > 0 && IsIdentifierChar(code[start - 1])) {
+        --start;
+      }
+      std::string_view keyword = code.substr(start, i - start);
+      if (absl::c_find(kReferenceKeywords, keyword) ==
+          kReferenceKeywords.end()) {
+        continue;
+      }
+      std::string_view name = LeadingIdentifier(code.substr(i + 1));
+      if (!name.empty()) {
+        references_.push_back(std::string(name));
+      }
+    }
+    code_.clear();
+  }
+
+  absl::Status EndDeclaration(int64_t end) {
+    ScanReferences();
+    std::string_view header = StripAttributes(header_);
+    bool is_top = false;
+    std::string_view keyword = LeadingIdentifier(header);
+    if (keyword == "top") {
+      is_top = true;
+      header = absl::StripLeadingAsciiWhitespace(header.substr(keyword.size()));
+      keyword = LeadingIdentifier(header);
+    }
+    std::string_view name = LeadingIdentifier(
+        absl::StripLeadingAsciiWhitespace(header.substr(keyword.size())));
+    int64_t start = *start_;
+    start_ = std::nullopt;
+
+    if (keyword == "package") {
+      if (package_name_.has_value()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Duplicate `package` declaration on line %d", lineno_));
+      }
+      package_name_ = std::string(name);
+      return absl::OkStatus();
+    }
+    if (!package_name_.has_value()) {
+      return absl::InvalidArgumentError("Expected `package` declaration");
+    }
+    Declaration declaration;
+    if (keyword == "file_number") {
+      declaration.kind = Declaration::Kind::kFileNumber;
+    } else if (keyword == "chan") {
+      declaration.kind = Declaration::Kind::kChannel;
+    } else if (keyword == "fn") {
+      declaration.kind = Declaration::Kind::kFunction;
+    } else if (keyword == "proc") {
+      declaration.kind = Declaration::Kind::kProc;
+    } else if (keyword == "block") {
+      declaration.kind = Declaration::Kind::kBlock;
+    } else {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Expected attribute or declaration (`fn`, `proc`, `block`, `chan`, "
+          "`file_number`) ending on line %d, got `%s`",
+          lineno_, keyword));
+    }
+    if (declaration.kind != Declaration::Kind::kFileNumber) {
+      declaration.name = std::string(name);
+    }
+    declaration.is_top = is_top;
+    declaration.offset = start;
+    declaration.size = end - start;
+    declaration.references = std::move(references_);
+    references_.clear();
+    declarations_.push_back(std::move(declaration));
+    return absl::OkStatus();
+  }
+
+  int64_t lineno_ = 0;
+  bool in_triple_quote_ = false;
+  int64_t paren_depth_ = 0;
+  int64_t bracket_depth_ = 0;
+  int64_t brace_depth_ = 0;
+
+  // State of the declaration currently being scanned.
+  std::optional<int64_t> start_;
+  // Code before the first top-level '(' or '{' of the declaration, which
+  // holds its attributes, keyword and name.
+  std::string header_;
+  bool header_done_ = false;
+  bool saw_brace_ = false;
+  std::vector<std::string> references_;
+  // Code (outside of strings and comments) on the current line.
+  std::string code_;
+
+  std::optional<std::string> package_name_;
+  std::vector<Declaration> declarations_;
+};
+
+bool IsStdin(const std::filesystem::path& path) {
+  return path == "-" || path == "/dev/stdin";
+}
+
+}  // namespace
+
+absl::Status StreamingIrParser::Index(std::istream& stream) {
+  DeclarationIndexer indexer;
+  std::string line;
+  int64_t offset = 0;
+  while (std::getline(stream, line)) {
+    XLS_RETURN_IF_ERROR(indexer.AddLine(line, offset));
+    offset += line.size() + 1;
+  }
+  XLS_RETURN_IF_ERROR(indexer.Finish());
+  package_name_ = indexer.package_name();
+  declarations_ = std::move(indexer.declarations());
+  for (int64_t i = 0; i < declarations_.size(); ++i) {
+    const Declaration& declaration = declarations_[i];
+    if (declaration.kind == Declaration::Kind::kFunction ||
+        declaration.kind == Declaration::Kind::kProc ||
+        declaration.kind == Declaration::Kind::kBlock) {
+      entities_by_name_[declaration.name].push_back(i);
+    }
+  }
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<StreamingIrParser>>
+StreamingIrParser::OpenFile(const std::filesystem::path& path) {
+  if (IsStdin(path)) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    return FromString(std::move(contents));
+  }
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return absl::NotFoundError(
+        absl::StrCat("Unable to open IR file: ", path.string()));
+  }
+  auto parser = absl::WrapUnique(new StreamingIrParser());
+  parser->path_ = path;
+  XLS_RETURN_IF_ERROR(parser->Index(stream)) << "@ " << path.string();
+  return parser;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<StreamingIrParser>>
+StreamingIrParser::FromString(std::string ir) {
+  auto parser = absl::WrapUnique(new StreamingIrParser());
+  std::istringstream stream(ir);
+  XLS_RETURN_IF_ERROR(parser->Index(stream));
+  parser->contents_ = std::move(ir);
+  return parser;
+}
+
+std::optional<std::string_view> StreamingIrParser::top() const {
+  for (const Declaration& declaration : declarations_) {
+    if (declaration.is_top) {
+      return declaration.name;
+    }
+  }
+  return std::nullopt;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> StreamingIrParser::ParseEntity(
+    std::optional<std::string_view> name) {
+  if (!name.has_value()) {
+    name = top();
+    if (!name.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Package `%s` has no top entity and none was specified",
+          package_name_));
+    }
+  }
+  auto it = entities_by_name_.find(*name);
+  if (it == entities_by_name_.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "No function, proc or block named `%s` in package `%s`", *name,
+        package_name_));
+  }
+
+  absl::flat_hash_set<int64_t> selected;
+  std::deque<int64_t> worklist(it->second.begin(), it->second.end());
+  while (!worklist.empty()) {
+    int64_t index = worklist.front();
+    worklist.pop_front();
+    if (!selected.insert(index).second) {
+      continue;
+    }
+    for (const std::string& reference : declarations_[index].references) {
+      auto ref_it = entities_by_name_.find(reference);
+      if (ref_it != entities_by_name_.end()) {
+        worklist.insert(worklist.end(), ref_it->second.begin(),
+                        ref_it->second.end());
+      }
+    }
+  }
+
+  // Keep the original order as definitions must precede their uses.
+  std::vector<const Declaration*> declarations;
+  for (int64_t i = 0; i < declarations_.size(); ++i) {
+    const Declaration& declaration = declarations_[i];
+    if (declaration.kind == Declaration::Kind::kFileNumber ||
+        declaration.kind == Declaration::Kind::kChannel ||
+        selected.contains(i)) {
+      declarations.push_back(&declaration);
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParseDeclarations(declarations));
+  XLS_RETURN_IF_ERROR(package->SetTopByName(*name));
+  return package;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> StreamingIrParser::ParseAll() {
+  std::vector<const Declaration*> declarations;
+  declarations.reserve(declarations_.size());
+  for (const Declaration& declaration : declarations_) {
+    declarations.push_back(&declaration);
+  }
+  return ParseDeclarations(declarations);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> StreamingIrParser::ParseDeclarations(
+    absl::Span<const Declaration* const> declarations) {
+  std::string ir = absl::StrCat("package ", package_name_, "\n\n");
+  std::optional<std::ifstream> stream;
+  if (!contents_.has_value()) {
+    XLS_RET_CHECK(path_.has_value());
+    stream.emplace(*path_, std::ios::binary);
+    if (!*stream) {
+      return absl::NotFoundError(
+          absl::StrCat("Unable to reopen IR file: ", path_->string()));
+    }
+  }
+  for (const Declaration* declaration : declarations) {
+    int64_t start = ir.size();
+    if (contents_.has_value()) {
+      absl::StrAppend(&ir, std::string_view(*contents_).substr(
+                               declaration->offset, declaration->size));
+    } else {
+      ir.resize(start + declaration->size);
+      stream->seekg(declaration->offset);
+      stream->read(ir.data() + start, declaration->size);
+      if (!*stream) {
+        return absl::DataLossError(absl::StrFormat(
+            "Unable to read declaration `%s` from %s; was the file modified?",
+            declaration->name, path_->string()));
+      }
+    }
+    absl::StrAppend(&ir, "\n");
+  }
+  std::optional<std::string> filename;
+  if (path_.has_value()) {
+    filename = path_->string();
+  }
+  return Parser::ParsePackage(ir, filename);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFileForEntity(
+    const std::filesystem::path& path, std::optional<std::string_view> entity) {
+  bool is_binary = false;
+  if (!IsStdin(path)) {
+    std::ifstream stream(path, std::ios::binary);
+    std::string magic(kBinaryPackageMagic.size(), '\0');
+    stream.read(magic.data(), magic.size());
+    is_binary = stream && IsBinaryPackage(magic);
+  }
+  if (is_binary || IsStdin(path)) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ReadPackageFile(path));
+    if (entity.has_value()) {
+      XLS_RETURN_IF_ERROR(package->SetTopByName(*entity));
+    }
+    return package;
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<StreamingIrParser> parser,
+                       StreamingIrParser::OpenFile(path));
+  return parser->ParseEntity(entity);
+}
+
+}  // namespace xls
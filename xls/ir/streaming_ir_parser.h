@@ -0,0 +1,114 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_STREAMING_IR_PARSER_H_
+#define XLS_IR_STREAMING_IR_PARSER_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Parser for large textual IR packages which only materializes the parts that
+// are needed. Construction streams over the input once, line by line, and
+// records the extent of every top-level declaration along with the functions,
+// procs and blocks it refers to (`to_apply=`, `body=`, `proc=` and `block=`
+// arguments). No tokenization or IR construction happens at that point.
+// ParseEntity then reads back and parses only a single entity and its
+// transitive dependencies.
+//
+// File numbers and channels are small and are always included.
+class StreamingIrParser {
+ public:
+  struct Declaration {
+    enum class Kind { kFileNumber, kChannel, kFunction, kProc, kBlock };
+
+    Kind kind;
+    // Empty for file numbers.
+    std::string name;
+    // Whether the declaration is marked with the `top` keyword.
+    bool is_top = false;
+    // Extent of the declaration (including any attributes) in the input.
+    int64_t offset = 0;
+    int64_t size = 0;
+    // Names of the functions, procs and blocks the declaration refers to.
+    // This is conservative: names which are not declared are ignored.
+    std::vector<std::string> references;
+  };
+
+  // Indexes the IR file at `path`. The file is read again by ParseEntity, so
+  // when reading from stdin ("-" or "/dev/stdin") the whole input is retained
+  // in memory instead.
+  static absl::StatusOr<std::unique_ptr<StreamingIrParser>> OpenFile(
+      const std::filesystem::path& path);
+
+  // Indexes the given IR text.
+  static absl::StatusOr<std::unique_ptr<StreamingIrParser>> FromString(
+      std::string ir);
+
+  const std::string& package_name() const { return package_name_; }
+  absl::Span<const Declaration> declarations() const { return declarations_; }
+
+  // Name of the entity marked `top` in the input, if any.
+  std::optional<std::string_view> top() const;
+
+  // Parses the function, proc or block `name` (or the `top` entity if
+  // unspecified) and everything it transitively refers to. The entity is the
+  // top of the returned package, which is verified.
+  absl::StatusOr<std::unique_ptr<Package>> ParseEntity(
+      std::optional<std::string_view> name = std::nullopt);
+
+  // Parses the entire package.
+  absl::StatusOr<std::unique_ptr<Package>> ParseAll();
+
+ private:
+  StreamingIrParser() = default;
+
+  // Indexes the input read from `stream`.
+  absl::Status Index(std::istream& stream);
+
+  absl::StatusOr<std::unique_ptr<Package>> ParseDeclarations(
+      absl::Span<const Declaration* const> declarations);
+
+  std::optional<std::filesystem::path> path_;
+  std::optional<std::string> contents_;
+  std::string package_name_;
+  std::vector<Declaration> declarations_;
+  // Index of function, proc and block declarations by name.
+  absl::flat_hash_map<std::string, std::vector<int64_t>> entities_by_name_;
+};
+
+// Reads the package in the IR file at `path` keeping only `entity` (or the
+// top entity if unspecified) and the functions, procs and blocks it depends
+// on. Textual IR is parsed with StreamingIrParser; binary packages (see
+// binary_package.h) are loaded whole as they are cheap to load.
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFileForEntity(
+    const std::filesystem::path& path,
+    std::optional<std::string_view> entity = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_IR_STREAMING_IR_PARSER_H_
@@ -0,0 +1,183 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/streaming_ir_parser.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/binary_package.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using Kind = StreamingIrParser::Declaration::Kind;
+
+constexpr std::string_view kIr = R"(package test
+
+file_number 0 "foo.x"
+
+chan ch(bits[32], id=0, kind=streaming, flow_control=ready_valid,
+        ops=send_only, metadata="")
+
+// A comment with a stray brace {
+fn leaf(x: bits[32]) -> bits[32] {
+  ret not.1: bits[32] = not(x, id=1)
+}
+
+fn unused(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+
+fn mid(x: bits[32], t: token, c: bits[1]) -> bits[32] {
+  assert.3: token = assert(t, c, message="unbalanced { in a string", id=3)
+  ret invoke.4: bits[32] = invoke(x, to_apply=leaf, id=4)
+}
+
+#[initiation_interval(2)]
+top fn main(x: bits[32], t: token, c: bits[1]) -> bits[32] {
+  ret invoke.5: bits[32] = invoke(x, t, c, to_apply=mid, id=5)
+}
+
+proc p(tkn: token, st: bits[32], init={token, 0}) {
+  send.6: token = send(tkn, st, channel=ch, id=6)
+  next (send.6, st)
+}
+)";
+
+std::vector<std::string> FunctionNames(const Package& package) {
+  std::vector<std::string> names;
+  for (const auto& f : package.functions()) {
+    names.push_back(f->name());
+  }
+  return names;
+}
+
+TEST(StreamingIrParserTest, IndexesDeclarations) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StreamingIrParser> parser,
+                           StreamingIrParser::FromString(std::string(kIr)));
+  EXPECT_EQ(parser->package_name(), "test");
+  EXPECT_EQ(parser->top(), "main");
+
+  std::vector<Kind> kinds;
+  std::vector<std::string> names;
+  for (const StreamingIrParser::Declaration& d : parser->declarations()) {
+    kinds.push_back(d.kind);
+    names.push_back(d.name);
+  }
+  EXPECT_THAT(kinds, ElementsAre(Kind::kFileNumber, Kind::kChannel,
+                                 Kind::kFunction, Kind::kFunction,
+                                 Kind::kFunction, Kind::kFunction,
+                                 Kind::kProc));
+  EXPECT_THAT(names,
+              ElementsAre("", "ch", "leaf", "unused", "mid", "main", "p"));
+  EXPECT_THAT(parser->declarations()[4].references, ElementsAre("leaf"));
+  // The extent of a declaration includes its attributes.
+  const StreamingIrParser::Declaration& main = parser->declarations()[5];
+  EXPECT_TRUE(kIr.substr(main.offset, main.size).starts_with("#["));
+  EXPECT_TRUE(kIr.substr(main.offset, main.size).ends_with("}"));
+}
+
+TEST(StreamingIrParserTest, ParseTopEntityAndCallees) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StreamingIrParser> parser,
+                           StreamingIrParser::FromString(std::string(kIr)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           parser->ParseEntity());
+  EXPECT_THAT(FunctionNames(*package), ElementsAre("leaf", "mid", "main"));
+  EXPECT_TRUE(package->procs().empty());
+  EXPECT_EQ(package->GetTop().value()->name(), "main");
+  EXPECT_EQ(package->GetTop().value()->GetInitiationInterval(), 2);
+}
+
+TEST(StreamingIrParserTest, ParseNamedEntity) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StreamingIrParser> parser,
+                           StreamingIrParser::FromString(std::string(kIr)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> proc_package,
+                           parser->ParseEntity("p"));
+  EXPECT_TRUE(proc_package->functions().empty());
+  EXPECT_EQ(proc_package->procs().size(), 1);
+  EXPECT_EQ(proc_package->channels().size(), 1);
+  EXPECT_EQ(proc_package->GetTop().value()->name(), "p");
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> leaf_package,
+                           parser->ParseEntity("leaf"));
+  EXPECT_THAT(FunctionNames(*leaf_package), ElementsAre("leaf"));
+
+  EXPECT_THAT(parser->ParseEntity("nonexistent"),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("nonexistent")));
+}
+
+TEST(StreamingIrParserTest, ParseAllMatchesParser) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> expected,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StreamingIrParser> parser,
+                           StreamingIrParser::FromString(std::string(kIr)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           parser->ParseAll());
+  EXPECT_EQ(package->DumpIr(), expected->DumpIr());
+}
+
+TEST(StreamingIrParserTest, ReadFromFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent(kIr, ".ir"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StreamingIrParser> parser,
+                           StreamingIrParser::OpenFile(file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           parser->ParseEntity("mid"));
+  EXPECT_THAT(FunctionNames(*package), ElementsAre("leaf", "mid"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> top_package,
+                           ReadPackageFileForEntity(file.path()));
+  EXPECT_THAT(FunctionNames(*top_package), ElementsAre("leaf", "mid", "main"));
+}
+
+TEST(StreamingIrParserTest, ReadBinaryFileForEntity) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinary(*package));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent(binary, ".irb"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> loaded,
+                           ReadPackageFileForEntity(file.path(), "leaf"));
+  EXPECT_EQ(loaded->GetTop().value()->name(), "leaf");
+}
+
+TEST(StreamingIrParserTest, MalformedInput) {
+  EXPECT_THAT(StreamingIrParser::FromString("fn f() -> () {\n}\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected `package`")));
+  EXPECT_THAT(
+      StreamingIrParser::FromString("package p\n\nfn f(x: bits[1]) -> () {\n"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Unexpected end of input")));
+  EXPECT_THAT(StreamingIrParser::FromString("package p\n\nfoo bar() {\n}\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected attribute or declaration")));
+}
+
+}  // namespace
+}  // namespace xls
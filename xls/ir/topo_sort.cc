@@ -25,14 +25,16 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
+namespace {
 
-std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+std::vector<Node*> ComputeReverseTopoSort(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -155,6 +157,16 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   return ordered;
 }
 
+}  // namespace
+
+std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+  absl::MutexLock lock(&f->topo_sort_mutex_);
+  if (!f->reverse_topo_sort_cache_.has_value()) {
+    f->reverse_topo_sort_cache_ = ComputeReverseTopoSort(f);
+  }
+  return *f->reverse_topo_sort_cache_;
+}
+
 std::vector<Node*> TopoSort(FunctionBase* f) {
   std::vector<Node*> ordered = ReverseTopoSort(f);
   std::reverse(ordered.begin(), ordered.end());
@@ -32,7 +32,9 @@ namespace xls {
 // satisfied).
 //
 // Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// incrementally as iteration proceeds. The order is cached in the function
+// base until the graph next changes, so repeated sorts of an unchanged function
+// base only copy the cached order.
 std::vector<Node*> TopoSort(FunctionBase* f);
 
 // As above, but returns a reverse topo order.
@@ -288,6 +288,36 @@ TEST(NodeIteratorTest, RpoVsTopo) {
 
 // LINT.ThenChange(//xls/ir/block_elaboration_test.cc)
 
+TEST(NodeIteratorTest, CachedOrderFollowsChanges) {
+  std::string program = R"(
+  fn f(a: bits[32]) -> bits[32] {
+    b: bits[32] = neg(a)
+    ret c: bits[32] = not(b)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  Node* a = *f->GetNode("a");
+  Node* b = *f->GetNode("b");
+  Node* c = *f->GetNode("c");
+  EXPECT_EQ(TopoSort(f), std::vector<Node*>({a, b, c}));
+  EXPECT_EQ(TopoSort(f), std::vector<Node*>({a, b, c}));
+
+  // Insert a node between `a` and `b`.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * d,
+                           f->MakeNodeWithName<UnOp>(SourceInfo(), a,
+                                                     Op::kNot, "d"));
+  XLS_ASSERT_OK(b->ReplaceOperandNumber(0, d));
+  EXPECT_EQ(TopoSort(f), std::vector<Node*>({a, d, b, c}));
+  EXPECT_EQ(ReverseTopoSort(f), std::vector<Node*>({c, b, d, a}));
+
+  // Make `d` the return value, leaving `b` and `c` dead.
+  XLS_ASSERT_OK(f->set_return_value(d));
+  XLS_ASSERT_OK(f->RemoveNode(c));
+  XLS_ASSERT_OK(f->RemoveNode(b));
+  EXPECT_EQ(TopoSort(f), std::vector<Node*>({a, d}));
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
@@ -20,12 +20,14 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/xls_type.pb.h"
 
@@ -74,6 +76,31 @@ absl::StatusOr<TupleType*> Type::AsTuple() {
       absl::StrCat("Type is not a tuple: ", *this));
 }
 
+absl::Span<Type* const> Type::leaf_types() const {
+  absl::call_once(leaf_types_cache_.once, [this]() {
+    std::vector<Type*>& types = leaf_types_cache_.types;
+    types.reserve(leaf_count());
+    if (IsBits() || IsToken()) {
+      types.push_back(const_cast<Type*>(this));
+    } else if (IsArray()) {
+      absl::Span<Type* const> element_leaf_types =
+          AsArrayOrDie()->element_type()->leaf_types();
+      for (int64_t i = 0; i < AsArrayOrDie()->size(); ++i) {
+        types.insert(types.end(), element_leaf_types.begin(),
+                     element_leaf_types.end());
+      }
+    } else {
+      CHECK(IsTuple());
+      for (Type* element_type : AsTupleOrDie()->element_types()) {
+        absl::Span<Type* const> element_leaf_types = element_type->leaf_types();
+        types.insert(types.end(), element_leaf_types.begin(),
+                     element_leaf_types.end());
+      }
+    }
+  });
+  return leaf_types_cache_.types;
+}
+
 TypeProto BitsType::ToProto() const {
   TypeProto proto;
   proto.set_type_enum(TypeProto::BITS);
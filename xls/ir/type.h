@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
@@ -87,6 +88,11 @@ class Type {
   // Returns the number of leaf Bits types in this object.
   virtual int64_t leaf_count() const = 0;
 
+  // Returns the leaf (bits and token) types of this type in the order of the
+  // flattened leaf elements, which is the order used by LeafTypeTree. Computed
+  // on first use and cached for the lifetime of the type.
+  absl::Span<Type* const> leaf_types() const;
+
   virtual std::string ToString() const = 0;
 
   template <typename Sink>
@@ -98,7 +104,19 @@ class Type {
   explicit Type(TypeKind kind) : kind_(kind) {}
 
  private:
+  // Lazily computed result of leaf_types(). Not copied along with the type as
+  // the leaf types of a bits or token type refer to the type itself.
+  struct LeafTypesCache {
+    LeafTypesCache() = default;
+    LeafTypesCache(const LeafTypesCache&) {}
+    LeafTypesCache& operator=(const LeafTypesCache&) { return *this; }
+
+    absl::once_flag once;
+    std::vector<Type*> types;
+  };
+
   TypeKind kind_;
+  mutable LeafTypesCache leaf_types_cache_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Type& type);
@@ -133,7 +151,9 @@ class TupleType : public Type {
   explicit TupleType(absl::Span<Type* const> members)
       : Type(TypeKind::kTuple), members_(members.begin(), members.end()) {
     leaf_count_ = 0;
+    element_leaf_offsets_.reserve(members.size());
     for (Type* t : members) {
+      element_leaf_offsets_.push_back(leaf_count_);
       leaf_count_ += t->leaf_count();
     }
   }
@@ -152,6 +172,12 @@ class TupleType : public Type {
   // Returns the element types of the tuple.
   absl::Span<Type* const> element_types() const { return members_; }
 
+  // Returns the number of leaves in the elements before the given element,
+  // i.e. the offset of its first leaf in the flattened leaf elements.
+  int64_t element_leaf_offset(int64_t index) const {
+    return element_leaf_offsets_.at(index);
+  }
+
   int64_t leaf_count() const override { return leaf_count_; }
 
   int64_t GetFlatBitCount() const override {
@@ -165,6 +191,7 @@ class TupleType : public Type {
  private:
   int64_t leaf_count_;
   std::vector<Type*> members_;
+  std::vector<int64_t> element_leaf_offsets_;
 };
 
 // Represents a type that is a one-dimensional array of identical types.
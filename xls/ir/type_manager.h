@@ -20,9 +20,11 @@
 #include <utility>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -30,6 +32,8 @@
 
 namespace xls {
 
+// Owns and interns the types of a package. Interning is thread-safe so that
+// passes may run concurrently on different function bases of one package.
 class TypeManager {
  public:
   explicit TypeManager();
@@ -39,9 +43,11 @@ class TypeManager {
   TypeManager& operator=(const TypeManager&) = delete;
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(&mutex_);
+    return IsOwnedTypeLocked(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
+    absl::MutexLock lock(&mutex_);
     return owned_function_types_.find(function_type) !=
            owned_function_types_.end();
   }
@@ -64,33 +70,45 @@ class TypeManager {
   Type* GetTypeForValue(const Value& value);
 
  private:
+  bool IsOwnedTypeLocked(const Type* type) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return owned_types_.find(type) != owned_types_.end();
+  }
+
+  // Guards the interning tables below. The interned types themselves are
+  // immutable and have stable addresses so they may be used without the lock.
+  mutable absl::Mutex mutex_;
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_ ABSL_GUARDED_BY(mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_ ABSL_GUARDED_BY(mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_ ABSL_GUARDED_BY(mutex_);
 
   // Owned token type.
   TokenType token_type_;
 
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  absl::node_hash_map<std::string, FunctionType> function_types_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -26,7 +26,9 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 
 TEST(TypeTest, TestVariousTypes) {
   BitsType b42(42);
@@ -132,6 +134,28 @@ TEST(TypeTest, TestVariousTypes) {
   EXPECT_FALSE(f_type1.IsEqualTo(&f_type5));
 }
 
+TEST(TypeTest, LeafTypesAndOffsets) {
+  BitsType b32(32);
+  BitsType b8(8);
+  TokenType token;
+  ArrayType a(3, &b8);
+  TupleType t_empty({});
+  TupleType t({&b32, &t_empty, &a, &token});
+
+  EXPECT_THAT(b32.leaf_types(), ElementsAre(&b32));
+  EXPECT_THAT(token.leaf_types(), ElementsAre(&token));
+  EXPECT_THAT(a.leaf_types(), ElementsAre(&b8, &b8, &b8));
+  EXPECT_THAT(t_empty.leaf_types(), IsEmpty());
+  EXPECT_THAT(t.leaf_types(), ElementsAre(&b32, &b8, &b8, &b8, &token));
+  // The leaf types are computed once and then shared.
+  EXPECT_EQ(t.leaf_types().data(), t.leaf_types().data());
+
+  EXPECT_EQ(t.element_leaf_offset(0), 0);
+  EXPECT_EQ(t.element_leaf_offset(1), 1);
+  EXPECT_EQ(t.element_leaf_offset(2), 1);
+  EXPECT_EQ(t.element_leaf_offset(3), 4);
+}
+
 TEST(TypeTest, ArrayDimensionAndIndex) {
   BitsType b32(32);
   TokenType token;
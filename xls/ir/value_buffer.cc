@@ -0,0 +1,193 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kWordBits = 64;
+
+uint64_t LowMask(int64_t width) {
+  return width >= kWordBits ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+}
+
+// Returns the `width` (at most 64) bits of `bitmap` starting at `offset`.
+uint64_t ReadChunk(const InlineBitmap& bitmap, int64_t offset, int64_t width) {
+  int64_t wordno = offset / kWordBits;
+  int64_t shift = offset % kWordBits;
+  uint64_t result = bitmap.GetWord(wordno) >> shift;
+  if (shift != 0 && shift + width > kWordBits) {
+    result |= bitmap.GetWord(wordno + 1) << (kWordBits - shift);
+  }
+  return result & LowMask(width);
+}
+
+// Overwrites the `width` (at most 64) bits of `bitmap` starting at `offset`
+// with the low bits of `value`.
+void WriteChunk(InlineBitmap& bitmap, int64_t offset, int64_t width,
+                uint64_t value) {
+  int64_t wordno = offset / kWordBits;
+  int64_t shift = offset % kWordBits;
+  uint64_t mask = LowMask(width);
+  value &= mask;
+  bitmap.SetWord(wordno, (bitmap.GetWord(wordno) & ~(mask << shift)) |
+                             (value << shift));
+  if (shift != 0 && shift + width > kWordBits) {
+    int64_t high_shift = kWordBits - shift;
+    bitmap.SetWord(wordno + 1,
+                   (bitmap.GetWord(wordno + 1) & ~(mask >> high_shift)) |
+                       (value >> high_shift));
+  }
+}
+
+void WriteBits(InlineBitmap& bitmap, int64_t offset, const Bits& bits) {
+  const InlineBitmap& src = bits.bitmap();
+  for (int64_t i = 0; i < bits.bit_count(); i += kWordBits) {
+    int64_t width = std::min(kWordBits, bits.bit_count() - i);
+    WriteChunk(bitmap, offset + i, width, src.GetWord(i / kWordBits));
+  }
+}
+
+// Writes `value`, which must conform to `type`, at `offset` in `bitmap`.
+void WriteValue(InlineBitmap& bitmap, int64_t offset, const Value& value,
+                Type* type) {
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      WriteBits(bitmap, offset, value.bits());
+      return;
+    case TypeKind::kTuple:
+    case TypeKind::kArray:
+      for (int64_t i = 0; i < value.size(); ++i) {
+        Type* element_type = type->IsTuple()
+                                 ? type->AsTupleOrDie()->element_type(i)
+                                 : type->AsArrayOrDie()->element_type();
+        WriteValue(bitmap, offset, value.element(i), element_type);
+        offset += element_type->GetFlatBitCount();
+      }
+      return;
+    case TypeKind::kToken:
+      return;
+  }
+  LOG(FATAL) << "Invalid type kind: " << type->kind();
+}
+
+}  // namespace
+
+int64_t ValueBufferView::element_count() const {
+  if (type_->IsTuple()) {
+    return type_->AsTupleOrDie()->size();
+  }
+  CHECK(type_->IsArray()) << type_->ToString();
+  return type_->AsArrayOrDie()->size();
+}
+
+ValueBufferView ValueBufferView::element(int64_t index) const {
+  CHECK_GE(index, 0);
+  CHECK_LT(index, element_count());
+  if (type_->IsArray()) {
+    Type* element_type = type_->AsArrayOrDie()->element_type();
+    return ValueBufferView(
+        element_type, bitmap_,
+        bit_offset_ + index * element_type->GetFlatBitCount());
+  }
+  TupleType* tuple_type = type_->AsTupleOrDie();
+  int64_t offset = bit_offset_;
+  for (int64_t i = 0; i < index; ++i) {
+    offset += tuple_type->element_type(i)->GetFlatBitCount();
+  }
+  return ValueBufferView(tuple_type->element_type(index), bitmap_, offset);
+}
+
+Bits ValueBufferView::GetBits() const {
+  CHECK(type_->IsBits()) << type_->ToString();
+  int64_t bit_count = type_->GetFlatBitCount();
+  InlineBitmap result(bit_count);
+  for (int64_t i = 0; i < bit_count; i += kWordBits) {
+    int64_t width = std::min(kWordBits, bit_count - i);
+    result.SetWord(i / kWordBits, ReadChunk(*bitmap_, bit_offset_ + i, width));
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+Value ValueBufferView::ToValue() const {
+  switch (type_->kind()) {
+    case TypeKind::kBits:
+      return Value(GetBits());
+    case TypeKind::kTuple:
+    case TypeKind::kArray: {
+      std::vector<Value> elements;
+      elements.reserve(element_count());
+      for (int64_t i = 0; i < element_count(); ++i) {
+        elements.push_back(element(i).ToValue());
+      }
+      return type_->IsTuple() ? Value::TupleOwned(std::move(elements))
+                              : Value::ArrayOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  LOG(FATAL) << "Invalid type kind: " << type_->kind();
+}
+
+/* static */ absl::StatusOr<ValueBuffer> ValueBuffer::FromValue(
+    const Value& value, Type* type) {
+  ValueBuffer buffer(type);
+  XLS_RETURN_IF_ERROR(buffer.Update({}, value));
+  return buffer;
+}
+
+absl::Status ValueBuffer::Update(absl::Span<const int64_t> index,
+                                 const Value& value) {
+  ValueBufferView target = view();
+  for (int64_t i : index) {
+    if (!target.type()->IsTuple() && !target.type()->IsArray()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cannot index into value of type %s", target.type()->ToString()));
+    }
+    if (i < 0 || i >= target.element_count()) {
+      return absl::OutOfRangeError(
+          absl::StrFormat("Index %d is out of bounds for type %s", i,
+                          target.type()->ToString()));
+    }
+    target = target.element(i);
+  }
+  if (!ValueConformsToType(value, target.type())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not conform to type %s",
+                        value.ToString(), target.type()->ToString()));
+  }
+  WriteValue(bitmap_, target.bit_offset(), value, target.type());
+  return absl::OkStatus();
+}
+
+}  // namespace xls
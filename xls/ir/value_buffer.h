@@ -0,0 +1,106 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_VALUE_BUFFER_H_
+#define XLS_IR_VALUE_BUFFER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A read-only view of a value of type `type()` stored at a bit offset within
+// a ValueBuffer. Views are cheap to copy and are invalidated if the underlying
+// buffer is destroyed.
+class ValueBufferView {
+ public:
+  ValueBufferView(Type* type, const InlineBitmap* bitmap, int64_t bit_offset)
+      : type_(type), bitmap_(bitmap), bit_offset_(bit_offset) {}
+
+  Type* type() const { return type_; }
+  int64_t bit_offset() const { return bit_offset_; }
+
+  // Returns the number of elements of the tuple or array this views.
+  int64_t element_count() const;
+
+  // Returns a view of the element at `index` of the tuple or array this views.
+  ValueBufferView element(int64_t index) const;
+
+  // Returns the value of the bits-typed value this views.
+  Bits GetBits() const;
+
+  Value ToValue() const;
+
+ private:
+  Type* type_;
+  const InlineBitmap* bitmap_;
+  int64_t bit_offset_;
+};
+
+// A value of a given type stored in a single contiguous bitmap rather than as a
+// tree of Values, so that aggregates of any size need at most one allocation
+// and can be copied as a block.
+//
+// The leaf elements are laid out in the order of a LeafTypeTree, with the first
+// leaf at bit zero and the bits of each leaf stored least significant bit
+// first. For example, the tuple (bits[3]:x, bits[2][2]:[y, z]) is stored as
+// {x[0..2], y[0..1], z[0..1]}. Tokens occupy no bits.
+class ValueBuffer {
+ public:
+  // Creates a buffer holding the zero value of `type`.
+  explicit ValueBuffer(Type* type)
+      : type_(type), bitmap_(type->GetFlatBitCount()) {}
+
+  // Returns a buffer holding `value`, which must conform to `type`.
+  static absl::StatusOr<ValueBuffer> FromValue(const Value& value, Type* type);
+
+  Type* type() const { return type_; }
+  const InlineBitmap& bitmap() const { return bitmap_; }
+
+  ValueBufferView view() const { return ValueBufferView(type_, &bitmap_, 0); }
+  ValueBufferView element(int64_t index) const {
+    return view().element(index);
+  }
+
+  Value ToValue() const { return view().ToValue(); }
+  std::string ToString() const { return ToValue().ToString(); }
+
+  // Overwrites the (possibly nested) element at `index` with `value`. Each
+  // entry of `index` selects an element of a tuple or array, like the indices
+  // of an array_update; an empty index overwrites the whole buffer. Returns an
+  // error if the index is out of bounds or `value` does not conform to the type
+  // of the element.
+  absl::Status Update(absl::Span<const int64_t> index, const Value& value);
+
+  bool operator==(const ValueBuffer& other) const {
+    return type_->IsEqualTo(other.type_) && bitmap_ == other.bitmap_;
+  }
+  bool operator!=(const ValueBuffer& other) const { return !(*this == other); }
+
+ private:
+  Type* type_;
+  InlineBitmap bitmap_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_VALUE_BUFFER_H_
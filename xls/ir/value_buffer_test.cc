@@ -0,0 +1,113 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_buffer.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_test_utils.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+
+TEST(ValueBufferTest, Bits) {
+  Package p("p");
+  Type* type = p.GetBitsType(100);
+  XLS_ASSERT_OK_AND_ASSIGN(ValueBuffer buffer,
+                           ValueBuffer::FromValue(Value(PrimeBits(100)), type));
+  EXPECT_EQ(buffer.view().GetBits(), PrimeBits(100));
+  EXPECT_EQ(buffer.ToValue(), Value(PrimeBits(100)));
+  EXPECT_EQ(ValueBuffer(type).ToValue(), Value(Bits(100)));
+}
+
+TEST(ValueBufferTest, NestedAggregate) {
+  Package p("p");
+  // (bits[3], bits[70][3], (), token)
+  Type* type = p.GetTupleType(
+      {p.GetBitsType(3), p.GetArrayType(3, p.GetBitsType(70)),
+       p.GetTupleType({}), p.GetTokenType()});
+  std::vector<Value> array_elements;
+  for (int64_t i = 0; i < 3; ++i) {
+    array_elements.push_back(Value(PrimeBits(70 + i).Slice(i, 70)));
+  }
+  Value value = Value::Tuple({Value(UBits(5, 3)),
+                              Value::ArrayOrDie(array_elements),
+                              Value::Tuple({}), Value::Token()});
+  XLS_ASSERT_OK_AND_ASSIGN(ValueBuffer buffer,
+                           ValueBuffer::FromValue(value, type));
+  EXPECT_EQ(buffer.bitmap().bit_count(), 3 + 3 * 70);
+  EXPECT_EQ(buffer.ToValue(), value);
+
+  ValueBufferView array = buffer.element(1);
+  EXPECT_EQ(array.bit_offset(), 3);
+  EXPECT_EQ(array.element_count(), 3);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(array.element(i).bit_offset(), 3 + i * 70);
+    EXPECT_EQ(array.element(i).ToValue(), array_elements[i]);
+  }
+  EXPECT_EQ(buffer.element(0).GetBits(), UBits(5, 3));
+}
+
+TEST(ValueBufferTest, Update) {
+  Package p("p");
+  Type* type = p.GetArrayType(
+      4, p.GetTupleType({p.GetBitsType(7), p.GetBitsType(65)}));
+  ValueBuffer buffer(type);
+  XLS_ASSERT_OK(buffer.Update({2, 1}, Value(Bits::AllOnes(65))));
+  XLS_ASSERT_OK(buffer.Update(
+      {1}, Value::Tuple({Value(UBits(3, 7)), Value(UBits(4, 65))})));
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(buffer.element(i).element(0).GetBits(),
+              UBits(i == 1 ? 3 : 0, 7))
+        << i;
+    EXPECT_EQ(buffer.element(i).element(1).GetBits(),
+              i == 2   ? Bits::AllOnes(65)
+              : i == 1 ? UBits(4, 65)
+                       : Bits(65))
+        << i;
+  }
+
+  EXPECT_THAT(buffer.Update({4}, Value::Tuple({Value(UBits(0, 7)),
+                                               Value(UBits(0, 65))})),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(buffer.Update({0, 0, 0}, Value(UBits(0, 1))),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(buffer.Update({0, 0}, Value(UBits(0, 8))),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ValueBuffer::FromValue(Value(UBits(0, 8)), type),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ValueBufferTest, Equality) {
+  Package p("p");
+  Type* type = p.GetArrayType(2, p.GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, Value::UBitsArray({1, 2}, 8));
+  EXPECT_THAT(ValueBuffer::FromValue(value, type),
+              IsOkAndHolds(ValueBuffer::FromValue(value, type).value()));
+  EXPECT_NE(ValueBuffer::FromValue(value, type).value(), ValueBuffer(type));
+}
+
+}  // namespace
+}  // namespace xls
@@ -98,8 +98,12 @@ absl::Status VerifyName(FunctionBase* function_base) {
   return absl::OkStatus();
 }
 
-// Verify common invariants to function-level constructs.
-absl::Status VerifyFunctionBase(FunctionBase* function) {
+// Verify common invariants to function-level constructs. If
+// `nodes_to_verify` is given, the node-level checks of VerifyNode are only run
+// on the nodes it contains.
+absl::Status VerifyFunctionBase(
+    FunctionBase* function,
+    const absl::flat_hash_set<Node*>* nodes_to_verify = nullptr) {
   VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
   XLS_VLOG_LINES(4, function->DumpIr());
 
@@ -129,7 +133,9 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
 
   // Verify consistency of node::users() and node::operands().
   for (Node* node : function->nodes()) {
-    XLS_RETURN_IF_ERROR(VerifyNode(node));
+    if (nodes_to_verify == nullptr || nodes_to_verify->contains(node)) {
+      XLS_RETURN_IF_ERROR(VerifyNode(node));
+    }
   }
 
   // Verify the set of parameter nodes is exactly Function::params(), and that
@@ -515,20 +521,34 @@ absl::Status VerifyElaboration(Package* package) {
 
 }  // namespace
 
-absl::Status VerifyPackage(Package* package, bool codegen) {
+static absl::Status VerifyFunctionImpl(
+    Function* function, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify);
+static absl::Status VerifyProcImpl(
+    Proc* proc, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify);
+static absl::Status VerifyBlockImpl(
+    Block* block, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify);
+
+static absl::Status VerifyPackageImpl(
+    Package* package, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
   XLS_VLOG_LINES(4, package->DumpIr());
 
   for (auto& function : package->functions()) {
-    XLS_RETURN_IF_ERROR(VerifyFunction(function.get(), codegen));
+    XLS_RETURN_IF_ERROR(
+        VerifyFunctionImpl(function.get(), codegen, nodes_to_verify));
   }
 
   for (auto& proc : package->procs()) {
-    XLS_RETURN_IF_ERROR(VerifyProc(proc.get(), codegen));
+    XLS_RETURN_IF_ERROR(VerifyProcImpl(proc.get(), codegen, nodes_to_verify));
   }
 
   for (auto& block : package->blocks()) {
-    XLS_RETURN_IF_ERROR(VerifyBlock(block.get(), codegen));
+    XLS_RETURN_IF_ERROR(
+        VerifyBlockImpl(block.get(), codegen, nodes_to_verify));
   }
 
   // Verify node IDs are unique within the package and uplinks point to this
@@ -588,11 +608,23 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyFunction(Function* function, bool codegen) {
+absl::Status VerifyPackage(Package* package, bool codegen) {
+  return VerifyPackageImpl(package, codegen, /*nodes_to_verify=*/nullptr);
+}
+
+absl::Status VerifyPackageNodes(Package* package,
+                                const absl::flat_hash_set<Node*>& nodes,
+                                bool codegen) {
+  return VerifyPackageImpl(package, codegen, &nodes);
+}
+
+static absl::Status VerifyFunctionImpl(
+    Function* function, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function, nodes_to_verify));
 
   for (Node* node : function->nodes()) {
     if (node->Is<Send>() || node->Is<Receive>()) {
@@ -768,11 +800,17 @@ static absl::Status VerifyProcInstantiations(Proc* proc) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyProc(Proc* proc, bool codegen) {
+absl::Status VerifyFunction(Function* function, bool codegen) {
+  return VerifyFunctionImpl(function, codegen, /*nodes_to_verify=*/nullptr);
+}
+
+static absl::Status VerifyProcImpl(
+    Proc* proc, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying proc:\n";
   XLS_VLOG_LINES(4, proc->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc, nodes_to_verify));
 
   if (proc->is_new_style_proc()) {
     XLS_RETURN_IF_ERROR(VerifyProcScopedChannels(proc));
@@ -820,6 +858,10 @@ absl::Status VerifyProc(Proc* proc, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyProc(Proc* proc, bool codegen) {
+  return VerifyProcImpl(proc, codegen, /*nodes_to_verify=*/nullptr);
+}
+
 // Verify that the given set of port nodes on the instantiated block match
 // one-to-one with the instantiation input/output nodes in the instantiating
 // block.
@@ -828,18 +870,22 @@ static absl::Status VerifyPortsMatch(
     absl::Span<PortNodeT* const> port_nodes,
     absl::Span<InstantiationNodeT* const> instantiation_nodes,
     BlockInstantiation* instantiation) {
+  // Blocks made by block stitching instantiate hundreds of blocks with many
+  // ports each, so the ports are matched by hashing rather than searching.
   std::vector<std::string> block_port_names;
   for (PortNodeT* port_node : port_nodes) {
     block_port_names.push_back(port_node->GetName());
   }
-  std::vector<std::string> instantiation_port_names;
+  std::vector<std::string_view> instantiation_port_names;
   for (InstantiationNodeT* instantiation_node : instantiation_nodes) {
     instantiation_port_names.push_back(instantiation_node->port_name());
   }
+  absl::flat_hash_set<std::string_view> block_port_set(
+      block_port_names.begin(), block_port_names.end());
+  absl::flat_hash_set<std::string_view> instantiation_port_set(
+      instantiation_port_names.begin(), instantiation_port_names.end());
   for (const std::string& name : block_port_names) {
-    if (std::find(instantiation_port_names.begin(),
-                  instantiation_port_names.end(),
-                  name) == instantiation_port_names.end()) {
+    if (!instantiation_port_set.contains(name)) {
       return absl::InternalError(
           absl::StrFormat("Instantiation `%s` of block `%s` is missing "
                           "instantation input/output node for port `%s`",
@@ -847,17 +893,19 @@ static absl::Status VerifyPortsMatch(
                           instantiation->instantiated_block()->name(), name));
     }
   }
-  for (const std::string& name : instantiation_port_names) {
-    if (std::find(block_port_names.begin(), block_port_names.end(), name) ==
-        block_port_names.end()) {
+  for (std::string_view name : instantiation_port_names) {
+    if (!block_port_set.contains(name)) {
       return absl::InternalError(absl::StrFormat(
           "No port `%s` on instantiated block `%s` for instantiation `%s`",
           name, instantiation->instantiated_block()->name(),
           instantiation->name()));
     }
   }
+  if (instantiation_port_set.size() == instantiation_port_names.size()) {
+    return absl::OkStatus();
+  }
   absl::flat_hash_set<std::string_view> name_set;
-  for (const std::string& name : instantiation_port_names) {
+  for (std::string_view name : instantiation_port_names) {
     if (!name_set.insert(name).second) {
       return absl::InternalError(
           absl::StrFormat("Duplicate instantiation input/output nodes for port "
@@ -870,20 +918,14 @@ static absl::Status VerifyPortsMatch(
   return absl::OkStatus();
 }
 
-// Verifies invariants of the given block instantiation.
-static absl::Status VerifyBlockInstantiation(BlockInstantiation* instantiation,
-                                             Block* instantiating_block) {
+// Verifies invariants of the given block instantiation. `package_blocks` holds
+// the blocks of the package of `instantiating_block`.
+static absl::Status VerifyBlockInstantiation(
+    BlockInstantiation* instantiation, Block* instantiating_block,
+    const absl::flat_hash_set<const Block*>& package_blocks) {
   Block* instantiated_block = instantiation->instantiated_block();
   Package* package = instantiating_block->package();
-  auto block_in_package = [](Package* p, Block* b) {
-    for (const std::unique_ptr<Block>& block : p->blocks()) {
-      if (block.get() == b) {
-        return true;
-      }
-    }
-    return false;
-  };
-  if (!block_in_package(package, instantiated_block)) {
+  if (!package_blocks.contains(instantiated_block)) {
     return absl::InternalError(absl::StrFormat(
         "Instantiated block `%s` (%p) is not owned by package `%s`",
         instantiated_block->name(), instantiated_block, package->name()));
@@ -1030,11 +1072,13 @@ static absl::Status VerifyFifoInstantiation(Package* package,
   return absl::OkStatus();
 }
 
-absl::Status VerifyBlock(Block* block, bool codegen) {
+static absl::Status VerifyBlockImpl(
+    Block* block, bool codegen,
+    const absl::flat_hash_set<Node*>* nodes_to_verify) {
   VLOG(4) << "Verifying block:\n";
   XLS_VLOG_LINES(4, block->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block, nodes_to_verify));
 
   // Verify that there are no cycles in the node graph.
   // The previous check in VerifyFunctionBase looks locally, but does not look
@@ -1144,13 +1188,21 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
     XLS_RET_CHECK_EQ(reg_write, reg_writes.at(reg));
   }
 
+  absl::flat_hash_set<const Block*> package_blocks;
+  if (!block->GetInstantiations().empty()) {
+    for (const std::unique_ptr<Block>& package_block :
+         block->package()->blocks()) {
+      package_blocks.insert(package_block.get());
+    }
+  }
   for (Instantiation* instantiation : block->GetInstantiations()) {
     switch (instantiation->kind()) {
       case InstantiationKind::kBlock:
         // Verify each instantiation is a block instantiation and the block is
         // owned the package.
         XLS_RETURN_IF_ERROR(VerifyBlockInstantiation(
-            down_cast<BlockInstantiation*>(instantiation), block));
+            down_cast<BlockInstantiation*>(instantiation), block,
+            package_blocks));
         break;
       case InstantiationKind::kExtern:
         XLS_RETURN_IF_ERROR(VerifyExternInstantiation(
@@ -1170,4 +1222,8 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyBlock(Block* block, bool codegen) {
+  return VerifyBlockImpl(block, codegen, /*nodes_to_verify=*/nullptr);
+}
+
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 
 namespace xls {
@@ -32,6 +33,15 @@ absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 
+// Verifies the invariants of the package like VerifyPackage but runs the
+// node-level checks, which dominate the cost of verification, only on the
+// given nodes. All function-, proc-, block- and package-level invariants are
+// still checked. Intended for re-verifying a package after a change to a known
+// set of nodes (and their users).
+absl::Status VerifyPackageNodes(Package* package,
+                                const absl::flat_hash_set<Node*>& nodes,
+                                bool codegen = false);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
@@ -174,6 +174,25 @@ fn graph(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
                                  "bits[42], has type bits[2].")));
 }
 
+TEST_F(VerifierTest, VerifyPackageNodesOnlyChecksGivenNodes) {
+  std::string input = R"(
+package VerifyPackageNodes
+
+fn graph(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.1: bits[42] = and(q, r)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("graph"));
+  Node* and_node = FindNode("and.1", f);
+  and_node->ReplaceOperand(FindNode("q", f), FindNode("p", f));
+  XLS_EXPECT_OK(VerifyPackageNodes(p.get(), {FindNode("r", f)}));
+  EXPECT_THAT(VerifyPackageNodes(p.get(), {and_node}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1 to have type "
+                                 "bits[42], has type bits[2].")));
+}
+
 TEST_F(VerifierTest, SelectWithUselessDefault) {
   std::string input = R"(
 package p
@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -30,12 +31,14 @@
 #include "llvm/include/llvm/IR/Attributes.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/GlobalValue.h"
 #include "llvm/include/llvm/IR/GlobalVariable.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/Linker/Linker.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
@@ -173,6 +176,55 @@ absl::Status AddWeakEmuTls(llvm::Module& module, llvm::LLVMContext* context) {
 }
 
 }  // namespace
+
+absl::StatusOr<std::unique_ptr<llvm::Module>>
+AotCompiler::OptimizeConcurrently(std::unique_ptr<llvm::Module> module) {
+  // Splitting externalizes local symbols. Record their linkage so it can be
+  // restored once the parts are linked back together, keeping the symbols of
+  // the object file the same as without splitting.
+  absl::flat_hash_map<std::string, llvm::GlobalValue::LinkageTypes>
+      local_linkage;
+  for (const llvm::GlobalValue& value : module->global_values()) {
+    if (value.hasLocalLinkage() && value.hasName()) {
+      local_linkage[value.getName().str()] = value.getLinkage();
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> parts,
+                       SplitModuleToBitcode(std::move(module)));
+
+  XLS_RETURN_IF_ERROR(RunConcurrently(
+      parts.size(), [&](int64_t i) -> absl::Status {
+        llvm::LLVMContext context;
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> part,
+                             ParseBitcode(parts[i], context));
+        if (llvm::Error error = PerformStandardOptimization(part.get())) {
+          return absl::InternalError(
+              absl::StrCat("Unable to optimize module part: ",
+                           llvm::toString(std::move(error))));
+        }
+        parts[i] = WriteBitcode(*part);
+        return absl::OkStatus();
+      }));
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> linked,
+                       ParseBitcode(parts.front(), *GetContext()));
+  for (int64_t i = 1; i < parts.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> part,
+                         ParseBitcode(parts[i], *GetContext()));
+    if (llvm::Linker::linkModules(*linked, std::move(part))) {
+      return absl::InternalError(
+          absl::StrCat("Unable to link optimized module part ", i));
+    }
+  }
+  for (const auto& [name, linkage] : local_linkage) {
+    if (llvm::GlobalValue* value = linked->getNamedValue(name)) {
+      value->setLinkage(linkage);
+      value->setVisibility(llvm::GlobalValue::DefaultVisibility);
+    }
+  }
+  return linked;
+}
+
 absl::Status AotCompiler::CompileModule(
     std::unique_ptr<llvm::Module>&& module) {
   JitObserverRequests notification;
@@ -182,8 +234,9 @@ absl::Status AotCompiler::CompileModule(
   if (notification.unoptimized_module) {
     jit_observer_->UnoptimizedModule(module.get());
   }
-  auto err = PerformStandardOptimization(module.get());
-  if (err) {
+  if (ShouldSplitModule(*module)) {
+    XLS_ASSIGN_OR_RETURN(module, OptimizeConcurrently(std::move(module)));
+  } else if (auto err = PerformStandardOptimization(module.get())) {
     std::string mem;
     llvm::raw_string_ostream oss(mem);
     oss << err;
@@ -40,6 +40,11 @@ class AotCompiler final : public LlvmCompiler {
   absl::StatusOr<AotCompiler*> AsAotCompiler() override { return this; }
 
   // Compiles the given LLVM module into object code.
+  //
+  // If the codegen thread count (see SetLlvmCodegenThreadCount) is more than
+  // one the module is split and the parts are optimized concurrently. The
+  // optimized parts are linked back into one module for code generation as
+  // the AOT build rules expect a single object file.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
   // Return the underlying LLVM context.
@@ -73,6 +78,11 @@ class AotCompiler final : public LlvmCompiler {
                      /*include_observer_callbacks=*/false),
         jit_observer_(observer) {}
 
+  // Splits `module`, optimizes the parts concurrently and returns them linked
+  // back into a single module in the compiler's context.
+  absl::StatusOr<std::unique_ptr<llvm::Module>> OptimizeConcurrently(
+      std::unique_ptr<llvm::Module> module);
+
   std::unique_ptr<llvm::LLVMContext> context_ =
       std::make_unique<llvm::LLVMContext>();
 
@@ -0,0 +1,170 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/aot_proc_network_c_api.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/proc_base_jit_wrapper.h"
+#include "xls/public/c_api_impl_helpers.h"
+
+struct xls_aot_proc_network {
+  std::unique_ptr<xls::BaseProcJitWrapper> wrapper;
+  // Queues, names and native element sizes of the channels, indexed by
+  // channel index.
+  std::vector<xls::JitChannelQueue*> queues;
+  std::vector<std::string> names;
+  std::vector<int64_t> element_sizes;
+};
+
+namespace xls {
+namespace {
+
+bool ReturnStatus(const absl::Status& status, char** error_out) {
+  if (status.ok()) {
+    *error_out = nullptr;
+    return true;
+  }
+  *error_out = ToOwnedCString(status.ToString());
+  return false;
+}
+
+absl::Status CheckChannel(const xls_aot_proc_network* network,
+                          int64_t channel) {
+  if (channel < 0 || channel >= network->queues.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel index %d out of range; network has %d channels", channel,
+        network->queues.size()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool CreateAotProcNetwork(
+    absl::StatusOr<std::unique_ptr<BaseProcJitWrapper>> wrapper,
+    char** error_out, xls_aot_proc_network** network_out) {
+  if (!ReturnStatus(wrapper.status(), error_out)) {
+    return false;
+  }
+  auto network = std::make_unique<xls_aot_proc_network>();
+  network->wrapper = *std::move(wrapper);
+  absl::StatusOr<JitChannelQueueManager*> queue_manager =
+      network->wrapper->runtime()->GetJitChannelQueueManager();
+  if (!ReturnStatus(queue_manager.status(), error_out)) {
+    return false;
+  }
+  for (ChannelInstance* channel_instance :
+       (*queue_manager)->elaboration().channel_instances()) {
+    network->queues.push_back(
+        &(*queue_manager)->GetJitQueue(channel_instance));
+    network->names.push_back(std::string(channel_instance->channel->name()));
+    network->element_sizes.push_back(
+        (*queue_manager)->runtime().GetTypeByteSize(
+            channel_instance->channel->type()));
+  }
+  *network_out = network.release();
+  return true;
+}
+
+}  // namespace xls
+
+extern "C" {
+
+void xls_aot_proc_network_free(xls_aot_proc_network* network) {
+  delete network;
+}
+
+void xls_aot_proc_network_reset(xls_aot_proc_network* network) {
+  network->wrapper->Reset();
+}
+
+bool xls_aot_proc_network_tick(xls_aot_proc_network* network,
+                               char** error_out) {
+  return xls::ReturnStatus(network->wrapper->Tick(), error_out);
+}
+
+bool xls_aot_proc_network_tick_until_blocked(xls_aot_proc_network* network,
+                                             int64_t max_ticks,
+                                             char** error_out,
+                                             int64_t* ticks_out) {
+  absl::StatusOr<int64_t> ticks = network->wrapper->TickUntilBlocked(
+      max_ticks < 0 ? std::nullopt : std::make_optional(max_ticks));
+  if (!xls::ReturnStatus(ticks.status(), error_out)) {
+    return false;
+  }
+  *ticks_out = *ticks;
+  return true;
+}
+
+int64_t xls_aot_proc_network_channel_count(
+    const xls_aot_proc_network* network) {
+  return network->queues.size();
+}
+
+const char* xls_aot_proc_network_channel_name(
+    const xls_aot_proc_network* network, int64_t channel) {
+  return network->names.at(channel).c_str();
+}
+
+int64_t xls_aot_proc_network_channel_element_size(
+    const xls_aot_proc_network* network, int64_t channel) {
+  return network->element_sizes.at(channel);
+}
+
+bool xls_aot_proc_network_get_channel_index(
+    const xls_aot_proc_network* network, const char* name, char** error_out,
+    int64_t* channel_out) {
+  for (int64_t i = 0; i < network->names.size(); ++i) {
+    if (network->names[i] == name) {
+      *error_out = nullptr;
+      *channel_out = i;
+      return true;
+    }
+  }
+  return xls::ReturnStatus(
+      absl::NotFoundError(absl::StrFormat("No channel named `%s`", name)),
+      error_out);
+}
+
+bool xls_aot_proc_network_send(xls_aot_proc_network* network, int64_t channel,
+                               const uint8_t* data, char** error_out) {
+  if (!xls::ReturnStatus(xls::CheckChannel(network, channel), error_out)) {
+    return false;
+  }
+  network->queues[channel]->WriteRaw(data);
+  return true;
+}
+
+bool xls_aot_proc_network_receive(xls_aot_proc_network* network,
+                                  int64_t channel, uint8_t* buffer,
+                                  char** error_out, bool* received_out) {
+  if (!xls::ReturnStatus(xls::CheckChannel(network, channel), error_out)) {
+    return false;
+  }
+  *received_out = network->queues[channel]->ReadRaw(buffer);
+  return true;
+}
+
+}  // extern "C"
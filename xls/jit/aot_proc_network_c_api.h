@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_AOT_PROC_NETWORK_C_API_H_
+#define XLS_JIT_AOT_PROC_NETWORK_C_API_H_
+
+#include <stdbool.h>  // NOLINT(modernize-deprecated-headers)
+#include <stdint.h>   // NOLINT(modernize-deprecated-headers)
+
+// C API for running an AOT-compiled proc network produced by
+// `cc_xls_ir_jit_wrapper` with `wrapper_type = PROC_WRAPPER_TYPE`. Each such
+// wrapper defines a factory
+//
+//   bool <namespace>_<class_name>_create_network(
+//       char** error_out, struct xls_aot_proc_network** network_out);
+//
+// where the namespace has `::` replaced by `_` and the class name is in
+// snake_case (e.g. `xls_examples_some_caps_create_network` for
+// `xls::examples::SomeCaps`).
+//
+// Channel data is passed in the native (LLVM) layout of the channel type, the
+// same layout the compiled procs use, and is copied directly to and from the
+// channel queues without conversion to XLS values.
+//
+// Fallible functions follow the convention of `xls/public/c_api.h`: they
+// return false on error and set `error_out` to a caller-owned C string which
+// must be deallocated via `free`.
+//
+// **WARNING**: These are *not* meant to be *ABI-stable* -- the wrapper and the
+// XLS runtime it links against must come from the same XLS commit.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct xls_aot_proc_network;
+
+void xls_aot_proc_network_free(struct xls_aot_proc_network* network);
+
+// Resets the state of all of the procs to their initial state.
+void xls_aot_proc_network_reset(struct xls_aot_proc_network* network);
+
+// Executes (up to) a single iteration of every proc in the network.
+bool xls_aot_proc_network_tick(struct xls_aot_proc_network* network,
+                               char** error_out);
+
+// Ticks until all procs with IO are blocked on receive operations, or returns
+// an error after `max_ticks` ticks if `max_ticks` is non-negative.
+bool xls_aot_proc_network_tick_until_blocked(
+    struct xls_aot_proc_network* network, int64_t max_ticks, char** error_out,
+    int64_t* ticks_out);
+
+// Returns the number of channels in the network. Channels are identified by
+// their index, from 0 to the channel count.
+int64_t xls_aot_proc_network_channel_count(
+    const struct xls_aot_proc_network* network);
+
+// Returns the name of the given channel. The string is owned by the network.
+const char* xls_aot_proc_network_channel_name(
+    const struct xls_aot_proc_network* network, int64_t channel);
+
+// Returns the number of bytes of one element of the given channel in its
+// native layout.
+int64_t xls_aot_proc_network_channel_element_size(
+    const struct xls_aot_proc_network* network, int64_t channel);
+
+// Finds the index of the channel with the given name.
+bool xls_aot_proc_network_get_channel_index(
+    const struct xls_aot_proc_network* network, const char* name,
+    char** error_out, int64_t* channel_out);
+
+// Writes one element of `channel_element_size` bytes to the channel.
+bool xls_aot_proc_network_send(struct xls_aot_proc_network* network,
+                               int64_t channel, const uint8_t* data,
+                               char** error_out);
+
+// Reads one element of `channel_element_size` bytes from the channel into
+// `buffer`. `received_out` is set to false if the channel is empty.
+bool xls_aot_proc_network_receive(struct xls_aot_proc_network* network,
+                                  int64_t channel, uint8_t* buffer,
+                                  char** error_out, bool* received_out);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // XLS_JIT_AOT_PROC_NETWORK_C_API_H_
@@ -14,6 +14,8 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -38,6 +40,7 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/observer.h"
 #include "xls/ir/block.h"
@@ -284,6 +287,105 @@ absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
   return absl::OkStatus();
 }
 
+int64_t BlockJit::input_trace_cycle_size() const {
+  return absl::c_accumulate(input_port_sizes(), int64_t{0});
+}
+
+int64_t BlockJit::output_trace_cycle_size() const {
+  return absl::c_accumulate(output_port_sizes(), int64_t{0});
+}
+
+absl::StatusOr<int64_t> BlockJit::RunCycles(
+    BlockJitContinuation& continuation, int64_t cycle_count,
+    absl::Span<const uint8_t> input_trace, absl::Span<uint8_t> output_trace) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  const int64_t input_stride = input_trace_cycle_size();
+  const int64_t output_stride = output_trace_cycle_size();
+  XLS_RET_CHECK_GE(input_trace.size(), cycle_count * input_stride)
+      << "input trace too small for " << cycle_count << " cycles";
+  XLS_RET_CHECK_GE(output_trace.size(), cycle_count * output_stride)
+      << "output trace too small for " << cycle_count << " cycles";
+  absl::Span<const int64_t> input_sizes = input_port_sizes();
+  absl::Span<const int64_t> output_sizes = output_port_sizes();
+  InterpreterEvents& events = continuation.GetEvents();
+  const int64_t initial_assert_count = events.assert_msgs.size();
+  const int64_t initial_trace_count = events.trace_msgs.size();
+  for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+    const uint8_t* input = input_trace.data() + cycle * input_stride;
+    absl::Span<uint8_t* const> input_ports =
+        continuation.input_port_pointers();
+    for (int64_t i = 0; i < input_sizes.size(); ++i) {
+      memcpy(input_ports[i], input, input_sizes[i]);
+      input += input_sizes[i];
+    }
+    if (continuation.observer() != nullptr) {
+      XLS_RETURN_IF_ERROR(RunOneCycle(continuation));
+    } else {
+      function_.RunJittedFunction(
+          continuation.input_buffers_.current(),
+          continuation.output_buffers_.current(), continuation.temp_buffer_,
+          &events, /*instance_context=*/&continuation.callbacks_,
+          runtime_.get(),
+          /*continuation_point=*/0);
+      continuation.SwapRegisters();
+    }
+    uint8_t* output = output_trace.data() + cycle * output_stride;
+    absl::Span<const uint8_t* const> output_ports =
+        continuation.output_port_pointers();
+    for (int64_t i = 0; i < output_sizes.size(); ++i) {
+      memcpy(output, output_ports[i], output_sizes[i]);
+      output += output_sizes[i];
+    }
+    if (events.assert_msgs.size() != initial_assert_count ||
+        events.trace_msgs.size() != initial_trace_count) {
+      return cycle + 1;
+    }
+  }
+  return cycle_count;
+}
+
+absl::StatusOr<std::vector<int64_t>> BlockJit::RunCyclesBatched(
+    absl::Span<BlockJitContinuation* const> continuations,
+    int64_t cycle_count,
+    absl::Span<const absl::Span<const uint8_t>> input_traces,
+    absl::Span<const absl::Span<uint8_t>> output_traces,
+    int64_t thread_count) {
+  XLS_RET_CHECK_EQ(continuations.size(), input_traces.size());
+  XLS_RET_CHECK_EQ(continuations.size(), output_traces.size());
+  XLS_RET_CHECK_GE(thread_count, 1);
+  for (BlockJitContinuation* continuation : continuations) {
+    XLS_RET_CHECK_EQ(continuation->block_jit_, this)
+        << "continuation was not created by this jit";
+  }
+  const int64_t count = continuations.size();
+  std::vector<int64_t> cycles(count, 0);
+  std::vector<absl::Status> results(count);
+  std::atomic<int64_t> next = 0;
+  auto worker = [&] {
+    for (int64_t i = next++; i < count; i = next++) {
+      absl::StatusOr<int64_t> run = RunCycles(
+          *continuations[i], cycle_count, input_traces[i], output_traces[i]);
+      if (run.ok()) {
+        cycles[i] = *run;
+      } else {
+        results[i] = run.status();
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(thread_count, count); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (absl::Status& status : results) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return cycles;
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
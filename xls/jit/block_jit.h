@@ -60,6 +60,36 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   virtual absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Runs up to `cycle_count` cycles of the block with the given continuation
+  // without converting the ports to and from Values between cycles.
+  //
+  // `input_trace` holds the input ports for each cycle in turn, each cycle
+  // being the native layout of every input port packed back to back (see
+  // input_port_sizes()) for a total of input_trace_cycle_size() bytes. The
+  // output ports after each cycle are written to `output_trace` in the same
+  // way (see output_port_sizes()). The input ports of the continuation are left
+  // holding the inputs of the last cycle run.
+  //
+  // Stops early after any cycle which records an assert or trace message in
+  // the continuation's events. Returns the number of cycles run.
+  absl::StatusOr<int64_t> RunCycles(BlockJitContinuation& continuation,
+                                    int64_t cycle_count,
+                                    absl::Span<const uint8_t> input_trace,
+                                    absl::Span<uint8_t> output_trace);
+
+  // Runs RunCycles on each of a batch of independent continuations of this
+  // block, continuation i reading `input_traces[i]` and writing
+  // `output_traces[i]`. The continuations are spread over `thread_count`
+  // threads (including the calling thread) so they must not share observers
+  // which are not thread safe. Returns the number of cycles each continuation
+  // ran.
+  absl::StatusOr<std::vector<int64_t>> RunCyclesBatched(
+      absl::Span<BlockJitContinuation* const> continuations,
+      int64_t cycle_count,
+      absl::Span<const absl::Span<const uint8_t>> input_traces,
+      absl::Span<const absl::Span<uint8_t>> output_traces,
+      int64_t thread_count = 1);
+
   OrcJit& orc_jit() const { return *jit_; }
 
   JitRuntime* runtime() const { return runtime_.get(); }
@@ -76,8 +106,24 @@ class BlockJit {
         .subspan(block_->GetInputPorts().size());
   }
 
+  // Get how large each pointer buffer for the output ports are.
+  absl::Span<const int64_t> output_port_sizes() const {
+    return absl::MakeConstSpan(function_.output_buffer_sizes())
+        .subspan(0, block_->GetOutputPorts().size());
+  }
+
+  // Number of bytes taken by one cycle of an input or output trace passed to
+  // RunCycles.
+  int64_t input_trace_cycle_size() const;
+  int64_t output_trace_cycle_size() const;
+
   bool supports_observer() const { return supports_observer_; }
 
+  // The nodes whose values the jitted code reports to runtime observers.
+  absl::Span<Node* const> observed_nodes() const {
+    return function_.observed_nodes();
+  }
+
  protected:
   BlockJit(Block* block, std::unique_ptr<JitRuntime> runtime,
            std::unique_ptr<OrcJit> jit, JittedFunctionBase function,
@@ -205,10 +251,14 @@ class BlockJitContinuation {
     if (!block_jit_->supports_observer()) {
       return absl::UnimplementedError("runtime observer not supported");
     }
-    callbacks_.observer = obs;
+    callbacks_.SetObserver(obs, block_jit_->observed_nodes(),
+                           block_jit_->runtime());
     return absl::OkStatus();
   }
-  void ClearObserver() { callbacks_.observer = nullptr; }
+  void ClearObserver() {
+    callbacks_.SetObserver(nullptr, /*observed_nodes=*/{},
+                           block_jit_->runtime());
+  }
   RuntimeObserver* observer() const { return callbacks_.observer; }
 
  protected:
@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -32,6 +33,7 @@
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/foreign_function_data.pb.h"
+#include "xls/ir/format_preference.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/ir_test_base.h"
@@ -123,6 +125,140 @@ TEST_F(BlockJitTest, DelaySlot) {
   EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(42, 8))));
 }
 
+TEST_F(BlockJitTest, RunCycles) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("test", p->GetBitsType(8)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto input = bb.InputPort("input", p->GetBitsType(8));
+  auto offset = bb.InputPort("offset", p->GetBitsType(16));
+  bb.RegisterWrite(r, input);
+  auto read = bb.RegisterRead(r);
+  bb.OutputPort("output", read);
+  bb.OutputPort("sum", bb.Add(bb.ZeroExtend(read, 16), offset));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters({Value(UBits(2, 8))}));
+
+  ASSERT_THAT(jit->input_port_sizes(), ElementsAre(1, 2));
+  ASSERT_THAT(jit->output_port_sizes(), ElementsAre(1, 2));
+  ASSERT_EQ(jit->input_trace_cycle_size(), 3);
+  ASSERT_EQ(jit->output_trace_cycle_size(), 3);
+  std::vector<uint8_t> input_trace;
+  for (uint8_t i = 0; i < 4; ++i) {
+    uint16_t offset_value = 1000 * i;
+    input_trace.push_back(10 + i);
+    input_trace.push_back(offset_value & 0xff);
+    input_trace.push_back(offset_value >> 8);
+  }
+  std::vector<uint8_t> output_trace(4 * jit->output_trace_cycle_size());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t cycles, jit->RunCycles(*cont, 4, input_trace, output_trace));
+  EXPECT_EQ(cycles, 4);
+  // Sums are 2 + 0, 10 + 1000, 11 + 2000 and 12 + 3000 in little-endian.
+  EXPECT_THAT(output_trace, ElementsAre(2, 0x02, 0x00, 10, 0xf2, 0x03, 11,
+                                        0xdb, 0x07, 12, 0xc4, 0x0b));
+  EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(13, 8))));
+
+  // Single cycles pick up where the trace left off.
+  XLS_ASSERT_OK(
+      cont->SetInputPorts({Value(UBits(0, 8)), Value(UBits(0, 16))}));
+  XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+  EXPECT_THAT(cont->GetOutputPorts(),
+              ElementsAre(Value(UBits(13, 8)), Value(UBits(13, 16))));
+
+  EXPECT_THAT(jit->RunCycles(*cont, 5, input_trace, output_trace),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(BlockJitTest, RunCyclesStopsOnEvents) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto x = bb.InputPort("x", p->GetBitsType(8));
+  auto tkn = bb.Literal(Value::Token());
+  auto assertion =
+      bb.Assert(tkn, bb.ULt(x, bb.Literal(UBits(100, 8))), "too big");
+  bb.Trace(assertion, bb.Eq(x, bb.Literal(UBits(7, 8))), {x},
+           {"x is ", FormatPreference::kDefault});
+  bb.OutputPort("y", bb.Add(x, bb.Literal(UBits(1, 8))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+
+  std::vector<uint8_t> input_trace = {1, 2, 7, 3, 200, 4};
+  std::vector<uint8_t> output_trace(input_trace.size());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t cycles, jit->RunCycles(*cont, 6, input_trace, output_trace));
+  EXPECT_EQ(cycles, 3);
+  EXPECT_THAT(output_trace, ElementsAre(2, 3, 8, 0, 0, 0));
+  EXPECT_EQ(cont->GetEvents().trace_msgs.size(), 1);
+  EXPECT_THAT(cont->GetEvents().assert_msgs, testing::IsEmpty());
+  cont->ClearEvents();
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      cycles,
+      jit->RunCycles(*cont, 3, absl::MakeConstSpan(input_trace).subspan(3),
+                     absl::MakeSpan(output_trace).subspan(3)));
+  EXPECT_EQ(cycles, 2);
+  EXPECT_THAT(output_trace, ElementsAre(2, 3, 8, 4, 201, 0));
+  EXPECT_THAT(cont->GetEvents().assert_msgs, ElementsAre("too big"));
+}
+
+TEST_F(BlockJitTest, RunCyclesBatched) {
+  // An accumulator: each instance sums its own inputs.
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(8)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto input = bb.InputPort("input", p->GetBitsType(8));
+  auto sum = bb.Add(bb.RegisterRead(r), input);
+  bb.RegisterWrite(r, sum);
+  bb.OutputPort("sum", sum);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+
+  constexpr int64_t kInstances = 37;
+  constexpr int64_t kCycles = 8;
+  std::vector<std::unique_ptr<BlockJitContinuation>> conts;
+  std::vector<BlockJitContinuation*> cont_ptrs;
+  std::vector<std::vector<uint8_t>> inputs(kInstances);
+  std::vector<std::vector<uint8_t>> outputs(kInstances);
+  std::vector<absl::Span<const uint8_t>> input_traces;
+  std::vector<absl::Span<uint8_t>> output_traces;
+  for (int64_t i = 0; i < kInstances; ++i) {
+    conts.push_back(jit->NewContinuation());
+    XLS_ASSERT_OK(conts.back()->SetRegisters({Value(UBits(i, 8))}));
+    cont_ptrs.push_back(conts.back().get());
+    for (int64_t c = 0; c < kCycles; ++c) {
+      inputs[i].push_back(i + c);
+    }
+    outputs[i].resize(kCycles);
+    input_traces.push_back(inputs[i]);
+    output_traces.push_back(absl::MakeSpan(outputs[i]));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> cycles,
+      jit->RunCyclesBatched(cont_ptrs, kCycles, input_traces, output_traces,
+                            /*thread_count=*/4));
+  EXPECT_THAT(cycles, testing::Each(kCycles));
+  for (int64_t i = 0; i < kInstances; ++i) {
+    uint8_t expected = i;
+    for (int64_t c = 0; c < kCycles; ++c) {
+      expected += i + c;
+      EXPECT_EQ(outputs[i][c], expected) << "instance " << i << " cycle " << c;
+    }
+    EXPECT_THAT(conts[i]->GetRegisters(),
+                ElementsAre(Value(UBits(expected, 8))));
+  }
+}
+
 TEST_F(BlockJitTest, SetInputsWithViews) {
   auto p = CreatePackage();
   BlockBuilder bb(TestName(), p.get());
@@ -14,6 +14,7 @@
 #include "xls/jit/function_base_jit.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
@@ -28,6 +29,8 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -37,7 +40,10 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Attributes.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
@@ -47,6 +53,7 @@
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "llvm/include/llvm/Support/Alignment.h"
+#include "llvm/include/llvm/Support/AtomicOrdering.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
@@ -58,6 +65,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/register.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
@@ -297,6 +305,11 @@ enum class AllocationKind : uint8_t {
   // passed in via already-allocated input buffers and some Bits-typed literals
   // which are materialized as LLVM constants at their uses.
   kNone,
+
+  // The node writes its value into the buffer of one of its operands rather
+  // than a buffer of its own. An array update can do this when nothing reads
+  // the array after it, avoiding a copy of the whole array.
+  kInPlace,
 };
 
 // Allocator for the buffers used to hold xls::Node values within jitted
@@ -314,10 +327,33 @@ class BufferAllocator {
     }
   }
 
+  // Records that `node` updates the buffer holding the value of `source` in
+  // place.
+  void SetInPlace(Node* node, Node* source) {
+    SetAllocationKind(node, AllocationKind::kInPlace);
+    in_place_sources_[node] = source;
+  }
+
   AllocationKind GetAllocationKind(Node* node) const {
     return allocation_kinds_.at(node);
   }
 
+  // Returns the node whose buffer `node` updates in place. Node must be
+  // assigned allocation kind kInPlace.
+  Node* GetInPlaceSource(Node* node) const {
+    return in_place_sources_.at(node);
+  }
+
+  // Returns the node whose allocation holds the value of `node`. This is `node`
+  // itself unless it updates the buffer of another node in place.
+  Node* GetBufferOwner(Node* node) const {
+    for (auto it = in_place_sources_.find(node); it != in_place_sources_.end();
+         it = in_place_sources_.find(node)) {
+      node = it->second;
+    }
+    return node;
+  }
+
   // Returns the offset within the temp block for the buffer allocated for
   // `node`. Node must be assigned allocation kind kTempblock.
   int64_t GetOffset(Node* node) const {
@@ -352,11 +388,9 @@ class BufferAllocator {
   int64_t current_offset_ = 0;
   int64_t alignment_ = 1;
   absl::flat_hash_map<Node*, AllocationKind> allocation_kinds_;
+  absl::flat_hash_map<Node*, Node*> in_place_sources_;
 };
 
-// The maximum number of xls::Nodes in a partition.
-static constexpr int64_t kMaxPartitionSize = 100;
-
 // Abstraction representing a point (partition function) at which an early exit
 // can occur.
 struct EarlyExitPoint {
@@ -402,8 +436,8 @@ bool ExecutionContinuesAfterNode(Node* node) {
 // Divides the nodes of the given function base into a topologically sorted
 // sequence of partitions. Each partition then becomes a separate function in
 // the LLVM module.
-// TODO(meheff): 2022/09/09 Tune this algorithm to maximize performance.
 std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
+  const JitPartitionOptions options = GetJitPartitionOptions();
   absl::flat_hash_map<Node*, int64_t> partition_map;
   // Partitions at which execution may resume after an early exit.
   absl::flat_hash_set<int64_t> resume_partitions;
@@ -412,10 +446,22 @@ std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
   enum class Resume : uint8_t { kNextPartition, kThisPartition };
   absl::flat_hash_map<int64_t, Resume> early_exit_partitions;
 
-  // Naively assign nodes to partitions based on a topological sort. First N
-  // nodes go to partition 0, next N nodes go to partition 1, etc.
+  // Small function bases are emitted as a single partition, otherwise the
+  // partitions are capped at the maximum cost.
+  int64_t total_cost = 0;
+  for (Node* node : f->nodes()) {
+    total_cost += JitPartitionCost(node);
+  }
+  const int64_t max_partition_cost =
+      total_cost <= options.single_partition_cost
+          ? std::numeric_limits<int64_t>::max()
+          : options.max_partition_cost;
+
+  // Assign nodes to partitions based on a topological sort, starting a new
+  // partition whenever the next node would exceed the maximum cost.
   int64_t current_partition = 0;
   int64_t partition_size = 0;
+  int64_t partition_cost = 0;
   for (Node* node : TopoSort(f)) {
     if (IsEarlyExitPoint(node)) {
       CHECK(f->IsProc())
@@ -436,14 +482,18 @@ std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
       }
       ++current_partition;
       partition_size = 0;
+      partition_cost = 0;
       continue;
     }
-    partition_map[node] = current_partition;
-    ++partition_size;
-    if (partition_size > kMaxPartitionSize) {
+    int64_t cost = JitPartitionCost(node);
+    if (partition_size != 0 && partition_cost + cost > max_partition_cost) {
       ++current_partition;
       partition_size = 0;
+      partition_cost = 0;
     }
+    partition_map[node] = current_partition;
+    ++partition_size;
+    partition_cost += cost;
   }
 
   // Move literals down as far as possible so they appear in the same partition
@@ -549,15 +599,30 @@ Type* OutputType(const Node* node) {
 //
 // `global_input_nodes` and `global_output_nodes` are the set of nodes whose
 // buffers are passed in via the `input`/`output` arguments of the function.
+//
+// If `execution_counter` is non-null the function increments it on each call.
 absl::StatusOr<llvm::Function*> BuildPartitionFunction(
     std::string_view name, const Partition& partition,
     absl::Span<Node* const> global_input_nodes,
     absl::Span<Node* const> global_output_nodes,
-    const BufferAllocator& allocator, JitBuilderContext& jit_context) {
+    const BufferAllocator& allocator, JitBuilderContext& jit_context,
+    std::atomic<uint64_t>* execution_counter) {
   LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
       name, global_input_nodes, global_output_nodes,
       llvm::Type::getInt1Ty(jit_context.context()), jit_context);
   llvm::IRBuilder<>& b = wrapper.entry_builder();
+  if (jit_context.llvm_compiler().profiling_options().registers_listeners()) {
+    // Keep the partition out of line so samples are attributed to its symbol.
+    wrapper.function()->addFnAttr(llvm::Attribute::NoInline);
+  }
+  if (execution_counter != nullptr) {
+    llvm::Value* counter = b.CreateIntToPtr(
+        b.getInt64(reinterpret_cast<uintptr_t>(execution_counter)),
+        llvm::PointerType::get(jit_context.context(), 0));
+    b.CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter, b.getInt64(1),
+                      llvm::MaybeAlign(alignof(std::atomic<uint64_t>)),
+                      llvm::AtomicOrdering::Monotonic);
+  }
 
   // Whether to interrupt execution of the FunctionBase. Only used for
   // partitions which are early exit points (e.g., have a blocking receive).
@@ -565,6 +630,35 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
 
   // The pointers to the buffers of nodes in the partition.
   absl::flat_hash_map<Node*, llvm::Value*> value_buffers;
+
+  // Returns the buffer holding the value of `node`, which is computed either
+  // earlier in this partition or in an earlier partition.
+  auto get_value_buffer = [&](Node* node) -> absl::StatusOr<llvm::Value*> {
+    if (auto it = value_buffers.find(node); it != value_buffers.end()) {
+      return it->second;
+    }
+    Node* owner = allocator.GetBufferOwner(node);
+    llvm::Value* buffer;
+    if (wrapper.IsInputNode(owner)) {
+      // The value is in a global input. Load the pointer to the buffer from
+      // the input array argument.
+      buffer = wrapper.GetInputBuffer(owner, b);
+    } else if (wrapper.IsOutputNode(owner)) {
+      // The value is a global output. It may have more than one buffer in this
+      // case which is one of the pointer in the output array argument.
+      // Arbitrarily choose the first.
+      buffer = wrapper.GetFirstOutputBuffer(owner, b);
+    } else {
+      // The value is stored inside the temporary buffer.
+      XLS_RET_CHECK(allocator.GetAllocationKind(owner) ==
+                    AllocationKind::kTempBlock)
+          << node;
+      buffer = wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(owner), b);
+    }
+    value_buffers[node] = buffer;
+    return buffer;
+  };
+
   for (Node* node : partition.nodes) {
     if (wrapper.IsInputNode(node)) {
       // Node is an input node. There is no need to generate a node function for
@@ -576,7 +670,9 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
         // state param is the next state value for a proc.
         llvm::Value* input_buffer = wrapper.GetInputBuffer(node, b);
         for (llvm::Value* output_buffer : wrapper.GetOutputBuffers(node, b)) {
-          LlvmMemcpy(
+          // The buffers are the same if the state element is updated in place
+          // (see JittedFunctionBase::shared_state_indices).
+          LlvmMemcpyIfDistinct(
               output_buffer, input_buffer,
               jit_context.type_converter().GetTypeByteSize(OutputType(node)),
               b);
@@ -603,6 +699,13 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       XLS_RET_CHECK(!node->Is<OutputPort>());
       output_buffers = {
           wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(node), b)};
+    } else if (allocator.GetAllocationKind(node) ==
+               AllocationKind::kInPlace) {
+      // `node` overwrites the value of one of its operands, which must already
+      // be computed.
+      XLS_ASSIGN_OR_RETURN(llvm::Value * buffer,
+                           get_value_buffer(allocator.GetInPlaceSource(node)));
+      output_buffers = {buffer};
     } else if (allocator.GetAllocationKind(node) == AllocationKind::kAlloca) {
       // `node` is used exclusively inside this partition (not an input, output,
       // nor has a temp buffer). Allocate a buffer on the stack with alloca.
@@ -628,29 +731,8 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
     // Gather the operand values to be passed to the node function.
     std::vector<llvm::Value*> operand_buffers;
     for (Node* operand : node_function.operand_arguments) {
-      if (value_buffers.contains(operand)) {
-        operand_buffers.push_back(value_buffers.at(operand));
-        continue;
-      }
-      llvm::Value* arg;
-      if (wrapper.IsInputNode(operand)) {
-        // `operand` is a global input. Load the pointer to the buffer from the
-        // input array argument.
-        arg = wrapper.GetInputBuffer(operand, b);
-      } else if (wrapper.IsOutputNode(operand)) {
-        // `operand` is a global output. `operand` may have more than one buffer
-        // in this case which is one of the pointer in the output array
-        // argument. Arbitrarily choose the first.
-        arg = wrapper.GetFirstOutputBuffer(operand, b);
-      } else {
-        // `operand` is stored inside the temporary buffer.
-        XLS_RET_CHECK(allocator.GetAllocationKind(operand) ==
-                      AllocationKind::kTempBlock)
-            << operand;
-        arg = wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(operand), b);
-      }
+      XLS_ASSIGN_OR_RETURN(llvm::Value * arg, get_value_buffer(operand));
       operand_buffers.push_back(arg);
-      value_buffers[operand] = arg;
     }
 
     // Call the node function.
@@ -688,11 +770,130 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   return wrapper.function();
 }
 
+// Returns the position of each node in the order the partitions evaluate them.
+absl::flat_hash_map<Node*, int64_t> GetEvaluationOrder(
+    absl::Span<const Partition> partitions) {
+  absl::flat_hash_map<Node*, int64_t> order;
+  for (const Partition& partition : partitions) {
+    for (Node* node : partition.nodes) {
+      order.emplace(node, order.size());
+    }
+  }
+  return order;
+}
+
+// Returns true if every node in `nodes` is a transitive operand of `node`, and
+// so is evaluated before it. `order` is the evaluation order of the nodes,
+// which bounds the search to the nodes which could lie on a path from `nodes`
+// to `node`.
+bool AreAllAncestors(absl::Span<Node* const> nodes, Node* node,
+                     const absl::flat_hash_map<Node*, int64_t>& order) {
+  absl::flat_hash_set<Node*> targets(nodes.begin(), nodes.end());
+  if (targets.empty()) {
+    return true;
+  }
+  int64_t min_order = std::numeric_limits<int64_t>::max();
+  for (Node* target : targets) {
+    min_order = std::min(min_order, order.at(target));
+  }
+  std::vector<Node*> worklist(node->operands().begin(),
+                              node->operands().end());
+  absl::flat_hash_set<Node*> visited;
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(n).second) {
+      continue;
+    }
+    if (targets.erase(n) > 0 && targets.empty()) {
+      return true;
+    }
+    if (order.at(n) > min_order) {
+      worklist.insert(worklist.end(), n->operands().begin(),
+                      n->operands().end());
+    }
+  }
+  return false;
+}
+
+// Returns the users of `node` which read its value. A next_value node which
+// names `node` only as the state element it updates writes to the output
+// buffer of the state element and does not read it.
+std::vector<Node*> GetReaders(Node* node) {
+  std::vector<Node*> readers;
+  for (Node* user : node->users()) {
+    if (user->Is<Next>() && user->As<Next>()->value() != node &&
+        user->As<Next>()->predicate() != node) {
+      continue;
+    }
+    readers.push_back(user);
+  }
+  return readers;
+}
+
+// Returns true if the jitted code may overwrite the buffer of the input
+// `node`. This is only the case for the state of procs with next_value nodes:
+// the output state starts each tick as a copy of the input state (see
+// ProcJitContinuation::NextTick), after which nothing outside the IR reads the
+// input buffer.
+//
+// The state params of such procs are also outputs, but the jitted code copies
+// the input to the output buffer when evaluating the param so the output buffer
+// is not affected.
+bool IsOverwritableInput(Node* node) {
+  if (!node->Is<Param>() || !node->function_base()->IsProc()) {
+    return false;
+  }
+  Proc* proc = node->function_base()->AsProcOrDie();
+  return !proc->next_values().empty() &&
+         proc->GetStateParamIndex(node->As<Param>()).ok();
+}
+
+// Returns the operand whose buffer `node` may update in place rather than
+// copying it into a buffer of its own, or nullptr if there is none. An array
+// update may write into the buffer of the array it updates if every other
+// reader of the array is evaluated before it. The buffer must outlive the
+// partition if the value of `node` does.
+Node* FindInPlaceSource(Node* node, const LlvmFunctionWrapper& wrapper,
+                        const BufferAllocator& allocator,
+                        const absl::flat_hash_set<Node*>& partition_set,
+                        const absl::flat_hash_map<Node*, int64_t>& order) {
+  if (!node->Is<ArrayUpdate>()) {
+    return nullptr;
+  }
+  Node* array = node->As<ArrayUpdate>()->array_to_update();
+  FunctionBase* function_base = node->function_base();
+  if (absl::c_count(node->operands(), array) != 1 ||
+      function_base->HasImplicitUse(array) ||
+      ((wrapper.IsInputNode(array) || wrapper.IsOutputNode(array)) &&
+       !IsOverwritableInput(array))) {
+    return nullptr;
+  }
+  std::vector<Node*> other_readers = GetReaders(array);
+  std::erase(other_readers, node);
+  if (!AreAllAncestors(other_readers, node, order)) {
+    return nullptr;
+  }
+  Node* owner = allocator.GetBufferOwner(array);
+  if (wrapper.IsInputNode(owner) ||
+      allocator.GetAllocationKind(owner) == AllocationKind::kTempBlock) {
+    return array;
+  }
+  if (allocator.GetAllocationKind(owner) == AllocationKind::kAlloca &&
+      !function_base->HasImplicitUse(node) &&
+      absl::c_all_of(node->users(),
+                     [&](Node* u) { return partition_set.contains(u); })) {
+    return array;
+  }
+  return nullptr;
+}
+
 // Determine the type of buffers required by each node. Allocates the temporary
 // buffers for nodes as needed.
 absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
                              const LlvmFunctionWrapper& wrapper,
                              BufferAllocator& allocator) {
+  absl::flat_hash_map<Node*, int64_t> order = GetEvaluationOrder(partitions);
   for (const Partition& partition : partitions) {
     absl::flat_hash_set<Node*> partition_set(partition.nodes.begin(),
                                              partition.nodes.end());
@@ -700,6 +901,10 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
       if (wrapper.IsInputNode(node) || wrapper.IsOutputNode(node) ||
           ShouldMaterializeAtUse(node)) {
         allocator.SetAllocationKind(node, AllocationKind::kNone);
+      } else if (Node* source = FindInPlaceSource(node, wrapper, allocator,
+                                                  partition_set, order);
+                 source != nullptr) {
+        allocator.SetInPlace(node, source);
       } else if (!node->function_base()->HasImplicitUse(node) &&
                  std::all_of(
                      node->users().begin(), node->users().end(),
@@ -715,6 +920,57 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
   return absl::OkStatus();
 }
 
+// Returns the indices of the state elements of `proc` whose input and output
+// buffers may be the same buffer. This requires that every read of the input
+// buffer be evaluated before the next_value nodes of the element write the
+// output buffer. If array updates write into the input buffer in place there
+// must also be a single unconditional next_value node, as otherwise the output
+// could be left holding the partially updated array.
+std::vector<int64_t> GetSharedStateIndices(
+    Proc* proc, absl::Span<const Partition> partitions,
+    const BufferAllocator& allocator) {
+  if (proc->next_values().empty()) {
+    return {};
+  }
+  absl::flat_hash_map<Node*, int64_t> order = GetEvaluationOrder(partitions);
+  std::vector<int64_t> shared_state_indices;
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    Param* param = proc->GetStateParam(i);
+    // The nodes whose values are held in the input buffer of the element.
+    std::vector<Node*> in_buffer;
+    for (Node* node : proc->nodes()) {
+      if (allocator.GetBufferOwner(node) == param) {
+        in_buffer.push_back(node);
+      }
+    }
+    const auto& next_values = proc->next_values(param);
+    if (in_buffer.size() > 1 &&
+        (next_values.size() != 1 ||
+         (*next_values.begin())->predicate().has_value())) {
+      continue;
+    }
+    bool shared = true;
+    for (Next* next : next_values) {
+      std::vector<Node*> readers;
+      for (Node* node : in_buffer) {
+        for (Node* reader : GetReaders(node)) {
+          if (reader != next) {
+            readers.push_back(reader);
+          }
+        }
+      }
+      if (!AreAllAncestors(readers, next, order)) {
+        shared = false;
+        break;
+      }
+    }
+    if (shared) {
+      shared_state_indices.push_back(i);
+    }
+  }
+  return shared_state_indices;
+}
+
 // Returns the nodes which comprise the inputs to a jitted function implementing
 // `function_base`. These nodes are passed in via the `inputs` argument.
 std::vector<Node*> GetJittedFunctionInputs(FunctionBase* function_base) {
@@ -818,9 +1074,11 @@ struct PartitionedFunction {
   llvm::Function* function;
   std::vector<Partition> partitions;
 };
+//
+// If `profile` is non-null the executions of each partition are counted in it.
 absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
     FunctionBase* xls_function, BufferAllocator& allocator,
-    JitBuilderContext& jit_context) {
+    JitBuilderContext& jit_context, JitPartitionProfile* profile) {
   VLOG(4) << "BuildFunction:";
   VLOG(4) << xls_function->DumpIr();
   std::vector<Partition> partitions = PartitionFunctionBase(xls_function);
@@ -851,10 +1109,19 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
   std::vector<llvm::Function*> partition_functions;
   for (int64_t i = 0; i < partitions.size(); ++i) {
     std::string name = absl::StrFormat("__%s_partition_%d", base_name, i);
+    std::atomic<uint64_t>* execution_counter = nullptr;
+    if (profile != nullptr) {
+      JitPartitionProfile::Partition profile_partition{
+          .symbol_name = name, .function_base_name = xls_function->name()};
+      for (Node* node : partitions[i].nodes) {
+        profile_partition.node_ids.push_back(node->id());
+      }
+      execution_counter = profile->AddPartition(std::move(profile_partition));
+    }
     XLS_ASSIGN_OR_RETURN(
         llvm::Function * partition_function,
         BuildPartitionFunction(name, partitions[i], inputs, outputs, allocator,
-                               jit_context));
+                               jit_context, execution_counter));
     partition_functions.push_back(partition_function);
   }
 
@@ -1249,6 +1516,99 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
 
 }  // namespace
 
+namespace {
+
+absl::Mutex partition_options_mutex(absl::kConstInit);
+JitPartitionOptions partition_options
+    ABSL_GUARDED_BY(partition_options_mutex);
+
+// Returns the number of 64-bit words needed to hold a value of `type`.
+int64_t WordCount(Type* type) {
+  return std::max<int64_t>(
+      1, CeilOfRatio(type->GetFlatBitCount(), int64_t{64}));
+}
+
+}  // namespace
+
+std::atomic<uint64_t>* JitPartitionProfile::AddPartition(Partition partition) {
+  partitions_.push_back(std::move(partition));
+  return &counts_.emplace_back(0);
+}
+
+void JitPartitionProfile::Reset() const {
+  for (std::atomic<uint64_t>& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string JitPartitionProfile::ToString() const {
+  std::vector<uint64_t> counts;
+  std::vector<int64_t> order;
+  for (int64_t i = 0; i < partitions_.size(); ++i) {
+    counts.push_back(ExecutionCount(i));
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return counts[a] > counts[b];
+  });
+  std::string result;
+  for (int64_t i : order) {
+    const Partition& partition = partitions_[i];
+    absl::StrAppendFormat(&result, "%12d  %s  (%s: nodes %s)\n", counts[i],
+                          partition.symbol_name, partition.function_base_name,
+                          absl::StrJoin(partition.node_ids, ", "));
+  }
+  return result;
+}
+
+void SetJitPartitionOptions(const JitPartitionOptions& options) {
+  CHECK_GE(options.max_partition_cost, 1);
+  absl::MutexLock lock(&partition_options_mutex);
+  partition_options = options;
+}
+
+JitPartitionOptions GetJitPartitionOptions() {
+  absl::MutexLock lock(&partition_options_mutex);
+  return partition_options;
+}
+
+int64_t JitPartitionCost(Node* node) {
+  int64_t words = WordCount(node->GetType());
+  switch (node->op()) {
+    case Op::kLiteral:
+      return 0;
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUMulp:
+    case Op::kSMulp:
+      return 4 * words * words;
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return 8 * words * words;
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+    case Op::kDynamicBitSlice:
+    case Op::kBitSliceUpdate:
+    case Op::kArrayIndex:
+    case Op::kArraySlice:
+      return 2 * words;
+    case Op::kArrayUpdate:
+      // Copies the whole array as well as indexing it.
+      return 3 * words;
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+      // The callee is a separate LLVM function so only the call is counted.
+      return 2;
+    default:
+      return words;
+  }
+}
+
 JitArgumentSet JittedFunctionBase::CreateInputBuffer() const {
   return JitArgumentSet::CreateInput(this, input_buffer_preferred_alignments(),
                                      input_buffer_sizes());
@@ -1278,6 +1638,14 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
     bool build_packed_wrapper) {
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
   BufferAllocator allocator(&jit_context.type_converter());
+  // The counter addresses are baked into the code so they can only be used
+  // when the code runs in this process.
+  std::shared_ptr<JitPartitionProfile> partition_profile;
+  if (jit_context.llvm_compiler().profiling_options()
+          .count_partition_executions &&
+      jit_context.llvm_compiler().IsOrcJit()) {
+    partition_profile = std::make_shared<JitPartitionProfile>();
+  }
   llvm::Function* top_function = nullptr;
   std::vector<Partition> top_partitions;
   for (FunctionBase* f : functions) {
@@ -1296,7 +1664,8 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
         jit_context.module()->getFunction(MangleForLLVM(f->name())), nullptr)
         << "Multiple copies of the same function created";
     XLS_ASSIGN_OR_RETURN(PartitionedFunction partitioned_function,
-                         BuildFunctionInternal(f, allocator, jit_context));
+                         BuildFunctionInternal(f, allocator, jit_context,
+                                               partition_profile.get()));
     jit_context.SetLlvmFunction(f, partitioned_function.function);
     if (f == xls_function) {
       top_function = partitioned_function.function;
@@ -1381,6 +1750,14 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
   }
 
   jitted_function.queue_indices_ = jit_context.queue_indices();
+  jitted_function.partition_profile_ = std::move(partition_profile);
+  jitted_function.observed_nodes_ =
+      std::vector<Node*>(jit_context.observed_nodes().begin(),
+                         jit_context.observed_nodes().end());
+  if (xls_function->IsProc()) {
+    jitted_function.shared_state_indices_ = GetSharedStateIndices(
+        xls_function->AsProcOrDie(), top_partitions, allocator);
+  }
 
   return std::move(jitted_function);
 }
@@ -1467,6 +1844,17 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildFromAot(
       std::move(queue_indices));
 }
 
+namespace {
+// Traces are only recorded by the jitted code, so they are formatted once it
+// returns.
+void FormatPendingTraces(InstanceContext* instance_context,
+                         JitRuntime* jit_runtime) {
+  if (instance_context != nullptr) {
+    instance_context->FormatPendingTraces(jit_runtime);
+  }
+}
+}  // namespace
+
 int64_t JittedFunctionBase::RunJittedFunction(
     const JitArgumentSet& inputs, JitArgumentSet& outputs,
     JitTempBuffer& temp_buffer, InterpreterEvents* events,
@@ -1477,8 +1865,11 @@ int64_t JittedFunctionBase::RunJittedFunction(
   CHECK(outputs.is_outputs());
   CHECK_EQ(outputs.source(), this);
   CHECK_EQ(temp_buffer.source(), this);
-  return function_(inputs.get(), outputs.get(), temp_buffer.get(), events,
-                   instance_context, jit_runtime, continuation_point);
+  int64_t result =
+      function_(inputs.get(), outputs.get(), temp_buffer.get(), events,
+                instance_context, jit_runtime, continuation_point);
+  FormatPendingTraces(instance_context, jit_runtime);
+  return result;
 }
 
 namespace {
@@ -1531,8 +1922,10 @@ int64_t JittedFunctionBase::RunUnalignedJittedFunction(
       return result;
     }
   }
-  return function_(inputs, outputs, temp_buffer, events, instance_context,
-                   jit_runtime, continuation);
+  int64_t result = function_(inputs, outputs, temp_buffer, events,
+                             instance_context, jit_runtime, continuation);
+  FormatPendingTraces(instance_context, jit_runtime);
+  return result;
 }
 
 template int64_t
@@ -1553,9 +1946,11 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
     JitRuntime* jit_runtime, int64_t continuation_point) const {
   // Packed Jit makes no alignment assumptions, so nothing to check.
   if (packed_function_) {
-    return (*packed_function_)(inputs, outputs, temp_buffer, events,
-                               instance_context, jit_runtime,
-                               continuation_point);
+    int64_t result = (*packed_function_)(inputs, outputs, temp_buffer, events,
+                                         instance_context, jit_runtime,
+                                         continuation_point);
+    FormatPendingTraces(instance_context, jit_runtime);
+    return result;
   }
   return std::nullopt;
 }
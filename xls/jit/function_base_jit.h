@@ -14,7 +14,10 @@
 #ifndef XLS_JIT_FUNCTION_BASE_JIT_H_
 #define XLS_JIT_FUNCTION_BASE_JIT_H_
 
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -72,6 +75,71 @@ using JitFunctionType = int64_t (*)(const uint8_t* const* inputs,
                                     JitRuntime* jit_runtime,
                                     int64_t continuation_point);
 
+// Options controlling how a FunctionBase is divided into partitions, each of
+// which is emitted as a separate LLVM function. Larger partitions mean fewer
+// calls between partitions at run time but more LLVM optimization time, which
+// grows faster than linearly with the size of a function.
+struct JitPartitionOptions {
+  // The maximum estimated cost (see JitPartitionCost) of the nodes in a
+  // partition. Bounds the LLVM optimization effort spent on each partition.
+  int64_t max_partition_cost = 150;
+  // FunctionBases whose nodes have a total estimated cost of at most this are
+  // emitted as a single partition (apart from early exit points) as calls
+  // between partitions would dominate their run time.
+  int64_t single_partition_cost = 300;
+};
+
+// Sets the partition options used by subsequent JIT and AOT compilations.
+void SetJitPartitionOptions(const JitPartitionOptions& options);
+JitPartitionOptions GetJitPartitionOptions();
+
+// Returns the estimated cost of the LLVM code generated for `node`, used to
+// size partitions. The cost grows with the number of 64-bit words in the
+// node's value, quadratically for multiplies and divides, and is zero for
+// literals which are materialized where they are used.
+int64_t JitPartitionCost(Node* node);
+
+// Execution counts of the partitions of a jitted FunctionBase and of the
+// functions it calls, collected when
+// `JitProfilingOptions::count_partition_executions` is set. The jitted code
+// atomically increments the counters so a profile may be read while the code
+// runs on other threads.
+class JitPartitionProfile {
+ public:
+  struct Partition {
+    // Name of the LLVM function implementing the partition. This is the symbol
+    // reported by perf and gdb when the code is registered with them.
+    std::string symbol_name;
+    // Name of the FunctionBase containing the partition.
+    std::string function_base_name;
+    // Ids of the XLS nodes in the partition, in topological order.
+    std::vector<int64_t> node_ids;
+  };
+
+  // Adds a partition and returns the counter the jitted code should increment
+  // on each execution of it. The counter lives as long as the profile.
+  std::atomic<uint64_t>* AddPartition(Partition partition);
+
+  absl::Span<const Partition> partitions() const { return partitions_; }
+
+  // Returns the number of times partition `index` has executed.
+  uint64_t ExecutionCount(int64_t index) const {
+    return counts_.at(index).load(std::memory_order_relaxed);
+  }
+
+  // Zeroes all of the counters. Const as the counters are written by the
+  // jitted code regardless.
+  void Reset() const;
+
+  // Returns a table of the partitions sorted by decreasing execution count.
+  std::string ToString() const;
+
+ private:
+  std::vector<Partition> partitions_;
+  // A deque so the counters never move as partitions are added.
+  mutable std::deque<std::atomic<uint64_t>> counts_;
+};
+
 // Abstraction holding function pointers and metadata about a jitted function
 // implementing a XLS Function, Proc, etc.
 //
@@ -205,6 +273,26 @@ class JittedFunctionBase {
     return queue_indices_;
   }
 
+  // The execution counts of the partitions, or nullptr if they are not being
+  // counted (see JitProfilingOptions).
+  const JitPartitionProfile* partition_profile() const {
+    return partition_profile_.get();
+  }
+
+  // The indices of the state elements of a proc whose input and output buffers
+  // may be the same buffer. Such an element is updated in place rather than
+  // copied between the buffers on each tick. Always empty for AOT-compiled
+  // code.
+  absl::Span<int64_t const> shared_state_indices() const {
+    return shared_state_indices_;
+  }
+
+  // The nodes whose values the jitted code reports to the runtime observer,
+  // indexed by their slot in `InstanceContext::node_value_accumulators`. Empty
+  // unless observer callbacks are compiled in, and always empty for
+  // AOT-compiled code.
+  absl::Span<Node* const> observed_nodes() const { return observed_nodes_; }
+
   JittedFunctionBase WithCodePointers(
       JitFunctionType entrypoint,
       std::optional<JitFunctionType> packed_entrypoint = std::nullopt) const {
@@ -291,6 +379,16 @@ class JittedFunctionBase {
   // The map from channel reference name to the index of the respective queue in
   // the instance context.
   absl::btree_map<std::string, int64_t> queue_indices_;
+
+  // Counters incremented by the jitted code. Shared because the code refers to
+  // them by address and copies of this object run the same code.
+  std::shared_ptr<JitPartitionProfile> partition_profile_;
+
+  // See shared_state_indices().
+  std::vector<int64_t> shared_state_indices_;
+
+  // See observed_nodes().
+  std::vector<Node*> observed_nodes_;
 };
 
 struct FunctionEntrypoint {
@@ -15,8 +15,10 @@
 #include "xls/jit/function_jit.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,15 +29,22 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/keyword_args.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -43,18 +52,97 @@
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/llvm_compiler.h"
+#include "xls/jit/native_float_lowering.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
+FunctionJitContext::FunctionJitContext(
+    const JittedFunctionBase& jitted_function_base,
+    std::unique_ptr<JitRuntime> runtime)
+    : arg_buffers_(jitted_function_base.CreateInputBuffer()),
+      result_buffers_(jitted_function_base.CreateOutputBuffer()),
+      temp_buffer_(jitted_function_base.CreateTempBuffer()),
+      runtime_(std::move(runtime)) {}
+
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
     Function* xls_function, int64_t opt_level, bool include_observer_callbacks,
     JitObserver* jit_observer) {
+  if (JitNativeFloatOptions native_float_options = GetJitNativeFloatOptions();
+      native_float_options.enabled &&
+      native_float_options.verification_samples > 0) {
+    for (FunctionBase* callee : GetDependentFunctions(xls_function)) {
+      if (callee != xls_function && callee->IsFunction() &&
+          MatchNativeFloatFunction(callee->AsFunctionOrDie()).has_value()) {
+        XLS_RETURN_IF_ERROR(VerifyNativeFloatLowering(
+            callee->AsFunctionOrDie(), opt_level,
+            native_float_options.verification_samples));
+      }
+    }
+  }
   return CreateInternal(xls_function, opt_level, include_observer_callbacks,
                         jit_observer);
 }
 
+/* static */ absl::Status FunctionJit::VerifyNativeFloatLowering(
+    Function* callee, int64_t opt_level, int64_t samples) {
+  // The lowering depends only on the name and signature of the callee, so
+  // invoke a stand-in for it from a scratch package and compare the result
+  // against interpreting the real thing.
+  Package package("native_float_verification");
+  XLS_ASSIGN_OR_RETURN(Type * type,
+                       package.MapTypeFromOtherPackage(
+                           callee->GetType()->return_type()));
+  FunctionBuilder stand_in_builder(callee->name(), &package);
+  std::vector<BValue> stand_in_params;
+  for (Param* param : callee->params()) {
+    stand_in_params.push_back(stand_in_builder.Param(param->name(), type));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Function * stand_in,
+      stand_in_builder.BuildWithReturnValue(stand_in_params.front()));
+  FunctionBuilder wrapper_builder(
+      absl::StrCat(callee->name(), "_native_wrapper"), &package);
+  std::vector<BValue> wrapper_params;
+  for (Param* param : callee->params()) {
+    wrapper_params.push_back(wrapper_builder.Param(param->name(), type));
+  }
+  XLS_ASSIGN_OR_RETURN(Function * wrapper,
+                       wrapper_builder.BuildWithReturnValue(
+                           wrapper_builder.Invoke(wrapper_params, stand_in)));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       CreateInternal(wrapper, opt_level,
+                                      /*include_observer_callbacks=*/false,
+                                      /*jit_observer=*/nullptr));
+
+  // Fixed seed, so compilation is deterministic.
+  std::mt19937_64 rng(0);
+  for (int64_t i = 0; i < samples; ++i) {
+    std::vector<Value> args;
+    for (Param* param : callee->params()) {
+      args.push_back(RandomValue(param->GetType(), rng));
+    }
+    XLS_ASSIGN_OR_RETURN(Value expected, DropInterpreterEvents(
+                                             InterpretFunction(callee, args)));
+    XLS_ASSIGN_OR_RETURN(Value actual, DropInterpreterEvents(jit->Run(args)));
+    if (actual != expected) {
+      return absl::InternalError(absl::StrFormat(
+          "Native lowering of `%s` differs from its IR implementation on "
+          "(%s): %s vs %s",
+          callee->name(),
+          absl::StrJoin(args, ", ",
+                        [](std::string* out, const Value& arg) {
+                          absl::StrAppend(out, arg.ToString());
+                        }),
+          actual.ToString(), expected.ToString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Returns an object containing an AOT-compiled version of the specified XLS
 // function.
 /* static */ absl::StatusOr<std::unique_ptr<FunctionJit>>
@@ -81,6 +169,21 @@ FunctionJit::CreateFromAot(Function* xls_function,
       /*has_observer_callbacks=*/false, std::make_unique<JitRuntime>(*layout)));
 }
 
+std::unique_ptr<FunctionJit> FunctionJit::Clone() const {
+  return std::unique_ptr<FunctionJit>(new FunctionJit(
+      xls_function_, orc_jit_, JittedFunctionBase(jitted_function_base_),
+      has_observer_callbacks_,
+      std::make_unique<JitRuntime>(runtime()->data_layout())));
+}
+
+FunctionJitContext FunctionJit::CreateContext() const {
+  FunctionJitContext context(
+      jitted_function_base_,
+      std::make_unique<JitRuntime>(runtime()->data_layout()));
+  ClearArgumentBuffers(context.arg_buffers_);
+  return context;
+}
+
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
     Function* xls_function, int64_t opt_level, bool include_msan,
     JitObserver* observer) {
@@ -117,8 +220,24 @@ absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
       has_observer_callbacks, std::make_unique<JitRuntime>(data_layout)));
 }
 
+std::vector<TypeLayout> FunctionJit::CreateParamLayouts(Function* xls_function,
+                                                        JitRuntime& runtime) {
+  std::vector<TypeLayout> layouts;
+  layouts.reserve(xls_function->params().size());
+  for (Param* param : xls_function->params()) {
+    layouts.push_back(runtime.CreateTypeLayout(param->GetType()));
+  }
+  return layouts;
+}
+
+void FunctionJit::ClearArgumentBuffers(JitArgumentSet& arg_buffers) const {
+  for (int64_t i = 0; i < param_layouts_.size(); ++i) {
+    memset(arg_buffers.pointers()[i], 0, param_layouts_[i].size());
+  }
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    absl::Span<const Value> args) {
+    absl::Span<const Value> args, FunctionJitContext& context) const {
   absl::Span<Param* const> params = xls_function_->params();
   if (args.size() != params.size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
@@ -134,31 +253,28 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
+  // Copy in arg Values.
+  for (int64_t i = 0; i < args.size(); ++i) {
+    param_layouts_[i].ValueToNativeLayout(args[i],
+                                          context.arg_buffers_.pointers()[i]);
   }
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(
-      jit_runtime_->PackArgs(args, param_types, arg_buffers_.pointers()));
-
   // Call observers with function params.
-  if (CurrentRuntimeObserver() != nullptr) {
-    for (int64_t i = 0; i < function()->params().size(); ++i) {
-      CurrentRuntimeObserver()->RecordNodeValue(
-          static_cast<int64_t>(
-              reinterpret_cast<intptr_t>(function()->params()[i])),
-          arg_buffers_.pointers()[i]);
+  if (RuntimeObserver* observer = context.CurrentRuntimeObserver();
+      observer != nullptr) {
+    for (int64_t i = 0; i < params.size(); ++i) {
+      observer->RecordNodeValue(
+          static_cast<int64_t>(reinterpret_cast<intptr_t>(params[i])),
+          context.arg_buffers_.pointers()[i]);
     }
   }
   InterpreterEvents events;
   jitted_function_base_.RunJittedFunction(
-      arg_buffers_, result_buffers_, temp_buffer_, &events,
-      /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(),
-      /*continuation_point=*/0);
-  Value result = jit_runtime_->UnpackBuffer(
-      result_buffers_.pointers()[0], xls_function_->return_value()->GetType());
+      context.arg_buffers_, context.result_buffers_, context.temp_buffer_,
+      &events, /*instance_context=*/&context.callbacks_,
+      /*jit_runtime=*/context.runtime(), /*continuation_point=*/0);
+  Value result =
+      return_layout_.NativeLayoutToValue(context.result_buffers_.pointers()[0]);
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
@@ -205,8 +321,8 @@ void FunctionJit::InvokeUnalignedJitFunction(
     InterpreterEvents* events) {
   uint8_t* output_buffers[1] = {output_buffer};
   jitted_function_base_.RunUnalignedJittedFunction<kForceZeroCopy>(
-      arg_buffers.data(), output_buffers, temp_buffer_.get(), events,
-      /*instance_context=*/&callbacks_, runtime(), /*continuation=*/0);
+      arg_buffers.data(), output_buffers, context_.temp_buffer_.get(), events,
+      /*instance_context=*/&context_.callbacks_, runtime(), /*continuation=*/0);
 }
 
 template void FunctionJit::InvokeUnalignedJitFunction</*kForceZeroCopy=*/false>(
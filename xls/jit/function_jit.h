@@ -21,6 +21,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -38,17 +39,65 @@
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
+class FunctionJit;
+
+// The mutable state of one invocation of a FunctionJit: the argument, result
+// and temporary buffers, the runtime callbacks (including any runtime observer)
+// and the JIT runtime. The compiled code of a FunctionJit is never modified by
+// running it, so any number of threads may run the same FunctionJit at once as
+// long as each uses its own context. Created by FunctionJit::CreateContext and
+// must not outlive the FunctionJit it was created by.
+class FunctionJitContext {
+ public:
+  FunctionJitContext(FunctionJitContext&&) = default;
+
+  JitRuntime* runtime() const { return runtime_.get(); }
+
+  RuntimeObserver* CurrentRuntimeObserver() const {
+    return callbacks_.observer;
+  }
+
+  // Sets the maximum verbosity of the traces recorded by subsequent runs with
+  // this context. Traces with a greater verbosity are skipped by the jitted
+  // code.
+  void SetMaxTraceVerbosity(int64_t verbosity) {
+    callbacks_.max_trace_verbosity = verbosity;
+  }
+
+ private:
+  friend class FunctionJit;
+
+  FunctionJitContext(const JittedFunctionBase& jitted_function_base,
+                     std::unique_ptr<JitRuntime> runtime);
+
+  // Pre-allocated & aligned storage for a set of arguments.
+  JitArgumentSet arg_buffers_;
+  // Pre-allocated & aligned storage for a result.
+  JitArgumentSet result_buffers_;
+  // Pre-allocated & aligned storage for required temporary storage.
+  JitTempBuffer temp_buffer_;
+
+  // Context callbacks.
+  InstanceContext callbacks_ = InstanceContext::CreateForFunc();
+
+  std::unique_ptr<JitRuntime> runtime_;
+};
+
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it. The methods
+// which do not take a FunctionJitContext share a single default context and so
+// are not thread-safe; those which do may be called concurrently from
+// different threads, each with its own context.
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // function.
+  // function. If native floating-point lowering is enabled with verification
+  // (see JitNativeFloatOptions), first checks the native lowering of each
+  // floating-point function that `xls_function` invokes.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
       Function* xls_function, int64_t opt_level = 3,
       bool include_observer_callbacks = false,
@@ -61,13 +110,29 @@ class FunctionJit {
       std::string_view data_layout, JitFunctionType function_unpacked,
       std::optional<JitFunctionType> function_packed = std::nullopt);
 
+  // Returns a new JIT for the same function which shares this JIT's compiled
+  // code but has its own buffers and runtime, so the two may be run
+  // concurrently from different threads. Runtime observers are not copied.
+  std::unique_ptr<FunctionJit> Clone() const;
+
+  // Returns a new context for running this JIT, with no runtime observer. See
+  // FunctionJitContext.
+  FunctionJitContext CreateContext() const;
+
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(
       Function* xls_function, int64_t opt_level, bool include_msan,
       JitObserver* observer = nullptr);
 
   // Executes the compiled function with the specified arguments.
-  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args) {
+    return Run(args, context_);
+  }
+
+  // As above, but using the buffers and callbacks of `context`. Thread-safe
+  // with respect to runs using other contexts.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args, FunctionJitContext& context) const;
 
   // As above, buth with arguments as key-value pairs.
   absl::StatusOr<InterpreterResult<Value>> Run(
@@ -119,8 +184,9 @@ class FunctionJit {
     InterpreterEvents events;
     uint8_t* output_buffers[1] = {result_buffer};
     jitted_function_base_.RunPackedJittedFunction(
-        arg_buffers, output_buffers, temp_buffer_.get(), &events,
-        /*instance_context=*/&callbacks_, runtime(), /*continuation_point=*/0);
+        arg_buffers, output_buffers, context_.temp_buffer_.get(), &events,
+        /*instance_context=*/&context_.callbacks_, runtime(),
+        /*continuation_point=*/0);
 
     return InterpreterEventsToStatus(events);
   }
@@ -190,41 +256,73 @@ class FunctionJit {
     return jitted_function_base_.function_name();
   }
 
-  JitRuntime* runtime() const { return jit_runtime_.get(); }
+  JitRuntime* runtime() const { return context_.runtime(); }
 
   RuntimeObserver* CurrentRuntimeObserver() const {
-    return callbacks_.observer;
+    return context_.CurrentRuntimeObserver();
   }
 
-  void ClearRuntimeObserver() { callbacks_.observer = nullptr; }
+  void ClearRuntimeObserver() { ClearRuntimeObserver(context_); }
+  void ClearRuntimeObserver(FunctionJitContext& context) const {
+    context.callbacks_.SetObserver(nullptr, /*observed_nodes=*/{},
+                                   context.runtime());
+  }
   // Set a callback to get notified on each node's evaluation.
   absl::Status SetRuntimeObserver(RuntimeObserver* observer) {
+    return SetRuntimeObserver(observer, context_);
+  }
+  // As above, but only for runs using `context`.
+  absl::Status SetRuntimeObserver(RuntimeObserver* observer,
+                                  FunctionJitContext& context) const {
     if (!has_observer_callbacks_) {
       return absl::UnimplementedError("Observer callbacks not supported.");
     }
-    callbacks_.observer = observer;
+    context.callbacks_.SetObserver(
+        observer, jitted_function_base_.observed_nodes(), context.runtime());
     return absl::OkStatus();
   }
   bool SupportsObservers() const { return has_observer_callbacks_; }
 
+  // Sets the maximum verbosity of the traces recorded by subsequent runs.
+  // Traces with a greater verbosity are skipped by the jitted code.
+  void SetMaxTraceVerbosity(int64_t verbosity) {
+    context_.SetMaxTraceVerbosity(verbosity);
+  }
+
  private:
-  FunctionJit(Function* xls_function, std::unique_ptr<OrcJit>&& orc_jit,
+  FunctionJit(Function* xls_function, std::shared_ptr<OrcJit> orc_jit,
               JittedFunctionBase&& jitted_function_base,
               bool has_observer_callbacks,
               std::unique_ptr<JitRuntime>&& runtime)
       : xls_function_(xls_function),
         orc_jit_(std::move(orc_jit)),
         jitted_function_base_(std::move(jitted_function_base)),
-        arg_buffers_(jitted_function_base_.CreateInputBuffer()),
-        result_buffers_(jitted_function_base_.CreateOutputBuffer()),
-        temp_buffer_(jitted_function_base_.CreateTempBuffer()),
-        jit_runtime_(std::move(runtime)),
-        has_observer_callbacks_(has_observer_callbacks) {}
+        param_layouts_(CreateParamLayouts(xls_function, *runtime)),
+        return_layout_(
+            runtime->CreateTypeLayout(xls_function->return_value()->GetType())),
+        has_observer_callbacks_(has_observer_callbacks),
+        context_(jitted_function_base_, std::move(runtime)) {
+    ClearArgumentBuffers(context_.arg_buffers_);
+  }
+
+  static std::vector<TypeLayout> CreateParamLayouts(Function* xls_function,
+                                                    JitRuntime& runtime);
+
+  // Zeroes the given argument buffers. Converting a value to its native layout
+  // only writes the bytes of its elements, so this ensures any bytes between
+  // elements are zero.
+  void ClearArgumentBuffers(JitArgumentSet& arg_buffers) const;
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
       Function* xls_function, int64_t opt_level,
       bool include_observer_callbacks, JitObserver* jit_observer);
 
+  // Checks that the native lowering of `callee` (see native_float_lowering.h)
+  // matches the IR implementation of `callee` on `samples` sampled inputs.
+  static absl::Status VerifyNativeFloatLowering(Function* callee,
+                                                int64_t opt_level,
+                                                int64_t samples);
+
   template <bool kForceZeroCopy, typename... ArgsT>
   absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
     const uint8_t* arg_buffers[sizeof...(ArgsT)];
@@ -284,25 +382,21 @@ class FunctionJit {
 
   Function* xls_function_;
 
-  std::unique_ptr<OrcJit> orc_jit_;
+  // Shared with any clones of this JIT.
+  std::shared_ptr<OrcJit> orc_jit_;
 
   JittedFunctionBase jitted_function_base_;
 
-  // Pre-allocated & aligned storage for a set of arguments. Not thread safe.
-  JitArgumentSet arg_buffers_;
-  // Pre-allocated & aligned storage for a result. Not thread safe.
-  JitArgumentSet result_buffers_;
-  // Pre-allocated & aligned storage for required temporary storage. NB Not
-  // thread safe.
-  JitTempBuffer temp_buffer_;
-
-  // Context callbacks.
-  InstanceContext callbacks_ = InstanceContext::CreateForFunc();
-
-  std::unique_ptr<JitRuntime> jit_runtime_;
+  // The native layouts of the params and return value, used to convert the
+  // arguments and result of Run.
+  std::vector<TypeLayout> param_layouts_;
+  TypeLayout return_layout_;
 
   // Are callbacks for node-values compiled in.
   bool has_observer_callbacks_;
+
+  // The context used by the methods which do not take one. Not thread safe.
+  FunctionJitContext context_;
 };
 
 }  // namespace xls
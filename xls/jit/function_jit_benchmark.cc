@@ -0,0 +1,198 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+// Measures the cost of calls between jitted functions and partitions. Under
+// MSan every call passes argument shadows through the thread-local MSan
+// buffers, which the jitted code reaches through emulated TLS, so comparing
+// runs of an MSan and a regular build shows the TLS overhead.
+
+// Returns a function applying `count` invokes of a 64-bit increment function.
+Function* MakeInvokeChain(Package* package, int64_t count) {
+  FunctionBuilder inc_builder("inc", package);
+  BValue y = inc_builder.Param("y", package->GetBitsType(64));
+  inc_builder.Add(y, inc_builder.Literal(UBits(1, 64)));
+  Function* inc = inc_builder.Build().value();
+
+  FunctionBuilder fb("invoke_chain", package);
+  BValue value = fb.Param("x", package->GetBitsType(64));
+  for (int64_t i = 0; i < count; ++i) {
+    value = fb.Invoke({value}, inc);
+  }
+  return fb.BuildWithReturnValue(value).value();
+}
+
+// Returns a function of a chain of `count` 64-bit adds.
+Function* MakeAddChain(Package* package, int64_t count) {
+  FunctionBuilder fb("add_chain", package);
+  BValue x = fb.Param("x", package->GetBitsType(64));
+  BValue value = x;
+  for (int64_t i = 0; i < count; ++i) {
+    value = fb.Add(value, x);
+  }
+  return fb.BuildWithReturnValue(value).value();
+}
+
+void RunJit(benchmark::State& state, Function* function) {
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(function).value();
+  uint64_t x = 3;
+  uint64_t result = 0;
+  std::vector<uint8_t*> args = {reinterpret_cast<uint8_t*>(&x)};
+  absl::Span<uint8_t> result_buffer(reinterpret_cast<uint8_t*>(&result),
+                                    sizeof(result));
+  InterpreterEvents events;
+  for (auto _ : state) {
+    CHECK_OK(jit->RunWithViews(args, result_buffer, &events));
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+void BM_InvokeChain(benchmark::State& state) {
+  Package package("BM");
+  RunJit(state, MakeInvokeChain(&package, state.range(0)));
+}
+
+// Splits the add chain into many small partitions so each run makes many
+// calls between partitions.
+void BM_PartitionedAddChain(benchmark::State& state) {
+  Package package("BM");
+  Function* function = MakeAddChain(&package, state.range(0));
+  SetJitPartitionOptions(
+      JitPartitionOptions{.max_partition_cost = 4, .single_partition_cost = 0});
+  RunJit(state, function);
+  SetJitPartitionOptions(JitPartitionOptions());
+}
+
+// Measures `function` on random inputs.
+void RunJitOnRandomArgs(benchmark::State& state, Function* function) {
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(function).value();
+
+  std::mt19937_64 bitgen(0);
+  std::vector<std::vector<uint8_t>> arg_buffers;
+  std::vector<uint8_t*> args;
+  for (int64_t i = 0; i < function->params().size(); ++i) {
+    Type* type = function->param(i)->GetType();
+    std::vector<uint8_t>& buffer =
+        arg_buffers.emplace_back(jit->GetArgTypeSize(i));
+    jit->runtime()->BlitValueToBuffer(RandomValue(type, bitgen), type,
+                                      absl::MakeSpan(buffer));
+  }
+  for (std::vector<uint8_t>& buffer : arg_buffers) {
+    args.push_back(buffer.data());
+  }
+  std::vector<uint8_t> result(jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    CHECK_OK(jit->RunWithViews(args, absl::MakeSpan(result), &events));
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+// Measures the top function of the IR file at runfile `ir_path` on random
+// inputs. The AES S-box and the table-driven CRC exercise indexing into literal
+// arrays, which the JIT reads from constant tables.
+void RunJitOnIrFile(benchmark::State& state, std::string_view ir_path) {
+  std::filesystem::path path = GetXlsRunfilePath(ir_path).value();
+  std::unique_ptr<Package> package =
+      Parser::ParsePackage(GetFileContents(path).value()).value();
+  RunJitOnRandomArgs(state, package->GetTopAsFunction().value());
+}
+
+// Measures a chain of 16 binary ops `op` of arguments of `state.range(0)` bits,
+// which the JIT lowers word by word above 128 bits.
+void RunWideArithmeticChain(benchmark::State& state, Op op) {
+  Package package("BM");
+  Type* type = package.GetBitsType(state.range(0));
+  FunctionBuilder fb("chain", &package);
+  BValue x = fb.Param("x", type);
+  BValue y = fb.Param("y", type);
+  BValue value = x;
+  for (int64_t i = 0; i < 16; ++i) {
+    switch (op) {
+      case Op::kUMul:
+        value = fb.UMul(value, y);
+        break;
+      case Op::kUDiv:
+        value = fb.UDiv(fb.Add(value, x), y);
+        break;
+      default:
+        value = fb.AddBinOp(op, value, fb.BitSlice(y, 0, 8));
+        break;
+    }
+  }
+  RunJitOnRandomArgs(state, fb.BuildWithReturnValue(value).value());
+}
+
+void BM_WideUMul(benchmark::State& state) {
+  RunWideArithmeticChain(state, Op::kUMul);
+}
+
+void BM_WideUDiv(benchmark::State& state) {
+  RunWideArithmeticChain(state, Op::kUDiv);
+}
+
+void BM_WideShll(benchmark::State& state) {
+  RunWideArithmeticChain(state, Op::kShll);
+}
+
+void BM_WideShra(benchmark::State& state) {
+  RunWideArithmeticChain(state, Op::kShra);
+}
+
+void BM_AesEncrypt(benchmark::State& state) {
+  RunJitOnIrFile(state, "xls/modules/aes/aes_encrypt.ir");
+}
+
+void BM_Crc32(benchmark::State& state) {
+  RunJitOnIrFile(state, "xls/examples/crc32/crc32.opt.ir");
+}
+
+BENCHMARK(BM_InvokeChain)->Arg(16)->Arg(256);
+BENCHMARK(BM_PartitionedAddChain)->Arg(16)->Arg(256);
+BENCHMARK(BM_WideUMul)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+BENCHMARK(BM_WideUDiv)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+BENCHMARK(BM_WideShll)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+BENCHMARK(BM_WideShra)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+BENCHMARK(BM_AesEncrypt);
+BENCHMARK(BM_Crc32);
+
+}  // namespace
+}  // namespace xls
@@ -20,6 +20,7 @@
 #include <initializer_list>
 #include <ios>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <random>
@@ -31,6 +32,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -38,16 +40,20 @@
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/Module.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/random_value.h"
@@ -290,6 +296,59 @@ TEST(FunctionJitTest, TraceFmtBigArgTest) {
             "00000000000000000000000000000000000000000000000000000000000000");
 }
 
+TEST(FunctionJitTest, TraceFmtCompoundArgsTest) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn trace_compound(tkn: token, x: (bits[3], bits[17]), y: bits[5][2]) -> token {
+    pred: bits[1] = literal(value=1)
+    trace.1: token = trace(tkn, pred, format="x: {:x} y: {}", data_operands=[x, y], id=1)
+    ret trace.2: token = trace(trace.1, pred, format="again {}", data_operands=[y], id=2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(Value y, Value::UBitsArray({7, 31}, 5));
+  for (int64_t i = 0; i < 2; ++i) {
+    std::vector<Value> args = {
+        Value::Token(),
+        Value::Tuple({Value(UBits(5, 3)), Value(UBits(0x1abcd + i, 17))}), y};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+    EXPECT_THAT(result.events.trace_msgs,
+                ElementsAre(TraceMessage(absl::StrFormat(
+                                             "x: (5, %x) y: [7, 31]",
+                                             0x1abcd + i),
+                                         0),
+                            TraceMessage("again [7, 31]", 0)));
+  }
+}
+
+TEST(FunctionJitTest, TraceMaxVerbosityTest) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn trace_verbosity(tkn: token, x: bits[8]) -> token {
+    pred: bits[1] = literal(value=1)
+    trace.1: token = trace(tkn, pred, format="quiet: {}", data_operands=[x], id=1)
+    ret trace.2: token = trace(trace.1, pred, format="loud: {}", data_operands=[x], verbosity=2, id=2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<Value> args = {Value::Token(), Value(UBits(42, 8))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("quiet: 42", 0),
+                          TraceMessage("loud: 42", 2)));
+
+  jit->SetMaxTraceVerbosity(1);
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("quiet: 42", 0)));
+}
+
 // This test verifies that a compiled JIT function can be reused.
 TEST(FunctionJitTest, ReuseTest) {
   Package package("my_package");
@@ -310,6 +369,481 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+TEST(FunctionJitTest, ClonesRunConcurrently) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add_mul(x: bits[16], y: bits[16]) -> (bits[16], bits[16]) {
+    add.1: bits[16] = add(x, y)
+    umul.2: bits[16] = umul(x, y)
+    ret tuple.3: (bits[16], bits[16]) = tuple(add.1, umul.2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kThreadCount = 4;
+  constexpr int64_t kRunsPerThread = 1000;
+  std::vector<std::unique_ptr<FunctionJit>> clones;
+  std::vector<std::vector<Value>> results(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    clones.push_back(jit->Clone());
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      for (int64_t i = 0; i < kRunsPerThread; ++i) {
+        results[t].push_back(
+            RunJitNoEvents(clones[t].get(),
+                           {Value(UBits(t + i, 16)), Value(UBits(i, 16))})
+                .value());
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    for (int64_t i = 0; i < kRunsPerThread; ++i) {
+      EXPECT_THAT(
+          RunJitNoEvents(jit.get(),
+                         {Value(UBits(t + i, 16)), Value(UBits(i, 16))}),
+          IsOkAndHolds(results[t][i]));
+    }
+  }
+}
+
+TEST(FunctionJitTest, SharedJitRunsConcurrentlyWithContexts) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add_mul(x: bits[16], y: bits[16]) -> (bits[16], bits[16]) {
+    add.1: bits[16] = add(x, y)
+    umul.2: bits[16] = umul(x, y)
+    ret tuple.3: (bits[16], bits[16]) = tuple(add.1, umul.2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(function));
+  const FunctionJit& shared_jit = *jit;
+
+  constexpr int64_t kThreadCount = 4;
+  constexpr int64_t kRunsPerThread = 1000;
+  std::vector<std::vector<Value>> results(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      FunctionJitContext context = shared_jit.CreateContext();
+      for (int64_t i = 0; i < kRunsPerThread; ++i) {
+        results[t].push_back(
+            DropInterpreterEvents(
+                shared_jit.Run({Value(UBits(t + i, 16)), Value(UBits(i, 16))},
+                               context))
+                .value());
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    ASSERT_EQ(results[t].size(), kRunsPerThread);
+    for (int64_t i = 0; i < kRunsPerThread; ++i) {
+      EXPECT_EQ(results[t][i],
+                Value::Tuple({Value(UBits(2 * i + t, 16)),
+                              Value(UBits((t + i) * i, 16))}));
+    }
+  }
+}
+
+TEST(FunctionJitTest, ContextsHaveSeparateTraceVerbosity) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn trace_verbosity(tkn: token, x: bits[8]) -> token {
+    pred: bits[1] = literal(value=1)
+    trace.1: token = trace(tkn, pred, format="quiet: {}", data_operands=[x], id=1)
+    ret trace.2: token = trace(trace.1, pred, format="loud: {}", data_operands=[x], verbosity=2, id=2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  FunctionJitContext quiet = jit->CreateContext();
+  quiet.SetMaxTraceVerbosity(1);
+  FunctionJitContext loud = jit->CreateContext();
+
+  std::vector<Value> args = {Value::Token(), Value(UBits(42, 8))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           jit->Run(args, quiet));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("quiet: 42", 0)));
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args, loud));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(TraceMessage("quiet: 42", 0),
+                          TraceMessage("loud: 42", 2)));
+  // The default context is unaffected.
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args));
+  EXPECT_EQ(result.events.trace_msgs.size(), 2);
+}
+
+TEST(FunctionJitTest, ConcurrentCodegenMatchesSerial) {
+  Package package("my_package");
+  // Enough nodes to be split into several partitions.
+  FunctionBuilder fb("long_chain", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 500; ++i) {
+    value = (i % 2 == 0) ? fb.Add(value, y)
+                         : fb.Xor(value, fb.Literal(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto serial_jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      JitObjectCode serial_object,
+      FunctionJit::CreateObjectCode(function, LlvmCompiler::kDefaultOptLevel,
+                                    /*include_msan=*/false));
+
+  SetLlvmCodegenThreadCount(4);
+  absl::StatusOr<std::unique_ptr<FunctionJit>> concurrent_jit =
+      FunctionJit::Create(function);
+  absl::StatusOr<JitObjectCode> concurrent_object =
+      FunctionJit::CreateObjectCode(function, LlvmCompiler::kDefaultOptLevel,
+                                    /*include_msan=*/false);
+  absl::StatusOr<JitObjectCode> concurrent_object_again =
+      FunctionJit::CreateObjectCode(function, LlvmCompiler::kDefaultOptLevel,
+                                    /*include_msan=*/false);
+  SetLlvmCodegenThreadCount(1);
+  XLS_ASSERT_OK(concurrent_jit.status());
+  XLS_ASSERT_OK(concurrent_object.status());
+  XLS_ASSERT_OK(concurrent_object_again.status());
+
+  for (int64_t i = 0; i < 10; ++i) {
+    std::vector<Value> args = {Value(UBits(i * 1234567, 32)),
+                               Value(UBits(i * 7654321 + 1, 32))};
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             RunJitNoEvents(serial_jit.get(), args));
+    EXPECT_THAT(RunJitNoEvents(concurrent_jit->get(), args),
+                IsOkAndHolds(expected));
+  }
+  // The AOT compiler still emits a single object file, and does so
+  // deterministically.
+  EXPECT_FALSE(serial_object.object_code.empty());
+  EXPECT_FALSE(concurrent_object->object_code.empty());
+  EXPECT_EQ(concurrent_object->object_code,
+            concurrent_object_again->object_code);
+}
+
+TEST(FunctionJitTest, LazyCompilationMatchesEager) {
+  Package package("my_package");
+  Type* u32 = package.GetBitsType(32);
+  // A chain of invoked functions, each compiled lazily on its first call.
+  Function* callee = nullptr;
+  for (int64_t i = 0; i < 4; ++i) {
+    FunctionBuilder fb(absl::StrFormat("callee%d", i), &package);
+    BValue x = fb.Param("x", u32);
+    BValue value = fb.Add(fb.UMul(x, x), fb.Literal(UBits(i, 32)));
+    if (callee != nullptr) {
+      value = fb.Invoke({value}, callee);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(callee, fb.BuildWithReturnValue(value));
+  }
+  FunctionBuilder fb("top", &package);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * top, fb.BuildWithReturnValue(fb.Xor(fb.Invoke({x}, callee),
+                                                     fb.Invoke({y}, callee))));
+  XLS_ASSERT_OK_AND_ASSIGN(auto eager_jit, FunctionJit::Create(top));
+
+  SetJitLazyCompilation(true);
+  absl::StatusOr<std::unique_ptr<FunctionJit>> lazy_jit =
+      FunctionJit::Create(top);
+  SetJitLazyCompilation(false);
+  XLS_ASSERT_OK(lazy_jit.status());
+
+  for (int64_t i = 0; i < 10; ++i) {
+    std::vector<Value> args = {Value(UBits(i * 1234567, 32)),
+                               Value(UBits(i * 7654321 + 1, 32))};
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             RunJitNoEvents(eager_jit.get(), args));
+    EXPECT_THAT(RunJitNoEvents(lazy_jit->get(), args),
+                IsOkAndHolds(expected));
+  }
+}
+
+TEST(FunctionJitTest, PartitionCostModel) {
+  Package package("my_package");
+  FunctionBuilder fb("costs", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue wide = fb.Param("wide", package.GetBitsType(256));
+  BValue literal = fb.Literal(UBits(1, 32));
+  BValue add = fb.Add(x, literal);
+  BValue wide_add = fb.Add(wide, wide);
+  BValue wide_mul = fb.UMul(wide, wide);
+  BValue div = fb.UDiv(x, x);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_EQ(JitPartitionCost(literal.node()), 0);
+  EXPECT_EQ(JitPartitionCost(add.node()), 1);
+  EXPECT_EQ(JitPartitionCost(wide_add.node()), 4);
+  EXPECT_EQ(JitPartitionCost(wide_mul.node()), 64);
+  EXPECT_EQ(JitPartitionCost(div.node()), 8);
+}
+
+// Accumulates the values of every node and counts the values it is called
+// back with.
+class AccumulatingObserver final : public RuntimeObserver {
+ public:
+  void RecordNodeValue(int64_t node_ptr, const uint8_t* data) override {
+    ++recorded_values_;
+  }
+  uint8_t* GetNodeValueAccumulator(Node* node, int64_t byte_size) override {
+    std::vector<uint8_t>& storage = accumulators_[node];
+    storage.resize(byte_size, 0);
+    return storage.data();
+  }
+
+  const uint8_t* accumulator(Node* node) const {
+    return accumulators_.at(node).data();
+  }
+  int64_t recorded_values() const { return recorded_values_; }
+
+ private:
+  absl::flat_hash_map<Node*, std::vector<uint8_t>> accumulators_;
+  int64_t recorded_values_ = 0;
+};
+
+TEST(FunctionJitTest, ObserverAccumulatesNodeValues) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, Parser::ParseFunction(R"(
+  fn f(x: bits[8], y: bits[200]) -> (bits[8], bits[200]) {
+    not.1: bits[8] = not(x)
+    identity.2: bits[200] = identity(y)
+    ret tuple.3: (bits[8], bits[200]) = tuple(not.1, identity.2)
+  }
+  )",
+                                                                    &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, LlvmCompiler::kDefaultOptLevel,
+                                    /*include_observer_callbacks=*/true));
+  AccumulatingObserver observer;
+  XLS_ASSERT_OK(jit->SetRuntimeObserver(&observer));
+  Bits high_bit = bits_ops::ShiftLeftLogical(UBits(1, 200), 199);
+  XLS_ASSERT_OK(
+      jit->Run({Value(UBits(0x0f, 8)), Value(UBits(1, 200))}).status());
+  XLS_ASSERT_OK(jit->Run({Value(UBits(0xfc, 8)), Value(high_bit)}).status());
+  EXPECT_EQ(observer.recorded_values(), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_node, function->GetNode("not.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * identity, function->GetNode("identity.2"));
+  EXPECT_EQ(jit->runtime()->UnpackBuffer(observer.accumulator(not_node),
+                                         not_node->GetType()),
+            Value(UBits(0xf3, 8)));
+  EXPECT_EQ(jit->runtime()->UnpackBuffer(observer.accumulator(identity),
+                                         identity->GetType()),
+            Value(bits_ops::Or(UBits(1, 200), high_bit)));
+}
+
+// Counts the partition functions in the unoptimized module.
+class PartitionCountingObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.unoptimized_module = true};
+  }
+  void UnoptimizedModule(const llvm::Module* module) override {
+    partition_count_ = 0;
+    for (const llvm::Function& function : module->functions()) {
+      if (absl::StrContains(function.getName().str(), "_partition_")) {
+        ++partition_count_;
+      }
+    }
+  }
+  int64_t partition_count() const { return partition_count_; }
+
+ private:
+  int64_t partition_count_ = 0;
+};
+
+TEST(FunctionJitTest, PartitionOptionsControlPartitioning) {
+  Package package("my_package");
+  FunctionBuilder fb("chain", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 199; ++i) {
+    value = fb.Add(value, x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  std::vector<Value> args = {Value(UBits(3, 32))};
+
+  // The function is small enough to be emitted as a single partition.
+  PartitionCountingObserver merged_observer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto merged_jit,
+      FunctionJit::Create(function, /*opt_level=*/1,
+                          /*include_observer_callbacks=*/false,
+                          &merged_observer));
+  EXPECT_EQ(merged_observer.partition_count(), 1);
+  EXPECT_THAT(RunJitNoEvents(merged_jit.get(), args),
+              IsOkAndHolds(Value(UBits(600, 32))));
+
+  // Capping the cost splits it. Each partition holds at most 50 nodes.
+  SetJitPartitionOptions(JitPartitionOptions{.max_partition_cost = 50,
+                                             .single_partition_cost = 0});
+  PartitionCountingObserver split_observer;
+  absl::StatusOr<std::unique_ptr<FunctionJit>> split_jit =
+      FunctionJit::Create(function, /*opt_level=*/1,
+                          /*include_observer_callbacks=*/false,
+                          &split_observer);
+  SetJitPartitionOptions(JitPartitionOptions());
+  XLS_ASSERT_OK(split_jit.status());
+  EXPECT_EQ(split_observer.partition_count(), 4);
+  EXPECT_THAT(RunJitNoEvents(split_jit->get(), args),
+              IsOkAndHolds(Value(UBits(600, 32))));
+}
+
+TEST(FunctionJitTest, CountPartitionExecutions) {
+  Package package("my_package");
+  FunctionBuilder fb("chain", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 199; ++i) {
+    value = fb.Add(value, x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  std::vector<Value> args = {Value(UBits(3, 32))};
+
+  // Without the option nothing is counted.
+  XLS_ASSERT_OK_AND_ASSIGN(auto uncounted_jit, FunctionJit::Create(function));
+  EXPECT_EQ(uncounted_jit->jitted_function_base().partition_profile(),
+            nullptr);
+
+  SetJitPartitionOptions(JitPartitionOptions{.max_partition_cost = 50,
+                                             .single_partition_cost = 0});
+  SetJitProfilingOptions(
+      JitProfilingOptions{.count_partition_executions = true});
+  absl::StatusOr<std::unique_ptr<FunctionJit>> jit =
+      FunctionJit::Create(function);
+  SetJitProfilingOptions(JitProfilingOptions());
+  SetJitPartitionOptions(JitPartitionOptions());
+  XLS_ASSERT_OK(jit.status());
+  const JitPartitionProfile* profile =
+      (*jit)->jitted_function_base().partition_profile();
+  ASSERT_NE(profile, nullptr);
+  ASSERT_EQ(profile->partitions().size(), 4);
+
+  // Every node appears in exactly one partition.
+  int64_t node_count = 0;
+  for (const JitPartitionProfile::Partition& partition :
+       profile->partitions()) {
+    EXPECT_THAT(partition.symbol_name, HasSubstr("_partition_"));
+    EXPECT_EQ(partition.function_base_name, "chain");
+    node_count += partition.node_ids.size();
+  }
+  EXPECT_EQ(node_count, function->node_count());
+
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_THAT(RunJitNoEvents(jit->get(), args),
+                IsOkAndHolds(Value(UBits(600, 32))));
+  }
+  for (int64_t i = 0; i < profile->partitions().size(); ++i) {
+    EXPECT_EQ(profile->ExecutionCount(i), 3);
+  }
+  EXPECT_THAT(profile->ToString(),
+              HasSubstr(profile->partitions().front().symbol_name));
+
+  profile->Reset();
+  EXPECT_EQ(profile->ExecutionCount(0), 0);
+}
+
+Value F32Bits(uint32_t bits) {
+  return Value::Tuple({Value(UBits(bits >> 31, 1)),
+                       Value(UBits((bits >> 23) & 0xff, 8)),
+                       Value(UBits(bits & 0x7fffff, 23))});
+}
+
+Value F32(float value) { return F32Bits(absl::bit_cast<uint32_t>(value)); }
+
+// Builds a function named `name` invoking a stand-in for the float32
+// function `callee` which just returns its first operand, so only a native
+// lowering computes the actual operation.
+absl::StatusOr<Function*> BuildFloat32Invoke(Package& package,
+                                             std::string_view name,
+                                             std::string_view callee) {
+  Type* type = package.GetTupleType({package.GetBitsType(1),
+                                     package.GetBitsType(8),
+                                     package.GetBitsType(23)});
+  FunctionBuilder stand_in_builder(callee, &package);
+  BValue x = stand_in_builder.Param("x", type);
+  stand_in_builder.Param("y", type);
+  XLS_ASSIGN_OR_RETURN(Function * stand_in,
+                       stand_in_builder.BuildWithReturnValue(x));
+  FunctionBuilder fb(name, &package);
+  BValue a = fb.Param("a", type);
+  BValue b = fb.Param("b", type);
+  return fb.BuildWithReturnValue(fb.Invoke({a, b}, stand_in));
+}
+
+TEST(FunctionJitTest, NativeFloatLowering) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * add, BuildFloat32Invoke(package, "add", "__float32__add"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * mul, BuildFloat32Invoke(package, "mul", "__float32__mul"));
+
+  // Without the option the invoked function is used.
+  XLS_ASSERT_OK_AND_ASSIGN(auto bit_level_jit, FunctionJit::Create(add));
+  EXPECT_THAT(RunJitNoEvents(bit_level_jit.get(), {F32(1.5f), F32(2.25f)}),
+              IsOkAndHolds(F32(1.5f)));
+
+  SetJitNativeFloatOptions(JitNativeFloatOptions{.enabled = true});
+  absl::StatusOr<std::unique_ptr<FunctionJit>> add_jit =
+      FunctionJit::Create(add);
+  absl::StatusOr<std::unique_ptr<FunctionJit>> mul_jit =
+      FunctionJit::Create(mul);
+  SetJitNativeFloatOptions(JitNativeFloatOptions());
+  XLS_ASSERT_OK(add_jit.status());
+  XLS_ASSERT_OK(mul_jit.status());
+
+  constexpr float kInfinity = std::numeric_limits<float>::infinity();
+  constexpr float kMinNormal = std::numeric_limits<float>::min();
+  EXPECT_THAT(RunJitNoEvents(add_jit->get(), {F32(1.5f), F32(2.25f)}),
+              IsOkAndHolds(F32(3.75f)));
+  EXPECT_THAT(RunJitNoEvents(mul_jit->get(), {F32(1.5f), F32(-2.25f)}),
+              IsOkAndHolds(F32(-3.375f)));
+  // Ties round to even.
+  EXPECT_THAT(RunJitNoEvents(add_jit->get(), {F32(1.0f), F32(0x1p-24f)}),
+              IsOkAndHolds(F32(1.0f)));
+  // Subnormal operands are treated as zero and subnormal results are flushed
+  // to zero, keeping their sign.
+  EXPECT_THAT(
+      RunJitNoEvents(add_jit->get(), {F32(kMinNormal / 2), F32(0.0f)}),
+      IsOkAndHolds(F32(0.0f)));
+  EXPECT_THAT(RunJitNoEvents(mul_jit->get(), {F32(-kMinNormal), F32(0.5f)}),
+              IsOkAndHolds(F32(-0.0f)));
+  // Overflows saturate to infinity, and NaNs are canonical quiet NaNs.
+  EXPECT_THAT(
+      RunJitNoEvents(mul_jit->get(),
+                     {F32(std::numeric_limits<float>::max()), F32(2.0f)}),
+      IsOkAndHolds(F32(kInfinity)));
+  EXPECT_THAT(RunJitNoEvents(add_jit->get(), {F32(kInfinity), F32(-kInfinity)}),
+              IsOkAndHolds(F32Bits(0x7fc00000)));
+}
+
+TEST(FunctionJitTest, NativeFloatLoweringVerification) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * add, BuildFloat32Invoke(package, "add", "__float32__add"));
+
+  // The stand-in doesn't actually add, so verification catches the mismatch.
+  SetJitNativeFloatOptions(
+      JitNativeFloatOptions{.enabled = true, .verification_samples = 16});
+  absl::StatusOr<std::unique_ptr<FunctionJit>> jit = FunctionJit::Create(add);
+  SetJitNativeFloatOptions(JitNativeFloatOptions());
+  EXPECT_THAT(jit.status(),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("differs from its IR implementation")));
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -729,6 +1263,36 @@ TEST(FunctionJitTest, ArrayConcatArrayOfBits) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+TEST(FunctionJitTest, ChainedArrayUpdates) {
+  Package package("my_package");
+
+  // array_update.5 and array_update.8 may not update the buffers of their
+  // arrays in place as the arrays are read elsewhere, array_update.9 may.
+  std::string ir_text = R"(
+  fn f(a: bits[32][4], i: bits[32], j: bits[32]) -> (bits[32][4], bits[32][4], bits[32][4]) {
+    array_update.4: bits[32][4] = array_update(a, i, indices=[i])
+    array_update.5: bits[32][4] = array_update(array_update.4, j, indices=[j])
+    array_index.6: bits[32] = array_index(array_update.5, indices=[i])
+    literal.7: bits[32] = literal(value=3)
+    array_update.8: bits[32][4] = array_update(array_update.5, array_index.6, indices=[literal.7])
+    array_update.9: bits[32][4] = array_update(array_update.8, literal.7, indices=[j])
+    ret tuple.10: (bits[32][4], bits[32][4], bits[32][4]) = tuple(a, array_update.5, array_update.9)
+  }
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a, Value::UBitsArray({10, 20, 30, 40}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value c, Value::UBitsArray({10, 1, 2, 40}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value g, Value::UBitsArray({10, 3, 2, 2}, 32));
+
+  std::vector args{a, Value(UBits(2, 32)), Value(UBits(1, 32))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value::Tuple({a, c, g})));
+}
+
 TEST(FunctionJitTest, ArrayConcatArrayOfBitsMixedOperands) {
   Package package("my_package");
 
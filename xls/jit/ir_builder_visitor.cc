@@ -23,7 +23,6 @@
 #include <string>
 #include <string_view>
 #include <utility>
-#include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -38,6 +37,8 @@
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/GlobalValue.h"
+#include "llvm/include/llvm/IR/GlobalVariable.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/Intrinsics.h"
@@ -47,6 +48,7 @@
 #include "llvm/include/llvm/IR/Value.h"
 #include "llvm/include/llvm/Support/Alignment.h"
 #include "llvm/include/llvm/Support/Casting.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -66,19 +68,52 @@
 #include "xls/ir/value_utils.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/native_float_lowering.h"
 
 namespace xls {
 
 bool ShouldMaterializeAtUse(Node* node) {
-  // Only materialize Bits typed literals at their use. Array and tuple typed
-  // literals are typically manipulated via pointer in the JITted code so these
-  // values would have to be put in an alloca'd buffer anyway so there is no
-  // advantage to doing this at their uses vs in HandleLiteral.
-  return node->Is<Literal>() && node->GetType()->IsBits();
+  // Only materialize Bits typed literals and lookup tables at their use. Array
+  // and tuple typed literals are typically manipulated via pointer in the
+  // JITted code so these values would have to be put in an alloca'd buffer
+  // anyway so there is no advantage to doing this at their uses vs in
+  // HandleLiteral.
+  return node->Is<Literal>() &&
+         (node->GetType()->IsBits() || IsLookupTable(node));
+}
+
+bool IsLookupTable(Node* node) {
+  return node->Is<Literal>() && node->GetType()->IsArray() &&
+         !node->users().empty() &&
+         absl::c_all_of(node->users(), [&](Node* user) {
+           return user->Is<ArrayIndex>() &&
+                  user->As<ArrayIndex>()->array() == node;
+         });
 }
 
 namespace {
 
+// Lookup tables indexed by a single index are padded to cover every value of
+// the index if the padded table is at most this many bytes.
+constexpr int64_t kMaxPaddedLookupTableBytes = int64_t{1} << 12;
+
+// Selects with at least this many cases are lowered to a switch, which LLVM
+// emits as a jump table or, if every case is a constant, as a lookup table in
+// read-only data. Narrower selects are lowered to a branchless chain of
+// selects.
+constexpr int64_t kMinSwitchSelectCases = 8;
+
+// Returns a constant global in read-only data holding `value`.
+llvm::GlobalVariable* CreateConstantTable(llvm::Module& module,
+                                          llvm::Constant* value,
+                                          std::string_view name) {
+  auto* table = new llvm::GlobalVariable(
+      module, value->getType(), /*isConstant=*/true,
+      llvm::GlobalValue::PrivateLinkage, value, name);
+  table->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  return table;
+}
+
 // Abstraction representing a value carried across iterations of the loop.
 struct LoopCarriedValue {
   std::string name;
@@ -267,6 +302,38 @@ LlvmIrLoop::LlvmIrLoop(int64_t loop_count, llvm::IRBuilder<>& builder,
   index_->addIncoming(init_index, entry_block);
 }
 
+// Values of at most this many bytes are ORed together as a single integer by
+// LlvmOrInto. Larger values are ORed byte by byte in a loop.
+constexpr int64_t kMaxUnrolledOrBytes = 16;
+
+// Emits code which ORs the `size` bytes at `src` into the bytes at `tgt`.
+// Returns the builder for the block following the emitted code.
+std::unique_ptr<llvm::IRBuilder<>> LlvmOrInto(llvm::Value* tgt,
+                                              llvm::Value* src, int64_t size,
+                                              llvm::IRBuilder<>& builder) {
+  if (size <= kMaxUnrolledOrBytes) {
+    if (size > 0) {
+      llvm::Type* int_type = builder.getIntNTy(size * 8);
+      llvm::Value* tgt_value =
+          builder.CreateAlignedLoad(int_type, tgt, llvm::MaybeAlign(1));
+      llvm::Value* src_value =
+          builder.CreateAlignedLoad(int_type, src, llvm::MaybeAlign(1));
+      builder.CreateAlignedStore(builder.CreateOr(tgt_value, src_value), tgt,
+                                 llvm::MaybeAlign(1));
+    }
+    return std::make_unique<llvm::IRBuilder<>>(builder.GetInsertBlock());
+  }
+  LlvmIrLoop loop(size, builder);
+  llvm::IRBuilder<>& body = loop.body_builder();
+  llvm::Value* tgt_byte = body.CreateGEP(body.getInt8Ty(), tgt, loop.index());
+  llvm::Value* src_byte = body.CreateGEP(body.getInt8Ty(), src, loop.index());
+  body.CreateStore(body.CreateOr(body.CreateLoad(body.getInt8Ty(), tgt_byte),
+                                 body.CreateLoad(body.getInt8Ty(), src_byte)),
+                   tgt_byte);
+  loop.Finalize();
+  return loop.ConsumeExitBuilder();
+}
+
 // Abstraction representing a if-then construct in LLVM.
 struct LlvmIfThen {
   // Builder for the "then" block.
@@ -325,6 +392,157 @@ std::vector<std::string> ConcatVectors(absl::Span<const std::string> a,
   return result;
 }
 
+template <int64_t kFunctionOffset>
+llvm::Value* InvokeCallback(llvm::IRBuilder<>* builder, llvm::Type* return_type,
+                            llvm::Value* instance_ptr,
+                            absl::Span<llvm::Value* const> args) {
+  std::vector<llvm::Value*> all_args{instance_ptr};
+  all_args.reserve(args.size() + 1);
+  absl::c_copy(args, std::back_inserter(all_args));
+  static_assert(InstanceContext::IsVtableOffset(kFunctionOffset));
+  llvm::ConstantInt* fn_offset = llvm::ConstantInt::get(
+      llvm::Type::getInt64Ty(builder->getContext()), kFunctionOffset);
+  std::vector<llvm::Type*> params_types;
+  params_types.reserve(all_args.size());
+  absl::c_transform(all_args, std::back_inserter(params_types),
+                    [](llvm::Value* v) { return v->getType(); });
+  llvm::Value* fn_ptr_ptr =
+      builder->CreateGEP(builder->getInt8Ty(), instance_ptr, fn_offset,
+                         "callback_ptr_ptr", /*IsInBounds=*/true);
+  llvm::FunctionType* fn_type =
+      llvm::FunctionType::get(return_type, params_types, /*isVarArg=*/false);
+  llvm::Value* fn_ptr =
+      builder->CreateLoad(llvm::PointerType::get(fn_type, 0), fn_ptr_ptr);
+  return builder->CreateCall(fn_type, fn_ptr, all_args);
+}
+
+// Integer arithmetic wider than this is lowered word by word, or by calling
+// into the runtime, rather than to LLVM's integer instructions. LLVM expands
+// wide multiplies and shifts into large instruction sequences which are slow
+// to compile and to run, and wide divisions into a loop over every bit.
+constexpr int64_t kMaxNativeArithmeticBitCount = 128;
+
+constexpr int64_t kLimbBits = 64;
+
+// Splits the integer `value` into 64-bit limbs, least significant first. The
+// top limb is sign-extended if `is_signed` and zero-extended otherwise.
+std::vector<llvm::Value*> SplitIntoLimbs(llvm::Value* value, bool is_signed,
+                                         llvm::IRBuilder<>* builder) {
+  int64_t limb_count =
+      CeilOfRatio(int64_t{value->getType()->getIntegerBitWidth()}, kLimbBits);
+  llvm::Type* padded_type = builder->getIntNTy(limb_count * kLimbBits);
+  llvm::Value* padded = is_signed ? builder->CreateSExt(value, padded_type)
+                                  : builder->CreateZExt(value, padded_type);
+  std::vector<llvm::Value*> limbs;
+  limbs.reserve(limb_count);
+  for (int64_t i = 0; i < limb_count; ++i) {
+    limbs.push_back(builder->CreateTrunc(
+        builder->CreateLShr(padded, i * kLimbBits), builder->getInt64Ty()));
+  }
+  return limbs;
+}
+
+// Returns the integer of type `type` made of the low bits of `limbs`.
+llvm::Value* JoinLimbs(absl::Span<llvm::Value* const> limbs, llvm::Type* type,
+                       llvm::IRBuilder<>* builder) {
+  llvm::Type* padded_type = builder->getIntNTy(limbs.size() * kLimbBits);
+  llvm::Value* result = llvm::ConstantInt::get(padded_type, 0);
+  for (int64_t i = 0; i < limbs.size(); ++i) {
+    result = builder->CreateOr(
+        result, builder->CreateShl(builder->CreateZExt(limbs[i], padded_type),
+                                   i * kLimbBits));
+  }
+  return builder->CreateTrunc(result, type);
+}
+
+// Returns the product of `lhs` and `rhs` truncated to their (common) type.
+// Products wider than kMaxNativeArithmeticBitCount are formed by schoolbook
+// multiplication of 64-bit limbs, skipping the partial products which only
+// contribute to the discarded high half. This beats Karatsuba at the widths
+// of XLS designs since the truncated product needs only about half of the
+// partial products to begin with.
+llvm::Value* EmitMul(llvm::Value* lhs, llvm::Value* rhs,
+                     llvm::IRBuilder<>* builder) {
+  llvm::Type* type = lhs->getType();
+  if (type->getIntegerBitWidth() <= kMaxNativeArithmeticBitCount) {
+    return builder->CreateMul(lhs, rhs);
+  }
+  std::vector<llvm::Value*> lhs_limbs =
+      SplitIntoLimbs(lhs, /*is_signed=*/false, builder);
+  std::vector<llvm::Value*> rhs_limbs =
+      SplitIntoLimbs(rhs, /*is_signed=*/false, builder);
+  int64_t limb_count = lhs_limbs.size();
+  llvm::Type* i64 = builder->getInt64Ty();
+  llvm::Type* i128 = builder->getInt128Ty();
+  std::vector<llvm::Value*> result(limb_count, llvm::ConstantInt::get(i64, 0));
+  for (int64_t i = 0; i < limb_count; ++i) {
+    llvm::Value* lhs_limb = builder->CreateZExt(lhs_limbs[i], i128);
+    llvm::Value* carry = llvm::ConstantInt::get(i64, 0);
+    for (int64_t j = 0; i + j < limb_count; ++j) {
+      // The product of two limbs plus two more limbs fits in 128 bits.
+      llvm::Value* sum = builder->CreateAdd(
+          builder->CreateAdd(
+              builder->CreateMul(lhs_limb,
+                                 builder->CreateZExt(rhs_limbs[j], i128)),
+              builder->CreateZExt(result[i + j], i128)),
+          builder->CreateZExt(carry, i128));
+      result[i + j] = builder->CreateTrunc(sum, i64);
+      carry = builder->CreateTrunc(builder->CreateLShr(sum, kLimbBits), i64);
+    }
+  }
+  return JoinLimbs(result, type, builder);
+}
+
+// Returns `value` shifted by `amount`, which has the same type and is less
+// than its width, word by word. The limbs of `value` are stored between limbs
+// of fill bits, and each limb of the result is a funnel shift of the two
+// limbs at the word offset of `amount`.
+llvm::Value* EmitWideShift(Op op, llvm::Value* value, llvm::Value* amount,
+                           llvm::IRBuilder<>* builder) {
+  llvm::Type* i64 = builder->getInt64Ty();
+  std::vector<llvm::Value*> limbs =
+      SplitIntoLimbs(value, /*is_signed=*/op == Op::kShra, builder);
+  int64_t limb_count = limbs.size();
+  llvm::Value* zero = llvm::ConstantInt::get(i64, 0);
+  llvm::Value* fill = op == Op::kShra
+                          ? builder->CreateAShr(limbs.back(), kLimbBits - 1)
+                          : zero;
+  llvm::Value* buffer =
+      builder->CreateAlloca(llvm::ArrayType::get(i64, 3 * limb_count));
+  auto limb_ptr = [&](llvm::Value* index) {
+    return builder->CreateGEP(i64, buffer, index);
+  };
+  for (int64_t i = 0; i < limb_count; ++i) {
+    builder->CreateStore(zero, limb_ptr(builder->getInt64(i)));
+    builder->CreateStore(limbs[i],
+                         limb_ptr(builder->getInt64(limb_count + i)));
+    builder->CreateStore(fill,
+                         limb_ptr(builder->getInt64(2 * limb_count + i)));
+  }
+
+  llvm::Value* amount64 = builder->CreateTrunc(amount, i64);
+  llvm::Value* word = builder->CreateLShr(amount64, 6);
+  llvm::Value* bit = builder->CreateAnd(amount64, kLimbBits - 1);
+  std::vector<llvm::Value*> result;
+  result.reserve(limb_count);
+  for (int64_t i = 0; i < limb_count; ++i) {
+    llvm::Value* hi;
+    llvm::Value* lo;
+    if (op == Op::kShll) {
+      hi = builder->CreateSub(builder->getInt64(limb_count + i), word);
+      lo = builder->CreateSub(hi, builder->getInt64(1));
+    } else {
+      lo = builder->CreateAdd(builder->getInt64(limb_count + i), word);
+      hi = builder->CreateAdd(lo, builder->getInt64(1));
+    }
+    result.push_back(builder->CreateIntrinsic(
+        op == Op::kShll ? llvm::Intrinsic::fshl : llvm::Intrinsic::fshr, {i64},
+        {builder->CreateLoad(i64, limb_ptr(hi)),
+         builder->CreateLoad(i64, limb_ptr(lo)), bit}));
+  }
+  return JoinLimbs(result, value->getType(), builder);
+}
+
 // Emit an LLVM shift operation corresponding to the semantics of the given XLS
 // op.
 llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
@@ -358,9 +576,7 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
   // (selected in the Select instruction) so correctness is not affected.
   llvm::Value* safe_rhs = builder->CreateSelect(is_overshift, zero, wide_rhs);
 
-  if (op == Op::kShll) {
-    inst = builder->CreateShl(wide_lhs, safe_rhs);
-  } else if (op == Op::kShra) {
+  if (op == Op::kShra) {
     llvm::Value* high_bit = builder->CreateLShr(
         wide_lhs,
         llvm::ConstantInt::get(dest_type,
@@ -369,6 +585,12 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
         builder->CreateICmpEQ(high_bit, llvm::ConstantInt::get(dest_type, 1));
     overshift_value = builder->CreateSelect(
         high_bit_set, llvm::ConstantInt::getSigned(dest_type, -1), zero);
+  }
+  if (common_width > kMaxNativeArithmeticBitCount) {
+    inst = EmitWideShift(op, wide_lhs, safe_rhs, builder);
+  } else if (op == Op::kShll) {
+    inst = builder->CreateShl(wide_lhs, safe_rhs);
+  } else if (op == Op::kShra) {
     inst = builder->CreateAShr(wide_lhs, safe_rhs);
   } else {
     CHECK_EQ(op, Op::kShrl);
@@ -384,8 +606,72 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
              : builder->CreateTrunc(result, lhs->getType());
 }
 
+// Returns the quotient, or if `remainder` is true the remainder, of the
+// unsigned division of `num` by `denom`, which must be nonzero. Divisions
+// wider than kMaxNativeArithmeticBitCount call WideUDivRem through the
+// instance context.
+llvm::Value* EmitUDivRem(llvm::Value* num, llvm::Value* denom, bool remainder,
+                         llvm::Value* instance_context,
+                         llvm::IRBuilder<>* builder) {
+  llvm::Type* type = num->getType();
+  if (type->getIntegerBitWidth() <= kMaxNativeArithmeticBitCount) {
+    return remainder ? builder->CreateURem(num, denom)
+                     : builder->CreateUDiv(num, denom);
+  }
+  int64_t limb_count =
+      CeilOfRatio(int64_t{type->getIntegerBitWidth()}, kLimbBits);
+  llvm::Type* padded_type = builder->getIntNTy(limb_count * kLimbBits);
+  llvm::Type* buffer_type =
+      llvm::ArrayType::get(builder->getInt64Ty(), limb_count);
+  llvm::Value* num_buffer = builder->CreateAlloca(buffer_type);
+  llvm::Value* denom_buffer = builder->CreateAlloca(buffer_type);
+  llvm::Value* quotient_buffer = builder->CreateAlloca(buffer_type);
+  llvm::Value* remainder_buffer = builder->CreateAlloca(buffer_type);
+  // The buffers are only aligned as arrays of limbs.
+  builder->CreateAlignedStore(builder->CreateZExt(num, padded_type),
+                              num_buffer, llvm::Align(8));
+  builder->CreateAlignedStore(builder->CreateZExt(denom, padded_type),
+                              denom_buffer, llvm::Align(8));
+  InvokeCallback<InstanceContext::kWideUDivRemOffset>(
+      builder, builder->getVoidTy(), instance_context,
+      {num_buffer, denom_buffer, builder->getInt64(limb_count),
+       quotient_buffer, remainder_buffer});
+  return builder->CreateTrunc(
+      builder->CreateAlignedLoad(
+          padded_type, remainder ? remainder_buffer : quotient_buffer,
+          llvm::Align(8)),
+      type);
+}
+
+// Signed variant of EmitUDivRem. The quotient rounds toward zero and the
+// remainder has the sign of `num`. `num` divided by -1 must not overflow.
+llvm::Value* EmitSDivRem(llvm::Value* num, llvm::Value* denom, bool remainder,
+                         llvm::Value* instance_context,
+                         llvm::IRBuilder<>* builder) {
+  if (num->getType()->getIntegerBitWidth() <= kMaxNativeArithmeticBitCount) {
+    return remainder ? builder->CreateSRem(num, denom)
+                     : builder->CreateSDiv(num, denom);
+  }
+  // Divide the magnitudes; the magnitude of the minimum value is still
+  // correct as an unsigned value.
+  llvm::Value* zero = llvm::ConstantInt::get(num->getType(), 0);
+  llvm::Value* num_negative = builder->CreateICmpSLT(num, zero);
+  llvm::Value* denom_negative = builder->CreateICmpSLT(denom, zero);
+  llvm::Value* magnitude = EmitUDivRem(
+      builder->CreateSelect(num_negative, builder->CreateSub(zero, num), num),
+      builder->CreateSelect(denom_negative, builder->CreateSub(zero, denom),
+                            denom),
+      remainder, instance_context, builder);
+  llvm::Value* negative =
+      remainder ? num_negative
+                : builder->CreateXor(num_negative, denom_negative);
+  return builder->CreateSelect(negative, builder->CreateSub(zero, magnitude),
+                               magnitude);
+}
+
 llvm::Value* EmitDiv(llvm::Value* num, llvm::Value* denom, int64_t bit_count,
                      bool is_signed, LlvmTypeConverter* type_converter,
+                     llvm::Value* instance_context,
                      llvm::IRBuilder<>* builder) {
   // XLS div semantics differ from LLVM's (and most software's) here: in XLS,
   // division by zero returns the greatest value of that type, so 255 for an
@@ -406,7 +692,8 @@ llvm::Value* EmitDiv(llvm::Value* num, llvm::Value* denom, int64_t bit_count,
         type_converter
             ->ToLlvmConstant(denom->getType(), Value(Bits::AllOnes(bit_count)))
             .value(),
-        builder->CreateUDiv(num, safe_denom));
+        EmitUDivRem(num, safe_denom, /*remainder=*/false, instance_context,
+                    builder));
   }
 
   // Division by 0 gives the value furthest from zero with matching sign.
@@ -436,7 +723,8 @@ llvm::Value* EmitDiv(llvm::Value* num, llvm::Value* denom, int64_t bit_count,
   safe_denom = builder->CreateSelect(
       denom_eq_neg_one, llvm::ConstantInt::get(denom->getType(), 1),
       safe_denom);
-  llvm::Value* normal_result = builder->CreateSDiv(num, safe_denom);
+  llvm::Value* normal_result = EmitSDivRem(
+      num, safe_denom, /*remainder=*/false, instance_context, builder);
 
   return builder->CreateSelect(
       denom_eq_zero, rhs_is_zero_result,
@@ -445,6 +733,7 @@ llvm::Value* EmitDiv(llvm::Value* num, llvm::Value* denom, int64_t bit_count,
 }
 
 llvm::Value* EmitMod(llvm::Value* lhs, llvm::Value* rhs, bool is_signed,
+                     llvm::Value* instance_context,
                      llvm::IRBuilder<>* builder) {
   // XLS mod semantics differ from LLVMs with regard to mod by zero. In XLS,
   // modulo by zero returns zero rather than undefined behavior.
@@ -454,9 +743,12 @@ llvm::Value* EmitMod(llvm::Value* lhs, llvm::Value* rhs, bool is_signed,
   // used.
   rhs = builder->CreateSelect(rhs_eq_zero,
                               llvm::ConstantInt::get(rhs->getType(), 1), rhs);
-  return builder->CreateSelect(rhs_eq_zero, zero,
-                               is_signed ? builder->CreateSRem(lhs, rhs)
-                                         : builder->CreateURem(lhs, rhs));
+  return builder->CreateSelect(
+      rhs_eq_zero, zero,
+      is_signed ? EmitSDivRem(lhs, rhs, /*remainder=*/true, instance_context,
+                              builder)
+                : EmitUDivRem(lhs, rhs, /*remainder=*/true, instance_context,
+                              builder));
 }
 
 // Local struct to hold the individual elements of a (possibly) compound
@@ -560,93 +852,24 @@ llvm::Value* ClampIndexInBounds(llvm::Value* index, ArrayType* array_type,
   return inbounds_index;
 }
 
-template <int64_t kFunctionOffset>
-llvm::Value* InvokeCallback(llvm::IRBuilder<>* builder, llvm::Type* return_type,
-                            llvm::Value* instance_ptr,
-                            absl::Span<llvm::Value* const> args) {
-  std::vector<llvm::Value*> all_args{instance_ptr};
-  all_args.reserve(args.size() + 1);
-  absl::c_copy(args, std::back_inserter(all_args));
-  static_assert(InstanceContext::IsVtableOffset(kFunctionOffset));
-  llvm::ConstantInt* fn_offset = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(builder->getContext()), kFunctionOffset);
-  std::vector<llvm::Type*> params_types;
-  params_types.reserve(all_args.size());
-  absl::c_transform(all_args, std::back_inserter(params_types),
-                    [](llvm::Value* v) { return v->getType(); });
-  llvm::Value* fn_ptr_ptr =
-      builder->CreateGEP(builder->getInt8Ty(), instance_ptr, fn_offset,
-                         "callback_ptr_ptr", /*IsInBounds=*/true);
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(return_type, params_types, /*isVarArg=*/false);
-  llvm::Value* fn_ptr =
-      builder->CreateLoad(llvm::PointerType::get(fn_type, 0), fn_ptr_ptr);
-  return builder->CreateCall(fn_type, fn_ptr, all_args);
-}
-
-// Build the LLVM IR that handles string fragment format steps.
-absl::Status InvokeStringStepCallback(llvm::IRBuilder<>* builder,
-                                      const std::string& step_string,
-                                      llvm::Value* buffer_ptr,
-                                      llvm::Value* instance_ctx) {
-  llvm::Constant* step_constant = builder->CreateGlobalStringPtr(step_string);
-  InvokeCallback<InstanceContext::kPerformStringStepOffset>(
-      builder, llvm::Type::getVoidTy(builder->getContext()), instance_ctx,
-      {step_constant, buffer_ptr});
-  return absl::OkStatus();
-}
-
-// Build the LLVM IR that handles formatting a runtime value according to a
-// format preference.
-absl::Status InvokeFormatStepCallback(
-    llvm::IRBuilder<>* builder, FormatPreference format,
-    xls::Type* operand_type, llvm::Value* operand, llvm::Value* buffer_ptr,
-    llvm::Value* jit_runtime_ptr, llvm::Value* instance_ctx) {
-  // Note: we assume the package lifetime is >= that of the JIT code by
-  // capturing this type pointer as a value burned into the JIT code, which
-  // should always be true.
+// Build the LLVM IR to invoke the callback that records an unformatted trace.
+// `format` is the encoding of the trace format from EncodeTraceFormat.
+absl::Status InvokeRecordRawTraceCallback(llvm::IRBuilder<>* builder,
+                                          std::string_view format,
+                                          llvm::Value* operands,
+                                          int64_t operands_size,
+                                          int64_t verbosity,
+                                          llvm::Value* interpreter_events_ptr,
+                                          llvm::Value* instance_ctx) {
   llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
-
-  llvm::ConstantInt* llvm_format =
-      llvm::ConstantInt::get(i64_type, static_cast<uint64_t>(format));
-  auto proto_str = operand_type->ToProto().SerializeAsString();
-  llvm::ConstantInt* proto_len =
-      llvm::ConstantInt::get(i64_type, proto_str.size());
-  llvm::Constant* proto_llvm_str = builder->CreateGlobalStringPtr(proto_str);
-  InvokeCallback<InstanceContext::kPerformFormatStepOffset>(
+  llvm::Constant* format_constant = builder->CreateGlobalStringPtr(format);
+  InvokeCallback<InstanceContext::kRecordRawTraceOffset>(
       builder, void_type, instance_ctx,
-      {jit_runtime_ptr, proto_llvm_str, proto_len, operand, llvm_format,
-       buffer_ptr});
+      {format_constant, operands, builder->getInt64(operands_size),
+       builder->getInt64(verbosity), interpreter_events_ptr});
   return absl::OkStatus();
 }
 
-// Build the LLVM IR to invoke the callback that records traces.
-absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
-                                       int64_t verbosity,
-                                       llvm::Value* buffer_ptr,
-                                       llvm::Value* interpreter_events_ptr,
-                                       llvm::Value* instance_ctx) {
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-
-  llvm::Value* verbosity_value = builder->getInt64(verbosity);
-  std::vector<llvm::Value*> args = {buffer_ptr, verbosity_value,
-                                    interpreter_events_ptr};
-
-  InvokeCallback<InstanceContext::kRecordTraceOffset>(
-      builder, void_type, instance_ctx,
-      {buffer_ptr, verbosity_value, interpreter_events_ptr});
-  return absl::OkStatus();
-}
-
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
-absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder, llvm::Value* instance_ctx) {
-  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-  return InvokeCallback<InstanceContext::kCreateTraceBufferOffset>(
-      builder, ptr_type, instance_ctx, {});
-}
-
 // Build the LLVM IR to invoke the callback that records assertions.
 absl::Status InvokeAssertCallback(llvm::IRBuilder<>* builder,
                                   const std::string& message,
@@ -971,6 +1194,22 @@ llvm::Value* NodeIrContext::GetOperandPtr(int64_t i,
   llvm::IRBuilder<>& b = builder == nullptr ? entry_builder() : *builder;
 
   std::pair<Node*, llvm::BasicBlock*> cache_key = {operand, b.GetInsertBlock()};
+  if (IsLookupTable(operand)) {
+    // Lookup tables are read directly from read-only data so one table serves
+    // every block.
+    cache_key.second = nullptr;
+    if (materialized_cache_.contains(cache_key)) {
+      return materialized_cache_.at(cache_key);
+    }
+    llvm::Value* table = CreateConstantTable(
+        *llvm_function_->getParent(),
+        type_converter()
+            .ToLlvmConstant(operand->GetType(), operand->As<Literal>()->value())
+            .value(),
+        absl::StrCat(operand->GetName(), "_table"));
+    materialized_cache_[cache_key] = table;
+    return table;
+  }
   if (ShouldMaterializeAtUse(operand)) {
     if (materialized_cache_.contains(cache_key)) {
       return materialized_cache_.at(cache_key);
@@ -1014,10 +1253,22 @@ void NodeIrContext::FinalizeWithPointerToValue(
   llvm::IRBuilder<>* final_exit_block;
   std::optional<llvm::IRBuilder<>> build;
   if (jit_context_.llvm_compiler().include_observer_callbacks()) {
-    // Add in a call to any observers of the values.
+    // Add in a call to any observers of the values. If the observer
+    // accumulates the values of this node they are ORed into its storage
+    // directly instead.
     llvm::Value* node_ptr_val = llvm::ConstantInt::get(
         llvm::Type::getInt64Ty(jit_context_.context()),
         static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node())));
+    int64_t slot = jit_context_.GetOrAllocateObservedNodeSlot(node());
+    // Accumulators hold a value of the node's own type (see
+    // InstanceContext::SetObserver).
+    int64_t result_size = type_converter().GetTypeByteSize(node()->GetType());
+    llvm::BasicBlock* check_accumulators_blk = llvm::BasicBlock::Create(
+        jit_context_.context(), "check_accumulators", llvm_function_);
+    llvm::BasicBlock* check_accumulator_blk = llvm::BasicBlock::Create(
+        jit_context_.context(), "check_accumulator", llvm_function_);
+    llvm::BasicBlock* accumulate_result_blk = llvm::BasicBlock::Create(
+        jit_context_.context(), "accumulate_result", llvm_function_);
     llvm::BasicBlock* record_result_blk = llvm::BasicBlock::Create(
         jit_context_.context(), "record_result_callback", llvm_function_);
     llvm::BasicBlock* cpy_result_out_blk = llvm::BasicBlock::Create(
@@ -1029,10 +1280,36 @@ void NodeIrContext::FinalizeWithPointerToValue(
         {node_ptr_val, result_buffer});
     record_result.CreateBr(cpy_result_out_blk);
 
+    llvm::Type* ptr_type = llvm::PointerType::get(jit_context_.context(), 0);
+    llvm::IRBuilder<> check_accumulators(check_accumulators_blk);
+    llvm::Value* accumulators = check_accumulators.CreateLoad(
+        ptr_type,
+        check_accumulators.CreateGEP(
+            check_accumulators.getInt8Ty(), GetInstanceContextArg(),
+            check_accumulators.getInt64(
+                InstanceContext::kNodeValueAccumulatorsOffset)),
+        "accumulators");
+    check_accumulators.CreateCondBr(
+        check_accumulators.CreateIsNull(accumulators), record_result_blk,
+        check_accumulator_blk);
+
+    llvm::IRBuilder<> check_accumulator(check_accumulator_blk);
+    llvm::Value* accumulator = check_accumulator.CreateLoad(
+        ptr_type,
+        check_accumulator.CreateGEP(ptr_type, accumulators,
+                                    check_accumulator.getInt64(slot)),
+        "accumulator");
+    check_accumulator.CreateCondBr(check_accumulator.CreateIsNull(accumulator),
+                                   record_result_blk, accumulate_result_blk);
+
+    llvm::IRBuilder<> accumulate_result(accumulate_result_blk);
+    LlvmOrInto(accumulator, result_buffer, result_size, accumulate_result)
+        ->CreateBr(cpy_result_out_blk);
+
     llvm::Value* has_instance_callbacks = b->CreateICmpNE(
         b->CreatePtrToInt(GetInstanceContextArg(), b->getInt64Ty()),
         b->getInt64(0));
-    b->CreateCondBr(has_instance_callbacks, record_result_blk,
+    b->CreateCondBr(has_instance_callbacks, check_accumulators_blk,
                     cpy_result_out_blk);
     build.emplace(cpy_result_out_blk);
     final_exit_block = &*build;
@@ -1093,6 +1370,10 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
   absl::Status HandleGate(Gate* gate) override;
   absl::Status HandleIdentity(UnOp* identity) override;
   absl::Status HandleInvoke(Invoke* invoke) override;
+  // Lowers an invocation of a floating-point function natively; see
+  // native_float_lowering.h.
+  absl::Status HandleNativeFloatInvoke(
+      Invoke* invoke, const NativeFloatFunction& native_function);
   absl::Status HandleLiteral(Literal* literal) override;
   absl::Status HandleMap(Map* map) override;
   absl::Status HandleNaryAnd(NaryOp* and_op) override;
@@ -1158,6 +1439,14 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       std::function<llvm::Value*(llvm::Value*, llvm::Value*,
                                  llvm::IRBuilder<>&)>,
       bool is_signed = false);
+  // HandleBinaryOp variant whose `build_result` is also passed the instance
+  // context, for results computed by calling back into the runtime.
+  absl::Status HandleBinaryOpWithInstanceContext(
+      Node* node,
+      std::function<llvm::Value*(llvm::Value*, llvm::Value*, llvm::Value*,
+                                 llvm::IRBuilder<>&)>
+          build_result,
+      bool is_signed = false);
   absl::Status HandleNaryOp(
       Node* node, std::function<llvm::Value*(absl::Span<llvm::Value* const>,
                                              llvm::IRBuilder<>&)>);
@@ -1195,6 +1484,16 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       std::optional<llvm::Value*> return_value = std::nullopt,
       std::optional<Type*> result_type = std::nullopt);
 
+  // Finalizes the node context of a select-like node by branching on `index`
+  // with a switch. Index value `i` selects operand `first_case_operand + i` for
+  // `i` less than `case_count`, and every other value selects operand
+  // `default_operand`, which must be given unless those values are
+  // unreachable.
+  absl::Status SelectWithSwitch(NodeIrContext&& node_context,
+                                llvm::Value* index, int64_t first_case_operand,
+                                int64_t case_count,
+                                std::optional<int64_t> default_operand);
+
   llvm::Value* MaybeAsSigned(llvm::Value* v, Type* xls_type,
                              llvm::IRBuilder<>& builder, bool is_signed) {
     if (is_signed) {
@@ -1494,9 +1793,19 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
           /*include_wrapper_args=*/true));
 
   llvm::IRBuilder<>& b = node_context.entry_builder();
-  llvm::Value* condition = node_context.LoadOperand(1);
   llvm::Value* events_ptr = node_context.GetInterpreterEventsArg();
-  llvm::Value* jit_runtime_ptr = node_context.GetJitRuntimeArg();
+  llvm::Value* instance_ctx = node_context.GetInstanceContextArg();
+
+  // Traces above the maximum verbosity are filtered out before any of the
+  // trace is evaluated.
+  llvm::Value* max_verbosity_ptr = b.CreateGEP(
+      b.getInt8Ty(), instance_ctx,
+      b.getInt64(InstanceContext::kMaxTraceVerbosityOffset),
+      "max_trace_verbosity_ptr", /*IsInBounds=*/true);
+  llvm::Value* max_verbosity = b.CreateLoad(b.getInt64Ty(), max_verbosity_ptr);
+  llvm::Value* condition = b.CreateAnd(
+      node_context.LoadOperand(1),
+      b.CreateICmpSLE(b.getInt64(trace_op->verbosity()), max_verbosity));
 
   std::string trace_name = trace_op->GetName();
 
@@ -1514,41 +1823,38 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(
-      llvm::Value * buffer_ptr,
-      InvokeCreateBufferCallback(&print_builder,
-                                 node_context.GetInstanceContextArg()));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
-  size_t operand_index = 2;
-  for (const FormatStep& step : trace_op->format()) {
-    if (std::holds_alternative<std::string>(step)) {
-      XLS_RETURN_IF_ERROR(InvokeStringStepCallback(
-          &print_builder, std::get<std::string>(step), buffer_ptr,
-          node_context.GetInstanceContextArg()));
-    } else {
-      xls::Node* o = trace_op->operand(operand_index);
-      llvm::Value* operand = node_context.LoadOperand(operand_index);
-      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
-      print_builder.CreateStore(operand, alloca);
-      // The way our format strings are currently formed we implicitly refer to
-      // the next operand after formatting this one.
-      operand_index += 1;
-      XLS_RETURN_IF_ERROR(InvokeFormatStepCallback(
-          &print_builder, std::get<FormatPreference>(step), o->GetType(),
-          alloca, buffer_ptr, jit_runtime_ptr,
-          node_context.GetInstanceContextArg()));
-    }
-  }
-
-  XLS_RETURN_IF_ERROR(InvokeRecordTraceCallback(
-      &print_builder, trace_op->verbosity(), buffer_ptr, events_ptr,
-      node_context.GetInstanceContextArg()));
+  // The trace only copies the raw bytes of its operands, packed one after the
+  // other; the message is formatted after the jitted code returns.
+  std::vector<Type*> operand_types;
+  std::vector<int64_t> operand_offsets;
+  int64_t operands_size = 0;
+  for (Node* arg : trace_op->args()) {
+    operand_types.push_back(arg->GetType());
+    operand_offsets.push_back(operands_size);
+    operands_size += type_converter()->GetTypeByteSize(arg->GetType());
+  }
+  llvm::Value* operands = print_builder.CreateAlloca(
+      llvm::ArrayType::get(print_builder.getInt8Ty(),
+                           std::max(operands_size, int64_t{1})),
+      /*ArraySize=*/nullptr, "trace_operands");
+  for (int64_t i = 0; i < operand_types.size(); ++i) {
+    llvm::Value* operand_ptr = print_builder.CreateGEP(
+        print_builder.getInt8Ty(), operands,
+        print_builder.getInt64(operand_offsets[i]));
+    print_builder.CreateAlignedStore(node_context.LoadOperand(i + 2),
+                                     operand_ptr, llvm::MaybeAlign(1));
+  }
+  XLS_RETURN_IF_ERROR(InvokeRecordRawTraceCallback(
+      &print_builder,
+      EncodeTraceFormat(trace_op->format(), operand_types, operand_offsets),
+      operands, operands_size, trace_op->verbosity(), events_ptr,
+      instance_ctx));
 
   print_builder.CreateBr(after_block);
 
@@ -1574,6 +1880,50 @@ absl::Status IrBuilderVisitor::HandleArrayIndex(ArrayIndex* index) {
   };
 
   Type* array_type = index->array()->GetType();
+  if (IsLookupTable(index->array()) && index->indices().size() == 1) {
+    // Read the table with the index directly if every value of the index is in
+    // bounds, padding the table with copies of its last element to make it so
+    // if that is cheap enough.
+    ArrayType* table_type = array_type->AsArrayOrDie();
+    Type* element_type = table_type->element_type();
+    int64_t index_width = index->indices().front()->BitCountOrDie();
+    llvm::Value* table = node_context.GetOperandPtr(0);
+    llvm::Type* llvm_table_type =
+        type_converter()->ConvertToLlvmType(table_type);
+    bool in_bounds =
+        index_width < 63 && (int64_t{1} << index_width) <= table_type->size();
+    if (!in_bounds && index_width < 31 &&
+        (int64_t{1} << index_width) *
+                type_converter()->GetTypeByteSize(element_type) <=
+            kMaxPaddedLookupTableBytes) {
+      const Value& table_value = index->array()->As<Literal>()->value();
+      std::vector<llvm::Constant*> entries;
+      for (int64_t i = 0; i < (int64_t{1} << index_width); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            llvm::Constant * entry,
+            type_converter()->ToLlvmConstant(
+                element_type,
+                table_value.element(std::min(i, table_type->size() - 1))));
+        entries.push_back(entry);
+      }
+      llvm_table_type = llvm::ArrayType::get(
+          type_converter()->ConvertToLlvmType(element_type), entries.size());
+      table = CreateConstantTable(
+          *module(),
+          llvm::ConstantArray::get(
+              llvm::cast<llvm::ArrayType>(llvm_table_type), entries),
+          absl::StrCat(index->array()->GetName(), "_padded_table"));
+      in_bounds = true;
+    }
+    if (in_bounds) {
+      gep_indices.push_back(b.CreateZExt(node_context.LoadOperand(1),
+                                         llvm::Type::getInt64Ty(ctx())));
+      llvm::Value* entry = b.CreateInBoundsGEP(llvm_table_type, table,
+                                               gep_indices);
+      return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
+                                                     entry);
+    }
+  }
   for (int64_t i = 1; i < index->operand_count(); ++i) {
     llvm::Value* index_value = node_context.LoadOperand(i);
     gep_indices.push_back(
@@ -1664,9 +2014,11 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // The buffers are the same if the update is done in place.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  LlvmMemcpyIfDistinct(output_buffer, node_context.GetOperandPtr(0),
+                       type_converter()->GetTypeByteSize(update->GetType()),
+                       b);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -2263,6 +2615,14 @@ absl::Status IrBuilderVisitor::HandleIdentity(UnOp* identity) {
 }
 
 absl::Status IrBuilderVisitor::HandleInvoke(Invoke* invoke) {
+  if (jit_context_.llvm_compiler().native_float_options().enabled) {
+    if (std::optional<NativeFloatFunction> native_function =
+            MatchNativeFloatFunction(invoke->to_apply());
+        native_function.has_value()) {
+      return HandleNativeFloatInvoke(invoke, *native_function);
+    }
+  }
+
   XLS_ASSIGN_OR_RETURN(
       NodeIrContext node_context,
       NewNodeIrContext(invoke, NumberedStrings("arg", invoke->operand_count()),
@@ -2288,6 +2648,27 @@ absl::Status IrBuilderVisitor::HandleInvoke(Invoke* invoke) {
                                                  output_buffer);
 }
 
+absl::Status IrBuilderVisitor::HandleNativeFloatInvoke(
+    Invoke* invoke, const NativeFloatFunction& native_function) {
+  XLS_ASSIGN_OR_RETURN(
+      NodeIrContext node_context,
+      NewNodeIrContext(invoke,
+                       NumberedStrings("arg", invoke->operand_count())));
+  llvm::IRBuilder<>& b = node_context.entry_builder();
+
+  std::vector<llvm::Value*> args;
+  args.reserve(invoke->operand_count());
+  for (int64_t i = 0; i < invoke->operand_count(); ++i) {
+    args.push_back(node_context.LoadOperand(i));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * result,
+      EmitNativeFloatFunction(
+          native_function, args,
+          type_converter()->ConvertToLlvmType(invoke->GetType()), b));
+  return FinalizeNodeIrContextWithValue(std::move(node_context), result);
+}
+
 absl::Status IrBuilderVisitor::HandleLiteral(Literal* literal) {
   // TODO(meheff): 2022/09/09 Avoid generating separate functions for
   // literals. Simply materialize the literals as constants at their uses.
@@ -2345,7 +2726,7 @@ absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return b.CreateMul(lhs, rhs);
+        return EmitMul(lhs, rhs, &b);
       },
       /*is_signed=*/true);
 }
@@ -2354,7 +2735,7 @@ absl::Status IrBuilderVisitor::HandleUMul(ArithOp* mul) {
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return b.CreateMul(lhs, rhs);
+        return EmitMul(lhs, rhs, &b);
       },
       /*is_signed=*/false);
 }
@@ -2397,10 +2778,11 @@ absl::StatusOr<llvm::Value*> HandleMulp(PartialProductOp* mul,
   // The outer int cast is unconditionally unsigned because smulp (like umulp)
   // returns a tuple of unsigned ints.
   llvm::Value* product =
-      b.CreateIntCast(b.CreateMul(b.CreateIntCast(lhs, llvm_result_element_type,
-                                                  /*isSigned=*/is_signed),
-                                  b.CreateIntCast(rhs, llvm_result_element_type,
-                                                  /*isSigned=*/is_signed)),
+      b.CreateIntCast(EmitMul(b.CreateIntCast(lhs, llvm_result_element_type,
+                                              /*isSigned=*/is_signed),
+                              b.CreateIntCast(rhs, llvm_result_element_type,
+                                              /*isSigned=*/is_signed),
+                              &b),
                       llvm_result_element_type, /*isSigned=*/false);
   llvm::Value* product_minus_offset = b.CreateSub(product, offset);
 
@@ -2540,9 +2922,12 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
 
   llvm::Value* value_ptr = node_context.GetOperandPtr(Next::kValueOperand);
 
+  // The value may already be in the output buffer if it was computed in place
+  // there.
   if (!next->predicate().has_value()) {
-    LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
-               type_converter()->GetTypeByteSize(next->value()->GetType()), b);
+    LlvmMemcpyIfDistinct(
+        node_context.GetOutputPtr(0), value_ptr,
+        type_converter()->GetTypeByteSize(next->value()->GetType()), b);
 
     // Record that this Next node was activated.
     XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
@@ -2556,9 +2941,10 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
   llvm::Value* predicate = node_context.LoadOperand(2);
   LlvmIfThen if_then = CreateIfThen(predicate, b, next->GetName());
 
-  LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
-             type_converter()->GetTypeByteSize(next->value()->GetType()),
-             *if_then.then_builder);
+  LlvmMemcpyIfDistinct(
+      node_context.GetOutputPtr(0), value_ptr,
+      type_converter()->GetTypeByteSize(next->value()->GetType()),
+      *if_then.then_builder);
 
   // Record that this Next node was activated.
   XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
@@ -2701,6 +3087,23 @@ absl::Status IrBuilderVisitor::HandleOneHotSel(OneHotSelect* sel) {
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   llvm::Value* selector = node_context.LoadOperand(0);
 
+  if (sel->GetType()->IsBits()) {
+    // Bits-typed cases are combined without branches by ORing together the
+    // cases masked by their selector bits.
+    llvm::IRBuilder<>& b = node_context.entry_builder();
+    llvm::Value* zero = LlvmTypeConverter::ZeroOfType(
+        type_converter()->ConvertToLlvmType(sel->GetType()));
+    llvm::Value* result = zero;
+    for (int64_t i = 0; i < sel->cases().size(); ++i) {
+      llvm::Value* select_bit = b.CreateTrunc(b.CreateLShr(selector, i),
+                                              llvm::Type::getInt1Ty(ctx()));
+      result = b.CreateOr(
+          result, b.CreateSelect(select_bit, node_context.LoadOperand(i + 1),
+                                 zero));
+    }
+    return FinalizeNodeIrContextWithValue(std::move(node_context), result);
+  }
+
   // To make management of the builders easier, create a new block with a
   // std::unique_ptr builder. This builder variable will be updated as the IR
   // is built.
@@ -2759,6 +3162,14 @@ absl::Status IrBuilderVisitor::HandlePrioritySel(PrioritySelect* sel) {
       module(), llvm::Intrinsic::cttz, {selector->getType()});
   llvm::Value* selected_index = b.CreateCall(cttz, {selector, llvm_false});
 
+  if (sel->cases().size() >= kMinSwitchSelectCases) {
+    // The index is the width of the selector if no bit is set, which takes the
+    // default of the switch.
+    return SelectWithSwitch(std::move(node_context), selected_index,
+                            /*first_case_operand=*/1, sel->cases().size(),
+                            sel->operand_count() - 1);
+  }
+
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
   llvm::Value* llvm_sel = default_value;
@@ -2775,6 +3186,59 @@ absl::Status IrBuilderVisitor::HandlePrioritySel(PrioritySelect* sel) {
                                                  llvm_sel);
 }
 
+absl::Status IrBuilderVisitor::SelectWithSwitch(
+    NodeIrContext&& node_context, llvm::Value* index,
+    int64_t first_case_operand, int64_t case_count,
+    std::optional<int64_t> default_operand) {
+  Node* node = node_context.node();
+  llvm::IRBuilder<>& b = node_context.entry_builder();
+  llvm::Function* function = node_context.llvm_function();
+
+  // Bits-typed values are selected by value so that LLVM can turn a switch
+  // over constants into a lookup table, other values are selected by pointer.
+  bool by_value = node->GetType()->IsBits();
+  llvm::BasicBlock* join_block =
+      llvm::BasicBlock::Create(ctx(), "join", function);
+  auto join_builder = std::make_unique<llvm::IRBuilder<>>(join_block);
+  llvm::PHINode* phi = join_builder->CreatePHI(
+      by_value ? type_converter()->ConvertToLlvmType(node->GetType())
+               : llvm::PointerType::get(ctx(), 0),
+      case_count + 1);
+  auto add_case = [&](int64_t operand, std::string_view name) {
+    llvm::BasicBlock* block = llvm::BasicBlock::Create(ctx(), name, function);
+    llvm::IRBuilder<> case_builder(block);
+    phi->addIncoming(by_value ? node_context.LoadOperand(operand, &case_builder)
+                              : node_context.GetOperandPtr(operand,
+                                                           &case_builder),
+                     block);
+    case_builder.CreateBr(join_block);
+    return block;
+  };
+
+  llvm::BasicBlock* default_block;
+  if (default_operand.has_value()) {
+    default_block = add_case(*default_operand, "default");
+  } else {
+    default_block = llvm::BasicBlock::Create(ctx(), "unreachable", function);
+    llvm::IRBuilder<>(default_block).CreateUnreachable();
+  }
+  llvm::SwitchInst* switch_inst =
+      b.CreateSwitch(index, default_block, case_count);
+  for (int64_t i = 0; i < case_count; ++i) {
+    switch_inst->addCase(
+        llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(index->getType()),
+                               i),
+        add_case(first_case_operand + i, absl::StrFormat("case_%d", i)));
+  }
+
+  if (by_value) {
+    return FinalizeNodeIrContextWithValue(std::move(node_context), phi,
+                                          join_builder.get());
+  }
+  return FinalizeNodeIrContextWithPointerToValue(std::move(node_context), phi,
+                                                 join_builder.get());
+}
+
 absl::Status IrBuilderVisitor::HandleOrReduce(BitwiseReductionOp* op) {
   return HandleUnaryOp(op, [](llvm::Value* operand, llvm::IRBuilder<>& b) {
     // OR-reduce is equivalent to checking if any bit is set in the input.
@@ -2801,20 +3265,22 @@ absl::Status IrBuilderVisitor::HandleReverse(UnOp* reverse) {
 }
 
 absl::Status IrBuilderVisitor::HandleSDiv(BinOp* binop) {
-  return HandleBinaryOp(
+  return HandleBinaryOpWithInstanceContext(
       binop,
-      [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+      [&](llvm::Value* lhs, llvm::Value* rhs, llvm::Value* instance_context,
+          llvm::IRBuilder<>& b) {
         return EmitDiv(lhs, rhs, binop->BitCountOrDie(), /*is_signed=*/true,
-                       type_converter(), &b);
+                       type_converter(), instance_context, &b);
       },
       /*is_signed=*/true);
 }
 
 absl::Status IrBuilderVisitor::HandleSMod(BinOp* binop) {
-  return HandleBinaryOp(
+  return HandleBinaryOpWithInstanceContext(
       binop,
-      [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return EmitMod(lhs, rhs, /*is_signed=*/true, &b);
+      [&](llvm::Value* lhs, llvm::Value* rhs, llvm::Value* instance_context,
+          llvm::IRBuilder<>& b) {
+        return EmitMod(lhs, rhs, /*is_signed=*/true, instance_context, &b);
       },
       /*is_signed=*/true);
 }
@@ -2830,9 +3296,18 @@ absl::Status IrBuilderVisitor::HandleSel(Select* sel) {
 
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
+  llvm::Value* selector = node_context.LoadOperand(0);
+  if (sel->cases().size() >= kMinSwitchSelectCases) {
+    return SelectWithSwitch(
+        std::move(node_context), selector, /*first_case_operand=*/1,
+        sel->cases().size(),
+        sel->default_value().has_value()
+            ? std::make_optional(sel->operand_count() - 1)
+            : std::nullopt);
+  }
+
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
-  llvm::Value* selector = node_context.LoadOperand(0);
   llvm::Value* llvm_sel =
       sel->default_value()
           ? node_context.GetOperandPtr(sel->operand_count() - 1)
@@ -2973,17 +3448,19 @@ absl::Status IrBuilderVisitor::HandleTupleIndex(TupleIndex* index) {
 }
 
 absl::Status IrBuilderVisitor::HandleUDiv(BinOp* binop) {
-  return HandleBinaryOp(
-      binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleBinaryOpWithInstanceContext(
+      binop, [&](llvm::Value* lhs, llvm::Value* rhs,
+                 llvm::Value* instance_context, llvm::IRBuilder<>& b) {
         return EmitDiv(lhs, rhs, binop->BitCountOrDie(), /*is_signed=*/false,
-                       type_converter(), &b);
+                       type_converter(), instance_context, &b);
       });
 }
 
 absl::Status IrBuilderVisitor::HandleUMod(BinOp* binop) {
-  return HandleBinaryOp(
-      binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return EmitMod(lhs, rhs, /*is_signed=*/false, &b);
+  return HandleBinaryOpWithInstanceContext(
+      binop, [&](llvm::Value* lhs, llvm::Value* rhs,
+                 llvm::Value* instance_context, llvm::IRBuilder<>& b) {
+        return EmitMod(lhs, rhs, /*is_signed=*/false, instance_context, &b);
       });
 }
 
@@ -3057,6 +3534,19 @@ absl::Status IrBuilderVisitor::HandleBinaryOp(
     std::function<llvm::Value*(llvm::Value*, llvm::Value*, llvm::IRBuilder<>&)>
         build_result,
     bool is_signed) {
+  return HandleBinaryOpWithInstanceContext(
+      node,
+      [&](llvm::Value* lhs, llvm::Value* rhs, llvm::Value* instance_context,
+          llvm::IRBuilder<>& b) { return build_result(lhs, rhs, b); },
+      is_signed);
+}
+
+absl::Status IrBuilderVisitor::HandleBinaryOpWithInstanceContext(
+    Node* node,
+    std::function<llvm::Value*(llvm::Value*, llvm::Value*, llvm::Value*,
+                               llvm::IRBuilder<>&)>
+        build_result,
+    bool is_signed) {
   XLS_RET_CHECK_EQ(node->operand_count(), 2);
   XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
                        NewNodeIrContext(node, {"lhs", "rhs"}));
@@ -3068,7 +3558,8 @@ absl::Status IrBuilderVisitor::HandleBinaryOp(
                     node_context.entry_builder(), is_signed);
   return FinalizeNodeIrContextWithValue(
       std::move(node_context),
-      build_result(lhs, rhs, node_context.entry_builder()));
+      build_result(lhs, rhs, node_context.GetInstanceContextArg(),
+                   node_context.entry_builder()));
 }
 
 absl::Status IrBuilderVisitor::HandleNaryOp(
@@ -3386,6 +3877,17 @@ llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                               llvm::MaybeAlign(1), size);
 }
 
+llvm::Value* LlvmMemcpyIfDistinct(llvm::Value* tgt, llvm::Value* src,
+                                  int64_t size, llvm::IRBuilder<>& builder) {
+  CHECK(tgt->getType()->isPointerTy());
+  CHECK(src->getType()->isPointerTy());
+  llvm::Value* copy_size =
+      builder.CreateSelect(builder.CreateICmpEQ(tgt, src),
+                           builder.getInt64(0), builder.getInt64(size));
+  return builder.CreateMemCpy(tgt, llvm::MaybeAlign(1), src,
+                              llvm::MaybeAlign(1), copy_size);
+}
+
 absl::StatusOr<NodeFunction> CreateNodeFunction(
     Node* node, int64_t output_arg_count,
     const JitCompilationMetadata& metadata, JitBuilderContext& jit_context) {
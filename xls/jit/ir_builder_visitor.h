@@ -26,6 +26,7 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Module.h"
@@ -42,6 +43,11 @@ namespace xls {
 // for nodes whose value is known at compile time (e.g., Literals).
 bool ShouldMaterializeAtUse(Node* node);
 
+// Returns whether the given node is a literal array which is only indexed into.
+// Such arrays are emitted as constant tables in read-only data which the
+// indexing reads directly.
+bool IsLookupTable(Node* node);
+
 // An object gathering necessary information for jitting XLS functions, procs,
 // etc.
 class JitBuilderContext {
@@ -94,6 +100,20 @@ class JitBuilderContext {
     return queue_indices_;
   }
 
+  // Returns the slot of `node` in the table of node value accumulators (see
+  // InstanceContext::node_value_accumulators), allocating one if needed.
+  int64_t GetOrAllocateObservedNodeSlot(Node* node) {
+    auto [it, inserted] =
+        observed_node_slots_.try_emplace(node, observed_nodes_.size());
+    if (inserted) {
+      observed_nodes_.push_back(node);
+    }
+    return it->second;
+  }
+
+  // The nodes whose values are reported to observers, indexed by their slot.
+  absl::Span<Node* const> observed_nodes() const { return observed_nodes_; }
+
   std::string MangleFunctionName(FunctionBase* f) {
     if (f == top() || !llvm_compiler().IsSharedCompilation()) {
       return f->name();
@@ -112,6 +132,9 @@ class JitBuilderContext {
 
   // A map from channel name to queue index.
   absl::btree_map<std::string, int64_t> queue_indices_;
+
+  absl::flat_hash_map<Node*, int64_t> observed_node_slots_;
+  std::vector<Node*> observed_nodes_;
 };
 
 // Abstraction representing an llvm::Function implementing an xls::Node. The
@@ -177,6 +200,12 @@ absl::StatusOr<NodeFunction> CreateNodeFunction(
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder);
 
+// Constructs a call to memcpy from `src` to `tgt` of `size` bytes which copies
+// nothing if `src` and `tgt` are the same buffer, as they are when a value is
+// updated in place.
+llvm::Value* LlvmMemcpyIfDistinct(llvm::Value* tgt, llvm::Value* src,
+                                  int64_t size, llvm::IRBuilder<>& builder);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_IR_BUILDER_VISITOR_H_
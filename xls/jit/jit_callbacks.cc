@@ -16,37 +16,51 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/xls_type.pb.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/wide_arithmetic.h"
 
 namespace xls {
 
 namespace {
-void PerformStringStep(InstanceContext* thiz, char* step_string,
-                       std::string* buffer) {
-  buffer->append(step_string);
+// Trace formats are encoded as the number of steps followed by each step: a
+// tag byte, then for strings the length and characters of the string, and for
+// operands the format preference, the offset of the operand value and the
+// length and bytes of the serialized TypeProto of the operand.
+constexpr uint8_t kStringStepTag = 0;
+constexpr uint8_t kOperandStepTag = 1;
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
 }
 
-void PerformFormatStep(InstanceContext* thiz, JitRuntime* runtime,
-                       const uint8_t* proto_data, int64_t proto_data_size,
-                       const uint8_t* value, uint64_t format_u64,
-                       std::string* buffer) {
-  Type* type = thiz->ParseTypeFromProto(
-      absl::Span<uint8_t const>(proto_data, proto_data_size));
-#ifdef ABSL_HAVE_MEMORY_SANITIZER
-  __msan_unpoison(value, runtime->GetTypeByteSize(type));
-#endif
-  FormatPreference format = static_cast<FormatPreference>(format_u64);
-  Value ir_value = runtime->UnpackBuffer(value, type);
-  absl::StrAppend(buffer, ir_value.ToHumanString(format));
+// Reads a varint from `*data`, which is trusted as it was produced by
+// EncodeTraceFormat, and advances past it.
+uint64_t ReadVarint(const uint8_t** data) {
+  uint64_t value = 0;
+  for (int64_t shift = 0;; shift += 7) {
+    uint8_t byte = *(*data)++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
 }
 
 void RecordTrace(InstanceContext* thiz, std::string* buffer, int64_t verbosity,
@@ -55,8 +69,16 @@ void RecordTrace(InstanceContext* thiz, std::string* buffer, int64_t verbosity,
       TraceMessage{.message = *buffer, .verbosity = verbosity});
   delete buffer;
 }
-std::string* CreateTraceBuffer(InstanceContext* thiz) {
-  return new std::string();
+void RecordRawTrace(InstanceContext* thiz, const uint8_t* format,
+                    const uint8_t* operands, int64_t operands_size,
+                    int64_t verbosity, InterpreterEvents* events) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  // Padding between and within the operand values is never initialized.
+  __msan_unpoison(operands, operands_size);
+#endif
+  thiz->RecordRawTrace(format,
+                       absl::Span<uint8_t const>(operands, operands_size),
+                       verbosity, events);
 }
 void RecordAssertion(InstanceContext* thiz, const char* msg,
                      InterpreterEvents* events) {
@@ -84,18 +106,26 @@ void RecordNodeResult(InstanceContext* thiz, int64_t node_ptr,
     thiz->observer->RecordNodeValue(node_ptr, data);
   }
 }
+
+void WideUDivRemWrapper(InstanceContext* thiz, const uint64_t* num,
+                        const uint64_t* denom, int64_t limb_count,
+                        uint64_t* quotient, uint64_t* remainder) {
+  WideUDivRem(absl::MakeConstSpan(num, limb_count),
+              absl::MakeConstSpan(denom, limb_count),
+              absl::MakeSpan(quotient, limb_count),
+              absl::MakeSpan(remainder, limb_count));
+}
 }  // namespace
 
 InstanceContextVTable::InstanceContextVTable()
-    : perform_string_step(&PerformStringStep),
-      perform_format_step(&PerformFormatStep),
-      record_trace(&RecordTrace),
-      create_trace_buffer(&CreateTraceBuffer),
+    : record_trace(&RecordTrace),
+      record_raw_trace(&RecordRawTrace),
       record_assertion(&RecordAssertion),
       queue_receive_wrapper(&QueueReceiveWrapper),
       queue_send_wrapper(&QueueSendWrapper),
       record_active_next_value(&RecordActiveNextValue),
-      record_node_result(&RecordNodeResult) {}
+      record_node_result(&RecordNodeResult),
+      wide_udiv_rem(&WideUDivRemWrapper) {}
 
 Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
   TypeProto proto;
@@ -104,4 +134,116 @@ Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
   CHECK_OK(type_or);
   return *type_or;
 }
+
+void InstanceContext::SetObserver(RuntimeObserver* new_observer,
+                                  absl::Span<Node* const> observed_nodes,
+                                  JitRuntime* runtime) {
+  observer = new_observer;
+  node_value_accumulators = nullptr;
+  node_value_accumulator_storage_.clear();
+  if (observer == nullptr) {
+    return;
+  }
+  bool accumulates = false;
+  for (Node* node : observed_nodes) {
+    uint8_t* storage = observer->GetNodeValueAccumulator(
+        node, runtime->GetTypeByteSize(node->GetType()));
+    accumulates = accumulates || storage != nullptr;
+    node_value_accumulator_storage_.push_back(storage);
+  }
+  if (accumulates) {
+    node_value_accumulators = node_value_accumulator_storage_.data();
+  }
+}
+
+void InstanceContext::RecordRawTrace(const uint8_t* format,
+                                     absl::Span<uint8_t const> operands,
+                                     int64_t verbosity,
+                                     InterpreterEvents* events) {
+  pending_traces_.push_back(
+      PendingTrace{.format = format,
+                   .data_offset = static_cast<int64_t>(
+                       pending_trace_data_.size()),
+                   .verbosity = verbosity,
+                   .events = events});
+  pending_trace_data_.insert(pending_trace_data_.end(), operands.begin(),
+                             operands.end());
+}
+
+const std::vector<InstanceContext::TraceStep>& InstanceContext::GetTraceSteps(
+    const uint8_t* format) {
+  auto [it, inserted] = trace_steps_.try_emplace(format);
+  if (!inserted) {
+    return it->second;
+  }
+  const uint8_t* data = format;
+  uint64_t step_count = ReadVarint(&data);
+  for (uint64_t i = 0; i < step_count; ++i) {
+    TraceStep& step = it->second.emplace_back();
+    uint8_t tag = *data++;
+    if (tag == kStringStepTag) {
+      uint64_t size = ReadVarint(&data);
+      step.text.assign(reinterpret_cast<const char*>(data), size);
+      data += size;
+      continue;
+    }
+    CHECK_EQ(tag, kOperandStepTag);
+    step.format = static_cast<FormatPreference>(ReadVarint(&data));
+    step.offset = static_cast<int64_t>(ReadVarint(&data));
+    uint64_t proto_size = ReadVarint(&data);
+    step.type = ParseTypeFromProto(absl::MakeConstSpan(data, proto_size));
+    data += proto_size;
+  }
+  return it->second;
+}
+
+void InstanceContext::FormatPendingTraces(JitRuntime* runtime) {
+  for (const PendingTrace& trace : pending_traces_) {
+    const uint8_t* operands = pending_trace_data_.data() + trace.data_offset;
+    std::string message;
+    for (const TraceStep& step : GetTraceSteps(trace.format)) {
+      if (step.type == nullptr) {
+        message.append(step.text);
+        continue;
+      }
+      absl::StrAppend(&message,
+                      runtime->UnpackBuffer(operands + step.offset, step.type)
+                          .ToHumanString(step.format));
+    }
+    trace.events->trace_msgs.push_back(
+        TraceMessage{.message = std::move(message),
+                     .verbosity = trace.verbosity});
+  }
+  pending_traces_.clear();
+  pending_trace_data_.clear();
+}
+
+std::string EncodeTraceFormat(absl::Span<FormatStep const> format,
+                              absl::Span<Type* const> operand_types,
+                              absl::Span<int64_t const> operand_offsets) {
+  CHECK_EQ(operand_types.size(), operand_offsets.size());
+  std::string encoding;
+  AppendVarint(format.size(), &encoding);
+  int64_t operand_index = 0;
+  for (const FormatStep& step : format) {
+    if (std::holds_alternative<std::string>(step)) {
+      const std::string& text = std::get<std::string>(step);
+      encoding.push_back(static_cast<char>(kStringStepTag));
+      AppendVarint(text.size(), &encoding);
+      encoding.append(text);
+      continue;
+    }
+    CHECK_LT(operand_index, operand_types.size());
+    encoding.push_back(static_cast<char>(kOperandStepTag));
+    AppendVarint(static_cast<uint64_t>(std::get<FormatPreference>(step)),
+                 &encoding);
+    AppendVarint(operand_offsets[operand_index], &encoding);
+    std::string proto =
+        operand_types[operand_index]->ToProto().SerializeAsString();
+    AppendVarint(proto.size(), &encoding);
+    encoding.append(proto);
+    ++operand_index;
+  }
+  return encoding;
+}
 }  // namespace xls
@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/node.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
@@ -50,27 +54,22 @@ struct InstanceContextVTable {
  public:
   explicit InstanceContextVTable();
 
-  using PerformStringStepFn = void (*)(InstanceContext* thiz, char* step_string,
-                                       std::string* buffer);
-  // This is a shim to let JIT code add a new trace fragment to an existing
-  // trace buffer.
-  const PerformStringStepFn perform_string_step;
-  using PerformFormatStepFn =
-      void (*)(InstanceContext* thiz, JitRuntime* runtime,
-               const uint8_t* type_proto_data, int64_t type_proto_data_size,
-               const uint8_t* value, uint64_t format_u64, std::string* buffer);
-  const PerformFormatStepFn perform_format_step;
-
   using RecordTraceFn = void (*)(InstanceContext* thiz, std::string* buffer,
                                  int64_t verbosity, InterpreterEvents* events);
-  // This a shim to let JIT code record a completed trace as an interpreter
-  // event.
+  // This a shim to record a completed trace as an interpreter event. Takes
+  // ownership of `buffer`.
   const RecordTraceFn record_trace;
 
-  using CreateTraceBufferFn = std::string* (*)(InstanceContext* thiz);
-  // This is a shim to let JIT code create a buffer for accumulating trace
-  // fragments.
-  const CreateTraceBufferFn create_trace_buffer;
+  using RecordRawTraceFn = void (*)(InstanceContext* thiz,
+                                    const uint8_t* format,
+                                    const uint8_t* operands,
+                                    int64_t operands_size, int64_t verbosity,
+                                    InterpreterEvents* events);
+  // This is a shim to let JIT code record a trace without formatting it.
+  // `format` is the trace format encoded by EncodeTraceFormat and must outlive
+  // the InstanceContext. The operand bytes are copied and the message is only
+  // built by InstanceContext::FormatPendingTraces.
+  const RecordRawTraceFn record_raw_trace;
 
   using RecordAssertionFn = void (*)(InstanceContext* thiz, const char* msg,
                                      InterpreterEvents* events);
@@ -102,6 +101,14 @@ struct InstanceContextVTable {
   // Data is in JIT data format and can be read using the appropriate type
   // information for the node.
   const RecordNodeResultFn record_node_result;
+
+  using WideUDivRemFn = void (*)(InstanceContext* thiz, const uint64_t* num,
+                                 const uint64_t* denom, int64_t limb_count,
+                                 uint64_t* quotient, uint64_t* remainder);
+  // This is a shim to let JIT code divide integers too wide for LLVM to divide
+  // efficiently. Each operand is `limb_count` little-endian 64-bit limbs; see
+  // WideUDivRem.
+  const WideUDivRemFn wide_udiv_rem;
 };
 
 // Data structure passed to the JITted function which contains instance-specific
@@ -119,14 +126,10 @@ struct InstanceContext {
   }
 
   // Offsets in the vtable the LLVM can use to grab the actual function pointer.
-  static constexpr int64_t kPerformStringStepOffset =
-      offsetof(InstanceContextVTable, perform_string_step);
-  static constexpr int64_t kPerformFormatStepOffset =
-      offsetof(InstanceContextVTable, perform_format_step);
   static constexpr int64_t kRecordTraceOffset =
       offsetof(InstanceContextVTable, record_trace);
-  static constexpr int64_t kCreateTraceBufferOffset =
-      offsetof(InstanceContextVTable, create_trace_buffer);
+  static constexpr int64_t kRecordRawTraceOffset =
+      offsetof(InstanceContextVTable, record_raw_trace);
   static constexpr int64_t kRecordAssertionOffset =
       offsetof(InstanceContextVTable, record_assertion);
   static constexpr int64_t kQueueReceiveWrapperOffset =
@@ -137,21 +140,53 @@ struct InstanceContext {
       offsetof(InstanceContextVTable, record_active_next_value);
   static constexpr int64_t kRecordNodeResultOffset =
       offsetof(InstanceContextVTable, record_node_result);
-  static constexpr int64_t kVTableLength = 9;
+  static constexpr int64_t kWideUDivRemOffset =
+      offsetof(InstanceContextVTable, wide_udiv_rem);
+  static constexpr int64_t kVTableLength = 8;
   using VTableArrayType = std::array<void (*)(), kVTableLength>;
 
   static constexpr bool IsVtableOffset(int64_t v) {
-    return v == kPerformFormatStepOffset || v == kPerformStringStepOffset ||
-           v == kRecordTraceOffset || v == kCreateTraceBufferOffset ||
+    return v == kRecordTraceOffset || v == kRecordRawTraceOffset ||
            v == kRecordAssertionOffset || v == kQueueReceiveWrapperOffset ||
            v == kQueueSendWrapperOffset || v == kRecordActiveNextValueOffset ||
-           v == kRecordNodeResultOffset;
+           v == kRecordNodeResultOffset || v == kWideUDivRemOffset;
   }
 
+  // Offsets of the fields which JIT code reads directly.
+  static constexpr int64_t kMaxTraceVerbosityOffset =
+      sizeof(InstanceContextVTable);
+  static constexpr int64_t kNodeValueAccumulatorsOffset =
+      kMaxTraceVerbosityOffset + sizeof(int64_t);
+
   Type* ParseTypeFromProto(absl::Span<uint8_t const> data);
 
+  // Records a trace to be formatted by FormatPendingTraces. See
+  // `InstanceContextVTable::record_raw_trace`.
+  void RecordRawTrace(const uint8_t* format, absl::Span<uint8_t const> operands,
+                      int64_t verbosity, InterpreterEvents* events);
+
+  // Formats the traces recorded by `record_raw_trace` since the last call and
+  // adds them to the InterpreterEvents they were recorded for.
+  void FormatPendingTraces(JitRuntime* runtime);
+
+  // Sets the observer of node values, or clears it if `new_observer` is
+  // nullptr. `observed_nodes` are the nodes the jitted code reports, by slot
+  // (see JittedFunctionBase::observed_nodes).
+  void SetObserver(RuntimeObserver* new_observer,
+                   absl::Span<Node* const> observed_nodes, JitRuntime* runtime);
+
   InstanceContextVTable vtable;
 
+  // Traces with a verbosity greater than this are skipped by the JIT code
+  // before evaluating any of their operands.
+  int64_t max_trace_verbosity = std::numeric_limits<int64_t>::max();
+
+  // The storage, indexed by slot, into which the JIT code ORs the value of
+  // each observed node in place of calling `record_node_result`. Null if the
+  // observer accumulates no node values, and null entries are reported to the
+  // observer through the callback.
+  uint8_t* const* node_value_accumulators = nullptr;
+
   // The proc instance being evaluated (if we are evaluating a proc).
   ProcInstance* instance = nullptr;
 
@@ -168,9 +203,49 @@ struct InstanceContext {
   std::unique_ptr<TypeManager> type_manager = std::make_unique<TypeManager>();
 
   RuntimeObserver* observer = nullptr;
+
+ private:
+  struct PendingTrace {
+    const uint8_t* format;
+    // Offset of the operand bytes in `pending_trace_data_`.
+    int64_t data_offset;
+    int64_t verbosity;
+    InterpreterEvents* events;
+  };
+  struct TraceStep {
+    // The text of a string step, empty for an operand.
+    std::string text;
+    // The type of the operand formatted by this step or nullptr for a string.
+    Type* type = nullptr;
+    FormatPreference format = FormatPreference::kDefault;
+    int64_t offset = 0;
+  };
+
+  const std::vector<TraceStep>& GetTraceSteps(const uint8_t* format);
+
+  std::vector<PendingTrace> pending_traces_;
+  // Operand bytes of the pending traces. Reused between calls to
+  // FormatPendingTraces so recording a trace does not usually allocate.
+  std::vector<uint8_t> pending_trace_data_;
+  // Decoded trace formats by the address of their encoding.
+  absl::flat_hash_map<const uint8_t*, std::vector<TraceStep>> trace_steps_;
+
+  // Backing store of `node_value_accumulators`.
+  std::vector<uint8_t*> node_value_accumulator_storage_;
 };
 
+// Returns the encoding of the given trace format passed to `record_raw_trace`.
+// The value of the i-th format operand, of type `operand_types[i]`, is at
+// `operand_offsets[i]` in the recorded operand bytes.
+std::string EncodeTraceFormat(absl::Span<FormatStep const> format,
+                              absl::Span<Type* const> operand_types,
+                              absl::Span<int64_t const> operand_offsets);
+
 static_assert(offsetof(InstanceContext, vtable) == 0);
+static_assert(offsetof(InstanceContext, max_trace_verbosity) ==
+              InstanceContext::kMaxTraceVerbosityOffset);
+static_assert(offsetof(InstanceContext, node_value_accumulators) ==
+              InstanceContext::kNodeValueAccumulatorsOffset);
 static_assert(sizeof(InstanceContextVTable) ==
               sizeof(InstanceContext::VTableArrayType));
 
@@ -22,38 +22,48 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
 
-void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
+void WriteValueOnQueue(const Value& value, const TypeLayout& type_layout,
                        ByteQueue& queue) {
   absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
       queue.element_size());
-  runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  type_layout.ValueToNativeLayout(value, buffer.data());
   queue.Write(buffer.data());
 }
 
-std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
+std::optional<Value> ReadValueFromQueue(const TypeLayout& type_layout,
                                         ByteQueue& queue) {
-  std::vector<uint8_t> buffer(queue.element_size());
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      queue.element_size());
   if (!queue.Read(buffer.data())) {
     return std::nullopt;
   }
-  return runtime.UnpackBuffer(buffer.data(), type);
+  return type_layout.NativeLayoutToValue(buffer.data());
 }
 
 }  // namespace
@@ -108,36 +118,284 @@ int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
 
 void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  WriteValueOnQueue(value, type_layout_, byte_queue_);
 }
 
 std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
-  std::optional<Value> value =
-      ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  std::optional<Value> value = ReadValueFromQueue(type_layout_, byte_queue_);
   if (value.has_value()) {
     CallReadCallbacks(value.value());
   }
   return value;
 }
 
+void ThreadSafeJitChannelQueue::WriteInPlace(
+    absl::FunctionRef<void(uint8_t*)> fill) {
+  absl::MutexLock lock(&mutex_);
+  uint8_t* slot = byte_queue_.WriteSlot();
+  fill(slot);
+  if (!callbacks_.empty()) {
+    CallWriteCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  byte_queue_.CommitWrite();
+}
+
+bool ThreadSafeJitChannelQueue::ReadInPlace(
+    absl::FunctionRef<void(const uint8_t*)> consume) {
+  absl::MutexLock lock(&mutex_);
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  const uint8_t* slot = byte_queue_.ReadSlot();
+  if (slot == nullptr) {
+    return false;
+  }
+  if (!callbacks_.empty()) {
+    CallReadCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  consume(slot);
+  byte_queue_.CommitRead();
+  return true;
+}
+
+void ThreadSafeJitChannelQueue::WriteRawBatch(const uint8_t* data,
+                                              int64_t count) {
+  absl::MutexLock lock(&mutex_);
+  for (int64_t i = 0; i < count; ++i) {
+    const uint8_t* element = data + i * element_size();
+    byte_queue_.Write(element);
+    if (!callbacks_.empty()) {
+      CallWriteCallbacks(type_layout_.NativeLayoutToValue(element));
+    }
+  }
+}
+
+int64_t ThreadSafeJitChannelQueue::ReadRawBatch(uint8_t* buffer,
+                                                int64_t max_count) {
+  absl::MutexLock lock(&mutex_);
+  int64_t count = 0;
+  while (count < max_count) {
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    uint8_t* element = buffer + count * element_size();
+    if (!byte_queue_.Read(element)) {
+      break;
+    }
+    if (!callbacks_.empty()) {
+      CallReadCallbacks(type_layout_.NativeLayoutToValue(element));
+    }
+    ++count;
+  }
+  return count;
+}
+
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
 void ThreadUnsafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  WriteValueOnQueue(value, type_layout_, byte_queue_);
 }
 
 std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
-  std::optional<Value> value =
-      ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  std::optional<Value> value = ReadValueFromQueue(type_layout_, byte_queue_);
   if (value.has_value()) {
     CallReadCallbacks(value.value());
   }
   return value;
 }
 
+void ThreadUnsafeJitChannelQueue::WriteInPlace(
+    absl::FunctionRef<void(uint8_t*)> fill) {
+  uint8_t* slot = byte_queue_.WriteSlot();
+  fill(slot);
+  if (!callbacks_.empty()) {
+    CallWriteCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  byte_queue_.CommitWrite();
+}
+
+bool ThreadUnsafeJitChannelQueue::ReadInPlace(
+    absl::FunctionRef<void(const uint8_t*)> consume) {
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  const uint8_t* slot = byte_queue_.ReadSlot();
+  if (slot == nullptr) {
+    return false;
+  }
+  if (!callbacks_.empty()) {
+    CallReadCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  consume(slot);
+  byte_queue_.CommitRead();
+  return true;
+}
+
+namespace {
+
+// Returns the initial number of slots in a segment of a SpscJitChannelQueue.
+// The segment holds at least a page worth of data.
+int64_t InitialSpscSegmentCapacity(int64_t slot_size) {
+  constexpr int64_t kMinCapacity = 8;
+  constexpr int64_t kTargetBytes = 4096;
+  return std::max(kMinCapacity, int64_t{1} << CeilOfLog2(CeilOfRatio(
+                                    kTargetBytes, slot_size)));
+}
+
+}  // namespace
+
+SpscJitChannelQueue::SpscJitChannelQueue(ChannelInstance* channel_instance,
+                                         JitRuntime* jit_runtime)
+    : JitChannelQueue(channel_instance, jit_runtime),
+      element_size_(
+          jit_runtime->GetTypeByteSize(channel_instance->channel->type())),
+      slot_size_(std::max(
+          int64_t{1},
+          RoundUpToNearest(element_size_,
+                           static_cast<int64_t>(alignof(std::max_align_t))))) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "SpscJitChannelQueue only supports streaming channels: "
+      << channel_instance->ToString();
+  producer_segment_ =
+      new Segment(InitialSpscSegmentCapacity(slot_size_), slot_size_);
+  consumer_segment_ = producer_segment_;
+}
+
+SpscJitChannelQueue::~SpscJitChannelQueue() {
+  Segment* segment = consumer_segment_;
+  while (segment != nullptr) {
+    Segment* next = segment->next.load(std::memory_order_acquire);
+    delete segment;
+    segment = next;
+  }
+}
+
+SpscJitChannelQueue::Segment* SpscJitChannelQueue::AddProducerSegment() {
+  // Cap the growth of segments so a single very deep queue does not allocate
+  // ever larger blocks.
+  constexpr int64_t kMaxSegmentBytes = int64_t{1} << 24;
+  int64_t capacity = producer_segment_->capacity;
+  if (capacity * slot_size_ < kMaxSegmentBytes) {
+    capacity *= 2;
+  }
+  Segment* segment = new Segment(capacity, slot_size_);
+  producer_cached_head_ = 0;
+  producer_segment_->next.store(segment, std::memory_order_release);
+  producer_segment_ = segment;
+  return segment;
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  // Load the read count first so the difference is never negative.
+  int64_t read_count = read_count_.load(std::memory_order_acquire);
+  return write_count_.load(std::memory_order_acquire) - read_count;
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  CallWriteCallbacks(value);
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  type_layout_.ValueToNativeLayout(value, buffer.data());
+  WriteBytes(buffer.data());
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  if (!ReadBytes(buffer.data())) {
+    return std::nullopt;
+  }
+  Value value = type_layout_.NativeLayoutToValue(buffer.data());
+  CallReadCallbacks(value);
+  return value;
+}
+
+void SpscJitChannelQueue::WriteInPlace(
+    absl::FunctionRef<void(uint8_t*)> fill) {
+  uint8_t* slot = ProducerSlot();
+  fill(slot);
+  if (!callbacks_.empty()) {
+    CallWriteCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  CommitProducerSlot();
+}
+
+bool SpscJitChannelQueue::ReadInPlace(
+    absl::FunctionRef<void(const uint8_t*)> consume) {
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  const uint8_t* slot = ConsumerSlot();
+  if (slot == nullptr) {
+    return false;
+  }
+  if (!callbacks_.empty()) {
+    CallReadCallbacks(type_layout_.NativeLayoutToValue(slot));
+  }
+  consume(slot);
+  CommitConsumerSlot();
+  return true;
+}
+
+namespace {
+
+// Returns the streaming channel instances in the elaboration which are sent on
+// by at most one proc instance and received on by at most one proc instance.
+absl::StatusOr<absl::flat_hash_set<ChannelInstance*>>
+GetSingleProducerSingleConsumerChannels(const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ChannelRef channel_ref,
+                           GetChannelRefUsedByNode(node));
+      ChannelInstance* channel_instance =
+          proc_instance->GetChannelBinding(channel_ref).instance;
+      if (node->Is<Send>()) {
+        senders[channel_instance].insert(proc_instance);
+      } else {
+        receivers[channel_instance].insert(proc_instance);
+      }
+    }
+  }
+  absl::flat_hash_set<ChannelInstance*> result;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming) {
+      continue;
+    }
+    auto count = [&](const auto& map) -> int64_t {
+      auto it = map.find(channel_instance);
+      return it == map.end() ? 0 : it->second.size();
+    };
+    if (count(senders) <= 1 && count(receivers) <= 1) {
+      result.insert(channel_instance);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package,
                                          std::unique_ptr<JitRuntime> runtime) {
@@ -149,10 +407,17 @@ JitChannelQueueManager::CreateThreadSafe(Package* package,
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(ProcElaboration&& elaboration,
                                          std::unique_ptr<JitRuntime> runtime) {
+  XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<ChannelInstance*> spsc_channels,
+                       GetSingleProducerSingleConsumerChannels(elaboration));
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+    if (spsc_channels.contains(channel_instance)) {
+      queues.push_back(std::make_unique<SpscJitChannelQueue>(channel_instance,
+                                                             runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    }
   }
   return absl::WrapUnique(new JitChannelQueueManager(
       std::move(elaboration), std::move(queues), std::move(runtime)));
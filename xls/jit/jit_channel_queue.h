@@ -14,6 +14,7 @@
 #ifndef XLS_JIT_JIT_CHANNEL_QUEUE_H_
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -21,8 +22,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xls/interpreter/channel_queue.h"
@@ -31,6 +34,7 @@
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -54,10 +58,21 @@ class ByteQueue {
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
     __msan_unpoison(data, channel_element_size_);
 #endif
+    memcpy(WriteSlot(), data, channel_element_size_);
+    CommitWrite();
+  }
+
+  // Returns the slot of `element_size()` bytes the next element is written to.
+  // The element is added to the queue by `CommitWrite`. The slot is valid until
+  // the next call to WriteSlot or Write.
+  uint8_t* WriteSlot() {
     if (bytes_used_ == max_byte_count_ && !is_single_value_) {
       Resize();
     }
-    memcpy(circular_buffer_.data() + write_index_, data, channel_element_size_);
+    return circular_buffer_.data() + write_index_;
+  }
+
+  void CommitWrite() {
     if (is_single_value_) {
       bytes_used_ = allocated_element_size_;
     } else {
@@ -70,11 +85,25 @@ class ByteQueue {
   }
 
   bool Read(uint8_t* buffer) {
-    if (bytes_used_ == 0) {
+    const uint8_t* slot = ReadSlot();
+    if (slot == nullptr) {
       return false;
     }
-    memcpy(buffer, circular_buffer_.data() + read_index_,
-           channel_element_size_);
+    memcpy(buffer, slot, channel_element_size_);
+    CommitRead();
+    return true;
+  }
+
+  // Returns the slot holding the element at the front of the queue, or nullptr
+  // if the queue is empty. The element is removed by `CommitRead`.
+  const uint8_t* ReadSlot() const {
+    if (bytes_used_ == 0) {
+      return nullptr;
+    }
+    return circular_buffer_.data() + read_index_;
+  }
+
+  void CommitRead() {
     if (!is_single_value_) {
       // Reads are destructive for non single-value channels.
       bytes_used_ -= allocated_element_size_;
@@ -83,7 +112,6 @@ class ByteQueue {
         read_index_ = 0;
       }
     }
-    return true;
   }
 
   int64_t size() const { return bytes_used_ / allocated_element_size_; }
@@ -118,14 +146,52 @@ class ByteQueue {
 class JitChannelQueue : public ChannelQueue {
  public:
   JitChannelQueue(ChannelInstance* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+      : ChannelQueue(channel),
+        jit_runtime_(jit_runtime),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->channel->type())) {}
   ~JitChannelQueue() override = default;
 
+  // Size in bytes of an element in the native layout of the channel type.
+  int64_t element_size() const { return type_layout_.size(); }
+
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Writes an element in place: `fill` is called with the queue slot of
+  // `element_size()` bytes which it must fill with the element in native
+  // layout. Avoids copying through an intermediate buffer. `fill` must not
+  // access the queue.
+  virtual void WriteInPlace(absl::FunctionRef<void(uint8_t*)> fill) = 0;
+
+  // Reads an element in place: if the queue is not empty `consume` is called
+  // with the queue slot holding the element at the front of the queue, which
+  // is then removed. Returns false if the queue is empty. `consume` must not
+  // access the queue.
+  virtual bool ReadInPlace(absl::FunctionRef<void(const uint8_t*)> consume) = 0;
+
+  // Writes `count` elements stored contiguously, `element_size()` bytes apart,
+  // in `data`.
+  virtual void WriteRawBatch(const uint8_t* data, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      WriteRaw(data + i * element_size());
+    }
+  }
+
+  // Reads up to `max_count` elements into `buffer`, contiguously and
+  // `element_size()` bytes apart. Returns the number of elements read.
+  virtual int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) {
+    int64_t count = 0;
+    while (count < max_count && ReadRaw(buffer + count * element_size())) {
+      ++count;
+    }
+    return count;
+  }
+
  protected:
   JitRuntime* jit_runtime_;
+  // The native layout of the channel type, used to convert values to and from
+  // the bytes held in the queue.
+  TypeLayout type_layout_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -145,7 +211,7 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     absl::MutexLock lock(&mutex_);
     byte_queue_.Write(data);
     if (!callbacks_.empty()) {
-      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+      CallWriteCallbacks(type_layout_.NativeLayoutToValue(data));
     }
   }
 
@@ -161,11 +227,17 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     }
     bool value_read = byte_queue_.Read(buffer);
     if (value_read && !callbacks_.empty()) {
-      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+      CallReadCallbacks(type_layout_.NativeLayoutToValue(buffer));
     }
     return value_read;
   }
 
+  // The in-place and batch accesses hold the lock for the whole operation.
+  void WriteInPlace(absl::FunctionRef<void(uint8_t*)> fill) override;
+  bool ReadInPlace(absl::FunctionRef<void(const uint8_t*)> consume) override;
+  void WriteRawBatch(const uint8_t* data, int64_t count) override;
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
@@ -190,7 +262,7 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   void WriteRaw(const uint8_t* data) override {
     byte_queue_.Write(data);
     if (!callbacks_.empty()) {
-      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+      CallWriteCallbacks(type_layout_.NativeLayoutToValue(data));
     }
   }
   bool ReadRaw(uint8_t* buffer) override {
@@ -202,11 +274,14 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
     }
     bool value_read = byte_queue_.Read(buffer);
     if (value_read && !callbacks_.empty()) {
-      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+      CallReadCallbacks(type_layout_.NativeLayoutToValue(buffer));
     }
     return value_read;
   }
 
+  void WriteInPlace(absl::FunctionRef<void(uint8_t*)> fill) override;
+  bool ReadInPlace(absl::FunctionRef<void(const uint8_t*)> consume) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value) override;
@@ -215,13 +290,180 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free JIT channel queue which supports exactly one producer thread and
+// one consumer thread operating concurrently. Only streaming (FIFO) channels
+// are supported.
+//
+// Elements are stored in fixed-size slots (the channel element size rounded up
+// to the largest scalar alignment) in a chain of ring-buffer segments. The
+// producer and consumer indices of each segment live on separate cache lines.
+// When the producer finds the current segment full it links a new segment of
+// twice the capacity and continues there; the consumer frees a segment once it
+// has drained it and observed the link. In the steady state no allocation
+// occurs and neither side takes a lock.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  SpscJitChannelQueue(ChannelInstance* channel_instance,
+                      JitRuntime* jit_runtime);
+  ~SpscJitChannelQueue() override;
+
+  // Must only be called from the producer thread.
+  void WriteRaw(const uint8_t* data) override {
+    WriteBytes(data);
+    if (!callbacks_.empty()) {
+      CallWriteCallbacks(type_layout_.NativeLayoutToValue(data));
+    }
+  }
+
+  // Must only be called from the consumer thread.
+  bool ReadRaw(uint8_t* buffer) override {
+    if (generator_.has_value()) {
+      // A queue with a generator cannot be written to by anyone else so the
+      // consumer is the only producer.
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    bool value_read = ReadBytes(buffer);
+    if (value_read && !callbacks_.empty()) {
+      CallReadCallbacks(type_layout_.NativeLayoutToValue(buffer));
+    }
+    return value_read;
+  }
+
+  // Must only be called from the producer thread.
+  void WriteInPlace(absl::FunctionRef<void(uint8_t*)> fill) override;
+
+  // Must only be called from the consumer thread.
+  bool ReadInPlace(absl::FunctionRef<void(const uint8_t*)> consume) override;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  struct Segment {
+    Segment(int64_t capacity, int64_t slot_size)
+        : capacity(capacity),
+          slots(std::make_unique<uint8_t[]>(capacity * slot_size)) {}
+
+    // Number of slots in the segment. Always a power of two.
+    const int64_t capacity;
+    std::unique_ptr<uint8_t[]> slots;
+    // Monotonically increasing slot counters. `head` is written only by the
+    // consumer and `tail` only by the producer.
+    alignas(ABSL_CACHELINE_SIZE) std::atomic<uint64_t> head = 0;
+    alignas(ABSL_CACHELINE_SIZE) std::atomic<uint64_t> tail = 0;
+    // Set by the producer once it stops writing to this segment.
+    std::atomic<Segment*> next = nullptr;
+  };
+
+  void WriteBytes(const uint8_t* data) {
+    memcpy(ProducerSlot(), data, element_size_);
+    CommitProducerSlot();
+  }
+
+  // Returns the slot the next element is written to, adding a segment if the
+  // current one is full. The element is published by `CommitProducerSlot`.
+  uint8_t* ProducerSlot() {
+    Segment* segment = producer_segment_;
+    uint64_t tail = segment->tail.load(std::memory_order_relaxed);
+    if (ABSL_PREDICT_FALSE(tail - producer_cached_head_ ==
+                           segment->capacity)) {
+      producer_cached_head_ = segment->head.load(std::memory_order_acquire);
+      if (tail - producer_cached_head_ == segment->capacity) {
+        segment = AddProducerSegment();
+        tail = 0;
+      }
+    }
+    return segment->slots.get() + (tail & (segment->capacity - 1)) * slot_size_;
+  }
+
+  void CommitProducerSlot() {
+    Segment* segment = producer_segment_;
+    segment->tail.store(segment->tail.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    write_count_.store(write_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  bool ReadBytes(uint8_t* buffer) {
+    const uint8_t* slot = ConsumerSlot();
+    if (slot == nullptr) {
+      return false;
+    }
+    memcpy(buffer, slot, element_size_);
+    CommitConsumerSlot();
+    return true;
+  }
+
+  // Returns the slot holding the element at the front of the queue, freeing
+  // drained segments on the way, or nullptr if the queue is empty. The element
+  // is removed by `CommitConsumerSlot`.
+  const uint8_t* ConsumerSlot() {
+    Segment* segment = consumer_segment_;
+    uint64_t head = segment->head.load(std::memory_order_relaxed);
+    while (ABSL_PREDICT_FALSE(head == consumer_cached_tail_)) {
+      consumer_cached_tail_ = segment->tail.load(std::memory_order_acquire);
+      if (head != consumer_cached_tail_) {
+        break;
+      }
+      Segment* next = segment->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return nullptr;
+      }
+      // The producer does not write to a segment after linking the next one,
+      // so the tail read here is final.
+      consumer_cached_tail_ = segment->tail.load(std::memory_order_acquire);
+      if (head != consumer_cached_tail_) {
+        break;
+      }
+      delete segment;
+      segment = consumer_segment_ = next;
+      head = 0;
+      consumer_cached_tail_ = 0;
+    }
+    return segment->slots.get() + (head & (segment->capacity - 1)) * slot_size_;
+  }
+
+  void CommitConsumerSlot() {
+    Segment* segment = consumer_segment_;
+    segment->head.store(segment->head.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    read_count_.store(read_count_.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+  }
+
+  Segment* AddProducerSegment();
+
+  // Size of an element in the channel in units of bytes.
+  int64_t element_size_;
+  // Size of a slot in a segment. The elements are aligned to the largest
+  // scalar type.
+  int64_t slot_size_;
+
+  // State touched only by the producer (except `write_count_`).
+  alignas(ABSL_CACHELINE_SIZE) Segment* producer_segment_;
+  uint64_t producer_cached_head_ = 0;
+  std::atomic<int64_t> write_count_ = 0;
+
+  // State touched only by the consumer (except `read_count_`).
+  alignas(ABSL_CACHELINE_SIZE) Segment* consumer_segment_;
+  uint64_t consumer_cached_tail_ = 0;
+  std::atomic<int64_t> read_count_ = 0;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
   // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // queues. CreateThreadSafe uses a lock-free SpscJitChannelQueue for each
+  // streaming channel instance which the elaboration shows is sent on by at
+  // most one proc instance and received on by at most one proc instance.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package, std::unique_ptr<JitRuntime> runtime);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
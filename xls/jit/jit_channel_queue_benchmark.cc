@@ -20,6 +20,7 @@
 
 #include "absl/log/check.h"
 #include "include/benchmark/benchmark.h"
+#include "xls/common/thread.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/package.h"
@@ -70,6 +71,52 @@ static void BM_QueueWriteThenRead(benchmark::State& state) {
   }
 }
 
+// Benchmark evaluating a producer thread writing to the channel while a
+// consumer thread concurrently reads from it. This measures the cost of the
+// queue under cross-thread contention which is the common case when procs are
+// evaluated on separate threads.
+template <typename QueueT,
+          typename std::enable_if<std::is_base_of_v<JitChannelQueue, QueueT>,
+                                  QueueT>::type* = nullptr>
+static void BM_QueueCrossThread(benchmark::State& state) {
+  int64_t element_size_bytes = state.range(0);
+
+  Package package("benchmark");
+  auto orc_jit = OrcJit::Create().value();
+  auto jit_runtime =
+      std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                  package.GetBitsType(8 * element_size_bytes))
+          .value();
+  ProcElaboration elaboration =
+      ProcElaboration::ElaborateOldStylePackage(&package).value();
+
+  QueueT queue(elaboration.GetUniqueInstance(channel).value(),
+               jit_runtime.get());
+
+  int64_t send_count = state.range(1);
+  std::vector<uint8_t> send_buffer(element_size_bytes);
+  std::vector<uint8_t> recv_buffer(element_size_bytes);
+  std::fill(send_buffer.begin(), send_buffer.end(), 42);
+  for (auto _ : state) {
+    Thread producer([&]() {
+      for (int64_t i = 0; i < send_count; ++i) {
+        queue.WriteRaw(send_buffer.data());
+      }
+    });
+    int64_t received = 0;
+    while (received < send_count) {
+      if (queue.ReadRaw(recv_buffer.data())) {
+        ++received;
+      }
+    }
+    producer.Join();
+  }
+  state.SetItemsProcessed(state.iterations() * send_count);
+}
+
 // For the following benchmark, the first element in the pair denotes the buffer
 // size written/read from the channel queue. The second element in the pair
 // denotes the number of writes and/or reads to the channel queue.
@@ -93,6 +140,29 @@ BENCHMARK(BM_QueueWriteThenRead<ThreadUnsafeJitChannelQueue>)
     ->ArgPair(2048, 1)
     ->ArgPair(2048, 128);
 
+BENCHMARK(BM_QueueWriteThenRead<SpscJitChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 128)
+    ->ArgPair(2048, 1)
+    ->ArgPair(2048, 128);
+
+// For the following benchmarks, the first element in the pair denotes the
+// buffer size written/read from the channel queue. The second element denotes
+// the number of elements sent from the producer to the consumer thread.
+BENCHMARK(BM_QueueCrossThread<ThreadSafeJitChannelQueue>)
+    ->ArgPair(8, 1 << 16)
+    ->ArgPair(32, 1 << 16)
+    ->ArgPair(2048, 1 << 12);
+
+BENCHMARK(BM_QueueCrossThread<SpscJitChannelQueue>)
+    ->ArgPair(8, 1 << 16)
+    ->ArgPair(32, 1 << 16)
+    ->ArgPair(2048, 1 << 12);
+
 }  // namespace
 }  // namespace xls
 
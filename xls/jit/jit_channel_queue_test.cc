@@ -24,10 +24,12 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
@@ -39,6 +41,7 @@ namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 JitRuntime* GetJitRuntime() {
   static auto orc_jit = OrcJit::Create().value();
@@ -67,7 +70,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -180,5 +184,148 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, ManyElementsSpanningSegments) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+
+  // Interleave bursts of writes and reads so the queue both grows and wraps.
+  uint64_t next_write = 0;
+  uint64_t next_read = 0;
+  for (int64_t burst = 1; burst < 2000; burst *= 3) {
+    for (int64_t i = 0; i < burst; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&next_write));
+      ++next_write;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < burst / 2; ++i) {
+      uint64_t value;
+      EXPECT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+      EXPECT_EQ(value, next_read++);
+    }
+  }
+  uint64_t value;
+  while (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+    EXPECT_EQ(value, next_read++);
+  }
+  EXPECT_EQ(next_read, next_write);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TYPED_TEST(JitChannelQueueTest, InPlaceAndBatchedAccess) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  ASSERT_EQ(queue.element_size(), sizeof(uint64_t));
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    queue.WriteInPlace(
+        [&](uint8_t* slot) { memcpy(slot, &i, sizeof(uint64_t)); });
+  }
+  // Enough elements to span several segments of the SPSC queue.
+  std::vector<uint64_t> batch(3000);
+  for (uint64_t i = 0; i < batch.size(); ++i) {
+    batch[i] = 10 + i;
+  }
+  queue.WriteRawBatch(reinterpret_cast<const uint8_t*>(batch.data()),
+                      batch.size());
+  EXPECT_EQ(queue.GetSize(), 3010);
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(0, 64))));
+
+  uint64_t value = 0;
+  EXPECT_TRUE(queue.ReadInPlace(
+      [&](const uint8_t* slot) { memcpy(&value, slot, sizeof(uint64_t)); }));
+  EXPECT_EQ(value, 1);
+
+  std::vector<uint64_t> received(4000);
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(received.data()),
+                               received.size()),
+            3008);
+  for (uint64_t i = 0; i < 3008; ++i) {
+    EXPECT_EQ(received[i], i + 2);
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.ReadInPlace([](const uint8_t*) { FAIL(); }));
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(received.data()),
+                               received.size()),
+            0);
+}
+
+class SpscJitChannelQueueTest : public ::testing::Test {};
+
+TEST_F(SpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime());
+
+  constexpr uint64_t kCount = 200000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST_F(SpscJitChannelQueueTest, ManagerPicksSpscQueues) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single,
+      package.CreateSingleValueChannel("single", ChannelOps::kReceiveOnly,
+                                       package.GetBitsType(32)));
+  TokenlessProcBuilder pb("passthru", "tkn", &package);
+  pb.Send(out, pb.Add(pb.Receive(in), pb.Receive(single)));
+  XLS_ASSERT_OK(pb.Build({}).status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto manager, JitChannelQueueManager::CreateThreadSafe(
+                        &package, std::make_unique<JitRuntime>(
+                                      GetJitRuntime()->data_layout())));
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(&manager->GetJitQueue(in)),
+            nullptr);
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(&manager->GetJitQueue(out)),
+            nullptr);
+  EXPECT_NE(
+      dynamic_cast<ThreadSafeJitChannelQueue*>(&manager->GetJitQueue(single)),
+      nullptr);
+}
+
 }  // namespace
 }  // namespace xls
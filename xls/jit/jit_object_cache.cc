@@ -0,0 +1,144 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/common/file/cache_key.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/jit/llvm_compiler.h"
+
+namespace xls {
+namespace {
+
+absl::Mutex& CacheDirectoryMutex() {
+  static absl::NoDestructor<absl::Mutex> mutex;
+  return *mutex;
+}
+
+std::optional<std::filesystem::path>& CacheDirectory()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(CacheDirectoryMutex()) {
+  static absl::NoDestructor<std::optional<std::filesystem::path>> directory;
+  return *directory;
+}
+
+}  // namespace
+
+void SetJitObjectCacheDirectory(
+    std::optional<std::filesystem::path> directory) {
+  absl::MutexLock lock(&CacheDirectoryMutex());
+  CacheDirectory() = std::move(directory);
+}
+
+std::optional<std::filesystem::path> GetJitObjectCacheDirectory() {
+  absl::MutexLock lock(&CacheDirectoryMutex());
+  return CacheDirectory();
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    const llvm::Module& module, int64_t opt_level, bool include_msan,
+    const llvm::TargetMachine& target_machine) {
+  return CacheKey({DumpLlvmModuleToString(&module), absl::StrCat(opt_level),
+                   include_msan ? "msan" : "nomsan",
+                   target_machine.getTargetTriple().getTriple(),
+                   target_machine.getTargetCPU().str(),
+                   target_machine.getTargetFeatureString().str()});
+}
+
+std::filesystem::path JitObjectCache::PathForKey(std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".o");
+}
+
+bool JitObjectCache::Register(const llvm::Module* module,
+                              std::string_view key) {
+  Entry entry{.key = std::string(key)};
+  // Read the object eagerly so a concurrent eviction of the file cannot leave
+  // us with a module whose optimization was skipped but which has no object.
+  absl::StatusOr<std::string> contents = GetFileContents(PathForKey(key));
+  if (contents.ok()) {
+    entry.object = *std::move(contents);
+  }
+  bool hit = entry.object.has_value();
+  absl::MutexLock lock(&mutex_);
+  entries_[module] = std::move(entry);
+  return hit;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JitObjectCache::getObject(
+    const llvm::Module* module) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(module);
+  if (it == entries_.end() || !it->second.object.has_value()) {
+    ++miss_count_;
+    return nullptr;
+  }
+  ++hit_count_;
+  VLOG(2) << absl::StreamFormat("JIT object cache hit for module %s (%s)",
+                                module->getModuleIdentifier(), it->second.key);
+  std::unique_ptr<llvm::MemoryBuffer> buffer =
+      llvm::MemoryBuffer::getMemBufferCopy(*it->second.object,
+                                           module->getModuleIdentifier());
+  entries_.erase(it);
+  return buffer;
+}
+
+void JitObjectCache::notifyObjectCompiled(const llvm::Module* module,
+                                          llvm::MemoryBufferRef object) {
+  std::string key;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(module);
+    if (it == entries_.end()) {
+      return;
+    }
+    key = std::move(it->second.key);
+    entries_.erase(it);
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to create JIT object cache directory %s: %s",
+        directory_.string(), ec.message());
+    return;
+  }
+  std::filesystem::path path = PathForKey(key);
+  absl::Status status = AtomicSetFileContents(
+      path,
+      std::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat("Unable to write JIT object cache %s: %s",
+                                       path.string(), status.ToString());
+  }
+}
+
+}  // namespace xls
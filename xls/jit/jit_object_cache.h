@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+
+namespace llvm {
+class Module;
+class TargetMachine;
+}  // namespace llvm
+
+namespace xls {
+
+// Sets the directory used by the JIT to persist compiled object files across
+// processes. If std::nullopt (the default) no persistent caching is done. Each
+// subsequently created OrcJit picks up the directory current at its creation.
+void SetJitObjectCacheDirectory(std::optional<std::filesystem::path> directory);
+std::optional<std::filesystem::path> GetJitObjectCacheDirectory();
+
+// An LLVM object cache which stores compiled objects as files in a directory.
+// Objects are keyed on a hash of the unoptimized LLVM module, the optimization
+// level and the target machine (triple, CPU and features) so a hit can skip
+// both LLVM optimization and code generation.
+//
+// Usage: the JIT calls `Register` with the unoptimized module before running
+// any optimization. If `Register` returns true, optimization may be skipped
+// since `getObject` will return the cached object for the module.
+class JitObjectCache final : public llvm::ObjectCache {
+ public:
+  explicit JitObjectCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Returns the cache key for the given (unoptimized) module.
+  static std::string ComputeKey(const llvm::Module& module, int64_t opt_level,
+                                bool include_msan,
+                                const llvm::TargetMachine& target_machine);
+
+  // Associates `key` with `module`. Returns true if an object for the key is
+  // present in the cache.
+  bool Register(const llvm::Module* module, std::string_view key);
+
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+  int64_t miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return miss_count_;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    // The cached object, if it was present at registration time.
+    std::optional<std::string> object;
+  };
+
+  std::filesystem::path PathForKey(std::string_view key) const;
+
+  std::filesystem::path directory_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<const llvm::Module*, Entry> entries_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::SizeIs;
+
+class JitObjectCacheTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::make_unique<TempDirectory>(std::move(temp_dir));
+    SetJitObjectCacheDirectory(temp_dir_->path());
+  }
+  void TearDown() override { SetJitObjectCacheDirectory(std::nullopt); }
+
+  absl::StatusOr<Function*> BuildAdder(Package* package) {
+    FunctionBuilder fb("adder", package);
+    fb.Add(fb.Param("x", package->GetBitsType(32)),
+           fb.Param("y", package->GetBitsType(32)));
+    return fb.Build();
+  }
+
+  std::unique_ptr<TempDirectory> temp_dir_;
+};
+
+TEST_F(JitObjectCacheTest, SecondCompilationHitsCache) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildAdder(package.get()));
+
+  std::vector<Value> args = {Value(UBits(2, 32)), Value(UBits(40, 32))};
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, jit->Run(args));
+    EXPECT_EQ(result.value, Value(UBits(42, 32)));
+  }
+  EXPECT_THAT(GetDirectoryEntries(temp_dir_->path()),
+              IsOkAndHolds(SizeIs(1)));
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, jit->Run(args));
+    EXPECT_EQ(result.value, Value(UBits(42, 32)));
+  }
+  // The second compilation reused the object so no new entry was added.
+  EXPECT_THAT(GetDirectoryEntries(temp_dir_->path()),
+              IsOkAndHolds(SizeIs(1)));
+}
+
+TEST_F(JitObjectCacheTest, OptLevelIsPartOfKey) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildAdder(package.get()));
+  XLS_ASSERT_OK(FunctionJit::Create(f, /*opt_level=*/1).status());
+  XLS_ASSERT_OK(FunctionJit::Create(f, /*opt_level=*/3).status());
+  EXPECT_THAT(GetDirectoryEntries(temp_dir_->path()),
+              IsOkAndHolds(SizeIs(2)));
+}
+
+TEST_F(JitObjectCacheTest, NoCachingWithoutDirectory) {
+  SetJitObjectCacheDirectory(std::nullopt);
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildAdder(package.get()));
+  XLS_ASSERT_OK(FunctionJit::Create(f).status());
+  EXPECT_THAT(GetDirectoryEntries(temp_dir_->path()),
+              IsOkAndHolds(SizeIs(0)));
+}
+
+}  // namespace
+}  // namespace xls
@@ -38,6 +38,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
@@ -213,6 +214,9 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
         ProcJit::CreateFromAot(jit_args.proc, &queue_manager->runtime(),
                                queue_manager.get(), jit_args.entrypoint,
                                jit_args.unpacked, jit_args.packed));
+    if (options.max_trace_verbosity().has_value()) {
+      proc_jit->SetMaxTraceVerbosity(*options.max_trace_verbosity());
+    }
     proc_jits.push_back(std::move(proc_jit));
   }
 
@@ -227,8 +231,14 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
   return std::move(proc_runtime);
 }
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration, const EvaluatorOptions& options) {
+struct JitEvaluators {
+  std::unique_ptr<JitChannelQueueManager> queue_manager;
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+};
+
+absl::StatusOr<JitEvaluators> CreateJitEvaluators(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    bool thread_safe_queues) {
   // We use the compiler to know the data layout.
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OrcJit> comp,
@@ -238,27 +248,71 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
-      JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+  JitEvaluators result;
+  if (thread_safe_queues) {
+    XLS_ASSIGN_OR_RETURN(
+        result.queue_manager,
+        JitChannelQueueManager::CreateThreadSafe(
+            std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        result.queue_manager,
+        JitChannelQueueManager::CreateThreadUnsafe(
+            std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+  }
 
   // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (Proc* proc : queue_manager->elaboration().procs()) {
+  for (Proc* proc : result.queue_manager->elaboration().procs()) {
     XLS_ASSIGN_OR_RETURN(
         std::unique_ptr<ProcJit> proc_jit,
         ProcJit::Create(
-            proc, &queue_manager->runtime(), queue_manager.get(),
+            proc, &result.queue_manager->runtime(), result.queue_manager.get(),
             /*include_observer_callbacks=*/options.support_observers()));
-    proc_jits.push_back(std::move(proc_jit));
+    if (options.max_trace_verbosity().has_value()) {
+      proc_jit->SetMaxTraceVerbosity(*options.max_trace_verbosity());
+    }
+    result.proc_jits.push_back(std::move(proc_jit));
   }
+  return std::move(result);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options) {
+  // A network ticked in dataflow order is only accessed from the ticking
+  // thread so the queues need no locking.
+  XLS_ASSIGN_OR_RETURN(
+      JitEvaluators jit_evaluators,
+      CreateJitEvaluators(
+          std::move(elaboration), options,
+          /*thread_safe_queues=*/!options.dataflow_tick_order()));
 
   // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(
+                           std::move(jit_evaluators.proc_jits),
+                           std::move(jit_evaluators.queue_manager), options));
+
+  XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
+      proc_runtime->elaboration(), proc_runtime->queue_manager()));
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    const ParallelProcRuntimeOptions& parallel_options) {
+  // Workers may tick instances on different threads, so the queues must lock
+  // even when the instances are ticked in dataflow order.
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<SerialProcRuntime> proc_runtime,
-      SerialProcRuntime::Create(std::move(proc_jits), std::move(queue_manager),
-                                options));
+      JitEvaluators jit_evaluators,
+      CreateJitEvaluators(std::move(elaboration), options,
+                          /*thread_safe_queues=*/true));
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ParallelProcRuntime> proc_runtime,
+      ParallelProcRuntime::Create(std::move(jit_evaluators.proc_jits),
+                                  std::move(jit_evaluators.queue_manager),
+                                  options, parallel_options));
 
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
@@ -281,6 +335,26 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
   return CreateRuntime(std::move(elaboration), options);
 }
 
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, const EvaluatorOptions& options,
+    const ParallelProcRuntimeOptions& parallel_options) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), options,
+                               parallel_options);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Proc* top, const EvaluatorOptions& options,
+    const ParallelProcRuntimeOptions& parallel_options) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), options,
+                               parallel_options);
+}
+
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Package* package,
                                                       bool with_msan,
                                                       JitObserver* observer) {
@@ -21,6 +21,7 @@ from collections.abc import Sequence
 import dataclasses
 import enum
 import itertools
+import re
 import subprocess
 from typing import Optional, TypeVar
 
@@ -181,6 +182,12 @@ class WrappedIr:
   def params_and_result(self):
     return list(self.params) + [self.result]
 
+  @property
+  def c_api_prefix(self) -> str:
+    """The prefix of the C API symbols defined for the wrapper."""
+    snake_class_name = re.sub(r"(?<!^)(?=[A-Z])", "_", self.class_name).lower()
+    return f"{self.namespace.replace('::', '_')}_{snake_class_name}"
+
 
 def to_packed(t: type_pb2.TypeProto) -> str:
   the_type = t.type_enum
@@ -15,6 +15,7 @@
 #include <array>
 #include <bit>
 #include <cstdint>
+#include <cstdlib>
 #include <optional>
 #include <string_view>
 
@@ -22,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/stdlib/float32_mul_jit_wrapper.h"
 #include "xls/dslx/stdlib/tests/float32_upcast_jit_wrapper.h"
@@ -31,6 +33,7 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_builder.h"
 #include "xls/ir/value_view.h"
+#include "xls/jit/aot_proc_network_c_api.h"
 #include "xls/jit/compound_type_jit_wrapper.h"
 
 namespace xls {
@@ -197,6 +200,54 @@ TEST(JitWrapperTest, ProcTickUnitlBlocked) {
   EXPECT_THAT(jit->ReceiveFromStringOutput(), IsOkAndHolds(std::nullopt));
 }
 
+TEST(JitWrapperTest, ProcCApi) {
+  char* error = nullptr;
+  xls_aot_proc_network* network = nullptr;
+  ASSERT_TRUE(xls_examples_some_caps_create_network(&error, &network))
+      << error;
+  auto find_channel = [&](std::string_view suffix) -> int64_t {
+    for (int64_t i = 0; i < xls_aot_proc_network_channel_count(network);
+         ++i) {
+      if (absl::EndsWith(xls_aot_proc_network_channel_name(network, i),
+                         suffix)) {
+        return i;
+      }
+    }
+    return -1;
+  };
+  int64_t input = find_channel("string_input");
+  int64_t output = find_channel("string_output");
+  ASSERT_NE(input, -1);
+  ASSERT_NE(output, -1);
+  EXPECT_EQ(xls_aot_proc_network_channel_element_size(network, input), 8);
+
+  std::array<uint8_t, 8> data = StrArray("abcdefgh");
+  ASSERT_TRUE(xls_aot_proc_network_send(network, input, data.data(), &error))
+      << error;
+  int64_t ticks = 0;
+  ASSERT_TRUE(xls_aot_proc_network_tick_until_blocked(network, -1, &error,
+                                                      &ticks))
+      << error;
+  std::array<uint8_t, 8> result;
+  bool received = false;
+  ASSERT_TRUE(xls_aot_proc_network_receive(network, output, result.data(),
+                                           &error, &received))
+      << error;
+  EXPECT_TRUE(received);
+  EXPECT_EQ(result, StrArray("ABCDEFGH"));
+  ASSERT_TRUE(xls_aot_proc_network_receive(network, output, result.data(),
+                                           &error, &received))
+      << error;
+  EXPECT_FALSE(received);
+
+  EXPECT_FALSE(xls_aot_proc_network_send(
+      network, xls_aot_proc_network_channel_count(network), data.data(),
+      &error));
+  EXPECT_THAT(error, testing::HasSubstr("out of range"));
+  free(error);
+  xls_aot_proc_network_free(network);
+}
+
 TEST(JitWrapperTest, ProcOptIrWrapper) {
   XLS_ASSERT_OK_AND_ASSIGN(auto jit, examples::SomeCapsOpt::Create());
   XLS_ASSERT_OK(
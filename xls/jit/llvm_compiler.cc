@@ -14,38 +14,60 @@
 
 #include "xls/jit/llvm_compiler.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/include/llvm/IR/Argument.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/GlobalVariable.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/PassManager.h"
+#include "llvm/include/llvm/IR/ReplaceConstant.h"
+#include "llvm/include/llvm/IR/User.h"
 #include "llvm/include/llvm/IR/Use.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBufferRef.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 
@@ -57,8 +79,45 @@ void OnceInit() {
   LLVMInitializeNativeAsmPrinter();
   LLVMInitializeNativeAsmParser();
 }
+
+std::atomic<int64_t> codegen_thread_count = 1;
+
+absl::Mutex profiling_options_mutex(absl::kConstInit);
+JitProfilingOptions profiling_options
+    ABSL_GUARDED_BY(profiling_options_mutex);
+
+absl::Mutex native_float_options_mutex(absl::kConstInit);
+JitNativeFloatOptions native_float_options
+    ABSL_GUARDED_BY(native_float_options_mutex);
 }  // namespace
 
+void SetLlvmCodegenThreadCount(int64_t thread_count) {
+  CHECK_GE(thread_count, 1);
+  codegen_thread_count = thread_count;
+}
+
+int64_t GetLlvmCodegenThreadCount() { return codegen_thread_count; }
+
+void SetJitProfilingOptions(const JitProfilingOptions& options) {
+  absl::MutexLock lock(&profiling_options_mutex);
+  profiling_options = options;
+}
+
+JitProfilingOptions GetJitProfilingOptions() {
+  absl::MutexLock lock(&profiling_options_mutex);
+  return profiling_options;
+}
+
+void SetJitNativeFloatOptions(const JitNativeFloatOptions& options) {
+  absl::MutexLock lock(&native_float_options_mutex);
+  native_float_options = options;
+}
+
+JitNativeFloatOptions GetJitNativeFloatOptions() {
+  absl::MutexLock lock(&native_float_options_mutex);
+  return native_float_options;
+}
+
 std::string LlvmCompiler::target_triple() const {
   return target_machine_->getTargetTriple().getTriple();
 }
@@ -131,6 +190,41 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
+// The thread-local globals of the MSan runtime which jitted code accesses
+// through emulated TLS (see jit_emulated_tls.h).
+constexpr std::array<std::string_view, 2> kMsanTlsGlobals = {
+    "__msan_param_tls", "__msan_retval_tls"};
+
+// MSan instrumentation accesses its thread-local globals at every call and
+// function entry, and emulated TLS lowers the accesses into a call to
+// __emutls_get_address in each basic block using them. Instead compute the
+// address of each global once at the entry of each function and reuse it.
+void HoistMsanTlsAddresses(llvm::Module& module) {
+  for (std::string_view name : kMsanTlsGlobals) {
+    llvm::GlobalVariable* global = module.getGlobalVariable(name);
+    if (global == nullptr || !global->isThreadLocal()) {
+      continue;
+    }
+    // Accesses are usually through constant GEPs which must become
+    // instructions before they can use a non-constant address.
+    llvm::convertUsersOfConstantsToInstructions({global});
+    absl::flat_hash_map<llvm::Function*, std::vector<llvm::Instruction*>> uses;
+    for (llvm::User* user : global->users()) {
+      if (auto* instruction = llvm::dyn_cast<llvm::Instruction>(user)) {
+        uses[instruction->getFunction()].push_back(instruction);
+      }
+    }
+    for (auto& [function, instructions] : uses) {
+      llvm::IRBuilder<> builder(
+          &*function->getEntryBlock().getFirstInsertionPt());
+      llvm::Value* address = builder.CreateThreadLocalAddress(global);
+      for (llvm::Instruction* instruction : instructions) {
+        instruction->replaceUsesOfWith(global, address);
+      }
+    }
+  }
+}
+
 }  // namespace
 
 llvm::Error LlvmCompiler::PerformStandardOptimization(
@@ -183,9 +277,87 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
     mpm = pass_builder.buildPerModuleDefaultPipeline(llvm_opt_level);
   }
   mpm.run(*bare_module, mam);
+  if (include_msan_) {
+    HoistMsanTlsAddresses(*bare_module);
+  }
   return llvm::Error::success();
 }
 
+bool LlvmCompiler::ShouldSplitModule(const llvm::Module& module) const {
+  if (codegen_thread_count_ <= 1) {
+    return false;
+  }
+  int64_t defined_function_count = 0;
+  for (const llvm::Function& function : module.functions()) {
+    if (!function.isDeclaration()) {
+      ++defined_function_count;
+    }
+  }
+  return defined_function_count > 1;
+}
+
+absl::StatusOr<std::vector<std::string>> LlvmCompiler::SplitModuleToBitcode(
+    std::unique_ptr<llvm::Module> module) {
+  std::vector<std::string> parts;
+  llvm::SplitModule(
+      *module, codegen_thread_count_,
+      [&](std::unique_ptr<llvm::Module> part) {
+        parts.push_back(WriteBitcode(*part));
+      },
+      /*PreserveLocals=*/false);
+  XLS_RET_CHECK(!parts.empty());
+  VLOG(2) << absl::StreamFormat("Split module `%s` into %d parts",
+                                module->getName().str(), parts.size());
+  return parts;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<llvm::Module>>
+LlvmCompiler::ParseBitcode(std::string_view bitcode,
+                           llvm::LLVMContext& context) {
+  llvm::Expected<std::unique_ptr<llvm::Module>> module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                            "module_part"),
+      context);
+  if (!module) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to parse module bitcode: %s",
+                        llvm::toString(module.takeError())));
+  }
+  return std::move(module.get());
+}
+
+/* static */ std::string LlvmCompiler::WriteBitcode(
+    const llvm::Module& module) {
+  std::string bitcode;
+  llvm::raw_string_ostream ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, ostream);
+  ostream.flush();
+  return bitcode;
+}
+
+absl::Status LlvmCompiler::RunConcurrently(
+    int64_t count, absl::FunctionRef<absl::Status(int64_t)> fn) {
+  std::vector<absl::Status> results(count);
+  std::atomic<int64_t> next = 0;
+  auto worker = [&] {
+    for (int64_t i = next++; i < count; i = next++) {
+      results[i] = fn(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(codegen_thread_count_, count); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (absl::Status& status : results) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 // Check that every operand of every instruction is in the same function as the
 // instruction itself. This is a very common error which is not checked by the
 // LLVM verifier(!).
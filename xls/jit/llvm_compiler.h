@@ -20,7 +20,9 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
@@ -39,6 +41,56 @@ namespace xls {
 class AotCompiler;
 class OrcJit;
 
+// Sets the number of threads used to optimize and generate code for each LLVM
+// module compiled by the JIT and AOT compilers. With more than one thread the
+// module is split into that many parts which are compiled concurrently, at the
+// cost of no inlining across the parts. Defaults to 1, which compiles the
+// module as a whole. Each subsequently created compiler picks up the count
+// current at its creation.
+void SetLlvmCodegenThreadCount(int64_t thread_count);
+int64_t GetLlvmCodegenThreadCount();
+
+// Options for profiling jitted code. Each subsequently created compiler picks
+// up the options current at its creation.
+struct JitProfilingOptions {
+  // Registers jitted object code with the GDB JIT interface so debuggers can
+  // symbolize and step through jitted frames.
+  bool register_with_gdb = false;
+  // Registers jitted object code with perf by writing a jitdump file which
+  // `perf inject --jit` merges into a recording. Requires LLVM to be built with
+  // perf support, otherwise a warning is logged and the option has no effect.
+  bool register_with_perf = false;
+  // Increments a counter on each execution of each partition of jitted code
+  // (see JitPartitionProfile). Only supported by the JIT, not AOT compilation,
+  // as the counter addresses are baked into the code.
+  bool count_partition_executions = false;
+
+  // Returns true if jitted code is registered with any external profiler.
+  bool registers_listeners() const {
+    return register_with_gdb || register_with_perf;
+  }
+};
+
+void SetJitProfilingOptions(const JitProfilingOptions& options);
+JitProfilingOptions GetJitProfilingOptions();
+
+// Options for lowering invocations of the DSLX standard library's
+// floating-point arithmetic (see native_float_lowering.h) to native
+// floating-point instructions rather than their bit-level IR implementations.
+// Intended for functional simulation of float-heavy designs. Each subsequently
+// created compiler picks up the options current at its creation.
+struct JitNativeFloatOptions {
+  bool enabled = false;
+  // If positive (and `enabled` is set), FunctionJit::Create checks the native
+  // lowering of each floating-point function the jitted function invokes
+  // against the IR implementation of that function on this many sampled
+  // inputs, and fails if any result differs.
+  int64_t verification_samples = 0;
+};
+
+void SetJitNativeFloatOptions(const JitNativeFloatOptions& options);
+JitNativeFloatOptions GetJitNativeFloatOptions();
+
 class LlvmCompiler {
  public:
   static constexpr int64_t kDefaultOptLevel = 3;
@@ -91,6 +143,13 @@ class LlvmCompiler {
   bool include_observer_callbacks() const {
     return include_observer_callbacks_;
   }
+  int64_t codegen_thread_count() const { return codegen_thread_count_; }
+  const JitProfilingOptions& profiling_options() const {
+    return profiling_options_;
+  }
+  const JitNativeFloatOptions& native_float_options() const {
+    return native_float_options_;
+  }
 
  protected:
   absl::Status Init();
@@ -101,12 +160,39 @@ class LlvmCompiler {
 
   llvm::Error PerformStandardOptimization(llvm::Module* module);
 
+  // Returns true if `module` should be split and compiled concurrently.
+  bool ShouldSplitModule(const llvm::Module& module) const;
+
+  // Splits `module` into at most `codegen_thread_count()` parts and returns
+  // the bitcode of each, so every part can be parsed into its own context and
+  // compiled on its own thread. Local symbols are externalized (as hidden)
+  // under their original names so references between the parts resolve and
+  // the symbol names are deterministic.
+  absl::StatusOr<std::vector<std::string>> SplitModuleToBitcode(
+      std::unique_ptr<llvm::Module> module);
+
+  // Parses bitcode produced by `SplitModuleToBitcode` into `context`.
+  static absl::StatusOr<std::unique_ptr<llvm::Module>> ParseBitcode(
+      std::string_view bitcode, llvm::LLVMContext& context);
+
+  // Serializes `module` to bitcode.
+  static std::string WriteBitcode(const llvm::Module& module);
+
+  // Calls `fn` with each index in [0, count) using up to
+  // `codegen_thread_count()` threads. Returns the error of the lowest failing
+  // index, if any.
+  absl::Status RunConcurrently(int64_t count,
+                               absl::FunctionRef<absl::Status(int64_t)> fn);
+
   LlvmCompiler(int64_t opt_level, bool include_msan,
                bool include_observer_callbacks)
       : data_layout_(""),
         opt_level_(opt_level),
         include_msan_(include_msan),
-        include_observer_callbacks_(include_observer_callbacks) {}
+        include_observer_callbacks_(include_observer_callbacks),
+        codegen_thread_count_(GetLlvmCodegenThreadCount()),
+        profiling_options_(GetJitProfilingOptions()),
+        native_float_options_(GetJitNativeFloatOptions()) {}
 
   // Constructor to manually setup the compiler without Init.
   LlvmCompiler(std::unique_ptr<llvm::TargetMachine> target,
@@ -116,7 +202,10 @@ class LlvmCompiler {
         data_layout_(layout),
         opt_level_(opt_level),
         include_msan_(include_msan),
-        include_observer_callbacks_(include_observer_callbacks) {}
+        include_observer_callbacks_(include_observer_callbacks),
+        codegen_thread_count_(GetLlvmCodegenThreadCount()),
+        profiling_options_(GetJitProfilingOptions()),
+        native_float_options_(GetJitNativeFloatOptions()) {}
 
   // Setup by Init
   std::unique_ptr<llvm::TargetMachine> target_machine_;
@@ -132,6 +221,16 @@ class LlvmCompiler {
   // callback.
   const bool include_observer_callbacks_;
 
+  // Number of threads used to compile each module. See
+  // SetLlvmCodegenThreadCount.
+  const int64_t codegen_thread_count_;
+
+  // See SetJitProfilingOptions.
+  const JitProfilingOptions profiling_options_;
+
+  // See SetJitNativeFloatOptions.
+  const JitNativeFloatOptions native_float_options_;
+
   bool module_created_ = false;
 };
 
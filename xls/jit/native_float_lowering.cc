@@ -0,0 +1,311 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_float_lowering.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+// Standard library modules whose arithmetic functions are lowered natively.
+constexpr std::array<std::string_view, 3> kFloatModules = {
+    "apfloat", "float32", "bfloat16"};
+
+constexpr int64_t kMaxExponentBits = 10;
+constexpr int64_t kMaxFractionBits = 25;
+
+constexpr int64_t kDoubleFractionBits = 52;
+constexpr int64_t kDoubleBias = 1023;
+constexpr int64_t kDoubleMaxExponent = 0x7ff;
+
+std::optional<NativeFloatOp> NativeFloatOpFromString(std::string_view name) {
+  if (name == "add") {
+    return NativeFloatOp::kAdd;
+  }
+  if (name == "sub") {
+    return NativeFloatOp::kSub;
+  }
+  if (name == "mul") {
+    return NativeFloatOp::kMul;
+  }
+  if (name == "fma") {
+    return NativeFloatOp::kFma;
+  }
+  return std::nullopt;
+}
+
+// Returns whether `module` (as it appears in a mangled function name, i.e.,
+// with dots replaced by underscores) is one of `kFloatModules`.
+bool IsFloatModule(std::string_view module) {
+  return absl::c_any_of(kFloatModules, [&](std::string_view float_module) {
+    return module == float_module ||
+           absl::EndsWith(module, absl::StrCat("_stdlib_", float_module));
+  });
+}
+
+int64_t Bias(const NativeFloatFunction& function) {
+  return (int64_t{1} << (function.exponent_bits - 1)) - 1;
+}
+
+int64_t MaxExponent(const NativeFloatFunction& function) {
+  return (int64_t{1} << function.exponent_bits) - 1;
+}
+
+llvm::Value* Mask(int64_t width, llvm::IRBuilder<>& builder) {
+  return builder.getInt64((uint64_t{1} << width) - 1);
+}
+
+// Returns the double with the value of the APFloat `value`, with subnormals
+// flushed to zero. This is exact, since the format is no wider than a double.
+llvm::Value* ToDouble(llvm::Value* value, const NativeFloatFunction& function,
+                      llvm::IRBuilder<>& builder) {
+  auto field = [&](unsigned index, int64_t width) {
+    return builder.CreateAnd(
+        builder.CreateZExt(builder.CreateExtractValue(value, {index}),
+                           builder.getInt64Ty()),
+        Mask(width, builder));
+  };
+  llvm::Value* sign = field(0, 1);
+  llvm::Value* bexp = field(1, function.exponent_bits);
+  llvm::Value* fraction = field(2, function.fraction_bits);
+
+  llvm::Value* is_zero_or_subnormal =
+      builder.CreateICmpEQ(bexp, builder.getInt64(0));
+  llvm::Value* is_inf_or_nan =
+      builder.CreateICmpEQ(bexp, builder.getInt64(MaxExponent(function)));
+  fraction =
+      builder.CreateSelect(is_zero_or_subnormal, builder.getInt64(0), fraction);
+  llvm::Value* double_exp = builder.CreateSelect(
+      is_zero_or_subnormal, builder.getInt64(0),
+      builder.CreateSelect(
+          is_inf_or_nan, builder.getInt64(kDoubleMaxExponent),
+          builder.CreateAdd(bexp,
+                            builder.getInt64(kDoubleBias - Bias(function)))));
+  llvm::Value* bits = builder.CreateOr(
+      builder.CreateOr(builder.CreateShl(sign, 63),
+                       builder.CreateShl(double_exp, kDoubleFractionBits)),
+      builder.CreateShl(fraction,
+                        kDoubleFractionBits - function.fraction_bits));
+  return builder.CreateBitCast(bits, builder.getDoubleTy());
+}
+
+// The sum of two doubles and its rounding error (a Knuth two-sum): `sum +
+// error` is exactly `a + b`.
+struct TwoSum {
+  llvm::Value* sum;
+  llvm::Value* error;
+};
+
+TwoSum EmitTwoSum(llvm::Value* a, llvm::Value* b, llvm::IRBuilder<>& builder) {
+  llvm::Value* sum = builder.CreateFAdd(a, b);
+  llvm::Value* b_virtual = builder.CreateFSub(sum, a);
+  llvm::Value* a_virtual = builder.CreateFSub(sum, b_virtual);
+  llvm::Value* error =
+      builder.CreateFAdd(builder.CreateFSub(a, a_virtual),
+                         builder.CreateFSub(b, b_virtual));
+  return TwoSum{.sum = sum, .error = error};
+}
+
+// Returns the APFloat value of type `result_type` nearest to `value + error`,
+// where `value` is that sum rounded to nearest. `value` is first rounded to
+// odd, which makes rounding it again to the (much narrower) APFloat format
+// equivalent to rounding the exact sum once. The exponent is unbounded while
+// rounding, so results below the smallest normal value are flushed to zero
+// regardless of which way they would round as subnormals.
+llvm::Value* FromDouble(llvm::Value* value, llvm::Value* error,
+                        const NativeFloatFunction& function,
+                        llvm::Type* result_type, llvm::IRBuilder<>& builder) {
+  llvm::Value* bits = builder.CreateBitCast(value, builder.getInt64Ty());
+
+  // Round to odd: truncate towards zero, and set the least significant bit if
+  // the result is inexact.
+  llvm::Value* inexact = builder.CreateFCmpONE(
+      error, llvm::ConstantFP::get(builder.getDoubleTy(), 0.0));
+  llvm::Value* rounded_away_from_zero = builder.CreateICmpSLT(
+      builder.CreateXor(bits,
+                        builder.CreateBitCast(error, builder.getInt64Ty())),
+      builder.getInt64(0));
+  bits = builder.CreateSelect(
+      builder.CreateAnd(inexact, rounded_away_from_zero),
+      builder.CreateSub(bits, builder.getInt64(1)), bits);
+  bits = builder.CreateSelect(
+      inexact, builder.CreateOr(bits, builder.getInt64(1)), bits);
+
+  // Round to nearest, ties to even, by adding just under half an ULP plus the
+  // ULP's own bit, so ties round up only when that bit is set; any carry
+  // propagates into the exponent.
+  int64_t shift = kDoubleFractionBits - function.fraction_bits;
+  llvm::Value* ulp_bit =
+      builder.CreateAnd(builder.CreateLShr(bits, shift), builder.getInt64(1));
+  llvm::Value* rounded = builder.CreateAdd(
+      bits, builder.CreateAdd(builder.getInt64((int64_t{1} << (shift - 1)) - 1),
+                              ulp_bit));
+
+  llvm::Value* sign = builder.CreateLShr(bits, 63);
+  llvm::Value* bexp = builder.CreateSub(
+      builder.CreateAnd(builder.CreateLShr(rounded, kDoubleFractionBits),
+                        builder.getInt64(kDoubleMaxExponent)),
+      builder.getInt64(kDoubleBias - Bias(function)));
+  llvm::Value* fraction = builder.CreateAnd(
+      builder.CreateLShr(rounded, shift),
+      Mask(function.fraction_bits, builder));
+
+  // Flush underflows to zero and saturate overflows (and infinities) to
+  // infinity.
+  llvm::Value* underflow = builder.CreateICmpSLE(bexp, builder.getInt64(0));
+  llvm::Value* overflow =
+      builder.CreateICmpSGE(bexp, builder.getInt64(MaxExponent(function)));
+  bexp = builder.CreateSelect(
+      underflow, builder.getInt64(0),
+      builder.CreateSelect(overflow, builder.getInt64(MaxExponent(function)),
+                           bexp));
+  fraction = builder.CreateSelect(builder.CreateOr(underflow, overflow),
+                                  builder.getInt64(0), fraction);
+
+  // NaNs are canonicalized to apfloat's quiet NaN.
+  llvm::Value* is_nan = builder.CreateFCmpUNO(value, value);
+  sign = builder.CreateSelect(is_nan, builder.getInt64(0), sign);
+  bexp = builder.CreateSelect(
+      is_nan, builder.getInt64(MaxExponent(function)), bexp);
+  fraction = builder.CreateSelect(
+      is_nan, builder.getInt64(int64_t{1} << (function.fraction_bits - 1)),
+      fraction);
+
+  llvm::Value* result = llvm::PoisonValue::get(result_type);
+  std::array<llvm::Value*, 3> fields = {sign, bexp, fraction};
+  for (unsigned i = 0; i < fields.size(); ++i) {
+    result = builder.CreateInsertValue(
+        result,
+        builder.CreateTrunc(fields[i], result_type->getStructElementType(i)),
+        {i});
+  }
+  return result;
+}
+
+}  // namespace
+
+std::string_view NativeFloatOpToString(NativeFloatOp op) {
+  switch (op) {
+    case NativeFloatOp::kAdd:
+      return "add";
+    case NativeFloatOp::kSub:
+      return "sub";
+    case NativeFloatOp::kMul:
+      return "mul";
+    case NativeFloatOp::kFma:
+      return "fma";
+  }
+  return "<unknown>";
+}
+
+std::optional<NativeFloatFunction> MatchNativeFloatFunction(
+    Function* function) {
+  // Mangled names are `__module__function`, with a `__params` suffix for
+  // parametric instantiations.
+  std::string_view name = function->name();
+  if (!absl::ConsumePrefix(&name, "__")) {
+    return std::nullopt;
+  }
+  std::vector<std::string_view> parts = absl::StrSplit(name, "__");
+  if ((parts.size() != 2 && parts.size() != 3) || !IsFloatModule(parts[0])) {
+    return std::nullopt;
+  }
+  std::optional<NativeFloatOp> op = NativeFloatOpFromString(parts[1]);
+  if (!op.has_value()) {
+    return std::nullopt;
+  }
+
+  // All operands and the result must be the same (sign, bexp, fraction) tuple.
+  Type* type = function->GetType()->return_type();
+  if (!type->IsTuple() || type->AsTupleOrDie()->size() != 3 ||
+      !absl::c_all_of(type->AsTupleOrDie()->element_types(),
+                      [](Type* element) { return element->IsBits(); })) {
+    return std::nullopt;
+  }
+  absl::Span<Type* const> fields = type->AsTupleOrDie()->element_types();
+  NativeFloatFunction result{
+      .op = *op,
+      .exponent_bits = fields[1]->AsBitsOrDie()->bit_count(),
+      .fraction_bits = fields[2]->AsBitsOrDie()->bit_count()};
+  if (fields[0]->AsBitsOrDie()->bit_count() != 1 ||
+      result.exponent_bits < 2 || result.exponent_bits > kMaxExponentBits ||
+      result.fraction_bits < 1 || result.fraction_bits > kMaxFractionBits) {
+    return std::nullopt;
+  }
+  int64_t operand_count = *op == NativeFloatOp::kFma ? 3 : 2;
+  if (function->params().size() != operand_count ||
+      !absl::c_all_of(function->params(),
+                      [&](Param* param) { return param->GetType() == type; })) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+absl::StatusOr<llvm::Value*> EmitNativeFloatFunction(
+    const NativeFloatFunction& function, absl::Span<llvm::Value* const> args,
+    llvm::Type* result_type, llvm::IRBuilder<>& builder) {
+  XLS_RET_CHECK_EQ(args.size(), function.op == NativeFloatOp::kFma ? 3 : 2);
+  XLS_RET_CHECK(result_type->isStructTy());
+  std::vector<llvm::Value*> operands;
+  operands.reserve(args.size());
+  for (llvm::Value* arg : args) {
+    operands.push_back(ToDouble(arg, function, builder));
+  }
+
+  // Products of two operands are exact in a double; sums are computed along
+  // with their rounding error.
+  TwoSum result;
+  switch (function.op) {
+    case NativeFloatOp::kAdd:
+      result = EmitTwoSum(operands[0], operands[1], builder);
+      break;
+    case NativeFloatOp::kSub:
+      result = EmitTwoSum(operands[0], builder.CreateFNeg(operands[1]),
+                          builder);
+      break;
+    case NativeFloatOp::kMul:
+      result = TwoSum{
+          .sum = builder.CreateFMul(operands[0], operands[1]),
+          .error = llvm::ConstantFP::get(builder.getDoubleTy(), 0.0)};
+      break;
+    case NativeFloatOp::kFma:
+      result = EmitTwoSum(builder.CreateFMul(operands[0], operands[1]),
+                          operands[2], builder);
+      break;
+  }
+  return FromDouble(result.sum, result.error, function, result_type, builder);
+}
+
+}  // namespace xls
@@ -0,0 +1,83 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_NATIVE_FLOAT_LOWERING_H_
+#define XLS_JIT_NATIVE_FLOAT_LOWERING_H_
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/ir/function.h"
+
+namespace xls {
+
+// Native lowering of the DSLX standard library's floating-point arithmetic.
+//
+// The IR implementations of apfloat's `add`, `sub`, `mul` and `fma` (and of
+// the float32 and bfloat16 wrappers of them) take thousands of
+// bit-level nodes per operation. When enabled (see JitNativeFloatOptions),
+// the JIT instead lowers invocations of these functions to a handful of
+// double-precision instructions plus integer rounding with the semantics of
+// apfloat:
+//
+//  - subnormal inputs are treated as zero and subnormal results are flushed
+//    to (signed) zero;
+//  - results are rounded to nearest, ties to even, with the exponent
+//    unbounded, and
+//  - NaN results are apfloat's canonical quiet NaN.
+//
+// Exact operations and sums are computed in double precision and rounded to
+// odd before the final rounding, so results are correctly rounded without
+// double rounding. This requires the product of two operands to be exact in a
+// double, so only formats with at most 10 exponent bits and 25 fraction bits
+// (e.g., float32, bfloat16 and float16, but not float64) are lowered.
+
+enum class NativeFloatOp : uint8_t {
+  kAdd,
+  kSub,
+  kMul,
+  kFma,
+};
+
+std::string_view NativeFloatOpToString(NativeFloatOp op);
+
+// A floating-point function which can be lowered natively.
+struct NativeFloatFunction {
+  NativeFloatOp op;
+  int64_t exponent_bits;
+  int64_t fraction_bits;
+};
+
+// Returns how `function` can be lowered natively, or std::nullopt if it's not
+// one of the recognized standard library functions (by mangled name) with the
+// expected signature.
+std::optional<NativeFloatFunction> MatchNativeFloatFunction(
+    Function* function);
+
+// Emits code computing `function` on `args`, which are LLVM values of the
+// (sign, bexp, fraction) tuple type of the operands. `result_type` is the LLVM
+// type of that tuple.
+absl::StatusOr<llvm::Value*> EmitNativeFloatFunction(
+    const NativeFloatFunction& function, absl::Span<llvm::Value* const> args,
+    llvm::Type* result_type, llvm::IRBuilder<>& builder);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_NATIVE_FLOAT_LOWERING_H_
@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/native_float_lowering.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+// Builds a function named `name` with `operand_count` operands of `type`
+// which returns its first operand.
+absl::StatusOr<Function*> BuildFunction(Package& package, std::string_view name,
+                                        Type* type, int64_t operand_count) {
+  FunctionBuilder fb(name, &package);
+  BValue first = fb.Param("x0", type);
+  for (int64_t i = 1; i < operand_count; ++i) {
+    fb.Param(absl::StrCat("x", i), type);
+  }
+  return fb.BuildWithReturnValue(first);
+}
+
+Type* FloatType(Package& package, int64_t exponent_bits,
+                int64_t fraction_bits) {
+  return package.GetTupleType({package.GetBitsType(1),
+                               package.GetBitsType(exponent_bits),
+                               package.GetBitsType(fraction_bits)});
+}
+
+TEST(NativeFloatLoweringTest, MatchesStandardLibraryFunctions) {
+  Package package("test_package");
+  Type* f32 = FloatType(package, 8, 23);
+  Type* bf16 = FloatType(package, 8, 7);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * add,
+                           BuildFunction(package, "__float32__add", f32, 2));
+  std::optional<NativeFloatFunction> match = MatchNativeFloatFunction(add);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->op, NativeFloatOp::kAdd);
+  EXPECT_EQ(match->exponent_bits, 8);
+  EXPECT_EQ(match->fraction_bits, 23);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * fma,
+      BuildFunction(package, "__xls_dslx_stdlib_bfloat16__fma", bf16, 3));
+  match = MatchNativeFloatFunction(fma);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->op, NativeFloatOp::kFma);
+  EXPECT_EQ(match->exponent_bits, 8);
+  EXPECT_EQ(match->fraction_bits, 7);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * mul, BuildFunction(package, "__apfloat__mul__8_23", f32, 2));
+  match = MatchNativeFloatFunction(mul);
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->op, NativeFloatOp::kMul);
+}
+
+TEST(NativeFloatLoweringTest, RejectsOtherFunctions) {
+  Package package("test_package");
+  Type* f32 = FloatType(package, 8, 23);
+
+  // Not an arithmetic function, or not from the standard library.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * div,
+                           BuildFunction(package, "__float32__div", f32, 2));
+  EXPECT_FALSE(MatchNativeFloatFunction(div).has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * user_add,
+                           BuildFunction(package, "__my_float__add", f32, 2));
+  EXPECT_FALSE(MatchNativeFloatFunction(user_add).has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * itok_add,
+      BuildFunction(package, "__itok__float32__add", f32, 2));
+  EXPECT_FALSE(MatchNativeFloatFunction(itok_add).has_value());
+
+  // Wrong signature.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * unary_add,
+                           BuildFunction(package, "__float32__sub", f32, 1));
+  EXPECT_FALSE(MatchNativeFloatFunction(unary_add).has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * bits_add,
+      BuildFunction(package, "__apfloat__add", package.GetBitsType(32), 2));
+  EXPECT_FALSE(MatchNativeFloatFunction(bits_add).has_value());
+
+  // Too wide for products to be exact in a double.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f64_add,
+      BuildFunction(package, "__apfloat__add__11_52",
+                    FloatType(package, 11, 52), 2));
+  EXPECT_FALSE(MatchNativeFloatFunction(f64_add).has_value());
+}
+
+}  // namespace
+}  // namespace xls
@@ -84,6 +84,16 @@ class RuntimeObserver {
  public:
   virtual ~RuntimeObserver() = default;
   virtual void RecordNodeValue(int64_t node_ptr, const uint8_t* data) = 0;
+
+  // Observers which only need the bitwise OR of all the values a node takes,
+  // such as toggle coverage, may return `byte_size` bytes of storage into which
+  // the jitted code ORs the values of `node` (in JIT data format) instead of
+  // calling RecordNodeValue. The storage must remain valid while the observer
+  // is set. Called for each node the jitted code may report when the observer
+  // is set.
+  virtual uint8_t* GetNodeValueAccumulator(Node* node, int64_t byte_size) {
+    return nullptr;
+  }
 };
 
 // A translator that lets one easily convert from a jit runtime observer to the
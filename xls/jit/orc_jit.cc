@@ -14,12 +14,15 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <atomic>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -27,16 +30,21 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/include/llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
@@ -44,21 +52,40 @@
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IRPrinter/IRPrintingPasses.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/jit/jit_emulated_tls.h"  // NOLINT: Used with MSAN
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
+namespace {
+
+std::atomic<bool> lazy_compilation = false;
+
+// Called in place of a lazily compiled function which failed to compile.
+void LazyCompilationFailure() {
+  LOG(FATAL) << "Lazy compilation of a JIT function failed; see the errors "
+                "reported by the execution session.";
+}
+
+}  // namespace
+
+void SetJitLazyCompilation(bool enabled) { lazy_compilation = enabled; }
+
+bool GetJitLazyCompilation() { return lazy_compilation; }
 
 OrcJit::OrcJit(int64_t opt_level, bool include_msan,
                bool include_observer_callbacks)
@@ -69,7 +96,8 @@ OrcJit::OrcJit(int64_t opt_level, bool include_msan,
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
-      dylib_(execution_session_.createBareJITDylib("main")) {}
+      dylib_(execution_session_.createBareJITDylib("main")),
+      lazy_compilation_(GetJitLazyCompilation()) {}
 
 OrcJit::~OrcJit() {
   if (auto err = execution_session_.endSession()) {
@@ -77,23 +105,40 @@ OrcJit::~OrcJit() {
   }
 }
 
-llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
-    llvm::orc::ThreadSafeModule module,
-    const llvm::orc::MaterializationResponsibility& responsibility) {
-  llvm::Module* bare_module = module.getModuleUnlocked();
-
+void OrcJit::NotifyUnoptimizedModule(llvm::Module* bare_module) {
   VLOG(2) << "Unoptimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
   if (jit_observer_ != nullptr &&
       jit_observer_->GetNotificationOptions().unoptimized_module) {
     jit_observer_->UnoptimizedModule(bare_module);
   }
+}
 
-  auto error = PerformStandardOptimization(bare_module);
-  if (error) {
-    return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
+llvm::Error OrcJit::OptimizeModule(llvm::Module* bare_module,
+                                   llvm::TargetMachine& target_machine) {
+  if (object_cache_ != nullptr) {
+    bool cache_hit = object_cache_->Register(
+        bare_module,
+        JitObjectCache::ComputeKey(*bare_module, opt_level_, include_msan_,
+                                   target_machine));
+    bool observe_compiled_code =
+        jit_observer_ != nullptr &&
+        (jit_observer_->GetNotificationOptions().optimized_module ||
+         jit_observer_->GetNotificationOptions().assembly_code_str);
+    if (cache_hit && !observe_compiled_code && !VLOG_IS_ON(2)) {
+      // The compile layer will pick up the cached object so there is no need
+      // to optimize the module.
+      return llvm::Error::success();
+    }
+  }
+
+  if (llvm::Error error = PerformStandardOptimization(bare_module)) {
+    return error;
   }
 
+  // Parts of a split module are optimized concurrently so serialize the
+  // notifications.
+  absl::MutexLock lock(&observer_mutex_);
   VLOG(2) << "Optimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
   if (jit_observer_ != nullptr &&
@@ -113,7 +158,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     llvm::SmallVector<char, 0> stream_buffer;
     llvm::raw_svector_ostream ostream(stream_buffer);
     llvm::legacy::PassManager mpm;
-    if (target_machine_->addPassesToEmitFile(
+    if (target_machine.addPassesToEmitFile(
             mpm, ostream, nullptr, llvm::CodeGenFileType::AssemblyFile)) {
       VLOG(3) << "Could not create ASM generation pass!";
     }
@@ -126,6 +171,17 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     }
   }
 
+  return llvm::Error::success();
+}
+
+llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
+    llvm::orc::ThreadSafeModule module,
+    const llvm::orc::MaterializationResponsibility& responsibility) {
+  llvm::Module* bare_module = module.getModuleUnlocked();
+  NotifyUnoptimizedModule(bare_module);
+  if (llvm::Error error = OptimizeModule(bare_module, *target_machine_)) {
+    return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
+  }
   return module;
 }
 
@@ -214,7 +270,28 @@ absl::Status OrcJit::InitInternal() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  if (std::optional<std::filesystem::path> cache_directory =
+          GetJitObjectCacheDirectory();
+      cache_directory.has_value()) {
+    object_cache_ = std::make_unique<JitObjectCache>(*cache_directory);
+  }
+  if (profiling_options().register_with_gdb) {
+    object_layer_.registerJITEventListener(
+        *llvm::JITEventListener::createGDBRegistrationListener());
+  }
+  if (profiling_options().register_with_perf) {
+    // The listener is only available if LLVM was built with perf support.
+    if (llvm::JITEventListener* perf_listener =
+            llvm::JITEventListener::createPerfJITEventListener();
+        perf_listener != nullptr) {
+      object_layer_.registerJITEventListener(*perf_listener);
+    } else {
+      LOG(WARNING) << "LLVM was built without perf support; jitted code will "
+                      "not be registered with perf.";
+    }
+  }
+  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+      *target_machine_, object_cache_.get());
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -227,12 +304,42 @@ absl::Status OrcJit::InitInternal() {
         return Optimizer(std::move(module), responsibility);
       });
 
+  if (lazy_compilation_) {
+    const llvm::Triple& triple = target_machine_->getTargetTriple();
+    llvm::Expected<std::unique_ptr<llvm::orc::LazyCallThroughManager>>
+        call_through_manager = llvm::orc::createLocalLazyCallThroughManager(
+            triple, execution_session_,
+            llvm::orc::ExecutorAddr::fromPtr(&LazyCompilationFailure));
+    if (!call_through_manager) {
+      return absl::InternalError(absl::StrCat(
+          "Unable to create lazy call-through manager: ",
+          llvm::toString(call_through_manager.takeError())));
+    }
+    lazy_call_through_manager_ = std::move(call_through_manager.get());
+    compile_on_demand_layer_ =
+        std::make_unique<llvm::orc::CompileOnDemandLayer>(
+            execution_session_, *transform_layer_, *lazy_call_through_manager_,
+            llvm::orc::createLocalIndirectStubsManagerBuilder(triple));
+    // Compile only the function being called rather than all the functions of
+    // the module defined alongside it.
+    compile_on_demand_layer_->setPartitionFunction(
+        llvm::orc::CompileOnDemandLayer::compileRequested);
+  }
+
   return absl::OkStatus();
 }
 
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
-  llvm::Error error = transform_layer_->add(
+  llvm::orc::IRLayer* layer = transform_layer_.get();
+  if (compile_on_demand_layer_ != nullptr) {
+    // Each function is extracted, optimized and compiled on its own when first
+    // called, so there is nothing to gain from splitting the module.
+    layer = compile_on_demand_layer_.get();
+  } else if (ShouldSplitModule(*module)) {
+    return CompileModuleConcurrently(std::move(module));
+  }
+  llvm::Error error = layer->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
     return absl::UnknownError(absl::StrFormat(
@@ -241,6 +348,51 @@ absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   return absl::OkStatus();
 }
 
+absl::Status OrcJit::CompileModuleConcurrently(
+    std::unique_ptr<llvm::Module> module) {
+  NotifyUnoptimizedModule(module.get());
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> parts,
+                       SplitModuleToBitcode(std::move(module)));
+
+  // Each part is optimized and compiled to an object in its own context with
+  // its own target machine as neither may be shared across threads.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(parts.size());
+  XLS_RETURN_IF_ERROR(RunConcurrently(
+      parts.size(), [&](int64_t i) -> absl::Status {
+        llvm::LLVMContext context;
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> part,
+                             ParseBitcode(parts[i], context));
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> machine,
+                             CreateTargetMachine());
+        if (llvm::Error error = OptimizeModule(part.get(), *machine)) {
+          return absl::UnknownError(
+              absl::StrFormat("Error optimizing converted IR: %s",
+                              llvm::toString(std::move(error))));
+        }
+        llvm::orc::SimpleCompiler compiler(*machine, object_cache_.get());
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+            compiler(*part);
+        if (!object) {
+          return absl::UnknownError(
+              absl::StrFormat("Error compiling converted IR: %s",
+                              llvm::toString(object.takeError())));
+        }
+        objects[i] = std::move(object.get());
+        return absl::OkStatus();
+      }));
+
+  // Add the objects in part order so the JIT dylib is the same regardless of
+  // which thread finished first.
+  for (std::unique_ptr<llvm::MemoryBuffer>& object : objects) {
+    if (llvm::Error error = object_layer_.add(dylib_, std::move(object))) {
+      return absl::UnknownError(
+          absl::StrFormat("Error adding compiled object: %s",
+                          llvm::toString(std::move(error))));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<llvm::orc::ExecutorAddr> OrcJit::LoadSymbol(
     std::string_view function_name) {
 #ifdef __APPLE__
@@ -21,9 +21,12 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
@@ -31,10 +34,22 @@
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
+
+// Sets whether subsequently created JITs compile lazily. A lazy JIT compiles
+// each function of a module through a stub the first time it is called rather
+// than the whole module up front, so large packages of which only some paths
+// are exercised start quickly. Functions are optimized separately, without
+// inlining across them, and the module is never split for concurrent
+// compilation (see SetLlvmCodegenThreadCount). Compiled functions are still
+// stored in and loaded from the object cache. Off by default.
+void SetJitLazyCompilation(bool enabled);
+bool GetJitLazyCompilation();
+
 // A wrapper around ORC JIT which hides some of the internals of the LLVM
 // interface.
 class OrcJit : public LlvmCompiler {
@@ -59,7 +74,14 @@ class OrcJit : public LlvmCompiler {
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
-  // Compiles the given LLVM module into the JIT's execution session.
+  // Compiles the given LLVM module into the JIT's execution session. With lazy
+  // compilation (see SetJitLazyCompilation) the functions of the module are
+  // only compiled when first called.
+  //
+  // If the codegen thread count (see SetLlvmCodegenThreadCount) is more than
+  // one the module is split and the parts are optimized and compiled to
+  // objects concurrently before being added to the session. The optimized
+  // module and assembly observer notifications are then made once per part.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
   // Returns the address of the given JIT'ed function.
@@ -72,6 +94,11 @@ class OrcJit : public LlvmCompiler {
   absl::StatusOr<std::unique_ptr<llvm::TargetMachine>> CreateTargetMachine()
       override;
 
+  // Returns the persistent object cache used by this JIT, if any. The cache is
+  // enabled if a directory was set with SetJitObjectCacheDirectory when the
+  // JIT was created.
+  JitObjectCache* object_cache() const { return object_cache_.get(); }
+
  protected:
   absl::Status InitInternal() override;
 
@@ -84,15 +111,36 @@ class OrcJit : public LlvmCompiler {
       llvm::orc::ThreadSafeModule module,
       const llvm::orc::MaterializationResponsibility& responsibility);
 
+  // Notifies the observer of the module before optimization.
+  void NotifyUnoptimizedModule(llvm::Module* bare_module);
+
+  // Optimizes the given module, registering it with the object cache and
+  // notifying the observer. `target_machine` is used for the cache key and
+  // assembly dumps. May be called concurrently on modules in distinct
+  // contexts.
+  llvm::Error OptimizeModule(llvm::Module* bare_module,
+                             llvm::TargetMachine& target_machine);
+
+  // Splits the module and compiles the parts concurrently.
+  absl::Status CompileModuleConcurrently(std::unique_ptr<llvm::Module> module);
+
   llvm::orc::ThreadSafeContext context_;
   llvm::orc::ExecutionSession execution_session_;
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
   llvm::orc::JITDylib& dylib_;
 
+  std::unique_ptr<JitObjectCache> object_cache_;
   std::unique_ptr<llvm::orc::IRCompileLayer> compile_layer_;
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
 
+  // Whether functions are compiled on their first call. See
+  // SetJitLazyCompilation. The layers below are only created if so.
+  const bool lazy_compilation_;
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> lazy_call_through_manager_;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> compile_on_demand_layer_;
+
   JitObserver* jit_observer_ = nullptr;
+  absl::Mutex observer_mutex_;
 };
 
 }  // namespace xls
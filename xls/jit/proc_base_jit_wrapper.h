@@ -38,6 +38,7 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
 #include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/aot_proc_network_c_api.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
@@ -86,6 +87,8 @@ class BaseProcJitWrapper {
         new RealType(std::move(package), proc, std::move(aot), runtime));
   }
 
+  virtual ~BaseProcJitWrapper() = default;
+
   Package* package() const { return package_.get(); }
   ProcRuntime* runtime() const { return runtime_.get(); }
 
@@ -188,6 +191,13 @@ class BaseProcJitWrapper {
   }
 };
 
+// Wraps the proc network of `wrapper` in the C API of
+// xls/jit/aot_proc_network_c_api.h, following its error convention. Used by
+// the generated wrappers to define their `create_network` factories.
+bool CreateAotProcNetwork(
+    absl::StatusOr<std::unique_ptr<BaseProcJitWrapper>> wrapper,
+    char** error_out, xls_aot_proc_network** network_out);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_PROC_BASE_JIT_WRAPPER_H_
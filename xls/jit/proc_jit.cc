@@ -144,6 +144,10 @@ class ProcJitContinuation : public ProcContinuation {
   // information.
   InstanceContext instance_context_;
 
+  // The nodes whose values the jitted code reports to observers. Owned by the
+  // ProcJit.
+  absl::Span<Node* const> observed_nodes_;
+
   RuntimeObserverShim observer_shim_;
 
   // if the code has observer callbacks compiled in.
@@ -163,8 +167,15 @@ ProcJitContinuation::ProcJitContinuation(ProcInstance* proc_instance,
       temp_buffer_(jit_func.CreateTempBuffer()),
       instance_context_(
           InstanceContext::CreateForProc(proc_instance, std::move(queues))),
+      observed_nodes_(jit_func.observed_nodes()),
       observer_shim_(this),
       has_observer_callbacks_(has_observer_callbacks) {
+  // State elements which the jitted code can update in place share a single
+  // buffer between the input and output sets. Swapping the sets keeps the
+  // buffer shared.
+  for (int64_t state_index : jit_func.shared_state_indices()) {
+    output_.pointers()[state_index] = input_.pointers()[state_index];
+  }
   // Write initial state value to the input_buffer.
   for (Param* state_param : proc()->StateParams()) {
     int64_t param_index = proc()->GetParamIndex(state_param).value();
@@ -178,7 +189,7 @@ ProcJitContinuation::ProcJitContinuation(ProcInstance* proc_instance,
 }
 
 void ProcJitContinuation::ClearObserver() {
-  instance_context_.observer = nullptr;
+  instance_context_.SetObserver(nullptr, /*observed_nodes=*/{}, jit_runtime_);
   ProcContinuation::ClearObserver();
 }
 
@@ -189,11 +200,9 @@ absl::Status ProcJitContinuation::SetObserver(EvaluationObserver* obs) {
   }
   XLS_RETURN_IF_ERROR(ProcContinuation::SetObserver(obs));
   auto runtime_obs = obs->AsRawObserver();
-  if (runtime_obs) {
-    instance_context_.observer = *runtime_obs;
-  } else {
-    instance_context_.observer = &observer_shim_;
-  }
+  instance_context_.SetObserver(
+      runtime_obs.has_value() ? *runtime_obs : &observer_shim_,
+      observed_nodes_, jit_runtime_);
   return absl::OkStatus();
 }
 
@@ -266,6 +275,9 @@ absl::Status ProcJitContinuation::NextTick() {
     // be unchanged by default.
     for (int64_t state_index = 0; state_index < proc()->GetStateElementCount();
          ++state_index) {
+      if (output_.pointers()[state_index] == input_.pointers()[state_index]) {
+        continue;
+      }
       memcpy(output_.pointers()[state_index], input_.pointers()[state_index],
              jit_runtime_->GetTypeByteSize(
                  proc()->GetStateElementType(state_index)));
@@ -279,8 +291,7 @@ absl::StatusOr<ChannelInstance*> GetChannelInstance(
     JitChannelQueueManager* queue_mgr) {
   if (proc_instance->path().has_value()) {
     // New-style proc-scoped channels.
-    return queue_mgr->elaboration().GetChannelInstance(channel_name,
-                                                       *proc_instance->path());
+    return proc_instance->GetChannelInstance(channel_name);
   }
   // Old-style global channels.
   XLS_ASSIGN_OR_RETURN(
@@ -352,9 +363,11 @@ absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
 std::unique_ptr<ProcContinuation> ProcJit::NewContinuation(
     ProcInstance* proc_instance) const {
   CHECK_EQ(proc_instance->proc(), proc());
-  return std::make_unique<ProcJitContinuation>(
+  auto continuation = std::make_unique<ProcJitContinuation>(
       proc_instance, jit_runtime_, channel_queues_.at(proc_instance),
       jitted_function_base_, has_observer_callbacks_);
+  continuation->instance_context()->max_trace_verbosity = max_trace_verbosity_;
+  return continuation;
 }
 
 absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
@@ -15,6 +15,8 @@
 #ifndef XLS_JIT_PROC_JIT_H_
 #define XLS_JIT_PROC_JIT_H_
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -61,6 +63,13 @@ class ProcJit : public ProcEvaluator {
 
   OrcJit& GetOrcJit() { return *orc_jit_; }
 
+  // Sets the maximum verbosity of the traces recorded by continuations created
+  // after this call. Traces with a greater verbosity are skipped by the jitted
+  // code.
+  void SetMaxTraceVerbosity(int64_t verbosity) {
+    max_trace_verbosity_ = verbosity;
+  }
+
  private:
   explicit ProcJit(Proc* proc, JitRuntime* jit_runtime,
                    JitChannelQueueManager* queue_mgr,
@@ -78,6 +87,7 @@ class ProcJit : public ProcEvaluator {
   // We need to have compiled in the callbacks in order to support the
   // Evaluation/RuntimeObserver apis.
   bool has_observer_callbacks_;
+  int64_t max_trace_verbosity_ = std::numeric_limits<int64_t>::max();
 
   // The set of channel queues used in each proc instance. The vector is in a
   // predetermined order assigned at JIT compile time. The JITted code looks for
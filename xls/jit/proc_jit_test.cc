@@ -16,13 +16,19 @@
 
 #include <memory>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/check.h"
+#include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
@@ -64,5 +70,32 @@ INSTANTIATE_TEST_SUITE_P(
                                            QueueManagerForPackage,
                                            /*supports_observers=*/true)));
 
+TEST(ProcJitTest, SharedStateIndices) {
+  Package package("my_package");
+  ProcBuilder pb("shared_state", &package);
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros, Value::UBitsArray({0, 0, 0, 0}, 32));
+  // Updated in place and written by a single next_value: shared.
+  BValue arr = pb.StateElement("arr", zeros);
+  // Read by an array_index which needn't be evaluated before the next_value:
+  // not shared.
+  BValue idx = pb.StateElement("idx", Value(UBits(0, 32)));
+  // Updated in place but written conditionally: not shared.
+  BValue cond_arr = pb.StateElement("cond_arr", zeros);
+  // Written conditionally but never updated in place: shared.
+  BValue counter = pb.StateElement("counter", Value(UBits(0, 32)));
+  BValue element = pb.ArrayIndex(arr, {idx});
+  pb.Next(arr, pb.ArrayUpdate(arr, pb.Add(element, idx), {idx}));
+  pb.Next(idx, pb.Add(idx, pb.Literal(UBits(1, 32))));
+  BValue pred = pb.Eq(element, pb.Literal(UBits(0, 32)));
+  pb.Next(cond_arr, pb.ArrayUpdate(cond_arr, idx, {idx}), pred);
+  pb.Next(counter, pb.Add(counter, pb.Literal(UBits(1, 32))), pred);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto orc_jit, OrcJit::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(JittedFunctionBase jit,
+                           JittedFunctionBase::Build(proc, *orc_jit));
+  EXPECT_THAT(jit.shared_state_indices(), testing::ElementsAre(0, 3));
+}
+
 }  // namespace
 }  // namespace xls
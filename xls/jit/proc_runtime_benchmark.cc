@@ -0,0 +1,290 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/math_util.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/modules/aes/aes_test_common.h"
+#include "xls/modules/zstd/data_generator.h"
+#include "external/zstd/lib/zstd.h"
+
+namespace xls {
+namespace {
+
+// Measures the throughput of the proc networks in xls/modules on each proc
+// runtime. Every benchmark feeds a fixed corpus to the network and ticks it
+// until all outputs are produced, reporting the payload processed per second,
+// ticks per second and the time taken to create the runtime, which for the JIT
+// backends is dominated by compilation.
+
+enum class Backend : int64_t {
+  kInterpreter,
+  kJit,
+  kParallelJit,
+};
+
+std::string_view BackendName(Backend backend) {
+  switch (backend) {
+    case Backend::kInterpreter:
+      return "interpreter";
+    case Backend::kJit:
+      return "jit";
+    case Backend::kParallelJit:
+      return "parallel_jit";
+  }
+  LOG(FATAL) << "Invalid backend: " << static_cast<int64_t>(backend);
+}
+
+std::unique_ptr<ProcRuntime> CreateRuntime(Package* package,
+                                           Backend backend) {
+  switch (backend) {
+    case Backend::kInterpreter:
+      return CreateInterpreterSerialProcRuntime(package).value();
+    case Backend::kJit:
+      return CreateJitSerialProcRuntime(package).value();
+    case Backend::kParallelJit:
+      return CreateJitParallelProcRuntime(package).value();
+  }
+  LOG(FATAL) << "Invalid backend: " << static_cast<int64_t>(backend);
+}
+
+// A fixed corpus of inputs for a proc network and the outputs it produces.
+struct Workload {
+  std::string ir_path;
+  // Values written to each input channel, by channel name.
+  std::vector<std::pair<std::string, std::vector<Value>>> inputs;
+  std::string output_channel;
+  int64_t output_count = 0;
+  // Size of the payload, for reporting throughput.
+  int64_t byte_count = 0;
+  // Whether to tick the network once after writing each input rather than
+  // writing all inputs up front, as the zstd decoder tests do.
+  bool tick_per_input = false;
+};
+
+constexpr int64_t kMaxTicks = int64_t{1} << 24;
+
+void BM_Workload(benchmark::State& state, const Workload& workload) {
+  Backend backend = static_cast<Backend>(state.range(0));
+  std::filesystem::path path = GetXlsRunfilePath(workload.ir_path).value();
+  std::unique_ptr<Package> package =
+      Parser::ParsePackage(GetFileContents(path).value()).value();
+
+  absl::Time start = absl::Now();
+  std::unique_ptr<ProcRuntime> runtime = CreateRuntime(package.get(), backend);
+  absl::Duration compile_time = absl::Now() - start;
+
+  std::vector<std::pair<ChannelQueue*, const std::vector<Value>*>> inputs;
+  for (const auto& [name, values] : workload.inputs) {
+    inputs.push_back(
+        {runtime->queue_manager().GetQueueByName(name).value(), &values});
+  }
+  Channel* output_channel =
+      package->GetChannel(workload.output_channel).value();
+  ChannelQueue& output_queue =
+      runtime->queue_manager().GetQueue(output_channel);
+
+  int64_t ticks = 0;
+  for (auto _ : state) {
+    runtime->ResetState();
+    for (const auto& [queue, values] : inputs) {
+      for (const Value& value : *values) {
+        CHECK_OK(queue->Write(value));
+        if (workload.tick_per_input) {
+          CHECK_OK(runtime->Tick());
+          ++ticks;
+        }
+      }
+    }
+    ticks += runtime
+                 ->TickUntilOutput({{output_channel, workload.output_count}},
+                                   kMaxTicks)
+                 .value();
+    while (output_queue.Read().has_value()) {
+    }
+  }
+
+  state.SetLabel(std::string(BackendName(backend)));
+  state.SetBytesProcessed(state.iterations() * workload.byte_count);
+  state.counters["ticks"] = benchmark::Counter(static_cast<double>(ticks),
+                                               benchmark::Counter::kIsRate);
+  state.counters["compile_ms"] = absl::ToDoubleMilliseconds(compile_time);
+}
+
+// Upper bound on the decompressed size of the generated frames, which have a
+// content size of at most 2^14 bytes.
+constexpr int64_t kMaxZstdFrameBytes = int64_t{1} << 15;
+constexpr int kZstdFramesPerBlockType = 4;
+
+Workload MakeZstdWorkload() {
+  Workload workload{.ir_path = "xls/modules/zstd/zstd_dec_test.ir",
+                    .output_channel = "zstd_dec__output_s",
+                    .tick_per_input = true};
+  std::vector<Value>& packets =
+      workload.inputs.emplace_back("zstd_dec__input_r", std::vector<Value>())
+          .second;
+  std::vector<uint8_t> decoded(kMaxZstdFrameBytes);
+  for (zstd::BlockType block_type :
+       {zstd::BlockType::RAW, zstd::BlockType::RLE}) {
+    for (int seed = 0; seed < kZstdFramesPerBlockType; ++seed) {
+      std::vector<uint8_t> frame =
+          zstd::GenerateFrame(seed, block_type).value();
+      size_t decoded_size = ZSTD_decompress(decoded.data(), decoded.size(),
+                                            frame.data(), frame.size());
+      CHECK(!ZSTD_isError(decoded_size)) << ZSTD_getErrorName(decoded_size);
+      // The decoder emits the frame in 64-bit words.
+      workload.output_count +=
+          CeilOfRatio(static_cast<int64_t>(decoded_size), int64_t{8});
+      workload.byte_count += decoded_size;
+      for (int64_t i = 0; i < frame.size(); i += 8) {
+        std::array<uint8_t, 8> packet = {};
+        std::copy(frame.begin() + i,
+                  frame.begin() + std::min<int64_t>(i + 8, frame.size()),
+                  packet.begin());
+        packets.push_back(Value(Bits::FromBytes(packet, 64)));
+      }
+    }
+  }
+  return workload;
+}
+
+constexpr int kAesGcmMessageCount = 4;
+constexpr int kAesGcmMessageBlocks = 64;
+constexpr int kAesGcmAadBlocks = 4;
+
+Workload MakeAesGcmWorkload() {
+  Workload workload{.ir_path = "xls/modules/aes/aes_gcm.ir",
+                    .output_channel = "aes_gcm__data_s"};
+  std::vector<Value>& commands =
+      workload.inputs.emplace_back("aes_gcm__command_in", std::vector<Value>())
+          .second;
+  std::vector<Value>& blocks =
+      workload.inputs.emplace_back("aes_gcm__data_r", std::vector<Value>())
+          .second;
+  std::mt19937_64 bitgen(0);
+  auto random_bytes = [&](auto& bytes) {
+    for (uint8_t& byte : bytes) {
+      byte = static_cast<uint8_t>(bitgen());
+    }
+  };
+  for (int i = 0; i < kAesGcmMessageCount; ++i) {
+    aes::Key key;
+    random_bytes(key);
+    aes::InitVector iv;
+    random_bytes(iv);
+    commands.push_back(Value::Tuple({
+        /*encrypt=*/Value(UBits(1, 1)),
+        /*msg_blocks=*/Value(UBits(kAesGcmMessageBlocks, 32)),
+        /*aad_blocks=*/Value(UBits(kAesGcmAadBlocks, 32)),
+        aes::KeyToValue(key).value(),
+        /*key_width=*/Value(UBits(/*256-bit=*/2, 2)),
+        aes::InitVectorToValue(iv),
+    }));
+    for (int j = 0; j < kAesGcmAadBlocks + kAesGcmMessageBlocks; ++j) {
+      aes::Block block;
+      random_bytes(block);
+      blocks.push_back(aes::BlockToValue(block).value());
+    }
+    // The ciphertext is followed by the authentication tag.
+    workload.output_count += kAesGcmMessageBlocks + 1;
+    workload.byte_count += kAesGcmMessageBlocks * aes::kBlockBytes;
+  }
+  return workload;
+}
+
+constexpr int kRleSymbolCount = 4096;
+constexpr int kRleMaxRunLength = 8;
+// The largest count the encoder emits for a single pair.
+constexpr int kRleMaxCount = 3;
+
+Workload MakeRleWorkload() {
+  Workload workload{.ir_path = "xls/modules/rle/rle_enc.ir",
+                    .output_channel = "rle_enc__output_s"};
+  std::vector<Value>& symbols =
+      workload.inputs.emplace_back("rle_enc__input_r", std::vector<Value>())
+          .second;
+  std::mt19937_64 bitgen(0);
+  uint32_t symbol = 0;
+  while (symbols.size() < kRleSymbolCount) {
+    // Each run differs from the previous one so it starts a new pair.
+    symbol += 1 + bitgen() % 16;
+    int64_t run_length = std::min<int64_t>(1 + bitgen() % kRleMaxRunLength,
+                                           kRleSymbolCount - symbols.size());
+    for (int64_t i = 0; i < run_length; ++i) {
+      bool last = symbols.size() + 1 == kRleSymbolCount;
+      symbols.push_back(
+          Value::Tuple({Value(UBits(symbol, 32)), Value(UBits(last, 1))}));
+    }
+    workload.output_count += CeilOfRatio(run_length, int64_t{kRleMaxCount});
+  }
+  workload.byte_count = kRleSymbolCount * sizeof(uint32_t);
+  return workload;
+}
+
+void BM_ZstdDecoder(benchmark::State& state) {
+  static const Workload* workload = new Workload(MakeZstdWorkload());
+  BM_Workload(state, *workload);
+}
+
+void BM_AesGcm(benchmark::State& state) {
+  static const Workload* workload = new Workload(MakeAesGcmWorkload());
+  BM_Workload(state, *workload);
+}
+
+void BM_RleEncoder(benchmark::State& state) {
+  static const Workload* workload = new Workload(MakeRleWorkload());
+  BM_Workload(state, *workload);
+}
+
+void AllBackends(benchmark::internal::Benchmark* b) {
+  for (Backend backend :
+       {Backend::kInterpreter, Backend::kJit, Backend::kParallelJit}) {
+    b->Arg(static_cast<int64_t>(backend));
+  }
+  b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_ZstdDecoder)->Apply(AllBackends);
+BENCHMARK(BM_AesGcm)->Apply(AllBackends);
+BENCHMARK(BM_RleEncoder)->Apply(AllBackends);
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/random_native_value.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+uint64_t RotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// Returns the next value of a splitmix64 sequence, used to expand the seed
+// into the xoshiro256** state.
+uint64_t SplitMix64(uint64_t& x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+}  // namespace
+
+RandomNativeValueGenerator::RandomNativeValueGenerator(const TypeLayout& layout,
+                                                       uint64_t seed)
+    : size_(layout.size()), mask_((layout.size() + 7) / 8, 0) {
+  std::vector<uint8_t> mask = layout.mask();
+  std::memcpy(mask_.data(), mask.data(), mask.size());
+  for (uint64_t& s : state_) {
+    s = SplitMix64(seed);
+  }
+}
+
+uint64_t RandomNativeValueGenerator::Next() {
+  uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+  uint64_t t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = RotateLeft(state_[3], 45);
+  return result;
+}
+
+void RandomNativeValueGenerator::Generate(uint8_t* buffer) {
+  // The mask is in the byte order of the buffer, so masking whole words is
+  // independent of endianness.
+  for (int64_t i = 0; i < mask_.size(); ++i) {
+    uint64_t word = Next() & mask_[i];
+    std::memcpy(buffer + i * 8, &word,
+                std::min<int64_t>(8, size_ - i * 8));
+  }
+}
+
+void RandomNativeValueGenerator::GenerateBatch(int64_t count, int64_t stride,
+                                               uint8_t* buffer) {
+  CHECK_GE(stride, size_);
+  for (int64_t i = 0; i < count; ++i) {
+    Generate(buffer + i * stride);
+  }
+}
+
+}  // namespace xls
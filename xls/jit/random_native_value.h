@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_RANDOM_NATIVE_VALUE_H_
+#define XLS_JIT_RANDOM_NATIVE_VALUE_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// Generates values of a type with random uniformly distributed bits directly
+// in the native layout used by the JIT, without constructing Value objects.
+//
+// The buffer is filled 64 bits at a time from a xoshiro256** generator (a
+// fast, non-cryptographic PRNG) and masked with the layout's mask, so the
+// padding bytes and the bits above the width of each leaf are zero as the JIT
+// requires. The values are not the same as those RandomValue produces for an
+// equal seed.
+class RandomNativeValueGenerator {
+ public:
+  RandomNativeValueGenerator(const TypeLayout& layout, uint64_t seed);
+
+  // Writes a random value to `buffer`, which must have room for at least
+  // `size()` bytes.
+  void Generate(uint8_t* buffer);
+
+  // Writes `count` random values to `buffer`, the i-th starting at byte
+  // `i * stride`. `stride` must be at least `size()`.
+  void GenerateBatch(int64_t count, int64_t stride, uint8_t* buffer);
+
+  // Returns the number of bytes of a generated value.
+  int64_t size() const { return size_; }
+
+ private:
+  uint64_t Next();
+
+  int64_t size_;
+  // The layout's mask as 64-bit words, the last padded with zeros.
+  std::vector<uint64_t> mask_;
+  std::array<uint64_t, 4> state_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_RANDOM_NATIVE_VALUE_H_
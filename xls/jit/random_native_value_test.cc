@@ -0,0 +1,99 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/random_native_value.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+class RandomNativeValueTest : public IrTestBase {};
+
+TypeLayout CreateTypeLayout(Type* type) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(type);
+}
+
+TEST_F(RandomNativeValueTest, GeneratesValidNativeValues) {
+  auto package = CreatePackage();
+  for (const char* type_str :
+       {"()", "bits[1]", "bits[8]", "bits[42]", "bits[64]", "bits[1024]",
+        "bits[123][10]", "(bits[3], (), bits[5], token, bits[7])[2][3]"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    TypeLayout layout = CreateTypeLayout(type);
+    RandomNativeValueGenerator generator(layout, /*seed=*/42);
+    ASSERT_EQ(generator.size(), layout.size());
+    for (int64_t i = 0; i < 10; ++i) {
+      std::vector<uint8_t> buffer(layout.size(), 0xff);
+      generator.Generate(buffer.data());
+
+      // The padding is zero, so the buffer is what converting its value back
+      // to the native layout writes.
+      Value value = layout.NativeLayoutToValue(buffer.data());
+      std::vector<uint8_t> expected(layout.size(), 0xff);
+      layout.ValueToNativeLayout(value, expected.data());
+      EXPECT_EQ(buffer, expected) << type_str;
+    }
+  }
+}
+
+TEST_F(RandomNativeValueTest, SeedDeterminesValues) {
+  auto package = CreatePackage();
+  TypeLayout layout = CreateTypeLayout(package->GetBitsType(100));
+  auto generate = [&](uint64_t seed) {
+    RandomNativeValueGenerator generator(layout, seed);
+    std::vector<uint8_t> buffer(layout.size() * 4);
+    generator.GenerateBatch(4, layout.size(), buffer.data());
+    return buffer;
+  };
+  EXPECT_EQ(generate(1), generate(1));
+  EXPECT_NE(generate(1), generate(2));
+}
+
+TEST_F(RandomNativeValueTest, CoversAllValuesOfNarrowType) {
+  auto package = CreatePackage();
+  Type* type = package->GetBitsType(3);
+  TypeLayout layout = CreateTypeLayout(type);
+  RandomNativeValueGenerator generator(layout, /*seed=*/0);
+  absl::flat_hash_set<uint64_t> seen;
+  std::vector<uint8_t> buffer(layout.size());
+  for (int64_t i = 0; i < 1000; ++i) {
+    generator.Generate(buffer.data());
+    seen.insert(
+        layout.NativeLayoutToValue(buffer.data()).bits().ToUint64().value());
+  }
+  EXPECT_EQ(seen.size(), 8);
+}
+
+}  // namespace
+}  // namespace xls
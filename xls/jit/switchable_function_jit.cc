@@ -14,6 +14,7 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -56,7 +58,22 @@ SwitchableFunctionJit::CreateJit(Function* xls_function, int64_t opt_level,
       FunctionJit::Create(xls_function, opt_level,
                           /*include_observer_callbacks=*/false, observer));
   return std::unique_ptr<SwitchableFunctionJit>(new SwitchableFunctionJit(
-      xls_function, /*use_jit=*/true, std::move(jit)));
+      xls_function, /*use_jit=*/true, std::move(jit), opt_level));
+}
+
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateTieredJit(Function* xls_function,
+                                       const TieredJitOptions& options,
+                                       JitObserver* observer) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SwitchableFunctionJit> jit,
+                       CreateJit(xls_function, options.initial_opt_level,
+                                 observer));
+  if (options.optimized_opt_level > options.initial_opt_level) {
+    jit->tiering_ = std::make_unique<Tiering>();
+    jit->tiering_->options = options;
+    jit->tiering_->observer = observer;
+  }
+  return jit;
 }
 
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
@@ -79,6 +96,10 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kTieredJit:
+      return SwitchableFunctionJit::CreateTieredJit(
+          xls_function, TieredJitOptions{.optimized_opt_level = opt_level},
+          observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
@@ -129,9 +150,45 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 }
 }  // namespace
 
+void SwitchableFunctionJit::UpdateTier() {
+  if (tiering_ == nullptr) {
+    return;
+  }
+  Tiering& tiering = *tiering_;
+  if (tiering.thread == nullptr) {
+    if (++tiering.run_count >= tiering.options.recompile_threshold) {
+      VLOG(1) << "Recompiling " << xls_function_->name() << " at opt level "
+              << tiering.options.optimized_opt_level << " after "
+              << tiering.run_count << " runs";
+      tiering.thread = std::make_unique<Thread>(
+          [&tiering, function = xls_function_]() {
+            tiering.optimized = FunctionJit::Create(
+                function, tiering.options.optimized_opt_level,
+                /*include_observer_callbacks=*/false, tiering.observer);
+            tiering.optimized_ready.store(true, std::memory_order_release);
+          });
+    }
+    return;
+  }
+  if (!tiering.optimized_ready.load(std::memory_order_acquire)) {
+    return;
+  }
+  tiering.thread->Join();
+  if (tiering.optimized.ok()) {
+    function_jit_ = *std::move(tiering.optimized);
+    opt_level_ = tiering.options.optimized_opt_level;
+  } else {
+    LOG(WARNING) << "Unable to recompile " << xls_function_->name()
+                 << ", continuing at opt level " << opt_level_ << ": "
+                 << tiering.optimized.status();
+  }
+  tiering_.reset();
+}
+
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
   if (use_jit_) {
+    UpdateTier();
     return function_jit_->Run(args);
   }
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(args, function()));
@@ -141,6 +198,7 @@ absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
   if (use_jit_) {
+    UpdateTier();
     return function_jit_->Run(kwargs);
   }
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(kwargs, function()));
@@ -15,6 +15,7 @@
 #ifndef XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 #define XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -36,6 +38,20 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // JIT compile quickly first and recompile with full optimization once the
+  // function has been run often enough. See TieredJitOptions.
+  kTieredJit,
+};
+
+// Options for tiered compilation. The function is first compiled at
+// `initial_opt_level` so it can be run right away. Once it has been run
+// `recompile_threshold` times it is recompiled at `optimized_opt_level` on a
+// background thread and subsequent runs switch to the optimized code as soon
+// as it is ready.
+struct TieredJitOptions {
+  int64_t initial_opt_level = 1;
+  int64_t optimized_opt_level = 3;
+  int64_t recompile_threshold = 1000;
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -51,6 +67,12 @@ class SwitchableFunctionJit {
       JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
   CreateInterpreter(Function* xls_function);
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+  CreateTieredJit(Function* xls_function,
+                  const TieredJitOptions& options = TieredJitOptions(),
+                  JitObserver* observer = nullptr);
+  // For ExecutionType::kTieredJit `opt_level` is the level of the optimized
+  // tier.
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
@@ -67,6 +89,8 @@ class SwitchableFunctionJit {
   // Returns the function that the JIT executes.
   Function* function() { return xls_function_; }
 
+  // Returns the JIT currently being run. A tiered JIT replaces it when it
+  // switches to the optimized code.
   std::optional<FunctionJit*> function_jit() {
     if (use_jit_) {
       return function_jit_.get();
@@ -74,16 +98,46 @@ class SwitchableFunctionJit {
     return std::nullopt;
   }
 
+  // Returns the LLVM optimization level of the code currently being run, or
+  // std::nullopt if the interpreter is used.
+  std::optional<int64_t> opt_level() const {
+    if (use_jit_) {
+      return opt_level_;
+    }
+    return std::nullopt;
+  }
+
  private:
+  // State of tiered compilation until the optimized code is switched in.
+  struct Tiering {
+    TieredJitOptions options;
+    JitObserver* observer = nullptr;
+    int64_t run_count = 0;
+    // Set by the background thread once `optimized` holds its result.
+    std::atomic<bool> optimized_ready = false;
+    absl::StatusOr<std::unique_ptr<FunctionJit>> optimized;
+    // Declared last so it is joined before the fields it writes are
+    // destroyed.
+    std::unique_ptr<Thread> thread;
+  };
+
   explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
-                                 std::unique_ptr<FunctionJit>&& jit)
+                                 std::unique_ptr<FunctionJit>&& jit,
+                                 int64_t opt_level = 0)
       : xls_function_(xls_function),
         use_jit_(use_jit),
-        function_jit_(std::move(jit)) {}
+        function_jit_(std::move(jit)),
+        opt_level_(opt_level) {}
+
+  // Counts a run of a tiered JIT, starting the optimizing compile once the
+  // threshold is reached and switching to its result once it is done.
+  void UpdateTier();
 
   Function* xls_function_;
   bool use_jit_;
   std::unique_ptr<FunctionJit> function_jit_;
+  int64_t opt_level_;
+  std::unique_ptr<Tiering> tiering_;
 };
 }  // namespace xls
 
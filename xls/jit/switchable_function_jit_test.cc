@@ -14,10 +14,14 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
@@ -79,5 +83,50 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, TieredJitSwitchesToOptimizedCode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      SwitchableFunctionJit::CreateTieredJit(
+          f, TieredJitOptions{.initial_opt_level = 0,
+                              .optimized_opt_level = 3,
+                              .recompile_threshold = 5}));
+  EXPECT_EQ(runner->opt_level(), 0);
+  std::vector<Value> args = {Value(UBits(8, 8)), Value(UBits(4, 8))};
+  Value expected = Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))});
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+    EXPECT_EQ(result.value, expected);
+  }
+  EXPECT_EQ(runner->opt_level(), 0);
+
+  // The optimized code is compiled in the background and switched in by a
+  // later run.
+  absl::Time deadline = absl::Now() + absl::Minutes(1);
+  while (runner->opt_level() != 3 && absl::Now() < deadline) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+    EXPECT_EQ(result.value, expected);
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_EQ(runner->opt_level(), 3);
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+}
+
+TEST_F(SwitchableFunctionJitTest, TieredJitIsNotRecompiledBelowThreshold) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kTieredJit));
+  std::vector<Value> args = {Value(UBits(8, 8)), Value(UBits(4, 8))};
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(runner->Run(args).status());
+  }
+  EXPECT_EQ(runner->opt_level(), TieredJitOptions().initial_opt_level);
+}
+
 }  // namespace
 }  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -23,6 +24,7 @@
 
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -42,21 +44,55 @@ static bool IsLeafValue(const Value& value) {
   return value.IsBits() || value.IsToken();
 }
 
-static void LeafValueToNativeLayout(const Value& value,
-                                    const ElementLayout& element_layout,
-                                    uint8_t* buffer) {
-  uint8_t* element_buffer = buffer + element_layout.offset;
-  if (value.IsBits()) {
-    // Write the bytes from the Bits object into the buffer.
-    value.bits().ToBytes(
-        absl::MakeSpan(element_buffer, element_layout.data_size));
-    // Clear any padding bytes.
-    std::memset(element_buffer + element_layout.data_size, 0,
-                element_layout.padded_size - element_layout.data_size);
-    return;
+TypeLayout::TypeLayout(Type* type, int64_t size,
+                       absl::Span<const ElementLayout> elements)
+    : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
+  CHECK_EQ(elements.size(), type->leaf_count());
+  AddBuildSteps(type);
+  for (const ElementLayout& element : elements_) {
+    if (element.padded_size == element.data_size) {
+      continue;
+    }
+    int64_t offset = element.offset + element.data_size;
+    int64_t padding = element.padded_size - element.data_size;
+    if (!padding_runs_.empty() &&
+        padding_runs_.back().offset + padding_runs_.back().size == offset) {
+      padding_runs_.back().size += padding;
+    } else {
+      padding_runs_.push_back(PaddingRun{.offset = offset, .size = padding});
+    }
+  }
+}
+
+void TypeLayout::AddBuildSteps(Type* type) {
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      build_steps_.push_back(BuildStep{
+          .kind = BuildStep::kBits, .count = type->AsBitsOrDie()->bit_count()});
+      return;
+    case TypeKind::kToken:
+      build_steps_.push_back(BuildStep{.kind = BuildStep::kToken, .count = 0});
+      return;
+    case TypeKind::kTuple: {
+      TupleType* tuple_type = type->AsTupleOrDie();
+      for (Type* element_type : tuple_type->element_types()) {
+        AddBuildSteps(element_type);
+      }
+      build_steps_.push_back(
+          BuildStep{.kind = BuildStep::kTuple, .count = tuple_type->size()});
+      return;
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        AddBuildSteps(array_type->element_type());
+      }
+      build_steps_.push_back(
+          BuildStep{.kind = BuildStep::kArray, .count = array_type->size()});
+      return;
+    }
   }
-  CHECK(value.IsToken());
-  std::memset(buffer, 0, element_layout.padded_size);
+  LOG(FATAL) << "Unsupported type: " << type->ToString();
 }
 
 void TypeLayout::ValueToNativeLayout(const Value& value,
@@ -64,8 +100,21 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
   DCHECK(ValueConformsToType(value, type())) << absl::StreamFormat(
       "Value `%s` is not of type `%s`", value.ToString(), type()->ToString());
 
+  // Clear the padding bytes. The leaves only write their data bytes below.
+  for (const PaddingRun& run : padding_runs_) {
+    std::memset(buffer + run.offset, 0, run.size);
+  }
+  auto write_leaf = [&](const Value& leaf, const ElementLayout& layout) {
+    // Tokens contain no data.
+    if (leaf.IsBits()) {
+      leaf.bits().ToBytes(
+          absl::MakeSpan(buffer + layout.offset, layout.data_size));
+    }
+  };
+
   if (IsLeafValue(value)) {
-    return LeafValueToNativeLayout(value, elements_.front(), buffer);
+    write_leaf(value, elements_.front());
+    return;
   }
 
   // At this point, `value` is a compound type. To avoid the expense of
@@ -97,7 +146,7 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
     }
     const Value& value_element = frame.value->element(frame.index);
     if (IsLeafValue(value_element)) {
-      LeafValueToNativeLayout(value_element, elements_.at(leaf_index), buffer);
+      write_leaf(value_element, elements_[leaf_index]);
       ++frame.index;
       ++leaf_index;
     } else {
@@ -108,47 +157,41 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
   CHECK_EQ(leaf_index, elements_.size());
 }
 
-Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
-                                              const uint8_t* buffer,
-                                              int64_t* leaf_index) const {
-  if (element_type->IsBits()) {
-    int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
-    const ElementLayout& element_layout = elements_.at(*leaf_index);
-    ++(*leaf_index);
-    return Value(
-        Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
-                                       CeilOfRatio(bit_count, int64_t{8})),
-                        bit_count));
-  }
-  if (element_type->IsToken()) {
-    ++(*leaf_index);
-    return Value::Token();
-  }
-  if (element_type->IsTuple()) {
-    TupleType* tuple_type = element_type->AsTupleOrDie();
-    std::vector<Value> elements;
-    elements.reserve(tuple_type->size());
-    for (int64_t i = 0; i < tuple_type->size(); ++i) {
-      elements.push_back(NativeLayoutToValueInternal(
-          tuple_type->element_type(i), buffer, leaf_index));
-    }
-    return Value::TupleOwned(std::move(elements));
-  }
-
-  CHECK(element_type->IsArray());
-  ArrayType* array_type = element_type->AsArrayOrDie();
-  std::vector<Value> elements;
-  elements.reserve(array_type->size());
-  for (int64_t i = 0; i < array_type->size(); ++i) {
-    elements.push_back(NativeLayoutToValueInternal(array_type->element_type(),
-                                                   buffer, leaf_index));
-  }
-  return Value::ArrayOwned(std::move(elements));
-}
-
 Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
+  // Run the build steps, keeping the values produced but not yet consumed by
+  // an aggregate on a stack.
+  std::vector<Value> stack;
   int64_t leaf_index = 0;
-  return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
+  auto pop_elements = [&](int64_t count) {
+    std::vector<Value> elements(std::make_move_iterator(stack.end() - count),
+                                std::make_move_iterator(stack.end()));
+    stack.resize(stack.size() - count);
+    return elements;
+  };
+  for (const BuildStep& step : build_steps_) {
+    switch (step.kind) {
+      case BuildStep::kBits: {
+        const ElementLayout& element_layout = elements_[leaf_index++];
+        stack.push_back(Value(Bits::FromBytes(
+            absl::MakeSpan(buffer + element_layout.offset,
+                           CeilOfRatio(step.count, int64_t{8})),
+            step.count)));
+        break;
+      }
+      case BuildStep::kToken:
+        ++leaf_index;
+        stack.push_back(Value::Token());
+        break;
+      case BuildStep::kTuple:
+        stack.push_back(Value::TupleOwned(pop_elements(step.count)));
+        break;
+      case BuildStep::kArray:
+        stack.push_back(Value::ArrayOwned(pop_elements(step.count)));
+        break;
+    }
+  }
+  CHECK_EQ(stack.size(), 1);
+  return std::move(stack.front());
 }
 
 std::string TypeLayout::ToString() const {
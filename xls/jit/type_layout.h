@@ -84,13 +84,15 @@ struct ElementLayout {
 //
 // TODO(https://github.com/google/xls/issues/760): Reduce the redundancy in the
 // array element layouts.
+//
+// The conversions to and from the native layout are precompiled when the
+// TypeLayout is constructed into a flat program, so they don't walk the type
+// tree. A TypeLayout should be created once per type and reused, e.g. for
+// every value sent on a channel.
 class TypeLayout {
  public:
   explicit TypeLayout(Type* type, int64_t size,
-                      absl::Span<const ElementLayout> elements)
-      : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
-    CHECK_EQ(elements.size(), type->leaf_count());
-  }
+                      absl::Span<const ElementLayout> elements);
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
   static absl::StatusOr<TypeLayout> FromProto(const TypeLayoutProto& proto,
@@ -119,12 +121,31 @@ class TypeLayout {
   std::string ToString() const;
 
  private:
-  Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
-                                    int64_t* leaf_index) const;
+  // Appends the steps building a value of type `type` to `build_steps_`.
+  void AddBuildSteps(Type* type);
+
+  // One step of the program which builds a Value from the native layout. The
+  // steps produce the leaves and aggregates of the type in post-order.
+  struct BuildStep {
+    enum Kind : uint8_t { kBits, kToken, kTuple, kArray };
+    Kind kind;
+    // The bit count of a kBits step, or the number of elements of a kTuple or
+    // kArray step, which are those most recently produced.
+    int64_t count;
+  };
+
+  // A run of padding bytes which must be zeroed when writing a value.
+  struct PaddingRun {
+    int64_t offset;
+    int64_t size;
+  };
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+  std::vector<BuildStep> build_steps_;
+  // The padding bytes of all the elements, with adjacent runs merged.
+  std::vector<PaddingRun> padding_runs_;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
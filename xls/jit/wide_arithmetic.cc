@@ -0,0 +1,137 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/wide_arithmetic.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/numeric/int128.h"
+#include "absl/types/span.h"
+
+namespace xls {
+namespace {
+
+// Returns the number of limbs of `value` below its most significant nonzero
+// limb, plus one.
+int64_t SignificantLimbs(absl::Span<const uint64_t> value) {
+  int64_t count = value.size();
+  while (count > 0 && value[count - 1] == 0) {
+    --count;
+  }
+  return count;
+}
+
+}  // namespace
+
+void WideUDivRem(absl::Span<const uint64_t> num,
+                 absl::Span<const uint64_t> denom,
+                 absl::Span<uint64_t> quotient,
+                 absl::Span<uint64_t> remainder) {
+  DCHECK_EQ(num.size(), denom.size());
+  DCHECK_EQ(num.size(), quotient.size());
+  DCHECK_EQ(num.size(), remainder.size());
+  std::fill(quotient.begin(), quotient.end(), 0);
+  std::fill(remainder.begin(), remainder.end(), 0);
+  int64_t m = SignificantLimbs(num);
+  int64_t n = SignificantLimbs(denom);
+  CHECK_GT(n, 0) << "Division by zero";
+  if (m < n) {
+    std::copy(num.begin(), num.end(), remainder.begin());
+    return;
+  }
+
+  if (n == 1) {
+    uint64_t r = 0;
+    for (int64_t i = m - 1; i >= 0; --i) {
+      absl::uint128 cur = absl::MakeUint128(r, num[i]);
+      quotient[i] = absl::Uint128Low64(cur / denom[0]);
+      r = absl::Uint128Low64(cur % denom[0]);
+    }
+    remainder[0] = r;
+    return;
+  }
+
+  // Normalize so the top limb of the divisor has its high bit set, which
+  // bounds the error of each estimated quotient limb by two.
+  int shift = std::countl_zero(denom[n - 1]);
+  auto shift_left = [shift](uint64_t hi, uint64_t lo) {
+    return shift == 0 ? hi : (hi << shift) | (lo >> (64 - shift));
+  };
+  absl::InlinedVector<uint64_t, 16> vn(n);
+  for (int64_t i = n - 1; i > 0; --i) {
+    vn[i] = shift_left(denom[i], denom[i - 1]);
+  }
+  vn[0] = denom[0] << shift;
+  absl::InlinedVector<uint64_t, 17> un(m + 1);
+  un[m] = shift == 0 ? 0 : num[m - 1] >> (64 - shift);
+  for (int64_t i = m - 1; i > 0; --i) {
+    un[i] = shift_left(num[i], num[i - 1]);
+  }
+  un[0] = num[0] << shift;
+
+  const absl::uint128 kBase = absl::MakeUint128(1, 0);
+  for (int64_t j = m - n; j >= 0; --j) {
+    absl::uint128 top = absl::MakeUint128(un[j + n], un[j + n - 1]);
+    absl::uint128 qhat = top / vn[n - 1];
+    absl::uint128 rhat = top % vn[n - 1];
+    while (qhat >= kBase ||
+           qhat * vn[n - 2] > absl::MakeUint128(absl::Uint128Low64(rhat),
+                                                un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if (rhat >= kBase) {
+        break;
+      }
+    }
+
+    // Subtract qhat * vn from the current window of un.
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      absl::uint128 product = qhat * vn[i] + carry;
+      carry = absl::Uint128High64(product);
+      absl::uint128 diff = absl::uint128(un[i + j]) -
+                           absl::Uint128Low64(product) - borrow;
+      un[i + j] = absl::Uint128Low64(diff);
+      borrow = absl::Uint128High64(diff) == 0 ? 0 : 1;
+    }
+    absl::uint128 diff = absl::uint128(un[j + n]) - carry - borrow;
+    un[j + n] = absl::Uint128Low64(diff);
+    quotient[j] = absl::Uint128Low64(qhat);
+
+    if (absl::Uint128High64(diff) != 0) {
+      // The estimate was one too large; add the divisor back.
+      --quotient[j];
+      carry = 0;
+      for (int64_t i = 0; i < n; ++i) {
+        absl::uint128 sum = absl::uint128(un[i + j]) + vn[i] + carry;
+        un[i + j] = absl::Uint128Low64(sum);
+        carry = absl::Uint128High64(sum);
+      }
+      un[j + n] += carry;
+    }
+  }
+
+  // Unnormalize the remainder.
+  for (int64_t i = 0; i < n; ++i) {
+    remainder[i] = shift == 0 ? un[i]
+                              : (un[i] >> shift) | (un[i + 1] << (64 - shift));
+  }
+}
+
+}  // namespace xls
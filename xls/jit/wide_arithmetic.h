@@ -0,0 +1,39 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_WIDE_ARITHMETIC_H_
+#define XLS_JIT_WIDE_ARITHMETIC_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+// Runtime support for arithmetic which the JIT does not lower to LLVM's
+// integer instructions because LLVM expands them poorly at large widths.
+// Integers are spans of little-endian 64-bit limbs.
+
+// Sets `quotient` and `remainder` to the unsigned quotient and remainder of
+// `num` divided by `denom`, which must be nonzero. All spans have the same
+// size. Uses Knuth's algorithm D, so the cost is quadratic in the number of
+// significant limbs rather than linear in the number of bits.
+void WideUDivRem(absl::Span<const uint64_t> num,
+                 absl::Span<const uint64_t> denom,
+                 absl::Span<uint64_t> quotient,
+                 absl::Span<uint64_t> remainder);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_WIDE_ARITHMETIC_H_
@@ -0,0 +1,99 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/wide_arithmetic.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+
+namespace xls {
+namespace {
+
+Bits LimbsToBits(absl::Span<const uint64_t> limbs) {
+  return Bits::FromBytes(
+      absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(limbs.data()),
+                          limbs.size() * sizeof(uint64_t)),
+      limbs.size() * 64);
+}
+
+// Returns `limb_count` limbs of which the low `significant_limbs` are random,
+// biased towards all-zero and all-one limbs which exercise the corrections of
+// the quotient estimates.
+std::vector<uint64_t> RandomLimbs(int64_t limb_count,
+                                  int64_t significant_limbs,
+                                  std::mt19937_64& rng) {
+  std::vector<uint64_t> limbs(limb_count, 0);
+  for (int64_t i = 0; i < significant_limbs; ++i) {
+    switch (rng() % 4) {
+      case 0:
+        limbs[i] = 0;
+        break;
+      case 1:
+        limbs[i] = ~uint64_t{0};
+        break;
+      default:
+        limbs[i] = rng();
+        break;
+    }
+  }
+  if (significant_limbs > 0 && limbs[significant_limbs - 1] == 0) {
+    limbs[significant_limbs - 1] = 1;
+  }
+  return limbs;
+}
+
+void ExpectUDivRemMatchesBitsOps(absl::Span<const uint64_t> num,
+                                 absl::Span<const uint64_t> denom) {
+  std::vector<uint64_t> quotient(num.size());
+  std::vector<uint64_t> remainder(num.size());
+  WideUDivRem(num, denom, absl::MakeSpan(quotient),
+              absl::MakeSpan(remainder));
+  Bits num_bits = LimbsToBits(num);
+  Bits denom_bits = LimbsToBits(denom);
+  EXPECT_EQ(LimbsToBits(quotient), bits_ops::UDiv(num_bits, denom_bits))
+      << num_bits.ToDebugString() << " / " << denom_bits.ToDebugString();
+  EXPECT_EQ(LimbsToBits(remainder), bits_ops::UMod(num_bits, denom_bits))
+      << num_bits.ToDebugString() << " % " << denom_bits.ToDebugString();
+}
+
+TEST(WideArithmeticTest, UDivRemSmallCases) {
+  ExpectUDivRemMatchesBitsOps({7, 0, 0}, {2, 0, 0});
+  ExpectUDivRemMatchesBitsOps({0, 0, 1}, {3, 0, 0});
+  ExpectUDivRemMatchesBitsOps({0, 1, 0}, {0, 0, 1});
+  ExpectUDivRemMatchesBitsOps({~uint64_t{0}, ~uint64_t{0}, ~uint64_t{0}},
+                              {~uint64_t{0}, ~uint64_t{0}, 0});
+  ExpectUDivRemMatchesBitsOps({0, 0, uint64_t{1} << 63},
+                              {1, uint64_t{1} << 63, 0});
+}
+
+TEST(WideArithmeticTest, UDivRemRandom) {
+  std::mt19937_64 rng(0);
+  for (int64_t limb_count : {2, 3, 4, 8, 16}) {
+    for (int64_t i = 0; i < 1000; ++i) {
+      int64_t num_limbs = 1 + rng() % limb_count;
+      int64_t denom_limbs = 1 + rng() % limb_count;
+      ExpectUDivRemMatchesBitsOps(RandomLimbs(limb_count, num_limbs, rng),
+                                  RandomLimbs(limb_count, denom_limbs, rng));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
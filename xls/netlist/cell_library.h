@@ -31,6 +31,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.pb.h"
 
 namespace xls {
@@ -190,7 +191,13 @@ class AbstractCellLibraryEntry {
         input_names_(input_names.begin(), input_names.end()),
         output_pin_to_function_(output_pin_to_function),
         state_table_(state_table),
-        clock_name_(clock_name) {}
+        clock_name_(clock_name) {
+    for (const auto& [pin_name, function] : output_pin_to_function_) {
+      compiled_functions_.emplace(
+          pin_name,
+          function::CompiledFunction::Compile(function, input_names_));
+    }
+  }
 
   CellKind kind() const { return kind_; }
   const std::string& name() const { return name_; }
@@ -203,6 +210,19 @@ class AbstractCellLibraryEntry {
   }
   std::optional<std::string> clock_name() const { return clock_name_; }
 
+  // Returns the function of the given output pin, compiled once when the entry
+  // is created; its leading operands are this entry's inputs, in order.
+  absl::StatusOr<const function::CompiledFunction*> GetCompiledFunction(
+      std::string_view pin_name) const {
+    auto it = compiled_functions_.find(pin_name);
+    if (it == compiled_functions_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("No output pin ", pin_name, " in cell ", name_));
+    }
+    XLS_RETURN_IF_ERROR(it->second.status());
+    return &it->second.value();
+  }
+
   absl::StatusOr<CellLibraryEntryProto> ToProto() const;
 
  private:
@@ -212,6 +232,8 @@ class AbstractCellLibraryEntry {
   OutputPinToFunction output_pin_to_function_;
   std::optional<AbstractStateTable<EvalT>> state_table_;
   std::optional<std::string> clock_name_;
+  absl::flat_hash_map<std::string, absl::StatusOr<function::CompiledFunction>>
+      compiled_functions_;
 };
 
 using CellLibraryEntry = AbstractCellLibraryEntry<>;
@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/cell_library_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_extractor.h"
+#include "xls/netlist/lib_parser.h"
+#include "xls/netlist/netlist.pb.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Writes `entry` to `entry_path` atomically, so that concurrent readers never
+// observe a partially written entry.
+absl::Status StoreEntry(const std::filesystem::path& cache_dir,
+                        const std::filesystem::path& entry_path,
+                        const CellLibraryCacheEntryProto& entry) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(cache_dir));
+  return AtomicSetFileContents(entry_path, entry.SerializeAsString());
+}
+
+}  // namespace
+
+uint64_t HashLibertyContents(std::string_view contents) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : contents) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+std::filesystem::path GetCellLibraryCachePath(
+    const std::filesystem::path& cache_dir, std::string_view liberty_contents) {
+  return cache_dir / absl::StrFormat("%016x.cell_library",
+                                     HashLibertyContents(liberty_contents));
+}
+
+absl::StatusOr<CellLibraryProto> LoadCellLibraryProto(
+    const std::filesystem::path& liberty_path,
+    const std::optional<std::filesystem::path>& cache_dir) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(liberty_path));
+  CellLibraryCacheEntryProto entry;
+  std::filesystem::path entry_path;
+  if (cache_dir.has_value()) {
+    entry_path = GetCellLibraryCachePath(*cache_dir, contents);
+    if (FileExists(entry_path).ok() &&
+        ParseProtobinFile(entry_path, &entry).ok() &&
+        entry.liberty_size() == contents.size() &&
+        entry.liberty_hash() == HashLibertyContents(contents)) {
+      return entry.library();
+    }
+    entry.Clear();
+    entry.set_liberty_size(contents.size());
+    entry.set_liberty_hash(HashLibertyContents(contents));
+  }
+
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromText(std::move(contents)));
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto library,
+                       function::ExtractFunctions(&stream));
+  if (cache_dir.has_value()) {
+    *entry.mutable_library() = library;
+    if (absl::Status status = StoreEntry(*cache_dir, entry_path, entry);
+        !status.ok()) {
+      LOG(WARNING) << "Unable to cache cell library for " << liberty_path
+                   << ": " << status;
+    }
+  }
+  return library;
+}
+
+absl::StatusOr<CellLibrary> LoadCellLibrary(
+    const std::filesystem::path& liberty_path,
+    const std::optional<std::filesystem::path>& cache_dir) {
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto,
+                       LoadCellLibraryProto(liberty_path, cache_dir));
+  return CellLibrary::FromProto(proto);
+}
+
+}  // namespace netlist
+}  // namespace xls
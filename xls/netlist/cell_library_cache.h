@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_CELL_LIBRARY_CACHE_H_
+#define XLS_NETLIST_CELL_LIBRARY_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/netlist.pb.h"
+
+namespace xls {
+namespace netlist {
+
+// Returns the 64-bit FNV-1a hash of `contents`, which (unlike absl::Hash) is
+// stable across processes.
+uint64_t HashLibertyContents(std::string_view contents);
+
+// Returns the path of the cache entry for a Liberty file with the given
+// contents.
+std::filesystem::path GetCellLibraryCachePath(
+    const std::filesystem::path& cache_dir, std::string_view liberty_contents);
+
+// Extracts the cell library from the Liberty file at `liberty_path`.
+//
+// If `cache_dir` is given, the extracted library (which holds only the cells,
+// pins and functions, a small fraction of a typical Liberty file) is stored
+// there in binary form, keyed on the hash of the Liberty file's contents.
+// Later loads of a file with the same contents read that entry instead of
+// parsing the file. Failing to write the cache is not an error.
+absl::StatusOr<CellLibraryProto> LoadCellLibraryProto(
+    const std::filesystem::path& liberty_path,
+    const std::optional<std::filesystem::path>& cache_dir = std::nullopt);
+
+// As above, but returns the CellLibrary built from the extracted proto.
+absl::StatusOr<CellLibrary> LoadCellLibrary(
+    const std::filesystem::path& liberty_path,
+    const std::optional<std::filesystem::path>& cache_dir = std::nullopt);
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_CELL_LIBRARY_CACHE_H_
@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/cell_library_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_replace.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/netlist.pb.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+constexpr std::string_view kLiberty = R"lib(
+library (test) {
+  cell (and2) {
+    area: 1.0;
+    pin (a) {
+      direction: input;
+    }
+    pin (b) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "(a * b)";
+    }
+  }
+}
+)lib";
+
+TEST(CellLibraryCacheTest, HashIsStable) {
+  EXPECT_EQ(HashLibertyContents(""), 0xcbf29ce484222325);
+  EXPECT_EQ(HashLibertyContents("a"), 0xaf63dc4c8601ec8c);
+  EXPECT_NE(HashLibertyContents("ab"), HashLibertyContents("ba"));
+}
+
+TEST(CellLibraryCacheTest, LoadWithoutCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path liberty_path = temp_dir.path() / "test.lib";
+  XLS_ASSERT_OK(SetFileContents(liberty_path, kLiberty));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           LoadCellLibraryProto(liberty_path));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).name(), "and2");
+  XLS_EXPECT_OK(LoadCellLibrary(liberty_path).status());
+}
+
+TEST(CellLibraryCacheTest, SecondLoadUsesCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path liberty_path = temp_dir.path() / "test.lib";
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  XLS_ASSERT_OK(SetFileContents(liberty_path, kLiberty));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto first,
+                           LoadCellLibraryProto(liberty_path, cache_dir));
+  std::filesystem::path entry_path =
+      GetCellLibraryCachePath(cache_dir, kLiberty);
+  XLS_ASSERT_OK(FileExists(entry_path));
+
+  // Replace the cached library with a recognizable one; an unchanged Liberty
+  // file must then be served from the cache.
+  CellLibraryCacheEntryProto entry;
+  XLS_ASSERT_OK(ParseProtobinFile(entry_path, &entry));
+  EXPECT_EQ(entry.liberty_size(), kLiberty.size());
+  EXPECT_EQ(entry.library().entries_size(), first.entries_size());
+  entry.mutable_library()->mutable_entries(0)->set_name("cached_and2");
+  XLS_ASSERT_OK(SetProtobinFile(entry_path, entry));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto second,
+                           LoadCellLibraryProto(liberty_path, cache_dir));
+  EXPECT_EQ(second.entries(0).name(), "cached_and2");
+
+  // Changing the Liberty file misses the cache.
+  std::string changed = absl::StrReplaceAll(kLiberty, {{"and2", "nand2"}});
+  XLS_ASSERT_OK(SetFileContents(liberty_path, changed));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto third,
+                           LoadCellLibraryProto(liberty_path, cache_dir));
+  EXPECT_EQ(third.entries(0).name(), "nand2");
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
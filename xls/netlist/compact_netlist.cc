@@ -0,0 +1,382 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compact_netlist.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace rtl {
+namespace {
+
+// Returns the heap memory held by a vector.
+template <typename T>
+int64_t VectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+// Returns the approximate heap memory held by a flat_hash_map.
+template <typename K, typename V>
+int64_t MapBytes(const absl::flat_hash_map<K, V>& map) {
+  return map.capacity() * (sizeof(std::pair<const K, V>) + 1);
+}
+
+}  // namespace
+
+StringPool::Id StringPool::Intern(std::string_view str) {
+  auto it = ids_.find(str);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+  Id id = strings_.size();
+  strings_.emplace_back(str);
+  ids_.emplace(strings_.back(), id);
+  return id;
+}
+
+std::optional<StringPool::Id> StringPool::Find(std::string_view str) const {
+  auto it = ids_.find(str);
+  if (it == ids_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+int64_t StringPool::GetMemoryUsage() const {
+  int64_t bytes = MapBytes(ids_);
+  for (const std::string& str : strings_) {
+    bytes += sizeof(std::string);
+    // Short strings are stored inline.
+    if (str.capacity() > std::string().capacity()) {
+      bytes += str.capacity() + 1;
+    }
+  }
+  return bytes;
+}
+
+CompactModule::CompactModule(std::string_view name)
+    : name_(strings_.Intern(name)) {
+  // The same implicit nets as are created by the `Module` constructor, in the
+  // same order.
+  zero_ = AddNet("<constant_0>", NetDeclKind::kWire).value();
+  one_ = AddNet("<constant_1>", NetDeclKind::kWire).value();
+  dummy_ = AddNet("__dummy__net_decl__", NetDeclKind::kWire).value();
+}
+
+absl::StatusOr<CompactModule::NetId> CompactModule::AddNet(
+    std::string_view name, NetDeclKind kind) {
+  StringPool::Id name_id = strings_.Intern(name);
+  auto it = name_to_net_.find(name_id);
+  if (it != name_to_net_.end()) {
+    // A wire being declared for an already-declared port is not an error.
+    if (net_kinds_[it->second] == NetDeclKind::kWire) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Module already has a net/wire decl with name: ", name));
+    }
+    return it->second;
+  }
+  NetId net = net_names_.size();
+  net_names_.push_back(name_id);
+  net_kinds_.push_back(kind);
+  name_to_net_[name_id] = net;
+  if (kind == NetDeclKind::kInput) {
+    inputs_.push_back(net);
+  } else if (kind == NetDeclKind::kOutput) {
+    outputs_.push_back(net);
+  }
+  return net;
+}
+
+absl::StatusOr<CompactModule::NetId> CompactModule::ResolveNet(
+    std::string_view name) const {
+  std::optional<StringPool::Id> name_id = strings_.Find(name);
+  if (name_id.has_value()) {
+    auto it = name_to_net_.find(*name_id);
+    if (it != name_to_net_.end()) {
+      return it->second;
+    }
+  }
+  return absl::NotFoundError(absl::StrCat("Could not find net: ", name));
+}
+
+int32_t CompactModule::GetOrAddEntry(const CellLibraryEntry* entry) {
+  auto [it, inserted] = entry_indices_.try_emplace(entry, entries_.size());
+  if (inserted) {
+    EntryInfo info{.entry = entry};
+    for (const auto& [pin_name, function] : entry->output_pin_to_function()) {
+      info.output_names.push_back(strings_.Intern(pin_name));
+    }
+    entries_.push_back(std::move(info));
+  }
+  return it->second;
+}
+
+absl::StatusOr<CompactModule::CellId> CompactModule::AddCell(
+    const CellLibraryEntry* entry, std::string_view name,
+    absl::Span<const std::pair<std::string_view, NetId>> connections) {
+  StringPool::Id name_id = strings_.Intern(name);
+  if (name_to_cell_.contains(name_id)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Module already has a cell with name: ", name));
+  }
+  for (const auto& [pin_name, net] : connections) {
+    XLS_RET_CHECK(net >= 0 && net < net_count())
+        << "Invalid net " << net << " for pin " << pin_name;
+  }
+  auto find_connection = [&](std::string_view pin) -> std::optional<NetId> {
+    for (const auto& [pin_name, net] : connections) {
+      if (pin_name == pin) {
+        return net;
+      }
+    }
+    return std::nullopt;
+  };
+
+  std::vector<NetId> pins;
+  pins.reserve(entry->input_names().size() +
+               entry->output_pin_to_function().size());
+  for (const std::string& input : entry->input_names()) {
+    std::optional<NetId> net = find_connection(input);
+    if (!net.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Missing named input parameter in instantiation of %s: %s", name,
+          input));
+    }
+    pins.push_back(*net);
+  }
+  for (const auto& [output, function] : entry->output_pin_to_function()) {
+    pins.push_back(find_connection(output).value_or(dummy_));
+  }
+  std::optional<NetId> clock;
+  if (entry->clock_name().has_value()) {
+    clock = find_connection(*entry->clock_name());
+    if (!clock.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cell %s named %s requires a clock connection %s but none was found.",
+          entry->name(), name, *entry->clock_name()));
+    }
+  }
+
+  CellId cell = cell_names_.size();
+  cell_names_.push_back(name_id);
+  cell_entries_.push_back(GetOrAddEntry(entry));
+  name_to_cell_[name_id] = cell;
+  cell_pin_nets_.insert(cell_pin_nets_.end(), pins.begin(), pins.end());
+  cell_pin_offsets_.push_back(cell_pin_nets_.size());
+  if (clock.has_value()) {
+    cell_clocks_[cell] = *clock;
+  }
+  return cell;
+}
+
+absl::StatusOr<CompactModule::CellId> CompactModule::ResolveCell(
+    std::string_view name) const {
+  std::optional<StringPool::Id> name_id = strings_.Find(name);
+  if (name_id.has_value()) {
+    auto it = name_to_cell_.find(*name_id);
+    if (it != name_to_cell_.end()) {
+      return it->second;
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrCat("Could not find cell with name: ", name));
+}
+
+absl::Span<const CompactModule::NetId> CompactModule::cell_inputs(
+    CellId cell) const {
+  return absl::MakeConstSpan(cell_pin_nets_)
+      .subspan(cell_pin_offsets_[cell],
+               cell_library_entry(cell)->input_names().size());
+}
+
+absl::Span<const CompactModule::NetId> CompactModule::cell_outputs(
+    CellId cell) const {
+  int64_t start = cell_pin_offsets_[cell] +
+                  cell_library_entry(cell)->input_names().size();
+  return absl::MakeConstSpan(cell_pin_nets_)
+      .subspan(start, cell_pin_offsets_[cell + 1] - start);
+}
+
+std::optional<CompactModule::NetId> CompactModule::cell_clock(
+    CellId cell) const {
+  auto it = cell_clocks_.find(cell);
+  if (it == cell_clocks_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void CompactModule::BuildFanout() const {
+  // Counting sort of the input pins by net.
+  fanout_offsets_.assign(net_count() + 1, 0);
+  for (CellId cell = 0; cell < cell_count(); ++cell) {
+    for (NetId net : cell_inputs(cell)) {
+      ++fanout_offsets_[net + 1];
+    }
+  }
+  for (int64_t i = 0; i < net_count(); ++i) {
+    fanout_offsets_[i + 1] += fanout_offsets_[i];
+  }
+  fanout_cells_.resize(fanout_offsets_.back());
+  std::vector<int64_t> next(fanout_offsets_.begin(), fanout_offsets_.end() - 1);
+  for (CellId cell = 0; cell < cell_count(); ++cell) {
+    for (NetId net : cell_inputs(cell)) {
+      fanout_cells_[next[net]++] = cell;
+    }
+  }
+  fanout_cell_count_ = cell_count();
+}
+
+absl::Span<const CompactModule::CellId> CompactModule::net_fanout(
+    NetId net) const {
+  if (fanout_cell_count_ != cell_count() ||
+      fanout_offsets_.size() != net_count() + 1) {
+    BuildFanout();
+  }
+  return absl::MakeConstSpan(fanout_cells_)
+      .subspan(fanout_offsets_[net],
+               fanout_offsets_[net + 1] - fanout_offsets_[net]);
+}
+
+int64_t CompactModule::GetMemoryUsage() const {
+  int64_t bytes = sizeof(*this) + strings_.GetMemoryUsage();
+  bytes += VectorBytes(net_names_) + VectorBytes(net_kinds_) +
+           MapBytes(name_to_net_) + VectorBytes(inputs_) +
+           VectorBytes(outputs_) + MapBytes(assigns_) +
+           MapBytes(entry_indices_) + VectorBytes(cell_names_) +
+           VectorBytes(cell_entries_) + MapBytes(name_to_cell_) +
+           VectorBytes(cell_pin_offsets_) + VectorBytes(cell_pin_nets_) +
+           MapBytes(cell_clocks_) + VectorBytes(fanout_offsets_) +
+           VectorBytes(fanout_cells_);
+  for (const EntryInfo& info : entries_) {
+    bytes += sizeof(EntryInfo) + VectorBytes(info.output_names);
+  }
+  return bytes;
+}
+
+/* static */ absl::StatusOr<CompactModule> CompactModule::FromModule(
+    const Module& module) {
+  CompactModule result(module.name());
+  absl::flat_hash_map<NetRef, NetId> net_ids;
+  net_ids.reserve(module.nets().size());
+  for (const auto& net : module.nets()) {
+    absl::StatusOr<NetId> existing = result.ResolveNet(net->name());
+    if (existing.ok()) {
+      // One of the implicit nets.
+      net_ids[net.get()] = *existing;
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(net_ids[net.get()],
+                         result.AddNet(net->name(), net->kind()));
+  }
+
+  std::vector<std::pair<std::string_view, NetId>> connections;
+  for (const auto& cell : module.cells()) {
+    connections.clear();
+    for (const Cell::Pin& pin : cell->inputs()) {
+      connections.push_back({pin.name, net_ids.at(pin.netref)});
+    }
+    for (const Cell::OutputPin& pin : cell->outputs()) {
+      if (pin.netref != module.GetDummyRef()) {
+        connections.push_back({pin.name, net_ids.at(pin.netref)});
+      }
+    }
+    if (cell->clock().has_value()) {
+      XLS_RET_CHECK(cell->cell_library_entry()->clock_name().has_value());
+      connections.push_back({*cell->cell_library_entry()->clock_name(),
+                             net_ids.at(*cell->clock())});
+    }
+    XLS_RETURN_IF_ERROR(
+        result.AddCell(cell->cell_library_entry(), cell->name(), connections)
+            .status());
+  }
+
+  for (const auto& [lhs, rhs] : module.assigns()) {
+    result.AddAssign(net_ids.at(lhs), net_ids.at(rhs));
+  }
+  return result;
+}
+
+absl::StatusOr<std::unique_ptr<Module>> CompactModule::ToModule() const {
+  auto module = std::make_unique<Module>(name());
+  std::vector<NetRef> nets;
+  nets.reserve(net_count());
+  for (NetId net = 0; net < net_count(); ++net) {
+    if (net != zero_ && net != one_ && net != dummy_) {
+      XLS_RETURN_IF_ERROR(module->AddNetDecl(net_kind(net), net_name(net)));
+    }
+    XLS_ASSIGN_OR_RETURN(NetRef ref, module->ResolveNet(net_name(net)));
+    nets.push_back(ref);
+  }
+
+  for (CellId cell = 0; cell < cell_count(); ++cell) {
+    const CellLibraryEntry* entry = cell_library_entry(cell);
+    absl::flat_hash_map<std::string, NetRef> named_parameter_assignments;
+    absl::Span<const NetId> inputs = cell_inputs(cell);
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      named_parameter_assignments[entry->input_names()[i]] = nets[inputs[i]];
+    }
+    absl::Span<const NetId> outputs = cell_outputs(cell);
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      if (outputs[i] != dummy_) {
+        named_parameter_assignments[cell_output_name(cell, i)] =
+            nets[outputs[i]];
+      }
+    }
+    std::optional<NetRef> clock;
+    if (std::optional<NetId> clock_id = cell_clock(cell);
+        clock_id.has_value()) {
+      clock = nets[*clock_id];
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Cell new_cell,
+        Cell::Create(entry, cell_name(cell), named_parameter_assignments, clock,
+                     module->GetDummyRef()));
+    XLS_ASSIGN_OR_RETURN(Cell * cell_ptr, module->AddCell(std::move(new_cell)));
+    absl::flat_hash_set<NetRef> connected_nets;
+    for (const auto& [pin_name, net] : named_parameter_assignments) {
+      if (connected_nets.insert(net).second) {
+        net->NoteConnectedCell(cell_ptr);
+      }
+    }
+  }
+
+  for (const auto& [lhs, rhs] : assigns_) {
+    XLS_RETURN_IF_ERROR(module->AddAssignDecl(net_name(lhs), net_name(rhs)));
+  }
+  return module;
+}
+
+}  // namespace rtl
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,188 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Memory-compact storage for large gate-level netlists.
+
+#ifndef XLS_NETLIST_COMPACT_NETLIST_H_
+#define XLS_NETLIST_COMPACT_NETLIST_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace rtl {
+
+// Interns strings so that each distinct string is stored only once; strings
+// are identified by dense integer IDs.
+class StringPool {
+ public:
+  using Id = int32_t;
+
+  Id Intern(std::string_view str);
+  std::optional<Id> Find(std::string_view str) const;
+  std::string_view Get(Id id) const { return strings_[id]; }
+  int64_t size() const { return strings_.size(); }
+
+  // Returns the approximate number of heap bytes used by the pool.
+  int64_t GetMemoryUsage() const;
+
+ private:
+  // A deque keeps the strings (and so the views used as keys in ids_) in place
+  // as the pool grows.
+  std::deque<std::string> strings_;
+  absl::flat_hash_map<std::string_view, Id> ids_;
+};
+
+// Struct-of-arrays representation of a netlist module.
+//
+// Nets and cells are identified by dense integer IDs, names are interned, and
+// pin connectivity is kept in CSR (compressed sparse row) form: the nets
+// connected to cell `c` are `cell_pin_nets_[cell_pin_offsets_[c] ..
+// cell_pin_offsets_[c + 1])`, inputs first in the order of the library entry's
+// `input_names()`, followed by outputs in the order of its
+// `output_pin_to_function()`. Pin names are therefore never stored per cell.
+// Unconnected outputs refer to the dummy net, as in `Module`.
+//
+// Net fanout (the cells reading each net) is derived from the pin arrays on
+// demand and is likewise stored in CSR form.
+//
+// Existing users operate on `Module`; `FromModule()` and `ToModule()` convert
+// between the two representations.
+class CompactModule {
+ public:
+  using NetId = int32_t;
+  using CellId = int32_t;
+
+  explicit CompactModule(std::string_view name);
+
+  // Converts `module` into the compact representation. The module's cell
+  // library entries are shared, not copied, so they must outlive the result.
+  static absl::StatusOr<CompactModule> FromModule(const Module& module);
+
+  // Materializes an equivalent `Module`, e.g. for passing to code which has
+  // not been ported to the compact representation.
+  absl::StatusOr<std::unique_ptr<Module>> ToModule() const;
+
+  std::string_view name() const { return strings_.Get(name_); }
+
+  // Adds a net. Redeclaring a port as a wire is allowed (and a no-op), as in
+  // `Module::AddNetDecl()`.
+  absl::StatusOr<NetId> AddNet(std::string_view name, NetDeclKind kind);
+  absl::StatusOr<NetId> ResolveNet(std::string_view name) const;
+
+  // Adds an instance of `entry` named `name`. `connections` maps pin names to
+  // nets; every input pin (and the clock pin, if present) must be connected.
+  // Connections to pins the entry does not declare are ignored.
+  absl::StatusOr<CellId> AddCell(
+      const CellLibraryEntry* entry, std::string_view name,
+      absl::Span<const std::pair<std::string_view, NetId>> connections);
+  absl::StatusOr<CellId> ResolveCell(std::string_view name) const;
+
+  // Records `assign lhs = rhs;`.
+  void AddAssign(NetId lhs, NetId rhs) { assigns_[lhs] = rhs; }
+
+  int64_t net_count() const { return net_names_.size(); }
+  std::string_view net_name(NetId net) const {
+    return strings_.Get(net_names_[net]);
+  }
+  NetDeclKind net_kind(NetId net) const { return net_kinds_[net]; }
+
+  int64_t cell_count() const { return cell_names_.size(); }
+  std::string_view cell_name(CellId cell) const {
+    return strings_.Get(cell_names_[cell]);
+  }
+  const CellLibraryEntry* cell_library_entry(CellId cell) const {
+    return entries_[cell_entries_[cell]].entry;
+  }
+  absl::Span<const NetId> cell_inputs(CellId cell) const;
+  absl::Span<const NetId> cell_outputs(CellId cell) const;
+  std::string_view cell_output_name(CellId cell, int64_t index) const {
+    return strings_.Get(entries_[cell_entries_[cell]].output_names[index]);
+  }
+  std::optional<NetId> cell_clock(CellId cell) const;
+
+  // Returns the cells with `net` as an input, once per connected pin.
+  absl::Span<const CellId> net_fanout(NetId net) const;
+
+  absl::Span<const NetId> inputs() const { return inputs_; }
+  absl::Span<const NetId> outputs() const { return outputs_; }
+  const absl::flat_hash_map<NetId, NetId>& assigns() const { return assigns_; }
+  NetId zero() const { return zero_; }
+  NetId one() const { return one_; }
+  NetId dummy() const { return dummy_; }
+
+  // Returns the approximate number of bytes used by the module's storage.
+  int64_t GetMemoryUsage() const;
+
+ private:
+  // Information shared by all instances of a cell library entry.
+  struct EntryInfo {
+    const CellLibraryEntry* entry;
+    // Interned names of the output pins, in CSR order.
+    std::vector<StringPool::Id> output_names;
+  };
+
+  int32_t GetOrAddEntry(const CellLibraryEntry* entry);
+  void BuildFanout() const;
+
+  StringPool strings_;
+  StringPool::Id name_;
+
+  std::vector<StringPool::Id> net_names_;
+  std::vector<NetDeclKind> net_kinds_;
+  absl::flat_hash_map<StringPool::Id, NetId> name_to_net_;
+  std::vector<NetId> inputs_;
+  std::vector<NetId> outputs_;
+  absl::flat_hash_map<NetId, NetId> assigns_;
+  NetId zero_;
+  NetId one_;
+  NetId dummy_;
+
+  std::vector<EntryInfo> entries_;
+  absl::flat_hash_map<const CellLibraryEntry*, int32_t> entry_indices_;
+
+  std::vector<StringPool::Id> cell_names_;
+  std::vector<int32_t> cell_entries_;
+  absl::flat_hash_map<StringPool::Id, CellId> name_to_cell_;
+  std::vector<int64_t> cell_pin_offsets_ = {0};
+  std::vector<NetId> cell_pin_nets_;
+  // Clocks are rare relative to cells, so they are kept out of the pin arrays.
+  absl::flat_hash_map<CellId, NetId> cell_clocks_;
+
+  // Fanout CSR arrays; rebuilt when cells have been added since the last
+  // query.
+  mutable std::vector<int64_t> fanout_offsets_;
+  mutable std::vector<CellId> fanout_cells_;
+  mutable int64_t fanout_cell_count_ = -1;
+};
+
+}  // namespace rtl
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPACT_NETLIST_H_
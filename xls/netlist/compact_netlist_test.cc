@@ -0,0 +1,176 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compact_netlist.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/find_logic_clouds.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace rtl {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
+
+constexpr std::string_view kTwoFlops = R"(module main(clk, ai, ao);
+  input clk;
+  input ai;
+  output ao;
+  wire ain, a1, a1n, a2, and_out, tied_low;
+
+  INV inv_a(.A(ai), .ZN(ain));
+  DFF dff_0(.D(ain), .Q(a1), .CLK(clk));
+  INV inv_b(.A(a1), .ZN(a1n));
+  DFF dff_1(.D(a1n), .Q(a2), .CLK(clk));
+  INV inv_c(.A(a2), .ZN(ao));
+  AND and_0(.A(ai), .B(ai), .Z(and_out));
+  assign tied_low = 1'b0;
+endmodule)";
+
+TEST(CompactNetlistTest, StringPoolInternsOnce) {
+  StringPool pool;
+  StringPool::Id a = pool.Intern("a");
+  StringPool::Id b = pool.Intern("b");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(pool.Intern(std::string("a")), a);
+  EXPECT_EQ(pool.Get(b), "b");
+  EXPECT_EQ(pool.Find("b"), b);
+  EXPECT_EQ(pool.Find("c"), std::nullopt);
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(CompactNetlistTest, FromModule) {
+  Scanner scanner(kTwoFlops);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> netlist,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* module, netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule compact,
+                           CompactModule::FromModule(*module));
+
+  EXPECT_EQ(compact.name(), "main");
+  EXPECT_EQ(compact.net_count(), module->nets().size());
+  EXPECT_EQ(compact.cell_count(), module->cells().size());
+  ASSERT_EQ(compact.inputs().size(), 2);
+  EXPECT_EQ(compact.net_name(compact.inputs()[0]), "clk");
+  EXPECT_EQ(compact.net_name(compact.inputs()[1]), "ai");
+  EXPECT_EQ(compact.net_kind(compact.inputs()[1]), NetDeclKind::kInput);
+
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId ai, compact.ResolveNet("ai"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId ain, compact.ResolveNet("ain"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId clk, compact.ResolveNet("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::CellId inv_a,
+                           compact.ResolveCell("inv_a"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::CellId dff_0,
+                           compact.ResolveCell("dff_0"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::CellId and_0,
+                           compact.ResolveCell("and_0"));
+  EXPECT_EQ(compact.cell_library_entry(inv_a)->name(), "INV");
+  EXPECT_EQ(compact.cell_library_entry(dff_0)->name(), "DFF");
+  EXPECT_THAT(compact.cell_inputs(inv_a), ElementsAre(ai));
+  EXPECT_THAT(compact.cell_outputs(inv_a), ElementsAre(ain));
+  EXPECT_EQ(compact.cell_clock(inv_a), std::nullopt);
+
+  // `and_0` reads `ai` through both of its inputs.
+  EXPECT_THAT(compact.net_fanout(ai),
+              UnorderedElementsAre(inv_a, and_0, and_0));
+  EXPECT_THAT(compact.net_fanout(ain), ElementsAre(dff_0));
+  EXPECT_THAT(compact.net_fanout(clk), ::testing::IsEmpty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId tied_low,
+                           compact.ResolveNet("tied_low"));
+  EXPECT_THAT(compact.assigns(),
+              UnorderedElementsAre(::testing::Pair(tied_low, compact.zero())));
+  EXPECT_GT(compact.GetMemoryUsage(), 0);
+}
+
+TEST(CompactNetlistTest, ToModuleRoundTrips) {
+  Scanner scanner(kTwoFlops);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> netlist,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* module, netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule compact,
+                           CompactModule::FromModule(*module));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> round_tripped,
+                           compact.ToModule());
+
+  EXPECT_EQ(round_tripped->nets().size(), module->nets().size());
+  EXPECT_EQ(round_tripped->cells().size(), module->cells().size());
+  EXPECT_EQ(round_tripped->inputs().size(), module->inputs().size());
+  EXPECT_EQ(round_tripped->outputs().size(), module->outputs().size());
+  EXPECT_EQ(round_tripped->assigns().size(), module->assigns().size());
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef ai, round_tripped->ResolveNet("ai"));
+  EXPECT_EQ(ai->connected_input_cells().size(), 3);
+  EXPECT_EQ(
+      ClustersToString(FindLogicClouds(*round_tripped,
+                                       /*include_vacuous=*/true)),
+      ClustersToString(FindLogicClouds(*module, /*include_vacuous=*/true)));
+}
+
+TEST(CompactNetlistTest, AddCellErrors) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* and_entry,
+                           cell_library.GetEntry("AND"));
+  CompactModule module("main");
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId a,
+                           module.AddNet("a", NetDeclKind::kInput));
+  XLS_ASSERT_OK_AND_ASSIGN(CompactModule::NetId z,
+                           module.AddNet("z", NetDeclKind::kOutput));
+  // Redeclaring a port as a wire is allowed; redeclaring a wire is not.
+  EXPECT_THAT(module.AddNet("a", NetDeclKind::kWire), IsOkAndHolds(a));
+  XLS_ASSERT_OK(module.AddNet("w", NetDeclKind::kWire).status());
+  EXPECT_THAT(module.AddNet("w", NetDeclKind::kWire),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  std::vector<std::pair<std::string_view, CompactModule::NetId>> connections =
+      {{"A", a}, {"B", module.one()}, {"Z", z}};
+  XLS_ASSERT_OK(module.AddCell(and_entry, "and0", connections).status());
+  EXPECT_THAT(module.AddCell(and_entry, "and0", connections),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("already has a cell")));
+  EXPECT_THAT(module.AddCell(and_entry, "and1", {{"A", a}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing named input parameter")));
+
+  // Unconnected outputs refer to the dummy net.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompactModule::CellId and2,
+      module.AddCell(and_entry, "and2", {{"A", a}, {"B", a}}));
+  EXPECT_THAT(module.cell_outputs(and2), ElementsAre(module.dummy()));
+}
+
+}  // namespace
+}  // namespace rtl
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_function.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+namespace {
+
+// The truth-table lanes of each of the first six operands: bit `i` of
+// kOperandLanes[j] is bit `j` of `i`.
+constexpr uint64_t kOperandLanes[CompiledFunction::kMaxTruthTableOperands] = {
+    0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+    0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL};
+
+// Appends the identifiers in `ast` which are not yet in `names`.
+void CollectIdentifiers(const Ast& ast, std::vector<std::string>& names) {
+  if (ast.kind() == Ast::Kind::kIdentifier) {
+    if (!absl::c_linear_search(names, ast.name())) {
+      names.push_back(ast.name());
+    }
+    return;
+  }
+  for (const Ast& child : ast.children()) {
+    CollectIdentifiers(child, names);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<CompiledFunction> CompiledFunction::Compile(
+    const Ast& ast, absl::Span<const std::string> input_names) {
+  CompiledFunction function;
+  function.operand_names_.assign(input_names.begin(), input_names.end());
+  function.input_count_ = input_names.size();
+  // Instruction results are numbered after the operands, so all of the
+  // operands must be known before any code is emitted.
+  CollectIdentifiers(ast, function.operand_names_);
+  function.result_ = function.CompileAst(ast);
+
+  int64_t operand_count = function.operand_names_.size();
+  if (operand_count <= kMaxTruthTableOperands) {
+    std::vector<uint64_t> lanes(kOperandLanes, kOperandLanes + operand_count);
+    uint64_t table = function.Evaluate<uint64_t>(
+        lanes, DefaultFunctionOps<uint64_t>(0, ~uint64_t{0}));
+    int64_t row_count = int64_t{1} << operand_count;
+    function.truth_table_ =
+        row_count == 64 ? table : table & ((uint64_t{1} << row_count) - 1);
+  }
+  return function;
+}
+
+absl::StatusOr<CompiledFunction> CompiledFunction::Compile(
+    const std::string& function, absl::Span<const std::string> input_names) {
+  XLS_ASSIGN_OR_RETURN(Ast ast, Parser::ParseFunction(function));
+  return Compile(ast, input_names);
+}
+
+int32_t CompiledFunction::CompileAst(const Ast& ast) {
+  auto emit = [this](OpKind kind, int32_t lhs = 0, int32_t rhs = 0) {
+    program_.push_back({kind, lhs, rhs});
+    return static_cast<int32_t>(operand_names_.size() + program_.size() - 1);
+  };
+  switch (ast.kind()) {
+    case Ast::Kind::kIdentifier: {
+      auto it = absl::c_find(operand_names_, ast.name());
+      CHECK(it != operand_names_.end()) << ast.name();
+      return static_cast<int32_t>(it - operand_names_.begin());
+    }
+    case Ast::Kind::kLiteralZero:
+      return emit(OpKind::kZero);
+    case Ast::Kind::kLiteralOne:
+      return emit(OpKind::kOne);
+    case Ast::Kind::kNot:
+      return emit(OpKind::kNot, CompileAst(ast.children()[0]));
+    case Ast::Kind::kAnd:
+    case Ast::Kind::kOr:
+    case Ast::Kind::kXor: {
+      int32_t lhs = CompileAst(ast.children()[0]);
+      int32_t rhs = CompileAst(ast.children()[1]);
+      OpKind kind = ast.kind() == Ast::Kind::kAnd  ? OpKind::kAnd
+                    : ast.kind() == Ast::Kind::kOr ? OpKind::kOr
+                                                   : OpKind::kXor;
+      return emit(kind, lhs, rhs);
+    }
+  }
+  LOG(FATAL) << "Unknown AST kind: " << static_cast<int>(ast.kind());
+}
+
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
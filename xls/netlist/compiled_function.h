@@ -0,0 +1,162 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_FUNCTION_H_
+#define XLS_NETLIST_COMPILED_FUNCTION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+
+// The operations used to evaluate a CompiledFunction on values of type EvalT.
+// `Not` complements relative to `one`, so integral types work both as single
+// truth values (one == 1) and as bit lanes (one == all ones); other types use
+// their `!`, `&`, `|` and `^` operators.
+template <typename EvalT>
+class DefaultFunctionOps {
+ public:
+  DefaultFunctionOps(EvalT zero, EvalT one)
+      : zero_(std::move(zero)), one_(std::move(one)) {}
+
+  EvalT Zero() const { return zero_; }
+  EvalT One() const { return one_; }
+  EvalT Not(const EvalT& x) const {
+    if constexpr (std::is_integral_v<EvalT> && !std::is_same_v<EvalT, bool>) {
+      return x ^ one_;
+    } else {
+      return !x;
+    }
+  }
+  EvalT And(const EvalT& x, const EvalT& y) const { return x & y; }
+  EvalT Or(const EvalT& x, const EvalT& y) const { return x | y; }
+  EvalT Xor(const EvalT& x, const EvalT& y) const { return x ^ y; }
+
+ private:
+  EvalT zero_;
+  EvalT one_;
+};
+
+// A cell pin "function" attribute compiled once into straight-line code, so it
+// can be evaluated many times without walking (or re-parsing) its AST.
+//
+// The function's operands are the cell's inputs, in the order they were given
+// to Compile(), followed by any other identifiers the function refers to (e.g.
+// the internal signals of a state table), in order of first reference. For
+// functions of at most six operands the truth table is also computed, which
+// serves as the fast path for evaluation on bools.
+class CompiledFunction {
+ public:
+  static constexpr int64_t kMaxTruthTableOperands = 6;
+
+  static absl::StatusOr<CompiledFunction> Compile(
+      const Ast& ast, absl::Span<const std::string> input_names);
+
+  // Parses and compiles the given function attribute.
+  static absl::StatusOr<CompiledFunction> Compile(
+      const std::string& function, absl::Span<const std::string> input_names);
+
+  absl::Span<const std::string> operand_names() const {
+    return operand_names_;
+  }
+  int64_t input_count() const { return input_count_; }
+
+  // If present, bit `i` holds the value of the function when operand `j` is
+  // bit `j` of `i`.
+  std::optional<uint64_t> truth_table() const { return truth_table_; }
+
+  // Evaluates the function with the given operand values.
+  template <typename EvalT, typename OpsT = DefaultFunctionOps<EvalT>>
+  EvalT Evaluate(absl::Span<const EvalT> operands, const OpsT& ops) const;
+
+ private:
+  enum class OpKind : uint8_t { kZero, kOne, kNot, kAnd, kOr, kXor };
+
+  // Each instruction writes the slot after the last; slots below
+  // `operand_names_.size()` hold the operands.
+  struct Instruction {
+    OpKind kind;
+    int32_t lhs;
+    int32_t rhs;
+  };
+
+  int32_t CompileAst(const Ast& ast);
+
+  std::vector<std::string> operand_names_;
+  int64_t input_count_ = 0;
+  std::vector<Instruction> program_;
+  int32_t result_ = 0;
+  std::optional<uint64_t> truth_table_;
+};
+
+template <typename EvalT, typename OpsT>
+EvalT CompiledFunction::Evaluate(absl::Span<const EvalT> operands,
+                                 const OpsT& ops) const {
+  CHECK_EQ(operands.size(), operand_names_.size());
+  if constexpr (std::is_same_v<EvalT, bool>) {
+    if (truth_table_.has_value()) {
+      uint64_t index = 0;
+      for (int64_t i = 0; i < operands.size(); ++i) {
+        index |= static_cast<uint64_t>(operands[i]) << i;
+      }
+      return ((*truth_table_ >> index) & 1) != 0;
+    }
+  }
+  absl::InlinedVector<EvalT, 16> slots(operands.begin(), operands.end());
+  slots.reserve(operands.size() + program_.size());
+  for (const Instruction& instruction : program_) {
+    switch (instruction.kind) {
+      case OpKind::kZero:
+        slots.push_back(ops.Zero());
+        break;
+      case OpKind::kOne:
+        slots.push_back(ops.One());
+        break;
+      case OpKind::kNot:
+        slots.push_back(ops.Not(slots[instruction.lhs]));
+        break;
+      case OpKind::kAnd:
+        slots.push_back(
+            ops.And(slots[instruction.lhs], slots[instruction.rhs]));
+        break;
+      case OpKind::kOr:
+        slots.push_back(
+            ops.Or(slots[instruction.lhs], slots[instruction.rhs]));
+        break;
+      case OpKind::kXor:
+        slots.push_back(
+            ops.Xor(slots[instruction.lhs], slots[instruction.rhs]));
+        break;
+    }
+  }
+  return slots[result_];
+}
+
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_FUNCTION_H_
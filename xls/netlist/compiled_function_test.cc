@@ -0,0 +1,91 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_function.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/inlined_vector.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace netlist {
+namespace function {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+TEST(CompiledFunctionTest, TruthTable) {
+  std::vector<std::string> inputs = {"A", "B"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction and_function,
+                           CompiledFunction::Compile("A&B", inputs));
+  EXPECT_THAT(and_function.truth_table(), Optional(0x8));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction nor_function,
+                           CompiledFunction::Compile("!(A|B)", inputs));
+  EXPECT_THAT(nor_function.truth_table(), Optional(0x1));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction xor_function,
+                           CompiledFunction::Compile("A^B", inputs));
+  EXPECT_THAT(xor_function.truth_table(), Optional(0x6));
+}
+
+TEST(CompiledFunctionTest, BoolAgreesWithLanes) {
+  std::vector<std::string> inputs = {"A", "B", "C"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction function,
+                           CompiledFunction::Compile("(A&!B)|(B^C)", inputs));
+  DefaultFunctionOps<bool> bool_ops(false, true);
+  uint64_t lanes = function.Evaluate<uint64_t>(
+      std::vector<uint64_t>{0xaa, 0xcc, 0xf0},
+      DefaultFunctionOps<uint64_t>(0, 0xff));
+  for (int64_t i = 0; i < 8; ++i) {
+    bool a = (i & 1) != 0;
+    bool b = (i & 2) != 0;
+    bool c = (i & 4) != 0;
+    bool expected = (a && !b) || (b != c);
+    EXPECT_EQ(function.Evaluate<bool>(absl::InlinedVector<bool, 3>{a, b, c},
+                                      bool_ops),
+              expected)
+        << i;
+    EXPECT_EQ(((lanes >> i) & 1) != 0, expected) << i;
+  }
+}
+
+TEST(CompiledFunctionTest, ExtraOperands) {
+  std::vector<std::string> inputs = {"A"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledFunction function,
+                           CompiledFunction::Compile("A&X", inputs));
+  EXPECT_THAT(function.operand_names(), ElementsAre("A", "X"));
+  EXPECT_EQ(function.input_count(), 1);
+  DefaultFunctionOps<bool> ops(false, true);
+  EXPECT_TRUE(
+      function.Evaluate<bool>(absl::InlinedVector<bool, 2>{true, true}, ops));
+  EXPECT_FALSE(
+      function.Evaluate<bool>(absl::InlinedVector<bool, 2>{true, false}, ops));
+}
+
+TEST(CompiledFunctionTest, ParseError) {
+  std::vector<std::string> inputs = {"A"};
+  EXPECT_FALSE(CompiledFunction::Compile("A&(", inputs).ok());
+}
+
+}  // namespace
+}  // namespace function
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,391 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Appends the flattened, levelized program for a module to a
+// CompiledInterpreter.
+class CompiledInterpreter::Compiler {
+ public:
+  Compiler(const rtl::Netlist* netlist, CompiledInterpreter* result)
+      : netlist_(netlist), result_(result) {}
+
+  // Appends the program for `module`. On entry `net_slots` maps the inputs of
+  // the module to slots; on exit it also holds the slots of every net driven
+  // by a cell.
+  absl::Status CompileModule(const rtl::Module* module,
+                             absl::flat_hash_map<rtl::NetRef, int64_t>&
+                                 net_slots) {
+    if (!active_modules_.insert(module).second) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Module %s instantiates itself", module->name()));
+    }
+    net_slots[module->zero()] = kZeroSlot;
+    net_slots[module->one()] = kOneSlot;
+
+    // As in `Interpreter`, a cell is ready to be evaluated once every one of
+    // its input wires has been driven.
+    absl::flat_hash_map<const rtl::Cell*, int64_t> missing_wires;
+    std::deque<rtl::NetRef> active_wires;
+    for (const auto& cell : module->cells()) {
+      missing_wires[cell.get()] = cell->inputs().size();
+      if (cell->inputs().empty()) {
+        XLS_RETURN_IF_ERROR(CompileCell(module, cell.get(), net_slots));
+        for (const auto& output : cell->outputs()) {
+          active_wires.push_back(output.netref);
+        }
+      }
+    }
+    for (rtl::NetRef input : module->inputs()) {
+      active_wires.push_back(input);
+    }
+    active_wires.push_back(module->zero());
+    active_wires.push_back(module->one());
+
+    while (!active_wires.empty()) {
+      rtl::NetRef wire = active_wires.front();
+      active_wires.pop_front();
+      for (rtl::Cell* cell : wire->connected_input_cells()) {
+        int64_t& missing = missing_wires.at(cell);
+        XLS_RET_CHECK_GT(missing, 0);
+        if (--missing > 0) {
+          continue;
+        }
+        XLS_RETURN_IF_ERROR(CompileCell(module, cell, net_slots));
+        for (const auto& output : cell->outputs()) {
+          active_wires.push_back(output.netref);
+        }
+      }
+    }
+
+    for (const auto& cell : module->cells()) {
+      if (missing_wires.at(cell.get()) > 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs and cannot be translated. "
+            "Example: cell %s",
+            cell->name()));
+      }
+    }
+    active_modules_.erase(module);
+    return absl::OkStatus();
+  }
+
+  // Returns the slot holding the value of `net`, following the assignments of
+  // `module` if it is not driven by a cell.
+  static absl::StatusOr<int64_t> ResolveSlot(
+      const rtl::Module* module,
+      const absl::flat_hash_map<rtl::NetRef, int64_t>& net_slots,
+      rtl::NetRef net) {
+    rtl::NetRef value = net;
+    while (!net_slots.contains(value) && module->assigns().contains(value)) {
+      value = module->assigns().at(value);
+    }
+    auto it = net_slots.find(value);
+    if (it == net_slots.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Net %s of module %s has no value assigned",
+                          net->name(), module->name()));
+    }
+    return it->second;
+  }
+
+ private:
+  absl::Status CompileCell(const rtl::Module* module, const rtl::Cell* cell,
+                           absl::flat_hash_map<rtl::NetRef, int64_t>&
+                               net_slots) {
+    const CellLibraryEntry* entry = cell->cell_library_entry();
+    if (std::optional<const rtl::Module*> submodule =
+            netlist_->MaybeGetModule(entry->name());
+        submodule.has_value()) {
+      return CompileSubmodule(cell, submodule.value(), net_slots);
+    }
+
+    ++result_->cell_count_;
+    for (const auto& output : cell->outputs()) {
+      int64_t output_slot = result_->slot_count_++;
+      if (output.eval != nullptr) {
+        Call call{.fn = output.eval, .output_slot = output_slot};
+        for (const auto& input : cell->inputs()) {
+          call.input_slots.push_back(net_slots.at(input.netref));
+        }
+        result_->program_.push_back(
+            Op{OpKind::kCall, static_cast<int64_t>(result_->calls_.size())});
+        result_->calls_.push_back(std::move(call));
+      } else {
+        XLS_ASSIGN_OR_RETURN(const function::Ast* ast,
+                             GetFunction(entry, output.name));
+        XLS_RETURN_IF_ERROR(
+            CompileFunction(*cell, *ast, net_slots, /*depth=*/1));
+        result_->program_.push_back(Op{OpKind::kStore, output_slot});
+      }
+      net_slots[output.netref] = output_slot;
+    }
+    return absl::OkStatus();
+  }
+
+  // Inlines the program for an instance of `submodule` and notes the slots of
+  // its outputs as those of the nets connected to the instance.
+  absl::Status CompileSubmodule(const rtl::Cell* cell,
+                                const rtl::Module* submodule,
+                                absl::flat_hash_map<rtl::NetRef, int64_t>&
+                                    net_slots) {
+    absl::flat_hash_map<rtl::NetRef, int64_t> submodule_slots;
+    absl::Span<const std::string> input_names =
+        submodule->AsCellLibraryEntry()->input_names();
+    for (const auto& input : cell->inputs()) {
+      auto it = std::find(input_names.begin(), input_names.end(), input.name);
+      XLS_RET_CHECK(it != input_names.end()) << absl::StrFormat(
+          "Could not find input pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"!",
+          input.name, submodule->name(), cell->name());
+      submodule_slots[submodule->inputs()[it - input_names.begin()]] =
+          net_slots.at(input.netref);
+    }
+    XLS_RETURN_IF_ERROR(CompileModule(submodule, submodule_slots));
+
+    for (rtl::NetRef submodule_output : submodule->outputs()) {
+      auto it = std::find_if(cell->outputs().begin(), cell->outputs().end(),
+                             [&](const rtl::Cell::OutputPin& pin) {
+                               return pin.name == submodule_output->name();
+                             });
+      XLS_RET_CHECK(it != cell->outputs().end()) << absl::StrFormat(
+          "Could not find cell output pin \"%s\" in cell \"%s\", referenced in "
+          "child module \"%s\"!",
+          submodule_output->name(), cell->name(), submodule->name());
+      XLS_ASSIGN_OR_RETURN(
+          net_slots[it->netref],
+          ResolveSlot(submodule, submodule_slots, submodule_output));
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns the parsed function of the given output pin, parsing it only the
+  // first time it's requested.
+  absl::StatusOr<const function::Ast*> GetFunction(
+      const CellLibraryEntry* entry, const std::string& pin_name) {
+    auto key = std::make_pair(entry, pin_name);
+    auto it = functions_.find(key);
+    if (it == functions_.end()) {
+      XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                           function::Parser::ParseFunction(
+                               entry->output_pin_to_function().at(pin_name)));
+      it = functions_.emplace(std::move(key), std::move(ast)).first;
+    }
+    return &it->second;
+  }
+
+  // Appends the bytecode evaluating `ast` for `cell`, whose result is pushed
+  // at stack depth `depth`.
+  absl::Status CompileFunction(
+      const rtl::Cell& cell, const function::Ast& ast,
+      const absl::flat_hash_map<rtl::NetRef, int64_t>& net_slots,
+      int64_t depth) {
+    result_->max_stack_depth_ = std::max(result_->max_stack_depth_, depth);
+    std::vector<Op>& program = result_->program_;
+    switch (ast.kind()) {
+      case function::Ast::Kind::kIdentifier: {
+        for (const auto& input : cell.inputs()) {
+          if (input.name == ast.name()) {
+            program.push_back(Op{OpKind::kLoad, net_slots.at(input.netref)});
+            return absl::OkStatus();
+          }
+        }
+        for (const auto& internal : cell.internal_pins()) {
+          if (internal.name == ast.name()) {
+            return absl::UnimplementedError(absl::StrFormat(
+                "Cell %s uses state table signal \"%s\", which is not "
+                "supported by the compiled interpreter",
+                cell.name(), ast.name()));
+          }
+        }
+        return absl::NotFoundError(
+            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                            "or internal signals.",
+                            ast.name(), cell.name()));
+      }
+      case function::Ast::Kind::kLiteralZero:
+        program.push_back(Op{OpKind::kLoad, kZeroSlot});
+        return absl::OkStatus();
+      case function::Ast::Kind::kLiteralOne:
+        program.push_back(Op{OpKind::kLoad, kOneSlot});
+        return absl::OkStatus();
+      case function::Ast::Kind::kNot:
+        XLS_RETURN_IF_ERROR(
+            CompileFunction(cell, ast.children()[0], net_slots, depth));
+        program.push_back(Op{OpKind::kNot});
+        return absl::OkStatus();
+      case function::Ast::Kind::kAnd:
+      case function::Ast::Kind::kOr:
+      case function::Ast::Kind::kXor: {
+        XLS_RETURN_IF_ERROR(
+            CompileFunction(cell, ast.children()[0], net_slots, depth));
+        XLS_RETURN_IF_ERROR(
+            CompileFunction(cell, ast.children()[1], net_slots, depth + 1));
+        OpKind kind = ast.kind() == function::Ast::Kind::kAnd  ? OpKind::kAnd
+                      : ast.kind() == function::Ast::Kind::kOr ? OpKind::kOr
+                                                               : OpKind::kXor;
+        program.push_back(Op{kind});
+        return absl::OkStatus();
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown AST element type: ", ast.kind()));
+  }
+
+  const rtl::Netlist* netlist_;
+  CompiledInterpreter* result_;
+  absl::flat_hash_set<const rtl::Module*> active_modules_;
+  absl::flat_hash_map<std::pair<const CellLibraryEntry*, std::string>,
+                      function::Ast>
+      functions_;
+};
+
+/* static */ absl::StatusOr<CompiledInterpreter> CompiledInterpreter::Compile(
+    const rtl::Netlist* netlist, const rtl::Module* module) {
+  CompiledInterpreter result(module);
+  absl::flat_hash_map<rtl::NetRef, int64_t> net_slots;
+  for (rtl::NetRef input : module->inputs()) {
+    int64_t slot = result.slot_count_++;
+    result.input_slots_.push_back(slot);
+    net_slots[input] = slot;
+  }
+  Compiler compiler(netlist, &result);
+  XLS_RETURN_IF_ERROR(compiler.CompileModule(module, net_slots));
+  for (rtl::NetRef output : module->outputs()) {
+    XLS_ASSIGN_OR_RETURN(int64_t slot,
+                         Compiler::ResolveSlot(module, net_slots, output));
+    result.output_slots_.push_back(slot);
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<uint64_t>> CompiledInterpreter::Evaluate(
+    absl::Span<const uint64_t> inputs) const {
+  XLS_RET_CHECK_EQ(inputs.size(), input_slots_.size());
+  std::vector<uint64_t> slots(slot_count_);
+  slots[kZeroSlot] = 0;
+  slots[kOneSlot] = ~uint64_t{0};
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    slots[input_slots_[i]] = inputs[i];
+  }
+
+  std::vector<uint64_t> stack(max_stack_depth_);
+  int64_t top = -1;
+  std::vector<bool> args;
+  for (const Op& op : program_) {
+    switch (op.kind) {
+      case OpKind::kLoad:
+        stack[++top] = slots[op.operand];
+        break;
+      case OpKind::kNot:
+        stack[top] = ~stack[top];
+        break;
+      case OpKind::kAnd:
+        stack[top - 1] &= stack[top];
+        --top;
+        break;
+      case OpKind::kOr:
+        stack[top - 1] |= stack[top];
+        --top;
+        break;
+      case OpKind::kXor:
+        stack[top - 1] ^= stack[top];
+        --top;
+        break;
+      case OpKind::kStore:
+        slots[op.operand] = stack[top--];
+        break;
+      case OpKind::kCall: {
+        const Call& call = calls_[op.operand];
+        uint64_t result = 0;
+        for (int64_t lane = 0; lane < kLaneCount; ++lane) {
+          args.clear();
+          for (int64_t slot : call.input_slots) {
+            args.push_back(((slots[slot] >> lane) & 1) != 0);
+          }
+          XLS_ASSIGN_OR_RETURN(bool value, call.fn(args));
+          result |= static_cast<uint64_t>(value) << lane;
+        }
+        slots[call.output_slot] = result;
+        break;
+      }
+    }
+  }
+
+  std::vector<uint64_t> outputs;
+  outputs.reserve(output_slots_.size());
+  for (int64_t slot : output_slots_) {
+    outputs.push_back(slots[slot]);
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<NetRef2Value>> CompiledInterpreter::InterpretVectors(
+    absl::Span<const NetRef2Value> vectors) const {
+  std::vector<NetRef2Value> results;
+  results.reserve(vectors.size());
+  for (int64_t start = 0; start < vectors.size(); start += kLaneCount) {
+    absl::Span<const NetRef2Value> batch =
+        vectors.subspan(start, kLaneCount);
+    std::vector<uint64_t> inputs(module_->inputs().size());
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      rtl::NetRef input = module_->inputs()[i];
+      for (int64_t lane = 0; lane < batch.size(); ++lane) {
+        auto it = batch[lane].find(input);
+        if (it == batch[lane].end()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("No value given for input %s in vector %d",
+                              input->name(), start + lane));
+        }
+        inputs[i] |= static_cast<uint64_t>(it->second) << lane;
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> outputs, Evaluate(inputs));
+    for (int64_t lane = 0; lane < batch.size(); ++lane) {
+      NetRef2Value& result = results.emplace_back();
+      for (int64_t i = 0; i < outputs.size(); ++i) {
+        result[module_->outputs()[i]] = ((outputs[i] >> lane) & 1) != 0;
+      }
+    }
+  }
+  return results;
+}
+
+}  // namespace netlist
+}  // namespace xls
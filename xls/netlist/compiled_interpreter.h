@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_INTERPRETER_H_
+#define XLS_NETLIST_COMPILED_INTERPRETER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Interprets a netlist module on 64 input vectors at a time.
+//
+// Unlike `Interpreter`, which propagates values through hash maps and parses
+// cell functions as it goes, all of the work of walking the netlist is done
+// once up front: the module is flattened (submodule instances are inlined),
+// its cells are ordered topologically into a single program, and each cell
+// output function is compiled into a small stack bytecode. Values are 64-bit
+// words where bit `i` holds the value of a net for input vector `i`, so every
+// instruction evaluates a gate for 64 vectors at once.
+//
+// Cells with state tables are not supported. Cells with an evaluation function
+// (see `rtl::Cell::SetOutputEvalFn()`) are, but the function is called once
+// per vector.
+class CompiledInterpreter {
+ public:
+  // The number of input vectors evaluated by one call to `Evaluate()`.
+  static constexpr int64_t kLaneCount = 64;
+
+  static absl::StatusOr<CompiledInterpreter> Compile(
+      const rtl::Netlist* netlist, const rtl::Module* module);
+
+  // Evaluates the module on up to 64 input vectors at once. `inputs` holds a
+  // word per module input, in the order of `module->inputs()`, where bit `i`
+  // is the value of that input in vector `i`. Returns a word per module output
+  // in the order of `module->outputs()`.
+  absl::StatusOr<std::vector<uint64_t>> Evaluate(
+      absl::Span<const uint64_t> inputs) const;
+
+  // Evaluates the module on each of `vectors`, which map every module input to
+  // its value as for `Interpreter::InterpretModule()`. Returns the value of the
+  // module outputs for each vector.
+  absl::StatusOr<std::vector<NetRef2Value>> InterpretVectors(
+      absl::Span<const NetRef2Value> vectors) const;
+
+  // Returns the number of cells (after flattening) in the compiled program.
+  int64_t cell_count() const { return cell_count_; }
+
+ private:
+  class Compiler;
+
+  enum class OpKind : uint8_t {
+    // Pushes the value in slot `operand`.
+    kLoad,
+    // Pops values and pushes the result of the operation.
+    kNot,
+    kAnd,
+    kOr,
+    kXor,
+    // Pops a value into slot `operand`.
+    kStore,
+    // Evaluates `calls_[operand]` one vector at a time.
+    kCall,
+  };
+  struct Op {
+    OpKind kind;
+    int64_t operand = 0;
+  };
+  struct Call {
+    rtl::CellOutputEvalFn<bool> fn;
+    std::vector<int64_t> input_slots;
+    int64_t output_slot;
+  };
+
+  // Slots 0 and 1 hold constant zero and one respectively.
+  static constexpr int64_t kZeroSlot = 0;
+  static constexpr int64_t kOneSlot = 1;
+
+  explicit CompiledInterpreter(const rtl::Module* module) : module_(module) {}
+
+  const rtl::Module* module_;
+  std::vector<Op> program_;
+  std::vector<Call> calls_;
+  std::vector<int64_t> input_slots_;
+  std::vector<int64_t> output_slots_;
+  int64_t slot_count_ = 2;
+  int64_t max_stack_depth_ = 0;
+  int64_t cell_count_ = 0;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_INTERPRETER_H_
@@ -0,0 +1,193 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kHierarchicalNetlist = R"(
+module aoi (a, b, c, z);
+  input a, b, c;
+  output z;
+
+  AOI21 aoi0 ( .A(a), .B(b), .C(c), .ZN(z) );
+endmodule
+
+module mixed (i0, i1, i2, i3, i4, o0, o1);
+  input i0, i1, i2, i3, i4;
+  output o0, o1;
+  wire one, nand_out, inv_out, aoi_out, nor_out;
+
+  LOGIC_ONE one0 ( .O(one) );
+  NAND nand0 ( .A(i0), .B(i1), .ZN(nand_out) );
+  INV inv0 ( .A(i2), .ZN(inv_out) );
+  aoi aoi1 ( .a(nand_out), .b(inv_out), .c(i3), .z(aoi_out) );
+  NOR4 nor0 ( .A(aoi_out), .B(i4), .C(i0), .D(inv_out), .ZN(nor_out) );
+  XOR xor0 ( .A(aoi_out), .B(one), .Z(o0) );
+  OR or0 ( .A(nor_out), .B(i1), .Z(o1) );
+endmodule
+)";
+
+class CompiledInterpreterTest : public ::testing::Test {
+ protected:
+  absl::StatusOr<std::unique_ptr<rtl::Netlist>> Parse(std::string_view text) {
+    XLS_ASSIGN_OR_RETURN(cell_library_, MakeFakeCellLibrary());
+    rtl::Scanner scanner(text);
+    return rtl::Parser::ParseNetlist(&cell_library_, &scanner);
+  }
+
+  // Returns `count` input vectors for `module`, enumerating the combinations
+  // of its inputs.
+  static std::vector<NetRef2Value> MakeVectors(const rtl::Module* module,
+                                               int64_t count) {
+    std::vector<NetRef2Value> vectors(count);
+    for (int64_t v = 0; v < count; ++v) {
+      for (int64_t i = 0; i < module->inputs().size(); ++i) {
+        vectors[v][module->inputs()[i]] = ((v >> i) & 1) != 0;
+      }
+    }
+    return vectors;
+  }
+
+  // Expects the compiled interpreter to produce the same outputs as
+  // `Interpreter` on each of `vectors`.
+  static void ExpectMatchesInterpreter(
+      rtl::Netlist* netlist, const rtl::Module* module,
+      const std::vector<NetRef2Value>& vectors) {
+    XLS_ASSERT_OK_AND_ASSIGN(CompiledInterpreter compiled,
+                             CompiledInterpreter::Compile(netlist, module));
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<NetRef2Value> results,
+                             compiled.InterpretVectors(vectors));
+    ASSERT_EQ(results.size(), vectors.size());
+    Interpreter interpreter(netlist);
+    for (int64_t v = 0; v < vectors.size(); ++v) {
+      XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                               interpreter.InterpretModule(module, vectors[v]));
+      EXPECT_EQ(results[v], expected) << "vector " << v;
+    }
+  }
+
+  CellLibrary cell_library_;
+};
+
+TEST_F(CompiledInterpreterTest, MatchesInterpreterWithSubmodules) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<rtl::Netlist> netlist,
+                           Parse(kHierarchicalNetlist));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("mixed"));
+  // More than one batch of vectors, with the last batch partially filled.
+  ExpectMatchesInterpreter(netlist.get(), module, MakeVectors(module, 100));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledInterpreter compiled,
+                           CompiledInterpreter::Compile(netlist.get(), module));
+  EXPECT_EQ(compiled.cell_count(), 7);
+}
+
+TEST_F(CompiledInterpreterTest, EvaluatesBitLanes) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<rtl::Netlist> netlist,
+                           Parse(kHierarchicalNetlist));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("aoi"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledInterpreter compiled,
+                           CompiledInterpreter::Compile(netlist.get(), module));
+  uint64_t a = 0xff00ff00ff00ff00;
+  uint64_t b = 0xf0f0f0f0f0f0f0f0;
+  uint64_t c = 0xcccccccccccccccc;
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> outputs,
+                           compiled.Evaluate({a, b, c}));
+  EXPECT_THAT(outputs, ::testing::ElementsAre(~((a & b) | c)));
+}
+
+TEST_F(CompiledInterpreterTest, MatchesInterpreterWithAssigns) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<rtl::Netlist> netlist, Parse(R"(
+module main (A, B, out);
+  input A;
+  input B;
+  wire [1:0] i0;
+  wire [2:0] i1;
+  wire [3:0] i2;
+  wire [4:0] i3;
+  output [15:0] out;
+  wire [15:0] out;
+
+  assign i0 = { A, B };
+  assign i1 = { 1'b1, i0 };
+  assign { i2, i3 }  = { i1, i1, i1, i1 };
+  assign out = { i3, i2, 7'h4a };
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module, MakeVectors(module, 4));
+}
+
+TEST_F(CompiledInterpreterTest, CallsCellEvalFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<rtl::Netlist> netlist,
+                           Parse(kHierarchicalNetlist));
+  int64_t call_count = 0;
+  rtl::CellToOutputEvalFns<bool> eval_fns{
+      {"NAND",
+       {{"ZN",
+         [&call_count](const std::vector<bool>& args) -> absl::StatusOr<bool> {
+           ++call_count;
+           return !(args[0] && args[1]);
+         }}}}};
+  XLS_ASSERT_OK(netlist->AddCellEvaluationFns(eval_fns));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("mixed"));
+  ExpectMatchesInterpreter(netlist.get(), module, MakeVectors(module, 32));
+  EXPECT_GT(call_count, 0);
+}
+
+TEST_F(CompiledInterpreterTest, StateTablesAreUnsupported) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<rtl::Netlist> netlist, Parse(R"(
+module main(i0, i1, o0);
+  input i0, i1;
+  output o0;
+
+  STATETABLE_AND and0 (.A(i0), .B(i1), .Z(o0) );
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(CompiledInterpreter::Compile(netlist.get(), module),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("state table")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
@@ -15,17 +15,23 @@
 #include "xls/netlist/find_logic_clouds.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/union_find.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/netlist.h"
@@ -50,112 +56,152 @@ void Cluster::SortCells() {
   std::sort(other_cells_.begin(), other_cells_.end(), cell_name_lt);
 }
 
-std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
+namespace {
 
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
-  };
+// Work is handed to threads in blocks of this many items.
+constexpr int64_t kBlockSize = 4096;
 
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
-  };
+int64_t BlockCount(int64_t count) {
+  return (count + kBlockSize - 1) / kBlockSize;
+}
 
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    VLOG(4) << "Considering cell: " << cell->name();
-
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
-    if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      VLOG(4) << "--- Now " << count_equivalence_classes()
-              << " equivalence classes for " << cell_to_uf.size() << " cells.";
-      continue;
+// Calls `f(begin, end)` for consecutive blocks of [0, count) on up to
+// `thread_count` threads, including the calling one.
+void ForEachBlock(int64_t count, int64_t thread_count,
+                  const std::function<void(int64_t, int64_t)>& f) {
+  int64_t block_count = BlockCount(count);
+  std::atomic<int64_t> next_block = 0;
+  auto worker = [&]() {
+    while (true) {
+      int64_t block = next_block.fetch_add(1);
+      if (block >= block_count) {
+        return;
+      }
+      f(block * kBlockSize, std::min(count, (block + 1) * kBlockSize));
     }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(thread_count, block_count); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
 
-    for (auto& input : cell->inputs()) {
-      VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        if (connected->kind() == CellKind::kFlop) {
-          VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
-              connected->name());
-          continue;
+}  // namespace
+
+std::vector<Cluster> FindLogicClouds(const Module& module, bool include_vacuous,
+                                     int64_t thread_count) {
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  absl::flat_hash_map<const Cell*, int64_t> cell_ids;
+  cell_ids.reserve(cells.size());
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    cell_ids[cells[i].get()] = i;
+  }
+
+  // Gather, per net, the pairs of cells whose equivalence classes it merges.
+  // Flop output connectivity is excluded from the equivalence class, so we get
+  // partitions along flop (output) boundaries: a net driven by logic ties
+  // together every cell on it (including the flops it feeds), while a net that
+  // is only read by logic ties together just the logic cells reading it. Each
+  // net's cells are chained rather than merged pairwise, which keeps the work
+  // linear in the fanout.
+  absl::Span<const std::unique_ptr<NetDef>> nets = module.nets();
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> block_edges(
+      BlockCount(nets.size()));
+  ForEachBlock(nets.size(), thread_count, [&](int64_t begin, int64_t end) {
+    std::vector<std::pair<int64_t, int64_t>>& edges =
+        block_edges[begin / kBlockSize];
+    std::vector<int64_t> members;
+    for (int64_t i = begin; i < end; ++i) {
+      NetRef net = nets[i].get();
+      bool driven_by_logic = absl::c_any_of(
+          net->connected_cells(), [net](const Cell* cell) {
+            return cell->kind() != CellKind::kFlop &&
+                   absl::c_any_of(cell->outputs(),
+                                  [net](const Cell::OutputPin& pin) {
+                                    return pin.netref == net;
+                                  });
+          });
+      members.clear();
+      for (const Cell* cell : net->connected_cells()) {
+        if (driven_by_logic || cell->kind() != CellKind::kFlop) {
+          members.push_back(cell_ids.at(cell));
         }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
+      }
+      for (int64_t k = 1; k < members.size(); ++k) {
+        edges.push_back({members[k - 1], members[k]});
       }
     }
+  });
 
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
-      }
+  UnionFind<int64_t> cell_to_uf;
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    cell_to_uf.Insert(i);
+  }
+  for (const std::vector<std::pair<int64_t, int64_t>>& edges : block_edges) {
+    for (const auto& [a, b] : edges) {
+      cell_to_uf.Union(a, b);
     }
   }
 
   // Run through the cells and put them into clusters according to their
   // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
-  }
-
-  // Put them into a vector and sort each cluster's internal cells for
-  // determinism.
-  std::vector<Cluster> clusters;
-  for (auto& item : equivalence_set_to_cluster) {
-    Cluster& cluster = item.second;
-    if (!include_vacuous && (cluster.terminating_flops().size() == 1 &&
-                             cluster.other_cells().empty())) {
-      // Vacuous 'just a flop' cluster.
-      continue;
+  absl::flat_hash_map<int64_t, int64_t> equivalence_set_to_cluster;
+  std::vector<Cluster> all_clusters;
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    auto [it, inserted] = equivalence_set_to_cluster.try_emplace(
+        cell_to_uf.Find(i), all_clusters.size());
+    if (inserted) {
+      all_clusters.emplace_back();
     }
-    cluster.SortCells();
-    clusters.push_back(std::move(cluster));
+    all_clusters[it->second].Add(cells[i].get());
+  }
+  VLOG(3) << absl::StreamFormat("%d equivalence classes for %d cells",
+                                all_clusters.size(), cells.size());
+  if (!include_vacuous) {
+    // Drop vacuous 'just a flop' clusters.
+    all_clusters.erase(
+        std::remove_if(all_clusters.begin(), all_clusters.end(),
+                       [](const Cluster& cluster) {
+                         return cluster.terminating_flops().size() == 1 &&
+                                cluster.other_cells().empty();
+                       }),
+        all_clusters.end());
   }
 
-  // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
+  // Sort each cluster's internal cells for determinism, then order the
+  // clusters. For convenience (for now) we convert the cell names to a string
+  // and rely on string comparison for deterministic order; the strings are
+  // built once per cluster rather than once per comparison.
   auto cells_to_str = [](absl::Span<const Cell* const> cells) {
     return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
       absl::StrAppend(out, cell->name());
     });
   };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
+  std::vector<std::pair<std::string, std::string>> sort_keys(
+      all_clusters.size());
+  ForEachBlock(all_clusters.size(), thread_count,
+               [&](int64_t begin, int64_t end) {
+                 for (int64_t i = begin; i < end; ++i) {
+                   all_clusters[i].SortCells();
+                   sort_keys[i] = {
+                       cells_to_str(all_clusters[i].terminating_flops()),
+                       cells_to_str(all_clusters[i].other_cells())};
+                 }
+               });
+  std::vector<int64_t> order(all_clusters.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return sort_keys[a] < sort_keys[b];
+  });
+  std::vector<Cluster> clusters;
+  clusters.reserve(order.size());
+  for (int64_t i : order) {
+    clusters.push_back(std::move(all_clusters[i]));
+  }
   return clusters;
 }
 
@@ -15,6 +15,7 @@
 #ifndef XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 #define XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -53,8 +54,12 @@ class Cluster {
 // include_vacuous indicates whether a terminating flop with no connected logic
 // (e.g. a layer of flops that flop input to the module) should be considered to
 // be a cluster, or just discarded.
+//
+// Connectivity is gathered and the clusters are sorted on up to
+// `thread_count` threads; the result does not depend on the thread count.
 std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous = false);
+                                     bool include_vacuous = false,
+                                     int64_t thread_count = 1);
 
 // Converts the clusters to a string suitable for debugging/testing.
 std::string ClustersToString(absl::Span<const Cluster> clusters);
@@ -14,13 +14,20 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <cstdint>
 #include <memory>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compact_netlist.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist_parser.h"
@@ -30,6 +37,57 @@ namespace netlist {
 namespace rtl {
 namespace {
 
+// Returns a pipeline of about `cell_count` cells of random AND logic between
+// stages of 64 flops, with occasional nets read by flops two stages on.
+std::unique_ptr<Module> MakeSyntheticModule(const CellLibrary& cell_library,
+                                            int64_t cell_count) {
+  constexpr int64_t kFlopsPerStage = 64;
+  constexpr int64_t kGatesPerStage = 15 * kFlopsPerStage;
+  const CellLibraryEntry* dff = cell_library.GetEntry("DFF").value();
+  const CellLibraryEntry* and_gate = cell_library.GetEntry("AND").value();
+  std::mt19937_64 rng(0);
+
+  CompactModule module("main");
+  CompactModule::NetId clk = module.AddNet("clk", NetDeclKind::kInput).value();
+  std::vector<CompactModule::NetId> stage_inputs;
+  for (int64_t i = 0; i < kFlopsPerStage; ++i) {
+    stage_inputs.push_back(
+        module.AddNet(absl::StrCat("in", i), NetDeclKind::kInput).value());
+  }
+  int64_t net_count = 0;
+  int64_t cells = 0;
+  while (cells < cell_count) {
+    std::vector<CompactModule::NetId> available = stage_inputs;
+    for (int64_t i = 0; i < kGatesPerStage; ++i) {
+      CompactModule::NetId a = available[rng() % available.size()];
+      CompactModule::NetId b = available[rng() % available.size()];
+      CompactModule::NetId z =
+          module.AddNet(absl::StrCat("n", net_count++), NetDeclKind::kWire)
+              .value();
+      CHECK_OK(module
+                   .AddCell(and_gate, absl::StrCat("c", cells++),
+                            {{"A", a}, {"B", b}, {"Z", z}})
+                   .status());
+      available.push_back(z);
+    }
+    std::vector<CompactModule::NetId> next_inputs;
+    for (int64_t i = 0; i < kFlopsPerStage; ++i) {
+      CompactModule::NetId q =
+          module.AddNet(absl::StrCat("n", net_count++), NetDeclKind::kWire)
+              .value();
+      CHECK_OK(module
+                   .AddCell(dff, absl::StrCat("c", cells++),
+                            {{"D", available[available.size() - 1 - i]},
+                             {"Q", q},
+                             {"CLK", clk}})
+                   .status());
+      next_inputs.push_back(q);
+    }
+    stage_inputs = std::move(next_inputs);
+  }
+  return module.ToModule().value();
+}
+
 TEST(ClusterTest, TwoSimpleClusters) {
   std::string netlist = R"(module main(clk, ai, ao);
   input clk;
@@ -133,6 +191,30 @@ cluster {
             ClustersToString(clusters));
 }
 
+TEST(ClusterTest, ThreadCountDoesNotChangeResult) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  std::unique_ptr<Module> module = MakeSyntheticModule(cell_library, 50000);
+  std::string expected = ClustersToString(
+      FindLogicClouds(*module, /*include_vacuous=*/true, /*thread_count=*/1));
+  EXPECT_EQ(ClustersToString(FindLogicClouds(*module, /*include_vacuous=*/true,
+                                             /*thread_count=*/4)),
+            expected);
+}
+
+void BM_FindLogicClouds(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::unique_ptr<Module> module =
+      MakeSyntheticModule(cell_library, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindLogicClouds(*module, /*include_vacuous=*/false,
+                                             /*thread_count=*/state.range(1)));
+  }
+  state.SetItemsProcessed(state.iterations() * module->cells().size());
+}
+BENCHMARK(BM_FindLogicClouds)
+    ->ArgsProduct({{10000, 100000, 1000000}, {1, 8}})
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -24,9 +25,11 @@
 #include <type_traits>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -39,7 +42,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/netlist/cell_library.h"
-#include "xls/netlist/function_parser.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.h"
 
 namespace xls {
@@ -128,7 +131,8 @@ class AbstractInterpreter {
       const rtl::AbstractCell<EvalT>* cell, AbstractNetRef2Value<EvalT>& wires);
 
   absl::StatusOr<EvalT> InterpretFunction(
-      const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
+      const rtl::AbstractCell<EvalT>& cell,
+      const function::CompiledFunction& function,
       const AbstractNetRef2Value<EvalT>& inputs);
 
   // Returns the value of the internal/output pin from the cell (defined by a
@@ -467,7 +471,6 @@ AbstractInterpreter<EvalT>::InterpretCell(
     return results;
   }
 
-  const auto& pins = entry->output_pin_to_function();
   for (int i = 0; i < cell->outputs().size(); i++) {
     if (cell->outputs()[i].eval != nullptr) {
       // The order of values in cell->inputs() is the same as the order of
@@ -481,9 +484,10 @@ AbstractInterpreter<EvalT>::InterpretCell(
       results.insert({cell->outputs()[i].netref, value});
     } else {
       XLS_ASSIGN_OR_RETURN(
-          function::Ast ast,
-          function::Parser::ParseFunction(pins.at(cell->outputs()[i].name)));
-      XLS_ASSIGN_OR_RETURN(EvalT value, InterpretFunction(*cell, ast, inputs));
+          const function::CompiledFunction* function,
+          entry->GetCompiledFunction(cell->outputs()[i].name));
+      XLS_ASSIGN_OR_RETURN(EvalT value,
+                           InterpretFunction(*cell, *function, inputs));
       results.insert({cell->outputs()[i].netref, value});
     }
   }
@@ -521,68 +525,35 @@ absl::Status AbstractInterpreter<EvalT>::ThreadBody() {
 
 template <typename EvalT>
 absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
-    const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
+    const rtl::AbstractCell<EvalT>& cell,
+    const function::CompiledFunction& function,
     const AbstractNetRef2Value<EvalT>& inputs) {
-  switch (ast.kind()) {
-    case function::Ast::Kind::kAnd: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs & rhs;
-    }
-    case function::Ast::Kind::kIdentifier: {
-      rtl::AbstractNetRef<EvalT> ref = nullptr;
-      for (const auto& input : cell.inputs()) {
-        if (input.name == ast.name()) {
-          ref = input.netref;
-        }
-      }
-
-      if (ref == nullptr) {
-        for (const auto& internal : cell.internal_pins()) {
-          if (internal.name == ast.name()) {
-            return InterpretStateTable(cell, internal.name, inputs);
-          }
-        }
-      }
-
-      if (ref == nullptr) {
-        return absl::NotFoundError(
-            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
-                            "or internal signals.",
-                            ast.name(), cell.name()));
-      }
-
-      return inputs.at(ref);
-    }
-    case function::Ast::Kind::kLiteralOne:
-      return one_;
-    case function::Ast::Kind::kLiteralZero:
-      return zero_;
-    case function::Ast::Kind::kNot: {
-      XLS_ASSIGN_OR_RETURN(EvalT value,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      return !value;
-    }
-    case function::Ast::Kind::kOr: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs | rhs;
-    }
-    case function::Ast::Kind::kXor: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs ^ rhs;
+  // The leading operands are the cell's inputs, which are in the order of the
+  // cell library entry's; the rest must be internal (state table) signals.
+  absl::InlinedVector<EvalT, 8> operands;
+  operands.reserve(function.operand_names().size());
+  for (const auto& input : cell.inputs()) {
+    operands.push_back(inputs.at(input.netref));
+  }
+  for (int64_t i = function.input_count(); i < function.operand_names().size();
+       ++i) {
+    const std::string& name = function.operand_names()[i];
+    absl::Span<const typename rtl::AbstractCell<EvalT>::Pin> internal_pins =
+        cell.internal_pins();
+    auto it = absl::c_find_if(
+        internal_pins, [&](const auto& pin) { return pin.name == name; });
+    if (it == internal_pins.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                          "or internal signals.",
+                          name, cell.name()));
     }
-    default:
-      return absl::InvalidArgumentError(
-          absl::StrCat("Unknown AST element type: ", ast.kind()));
+    XLS_ASSIGN_OR_RETURN(EvalT value,
+                         InterpretStateTable(cell, it->name, inputs));
+    operands.push_back(std::move(value));
   }
+  return function.Evaluate<EvalT>(
+      operands, function::DefaultFunctionOps<EvalT>(zero_, one_));
 }
 
 template <typename EvalT>
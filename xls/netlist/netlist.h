@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -111,6 +112,7 @@ class AbstractCell {
   absl::Span<const Pin> inputs() const { return inputs_; }
   absl::Span<const OutputPin> outputs() const { return outputs_; }
   absl::Span<const Pin> internal_pins() const { return internal_pins_; }
+  const std::optional<AbstractNetRef<EvalT>>& clock() const { return clock_; }
 
   absl::Status SetOutputEvalFn(std::string_view output_pin_name,
                                CellOutputEvalFn<EvalT> fn) {
@@ -516,7 +518,8 @@ class AbstractNetlist {
   // The AbstractNetlist itself manages the CellLibraryEntries corresponding to
   // the LUT4 cells that are used, which are identified by their LUT mask (i.e.
   // the 16 bit LUT_INIT parameter).
-  absl::flat_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_;
+  // A node_hash_map, as cells hold pointers to the entries.
+  absl::node_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_;
   std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules_;
 };
 
@@ -15,7 +15,9 @@
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
 
+#include <filesystem>  // NOLINT
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -39,15 +41,18 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
-#include "xls/netlist/function_extractor.h"
+#include "xls/netlist/cell_library_cache.h"
 #include "xls/netlist/interpreter.h"
-#include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
+ABSL_FLAG(std::string, cell_library_cache_dir, "",
+          "Optional directory in which to cache the cell library extracted "
+          "from --cell_library, so that later runs with an unchanged Liberty "
+          "file skip parsing it.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
 // TODO(rspringer): Eliminate the need for this flag.
@@ -78,14 +83,12 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
-  XLS_ASSIGN_OR_RETURN(
-      auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
-  XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                       netlist::function::ExtractFunctions(&char_stream));
-  return netlist::CellLibrary::FromProto(lib_proto);
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string dir = absl::GetFlag(FLAGS_cell_library_cache_dir);
+      !dir.empty()) {
+    cache_dir = dir;
+  }
+  return netlist::LoadCellLibrary(cell_library_path, cache_dir);
 }
 
 static absl::Status RealMain(const std::string& netlist_path,
@@ -14,8 +14,22 @@
 
 #include "xls/netlist/netlist_parser.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -24,6 +38,8 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 
@@ -293,6 +309,145 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
   }
 }
 
+absl::StatusOr<std::vector<ModuleText>> SplitModules(std::string_view text) {
+  auto is_name_char = [](char c) {
+    return isalpha(c) || isdigit(c) || c == '_';
+  };
+  std::vector<ModuleText> modules;
+  int64_t lineno = 0;
+  std::optional<size_t> module_start;
+  int64_t module_lineno = 0;
+  size_t i = 0;
+  // Skips to just past `end`, counting lines.
+  auto skip_past = [&](std::string_view end) {
+    size_t found = text.find(end, i);
+    size_t stop = found == std::string_view::npos ? text.size()
+                                                  : found + end.size();
+    lineno += std::count(text.begin() + i, text.begin() + stop, '\n');
+    i = stop;
+  };
+  while (i < text.size()) {
+    char c = text[i];
+    char next = i + 1 < text.size() ? text[i + 1] : '\0';
+    if (c == '/' && next == '/') {
+      skip_past("\n");
+      continue;
+    }
+    if (c == '/' && next == '*') {
+      i += 2;
+      skip_past("*/");
+      continue;
+    }
+    if (c == '(' && next == '*') {
+      i += 2;
+      skip_past("*)");
+      continue;
+    }
+    if (c == '\n') {
+      ++lineno;
+      ++i;
+      continue;
+    }
+    if (c == ' ' || c == '\t' || c == '\r') {
+      ++i;
+      continue;
+    }
+    if (!module_start.has_value()) {
+      // Outside of a module only the "module" keyword may appear; leave the
+      // error to the parser otherwise.
+      if (text.substr(i, 6) != "module" ||
+          (i + 6 < text.size() && is_name_char(text[i + 6]))) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected keyword 'module' @ %s",
+            Pos{lineno, 0}.ToHumanString()));
+      }
+      module_start = i;
+      module_lineno = lineno;
+      i += 6;
+      continue;
+    }
+    if (c == '\\') {
+      // Escaped names extend to the next whitespace.
+      while (i < text.size() && text[i] != ' ' && text[i] != '\t' &&
+             text[i] != '\n') {
+        ++i;
+      }
+      continue;
+    }
+    if (is_name_char(c)) {
+      size_t start = i;
+      while (i < text.size() && is_name_char(text[i])) {
+        ++i;
+      }
+      if (text.substr(start, i - start) == "endmodule") {
+        std::string_view module_text =
+            text.substr(*module_start, i - *module_start);
+        Scanner scanner(module_text, module_lineno);
+        XLS_RETURN_IF_ERROR(scanner.Pop().status());
+        XLS_ASSIGN_OR_RETURN(Token name, scanner.Pop());
+        if (name.kind != TokenKind::kName) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Expected module name @ %s", name.pos.ToHumanString()));
+        }
+        modules.push_back(ModuleText{.name = std::move(name.value),
+                                     .text = module_text,
+                                     .lineno = module_lineno});
+        module_start.reset();
+      }
+      continue;
+    }
+    ++i;
+  }
+  if (module_start.has_value()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module starting @ %s has no endmodule",
+        Pos{module_lineno, 0}.ToHumanString()));
+  }
+  return modules;
+}
+
+/* static */ absl::StatusOr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() == -1) {
+    return ErrnoToStatus(errno) << "Failed to open " << path;
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno) << "Failed to stat " << path;
+  }
+  size_t size = st.st_size;
+  if (size == 0) {
+    return MappedFile(nullptr, 0);
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatus(errno) << "Failed to map " << path;
+  }
+  return MappedFile(data, size);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
@@ -16,8 +16,12 @@
 #define XLS_NETLIST_NETLIST_PARSER_H_
 
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -36,9 +40,11 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/string_to_int.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 #include "xls/netlist/cell_library.h"
@@ -91,7 +97,10 @@ struct Token {
 // Token scanner for netlist files.
 class Scanner {
  public:
-  explicit Scanner(std::string_view text) : text_(text) {}
+  // `lineno` is the line of the input at which `text` starts, for use in
+  // positions.
+  explicit Scanner(std::string_view text, int64_t lineno = 0)
+      : text_(text), lineno_(lineno) {}
 
   absl::StatusOr<Token> Peek();
 
@@ -133,6 +142,42 @@ class Scanner {
   std::optional<Token> lookahead_;
 };
 
+// The text of a single module definition within a netlist.
+struct ModuleText {
+  std::string name;
+  // From the "module" keyword through "endmodule".
+  std::string_view text;
+  // Line of the input at which `text` starts.
+  int64_t lineno;
+};
+
+// Splits netlist text at module boundaries. This only skips over comments,
+// attributes and identifiers instead of tokenizing the text, so that the
+// modules can then be parsed concurrently.
+absl::StatusOr<std::vector<ModuleText>> SplitModules(std::string_view text);
+
+// A read-only memory mapping of a file.
+class MappedFile {
+ public:
+  static absl::StatusOr<MappedFile> Open(const std::filesystem::path& path);
+
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 template <typename EvalT = bool>
 class AbstractParser {
  public:
@@ -147,7 +192,47 @@ class AbstractParser {
     return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true});
   }
 
+  // Parses a netlist as above, but splits `text` at module boundaries and
+  // parses the modules concurrently on up to `thread_count` threads. As when
+  // parsing sequentially, a module may only instantiate modules defined before
+  // it; a module waits for those it instantiates to be parsed.
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, int64_t thread_count, EvalT zero,
+                       EvalT one);
+  template <typename = std::is_constructible<EvalT, bool>>
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, int64_t thread_count) {
+    return ParseNetlistParallel(cell_library, text, thread_count, EvalT{false},
+                                EvalT{true});
+  }
+
+  // Memory-maps the netlist file at `path` and parses it with
+  // ParseNetlistParallel().
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistFile(AbstractCellLibrary<EvalT>* cell_library,
+                   const std::filesystem::path& path, int64_t thread_count,
+                   EvalT zero, EvalT one) {
+    XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+    return ParseNetlistParallel(cell_library, file.contents(), thread_count,
+                                zero, one);
+  }
+  template <typename = std::is_constructible<EvalT, bool>>
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistFile(AbstractCellLibrary<EvalT>* cell_library,
+                   const std::filesystem::path& path, int64_t thread_count) {
+    return ParseNetlistFile(cell_library, path, thread_count, EvalT{false},
+                            EvalT{true});
+  }
+
  private:
+  // Returns the module with the given name defined earlier in the netlist, if
+  // any.
+  using ModuleResolver =
+      std::function<absl::StatusOr<std::optional<const AbstractModule<EvalT>*>>(
+          const std::string& name)>;
+
   explicit AbstractParser(AbstractCellLibrary<EvalT>* cell_library,
                           Scanner* scanner, EvalT zero, EvalT one)
       : cell_library_(cell_library),
@@ -285,6 +370,11 @@ class AbstractParser {
   // Cell library definitions are resolved against.
   AbstractCellLibrary<EvalT>* cell_library_;
 
+  // When parsing modules concurrently, resolves module names in place of the
+  // (incomplete) netlist, and guards the netlist's LUT cell entries.
+  ModuleResolver module_resolver_;
+  absl::Mutex* netlist_mutex_ = nullptr;
+
   // Set of (already-parsed) Modules that may be present in the AbstractModule
   // currently being processed as AbstractCell-type references.
   absl::flat_hash_map<std::string, AbstractModule<EvalT>> modules_;
@@ -438,7 +528,12 @@ template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
   XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-  auto maybe_module = netlist.MaybeGetModule(name);
+  std::optional<const AbstractModule<EvalT>*> maybe_module;
+  if (module_resolver_) {
+    XLS_ASSIGN_OR_RETURN(maybe_module, module_resolver_(name));
+  } else {
+    maybe_module = netlist.MaybeGetModule(name);
+  }
   if (maybe_module.has_value()) {
     return maybe_module.value()->AsCellLibraryEntry();
   }
@@ -454,6 +549,10 @@ AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
     XLS_ASSIGN_OR_RETURN(int64_t lut_mask, PopNumberOrError());
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
+    if (netlist_mutex_ != nullptr) {
+      absl::MutexLock lock(netlist_mutex_);
+      return netlist.GetOrCreateLut4CellEntry(lut_mask, zero_, one_);
+    }
     return netlist.GetOrCreateLut4CellEntry(lut_mask, zero_, one_);
   }
   return cell_library_->GetEntry(name);
@@ -797,6 +896,97 @@ AbstractParser<EvalT>::ParseNetlist(AbstractCellLibrary<EvalT>* cell_library,
   return std::move(netlist);
 }
 
+template <typename EvalT>
+absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+AbstractParser<EvalT>::ParseNetlistParallel(
+    AbstractCellLibrary<EvalT>* cell_library, std::string_view text,
+    int64_t thread_count, EvalT zero, EvalT one) {
+  XLS_ASSIGN_OR_RETURN(std::vector<ModuleText> module_texts,
+                       SplitModules(text));
+  const int64_t module_count = module_texts.size();
+  // Instances refer to the first module with a given name, as with
+  // AbstractNetlist::MaybeGetModule().
+  absl::flat_hash_map<std::string_view, int64_t> first_definitions;
+  for (int64_t i = 0; i < module_count; ++i) {
+    first_definitions.try_emplace(module_texts[i].name, i);
+  }
+
+  auto netlist = std::make_unique<AbstractNetlist<EvalT>>();
+  absl::Mutex netlist_mutex;
+  absl::Mutex mu;
+  std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules(module_count);
+  // Set once the corresponding module has been parsed (or failed to parse).
+  std::vector<std::optional<absl::Status>> results(module_count);
+
+  auto parse_module = [&](int64_t index)
+      -> absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> {
+    Scanner scanner(module_texts[index].text, module_texts[index].lineno);
+    AbstractParser<EvalT> p(cell_library, &scanner, zero, one);
+    p.netlist_mutex_ = &netlist_mutex;
+    p.module_resolver_ = [&, index](const std::string& name)
+        -> absl::StatusOr<std::optional<const AbstractModule<EvalT>*>> {
+      auto it = first_definitions.find(name);
+      if (it == first_definitions.end() || it->second >= index) {
+        return std::nullopt;
+      }
+      // Modules are claimed in order, so the dependency is already being
+      // parsed by some thread.
+      const int64_t dependency = it->second;
+      absl::MutexLock lock(&mu);
+      auto dependency_done = [&]() { return results[dependency].has_value(); };
+      mu.Await(absl::Condition(&dependency_done));
+      if (!results[dependency]->ok()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Module %s instantiates module %s, which failed to parse",
+            module_texts[index].name, name));
+      }
+      return modules[dependency].get();
+    };
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<AbstractModule<EvalT>> module,
+                         p.ParseModule(*netlist));
+    // The cell library entry is created lazily; create it now, before other
+    // threads can instantiate the module.
+    module->AsCellLibraryEntry();
+    return module;
+  };
+
+  std::atomic<int64_t> next_module = 0;
+  auto worker = [&]() {
+    while (true) {
+      int64_t index = next_module.fetch_add(1);
+      if (index >= module_count) {
+        return;
+      }
+      absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> module =
+          parse_module(index);
+      absl::MutexLock lock(&mu);
+      if (module.ok()) {
+        modules[index] = std::move(module).value();
+        results[index] = absl::OkStatus();
+      } else {
+        results[index] = module.status();
+      }
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < std::min(thread_count, module_count); ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  // Report the first error in file order, as sequential parsing would.
+  for (int64_t i = 0; i < module_count; ++i) {
+    XLS_RETURN_IF_ERROR(*results[i]);
+    netlist->AddModule(std::move(modules[i]));
+  }
+  return std::move(netlist);
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,7 +27,9 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/substitute.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/fake_cell_library.h"
@@ -447,6 +450,113 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+constexpr std::string_view kModuleHierarchy = R"(// module commented_out();
+module leaf(a, b, z);
+  input a, b;
+  output z;
+  (* src = "endmodule" *)
+  AND and0(.A(a), .B(b), .Z(z));
+endmodule
+/* module also_commented_out();
+endmodule */
+module \mid (a, b, c, z);
+  input a, b, c;
+  output z;
+  wire t;
+  leaf l0(.a(a), .b(b), .z(t));
+  OR or0(.A(t), .B(c), .Z(z));
+endmodule
+module main(a, b, c, d, z);
+  input a, b, c, d;
+  output z;
+  wire t0, t1;
+  \mid  m0(.a(a), .b(b), .c(c), .z(t0));
+  leaf l1(.a(t0), .b(d), .z(t1));
+  SB_LUT4 #(.LUT_INIT(16'h8000)) lut0(.I0(t1), .I1(a), .I2(b), .I3(c),
+                                      .O(z));
+endmodule
+)";
+
+TEST(NetlistParserTest, SplitModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ModuleText> modules,
+                           SplitModules(kModuleHierarchy));
+  ASSERT_EQ(modules.size(), 3);
+  EXPECT_EQ(modules[0].name, "leaf");
+  EXPECT_EQ(modules[0].lineno, 1);
+  EXPECT_TRUE(absl::StartsWith(modules[0].text, "module leaf"));
+  EXPECT_TRUE(absl::EndsWith(modules[0].text, "endmodule"));
+  EXPECT_EQ(modules[1].name, "\\mid");
+  EXPECT_EQ(modules[1].lineno, 9);
+  EXPECT_EQ(modules[2].name, "main");
+
+  EXPECT_THAT(SplitModules("module main(); wire a;"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("no endmodule")));
+  EXPECT_THAT(SplitModules("wire a; module main(); endmodule"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected keyword 'module'")));
+}
+
+TEST(NetlistParserTest, ParallelMatchesSequential) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  Scanner scanner(kModuleHierarchy);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> expected,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  for (int64_t thread_count : {1, 2, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<Netlist> n,
+        Parser::ParseNetlistParallel(&cell_library, kModuleHierarchy,
+                                     thread_count));
+    ASSERT_EQ(n->modules().size(), expected->modules().size());
+    for (int64_t i = 0; i < n->modules().size(); ++i) {
+      const Module* m = n->modules()[i].get();
+      const Module* e = expected->modules()[i].get();
+      EXPECT_EQ(m->name(), e->name());
+      EXPECT_EQ(m->nets().size(), e->nets().size());
+      ASSERT_EQ(m->cells().size(), e->cells().size());
+      for (int64_t j = 0; j < m->cells().size(); ++j) {
+        EXPECT_EQ(m->cells()[j]->name(), e->cells()[j]->name());
+        EXPECT_EQ(m->cells()[j]->cell_library_entry()->name(),
+                  e->cells()[j]->cell_library_entry()->name());
+      }
+    }
+    // Submodule instances refer to the modules in the same netlist.
+    XLS_ASSERT_OK_AND_ASSIGN(const Module* mid, n->GetModule("\\mid"));
+    XLS_ASSERT_OK_AND_ASSIGN(const Module* main, n->GetModule("main"));
+    XLS_ASSERT_OK_AND_ASSIGN(Cell * m0, main->ResolveCell("m0"));
+    EXPECT_EQ(m0->cell_library_entry(), mid->AsCellLibraryEntry());
+  }
+}
+
+TEST(NetlistParserTest, ParallelReportsFirstError) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  std::string netlist = R"(module a(x); input x; endmodule
+module b(x); input x; NOT_A_CELL c(.A(x)); endmodule
+module c(x); input x; b b0(.x(x)); endmodule
+module d(x); input x; OTHER_BAD_CELL c(.A(x)); endmodule
+)";
+  EXPECT_THAT(Parser::ParseNetlistParallel(&cell_library, netlist,
+                                           /*thread_count=*/4),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("NOT_A_CELL")));
+}
+
+TEST(NetlistParserTest, ParseNetlistFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::CreateWithContent(
+                                              kModuleHierarchy, ".v"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> n,
+      Parser::ParseNetlistFile(&cell_library, file.path(),
+                               /*thread_count=*/2));
+  EXPECT_EQ(n->modules().size(), 3);
+  XLS_EXPECT_OK(n->GetModule("main").status());
+
+  EXPECT_THAT(Parser::ParseNetlistFile(&cell_library,
+                                       file.path().string() + ".missing",
+                                       /*thread_count=*/2),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
@@ -30,12 +31,20 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compact_netlist.h"
 #include "xls/netlist/find_logic_clouds.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(bool, show_clusters, false, "Show the logic clusters found.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads to parse the netlist's modules with; the netlist "
+          "file is memory-mapped in this mode. If zero, the netlist is read "
+          "and parsed sequentially.");
+ABSL_FLAG(bool, show_compact_memory, false,
+          "Convert the module to the compact netlist representation and show "
+          "its memory usage.");
 
 namespace xls {
 namespace {
@@ -51,11 +60,17 @@ absl::Status RealMain(std::string_view netlist_path,
                          netlist::CellLibrary::FromProto(cell_library_proto));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<netlist::rtl::Netlist> netlist,
-      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  std::unique_ptr<netlist::rtl::Netlist> netlist;
+  if (int64_t threads = absl::GetFlag(FLAGS_threads); threads > 0) {
+    XLS_ASSIGN_OR_RETURN(netlist, netlist::rtl::Parser::ParseNetlistFile(
+                                      &cell_library, netlist_path, threads));
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::string netlist_text,
+                         GetFileContents(netlist_path));
+    netlist::rtl::Scanner scanner(netlist_text);
+    XLS_ASSIGN_OR_RETURN(
+        netlist, netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  }
   netlist::rtl::Module* module = netlist->modules()[0].get();
   std::cout << "nets:  " << module->nets().size() << '\n';
   std::cout << "cells: " << module->cells().size() << '\n';
@@ -73,8 +88,16 @@ absl::Status RealMain(std::string_view netlist_path,
               << '\n';
   }
 
+  if (absl::GetFlag(FLAGS_show_compact_memory)) {
+    XLS_ASSIGN_OR_RETURN(netlist::rtl::CompactModule compact,
+                         netlist::rtl::CompactModule::FromModule(*module));
+    std::cout << "compact bytes: " << compact.GetMemoryUsage() << '\n';
+  }
+
   std::vector<netlist::rtl::Cluster> clusters =
-      netlist::rtl::FindLogicClouds(*module);
+      netlist::rtl::FindLogicClouds(
+          *module, /*include_vacuous=*/false,
+          /*thread_count=*/std::max<int64_t>(absl::GetFlag(FLAGS_threads), 1));
   std::cout << "logic clusters: " << clusters.size() << '\n';
   if (absl::GetFlag(FLAGS_show_clusters)) {
     std::cout << netlist::rtl::ClustersToString(clusters) << '\n';
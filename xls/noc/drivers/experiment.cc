@@ -15,7 +15,9 @@
 #include "xls/noc/drivers/experiment.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +31,9 @@
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/drivers/experiment_results.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -141,23 +146,61 @@ absl::Status ExperimentMetrics::DebugDump() const {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
-    const ExperimentConfig& experiment_config,
-    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
-    const {
-  // Build and assign simulation objects.
-  NetworkManager graph;
-  NocParameters params;
+ExperimentMetricsProto ExperimentMetrics::ToProto() const {
+  ExperimentMetricsProto proto;
+  for (auto& [name, val] : float_metrics_) {
+    (*proto.mutable_float_metrics())[name] = val;
+  }
+  for (auto& [name, val] : integer_metrics_) {
+    (*proto.mutable_integer_metrics())[name] = val;
+  }
+  for (auto& [name, val] : integer_integer_map_metrics_) {
+    ExperimentIntegerMapMetricProto& map_proto =
+        (*proto.mutable_integer_integer_map_metrics())[name];
+    for (auto& [key, value] : val) {
+      (*map_proto.mutable_entries())[key] = value;
+    }
+  }
+  return proto;
+}
+
+absl::StatusOr<std::unique_ptr<ExperimentNetwork>>
+ExperimentRunner::BuildNetwork(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  auto network = std::make_unique<ExperimentNetwork>();
+  NetworkManager& graph = network->graph;
+  NocParameters& params = network->params;
 
-  XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
-      experiment_config.GetNetworkConfig(), &graph, &params));
+  XLS_RETURN_IF_ERROR(
+      BuildNetworkGraphFromProto(network_config, &graph, &params));
 
   // Create global routing table.
   XLS_ASSIGN_OR_RETURN(
-      DistributedRoutingTable routing_table,
+      network->routing_table,
       distributed_routing_table_builder.BuildNetworkRoutingTables(
           graph.GetNetworkIds()[0], graph, params));
 
+  return network;
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ExperimentNetwork> network,
+                       BuildNetwork(experiment_config.GetNetworkConfig(),
+                                    distributed_routing_table_builder));
+  return RunExperimentOnNetwork(experiment_config, *network);
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperimentOnNetwork(
+    const ExperimentConfig& experiment_config,
+    ExperimentNetwork& network) const {
+  NetworkManager& graph = network.graph;
+  NocParameters& params = network.params;
+  DistributedRoutingTable& routing_table = network.routing_table;
+
   // Build traffic model.
   RandomNumberInterface rnd;
   rnd.SetSeed(seed_);
@@ -180,6 +223,7 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   NocSimulator simulator;
   XLS_RET_CHECK_OK(simulator.Initialize(graph, params, routing_table,
                                         graph.GetNetworkIds()[0]));
+  simulator.SetSparseActivityMode(true);
   simulator.Dump();
 
   // Hook traffic injector and simulator together.
@@ -332,4 +376,68 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::StatusOr<ExperimentSweepResultsProto> Experiment::RunAllSteps(
+    int64_t thread_count,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_RET_CHECK_GT(thread_count, 0);
+
+  // Build the configs of all steps, and a single network for each distinct
+  // network config.
+  std::vector<ExperimentConfig> configs;
+  std::vector<ExperimentNetwork*> step_networks;
+  std::vector<std::unique_ptr<ExperimentNetwork>> networks;
+  absl::flat_hash_map<std::string, ExperimentNetwork*> network_by_config;
+  for (int64_t step = 0; step < GetStepCount(); ++step) {
+    XLS_ASSIGN_OR_RETURN(ExperimentConfig config, GetConfigForStep(step));
+    auto [iter, inserted] = network_by_config.try_emplace(
+        config.GetNetworkConfig().SerializeAsString(), nullptr);
+    if (inserted) {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<ExperimentNetwork> network,
+          ExperimentRunner::BuildNetwork(config.GetNetworkConfig(),
+                                         distributed_routing_table_builder));
+      iter->second = network.get();
+      networks.push_back(std::move(network));
+    }
+    step_networks.push_back(iter->second);
+    configs.push_back(std::move(config));
+  }
+  VLOG(1) << absl::StreamFormat("Running %d steps on %d networks",
+                                configs.size(), networks.size());
+
+  // Simulate the steps, each on its own simulator.
+  std::vector<absl::StatusOr<ExperimentData>> data(
+      configs.size(), absl::UnknownError("Step was not run"));
+  std::atomic<int64_t> next_step = 0;
+  auto run_steps = [&]() {
+    // Each worker runs its steps with its own copy of the runner.
+    ExperimentRunner runner = runner_;
+    for (int64_t step = next_step++; step < configs.size();
+         step = next_step++) {
+      data[step] =
+          runner.RunExperimentOnNetwork(configs[step], *step_networks[step]);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  int64_t worker_count = std::min<int64_t>(thread_count, configs.size());
+  for (int64_t i = 1; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(run_steps));
+  }
+  run_steps();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  ExperimentSweepResultsProto results;
+  for (int64_t step = 0; step < configs.size(); ++step) {
+    XLS_RETURN_IF_ERROR(data[step].status())
+        << absl::StreamFormat("in experiment step %d", step);
+    ExperimentStepResultProto* step_result = results.add_steps();
+    step_result->set_step(step);
+    *step_result->mutable_metrics() = data[step]->metrics.ToProto();
+  }
+  return results;
+}
+
 }  // namespace xls::noc
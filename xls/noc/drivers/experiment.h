@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -33,8 +34,11 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/drivers/experiment_results.pb.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/traffic_description.h"
 
 // This file contains classes used to construct different
@@ -146,6 +150,9 @@ class ExperimentMetrics {
   // Prints out the metrics and values stored.
   absl::Status DebugDump() const;
 
+  // Returns the metrics and values stored as a proto.
+  ExperimentMetricsProto ToProto() const;
+
  private:
   absl::btree_map<std::string, double> float_metrics_;
   absl::btree_map<std::string, absl::flat_hash_map<int64_t, int64_t>>
@@ -215,6 +222,16 @@ struct ExperimentData {
   ExperimentInfo info;
 };
 
+// A network built from a NetworkConfigProto along with its routing tables.
+//
+// The routing tables refer to the graph and parameters, so the object must
+// not be moved once built.
+struct ExperimentNetwork {
+  NetworkManager graph;
+  NocParameters params;
+  DistributedRoutingTable routing_table;
+};
+
 // Class to setup and run a single step of the experiment,
 // including the setup and initialization of the traffic model.
 class ExperimentRunner {
@@ -227,6 +244,20 @@ class ExperimentRunner {
       DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
           DistributedRoutingTableBuilderForTrees()) const;
 
+  // Builds the network and routing tables described by network_config.
+  static absl::StatusOr<std::unique_ptr<ExperimentNetwork>> BuildNetwork(
+      const NetworkConfigProto& network_config,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  // Runs the traffic of experiment_config on a network previously built from
+  // its network config.
+  //
+  // The network is only read, so several experiments may run on the same
+  // network concurrently.
+  absl::StatusOr<ExperimentData> RunExperimentOnNetwork(
+      const ExperimentConfig& experiment_config,
+      ExperimentNetwork& network) const;
+
   ExperimentRunner& SetSimulationCycleCount(int64_t count) {
     CHECK_GE(count, 0);
     total_simulation_cycle_count_ = count;
@@ -293,6 +324,16 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Runs every step and returns the metrics of each step.
+  //
+  // Steps with identical network configs share a single network and routing
+  // table, which are built once, and up to thread_count steps are simulated
+  // concurrently on separate simulators.
+  absl::StatusOr<ExperimentSweepResultsProto> RunAllSteps(
+      int64_t thread_count,
+      DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
+          DistributedRoutingTableBuilderForTrees()) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
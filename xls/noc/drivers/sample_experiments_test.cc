@@ -26,6 +26,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/noc/drivers/experiment.h"
 #include "xls/noc/drivers/experiment_factory.h"
+#include "xls/noc/drivers/experiment_results.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 
@@ -220,5 +221,36 @@ TEST(SampleExperimentsTest, AggregateTreeTest) {
   }
 }
 
+TEST(SampleExperimentsTest, RunAllStepsMatchesRunStep) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ExperimentSweepResultsProto results,
+                           experiment.RunAllSteps(/*thread_count=*/2));
+  ASSERT_EQ(results.steps_size(), experiment.GetStepCount());
+
+  for (int64_t i = 0; i < experiment.GetStepCount(); ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData data, experiment.RunStep(i));
+    ExperimentMetricsProto expected = data.metrics.ToProto();
+    const ExperimentMetricsProto& actual = results.steps(i).metrics();
+    EXPECT_EQ(results.steps(i).step(), i);
+
+    EXPECT_EQ(actual.float_metrics_size(), expected.float_metrics_size());
+    for (const auto& [name, value] : expected.float_metrics()) {
+      ASSERT_TRUE(actual.float_metrics().contains(name)) << name;
+      EXPECT_EQ(actual.float_metrics().at(name), value) << name;
+    }
+    EXPECT_EQ(actual.integer_metrics_size(), expected.integer_metrics_size());
+    for (const auto& [name, value] : expected.integer_metrics()) {
+      ASSERT_TRUE(actual.integer_metrics().contains(name)) << name;
+      EXPECT_EQ(actual.integer_metrics().at(name), value) << name;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -70,6 +70,10 @@ struct DataFlit {
   int16_t data_bit_count;
   Bits data;
 
+  // Next hop of the source route of the flit, set by the source when source
+  // routing (see DistributedRoutingTable::GetSourceRouteStart).
+  int32_t source_route = -1;
+
   std::string ToString() const {
     return absl::StrFormat(
         "{type: %s (%d), source_index: %d, dest_index: %d, "
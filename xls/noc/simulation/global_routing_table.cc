@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <queue>
@@ -268,6 +269,161 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
   return absl::OkStatus();
 }
 
+absl::Status DistributedRoutingTable::CompileRoutes(NetworkId network_id) {
+  const Network& network = network_manager_->GetNetwork(network_id);
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+
+  // Returns the number of vcs of a port, ports without vcs using a single
+  // default vc.
+  auto get_vc_count = [&](PortId port_id) -> absl::StatusOr<int64_t> {
+    XLS_ASSIGN_OR_RETURN(PortParam port_param,
+                         network_parameters_->GetPortParam(port_id));
+    return std::max<int64_t>(port_param.VirtualChannelCount(), 1);
+  };
+
+  // Compile the routing table of each router.
+  if (compiled_routing_tables_.size() <= network_id.id()) {
+    compiled_routing_tables_.resize(network_id.id() + 1);
+  }
+  std::vector<CompiledRouterRoutingTable>& compiled_tables =
+      compiled_routing_tables_[network_id.id()];
+  compiled_tables.assign(routing_tables_.at(network_id.id()).size(),
+                         CompiledRouterRoutingTable());
+
+  for (const NetworkComponent& nc : network.GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t input_port_count,
+                         port_indices_.InputPortCount(nc.id()));
+    std::vector<PortId> input_ports;
+    CompiledRouterRoutingTable& compiled = compiled_tables.at(nc.id().id());
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          PortId port_id,
+          port_indices_.GetPortByIndex(nc.id(), PortDirection::kInput, i));
+      XLS_ASSIGN_OR_RETURN(int64_t vc_count, get_vc_count(port_id));
+      compiled.vc_count = std::max(compiled.vc_count, vc_count);
+      input_ports.push_back(port_id);
+    }
+    compiled.destination_count = destination_count;
+    compiled.routes.resize(
+        input_port_count * compiled.vc_count * destination_count,
+        PortIndexAndVCIndex{-1, 0});
+
+    const RouterRoutingTable& table = GetRoutingTable(nc.id());
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      if (input_ports[i].id() >= table.routes.size()) {
+        continue;
+      }
+      const std::vector<PortRoutingList>& port_routes =
+          table.routes[input_ports[i].id()];
+      for (int64_t vc = 0; vc < port_routes.size(); ++vc) {
+        for (const auto& [destination_index, hop] : port_routes[vc]) {
+          PortIndexAndVCIndex& route = compiled.routes.at(
+              (i * compiled.vc_count + vc) * destination_count +
+              destination_index);
+          // Only the first matching route is used.
+          if (route.port_index_ != -1) {
+            continue;
+          }
+          XLS_ASSIGN_OR_RETURN(
+              route.port_index_,
+              port_indices_.GetPortIndex(hop.port_id_, PortDirection::kOutput));
+          route.vc_index_ = hop.vc_index_;
+        }
+      }
+    }
+  }
+
+  // Trace the source route between every source, vc and sink.
+  source_vc_count_ = 0;
+  for (NetworkComponentId source : source_indices_.GetNetworkComponents()) {
+    PortId port_id =
+        network_manager_->GetNetworkComponent(source).GetPortIdByIndex(0);
+    XLS_ASSIGN_OR_RETURN(int64_t vc_count, get_vc_count(port_id));
+    source_vc_count_ = std::max(source_vc_count_, vc_count);
+  }
+  source_route_starts_.assign(source_indices_.NetworkComponentCount() *
+                                  source_vc_count_ * destination_count,
+                              kNoSourceRoute);
+  source_route_hops_.clear();
+
+  for (int64_t source_index = 0;
+       source_index < source_indices_.NetworkComponentCount();
+       ++source_index) {
+    NetworkComponentId source =
+        source_indices_.GetNetworkComponents()[source_index];
+    PortId source_port =
+        network_manager_->GetNetworkComponent(source).GetPortIdByIndex(0);
+    XLS_ASSIGN_OR_RETURN(int64_t vc_count, get_vc_count(source_port));
+
+    for (int64_t vc = 0; vc < vc_count; ++vc) {
+      for (int64_t destination_index = 0;
+           destination_index < destination_count; ++destination_index) {
+        NetworkComponentId sink =
+            sink_indices_.GetNetworkComponents()[destination_index];
+        PortId final_port =
+            network_manager_->GetNetworkComponent(sink).GetPortIdByIndex(0);
+
+        std::vector<PortIndexAndVCIndex> hops;
+        PortAndVCIndex current{source_port, vc};
+        bool found = true;
+        for (int64_t step = 0; current.port_id_ != final_port; ++step) {
+          // A path without loops crosses each connection at most once, so
+          // longer routes loop and are left to the routing tables.
+          if (step > 2 * network.GetConnectionCount()) {
+            found = false;
+            break;
+          }
+          NetworkComponentId nc_id = current.port_id_.GetNetworkComponentId();
+          if (network_manager_->GetNetworkComponent(nc_id).kind() ==
+                  NetworkComponentKind::kRouter &&
+              network_manager_->GetPort(current.port_id_).direction() ==
+                  PortDirection::kInput) {
+            // Follow and record the compiled route of the router.
+            XLS_ASSIGN_OR_RETURN(int64_t input_port_index,
+                                 port_indices_.GetPortIndex(
+                                     current.port_id_, PortDirection::kInput));
+            const PortIndexAndVCIndex& route =
+                GetCompiledRouterRoutingTable(nc_id).GetRoute(
+                    input_port_index, current.vc_index_, destination_index);
+            if (route.port_index_ == -1) {
+              found = false;
+              break;
+            }
+            hops.push_back(route);
+            XLS_ASSIGN_OR_RETURN(
+                current.port_id_,
+                port_indices_.GetPortByIndex(nc_id, PortDirection::kOutput,
+                                             route.port_index_));
+            current.vc_index_ = route.vc_index_;
+            continue;
+          }
+
+          absl::StatusOr<PortAndVCIndex> next = GetNextHopPort(current, sink);
+          if (!next.ok()) {
+            found = false;
+            break;
+          }
+          current = *next;
+        }
+
+        if (!found) {
+          continue;
+        }
+        source_route_starts_[(source_index * source_vc_count_ + vc) *
+                                 destination_count +
+                             destination_index] = source_route_hops_.size();
+        source_route_hops_.insert(source_route_hops_.end(), hops.begin(),
+                                  hops.end());
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
                                                       int64_t component_count) {
   int64_t network_index = network_id.id();
@@ -372,6 +528,7 @@ DistributedRoutingTableBuilderForTrees::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.CompileRoutes(network_id));
 
   return routing_table;
 }
@@ -501,6 +658,7 @@ DistributedRoutingTableBuilderForMultiplePaths::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.CompileRoutes(network_id));
 
   return routing_table;
 }
@@ -74,6 +74,30 @@ class DistributedRoutingTable {
     std::vector<std::vector<PortRoutingList>> routes;
   };
 
+  // The routing table of a router compiled into a dense array, so that a
+  // route is found without any search.
+  //
+  // routes[(input_port_index * vc_count + vc_index) * destination_count
+  //        + destination_index]
+  //   is the output port index and vc of the route, or has a port index of
+  //   -1 if there is no route.
+  struct CompiledRouterRoutingTable {
+    int64_t vc_count = 0;
+    int64_t destination_count = 0;
+    std::vector<PortIndexAndVCIndex> routes;
+
+    const PortIndexAndVCIndex& GetRoute(int64_t input_port_index,
+                                        int64_t vc_index,
+                                        int64_t destination_index) const {
+      return routes[(input_port_index * vc_count + vc_index) *
+                        destination_count +
+                    destination_index];
+    }
+  };
+
+  // Denotes that there is no source route between a source and a sink.
+  static constexpr int64_t kNoSourceRoute = -1;
+
   // Returns route to destination from a particular source network interface
   // to a sink network interface.
   //
@@ -107,8 +131,30 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Returns the compiled routing table of a router.
+  const CompiledRouterRoutingTable& GetCompiledRouterRoutingTable(
+      NetworkComponentId nc_id) const {
+    return compiled_routing_tables_[nc_id.network()][nc_id.id()];
+  }
+
+  // Returns the start of the source route of flits leaving the source with
+  // the given index on a vc towards a destination (sink) index, or
+  // kNoSourceRoute.
+  //
+  // A source route is the list of the router hops of the path, each hop
+  // being the output port index and vc taken at the router; the hops of a
+  // route are consecutive and read with GetSourceRouteHop().
+  int64_t GetSourceRouteStart(int64_t source_index, int64_t vc_index,
+                              int64_t destination_index) const {
+    return source_route_starts_[(source_index * source_vc_count_ + vc_index) *
+                                    sink_indices_.NetworkComponentCount() +
+                                destination_index];
+  }
+
+  // Returns a hop of a source route, see GetSourceRouteStart().
+  const PortIndexAndVCIndex& GetSourceRouteHop(int64_t hop) const {
+    return source_route_hops_[hop];
+  }
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -136,6 +182,12 @@ class DistributedRoutingTable {
   // number of components in a network.
   void AllocateTableForNetwork(NetworkId network_id, int64_t component_count);
 
+  // Compiles the routing tables of the routers of a network and the source
+  // routes between every source and sink.
+  //
+  // Must be called once all routes are added.
+  absl::Status CompileRoutes(NetworkId network_id);
+
   // Get (and create if necessary) routing table associated for a component.
   RouterRoutingTable& GetRoutingTable(NetworkComponentId nc_id) {
     return routing_tables_[nc_id.network()][nc_id.id()];
@@ -164,6 +216,15 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Compiled routing tables of all components, indexed as routing_tables_.
+  std::vector<std::vector<CompiledRouterRoutingTable>> compiled_routing_tables_;
+
+  // Start of each source route, indexed by source, vc and sink index, and the
+  // hops of all source routes.
+  int64_t source_vc_count_ = 0;
+  std::vector<int64_t> source_route_starts_;
+  std::vector<PortIndexAndVCIndex> source_route_hops_;
 };
 
 // Abstract base class for distributed routing table builder.
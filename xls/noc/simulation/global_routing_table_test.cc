@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -29,6 +30,8 @@
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/config/network_config_proto_builder.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/indexer.h"
+#include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
@@ -287,6 +290,91 @@ TEST(GlobalRoutingTableTest, RouterLoop) {
   EXPECT_EQ(route01[6], recvport1);
 }
 
+TEST(GlobalRoutingTableTest, CompiledRoutes) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLoop000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  const PortIndexMap& port_indices = routing_table.GetPortIndices();
+  int64_t sink_count = routing_table.GetSinkIndices().NetworkComponentCount();
+
+  // The compiled tables of the routers hold the same routes as the routing
+  // tables.
+  int64_t route_count = 0;
+  for (const NetworkComponent& nc :
+       graph.GetNetwork(graph.GetNetworkIds()[0]).GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    const DistributedRoutingTable::CompiledRouterRoutingTable& compiled =
+        routing_table.GetCompiledRouterRoutingTable(nc.id());
+    for (PortId port : nc.GetInputPortIds()) {
+      XLS_ASSERT_OK_AND_ASSIGN(int64_t port_index,
+                               port_indices.GetPortIndex(
+                                   port, PortDirection::kInput));
+      XLS_ASSERT_OK_AND_ASSIGN(PortParam port_param,
+                               params.GetPortParam(port));
+      for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
+        for (int64_t sink = 0; sink < sink_count; ++sink) {
+          const PortIndexAndVCIndex& route =
+              compiled.GetRoute(port_index, vc, sink);
+          absl::StatusOr<PortAndVCIndex> expected =
+              routing_table.GetRouterOutputPortByIndex(
+                  PortAndVCIndex{port, vc}, sink);
+          if (!expected.ok()) {
+            EXPECT_EQ(route.port_index_, -1);
+            continue;
+          }
+          XLS_ASSERT_OK_AND_ASSIGN(
+              int64_t expected_port_index,
+              port_indices.GetPortIndex(expected->port_id_,
+                                        PortDirection::kOutput));
+          EXPECT_EQ(route.port_index_, expected_port_index);
+          EXPECT_EQ(route.vc_index_, expected->vc_index_);
+          ++route_count;
+        }
+      }
+    }
+  }
+  EXPECT_GT(route_count, 0);
+
+  // The route from SendPort0 to RecvPort1 goes through both routers, leaving
+  // RouterB on Bout0.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId sendport0,
+      FindNetworkComponentByName("SendPort0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recvport1,
+      FindNetworkComponentByName("RecvPort1", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t source_index,
+      routing_table.GetSourceIndices().GetNetworkComponentIndex(sendport0));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t sink_index,
+      routing_table.GetSinkIndices().GetNetworkComponentIndex(recvport1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId routerb_id,
+      FindNetworkComponentByName("RouterB", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(PortId bout0,
+                           FindPortByName("Bout0", graph, params));
+
+  int64_t start = routing_table.GetSourceRouteStart(
+      source_index, /*vc_index=*/0, sink_index);
+  ASSERT_NE(start, DistributedRoutingTable::kNoSourceRoute);
+  const PortIndexAndVCIndex& last_hop =
+      routing_table.GetSourceRouteHop(start + 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortId last_port,
+      port_indices.GetPortByIndex(routerb_id, PortDirection::kOutput,
+                                  last_hop.port_index_));
+  EXPECT_EQ(last_port, bout0);
+}
+
 TEST(GlobalRoutingTableTest, MultiplePathsBetweenRouters) {
   // Build and assign simulation objects
   NetworkConfigProto proto;
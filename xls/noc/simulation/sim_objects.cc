@@ -15,6 +15,10 @@
 #include "xls/noc/simulation/sim_objects.h"
 
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <queue>
 #include <utility>
 #include <vector>
@@ -25,9 +29,11 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
@@ -132,6 +138,89 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
 
 }  // namespace
 
+// Runs a function for each region of a parallel simulation.
+//
+// The function is run for region zero on the calling thread and for each
+// other region on a dedicated thread which is kept alive across cycles.
+class NocSimulator::RegionWorkers {
+ public:
+  explicit RegionWorkers(int64_t region_count) {
+    for (int64_t i = 1; i < region_count; ++i) {
+      threads_.push_back(std::make_unique<Thread>([this, i]() { Work(i); }));
+    }
+  }
+
+  ~RegionWorkers() {
+    {
+      absl::MutexLock lock(&mu_);
+      shutdown_ = true;
+    }
+    for (std::unique_ptr<Thread>& thread : threads_) {
+      thread->Join();
+    }
+  }
+
+  // Runs fn for every region and waits for all of them to finish.
+  // Returns true if fn returned true for every region.
+  bool Run(const std::function<bool(int64_t)>& fn) {
+    {
+      absl::MutexLock lock(&mu_);
+      fn_ = &fn;
+      pending_ = threads_.size();
+      all_true_ = true;
+      ++generation_;
+    }
+    bool result = fn(0);
+
+    absl::MutexLock lock(&mu_);
+    auto done = [this]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+      return pending_ == 0;
+    };
+    mu_.Await(absl::Condition(&done));
+    fn_ = nullptr;
+    return result && all_true_;
+  }
+
+ private:
+  void Work(int64_t region) {
+    int64_t seen_generation = 0;
+    while (true) {
+      const std::function<bool(int64_t)>* fn;
+      {
+        absl::MutexLock lock(&mu_);
+        auto ready = [&]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+          return shutdown_ || generation_ != seen_generation;
+        };
+        mu_.Await(absl::Condition(&ready));
+        if (shutdown_) {
+          return;
+        }
+        seen_generation = generation_;
+        fn = fn_;
+      }
+
+      bool result = (*fn)(region);
+
+      absl::MutexLock lock(&mu_);
+      all_true_ = all_true_ && result;
+      --pending_;
+    }
+  }
+
+  absl::Mutex mu_;
+  const std::function<bool(int64_t)>* fn_ ABSL_GUARDED_BY(mu_) = nullptr;
+  int64_t generation_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t pending_ ABSL_GUARDED_BY(mu_) = 0;
+  bool all_true_ ABSL_GUARDED_BY(mu_) = true;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+NocSimulator::NocSimulator()
+    : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+
+NocSimulator::~NocSimulator() = default;
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
   Network& network_obj = mgr_->GetNetwork(network);
 
@@ -267,8 +356,32 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
+  if (sparse_activity_mode_ && network_idle_ && AreSourcesIdle()) {
+    // Nothing is in flight and nothing was injected, so ticking the network
+    // would leave it in the same state.
+    VLOG(2) << "Network idle, skipping cycle";
+    ++skipped_cycle_count_;
+  } else {
+    XLS_RETURN_IF_ERROR(TickToConvergence(max_ticks));
+    if (sparse_activity_mode_) {
+      network_idle_ = IsNetworkIdle();
+    }
+  }
+
+  for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+    XLS_RET_CHECK_OK(svc->RunCycle());
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status NocSimulator::TickToConvergence(int64_t max_ticks) {
   bool converged = false;
   int64_t nticks = 0;
+  if (!regions_.empty()) {
+    XLS_RETURN_IF_ERROR(RunParallelCycle(max_ticks));
+    converged = true;
+  }
   while (!converged) {
     VLOG(2) << absl::StreamFormat("Tick %d", nticks);
     converged = Tick();
@@ -293,11 +406,45 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     }
   }
 
-  for (NocSimulatorServiceShim* svc : post_cycle_services_) {
-    XLS_RET_CHECK_OK(svc->RunCycle());
+  return absl::OkStatus();
+}
+
+bool NocSimulator::IsNetworkIdle() const {
+  // Cheaper checks first, as the network is usually busy.
+  if (!AreSourcesIdle()) {
+    return false;
   }
+  for (const SimInputBufferedVCRouter& nc : routers_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  for (const SimConnectionState& connection : connections_) {
+    if (connection.forward_channels.flit.type != FlitType::kInvalid) {
+      return false;
+    }
+    for (const TimedMetadataFlit& credit : connection.reverse_channels) {
+      if (credit.flit.type != FlitType::kInvalid &&
+          !credit.flit.data.IsZero()) {
+        return false;
+      }
+    }
+  }
+  for (const SimLink& nc : links_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  return absl::OkStatus();
+bool NocSimulator::AreSourcesIdle() const {
+  for (const SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool NocSimulator::Tick() {
@@ -414,6 +561,64 @@ absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   return absl::OkStatus();
 }
 
+int64_t DataFlitBufferPool::AddBuffer(int64_t capacity) {
+  int64_t offset =
+      buffers_.empty() ? 0 : buffers_.back().offset + buffers_.back().capacity;
+  buffers_.push_back(Ring{offset, capacity, 0, 0});
+  return buffers_.size() - 1;
+}
+
+void DataFlitBufferPool::Allocate() {
+  int64_t total_capacity =
+      buffers_.empty() ? 0 : buffers_.back().offset + buffers_.back().capacity;
+  flits_.resize(total_capacity);
+  metadata_.resize(total_capacity);
+}
+
+void DataFlitBufferPool::Push(int64_t buffer, const DataFlit& flit,
+                              const TimedDataFlitInfo& metadata) {
+  Ring& ring = buffers_[buffer];
+  CHECK_LT(ring.size, ring.capacity) << "Overflow of flit buffer " << buffer;
+  int64_t slot = ring.head + ring.size;
+  if (slot >= ring.capacity) {
+    slot -= ring.capacity;
+  }
+  flits_[ring.offset + slot] = flit;
+  metadata_[ring.offset + slot] = metadata;
+  ++ring.size;
+  ++total_size_;
+}
+
+void DataFlitBufferPool::Pop(int64_t buffer) {
+  Ring& ring = buffers_[buffer];
+  CHECK_GT(ring.size, 0) << "Underflow of flit buffer " << buffer;
+  ++ring.head;
+  if (ring.head == ring.capacity) {
+    ring.head = 0;
+  }
+  --ring.size;
+  --total_size_;
+}
+
+bool SimLink::IsIdle() const {
+  // Pipeline stages keep holding bubbles once traffic has drained.
+  std::queue<TimedDataFlit> data_stages = forward_data_stages_;
+  for (; !data_stages.empty(); data_stages.pop()) {
+    if (data_stages.front().flit.type != FlitType::kInvalid) {
+      return false;
+    }
+  }
+  for (std::queue<TimedMetadataFlit> credit_stages : reverse_credit_stages_) {
+    for (; !credit_stages.empty(); credit_stages.pop()) {
+      const MetadataFlit& flit = credit_stages.front().flit;
+      if (flit.type != FlitType::kInvalid && !flit.data.IsZero()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -435,6 +640,11 @@ absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
 
   sink_connection_index_ = simulator.GetConnectionIndex(sink_connection);
 
+  XLS_ASSIGN_OR_RETURN(source_index_,
+                       simulator.GetRoutingTable()
+                           ->GetSourceIndices()
+                           .GetNetworkComponentIndex(id_));
+
   return absl::OkStatus();
 }
 
@@ -461,10 +671,9 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
   std::vector<VirtualChannelParam> vc_params = port_param.GetVirtualChannels();
   int64_t virtual_channel_count = port_param.VirtualChannelCount();
 
-  input_buffers_.resize(virtual_channel_count);
-
+  input_buffer_depths_.resize(virtual_channel_count);
   for (int64_t vc = 0; vc < virtual_channel_count; ++vc) {
-    input_buffers_[vc].max_queue_size = vc_params[vc].GetDepth();
+    input_buffer_depths_[vc] = vc_params[vc].GetDepth();
   }
 
   NetworkManager* network_manager = simulator.GetNetworkManager();
@@ -477,6 +686,34 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
   return absl::OkStatus();
 }
 
+bool SimNetworkInterfaceSrc::IsIdle() const {
+  for (const std::queue<TimedDataFlit>& send_queue : data_to_send_) {
+    if (!send_queue.empty()) {
+      return false;
+    }
+  }
+  for (const CreditState& update : credit_update_) {
+    if (update.credit != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SimInputBufferedVCRouter::IsIdle() const {
+  if (!input_buffers_.AllEmpty()) {
+    return false;
+  }
+  for (const std::vector<CreditState>& port_updates : credit_update_) {
+    for (const CreditState& update : port_updates) {
+      if (update.credit != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 int64_t SimInputBufferedVCRouter::GetUtilizationCycleCount() const {
   return utilization_cycle_count_;
 }
@@ -495,7 +732,9 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   absl::Span<int64_t> input_indices = simulator.GetConnectionIndicesStore(
       input_connection_index_start_, input_connection_count_);
 
-  input_buffers_.resize(input_connection_count_);
+  input_buffers_ = DataFlitBufferPool();
+  input_buffer_start_.resize(input_connection_count_);
+  input_vc_count_.resize(input_connection_count_);
   input_credit_to_send_.resize(input_connection_count_);
   max_vc_ = 0;
   for (int64_t i = 0; i < input_connection_count_; ++i) {
@@ -510,9 +749,10 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     std::vector<VirtualChannelParam> vc_params =
         port_param.GetVirtualChannels();
 
-    input_buffers_[i].resize(port_param.VirtualChannelCount());
+    input_buffer_start_[i] = input_buffers_.BufferCount();
+    input_vc_count_[i] = port_param.VirtualChannelCount();
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
-      input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_.AddBuffer(vc_params[vc].GetDepth());
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -520,6 +760,8 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     }
   }
 
+  input_buffers_.Allocate();
+
   // Setup structures associated with the outputs.
   //  - output to SimConnectionState (output_connection_index_start_ and count_)
   //  - credits associated with the outputs
@@ -628,6 +870,12 @@ bool SimNetworkInterfaceSrc::TryForwardPropagation(NocSimulator& simulator) {
       if (credit_[vc] > 0) {
         sink.forward_channels.flit = send_queue.front().flit;
         sink.forward_channels.flit.vc = vc;
+        if (simulator.IsSourceRouting()) {
+          sink.forward_channels.flit.source_route =
+              simulator.GetRoutingTable()->GetSourceRouteStart(
+                  source_index_, vc,
+                  sink.forward_channels.flit.destination_index);
+        }
         sink.forward_channels.cycle = current_cycle;
         sink.forward_channels.metadata = send_queue.front().metadata;
         sink.forward_channels.metadata.timed_route_info.route.push_back(
@@ -708,23 +956,19 @@ absl::StatusOr<SimInputBufferedVCRouter::PortIndexAndVCIndex>
 SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
     NocSimulator& simulator, PortIndexAndVCIndex input,
     int64_t destination_index) {
-  DistributedRoutingTable* routes = simulator.GetRoutingTable();
-
-  XLS_ASSIGN_OR_RETURN(PortId input_port,
-                       routes->GetPortIndices().GetPortByIndex(
-                           GetId(), PortDirection::kInput, input.port_index));
-
-  PortAndVCIndex port_from{input_port, input.vc_index};
-
-  XLS_ASSIGN_OR_RETURN(
-      PortAndVCIndex port_to,
-      routes->GetRouterOutputPortByIndex(port_from, destination_index));
-
-  XLS_ASSIGN_OR_RETURN(int64_t output_port_index,
-                       routes->GetPortIndices().GetPortIndex(
-                           port_to.port_id_, PortDirection::kOutput));
+  const DistributedRoutingTable::CompiledRouterRoutingTable& routes =
+      simulator.GetRoutingTable()->GetCompiledRouterRoutingTable(GetId());
+
+  const ::xls::noc::PortIndexAndVCIndex& route =
+      routes.GetRoute(input.port_index, input.vc_index, destination_index);
+  if (route.port_index_ == -1) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Router %x has no route from port index %d vc %d to destination %d",
+        GetId().AsUInt64(), input.port_index, input.vc_index,
+        destination_index));
+  }
 
-  return PortIndexAndVCIndex{output_port_index, port_to.vc_index_};
+  return PortIndexAndVCIndex{route.port_index_, route.vc_index_};
 }
 
 bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
@@ -793,8 +1037,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
-          {input.forward_channels.flit, input.forward_channels.metadata});
+      input_buffers_.Push(input_buffer_start_[i] + vc,
+                          input.forward_channels.flit,
+                          input.forward_channels.metadata);
 
       VLOG(2) << absl::StrFormat(
           "... router %x from %x received data %s port %d vc %d",
@@ -806,26 +1051,34 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   // Use fixed priority to route to output ports.
   // Priority goes to the port with the least vc and the least port index.
   for (int64_t vc = 0; vc < max_vc_; ++vc) {
-    for (int64_t i = 0; i < input_buffers_.size(); ++i) {
-      if (vc >= input_buffers_[i].size()) {
+    for (int64_t i = 0; i < input_connection_count_; ++i) {
+      if (vc >= input_vc_count_[i]) {
         continue;
       }
 
       // See if we have a flit to route and can route it.
-      if (input_buffers_[i][vc].queue.empty()) {
+      int64_t buffer = input_buffer_start_[i] + vc;
+      if (input_buffers_.Empty(buffer)) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      const DataFlit& flit = input_buffers_.FrontFlit(buffer);
       int64_t destination_index = flit.destination_index;
 
-      PortIndexAndVCIndex input{i, vc};
-      absl::StatusOr<PortIndexAndVCIndex> output_status =
-          GetDestinationPortIndexAndVcIndex(simulator, input,
-                                            destination_index);
-      CHECK_OK(output_status.status());
-      PortIndexAndVCIndex output = output_status.value();
+      PortIndexAndVCIndex output;
+      if (simulator.IsSourceRouting() &&
+          flit.source_route != DistributedRoutingTable::kNoSourceRoute) {
+        const ::xls::noc::PortIndexAndVCIndex& hop =
+            simulator.GetRoutingTable()->GetSourceRouteHop(flit.source_route);
+        output = PortIndexAndVCIndex{hop.port_index_, hop.vc_index_};
+      } else {
+        PortIndexAndVCIndex input{i, vc};
+        absl::StatusOr<PortIndexAndVCIndex> output_status =
+            GetDestinationPortIndexAndVcIndex(simulator, input,
+                                              destination_index);
+        CHECK_OK(output_status.status());
+        output = output_status.value();
+      }
 
       // Now see if we have sufficient credits.
       if (credit_.at(output.port_index).at(output.vc_index) <= 0) {
@@ -848,8 +1101,13 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       // Now send the flit along.
       output_state.forward_channels.flit = flit;
       output_state.forward_channels.flit.vc = output.vc_index;
+      if (simulator.IsSourceRouting() &&
+          flit.source_route != DistributedRoutingTable::kNoSourceRoute) {
+        ++output_state.forward_channels.flit.source_route;
+      }
       output_state.forward_channels.cycle = current_cycle;
-      output_state.forward_channels.metadata = metadata;
+      output_state.forward_channels.metadata =
+          input_buffers_.FrontMetadata(buffer);
       output_state.forward_channels.metadata.timed_route_info.route.push_back(
           TimedRouteItem{id_, current_cycle});
 
@@ -858,7 +1116,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
       // Update credit to send back to input.
       ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      input_buffers_.Pop(buffer);
 
       flit_sent = true;
 
@@ -916,7 +1174,7 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
       // Upon reset (cycle-0) a full update of credits is sent.
       if (current_cycle == 0) {
         input.reverse_channels[vc].flit.data =
-            UBits(input_buffers_[i][vc].max_queue_size, 32);
+            UBits(input_buffers_.Capacity(input_buffer_start_[i] + vc), 32);
       } else {
         input.reverse_channels[vc].flit.data =
             UBits(input_credit_to_send_[i][vc], 32);
@@ -1000,7 +1258,7 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
 
     // TODO(tedhong): 2021-01-31 Support blocking traffic at sink.
     // without blocking, the queue never gets empty so we don't
-    // emplace into input_buffers_[vc].queue.
+    // keep input buffers.
     TimedDataFlit received_flit;
     received_flit.cycle = current_cycle;
     received_flit.flit = src.forward_channels.flit;
@@ -1026,11 +1284,11 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
       src.reverse_channels[vc].cycle = current_cycle;
       src.reverse_channels[vc].flit.type = FlitType::kTail;
       src.reverse_channels[vc].flit.data =
-          UBits(input_buffers_[vc].max_queue_size, 32);
+          UBits(input_buffer_depths_[vc], 32);
 
       VLOG(2) << absl::StreamFormat(
           "... sink %x sending %d credit vc %d on %x", GetId().AsUInt64(),
-          input_buffers_[vc].max_queue_size, vc, src.id.AsUInt64());
+          input_buffer_depths_[vc], vc, src.id.AsUInt64());
     }
   } else {
     for (int64_t vc = 0; vc < src.reverse_channels.size(); ++vc) {
@@ -1045,6 +1303,194 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
   return true;
 }
 
+absl::Status NocSimulator::RunParallelCycle(int64_t max_ticks) {
+  std::function<bool(int64_t)> tick_region = [&](int64_t region) {
+    return TickRegion(region, max_ticks);
+  };
+
+  // Each round first ticks the links between regions, then ticks every
+  // region to convergence. Registered links produce their outputs on their
+  // first tick of a cycle, so the regions never wait on each other and a
+  // second round lets the links consume the values the regions produced.
+  bool converged = false;
+  int64_t nrounds = 0;
+  while (!converged) {
+    VLOG(2) << absl::StreamFormat("Round %d", nrounds);
+    converged = true;
+    for (SimLink* link : boundary_links_) {
+      converged &= link->Tick(*this);
+    }
+    if (!region_workers_->Run(tick_region)) {
+      return absl::InternalError(absl::StrFormat(
+          "Simulator region unable to converge after %d ticks for cycle %d",
+          max_ticks, cycle_));
+    }
+    ++nrounds;
+    if (!converged && nrounds >= max_ticks) {
+      return absl::InternalError(absl::StrFormat(
+          "Simulator unable to converge after %d ticks for cycle %d", nrounds,
+          cycle_));
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+bool NocSimulator::TickRegion(int64_t region, int64_t max_ticks) {
+  for (int64_t nticks = 0; nticks < max_ticks; ++nticks) {
+    bool converged = true;
+    for (SimNetworkComponentBase* nc : regions_[region]) {
+      converged &= nc->Tick(*this);
+    }
+    if (converged) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void NocSimulator::ResetParallelRegions() {
+  region_workers_.reset();
+  regions_.clear();
+  boundary_links_.clear();
+}
+
+absl::Status NocSimulator::SetParallelRegionCount(int64_t region_count) {
+  XLS_RET_CHECK(mgr_ != nullptr) << "Simulator has not been initialized";
+  ResetParallelRegions();
+  if (region_count <= 1) {
+    return absl::OkStatus();
+  }
+
+  // Gather all components in the order they are ticked by Tick().
+  std::vector<SimNetworkComponentBase*> components;
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components.push_back(&nc);
+  }
+  int64_t links_begin = components.size();
+  for (SimLink& nc : links_) {
+    components.push_back(&nc);
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components.push_back(&nc);
+  }
+  auto is_registered_link = [&](int64_t index) {
+    return index >= links_begin && index < links_begin + links_.size() &&
+           links_[index - links_begin].IsRegistered();
+  };
+
+  absl::flat_hash_map<NetworkComponentId, int64_t> component_index;
+  for (int64_t i = 0; i < components.size(); ++i) {
+    component_index[components[i]->GetId()] = i;
+  }
+
+  // Components exchanging state within a cycle must be ticked together, so
+  // they are merged into indivisible groups. Only the connections driven by
+  // registered links are left uncut.
+  std::vector<int64_t> group(components.size());
+  std::iota(group.begin(), group.end(), 0);
+  auto find_group = [&](int64_t i) {
+    while (group[i] != i) {
+      group[i] = group[group[i]];
+      i = group[i];
+    }
+    return i;
+  };
+  std::vector<std::vector<int64_t>> neighbors(components.size());
+  absl::flat_hash_map<int64_t, int64_t> registered_link_sinks;
+
+  Network& network_obj = mgr_->GetNetwork(network_);
+  for (int64_t i = 0; i < network_obj.GetConnectionCount(); ++i) {
+    Connection& connection =
+        mgr_->GetConnection(network_obj.GetConnectionIdByIndex(i));
+    if (!connection.src().IsValid() || !connection.sink().IsValid()) {
+      continue;
+    }
+    auto src_iter =
+        component_index.find(connection.src().GetNetworkComponentId());
+    auto sink_iter =
+        component_index.find(connection.sink().GetNetworkComponentId());
+    if (src_iter == component_index.end() ||
+        sink_iter == component_index.end()) {
+      continue;
+    }
+    int64_t src = src_iter->second;
+    int64_t sink = sink_iter->second;
+    neighbors[src].push_back(sink);
+    neighbors[sink].push_back(src);
+    if (is_registered_link(src)) {
+      registered_link_sinks[src] = sink;
+      continue;
+    }
+    group[find_group(src)] = find_group(sink);
+  }
+
+  // Visit the components breadth first so that neighboring groups tend to
+  // be placed in the same region, and fill the regions in that order.
+  std::vector<int64_t> group_order;
+  absl::flat_hash_map<int64_t, int64_t> group_sizes;
+  std::vector<bool> visited(components.size(), false);
+  for (int64_t start = 0; start < components.size(); ++start) {
+    if (visited[start]) {
+      continue;
+    }
+    std::deque<int64_t> worklist = {start};
+    visited[start] = true;
+    while (!worklist.empty()) {
+      int64_t i = worklist.front();
+      worklist.pop_front();
+      if (group_sizes[find_group(i)]++ == 0) {
+        group_order.push_back(find_group(i));
+      }
+      for (int64_t neighbor : neighbors[i]) {
+        if (!visited[neighbor]) {
+          visited[neighbor] = true;
+          worklist.push_back(neighbor);
+        }
+      }
+    }
+  }
+
+  int64_t region_size =
+      (components.size() + region_count - 1) / region_count;
+  absl::flat_hash_map<int64_t, int64_t> group_region;
+  int64_t region = 0;
+  int64_t current_size = 0;
+  for (int64_t g : group_order) {
+    if (current_size >= region_size && region + 1 < region_count) {
+      ++region;
+      current_size = 0;
+    }
+    group_region[g] = region;
+    current_size += group_sizes[g];
+  }
+  if (region == 0) {
+    VLOG(1) << "Network can not be partitioned, simulating serially";
+    return absl::OkStatus();
+  }
+
+  regions_.resize(region + 1);
+  for (int64_t i = 0; i < components.size(); ++i) {
+    int64_t this_region = group_region.at(find_group(i));
+    auto sink_iter = registered_link_sinks.find(i);
+    if (sink_iter != registered_link_sinks.end() &&
+        group_region.at(find_group(sink_iter->second)) != this_region) {
+      boundary_links_.push_back(&links_[i - links_begin]);
+    } else {
+      regions_[this_region].push_back(components[i]);
+    }
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Partitioned network into %d regions with %d boundary links",
+      regions_.size(), boundary_links_.size());
+
+  region_workers_ = std::make_unique<RegionWorkers>(regions_.size());
+  return absl::OkStatus();
+}
+
 absl::StatusOr<SimNetworkInterfaceSrc*> NocSimulator::GetSimNetworkInterfaceSrc(
     NetworkComponentId src) {
   auto iter = src_index_map_.find(src);
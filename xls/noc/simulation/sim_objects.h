@@ -16,6 +16,7 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -52,15 +53,55 @@ struct CreditState {
   int64_t credit;
 };
 
-struct DataFlitQueueElement {
-  DataFlit flit;
-  TimedDataFlitInfo metadata;
-};
+// Represents the fifos/buffers used by a component to store phits.
+//
+// Each buffer is a fixed-capacity ring buffer carved out of a single pool
+// which is allocated once, after all buffers have been added, instead of
+// growing a container per buffer. Flits and their metadata are kept in
+// separate arrays so that arbitration, which only looks at the flits, does
+// not walk over the (much larger) route metadata.
+class DataFlitBufferPool {
+ public:
+  // Adds a buffer able to hold up to capacity flits and returns its index.
+  int64_t AddBuffer(int64_t capacity);
+
+  // Allocates the storage of all buffers added so far.
+  void Allocate();
 
-// Represents a fifo/buffer used to store phits.
-struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
-  int64_t max_queue_size;
+  int64_t BufferCount() const { return buffers_.size(); }
+  int64_t Capacity(int64_t buffer) const { return buffers_[buffer].capacity; }
+  bool Empty(int64_t buffer) const { return buffers_[buffer].size == 0; }
+
+  // Returns true if all buffers are empty.
+  bool AllEmpty() const { return total_size_ == 0; }
+
+  // Returns the oldest flit of a non-empty buffer and its metadata.
+  const DataFlit& FrontFlit(int64_t buffer) const {
+    return flits_[buffers_[buffer].offset + buffers_[buffer].head];
+  }
+  const TimedDataFlitInfo& FrontMetadata(int64_t buffer) const {
+    return metadata_[buffers_[buffer].offset + buffers_[buffer].head];
+  }
+
+  // Appends a flit to a buffer, which must not be full.
+  void Push(int64_t buffer, const DataFlit& flit,
+            const TimedDataFlitInfo& metadata);
+
+  // Removes the oldest flit of a non-empty buffer.
+  void Pop(int64_t buffer);
+
+ private:
+  struct Ring {
+    int64_t offset;
+    int64_t capacity;
+    int64_t head;
+    int64_t size;
+  };
+
+  std::vector<Ring> buffers_;
+  std::vector<DataFlit> flits_;
+  std::vector<TimedDataFlitInfo> metadata_;
+  int64_t total_size_ = 0;
 };
 
 // Represents a fifo/buffer used to store metadata phits.
@@ -84,6 +125,12 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns true if the component holds no flits or credits, so that
+  // simulating a cycle without new traffic would not change its state.
+  //
+  // Only meaningful once a cycle has converged.
+  virtual bool IsIdle() const { return true; }
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -155,6 +202,17 @@ class SimLink : public SimNetworkComponentBase {
 
   // Get the sink connection index that in used in the simulator.
 
+  // Returns true if both directions of the link are pipelined.
+  //
+  // The outputs of a registered link for a cycle only depend on state from
+  // previous cycles, so the components on either side of it can be ticked
+  // independently of each other within a cycle.
+  bool IsRegistered() const {
+    return forward_pipeline_stages_ > 0 && reverse_pipeline_stages_ > 0;
+  }
+
+  bool IsIdle() const override;
+
  private:
   SimLink() = default;
 
@@ -192,6 +250,8 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  bool IsIdle() const override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -203,6 +263,9 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   std::vector<int64_t> credit_;
   std::vector<CreditState> credit_update_;
   std::vector<std::queue<TimedDataFlit>> data_to_send_;
+
+  // Index of this source in the routing table, used for source routing.
+  int64_t source_index_;
 };
 
 // Sink - traffic leaves the network via a sink.
@@ -258,7 +321,9 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
   bool TryForwardPropagation(NocSimulator& simulator) override;
 
   int64_t src_connection_index_;
-  std::vector<DataFlitQueue> input_buffers_;
+
+  // Depth of the input buffer of each vc, advertised as credits upstream.
+  std::vector<int64_t> input_buffer_depths_;
   std::vector<TimedDataFlit> received_traffic_;
 };
 
@@ -295,6 +360,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  bool IsIdle() const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -341,7 +408,12 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
   int64_t internal_propagated_cycle_;
 
   // Stores the input buffers associated with each input port and vc.
-  std::vector<std::vector<DataFlitQueue>> input_buffers_;
+  // The buffer of port i and vc v has index input_buffer_start_[i] + v.
+  DataFlitBufferPool input_buffers_;
+  std::vector<int64_t> input_buffer_start_;
+
+  // The number of vcs of each input port.
+  std::vector<int64_t> input_vc_count_;
 
   // Stores the credit count associated with each output port and vc.
   // Each cycle, the router updates its credit count from credit_update_.
@@ -366,8 +438,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 // state and objects.
 class NocSimulator {
  public:
-  NocSimulator()
-      : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  NocSimulator();
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -379,6 +451,9 @@ class NocSimulator {
     routing_ = &routing;
     network_ = network;
     cycle_ = -1;
+    network_idle_ = false;
+    skipped_cycle_count_ = 0;
+    ResetParallelRegions();
 
     return CreateSimulationObjects(network);
   }
@@ -439,6 +514,46 @@ class NocSimulator {
   // Runs a single tick of the simulator.
   bool Tick();
 
+  // Partitions the network into (up to) region_count regions which are
+  // ticked in parallel by RunCycle(), each on its own thread.
+  //
+  // Regions are only split at registered links (see SimLink::IsRegistered);
+  // those links are ticked serially between the parallel ticks of the
+  // regions, which keeps the results identical to the serial simulator.
+  // A region_count of one or less restores serial simulation.
+  //
+  // Must be called after Initialize().
+  absl::Status SetParallelRegionCount(int64_t region_count);
+
+  // Enables skipping cycles in which the whole network is idle.
+  //
+  // Once a cycle converges with no flits or credits left anywhere in the
+  // network, following cycles are skipped without ticking any component
+  // until traffic is injected again (the pre and post-cycle services still
+  // run every cycle). Skipped cycles leave the simulation state exactly as
+  // simulating them would.
+  void SetSparseActivityMode(bool enabled) {
+    sparse_activity_mode_ = enabled;
+    network_idle_ = false;
+  }
+
+  // Returns the number of cycles skipped by the sparse activity mode.
+  int64_t GetSkippedCycleCount() const { return skipped_cycle_count_; }
+
+  // Enables source routing.
+  //
+  // Sources then store the precomputed route of each flit in the flit (see
+  // DistributedRoutingTable::GetSourceRouteStart), and routers forward the
+  // flit along that route instead of looking up their routing tables.
+  void SetSourceRouting(bool enabled) { source_routing_ = enabled; }
+
+  bool IsSourceRouting() const { return source_routing_; }
+
+  // Returns the number of regions ticked in parallel, one if serial.
+  int64_t GetParallelRegionCount() const {
+    return regions_.empty() ? 1 : regions_.size();
+  }
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -474,6 +589,28 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Runs the threads ticking the regions of a parallel simulation.
+  class RegionWorkers;
+
+  // Ticks the components of a region until they converge, or until
+  // max_ticks is reached. Returns true if the region converged.
+  bool TickRegion(int64_t region, int64_t max_ticks);
+
+  // Ticks the network until the current cycle converges.
+  absl::Status TickToConvergence(int64_t max_ticks);
+
+  // Returns true if no component or connection holds flits or credits.
+  bool IsNetworkIdle() const;
+
+  // Returns true if no source has flits to send.
+  bool AreSourcesIdle() const;
+
+  // Runs a single cycle of a parallel simulation to convergence.
+  absl::Status RunParallelCycle(int64_t max_ticks);
+
+  // Drops the regions of a parallel simulation.
+  void ResetParallelRegions();
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -515,6 +652,24 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  // Components of each region of a parallel simulation, empty if serial.
+  std::vector<std::vector<SimNetworkComponentBase*>> regions_;
+
+  // Registered links connecting different regions.
+  std::vector<SimLink*> boundary_links_;
+
+  std::unique_ptr<RegionWorkers> region_workers_;
+
+  // Set by SetSparseActivityMode().
+  bool sparse_activity_mode_ = false;
+
+  // Set by SetSourceRouting().
+  bool source_routing_ = false;
+
+  // True if the network was idle at the end of the last cycle.
+  bool network_idle_ = false;
+  int64_t skipped_cycle_count_ = 0;
 };
 
 }  // namespace noc
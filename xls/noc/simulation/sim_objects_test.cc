@@ -302,6 +302,52 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+TEST(SimObjectsTest, DataFlitBufferPool) {
+  DataFlitBufferPool pool;
+  EXPECT_EQ(pool.AddBuffer(2), 0);
+  EXPECT_EQ(pool.AddBuffer(3), 1);
+  pool.Allocate();
+
+  EXPECT_EQ(pool.BufferCount(), 2);
+  EXPECT_EQ(pool.Capacity(0), 2);
+  EXPECT_EQ(pool.Capacity(1), 3);
+  EXPECT_TRUE(pool.AllEmpty());
+
+  auto make_flit = [](int64_t data) {
+    return DataFlitBuilder()
+        .Type(FlitType::kTail)
+        .Data(UBits(data, 64))
+        .BuildFlit()
+        .value();
+  };
+
+  // Fill and drain the first buffer a few times so that it wraps around,
+  // checking the second buffer is unaffected.
+  pool.Push(1, make_flit(100), TimedDataFlitInfo{7});
+  int64_t next_pushed = 0;
+  int64_t next_popped = 0;
+  for (int64_t i = 0; i < 3; ++i) {
+    pool.Push(0, make_flit(next_pushed), TimedDataFlitInfo{next_pushed});
+    ++next_pushed;
+    pool.Push(0, make_flit(next_pushed), TimedDataFlitInfo{next_pushed});
+    ++next_pushed;
+    for (int64_t j = 0; j < 2; ++j) {
+      ASSERT_FALSE(pool.Empty(0));
+      EXPECT_EQ(pool.FrontFlit(0).data, UBits(next_popped, 64));
+      EXPECT_EQ(pool.FrontMetadata(0).injection_cycle_time, next_popped);
+      pool.Pop(0);
+      ++next_popped;
+    }
+    EXPECT_TRUE(pool.Empty(0));
+  }
+
+  EXPECT_FALSE(pool.AllEmpty());
+  EXPECT_EQ(pool.FrontFlit(1).data, UBits(100, 64));
+  EXPECT_EQ(pool.FrontMetadata(1).injection_cycle_time, 7);
+  pool.Pop(1);
+  EXPECT_TRUE(pool.AllEmpty());
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -13,13 +13,20 @@
 // limitations under the License.
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/network_graph_builder.h"
@@ -387,5 +394,174 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+// Simulates traffic in both directions through the routers of Sample Loop
+// Network 000 with the given number of parallel regions, optionally skipping
+// idle cycles and using source routing. Returns the traffic received by each
+// sink and the utilization of each router as strings, and sets
+// actual_region_count to the number of regions the network was split into and
+// skipped_cycle_count to the number of cycles skipped.
+absl::StatusOr<std::vector<std::string>> SimulateLoopNetwork(
+    int64_t region_count, bool sparse_activity_mode, bool source_routing,
+    int64_t* actual_region_count, int64_t* skipped_cycle_count) {
+  NocTrafficManager traffic_mgr;
+
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(3 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow1_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort0")
+      .SetVC("VC1")
+      .SetPacketSizeInBits(128)
+      .SetClockCycleTimes({0, 1, 2, 4, 8, 9, 10, 11, 15});
+
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLoop000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 400;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  XLS_RETURN_IF_ERROR(simulator.SetParallelRegionCount(region_count));
+  *actual_region_count = simulator.GetParallelRegionCount();
+  simulator.SetSparseActivityMode(sparse_activity_mode);
+  simulator.SetSourceRouting(source_routing);
+
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  NocSimulatorToLinkMonitorServiceShim link_monitor(simulator);
+  simulator.RegisterPostCycleService(link_monitor);
+
+  for (int64_t i = 0; i < 40; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+  *skipped_cycle_count = simulator.GetSkippedCycleCount();
+
+  std::vector<std::string> result;
+  for (NetworkComponentId sink :
+       routing_table.GetSinkIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sim_sink,
+                         simulator.GetSimNetworkInterfaceSink(sink));
+    for (const TimedDataFlit& flit : sim_sink->GetReceivedTraffic()) {
+      result.push_back(absl::StrFormat("%x: %s", sink.AsUInt64(),
+                                       flit.ToString()));
+    }
+  }
+  for (const SimInputBufferedVCRouter& router : simulator.GetRouters()) {
+    result.push_back(absl::StrFormat("%x: %d", router.GetId().AsUInt64(),
+                                     router.GetUtilizationCycleCount()));
+  }
+  for (const auto& [link, packet_counts] :
+       link_monitor.GetLinkToPacketCountMap()) {
+    for (const auto& [destination, count] : packet_counts) {
+      result.push_back(absl::StrFormat("%x: %d %d %d", link.AsUInt64(),
+                                       destination.sink_index,
+                                       destination.vc, count));
+    }
+  }
+  absl::c_sort(result);
+  return result;
+}
+
+TEST(SimTrafficTest, ParallelRegionsMatchSerialSimulation) {
+  int64_t actual_region_count;
+  int64_t skipped_cycle_count;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> serial,
+      SimulateLoopNetwork(/*region_count=*/1, /*sparse_activity_mode=*/false,
+                          /*source_routing=*/false, &actual_region_count,
+                          &skipped_cycle_count));
+  EXPECT_EQ(actual_region_count, 1);
+  EXPECT_GT(serial.size(), 2);
+
+  for (int64_t region_count : {2, 3, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::string> parallel,
+        SimulateLoopNetwork(region_count, /*sparse_activity_mode=*/false,
+                            /*source_routing=*/false, &actual_region_count,
+                            &skipped_cycle_count));
+    EXPECT_GT(actual_region_count, 1);
+    EXPECT_LE(actual_region_count, region_count);
+    EXPECT_EQ(parallel, serial) << region_count << " regions";
+  }
+}
+
+TEST(SimTrafficTest, SparseActivityModeMatchesDenseSimulation) {
+  int64_t actual_region_count;
+  int64_t skipped_cycle_count;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> dense,
+      SimulateLoopNetwork(/*region_count=*/1, /*sparse_activity_mode=*/false,
+                          /*source_routing=*/false, &actual_region_count,
+                          &skipped_cycle_count));
+  EXPECT_EQ(skipped_cycle_count, 0);
+
+  for (int64_t region_count : {1, 2}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::string> sparse,
+        SimulateLoopNetwork(region_count, /*sparse_activity_mode=*/true,
+                            /*source_routing=*/false, &actual_region_count,
+                            &skipped_cycle_count));
+    EXPECT_GT(skipped_cycle_count, 0);
+    EXPECT_EQ(sparse, dense) << region_count << " regions";
+  }
+}
+
+TEST(SimTrafficTest, SourceRoutingMatchesRoutingTables) {
+  int64_t actual_region_count;
+  int64_t skipped_cycle_count;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> table_routed,
+      SimulateLoopNetwork(/*region_count=*/1, /*sparse_activity_mode=*/false,
+                          /*source_routing=*/false, &actual_region_count,
+                          &skipped_cycle_count));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> source_routed,
+      SimulateLoopNetwork(/*region_count=*/1, /*sparse_activity_mode=*/false,
+                          /*source_routing=*/true, &actual_region_count,
+                          &skipped_cycle_count));
+  EXPECT_GT(source_routed.size(), 2);
+  EXPECT_EQ(source_routed, table_routed);
+}
+
 }  // namespace
 }  // namespace xls::noc
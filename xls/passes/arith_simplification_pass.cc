@@ -48,6 +48,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/rewrite_rule_set.h"
 #include "xls/passes/stateless_query_engine.h"
 
 namespace xls {
@@ -824,16 +825,6 @@ absl::StatusOr<bool> MatchArithPatterns(int64_t opt_level, Node* n,
     return true;
   }
 
-  XLS_ASSIGN_OR_RETURN(bool udiv_matched, MatchUnsignedDivide(n, query_engine));
-  if (udiv_matched) {
-    return true;
-  }
-
-  XLS_ASSIGN_OR_RETURN(bool sdiv_matched, MatchSignedDivide(n, query_engine));
-  if (sdiv_matched) {
-    return true;
-  }
-
   // Logical shift by a constant can be replaced by a slice and concat.
   //    (val << lit) -> Concat(BitSlice(val, ...), UBits(0, ...))
   //    (val >> lit) -> Concat(UBits(0, ...), BitSlice(val, ...))
@@ -1411,12 +1402,6 @@ absl::StatusOr<bool> MatchArithPatterns(int64_t opt_level, Node* n,
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(bool injective_matched,
-                       MatchComparisonOfInjectiveOp(n, query_engine));
-  if (injective_matched) {
-    return true;
-  }
-
   return false;
 }
 
@@ -1425,9 +1410,38 @@ absl::StatusOr<bool> MatchArithPatterns(int64_t opt_level, Node* n,
 absl::StatusOr<bool> ArithSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return TransformNodesToFixedPoint(f, [this](Node* n) {
-    return MatchArithPatterns(opt_level_, n, StatelessQueryEngine());
-  });
+  // Each node is only tried against the rules for its op. Rules rooted at the
+  // same op are tried in the order added, so the general patterns run before
+  // the division by constant and injective comparison rewrites.
+  StatelessQueryEngine query_engine;
+  RewriteRuleSet rules;
+  rules.Add(RewriteRule{
+      .name = "arith_patterns",
+      .root_ops = {Op::kSMul, Op::kUMul, Op::kSMulp, Op::kUMulp, Op::kUDiv,
+                   Op::kSDiv, Op::kUMod, Op::kSMod, Op::kShll, Op::kShrl,
+                   Op::kShra, Op::kSignExt, Op::kDecode, Op::kNot, Op::kEq,
+                   Op::kNe, Op::kULt, Op::kULe, Op::kUGt, Op::kUGe, Op::kSLt,
+                   Op::kSLe, Op::kSGt, Op::kSGe},
+      .rewrite =
+          [&](Node* n) {
+            return MatchArithPatterns(opt_level_, n, query_engine);
+          }});
+  rules.Add(RewriteRule{
+      .name = "unsigned_divide",
+      .root_ops = {Op::kUDiv},
+      .rewrite =
+          [&](Node* n) { return MatchUnsignedDivide(n, query_engine); }});
+  rules.Add(RewriteRule{
+      .name = "signed_divide",
+      .root_ops = {Op::kSDiv},
+      .rewrite = [&](Node* n) { return MatchSignedDivide(n, query_engine); }});
+  rules.Add(RewriteRule{.name = "comparison_of_injective_op",
+                        .root_ops = {Op::kEq, Op::kNe},
+                        .rewrite = [&](Node* n) {
+                          return MatchComparisonOfInjectiveOp(n, query_engine);
+                        }});
+  return TransformNodesToFixedPoint(
+      f, [&rules](Node* n) { return rules.Apply(n); });
 }
 
 REGISTER_OPT_PASS(ArithSimplificationPass, pass_config::kOptLevel);
@@ -35,6 +35,8 @@ class ArithSimplificationPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~ArithSimplificationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   int64_t opt_level_;
 
@@ -34,6 +34,8 @@ class ArraySimplificationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Array Simplification"),
         opt_level_(opt_level) {}
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   int64_t opt_level_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
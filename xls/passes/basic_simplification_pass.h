@@ -38,6 +38,8 @@ class BasicSimplificationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Basic Simplifications") {}
   ~BasicSimplificationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -32,6 +32,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/passes/bdd_function.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -101,6 +102,10 @@ absl::StatusOr<std::vector<Node*>> GetNodeOrder(FunctionBase* f) {
 absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  if (BudgetUsed(options, 1.0)) {
+    RecordCurtailment(options, short_name(), "skipped");
+    return false;
+  }
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BddFunction> bdd_function,
       BddFunction::Run(f, BddFunction::kDefaultPathLimit, IsCheapForBdds));
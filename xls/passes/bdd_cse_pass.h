@@ -34,6 +34,8 @@ class BddCsePass : public OptimizationFunctionBasePass {
             kName, "BDD-based Common Subexpression Elimination") {}
   ~BddCsePass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
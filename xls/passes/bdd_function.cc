@@ -15,9 +15,11 @@
 #include "xls/passes/bdd_function.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <utility>
@@ -39,7 +41,9 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_decision_diagram.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
@@ -55,6 +59,10 @@
 namespace xls {
 namespace {
 
+// The number of BDD nodes above which BddFunction::Run garbage collects the
+// intermediate expressions produced while evaluating each operation.
+constexpr int64_t kGarbageCollectionNodeThreshold = 1 << 16;
+
 // Construct a BDD-based abstract evaluator. The expressions in the BDD
 // saturates at a particular number of paths from the expression node to the
 // terminal nodes 0 and 1 in the BDD. When the path limit is met, a new BDD
@@ -341,32 +349,84 @@ class BddStatistics {
   absl::flat_hash_map<Op, int64_t> op_counts_;
 };
 
-}  // namespace
+// The cone of each bit of each node of a partitioned function.
+using BitCones = absl::flat_hash_map<const Node*, std::vector<int64_t>>;
 
-/* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
-    FunctionBase* f, int64_t path_limit,
-    std::optional<std::function<bool(const Node*)>> node_filter) {
-  VLOG(1) << absl::StreamFormat("BddFunction::Run(%s), %d nodes:", f->name(),
-                                f->node_count());
-  XLS_VLOG_LINES(5, f->DumpIr());
+// The BDD expressions of the bits-typed nodes in one cone of a function.
+struct ConeValues {
+  // The expression of each bit which is in the cone; other bits are zero.
+  NodeMap node_map;
+  // The nodes whose expressions exceeded the path limit; see
+  // BddFunction::saturated_expressions_.
+  absl::flat_hash_set<Node*> saturated_expressions;
+};
 
-  auto bdd_function = absl::WrapUnique(new BddFunction(f));
-  SaturatingBddEvaluator evaluator(path_limit, &bdd_function->bdd());
+// Returns whether the BDD expression of `node` is computed from the
+// expressions of its operands rather than being a vector of new variables.
+bool IsEvaluatedFromOperands(
+    Node* node,
+    const std::optional<std::function<bool(const Node*)>>& node_filter) {
+  return ShouldEvaluate(node) &&
+         (!node_filter.has_value() || node_filter.value()(node)) &&
+         std::all_of(node->operands().begin(), node->operands().end(),
+                     [](Node* o) { return o->GetType()->IsBits(); });
+}
+
+// Builds the BDD expressions of the bits of `nodes` in cone `cone` in `bdd`.
+// `nodes` must be in topological order and include every node with a bit in
+// the cone. If `bit_cones` is null every bit is in the cone. Otherwise the
+// partition must ensure that each bit in the cone only depends on bits in
+// the cone, as the other bits are treated as zero.
+absl::StatusOr<ConeValues> EvaluateCone(
+    absl::Span<Node* const> nodes, int64_t cone, const BitCones* bit_cones,
+    int64_t path_limit,
+    const std::optional<std::function<bool(const Node*)>>& node_filter,
+    BinaryDecisionDiagram& bdd) {
+  ConeValues result;
+  SaturatingBddEvaluator evaluator(path_limit, &bdd);
+  auto in_cone = [&](Node* n, int64_t bit_index) {
+    return bit_cones == nullptr || bit_cones->at(n)[bit_index] == cone;
+  };
 
   // Create and return a vector containing newly defined BDD variables.
   auto create_new_node_vector = [&](Node* n) {
-    SaturatingBddNodeVector v(n->BitCountOrDie());
+    SaturatingBddNodeVector v(n->BitCountOrDie(), bdd.zero());
     for (int64_t i = 0; i < n->BitCountOrDie(); ++i) {
-      v[i] = bdd_function->bdd().NewVariable();
+      if (in_cone(n, i)) {
+        v[i] = bdd.NewVariable();
+      }
     }
-    bdd_function->saturated_expressions_.insert(n);
+    result.saturated_expressions.insert(n);
     return v;
   };
 
   VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
   BddStatistics bdd_stats;
-  for (Node* node : TopoSort(f)) {
+
+  // Only the expressions in `values` are referenced again, so once the BDD
+  // grows large the rest can be reclaimed.
+  int64_t gc_threshold = kGarbageCollectionNodeThreshold;
+  auto maybe_garbage_collect = [&]() {
+    if (bdd.size() < gc_threshold) {
+      return;
+    }
+    std::vector<BddNodeIndex> roots;
+    for (const auto& [_, vector] : values) {
+      for (const SaturatingBddNodeIndex& value : vector) {
+        roots.push_back(std::get<BddNodeIndex>(value));
+      }
+    }
+    bdd.GarbageCollect(absl::MakeSpan(roots));
+    auto root = roots.begin();
+    for (auto& [_, vector] : values) {
+      for (SaturatingBddNodeIndex& value : vector) {
+        value = *root++;
+      }
+    }
+    gc_threshold = std::max(kGarbageCollectionNodeThreshold, 2 * bdd.size());
+  };
+  for (Node* node : nodes) {
     VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
       VLOG(3) << "  skipping node, type is not bits: "
@@ -382,10 +442,7 @@ class BddStatistics {
     // If we shouldn't evaluate this node, the node is to be modeled as
     // variables, or the node includes some non-bits-typed operands, then just
     // create a vector of new BDD variables for this node.
-    if (!ShouldEvaluate(node) ||
-        (node_filter.has_value() && !node_filter.value()(node)) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
+    if (!IsEvaluatedFromOperands(node, node_filter)) {
       VLOG(3) << "  node filtered out.";
       values[node] = create_new_node_vector(node);
     } else {
@@ -393,7 +450,12 @@ class BddStatistics {
       std::vector<SaturatingBddNodeVector> operand_values;
       operand_values.reserve(node->operand_count());
       for (Node* operand : node->operands()) {
-        operand_values.push_back(values.at(operand));
+        auto it = values.find(operand);
+        // An operand with no bits in the cone is not evaluated.
+        operand_values.push_back(
+            it == values.end()
+                ? SaturatingBddNodeVector(operand->BitCountOrDie(), bdd.zero())
+                : it->second);
       }
       XLS_ASSIGN_OR_RETURN(
           values[node],
@@ -402,10 +464,13 @@ class BddStatistics {
 
       // Associate a new BDD variable with each bit that exceeded the path
       // limit.
-      for (SaturatingBddNodeIndex& value : values.at(node)) {
-        if (std::holds_alternative<TooManyPaths>(value)) {
-          bdd_function->saturated_expressions_.insert(node);
-          value = bdd_function->bdd().NewVariable();
+      SaturatingBddNodeVector& node_values = values.at(node);
+      for (int64_t i = 0; i < node_values.size(); ++i) {
+        if (!in_cone(node, i)) {
+          node_values[i] = bdd.zero();
+        } else if (std::holds_alternative<TooManyPaths>(node_values[i])) {
+          result.saturated_expressions.insert(node);
+          node_values[i] = bdd.NewVariable();
         }
       }
     }
@@ -414,23 +479,284 @@ class BddStatistics {
       for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
         VLOG(5) << absl::StreamFormat(
             "    bit %d : %s", i,
-            bdd_function->bdd().ToStringDnf(
-                std::get<BddNodeIndex>(values.at(node)[i]),
-                /*minterm_limit=*/15));
+            bdd.ToStringDnf(std::get<BddNodeIndex>(values.at(node)[i]),
+                            /*minterm_limit=*/15));
       }
     }
     if (stop_watch.has_value()) {
       bdd_stats.AddOp(node->op(), stop_watch->GetElapsedTime());
     }
+    maybe_garbage_collect();
   }
   XLS_VLOG_LINES(2, bdd_stats.ToString());
 
-  // Copy over the vector and BDD variables into the node map which is exposed
-  // via the BddFunction interface. At this point any TooManyPaths sentinel
-  // values have been replaced with new Bdd variables.
+  // At this point any TooManyPaths sentinel values have been replaced with new
+  // Bdd variables.
   for (const auto& pair : values) {
-    bdd_function->node_map_[pair.first] = ToBddNodeVector(pair.second);
+    result.node_map[pair.first] = ToBddNodeVector(pair.second);
+  }
+  return result;
+}
+
+// Assigns each bit of each bits-typed node of `topo_sort` to a cone such that
+// the BDD expression of a bit only depends on the expressions of bits in the
+// same cone. Bits are numbered consecutively from zero in topological order.
+// Returns the cone of each bit, with the cones numbered in the order of their
+// first bit.
+BitCones PartitionIntoCones(
+    absl::Span<Node* const> topo_sort,
+    const std::optional<std::function<bool(const Node*)>>& node_filter,
+    int64_t& cone_count) {
+  absl::flat_hash_map<const Node*, int64_t> first_bit;
+  int64_t bit_count = 0;
+  for (Node* node : topo_sort) {
+    if (node->GetType()->IsBits()) {
+      first_bit[node] = bit_count;
+      bit_count += node->BitCountOrDie();
+    }
+  }
+  UnionFind<int64_t> cones;
+  for (int64_t i = 0; i < bit_count; ++i) {
+    cones.Insert(i);
+  }
+
+  for (Node* node : topo_sort) {
+    // A node whose expression is a vector of new variables shares no
+    // variables with its operands.
+    if (!node->GetType()->IsBits() ||
+        !IsEvaluatedFromOperands(node, node_filter)) {
+      continue;
+    }
+    int64_t width = node->BitCountOrDie();
+    int64_t base = first_bit.at(node);
+    auto depends = [&](int64_t bit_index, int64_t operand_no,
+                       int64_t operand_bit_index) {
+      cones.Union(base + bit_index,
+                  first_bit.at(node->operand(operand_no)) + operand_bit_index);
+    };
+    switch (node->op()) {
+      case Op::kAnd:
+      case Op::kNand:
+      case Op::kNor:
+      case Op::kNot:
+      case Op::kOr:
+      case Op::kXor:
+      case Op::kIdentity:
+        for (int64_t i = 0; i < width; ++i) {
+          for (int64_t j = 0; j < node->operand_count(); ++j) {
+            depends(i, j, i);
+          }
+        }
+        break;
+      case Op::kLiteral:
+        break;
+      case Op::kBitSlice:
+        for (int64_t i = 0; i < width; ++i) {
+          depends(i, 0, node->As<BitSlice>()->start() + i);
+        }
+        break;
+      case Op::kConcat: {
+        int64_t offset = 0;
+        for (int64_t j = node->operand_count() - 1; j >= 0; --j) {
+          for (int64_t i = 0; i < node->operand(j)->BitCountOrDie(); ++i) {
+            depends(offset + i, j, i);
+          }
+          offset += node->operand(j)->BitCountOrDie();
+        }
+        break;
+      }
+      case Op::kReverse:
+        for (int64_t i = 0; i < width; ++i) {
+          depends(i, 0, width - 1 - i);
+        }
+        break;
+      case Op::kZeroExt:
+      case Op::kSignExt: {
+        int64_t operand_width = node->operand(0)->BitCountOrDie();
+        for (int64_t i = 0; i < width && operand_width > 0; ++i) {
+          if (i < operand_width || node->op() == Op::kSignExt) {
+            depends(i, 0, std::min(i, operand_width - 1));
+          }
+        }
+        break;
+      }
+      case Op::kSel:
+      case Op::kOneHotSel:
+      case Op::kPrioritySel:
+        // Each bit depends on the selector and the same bit of each case.
+        for (int64_t i = 0; i < width; ++i) {
+          for (int64_t s = 0; s < node->operand(0)->BitCountOrDie(); ++s) {
+            depends(i, 0, s);
+          }
+          for (int64_t j = 1; j < node->operand_count(); ++j) {
+            depends(i, j, i);
+          }
+        }
+        break;
+      default:
+        // Conservatively assume every bit depends on every operand bit.
+        // A zero-width result has no bits to depend on anything.
+        if (width == 0) {
+          break;
+        }
+        for (int64_t i = 1; i < width; ++i) {
+          cones.Union(base, base + i);
+        }
+        for (int64_t j = 0; j < node->operand_count(); ++j) {
+          for (int64_t i = 0; i < node->operand(j)->BitCountOrDie(); ++i) {
+            depends(0, j, i);
+          }
+        }
+        break;
+    }
+  }
+
+  absl::flat_hash_map<int64_t, int64_t> cone_indices;
+  BitCones bit_cones;
+  for (Node* node : topo_sort) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    std::vector<int64_t>& node_cones = bit_cones[node];
+    for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+      auto [it, inserted] = cone_indices.try_emplace(
+          cones.Find(first_bit.at(node) + i), cone_indices.size());
+      node_cones.push_back(it->second);
+    }
+  }
+  cone_count = cone_indices.size();
+  return bit_cones;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
+    FunctionBase* f, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter) {
+  VLOG(1) << absl::StreamFormat("BddFunction::Run(%s), %d nodes:", f->name(),
+                                f->node_count());
+  XLS_VLOG_LINES(5, f->DumpIr());
+
+  auto bdd_function = absl::WrapUnique(new BddFunction(f));
+  bdd_function->bdds_.resize(1);
+  XLS_ASSIGN_OR_RETURN(
+      ConeValues values,
+      EvaluateCone(TopoSort(f), /*cone=*/0, /*bit_cones=*/nullptr, path_limit,
+                   node_filter, bdd_function->bdds_.front()));
+  bdd_function->node_map_ = std::move(values.node_map);
+  bdd_function->saturated_expressions_ =
+      std::move(values.saturated_expressions);
+  return std::move(bdd_function);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>>
+BddFunction::RunOnNodes(
+    FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter) {
+  VLOG(1) << absl::StreamFormat("BddFunction::RunOnNodes(%s), %d of %d nodes",
+                                f->name(), nodes.size(), f->node_count());
+  absl::flat_hash_set<const Node*> node_set(nodes.begin(), nodes.end());
+  std::function<bool(const Node*)> in_nodes_filter =
+      [&node_set, &node_filter](const Node* node) {
+        return (!node_filter.has_value() || node_filter.value()(node)) &&
+               std::all_of(
+                   node->operands().begin(), node->operands().end(),
+                   [&](const Node* o) { return node_set.contains(o); });
+      };
+
+  auto bdd_function = absl::WrapUnique(new BddFunction(f));
+  bdd_function->bdds_.resize(1);
+  XLS_ASSIGN_OR_RETURN(
+      ConeValues values,
+      EvaluateCone(nodes, /*cone=*/0, /*bit_cones=*/nullptr, path_limit,
+                   in_nodes_filter, bdd_function->bdds_.front()));
+  bdd_function->node_map_ = std::move(values.node_map);
+  bdd_function->saturated_expressions_ =
+      std::move(values.saturated_expressions);
+  return std::move(bdd_function);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>>
+BddFunction::RunPartitioned(
+    FunctionBase* f, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t thread_count) {
+  VLOG(1) << absl::StreamFormat(
+      "BddFunction::RunPartitioned(%s), %d nodes, %d threads:", f->name(),
+      f->node_count(), thread_count);
+  XLS_VLOG_LINES(5, f->DumpIr());
+  XLS_RET_CHECK_GT(thread_count, 0);
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  int64_t cone_count;
+  BitCones bit_cones = PartitionIntoCones(topo_sort, node_filter, cone_count);
+  VLOG(2) << absl::StreamFormat("Partitioned %s into %d cones", f->name(),
+                                cone_count);
+  std::vector<std::vector<Node*>> cone_nodes(cone_count);
+  for (Node* node : topo_sort) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    absl::flat_hash_set<int64_t> node_cones(bit_cones.at(node).begin(),
+                                            bit_cones.at(node).end());
+    for (int64_t cone : node_cones) {
+      cone_nodes[cone].push_back(node);
+    }
+  }
+
+  auto bdd_function = absl::WrapUnique(new BddFunction(f));
+  // There is always at least one BDD, even if it is empty.
+  bdd_function->bdds_.resize(std::max<int64_t>(cone_count, 1));
+
+  // Build the largest cones first to balance the load across threads.
+  std::vector<int64_t> work_order(cone_count);
+  std::iota(work_order.begin(), work_order.end(), 0);
+  std::stable_sort(work_order.begin(), work_order.end(),
+                   [&](int64_t a, int64_t b) {
+                     return cone_nodes[a].size() > cone_nodes[b].size();
+                   });
+  std::vector<ConeValues> values(cone_count);
+  std::vector<absl::Status> statuses(cone_count);
+  std::atomic<int64_t> next_work_item = 0;
+  auto worker = [&]() {
+    for (int64_t item = next_work_item++; item < cone_count;
+         item = next_work_item++) {
+      int64_t cone = work_order[item];
+      absl::StatusOr<ConeValues> cone_values =
+          EvaluateCone(cone_nodes[cone], cone, &bit_cones, path_limit,
+                       node_filter, bdd_function->bdds_[cone]);
+      if (cone_values.ok()) {
+        values[cone] = *std::move(cone_values);
+      } else {
+        statuses[cone] = cone_values.status();
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(thread_count, cone_count); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  for (const auto& [node, node_cones] : bit_cones) {
+    BddNodeVector& vector = bdd_function->node_map_[node];
+    vector.resize(node_cones.size());
+    for (int64_t i = 0; i < node_cones.size(); ++i) {
+      vector[i] = values[node_cones[i]].node_map.at(node)[i];
+    }
+  }
+  for (const ConeValues& cone_values : values) {
+    bdd_function->saturated_expressions_.insert(
+        cone_values.saturated_expressions.begin(),
+        cone_values.saturated_expressions.end());
   }
+  bdd_function->bit_cones_ = std::move(bit_cones);
   return std::move(bdd_function);
 }
 
@@ -444,8 +770,9 @@ absl::StatusOr<Value> BddFunction::Evaluate(
 
   // Map containing the result of each node.
   absl::flat_hash_map<const Node*, Value> values;
-  // Map of the BDD variable values.
-  absl::flat_hash_map<BddNodeIndex, bool> bdd_variable_values;
+  // Map of the BDD variable values of each cone.
+  std::vector<absl::flat_hash_map<BddNodeIndex, bool>> bdd_variable_values(
+      cone_count());
   XLS_RET_CHECK_EQ(args.size(), function->params().size());
   for (Node* node : TopoSort(function)) {
     VLOG(3) << "node: " << node;
@@ -474,8 +801,10 @@ absl::StatusOr<Value> BddFunction::Evaluate(
       const BddNodeVector& bdd_vector = node_map_.at(node);
       absl::InlinedVector<bool, 64> bits;
       for (int64_t i = 0; i < bdd_vector.size(); ++i) {
-        XLS_ASSIGN_OR_RETURN(bool bit_result,
-                             bdd_.Evaluate(bdd_vector[i], bdd_variable_values));
+        int64_t cone = *GetCone(node, i);
+        XLS_ASSIGN_OR_RETURN(
+            bool bit_result,
+            bdd(cone).Evaluate(bdd_vector[i], bdd_variable_values[cone]));
         bits.push_back(bit_result);
       }
       result = Value(Bits(bits));
@@ -487,8 +816,9 @@ absl::StatusOr<Value> BddFunction::Evaluate(
     if (node_map_.contains(node)) {
       const BddNodeVector& bdd_vector = node_map_.at(node);
       for (int64_t i = 0; i < bdd_vector.size(); ++i) {
-        if (bdd_.IsVariableBaseNode(bdd_vector.at(i))) {
-          bdd_variable_values[bdd_vector.at(i)] = result.bits().Get(i);
+        int64_t cone = *GetCone(node, i);
+        if (bdd(cone).IsVariableBaseNode(bdd_vector.at(i))) {
+          bdd_variable_values[cone][bdd_vector.at(i)] = result.bits().Get(i);
         }
       }
     }
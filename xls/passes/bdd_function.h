@@ -48,6 +48,11 @@ using NodeMap = absl::flat_hash_map<const Node*, BddNodeVector>;
 // For each bits-typed XLS Node, BddFunction holds a BddNodeVector which is a
 // vector of BDD nodes corresponding to the expression for each bit in the XLS
 // Node output.
+//
+// The function may optionally be partitioned into cones of nodes which share no
+// BDD variables, each represented in its own BDD (see RunPartitioned). BDD node
+// indices are only meaningful within the BDD of their cone, except for the
+// terminal nodes zero and one which have the same index in every BDD.
 class BddFunction {
  public:
   // The default limit on the number of paths from a BDD node to the BDD
@@ -69,9 +74,57 @@ class BddFunction {
       std::optional<std::function<bool(const Node*)>> node_filter =
           std::nullopt);
 
-  // Returns the underlying BDD.
-  const BinaryDecisionDiagram& bdd() const { return bdd_; }
-  BinaryDecisionDiagram& bdd() { return bdd_; }
+  // As Run, but only builds the BDD expressions of `nodes`, which must be in
+  // topological order. A node with an operand not in `nodes` is not evaluated,
+  // as if `node_filter` returned false for it. Lets analyses which only query a
+  // few nodes (e.g. some control signals) pass the fan-in cone of those nodes
+  // and skip the rest of the function, such as a wide datapath.
+  static absl::StatusOr<std::unique_ptr<BddFunction>> RunOnNodes(
+      FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          std::nullopt);
+
+  // As Run, but partitions the bits of the function into cones whose BDD
+  // expressions share no variables, and builds the BDD of each cone separately
+  // on up to `thread_count` threads. Structurally independent parts of a
+  // function such as the lanes of a vector datapath can then be built
+  // concurrently. `node_filter` may be called concurrently.
+  static absl::StatusOr<std::unique_ptr<BddFunction>> RunPartitioned(
+      FunctionBase* f, int64_t path_limit,
+      std::optional<std::function<bool(const Node*)>> node_filter,
+      int64_t thread_count);
+
+  // Returns the number of cones, each of which has its own BDD. This is one
+  // unless the function was built with RunPartitioned.
+  int64_t cone_count() const { return bdds_.size(); }
+
+  // Returns the BDD of the given cone.
+  const BinaryDecisionDiagram& bdd(int64_t cone) const {
+    return bdds_.at(cone);
+  }
+  BinaryDecisionDiagram& bdd(int64_t cone) { return bdds_.at(cone); }
+
+  // Returns the underlying BDD. The function must have a single cone.
+  const BinaryDecisionDiagram& bdd() const {
+    CHECK_EQ(cone_count(), 1);
+    return bdds_.front();
+  }
+  BinaryDecisionDiagram& bdd() {
+    CHECK_EQ(cone_count(), 1);
+    return bdds_.front();
+  }
+
+  // Returns the cone whose BDD holds the expression of the given bit, or
+  // std::nullopt if the node is not represented in the BDD.
+  std::optional<int64_t> GetCone(const Node* node, int64_t bit_index) const {
+    if (!node_map_.contains(node)) {
+      return std::nullopt;
+    }
+    if (bit_cones_.empty()) {
+      return 0;
+    }
+    return bit_cones_.at(node).at(bit_index);
+  }
 
   // Returns the node associated with the given bit.
   BddNodeIndex GetBddNode(Node* node, int64_t bit_index) const {
@@ -100,7 +153,13 @@ class BddFunction {
   explicit BddFunction(FunctionBase* f) : func_base_(f) {}
 
   FunctionBase* func_base_;
-  BinaryDecisionDiagram bdd_;
+
+  // The BDD of each cone.
+  std::vector<BinaryDecisionDiagram> bdds_;
+
+  // The cone of each bit of each node in `node_map_`. Empty if the function
+  // has a single cone.
+  absl::flat_hash_map<const Node*, std::vector<int64_t>> bit_cones_;
 
   // A map from XLS Node to vector of BDD nodes representing the XLS Node's
   // expression.
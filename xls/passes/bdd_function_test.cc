@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -116,6 +117,50 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, PartitionedLanes) {
+  // Four lanes which share no variables, combined by a concat.
+  constexpr int64_t kLanes = 4;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8 * kLanes));
+  BValue y = fb.Param("y", p->GetBitsType(8 * kLanes));
+  std::vector<BValue> lanes;
+  for (int64_t i = 0; i < kLanes; ++i) {
+    BValue x_lane = fb.BitSlice(x, 8 * i, 8);
+    BValue y_lane = fb.BitSlice(y, 8 * i, 8);
+    lanes.push_back(fb.OrReduce(
+        fb.Xor(fb.And(x_lane, fb.Not(y_lane)), fb.Or(x_lane, y_lane))));
+  }
+  fb.Concat(lanes);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::minstd_rand engine;
+  for (int64_t thread_count : {1, 2, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BddFunction> bdd_function,
+        BddFunction::RunPartitioned(f, /*path_limit=*/0,
+                                    /*node_filter=*/std::nullopt,
+                                    thread_count));
+    // Each lane only depends on its own slices of the params, so each lane is
+    // a separate cone even though the lanes slice the same params.
+    EXPECT_EQ(bdd_function->cone_count(), kLanes);
+    for (int64_t i = 0; i < kLanes; ++i) {
+      EXPECT_EQ(bdd_function->GetCone(lanes[i].node(), 0),
+                bdd_function->GetCone(x.node(), 8 * i));
+      EXPECT_EQ(bdd_function->GetCone(lanes[i].node(), 0),
+                bdd_function->GetCone(y.node(), 8 * i + 7));
+    }
+    EXPECT_NE(bdd_function->GetCone(lanes[0].node(), 0),
+              bdd_function->GetCone(lanes[1].node(), 0));
+    for (int64_t i = 0; i < 32; ++i) {
+      std::vector<Value> inputs = RandomFunctionArguments(f, engine);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+      EXPECT_THAT(bdd_function->Evaluate(inputs), IsOkAndHolds(expected));
+    }
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various benchmarks and verify against the interpreter.
   //
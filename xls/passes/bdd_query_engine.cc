@@ -17,7 +17,9 @@
 #include <cstdint>
 #include <optional>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -35,45 +37,76 @@
 namespace xls {
 
 absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
-  XLS_ASSIGN_OR_RETURN(bdd_function_,
-                       BddFunction::Run(f, path_limit_, node_filter_));
+  if (partition_thread_count_ > 0) {
+    XLS_ASSIGN_OR_RETURN(
+        bdd_function_,
+        BddFunction::RunPartitioned(f, path_limit_, node_filter_,
+                                    partition_thread_count_));
+  } else {
+    XLS_ASSIGN_OR_RETURN(bdd_function_,
+                         BddFunction::Run(f, path_limit_, node_filter_));
+  }
   // Construct the Bits objects indication which bit values are statically known
   // for each node and what those values are (0 or 1) if known.
-  BinaryDecisionDiagram& bdd = this->bdd();
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
-    if (node->GetType()->IsBits()) {
-      absl::InlinedVector<bool, 1> known_bits;
-      absl::InlinedVector<bool, 1> bits_values;
-      for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
-        if (GetBddNode(TreeBitLocation(node, i)) == bdd.zero()) {
-          known_bits.push_back(true);
-          bits_values.push_back(false);
-        } else if (GetBddNode(TreeBitLocation(node, i)) == bdd.one()) {
-          known_bits.push_back(true);
-          bits_values.push_back(true);
-        } else {
-          known_bits.push_back(false);
-          bits_values.push_back(false);
-        }
-      }
-      if (!known_bits_.contains(node)) {
-        known_bits_[node] = Bits(known_bits.size());
-        bits_values_[node] = Bits(bits_values.size());
-      }
-      Bits new_known_bits(known_bits);
-      Bits new_bits_values(bits_values);
-      // TODO(taktoa): check for inconsistency
-      Bits ored_known_bits = bits_ops::Or(known_bits_[node], new_known_bits);
-      Bits ored_bits_values = bits_ops::Or(bits_values_[node], new_bits_values);
-      if ((ored_known_bits != known_bits_[node]) ||
-          (ored_bits_values != bits_values_[node])) {
-        rf = ReachedFixpoint::Changed;
-      }
-      known_bits_[node] = ored_known_bits;
-      bits_values_[node] = ored_bits_values;
+    if (UpdateKnownBits(node) == ReachedFixpoint::Changed) {
+      rf = ReachedFixpoint::Changed;
+    }
+  }
+  return rf;
+}
+
+absl::StatusOr<ReachedFixpoint> BddQueryEngine::PopulateWithNodes(
+    FunctionBase* f, absl::Span<Node* const> nodes) {
+  XLS_ASSIGN_OR_RETURN(
+      bdd_function_,
+      BddFunction::RunOnNodes(f, nodes, path_limit_, node_filter_));
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* node : nodes) {
+    if (UpdateKnownBits(node) == ReachedFixpoint::Changed) {
+      rf = ReachedFixpoint::Changed;
+    }
+  }
+  return rf;
+}
+
+ReachedFixpoint BddQueryEngine::UpdateKnownBits(Node* node) {
+  if (!node->GetType()->IsBits()) {
+    return ReachedFixpoint::Unchanged;
+  }
+  absl::InlinedVector<bool, 1> known_bits;
+  absl::InlinedVector<bool, 1> bits_values;
+  for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+    std::optional<ConeNode> bdd_node = GetBddNode(TreeBitLocation(node, i));
+    if (bdd_node.has_value() && bdd_node->node == bdd(bdd_node->cone).zero()) {
+      known_bits.push_back(true);
+      bits_values.push_back(false);
+    } else if (bdd_node.has_value() &&
+               bdd_node->node == bdd(bdd_node->cone).one()) {
+      known_bits.push_back(true);
+      bits_values.push_back(true);
+    } else {
+      known_bits.push_back(false);
+      bits_values.push_back(false);
     }
   }
+  if (!known_bits_.contains(node)) {
+    known_bits_[node] = Bits(known_bits.size());
+    bits_values_[node] = Bits(bits_values.size());
+  }
+  Bits new_known_bits(known_bits);
+  Bits new_bits_values(bits_values);
+  // TODO(taktoa): check for inconsistency
+  Bits ored_known_bits = bits_ops::Or(known_bits_[node], new_known_bits);
+  Bits ored_bits_values = bits_ops::Or(bits_values_[node], new_bits_values);
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  if ((ored_known_bits != known_bits_[node]) ||
+      (ored_bits_values != bits_values_[node])) {
+    rf = ReachedFixpoint::Changed;
+  }
+  known_bits_[node] = ored_known_bits;
+  bits_values_[node] = ored_bits_values;
   return rf;
 }
 
@@ -85,61 +118,88 @@ bool BddQueryEngine::AtMostOneTrue(
     return false;
   }
 
-  BddNodeIndex result = bdd().zero();
   for (const TreeBitLocation& loc : bits) {
     if (!IsTracked(loc.node())) {
       return false;
     }
   }
 
+  // Collect the bits which may be true. Bits in different cones depend on
+  // disjoint sets of variables, so two such bits in different cones can be
+  // true simultaneously.
+  std::optional<int64_t> cone;
+  std::vector<BddNodeIndex> maybe_true;
+  for (const TreeBitLocation& loc : bits) {
+    std::optional<ConeNode> bdd_node = GetBddNode(loc);
+    if (!bdd_node.has_value()) {
+      return false;
+    }
+    if (bdd_node->node == bdd(bdd_node->cone).zero()) {
+      continue;
+    }
+    if (cone.has_value() && *cone != bdd_node->cone) {
+      return false;
+    }
+    cone = bdd_node->cone;
+    maybe_true.push_back(bdd_node->node);
+  }
+  if (!cone.has_value()) {
+    return true;
+  }
+
   // Compute the OR-reduction of a pairwise AND of all bits. If this value is
   // zero then no two bits can be simultaneously true. Equivalently: at most one
   // bit is true.
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    std::optional<BddNodeIndex> i_bdd = GetBddNode(bits[i]);
-    if (!i_bdd.has_value()) {
-      return false;
-    }
-    for (int64_t j = i + 1; j < bits.size(); ++j) {
-      std::optional<BddNodeIndex> j_bdd = GetBddNode(bits[j]);
-      if (!j_bdd.has_value()) {
-        return false;
-      }
-      result = bdd().Or(result, bdd().And(*i_bdd, *j_bdd));
-      if (ExceedsPathLimit(result)) {
+  BinaryDecisionDiagram& bdd = this->bdd(*cone);
+  BddNodeIndex result = bdd.zero();
+  for (int64_t i = 0; i < maybe_true.size(); ++i) {
+    for (int64_t j = i + 1; j < maybe_true.size(); ++j) {
+      result = bdd.Or(result, bdd.And(maybe_true[i], maybe_true[j]));
+      if (ExceedsPathLimit(*cone, result)) {
         VLOG(3) << "AtMostOneTrue exceeded path limit of " << path_limit_;
         return false;
       }
     }
   }
-  return result == bdd().zero();
+  return result == bdd.zero();
 }
 
 bool BddQueryEngine::AtLeastOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
-  BddNodeIndex result = bdd().zero();
   // At least one bit is true is equivalent to an OR-reduction of all the bits.
+  // The bits of different cones are independent, so this is always true iff
+  // the OR-reduction of the bits of some cone is.
+  absl::flat_hash_map<int64_t, BddNodeIndex> cone_results;
   for (const TreeBitLocation& location : bits) {
     if (!IsTracked(location.node())) {
       return false;
     }
-    std::optional<BddNodeIndex> bdd_node = GetBddNode(location);
+    std::optional<ConeNode> bdd_node = GetBddNode(location);
     if (!bdd_node.has_value()) {
       return false;
     }
-    result = bdd().Or(result, *bdd_node);
-    if (ExceedsPathLimit(result)) {
+    BinaryDecisionDiagram& bdd = this->bdd(bdd_node->cone);
+    auto [it, inserted] = cone_results.try_emplace(bdd_node->cone, bdd.zero());
+    BddNodeIndex& result = it->second;
+    result = bdd.Or(result, bdd_node->node);
+    if (ExceedsPathLimit(bdd_node->cone, result)) {
       VLOG(3) << "AtLeastOneTrue exceeded path limit of " << path_limit_;
       return false;
     }
   }
-  return result == bdd().one();
+  for (const auto& [cone, result] : cone_results) {
+    if (result == bdd(cone).one()) {
+      return true;
+    }
+  }
+  return false;
 }
 
-bool BddQueryEngine::Implies(const BddNodeIndex& a,
+bool BddQueryEngine::Implies(int64_t cone, const BddNodeIndex& a,
                              const BddNodeIndex& b) const {
   // A implies B  <=>  !(A && !B)
-  return bdd().And(a, bdd().Not(b)) == bdd().zero();
+  BinaryDecisionDiagram& bdd = this->bdd(cone);
+  return bdd.And(a, bdd.Not(b)) == bdd.zero();
 }
 
 bool BddQueryEngine::Implies(const TreeBitLocation& a,
@@ -147,15 +207,21 @@ bool BddQueryEngine::Implies(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
-  std::optional<BddNodeIndex> a_bdd = GetBddNode(a);
+  std::optional<ConeNode> a_bdd = GetBddNode(a);
   if (!a_bdd.has_value()) {
     return false;
   }
-  std::optional<BddNodeIndex> b_bdd = GetBddNode(b);
+  std::optional<ConeNode> b_bdd = GetBddNode(b);
   if (!b_bdd.has_value()) {
     return false;
   }
-  return Implies(*a_bdd, *b_bdd);
+  if (a_bdd->cone != b_bdd->cone) {
+    // The expressions depend on disjoint sets of variables, so A implies B
+    // only if A is always false or B is always true.
+    return a_bdd->node == bdd(a_bdd->cone).zero() ||
+           b_bdd->node == bdd(b_bdd->cone).one();
+  }
+  return Implies(a_bdd->cone, a_bdd->node, b_bdd->node);
 }
 
 std::optional<Bits> BddQueryEngine::ImpliedNodeValue(
@@ -176,48 +242,56 @@ std::optional<TernaryVector> BddQueryEngine::ImpliedNodeTernary(
   if (!IsTracked(node) || !node->GetType()->IsBits()) {
     return std::nullopt;
   }
-
-  // Create a Bdd node for the predicate_bit_values.
-  BddNodeIndex bdd_predicate_bit = bdd().one();
+  // Create a Bdd node for the predicate_bit_values in each cone. The
+  // predicate is the conjunction of these, and as the cones are independent the
+  // conjuncts in other cones only matter if they are false.
+  absl::flat_hash_map<int64_t, BddNodeIndex> cone_predicates;
   for (const auto& [conjuction_bit_location, conjunction_value] :
        predicate_bit_values) {
-    std::optional<BddNodeIndex> conjuction_bit =
+    std::optional<ConeNode> conjuction_bit =
         GetBddNode(conjuction_bit_location);
     if (!conjuction_bit.has_value()) {
       // Skip this predicate; we don't recognize the node, so we can't see the
       // effects of assuming it.
       continue;
     }
-    conjuction_bit =
-        conjunction_value ? *conjuction_bit : bdd().Not(*conjuction_bit);
-    bdd_predicate_bit = bdd().And(bdd_predicate_bit, *conjuction_bit);
-    if (ExceedsPathLimit(bdd_predicate_bit)) {
+    int64_t cone = conjuction_bit->cone;
+    BinaryDecisionDiagram& bdd = this->bdd(cone);
+    auto [it, inserted] = cone_predicates.try_emplace(cone, bdd.one());
+    BddNodeIndex& bdd_predicate_bit = it->second;
+    bdd_predicate_bit = bdd.And(
+        bdd_predicate_bit, conjunction_value ? conjuction_bit->node
+                                             : bdd.Not(conjuction_bit->node));
+    if (ExceedsPathLimit(cone, bdd_predicate_bit)) {
       return std::nullopt;
     }
   }
   // If the predicate evaluates to false, we can't determine
   // what node value it implies. That is, !predicate || node_bit
   // evaluates to true for both node_bit == 1 and == 0.
-  if (bdd_predicate_bit == bdd().zero()) {
-    return std::nullopt;
+  for (const auto& [cone, bdd_predicate_bit] : cone_predicates) {
+    if (bdd_predicate_bit == bdd(cone).zero()) {
+      return std::nullopt;
+    }
   }
 
-  enum class ImpliedValue : std::uint8_t {
-    kNotAnalyzable,
-    kUnknown,
-    kImpliedTrue,
-    kImpliedFalse
-  };
+  // Each bit of the node is only affected by the predicate in its own cone.
   auto implied_value = [&](int node_idx) -> std::optional<TernaryValue> {
-    std::optional<BddNodeIndex> bdd_node_bit =
+    std::optional<ConeNode> bdd_node_bit =
         GetBddNode(TreeBitLocation(node, node_idx));
     if (!bdd_node_bit.has_value()) {
       return std::nullopt;
     }
-    if (Implies(bdd_predicate_bit, *bdd_node_bit)) {
+    int64_t cone = bdd_node_bit->cone;
+    BinaryDecisionDiagram& bdd = this->bdd(cone);
+    auto predicate_it = cone_predicates.find(cone);
+    BddNodeIndex bdd_predicate_bit = predicate_it == cone_predicates.end()
+                                         ? bdd.one()
+                                         : predicate_it->second;
+    if (Implies(cone, bdd_predicate_bit, bdd_node_bit->node)) {
       return TernaryValue::kKnownOne;
     }
-    if (Implies(bdd_predicate_bit, bdd().Not(*bdd_node_bit))) {
+    if (Implies(cone, bdd_predicate_bit, bdd.Not(bdd_node_bit->node))) {
       return TernaryValue::kKnownZero;
     }
     return TernaryValue::kUnknown;
@@ -245,15 +319,19 @@ bool BddQueryEngine::KnownEquals(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
-  std::optional<BddNodeIndex> a_bdd = GetBddNode(a);
+  std::optional<ConeNode> a_bdd = GetBddNode(a);
   if (!a_bdd.has_value()) {
     return false;
   }
-  std::optional<BddNodeIndex> b_bdd = GetBddNode(b);
+  std::optional<ConeNode> b_bdd = GetBddNode(b);
   if (!b_bdd.has_value()) {
     return false;
   }
-  return *a_bdd == *b_bdd;
+  if (a_bdd->cone != b_bdd->cone) {
+    // Only constants can be equal across independent cones.
+    return IsConstant(*a_bdd) && a_bdd->node == b_bdd->node;
+  }
+  return a_bdd->node == b_bdd->node;
 }
 
 bool BddQueryEngine::KnownNotEquals(const TreeBitLocation& a,
@@ -261,15 +339,19 @@ bool BddQueryEngine::KnownNotEquals(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
-  std::optional<BddNodeIndex> a_bdd = GetBddNode(a);
+  std::optional<ConeNode> a_bdd = GetBddNode(a);
   if (!a_bdd.has_value()) {
     return false;
   }
-  std::optional<BddNodeIndex> b_bdd = GetBddNode(b);
+  std::optional<ConeNode> b_bdd = GetBddNode(b);
   if (!b_bdd.has_value()) {
     return false;
   }
-  return *a_bdd == bdd().Not(*b_bdd);
+  if (a_bdd->cone != b_bdd->cone) {
+    return IsConstant(*a_bdd) && IsConstant(*b_bdd) &&
+           a_bdd->node != b_bdd->node;
+  }
+  return a_bdd->node == bdd(a_bdd->cone).Not(b_bdd->node);
 }
 
 }  // namespace xls
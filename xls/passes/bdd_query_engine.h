@@ -48,14 +48,27 @@ class BddQueryEngine : public QueryEngine {
   // terminals 0 and 1 to allow for a BDD expression before truncating it.
   // `node_filter` is an optional function which can be used to limit the nodes
   // which the BDD evaluates (returning false means the node will node be
-  // evaluated). See BddFunction for details.
+  // evaluated). See BddFunction for details. If `partition_thread_count` is
+  // positive the function is partitioned into cones which share no BDD
+  // variables, built concurrently on that many threads (see
+  // BddFunction::RunPartitioned); queries spanning several cones are answered
+  // exactly using the independence of the cones.
   explicit BddQueryEngine(int64_t path_limit = 0,
                           std::optional<std::function<bool(const Node*)>>
-                              node_filter = std::nullopt)
-      : path_limit_(path_limit), node_filter_(node_filter) {}
+                              node_filter = std::nullopt,
+                          int64_t partition_thread_count = 0)
+      : path_limit_(path_limit),
+        node_filter_(node_filter),
+        partition_thread_count_(partition_thread_count) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // As Populate, but only analyzes `nodes`, which must be in topological order;
+  // see BddFunction::RunOnNodes. Other nodes are not tracked. Ignores
+  // `partition_thread_count`.
+  absl::StatusOr<ReachedFixpoint> PopulateWithNodes(
+      FunctionBase* f, absl::Span<Node* const> nodes);
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -92,27 +105,54 @@ class BddQueryEngine : public QueryEngine {
   // generally mutate the object. We sneakily avoid conflicts with C++ const
   // because the BDD is only held indirectly via pointers.
   // TODO(meheff): Enable queries on a BDD with out mutating the BDD itself.
-  BinaryDecisionDiagram& bdd() const { return bdd_function_->bdd(); }
+  BinaryDecisionDiagram& bdd(int64_t cone) const {
+    return bdd_function_->bdd(cone);
+  }
+
+  // A BDD node and the cone of the BDD which holds it.
+  struct ConeNode {
+    int64_t cone;
+    BddNodeIndex node;
+  };
 
   // Returns the BDD node associated with the given bit, if there is one;
   // otherwise returns std::nullopt.
-  std::optional<BddNodeIndex> GetBddNode(
-      const TreeBitLocation& location) const {
+  std::optional<ConeNode> GetBddNode(const TreeBitLocation& location) const {
     CHECK(location.tree_index().empty());
     CHECK(location.node()->GetType()->IsBits());
-    return bdd_function_->TryGetBddNode(location.node(), location.bit_index());
+    std::optional<BddNodeIndex> node =
+        bdd_function_->TryGetBddNode(location.node(), location.bit_index());
+    if (!node.has_value()) {
+      return std::nullopt;
+    }
+    return ConeNode{.cone = *bdd_function_->GetCone(location.node(),
+                                                    location.bit_index()),
+                    .node = *node};
   }
 
+  // Returns whether the given node is the terminal zero or one. These have the
+  // same index in the BDD of every cone.
+  bool IsConstant(const ConeNode& node) const {
+    return node.node == bdd(node.cone).zero() ||
+           node.node == bdd(node.cone).one();
+  }
+
+  // Notes the bits of `node` which the BDD shows to be constant. Returns
+  // whether that is more than was known before.
+  ReachedFixpoint UpdateKnownBits(Node* node);
+
   // A implies B  <=>  !(A && !B)
-  bool Implies(const BddNodeIndex& a, const BddNodeIndex& b) const;
+  bool Implies(int64_t cone, const BddNodeIndex& a,
+               const BddNodeIndex& b) const;
 
   // Returns true if the expression of the given BDD node exceeds the path
   // limit.
   // TODO(meheff): This should be part of the BDD itself where a query can be
   // performed and the BDD method returns a union of path limit exceeded or
   // the result of the query.
-  bool ExceedsPathLimit(BddNodeIndex node) const {
-    return path_limit_ > 0 && bdd().GetNode(node).path_count > path_limit_;
+  bool ExceedsPathLimit(int64_t cone, BddNodeIndex node) const {
+    return path_limit_ > 0 &&
+           bdd(cone).GetNode(node).path_count > path_limit_;
   }
 
   // The maximum number of paths in expression in the BDD before truncating.
@@ -120,6 +160,10 @@ class BddQueryEngine : public QueryEngine {
 
   std::optional<std::function<bool(const Node*)>> node_filter_;
 
+  // The number of threads with which to build a partitioned BDD, or zero to
+  // build a single BDD.
+  int64_t partition_thread_count_;
+
   // Indicates the bits at the output of each node which have known values.
   absl::flat_hash_map<Node*, Bits> known_bits_;
 
@@ -337,5 +337,59 @@ fn __sample__main(x0: bits[16], x1: bits[8], x2: bits[10], x3: bits[1]) -> (bits
       << "Expected failure to find result due to path-size explosion.";
 }
 
+TEST_F(BddQueryEngineTest, PartitionedQueriesSpanningCones) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(1));
+  BValue b = fb.Param("b", p->GetBitsType(1));
+  BValue c = fb.Param("c", p->GetBitsType(1));
+  BValue a_and_not_a = fb.And(a, fb.Not(a));
+  BValue a_or_not_a = fb.Or(a, fb.Not(a));
+  BValue b_and_c = fb.And(b, c);
+  BValue b_or_c = fb.Or(b, c);
+  BValue c_and_not_c = fb.And(c, fb.Not(c));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  BddQueryEngine query_engine(/*path_limit=*/0, /*node_filter=*/std::nullopt,
+                              /*partition_thread_count=*/2);
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+
+  // `a` and `b`/`c` are in separate cones.
+  EXPECT_TRUE(query_engine.AtMostOneTrue(
+      {TreeBitLocation(a_and_not_a.node(), 0), TreeBitLocation(b.node(), 0)}));
+  EXPECT_FALSE(query_engine.AtMostOneTrue(
+      {TreeBitLocation(a.node(), 0), TreeBitLocation(b.node(), 0)}));
+  EXPECT_TRUE(query_engine.AtLeastOneTrue(
+      {TreeBitLocation(a_or_not_a.node(), 0), TreeBitLocation(b.node(), 0)}));
+  EXPECT_FALSE(query_engine.AtLeastOneTrue(
+      {TreeBitLocation(a.node(), 0), TreeBitLocation(b.node(), 0)}));
+  EXPECT_TRUE(Implies(query_engine, b_and_c.node(), b_or_c.node()));
+  EXPECT_TRUE(Implies(query_engine, a_and_not_a.node(), b.node()));
+  EXPECT_TRUE(Implies(query_engine, b.node(), a_or_not_a.node()));
+  EXPECT_FALSE(Implies(query_engine, a.node(), b.node()));
+  EXPECT_TRUE(KnownEquals(query_engine, a_and_not_a.node(),
+                          c_and_not_c.node()));
+  EXPECT_TRUE(KnownNotEquals(query_engine, a_or_not_a.node(),
+                             c_and_not_c.node()));
+  EXPECT_FALSE(KnownEquals(query_engine, a.node(), b.node()));
+  EXPECT_FALSE(KnownNotEquals(query_engine, a.node(), b.node()));
+
+  // A predicate in one cone only implies values in that cone, unless it is
+  // unsatisfiable.
+  EXPECT_THAT(query_engine.ImpliedNodeValue(
+                  {{TreeBitLocation(b_and_c.node(), 0), true},
+                   {TreeBitLocation(a.node(), 0), true}},
+                  b_or_c.node()),
+              testing::Optional(UBits(1, 1)));
+  EXPECT_EQ(query_engine.ImpliedNodeValue(
+                {{TreeBitLocation(b_and_c.node(), 0), true}}, a.node()),
+            std::nullopt);
+  EXPECT_EQ(query_engine.ImpliedNodeValue(
+                {{TreeBitLocation(b_and_c.node(), 0), true},
+                 {TreeBitLocation(a_and_not_a.node(), 0), true}},
+                b_or_c.node()),
+            std::nullopt);
+}
+
 }  // namespace
 }  // namespace xls
@@ -43,10 +43,12 @@
 #include "xls/ir/value.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
@@ -442,8 +444,14 @@ absl::StatusOr<bool> BddSimplificationPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<BddQueryEngine>(
-      BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  if (BudgetUsed(options, 1.0)) {
+    RecordCurtailment(options, short_name(),
+                      "used ternary analysis instead of BDDs");
+    query_engines.push_back(MakeTernaryQueryEngine(f, options));
+  } else {
+    query_engines.push_back(std::make_unique<BddQueryEngine>(
+        BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  }
 
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
@@ -37,6 +37,8 @@ class BddSimplificationPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~BddSimplificationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   // Run all registered passes in order of registration.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -20,6 +20,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -29,6 +31,7 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/package.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
@@ -66,6 +69,28 @@ TEST_F(BddSimplificationPassTest, ReplaceAllKnownValues) {
   EXPECT_THAT(f->return_value(), m::Literal(0b11110000));
 }
 
+TEST_F(BddSimplificationPassTest, SpentBudgetUsesTernaryAnalysis) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue y = fb.Param("y", p->GetBitsType(4));
+  BValue x_or_not_x = fb.Or(x, fb.Not(x));
+  fb.Concat({x_or_not_x, fb.And(y, fb.Literal(UBits(0, 4)))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OptimizationBudget budget(absl::Seconds(1), absl::Now() - absl::Seconds(10));
+  OptimizationPassOptions options;
+  options.budget = &budget;
+  PassResults results;
+  XLS_ASSERT_OK(BddSimplificationPass(kMaxOptLevel)
+                    .RunOnFunctionBase(f, options, &results)
+                    .status());
+  // Ternary analysis does not see that `x | ~x` is all ones.
+  EXPECT_FALSE(x_or_not_x.node()->users().empty());
+  ASSERT_EQ(budget.curtailments().size(), 1);
+  EXPECT_EQ(budget.curtailments()[0].pass_name, "bdd_simp");
+}
+
 TEST_F(BddSimplificationPassTest, ReplaceKnownPrefix) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -80,6 +80,8 @@ class BooleanSimplificationPass : public OptimizationFunctionBasePass {
   BooleanSimplificationPass()
       : OptimizationFunctionBasePass(kName, "boolean simplification") {}
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -38,6 +38,8 @@ class CanonicalizationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Canonicalization") {}
   ~CanonicalizationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
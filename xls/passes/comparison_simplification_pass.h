@@ -37,6 +37,8 @@ class ComparisonSimplificationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Comparison Simplification") {}
   ~ComparisonSimplificationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
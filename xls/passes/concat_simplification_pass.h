@@ -35,6 +35,8 @@ class ConcatSimplificationPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~ConcatSimplificationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   int64_t opt_level_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
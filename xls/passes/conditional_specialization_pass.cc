@@ -51,6 +51,7 @@
 #include "xls/ir/value_utils.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -74,6 +75,11 @@ struct Condition {
   bool operator==(const Condition& other) const {
     return node == other.node && value == other.value;
   }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const Condition& condition) {
+    return H::combine(std::move(h), condition.node, condition.value);
+  }
 };
 
 // A comparison functor for ordering Conditions. The functor orders conditions
@@ -298,11 +304,70 @@ class ConditionMap {
   absl::flat_hash_map<std::pair<Node*, int64_t>, ConditionSet> edge_conditions_;
 };
 
+// Answers queries of the query engine for the value of a node implied by a
+// condition set. In nested select trees the same cones are queried under the
+// same conditions from many users, so answers are cached by (node, condition
+// set). Once `query_budget` queries have been made of the query engine no more
+// are made and no value is implied, which bounds the work done on a function.
+class ImpliedValueCache {
+ public:
+  ImpliedValueCache(const QueryEngine& query_engine, int64_t query_budget)
+      : query_engine_(query_engine), query_budget_(query_budget) {}
+
+  std::optional<Bits> ImpliedNodeValue(const ConditionSet& condition_set,
+                                       Node* node) {
+    auto [it, inserted] =
+        values_.try_emplace(MakeKey(condition_set, node), std::nullopt);
+    if (inserted && ConsumeQuery()) {
+      it->second = query_engine_.ImpliedNodeValue(
+          condition_set.GetPredicates(), node);
+    }
+    return it->second;
+  }
+
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      const ConditionSet& condition_set, Node* node) {
+    auto [it, inserted] =
+        ternaries_.try_emplace(MakeKey(condition_set, node), std::nullopt);
+    if (inserted && ConsumeQuery()) {
+      it->second = query_engine_.ImpliedNodeTernary(
+          condition_set.GetPredicates(), node);
+    }
+    return it->second;
+  }
+
+  bool BudgetExhausted() const { return queries_ >= query_budget_; }
+
+ private:
+  using Key = std::pair<Node*, std::vector<Condition>>;
+
+  static Key MakeKey(const ConditionSet& condition_set, Node* node) {
+    return Key(node, std::vector<Condition>(condition_set.conditions().begin(),
+                                            condition_set.conditions().end()));
+  }
+
+  // Returns whether a query may be made of the query engine, counting it
+  // against the budget if so.
+  bool ConsumeQuery() {
+    if (BudgetExhausted()) {
+      return false;
+    }
+    ++queries_;
+    return true;
+  }
+
+  const QueryEngine& query_engine_;
+  const int64_t query_budget_;
+  int64_t queries_ = 0;
+  absl::flat_hash_map<Key, std::optional<Bits>> values_;
+  absl::flat_hash_map<Key, std::optional<TernaryVector>> ternaries_;
+};
+
 // Returns the value for node logically implied by the given conditions if a
 // value can be implied. Returns std::nullopt otherwise.
 std::optional<Bits> ImpliedNodeValue(const ConditionSet& condition_set,
                                      Node* node,
-                                     const QueryEngine& query_engine) {
+                                     ImpliedValueCache& implied_values) {
   for (const Condition& condition : condition_set.conditions()) {
     if (condition.node == node && ternary_ops::IsFullyKnown(condition.value)) {
       VLOG(4) << absl::StreamFormat("%s trivially implies %s==%s",
@@ -312,10 +377,8 @@ std::optional<Bits> ImpliedNodeValue(const ConditionSet& condition_set,
     }
   }
 
-  std::vector<std::pair<TreeBitLocation, bool>> predicates =
-      condition_set.GetPredicates();
   std::optional<Bits> implied_value =
-      query_engine.ImpliedNodeValue(predicates, node);
+      implied_values.ImpliedNodeValue(condition_set, node);
 
   if (implied_value.has_value()) {
     VLOG(4) << absl::StreamFormat("%s implies %s==%v", condition_set.ToString(),
@@ -328,7 +391,7 @@ std::optional<Bits> ImpliedNodeValue(const ConditionSet& condition_set,
 // value can be implied. Returns std::nullopt otherwise.
 std::optional<TernaryVector> ImpliedNodeTernary(
     const ConditionSet& condition_set, Node* node,
-    const QueryEngine& query_engine) {
+    ImpliedValueCache& implied_values) {
   if (!node->GetType()->IsBits()) {
     return std::nullopt;
   }
@@ -355,10 +418,8 @@ std::optional<TernaryVector> ImpliedNodeTernary(
     return result;
   }
 
-  std::vector<std::pair<TreeBitLocation, bool>> predicates =
-      condition_set.GetPredicates();
   std::optional<TernaryVector> implied_ternary =
-      query_engine.ImpliedNodeTernary(predicates, node);
+      implied_values.ImpliedNodeTernary(condition_set, node);
   if (implied_ternary.has_value()) {
     VLOG(4) << absl::StreamFormat("%s implies %s==%s", condition_set.ToString(),
                                   node->GetName(),
@@ -433,7 +494,9 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  if (use_bdd_) {
+  if (use_bdd_ && BudgetUsed(options, 1.0)) {
+    RecordCurtailment(options, short_name(), "ran without BDDs");
+  } else if (use_bdd_) {
     query_engines.push_back(std::make_unique<BddQueryEngine>(
         BddFunction::kDefaultPathLimit, IsCheapForBdds));
   }
@@ -441,6 +504,8 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
 
+  ImpliedValueCache implied_values(query_engine,
+                                   queries_per_node_ * f->node_count());
   ConditionMap condition_map(f);
 
   // Iterate backwards through the graph because we add conditions at the case
@@ -669,7 +734,7 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
       // First check to see if the condition set directly implies a value for
       // the operand. If so replace with the implied value.
       if (std::optional<Bits> implied_value =
-              ImpliedNodeValue(edge_set, operand, query_engine);
+              ImpliedNodeValue(edge_set, operand, implied_values);
           implied_value.has_value()) {
         VLOG(3) << absl::StreamFormat("Replacing operand %d of %s with %v",
                                       operand_no, node->GetName(),
@@ -716,7 +781,7 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
               break;
             }
             std::optional<Bits> implied_selector =
-                ImpliedNodeValue(edge_set, select->selector(), query_engine);
+                ImpliedNodeValue(edge_set, select->selector(), implied_values);
             if (!implied_selector.has_value()) {
               break;
             }
@@ -735,8 +800,8 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
             if (select->selector()->Is<Literal>()) {
               break;
             }
-            std::optional<TernaryVector> implied_selector =
-                ImpliedNodeTernary(edge_set, select->selector(), query_engine);
+            std::optional<TernaryVector> implied_selector = ImpliedNodeTernary(
+                edge_set, select->selector(), implied_values);
             if (!implied_selector.has_value()) {
               break;
             }
@@ -760,7 +825,7 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
               break;
             }
             std::optional<TernaryVector> implied_selector =
-                ImpliedNodeTernary(edge_set, ohs->selector(), query_engine);
+                ImpliedNodeTernary(edge_set, ohs->selector(), implied_values);
             if (!implied_selector.has_value()) {
               break;
             }
@@ -776,7 +841,7 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
               std::optional<Bits> implied_case =
                   ImpliedNodeValue(condition_map.GetEdgeConditionSet(
                                        ohs, /*operand_no=*/case_no + 1),
-                                   ohs->cases()[case_no], query_engine);
+                                   ohs->cases()[case_no], implied_values);
               if (implied_case.has_value() && implied_case->IsZero()) {
                 implied_selector.value()[case_no] = TernaryValue::kKnownZero;
               }
@@ -813,7 +878,7 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
             for (Node* potential_src : bitwise_op->operands()) {
               XLS_RET_CHECK(potential_src->GetType()->IsBits());
               std::optional<Bits> implied_src =
-                  ImpliedNodeValue(edge_set, potential_src, query_engine);
+                  ImpliedNodeValue(edge_set, potential_src, implied_values);
               if (implied_src.has_value() && is_identity(*implied_src)) {
                 continue;
               }
@@ -850,6 +915,15 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
     }
   }
 
+  if (implied_values.BudgetExhausted()) {
+    VLOG(2) << absl::StreamFormat(
+        "Query budget of %s exhausted; remaining conditions only used where "
+        "they directly give a value",
+        f->name());
+    if (options.budget != nullptr) {
+      RecordCurtailment(options, short_name(), "query budget exhausted");
+    }
+  }
   return changed;
 }
 
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONDITIONAL_SPECIALIZATION_PASS_H_
 #define XLS_PASSES_CONDITIONAL_SPECIALIZATION_PASS_H_
 
+#include <cstdint>
 #include <string_view>
 
 #include "absl/status/statusor.h"
@@ -29,15 +30,28 @@ namespace xls {
 class ConditionalSpecializationPass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "cond_spec";
+  // The default of `queries_per_node`.
+  static constexpr int64_t kDefaultQueriesPerNode = 64;
+
   // If `use_bdd` is true, then binary decision diagrams (BDDs) are used for
   // stronger analysis at the cost of slower transformation.
-  explicit ConditionalSpecializationPass(bool use_bdd)
+  //
+  // At most `queries_per_node` times the number of nodes of the function base
+  // queries are made of the query engine for the values implied by the
+  // conditions at a node; after that only conditions which directly give the
+  // value of a node are used.
+  explicit ConditionalSpecializationPass(
+      bool use_bdd, int64_t queries_per_node = kDefaultQueriesPerNode)
       : OptimizationFunctionBasePass(kName, "Conditional specialization"),
-        use_bdd_(use_bdd) {}
+        use_bdd_(use_bdd),
+        queries_per_node_(queries_per_node) {}
   ~ConditionalSpecializationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   bool use_bdd_;
+  int64_t queries_per_node_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
@@ -46,11 +46,15 @@ using ::testing::A;
 
 class ConditionalSpecializationPassTest : public IrTestBase {
  protected:
-  absl::StatusOr<bool> Run(FunctionBase* f, bool use_bdd = true) {
+  absl::StatusOr<bool> Run(
+      FunctionBase* f, bool use_bdd = true,
+      int64_t queries_per_node =
+          ConditionalSpecializationPass::kDefaultQueriesPerNode) {
     PassResults results;
+    ConditionalSpecializationPass pass(use_bdd, queries_per_node);
     XLS_ASSIGN_OR_RETURN(
-        bool changed, ConditionalSpecializationPass(use_bdd).RunOnFunctionBase(
-                          f, OptimizationPassOptions(), &results));
+        bool changed,
+        pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results));
     return changed;
   }
   absl::StatusOr<bool> Run(Package* p, bool use_bdd = true) {
@@ -112,6 +116,26 @@ fn f(a: bits[32], x: bits[1]) -> bits[1] {
                                            {m::Literal(1), m::Param("x")}));
 }
 
+TEST_F(ConditionalSpecializationPassTest, QueryBudgetExhausted) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(a: bits[32], x: bits[1]) -> bits[1] {
+  literal.1: bits[32] = literal(value=7)
+  ult.2: bits[1] = ult(a, literal.1)
+  not.3: bits[1] = not(ult.2)
+  ret sel.4: bits[1] = sel(ult.2, cases=[not.3, x])
+}
+  )",
+                                                       p.get()));
+  // Without any queries of the query engine, only the condition on ult.2
+  // itself is used.
+  EXPECT_THAT(Run(f, /*use_bdd=*/true, /*queries_per_node=*/0),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::ULt(m::Param("a"), m::Literal(7)),
+                        {m::Not(m::Literal(0)), m::Param("x")}));
+}
+
 TEST_F(ConditionalSpecializationPassTest, SpecializeSelectNegative0) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
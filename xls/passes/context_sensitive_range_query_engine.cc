@@ -30,6 +30,8 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -189,11 +191,23 @@ class Analysis {
     absl::flat_hash_map<Node*, int64_t> node_indices;
     std::vector<std::pair<PredicateState, InlineBitmap>> state_and_nodes;
   };
+  // The number and duration of the specializations computed and the number
+  // skipped are written to `stats`.
+  struct Stats {
+    int64_t specialization_count = 0;
+    int64_t skipped_count = 0;
+    absl::Duration specialization_time = absl::ZeroDuration();
+  };
   Analysis(
       RangeQueryEngine& base_range,
       std::vector<std::unique_ptr<const RangeQueryEngine>>& arena,
-      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines)
-      : base_range_(base_range), arena_(arena), engines_(engines) {}
+      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines,
+      const ContextSensitiveRangeQueryEngine::Limits& limits, Stats& stats)
+      : base_range_(base_range),
+        arena_(arena),
+        engines_(engines),
+        limits_(limits),
+        stats_(stats) {}
 
   absl::StatusOr<ReachedFixpoint> Execute(FunctionBase* f) {
     // Get the topological sort once so we don't recalculate it each time.
@@ -224,26 +238,35 @@ class Analysis {
     XLS_ASSIGN_OR_RETURN(auto interesting,
                          FilterUninterestingStates(f, all_states));
     // Bucket states into equivalence classes. Any predicate-states where the
-    // arm and selector are identical
-    absl::flat_hash_map<SelectorAndArm, EquivalenceSet> equivalences;
-    equivalences.reserve(interesting.state_and_nodes.size());
+    // arm and selector are identical. The classes are kept in the order their
+    // first state appears so that capping their number is deterministic.
+    absl::flat_hash_map<SelectorAndArm, int64_t> equivalence_indices;
+    std::vector<EquivalenceSet> equivalences;
+    equivalence_indices.reserve(interesting.state_and_nodes.size());
     for (const auto& [state, interesting_nodes] : interesting.state_and_nodes) {
-      EquivalenceSet& cur =
-          equivalences
-              .try_emplace(
-                  SelectorAndArm{
-                      .selector = state.node()->As<Select>()->selector(),
-                      .arm = state.arm()},
-                  EquivalenceSet{
-                      .equivalent_states = {},
-                      .interesting_nodes = InlineBitmap(f->node_count())})
-              .first->second;
+      auto [it, inserted] = equivalence_indices.try_emplace(
+          SelectorAndArm{.selector = state.node()->As<Select>()->selector(),
+                         .arm = state.arm()},
+          equivalences.size());
+      if (inserted) {
+        equivalences.push_back(
+            EquivalenceSet{.equivalent_states = {},
+                           .interesting_nodes = InlineBitmap(f->node_count())});
+      }
+      EquivalenceSet& cur = equivalences[it->second];
       cur.equivalent_states.push_back(state);
       cur.interesting_nodes.Union(interesting_nodes);
     }
-    // NB We don't care what order we examine each equivalence (since all are
-    // disjoint).
-    for (const auto& [_, states] : equivalences) {
+    absl::Time start = absl::Now();
+    for (int64_t i = 0; i < equivalences.size(); ++i) {
+      const EquivalenceSet& states = equivalences[i];
+      if ((limits_.max_specializations.has_value() &&
+           i >= *limits_.max_specializations) ||
+          (limits_.time_budget.has_value() &&
+           absl::Now() - start >= *limits_.time_budget)) {
+        stats_.skipped_count = equivalences.size() - i;
+        break;
+      }
       // Since the all_states_ is in topo the last equiv state is usable for
       // everything.
       // We don't care what order we calculate the equivalences because each is
@@ -260,7 +283,9 @@ class Analysis {
       for (const PredicateState& ps : states.equivalent_states) {
         engines_[ps] = result;
       }
+      ++stats_.specialization_count;
     }
+    stats_.specialization_time = absl::Now() - start;
     return ReachedFixpoint::Changed;
   }
 
@@ -393,6 +418,8 @@ class Analysis {
   RangeQueryEngine& base_range_;
   std::vector<std::unique_ptr<const RangeQueryEngine>>& arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines_;
+  const ContextSensitiveRangeQueryEngine::Limits& limits_;
+  Stats& stats_;
 };
 
 // A proxy query engine which specializes using select context.
@@ -508,8 +535,14 @@ class ProxyContextQueryEngine final : public QueryEngine {
 
 absl::StatusOr<ReachedFixpoint> ContextSensitiveRangeQueryEngine::Populate(
     FunctionBase* f) {
-  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_);
-  return analysis.Execute(f);
+  Analysis::Stats stats;
+  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_, limits_,
+                    stats);
+  XLS_ASSIGN_OR_RETURN(ReachedFixpoint result, analysis.Execute(f));
+  specialization_count_ = stats.specialization_count;
+  skipped_count_ = stats.skipped_count;
+  specialization_time_ = stats.specialization_time;
+  return result;
 }
 
 std::unique_ptr<QueryEngine>
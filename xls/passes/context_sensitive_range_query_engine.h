@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 #define XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
@@ -46,12 +48,34 @@ namespace xls {
 // given their selector is at the appropriate value and propagating that down
 // for each single case. This means the engine is only able to provide
 // information for a single case at a time.
+//
+// The number of specializations computed by Populate may be capped, either by
+// count or by the time spent computing them. Specializations are computed in
+// topological order of their selects, and predicates whose specialization was
+// not computed get the results of the base case.
 class ContextSensitiveRangeQueryEngine final : public QueryEngine {
  public:
+  struct Limits {
+    // Maximum number of specializations to compute. Predicates which share a
+    // selector and arm share a specialization.
+    std::optional<int64_t> max_specializations;
+    // Time after which no more specializations are started. Unlike the count,
+    // this makes the results depend on the speed of the machine.
+    std::optional<absl::Duration> time_budget;
+  };
+
   ContextSensitiveRangeQueryEngine() = default;
+  explicit ContextSensitiveRangeQueryEngine(Limits limits) : limits_(limits) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // The number of specializations computed by the last Populate, and the
+  // number skipped because of the limits.
+  int64_t specialization_count() const { return specialization_count_; }
+  int64_t skipped_specialization_count() const { return skipped_count_; }
+  // The time spent computing specializations in the last Populate.
+  absl::Duration specialization_time() const { return specialization_time_; }
+
   LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
     return base_case_ranges_.GetIntervals(node);
   }
@@ -121,6 +145,10 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
       const absl::flat_hash_set<PredicateState>& state) const override;
 
  private:
+  Limits limits_;
+  int64_t specialization_count_ = 0;
+  int64_t skipped_count_ = 0;
+  absl::Duration specialization_time_ = absl::ZeroDuration();
   RangeQueryEngine base_case_ranges_;
   std::vector<std::unique_ptr<const RangeQueryEngine>> arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*> one_hot_ranges_;
@@ -25,6 +25,7 @@
 #include "gtest/gtest.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -316,6 +317,52 @@ TEST_F(ContextSensitiveRangeQueryEngineTest, Eq) {
               AnyOf(Eq(x_ist), Eq(res_ist)));
 }
 
+TEST_F(ContextSensitiveRangeQueryEngineTest, SpecializationLimits) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x == 12) { x + 10 } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue cond = fb.Eq(x, fb.Literal(UBits(12, 8)));
+  BValue add_ten = fb.Add(x, fb.Literal(UBits(10, 8)));
+  BValue res = fb.Select(cond, {x, add_ten});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  PredicateState consequent(res.node()->As<Select>(), kConsequentArm);
+  IntervalSetTree add_ten_ist =
+      BitsLTT(add_ten.node(), {Interval::Precise(UBits(22, 8))});
+  IntervalSetTree add_ten_ist_global =
+      BitsLTT(add_ten.node(), {Interval::Maximal(8)});
+
+  ContextSensitiveRangeQueryEngine unlimited;
+  XLS_ASSERT_OK(unlimited.Populate(f));
+  EXPECT_GT(unlimited.specialization_count(), 0);
+  EXPECT_EQ(unlimited.skipped_specialization_count(), 0);
+  EXPECT_EQ(unlimited.SpecializeGivenPredicate({consequent})
+                ->GetIntervals(add_ten.node()),
+            add_ten_ist);
+
+  // Skipped specializations fall back to the base case.
+  ContextSensitiveRangeQueryEngine no_specializations(
+      ContextSensitiveRangeQueryEngine::Limits{.max_specializations = 0});
+  XLS_ASSERT_OK(no_specializations.Populate(f));
+  EXPECT_EQ(no_specializations.specialization_count(), 0);
+  EXPECT_EQ(no_specializations.skipped_specialization_count(),
+            unlimited.specialization_count());
+  EXPECT_EQ(no_specializations.SpecializeGivenPredicate({consequent})
+                ->GetIntervals(add_ten.node()),
+            add_ten_ist_global);
+
+  ContextSensitiveRangeQueryEngine no_time(
+      ContextSensitiveRangeQueryEngine::Limits{.time_budget =
+                                                   absl::ZeroDuration()});
+  XLS_ASSERT_OK(no_time.Populate(f));
+  EXPECT_EQ(no_time.specialization_count(), 0);
+  EXPECT_EQ(no_time.SpecializeGivenPredicate({consequent})
+                ->GetIntervals(add_ten.node()),
+            add_ten_ist_global);
+}
+
 TEST_F(ContextSensitiveRangeQueryEngineTest, Ne) {
   Bits max_bits = UBits(12, 8);
   auto p = CreatePackage();
@@ -14,19 +14,23 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/node_util.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/passes/optimization_pass.h"
@@ -37,89 +41,139 @@ namespace xls {
 
 namespace {
 
-// Returns the operands of the given node for the purposes of the CSE
-// optimization. The order of the nodes may not match the order of the node's
-// actual operands. Motivation: generally for nodes to be considered equivalent
-// the operands must be in the same order. However, commutative operations are
-// agnostic to operand order. So to expand the CSE optimization, compare
-// operands as an unordered set for commutative operands. This is done be
-// ordered commutative operation operands by id prior to comparison. To avoid
-// having to construct a vector every time, a span is returned by this
-// function. If the operation is not commutative, the node's own operand span is
-// simply returned. For the commutative case, a vector of sorted operands is
-// constructed in span_backing_store from which a span is constructed.
-absl::Span<Node* const> GetOperandsForCse(
-    Node* node, std::vector<Node*>* span_backing_store) {
-  CHECK(span_backing_store->empty());
+// Returns the hash of `node` used to bucket potentially common nodes, computed
+// from its op and the ids of its operands without materializing them.
+// Commutative operations are agnostic to operand order, so for them the
+// operand hashes are combined with a commutative operation. If this is slow
+// because of many literals, the Literal values could be combined into the
+// hash. As is, all literals get the same hash value.
+uint64_t CseHash(Node* node) {
   if (!OpIsCommutative(node->op())) {
-    return node->operands();
+    uint64_t hash = absl::HashOf(node->op(), node->operand_count());
+    for (Node* operand : node->operands()) {
+      hash = absl::HashOf(hash, operand->id());
+    }
+    return hash;
+  }
+  uint64_t operand_hash_sum = 0;
+  for (Node* operand : node->operands()) {
+    operand_hash_sum += absl::HashOf(operand->id());
+  }
+  return absl::HashOf(node->op(), node->operand_count(), operand_hash_sum);
+}
+
+// Returns true if `a` and `b` have the same operands for the purposes of CSE,
+// i.e. the same operands in the same order or, for commutative operations, in
+// any order.
+bool SameOperandsForCse(Node* a, Node* b) {
+  if (!OpIsCommutative(a->op())) {
+    return a->operands() == b->operands();
+  }
+  if (a->operand_count() != b->operand_count()) {
+    return false;
   }
-  span_backing_store->insert(span_backing_store->begin(),
-                             node->operands().begin(), node->operands().end());
-  SortByNodeId(span_backing_store);
-  return *span_backing_store;
+  auto by_id = [](Node* x, Node* y) { return x->id() < y->id(); };
+  absl::InlinedVector<Node*, 4> a_operands(a->operands().begin(),
+                                           a->operands().end());
+  absl::InlinedVector<Node*, 4> b_operands(b->operands().begin(),
+                                           b->operands().end());
+  absl::c_sort(a_operands, by_id);
+  absl::c_sort(b_operands, by_id);
+  return a_operands == b_operands;
 }
 
 }  // namespace
 
-absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements) {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
-    std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
-    }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
+CseValueNumbering::CseValueNumbering(FunctionBase* f) : function_base_(f) {
+  function_base_->RegisterChangeListener(this);
+  dirty_.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    dirty_.insert(node);
+  }
+}
+
+CseValueNumbering::~CseValueNumbering() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+void CseValueNumbering::Forget(Node* node) {
+  auto it = hashes_.find(node);
+  if (it == hashes_.end()) {
+    return;
+  }
+  auto bucket = buckets_.find(it->second);
+  CHECK(bucket != buckets_.end());
+  std::vector<Node*>& nodes = bucket->second;
+  nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+  if (nodes.empty()) {
+    buckets_.erase(bucket);
+  }
+  hashes_.erase(it);
+}
+
+void CseValueNumbering::NodeDeleted(Node* node) {
+  Forget(node);
+  dirty_.erase(node);
+}
+
+void CseValueNumbering::OperandChanged(Node* node, Node* old_operand,
+                                       absl::Span<const int64_t> operand_nos) {
+  Forget(node);
+  dirty_.insert(node);
+}
+
+void CseValueNumbering::FunctionBaseDeleted(FunctionBase* f) {
+  function_base_ = nullptr;
+  dirty_.clear();
+  buckets_.clear();
+  hashes_.clear();
+}
 
+absl::StatusOr<bool> CseValueNumbering::Run(
+    absl::flat_hash_map<Node*, Node*>* replacements) {
+  XLS_RET_CHECK(function_base_ != nullptr);
+  if (dirty_.empty()) {
+    return false;
+  }
   bool changed = false;
-  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
-  node_buckets.reserve(f->node_count());
-  for (Node* node : TopoSort(f)) {
-    if (OpIsSideEffecting(node->op())) {
+  // Replacing a node marks its users dirty; they come later in the order and
+  // are visited in the same run.
+  for (Node* node : TopoSort(function_base_)) {
+    if (dirty_.erase(node) == 0 || OpIsSideEffecting(node->op())) {
       continue;
     }
-
-    int64_t hash = node_hash(node);
-    if (!node_buckets.contains(hash)) {
-      node_buckets[hash].push_back(node);
+    uint64_t hash = CseHash(node);
+    std::vector<Node*>& bucket = buckets_[hash];
+    auto candidate = absl::c_find_if(bucket, [&](Node* candidate) {
+      return SameOperandsForCse(node, candidate) &&
+             node->IsDefinitelyEqualTo(candidate);
+    });
+    if (candidate == bucket.end()) {
+      bucket.push_back(node);
+      hashes_[node] = hash;
       continue;
     }
-    bool replaced = false;
-    std::vector<Node*> node_span_backing_store;
-    absl::Span<Node* const> node_operands_for_cse =
-        GetOperandsForCse(node, &node_span_backing_store);
-    for (Node* candidate : node_buckets.at(hash)) {
-      std::vector<Node*> candidate_span_backing_store;
-      if (node_operands_for_cse ==
-              GetOperandsForCse(candidate, &candidate_span_backing_store) &&
-          node->IsDefinitelyEqualTo(candidate)) {
-        VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
-                                      node->GetName(), candidate->GetName());
-        XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
-        if (replacements != nullptr) {
-          (*replacements)[node] = candidate;
-        }
-        changed = true;
-        replaced = true;
-        break;
-      }
-    }
-    if (!replaced) {
-      node_buckets[hash].push_back(node);
+    VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
+                                  node->GetName(), (*candidate)->GetName());
+    if (replacements != nullptr) {
+      (*replacements)[node] = *candidate;
     }
+    // The surviving node now also computes the value of `node`, so it carries
+    // both source locations.
+    (*candidate)->MergeLoc(node);
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(*candidate));
+    changed = true;
   }
-
   return changed;
 }
 
+absl::StatusOr<bool> RunCse(FunctionBase* f,
+                            absl::flat_hash_map<Node*, Node*>* replacements) {
+  return CseValueNumbering(f).Run(replacements);
+}
+
 absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
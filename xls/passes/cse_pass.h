@@ -15,10 +15,15 @@
 #ifndef XLS_PASSES_CSE_PASS_H_
 #define XLS_PASSES_CSE_PASS_H_
 
+#include <cstdint>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/passes/optimization_pass.h"
@@ -26,6 +31,54 @@
 
 namespace xls {
 
+// A structural value numbering of the side-effect free nodes of a single
+// function base, used to merge common subexpressions. Nodes are bucketed by a
+// hash of their op and (for commutative ops, unordered) operands, and nodes
+// in the same bucket are compared with Node::IsDefinitelyEqualTo.
+//
+// The table listens for changes to the IR and keeps itself up to date: added
+// nodes and nodes whose operands were replaced are rehashed by the next call
+// to Run, and removed nodes are forgotten immediately. It can therefore be
+// kept alive across passes, with each Run only visiting the nodes which
+// changed since the previous one.
+class CseValueNumbering final : public ChangeListener {
+ public:
+  explicit CseValueNumbering(FunctionBase* f);
+  ~CseValueNumbering() override;
+
+  CseValueNumbering(const CseValueNumbering&) = delete;
+  CseValueNumbering& operator=(const CseValueNumbering&) = delete;
+
+  // Replaces the uses of each changed node which is equivalent to a node
+  // already in the table with that node, in topological order, and adds the
+  // others to the table. Each replacement is added to `replacements` if it is
+  // not `nullptr`. Returns true if any node was replaced.
+  absl::StatusOr<bool> Run(absl::flat_hash_map<Node*, Node*>* replacements);
+
+  // Returns the function base this table is bound to, or nullptr if it has
+  // been destroyed.
+  FunctionBase* function_base() const { return function_base_; }
+
+  // Returns the number of nodes which the next call to Run will visit.
+  int64_t dirty_node_count() const { return dirty_.size(); }
+
+  void NodeAdded(Node* node) override { dirty_.insert(node); }
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override;
+  void FunctionBaseDeleted(FunctionBase* f) override;
+
+ private:
+  // Removes `node` from its bucket, if it is in one.
+  void Forget(Node* node);
+
+  FunctionBase* function_base_;
+  absl::flat_hash_set<Node*> dirty_;
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> buckets_;
+  // The hash of each node in `buckets_` when it was added.
+  absl::flat_hash_map<Node*, uint64_t> hashes_;
+};
+
 // This function is called by the `CsePass` to merge together common
 // subexpressions. It exists so that you can call it inside other passes and
 // extract which nodes were merged. Each replacement done by the pass is added
@@ -65,6 +118,8 @@ class CsePass : public OptimizationFunctionBasePass {
                                      "Common subexpression elimination") {}
   ~CsePass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -26,8 +26,11 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -38,6 +41,8 @@ namespace xls {
 namespace {
 
 using status_testing::IsOkAndHolds;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 TEST(FixedPointOfSPO, Simple) {
   absl::flat_hash_map<std::string, std::string> spo;
@@ -101,6 +106,23 @@ TEST_F(CsePassTest, TwoIdenticalLiterals) {
   EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, MergesSourceLocations) {
+  auto p = CreatePackage();
+  p->SetFileno(Fileno(1), "a.x");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+        add.1: bits[8] = add(x, y, pos=[(1,2,3)])
+        add.2: bits[8] = add(x, y, pos=[(1,4,5)])
+        ret tuple.3: (bits[8], bits[8]) = tuple(add.1, add.2)
+     }
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  Node* add = f->return_value()->operand(0);
+  EXPECT_EQ(add, f->return_value()->operand(1));
+  EXPECT_EQ(add->loc().ToString(), "[(1,2,3), (1,4,5)]");
+}
+
 TEST_F(CsePassTest, NontrivialCommonSubexpressions) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
@@ -234,5 +256,48 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, ValueNumberingOnlyRevisitsChangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue product = fb.UMul(sum, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(product));
+
+  CseValueNumbering value_numbering(f);
+  EXPECT_EQ(value_numbering.dirty_node_count(), 4);
+  EXPECT_THAT(value_numbering.Run(nullptr), IsOkAndHolds(false));
+  EXPECT_EQ(value_numbering.dirty_node_count(), 0);
+
+  // A commuted copy of `sum` is merged with it, and the user of the copy is
+  // then merged with `product`.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sum_copy,
+      f->MakeNode<BinOp>(SourceInfo(), y.node(), x.node(), Op::kAdd));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * product_copy,
+      f->MakeNode<ArithOp>(SourceInfo(), sum_copy, y.node(), 32, Op::kUMul));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * result,
+      f->MakeNode<BinOp>(SourceInfo(), product.node(), product_copy,
+                         Op::kSub));
+  XLS_ASSERT_OK(f->set_return_value(result));
+  EXPECT_EQ(value_numbering.dirty_node_count(), 3);
+
+  absl::flat_hash_map<Node*, Node*> replacements;
+  EXPECT_THAT(value_numbering.Run(&replacements), IsOkAndHolds(true));
+  EXPECT_THAT(replacements,
+              UnorderedElementsAre(Pair(sum_copy, sum.node()),
+                                   Pair(product_copy, product.node())));
+  EXPECT_EQ(result->operand(0), product.node());
+  EXPECT_EQ(result->operand(1), product.node());
+
+  // Removing the merged nodes leaves nothing to do.
+  XLS_ASSERT_OK(f->RemoveNode(product_copy));
+  XLS_ASSERT_OK(f->RemoveNode(sum_copy));
+  EXPECT_THAT(value_numbering.Run(nullptr), IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
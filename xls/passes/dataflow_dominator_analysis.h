@@ -15,56 +15,49 @@
 #ifndef XLS_PASSES_DATAFLOW_DOMINATOR_ANALYSIS_H_
 #define XLS_PASSES_DATAFLOW_DOMINATOR_ANALYSIS_H_
 
-#include <memory>
+#include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
-#include "absl/types/span.h"
 #include "xls/ir/node.h"
+#include "xls/passes/dominator_tree.h"
 
 namespace xls {
 
 // A class for dataflow dominator analysis of the IR instructions in a function.
 //
 // This finds all dominators of each node, accounting for potential external
-// sources of data and disregarding literals.
+// sources of data and disregarding literals. The dominators are held as a tree
+// so the analysis takes memory linear in the size of the function, and
+// dominance queries take constant time.
 class DataflowDominatorAnalysis {
  public:
   // Performs dataflow dominator analysis on the function and returns the
   // result.
   static absl::StatusOr<DataflowDominatorAnalysis> Run(FunctionBase* f);
 
-  // Returns the nodes that dominate this node.
-  absl::Span<Node* const> GetDominatorsOfNode(const Node* node) const {
-    return dominated_node_to_dominators_ordered_by_id_.at(node);
+  // Returns the nodes that dominate this node, ordered by id.
+  std::vector<Node*> GetDominatorsOfNode(const Node* node) const {
+    return tree_.DominatorsOf(node);
   }
-  // Returns the nodes that are dominated by this node.
-  absl::Span<Node* const> GetNodesDominatedByNode(const Node* node) const {
-    return dominator_to_dominated_nodes_ordered_by_id_.at(node);
+  // Returns the nodes that are dominated by this node, ordered by id.
+  std::vector<Node*> GetNodesDominatedByNode(const Node* node) const {
+    return tree_.NodesDominatedBy(node);
   }
   // Returns true if 'node' is dominated by 'dominator'.
   bool NodeIsDominatedBy(const Node* node, const Node* dominator) const {
-    return dominated_node_to_dominators_.at(node).contains(dominator);
+    return tree_.Dominates(dominator, node);
   }
   // Returns true if 'node' dominates 'dominated'.
   bool NodeDominates(const Node* node, const Node* dominated) const {
-    return dominator_to_dominated_nodes_.at(node).contains(dominated);
+    return tree_.Dominates(node, dominated);
   }
 
  private:
-  // Maps from a node to all nodes that dominate the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      dominated_node_to_dominators_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      dominated_node_to_dominators_ordered_by_id_;
+  explicit DataflowDominatorAnalysis(DominatorTree tree)
+      : tree_(std::move(tree)) {}
 
-  // Maps from a node to all nodes that are dominated by the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      dominator_to_dominated_nodes_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      dominator_to_dominated_nodes_ordered_by_id_;
+  DominatorTree tree_;
 };
 
 }  // namespace xls
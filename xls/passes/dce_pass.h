@@ -36,6 +36,8 @@ class DeadCodeEliminationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Dead Code Elimination") {}
   ~DeadCodeEliminationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   // Iterate all nodes, mark and eliminate the unvisited nodes.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
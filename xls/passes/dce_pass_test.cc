@@ -14,19 +14,24 @@
 
 #include "xls/passes/dce_pass.h"
 
+#include <memory>
 #include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -166,5 +171,31 @@ TEST_F(DeadCodeEliminationPassTest, GateRemoved) {
   EXPECT_THAT(f->GetNode(kDeadNodeName), Not(IsOk()));
 }
 
+// Removes a balanced tree of dead nodes. DCE time is dominated by unlinking
+// operands from their users and freeing nodes.
+void BM_DceDeadBalancedTree(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto p = std::make_unique<Package>("dead_tree_pkg");
+    FunctionBuilder fb("dead_tree", p.get());
+    CHECK_OK(benchmark_support::GenerateBalancedTree(
+                 fb, /*depth=*/state.range(0), /*fan_out=*/2,
+                 benchmark_support::strategy::BinaryAdd(),
+                 benchmark_support::strategy::DistinctLiteral())
+                 .status());
+    CHECK_OK(fb.BuildWithReturnValue(fb.Literal(UBits(0, 8))).status());
+    PassResults results;
+    state.ResumeTiming();
+    CHECK_OK(DeadCodeEliminationPass()
+                 .Run(p.get(), OptimizationPassOptions(), &results)
+                 .status());
+    state.PauseTiming();
+    p.reset();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(BM_DceDeadBalancedTree)->DenseRange(4, 16, 4);
+
 }  // namespace
 }  // namespace xls
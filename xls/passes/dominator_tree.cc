@@ -0,0 +1,138 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/dominator_tree.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_util.h"
+
+namespace xls {
+
+DominatorTree::DominatorTree(std::vector<Node*> order,
+                             std::vector<int64_t> parents,
+                             const std::vector<bool>& excluded)
+    : nodes_(std::move(order)), parents_(std::move(parents)) {
+  CHECK_EQ(nodes_.size(), parents_.size());
+  CHECK_EQ(nodes_.size(), excluded.size());
+  int64_t node_count = nodes_.size();
+  indices_.reserve(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    indices_[nodes_[i]] = i;
+  }
+
+  // Children lists in compressed form: the children of node i are
+  // children[child_begin[i], child_begin[i + 1]).
+  std::vector<int64_t> child_begin(node_count + 1, 0);
+  for (int64_t i = 0; i < node_count; ++i) {
+    if (parents_[i] != kNoParent) {
+      CHECK_LT(parents_[i], i);
+      CHECK(!excluded[i] && !excluded[parents_[i]]);
+      ++child_begin[parents_[i] + 1];
+    }
+  }
+  for (int64_t i = 0; i < node_count; ++i) {
+    child_begin[i + 1] += child_begin[i];
+  }
+  std::vector<int64_t> children(child_begin.back());
+  std::vector<int64_t> next_child(child_begin.begin(), child_begin.end() - 1);
+  for (int64_t i = 0; i < node_count; ++i) {
+    if (parents_[i] != kNoParent) {
+      children[next_child[parents_[i]]++] = i;
+    }
+  }
+
+  // Number the forest with an iterative preorder walk from each root.
+  preorder_begin_.assign(node_count, -1);
+  preorder_end_.assign(node_count, -1);
+  preorder_.reserve(node_count);
+  std::vector<std::pair<int64_t, int64_t>> stack;
+  for (int64_t root = 0; root < node_count; ++root) {
+    if (parents_[root] != kNoParent || excluded[root]) {
+      continue;
+    }
+    preorder_begin_[root] = preorder_.size();
+    preorder_.push_back(nodes_[root]);
+    stack.push_back({root, child_begin[root]});
+    while (!stack.empty()) {
+      auto& [node, next] = stack.back();
+      if (next == child_begin[node + 1]) {
+        preorder_end_[node] = preorder_.size();
+        stack.pop_back();
+        continue;
+      }
+      int64_t child = children[next++];
+      preorder_begin_[child] = preorder_.size();
+      preorder_.push_back(nodes_[child]);
+      stack.push_back({child, child_begin[child]});
+    }
+  }
+}
+
+/* static */ int64_t DominatorTree::NearestCommonDominator(
+    const std::vector<int64_t>& parents, int64_t a, int64_t b) {
+  // Dominators precede the nodes they dominate, so walking up from whichever
+  // node is later meets the other node's ancestors if there are any in common.
+  while (a != b) {
+    if (a == kNoParent || b == kNoParent) {
+      return kNoParent;
+    }
+    if (a > b) {
+      a = parents[a];
+    } else {
+      b = parents[b];
+    }
+  }
+  return a;
+}
+
+bool DominatorTree::Dominates(const Node* dominator, const Node* node) const {
+  int64_t d = indices_.at(dominator);
+  int64_t n = indices_.at(node);
+  if (preorder_begin_[d] < 0 || preorder_begin_[n] < 0) {
+    return false;
+  }
+  return preorder_begin_[d] <= preorder_begin_[n] &&
+         preorder_begin_[n] < preorder_end_[d];
+}
+
+std::vector<Node*> DominatorTree::DominatorsOf(const Node* node) const {
+  std::vector<Node*> dominators;
+  int64_t n = indices_.at(node);
+  if (preorder_begin_[n] < 0) {
+    return dominators;
+  }
+  for (; n != kNoParent; n = parents_[n]) {
+    dominators.push_back(nodes_[n]);
+  }
+  SortByNodeId(&dominators);
+  return dominators;
+}
+
+std::vector<Node*> DominatorTree::NodesDominatedBy(const Node* node) const {
+  int64_t n = indices_.at(node);
+  if (preorder_begin_[n] < 0) {
+    return {};
+  }
+  std::vector<Node*> dominated(preorder_.begin() + preorder_begin_[n],
+                               preorder_.begin() + preorder_end_[n]);
+  SortByNodeId(&dominated);
+  return dominated;
+}
+
+}  // namespace xls
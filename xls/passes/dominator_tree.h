@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_DOMINATOR_TREE_H_
+#define XLS_PASSES_DOMINATOR_TREE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A forest over the nodes of a function base in which the ancestors of a node
+// are exactly the nodes that dominate it, for whichever notion of dominance
+// the analysis building the tree uses. Storage is linear in the number of
+// nodes, and dominance queries take constant time by comparing the preorder
+// interval of each node.
+class DominatorTree {
+ public:
+  static constexpr int64_t kNoParent = -1;
+
+  // Builds the forest from `order` and the immediate dominators `parents`:
+  // `parents[i]` is the index in `order` of the immediate dominator of
+  // `order[i]`, or kNoParent if nothing else dominates it. Every parent must
+  // precede its children in `order`. Nodes for which `excluded[i]` is true
+  // neither dominate nor are dominated by anything, not even themselves.
+  DominatorTree(std::vector<Node*> order, std::vector<int64_t> parents,
+                const std::vector<bool>& excluded);
+
+  // Returns the nearest common dominator of the nodes at indices `a` and `b`
+  // in `parents`, which must only be filled in for nodes preceding them, or
+  // kNoParent if there is none. Used while computing `parents`.
+  static int64_t NearestCommonDominator(const std::vector<int64_t>& parents,
+                                        int64_t a, int64_t b);
+
+  // Returns true if `dominator` dominates `node`. Each node dominates itself.
+  bool Dominates(const Node* dominator, const Node* node) const;
+
+  // Returns the nodes dominating `node`, ordered by id.
+  std::vector<Node*> DominatorsOf(const Node* node) const;
+
+  // Returns the nodes dominated by `node`, ordered by id.
+  std::vector<Node*> NodesDominatedBy(const Node* node) const;
+
+ private:
+  std::vector<Node*> nodes_;
+  absl::flat_hash_map<const Node*, int64_t> indices_;
+  std::vector<int64_t> parents_;
+  // The position of each node in a preorder walk of the forest and the
+  // position just past its last descendant; -1 for excluded nodes.
+  std::vector<int64_t> preorder_begin_;
+  std::vector<int64_t> preorder_end_;
+  // The nodes in preorder, so the descendants of a node are contiguous.
+  std::vector<Node*> preorder_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_DOMINATOR_TREE_H_
@@ -36,6 +36,8 @@ class IdentityRemovalPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Identity Removal") {}
   ~IdentityRemovalPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   // Iterate all nodes and eliminate identities.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -0,0 +1,158 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/inline_and_fold.h"
+
+#include <deque>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/passes/inlining_pass.h"
+
+namespace xls {
+namespace {
+
+// Records the nodes added to a function base, in the order they were added,
+// while it is alive. Removed nodes are forgotten.
+class AddedNodeRecorder : public ChangeListener {
+ public:
+  explicit AddedNodeRecorder(FunctionBase* f) : f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+  ~AddedNodeRecorder() override { f_->UnregisterChangeListener(this); }
+
+  void NodeAdded(Node* node) override {
+    nodes_.push_back(node);
+    alive_.insert(node);
+  }
+  void NodeDeleted(Node* node) override { alive_.erase(node); }
+
+  // Returns the nodes added so far which have not been removed.
+  std::vector<Node*> AliveNodes() const {
+    std::vector<Node*> result;
+    for (Node* node : nodes_) {
+      if (alive_.contains(node)) {
+        result.push_back(node);
+      }
+    }
+    return result;
+  }
+
+ private:
+  FunctionBase* f_;
+  std::vector<Node*> nodes_;
+  absl::flat_hash_set<Node*> alive_;
+};
+
+bool IsFoldable(Node* node) {
+  return !node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
+         !OpIsSideEffecting(node->op()) &&
+         absl::c_all_of(node->operands(),
+                        [](Node* operand) { return operand->Is<Literal>(); });
+}
+
+bool IsDeletable(Node* node) {
+  return node->users().empty() &&
+         !node->function_base()->HasImplicitUse(node) &&
+         !OpIsSideEffecting(node->op());
+}
+
+}  // namespace
+
+bool CanInlineAndFold(Function* f) {
+  if (f->ForeignFunctionData().has_value()) {
+    return false;
+  }
+  return absl::c_none_of(f->nodes(), [](Node* node) {
+    return node->Is<Cover>() ||
+           (node->Is<Assert>() && node->As<Assert>()->label().has_value());
+  });
+}
+
+absl::StatusOr<Node*> InlineAndFold(Invoke* invoke) {
+  XLS_RET_CHECK(CanInlineAndFold(invoke->to_apply()));
+  FunctionBase* f = invoke->function_base();
+  std::vector<Node*> candidates(invoke->operands().begin(),
+                                invoke->operands().end());
+  Node* result;
+  std::vector<Node*> inlined;
+  {
+    AddedNodeRecorder recorder(f);
+    XLS_ASSIGN_OR_RETURN(result, InliningPass::InlineOneInvokeAndGetResult(
+                                     invoke));
+    inlined = recorder.AliveNodes();
+  }
+
+  // The inlined nodes were added in topological order, so folded values
+  // propagate through the whole body.
+  for (Node* node : inlined) {
+    if (!IsFoldable(node)) {
+      continue;
+    }
+    VLOG(3) << "Folding inlined node: " << *node;
+    std::vector<Value> operand_values;
+    operand_values.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(operand->As<Literal>()->value());
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, InterpretNode(node, operand_values));
+    XLS_ASSIGN_OR_RETURN(Literal * literal,
+                         node->ReplaceUsesWithNew<Literal>(value));
+    if (node == result) {
+      result = literal;
+    }
+  }
+
+  // Remove the nodes left dead, other than the result which the caller has yet
+  // to use.
+  candidates.insert(candidates.end(), inlined.begin(), inlined.end());
+  absl::flat_hash_set<Node*> removed;
+  std::deque<Node*> worklist;
+  auto enqueue_if_dead = [&](Node* node) {
+    if (node != result && !removed.contains(node) && IsDeletable(node)) {
+      removed.insert(node);
+      worklist.push_back(node);
+    }
+  };
+  for (Node* node : candidates) {
+    enqueue_if_dead(node);
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.front();
+    worklist.pop_front();
+    std::vector<Node*> operands(node->operands().begin(),
+                                node->operands().end());
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    for (Node* operand : operands) {
+      enqueue_if_dead(operand);
+    }
+  }
+  return result;
+}
+
+}  // namespace xls
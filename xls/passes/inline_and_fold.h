@@ -0,0 +1,39 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_INLINE_AND_FOLD_H_
+#define XLS_PASSES_INLINE_AND_FOLD_H_
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+
+namespace xls {
+
+// Returns true if invocations of `f` may be expanded with InlineAndFold. This
+// excludes foreign functions and functions containing cover points or labeled
+// asserts, whose labels are only made unique by the inlining pass.
+bool CanInlineAndFold(Function* f);
+
+// Inlines `invoke`, then folds each of the inlined nodes whose operands are
+// all literals and removes the nodes left dead, including any operands of the
+// invoke which were only used by it. Returns the node which replaced the
+// invoke. Used to expand loops and maps one iteration at a time so that the
+// node count stays bounded when most of each iteration folds away.
+absl::StatusOr<Node*> InlineAndFold(Invoke* invoke);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_INLINE_AND_FOLD_H_
@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/inline_and_fold.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+class InlineAndFoldTest : public IrTestBase {};
+
+TEST_F(InlineAndFoldTest, FoldsConstantPartOfBody) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb(TestName() + "_callee", p.get());
+  BValue a = callee_fb.Param("a", p->GetBitsType(8));
+  BValue b = callee_fb.Param("b", p->GetBitsType(8));
+  callee_fb.Add(callee_fb.Not(a), b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_fb.Build());
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue invoke = fb.Invoke({fb.Literal(UBits(0x0f, 8)), x}, callee);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(invoke));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * result,
+                           InlineAndFold(invoke.node()->As<Invoke>()));
+  EXPECT_THAT(result, m::Add(m::Literal(0xf0), m::Param("x")));
+  EXPECT_EQ(f->return_value(), result);
+  // The literal argument and the inlined `not` are removed.
+  EXPECT_EQ(f->node_count(), 3);
+}
+
+TEST_F(InlineAndFoldTest, FullyConstantBodyFoldsToLiteral) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb(TestName() + "_callee", p.get());
+  BValue a = callee_fb.Param("a", p->GetBitsType(8));
+  callee_fb.UMul(a, a);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_fb.Build());
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue invoke = fb.Invoke({fb.Literal(UBits(5, 8))}, callee);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(invoke));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * result,
+                           InlineAndFold(invoke.node()->As<Invoke>()));
+  EXPECT_THAT(result, m::Literal(25));
+  EXPECT_EQ(f->return_value(), result);
+  EXPECT_EQ(f->node_count(), 1);
+}
+
+TEST_F(InlineAndFoldTest, CannotInlineAndFoldCoverPoints) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb(TestName() + "_callee", p.get());
+  BValue a = callee_fb.Param("a", p->GetBitsType(1));
+  callee_fb.Cover(a, "a_covered");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee,
+                           callee_fb.BuildWithReturnValue(a));
+  EXPECT_FALSE(CanInlineAndFold(callee));
+}
+
+}  // namespace
+}  // namespace xls
@@ -96,9 +96,9 @@ static bool IsInlineable(const Invoke* invoke) {
 }
 
 // Inlines the node "invoke" by replacing it with the contents of the called
-// function.
+// function. Returns the node which replaced the invoke.
 template <bool kCheckNoSubInvokes = true>
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
+absl::StatusOr<Node*> InlineInvoke(Invoke* invoke, int inline_count) {
   Function* invoked = invoke->to_apply();
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
@@ -195,14 +195,26 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
     }
   }
 
-  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(
-      invoked_node_to_replacement.at(invoked->return_value())));
-  return invoke->function_base()->RemoveNode(invoke);
+  Node* result = invoked_node_to_replacement.at(invoked->return_value());
+  // A node created by inlining which replaces the invoke also stands for the
+  // call site. Pass-through parameters resolve to nodes of the caller which
+  // are left as they are.
+  if (!invoked->return_value()->Is<Param>()) {
+    result->MergeLoc(invoke);
+  }
+  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(result));
+  XLS_RETURN_IF_ERROR(invoke->function_base()->RemoveNode(invoke));
+  return result;
 }
 
 }  // namespace
 
 absl::Status InliningPass::InlineOneInvoke(Invoke* invoke) {
+  return InlineOneInvokeAndGetResult(invoke).status();
+}
+
+absl::StatusOr<Node*> InliningPass::InlineOneInvokeAndGetResult(
+    Invoke* invoke) {
   return InlineInvoke</*kCheckNoSubInvokes=*/false>(invoke, /*inline_count=*/0);
 }
 
@@ -221,7 +233,8 @@ absl::StatusOr<bool> InliningPass::RunInternal(
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
       if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+        XLS_RETURN_IF_ERROR(
+            InlineInvoke(node->As<Invoke>(), inline_count++).status());
         changed = true;
       }
     }
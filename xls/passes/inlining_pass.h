@@ -19,6 +19,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
@@ -37,6 +38,9 @@ class InliningPass : public OptimizationPass {
   // have invokes in the function code.
   static absl::Status InlineOneInvoke(Invoke* invoke);
 
+  // As InlineOneInvoke, but returns the node which replaced the invoke.
+  static absl::StatusOr<Node*> InlineOneInvokeAndGetResult(Invoke* invoke);
+
  protected:
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
@@ -74,6 +74,28 @@ fn caller() -> bits[32] {
   EXPECT_THAT(f->return_value(), m::Add(m::Literal(2), m::Literal(2)));
 }
 
+TEST_F(InliningPassTest, ReturnValueKeepsCallSiteLocation) {
+  const std::string program = R"(
+package some_package
+
+file_number 1 "a.x"
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y, pos=[(1,2,3)])
+}
+
+fn caller() -> bits[32] {
+  literal.2: bits[32] = literal(value=2)
+  ret invoke.3: bits[32] = invoke(literal.2, literal.2, to_apply=callee, pos=[(1,7,8)])
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Inline(package.get()), IsOkAndHolds(true));
+  Function* f = FindFunction("caller", package.get());
+  EXPECT_THAT(f->return_value(), m::Add(m::Literal(2), m::Literal(2)));
+  EXPECT_EQ(f->return_value()->loc().ToString(), "[(1,2,3), (1,7,8)]");
+}
+
 TEST_F(InliningPassTest, FfiFunctionsNotInlined) {
   const std::string program = R"(
 package some_package
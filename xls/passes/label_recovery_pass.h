@@ -35,6 +35,8 @@ class LabelRecoveryPass : public OptimizationFunctionBasePass {
   LabelRecoveryPass() : OptimizationFunctionBasePass(kName, "LabelRecovery") {}
   ~LabelRecoveryPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -34,6 +34,8 @@ class LiteralUncommoningPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Literal uncommoning") {}
   ~LiteralUncommoningPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -14,18 +14,24 @@
 
 #include "xls/passes/lut_conversion_pass.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -41,20 +47,27 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/passes/dataflow_dominator_analysis.h"
+#include "xls/passes/bit_provenance_analysis.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
-#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
 namespace xls {
 
 namespace {
 
-bool IsTriviallyDerived(Node* node, Node* ancestor) {
+// Bounds on the cuts considered for a selector; see `CutEnumerator`.
+//
+// The most leaves a cut may have.
+constexpr int64_t kMaxCutLeaves = 4;
+// The most cuts retained per node.
+constexpr int64_t kCutsPerNode = 8;
+
+bool IsTriviallyDerived(Node* node, const absl::flat_hash_set<Node*>& leaves) {
   static constexpr auto is_trivial_array_index = [](Node* node) {
     if (!node->Is<ArrayIndex>()) {
       return false;
@@ -62,109 +75,307 @@ bool IsTriviallyDerived(Node* node, Node* ancestor) {
     return absl::c_all_of(node->As<ArrayIndex>()->indices(),
                           [](Node* index) { return index->Is<Literal>(); });
   };
-  while (node != ancestor && (node->OpIn({Op::kTupleIndex, Op::kBitSlice}) ||
-                              is_trivial_array_index(node))) {
+  while (!leaves.contains(node) &&
+         (node->OpIn({Op::kTupleIndex, Op::kBitSlice}) ||
+          is_trivial_array_index(node))) {
     node = node->operand(0);
   }
   if (node->Is<Literal>()) {
     return true;
   }
-  if (node != ancestor && node->Is<Concat>()) {
+  if (!leaves.contains(node) && node->Is<Concat>()) {
     return absl::c_all_of(node->operands(), [&](Node* operand) {
-      return IsTriviallyDerived(operand, ancestor);
+      return IsTriviallyDerived(operand, leaves);
+    });
+  }
+  return leaves.contains(node);
+}
+
+// Returns true if, according to `provenance`, every bit of `node` is a
+// literal bit or is copied from the leaves or from where the leaves' own bits
+// come from; i.e., if `node` merely rearranges the bits of the leaves.
+bool IsProvenanceDerived(Node* node, const absl::flat_hash_set<Node*>& leaves,
+                         const BitProvenanceAnalysis& provenance) {
+  if (!provenance.IsTracked(node)) {
+    return false;
+  }
+  absl::flat_hash_set<Node*> sources = leaves;
+  for (Node* leaf : leaves) {
+    if (!provenance.IsTracked(leaf)) {
+      continue;
+    }
+    for (const TreeBitSources& leaf_sources :
+         provenance.GetBitSources(leaf).elements()) {
+      for (const TreeBitSources::BitRange& range : leaf_sources.ranges()) {
+        sources.insert(range.source_node());
+      }
+    }
+  }
+  return absl::c_all_of(
+      provenance.GetBitSources(node).elements(),
+      [&](const TreeBitSources& node_sources) {
+        return absl::c_all_of(
+            node_sources.ranges(), [&](const TreeBitSources::BitRange& range) {
+              return range.source_node()->Is<Literal>() ||
+                     sources.contains(range.source_node());
+            });
+      });
+}
+
+// A set of nodes (the leaves) which, together with the values the query
+// engine knows, determines the value of the node it's a cut of.
+struct Cut {
+  // Sorted in topological order.
+  std::vector<Node*> leaves;
+  // The total number of bits of the leaves that are not known.
+  int64_t unknown_bits = 0;
+  // The topological index of the last leaf, or -1 if there are none; smaller
+  // values are further from the node the cut is for.
+  int64_t max_topo_index = -1;
+};
+
+// Enumerates cuts of nodes' fan-in cones with priority-cut pruning: the cuts
+// of a node are built by merging the cuts of its operands, and only cuts of at
+// most `max_cut_bits` unknown bits and `kMaxCutLeaves` leaves are kept, up to
+// `kCutsPerNode` of them per node. This bounds the work per node no matter how
+// large the cones are. Cuts are preferred the further they are from the node,
+// then the fewer unknown bits they have.
+class CutEnumerator {
+ public:
+  CutEnumerator(const QueryEngine& query_engine,
+                const absl::flat_hash_map<Node*, int64_t>& topo_index,
+                int64_t max_cut_bits)
+      : query_engine_(query_engine),
+        topo_index_(topo_index),
+        max_cut_bits_(max_cut_bits) {}
+
+  // Returns the cuts of `node`; the trivial cut {node} is included if it's
+  // within bounds.
+  absl::Span<const Cut> GetCuts(Node* node) {
+    // Computed iteratively, since fan-in cones can be very deep.
+    std::vector<std::pair<Node*, bool>> stack = {{node, false}};
+    while (!stack.empty()) {
+      auto [n, operands_done] = stack.back();
+      stack.pop_back();
+      if (cuts_.contains(n)) {
+        continue;
+      }
+      if (!operands_done && IsMergeable(n)) {
+        stack.push_back({n, true});
+        for (Node* operand : n->operands()) {
+          if (!cuts_.contains(operand)) {
+            stack.push_back({operand, false});
+          }
+        }
+        continue;
+      }
+      cuts_.emplace(n, ComputeCuts(n));
+    }
+    return cuts_.at(node);
+  }
+
+  int64_t UnknownBits(Node* node) {
+    auto [it, inserted] = unknown_bits_.try_emplace(node, 0);
+    if (inserted) {
+      std::optional<LeafTypeTree<TernaryVector>> ternary =
+          query_engine_.GetTernary(node);
+      it->second =
+          ternary.has_value()
+              ? absl::c_accumulate(
+                    ternary->elements(), int64_t{0},
+                    [](int64_t sum, const TernaryVector& t) {
+                      return sum + absl::c_count_if(t, [](TernaryValue v) {
+                               return ternary_ops::IsUnknown(v);
+                             });
+                    })
+              : node->GetType()->GetFlatBitCount();
+    }
+    return it->second;
+  }
+
+ private:
+  // Whether the cuts of `node` can be derived from those of its operands;
+  // otherwise `node` can only be a leaf.
+  bool IsMergeable(Node* node) const {
+    return node->operand_count() > 0 && !OpIsSideEffecting(node->op()) &&
+           !query_engine_.KnownValue(node).has_value();
+  }
+
+  bool IsBetter(const Cut& a, const Cut& b) const {
+    return std::tie(a.max_topo_index, a.unknown_bits) <
+           std::tie(b.max_topo_index, b.unknown_bits);
+  }
+
+  Cut Union(const Cut& a, const Cut& b) {
+    Cut result;
+    auto by_topo = [&](Node* x, Node* y) {
+      return topo_index_.at(x) < topo_index_.at(y);
+    };
+    std::set_union(a.leaves.begin(), a.leaves.end(), b.leaves.begin(),
+                   b.leaves.end(), std::back_inserter(result.leaves), by_topo);
+    for (Node* leaf : result.leaves) {
+      result.unknown_bits += UnknownBits(leaf);
+    }
+    result.max_topo_index = std::max(a.max_topo_index, b.max_topo_index);
+    return result;
+  }
+
+  // Keeps the best `kCutsPerNode` distinct cuts.
+  void Prune(std::vector<Cut>& cuts) const {
+    absl::c_stable_sort(cuts, [&](const Cut& a, const Cut& b) {
+      return IsBetter(a, b);
     });
+    std::vector<Cut> pruned;
+    absl::flat_hash_set<std::vector<Node*>> seen;
+    for (Cut& cut : cuts) {
+      if (pruned.size() >= kCutsPerNode) {
+        break;
+      }
+      if (seen.insert(cut.leaves).second) {
+        pruned.push_back(std::move(cut));
+      }
+    }
+    cuts = std::move(pruned);
+  }
+
+  std::vector<Cut> ComputeCuts(Node* node) {
+    if (query_engine_.KnownValue(node).has_value()) {
+      // Fully-known nodes are determined by the empty cut.
+      return {Cut{}};
+    }
+    std::vector<Cut> cuts;
+    if (IsMergeable(node)) {
+      cuts.push_back(Cut{});
+      absl::flat_hash_set<Node*> merged_operands;
+      for (Node* operand : node->operands()) {
+        if (!merged_operands.insert(operand).second) {
+          continue;
+        }
+        std::vector<Cut> next;
+        for (const Cut& cut : cuts) {
+          for (const Cut& operand_cut : cuts_.at(operand)) {
+            Cut merged = Union(cut, operand_cut);
+            if (merged.leaves.size() <= kMaxCutLeaves &&
+                merged.unknown_bits <= max_cut_bits_) {
+              next.push_back(std::move(merged));
+            }
+          }
+        }
+        Prune(next);
+        cuts = std::move(next);
+        if (cuts.empty()) {
+          break;
+        }
+      }
+    }
+    if (UnknownBits(node) <= max_cut_bits_) {
+      // Always keep the trivial cut, so users can merge through this node.
+      if (cuts.size() >= kCutsPerNode) {
+        cuts.pop_back();
+      }
+      cuts.push_back(Cut{.leaves = {node},
+                         .unknown_bits = UnknownBits(node),
+                         .max_topo_index = topo_index_.at(node)});
+    }
+    return cuts;
   }
-  return node == ancestor;
+
+  const QueryEngine& query_engine_;
+  const absl::flat_hash_map<Node*, int64_t>& topo_index_;
+  const int64_t max_cut_bits_;
+  absl::flat_hash_map<Node*, std::vector<Cut>> cuts_;
+  absl::flat_hash_map<Node*, int64_t> unknown_bits_;
+};
+
+int64_t SelectorBitsNeeded(Select* select) {
+  return Bits::MinBitCountUnsigned(select->default_value().has_value()
+                                       ? select->cases().size()
+                                       : select->cases().size() - 1);
 }
 
 absl::StatusOr<bool> MaybeMergeLutIntoSelect(
     Select* select, const QueryEngine& query_engine, int64_t opt_level,
-    const DataflowDominatorAnalysis& dataflow_dominator_analysis) {
+    CutEnumerator& cut_enumerator, const BitProvenanceAnalysis& provenance) {
   Node* selector = select->selector();
-  int64_t num_cases = select->cases().size();
-  if (select->default_value().has_value()) {
-    ++num_cases;
-  }
-
-  absl::Span<Node* const> dominators =
-      dataflow_dominator_analysis.GetDominatorsOfNode(selector);
 
-  // We favor the dominator with the fewest unknown bits, since this minimizes
-  // the risk that we need too many additional pipeline flops on the path to
-  // the resulting LUT; we break ties by preferring the most distant
-  // dominator, which should usually reduce both area & delay as much as
-  // possible.
+  // We favor the most distant cut of the selector which doesn't have more
+  // unknown bits than the original selector needs, since this should usually
+  // reduce both area & delay as much as possible, and will not result in a
+  // wider selector than the original; we break ties by preferring the cut
+  // with the fewest unknown bits, since this minimizes the risk that we need
+  // too many additional pipeline flops on the path to the resulting LUT.
   //
-  // NOTE: The dominators are topologically sorted, so we iterate from most to
-  // least distant.
+  // If the selector is "trivially" derived from the cut (via tuple index, bit
+  // slice, array index with literal indices, concat, or anything else bit
+  // provenance sees as just moving bits around), we only consider it if the
+  // selector will be *strictly* narrower.
   VLOG(4) << "Looking for earlier selector: " << selector->ToString();
-  int64_t original_bits_needed = Bits::MinBitCountUnsigned(
-      select->default_value().has_value() ? select->cases().size()
-                                          : select->cases().size() - 1);
-  Node* best_dominator = nullptr;
-  std::optional<LeafTypeTree<TernaryVector>> best_dominator_ternary;
-  for (Node* dominator : dominators) {
-    std::optional<LeafTypeTree<TernaryVector>> dominator_ternary =
-        query_engine.GetTernary(dominator);
-    int64_t unknown_bits =
-        dominator_ternary.has_value()
-            ? absl::c_accumulate(
-                  dominator_ternary->elements(), 0,
-                  [](int64_t sum, const TernaryVector& ternary) {
-                    return sum + absl::c_count_if(ternary, [](TernaryValue v) {
-                             return ternary_ops::IsUnknown(v);
-                           });
-                  })
-            : dominator->GetType()->GetFlatBitCount();
-
-    // For now, only consider dominators that will not result in a wider
-    // selector than the original. If the selector is "trivially" derived from
-    // the dominator (via tuple index, bit slice, array index with literal
-    // indices, and concat), we only consider it if the selector will be
-    // *strictly* narrower.
-    if (unknown_bits <= original_bits_needed &&
-        (!IsTriviallyDerived(selector, dominator) ||
-         unknown_bits < original_bits_needed)) {
-      best_dominator = dominator;
-      if (dominator_ternary.has_value()) {
-        best_dominator_ternary = std::move(dominator_ternary);
-      }
-      VLOG(3) << "Found earlier selector with " << unknown_bits
-              << " unknown bits (original: " << selector->BitCountOrDie()
-              << " bits, " << original_bits_needed
-              << " needed): " << dominator->ToString();
-      break;
+  int64_t original_bits_needed = SelectorBitsNeeded(select);
+  const Cut* best_cut = nullptr;
+  for (const Cut& cut : cut_enumerator.GetCuts(selector)) {
+    if (cut.unknown_bits > original_bits_needed) {
+      continue;
+    }
+    absl::flat_hash_set<Node*> leaves(cut.leaves.begin(), cut.leaves.end());
+    if (cut.unknown_bits == original_bits_needed &&
+        (IsTriviallyDerived(selector, leaves) ||
+         IsProvenanceDerived(selector, leaves, provenance))) {
+      continue;
+    }
+    if (best_cut == nullptr ||
+        std::tie(cut.max_topo_index, cut.unknown_bits) <
+            std::tie(best_cut->max_topo_index, best_cut->unknown_bits)) {
+      best_cut = &cut;
     }
   }
-  if (best_dominator == nullptr || best_dominator == selector) {
+  if (best_cut == nullptr ||
+      (best_cut->leaves.size() == 1 && best_cut->leaves.front() == selector)) {
     // There's no better alternative; this selector is already optimal.
     return false;
   }
+  VLOG(3) << "Found earlier selector with " << best_cut->unknown_bits
+          << " unknown bits (original: " << selector->BitCountOrDie()
+          << " bits, " << original_bits_needed << " needed): "
+          << absl::StrJoin(best_cut->leaves, ", ",
+                           [](std::string* out, Node* leaf) {
+                             absl::StrAppend(out, leaf->GetName());
+                           });
   VLOG(2) << "Merging a lookup table into a select: " << select->ToString();
+  absl::Span<Node* const> leaves = best_cut->leaves;
 
-  if (!best_dominator_ternary.has_value()) {
-    best_dominator_ternary = *LeafTypeTree<TernaryVector>::CreateFromFunction(
-        best_dominator->GetType(),
-        [](Type* leaf_type,
-           absl::Span<const int64_t>) -> absl::StatusOr<TernaryVector> {
-          return TernaryVector(leaf_type->GetFlatBitCount(),
-                               TernaryValue::kUnknown);
-        });
+  std::vector<LeafTypeTree<TernaryVector>> leaf_ternaries;
+  std::vector<std::vector<Value>> leaf_values;
+  leaf_ternaries.reserve(leaves.size());
+  leaf_values.reserve(leaves.size());
+  for (Node* leaf : leaves) {
+    std::optional<LeafTypeTree<TernaryVector>> ternary =
+        query_engine.GetTernary(leaf);
+    if (!ternary.has_value()) {
+      ternary = *LeafTypeTree<TernaryVector>::CreateFromFunction(
+          leaf->GetType(),
+          [](Type* leaf_type,
+             absl::Span<const int64_t>) -> absl::StatusOr<TernaryVector> {
+            return TernaryVector(leaf_type->GetFlatBitCount(),
+                                 TernaryValue::kUnknown);
+          });
+    }
+    XLS_ASSIGN_OR_RETURN(leaf_values.emplace_back(),
+                         ternary_ops::AllValues(ternary->AsView()));
+    XLS_RET_CHECK(!leaf_values.back().empty());
+    leaf_ternaries.push_back(*std::move(ternary));
   }
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<Value> dominator_values,
-      ternary_ops::AllValues(best_dominator_ternary->AsView()));
-  XLS_RET_CHECK(!dominator_values.empty());
 
   // Populate an interpreter with all known values that feed into the
-  // selector.
+  // selector, stopping at the leaves of the cut.
+  absl::flat_hash_set<Node*> leaf_set(leaves.begin(), leaves.end());
   IrInterpreter base_interpreter;
   std::vector<Node*> to_visit({selector});
   absl::flat_hash_set<Node*> visited;
   while (!to_visit.empty()) {
     Node* n = to_visit.back();
     to_visit.pop_back();
-    if (visited.contains(n) || base_interpreter.IsVisited(n)) {
+    if (leaf_set.contains(n) || visited.contains(n) ||
+        base_interpreter.IsVisited(n)) {
       continue;
     }
     if (std::optional<Value> known_value = query_engine.KnownValue(n);
@@ -177,20 +388,27 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelect(
     }
   }
 
+  // Enumerate every combination of leaf values, with the last leaf varying
+  // fastest; this matches the order of the values of the new selector below,
+  // which concatenates the unknown bits of the leaves with the first leaf
+  // most significant.
+  int64_t combinations = 1;
+  for (const std::vector<Value>& values : leaf_values) {
+    combinations *= values.size();
+  }
   std::vector<Node*> new_cases;
-  new_cases.reserve(dominator_values.size());
-  for (const Value& dominator_value : dominator_values) {
-    // Invoke an interpreter using known values & this `dominator_value` to
-    // compute the value of the selector.
+  new_cases.reserve(combinations);
+  for (int64_t combination = 0; combination < combinations; ++combination) {
+    // Invoke an interpreter using known values & this assignment of leaf
+    // values to compute the value of the selector.
     IrInterpreter interpreter = base_interpreter;
-    if (interpreter.IsVisited(best_dominator)) {
-      // It seems the dominator is actually fully-known!
-      XLS_RET_CHECK_EQ(interpreter.ResolveAsValue(best_dominator),
-                       dominator_value);
-    } else {
-      XLS_RETURN_IF_ERROR(
-          interpreter.SetValueResult(best_dominator, dominator_value));
-      interpreter.MarkVisited(best_dominator);
+    int64_t remaining = combination;
+    for (int64_t i = leaves.size() - 1; i >= 0; --i) {
+      const Value& leaf_value =
+          leaf_values[i][remaining % leaf_values[i].size()];
+      remaining /= leaf_values[i].size();
+      XLS_RETURN_IF_ERROR(interpreter.SetValueResult(leaves[i], leaf_value));
+      interpreter.MarkVisited(leaves[i]);
     }
     XLS_RETURN_IF_ERROR(selector->Accept(&interpreter));
 
@@ -210,16 +428,26 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelect(
     return true;
   }
 
-  // Assemble the new selector out of the unknown bits of the dominator.
-  LeafTypeTree<Bits> unknown_positions_ltt =
-      leaf_type_tree::Map<Bits, TernaryVector>(
-          best_dominator_ternary->AsView(),
-          [&](const TernaryVector& ternary) -> Bits {
-            return bits_ops::Not(ternary_ops::ToKnownBits(ternary));
-          });
-  XLS_ASSIGN_OR_RETURN(
-      Node * new_selector,
-      GatherBits(best_dominator, unknown_positions_ltt.AsView()));
+  // Assemble the new selector out of the unknown bits of the leaves.
+  std::vector<Node*> selector_pieces;
+  selector_pieces.reserve(leaves.size());
+  for (int64_t i = 0; i < leaves.size(); ++i) {
+    LeafTypeTree<Bits> unknown_positions_ltt =
+        leaf_type_tree::Map<Bits, TernaryVector>(
+            leaf_ternaries[i].AsView(),
+            [&](const TernaryVector& ternary) -> Bits {
+              return bits_ops::Not(ternary_ops::ToKnownBits(ternary));
+            });
+    XLS_ASSIGN_OR_RETURN(
+        selector_pieces.emplace_back(),
+        GatherBits(leaves[i], unknown_positions_ltt.AsView()));
+  }
+  Node* new_selector = selector_pieces.front();
+  if (selector_pieces.size() > 1) {
+    XLS_ASSIGN_OR_RETURN(new_selector,
+                         select->function_base()->MakeNode<Concat>(
+                             select->loc(), selector_pieces));
+  }
 
   XLS_RETURN_IF_ERROR(
       select
@@ -229,14 +457,15 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelect(
   return true;
 }
 
-absl::StatusOr<bool> SimplifyNode(
-    Node* node, const QueryEngine& query_engine, int64_t opt_level,
-    const DataflowDominatorAnalysis& dataflow_dominator_analysis) {
+absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
+                                  int64_t opt_level,
+                                  CutEnumerator& cut_enumerator,
+                                  const BitProvenanceAnalysis& provenance) {
   if (node->Is<Select>()) {
     XLS_ASSIGN_OR_RETURN(
         bool changed_select_incorporating_lut,
         MaybeMergeLutIntoSelect(node->As<Select>(), query_engine, opt_level,
-                                dataflow_dominator_analysis));
+                                cut_enumerator, provenance));
     if (changed_select_incorporating_lut) {
       return true;
     }
@@ -256,13 +485,26 @@ absl::StatusOr<bool> LutConversionPass::RunOnFunctionBaseInternal(
 
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  query_engines.push_back(MakeTernaryQueryEngine(func, options));
 
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
 
-  XLS_ASSIGN_OR_RETURN(DataflowDominatorAnalysis dataflow_dominator_analysis,
-                       DataflowDominatorAnalysis::Run(func));
+  XLS_ASSIGN_OR_RETURN(BitProvenanceAnalysis provenance,
+                       BitProvenanceAnalysis::Create(func));
+
+  // Cuts never need more unknown bits than the widest selector needs.
+  std::vector<Node*> topo_sort = TopoSort(func);
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  int64_t max_cut_bits = 0;
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    topo_index[topo_sort[i]] = i;
+    if (topo_sort[i]->Is<Select>()) {
+      max_cut_bits = std::max(max_cut_bits,
+                              SelectorBitsNeeded(topo_sort[i]->As<Select>()));
+    }
+  }
+  CutEnumerator cut_enumerator(query_engine, topo_index, max_cut_bits);
 
   bool changed = false;
   // By running in reverse topological order, the analyses will stay valid for
@@ -273,7 +515,7 @@ absl::StatusOr<bool> LutConversionPass::RunOnFunctionBaseInternal(
     }
     XLS_ASSIGN_OR_RETURN(bool node_changed,
                          SimplifyNode(node, query_engine, opt_level_,
-                                      dataflow_dominator_analysis));
+                                      cut_enumerator, provenance));
     changed = changed || node_changed;
   }
   return changed;
@@ -155,5 +155,31 @@ TEST_F(LutConversionPassTest, IneligibleDominator) {
                                         m::Literal(1), m::Literal(2)}));
 }
 
+TEST_F(LutConversionPassTest, MultipleLeafSelector) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn simple_select(x: bits[2], y: bits[1]) -> bits[3] {
+        literal.0: bits[3] = literal(value=0)
+        literal.1: bits[3] = literal(value=1)
+        literal.2: bits[3] = literal(value=2)
+        literal.3: bits[3] = literal(value=3)
+        literal.4: bits[3] = literal(value=4)
+        wide_x: bits[3] = zero_ext(x, new_bit_count=3)
+        wide_y: bits[3] = zero_ext(y, new_bit_count=3)
+        selector: bits[3] = add(wide_x, wide_y)
+        ret result: bits[3] = sel(selector, cases=[literal.0, literal.1, literal.2, literal.3], default=literal.4)
+     }
+  )",
+                                                       p.get()));
+
+  solvers::z3::ScopedVerifyEquivalence stays_equivalent(f);
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::Select(m::Concat(m::Param("x"), m::Param("y")),
+                {m::Literal(0), m::Literal(1), m::Literal(1), m::Literal(2),
+                 m::Literal(2), m::Literal(3), m::Literal(3), m::Literal(4)}));
+}
+
 }  // namespace
 }  // namespace xls
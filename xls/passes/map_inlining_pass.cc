@@ -24,6 +24,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
+#include "xls/passes/inline_and_fold.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -47,7 +48,13 @@ absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
   }
 
   for (Node* node : map_nodes) {
-    XLS_RETURN_IF_ERROR(ReplaceMap(node->As<Map>()));
+    Map* map = node->As<Map>();
+    bool streaming =
+        options.streaming_unroll_threshold.has_value() &&
+        map->operand(0)->GetType()->AsArrayOrDie()->size() >=
+            *options.streaming_unroll_threshold &&
+        CanInlineAndFold(map->to_apply());
+    XLS_RETURN_IF_ERROR(ReplaceMap(map, streaming));
   }
 
   return changed;
@@ -55,10 +62,10 @@ absl::StatusOr<bool> MapInliningPass::RunOnFunctionBaseInternal(
 
 absl::Status MapInliningPass::InlineOneMap(Map* map) {
   MapInliningPass pass;
-  return pass.ReplaceMap(map);
+  return pass.ReplaceMap(map, /*streaming=*/false);
 }
 
-absl::Status MapInliningPass::ReplaceMap(Map* map) const {
+absl::Status MapInliningPass::ReplaceMap(Map* map, bool streaming) const {
   FunctionBase* function = map->function_base();
 
   int map_inputs_size = map->operand(0)->GetType()->AsArrayOrDie()->size();
@@ -73,9 +80,13 @@ absl::Status MapInliningPass::ReplaceMap(Map* map) const {
                                                  map->loc(), map->operand(0),
                                                  std::vector<Node*>({index})));
     XLS_ASSIGN_OR_RETURN(
-        Node * node,
+        Invoke * invoke,
         function->MakeNode<Invoke>(map->loc(), absl::MakeSpan(&array_index, 1),
                                    map->to_apply()));
+    Node* node = invoke;
+    if (streaming) {
+      XLS_ASSIGN_OR_RETURN(node, InlineAndFold(invoke));
+    }
     invocations.push_back(node);
   }
 
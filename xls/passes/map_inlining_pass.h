@@ -42,8 +42,10 @@ class MapInliningPass : public OptimizationFunctionBasePass {
       FunctionBase* function, const OptimizationPassOptions& options,
       PassResults* results) const override;
 
-  // Replaces a single Map node with a CountedFor operation.
-  absl::Status ReplaceMap(Map* map) const;
+  // Replaces a single Map node with an array of invocations of the mapped
+  // function. If `streaming` each invocation is inlined and folded before the
+  // next is created.
+  absl::Status ReplaceMap(Map* map, bool streaming) const;
 };
 
 }  // namespace xls
@@ -14,9 +14,13 @@
 
 #include "xls/passes/map_inlining_pass.h"
 
+#include <cstdint>
+#include <string>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
@@ -100,6 +104,38 @@ fn main(a: bits[32][4]) -> bits[16][4] {
           m::Invoke(m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(3)}))));
 }
 
+TEST_F(MapInliningPassTest, StreamingInlinesEachElement) {
+  const char kPackage[] = R"(
+package p
+
+fn map_fn(x: bits[32]) -> bits[16] {
+  ret bit_slice.1: bits[16] = bit_slice(x, start=0, width=16)
+}
+
+fn main(a: bits[32][4]) -> bits[16][4] {
+  ret result: bits[16][4] = map(a, to_apply=map_fn)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(auto func, package->GetFunction("main"));
+  MapInliningPass pass;
+  OptimizationPassOptions options;
+  options.streaming_unroll_threshold = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(bool changed,
+                           pass.RunOnFunctionBase(func, options, nullptr));
+  ASSERT_TRUE(changed);
+
+  EXPECT_THAT(
+      func->return_value(),
+      m::Array(
+          m::BitSlice(m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(0)})),
+          m::BitSlice(m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(1)})),
+          m::BitSlice(m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(2)})),
+          m::BitSlice(
+              m::ArrayIndex(m::Param(), /*indices=*/{m::Literal(3)}))));
+}
+
 TEST_F(MapInliningPassTest, InlineOneMap) {
   auto p = CreatePackage();
   FunctionBuilder fb_target(TestName() + "_Target", p.get());
@@ -123,5 +159,53 @@ TEST_F(MapInliningPassTest, InlineOneMap) {
                map_two.node()));
 }
 
+TEST_F(MapInliningPassTest, RunsSeriallyWithFunctionPassThreads) {
+  // Every caller streams the body of `callee` into itself while the pass also
+  // inlines the map in `callee`, so the callers must not run concurrently with
+  // it.
+  std::string ir_text = R"(
+package p
+
+fn slice_fn(x: bits[8]) -> bits[4] {
+  ret bit_slice.1: bits[4] = bit_slice(x, start=0, width=4)
+}
+
+fn callee(x: bits[8][2]) -> bits[4][2] {
+  ret map.2: bits[4][2] = map(x, to_apply=slice_fn)
+}
+)";
+  for (int64_t i = 0; i < 8; ++i) {
+    absl::StrAppendFormat(&ir_text, R"(
+fn caller%d(a: bits[8][2][4]) -> bits[4][2][4] {
+  ret result: bits[4][2][4] = map(a, to_apply=callee)
+}
+)",
+                          i);
+  }
+
+  MapInliningPass pass;
+  EXPECT_FALSE(pass.IsSafeToRunConcurrently());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto serial, Parser::ParsePackage(ir_text));
+  OptimizationPassOptions serial_options;
+  serial_options.streaming_unroll_threshold = 4;
+  PassResults serial_results;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool serial_changed,
+      pass.Run(serial.get(), serial_options, &serial_results));
+  EXPECT_TRUE(serial_changed);
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto parallel, Parser::ParsePackage(ir_text));
+  OptimizationPassOptions parallel_options = serial_options;
+  parallel_options.function_pass_threads = 4;
+  PassResults parallel_results;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool parallel_changed,
+      pass.Run(parallel.get(), parallel_options, &parallel_results));
+  EXPECT_TRUE(parallel_changed);
+
+  EXPECT_EQ(parallel->DumpIr(), serial->DumpIr());
+}
+
 }  // namespace
 }  // namespace xls
@@ -35,6 +35,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
 #include "xls/common/module_initializer.h"
@@ -59,12 +60,14 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/passes/context_sensitive_range_query_engine.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/predicate_dominator_analysis.h"
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -76,6 +79,10 @@ namespace {
 
 using AnalysisType = NarrowingPass::AnalysisType;
 
+// Once this fraction of the optimization budget is used, context-sensitive
+// narrowing falls back to plain range analysis.
+constexpr double kContextAnalysisBudgetFraction = 0.5;
+
 class SpecializedQueryEngines {
  public:
   SpecializedQueryEngines(AnalysisType type, PredicateDominatorAnalysis& pda,
@@ -1757,17 +1764,28 @@ static void RangeAnalysisLog(FunctionBase* f,
   }
 }
 
+// The ternary engine is shared through the query engine cache of `options`, if
+// any, so repeated runs of narrowing only update it for intervening changes.
 static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, AnalysisType analysis) {
+    FunctionBase* f, AnalysisType analysis,
+    const OptimizationPassOptions& options) {
   std::unique_ptr<QueryEngine> query_engine;
+  ContextSensitiveRangeQueryEngine* context_engine = nullptr;
   if (analysis == AnalysisType::kRangeWithContext) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
+    // Specializations may use no more than what is left of the budget.
+    std::optional<absl::Duration> time_budget =
+        options.context_specialization_time_budget;
+    if (options.budget != nullptr) {
+      time_budget = std::min(time_budget.value_or(absl::InfiniteDuration()),
+                             options.budget->Remaining());
+    }
+    auto ternary_query_engine = MakeTernaryQueryEngine(f, options);
     auto range_query_engine =
-        std::make_unique<ContextSensitiveRangeQueryEngine>();
-
-    if (VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
-    }
+        std::make_unique<ContextSensitiveRangeQueryEngine>(
+            ContextSensitiveRangeQueryEngine::Limits{
+                .max_specializations = options.max_context_specializations,
+                .time_budget = time_budget});
+    context_engine = range_query_engine.get();
 
     std::vector<std::unique_ptr<QueryEngine>> engines;
     engines.push_back(std::make_unique<StatelessQueryEngine>());
@@ -1775,39 +1793,54 @@ static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
     engines.push_back(std::move(range_query_engine));
     query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   } else if (analysis == AnalysisType::kRange) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
-    auto range_query_engine = std::make_unique<RangeQueryEngine>();
-
-    if (VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
-    }
-
     std::vector<std::unique_ptr<QueryEngine>> engines;
     engines.push_back(std::make_unique<StatelessQueryEngine>());
-    engines.push_back(std::move(ternary_query_engine));
-    engines.push_back(std::move(range_query_engine));
+    engines.push_back(MakeTernaryQueryEngine(f, options));
+    engines.push_back(std::make_unique<RangeQueryEngine>());
     query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   } else {
     std::vector<std::unique_ptr<QueryEngine>> engines;
     engines.push_back(std::make_unique<StatelessQueryEngine>());
-    engines.push_back(std::make_unique<TernaryQueryEngine>());
+    engines.push_back(MakeTernaryQueryEngine(f, options));
     query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   }
   XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
+
+  if (context_engine != nullptr) {
+    VLOG(3) << "narrowing_pass: computed "
+            << context_engine->specialization_count()
+            << " context specializations of " << f->name() << " in "
+            << context_engine->specialization_time() << ", skipped "
+            << context_engine->skipped_specialization_count();
+  }
+  if (VLOG_IS_ON(3) && analysis != AnalysisType::kTernary) {
+    TernaryQueryEngine ternary_query_engine;
+    RangeQueryEngine range_query_engine;
+    XLS_RETURN_IF_ERROR(ternary_query_engine.Populate(f).status());
+    XLS_RETURN_IF_ERROR(range_query_engine.Populate(f).status());
+    RangeAnalysisLog(f, ternary_query_engine, range_query_engine);
+  }
   return std::move(query_engine);
 }
 
 absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  AnalysisType analysis = RealAnalysis(options);
+  if (analysis == AnalysisType::kRangeWithContext &&
+      BudgetUsed(options, kContextAnalysisBudgetFraction)) {
+    RecordCurtailment(options, short_name(),
+                      "used range analysis instead of context-sensitive "
+                      "range analysis");
+    analysis = AnalysisType::kRange;
+  }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, RealAnalysis(options)));
+                       GetQueryEngine(f, analysis, options));
 
   PredicateDominatorAnalysis pda = PredicateDominatorAnalysis::Run(f);
-  SpecializedQueryEngines sqe(RealAnalysis(options), pda, *query_engine);
+  SpecializedQueryEngines sqe(analysis, pda, *query_engine);
 
-  NarrowVisitor narrower(sqe, RealAnalysis(options), options,
-                         SplitsEnabled(opt_level_));
+  NarrowVisitor narrower(sqe, analysis, options, SplitsEnabled(opt_level_));
 
   for (Node* node : TopoSort(f)) {
     // We specifically want gate ops to be eligible for being reduced to a
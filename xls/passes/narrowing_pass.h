@@ -46,6 +46,8 @@ class NarrowingPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~NarrowingPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   AnalysisType analysis_;
   int64_t opt_level_;
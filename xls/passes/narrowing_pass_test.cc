@@ -21,6 +21,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
@@ -32,6 +34,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
@@ -47,6 +50,8 @@ using ::xls::solvers::z3::ScopedVerifyEquivalence;
 using ::testing::_;
 using ::testing::AllOf;
 using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::Field;
 
 // The test is parameterized on whether to use range analysis or not.
 class NarrowingPassTestBase : public IrTestBase {
@@ -56,9 +61,12 @@ class NarrowingPassTestBase : public IrTestBase {
   virtual NarrowingPass::AnalysisType analysis() const = 0;
 
   absl::StatusOr<bool> Run(Package* p) {
-    PassResults results;
     OptimizationPassOptions options;
     options.convert_array_index_to_select = 2;
+    return Run(p, options);
+  }
+  absl::StatusOr<bool> Run(Package* p, const OptimizationPassOptions& options) {
+    PassResults results;
     return NarrowingPass(analysis()).Run(p, options, &results);
   }
 };
@@ -1302,6 +1310,62 @@ TEST_F(ContextNarrowingPassTest, ExactMatch) {
       << f->DumpIr();
 }
 
+TEST_F(ContextNarrowingPassTest, SpecializationLimit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue param = fb.Param("param", p->GetBitsType(64));
+  BValue lit_10 = fb.Literal(UBits(10, 64));
+  BValue add_10 = fb.Add(param, lit_10);
+  BValue result = fb.Select(param, {lit_10, add_10, lit_10, add_10}, lit_10);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Without specializations the arms of the select can't be made constant.
+  OptimizationPassOptions options;
+  options.max_context_specializations = 0;
+  XLS_ASSERT_OK(Run(p.get(), options).status());
+  ASSERT_EQ(f->return_value(), result.node());
+  EXPECT_THAT(result.node(),
+              m::Select(param.node(),
+                        {m::Literal(UBits(10, 64)), m::Add(),
+                         m::Literal(UBits(10, 64)), m::Add()},
+                        m::Literal(UBits(10, 64))));
+
+  // With a single specialization only the earliest arm is specialized.
+  options.max_context_specializations = 1;
+  ASSERT_THAT(Run(p.get(), options), IsOkAndHolds(true));
+  EXPECT_THAT(result.node(),
+              m::Select(param.node(),
+                        {m::Literal(UBits(10, 64)), m::Literal(UBits(11, 64)),
+                         m::Literal(UBits(10, 64)), m::Add()},
+                        m::Literal(UBits(10, 64))));
+}
+
+TEST_F(ContextNarrowingPassTest, SpentBudgetFallsBackToRangeAnalysis) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue param = fb.Param("param", p->GetBitsType(64));
+  BValue lit_10 = fb.Literal(UBits(10, 64));
+  BValue add_10 = fb.Add(param, lit_10);
+  BValue result = fb.Select(param, {lit_10, add_10, lit_10, add_10}, lit_10);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  OptimizationBudget budget(absl::Seconds(1), absl::Now() - absl::Seconds(10));
+  OptimizationPassOptions options;
+  options.budget = &budget;
+  XLS_ASSERT_OK(Run(p.get(), options).status());
+  ASSERT_EQ(f->return_value(), result.node());
+  EXPECT_THAT(result.node(),
+              m::Select(param.node(),
+                        {m::Literal(UBits(10, 64)), m::Add(),
+                         m::Literal(UBits(10, 64)), m::Add()},
+                        m::Literal(UBits(10, 64))));
+  EXPECT_THAT(budget.curtailments(),
+              ElementsAre(Field(&OptimizationBudget::Curtailment::pass_name,
+                                "narrow")));
+}
+
 TEST_F(ContextNarrowingPassTest, ExactMatchWithEq) {
   auto p = CreatePackage();
   // fn (x) { if (x == 10) { x + 10 } else { 13 } }
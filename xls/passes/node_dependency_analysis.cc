@@ -15,8 +15,10 @@
 #include "xls/passes/node_dependency_analysis.h"
 
 #include <cstdint>
+#include <optional>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -62,23 +64,41 @@ AnalyzeDependents(FunctionBase* f,
     }
     return seen_interesting_nodes_count == interesting_nodes.size();
   };
+  // The number of nodes yet to be visited which read the bitmap of each node.
+  // Once it drops to zero the bitmap of an uninteresting node is released, so
+  // only the bitmaps of the frontier of the walk are held at any time.
+  std::vector<int64_t> pending_reads(f->node_count(), 0);
+  for (Node* n : topo_sort) {
+    for (Node* pred : preds(n)) {
+      ++pending_reads[node_ids.at(pred)];
+    }
+  }
   int64_t bitmap_size = f->node_count();
-  absl::flat_hash_map<Node*, InlineBitmap> results;
-  results.reserve(f->node_count());
+  std::vector<std::optional<InlineBitmap>> bitmaps(f->node_count());
   for (Node* n : topo_sort) {
-    InlineBitmap& bm = results.emplace(n, bitmap_size).first->second;
-    bm.Set(node_ids[n]);
+    int64_t id = node_ids.at(n);
+    InlineBitmap& bm = bitmaps[id].emplace(bitmap_size);
+    bm.Set(id);
     for (Node* pred : preds(n)) {
-      bm.Union(results.at(pred));
+      int64_t pred_id = node_ids.at(pred);
+      bm.Union(*bitmaps[pred_id]);
+      if (--pending_reads[pred_id] == 0 && !is_interesting(pred)) {
+        bitmaps[pred_id].reset();
+      }
     }
     if (is_last_interesting_node(n)) {
       break;
     }
   }
-  // To avoid any bugs delete everything that's not specifically requested.
-  absl::erase_if(results,
-                 [&](auto& pair) { return !is_interesting(pair.first); });
-  return {results, node_ids};
+  // To avoid any bugs drop everything that's not specifically requested.
+  absl::flat_hash_map<Node*, InlineBitmap> results;
+  for (Node* n : topo_sort) {
+    std::optional<InlineBitmap>& bm = bitmaps[node_ids.at(n)];
+    if (bm.has_value() && is_interesting(n)) {
+      results.emplace(n, *std::move(bm));
+    }
+  }
+  return {std::move(results), std::move(node_ids)};
 }
 
 }  // namespace
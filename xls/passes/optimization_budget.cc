@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_budget.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+
+absl::Duration OptimizationBudget::Remaining() const {
+  return std::max(budget_ - (absl::Now() - start_), absl::ZeroDuration());
+}
+
+double OptimizationBudget::FractionUsed() const {
+  if (budget_ <= absl::ZeroDuration()) {
+    return 1.0;
+  }
+  return absl::FDivDuration(absl::Now() - start_, budget_);
+}
+
+void OptimizationBudget::RecordCurtailment(std::string_view pass_name,
+                                           std::string_view description) {
+  absl::MutexLock lock(&mutex_);
+  for (Curtailment& curtailment : curtailments_) {
+    if (curtailment.pass_name == pass_name &&
+        curtailment.description == description) {
+      ++curtailment.count;
+      return;
+    }
+  }
+  curtailments_.push_back(Curtailment{.pass_name = std::string(pass_name),
+                                      .description = std::string(description),
+                                      .count = 1});
+}
+
+std::vector<OptimizationBudget::Curtailment> OptimizationBudget::curtailments()
+    const {
+  absl::MutexLock lock(&mutex_);
+  return curtailments_;
+}
+
+std::string OptimizationBudget::Report() const {
+  std::string report;
+  for (const Curtailment& curtailment : curtailments()) {
+    absl::StrAppendFormat(&report, "%s: %s (%d function bases)\n",
+                          curtailment.pass_name, curtailment.description,
+                          curtailment.count);
+  }
+  return report;
+}
+
+bool BudgetUsed(const OptimizationPassOptions& options, double fraction) {
+  return options.budget != nullptr &&
+         options.budget->FractionUsed() >= fraction;
+}
+
+void RecordCurtailment(const OptimizationPassOptions& options,
+                       std::string_view pass_name,
+                       std::string_view description) {
+  CHECK(options.budget != nullptr);
+  options.budget->RecordCurtailment(pass_name, description);
+}
+
+}  // namespace xls
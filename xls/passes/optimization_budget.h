@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_OPTIMIZATION_BUDGET_H_
+#define XLS_PASSES_OPTIMIZATION_BUDGET_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+
+// A wall-clock budget for an optimization pipeline. Passes with expensive
+// analyses consult the budget and switch to cheaper analyses as it is used up,
+// recording each such curtailment so that it can be reported after the
+// pipeline has run. The budget does not stop the pipeline; cheap passes run to
+// completion regardless.
+//
+// Curtailments may be recorded concurrently by passes running on different
+// function bases.
+class OptimizationBudget {
+ public:
+  struct Curtailment {
+    // Short name of the curtailed pass.
+    std::string pass_name;
+    // What the pass did instead of its full analysis.
+    std::string description;
+    // Number of function bases on which the pass was curtailed this way.
+    int64_t count;
+  };
+
+  explicit OptimizationBudget(absl::Duration budget,
+                              absl::Time start = absl::Now())
+      : budget_(budget), start_(start) {}
+  OptimizationBudget(const OptimizationBudget&) = delete;
+  OptimizationBudget& operator=(const OptimizationBudget&) = delete;
+
+  absl::Duration budget() const { return budget_; }
+
+  // The time left in the budget, never negative.
+  absl::Duration Remaining() const;
+
+  // The fraction of the budget used so far. May exceed one.
+  double FractionUsed() const;
+
+  bool Exhausted() const { return FractionUsed() >= 1.0; }
+
+  // Records that `pass_name` used a cheaper analysis because of the budget.
+  void RecordCurtailment(std::string_view pass_name,
+                         std::string_view description);
+
+  // The curtailments recorded so far, in the order they were first recorded.
+  std::vector<Curtailment> curtailments() const;
+
+  // Returns a human readable list of the curtailments, one per line.
+  std::string Report() const;
+
+ private:
+  const absl::Duration budget_;
+  const absl::Time start_;
+  mutable absl::Mutex mutex_;
+  std::vector<Curtailment> curtailments_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns true if `options` has a budget of which at least `fraction` has been
+// used. Passes call this to decide whether to curtail an analysis and then
+// record the curtailment with RecordCurtailment.
+bool BudgetUsed(const OptimizationPassOptions& options, double fraction);
+
+// Records a curtailment in the budget of `options`, which must be set.
+void RecordCurtailment(const OptimizationPassOptions& options,
+                       std::string_view pass_name,
+                       std::string_view description);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_OPTIMIZATION_BUDGET_H_
@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_budget.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FieldsAre;
+
+TEST(OptimizationBudgetTest, FractionUsed) {
+  OptimizationBudget fresh(absl::Hours(1));
+  EXPECT_LT(fresh.FractionUsed(), 0.5);
+  EXPECT_FALSE(fresh.Exhausted());
+  EXPECT_GT(fresh.Remaining(), absl::Minutes(30));
+
+  OptimizationBudget half(absl::Hours(1), absl::Now() - absl::Minutes(40));
+  EXPECT_GE(half.FractionUsed(), 0.5);
+  EXPECT_FALSE(half.Exhausted());
+
+  OptimizationBudget spent(absl::Seconds(1), absl::Now() - absl::Seconds(10));
+  EXPECT_TRUE(spent.Exhausted());
+  EXPECT_EQ(spent.Remaining(), absl::ZeroDuration());
+
+  EXPECT_TRUE(OptimizationBudget(absl::ZeroDuration()).Exhausted());
+}
+
+TEST(OptimizationBudgetTest, BudgetUsedWithoutBudget) {
+  OptimizationPassOptions options;
+  EXPECT_FALSE(BudgetUsed(options, 0.0));
+
+  OptimizationBudget spent(absl::Seconds(1), absl::Now() - absl::Seconds(10));
+  options.budget = &spent;
+  EXPECT_TRUE(BudgetUsed(options, 0.5));
+  EXPECT_TRUE(BudgetUsed(options, 1.0));
+}
+
+TEST(OptimizationBudgetTest, RecordsCurtailments) {
+  OptimizationBudget budget(absl::Seconds(1));
+  EXPECT_TRUE(budget.curtailments().empty());
+  EXPECT_EQ(budget.Report(), "");
+
+  budget.RecordCurtailment("bdd_simp", "used ternary analysis");
+  budget.RecordCurtailment("narrow", "used range analysis");
+  budget.RecordCurtailment("bdd_simp", "used ternary analysis");
+  EXPECT_THAT(budget.curtailments(),
+              ElementsAre(FieldsAre("bdd_simp", "used ternary analysis", 2),
+                          FieldsAre("narrow", "used range analysis", 1)));
+  EXPECT_EQ(budget.Report(),
+            "bdd_simp: used ternary analysis (2 function bases)\n"
+            "narrow: used range analysis (1 function bases)\n");
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,12 +14,16 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
-#include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -29,9 +33,12 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
@@ -148,8 +155,20 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  if (options.frozen_function_bases != nullptr) {
+    std::erase_if(function_bases, [&](FunctionBase* f) {
+      return options.frozen_function_bases->contains(f);
+    });
+  }
+  const int64_t thread_count =
+      std::min<int64_t>(options.function_pass_threads, function_bases.size());
+  if (thread_count > 1 && IsSafeToRunConcurrently()) {
+    return RunOnFunctionBasesInParallel(function_bases, thread_count, options,
+                                        results);
+  }
   bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
+  for (FunctionBase* f : function_bases) {
     XLS_ASSIGN_OR_RETURN(bool function_changed,
                          RunOnFunctionBaseInternal(f, options, results));
     changed = changed || function_changed;
@@ -157,6 +176,125 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
   return changed;
 }
 
+absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBasesInParallel(
+    absl::Span<FunctionBase* const> function_bases, int64_t thread_count,
+    const OptimizationPassOptions& options, PassResults* results) const {
+  // Each function base allocates node ids from a private range while the
+  // workers run. Ending the isolated mutations in package order afterwards
+  // renumbers the new nodes exactly as serial execution would have.
+  for (FunctionBase* f : function_bases) {
+    f->BeginIsolatedMutation();
+  }
+  std::vector<absl::StatusOr<bool>> function_results(function_bases.size(),
+                                                     false);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < function_bases.size();
+         i = next_index.fetch_add(1)) {
+      function_results[i] =
+          RunOnFunctionBaseInternal(function_bases[i], options, results);
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (FunctionBase* f : function_bases) {
+    f->EndIsolatedMutation();
+  }
+
+  // Report the first failure in package order so errors match serial mode.
+  bool changed = false;
+  for (absl::StatusOr<bool>& function_result : function_results) {
+    XLS_ASSIGN_OR_RETURN(bool function_changed, std::move(function_result));
+    changed = changed || function_changed;
+  }
+  return changed;
+}
+
+namespace {
+
+// Worklist of nodes to (re)visit in TransformNodesToFixedPoint. Registered as
+// a change listener so nodes affected by each rewrite are queued: new nodes,
+// nodes whose operands changed along with their users (whose patterns may look
+// through the changed node), and the operands of removed nodes.
+class NodeWorklist : public ChangeListener {
+ public:
+  explicit NodeWorklist(FunctionBase* f) : f_(f) {
+    for (Node* node : f->nodes()) {
+      Push(node);
+    }
+    f_->RegisterChangeListener(this);
+  }
+  ~NodeWorklist() override { f_->UnregisterChangeListener(this); }
+
+  bool empty() const { return pending_.empty(); }
+
+  // Returns the next node to visit. Must not be called if `empty()`.
+  Node* Pop() {
+    while (true) {
+      Node* node = queue_.front();
+      queue_.pop_front();
+      // Skip entries of nodes which were removed or are queued again later.
+      if (pending_.erase(node) != 0) {
+        return node;
+      }
+    }
+  }
+
+  void Push(Node* node) {
+    if (pending_.insert(node).second) {
+      queue_.push_back(node);
+    }
+  }
+
+  void PushWithUsers(Node* node) {
+    Push(node);
+    for (Node* user : node->users()) {
+      Push(user);
+    }
+  }
+
+  // Records whether `node` is removed from now on. Used to tell whether a
+  // rewrite removed the node it was called on.
+  void Watch(Node* node) {
+    watched_ = node;
+    watched_deleted_ = false;
+  }
+  bool watched_deleted() const { return watched_deleted_; }
+
+  void NodeAdded(Node* node) override { Push(node); }
+  void NodeDeleted(Node* node) override {
+    pending_.erase(node);
+    for (Node* operand : node->operands()) {
+      Push(operand);
+    }
+    if (node == watched_) {
+      watched_deleted_ = true;
+    }
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    PushWithUsers(node);
+    Push(old_operand);
+  }
+
+ private:
+  FunctionBase* f_;
+  std::deque<Node*> queue_;
+  absl::flat_hash_set<Node*> pending_;
+  Node* watched_ = nullptr;
+  bool watched_deleted_ = false;
+};
+
+}  // namespace
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
     FunctionBase* f,
     std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
@@ -164,32 +302,33 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
   // reused.
   absl::flat_hash_set<int64_t> simplified_node_ids;
   bool changed = false;
-  bool changed_this_time = false;
-  do {
-    changed_this_time = false;
-    auto node_it = f->nodes().begin();
-    while (node_it != f->nodes().end()) {
-      // Save the next iterator because node_it may be invalidated by the call
-      // to simplify_f if simpplify_f ends up deleting 'node'.
-      auto next_it = std::next(node_it);
-      Node* node = *node_it;
-      // If the node was previously simplified and is now dead, avoid running
-      // simplification on it again to avoid inf-looping while simplifying the
-      // same node over and over again.
-      if (!node->IsDead() || !simplified_node_ids.contains(node->id())) {
-        // Grab the node ID before simplifying because the node might be
-        // removed when simplifying.
-        int64_t node_id = node->id();
-        XLS_ASSIGN_OR_RETURN(bool node_changed, simplify_f(node));
-        if (node_changed) {
-          simplified_node_ids.insert(node_id);
-          changed_this_time = true;
-          changed = true;
-        }
+  // Rather than sweeping over every node until nothing changes, visit each
+  // node once and then only the nodes the rewrites affected, so the work is
+  // proportional to the amount of change.
+  NodeWorklist worklist(f);
+  while (!worklist.empty()) {
+    Node* node = worklist.Pop();
+    // If the node was previously simplified and is now dead, avoid running
+    // simplification on it again to avoid inf-looping while simplifying the
+    // same node over and over again.
+    if (node->IsDead() && simplified_node_ids.contains(node->id())) {
+      continue;
+    }
+    // Grab the node ID before simplifying because the node might be removed
+    // when simplifying.
+    int64_t node_id = node->id();
+    worklist.Watch(node);
+    XLS_ASSIGN_OR_RETURN(bool node_changed, simplify_f(node));
+    if (node_changed) {
+      simplified_node_ids.insert(node_id);
+      changed = true;
+      // Not every change is structural (e.g., a node's attributes may be
+      // rewritten in place) so revisit the node and its users.
+      if (!worklist.watched_deleted()) {
+        worklist.PushWithUsers(node);
       }
-      node_it = next_it;
     }
-  } while (changed_this_time);
+  }
 
   return changed;
 }
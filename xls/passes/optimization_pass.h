@@ -24,7 +24,10 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
@@ -37,6 +40,10 @@
 
 namespace xls {
 
+class OptimizationBudget;
+class OptimizationResultCache;
+class QueryEngineCache;
+
 // Metadata for RAMs.
 // TODO(google/xls#873): Ideally this metadata should live in the IR.
 //
@@ -127,12 +134,54 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // this optimization is skipped, since it can sometimes reduce output quality.
   std::optional<int64_t> split_next_value_selects = std::nullopt;
 
+  // If this is not `std::nullopt`, counted for loops with at least the given
+  // number of iterations and maps over at least that many elements are
+  // expanded one iteration at a time: each iteration's body is inlined, its
+  // constant operations folded and its dead nodes removed before the next
+  // iteration is cloned. This bounds the size of the IR while unrolling large
+  // loops whose iterations mostly fold away.
+  std::optional<int64_t> streaming_unroll_threshold = std::nullopt;
+
   // List of RAM rewrites, generally lowering abstract RAMs into concrete
   // variants.
   std::vector<RamRewrite> ram_rewrites;
 
   // Use select context during narrowing range analysis.
   bool use_context_narrowing_analysis = false;
+
+  // Limits on the select-context specializations computed by each run of
+  // context-sensitive narrowing: at most this many per function base, and no
+  // new ones once this much time has been spent on them. Predicates beyond the
+  // limits are narrowed using the context-free ranges. A time budget makes the
+  // optimized IR depend on the speed of the machine.
+  std::optional<int64_t> max_context_specializations = std::nullopt;
+  std::optional<absl::Duration> context_specialization_time_budget =
+      std::nullopt;
+
+  // Number of threads on which passes scoped to a single function/proc may
+  // process the function bases of a package concurrently. Values of one or
+  // less run them serially. The optimized IR, including node ids, is
+  // identical to that of serial execution.
+  int64_t function_pass_threads = 1;
+
+  // If set, passes share query engines through this cache, which updates
+  // their results incrementally as the IR changes instead of having each pass
+  // recompute them. See query_engine_cache.h. Not owned.
+  QueryEngineCache* query_engine_cache = nullptr;
+
+  // If set, passes with expensive analyses fall back to cheaper ones as this
+  // wall-clock budget is used up and record having done so in it. See
+  // optimization_budget.h. Not owned.
+  OptimizationBudget* budget = nullptr;
+
+  // If set, the pre-inlining passes reuse function bodies optimized by earlier
+  // runs and store the ones they optimize. See optimization_result_cache.h.
+  // Not owned.
+  OptimizationResultCache* result_cache = nullptr;
+
+  // If set, passes scoped to a single function base leave these function bases
+  // untouched. Not owned.
+  const absl::flat_hash_set<FunctionBase*>* frozen_function_bases = nullptr;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -177,9 +226,20 @@ class OptimizationFunctionBasePass : public OptimizationPass {
                                          const OptimizationPassOptions& options,
                                          PassResults* results) const;
 
+  // Returns whether the pass may run on several function bases of a package
+  // concurrently (see `OptimizationPassOptions::function_pass_threads`). A
+  // pass may only return true if RunOnFunctionBaseInternal reads and mutates
+  // nothing but the function base it is given (and interns types), and treats
+  // `results` as read-only. Passes which look into other function bases, e.g.
+  // by inlining or interpreting invoked functions, must run serially as the
+  // callee may be being transformed at the same time.
+  virtual bool IsSafeToRunConcurrently() const { return false; }
+
  protected:
   // Iterates over each function and proc in the package calling
-  // RunOnFunctionBase.
+  // RunOnFunctionBase. If `options.function_pass_threads` is greater than one
+  // and the pass IsSafeToRunConcurrently, the function bases are processed
+  // concurrently.
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
@@ -193,11 +253,22 @@ class OptimizationFunctionBasePass : public OptimizationPass {
   // IR was modified. simplify_f can add or remove nodes including the node
   // passed to it.
   //
+  // After the first visit of every node only the nodes affected by changes are
+  // revisited: added nodes, nodes whose operands changed and their users, the
+  // operands of removed nodes, and nodes for which simplify_f returned true
+  // and their users. simplify_f must therefore only depend on the node and its
+  // nearby operands and users.
+  //
   // TransformNodesToFixedPoint returns true iff any invocations of simplify_f
   // returned true.
   absl::StatusOr<bool> TransformNodesToFixedPoint(
       FunctionBase* f,
       std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+ private:
+  absl::StatusOr<bool> RunOnFunctionBasesInParallel(
+      absl::Span<FunctionBase* const> function_bases, int64_t thread_count,
+      const OptimizationPassOptions& options, PassResults* results) const;
 };
 
 // Abstract base class for passes operate on procs. The derived
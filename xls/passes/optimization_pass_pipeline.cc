@@ -19,19 +19,34 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/casts.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/arith_simplification_pass.h"
 #include "xls/passes/array_simplification_pass.h"
 #include "xls/passes/basic_simplification_pass.h"
@@ -58,6 +73,7 @@
 #include "xls/passes/next_value_optimization_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/optimization_result_cache.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/proc_inlining_pass.h"
 #include "xls/passes/proc_state_array_flattening_pass.h"
@@ -150,7 +166,8 @@ FixedPointSimplificationPass::FixedPointSimplificationPass(int64_t opt_level)
 
 PreInliningPassGroup::PreInliningPassGroup(int64_t opt_level)
     : OptimizationCompoundPass(PreInliningPassGroup::kName,
-                               "pre-inlining passes") {
+                               "pre-inlining passes"),
+      opt_level_(opt_level) {
   Add<DeadFunctionEliminationPass>();
   Add<DeadCodeEliminationPass>();
   // At this stage in the pipeline only optimizations up to level 2 should
@@ -160,6 +177,93 @@ PreInliningPassGroup::PreInliningPassGroup(int64_t opt_level)
   Add<SimplificationPass>(std::min(int64_t{2}, opt_level));
 }
 
+std::string PreInliningPassGroup::CacheSalt(
+    const OptimizationPassOptions& options) const {
+  std::vector<std::string> parts = {absl::StrCat("opt_level=", opt_level_)};
+  std::function<void(const OptimizationPass*)> add_pass =
+      [&](const OptimizationPass* pass) {
+        parts.push_back(pass->short_name());
+        if (pass->IsCompound()) {
+          parts.push_back("(");
+          for (const OptimizationPass* nested :
+               down_cast<const OptimizationCompoundPass*>(pass)->passes()) {
+            add_pass(nested);
+          }
+          parts.push_back(")");
+        }
+      };
+  add_pass(this);
+  parts.push_back(
+      absl::StrCat("skip_passes=", absl::StrJoin(options.skip_passes, ",")));
+  parts.push_back(absl::StrCat("convert_array_index_to_select=",
+                               options.convert_array_index_to_select.value_or(
+                                   -1)));
+  parts.push_back(absl::StrCat("split_next_value_selects=",
+                               options.split_next_value_selects.value_or(-1)));
+  parts.push_back(absl::StrCat("use_context_narrowing_analysis=",
+                               options.use_context_narrowing_analysis));
+  parts.push_back(absl::StrCat("max_context_specializations=",
+                               options.max_context_specializations.value_or(
+                                   -1)));
+  parts.push_back(absl::StrCat(
+      "context_specialization_time_budget=",
+      absl::FormatDuration(options.context_specialization_time_budget.value_or(
+          absl::InfiniteDuration()))));
+  return absl::StrJoin(parts, " ");
+}
+
+absl::StatusOr<CompoundPassResult> PreInliningPassGroup::RunNested(
+    Package* p, const OptimizationPassOptions& options, PassResults* results,
+    std::string_view top_level_name,
+    absl::Span<const InvariantChecker* const> invariant_checkers) const {
+  if (options.result_cache == nullptr) {
+    return OptimizationCompoundPass::RunNested(p, options, results,
+                                               top_level_name,
+                                               invariant_checkers);
+  }
+  // Compute all of the keys before restoring anything since the key of a
+  // function covers the unoptimized IR of its callees.
+  std::string salt = CacheSalt(options);
+  std::vector<std::pair<Function*, std::string>> keyed_functions;
+  for (const std::unique_ptr<Function>& f : p->functions()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> key,
+                         options.result_cache->ComputeKey(f.get(), salt));
+    if (key.has_value()) {
+      keyed_functions.push_back({f.get(), *std::move(key)});
+    }
+  }
+  absl::flat_hash_set<FunctionBase*> restored;
+  absl::flat_hash_map<std::string, std::string> keys_to_store;
+  for (auto& [f, key] : keyed_functions) {
+    XLS_ASSIGN_OR_RETURN(bool hit, options.result_cache->Restore(f, key));
+    if (hit) {
+      restored.insert(f);
+    } else {
+      keys_to_store[f->name()] = std::move(key);
+    }
+  }
+
+  OptimizationPassOptions frozen_options = options;
+  frozen_options.frozen_function_bases = &restored;
+  XLS_ASSIGN_OR_RETURN(
+      CompoundPassResult result,
+      OptimizationCompoundPass::RunNested(p, frozen_options, results,
+                                          top_level_name, invariant_checkers));
+  if (!restored.empty()) {
+    result.set_changed(true);
+  }
+  // Functions removed as dead by the passes are not stored.
+  for (const std::unique_ptr<Function>& f : p->functions()) {
+    if (auto it = keys_to_store.find(f->name()); it != keys_to_store.end()) {
+      options.result_cache->Store(f.get(), it->second);
+    }
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Optimization result cache: %d hits, %d misses",
+      options.result_cache->hit_count(), options.result_cache->miss_count());
+  return result;
+}
+
 UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup(int64_t opt_level)
     : OptimizationCompoundPass(UnrollingAndInliningPassGroup::kName,
                                "full function inlining passes") {
@@ -273,7 +377,9 @@ std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline(
     int64_t opt_level) {
   auto top = std::make_unique<OptimizationCompoundPass>(
       "ir", "Top level pass pipeline");
-  top->AddInvariantChecker<VerifierChecker>();
+  // The package is fully verified before the first pass; after that only the
+  // nodes changed by each pass are re-verified.
+  top->AddInvariantChecker<VerifierChecker>(/*incremental=*/true);
 
   top->Add<PreInliningPassGroup>(opt_level);
   top->Add<UnrollingAndInliningPassGroup>(opt_level);
@@ -287,7 +393,11 @@ absl::StatusOr<bool> RunOptimizationPassPipeline(Package* package,
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline(opt_level);
   PassResults results;
-  return pipeline->Run(package, OptimizationPassOptions(), &results);
+  XLS_ASSIGN_OR_RETURN(
+      bool changed,
+      pipeline->Run(package, OptimizationPassOptions(), &results));
+  XLS_RETURN_IF_ERROR(VerifyPackage(package));
+  return changed;
 }
 
 absl::Status OptimizationPassPipelineGenerator::AddPassToPipeline(
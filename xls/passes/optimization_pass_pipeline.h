@@ -23,8 +23,10 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 
@@ -40,10 +42,29 @@ class FixedPointSimplificationPass : public OptimizationFixedPointCompoundPass {
 };
 
 // The passes which are executed before any inlining has been performed.
+//
+// These passes only look at the function they optimize, so if
+// `OptimizationPassOptions::result_cache` is set functions whose optimized
+// bodies are cached are restored from the cache and left alone by the passes,
+// and the bodies of the other functions are cached once optimized.
 class PreInliningPassGroup : public OptimizationCompoundPass {
  public:
   static constexpr std::string_view kName = "pre-inlining";
   explicit PreInliningPassGroup(int64_t opt_level);
+
+ protected:
+  absl::StatusOr<CompoundPassResult> RunNested(
+      Package* p, const OptimizationPassOptions& options, PassResults* results,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> invariant_checkers)
+      const override;
+
+ private:
+  // Returns the description of the passes and options used to salt the result
+  // cache keys.
+  std::string CacheSalt(const OptimizationPassOptions& options) const;
+
+  int64_t opt_level_;
 };
 
 // The passes which perform full function inlining.
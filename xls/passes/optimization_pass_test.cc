@@ -37,9 +37,11 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
@@ -422,6 +424,126 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Replaces every neg with a subtraction from zero, creating new nodes (and
+// consuming node ids) in the function being transformed.
+class NegToSubPass : public OptimizationFunctionBasePass {
+ public:
+  NegToSubPass() : OptimizationFunctionBasePass("neg_to_sub", "neg to sub") {}
+
+  bool IsSafeToRunConcurrently() const override { return true; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    std::vector<Node*> negs;
+    for (Node* node : f->nodes()) {
+      if (node->op() == Op::kNeg) {
+        negs.push_back(node);
+      }
+    }
+    for (Node* neg : negs) {
+      XLS_ASSIGN_OR_RETURN(
+          Literal * zero,
+          f->MakeNode<Literal>(neg->loc(),
+                               Value(UBits(0, neg->BitCountOrDie()))));
+      XLS_RETURN_IF_ERROR(
+          neg->ReplaceUsesWithNew<BinOp>(zero, neg->operand(0), Op::kSub)
+              .status());
+      XLS_RETURN_IF_ERROR(f->RemoveNode(neg));
+    }
+    return !negs.empty();
+  }
+};
+
+// Folds not(not(x)) into x using TransformNodesToFixedPoint, counting the
+// nodes visited.
+class CountingDoubleNotPass : public OptimizationFunctionBasePass {
+ public:
+  CountingDoubleNotPass()
+      : OptimizationFunctionBasePass("double_not", "double not") {}
+
+  int64_t visit_count() const { return visit_count_; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    return TransformNodesToFixedPoint(f, [&](Node* n) -> absl::StatusOr<bool> {
+      ++visit_count_;
+      if (n->op() == Op::kNot && n->operand(0)->op() == Op::kNot) {
+        XLS_RETURN_IF_ERROR(n->ReplaceUsesWith(n->operand(0)->operand(0)));
+        return true;
+      }
+      return false;
+    });
+  }
+
+ private:
+  mutable int64_t visit_count_ = 0;
+};
+
+TEST(PassesTest, TransformNodesToFixedPointOnlyRevisitsChangedNodes) {
+  auto m = std::make_unique<Package>("m");
+  FunctionBuilder fb("test", m.get());
+  BValue x = fb.Param("x", m->GetBitsType(32));
+  // A long chain of adds which never simplifies and, at its end, a chain of
+  // nots which folds away one pair at a time from the top.
+  BValue value = x;
+  for (int64_t i = 0; i < 500; ++i) {
+    value = fb.Add(value, x);
+  }
+  BValue adds = value;
+  for (int64_t i = 0; i < 8; ++i) {
+    value = fb.Not(value);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(value));
+  int64_t node_count = f->node_count();
+
+  CountingDoubleNotPass pass;
+  PassResults results;
+  ASSERT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value(), adds.node());
+  // Only the nots near each change are revisited, rather than every node in
+  // another sweep.
+  EXPECT_LT(pass.visit_count(), node_count + 50);
+}
+
+std::unique_ptr<Package> BuildPackageWithManyFunctions() {
+  auto p = std::make_unique<Package>("many_functions");
+  for (int64_t i = 0; i < 16; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(i + 1));
+    BValue value = x;
+    for (int64_t j = 0; j <= i % 5; ++j) {
+      value = fb.Add(fb.Negate(value), x);
+    }
+    CHECK_OK(fb.Build().status());
+  }
+  return p;
+}
+
+TEST(PassesTest, ParallelFunctionBasePassMatchesSerial) {
+  std::unique_ptr<Package> serial = BuildPackageWithManyFunctions();
+  std::unique_ptr<Package> parallel = BuildPackageWithManyFunctions();
+
+  PassResults serial_results;
+  ASSERT_THAT(NegToSubPass().Run(serial.get(), OptimizationPassOptions(),
+                                 &serial_results),
+              IsOkAndHolds(true));
+
+  OptimizationPassOptions parallel_options;
+  parallel_options.function_pass_threads = 4;
+  PassResults parallel_results;
+  ASSERT_THAT(NegToSubPass().Run(parallel.get(), parallel_options,
+                                 &parallel_results),
+              IsOkAndHolds(true));
+
+  EXPECT_EQ(parallel->next_node_id(), serial->next_node_id());
+  EXPECT_EQ(parallel->DumpIr(), serial->DumpIr());
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
@@ -0,0 +1,214 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_result_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/cache_key.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+// Bumped whenever the format of the cached entries changes.
+constexpr std::string_view kFormatVersion = "1";
+
+// Returns `f` and the functions it transitively calls cloned into a fresh
+// package along with the names of the files their source positions refer to.
+// Functions with equal IR export to equal packages regardless of the node ids
+// they have in the package they come from.
+absl::StatusOr<std::unique_ptr<Package>> ExportFunction(Function* f) {
+  auto exported = std::make_unique<Package>("optimization_result_cache");
+  XLS_RETURN_IF_ERROR(
+      CloneFunctionAndItsDependencies(f, f->name(), exported.get()).status());
+  for (FunctionBase* function_base : exported->GetFunctionBases()) {
+    for (Node* node : function_base->nodes()) {
+      for (const SourceLocation& location : node->loc().locations) {
+        if (std::optional<std::string> filename =
+                f->package()->GetFilename(location.fileno());
+            filename.has_value()) {
+          exported->SetFileno(location.fileno(), *filename);
+        }
+      }
+    }
+  }
+  return exported;
+}
+
+// Replaces the body of `f` with that of `replacement`, a function of another
+// package with the same signature. The functions called by `replacement` are
+// mapped to the functions of the same name in the package of `f`.
+absl::Status ReplaceBody(Function* f, Function* replacement) {
+  absl::flat_hash_map<const Function*, Function*> call_remapping;
+  for (FunctionBase* callee : GetDependentFunctions(replacement)) {
+    if (callee == replacement) {
+      continue;
+    }
+    XLS_RET_CHECK(callee->IsFunction());
+    XLS_ASSIGN_OR_RETURN(call_remapping[callee->AsFunctionOrDie()],
+                         f->package()->GetFunction(callee->name()));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Function * clone,
+      replacement->Clone(absl::StrCat(f->name(), "__cached"), f->package(),
+                         call_remapping));
+
+  // Free the names of the old nodes so the new nodes can take them.
+  std::vector<Node*> old_nodes;
+  for (Node* node : TopoSort(f)) {
+    if (!node->Is<Param>()) {
+      node->ClearName();
+      old_nodes.push_back(node);
+    }
+  }
+  absl::flat_hash_map<Node*, Node*> clone_to_f;
+  for (int64_t i = 0; i < clone->params().size(); ++i) {
+    clone_to_f[clone->param(i)] = f->param(i);
+  }
+  for (Node* node : TopoSort(clone)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operands.push_back(clone_to_f.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(clone_to_f[node],
+                         node->CloneInNewFunction(operands, f));
+  }
+  XLS_RETURN_IF_ERROR(
+      f->set_return_value(clone_to_f.at(clone->return_value())));
+  XLS_RETURN_IF_ERROR(f->package()->RemoveFunction(clone));
+  for (auto it = old_nodes.rbegin(); it != old_nodes.rend(); ++it) {
+    XLS_RETURN_IF_ERROR(f->RemoveNode(*it));
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether `a` and `b` have the same parameters and return type.
+bool SameSignature(Function* a, Function* b) {
+  if (a->params().size() != b->params().size() ||
+      a->GetType()->ToString() != b->GetType()->ToString()) {
+    return false;
+  }
+  for (int64_t i = 0; i < a->params().size(); ++i) {
+    if (a->param(i)->GetName() != b->param(i)->GetName()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+absl::StatusOr<std::optional<std::string>> OptimizationResultCache::ComputeKey(
+    Function* f, std::string_view salt) const {
+  for (FunctionBase* function_base : GetDependentFunctions(f)) {
+    for (Node* node : function_base->nodes()) {
+      // Cloning does not remap the bodies of dynamic counted for loops.
+      if (node->op() == Op::kDynamicCountedFor) {
+        return std::nullopt;
+      }
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> exported, ExportFunction(f));
+  return CacheKey({kFormatVersion, salt, f->name(), exported->DumpIr()});
+}
+
+std::filesystem::path OptimizationResultCache::PathForKey(
+    std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".ir");
+}
+
+absl::StatusOr<bool> OptimizationResultCache::Restore(Function* f,
+                                                      std::string_view key) {
+  std::filesystem::path path = PathForKey(key);
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  if (!contents.ok()) {
+    ++miss_count_;
+    return false;
+  }
+  absl::StatusOr<std::unique_ptr<Package>> cached =
+      Parser::ParsePackage(*contents);
+  std::optional<Function*> cached_function;
+  if (cached.ok()) {
+    cached_function = (*cached)->TryGetFunction(f->name());
+  }
+  if (!cached_function.has_value() || !SameSignature(f, *cached_function)) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Ignoring unusable optimization result cache entry %s for %s",
+        path.string(), f->name());
+    ++miss_count_;
+    return false;
+  }
+  XLS_RETURN_IF_ERROR(ReplaceBody(f, *cached_function));
+  VLOG(2) << absl::StreamFormat("Optimization result cache hit for %s (%s)",
+                                f->name(), key);
+  ++hit_count_;
+  return true;
+}
+
+void OptimizationResultCache::Store(Function* f, std::string_view key) {
+  absl::StatusOr<std::unique_ptr<Package>> exported = ExportFunction(f);
+  if (!exported.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to export %s for the optimization result cache: %s", f->name(),
+        exported.status().ToString());
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to create optimization result cache directory %s: %s",
+        directory_.string(), ec.message());
+    return;
+  }
+  std::filesystem::path path = PathForKey(key);
+  absl::Status status = AtomicSetFileContents(path, (*exported)->DumpIr());
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Unable to write optimization result cache %s: %s", path.string(),
+        status.ToString());
+  }
+}
+
+}  // namespace xls
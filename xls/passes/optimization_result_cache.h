@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_OPTIMIZATION_RESULT_CACHE_H_
+#define XLS_PASSES_OPTIMIZATION_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function.h"
+
+namespace xls {
+
+// A cache of optimized function bodies stored as files in a directory, which
+// may be shared by concurrent processes. Bodies are keyed on the IR of the
+// unoptimized function and of the functions it transitively calls (including
+// source positions, but not node ids) along with a salt describing the passes
+// and options which optimize it. This lets a library function appearing in
+// many packages be optimized once, provided the passes only look at the
+// function itself, as is the case before inlining.
+class OptimizationResultCache {
+ public:
+  explicit OptimizationResultCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Returns the key of `f` as it is now, or std::nullopt if `f` cannot be
+  // cached.
+  absl::StatusOr<std::optional<std::string>> ComputeKey(
+      Function* f, std::string_view salt) const;
+
+  // Replaces the body of `f` with the body cached under `key`, whose callees
+  // are resolved by name in the package of `f`. Returns false, leaving `f`
+  // unchanged, if there is no usable entry for the key.
+  absl::StatusOr<bool> Restore(Function* f, std::string_view key);
+
+  // Stores the body of `f` under `key`. Failures to write the cache are logged
+  // rather than returned since they only cost a later miss.
+  void Store(Function* f, std::string_view key);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  int64_t hit_count() const { return hit_count_; }
+  int64_t miss_count() const { return miss_count_; }
+
+ private:
+  std::filesystem::path PathForKey(std::string_view key) const;
+
+  std::filesystem::path directory_;
+  int64_t hit_count_ = 0;
+  int64_t miss_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_OPTIMIZATION_RESULT_CACHE_H_
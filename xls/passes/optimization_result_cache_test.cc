@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/optimization_result_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+// `f` computes `(x + 0) & y` by way of `g`. `kIrWithOtherIds` is the same IR
+// with different node ids and `kIrWithOtherCallee` has a different `g`.
+constexpr std::string_view kIr = R"(
+package p
+
+fn g(a: bits[8], b: bits[8]) -> bits[8] {
+  ret and.3: bits[8] = and(a, b, id=3)
+}
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  literal.6: bits[8] = literal(value=0, id=6)
+  add.7: bits[8] = add(x, literal.6, id=7)
+  ret invoke.8: bits[8] = invoke(add.7, y, to_apply=g, id=8)
+}
+)";
+
+constexpr std::string_view kIrWithOtherIds = R"(
+package q
+
+fn g(a: bits[8], b: bits[8]) -> bits[8] {
+  ret and.30: bits[8] = and(a, b, id=30)
+}
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  literal.60: bits[8] = literal(value=0, id=60)
+  add.70: bits[8] = add(x, literal.60, id=70)
+  ret invoke.80: bits[8] = invoke(add.70, y, to_apply=g, id=80)
+}
+)";
+
+constexpr std::string_view kIrWithOtherCallee = R"(
+package p
+
+fn g(a: bits[8], b: bits[8]) -> bits[8] {
+  ret or.3: bits[8] = or(a, b, id=3)
+}
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  literal.6: bits[8] = literal(value=0, id=6)
+  add.7: bits[8] = add(x, literal.6, id=7)
+  ret invoke.8: bits[8] = invoke(add.7, y, to_apply=g, id=8)
+}
+)";
+
+class OptimizationResultCacheTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::make_unique<TempDirectory>(std::move(temp_dir));
+  }
+
+  std::string Key(const OptimizationResultCache& cache, Package* p,
+                  std::string_view function_name,
+                  std::string_view salt = "salt") {
+    Function* f = p->GetFunction(function_name).value();
+    std::optional<std::string> key = cache.ComputeKey(f, salt).value();
+    EXPECT_TRUE(key.has_value());
+    return key.value_or("");
+  }
+
+  std::unique_ptr<TempDirectory> temp_dir_;
+};
+
+TEST_F(OptimizationResultCacheTest, KeysIgnoreNodeIds) {
+  OptimizationResultCache cache(temp_dir_->path());
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(auto other_ids, ParsePackage(kIrWithOtherIds));
+  XLS_ASSERT_OK_AND_ASSIGN(auto other_callee, ParsePackage(kIrWithOtherCallee));
+
+  EXPECT_EQ(Key(cache, p.get(), "f"), Key(cache, other_ids.get(), "f"));
+  EXPECT_EQ(Key(cache, p.get(), "g"), Key(cache, other_ids.get(), "g"));
+  EXPECT_NE(Key(cache, p.get(), "f"), Key(cache, p.get(), "g"));
+  EXPECT_NE(Key(cache, p.get(), "f"),
+            Key(cache, p.get(), "f", /*salt=*/"other salt"));
+  // The key of a function covers its callees.
+  EXPECT_NE(Key(cache, p.get(), "f"), Key(cache, other_callee.get(), "f"));
+}
+
+TEST_F(OptimizationResultCacheTest, StoreAndRestore) {
+  OptimizationResultCache cache(temp_dir_->path());
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("f"));
+  std::string key = Key(cache, p.get(), "f");
+  EXPECT_THAT(cache.Restore(f, key), IsOkAndHolds(false));
+  EXPECT_EQ(cache.miss_count(), 1);
+
+  // Store the body with the addition of zero removed.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, f->GetNode("add.7"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * zero, f->GetNode("literal.6"));
+  XLS_ASSERT_OK(add->ReplaceUsesWith(f->param(0)));
+  XLS_ASSERT_OK(f->RemoveNode(add));
+  XLS_ASSERT_OK(f->RemoveNode(zero));
+  cache.Store(f, key);
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto other, ParsePackage(kIrWithOtherIds));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_f, other->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_g, other->GetFunction("g"));
+  EXPECT_THAT(cache.Restore(other_f, Key(cache, other.get(), "f")),
+              IsOkAndHolds(true));
+  EXPECT_EQ(cache.hit_count(), 1);
+  EXPECT_EQ(other_f->node_count(), 3);
+  EXPECT_EQ(other->functions().size(), 2);
+  ASSERT_TRUE(other_f->return_value()->Is<Invoke>());
+  EXPECT_EQ(other_f->return_value()->As<Invoke>()->to_apply(), other_g);
+  EXPECT_THAT(DropInterpreterEvents(InterpretFunction(
+                  other_f, {Value(UBits(0x3c, 8)), Value(UBits(0x0f, 8))})),
+              IsOkAndHolds(Value(UBits(0x0c, 8))));
+}
+
+TEST_F(OptimizationResultCacheTest, PreInliningPassesReuseCachedBodies) {
+  OptimizationResultCache cache(temp_dir_->path());
+  PreInliningPassGroup pre_inlining(/*opt_level=*/2);
+  OptimizationPassOptions options;
+  options.result_cache = &cache;
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kIr));
+  XLS_ASSERT_OK(p->SetTopByName("f"));
+  PassResults results;
+  XLS_ASSERT_OK(pre_inlining.Run(p.get(), options, &results).status());
+  EXPECT_EQ(cache.hit_count(), 0);
+  EXPECT_EQ(cache.miss_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("f"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto other, ParsePackage(kIrWithOtherIds));
+  XLS_ASSERT_OK(other->SetTopByName("f"));
+  PassResults other_results;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool changed, pre_inlining.Run(other.get(), options, &other_results));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(cache.hit_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_f, other->GetFunction("f"));
+  EXPECT_EQ(other_f->node_count(), f->node_count());
+  EXPECT_THAT(DropInterpreterEvents(InterpretFunction(
+                  other_f, {Value(UBits(0x3c, 8)), Value(UBits(0x0f, 8))})),
+              IsOkAndHolds(Value(UBits(0x0c, 8))));
+}
+
+}  // namespace
+}  // namespace xls
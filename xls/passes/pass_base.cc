@@ -15,6 +15,7 @@
 #include "xls/passes/pass_base.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
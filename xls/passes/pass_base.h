@@ -37,6 +37,7 @@
 #include "xls/common/casts.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/package.h"
@@ -79,6 +80,23 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // Number of nodes in the IR before and after the pass ran.
+  int64_t node_count_before = 0;
+  int64_t node_count_after = 0;
+
+  // Transformation metrics accumulated by the pass.
+  TransformMetrics metrics;
+
+  // Peak resident memory of the process, in bytes, measured after the pass
+  // ran. This is a high-water mark so a pass which raises it is one which
+  // allocated more than any previous pass.
+  int64_t peak_memory_bytes = 0;
+
+  // Resident memory and, when linked with tcmalloc, heap allocation of the
+  // process after the pass ran.
+  int64_t rss_bytes = 0;
+  std::optional<int64_t> heap_allocated_bytes;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -385,10 +403,8 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
                                   pass->long_name(), pass->short_name(),
                                   results->invocations.size(), ir->name());
 
-    TransformMetrics before_metrics;
-    if (VLOG_IS_ON(1)) {
-      before_metrics = ir->transform_metrics();
-    }
+    TransformMetrics before_metrics = ir->transform_metrics();
+    int64_t node_count_before = ir->GetNodeCount();
 
     if (!pass->IsCompound() && options.bisect_limit &&
         results->invocations.size() >= options.bisect_limit) {
@@ -451,8 +467,17 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
       VLOG(1) << absl::StrFormat("Metrics: %s", pass_metrics.ToString());
     }
     if (!pass->IsCompound()) {
+      MemoryUsage memory_usage = GetMemoryUsage();
       results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+          {.pass_name = pass->short_name(),
+           .ir_changed = pass_changed,
+           .run_duration = duration,
+           .node_count_before = node_count_before,
+           .node_count_after = ir->GetNodeCount(),
+           .metrics = pass_metrics,
+           .peak_memory_bytes = memory_usage.peak_rss_bytes,
+           .rss_bytes = memory_usage.rss_bytes,
+           .heap_allocated_bytes = memory_usage.heap_allocated_bytes});
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
@@ -288,5 +288,35 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+
+TEST_F(PassBaseTest, InvocationsRecordNodeCountsAndMetrics) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f, fb.Build());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+  PassResults results;
+  EXPECT_THAT(opt.Run(p.get(), OptimizationPassOptions(), &results), IsOk());
+  EXPECT_EQ(f->node_count(), 1);
+  ASSERT_THAT(results.invocations, ElementsAre(LevelUpInvoke(), DceInvoke()));
+
+  const PassInvocation& level_up = results.invocations[0];
+  EXPECT_TRUE(level_up.ir_changed);
+  EXPECT_EQ(level_up.node_count_before, 1);
+  EXPECT_EQ(level_up.node_count_after, 2);
+  EXPECT_EQ(level_up.metrics.nodes_added, 1);
+  EXPECT_EQ(level_up.metrics.nodes_replaced, 1);
+  EXPECT_GT(level_up.peak_memory_bytes, 0);
+
+  const PassInvocation& dce = results.invocations[1];
+  EXPECT_TRUE(dce.ir_changed);
+  EXPECT_EQ(dce.node_count_before, 2);
+  EXPECT_EQ(dce.node_count_after, 1);
+  EXPECT_EQ(dce.metrics.nodes_removed, 1);
+  EXPECT_GE(dce.peak_memory_bytes, level_up.peak_memory_bytes);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,153 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/ir/block.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results) {
+  PassPipelineProfileProto profile;
+  absl::flat_hash_map<std::string, PassSummaryProfileProto> summaries;
+  std::vector<std::string> pass_names;
+  int64_t total_duration_us = 0;
+  int64_t peak_memory_bytes = 0;
+  for (const PassInvocation& invocation : results.invocations) {
+    int64_t duration_us = absl::ToInt64Microseconds(invocation.run_duration);
+    PassInvocationProfileProto* proto = profile.add_invocations();
+    proto->set_pass_name(invocation.pass_name);
+    proto->set_ir_changed(invocation.ir_changed);
+    proto->set_duration_us(duration_us);
+    proto->set_node_count_before(invocation.node_count_before);
+    proto->set_node_count_after(invocation.node_count_after);
+    proto->set_nodes_added(invocation.metrics.nodes_added);
+    proto->set_nodes_removed(invocation.metrics.nodes_removed);
+    proto->set_nodes_replaced(invocation.metrics.nodes_replaced);
+    proto->set_operands_replaced(invocation.metrics.operands_replaced);
+    proto->set_peak_memory_bytes(invocation.peak_memory_bytes);
+    proto->set_rss_bytes(invocation.rss_bytes);
+    if (invocation.heap_allocated_bytes.has_value()) {
+      proto->set_heap_allocated_bytes(*invocation.heap_allocated_bytes);
+    }
+
+    auto [it, inserted] = summaries.try_emplace(invocation.pass_name);
+    PassSummaryProfileProto& summary = it->second;
+    if (inserted) {
+      summary.set_pass_name(invocation.pass_name);
+      pass_names.push_back(invocation.pass_name);
+    }
+    summary.set_run_count(summary.run_count() + 1);
+    summary.set_changed_count(summary.changed_count() +
+                              (invocation.ir_changed ? 1 : 0));
+    summary.set_total_duration_us(summary.total_duration_us() + duration_us);
+    summary.set_node_count_delta(summary.node_count_delta() +
+                                 invocation.node_count_after -
+                                 invocation.node_count_before);
+    summary.set_nodes_added(summary.nodes_added() +
+                            invocation.metrics.nodes_added);
+    summary.set_nodes_removed(summary.nodes_removed() +
+                              invocation.metrics.nodes_removed);
+    summary.set_nodes_replaced(summary.nodes_replaced() +
+                               invocation.metrics.nodes_replaced);
+    summary.set_operands_replaced(summary.operands_replaced() +
+                                  invocation.metrics.operands_replaced);
+    // The first invocation has no earlier measurement to compare against so
+    // it is not charged with the memory used before the pipeline started.
+    if (peak_memory_bytes > 0 &&
+        invocation.peak_memory_bytes > peak_memory_bytes) {
+      summary.set_peak_memory_growth_bytes(
+          summary.peak_memory_growth_bytes() + invocation.peak_memory_bytes -
+          peak_memory_bytes);
+    }
+
+    total_duration_us += duration_us;
+    peak_memory_bytes = std::max(peak_memory_bytes,
+                                 invocation.peak_memory_bytes);
+  }
+
+  // Sort by decreasing total duration, breaking ties by name so the output is
+  // deterministic.
+  std::sort(pass_names.begin(), pass_names.end(),
+            [&](const std::string& a, const std::string& b) {
+              int64_t a_time = summaries.at(a).total_duration_us();
+              int64_t b_time = summaries.at(b).total_duration_us();
+              if (a_time != b_time) {
+                return a_time > b_time;
+              }
+              return a < b;
+            });
+  for (const std::string& name : pass_names) {
+    *profile.add_summaries() = std::move(summaries.at(name));
+  }
+  profile.set_total_duration_us(total_duration_us);
+  profile.set_peak_memory_bytes(peak_memory_bytes);
+  return profile;
+}
+
+void AddBlockSizesToProfile(const Package& package,
+                            PassPipelineProfileProto* profile) {
+  profile->clear_block_sizes();
+  for (const std::unique_ptr<Block>& block : package.blocks()) {
+    BlockSizeProfileProto* proto = profile->add_block_sizes();
+    proto->set_block_name(block->name());
+    proto->set_node_count(block->node_count());
+    proto->set_register_count(block->GetRegisters().size());
+    proto->set_instantiation_count(block->GetInstantiations().size());
+  }
+}
+
+std::string PassProfileToCsv(const PassPipelineProfileProto& profile) {
+  std::vector<const PassSummaryProfileProto*> summaries;
+  summaries.reserve(profile.summaries_size());
+  for (const PassSummaryProfileProto& summary : profile.summaries()) {
+    summaries.push_back(&summary);
+  }
+  std::sort(summaries.begin(), summaries.end(),
+            [](const PassSummaryProfileProto* a,
+               const PassSummaryProfileProto* b) {
+              return a->pass_name() < b->pass_name();
+            });
+
+  std::string csv =
+      "pass_name,run_count,changed_count,total_duration_us,node_count_delta,"
+      "nodes_added,nodes_removed,nodes_replaced,operands_replaced,"
+      "peak_memory_growth_bytes\n";
+  for (const PassSummaryProfileProto* summary : summaries) {
+    absl::StrAppendFormat(&csv, "%s,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+                          summary->pass_name(), summary->run_count(),
+                          summary->changed_count(),
+                          summary->total_duration_us(),
+                          summary->node_count_delta(), summary->nodes_added(),
+                          summary->nodes_removed(), summary->nodes_replaced(),
+                          summary->operands_replaced(),
+                          summary->peak_memory_growth_bytes());
+  }
+  return csv;
+}
+
+}  // namespace xls
@@ -0,0 +1,42 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_PROFILE_H_
+#define XLS_PASSES_PASS_PROFILE_H_
+
+#include <string>
+
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+// Converts the per-invocation statistics recorded in `results` into a profile
+// proto containing both the individual invocations and per-pass summaries.
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results);
+
+// Records the size of each block in `package` in `profile`, replacing any
+// block sizes already present.
+void AddBlockSizesToProfile(const Package& package,
+                            PassPipelineProfileProto* profile);
+
+// Returns the per-pass summaries of `profile` as CSV with a header row. Rows
+// are sorted by pass name so profiles from different compiler versions can be
+// diffed directly.
+std::string PassProfileToCsv(const PassPipelineProfileProto& profile);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_PROFILE_H_
@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+PassInvocation MakeInvocation(const char* name, bool changed, int64_t us,
+                              int64_t before, int64_t after, int64_t memory) {
+  return PassInvocation{.pass_name = name,
+                        .ir_changed = changed,
+                        .run_duration = absl::Microseconds(us),
+                        .node_count_before = before,
+                        .node_count_after = after,
+                        .metrics = TransformMetrics{.nodes_removed =
+                                                        before - after},
+                        .peak_memory_bytes = memory};
+}
+
+TEST(PassProfileTest, SummarizesInvocations) {
+  PassResults results;
+  results.invocations = {
+      MakeInvocation("dce", true, 10, 20, 15, 1000),
+      MakeInvocation("const_fold", false, 50, 15, 15, 1500),
+      MakeInvocation("dce", false, 5, 15, 15, 1500),
+      MakeInvocation("dce", true, 20, 15, 12, 4000),
+  };
+  PassPipelineProfileProto profile = PassResultsToProfileProto(results);
+
+  ASSERT_EQ(profile.invocations_size(), 4);
+  EXPECT_EQ(profile.invocations(0).pass_name(), "dce");
+  EXPECT_EQ(profile.invocations(0).nodes_removed(), 5);
+  EXPECT_EQ(profile.total_duration_us(), 85);
+  EXPECT_EQ(profile.peak_memory_bytes(), 4000);
+
+  ASSERT_EQ(profile.summaries_size(), 2);
+  const PassSummaryProfileProto& const_fold = profile.summaries(0);
+  EXPECT_EQ(const_fold.pass_name(), "const_fold");
+  EXPECT_EQ(const_fold.run_count(), 1);
+  EXPECT_EQ(const_fold.changed_count(), 0);
+  EXPECT_EQ(const_fold.peak_memory_growth_bytes(), 500);
+  const PassSummaryProfileProto& dce = profile.summaries(1);
+  EXPECT_EQ(dce.pass_name(), "dce");
+  EXPECT_EQ(dce.run_count(), 3);
+  EXPECT_EQ(dce.changed_count(), 2);
+  EXPECT_EQ(dce.total_duration_us(), 35);
+  EXPECT_EQ(dce.node_count_delta(), -8);
+  EXPECT_EQ(dce.nodes_removed(), 8);
+  EXPECT_EQ(dce.peak_memory_growth_bytes(), 2500);
+
+  EXPECT_EQ(PassProfileToCsv(profile),
+            "pass_name,run_count,changed_count,total_duration_us,"
+            "node_count_delta,nodes_added,nodes_removed,nodes_replaced,"
+            "operands_replaced,peak_memory_growth_bytes\n"
+            "const_fold,1,0,50,0,0,0,0,0,500\n"
+            "dce,3,2,35,-8,0,8,0,0,2500\n");
+}
+
+TEST(PassProfileTest, EmptyResults) {
+  PassPipelineProfileProto profile = PassResultsToProfileProto(PassResults());
+  EXPECT_EQ(profile.invocations_size(), 0);
+  EXPECT_EQ(profile.summaries_size(), 0);
+  EXPECT_EQ(profile.total_duration_us(), 0);
+}
+
+TEST(PassProfileTest, BlockSizes) {
+  Package p("p");
+  BlockBuilder bb("my_block", &p);
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p.GetBitsType(32));
+  BValue a_d = bb.InsertRegister("a_reg", a);
+  bb.OutputPort("out", bb.Add(a_d, bb.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK(bb.Build().status());
+
+  PassPipelineProfileProto profile;
+  AddBlockSizesToProfile(p, &profile);
+  // Adding again replaces rather than duplicates the sizes.
+  AddBlockSizesToProfile(p, &profile);
+  ASSERT_EQ(profile.block_sizes_size(), 1);
+  EXPECT_EQ(profile.block_sizes(0).block_name(), "my_block");
+  EXPECT_EQ(profile.block_sizes(0).node_count(),
+            p.GetBlock("my_block").value()->node_count());
+  EXPECT_EQ(profile.block_sizes(0).register_count(), 1);
+  EXPECT_EQ(profile.block_sizes(0).instantiation_count(), 0);
+}
+
+}  // namespace
+}  // namespace xls
@@ -16,53 +16,48 @@
 #define XLS_PASSES_POST_DOMINATOR_ANALYSIS_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
-#include "absl/types/span.h"
 #include "xls/ir/node.h"
+#include "xls/passes/dominator_tree.h"
 
 namespace xls {
 
 // A class for post-dominator analysis of the IR instructions in a function.
+//
+// The post-dominators are held as a tree so the analysis takes memory linear
+// in the size of the function, and queries of whether one node post-dominates
+// another take constant time.
 class PostDominatorAnalysis {
  public:
   // Performs post-dominator analysis on the function and returns the result.
   static absl::StatusOr<std::unique_ptr<PostDominatorAnalysis>> Run(
       FunctionBase* f);
 
-  // Returns the nodes that post-dominate this node.
-  absl::Span<Node* const> GetPostDominatorsOfNode(const Node* node) const {
-    return dominated_node_to_post_dominators_ordered_by_id_.at(node);
+  // Returns the nodes that post-dominate this node, ordered by id.
+  std::vector<Node*> GetPostDominatorsOfNode(const Node* node) const {
+    return tree_.DominatorsOf(node);
   }
-  // Returns the nodes that are post-dominated by this node.
-  absl::Span<Node* const> GetNodesPostDominatedByNode(const Node* node) const {
-    return post_dominator_to_dominated_nodes_ordered_by_id_.at(node);
+  // Returns the nodes that are post-dominated by this node, ordered by id.
+  std::vector<Node*> GetNodesPostDominatedByNode(const Node* node) const {
+    return tree_.NodesDominatedBy(node);
   }
   // Returns true if 'node' is post-dominated by 'post_dominator'.
   bool NodeIsPostDominatedBy(const Node* node,
                              const Node* post_dominator) const {
-    return dominated_node_to_post_dominators_.at(node).contains(post_dominator);
+    return tree_.Dominates(post_dominator, node);
   }
   // Returns true if 'node' post_dominates 'post_dominated'.
   bool NodePostDominates(const Node* node, const Node* post_dominated) const {
-    return post_dominator_to_dominated_nodes_.at(node).contains(post_dominated);
+    return tree_.Dominates(node, post_dominated);
   }
 
- private:
-  // Maps from a node to all nodes that post-dominate the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      dominated_node_to_post_dominators_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      dominated_node_to_post_dominators_ordered_by_id_;
+  explicit PostDominatorAnalysis(DominatorTree tree) : tree_(std::move(tree)) {}
 
-  // Maps from a node to all nodes that are post-dominated by the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      post_dominator_to_dominated_nodes_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      post_dominator_to_dominated_nodes_ordered_by_id_;
+ private:
+  DominatorTree tree_;
 };
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/passes/post_dominator_analysis.h"
 
+#include <cstdint>
 #include <memory>
 
 #include "gmock/gmock.h"
@@ -249,5 +250,31 @@ TEST_F(PostDominatorAnalysisTest, MultipleOutputs) {
               ElementsAre(y.node(), z.node()));
 }
 
+TEST_F(PostDominatorAnalysisTest, LongChainOfDiamonds) {
+  constexpr int64_t kDiamonds = 5000;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue first_not;
+  BValue prev = x;
+  for (int64_t i = 0; i < kDiamonds; ++i) {
+    BValue not_prev = fb.Not(prev);
+    if (i == 0) {
+      first_not = not_prev;
+    }
+    prev = fb.And(not_prev, fb.Negate(prev));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PostDominatorAnalysis> analysis,
+                           PostDominatorAnalysis::Run(f));
+
+  // `x` is post-dominated by itself and the `and` closing each diamond.
+  EXPECT_EQ(analysis->GetPostDominatorsOfNode(x.node()).size(), kDiamonds + 1);
+  EXPECT_EQ(analysis->GetNodesPostDominatedByNode(prev.node()).size(),
+            f->node_count());
+  EXPECT_TRUE(analysis->NodePostDominates(prev.node(), first_not.node()));
+  EXPECT_FALSE(analysis->NodePostDominates(first_not.node(), x.node()));
+}
+
 }  // namespace
 }  // namespace xls
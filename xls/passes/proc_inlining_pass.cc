@@ -15,6 +15,7 @@
 #include "xls/passes/proc_inlining_pass.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -38,6 +39,7 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
@@ -735,6 +737,63 @@ GetReceiveDataDependencies(Proc* inlined_proc) {
   return std::move(result);
 }
 
+// The analyses of a proc to inline which only read the proc. They are
+// computed for all of the procs, possibly concurrently, before any proc is
+// inlined into the container proc.
+struct ProcAnalysis {
+  std::vector<Node*> topo_sort;
+  std::vector<NodeAndPredecessors> token_graph;
+  absl::flat_hash_map<Receive*, std::vector<Node*>> receive_data_deps;
+};
+
+absl::StatusOr<ProcAnalysis> AnalyzeProc(Proc* proc) {
+  XLS_RETURN_IF_ERROR(VerifyTokenDependencies(proc));
+  ProcAnalysis analysis;
+  analysis.topo_sort = TopoSort(proc);
+  XLS_ASSIGN_OR_RETURN(analysis.token_graph, ComputeTopoSortedTokenDAG(proc));
+  XLS_ASSIGN_OR_RETURN(analysis.receive_data_deps,
+                       GetReceiveDataDependencies(proc));
+  return std::move(analysis);
+}
+
+// Analyzes each of `procs` using up to `thread_count` threads. The procs are
+// only read, so they may be analyzed concurrently. If any analysis fails the
+// error of the first such proc in `procs` is returned, as in serial execution.
+absl::StatusOr<std::vector<ProcAnalysis>> AnalyzeProcs(
+    absl::Span<Proc* const> procs, int64_t thread_count) {
+  std::vector<absl::StatusOr<ProcAnalysis>> analyses(procs.size());
+  if (thread_count <= 1 || procs.size() <= 1) {
+    for (int64_t i = 0; i < procs.size(); ++i) {
+      analyses[i] = AnalyzeProc(procs[i]);
+      XLS_RETURN_IF_ERROR(analyses[i].status());
+    }
+  } else {
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < procs.size();
+           i = next_index.fetch_add(1)) {
+        analyses[i] = AnalyzeProc(procs[i]);
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < std::min<int64_t>(thread_count, procs.size());
+         ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  std::vector<ProcAnalysis> result;
+  result.reserve(procs.size());
+  for (absl::StatusOr<ProcAnalysis>& analysis : analyses) {
+    XLS_ASSIGN_OR_RETURN(ProcAnalysis value, std::move(analysis));
+    result.push_back(std::move(value));
+  }
+  return std::move(result);
+}
+
 // Abstraction representing a proc thread. A proc thread contains the logic
 // required to virtually evaluate a proc (the "inlined proc") within another
 // proc (the "container proc"). An activation bit is threaded through the proc's
@@ -744,13 +803,15 @@ class ProcThread {
  public:
   // Creates and returns a proc thread which executes the given proc.
   // `container_proc` is the FunctionBase which will contain the proc thread.
+  // `analysis` is the analysis of `inlined_proc` and must outlive the proc
+  // thread.
   static absl::StatusOr<ProcThread> Create(Proc* inlined_proc,
-                                           Proc* container_proc) {
+                                           Proc* container_proc,
+                                           const ProcAnalysis* analysis) {
     ProcThread proc_thread;
     proc_thread.inlined_proc_ = inlined_proc;
     proc_thread.container_proc_ = container_proc;
-
-    XLS_RETURN_IF_ERROR(VerifyTokenDependencies(inlined_proc));
+    proc_thread.analysis_ = analysis;
 
     // Create the state element to hold the state of the inlined proc.
     for (int64_t i = 0; i < inlined_proc->GetStateElementCount(); ++i) {
@@ -821,8 +882,8 @@ class ProcThread {
   // source and sink nodes as well.
   absl::Status CreateActivationNetwork() {
     VLOG(3) << "CreateActivationNetwork " << inlined_proc_->name();
-    XLS_ASSIGN_OR_RETURN(std::vector<NodeAndPredecessors> token_graph,
-                         ComputeTopoSortedTokenDAG(inlined_proc_));
+    const std::vector<NodeAndPredecessors>& token_graph =
+        analysis_->token_graph;
     // Create the state element for the activation bit of the proc thread.
     XLS_ASSIGN_OR_RETURN(
         activation_state_,
@@ -980,9 +1041,8 @@ class ProcThread {
   // activation nodes.
   absl::StatusOr<absl::flat_hash_map<Receive*, std::vector<ActivationNode*>>>
   GetDataDependentActivationNodes() {
-    absl::flat_hash_map<Receive*, std::vector<Node*>> receive_data_deps;
-    XLS_ASSIGN_OR_RETURN(receive_data_deps,
-                         GetReceiveDataDependencies(inlined_proc_));
+    const absl::flat_hash_map<Receive*, std::vector<Node*>>&
+        receive_data_deps = analysis_->receive_data_deps;
 
     absl::flat_hash_set<Node*> next_state_nodes(
         inlined_proc_->NextState().begin(), inlined_proc_->NextState().end());
@@ -1357,6 +1417,9 @@ class ProcThread {
   // The proc whose logic which this proc thread evaluates.
   Proc* inlined_proc_;
 
+  // The analysis of `inlined_proc_`.
+  const ProcAnalysis* analysis_;
+
   // The actual proc in which this proc thread evaluates. The container proc may
   // simultaneously evaluate multiple proc threads.
   Proc* container_proc_;
@@ -1687,11 +1750,11 @@ absl::StatusOr<Node*> ProcThread::ConvertToActivatedReceive(
 // the activation chain. Newly created virtual send/receieves are inserted into
 // the `virtual_send` and `virtual_receive` maps.
 absl::StatusOr<ProcThread> InlineProcAsProcThread(
-    Proc* proc_to_inline, Proc* container_proc,
+    Proc* proc_to_inline, const ProcAnalysis& analysis, Proc* container_proc,
     absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels) {
-  auto topo_sort = TopoSort(proc_to_inline);
-  XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
-                       ProcThread::Create(proc_to_inline, container_proc));
+  XLS_ASSIGN_OR_RETURN(
+      ProcThread proc_thread,
+      ProcThread::Create(proc_to_inline, container_proc, &analysis));
   absl::flat_hash_map<Node*, Node*> node_map;
 
   auto clone_node = [&](Node* node) -> absl::StatusOr<Node*> {
@@ -1703,7 +1766,7 @@ absl::StatusOr<ProcThread> InlineProcAsProcThread(
   };
 
   std::vector<Node*> converted_clones;
-  for (Node* node : topo_sort) {
+  for (Node* node : analysis.topo_sort) {
     VLOG(3) << absl::StreamFormat("Inlining node %s", node->GetName());
     if (node->Is<Param>()) {
       // The dummy state value will later be replaced with an element from the
@@ -1858,16 +1921,24 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
     }
   }
 
+  // The procs to inline are only read until they are deleted, so they are
+  // analyzed up front, concurrently if requested. Building the proc threads
+  // mutates the container proc and stays serial.
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<ProcAnalysis> analyses,
+      AnalyzeProcs(procs_to_inline, options.function_pass_threads));
+
   std::vector<ProcThread> proc_threads;
 
   // Inline each proc into `container_proc`. Sends/receives are converted to
   // virtual send/receives.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
-  for (Proc* proc : procs_to_inline) {
-    XLS_ASSIGN_OR_RETURN(
-        ProcThread proc_thread,
-        InlineProcAsProcThread(proc, container_proc, virtual_channels));
+  for (int64_t i = 0; i < procs_to_inline.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
+                         InlineProcAsProcThread(procs_to_inline[i],
+                                                analyses[i], container_proc,
+                                                virtual_channels));
     proc_threads.push_back(std::move(proc_thread));
   }
 
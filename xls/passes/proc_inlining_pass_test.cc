@@ -28,6 +28,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -80,6 +81,39 @@ FifoConfig FifoConfigWithDepth(int64_t depth) {
                     /*register_pop_outputs=*/false);
 }
 
+// Makes a pipeline of `stage_count` procs, each of which receives a value
+// from the previous stage and sends it incremented to the next. The first
+// stage receives on `in` and is the top, the last sends on `out`.
+absl::Status MakeProcPipeline(Package* p, int64_t stage_count) {
+  Type* u32 = p->GetBitsType(32);
+  XLS_ASSIGN_OR_RETURN(
+      Channel * in,
+      p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  for (int64_t i = 0; i < stage_count; ++i) {
+    Channel* out;
+    if (i == stage_count - 1) {
+      XLS_ASSIGN_OR_RETURN(
+          out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          out, p->CreateStreamingChannel(
+                   absl::StrFormat("stage%d_out", i), ChannelOps::kSendReceive,
+                   u32, /*initial_values=*/{},
+                   /*fifo_config=*/FifoConfigWithDepth(1)));
+    }
+    ProcBuilder b(absl::StrFormat("stage%d", i), p);
+    BValue rcv = b.Receive(in, b.Literal(Value::Token()));
+    b.Send(out, b.TupleIndex(rcv, 0),
+           b.Add(b.TupleIndex(rcv, 1), b.Literal(UBits(1, 32))));
+    XLS_ASSIGN_OR_RETURN(Proc * proc, b.Build());
+    if (i == 0) {
+      XLS_RETURN_IF_ERROR(p->SetTop(proc));
+    }
+    in = out;
+  }
+  return absl::OkStatus();
+}
+
 class ProcInliningPassTest : public IrTestBase {
  protected:
   ProcInliningPassTest() = default;
@@ -4180,5 +4214,50 @@ proc input_passthrough(__state: (), init={()}) {
           .status());
 }
 
+TEST_F(ProcInliningPassTest, ProcPipelineAnalyzedInParallel) {
+  auto serial = CreatePackage();
+  XLS_ASSERT_OK(MakeProcPipeline(serial.get(), 8));
+  auto parallel = CreatePackage();
+  XLS_ASSERT_OK(MakeProcPipeline(parallel.get(), 8));
+
+  OptimizationPassOptions options;
+  options.inline_procs = true;
+  PassResults results;
+  EXPECT_THAT(ProcInliningPass().Run(serial.get(), options, &results),
+              IsOkAndHolds(true));
+  options.function_pass_threads = 4;
+  EXPECT_THAT(ProcInliningPass().Run(parallel.get(), options, &results),
+              IsOkAndHolds(true));
+
+  // Concurrent analysis produces exactly the IR of serial inlining.
+  EXPECT_EQ(parallel->DumpIr(), serial->DumpIr());
+  EXPECT_EQ(parallel->procs().size(), 1);
+  XLS_EXPECT_OK(EvalAndExpect(parallel.get(), {{"in", {1, 2, 3}}},
+                              {{"out", {9, 10, 11}}})
+                    .status());
+}
+
+// Measures the scaling of proc inlining with the number of procs in a
+// pipeline, analyzing the procs on the given number of threads.
+void BM_InlineProcPipeline(benchmark::State& state) {
+  const int64_t stage_count = state.range(0);
+  OptimizationPassOptions options;
+  options.inline_procs = true;
+  options.function_pass_threads = state.range(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    Package p("bm_test");
+    XLS_ASSERT_OK(MakeProcPipeline(&p, stage_count));
+    state.ResumeTiming();
+    PassResults results;
+    XLS_ASSERT_OK(ProcInliningPass().Run(&p, options, &results).status());
+  }
+  state.SetComplexityN(stage_count);
+}
+
+BENCHMARK(BM_InlineProcPipeline)
+    ->ArgsProduct({{8, 32, 128, 512}, {1, 8}})
+    ->Complexity();
+
 }  // namespace
 }  // namespace xls
@@ -560,7 +560,7 @@ absl::StatusOr<bool> ProcStateOptimizationPass::RunOnProcInternal(
 
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  query_engines.push_back(std::make_unique<LazyTernaryQueryEngine>());
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
 
@@ -0,0 +1,76 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/union_query_engine.h"
+
+namespace xls {
+namespace {
+
+// Forwards queries to a cached incremental ternary engine. The first Populate
+// discards what earlier users merged into the cached engine so that a pass
+// sees the same results as with a TernaryQueryEngine of its own.
+class CachedTernaryQueryEngine : public UnownedUnionQueryEngine {
+ public:
+  explicit CachedTernaryQueryEngine(IncrementalTernaryQueryEngine* engine)
+      : UnownedUnionQueryEngine({engine}), engine_(engine) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    if (!populated_) {
+      populated_ = true;
+      XLS_RETURN_IF_ERROR(engine_->ResetAndPopulate(f));
+      return ReachedFixpoint::Unchanged;
+    }
+    return UnownedUnionQueryEngine::Populate(f);
+  }
+
+ private:
+  IncrementalTernaryQueryEngine* engine_;
+  bool populated_ = false;
+};
+
+}  // namespace
+
+IncrementalTernaryQueryEngine* QueryEngineCache::GetTernaryQueryEngine(
+    FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<IncrementalTernaryQueryEngine>& engine = ternary_engines_[f];
+  // An engine whose function base was destroyed may be keyed by an address
+  // which has since been reused.
+  if (engine == nullptr || engine->function_base() != f) {
+    engine = std::make_unique<IncrementalTernaryQueryEngine>(f);
+  }
+  return engine.get();
+}
+
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(
+    FunctionBase* f, const OptimizationPassOptions& options) {
+  if (options.query_engine_cache == nullptr) {
+    return std::make_unique<TernaryQueryEngine>();
+  }
+  return std::make_unique<CachedTernaryQueryEngine>(
+      options.query_engine_cache->GetTernaryQueryEngine(f));
+}
+
+}  // namespace xls
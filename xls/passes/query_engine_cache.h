@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+// A package-scoped cache of query engine results shared by the passes of an
+// optimization pipeline. Instead of each pass evaluating the whole function
+// base from scratch, the cached engines are notified of every change to the IR
+// and only re-evaluate the fanout of changed nodes when next populated.
+//
+// Passes obtain engines through the Make*QueryEngine helpers below, which fall
+// back to a fresh engine when no cache is set in the pass options. The cache
+// must outlive the passes using it; it may be destroyed before or after the
+// package. Engines for different function bases may be requested concurrently.
+class QueryEngineCache {
+ public:
+  QueryEngineCache() = default;
+  QueryEngineCache(const QueryEngineCache&) = delete;
+  QueryEngineCache& operator=(const QueryEngineCache&) = delete;
+
+  // Returns the incrementally maintained ternary query engine for `f`,
+  // creating it if necessary.
+  IncrementalTernaryQueryEngine* GetTernaryQueryEngine(FunctionBase* f);
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<FunctionBase*,
+                      std::unique_ptr<IncrementalTernaryQueryEngine>>
+      ternary_engines_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns a ternary query engine for a pass running on `f`. If
+// `options.query_engine_cache` is set the engine is backed by the cached
+// engine for `f`; the first call to its Populate gives exactly the results of
+// a freshly populated TernaryQueryEngine and later calls merge as
+// TernaryQueryEngine does. Otherwise a new TernaryQueryEngine is returned.
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(
+    FunctionBase* f, const OptimizationPassOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
@@ -0,0 +1,86 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+class QueryEngineCacheTest : public IrTestBase {};
+
+TEST_F(QueryEngineCacheTest, SharesEngineAcrossPasses) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0xf0, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &cache;
+  IncrementalTernaryQueryEngine* cached = cache.GetTernaryQueryEngine(f);
+  EXPECT_EQ(cache.GetTernaryQueryEngine(f), cached);
+
+  std::unique_ptr<QueryEngine> first = MakeTernaryQueryEngine(f, options);
+  XLS_ASSERT_OK(first->Populate(f).status());
+  EXPECT_EQ(first->ToString(masked.node()), "0bXXXX_0000");
+  EXPECT_EQ(cached->dirty_node_count(), 0);
+
+  // A later pass changes one operand; only the changed nodes are stale.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * new_mask,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(0x0f, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+  EXPECT_EQ(cached->dirty_node_count(), 2);
+
+  std::unique_ptr<QueryEngine> second = MakeTernaryQueryEngine(f, options);
+  XLS_ASSERT_OK(second->Populate(f).status());
+  TernaryQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f).status());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(second->ToString(node), fresh.ToString(node)) << node;
+  }
+  EXPECT_EQ(second->ToString(masked.node()), "0b0000_XXXX");
+}
+
+TEST_F(QueryEngineCacheTest, NoCacheGivesFreshEngine) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue out = fb.Not(fb.Literal(UBits(0b1010, 4)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::unique_ptr<QueryEngine> engine =
+      MakeTernaryQueryEngine(f, OptimizationPassOptions());
+  XLS_ASSERT_OK(engine->Populate(f).status());
+  EXPECT_EQ(engine->ToString(out.node()), "0b0101");
+}
+
+}  // namespace
+}  // namespace xls
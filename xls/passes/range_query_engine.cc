@@ -317,6 +317,7 @@ void RangeQueryEngine::SetIntervalSetTree(
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  InternIntervalSets(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -339,6 +340,7 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  InternIntervalSets(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -348,6 +350,13 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
   }
 }
 
+void RangeQueryEngine::InternIntervalSets(MutableIntervalSetTreeView tree) {
+  for (IntervalSet& set : tree.elements()) {
+    set.Normalize();
+    set = interner_.Intern(std::move(set));
+  }
+}
+
 void RangeQueryEngine::InitializeNode(Node* node) {
   if (!known_bits_.contains(node) || !known_bit_values_.contains(node)) {
     known_bits_[node] = Bits(node->GetType()->GetFlatBitCount());
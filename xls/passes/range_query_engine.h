@@ -238,9 +238,15 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
+  // Makes the sets of `tree` share storage with equal sets of other nodes.
+  void InternIntervalSets(MutableIntervalSetTreeView tree);
+
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
   absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // Most nodes of a function have one of a few distinct ranges (e.g. maximal),
+  // so the sets in `interval_sets_` are interned to share their storage.
+  IntervalSetInterner interner_;
 };
 
 std::string IntervalSetTreeToString(const IntervalSetTree& tree);
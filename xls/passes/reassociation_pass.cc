@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -92,6 +93,9 @@ bool IsFullWidthAddition(Node* n) {
 //   leaves = {{false, a}, {false, b}, {true, c}, {false, d}, {true, e}}
 //
 // The expression is equivalently: a + b + (-c) + d + (-e)
+//
+// The expression is walked iteratively, in the same order as a recursive
+// left-to-right traversal, so arbitrarily deep chains do not exhaust the stack.
 struct AddSubLeaf {
   bool negated;
   Node* node;
@@ -99,23 +103,26 @@ struct AddSubLeaf {
 absl::Status GatherAddsAndSubtracts(Node* node, bool negated,
                                     std::vector<AddSubLeaf>* leaves,
                                     std::vector<Node*>* interior_nodes) {
-  if ((node->op() != Op::kAdd && node->op() != Op::kSub) ||
-      !NodeAndOperandsSameType(node)) {
-    // 'node' is not an add or subtract or has differently typed operads.
-    leaves->push_back(AddSubLeaf{negated, node});
-    return absl::OkStatus();
-  }
+  std::vector<AddSubLeaf> stack = {AddSubLeaf{negated, node}};
+  while (!stack.empty()) {
+    AddSubLeaf current = stack.back();
+    stack.pop_back();
+    if ((current.node->op() != Op::kAdd && current.node->op() != Op::kSub) ||
+        !NodeAndOperandsSameType(current.node)) {
+      // 'node' is not an add or subtract or has differently typed operads.
+      leaves->push_back(current);
+      continue;
+    }
 
-  interior_nodes->push_back(node);
+    interior_nodes->push_back(current.node);
 
-  XLS_RET_CHECK_EQ(node->operand_count(), 2);
-  for (int64_t operand_no = 0; operand_no < 2; ++operand_no) {
-    Node* operand = node->operand(operand_no);
-    // Subtraction negates it's second operand (operand number 1).
-    bool negated_next =
-        (operand_no == 1 && node->op() == Op::kSub) ? !negated : negated;
-    XLS_RETURN_IF_ERROR(
-        GatherAddsAndSubtracts(operand, negated_next, leaves, interior_nodes));
+    XLS_RET_CHECK_EQ(current.node->operand_count(), 2);
+    // Subtraction negates it's second operand (operand number 1). Operands are
+    // pushed in reverse so the first operand is visited first.
+    stack.push_back(AddSubLeaf{
+        current.node->op() == Op::kSub ? !current.negated : current.negated,
+        current.node->operand(1)});
+    stack.push_back(AddSubLeaf{current.negated, current.node->operand(0)});
   }
   return absl::OkStatus();
 }
@@ -132,12 +139,14 @@ absl::Status GatherAddsAndSubtracts(Node* node, bool negated,
 // TODO(meheff): 2021-01-27 Use n-ary adds when they are supported.
 absl::StatusOr<Node*> CreateSum(absl::Span<Node* const> nodes) {
   XLS_RET_CHECK(!nodes.empty());
-  if (nodes.size() == 1) {
-    return nodes.front();
+  // Build the tree from the right so deep chains need no recursion.
+  Node* sum = nodes.back();
+  for (int64_t i = nodes.size() - 2; i >= 0; --i) {
+    Node* lhs = nodes[i];
+    XLS_ASSIGN_OR_RETURN(sum, lhs->function_base()->MakeNode<BinOp>(
+                                  lhs->loc(), lhs, sum, Op::kAdd));
   }
-  Node* lhs = nodes.front();
-  XLS_ASSIGN_OR_RETURN(Node * rhs, CreateSum(nodes.subspan(1)));
-  return lhs->function_base()->MakeNode<BinOp>(lhs->loc(), lhs, rhs, Op::kAdd);
+  return sum;
 }
 
 // Attempts to simplify expressions containing adds and subtracts using
@@ -276,6 +285,57 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f,
   return changed;
 }
 
+// The node reached through an operand of an interior node of an expression
+// tree, and whether it may itself be an interior node.
+struct TreeEdge {
+  Node* node;
+  bool expandable;
+};
+
+// Linearizes the expression tree rooted at `root` in a single walk, appending
+// its leaves in left-to-right order to `leaves` and its interior nodes in
+// pre-order to `interior_nodes`. `is_interior` returns whether a node is an
+// operation of the tree and `edge` gives the node reached through an operand of
+// an interior node. Returns the height of the tree, i.e., the largest number of
+// interior nodes on a path from the root.
+//
+// The walk uses an explicit stack holding the depth of each pending node, so
+// the wide, deep reduction trees of DSP designs (10k+ operands) need neither
+// recursion nor a second pass to compute the height.
+int64_t LinearizeTree(Node* root, absl::FunctionRef<bool(Node*)> is_interior,
+                      absl::FunctionRef<TreeEdge(Node*)> edge,
+                      std::vector<Node*>* leaves,
+                      std::vector<Node*>* interior_nodes) {
+  struct Pending {
+    Node* node;
+    bool expandable;
+    // Number of interior nodes on the path from the root to this node if it is
+    // an interior node.
+    int64_t depth;
+  };
+  int64_t height = 0;
+  std::vector<Pending> stack = {
+      Pending{.node = root, .expandable = true, .depth = 1}};
+  while (!stack.empty()) {
+    Pending current = stack.back();
+    stack.pop_back();
+    if (!current.expandable || !is_interior(current.node)) {
+      leaves->push_back(current.node);
+      continue;
+    }
+    interior_nodes->push_back(current.node);
+    height = std::max(height, current.depth);
+    // Push the operands in reverse so they are visited left to right.
+    for (int64_t i = current.node->operand_count() - 1; i >= 0; --i) {
+      TreeEdge next = edge(current.node->operand(i));
+      stack.push_back(Pending{.node = next.node,
+                              .expandable = next.expandable,
+                              .depth = current.depth + 1});
+    }
+  }
+  return height;
+}
+
 // Walks an expression tree of full-width additions using the given
 // `extension_op`. 'node' is the node currently being visited.  The leaves of
 // the expression tree are added to 'leaves', and the interior nodes of the tree
@@ -309,29 +369,24 @@ absl::StatusOr<bool> ReassociateSubtracts(FunctionBase* f,
 int64_t GatherFullWidthAdditionLeaves(Op extension_op, Node* node,
                                       std::vector<Node*>* leaves,
                                       std::vector<Node*>* interior_nodes) {
-  if (!IsFullWidthAddition(node) || node->operand(0)->op() != extension_op) {
-    // 'node' is not a full-width addition of the same type and is therefore a
-    // leaf.
-    leaves->push_back(node);
-    return 0;
-  }
-  // 'node' could be an interior node in the tree of full-width additions.
-  // Traverse into the operands if the operand & its extension are both
-  // single-use; otherwise the operand is a leaf.
-  interior_nodes->push_back(node);
-  int64_t max_depth = 1;
-  for (Node* extension : node->operands()) {
-    Node* operand = extension->operand(0);
-    // TODO(meheff): 2021-01-27 Consider handling cases with more than one user.
-    if (HasSingleUse(extension) && HasSingleUse(operand)) {
-      max_depth = std::max(
-          max_depth, 1 + GatherFullWidthAdditionLeaves(extension_op, operand,
-                                                       leaves, interior_nodes));
-    } else {
-      leaves->push_back(operand);
-    }
-  }
-  return max_depth;
+  return LinearizeTree(
+      node,
+      [&](Node* n) {
+        // Nodes which are not full-width additions of the same type are
+        // leaves.
+        return IsFullWidthAddition(n) && n->operand(0)->op() == extension_op;
+      },
+      [](Node* extension) {
+        // Traverse into the operands if the operand & its extension are both
+        // single-use; otherwise the operand is a leaf.
+        // TODO(meheff): 2021-01-27 Consider handling cases with more than one
+        // user.
+        Node* operand = extension->operand(0);
+        return TreeEdge{.node = operand,
+                        .expandable = HasSingleUse(extension) &&
+                                      HasSingleUse(operand)};
+      },
+      leaves, interior_nodes);
 }
 
 // Walks an expression tree of operations with the given op and bit
@@ -356,27 +411,20 @@ int64_t GatherFullWidthAdditionLeaves(Op extension_op, Node* node,
 // leaves).
 int64_t GatherExpressionLeaves(Op op, Node* node, std::vector<Node*>* leaves,
                                std::vector<Node*>* interior_nodes) {
-  if (node->op() != op || !NodeAndOperandsSameType(node)) {
-    // 'node' does not match the other nodes of the tree and is thus a leaf.
-    leaves->push_back(node);
-    return 0;
-  }
-  // 'node' is an interior node in the tree of identical operations. Traverse
-  // into the operands if the operand has a single use, otherwise the operand is
-  // a leaf.
-  interior_nodes->push_back(node);
-  int64_t max_depth = 1;
-  for (Node* operand : node->operands()) {
-    // TODO(meheff): 2021-01-27 Consider handling cases with more than one user.
-    if (HasSingleUse(operand)) {
-      max_depth = std::max(
-          max_depth,
-          1 + GatherExpressionLeaves(op, operand, leaves, interior_nodes));
-    } else {
-      leaves->push_back(operand);
-    }
-  }
-  return max_depth;
+  return LinearizeTree(
+      node,
+      [&](Node* n) {
+        // Nodes which do not match the other nodes of the tree are leaves.
+        return n->op() == op && NodeAndOperandsSameType(n);
+      },
+      [](Node* operand) {
+        // Traverse into the operands if the operand has a single use,
+        // otherwise the operand is a leaf.
+        // TODO(meheff): 2021-01-27 Consider handling cases with more than one
+        // user.
+        return TreeEdge{.node = operand, .expandable = HasSingleUse(operand)};
+      },
+      leaves, interior_nodes);
 }
 
 // Reassociate associative and commutative operations to minimize delay and
@@ -33,6 +33,8 @@ class ReassociationPass : public OptimizationFunctionBasePass {
   ReassociationPass() : OptimizationFunctionBasePass(kName, "Reassociation") {}
   ~ReassociationPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -14,19 +14,29 @@
 
 #include "xls/passes/reassociation_pass.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -415,5 +425,96 @@ TEST_F(ReassociationPassTest, SubOfSub) {
               m::Sub(m::Add(m::Param("x"), m::Param("z")), m::Param("y")));
 }
 
+// Returns the number of adds on the longest path from `node` to a non-add.
+int64_t AddTreeHeight(Node* node) {
+  absl::flat_hash_map<Node*, int64_t> heights;
+  for (Node* n : TopoSort(node->function_base())) {
+    int64_t height = 0;
+    if (n->op() == Op::kAdd) {
+      for (Node* operand : n->operands()) {
+        height = std::max(height, heights.at(operand) + 1);
+      }
+      height = std::max<int64_t>(height, 1);
+    }
+    heights[n] = height;
+  }
+  return heights.at(node);
+}
+
+// Builds a left-leaning chain of `count` - 1 operations over `count` u32
+// parameters. Every `sub_period`-th operation is a subtract if positive.
+absl::StatusOr<Function*> BuildChain(Package* p, int64_t count,
+                                     int64_t sub_period = 0) {
+  FunctionBuilder fb("chain", p);
+  Type* u32 = p->GetBitsType(32);
+  BValue chain = fb.Param("x0", u32);
+  for (int64_t i = 1; i < count; ++i) {
+    BValue x = fb.Param(absl::StrFormat("x%d", i), u32);
+    chain = sub_period > 0 && i % sub_period == 0 ? fb.Subtract(chain, x)
+                                                  : fb.Add(chain, x);
+  }
+  return fb.BuildWithReturnValue(chain);
+}
+
+TEST_F(ReassociationPassTest, VeryDeepChainOfAdds) {
+  // Deep enough that a recursive walk of the chain would risk exhausting the
+  // stack.
+  constexpr int64_t kCount = 50000;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChain(p.get(), kCount));
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(AddTreeHeight(f->return_value()), CeilOfLog2(kCount));
+}
+
+TEST_F(ReassociationPassTest, VeryDeepChainOfAddsAndSubtracts) {
+  constexpr int64_t kCount = 50000;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           BuildChain(p.get(), kCount, /*sub_period=*/2));
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Sub(m::Add(), m::Add()));
+  EXPECT_EQ(AddTreeHeight(f->return_value()->operand(0)),
+            CeilOfLog2(kCount / 2));
+  EXPECT_EQ(AddTreeHeight(f->return_value()->operand(1)),
+            CeilOfLog2(kCount / 2));
+}
+
+// Reassociates a left-leaning reduction chain into a balanced tree. With
+// `sub_period` > 0 the chain mixes in subtracts, which are first gathered into
+// a single subtraction of two sums.
+void BM_ReassociateChain(benchmark::State& state, int64_t sub_period) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto p = std::make_unique<Package>("chain_pkg");
+    CHECK_OK(BuildChain(p.get(), state.range(0), sub_period).status());
+    PassResults results;
+    state.ResumeTiming();
+    CHECK_OK(ReassociationPass()
+                 .Run(p.get(), OptimizationPassOptions(), &results)
+                 .status());
+    state.PauseTiming();
+    p.reset();
+    state.ResumeTiming();
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_ReassociateAddChain(benchmark::State& state) {
+  BM_ReassociateChain(state, /*sub_period=*/0);
+}
+
+void BM_ReassociateAddSubChain(benchmark::State& state) {
+  BM_ReassociateChain(state, /*sub_period=*/2);
+}
+
+BENCHMARK(BM_ReassociateAddChain)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384)
+    ->Complexity(benchmark::oN);
+BENCHMARK(BM_ReassociateAddSubChain)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384)
+    ->Complexity(benchmark::oN);
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,70 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_rule_set.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+std::atomic<bool> rewrite_rule_indexing = true;
+
+}  // namespace
+
+void SetRewriteRuleIndexing(bool enabled) { rewrite_rule_indexing = enabled; }
+
+bool GetRewriteRuleIndexing() { return rewrite_rule_indexing; }
+
+void RewriteRuleSet::Add(RewriteRule rule) {
+  rules_.push_back(std::make_unique<RewriteRule>(std::move(rule)));
+  const RewriteRule* added = rules_.back().get();
+  for (Op op : added->root_ops) {
+    std::vector<const RewriteRule*>& rules =
+        rules_by_op_[static_cast<int64_t>(op)];
+    if (!absl::c_linear_search(rules, added)) {
+      rules.push_back(added);
+    }
+  }
+}
+
+absl::StatusOr<bool> RewriteRuleSet::Apply(Node* node) const {
+  if (rewrite_rule_indexing.load(std::memory_order_relaxed)) {
+    for (const RewriteRule* rule : RulesFor(node->op())) {
+      XLS_ASSIGN_OR_RETURN(bool changed, rule->rewrite(node));
+      if (changed) {
+        return true;
+      }
+    }
+    return false;
+  }
+  for (const std::unique_ptr<RewriteRule>& rule : rules_) {
+    XLS_ASSIGN_OR_RETURN(bool changed, rule->rewrite(node));
+    if (changed) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace xls
@@ -0,0 +1,86 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_REWRITE_RULE_SET_H_
+#define XLS_PASSES_REWRITE_RULE_SET_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+// A single local rewrite of the IR rooted at a node. `rewrite` is only invoked
+// on nodes whose op is one of `root_ops` and returns true if it changed the
+// IR (typically by replacing the uses of the node).
+struct RewriteRule {
+  std::string name;
+  std::vector<Op> root_ops;
+  std::function<absl::StatusOr<bool>(Node*)> rewrite;
+};
+
+// A set of rewrite rules indexed by the op of the node they are rooted at, so
+// that applying the set to a node only tries the rules which can match it
+// instead of testing the node against every pattern in turn. Intended to be
+// used as the node simplifier of TransformNodesToFixedPoint.
+class RewriteRuleSet {
+ public:
+  RewriteRuleSet() = default;
+
+  // Movable but not copyable; the op index points into `rules_`.
+  RewriteRuleSet(RewriteRuleSet&&) = default;
+  RewriteRuleSet& operator=(RewriteRuleSet&&) = default;
+  RewriteRuleSet(const RewriteRuleSet&) = delete;
+  RewriteRuleSet& operator=(const RewriteRuleSet&) = delete;
+
+  // Adds a rule. Rules rooted at the same op are tried in the order they were
+  // added.
+  void Add(RewriteRule rule);
+
+  // Tries the rules whose root ops include the op of `node` in order and
+  // returns true as soon as one changes the IR. Returns false if no rule
+  // applies.
+  absl::StatusOr<bool> Apply(Node* node) const;
+
+  // Returns the rules rooted at `op`, in the order they are tried.
+  absl::Span<const RewriteRule* const> RulesFor(Op op) const {
+    return rules_by_op_[static_cast<int64_t>(op)];
+  }
+
+  int64_t size() const { return rules_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<RewriteRule>> rules_;
+  std::array<std::vector<const RewriteRule*>, kAllOps.size()> rules_by_op_;
+};
+
+// Sets whether RewriteRuleSet::Apply dispatches on the op of the node (the
+// default). When disabled every rule is tried on every node in the order
+// added, reproducing the cost of a chain of hand-written matchers. This is
+// only correct for rules which check the op of the node themselves and exists
+// to benchmark the index.
+void SetRewriteRuleIndexing(bool enabled);
+bool GetRewriteRuleIndexing();
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_REWRITE_RULE_SET_H_
@@ -0,0 +1,137 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_rule_set.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class RewriteRuleSetTest : public IrTestBase {};
+
+// Returns a rule replacing `not(not(x))` with `x`, recording the nodes it is
+// invoked on in `visited`.
+RewriteRule DoubleNotRule(std::vector<std::string>* visited) {
+  return RewriteRule{
+      .name = "double_not",
+      .root_ops = {Op::kNot},
+      .rewrite = [visited](Node* n) -> absl::StatusOr<bool> {
+        visited->push_back("double_not");
+        if (n->operand(0)->op() != Op::kNot) {
+          return false;
+        }
+        XLS_RETURN_IF_ERROR(n->ReplaceUsesWith(n->operand(0)->operand(0)));
+        return true;
+      }};
+}
+
+// Returns a rule which never matches but records the nodes it is tried on.
+RewriteRule NeverRule(std::string name, std::vector<Op> root_ops,
+                      std::vector<std::string>* visited) {
+  return RewriteRule{
+      .name = name,
+      .root_ops = std::move(root_ops),
+      .rewrite = [visited, name](Node* n) -> absl::StatusOr<bool> {
+        visited->push_back(name);
+        return false;
+      }};
+}
+
+TEST_F(RewriteRuleSetTest, OnlyTriesRulesForTheOpOfTheNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue sum = fb.Add(x, x);
+  BValue inverted = fb.Not(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<std::string> visited;
+  RewriteRuleSet rules;
+  rules.Add(NeverRule("add_or_not", {Op::kAdd, Op::kNot}, &visited));
+  rules.Add(NeverRule("sub", {Op::kSub}, &visited));
+  rules.Add(DoubleNotRule(&visited));
+  EXPECT_EQ(rules.size(), 3);
+  EXPECT_THAT(rules.RulesFor(Op::kUMul), IsEmpty());
+  EXPECT_EQ(rules.RulesFor(Op::kNot).size(), 2);
+
+  EXPECT_THAT(rules.Apply(x.node()), IsOkAndHolds(false));
+  EXPECT_THAT(visited, IsEmpty());
+  EXPECT_THAT(rules.Apply(sum.node()), IsOkAndHolds(false));
+  EXPECT_THAT(visited, ElementsAre("add_or_not"));
+  visited.clear();
+  EXPECT_THAT(rules.Apply(inverted.node()), IsOkAndHolds(false));
+  EXPECT_THAT(visited, ElementsAre("add_or_not", "double_not"));
+  EXPECT_EQ(f->return_value(), inverted.node());
+}
+
+TEST_F(RewriteRuleSetTest, UnindexedTriesEveryRule) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Not(fb.Not(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<std::string> visited;
+  RewriteRuleSet rules;
+  rules.Add(NeverRule("add", {Op::kAdd}, &visited));
+  rules.Add(DoubleNotRule(&visited));
+  SetRewriteRuleIndexing(false);
+  EXPECT_THAT(rules.Apply(f->return_value()), IsOkAndHolds(true));
+  SetRewriteRuleIndexing(true);
+  EXPECT_THAT(visited, ElementsAre("add", "double_not"));
+  EXPECT_THAT(f->return_value(), m::Param("x"));
+}
+
+TEST_F(RewriteRuleSetTest, StopsAtFirstRuleWhichChangesTheIr) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Not(fb.Not(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<std::string> visited;
+  RewriteRuleSet rules;
+  rules.Add(DoubleNotRule(&visited));
+  rules.Add(NeverRule("after", {Op::kNot}, &visited));
+  EXPECT_THAT(rules.Apply(f->return_value()), IsOkAndHolds(true));
+  EXPECT_THAT(visited, ElementsAre("double_not"));
+  EXPECT_THAT(f->return_value(), m::Param("x"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -35,6 +35,8 @@ class SparsifySelectPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Sparsify Select") {}
   ~SparsifySelectPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   // Sparsify selects using range analysis.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -35,6 +35,8 @@ class StrengthReductionPass : public OptimizationFunctionBasePass {
         opt_level_(opt_level) {}
   ~StrengthReductionPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   int64_t opt_level_;
 
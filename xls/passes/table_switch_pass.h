@@ -42,6 +42,8 @@ class TableSwitchPass : public OptimizationFunctionBasePass {
   TableSwitchPass()
       : OptimizationFunctionBasePass(kName, "Table switch conversion") {}
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
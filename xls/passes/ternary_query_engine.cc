@@ -18,6 +18,8 @@
 #include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -35,6 +37,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/packed_ternary.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
@@ -120,7 +123,12 @@ bool IsExpensiveToEvaluate(
   // data-types.
   static constexpr int64_t kCompoundDataTypeSizeLimit = 65536;
   // Shifts are quadratic in the width of the operand so wide shifts are very
-  // slow to evaluate in the abstract evaluator.
+  // slow to evaluate in the abstract evaluator. Logical shifts by a known
+  // amount are evaluated on packed words and are cheap at any width.
+  if (node->OpIn({Op::kShrl, Op::kShll}) &&
+      ternary_ops::IsFullyKnown(known_bits.at(node->operand(1)).Get({}))) {
+    return false;
+  }
   bool is_complex_evaluation = node->OpIn({
       Op::kShrl,
       Op::kShll,
@@ -175,6 +183,69 @@ class TernaryNodeEvaluator : public AbstractNodeEvaluator<TernaryEvaluator> {
     return SetValue(n, std::move(unconstrained));
   }
 
+  // Bitwise, arithmetic and known-amount shift operations are evaluated on
+  // word-packed operands, which is much faster than bit-at-a-time evaluation
+  // and gives the same result.
+  absl::Status HandleAdd(BinOp* add) override {
+    return FoldPacked(add, packed_ternary_ops::Add);
+  }
+  absl::Status HandleNaryAnd(NaryOp* and_op) override {
+    return FoldPacked(and_op, packed_ternary_ops::And);
+  }
+  absl::Status HandleNaryNand(NaryOp* nand_op) override {
+    return FoldPacked(nand_op, packed_ternary_ops::And, /*invert=*/true);
+  }
+  absl::Status HandleNaryNor(NaryOp* nor_op) override {
+    return FoldPacked(nor_op, packed_ternary_ops::Or, /*invert=*/true);
+  }
+  absl::Status HandleNaryOr(NaryOp* or_op) override {
+    return FoldPacked(or_op, packed_ternary_ops::Or);
+  }
+  absl::Status HandleNaryXor(NaryOp* xor_op) override {
+    return FoldPacked(xor_op, packed_ternary_ops::Xor);
+  }
+  absl::Status HandleNeg(UnOp* neg) override {
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector v,
+                         GetPackedValue(neg->operand(0)));
+    return SetValue(neg, packed_ternary_ops::Neg(v).ToTernary());
+  }
+  absl::Status HandleNot(UnOp* not_op) override {
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector v,
+                         GetPackedValue(not_op->operand(0)));
+    return SetValue(not_op, packed_ternary_ops::Not(v).ToTernary());
+  }
+  absl::Status HandleSub(BinOp* sub) override {
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector lhs,
+                         GetPackedValue(sub->operand(0)));
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector rhs,
+                         GetPackedValue(sub->operand(1)));
+    return SetValue(
+        sub, packed_ternary_ops::Add(lhs, packed_ternary_ops::Neg(rhs))
+                 .ToTernary());
+  }
+  absl::Status HandleShll(BinOp* shll) override {
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> amount,
+                         KnownShiftAmount(shll));
+    if (!amount.has_value()) {
+      return AbstractNodeEvaluator::HandleShll(shll);
+    }
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector v,
+                         GetPackedValue(shll->operand(0)));
+    return SetValue(
+        shll, packed_ternary_ops::ShiftLeftLogical(v, *amount).ToTernary());
+  }
+  absl::Status HandleShrl(BinOp* shrl) override {
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> amount,
+                         KnownShiftAmount(shrl));
+    if (!amount.has_value()) {
+      return AbstractNodeEvaluator::HandleShrl(shrl);
+    }
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector v,
+                         GetPackedValue(shrl->operand(0)));
+    return SetValue(
+        shrl, packed_ternary_ops::ShiftRightLogical(v, *amount).ToTernary());
+  }
+
   absl::Status HandleArrayIndex(ArrayIndex* index) override {
     XLS_ASSIGN_OR_RETURN(auto indices, GetValueList(index->indices()));
     XLS_ASSIGN_OR_RETURN(auto array, GetCompoundValue(index->array()));
@@ -258,7 +329,43 @@ class TernaryNodeEvaluator : public AbstractNodeEvaluator<TernaryEvaluator> {
     return SetValue(update, std::move(result));
   }
 
+  // Records a previously computed value for `n` so that the users of `n` can be
+  // evaluated without evaluating `n` again.
+  absl::Status SeedValue(Node* n, const CompoundValue& value) {
+    return SetValue(n, CompoundValue(value));
+  }
+
  private:
+  absl::StatusOr<PackedTernaryVector> GetPackedValue(Node* n) const {
+    XLS_ASSIGN_OR_RETURN(TernarySpan value, GetValue(n));
+    return PackedTernaryVector::FromTernary(value);
+  }
+
+  // Sets the value of `n` to its operands folded together with `combine`,
+  // inverted if `invert` is true.
+  template <typename Combine>
+  absl::Status FoldPacked(Node* n, Combine combine, bool invert = false) {
+    XLS_ASSIGN_OR_RETURN(PackedTernaryVector result,
+                         GetPackedValue(n->operand(0)));
+    for (Node* operand : n->operands().subspan(1)) {
+      XLS_ASSIGN_OR_RETURN(PackedTernaryVector v, GetPackedValue(operand));
+      result = combine(result, v);
+    }
+    if (invert) {
+      result = packed_ternary_ops::Not(result);
+    }
+    return SetValue(n, result.ToTernary());
+  }
+
+  // Returns the shift amount of `shift` if it is fully known.
+  absl::StatusOr<std::optional<int64_t>> KnownShiftAmount(BinOp* shift) const {
+    XLS_ASSIGN_OR_RETURN(TernarySpan amount, GetValue(shift->operand(1)));
+    if (!ternary_ops::IsFullyKnown(amount)) {
+      return std::nullopt;
+    }
+    return ToSaturatedInt64(ternary_ops::ToKnownBitsValues(amount));
+  }
+
   // Intersect all 'possibilities' together
   absl::StatusOr<CompoundValue> MergePossibilities(
       absl::Span<CompoundValueView const> possibilities) {
@@ -338,6 +445,127 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+IncrementalTernaryQueryEngine::IncrementalTernaryQueryEngine(FunctionBase* f)
+    : function_base_(f) {
+  function_base_->RegisterChangeListener(this);
+  for (Node* node : f->nodes()) {
+    dirty_.insert(node);
+  }
+}
+
+IncrementalTernaryQueryEngine::~IncrementalTernaryQueryEngine() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+void IncrementalTernaryQueryEngine::NodeDeleted(Node* node) {
+  dirty_.erase(node);
+  values_.erase(node);
+  fresh_values_.erase(node);
+}
+
+void IncrementalTernaryQueryEngine::FunctionBaseDeleted(FunctionBase* f) {
+  function_base_ = nullptr;
+  dirty_.clear();
+  values_.clear();
+  fresh_values_.clear();
+}
+
+absl::StatusOr<ReachedFixpoint> IncrementalTernaryQueryEngine::Populate(
+    FunctionBase* f) {
+  return Update(f, /*merge=*/true);
+}
+
+absl::Status IncrementalTernaryQueryEngine::ResetAndPopulate(FunctionBase* f) {
+  return Update(f, /*merge=*/false).status();
+}
+
+const LeafTypeTree<TernaryEvaluator::Vector>*
+IncrementalTernaryQueryEngine::FreshValue(Node* node) const {
+  if (auto it = fresh_values_.find(node); it != fresh_values_.end()) {
+    return &it->second;
+  }
+  if (auto it = values_.find(node); it != values_.end()) {
+    return &it->second;
+  }
+  return nullptr;
+}
+
+absl::StatusOr<ReachedFixpoint> IncrementalTernaryQueryEngine::Update(
+    FunctionBase* f, bool merge) {
+  XLS_RET_CHECK_EQ(f, function_base_);
+  if (!merge) {
+    for (auto& [node, fresh_value] : fresh_values_) {
+      values_.insert_or_assign(node, std::move(fresh_value));
+    }
+    fresh_values_.clear();
+  }
+  if (dirty_.empty()) {
+    return ReachedFixpoint::Unchanged;
+  }
+
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* n : TopoSort(f)) {
+    if (!dirty_.contains(n)) {
+      continue;
+    }
+    // Operands which are not re-evaluated in this update keep their previous
+    // values.
+    for (Node* operand : n->operands()) {
+      if (!ternary_visitor.values().contains(operand)) {
+        const LeafTypeTree<TernaryVector>* operand_value = FreshValue(operand);
+        XLS_RET_CHECK(operand_value != nullptr) << operand;
+        XLS_RETURN_IF_ERROR(ternary_visitor.SeedValue(operand, *operand_value));
+      }
+    }
+    if (IsExpensiveToEvaluate(n, ternary_visitor.values())) {
+      XLS_RETURN_IF_ERROR(ternary_visitor.DefaultHandler(n));
+    } else {
+      XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
+    }
+    const LeafTypeTree<TernaryVector>& new_value =
+        ternary_visitor.values().at(n);
+    const LeafTypeTree<TernaryVector>* old_value = FreshValue(n);
+    if (old_value != nullptr && old_value->type() == new_value.type() &&
+        *old_value == new_value) {
+      continue;
+    }
+    // The value changed so the users, which come later in the topological
+    // order, must be re-evaluated as well.
+    for (Node* user : n->users()) {
+      dirty_.insert(user);
+    }
+
+    auto it = values_.find(n);
+    if (!merge || it == values_.end() ||
+        it->second.type() != new_value.type()) {
+      values_.insert_or_assign(n, new_value);
+      fresh_values_.erase(n);
+      continue;
+    }
+    // Merge as TernaryQueryEngine::Populate does, remembering the fresh value
+    // if it differs from the merged one.
+    leaf_type_tree::SimpleUpdateFrom<TernaryVector, TernaryVector>(
+        it->second.AsMutableView(), new_value.AsView(),
+        [&rf](TernaryVector& lhs, const TernaryVector& rhs) {
+          if (lhs != rhs) {
+            rf = ReachedFixpoint::Changed;
+          }
+          CHECK_OK(ternary_ops::UpdateWithUnion(lhs, rhs));
+        });
+    if (it->second == new_value) {
+      fresh_values_.erase(n);
+    } else {
+      fresh_values_.insert_or_assign(n, new_value);
+    }
+  }
+  dirty_.clear();
+  return rf;
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
@@ -369,4 +597,140 @@ bool TernaryQueryEngine::KnownNotEquals(const TreeBitLocation& a,
   return IsKnown(a) && IsKnown(b) && IsOne(a) != IsOne(b);
 }
 
+// The evaluator holding the memoized values of a LazyTernaryQueryEngine.
+class LazyTernaryQueryEngine::Evaluator {
+ public:
+  Evaluator() : visitor_(evaluator_) {}
+
+  TernaryNodeEvaluator& visitor() { return visitor_; }
+
+ private:
+  TernaryEvaluator evaluator_;
+  TernaryNodeEvaluator visitor_;
+};
+
+LazyTernaryQueryEngine::LazyTernaryQueryEngine()
+    : evaluator_(std::make_unique<Evaluator>()) {}
+
+LazyTernaryQueryEngine::~LazyTernaryQueryEngine() = default;
+
+absl::StatusOr<ReachedFixpoint> LazyTernaryQueryEngine::Populate(
+    FunctionBase* f) {
+  function_base_ = f;
+  evaluator_ = std::make_unique<Evaluator>();
+  return ReachedFixpoint::Changed;
+}
+
+int64_t LazyTernaryQueryEngine::evaluated_node_count() const {
+  return evaluator_->visitor().values().size();
+}
+
+LeafTypeTreeView<TernaryVector> LazyTernaryQueryEngine::Evaluate(
+    Node* node) const {
+  CHECK(IsTracked(node)) << node;
+  TernaryNodeEvaluator& visitor = evaluator_->visitor();
+  if (!visitor.values().contains(node)) {
+    // Evaluate the unevaluated part of the fan-in cone in post order. A node
+    // is pushed a second time once its operands have been pushed, and it is
+    // evaluated when popped that second time.
+    std::vector<std::pair<Node*, bool>> worklist = {{node, false}};
+    while (!worklist.empty()) {
+      auto [n, operands_done] = worklist.back();
+      worklist.pop_back();
+      if (visitor.values().contains(n)) {
+        continue;
+      }
+      if (!operands_done) {
+        worklist.push_back({n, true});
+        for (Node* operand : n->operands()) {
+          if (!visitor.values().contains(operand)) {
+            worklist.push_back({operand, false});
+          }
+        }
+        continue;
+      }
+      if (IsExpensiveToEvaluate(n, visitor.values())) {
+        CHECK_OK(visitor.DefaultHandler(n));
+      } else {
+        CHECK_OK(n->VisitSingleNode(&visitor));
+      }
+    }
+  }
+  return visitor.values().at(node).AsView();
+}
+
+std::optional<LeafTypeTree<TernaryVector>> LazyTernaryQueryEngine::GetTernary(
+    Node* node) const {
+  if (!IsTracked(node)) {
+    return std::nullopt;
+  }
+  LeafTypeTreeView<TernaryVector> view = Evaluate(node);
+  return LeafTypeTree<TernaryVector>(view.type(), view.elements());
+}
+
+bool LazyTernaryQueryEngine::IsFullyKnown(Node* n) const {
+  if (!IsTracked(n)) {
+    return false;
+  }
+  return absl::c_all_of(Evaluate(n).elements(), [](const TernaryVector& tv) {
+    return ternary_ops::IsFullyKnown(tv);
+  });
+}
+
+namespace {
+
+// Returns the value of the bit at `location` in `value`.
+TernaryValue BitValue(LeafTypeTreeView<TernaryVector> value,
+                      const TreeBitLocation& location) {
+  return value.Get(location.tree_index())[location.bit_index()];
+}
+
+}  // namespace
+
+bool LazyTernaryQueryEngine::AtMostOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  int64_t maybe_one_count = 0;
+  for (const TreeBitLocation& location : bits) {
+    if (!IsTracked(location.node()) ||
+        BitValue(Evaluate(location.node()), location) !=
+            TernaryValue::kKnownZero) {
+      maybe_one_count++;
+    }
+  }
+  return maybe_one_count <= 1;
+}
+
+bool LazyTernaryQueryEngine::AtLeastOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  for (const TreeBitLocation& location : bits) {
+    if (IsTracked(location.node()) &&
+        BitValue(Evaluate(location.node()), location) ==
+            TernaryValue::kKnownOne) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LazyTernaryQueryEngine::KnownEquals(const TreeBitLocation& a,
+                                         const TreeBitLocation& b) const {
+  if (!IsTracked(a.node()) || !IsTracked(b.node())) {
+    return false;
+  }
+  TernaryValue a_value = BitValue(Evaluate(a.node()), a);
+  TernaryValue b_value = BitValue(Evaluate(b.node()), b);
+  return a_value != TernaryValue::kUnknown && a_value == b_value;
+}
+
+bool LazyTernaryQueryEngine::KnownNotEquals(const TreeBitLocation& a,
+                                            const TreeBitLocation& b) const {
+  if (!IsTracked(a.node()) || !IsTracked(b.node())) {
+    return false;
+  }
+  TernaryValue a_value = BitValue(Evaluate(a.node()), a);
+  TernaryValue b_value = BitValue(Evaluate(b.node()), b);
+  return a_value != TernaryValue::kUnknown &&
+         b_value != TernaryValue::kUnknown && a_value != b_value;
+}
+
 }  // namespace xls
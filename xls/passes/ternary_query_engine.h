@@ -15,16 +15,20 @@
 #ifndef XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 #define XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <utility>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/ternary.h"
@@ -92,11 +96,135 @@ class TernaryQueryEngine : public QueryEngine {
                           });
   }
 
- private:
+ protected:
   // Holds which bits values are known for nodes in the function.
   absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>> values_;
 };
 
+// A ternary query engine bound to a single function base which keeps its
+// results up to date incrementally. It listens for changes to the IR, and
+// populating only re-evaluates the nodes which were added or had operands
+// replaced since the previous call, plus the transitive users of any node whose
+// value changed as a result.
+//
+// Between calls to Populate the results describe the IR as of the last call,
+// except that removed nodes are forgotten immediately.
+class IncrementalTernaryQueryEngine final : public TernaryQueryEngine,
+                                            public ChangeListener {
+ public:
+  explicit IncrementalTernaryQueryEngine(FunctionBase* f);
+  ~IncrementalTernaryQueryEngine() override;
+
+  IncrementalTernaryQueryEngine(const IncrementalTernaryQueryEngine&) = delete;
+  IncrementalTernaryQueryEngine& operator=(
+      const IncrementalTernaryQueryEngine&) = delete;
+
+  // Brings the results up to date with the IR. As with TernaryQueryEngine,
+  // the new results of a node are merged with what was known about it before.
+  // `f` must be the function base given at construction.
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  // Brings the results up to date with the IR, discarding the information
+  // merged in by earlier calls to Populate. Afterwards the results are
+  // identical to those of a newly constructed TernaryQueryEngine populated
+  // with `f`.
+  absl::Status ResetAndPopulate(FunctionBase* f);
+
+  // Returns the function base this engine is bound to, or nullptr if it has
+  // been destroyed.
+  FunctionBase* function_base() const { return function_base_; }
+
+  // Returns the number of nodes which the next update will evaluate before
+  // propagating any changes.
+  int64_t dirty_node_count() const { return dirty_.size(); }
+
+  void NodeAdded(Node* node) override { dirty_.insert(node); }
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    dirty_.insert(node);
+  }
+  void FunctionBaseDeleted(FunctionBase* f) override;
+
+ private:
+  absl::StatusOr<ReachedFixpoint> Update(FunctionBase* f, bool merge);
+
+  // Returns the value a fresh evaluation of the IR as of the last update gave
+  // `node`, or nullptr if it has none.
+  const LeafTypeTree<TernaryEvaluator::Vector>* FreshValue(Node* node) const;
+
+  FunctionBase* function_base_;
+  absl::flat_hash_set<Node*> dirty_;
+
+  // The freshly evaluated values of the nodes whose entry in `values_` holds
+  // more information because of merging.
+  absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>>
+      fresh_values_;
+};
+
+// A ternary query engine which evaluates nodes on demand. Populate only binds
+// the engine to a function base; the first query about a node evaluates that
+// node and whatever part of its fan-in cone has not been evaluated yet, and the
+// results are memoized. Passes which query only a few nodes thereby avoid
+// evaluating the whole function base.
+//
+// The results are identical to those of a TernaryQueryEngine populated once.
+// Populating again discards the memoized results rather than merging them.
+// Queries mutate the memoized results so the engine must not be queried
+// concurrently.
+class LazyTernaryQueryEngine final : public QueryEngine {
+ public:
+  LazyTernaryQueryEngine();
+  ~LazyTernaryQueryEngine() override;
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  bool IsTracked(Node* node) const override {
+    return function_base_ != nullptr && node->function_base() == function_base_;
+  }
+
+  std::optional<LeafTypeTree<TernaryVector>> GetTernary(
+      Node* node) const override;
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override;
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override;
+
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return false;
+  }
+
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return std::nullopt;
+  }
+
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return std::nullopt;
+  }
+
+  bool IsFullyKnown(Node* n) const override;
+
+  // Returns the number of nodes evaluated since the last Populate.
+  int64_t evaluated_node_count() const;
+
+ private:
+  class Evaluator;
+
+  // Evaluates `node` and its unevaluated fan-in, returning its value.
+  LeafTypeTreeView<TernaryVector> Evaluate(Node* node) const;
+
+  FunctionBase* function_base_ = nullptr;
+  std::unique_ptr<Evaluator> evaluator_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_PASSES_TERNARY_QUERY_ENGINE_H_
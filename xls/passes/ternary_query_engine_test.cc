@@ -337,6 +337,55 @@ TEST_F(TernaryQueryEngineTest, Ult) {
   EXPECT_THAT(RunOnBinaryOp("0b0XX", "0b1XX", make_ult), IsOkAndHolds("0b1"));
 }
 
+TEST_F(TernaryQueryEngineTest, Add) {
+  auto make_add = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
+    fb->Add(lhs, rhs);
+  };
+  EXPECT_THAT(RunOnBinaryOp("0b0X1", "0b001", make_add),
+              IsOkAndHolds("0bXX0"));
+  EXPECT_THAT(RunOnBinaryOp("0b0X0", "0b001", make_add),
+              IsOkAndHolds("0b0X1"));
+  EXPECT_THAT(RunOnBinaryOp("0bXXX", "0b000", make_add),
+              IsOkAndHolds("0bXXX"));
+}
+
+TEST_F(TernaryQueryEngineTest, Sub) {
+  auto make_sub = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
+    fb->Subtract(lhs, rhs);
+  };
+  EXPECT_THAT(RunOnBinaryOp("0b1X0", "0b001", make_sub),
+              IsOkAndHolds("0bXX1"));
+  EXPECT_THAT(RunOnBinaryOp("0b1X1", "0b001", make_sub),
+              IsOkAndHolds("0b1X0"));
+}
+
+TEST_F(TernaryQueryEngineTest, WideShiftByKnownAmount) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(1024));
+  BValue left = fb.Shll(x, fb.Literal(UBits(3, 16)));
+  BValue right = fb.Shrl(x, fb.Literal(UBits(100, 16)));
+  BValue unknown_amount = fb.Shll(x, fb.Param("y", p->GetBitsType(16)));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  TernaryQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(p->functions().front().get()).status());
+  TernaryVector left_bits = query_engine.GetTernary(left.node())->Get({});
+  TernaryVector right_bits = query_engine.GetTernary(right.node())->Get({});
+  EXPECT_EQ(ternary_ops::NumberOfKnownBits(left_bits), 3);
+  EXPECT_EQ(ternary_ops::NumberOfKnownBits(right_bits), 100);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(left_bits[i], TernaryValue::kKnownZero);
+  }
+  for (int64_t i = 924; i < 1024; ++i) {
+    EXPECT_EQ(right_bits[i], TernaryValue::kKnownZero);
+  }
+  // Wide shifts by an unknown amount are still too expensive to analyze.
+  EXPECT_EQ(ternary_ops::NumberOfKnownBits(
+                query_engine.GetTernary(unknown_amount.node())->Get({})),
+            0);
+}
+
 TEST_F(TernaryQueryEngineTest, Ne) {
   auto make_ne = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
     fb->Ne(lhs, rhs);
@@ -1762,6 +1811,86 @@ class ArrayCreation : public benchmark_support::strategy::NaryNode {
     return builder.Array(inputs, inputs.front().GetType());
   }
 };
+TEST_F(TernaryQueryEngineTest, IncrementalMatchesFreshAfterChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue mask = fb.Literal(UBits(0x0f, 8));
+  BValue masked = fb.And(x, mask);
+  BValue out = fb.Or(masked, fb.Literal(UBits(0x80, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(out));
+
+  IncrementalTernaryQueryEngine incremental(f);
+  EXPECT_EQ(incremental.dirty_node_count(), f->node_count());
+  XLS_ASSERT_OK(incremental.ResetAndPopulate(f));
+  EXPECT_EQ(incremental.dirty_node_count(), 0);
+  EXPECT_EQ(incremental.ToString(out.node()), "0b1000_XXXX");
+
+  // Narrow the mask. Only the new literal and the and are dirty; the change
+  // then propagates to the or.
+  XLS_ASSERT_OK_AND_ASSIGN(Literal * new_mask,
+                           f->MakeNode<Literal>(SourceInfo(),
+                                                Value(UBits(0x03, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+  XLS_ASSERT_OK(f->RemoveNode(mask.node()));
+  EXPECT_EQ(incremental.dirty_node_count(), 2);
+  XLS_ASSERT_OK(incremental.ResetAndPopulate(f));
+
+  TernaryQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f).status());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(incremental.ToString(node), fresh.ToString(node)) << node;
+  }
+  EXPECT_EQ(incremental.ToString(out.node()), "0b1000_00XX");
+}
+
+TEST_F(TernaryQueryEngineTest, IncrementalForgetsDeletedFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(4)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  IncrementalTernaryQueryEngine incremental(f);
+  XLS_ASSERT_OK(incremental.ResetAndPopulate(f));
+  EXPECT_EQ(incremental.function_base(), f);
+  p.reset();
+  EXPECT_EQ(incremental.function_base(), nullptr);
+}
+
+TEST_F(TernaryQueryEngineTest, LazyEvaluatesOnlyFanIn) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue high = fb.Or(masked, fb.Literal(UBits(0x80, 8)));
+  BValue unrelated = fb.Add(fb.Not(y), fb.Literal(UBits(1, 8)));
+  BValue out = fb.Tuple({high, unrelated});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(out));
+
+  LazyTernaryQueryEngine lazy;
+  XLS_ASSERT_OK(lazy.Populate(f).status());
+  EXPECT_EQ(lazy.evaluated_node_count(), 0);
+  EXPECT_EQ(lazy.ToString(high.node()), "0b1000_XXXX");
+  // Only `high`, `masked`, `x` and the two literals were evaluated.
+  EXPECT_EQ(lazy.evaluated_node_count(), 5);
+  EXPECT_TRUE(lazy.KnownEquals(TreeBitLocation(high.node(), 7),
+                               TreeBitLocation(high.node(), 7)));
+  EXPECT_TRUE(lazy.KnownNotEquals(TreeBitLocation(high.node(), 7),
+                                  TreeBitLocation(high.node(), 6)));
+  EXPECT_EQ(lazy.evaluated_node_count(), 5);
+
+  TernaryQueryEngine eager;
+  XLS_ASSERT_OK(eager.Populate(f).status());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(lazy.ToString(node), eager.ToString(node)) << node;
+  }
+  EXPECT_EQ(lazy.evaluated_node_count(), f->node_count());
+
+  // Populating again forgets the memoized values.
+  XLS_ASSERT_OK(lazy.Populate(f).status());
+  EXPECT_EQ(lazy.evaluated_node_count(), 0);
+}
+
 }  // namespace
 
 // Single level array
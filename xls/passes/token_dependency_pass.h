@@ -38,6 +38,8 @@ class TokenDependencyPass : public OptimizationFunctionBasePass {
                                      "dependencies") {}
   ~TokenDependencyPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
@@ -27,6 +27,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
+#include "xls/passes/inline_and_fold.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -47,8 +48,9 @@ CountedFor* FindCountedFor(FunctionBase* f) {
 }
 
 // Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// invocations. If `streaming` each invocation is inlined and folded before the
+// next is created.
+absl::Status UnrollCountedFor(CountedFor* loop, bool streaming) {
   FunctionBase* f = loop->function_base();
   Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
@@ -65,9 +67,13 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
     }
 
     XLS_ASSIGN_OR_RETURN(
-        loop_carry,
+        Invoke * invoke,
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
+    loop_carry = invoke;
+    if (streaming) {
+      XLS_ASSIGN_OR_RETURN(loop_carry, InlineAndFold(invoke));
+    }
   }
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
   return f->RemoveNode(loop);
@@ -84,7 +90,11 @@ absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     if (loop == nullptr) {
       break;
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    bool streaming =
+        options.streaming_unroll_threshold.has_value() &&
+        loop->trip_count() >= *options.streaming_unroll_threshold &&
+        CanInlineAndFold(loop->body());
+    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop, streaming));
     changed = true;
   }
   return changed;
@@ -63,5 +63,35 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, StreamingUnrollFoldsEachIteration) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[8], accum: bits[32], x: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  umul.4: bits[32] = umul(zero_ext.3, zero_ext.3)
+  ret add.5: bits[32] = add(umul.4, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=200, stride=1, body=body, invariant_args=[x])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  options.streaming_unroll_threshold = 100;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  // Every iteration folds away, leaving the sum of the squares below 200. Only
+  // the parameter and the unused initial value remain alongside it.
+  EXPECT_THAT(f->return_value(), m::Literal(2646700));
+  EXPECT_EQ(f->node_count(), 3);
+}
+
 }  // namespace
 }  // namespace xls
@@ -34,6 +34,8 @@ class UselessAssertRemovalPass : public OptimizationFunctionBasePass {
                                      "Remove useless (always true) asserts") {}
   ~UselessAssertRemovalPass() override = default;
 
+  bool IsSafeToRunConcurrently() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
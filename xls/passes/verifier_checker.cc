@@ -14,17 +14,113 @@
 
 #include "xls/passes/verifier_checker.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
 
+// Records the nodes of a function base whose node-level invariants may have
+// been affected by changes since the tracker was last cleared.
+class VerifierChecker::ChangedNodeTracker : public ChangeListener {
+ public:
+  explicit ChangedNodeTracker(FunctionBase* f) : function_base_(f) {
+    function_base_->RegisterChangeListener(this);
+  }
+  ~ChangedNodeTracker() override {
+    if (function_base_ != nullptr) {
+      function_base_->UnregisterChangeListener(this);
+    }
+  }
+
+  void NodeAdded(Node* node) override { changed_.insert(node); }
+
+  void NodeDeleted(Node* node) override {
+    changed_.erase(node);
+    // The users of the operands changed.
+    for (Node* operand : node->operands()) {
+      changed_.insert(operand);
+    }
+  }
+
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    changed_.insert(node);
+    changed_.insert(old_operand);
+    changed_.insert(node->operand(operand_nos.front()));
+  }
+
+  void FunctionBaseDeleted(FunctionBase* f) override {
+    function_base_ = nullptr;
+    changed_.clear();
+  }
+
+  bool deleted() const { return function_base_ == nullptr; }
+
+  // Adds the changed nodes and their users to `nodes` and forgets them.
+  void TakeChangedNodes(absl::flat_hash_set<Node*>& nodes) {
+    for (Node* node : changed_) {
+      nodes.insert(node);
+      nodes.insert(node->users().begin(), node->users().end());
+    }
+    changed_.clear();
+  }
+
+ private:
+  FunctionBase* function_base_;
+  absl::flat_hash_set<Node*> changed_;
+};
+
+VerifierChecker::VerifierChecker(bool incremental)
+    : incremental_(incremental) {}
+
+VerifierChecker::~VerifierChecker() = default;
+
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  if (!incremental_) {
+    return VerifyPackage(p);
+  }
+
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  if (p != package_) {
+    trackers_.clear();
+    for (FunctionBase* f : function_bases) {
+      trackers_[f] = std::make_unique<ChangedNodeTracker>(f);
+    }
+    package_ = p;
+    return VerifyPackage(p);
+  }
+
+  absl::erase_if(trackers_, [](const auto& entry) {
+    return entry.second->deleted();
+  });
+  absl::flat_hash_set<Node*> nodes;
+  for (FunctionBase* f : function_bases) {
+    auto [it, inserted] = trackers_.try_emplace(f);
+    if (inserted) {
+      // New function base; verify it in full.
+      it->second = std::make_unique<ChangedNodeTracker>(f);
+      for (Node* node : f->nodes()) {
+        nodes.insert(node);
+      }
+      continue;
+    }
+    it->second->TakeChangedNodes(nodes);
+  }
+  return VerifyPackageNodes(p, nodes);
 }
 
 }  // namespace xls
@@ -15,7 +15,11 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -23,10 +27,34 @@
 namespace xls {
 
 // Invariant checker which just runs xls::Verifier.
+//
+// If `incremental` is true only the first run verifies the whole package.
+// Later runs check the node-level invariants only of the nodes added or whose
+// operands changed since the previous run (tracked with change listeners on
+// each function base), the operands and users of those nodes, and all nodes
+// of function bases added in the meantime. Function-, proc- and package-level
+// invariants are checked on every run. Changes which are not reported to
+// change listeners (e.g., to node attributes) may go undetected until the next
+// full verification, so callers should fully verify at pipeline boundaries.
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
+  explicit VerifierChecker(bool incremental = false);
+  ~VerifierChecker() override;
+
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  class ChangedNodeTracker;
+
+  const bool incremental_;
+
+  // State of incremental verification: the package verified by the previous
+  // run and the trackers of changes to each of its function bases since.
+  mutable Package* package_ = nullptr;
+  mutable absl::flat_hash_map<FunctionBase*,
+                              std::unique_ptr<ChangedNodeTracker>>
+      trackers_;
 };
 
 }  // namespace xls
@@ -0,0 +1,100 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/verifier_checker.h"
+
+#include <memory>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class VerifierCheckerTest : public IrTestBase {
+ protected:
+  absl::Status Check(const VerifierChecker& checker, Package* p) {
+    PassResults results;
+    return checker.Run(p, OptimizationPassOptions(), &results);
+  }
+};
+
+constexpr std::string_view kPackage = R"(
+package p
+
+fn graph(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.1: bits[42] = and(q, r)
+}
+)";
+
+TEST_F(VerifierCheckerTest, IncrementalCatchesChangedNode) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("graph"));
+  VerifierChecker checker(/*incremental=*/true);
+  XLS_ASSERT_OK(Check(checker, p.get()));
+  XLS_ASSERT_OK(Check(checker, p.get()));
+
+  FindNode("and.1", f)->ReplaceOperand(FindNode("q", f), FindNode("p", f));
+  EXPECT_THAT(Check(checker, p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1 to have type "
+                                 "bits[42], has type bits[2].")));
+}
+
+TEST_F(VerifierCheckerTest, IncrementalVerifiesNewFunctionsInFull) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kPackage));
+  VerifierChecker checker(/*incremental=*/true);
+  XLS_ASSERT_OK(Check(checker, p.get()));
+
+  FunctionBuilder fb("other", p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y, SourceInfo(), "sum");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other, fb.BuildWithReturnValue(sum));
+  XLS_ASSERT_OK(Check(checker, p.get()));
+
+  // Deleting the function drops its change tracking; the package is still
+  // verified.
+  XLS_ASSERT_OK(p->RemoveFunction(other));
+  XLS_ASSERT_OK(Check(checker, p.get()));
+}
+
+TEST_F(VerifierCheckerTest, IncrementalCheckerSwitchesPackages) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p1, ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(auto p2, ParsePackageNoVerify(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, p2->GetFunction("graph"));
+  FindNode("and.1", f2)->ReplaceOperand(FindNode("q", f2), FindNode("p", f2));
+
+  VerifierChecker checker(/*incremental=*/true);
+  XLS_ASSERT_OK(Check(checker, p1.get()));
+  // A package not seen before is verified in full.
+  EXPECT_THAT(Check(checker, p2.get()),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("and.1")));
+}
+
+}  // namespace
+}  // namespace xls
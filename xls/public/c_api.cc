@@ -17,6 +17,7 @@
 #include <string.h>  // NOLINT(modernize-deprecated-headers)
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -30,8 +31,12 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
@@ -40,11 +45,46 @@
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/public/c_api_format_preference.h"
 #include "xls/public/c_api_impl_helpers.h"
 #include "xls/public/c_api_vast.h"
 #include "xls/public/runtime_build_actions.h"
 
+namespace {
+
+// Adapts `status` to the C API pattern: returns whether it is ok, populating
+// `error_out` otherwise.
+bool ReturnStatusHelper(const absl::Status& status, char** error_out) {
+  if (!status.ok()) {
+    *error_out = xls::ToOwnedCString(status.ToString());
+    return false;
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+absl::StatusOr<xls::JitChannelQueue*> GetJitQueue(
+    xls::ProcRuntime* runtime, std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(xls::ChannelQueue * queue,
+                       runtime->queue_manager().GetQueueByName(channel_name));
+  auto* jit_queue = dynamic_cast<xls::JitChannelQueue*>(queue);
+  if (jit_queue == nullptr) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel `%s` does not have a JIT queue.", channel_name));
+  }
+  return jit_queue;
+}
+
+// Distance in bytes between consecutive values in the batch entry points.
+int64_t BatchStride(int64_t size, int64_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
 extern "C" {
 
 void xls_init_xls(const char* usage, int argc, char* argv[]) {
@@ -394,4 +434,250 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
   return true;
 }
 
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out) {
+  CHECK(function != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::Function* xls_function = reinterpret_cast<xls::Function*>(function);
+  absl::StatusOr<std::unique_ptr<xls::FunctionJit>> jit =
+      xls::FunctionJit::Create(xls_function);
+  if (!jit.ok()) {
+    *result_out = nullptr;
+    return ReturnStatusHelper(jit.status(), error_out);
+  }
+  *error_out = nullptr;
+  *result_out = reinterpret_cast<xls_function_jit*>(jit->release());
+  return true;
+}
+
+void xls_function_jit_free(struct xls_function_jit* jit) {
+  delete reinterpret_cast<xls::FunctionJit*>(jit);
+}
+
+bool xls_function_jit_run(struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out) {
+  CHECK(jit != nullptr);
+  CHECK(args != nullptr || argc == 0);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::FunctionJit* xls_jit = reinterpret_cast<xls::FunctionJit*>(jit);
+
+  std::vector<xls::Value> xls_args;
+  xls_args.reserve(argc);
+  for (size_t i = 0; i < argc; ++i) {
+    CHECK(args[i] != nullptr);
+    xls_args.push_back(*reinterpret_cast<const xls::Value*>(args[i]));
+  }
+
+  absl::StatusOr<xls::Value> result_value =
+      [&]() -> absl::StatusOr<xls::Value> {
+    XLS_ASSIGN_OR_RETURN(xls::InterpreterResult<xls::Value> result,
+                         xls_jit->Run(xls_args));
+    return xls::InterpreterResultToStatusOrValue(std::move(result));
+  }();
+  if (!result_value.ok()) {
+    *result_out = nullptr;
+    return ReturnStatusHelper(result_value.status(), error_out);
+  }
+  *result_out = reinterpret_cast<struct xls_value*>(
+      new xls::Value(std::move(result_value.value())));
+  *error_out = nullptr;
+  return true;
+}
+
+size_t xls_function_jit_get_arg_size(struct xls_function_jit* jit,
+                                     size_t arg_index) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetArgTypeSize(arg_index);
+}
+
+size_t xls_function_jit_get_arg_alignment(struct xls_function_jit* jit,
+                                          size_t arg_index) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetArgTypeAlignment(
+      arg_index);
+}
+
+size_t xls_function_jit_get_result_size(struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetReturnTypeSize();
+}
+
+size_t xls_function_jit_get_result_alignment(struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetReturnTypeAlignment();
+}
+
+bool xls_function_jit_run_with_buffers(struct xls_function_jit* jit,
+                                       size_t argc, uint8_t* const* args,
+                                       uint8_t* result, char** error_out) {
+  return xls_function_jit_run_batch(jit, /*count=*/1, argc, args, result,
+                                    error_out);
+}
+
+bool xls_function_jit_run_batch(struct xls_function_jit* jit, size_t count,
+                                size_t argc, uint8_t* const* args,
+                                uint8_t* results, char** error_out) {
+  CHECK(jit != nullptr);
+  CHECK(args != nullptr || argc == 0);
+  CHECK(results != nullptr);
+  CHECK(error_out != nullptr);
+  xls::FunctionJit* xls_jit = reinterpret_cast<xls::FunctionJit*>(jit);
+
+  std::vector<int64_t> arg_strides(argc);
+  for (size_t i = 0; i < argc; ++i) {
+    CHECK(args[i] != nullptr);
+    arg_strides[i] = BatchStride(xls_jit->GetArgTypeSize(i),
+                                 xls_jit->GetArgTypeAlignment(i));
+  }
+  const int64_t result_size = xls_jit->GetReturnTypeSize();
+  const int64_t result_stride =
+      BatchStride(result_size, xls_jit->GetReturnTypeAlignment());
+
+  std::vector<uint8_t*> lane_args(args, args + argc);
+  xls::InterpreterEvents events;
+  for (size_t lane = 0; lane < count; ++lane) {
+    for (size_t i = 0; i < argc; ++i) {
+      lane_args[i] = args[i] + lane * arg_strides[i];
+    }
+    events.Clear();
+    absl::Status status = xls_jit->RunWithViews(
+        lane_args, absl::MakeSpan(results + lane * result_stride, result_size),
+        &events);
+    if (status.ok()) {
+      status = xls::InterpreterEventsToStatus(events);
+    }
+    if (!status.ok()) {
+      return ReturnStatusHelper(status, error_out);
+    }
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_make_proc_jit_runtime(struct xls_package* package, char** error_out,
+                               struct xls_proc_runtime** result_out) {
+  CHECK(package != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::Package* xls_package = reinterpret_cast<xls::Package*>(package);
+  absl::StatusOr<std::unique_ptr<xls::SerialProcRuntime>> runtime =
+      xls::CreateJitSerialProcRuntime(xls_package);
+  if (!runtime.ok()) {
+    *result_out = nullptr;
+    return ReturnStatusHelper(runtime.status(), error_out);
+  }
+  xls::ProcRuntime* xls_runtime = runtime->release();
+  *error_out = nullptr;
+  *result_out = reinterpret_cast<xls_proc_runtime*>(xls_runtime);
+  return true;
+}
+
+void xls_proc_runtime_free(struct xls_proc_runtime* runtime) {
+  delete reinterpret_cast<xls::ProcRuntime*>(runtime);
+}
+
+bool xls_proc_runtime_tick(struct xls_proc_runtime* runtime, char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(error_out != nullptr);
+  xls::ProcRuntime* xls_runtime = reinterpret_cast<xls::ProcRuntime*>(runtime);
+  return ReturnStatusHelper(xls_runtime->Tick(), error_out);
+}
+
+bool xls_proc_runtime_enqueue_value(struct xls_proc_runtime* runtime,
+                                    const char* channel_name,
+                                    const struct xls_value* value,
+                                    char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(value != nullptr);
+  CHECK(error_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitQueue(reinterpret_cast<xls::ProcRuntime*>(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnStatusHelper(queue.status(), error_out);
+  }
+  return ReturnStatusHelper(
+      (*queue)->Write(*reinterpret_cast<const xls::Value*>(value)), error_out);
+}
+
+bool xls_proc_runtime_dequeue_value(struct xls_proc_runtime* runtime,
+                                    const char* channel_name, char** error_out,
+                                    struct xls_value** value_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(value_out != nullptr);
+  *value_out = nullptr;
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitQueue(reinterpret_cast<xls::ProcRuntime*>(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnStatusHelper(queue.status(), error_out);
+  }
+  std::optional<xls::Value> value = (*queue)->Read();
+  if (value.has_value()) {
+    *value_out = reinterpret_cast<struct xls_value*>(
+        new xls::Value(std::move(value.value())));
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_runtime_get_channel_element_size(
+    struct xls_proc_runtime* runtime, const char* channel_name,
+    char** error_out, size_t* size_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(size_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitQueue(reinterpret_cast<xls::ProcRuntime*>(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnStatusHelper(queue.status(), error_out);
+  }
+  *size_out = (*queue)->element_size();
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_runtime_enqueue_raw(struct xls_proc_runtime* runtime,
+                                  const char* channel_name,
+                                  const uint8_t* data, size_t count,
+                                  char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(data != nullptr || count == 0);
+  CHECK(error_out != nullptr);
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitQueue(reinterpret_cast<xls::ProcRuntime*>(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnStatusHelper(queue.status(), error_out);
+  }
+  (*queue)->WriteRawBatch(data, count);
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_runtime_dequeue_raw(struct xls_proc_runtime* runtime,
+                                  const char* channel_name, uint8_t* buffer,
+                                  size_t max_count, char** error_out,
+                                  size_t* count_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(buffer != nullptr || max_count == 0);
+  CHECK(error_out != nullptr);
+  CHECK(count_out != nullptr);
+  *count_out = 0;
+  absl::StatusOr<xls::JitChannelQueue*> queue =
+      GetJitQueue(reinterpret_cast<xls::ProcRuntime*>(runtime), channel_name);
+  if (!queue.ok()) {
+    return ReturnStatusHelper(queue.status(), error_out);
+  }
+  *count_out = (*queue)->ReadRawBatch(buffer, max_count);
+  *error_out = nullptr;
+  return true;
+}
+
 }  // extern "C"
@@ -16,6 +16,7 @@
 #define XLS_PUBLIC_C_API_H_
 
 #include <stddef.h>  // NOLINT(modernize-deprecated-headers)
+#include <stdint.h>  // NOLINT(modernize-deprecated-headers)
 
 #include "xls/public/c_api_dslx.h"
 #include "xls/public/c_api_format_preference.h"
@@ -47,6 +48,8 @@ struct xls_package;
 struct xls_function;
 struct xls_type;
 struct xls_function_type;
+struct xls_function_jit;
+struct xls_proc_runtime;
 
 void xls_init_xls(const char* usage, int argc, char* argv[]);
 
@@ -179,6 +182,90 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
                             const struct xls_value** args, char** error_out,
                             struct xls_value** result_out);
 
+// Compiles the given `function` to native code once, so it can be run many
+// times. The returned JIT must be freed via `xls_function_jit_free` and must
+// not outlive the package containing `function`.
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out);
+
+void xls_function_jit_free(struct xls_function_jit* jit);
+
+// As `xls_interpret_function`, but runs the compiled function.
+bool xls_function_jit_run(struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out);
+
+// Returns the size and alignment in bytes of argument `arg_index` (or of the
+// result) in the native layout of the JIT, as used by the buffer entry points
+// below.
+size_t xls_function_jit_get_arg_size(struct xls_function_jit* jit,
+                                     size_t arg_index);
+size_t xls_function_jit_get_arg_alignment(struct xls_function_jit* jit,
+                                          size_t arg_index);
+size_t xls_function_jit_get_result_size(struct xls_function_jit* jit);
+size_t xls_function_jit_get_result_alignment(struct xls_function_jit* jit);
+
+// Runs the compiled function on caller-owned buffers in the native layout:
+// `args` is an array of `argc` pointers to the arguments, and the result is
+// written to `result`. Buffers which are suitably aligned are used in place;
+// others are copied. Returns false and populates `error_out` if an assertion
+// in the function fails.
+bool xls_function_jit_run_with_buffers(struct xls_function_jit* jit,
+                                       size_t argc, uint8_t* const* args,
+                                       uint8_t* result, char** error_out);
+
+// Runs the compiled function `count` times. `args[i]` points to `count`
+// consecutive values of argument `i`, and `count` results are written
+// consecutively to `results`; consecutive values are spaced by their size
+// rounded up to their alignment.
+bool xls_function_jit_run_batch(struct xls_function_jit* jit, size_t count,
+                                size_t argc, uint8_t* const* args,
+                                uint8_t* results, char** error_out);
+
+// Creates a runtime which ticks the procs in `package`, compiled to native
+// code. The returned runtime must be freed via `xls_proc_runtime_free` and
+// must not outlive `package`.
+bool xls_make_proc_jit_runtime(struct xls_package* package, char** error_out,
+                               struct xls_proc_runtime** result_out);
+
+void xls_proc_runtime_free(struct xls_proc_runtime* runtime);
+
+// Executes one tick of every proc in the network.
+bool xls_proc_runtime_tick(struct xls_proc_runtime* runtime, char** error_out);
+
+// Enqueues `value` on the channel named `channel_name`.
+bool xls_proc_runtime_enqueue_value(struct xls_proc_runtime* runtime,
+                                    const char* channel_name,
+                                    const struct xls_value* value,
+                                    char** error_out);
+
+// Dequeues a value from the channel named `channel_name` into `value_out`, or
+// sets `value_out` to null if the channel is empty.
+bool xls_proc_runtime_dequeue_value(struct xls_proc_runtime* runtime,
+                                    const char* channel_name, char** error_out,
+                                    struct xls_value** value_out);
+
+// Returns the size in bytes of an element of the channel named
+// `channel_name`, in the native layout used by the raw entry points below.
+bool xls_proc_runtime_get_channel_element_size(
+    struct xls_proc_runtime* runtime, const char* channel_name,
+    char** error_out, size_t* size_out);
+
+// Enqueues `count` elements in native layout, stored consecutively with the
+// element size apart in `data`, on the channel named `channel_name`.
+bool xls_proc_runtime_enqueue_raw(struct xls_proc_runtime* runtime,
+                                  const char* channel_name,
+                                  const uint8_t* data, size_t count,
+                                  char** error_out);
+
+// Dequeues up to `max_count` elements in native layout from the channel named
+// `channel_name` into `buffer`, stored consecutively with the element size
+// apart. The number of elements dequeued is placed in `count_out`.
+bool xls_proc_runtime_dequeue_raw(struct xls_proc_runtime* runtime,
+                                  const char* channel_name, uint8_t* buffer,
+                                  size_t max_count, char** error_out,
+                                  size_t* count_out);
+
 }  // extern "C"
 
 #endif  // XLS_PUBLIC_C_API_H_
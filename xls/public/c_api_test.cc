@@ -14,6 +14,8 @@
 
 #include "xls/public/c_api.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
@@ -197,6 +199,139 @@ fn f(x: bits[32] id=3) -> bits[32] {
   ASSERT_TRUE(xls_value_eq(ft, result));
 }
 
+TEST(XlsCApiTest, JitFunctionOnValuesAndBuffers) {
+  const std::string kPackage = R"(package p
+
+fn f(x: bits[32] id=1, y: bits[32] id=2) -> bits[32] {
+  ret z: bits[32] = add(x, y, id=3)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_function* function = nullptr;
+  ASSERT_TRUE(xls_package_get_function(package, "f", &error, &function));
+
+  struct xls_function_jit* jit = nullptr;
+  ASSERT_TRUE(xls_make_function_jit(function, &error, &jit))
+      << "xls_make_function_jit error: " << error;
+  absl::Cleanup free_jit([jit] { xls_function_jit_free(jit); });
+
+  struct xls_value* x = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:40", &error, &x));
+  absl::Cleanup free_x([x] { xls_value_free(x); });
+  struct xls_value* y = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:2", &error, &y));
+  absl::Cleanup free_y([y] { xls_value_free(y); });
+  const struct xls_value* args[] = {x, y};
+
+  struct xls_value* result = nullptr;
+  ASSERT_TRUE(xls_function_jit_run(jit, /*argc=*/2, args, &error, &result));
+  absl::Cleanup free_result([result] { xls_value_free(result); });
+  char* result_str = nullptr;
+  ASSERT_TRUE(xls_value_to_string(result, &result_str));
+  absl::Cleanup free_result_str([result_str] { xls_c_str_free(result_str); });
+  EXPECT_EQ(std::string_view(result_str), "bits[32]:42");
+
+  // bits[32] is a native uint32_t.
+  ASSERT_EQ(xls_function_jit_get_arg_size(jit, 0), sizeof(uint32_t));
+  ASSERT_EQ(xls_function_jit_get_result_size(jit), sizeof(uint32_t));
+  uint32_t buffer_x = 7;
+  uint32_t buffer_y = 5;
+  uint32_t buffer_result = 0;
+  uint8_t* buffer_args[] = {reinterpret_cast<uint8_t*>(&buffer_x),
+                            reinterpret_cast<uint8_t*>(&buffer_y)};
+  ASSERT_TRUE(xls_function_jit_run_with_buffers(
+      jit, /*argc=*/2, buffer_args, reinterpret_cast<uint8_t*>(&buffer_result),
+      &error));
+  EXPECT_EQ(buffer_result, 12);
+
+  uint32_t batch_x[] = {1, 2, 3, 0xffffffff};
+  uint32_t batch_y[] = {10, 20, 30, 1};
+  uint32_t batch_result[4] = {};
+  uint8_t* batch_args[] = {reinterpret_cast<uint8_t*>(batch_x),
+                           reinterpret_cast<uint8_t*>(batch_y)};
+  ASSERT_TRUE(xls_function_jit_run_batch(
+      jit, /*count=*/4, /*argc=*/2, batch_args,
+      reinterpret_cast<uint8_t*>(batch_result), &error));
+  EXPECT_THAT(batch_result, testing::ElementsAre(11, 22, 33, 0));
+}
+
+TEST(XlsCApiTest, JitProcRuntimeEnqueueTickDequeue) {
+  const std::string kPackage = R"(package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc add_one(tkn: token, state: (), init={token, ()}) {
+  rcv: (token, bits[32]) = receive(tkn, channel=in)
+  rcv_tkn: token = tuple_index(rcv, index=0)
+  data: bits[32] = tuple_index(rcv, index=1)
+  one: bits[32] = literal(value=1)
+  sum: bits[32] = add(data, one)
+  snd: token = send(rcv_tkn, sum, channel=out)
+  next (snd, state)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_proc_runtime* runtime = nullptr;
+  ASSERT_TRUE(xls_make_proc_jit_runtime(package, &error, &runtime))
+      << "xls_make_proc_jit_runtime error: " << error;
+  absl::Cleanup free_runtime([runtime] { xls_proc_runtime_free(runtime); });
+
+  struct xls_value* input = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:41", &error, &input));
+  absl::Cleanup free_input([input] { xls_value_free(input); });
+  ASSERT_TRUE(xls_proc_runtime_enqueue_value(runtime, "in", input, &error));
+  ASSERT_TRUE(xls_proc_runtime_tick(runtime, &error));
+
+  struct xls_value* output = nullptr;
+  ASSERT_TRUE(xls_proc_runtime_dequeue_value(runtime, "out", &error, &output));
+  ASSERT_NE(output, nullptr);
+  absl::Cleanup free_output([output] { xls_value_free(output); });
+  char* output_str = nullptr;
+  ASSERT_TRUE(xls_value_to_string(output, &output_str));
+  absl::Cleanup free_output_str([output_str] { xls_c_str_free(output_str); });
+  EXPECT_EQ(std::string_view(output_str), "bits[32]:42");
+
+  struct xls_value* empty = nullptr;
+  ASSERT_TRUE(xls_proc_runtime_dequeue_value(runtime, "out", &error, &empty));
+  EXPECT_EQ(empty, nullptr);
+
+  // The same, through raw buffers in native layout.
+  size_t element_size = 0;
+  ASSERT_TRUE(xls_proc_runtime_get_channel_element_size(runtime, "in", &error,
+                                                        &element_size));
+  ASSERT_EQ(element_size, sizeof(uint32_t));
+  uint32_t inputs[] = {1, 2, 3};
+  ASSERT_TRUE(xls_proc_runtime_enqueue_raw(
+      runtime, "in", reinterpret_cast<const uint8_t*>(inputs), 3, &error));
+  for (int64_t i = 0; i < 3; ++i) {
+    ASSERT_TRUE(xls_proc_runtime_tick(runtime, &error));
+  }
+  uint32_t outputs[4] = {};
+  size_t count = 0;
+  ASSERT_TRUE(xls_proc_runtime_dequeue_raw(runtime, "out",
+                                           reinterpret_cast<uint8_t*>(outputs),
+                                           4, &error, &count));
+  EXPECT_EQ(count, 3);
+  EXPECT_THAT(outputs, testing::ElementsAre(2, 3, 4, 0));
+
+  EXPECT_FALSE(xls_proc_runtime_enqueue_value(runtime, "nope", input, &error));
+  absl::Cleanup free_error([error] { xls_c_str_free(error); });
+  EXPECT_THAT(error, HasSubstr("nope"));
+}
+
 TEST(XlsCApiTest, ParsePackageAndOptimizeFunctionInIt) {
   const std::string kPackage = R"(
 package p
@@ -0,0 +1,106 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/critical_path_distances.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+/* static */ CriticalPathDistances CriticalPathDistances::Compute(
+    absl::Span<Node* const> topo_sort,
+    absl::FunctionRef<int64_t(Node*)> node_delay,
+    std::optional<int64_t> max_start_distance) {
+  CriticalPathDistances result;
+  result.max_start_distance_ = max_start_distance;
+  result.nodes_.assign(topo_sort.begin(), topo_sort.end());
+  result.node_to_index_.reserve(topo_sort.size());
+  for (int32_t i = 0; i < topo_sort.size(); ++i) {
+    result.node_to_index_[topo_sort[i]] = i;
+  }
+  result.offsets_.reserve(topo_sort.size() + 1);
+  result.offsets_.push_back(0);
+
+  // Scratch space for merging the rows of a node's operands; `best[a]` is the
+  // longest distance from `a` to any operand seen so far, or -1 if none.
+  std::vector<int64_t> best(topo_sort.size(), -1);
+  std::vector<int32_t> touched;
+  for (int32_t target = 0; target < topo_sort.size(); ++target) {
+    Node* node = topo_sort[target];
+    int64_t delay = node_delay(node);
+
+    // The critical-path distance from `a` to `node` extends the critical path
+    // from `a` to one of `node`'s operands by `delay`. Paths which already
+    // reach past the bound at the end of the operand can't matter for `node`
+    // or anything after it, so they aren't extended.
+    for (Node* operand : node->operands()) {
+      int32_t operand_index = result.node_to_index_.at(operand);
+      absl::Span<const int32_t> sources = result.SourcesTo(operand_index);
+      absl::Span<const int64_t> distances = result.DistancesTo(operand_index);
+      for (int64_t i = 0; i < sources.size(); ++i) {
+        if (max_start_distance.has_value() &&
+            distances[i] > *max_start_distance) {
+          continue;
+        }
+        if (best[sources[i]] < 0) {
+          touched.push_back(sources[i]);
+        }
+        best[sources[i]] = std::max(best[sources[i]], distances[i]);
+      }
+    }
+
+    std::sort(touched.begin(), touched.end());
+    for (int32_t source : touched) {
+      result.sources_.push_back(source);
+      result.distances_.push_back(best[source] + delay);
+      best[source] = -1;
+    }
+    touched.clear();
+    // The critical path from `node` to `node` is always `delay` long.
+    result.sources_.push_back(target);
+    result.distances_.push_back(delay);
+    result.offsets_.push_back(result.sources_.size());
+  }
+  result.sources_.shrink_to_fit();
+  result.distances_.shrink_to_fit();
+  return result;
+}
+
+std::optional<int64_t> CriticalPathDistances::PairIndex(int32_t from,
+                                                        int32_t to) const {
+  absl::Span<const int32_t> sources = SourcesTo(to);
+  auto it = std::lower_bound(sources.begin(), sources.end(), from);
+  if (it == sources.end() || *it != from) {
+    return std::nullopt;
+  }
+  return offsets_[to] + (it - sources.begin());
+}
+
+std::optional<int64_t> CriticalPathDistances::GetDistance(Node* from,
+                                                          Node* to) const {
+  std::optional<int64_t> pair = PairIndex(index(from), index(to));
+  if (!pair.has_value()) {
+    return std::nullopt;
+  }
+  return distances_[*pair];
+}
+
+}  // namespace xls
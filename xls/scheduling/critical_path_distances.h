@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_CRITICAL_PATH_DISTANCES_H_
+#define XLS_SCHEDULING_CRITICAL_PATH_DISTANCES_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Critical-path distances between pairs of nodes in a function or proc. The
+// distance from node `a` to node `b` is the length of the longest delay path
+// from `a`'s start to `b`'s end, which includes the delays of both endpoints;
+// the distance from a node to itself is its own delay.
+//
+// Only pairs connected by a path are stored, in compressed sparse row form
+// keyed by the target of the path: the entries for each target are contiguous
+// and sorted by source. Nodes are identified by their position in the
+// topological order the distances were computed with.
+class CriticalPathDistances {
+ public:
+  // Computes the distances between all pairs of nodes in `topo_sort` connected
+  // by a path.
+  //
+  // If `max_start_distance` is given, paths are pruned once the distance to
+  // the start of their target exceeds it; i.e., the pair (`a`, `b`) is only
+  // guaranteed to be present, with its exact distance, if
+  //
+  //   distance(a, b) - delay(b) <= max_start_distance
+  //
+  // Other pairs may be missing, or be present with a distance which
+  // underestimates the true one. This is all that's needed to find the pairs of
+  // nodes which must be separated by a pipeline register for any clock period
+  // up to `max_start_distance`, and keeps the size of the result proportional
+  // to the number of pairs within the bound rather than the square of the
+  // number of nodes.
+  static CriticalPathDistances Compute(
+      absl::Span<Node* const> topo_sort,
+      absl::FunctionRef<int64_t(Node*)> node_delay,
+      std::optional<int64_t> max_start_distance = std::nullopt);
+
+  int64_t node_count() const { return nodes_.size(); }
+  int64_t pair_count() const { return sources_.size(); }
+  std::optional<int64_t> max_start_distance() const {
+    return max_start_distance_;
+  }
+
+  Node* node(int32_t index) const { return nodes_[index]; }
+  int32_t index(Node* node) const { return node_to_index_.at(node); }
+  bool contains(Node* node) const { return node_to_index_.contains(node); }
+
+  // The sources of the paths ending at `target`, in increasing order, and the
+  // corresponding distances.
+  absl::Span<const int32_t> SourcesTo(int32_t target) const {
+    return absl::MakeConstSpan(sources_).subspan(
+        offsets_[target], offsets_[target + 1] - offsets_[target]);
+  }
+  absl::Span<const int64_t> DistancesTo(int32_t target) const {
+    return absl::MakeConstSpan(distances_)
+        .subspan(offsets_[target], offsets_[target + 1] - offsets_[target]);
+  }
+  absl::Span<int64_t> MutableDistancesTo(int32_t target) {
+    return absl::MakeSpan(distances_).subspan(
+        offsets_[target], offsets_[target + 1] - offsets_[target]);
+  }
+
+  // Returns the position of the pair (`from`, `to`) among all stored pairs
+  // (the entries for `to` start at position `RowOffset(to)`), or std::nullopt
+  // if it isn't present.
+  std::optional<int64_t> PairIndex(int32_t from, int32_t to) const;
+  int64_t RowOffset(int32_t target) const { return offsets_[target]; }
+
+  // Returns the distance from `from` to `to`, or std::nullopt if the pair isn't
+  // present.
+  std::optional<int64_t> GetDistance(Node* from, Node* to) const;
+
+ private:
+  std::vector<Node*> nodes_;
+  absl::flat_hash_map<Node*, int32_t> node_to_index_;
+  std::optional<int64_t> max_start_distance_;
+
+  // Entries for target `i` are at positions [offsets_[i], offsets_[i + 1]).
+  std::vector<int64_t> offsets_;
+  std::vector<int32_t> sources_;
+  std::vector<int64_t> distances_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_CRITICAL_PATH_DISTANCES_H_
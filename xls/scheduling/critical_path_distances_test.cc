@@ -0,0 +1,124 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/critical_path_distances.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+class CriticalPathDistancesTest : public IrTestBase {};
+
+// Params are free; every other node has a delay of 1.
+int64_t UnitDelay(Node* node) { return node->Is<Param>() ? 0 : 1; }
+
+TEST_F(CriticalPathDistancesTest, AllPairs) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue a = fb.Add(x, y);
+  BValue b = fb.Not(a);
+  BValue c = fb.Subtract(b, x);
+  BValue d = fb.UMul(a, c);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(d));
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  CriticalPathDistances distances =
+      CriticalPathDistances::Compute(topo_sort, UnitDelay);
+  EXPECT_EQ(distances.node_count(), f->node_count());
+  EXPECT_EQ(distances.max_start_distance(), std::nullopt);
+
+  EXPECT_THAT(distances.GetDistance(x.node(), x.node()), Optional(0));
+  EXPECT_THAT(distances.GetDistance(a.node(), a.node()), Optional(1));
+  EXPECT_THAT(distances.GetDistance(x.node(), a.node()), Optional(1));
+  EXPECT_THAT(distances.GetDistance(a.node(), c.node()), Optional(3));
+  // The longest path from `a` to `d` goes through `b` and `c`.
+  EXPECT_THAT(distances.GetDistance(a.node(), d.node()), Optional(4));
+  EXPECT_THAT(distances.GetDistance(x.node(), d.node()), Optional(4));
+  EXPECT_THAT(distances.GetDistance(c.node(), d.node()), Optional(2));
+  EXPECT_EQ(distances.GetDistance(d.node(), a.node()), std::nullopt);
+  EXPECT_EQ(distances.GetDistance(x.node(), y.node()), std::nullopt);
+
+  int32_t d_index = distances.index(d.node());
+  EXPECT_EQ(distances.node(d_index), d.node());
+  absl::Span<const int32_t> sources = distances.SourcesTo(d_index);
+  EXPECT_TRUE(std::is_sorted(sources.begin(), sources.end()));
+  // Every node reaches `d`.
+  EXPECT_EQ(sources.size(), f->node_count());
+  EXPECT_THAT(distances.SourcesTo(distances.index(x.node())),
+              ElementsAre(distances.index(x.node())));
+}
+
+TEST_F(CriticalPathDistancesTest, PrunedDistances) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  // A long chain with a short path from its start to its end.
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  std::vector<BValue> chain = {x};
+  for (int64_t i = 0; i < 10; ++i) {
+    chain.push_back(fb.Not(chain.back()));
+  }
+  BValue shortcut = fb.Add(x, chain.back());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(shortcut));
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  CriticalPathDistances all =
+      CriticalPathDistances::Compute(topo_sort, UnitDelay);
+  constexpr int64_t kBound = 3;
+  CriticalPathDistances pruned =
+      CriticalPathDistances::Compute(topo_sort, UnitDelay, kBound);
+  EXPECT_EQ(pruned.max_start_distance(), kBound);
+  EXPECT_LT(pruned.pair_count(), all.pair_count());
+
+  for (Node* to : topo_sort) {
+    for (Node* from : topo_sort) {
+      std::optional<int64_t> distance = all.GetDistance(from, to);
+      std::optional<int64_t> pruned_distance = pruned.GetDistance(from, to);
+      if (!distance.has_value()) {
+        EXPECT_EQ(pruned_distance, std::nullopt);
+      } else if (*distance - UnitDelay(to) <= kBound) {
+        EXPECT_EQ(pruned_distance, distance);
+      } else if (pruned_distance.has_value()) {
+        EXPECT_LE(*pruned_distance, *distance);
+      }
+    }
+  }
+
+  // Paths along the chain are dropped once they exceed the bound.
+  EXPECT_THAT(all.GetDistance(x.node(), shortcut.node()), Optional(11));
+  EXPECT_EQ(pruned.GetDistance(chain[1].node(), shortcut.node()),
+            std::nullopt);
+}
+
+}  // namespace
+}  // namespace xls
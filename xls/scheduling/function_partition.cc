@@ -33,7 +33,8 @@ namespace xls {
 namespace sched {
 
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes) {
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::PushRelabelMinCut* solver) {
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Computing min-cut of function " << f->name()
             << ", partitionable nodes:";
@@ -168,7 +169,8 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   }
 
   min_cut::GraphCut graph_cut =
-      min_cut::MinCutBetweenNodes(graph, source, sink);
+      solver == nullptr ? min_cut::MinCutBetweenNodes(graph, source, sink)
+                        : solver->MinCutBetweenNodes(graph, source, sink);
 
   // Map the mincut graph partition back to the XLS graph.
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
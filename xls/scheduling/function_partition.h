@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "absl/types/span.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -52,8 +53,13 @@ namespace sched {
 //
 // Returns the two partitions as a std::pair. The first element is the
 // predecessor partition of the dicut (partition A in the example above).
+//
+// If 'solver' is given the cut is computed with it, reusing its storage from
+// earlier partitions; otherwise min_cut::MinCutBetweenNodes is used. The
+// partition is the same either way.
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes);
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::PushRelabelMinCut* solver = nullptr);
 
 }  // namespace sched
 }  // namespace xls
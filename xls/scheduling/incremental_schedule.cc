@@ -0,0 +1,230 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/incremental_schedule.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/estimate_cache.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+namespace {
+
+// The initial number of edges from a changed node within which nodes may
+// move.
+constexpr int64_t kInitialConeRadius = 2;
+
+absl::flat_hash_map<std::string, int64_t> PriorCycles(
+    const PipelineScheduleProto& prior_schedule) {
+  absl::flat_hash_map<std::string, int64_t> cycles;
+  for (const StageProto& stage : prior_schedule.stages()) {
+    for (const TimedNodeProto& timed_node : stage.timed_nodes()) {
+      cycles[timed_node.node()] = stage.stage();
+    }
+  }
+  return cycles;
+}
+
+// Returns whether `node` differs from its namesake `prior` in anything
+// affecting its schedule.
+bool NodeChanged(Node* node, Node* prior) {
+  if (NodeSignature(node) != NodeSignature(prior)) {
+    return true;
+  }
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    if (node->operand(i)->GetName() != prior->operand(i)->GetName()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the nodes at most `radius` edges, in either direction, from any of
+// `changed_nodes`.
+absl::flat_hash_set<Node*> ConeAround(absl::Span<Node* const> changed_nodes,
+                                      int64_t radius) {
+  absl::flat_hash_set<Node*> cone(changed_nodes.begin(), changed_nodes.end());
+  std::vector<Node*> frontier(changed_nodes.begin(), changed_nodes.end());
+  for (int64_t distance = 0; distance < radius && !frontier.empty();
+       ++distance) {
+    std::vector<Node*> next_frontier;
+    auto visit = [&](Node* neighbor) {
+      if (cone.insert(neighbor).second) {
+        next_frontier.push_back(neighbor);
+      }
+    };
+    for (Node* node : frontier) {
+      for (Node* operand : node->operands()) {
+        visit(operand);
+      }
+      for (Node* user : node->users()) {
+        visit(user);
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  return cone;
+}
+
+}  // namespace
+
+std::string IncrementalScheduleReport::ToString() const {
+  std::string result = absl::StrFormat(
+      "%d changed node(s), %d removed node(s); rescheduled %d node(s) %s\n",
+      changed_nodes.size(), removed_nodes.size(), rescheduled_node_count,
+      cone_radius.has_value()
+          ? absl::StrFormat("within %d edge(s) of a change", *cone_radius)
+          : "(full reschedule)");
+  absl::StrAppendFormat(&result, "%d node(s) moved\n", moves.size());
+  for (const ScheduleMove& move : moves) {
+    absl::StrAppendFormat(&result, "  %s: cycle %d -> %d\n",
+                          move.node->GetName(), move.prior_cycle, move.cycle);
+  }
+  return result;
+}
+
+std::vector<Node*> FindChangedNodes(
+    FunctionBase* f, const PipelineScheduleProto& prior_schedule,
+    std::optional<FunctionBase*> prior_function) {
+  absl::flat_hash_map<std::string, int64_t> prior_cycles =
+      PriorCycles(prior_schedule);
+  absl::flat_hash_map<std::string, Node*> prior_nodes;
+  if (prior_function.has_value()) {
+    for (Node* node : (*prior_function)->nodes()) {
+      prior_nodes[node->GetName()] = node;
+    }
+  }
+  std::vector<Node*> changed;
+  for (Node* node : TopoSort(f)) {
+    if (!prior_cycles.contains(node->GetName())) {
+      changed.push_back(node);
+      continue;
+    }
+    if (!prior_function.has_value()) {
+      continue;
+    }
+    auto it = prior_nodes.find(node->GetName());
+    if (it == prior_nodes.end() || NodeChanged(node, it->second)) {
+      changed.push_back(node);
+    }
+  }
+  return changed;
+}
+
+absl::StatusOr<IncrementalScheduleResult> RunIncrementalPipelineSchedule(
+    FunctionBase* f, const PipelineScheduleProto& prior_schedule,
+    const DelayEstimator& delay_estimator, const SchedulingOptions& options,
+    std::optional<FunctionBase*> prior_function) {
+  if (options.strategy() != SchedulingStrategy::SDC) {
+    return absl::InvalidArgumentError(
+        "Incremental scheduling requires the SDC scheduling strategy.");
+  }
+  absl::flat_hash_map<std::string, int64_t> prior_cycles =
+      PriorCycles(prior_schedule);
+  int64_t prior_length = 0;
+  for (const auto& [name, cycle] : prior_cycles) {
+    prior_length = std::max(prior_length, cycle + 1);
+  }
+
+  IncrementalScheduleReport report;
+  report.changed_nodes = FindChangedNodes(f, prior_schedule, prior_function);
+  absl::flat_hash_set<std::string> node_names;
+  for (Node* node : f->nodes()) {
+    node_names.insert(node->GetName());
+  }
+  for (const StageProto& stage : prior_schedule.stages()) {
+    for (const TimedNodeProto& timed_node : stage.timed_nodes()) {
+      if (!node_names.contains(timed_node.node())) {
+        report.removed_nodes.push_back(timed_node.node());
+      }
+    }
+  }
+
+  SchedulingOptions pinned_options = options;
+  // Partitioned scheduling doesn't support NodeInCycleConstraints.
+  pinned_options.schedule_partitions(1);
+  if (!options.pipeline_stages().has_value()) {
+    pinned_options.pipeline_stages(prior_length);
+  }
+  std::optional<PipelineSchedule> schedule;
+  int64_t previous_cone_size = -1;
+  for (int64_t radius = kInitialConeRadius;; radius *= 2) {
+    absl::flat_hash_set<Node*> cone = ConeAround(report.changed_nodes, radius);
+    // Stop once the cone covers the function or stops growing, which happens
+    // when the changes are confined to part of the graph.
+    if (cone.size() == f->node_count() || cone.size() == previous_cone_size) {
+      break;
+    }
+    previous_cone_size = cone.size();
+    SchedulingOptions attempt_options = pinned_options;
+    for (Node* node : f->nodes()) {
+      if (!cone.contains(node)) {
+        attempt_options.add_constraint(
+            NodeInCycleConstraint(node, prior_cycles.at(node->GetName())));
+      }
+    }
+    absl::StatusOr<PipelineSchedule> attempt =
+        RunPipelineSchedule(f, delay_estimator, attempt_options);
+    if (attempt.ok()) {
+      schedule = *std::move(attempt);
+      report.rescheduled_node_count = cone.size();
+      report.cone_radius = radius;
+      break;
+    }
+    VLOG(2) << absl::StreamFormat(
+        "Unable to reschedule %s within %d edge(s) of a change: %s", f->name(),
+        radius, attempt.status().message());
+  }
+  if (!schedule.has_value()) {
+    VLOG(1) << "Rescheduling all of " << f->name();
+    XLS_ASSIGN_OR_RETURN(schedule,
+                         RunPipelineSchedule(f, delay_estimator, options));
+    report.rescheduled_node_count = f->node_count();
+  }
+
+  for (Node* node : TopoSort(f)) {
+    auto it = prior_cycles.find(node->GetName());
+    if (it != prior_cycles.end() && it->second != schedule->cycle(node)) {
+      report.moves.push_back(ScheduleMove{.node = node,
+                                          .prior_cycle = it->second,
+                                          .cycle = schedule->cycle(node)});
+    }
+  }
+  return IncrementalScheduleResult{.schedule = *std::move(schedule),
+                                   .report = std::move(report)};
+}
+
+}  // namespace xls
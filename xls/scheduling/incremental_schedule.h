@@ -0,0 +1,94 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_INCREMENTAL_SCHEDULE_H_
+#define XLS_SCHEDULING_INCREMENTAL_SCHEDULE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// A node whose cycle differs from the prior schedule.
+struct ScheduleMove {
+  Node* node;
+  int64_t prior_cycle;
+  int64_t cycle;
+};
+
+// Describes how an incremental schedule differs from the prior schedule.
+struct IncrementalScheduleReport {
+  // The nodes found to have changed since the prior schedule, in topological
+  // order.
+  std::vector<Node*> changed_nodes;
+
+  // The names of nodes in the prior schedule which no longer exist.
+  std::vector<std::string> removed_nodes;
+
+  // The number of nodes which were free to move; every other node was pinned
+  // to its prior cycle.
+  int64_t rescheduled_node_count = 0;
+
+  // How many edges away from a changed node a node could be and still move.
+  // Unset if the whole function was rescheduled.
+  std::optional<int64_t> cone_radius;
+
+  // The nodes of the prior schedule which moved, in topological order.
+  std::vector<ScheduleMove> moves;
+
+  std::string ToString() const;
+};
+
+struct IncrementalScheduleResult {
+  PipelineSchedule schedule;
+  IncrementalScheduleReport report;
+};
+
+// Returns the nodes of `f`, in topological order, which can't be pinned to
+// their cycle in `prior_schedule`: nodes which aren't in it and, if
+// `prior_function` (the version of `f` which was scheduled) is given, nodes
+// whose operation, attributes or operands differ from the node of the same
+// name in `prior_function`. Nodes are matched by name.
+std::vector<Node*> FindChangedNodes(
+    FunctionBase* f, const PipelineScheduleProto& prior_schedule,
+    std::optional<FunctionBase*> prior_function = std::nullopt);
+
+// Schedules `f`, an edited version of the function scheduled by
+// `prior_schedule`, by re-solving only the neighborhood of the changed nodes:
+// every node further than some radius from a changed node is pinned to its
+// prior cycle with a NodeInCycleConstraint. If that is infeasible the radius is
+// doubled, and if the neighborhood grows to cover the whole function, `f` is
+// scheduled from scratch with `options`.
+//
+// Unless `options` fixes the pipeline length, the prior length is kept while
+// any nodes are pinned. Requires the SDC strategy, which is the only one
+// supporting NodeInCycleConstraints.
+absl::StatusOr<IncrementalScheduleResult> RunIncrementalPipelineSchedule(
+    FunctionBase* f, const PipelineScheduleProto& prior_schedule,
+    const DelayEstimator& delay_estimator, const SchedulingOptions& options,
+    std::optional<FunctionBase*> prior_function = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_INCREMENTAL_SCHEDULE_H_
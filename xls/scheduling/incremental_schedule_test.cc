@@ -0,0 +1,181 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/incremental_schedule.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+namespace m = ::xls::op_matchers;
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr int64_t kChainLength = 8;
+
+// Builds two independent chains of adds, "a0".."a7" on `x` and "b0".."b7" on
+// `y`, returning both ends in a tuple. If `edit` is set, a4 instead adds a new
+// node "not_x" to a3.
+absl::StatusOr<Function*> BuildChains(Package* p, bool edit) {
+  FunctionBuilder fb("chains", p);
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue not_x = edit ? fb.Not(x, SourceInfo(), "not_x") : x;
+  BValue a = x;
+  BValue b = y;
+  for (int64_t i = 0; i < kChainLength; ++i) {
+    a = fb.Add(a, i == 4 ? not_x : x, SourceInfo(), absl::StrCat("a", i));
+    b = fb.Add(b, y, SourceInfo(), absl::StrCat("b", i));
+  }
+  return fb.BuildWithReturnValue(fb.Tuple({a, b}, SourceInfo(), "result"));
+}
+
+class IncrementalScheduleTest : public IrTestBase {
+ protected:
+  SchedulingOptions Options() const {
+    return SchedulingOptions().clock_period_ps(3);
+  }
+};
+
+TEST_F(IncrementalScheduleTest, FindChangedNodes) {
+  const DelayEstimator& estimator = *GetDelayEstimator("unit").value();
+  auto prior_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * prior,
+                           BuildChains(prior_package.get(), false));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule prior_schedule,
+                           RunPipelineSchedule(prior, estimator, Options()));
+  PipelineScheduleProto prior_proto = prior_schedule.ToProto(estimator);
+
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChains(package.get(), true));
+  // Without the prior function only new nodes are found.
+  EXPECT_THAT(FindChangedNodes(f, prior_proto),
+              ElementsAre(m::Name("not_x")));
+  EXPECT_THAT(FindChangedNodes(f, prior_proto, prior),
+              ElementsAre(m::Name("not_x"), m::Name("a4")));
+  EXPECT_THAT(FindChangedNodes(prior, prior_proto, prior), IsEmpty());
+}
+
+TEST_F(IncrementalScheduleTest, PinsNodesAwayFromTheChange) {
+  const DelayEstimator& estimator = *GetDelayEstimator("unit").value();
+  auto prior_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * prior,
+                           BuildChains(prior_package.get(), false));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule prior_schedule,
+                           RunPipelineSchedule(prior, estimator, Options()));
+  PipelineScheduleProto prior_proto = prior_schedule.ToProto(estimator);
+
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChains(package.get(), true));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      IncrementalScheduleResult result,
+      RunIncrementalPipelineSchedule(f, prior_proto, estimator, Options(),
+                                     prior));
+  const PipelineSchedule& schedule = result.schedule;
+  XLS_ASSERT_OK(schedule.Verify());
+  XLS_ASSERT_OK(schedule.VerifyTiming(3, estimator));
+  EXPECT_EQ(schedule.length(), prior_schedule.length());
+
+  const IncrementalScheduleReport& report = result.report;
+  EXPECT_THAT(report.changed_nodes,
+              ElementsAre(m::Name("not_x"), m::Name("a4")));
+  EXPECT_THAT(report.removed_nodes, IsEmpty());
+  EXPECT_TRUE(report.cone_radius.has_value());
+  EXPECT_LT(report.rescheduled_node_count, f->node_count());
+  // The b chain is unrelated to the change and keeps its schedule.
+  for (int64_t i = 0; i < kChainLength; ++i) {
+    std::string name = absl::StrCat("b", i);
+    XLS_ASSERT_OK_AND_ASSIGN(Node * node, f->GetNode(name));
+    XLS_ASSERT_OK_AND_ASSIGN(Node * prior_node, prior->GetNode(name));
+    EXPECT_EQ(schedule.cycle(node), prior_schedule.cycle(prior_node)) << name;
+  }
+  for (const ScheduleMove& move : report.moves) {
+    XLS_ASSERT_OK_AND_ASSIGN(Node * prior_node,
+                             prior->GetNode(move.node->GetName()));
+    EXPECT_EQ(move.prior_cycle, prior_schedule.cycle(prior_node));
+    EXPECT_EQ(move.cycle, schedule.cycle(move.node));
+    EXPECT_NE(move.prior_cycle, move.cycle);
+  }
+}
+
+TEST_F(IncrementalScheduleTest, UnchangedFunctionKeepsSchedule) {
+  const DelayEstimator& estimator = *GetDelayEstimator("unit").value();
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChains(p.get(), false));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule prior_schedule,
+                           RunPipelineSchedule(f, estimator, Options()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      IncrementalScheduleResult result,
+      RunIncrementalPipelineSchedule(
+          f, prior_schedule.ToProto(estimator), estimator, Options(), f));
+  EXPECT_EQ(result.report.rescheduled_node_count, 0);
+  EXPECT_THAT(result.report.moves, IsEmpty());
+  EXPECT_EQ(result.schedule.GetCycleMap(), prior_schedule.GetCycleMap());
+}
+
+TEST_F(IncrementalScheduleTest, RemovedNodesAreReported) {
+  const DelayEstimator& estimator = *GetDelayEstimator("unit").value();
+  auto edited_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * edited,
+                           BuildChains(edited_package.get(), true));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule prior_schedule,
+                           RunPipelineSchedule(edited, estimator, Options()));
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChains(p.get(), false));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      IncrementalScheduleResult result,
+      RunIncrementalPipelineSchedule(f, prior_schedule.ToProto(estimator),
+                                     estimator, Options(), edited));
+  XLS_ASSERT_OK(result.schedule.Verify());
+  EXPECT_THAT(result.report.removed_nodes, ElementsAre("not_x"));
+  EXPECT_THAT(result.report.changed_nodes, ElementsAre(m::Name("a4")));
+}
+
+TEST_F(IncrementalScheduleTest, RequiresSdc) {
+  const DelayEstimator& estimator = *GetDelayEstimator("unit").value();
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildChains(p.get(), false));
+  EXPECT_THAT(RunIncrementalPipelineSchedule(
+                  f, PipelineScheduleProto(), estimator,
+                  Options().strategy(SchedulingStrategy::ASAP)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <utility>
@@ -24,6 +25,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -33,11 +35,16 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/scheduling/function_partition.h"
+#include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
 
@@ -47,24 +54,26 @@ namespace {
 
 // Splits the nodes at the boundary between 'cycle' and 'cycle + 1' by
 // performing a minimum cost cut and tightens the bounds accordingly. Upon
-// return no node in the function will have a range which spans both 'cycle' and
+// return no node in 'nodes' will have a range which spans both 'cycle' and
 // 'cycle + 1'.
-absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
+absl::Status SplitAfterCycle(FunctionBase* f, absl::Span<Node* const> nodes,
+                             int64_t cycle,
                              const DelayEstimator& delay_estimator,
+                             min_cut::PushRelabelMinCut* solver,
                              sched::ScheduleBounds* bounds) {
   VLOG(3) << "Splitting after cycle " << cycle;
 
   // The nodes which need to be partitioned are those which can be scheduled in
   // either 'cycle' or 'cycle + 1'.
   std::vector<Node*> partitionable_nodes;
-  for (Node* node : f->nodes()) {
+  for (Node* node : nodes) {
     if (bounds->lb(node) <= cycle && bounds->ub(node) >= cycle + 1) {
       partitionable_nodes.push_back(node);
     }
   }
 
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions =
-      sched::MinCostFunctionPartition(f, partitionable_nodes);
+      sched::MinCostFunctionPartition(f, partitionable_nodes, solver);
 
   // Tighten bounds based on the cut.
   for (Node* node : partitions.first) {
@@ -77,17 +86,99 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   return absl::OkStatus();
 }
 
+// Partitions 'nodes' at each cycle boundary in 'cut_order' in turn, splitting
+// the nodes into those which must be scheduled at or before the cycle and
+// those which must be scheduled after. Upon return each node will have a range
+// of exactly one cycle.
+//
+// Once the nodes are split after a cycle no node spans it, so the later cuts
+// before and after that cycle divide disjoint sets of nodes. With more than one
+// thread these are made concurrently, the earlier ones on a copy of the bounds
+// which is merged back afterwards. The result doesn't depend on
+// 'thread_count'.
+absl::Status SplitAtCycles(FunctionBase* f, absl::Span<Node* const> nodes,
+                           absl::Span<const int64_t> cut_order,
+                           const DelayEstimator& delay_estimator,
+                           int64_t thread_count,
+                           min_cut::PushRelabelMinCut* solver,
+                           sched::ScheduleBounds* bounds) {
+  if (thread_count <= 1) {
+    for (int64_t cycle : cut_order) {
+      XLS_RETURN_IF_ERROR(
+          SplitAfterCycle(f, nodes, cycle, delay_estimator, solver, bounds));
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+    }
+    return absl::OkStatus();
+  }
+  if (cut_order.empty()) {
+    return absl::OkStatus();
+  }
+
+  const int64_t cycle = cut_order.front();
+  XLS_RETURN_IF_ERROR(
+      SplitAfterCycle(f, nodes, cycle, delay_estimator, solver, bounds));
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+
+  std::vector<int64_t> earlier_cuts;
+  std::vector<int64_t> later_cuts;
+  for (int64_t c : cut_order.subspan(1)) {
+    (c < cycle ? earlier_cuts : later_cuts).push_back(c);
+  }
+  std::vector<Node*> earlier_nodes;
+  std::vector<Node*> later_nodes;
+  for (Node* node : nodes) {
+    if (bounds->ub(node) <= cycle) {
+      earlier_nodes.push_back(node);
+    } else {
+      XLS_RET_CHECK_GT(bounds->lb(node), cycle) << node->GetName();
+      later_nodes.push_back(node);
+    }
+  }
+  if (earlier_cuts.empty() || later_cuts.empty()) {
+    return SplitAtCycles(f, earlier_cuts.empty() ? later_nodes : earlier_nodes,
+                         earlier_cuts.empty() ? later_cuts : earlier_cuts,
+                         delay_estimator, thread_count, solver, bounds);
+  }
+
+  const int64_t earlier_thread_count = thread_count / 2;
+  sched::ScheduleBounds earlier_bounds = *bounds;
+  absl::Status earlier_status;
+  auto split_earlier = [&]() {
+    min_cut::PushRelabelMinCut earlier_solver;
+    earlier_status =
+        SplitAtCycles(f, earlier_nodes, earlier_cuts, delay_estimator,
+                      earlier_thread_count, &earlier_solver, &earlier_bounds);
+  };
+  auto thread = std::make_unique<Thread>(split_earlier);
+  absl::Status later_status =
+      SplitAtCycles(f, later_nodes, later_cuts, delay_estimator,
+                    thread_count - earlier_thread_count, solver, bounds);
+  thread->Join();
+  XLS_RETURN_IF_ERROR(earlier_status);
+  XLS_RETURN_IF_ERROR(later_status);
+  for (Node* node : earlier_nodes) {
+    XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, earlier_bounds.ub(node)));
+    XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, earlier_bounds.lb(node)));
+  }
+  return absl::OkStatus();
+}
+
 // Returns the number of pipeline registers (flops) on the interior of the
-// pipeline not counting the input and output flops (if any).
+// pipeline not counting the input and output flops (if any) for the values of
+// 'nodes'. Only uses by nodes held in 'bounds' are counted.
 absl::StatusOr<int64_t> CountInteriorPipelineRegisters(
-    FunctionBase* f, const sched::ScheduleBounds& bounds) {
+    absl::Span<Node* const> nodes, const sched::ScheduleBounds& bounds) {
   int64_t registers = 0;
-  for (Node* node : f->nodes()) {
+  for (Node* node : nodes) {
     XLS_RET_CHECK_EQ(bounds.lb(node), bounds.ub(node)) << absl::StrFormat(
         "%s [%d, %d]", node->GetName(), bounds.lb(node), bounds.ub(node));
     int64_t latest_use = bounds.lb(node);
     for (Node* user : node->users()) {
-      latest_use = std::max(latest_use, bounds.lb(user));
+      if (bounds.contains(user)) {
+        latest_use = std::max(latest_use, bounds.lb(user));
+      }
     }
     registers +=
         node->GetType()->GetFlatBitCount() * (latest_use - bounds.lb(node));
@@ -118,45 +209,11 @@ std::vector<int64_t> MiddleFirstOrder(int64_t first, int64_t last) {
   return ret;
 }
 
-}  // namespace
-
-std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
-  if (length == 0) {
-    return {{}};
-  }
-  if (length == 1) {
-    return {{0}};
-  }
-  if (length == 2) {
-    return {{0, 1}, {1, 0}};
-  }
-  // For lengths greater than 2, return forward, reverse and middle first
-  // orderings.
-  std::vector<std::vector<int64_t>> orders;
-  std::vector<int64_t> forward(length);
-  std::iota(forward.begin(), forward.end(), 0);
-  orders.push_back(forward);
-
-  std::vector<int64_t> reverse(length);
-  std::iota(reverse.begin(), reverse.end(), 0);
-  std::reverse(reverse.begin(), reverse.end());
-  orders.push_back(reverse);
-
-  orders.push_back(MiddleFirstOrder(0, length - 1));
-  return orders;
-}
-
-absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
-    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
-    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints) {
-  VLOG(3) << "MinCutScheduler()";
-  VLOG(3) << "  pipeline stages = " << pipeline_stages;
-  XLS_VLOG_LINES(4, f->DumpIr());
-
-  VLOG(4) << "Initial bounds:";
-  XLS_VLOG_LINES(4, bounds->ToString());
-
+// Applies the constraints supported by the min-cut scheduler to 'bounds'.
+absl::Status ApplyConstraints(
+    FunctionBase* f, int64_t pipeline_stages,
+    absl::Span<const SchedulingConstraint> constraints,
+    sched::ScheduleBounds* bounds) {
   for (const SchedulingConstraint& constraint : constraints) {
     if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
       for (Node* node : f->nodes()) {
@@ -194,42 +251,324 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
       XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
     }
   }
+  return absl::OkStatus();
+}
 
+// Schedules 'nodes' by splitting them at each cycle boundary. 'bounds' must
+// hold every node in 'nodes' and every node adjacent to one, and the bounds of
+// adjacent nodes not in 'nodes' must already be fixed to a single cycle. Up to
+// 'thread_count' threads are used; the schedule doesn't depend on the count.
+absl::StatusOr<ScheduleCycleMap> ScheduleNodes(
+    FunctionBase* f, absl::Span<Node* const> nodes, int64_t pipeline_stages,
+    const DelayEstimator& delay_estimator, int64_t thread_count,
+    sched::ScheduleBounds* bounds) {
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
-  int64_t best_register_count = std::numeric_limits<int64_t>::max();
-  std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
+  // is performed and keep the best one. The orderings are independent, so
+  // with enough threads each is tried concurrently.
+  const std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(pipeline_stages - 1);
+  const int64_t order_count = cut_orders.size();
+  std::vector<sched::ScheduleBounds> trial_bounds(order_count, *bounds);
+  std::vector<absl::Status> trial_statuses(order_count);
+  auto try_order = [&](int64_t i, int64_t order_thread_count) {
     VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
-                                  absl::StrJoin(cut_order, ", "));
-    sched::ScheduleBounds trial_bounds = *bounds;
-    // Partition the nodes at each cycle boundary. For each iteration, this
-    // splits the nodes into those which must be scheduled at or before the
-    // cycle and those which must be scheduled after. Upon loop completion each
-    // node will have a range of exactly one cycle.
-    for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
+                                  absl::StrJoin(cut_orders[i], ", "));
+    min_cut::PushRelabelMinCut solver;
+    trial_statuses[i] =
+        SplitAtCycles(f, nodes, cut_orders[i], delay_estimator,
+                      order_thread_count, &solver, &trial_bounds[i]);
+  };
+  if (thread_count >= order_count && order_count > 1) {
+    const int64_t threads_per_order = thread_count / order_count;
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < order_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(
+          [&, i]() { try_order(i, threads_per_order); }));
+    }
+    try_order(0, thread_count - (order_count - 1) * threads_per_order);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
     }
-    XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
-                         CountInteriorPipelineRegisters(f, trial_bounds));
+  } else {
+    for (int64_t i = 0; i < order_count; ++i) {
+      try_order(i, thread_count);
+    }
+  }
+
+  int64_t best_register_count = std::numeric_limits<int64_t>::max();
+  std::optional<sched::ScheduleBounds> best_bounds;
+  for (int64_t i = 0; i < order_count; ++i) {
+    XLS_RETURN_IF_ERROR(trial_statuses[i]);
+    XLS_ASSIGN_OR_RETURN(
+        int64_t trial_register_count,
+        CountInteriorPipelineRegisters(nodes, trial_bounds[i]));
     if (!best_bounds.has_value() ||
         best_register_count > trial_register_count) {
-      best_bounds = std::move(trial_bounds);
+      best_bounds = std::move(trial_bounds[i]);
       best_register_count = trial_register_count;
     }
   }
   *bounds = std::move(*best_bounds);
 
   ScheduleCycleMap cycle_map;
-  for (Node* node : f->nodes()) {
+  for (Node* node : nodes) {
     XLS_RET_CHECK_EQ(bounds->lb(node), bounds->ub(node)) << node->GetName();
     cycle_map[node] = bounds->lb(node);
   }
   return cycle_map;
 }
 
+// Returns the representative of the region holding node 'i' in the union-find
+// forest 'parent', shortening the path to it along the way.
+int64_t FindRegion(std::vector<int64_t>& parent, int64_t i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+// Splits 'f' into about 'partition_count' regions and schedules them
+// concurrently; see PartitionedMinCutScheduler. 'bounds' is not modified.
+absl::StatusOr<ScheduleCycleMap> ScheduleRegions(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator,
+    const sched::ScheduleBounds& bounds, int64_t partition_count) {
+  std::vector<Node*> topo_sort;
+  for (Node* node : TopoSort(f)) {
+    topo_sort.push_back(node);
+  }
+  const int64_t node_count = topo_sort.size();
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  topo_index.reserve(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    topo_index[topo_sort[i]] = i;
+  }
+
+  // A value crossing between regions is fixed to a single cycle and, unless
+  // it's a parameter or literal which has no paths into it which could be
+  // lengthened, only used in a later cycle than it's produced in. Edges with
+  // no room for such a register can't be cut.
+  struct Edge {
+    int64_t bit_count;
+    int64_t producer;
+    int64_t user;
+  };
+  std::vector<Edge> edges;
+  std::vector<int64_t> parent(node_count);
+  std::iota(parent.begin(), parent.end(), 0);
+  std::vector<int64_t> region_size(node_count, 1);
+  auto merge = [&](int64_t a, int64_t b, int64_t max_size) {
+    a = FindRegion(parent, a);
+    b = FindRegion(parent, b);
+    if (a == b || region_size[a] + region_size[b] > max_size) {
+      return;
+    }
+    if (region_size[a] < region_size[b]) {
+      std::swap(a, b);
+    }
+    parent[b] = a;
+    region_size[a] += region_size[b];
+  };
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = topo_sort[i];
+    for (Node* user : node->users()) {
+      int64_t j = topo_index.at(user);
+      if (node->operand_count() > 0 && bounds.lb(node) + 1 > bounds.ub(user)) {
+        merge(i, j, std::numeric_limits<int64_t>::max());
+        continue;
+      }
+      edges.push_back(Edge{
+          .bit_count = node->GetType()->GetFlatBitCount(),
+          .producer = i,
+          .user = j,
+      });
+    }
+  }
+  // Greedily keep the widest values within a region.
+  const int64_t max_region_size =
+      (node_count + partition_count - 1) / partition_count;
+  std::stable_sort(edges.begin(), edges.end(),
+                   [](const Edge& a, const Edge& b) {
+                     return a.bit_count > b.bit_count;
+                   });
+  for (const Edge& edge : edges) {
+    merge(edge.producer, edge.user, max_region_size);
+  }
+
+  // Fix the cycles of the values crossing between regions. Registering a value
+  // can push later values into later cycles, so repeat until no more cut
+  // values need to move.
+  sched::ScheduleBounds pinned = bounds;
+  std::vector<Edge> cut_edges;
+  for (const Edge& edge : edges) {
+    if (FindRegion(parent, edge.producer) != FindRegion(parent, edge.user)) {
+      cut_edges.push_back(edge);
+    }
+  }
+  VLOG(3) << absl::StreamFormat(
+      "Partitioned %d nodes into regions of at most %d nodes; %d edges cut",
+      node_count, max_region_size, cut_edges.size());
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (const Edge& edge : cut_edges) {
+      Node* producer = topo_sort[edge.producer];
+      Node* user = topo_sort[edge.user];
+      if (producer->operand_count() > 0 &&
+          pinned.lb(user) <= pinned.lb(producer)) {
+        XLS_RETURN_IF_ERROR(
+            pinned.TightenNodeLb(user, pinned.lb(producer) + 1));
+        changed = true;
+      }
+    }
+    if (changed) {
+      XLS_RETURN_IF_ERROR(pinned.PropagateLowerBounds());
+    }
+  }
+  for (const Edge& edge : cut_edges) {
+    Node* producer = topo_sort[edge.producer];
+    XLS_RETURN_IF_ERROR(pinned.TightenNodeUb(producer, pinned.lb(producer)));
+  }
+  XLS_RETURN_IF_ERROR(pinned.PropagateUpperBounds());
+
+  // Each region is scheduled along with the fixed values it uses from other
+  // regions.
+  absl::flat_hash_map<int64_t, int64_t> region_index;
+  std::vector<std::vector<Node*>> region_nodes;
+  std::vector<absl::flat_hash_set<Node*>> region_inputs;
+  for (int64_t i = 0; i < node_count; ++i) {
+    int64_t root = FindRegion(parent, i);
+    auto [it, inserted] = region_index.try_emplace(root, region_nodes.size());
+    if (inserted) {
+      region_nodes.emplace_back();
+      region_inputs.emplace_back();
+    }
+    region_nodes[it->second].push_back(topo_sort[i]);
+    for (Node* operand : topo_sort[i]->operands()) {
+      if (FindRegion(parent, topo_index.at(operand)) != root) {
+        region_inputs[it->second].insert(operand);
+      }
+    }
+  }
+
+  const int64_t region_count = region_nodes.size();
+  std::vector<absl::StatusOr<ScheduleCycleMap>> region_cycle_maps(
+      region_count);
+  auto schedule_region = [&](int64_t r) -> absl::StatusOr<ScheduleCycleMap> {
+    std::vector<Node*> region_topo_sort = region_nodes[r];
+    region_topo_sort.insert(region_topo_sort.end(), region_inputs[r].begin(),
+                            region_inputs[r].end());
+    std::sort(region_topo_sort.begin(), region_topo_sort.end(),
+              [&](Node* a, Node* b) {
+                return topo_index.at(a) < topo_index.at(b);
+              });
+    sched::ScheduleBounds region_bounds(f, std::move(region_topo_sort),
+                                        clock_period_ps, delay_estimator);
+    for (Node* node : region_nodes[r]) {
+      XLS_RETURN_IF_ERROR(region_bounds.TightenNodeUb(node, pinned.ub(node)));
+      XLS_RETURN_IF_ERROR(region_bounds.TightenNodeLb(node, pinned.lb(node)));
+    }
+    for (Node* node : region_inputs[r]) {
+      XLS_RETURN_IF_ERROR(region_bounds.TightenNodeUb(node, pinned.ub(node)));
+      XLS_RETURN_IF_ERROR(region_bounds.TightenNodeLb(node, pinned.lb(node)));
+    }
+    // The regions are already scheduled in parallel.
+    return ScheduleNodes(f, region_nodes[r], pipeline_stages, delay_estimator,
+                         /*thread_count=*/1, &region_bounds);
+  };
+  {
+    TaskGroup regions;
+    for (int64_t r = 0; r < region_count; ++r) {
+      regions.Schedule(
+          [&, r]() { region_cycle_maps[r] = schedule_region(r); });
+    }
+    XLS_RETURN_IF_ERROR(regions.Wait());
+  }
+
+  // Stitch the regions together and check the result as a whole.
+  ScheduleCycleMap cycle_map;
+  cycle_map.reserve(node_count);
+  for (absl::StatusOr<ScheduleCycleMap>& region_cycle_map :
+       region_cycle_maps) {
+    XLS_RETURN_IF_ERROR(region_cycle_map.status());
+    cycle_map.insert(region_cycle_map->begin(), region_cycle_map->end());
+  }
+  XLS_RET_CHECK_EQ(cycle_map.size(), node_count);
+  PipelineSchedule schedule(f, cycle_map, pipeline_stages);
+  XLS_RETURN_IF_ERROR(schedule.Verify());
+  XLS_RETURN_IF_ERROR(schedule.VerifyTiming(clock_period_ps, delay_estimator));
+  return cycle_map;
+}
+
+}  // namespace
+
+std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
+  if (length == 0) {
+    return {{}};
+  }
+  if (length == 1) {
+    return {{0}};
+  }
+  if (length == 2) {
+    return {{0, 1}, {1, 0}};
+  }
+  // For lengths greater than 2, return forward, reverse and middle first
+  // orderings.
+  std::vector<std::vector<int64_t>> orders;
+  std::vector<int64_t> forward(length);
+  std::iota(forward.begin(), forward.end(), 0);
+  orders.push_back(forward);
+
+  std::vector<int64_t> reverse(length);
+  std::iota(reverse.begin(), reverse.end(), 0);
+  std::reverse(reverse.begin(), reverse.end());
+  orders.push_back(reverse);
+
+  orders.push_back(MiddleFirstOrder(0, length - 1));
+  return orders;
+}
+
+absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints) {
+  VLOG(3) << "MinCutScheduler()";
+  VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  XLS_VLOG_LINES(4, f->DumpIr());
+
+  VLOG(4) << "Initial bounds:";
+  XLS_VLOG_LINES(4, bounds->ToString());
+
+  XLS_RETURN_IF_ERROR(
+      ApplyConstraints(f, pipeline_stages, constraints, bounds));
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  return ScheduleNodes(f, nodes, pipeline_stages, delay_estimator,
+                       XlsThreadCount(), bounds);
+}
+
+absl::StatusOr<ScheduleCycleMap> PartitionedMinCutScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t partition_count) {
+  VLOG(3) << "PartitionedMinCutScheduler()";
+  VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  VLOG(3) << "  partitions = " << partition_count;
+  XLS_RET_CHECK_GT(partition_count, 0);
+  XLS_RETURN_IF_ERROR(
+      ApplyConstraints(f, pipeline_stages, constraints, bounds));
+  absl::StatusOr<ScheduleCycleMap> cycle_map =
+      ScheduleRegions(f, pipeline_stages, clock_period_ps, delay_estimator,
+                      *bounds, partition_count);
+  if (cycle_map.ok()) {
+    return cycle_map;
+  }
+  LOG(WARNING) << "Unable to schedule " << f->name()
+               << " in partitions, scheduling it as a whole: "
+               << cycle_map.status();
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  return ScheduleNodes(f, nodes, pipeline_stages, delay_estimator,
+                       XlsThreadCount(), bounds);
+}
+
 }  // namespace xls
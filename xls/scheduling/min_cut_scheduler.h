@@ -36,6 +36,21 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
     absl::Span<const SchedulingConstraint> constraints);
 
+// Like MinCutScheduler, but first splits the function into about
+// `partition_count` weakly coupled regions which are then scheduled
+// independently and in parallel. Regions are grown by keeping the widest values
+// inside a region. Values which cross between regions are fixed to their
+// earliest cycle, and a value with operands is registered before it's used in
+// another region, so the region schedules can be combined without violating
+// timing. The combined schedule is verified, and if the regions can't be
+// scheduled this way the function is scheduled as a whole. This scales to much
+// larger functions than MinCutScheduler at a small cost in pipeline registers.
+absl::StatusOr<ScheduleCycleMap> PartitionedMinCutScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t partition_count);
+
 // Returns the list of ordering of cycles (pipeline stages) in which to compute
 // min cut of the graph. Each min cut of the graph computes which XLS node
 // values are in registers after a particular stage in the pipeline schedule. A
@@ -19,7 +19,6 @@
 #include <functional>
 #include <iterator>
 #include <memory>
-#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -41,7 +40,9 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/adjacency_bitmap.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -55,8 +56,13 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/token_provenance_analysis.h"
+#include "xls/passes/union_query_engine.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
 #include "xls/solvers/z3_ir_translator.h"
@@ -96,13 +102,53 @@ bool HasIntersection(const absl::flat_hash_set<T>& lhs,
                      [&bigger](T element) { return bigger.contains(element); });
 }
 
-Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
-  Z3_solver solver = solvers::z3::CreateSolver(c, 1);
-  Z3_solver_assert(c, solver, asserted);
-  Z3_lbool satisfiable = Z3_solver_check(c, solver);
-  Z3_solver_dec_ref(c, solver);
-  return satisfiable;
-}
+// Checks whether conjunctions of predicates are satisfiable using a single
+// incremental solver. Each predicate is only asserted to be implied by a fresh
+// boolean indicator, and a query checks the indicators of its predicates as
+// assumptions, so the lemmas learned by one query are reused by the next.
+class PredicateSolver {
+ public:
+  explicit PredicateSolver(solvers::z3::IrTranslator* translator)
+      : translator_(translator),
+        solver_(solvers::z3::CreateSolver(translator->ctx(), 1)) {}
+  ~PredicateSolver() { Z3_solver_dec_ref(translator_->ctx(), solver_); }
+
+  PredicateSolver(const PredicateSolver&) = delete;
+  PredicateSolver& operator=(const PredicateSolver&) = delete;
+
+  // Returns whether all of `predicates` can be true at once, within the rlimit
+  // currently set on the translator.
+  Z3_lbool CheckConjunction(absl::Span<Node* const> predicates) {
+    std::vector<Z3_ast> assumptions;
+    assumptions.reserve(predicates.size());
+    for (Node* predicate : predicates) {
+      assumptions.push_back(GetIndicator(predicate));
+    }
+    return Z3_solver_check_assumptions(translator_->ctx(), solver_,
+                                       assumptions.size(), assumptions.data());
+  }
+
+ private:
+  Z3_ast GetIndicator(Node* predicate) {
+    auto it = indicators_.find(predicate);
+    if (it != indicators_.end()) {
+      return it->second;
+    }
+    Z3_context ctx = translator_->ctx();
+    Z3_ast indicator = Z3_mk_fresh_const(ctx, "pred", Z3_mk_bool_sort(ctx));
+    Z3_solver_assert(
+        ctx, solver_,
+        Z3_mk_implies(ctx, indicator,
+                      solvers::z3::BitVectorToBoolean(
+                          ctx, translator_->GetTranslation(predicate))));
+    indicators_.emplace(predicate, indicator);
+    return indicator;
+  }
+
+  solvers::z3::IrTranslator* translator_;
+  Z3_solver solver_;
+  absl::flat_hash_map<Node*, Z3_ast> indicators_;
+};
 
 // Returns a list of all predicates in a deterministic order, paired with their
 // index in the list.
@@ -309,43 +355,31 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     }
   }
 
-  // The complement of the `neighborhoods` graph
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
-
-  for (Node* node : nodes) {
-    inverted_neighborhoods[node] = nodes;
-    for (Node* neighbor : neighborhoods.at(node)) {
-      inverted_neighborhoods[node].erase(neighbor);
-    }
-  }
-
   absl::flat_hash_map<Node*, int64_t> node_to_index;
   for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
     node_to_index[ordered_nodes[i]] = i;
   }
 
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
-  std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+  // The complement of the `neighborhoods` graph
+  const int64_t node_count = ordered_nodes.size();
+  AdjacencyBitmap inverted_neighborhoods(
+      node_count, InlineBitmap(node_count, /*fill=*/true));
+  for (int64_t i = 0; i < node_count; ++i) {
+    inverted_neighborhoods[i].Set(i, false);
+    for (Node* neighbor : neighborhoods.at(ordered_nodes[i])) {
+      inverted_neighborhoods[i].Set(node_to_index.at(neighbor), false);
+    }
+  }
+
+  std::vector<int64_t> colors =
+      RecursiveLargestFirstColoring(inverted_neighborhoods);
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
-  for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
-    absl::flat_hash_set<Node*> color_node_class;
-    for (int64_t index : color_class) {
-      color_node_class.insert(ordered_nodes[index]);
+  for (int64_t i = 0; i < node_count; ++i) {
+    if (colors[i] >= coloring.size()) {
+      coloring.resize(colors[i] + 1);
     }
-    coloring.push_back(color_node_class);
+    coloring[colors[i]].insert(ordered_nodes[i]);
   }
 
   for (const absl::flat_hash_set<Node*>& color_class : coloring) {
@@ -815,7 +849,7 @@ struct PredicateSet {
 
 using NodeSet = absl::btree_set<Node*, Node::NodeIdLessThan>;
 template <typename T>
-using NodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
+using OrderedNodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
 
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<PostDominatorAnalysis> pda,
@@ -829,7 +863,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // First, take each select and add to the `PredicateSet` of all nodes
   // that are postdominated by one of its cases a predicate of the form
   // `selector == case_number`.
-  NodeMap<PredicateSet> predicate_sets;
+  OrderedNodeMap<PredicateSet> predicate_sets;
   for (Node* node : TopoSort(f)) {
     if (node->Is<Select>()) {
       Select* select = node->As<Select>();
@@ -902,7 +936,8 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // Fourth, we create a mapping from selector to the value of the selector
   // to set of nodes that contain that selector-value pair, which will be used
   // later in creating mutual exclusion edges.
-  NodeMap<absl::btree_map<Bits, NodeSet, BitsLT>> selector_to_value_to_preds;
+  OrderedNodeMap<absl::btree_map<Bits, NodeSet, BitsLT>>
+      selector_to_value_to_preds;
 
   // Fifth, we AND together all the select predicates that apply to a given node
   // and then AND that with the current predicate of that node via the call to
@@ -1003,19 +1038,37 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
     return absl::OkStatus();
   }
 
+  // Ternary and BDD analyses settle the easy cases (predicates known to be
+  // false and pairs that are plainly exclusive) much more cheaply than Z3.
+  std::vector<std::unique_ptr<QueryEngine>> query_engines;
+  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  query_engines.push_back(std::make_unique<BddQueryEngine>(
+      BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  UnionQueryEngine query_engine(std::move(query_engines));
+  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
                        solvers::z3::IrTranslator::CreateAndTranslate(f, true));
 
   Z3_context ctx = translator->ctx();
 
   solvers::z3::ScopedErrorHandler seh(ctx);
+  PredicateSolver solver(translator.get());
 
   // Determine for each predicate whether it is always false using Z3.
   // Dead nodes are mutually exclusive with all other nodes, so this can reduce
   // the runtime by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
+    if (query_engine.IsAllZeros(node)) {
+      VLOG(3) << "Statically known that " << node << " is always false";
+      for (const auto& [other, other_index] : predicate_nodes) {
+        if (index != other_index) {
+          XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node, other));
+        }
+      }
+      continue;
+    }
     // Check whether it's possible for `node` to need to be proven mutually
     // exclusive with some other node in order for channel operations to be
     // legal; if so, we remove the rlimit on the prover.
@@ -1028,8 +1081,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
                 << " as mutual exclusion is required for compilation.";
     }
     translator->SetRlimit(z3_rlimit);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    if (solver.CheckConjunction({node}) == Z3_L_FALSE) {
       VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -1064,14 +1116,15 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
+      if (FunctionIsOneBit(node_a) && FunctionIsOneBit(node_b) &&
+          query_engine.AtMostOneNodeTrue({node_a, node_b})) {
+        known_true += 1;
+        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+        continue;
+      }
 
       // We try to find out if `a ∧ b` is satisfiable, which is true iff
       // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
-
       // Check whether `a` and `b` must be proven mutually exclusive in order
       // for channel operations to be legal; if so, we remove the rlimit on the
       // prover.
@@ -1085,7 +1138,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
                   << node_a->GetName() << " and " << node_b->GetName()
                   << " as mutual exclusion is required for compilation.";
       }
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
+      Z3_lbool satisfiable = solver.CheckConjunction({node_a, node_b});
 
       if (satisfiable == Z3_L_FALSE) {
         known_true += 1;
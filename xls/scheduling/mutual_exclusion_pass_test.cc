@@ -122,6 +122,23 @@ absl::StatusOr<Proc*> CreateTwoParallelSendsProc(Package* p,
   return pb.Build({pb.AfterAll({send0, send1}), not_st});
 }
 
+// Like CreateTwoParallelSendsProc, but with predicates whose exclusion is too
+// expensive to prove with BDDs, so it is left to Z3.
+absl::StatusOr<Proc*> CreateTwoParallelComparisonSendsProc(
+    Package* p, std::string_view name, Channel* channel) {
+  ProcBuilder pb(name, p);
+  BValue tok = pb.StateElement("__token", Value::Token());
+  BValue st = pb.StateElement("__state", Value(UBits(0, 32)));
+  BValue lt = pb.ULt(st, pb.Literal(UBits(5, 32)));
+  BValue gt = pb.UGt(st, pb.Literal(UBits(10, 32)));
+  BValue lit50 = pb.Literal(UBits(50, 32));
+  BValue lit60 = pb.Literal(UBits(60, 32));
+  BValue send0 = pb.SendIf(channel, tok, lt, lit50);
+  BValue send1 = pb.SendIf(channel, tok, gt, lit60);
+  return pb.Build({pb.AfterAll({send0, send1}),
+                   pb.Add(st, pb.Literal(UBits(1, 32)))});
+}
+
 absl::StatusOr<Node*> FindOp(FunctionBase* f, Op op) {
   Node* result = nullptr;
   for (Node* node : f->nodes()) {
@@ -186,13 +203,35 @@ TEST_F(MutualExclusionPassTest,
           /*flow_control=*/FlowControl::kReadyValid,
           /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
   XLS_ASSERT_OK_AND_ASSIGN(
-      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+      Proc * proc,
+      CreateTwoParallelComparisonSendsProc(p.get(), "main", test_channel));
   EXPECT_THAT(RunMutualExclusionPass(
                   proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
               IsOkAndHolds(false));
   EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
 }
 
+TEST_F(MutualExclusionPassTest,
+       TwoParallelSendsWithSmallRlimitAndOptionalMergingSettledByBdds) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel(
+          "test_channel", ChannelOps::kSendOnly, p->GetBitsType(32),
+          /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
+          /*flow_control=*/FlowControl::kReadyValid,
+          /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+  // `st` and `!st` are exclusive by BDD analysis alone, so the rlimit on Z3
+  // doesn't prevent merging.
+  EXPECT_THAT(RunMutualExclusionPass(
+                  proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
+              IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
 TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
@@ -297,6 +297,43 @@ TEST_F(PipelineScheduleTest, AsapScheduleComplex) {
   EXPECT_THAT(schedule.nodes_in_cycle(2), UnorderedElementsAre(m::Neg()));
 }
 
+TEST_F(PipelineScheduleTest, PartitionedMinCutSchedule) {
+  // Lanes of chained operations which are coupled to their neighbours part way
+  // down, all joined by the return value.
+  constexpr int64_t kLanes = 32;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> lanes;
+  for (int64_t i = 0; i < kLanes; ++i) {
+    lanes.push_back(fb.Not(fb.Param(absl::StrCat("x", i), p->GetBitsType(8))));
+  }
+  std::vector<BValue> coupled;
+  for (int64_t i = 0; i < kLanes; ++i) {
+    coupled.push_back(fb.Add(lanes[i], lanes[(i + 1) % kLanes]));
+  }
+  std::vector<BValue> outputs;
+  for (BValue lane : coupled) {
+    outputs.push_back(fb.Negate(fb.Not(fb.Negate(fb.Not(lane)))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat(outputs)));
+
+  for (SchedulingStrategy strategy :
+       {SchedulingStrategy::SDC, SchedulingStrategy::MIN_CUT}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(f, TestDelayEstimator(),
+                            SchedulingOptions(strategy)
+                                .clock_period_ps(2)
+                                .pipeline_stages(6)
+                                .schedule_partitions(4)));
+    EXPECT_EQ(schedule.length(), 6);
+    for (Node* node : f->nodes()) {
+      EXPECT_TRUE(schedule.IsScheduled(node)) << node->GetName();
+    }
+  }
+}
+
 TEST_F(PipelineScheduleTest, JustClockPeriodGiven) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -15,6 +15,7 @@
 #include "xls/scheduling/proc_state_legalization_pass.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -61,8 +62,14 @@ absl::StatusOr<bool> ModernizeNextValues(Proc* proc) {
   return proc->GetStateElementCount() > 0;
 }
 
+// A prover shared by all state params of a proc, created by the first param
+// which needs a proof so the proc is translated at most once.
+using LazyProverSession =
+    std::optional<absl::StatusOr<std::unique_ptr<solvers::z3::ProverSession>>>;
+
 absl::StatusOr<bool> AddDefaultNextValue(Proc* proc, Param* param,
-                                         const SchedulingPassOptions& options) {
+                                         const SchedulingPassOptions& options,
+                                         LazyProverSession& session) {
   absl::btree_set<Node*, Node::NodeIdLessThan> predicates;
   for (Next* next : proc->next_values(param)) {
     if (next->predicate().has_value()) {
@@ -126,14 +133,19 @@ absl::StatusOr<bool> AddDefaultNextValue(Proc* proc, Param* param,
       });
     }
 
-    absl::StatusOr<solvers::z3::ProverResult> no_default_needed =
-        solvers::z3::TryProveDisjunction(
-            proc, z3_predicates,
-            /*rlimit=*/*default_next_value_z3_rlimit,
-            /*allow_unsupported=*/true);
-    if (no_default_needed.ok() &&
-        std::holds_alternative<solvers::z3::ProvenTrue>(*no_default_needed)) {
-      return false;
+    if (!session.has_value()) {
+      session = solvers::z3::ProverSession::Create(proc,
+                                                   /*allow_unsupported=*/true);
+    }
+    if (session->ok()) {
+      solvers::z3::ProverSession& prover = ***session;
+      prover.SetRlimit(*default_next_value_z3_rlimit);
+      absl::StatusOr<solvers::z3::ProverResult> no_default_needed =
+          prover.TryProveDisjunction(z3_predicates);
+      if (no_default_needed.ok() &&
+          std::holds_alternative<solvers::z3::ProvenTrue>(*no_default_needed)) {
+        return false;
+      }
     }
   }
 
@@ -156,9 +168,12 @@ absl::StatusOr<bool> AddDefaultNextValues(
     Proc* proc, const SchedulingPassOptions& options) {
   bool changed = false;
 
+  // The default next_value nodes added along the way are never the subject of
+  // a proof, so the session stays valid.
+  LazyProverSession session;
   for (Param* param : proc->StateParams()) {
     XLS_ASSIGN_OR_RETURN(bool param_changed,
-                         AddDefaultNextValue(proc, param, options));
+                         AddDefaultNextValue(proc, param, options, session));
     if (param_changed) {
       VLOG(4) << "Added default next_value for param: " << param->name();
       changed = true;
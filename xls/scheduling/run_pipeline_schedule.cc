@@ -369,8 +369,10 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   auto initialize_sdc_scheduler = [&]() -> absl::Status {
     if (sdc_scheduler == nullptr) {
-      XLS_ASSIGN_OR_RETURN(sdc_scheduler,
-                           SDCScheduler::Create(f, input_delay_added));
+      XLS_ASSIGN_OR_RETURN(
+          sdc_scheduler,
+          SDCScheduler::Create(f, input_delay_added,
+                               options.prune_critical_path_distances()));
       XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
     }
     return absl::OkStatus();
@@ -436,7 +438,15 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   }
 
   ScheduleCycleMap cycle_map;
-  if (options.strategy() == SchedulingStrategy::SDC) {
+  const bool partitioned =
+      options.schedule_partitions() > 1 &&
+      (options.strategy() == SchedulingStrategy::SDC ||
+       options.strategy() == SchedulingStrategy::MIN_CUT);
+  if (partitioned && options.use_fdo()) {
+    return absl::UnimplementedError(
+        "Partitioned scheduling does not support FDO.");
+  }
+  if (options.strategy() == SchedulingStrategy::SDC && !partitioned) {
     // Enable iterative SDC scheduling when use_fdo is true
     if (options.use_fdo()) {
       if (!options.clock_period_ps().has_value()) {
@@ -455,6 +465,16 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
       isdc_options.stochastic_ratio = options.fdo_refinement_stochastic_ratio();
       isdc_options.path_evaluate_strategy =
           options.fdo_path_evaluate_strategy();
+      isdc_options.dispatcher_options.max_in_flight =
+          options.fdo_max_concurrent_syntheses();
+      if (!options.fdo_synthesis_cache_dir().empty()) {
+        isdc_options.dispatcher_options.cache_directory =
+            options.fdo_synthesis_cache_dir();
+      }
+      isdc_options.dispatcher_options.pdk = absl::StrJoin(
+          {options.fdo_synthesizer_name(), options.fdo_synthesis_libraries(),
+           options.fdo_default_driver_cell(), options.fdo_default_load()},
+          ";");
 
       DelayManager delay_manager(f, delay_estimator);
       XLS_ASSIGN_OR_RETURN(
@@ -577,9 +597,18 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     // chosen scheduler.
     sched::ScheduleBounds bounds(f, TopoSort(f), clock_period_ps,
                                  input_delay_added);
+    bounds.SetPropagationThreadCount(options.schedule_bounds_threads());
     XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, options.pipeline_stages()));
 
-    if (options.strategy() == SchedulingStrategy::MIN_CUT) {
+    if (partitioned) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          PartitionedMinCutScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, input_delay_added, &bounds,
+              options.constraints(), options.schedule_partitions()));
+    } else if (options.strategy() == SchedulingStrategy::MIN_CUT) {
       XLS_ASSIGN_OR_RETURN(cycle_map,
                            MinCutScheduler(f,
                                            options.pipeline_stages().value_or(
@@ -15,18 +15,23 @@
 #include "xls/scheduling/schedule_bounds.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -75,107 +80,282 @@ std::string ScheduleBounds::ToString() const {
   return out;
 }
 
+namespace {
+
+// Levels with fewer nodes than this are propagated by a single thread; the
+// others would only wait at the barrier anyway.
+constexpr int64_t kMinNodesPerThread = 64;
+
+// A barrier which, unlike absl::Barrier, can be passed repeatedly.
+class ReusableBarrier {
+ public:
+  explicit ReusableBarrier(int64_t thread_count)
+      : thread_count_(thread_count) {}
+
+  void Wait() {
+    absl::MutexLock lock(&mutex_);
+    int64_t generation = generation_;
+    if (++waiting_ == thread_count_) {
+      waiting_ = 0;
+      ++generation_;
+      return;
+    }
+    auto released = [this, generation]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return generation_ != generation;
+    };
+    mutex_.Await(absl::Condition(&released));
+  }
+
+ private:
+  const int64_t thread_count_;
+  absl::Mutex mutex_;
+  int64_t waiting_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace
+
+absl::Status ScheduleBounds::PropagateNodeLowerBound(
+    Node* node, const InCycleDelayMap& in_cycle_delay,
+    int64_t& node_in_cycle_delay, int64_t& max_lower_bound) {
+  VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
+                                lb(node));
+  for (Node* operand : node->operands()) {
+    auto operand_bounds = bounds_.find(operand);
+    if (operand_bounds == bounds_.end()) {
+      continue;
+    }
+    int64_t operand_lb = operand_bounds->second.first;
+    if (operand_lb < lb(node)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
+                         delay_estimator_->GetOperationDelayInPs(operand));
+    if (operand_lb > lb(node)) {
+      VLOG(4) << absl::StreamFormat(
+          "    tightened lb to %d because of operand %s", operand_lb,
+          operand->GetName());
+      XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb, max_lower_bound));
+      node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
+      continue;
+    }
+    int64_t min_delay =
+        operand->Is<MinDelay>() ? operand->As<MinDelay>()->delay() : 0;
+    if (operand_lb + min_delay > lb(node)) {
+      VLOG(4) << absl::StreamFormat(
+          "    tightened lb to %d because of operand %s", operand_lb,
+          operand->GetName());
+      XLS_RETURN_IF_ERROR(
+          TightenNodeLb(node, operand_lb + min_delay, max_lower_bound));
+      node_in_cycle_delay = 0;
+      continue;
+    }
+    node_in_cycle_delay = std::max(
+        node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                       delay_estimator_->GetOperationDelayInPs(node));
+  if (node_delay > clock_period_ps_) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Node %s has a greater delay (%dps) than the clock period (%dps)",
+        node->GetName(), node_delay, clock_period_ps_));
+  }
+  if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    VLOG(4) << "    overflows clock period, tightened lb to " << lb(node) + 1;
+    XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1, max_lower_bound));
+    node_in_cycle_delay = 0;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::PropagateNodeUpperBound(
+    Node* node, const InCycleDelayMap& in_cycle_delay,
+    int64_t& node_in_cycle_delay, int64_t& min_upper_bound) {
+  VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
+                                ub(node));
+  for (Node* user : node->users()) {
+    auto user_bounds = bounds_.find(user);
+    if (user_bounds == bounds_.end()) {
+      continue;
+    }
+    int64_t user_ub = user_bounds->second.second;
+    if (user_ub == std::numeric_limits<int64_t>::max() || user_ub > ub(node)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t user_delay,
+                         delay_estimator_->GetOperationDelayInPs(user));
+    if (user_ub < ub(node)) {
+      VLOG(4) << absl::StreamFormat("    tightened ub to %d because of user %s",
+                                    user_ub, user->GetName());
+      XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub, min_upper_bound));
+      node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
+      continue;
+    }
+    node_in_cycle_delay =
+        std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                       delay_estimator_->GetOperationDelayInPs(node));
+  if (node_delay > clock_period_ps_) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Node %s has a greater delay (%dps) than the clock period (%dps)",
+        node->GetName(), node_delay, clock_period_ps_));
+  }
+  if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    VLOG(4) << "    overflows clock period, tightened ub to " << ub(node) - 1;
+    XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1, min_upper_bound));
+    node_in_cycle_delay = 0;
+  }
+  return absl::OkStatus();
+}
+
+void ScheduleBounds::ComputeLevels() {
+  if (!level_offsets_.empty() || topo_sort_.empty()) {
+    return;
+  }
+  absl::flat_hash_map<Node*, int64_t> levels;
+  levels.reserve(topo_sort_.size());
+  int64_t level_count = 0;
+  for (Node* node : topo_sort_) {
+    int64_t level = 0;
+    for (Node* operand : node->operands()) {
+      auto it = levels.find(operand);
+      if (it != levels.end()) {
+        level = std::max(level, it->second + 1);
+      }
+    }
+    levels[node] = level;
+    level_count = std::max(level_count, level + 1);
+  }
+  // Counting sort by level, which keeps topological order within a level.
+  level_offsets_.assign(level_count + 1, 0);
+  for (Node* node : topo_sort_) {
+    ++level_offsets_[levels.at(node) + 1];
+  }
+  for (int64_t i = 1; i <= level_count; ++i) {
+    level_offsets_[i] += level_offsets_[i - 1];
+  }
+  std::vector<int64_t> next(level_offsets_.begin(), level_offsets_.end() - 1);
+  level_order_.resize(topo_sort_.size());
+  for (Node* node : topo_sort_) {
+    level_order_[next[levels.at(node)]++] = node;
+  }
+}
+
+absl::Status ScheduleBounds::PropagateInParallel(bool lower_bounds) {
+  ComputeLevels();
+  // Every node is inserted up front so the workers only modify values and
+  // never the structure of the map.
+  InCycleDelayMap in_cycle_delay;
+  in_cycle_delay.reserve(topo_sort_.size());
+  for (Node* node : topo_sort_) {
+    in_cycle_delay[node] = 0;
+  }
+
+  const int64_t level_count = static_cast<int64_t>(level_offsets_.size()) - 1;
+  const int64_t thread_count = thread_count_;
+  std::vector<int64_t> extremes(
+      thread_count, lower_bounds ? max_lower_bound_ : min_upper_bound_);
+  std::vector<absl::Status> statuses(thread_count);
+  // Set before the barrier by a failing worker; every worker checks it after
+  // the barrier so they all stop at the same level.
+  std::atomic<bool> failed = false;
+  ReusableBarrier barrier(thread_count);
+
+  auto worker = [&](int64_t thread_index) {
+    for (int64_t i = 0; i < level_count; ++i) {
+      // Upper bounds flow from users to operands, so go from the last level.
+      int64_t level = lower_bounds ? i : level_count - 1 - i;
+      int64_t begin = level_offsets_[level];
+      int64_t size = level_offsets_[level + 1] - begin;
+      int64_t active_threads =
+          std::clamp<int64_t>(size / kMinNodesPerThread, 1, thread_count);
+      if (thread_index < active_threads) {
+        int64_t chunk = (size + active_threads - 1) / active_threads;
+        int64_t chunk_begin = begin + thread_index * chunk;
+        int64_t chunk_end = std::min(chunk_begin + chunk, begin + size);
+        for (int64_t j = chunk_begin; j < chunk_end; ++j) {
+          Node* node = level_order_[j];
+          int64_t& node_in_cycle_delay = in_cycle_delay.find(node)->second;
+          absl::Status status =
+              lower_bounds
+                  ? PropagateNodeLowerBound(node, in_cycle_delay,
+                                            node_in_cycle_delay,
+                                            extremes[thread_index])
+                  : PropagateNodeUpperBound(node, in_cycle_delay,
+                                            node_in_cycle_delay,
+                                            extremes[thread_index]);
+          if (!status.ok()) {
+            statuses[thread_index] = std::move(status);
+            failed = true;
+            break;
+          }
+        }
+      }
+      barrier.Wait();
+      if (failed) {
+        return;
+      }
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count - 1);
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>([&worker, i]() { worker(i); }));
+  }
+  worker(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (int64_t i = 0; i < thread_count; ++i) {
+    XLS_RETURN_IF_ERROR(statuses[i]);
+    if (lower_bounds) {
+      max_lower_bound_ = std::max(max_lower_bound_, extremes[i]);
+    } else {
+      min_upper_bound_ = std::min(min_upper_bound_, extremes[i]);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ScheduleBounds::PropagateLowerBounds() {
   VLOG(4) << "PropagateLowerBounds()";
+  if (thread_count_ > 1) {
+    return PropagateInParallel(/*lower_bounds=*/true);
+  }
   // The delay in picoseconds from the beginning of a cycle to the start of the
   // node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  InCycleDelayMap in_cycle_delay;
 
   // Compute the lower bound of each node based on the lower bounds of the
   // operands of the node.
   for (Node* node : topo_sort_) {
     int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
-                                  lb(node));
-    for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
-                           delay_estimator_->GetOperationDelayInPs(operand));
-      if (operand_lb > lb(node)) {
-        VLOG(4) << absl::StreamFormat(
-            "    tightened lb to %d because of operand %s", operand_lb,
-            operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
-        continue;
-      }
-      int64_t min_delay =
-          operand->Is<MinDelay>() ? operand->As<MinDelay>()->delay() : 0;
-      if (operand_lb + min_delay > lb(node)) {
-        VLOG(4) << absl::StreamFormat(
-            "    tightened lb to %d because of operand %s", operand_lb,
-            operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb + min_delay));
-        node_in_cycle_delay = 0;
-        continue;
-      }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
-    }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened lb to " << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
-      node_in_cycle_delay = 0;
-    }
+    XLS_RETURN_IF_ERROR(PropagateNodeLowerBound(
+        node, in_cycle_delay, node_in_cycle_delay, max_lower_bound_));
   }
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   VLOG(4) << "PropagateUpperBounds()";
+  if (thread_count_ > 1) {
+    return PropagateInParallel(/*lower_bounds=*/false);
+  }
   // The delay in picoseconds from the end of a cycle to the end of the node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
+  InCycleDelayMap in_cycle_delay;
 
   // Compute the upper bound of each node based on the upper bounds of the
   // users of the node.
   for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
     Node* node = *it;
     int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
-                                  ub(node));
-    for (Node* user : node->users()) {
-      int64_t user_ub = ub(user);
-      if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay,
-                           delay_estimator_->GetOperationDelayInPs(user));
-      if (user_ub < ub(node)) {
-        VLOG(4) << absl::StreamFormat(
-            "    tightened ub to %d because of user %s", user_ub,
-            user->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
-        continue;
-      }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
-    }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened ub to " << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
-      node_in_cycle_delay = 0;
-    }
+    XLS_RETURN_IF_ERROR(PropagateNodeUpperBound(
+        node, in_cycle_delay, node_in_cycle_delay, min_upper_bound_));
   }
   return absl::OkStatus();
 }
@@ -183,9 +363,10 @@ absl::Status ScheduleBounds::PropagateUpperBounds() {
 /* static */ absl::StatusOr<ScheduleBounds>
 ScheduleBounds::ComputeAsapAndAlapBounds(
     FunctionBase* f, int64_t clock_period_ps,
-    const DelayEstimator& delay_estimator) {
+    const DelayEstimator& delay_estimator, int64_t thread_count) {
   VLOG(4) << "ComputeAsapAndAlapBounds()";
   ScheduleBounds bounds(f, clock_period_ps, delay_estimator);
+  bounds.SetPropagationThreadCount(thread_count);
   XLS_RETURN_IF_ERROR(bounds.PropagateLowerBounds());
   VLOG(4) << "Setting all upper bounds to max-lower-bound "
           << bounds.max_lower_bound();
@@ -40,10 +40,11 @@ class ScheduleBounds {
   // possible cycle which satisfies dependency and clock period
   // constraints. Similarly, upper bounds are set to the latest possible cycle
   // The upper bounds of nodes with no uses (leaf nodes) are set to the maximum
-  // lower bound of any node.
+  // lower bound of any node. `thread_count` is passed to
+  // SetPropagationThreadCount.
   static absl::StatusOr<ScheduleBounds> ComputeAsapAndAlapBounds(
       FunctionBase* f, int64_t clock_period_ps,
-      const DelayEstimator& delay_estimator);
+      const DelayEstimator& delay_estimator, int64_t thread_count = 1);
 
   // Upon construction all parameters have lower and upper bounds of 0. All
   // other nodes have a lower bound of 1 and an upper bound of INT64_MAX.
@@ -51,7 +52,10 @@ class ScheduleBounds {
                  const DelayEstimator& delay_estimator);
 
   // Constructor which uses an existing topological sort to avoid having to
-  // recompute it.
+  // recompute it. The sort may cover only part of the function, in which case
+  // bounds are only held for the nodes in it and propagation ignores operands
+  // and users outside of it. This is useful for scheduling a region of a
+  // function whose boundary nodes have fixed bounds.
   ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
                  int64_t clock_period_ps,
                  const DelayEstimator& delay_estimator);
@@ -64,6 +68,19 @@ class ScheduleBounds {
   // Resets node bounds to their initial unconstrained values.
   void Reset();
 
+  // Sets the number of threads used by PropagateLowerBounds and
+  // PropagateUpperBounds. With more than one thread, nodes are grouped into
+  // levels (the length of the longest path from a parameter or literal) and
+  // the nodes of each level, which cannot depend on each other, are
+  // propagated concurrently. The resulting bounds are the same for any thread
+  // count, but the delay estimator must be safe to call concurrently.
+  void SetPropagationThreadCount(int64_t thread_count) {
+    thread_count_ = std::max<int64_t>(thread_count, 1);
+  }
+
+  // Returns whether bounds are held for the given node.
+  bool contains(Node* node) const { return bounds_.contains(node); }
+
   // Return the lower/upper bound of the given node.
   int64_t lb(Node* node) const { return bounds_.at(node).first; }
   int64_t ub(Node* node) const { return bounds_.at(node).second; }
@@ -77,28 +94,14 @@ class ScheduleBounds {
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeLb(Node* node, int64_t value) {
-    if (value > ub(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
-                          node->GetName(), value));
-    }
-    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
-    max_lower_bound_ = std::max(max_lower_bound_, value);
-    return absl::OkStatus();
+    return TightenNodeLb(node, value, max_lower_bound_);
   }
 
   // Sets the upper bound of the given node to the minimum of its existing value
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeUb(Node* node, int64_t value) {
-    if (value < lb(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
-                          node->GetName(), value));
-    }
-    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
-    min_upper_bound_ = std::min(min_upper_bound_, value);
-    return absl::OkStatus();
+    return TightenNodeUb(node, value, min_upper_bound_);
   }
 
   // Returns the maximum lower (upper) bound of any node in the function.
@@ -117,9 +120,67 @@ class ScheduleBounds {
   absl::Status PropagateUpperBounds();
 
  private:
+  // The delay within its cycle of each node, measured from the start of the
+  // cycle when propagating lower bounds and from its end otherwise.
+  using InCycleDelayMap = absl::flat_hash_map<Node*, int64_t>;
+
+  // Variants of TightenNodeLb/TightenNodeUb which fold the new bound into
+  // `max_lower_bound` (`min_upper_bound`) rather than the member, so
+  // concurrent propagation can keep one per thread.
+  absl::Status TightenNodeLb(Node* node, int64_t value,
+                             int64_t& max_lower_bound) {
+    if (value > ub(node)) {
+      return absl::ResourceExhaustedError(
+          absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
+                          node->GetName(), value));
+    }
+    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
+    max_lower_bound = std::max(max_lower_bound, value);
+    return absl::OkStatus();
+  }
+  absl::Status TightenNodeUb(Node* node, int64_t value,
+                             int64_t& min_upper_bound) {
+    if (value < lb(node)) {
+      return absl::ResourceExhaustedError(
+          absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
+                          node->GetName(), value));
+    }
+    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
+    min_upper_bound = std::min(min_upper_bound, value);
+    return absl::OkStatus();
+  }
+
+  // Propagates the bounds of the operands (users) of `node` into its own
+  // bounds. `in_cycle_delay` must hold the final values for the operands
+  // (users); only the bounds of `node` and `node_in_cycle_delay` are written.
+  absl::Status PropagateNodeLowerBound(Node* node,
+                                       const InCycleDelayMap& in_cycle_delay,
+                                       int64_t& node_in_cycle_delay,
+                                       int64_t& max_lower_bound);
+  absl::Status PropagateNodeUpperBound(Node* node,
+                                       const InCycleDelayMap& in_cycle_delay,
+                                       int64_t& node_in_cycle_delay,
+                                       int64_t& min_upper_bound);
+
+  // Runs the lower (upper) bound propagation level by level on
+  // `thread_count_` threads.
+  absl::Status PropagateInParallel(bool lower_bounds);
+
+  // Fills `level_order_` and `level_offsets_` if they haven't been computed.
+  void ComputeLevels();
+
   // A topological sort of the nodes in the function.
   std::vector<Node*> topo_sort_;
 
+  int64_t thread_count_ = 1;
+
+  // The nodes grouped by level, in topological order within each level. The
+  // nodes of level `i` are level_order_[level_offsets_[i]] through
+  // level_order_[level_offsets_[i + 1] - 1]. Computed on first use by
+  // parallel propagation.
+  std::vector<Node*> level_order_;
+  std::vector<int64_t> level_offsets_;
+
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
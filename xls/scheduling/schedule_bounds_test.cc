@@ -16,20 +16,25 @@
 
 #include <cstdint>
 #include <limits>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
 
 namespace xls {
 namespace sched {
 namespace {
 
+using status_testing::StatusIs;
 using testing::Pair;
 
 class TestDelayEstimator : public DelayEstimator {
@@ -166,6 +171,59 @@ TEST_F(ScheduleBoundsTest, SimpleExpressionTightenBounds) {
   EXPECT_EQ(bounds.lb(result.node()), 23);
 }
 
+TEST_F(ScheduleBoundsTest, ParallelPropagationMatchesSerial) {
+  // A wide, deep mesh so that every level is split among the threads.
+  constexpr int64_t kWidth = 300;
+  constexpr int64_t kDepth = 12;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> row;
+  for (int64_t i = 0; i < kWidth; ++i) {
+    row.push_back(fb.Param(absl::StrCat("p", i), p->GetBitsType(8)));
+  }
+  for (int64_t d = 0; d < kDepth; ++d) {
+    std::vector<BValue> next;
+    for (int64_t i = 0; i < kWidth; ++i) {
+      BValue sum = fb.Add(row[i], row[(i + d + 1) % kWidth]);
+      // Vary the depth of the paths from the parameters.
+      next.push_back(i % 3 == 0 ? fb.Not(sum) : sum);
+    }
+    row = std::move(next);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat(row)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleBounds serial,
+      ScheduleBounds::ComputeAsapAndAlapBounds(f, 3, delay_estimator_));
+  XLS_ASSERT_OK_AND_ASSIGN(ScheduleBounds parallel,
+                           ScheduleBounds::ComputeAsapAndAlapBounds(
+                               f, 3, delay_estimator_, /*thread_count=*/4));
+  EXPECT_EQ(parallel.max_lower_bound(), serial.max_lower_bound());
+  EXPECT_EQ(parallel.min_upper_bound(), serial.min_upper_bound());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(parallel.bounds(node), serial.bounds(node)) << node->GetName();
+  }
+
+  // Tighten a node in the middle of the mesh and propagate both ways again.
+  Node* middle = row[0].node()->operand(0)->operand(0);
+  for (ScheduleBounds* bounds : {&serial, &parallel}) {
+    XLS_ASSERT_OK(bounds->TightenNodeLb(middle, bounds->lb(middle) + 1));
+    XLS_ASSERT_OK(bounds->PropagateLowerBounds());
+    XLS_ASSERT_OK(bounds->PropagateUpperBounds());
+  }
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(parallel.bounds(node), serial.bounds(node)) << node->GetName();
+  }
+
+  // Infeasible bounds are reported by the parallel propagation too.
+  ScheduleBounds infeasible(f, 3, delay_estimator_);
+  infeasible.SetPropagationThreadCount(4);
+  XLS_ASSERT_OK(infeasible.TightenNodeUb(f->return_value(), 0));
+  EXPECT_THAT(infeasible.PropagateLowerBounds(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
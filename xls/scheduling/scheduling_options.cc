@@ -16,18 +16,25 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/package.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
 
@@ -225,8 +232,19 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   scheduling_options.fdo_synthesis_libraries(proto.fdo_synthesis_libraries());
   scheduling_options.fdo_default_driver_cell(proto.fdo_default_driver_cell());
   scheduling_options.fdo_default_load(proto.fdo_default_load());
+  scheduling_options.fdo_max_concurrent_syntheses(
+      proto.fdo_max_concurrent_syntheses());
+  scheduling_options.fdo_synthesis_cache_dir(proto.fdo_synthesis_cache_dir());
 
   scheduling_options.schedule_all_procs(proto.multi_proc());
+  scheduling_options.prune_critical_path_distances(
+      proto.prune_critical_path_distances());
+  if (proto.has_schedule_bounds_threads()) {
+    scheduling_options.schedule_bounds_threads(proto.schedule_bounds_threads());
+  }
+  if (proto.has_schedule_partitions()) {
+    scheduling_options.schedule_partitions(proto.schedule_partitions());
+  }
 
   return scheduling_options;
 }
@@ -235,7 +253,29 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
 
 absl::StatusOr<DelayEstimator*> SetUpDelayEstimator(
     const SchedulingOptionsFlagsProto& flags) {
-  return GetDelayEstimator(flags.delay_model());
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * estimator,
+                       GetDelayEstimator(flags.delay_model()));
+  if (flags.delay_cache_path().empty()) {
+    return estimator;
+  }
+  XLS_ASSIGN_OR_RETURN(EstimateCache * cache,
+                       GetSharedEstimateCache(flags.delay_cache_path()));
+
+  // Like the registered estimators they wrap, caching estimators live for the
+  // rest of the process.
+  static absl::NoDestructor<absl::Mutex> mutex;
+  static absl::NoDestructor<absl::flat_hash_map<
+      std::pair<DelayEstimator*, EstimateCache*>,
+      std::unique_ptr<CachingDelayEstimator>>>
+      caching_estimators;
+  absl::MutexLock lock(mutex.get());
+  std::unique_ptr<CachingDelayEstimator>& caching =
+      (*caching_estimators)[{estimator, cache}];
+  if (caching == nullptr) {
+    caching = std::make_unique<CachingDelayEstimator>(
+        absl::StrCat("cached_", estimator->name()), *estimator, cache);
+  }
+  return caching.get();
 }
 
 absl::StatusOr<bool> IsDelayModelSpecifiedViaFlag(
@@ -249,9 +249,17 @@ class SchedulingOptions {
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
         fdo_synthesizer_name_("yosys"),
-        schedule_all_procs_(false) {}
-
-  // Returns the scheduling strategy.
+        fdo_max_concurrent_syntheses_(0),
+        schedule_all_procs_(false),
+        prune_critical_path_distances_(false),
+        schedule_bounds_threads_(1),
+        schedule_partitions_(1) {}
+
+  // Sets/gets the scheduling strategy.
+  SchedulingOptions& strategy(SchedulingStrategy value) {
+    strategy_ = value;
+    return *this;
+  }
   SchedulingStrategy strategy() const { return strategy_; }
 
   // Sets/gets the target delay model
@@ -519,12 +527,61 @@ class SchedulingOptions {
   }
   std::string fdo_default_load() const { return fdo_default_load_; }
 
+  // Maximum number of syntheses run concurrently in each FDO iteration; zero
+  // means one per available CPU.
+  SchedulingOptions& fdo_max_concurrent_syntheses(int64_t value) {
+    fdo_max_concurrent_syntheses_ = value;
+    return *this;
+  }
+  int64_t fdo_max_concurrent_syntheses() const {
+    return fdo_max_concurrent_syntheses_;
+  }
+
+  // Directory in which synthesized subgraph delays are cached across runs; if
+  // empty, delays are only reused within a run.
+  SchedulingOptions& fdo_synthesis_cache_dir(std::string_view value) {
+    fdo_synthesis_cache_dir_ = value;
+    return *this;
+  }
+  std::string fdo_synthesis_cache_dir() const {
+    return fdo_synthesis_cache_dir_;
+  }
+
   SchedulingOptions& schedule_all_procs(bool value) {
     schedule_all_procs_ = value;
     return *this;
   }
   bool schedule_all_procs() const { return schedule_all_procs_; }
 
+  // Sets/gets whether the SDC scheduler should only compute the critical-path
+  // distances between pairs of nodes which can violate the clock periods being
+  // scheduled for, rather than between all pairs of nodes.
+  SchedulingOptions& prune_critical_path_distances(bool value) {
+    prune_critical_path_distances_ = value;
+    return *this;
+  }
+  bool prune_critical_path_distances() const {
+    return prune_critical_path_distances_;
+  }
+
+  // Sets/gets the number of threads used to propagate the ASAP/ALAP bounds
+  // which seed the min-cut, random and ASAP schedulers.
+  SchedulingOptions& schedule_bounds_threads(int64_t value) {
+    schedule_bounds_threads_ = value;
+    return *this;
+  }
+  int64_t schedule_bounds_threads() const { return schedule_bounds_threads_; }
+
+  // Sets/gets the number of regions the function is split into for
+  // scheduling. If greater than one, the SDC and min-cut strategies schedule
+  // the regions independently and in parallel with the min-cut algorithm; see
+  // PartitionedMinCutScheduler.
+  SchedulingOptions& schedule_partitions(int64_t value) {
+    schedule_partitions_ = value;
+    return *this;
+  }
+  int64_t schedule_partitions() const { return schedule_partitions_; }
+
  private:
   SchedulingStrategy strategy_;
   int64_t opt_level_;
@@ -556,7 +613,12 @@ class SchedulingOptions {
   std::string fdo_synthesis_libraries_;
   std::string fdo_default_driver_cell_;
   std::string fdo_default_load_;
+  int64_t fdo_max_concurrent_syntheses_;
+  std::string fdo_synthesis_cache_dir_;
   bool schedule_all_procs_;
+  bool prune_critical_path_distances_;
+  int64_t schedule_bounds_threads_;
+  int64_t schedule_partitions_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
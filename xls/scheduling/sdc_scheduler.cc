@@ -14,6 +14,7 @@
 
 #include "xls/scheduling/sdc_scheduler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <memory>
@@ -46,6 +47,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/critical_path_distances.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -56,73 +58,38 @@ namespace {
 using DelayMap = absl::flat_hash_map<Node*, int64_t>;
 namespace math_opt = ::operations_research::math_opt;
 
-// A helper function to compute each node's delay by calling the delay estimator
+// A helper function to compute each node's delay with one batch query of the
+// delay estimator.
 absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  std::vector<int64_t> delays(nodes.size());
+  XLS_RETURN_IF_ERROR(
+      delay_estimator.GetOperationDelaysInPs(nodes, absl::MakeSpan(delays)));
   DelayMap result;
-  for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(result[node],
-                         delay_estimator.GetOperationDelayInPs(node));
+  result.reserve(nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    result[nodes[i]] = delays[i];
   }
   return result;
 }
 
-// Compute all-pairs longest distance between all nodes in `f`. The distance
-// from node `a` to node `b` is defined as the length of the longest delay path
-// from `a`'s start to `b`'s end, which includes the delay of the path endpoints
-// `a` and `b`. The all-pairs distance is stored in the map of maps
-// `distances_to_node` where `distances_to_node[y][x]` (if present) is the
-// critical-path distance from `x` to `y`.
-absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
-                        const DelayMap& delay_map) {
-  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-      distances_to_node;
-  distances_to_node.reserve(f->node_count());
+// Returns the length of the longest delay path in the function.
+int64_t ComputeCriticalPathDelay(absl::Span<Node* const> topo_sort,
+                                 const DelayMap& delay_map) {
+  absl::flat_hash_map<Node*, int64_t> distance_to_node;
+  distance_to_node.reserve(topo_sort.size());
+  int64_t critical_path = 0;
   for (Node* node : topo_sort) {
-    // Initialize the distance map entry to an empty map.
-    distances_to_node[node];
-  }
-
-  for (Node* node : topo_sort) {
-    absl::flat_hash_map<Node*, int64_t>& distances = distances_to_node.at(node);
-
-    // The critical path from `node` to `node` is always `node_delay` long.
-    int64_t node_delay = delay_map.at(node);
-    distances_to_node.at(node)[node] = node_delay;
-
-    // Compute the critical-path distance from `a` to `node` for all descendants
-    // `a` of each operand, extending the critical path from `a` to each operand
-    // of `node` by `node_delay`.
+    int64_t distance = 0;
     for (Node* operand : node->operands()) {
-      for (auto [a, operand_distance] : distances_to_node.at(operand)) {
-        auto [it, newly_reachable] =
-            distances.try_emplace(a, operand_distance + node_delay);
-        if (!newly_reachable) {
-          if (it->second >= operand_distance + node_delay) {
-            continue;
-          }
-          it->second = operand_distance + node_delay;
-        }
-      }
+      distance = std::max(distance, distance_to_node.at(operand));
     }
+    distance += delay_map.at(node);
+    distance_to_node[node] = distance;
+    critical_path = std::max(critical_path, distance);
   }
-
-  if (VLOG_IS_ON(4)) {
-    VLOG(4) << "All-pairs critical-path distances:";
-    for (Node* target : topo_sort) {
-      VLOG(4) << absl::StrFormat("  distances to %s:", target->GetName());
-      for (Node* source : topo_sort) {
-        VLOG(4) << absl::StrFormat(
-            "    %s -> %s : %s", source->GetName(), target->GetName(),
-            distances_to_node.at(target).contains(source)
-                ? absl::StrCat(distances_to_node.at(target).at(source))
-                : "(none)");
-      }
-    }
-  }
-
-  return distances_to_node;
+  return critical_path;
 }
 
 // Returns the minimal set of schedule constraints which ensure that no
@@ -141,11 +108,11 @@ ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
 // is greater than `critical_path_period`, but the critical-path distance of the
 // path *not* including the delay of `b` is *less than* `critical_path_period`.
 absl::flat_hash_map<Node*, std::vector<Node*>>
-ComputeCombinationalDelayConstraints(
-    FunctionBase* f, absl::Span<Node* const> topo_sort, int64_t clock_period_ps,
-    const absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>&
-        distances_to_node,
-    const DelayMap& delay_map) {
+ComputeCombinationalDelayConstraints(FunctionBase* f,
+                                     absl::Span<Node* const> topo_sort,
+                                     int64_t clock_period_ps,
+                                     const CriticalPathDistances& distances,
+                                     const DelayMap& delay_map) {
   absl::flat_hash_map<Node*, std::vector<Node*>> result;
   result.reserve(f->node_count());
   for (Node* a : topo_sort) {
@@ -163,10 +130,14 @@ ComputeCombinationalDelayConstraints(
     // NOTE: The order in which we iterate over the ancestors `a` here does not
     // matter. As long as our iteration over `node` is deterministic, we will
     // push the same sequence of `node`s into each `result[a]` every time.
-    for (auto [a, distance] : distances_to_node.at(node)) {
+    int32_t target = distances.index(node);
+    absl::Span<const int32_t> sources = distances.SourcesTo(target);
+    absl::Span<const int64_t> distances_to_node = distances.DistancesTo(target);
+    for (int64_t i = 0; i < sources.size(); ++i) {
+      int64_t distance = distances_to_node[i];
       if (distance > clock_period_ps &&
           distance - node_delay <= clock_period_ps) {
-        result.at(a).push_back(node);
+        result.at(distances.node(sources[i])).push_back(node);
       }
     }
   }
@@ -194,12 +165,6 @@ SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
       last_stage_(model_.AddContinuousVariable(0.0, kInfinity, "last_stage")),
       cycle_at_sinknode_(model_.AddContinuousVariable(-kInfinity, kInfinity,
                                                       "cycle_at_sinknode")) {
-  // when subclassed for Iterative SDC, delay_map_ and distances_to_node_
-  // are not used.
-  if (!delay_map_.empty()) {
-    distances_to_node_ = ComputeDistancesToNodes(func_, topo_sort_, delay_map_);
-  }
-
   for (Node* node : topo_sort_) {
     cycle_var_.emplace(
         node, model_.AddContinuousVariable(0.0, kInfinity, node->GetName()));
@@ -525,33 +490,72 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
+  if (clock_period_ps_ == clock_period_ps) {
+    return;
+  }
+  clock_period_ps_ = clock_period_ps;
   absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
       std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
+  if (!critical_path_ps_.has_value()) {
+    critical_path_ps_ = ComputeCriticalPathDelay(topo_sort_, delay_map_);
+  }
+  if (clock_period_ps >= *critical_path_ps_) {
+    // No path is longer than the clock period, so there are no timing
+    // constraints; this is commonly where a search over clock periods starts.
+    delay_constraints_.clear();
+    for (Node* node : topo_sort_) {
+      delay_constraints_[node];
+    }
+  } else {
+    // The distances are computed on first use (they are never needed when
+    // subclassed for Iterative SDC). Pruned distances only cover clock periods
+    // up to the one they were computed for, so are recomputed if that's
+    // exceeded.
+    if (!distances_.has_value() ||
+        distances_->max_start_distance().value_or(clock_period_ps) <
+            clock_period_ps) {
+      distances_ = CriticalPathDistances::Compute(
+          topo_sort_, [&](Node* node) { return delay_map_.at(node); },
+          prune_distances_ ? std::make_optional(clock_period_ps)
+                           : std::nullopt);
+      VLOG(4) << absl::StrFormat(
+          "Computed critical-path distances for %d pairs of nodes",
+          distances_->pair_count());
+    }
+    delay_constraints_ = ComputeCombinationalDelayConstraints(
+        func_, topo_sort_, clock_period_ps, *distances_, delay_map_);
+  }
 
+  // Only the bounds of the timing constraints are changed here; constraints
+  // which are no longer needed are relaxed rather than deleted. This keeps the
+  // structure of the LP fixed across clock periods, which lets the incremental
+  // solver warm-start from the previous basis instead of solving from scratch.
+  absl::flat_hash_set<Node*> new_targets;
   for (Node* source : topo_sort_) {
     if (!prev_delay_constraints.empty()) {
-      // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
+      // Check over all the prior constraints, relaxing any that are obsolete.
+      new_targets.clear();
+      new_targets.insert(delay_constraints_.at(source).begin(),
+                         delay_constraints_.at(source).end());
       for (Node* target : prev_delay_constraints.at(source)) {
         if (new_targets.contains(target)) {
           continue;
         }
 
-        // No longer related; remove constraint.
-        auto it = timing_constraint_.find(std::make_pair(source, target));
-        model_.DeleteLinearConstraint(it->second);
-        timing_constraint_.erase(it);
+        // No longer related; relax constraint.
+        model_.set_lower_bound(
+            timing_constraint_.at(std::make_pair(source, target)), -kInfinity);
       }
     }
 
-    // Add all new constraints, avoiding duplicates for any that already exist.
+    // Enforce all new constraints, reusing any that already exist.
     for (Node* target : delay_constraints_.at(source)) {
       auto key = std::make_pair(source, target);
-      if (timing_constraint_.contains(key)) {
+      if (auto it = timing_constraint_.find(key);
+          it != timing_constraint_.end()) {
+        if (it->second.lower_bound() != 1.0) {
+          model_.set_lower_bound(it->second, 1.0);
+        }
         continue;
       }
 
@@ -579,6 +583,16 @@ absl::Status SDCSchedulingModel::SetWorstCaseThroughput(
   }
 
   proc->SetInitiationInterval(worst_case_throughput);
+  if (worst_case_throughput > 0 && !backedge_constraint_.empty()) {
+    // The set of backedges doesn't depend on the throughput, so just update
+    // the bounds in place; as with the timing constraints, this lets the
+    // incremental solver warm-start from the previous basis.
+    for (auto& [nodes, constraint] : backedge_constraint_) {
+      model_.set_upper_bound(constraint,
+                             static_cast<double>(worst_case_throughput - 1));
+    }
+    return absl::OkStatus();
+  }
   for (auto& [nodes, constraint] : backedge_constraint_) {
     model_.DeleteLinearConstraint(constraint);
   }
@@ -907,11 +921,13 @@ SDCSchedulingModel::AddLowerBoundSlack(
 }
 
 absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
-    FunctionBase* f, const DelayEstimator& delay_estimator) {
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    bool prune_critical_path_distances) {
   XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
                        ComputeNodeDelays(f, delay_estimator));
   std::unique_ptr<SDCScheduler> scheduler(
       new SDCScheduler(f, std::move(delay_map)));
+  scheduler->model_.PruneCriticalPathDistances(prune_critical_path_distances);
   XLS_RETURN_IF_ERROR(scheduler->Initialize());
   return std::move(scheduler);
 }
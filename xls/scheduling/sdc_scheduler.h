@@ -30,6 +30,7 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/scheduling/critical_path_distances.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -62,6 +63,13 @@ class SDCSchedulingModel {
   absl::Status AddSendThenRecvConstraint(
       const SendThenRecvConstraint& constraint);
 
+  // If set, only the critical-path distances which can affect the timing
+  // constraints at the clock periods being scheduled for are computed, rather
+  // than the distances between all pairs of nodes. This greatly reduces memory
+  // use for wide designs, but the distances must be recomputed whenever a
+  // longer clock period than any seen before is set.
+  void PruneCriticalPathDistances(bool value) { prune_distances_ = value; }
+
   void SetClockPeriod(int64_t clock_period_ps);
 
   absl::Status SetWorstCaseThroughput(int64_t worst_case_throughput);
@@ -151,11 +159,14 @@ class SDCSchedulingModel {
   operations_research::math_opt::Model model_;
   const DelayMap& delay_map_;
 
-  // Stores the critical-path distances between all pairs of Nodes; if there is
-  // a path from `x` to `y`, `distances_to_node_[y][x]` is the length of the
-  // critical path.
-  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-      distances_to_node_;
+  // Stores the critical-path distances between pairs of Nodes, computed by
+  // the first call to SetClockPeriod. If `prune_distances_` is set, only the
+  // pairs which matter for clock periods up to the one given then are kept.
+  std::optional<CriticalPathDistances> distances_;
+  bool prune_distances_ = false;
+
+  // The length of the longest delay path in the function.
+  std::optional<int64_t> critical_path_ps_;
 
   operations_research::math_opt::Variable last_stage_;
   std::optional<operations_research::math_opt::Variable> last_stage_slack_;
@@ -173,6 +184,9 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
+  // The clock period the timing constraints were last computed for.
+  std::optional<int64_t> clock_period_ps_;
+
   // A cache of the delay constraints.
   absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
 
@@ -188,7 +202,9 @@ class SDCSchedulingModel {
       io_constraints_;
 
   // A map from Node* pairs (a, b) to the LinearConstraint (if present)
-  // guaranteeing that a is in a stage strictly before b.
+  // guaranteeing that a is in a stage strictly before b. Constraints which are
+  // not needed at the current clock period are relaxed to have no lower bound
+  // rather than removed.
   absl::flat_hash_map<std::pair<Node*, Node*>,
                       operations_research::math_opt::LinearConstraint>
       timing_constraint_;
@@ -210,8 +226,11 @@ class SDCScheduler {
   using DelayMap = absl::flat_hash_map<Node*, int64_t>;
 
  public:
+  // See SDCSchedulingModel::PruneCriticalPathDistances for
+  // `prune_critical_path_distances`.
   static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
-      FunctionBase* f, const DelayEstimator& delay_estimator);
+      FunctionBase* f, const DelayEstimator& delay_estimator,
+      bool prune_critical_path_distances = false);
 
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
@@ -245,6 +264,15 @@ class SDCScheduler {
       bool check_feasibility = false,
       std::optional<int64_t> worst_case_throughput = std::nullopt);
 
+  // Returns the number of variables and linear constraints in the LP as of the
+  // last call to Schedule.
+  int64_t lp_variable_count() const {
+    return model_.UnderlyingModel().num_variables();
+  }
+  int64_t lp_constraint_count() const {
+    return model_.UnderlyingModel().num_linear_constraints();
+  }
+
  private:
   SDCScheduler(FunctionBase* f, DelayMap delay_map);
   absl::Status Initialize();
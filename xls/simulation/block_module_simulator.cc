@@ -0,0 +1,508 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/block_module_simulator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/channel.pb.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/module_testbench_thread.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// The number of cycles the DUT is held in reset, matching ModuleTestbench.
+constexpr int64_t kResetCycles = 5;
+
+absl::StatusOr<const BlockPortMappingProto*> BlockPortMapping(
+    const ChannelProto& channel_proto, std::string_view module_name) {
+  auto iter = absl::c_find_if(
+      channel_proto.metadata().block_ports(),
+      [&](const BlockPortMappingProto& block_port_mapping_proto) {
+        return block_port_mapping_proto.block_name() == module_name;
+      });
+  if (iter == channel_proto.metadata().block_ports().end()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Block port mapping for channel '%s' not found for module '%s'.",
+        channel_proto.name(), module_name));
+  }
+  return &*iter;
+}
+
+// Drives the values of an input channel on to the block ports in the same
+// sequence as the driver thread of the ModuleSimulator testbench: each value
+// is preceded by its valid holdoff and held until the cycle in which ready is
+// asserted.
+class InputChannelDriver {
+ public:
+  InputChannelDriver(const BlockPortMappingProto& ports, Type* data_type,
+                     absl::Span<const Value> values,
+                     absl::Span<const ValidHoldoff> holdoffs)
+      : ports_(ports),
+        data_type_(data_type),
+        values_(values),
+        holdoffs_(holdoffs) {}
+
+  // Sets the channel input ports for the upcoming cycle.
+  absl::Status Drive(absl::flat_hash_map<std::string, Value>& inputs) {
+    Value data = ZeroOfType(data_type_);
+    bool valid = false;
+    if (InHoldoff()) {
+      const ValidHoldoff& holdoff = holdoffs_[next_];
+      if (!holdoff.driven_values.empty() &&
+          std::holds_alternative<Bits>(
+              holdoff.driven_values[holdoff_cycle_])) {
+        XLS_ASSIGN_OR_RETURN(
+            data, UnflattenBitsToValue(
+                      std::get<Bits>(holdoff.driven_values[holdoff_cycle_]),
+                      data_type_));
+      }
+    } else if (next_ < values_.size()) {
+      data = values_[next_];
+      valid = true;
+    }
+    inputs[ports_.data_port_name()] = std::move(data);
+    inputs[ports_.valid_port_name()] = Value(UBits(valid ? 1 : 0, 1));
+    return absl::OkStatus();
+  }
+
+  // Advances the driver past a cycle given the outputs of that cycle.
+  void Advance(const absl::flat_hash_map<std::string, Value>& outputs) {
+    if (InHoldoff()) {
+      ++holdoff_cycle_;
+    } else if (next_ < values_.size() &&
+               outputs.at(ports_.ready_port_name()).bits().IsOne()) {
+      ++next_;
+      holdoff_cycle_ = 0;
+    }
+  }
+
+ private:
+  bool InHoldoff() const {
+    return next_ < values_.size() && !holdoffs_.empty() &&
+           holdoff_cycle_ < holdoffs_[next_].cycles;
+  }
+
+  const BlockPortMappingProto& ports_;
+  Type* data_type_;
+  absl::Span<const Value> values_;
+  absl::Span<const ValidHoldoff> holdoffs_;
+  int64_t next_ = 0;
+  int64_t holdoff_cycle_ = 0;
+};
+
+// Drives the ready port of an output channel and captures its values in the
+// same way as the ModuleSimulator testbench.
+class OutputChannelCapture {
+ public:
+  OutputChannelCapture(const BlockPortMappingProto& ports, int64_t count,
+                       absl::Span<const int64_t> ready_holdoffs)
+      : ports_(ports), count_(count) {
+    // Consecutive zero holdoffs extend the preceding assertion of ready; see
+    // ReadyValidHoldoffs::ready_holdoffs.
+    int64_t assertion_length = 1;
+    for (int64_t holdoff : ready_holdoffs) {
+      if (holdoff == 0) {
+        ++assertion_length;
+      } else {
+        ready_pattern_.insert(ready_pattern_.end(), assertion_length, true);
+        ready_pattern_.insert(ready_pattern_.end(), holdoff, false);
+        assertion_length = 1;
+      }
+    }
+  }
+
+  bool done() const { return values_.size() >= count_; }
+  std::vector<Value>& values() { return values_; }
+
+  // Sets the channel ready port (if any) for the given cycle.
+  void Drive(int64_t cycle, absl::flat_hash_map<std::string, Value>& inputs) {
+    if (ports_.has_ready_port_name()) {
+      bool ready = cycle >= ready_pattern_.size() || ready_pattern_[cycle];
+      inputs[ports_.ready_port_name()] = Value(UBits(ready ? 1 : 0, 1));
+    }
+  }
+
+  // Captures the channel value if a transaction occurred in the cycle which
+  // produced `outputs`.
+  void Capture(const absl::flat_hash_map<std::string, Value>& inputs,
+               const absl::flat_hash_map<std::string, Value>& outputs) {
+    if (done()) {
+      return;
+    }
+    if (ports_.has_valid_port_name() &&
+        !outputs.at(ports_.valid_port_name()).bits().IsOne()) {
+      return;
+    }
+    if (ports_.has_ready_port_name() &&
+        !inputs.at(ports_.ready_port_name()).bits().IsOne()) {
+      return;
+    }
+    values_.push_back(outputs.at(ports_.data_port_name()));
+  }
+
+ private:
+  const BlockPortMappingProto& ports_;
+  int64_t count_;
+  std::vector<bool> ready_pattern_;
+  std::vector<Value> values_;
+};
+
+}  // namespace
+
+absl::StatusOr<BlockModuleSimulator::ResetBlock>
+BlockModuleSimulator::CreateResetBlock() const {
+  ResetBlock result;
+  XLS_ASSIGN_OR_RETURN(result.continuation,
+                       evaluator_.NewContinuation(block_));
+  for (InputPort* port : block_->GetInputPorts()) {
+    result.inputs[port->GetName()] = ZeroOfType(port->GetType());
+  }
+  if (!signature_.proto().has_reset()) {
+    return result;
+  }
+  const ResetProto& reset = signature_.proto().reset();
+  result.inputs[reset.name()] = Value(UBits(reset.active_low() ? 0 : 1, 1));
+  for (int64_t i = 0; i < kResetCycles; ++i) {
+    XLS_RETURN_IF_ERROR(result.continuation->RunOneCycle(result.inputs));
+  }
+  result.inputs[reset.name()] = Value(UBits(reset.active_low() ? 1 : 0, 1));
+  return result;
+}
+
+absl::StatusOr<std::vector<BlockModuleSimulator::ValueMap>>
+BlockModuleSimulator::RunBatchedOnBlock(
+    absl::Span<const ValueMap> inputs) const {
+  if (inputs.empty()) {
+    return std::vector<ValueMap>();
+  }
+  XLS_ASSIGN_OR_RETURN(ResetBlock dut, CreateResetBlock());
+  std::vector<ValueMap> outputs;
+  auto run_cycle = [&](std::optional<int64_t> input_index,
+                       bool capture) -> absl::Status {
+    if (input_index.has_value()) {
+      for (const PortProto& port : signature_.data_inputs()) {
+        dut.inputs[port.name()] = inputs[*input_index].at(port.name());
+      }
+    }
+    XLS_RETURN_IF_ERROR(dut.continuation->RunOneCycle(dut.inputs));
+    if (capture) {
+      ValueMap& output = outputs.emplace_back();
+      for (const PortProto& port : signature_.data_outputs()) {
+        output[port.name()] = dut.continuation->output_ports().at(port.name());
+      }
+    }
+    return absl::OkStatus();
+  };
+
+  const ModuleSignatureProto& proto = signature_.proto();
+  if (proto.has_fixed_latency()) {
+    // Each input is held until its output is captured at the end of the
+    // latency.
+    const int64_t latency = proto.fixed_latency().latency();
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      for (int64_t cycle = 0; cycle <= latency; ++cycle) {
+        XLS_RETURN_IF_ERROR(run_cycle(i, /*capture=*/cycle == latency));
+      }
+    }
+  } else if (proto.has_pipeline()) {
+    // A new input enters the pipeline every cycle and its output is captured
+    // `latency` cycles later.
+    const int64_t latency = proto.pipeline().latency();
+    std::optional<PipelineControl> pipeline_control;
+    if (proto.pipeline().has_pipeline_control()) {
+      pipeline_control = proto.pipeline().pipeline_control();
+    }
+    if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+      dut.inputs[pipeline_control->manual().input_name()] =
+          Value(Bits::AllOnes(latency));
+    }
+    for (int64_t cycle = 0; cycle < inputs.size() + latency; ++cycle) {
+      bool driving = cycle < inputs.size();
+      if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+        dut.inputs[pipeline_control->valid().input_name()] =
+            Value(UBits(driving ? 1 : 0, 1));
+      }
+      if (!driving) {
+        for (const PortProto& port : signature_.data_inputs()) {
+          XLS_ASSIGN_OR_RETURN(InputPort * input,
+                               block_->GetInputPort(port.name()));
+          dut.inputs[port.name()] = ZeroOfType(input->GetType());
+        }
+      }
+      XLS_RETURN_IF_ERROR(
+          run_cycle(driving ? std::make_optional(cycle) : std::nullopt,
+                    /*capture=*/cycle >= latency));
+    }
+  } else if (proto.has_combinational()) {
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      XLS_RETURN_IF_ERROR(run_cycle(i, /*capture=*/true));
+    }
+  } else {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported interface: ", proto.interface_oneof_case()));
+  }
+  XLS_RET_CHECK_EQ(outputs.size(), inputs.size());
+  return outputs;
+}
+
+absl::StatusOr<BlockModuleSimulator::BitsMap> BlockModuleSimulator::RunFunction(
+    const BitsMap& inputs) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> outputs, RunBatched({inputs}));
+  XLS_RET_CHECK_EQ(outputs.size(), 1);
+  return outputs[0];
+}
+
+absl::StatusOr<Bits> BlockModuleSimulator::RunAndReturnSingleOutput(
+    const BitsMap& inputs) const {
+  XLS_ASSIGN_OR_RETURN(BitsMap outputs, RunFunction(inputs));
+  if (outputs.size() != 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected exactly one data output, got %d", outputs.size()));
+  }
+  return outputs.begin()->second;
+}
+
+absl::StatusOr<std::vector<BlockModuleSimulator::BitsMap>>
+BlockModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
+  std::vector<ValueMap> value_inputs;
+  for (const BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    ValueMap& value_input = value_inputs.emplace_back();
+    for (const auto& [name, bits] : input) {
+      XLS_ASSIGN_OR_RETURN(InputPort * port, block_->GetInputPort(name));
+      XLS_ASSIGN_OR_RETURN(value_input[name],
+                           UnflattenBitsToValue(bits, port->GetType()));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<ValueMap> value_outputs,
+                       RunBatchedOnBlock(value_inputs));
+  std::vector<BitsMap> outputs;
+  for (const ValueMap& value_output : value_outputs) {
+    BitsMap& output = outputs.emplace_back();
+    for (const auto& [name, value] : value_output) {
+      output[name] = FlattenValueToBits(value);
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<Value> BlockModuleSimulator::RunFunction(
+    const absl::flat_hash_map<std::string, Value>& inputs) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> outputs, RunBatched({inputs}));
+  XLS_RET_CHECK_EQ(outputs.size(), 1);
+  return outputs[0];
+}
+
+absl::StatusOr<std::vector<Value>> BlockModuleSimulator::RunBatched(
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  for (const auto& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+  }
+  XLS_RET_CHECK_EQ(signature_.data_outputs().size(), 1);
+  XLS_ASSIGN_OR_RETURN(std::vector<ValueMap> value_outputs,
+                       RunBatchedOnBlock(inputs));
+  std::vector<Value> outputs;
+  for (const ValueMap& value_output : value_outputs) {
+    outputs.push_back(value_output.at(signature_.data_outputs()[0].name()));
+  }
+  return outputs;
+}
+
+absl::StatusOr<Value> BlockModuleSimulator::RunFunction(
+    absl::Span<const Value> inputs) const {
+  XLS_ASSIGN_OR_RETURN(auto kwargs, signature_.ToKwargs(inputs));
+  return RunFunction(kwargs);
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
+BlockModuleSimulator::RunInputSeriesProcOnBlock(
+    const absl::flat_hash_map<std::string, std::vector<Value>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    const ReadyValidHoldoffs& holdoffs) const {
+  std::vector<InputChannelDriver> drivers;
+  for (const ChannelProto& channel_proto : signature_.GetInputChannels()) {
+    std::string_view channel_name = channel_proto.name();
+    XLS_ASSIGN_OR_RETURN(
+        const BlockPortMappingProto* ports,
+        BlockPortMapping(channel_proto, signature_.module_name()));
+    if (!ports->has_valid_port_name() || !ports->has_ready_port_name()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Input channel `%s` has no ready/valid flow control", channel_name));
+    }
+    auto values_it = channel_inputs.find(channel_name);
+    if (values_it == channel_inputs.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Channel '%s' not found in channel inputs map.", channel_name));
+    }
+    auto holdoffs_it = holdoffs.valid_holdoffs.find(channel_name);
+    absl::Span<const ValidHoldoff> valid_holdoffs;
+    if (holdoffs_it != holdoffs.valid_holdoffs.end()) {
+      XLS_RET_CHECK_EQ(holdoffs_it->second.size(), values_it->second.size())
+          << absl::StreamFormat(
+                 "Number of valid holdoffs does not match number of inputs "
+                 "for channel `%s`",
+                 channel_name);
+      for (const ValidHoldoff& holdoff : holdoffs_it->second) {
+        XLS_RET_CHECK_GE(holdoff.cycles, 0);
+        XLS_RET_CHECK(holdoff.driven_values.empty() ||
+                      holdoff.driven_values.size() == holdoff.cycles);
+      }
+      valid_holdoffs = holdoffs_it->second;
+    }
+    XLS_ASSIGN_OR_RETURN(InputPort * data_port,
+                         block_->GetInputPort(ports->data_port_name()));
+    drivers.emplace_back(*ports, data_port->GetType(), values_it->second,
+                         valid_holdoffs);
+  }
+
+  std::vector<std::string> output_channel_names;
+  std::vector<OutputChannelCapture> captures;
+  for (const ChannelProto& channel_proto : signature_.GetOutputChannels()) {
+    std::string_view channel_name = channel_proto.name();
+    auto count_it = output_channel_counts.find(channel_name);
+    if (count_it == output_channel_counts.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Channel '%s' not found in expected output channel counts map.",
+          channel_name));
+    }
+    if (count_it->second < 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Output channel '%s' has a negative read count.", channel_name));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const BlockPortMappingProto* ports,
+        BlockPortMapping(channel_proto, signature_.module_name()));
+    absl::Span<const int64_t> ready_holdoffs;
+    if (auto it = holdoffs.ready_holdoffs.find(channel_name);
+        it != holdoffs.ready_holdoffs.end()) {
+      ready_holdoffs = it->second;
+    }
+    output_channel_names.push_back(std::string{channel_name});
+    captures.emplace_back(*ports, count_it->second, ready_holdoffs);
+  }
+
+  XLS_ASSIGN_OR_RETURN(ResetBlock dut, CreateResetBlock());
+  int64_t cycle = 0;
+  while (!absl::c_all_of(captures, [](const OutputChannelCapture& capture) {
+    return capture.done();
+  })) {
+    if (cycle >= cycle_limit_) {
+      return absl::DeadlineExceededError(absl::StrFormat(
+          "Simulation ran too long (%d cycles).", cycle_limit_));
+    }
+    for (InputChannelDriver& driver : drivers) {
+      XLS_RETURN_IF_ERROR(driver.Drive(dut.inputs));
+    }
+    for (OutputChannelCapture& capture : captures) {
+      capture.Drive(cycle, dut.inputs);
+    }
+    XLS_RETURN_IF_ERROR(dut.continuation->RunOneCycle(dut.inputs));
+    const absl::flat_hash_map<std::string, Value>& outputs =
+        dut.continuation->output_ports();
+    for (InputChannelDriver& driver : drivers) {
+      driver.Advance(outputs);
+    }
+    for (OutputChannelCapture& capture : captures) {
+      capture.Capture(dut.inputs, outputs);
+    }
+    ++cycle;
+  }
+
+  absl::flat_hash_map<std::string, std::vector<Value>> results;
+  for (int64_t i = 0; i < captures.size(); ++i) {
+    results[output_channel_names[i]] = std::move(captures[i].values());
+  }
+  return results;
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Bits>>>
+BlockModuleSimulator::RunInputSeriesProc(
+    const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    std::optional<ReadyValidHoldoffs> holdoffs) const {
+  absl::flat_hash_map<std::string, std::vector<Value>> value_inputs;
+  for (const auto& [channel_name, channel_values] : channel_inputs) {
+    XLS_RETURN_IF_ERROR(
+        signature_.ValidateChannelBitsInputs(channel_name, channel_values));
+    XLS_ASSIGN_OR_RETURN(ChannelProto channel_proto,
+                         signature_.GetInputChannelProtoByName(channel_name));
+    XLS_ASSIGN_OR_RETURN(
+        const BlockPortMappingProto* ports,
+        BlockPortMapping(channel_proto, signature_.module_name()));
+    XLS_ASSIGN_OR_RETURN(InputPort * data_port,
+                         block_->GetInputPort(ports->data_port_name()));
+    std::vector<Value>& values = value_inputs[channel_name];
+    for (const Bits& bits : channel_values) {
+      XLS_ASSIGN_OR_RETURN(values.emplace_back(),
+                           UnflattenBitsToValue(bits, data_port->GetType()));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(
+      auto value_outputs,
+      RunInputSeriesProcOnBlock(value_inputs, output_channel_counts,
+                                holdoffs.value_or(ReadyValidHoldoffs())));
+  absl::flat_hash_map<std::string, std::vector<Bits>> outputs;
+  for (const auto& [channel_name, values] : value_outputs) {
+    std::vector<Bits>& bits = outputs[channel_name];
+    for (const Value& value : values) {
+      bits.push_back(FlattenValueToBits(value));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
+BlockModuleSimulator::RunInputSeriesProc(
+    const absl::flat_hash_map<std::string, std::vector<Value>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    std::optional<ReadyValidHoldoffs> holdoffs) const {
+  for (const auto& [channel_name, channel_values] : channel_inputs) {
+    XLS_RETURN_IF_ERROR(
+        signature_.ValidateChannelValueInputs(channel_name, channel_values));
+  }
+  return RunInputSeriesProcOnBlock(channel_inputs, output_channel_counts,
+                                   holdoffs.value_or(ReadyValidHoldoffs()));
+}
+
+}  // namespace verilog
+}  // namespace xls
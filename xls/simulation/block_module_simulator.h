@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SIMULATION_BLOCK_MODULE_SIMULATOR_H_
+#define XLS_SIMULATION_BLOCK_MODULE_SIMULATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/module_testbench.h"
+
+namespace xls {
+namespace verilog {
+
+// Simulates the module described by a ModuleSignature by evaluating the block
+// it was generated from rather than running the Verilog under a simulator. The
+// block is driven cycle by cycle exactly as the ModuleSimulator testbench
+// drives the module (reset, pipeline control, channel flow control and
+// holdoffs), so the two are interchangeable for any block whose Verilog is a
+// faithful translation of its IR. This is much faster than Verilog simulation
+// and is intended for quick iteration; it does not check the generated Verilog
+// itself.
+//
+// Values which the Verilog testbench drives as X are driven as zero.
+class BlockModuleSimulator {
+ public:
+  using BitsMap = ModuleSimulator::BitsMap;
+
+  // `block` must be the block from which the module described by `signature`
+  // was generated and must outlive the simulator. `cycle_limit` bounds the
+  // number of cycles run (excluding reset) by RunInputSeriesProc.
+  BlockModuleSimulator(
+      const ModuleSignature& signature, Block* block,
+      const BlockEvaluator& evaluator = kJitBlockEvaluator,
+      int64_t cycle_limit = kDefaultSimulationCycleLimit)
+      : signature_(signature),
+        block_(block),
+        evaluator_(evaluator),
+        cycle_limit_(cycle_limit) {}
+
+  // Counterparts of the ModuleSimulator methods of the same names.
+  absl::StatusOr<BitsMap> RunFunction(const BitsMap& inputs) const;
+  absl::StatusOr<Bits> RunAndReturnSingleOutput(const BitsMap& inputs) const;
+  absl::StatusOr<std::vector<BitsMap>> RunBatched(
+      absl::Span<const BitsMap> inputs) const;
+
+  absl::StatusOr<Value> RunFunction(
+      const absl::flat_hash_map<std::string, Value>& inputs) const;
+  absl::StatusOr<std::vector<Value>> RunBatched(
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+  absl::StatusOr<Value> RunFunction(absl::Span<const Value> inputs) const;
+
+  absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Bits>>>
+  RunInputSeriesProc(
+      const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
+  absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
+  RunInputSeriesProc(
+      const absl::flat_hash_map<std::string, std::vector<Value>>&
+          channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
+
+ private:
+  // Returns a new continuation of the block which has been through the reset
+  // sequence of the testbench, along with the input port values (all
+  // deasserted or zero) to drive from then on.
+  struct ResetBlock {
+    std::unique_ptr<BlockContinuation> continuation;
+    absl::flat_hash_map<std::string, Value> inputs;
+  };
+  absl::StatusOr<ResetBlock> CreateResetBlock() const;
+
+  // Implementations of RunBatched and RunInputSeriesProc on values of the
+  // block's port types.
+  using ValueMap = absl::flat_hash_map<std::string, Value>;
+  absl::StatusOr<std::vector<ValueMap>> RunBatchedOnBlock(
+      absl::Span<const ValueMap> inputs) const;
+  absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
+  RunInputSeriesProcOnBlock(
+      const absl::flat_hash_map<std::string, std::vector<Value>>&
+          channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      const ReadyValidHoldoffs& holdoffs) const;
+
+  ModuleSignature signature_;
+  Block* block_;
+  const BlockEvaluator& evaluator_;
+  int64_t cycle_limit_;
+};
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_SIMULATION_BLOCK_MODULE_SIMULATOR_H_
@@ -0,0 +1,191 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/block_module_simulator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/combinational_generator.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/simulation/module_simulator.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class BlockModuleSimulatorTest : public IrTestBase {
+ protected:
+  CodegenOptions PipelineOptions() const {
+    return CodegenOptions()
+        .clock_name("clk")
+        .reset("rst", /*asynchronous=*/false, /*active_low=*/false,
+               /*reset_data_path=*/false)
+        .flop_inputs(true)
+        .flop_outputs(true);
+  }
+
+  // Returns a function computing `x * y + z` on 16-bit values.
+  Function* MakeMulAdd(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(16));
+    BValue y = fb.Param("y", p->GetBitsType(16));
+    BValue z = fb.Param("z", p->GetBitsType(16));
+    fb.Add(fb.UMul(x, y), z);
+    return fb.Build().value();
+  }
+
+  // Returns a stateless proc which receives `x` on `in` and sends `2x + 1` on
+  // `out`.
+  Proc* MakeDoubleIncrementProc(Package* p) {
+    Channel* in = p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                            p->GetBitsType(32))
+                      .value();
+    Channel* out = p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                             p->GetBitsType(32))
+                       .value();
+    ProcBuilder pb(TestName(), p);
+    BValue rcv = pb.Receive(in, pb.Literal(Value::Token()));
+    BValue x = pb.TupleIndex(rcv, 1);
+    BValue result = pb.Add(pb.UMul(x, pb.Literal(UBits(2, 32))),
+                           pb.Literal(UBits(1, 32)));
+    pb.Send(out, pb.TupleIndex(rcv, 0), result);
+    return pb.Build().value();
+  }
+};
+
+TEST_F(BlockModuleSimulatorTest, PipelinedFunction) {
+  auto p = CreatePackage();
+  Function* f = MakeMulAdd(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(3)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, f,
+                           PipelineOptions().valid_control("in_vld",
+                                                           "out_vld")));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           p->GetBlock(result.signature.module_name()));
+  BlockModuleSimulator simulator(result.signature, block);
+
+  EXPECT_THAT(simulator.RunAndReturnSingleOutput(
+                  {{"x", UBits(3, 16)}, {"y", UBits(5, 16)},
+                   {"z", UBits(7, 16)}}),
+              IsOkAndHolds(UBits(22, 16)));
+
+  std::vector<ModuleSimulator::BitsMap> inputs;
+  for (int64_t i = 0; i < 10; ++i) {
+    inputs.push_back({{"x", UBits(i, 16)},
+                      {"y", UBits(i + 1, 16)},
+                      {"z", UBits(100, 16)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ModuleSimulator::BitsMap> outputs,
+                           simulator.RunBatched(inputs));
+  ASSERT_EQ(outputs.size(), inputs.size());
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    EXPECT_THAT(outputs[i], UnorderedElementsAre(Pair(
+                                "out", UBits(i * (i + 1) + 100, 16))))
+        << i;
+  }
+}
+
+TEST_F(BlockModuleSimulatorTest, CombinationalFunctionValues) {
+  auto p = CreatePackage();
+  Function* f = MakeMulAdd(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      GenerateCombinationalModule(f, CodegenOptions()));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           p->GetBlock(result.signature.module_name()));
+  BlockModuleSimulator simulator(result.signature, block);
+  EXPECT_THAT(simulator.RunFunction({Value(UBits(2, 16)), Value(UBits(4, 16)),
+                                     Value(UBits(1, 16))}),
+              IsOkAndHolds(Value(UBits(9, 16))));
+}
+
+TEST_F(BlockModuleSimulatorTest, ProcWithHoldoffs) {
+  auto p = CreatePackage();
+  Proc* proc = MakeDoubleIncrementProc(p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(2)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, proc, PipelineOptions()));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           p->GetBlock(result.signature.module_name()));
+  BlockModuleSimulator simulator(result.signature, block);
+
+  std::vector<Bits> inputs = {UBits(1, 32), UBits(10, 32), UBits(42, 32)};
+  absl::flat_hash_map<std::string, std::vector<Bits>> channel_inputs = {
+      {"in", inputs}};
+  absl::flat_hash_map<std::string, int64_t> output_counts = {{"out", 3}};
+  EXPECT_THAT(
+      simulator.RunInputSeriesProc(channel_inputs, output_counts),
+      IsOkAndHolds(UnorderedElementsAre(Pair(
+          "out", ElementsAre(UBits(3, 32), UBits(21, 32), UBits(85, 32))))));
+
+  ReadyValidHoldoffs holdoffs;
+  holdoffs.valid_holdoffs["in"] = {
+      ValidHoldoff{.cycles = 2, .driven_values = {}},
+      ValidHoldoff{.cycles = 0, .driven_values = {}},
+      ValidHoldoff{.cycles = 3, .driven_values = {UBits(7, 32), IsX(),
+                                                  UBits(8, 32)}}};
+  holdoffs.ready_holdoffs["out"] = {4, 0, 1, 5};
+  EXPECT_THAT(
+      simulator.RunInputSeriesProc(channel_inputs, output_counts, holdoffs),
+      IsOkAndHolds(UnorderedElementsAre(Pair(
+          "out", ElementsAre(UBits(3, 32), UBits(21, 32), UBits(85, 32))))));
+
+  // Asking for more outputs than the proc produces runs into the cycle limit.
+  BlockModuleSimulator limited_simulator(result.signature, block,
+                                         kJitBlockEvaluator,
+                                         /*cycle_limit=*/100);
+  EXPECT_THAT(limited_simulator.RunInputSeriesProc(channel_inputs,
+                                                   {{"out", 4}}),
+              StatusIs(absl::StatusCode::kDeadlineExceeded));
+}
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
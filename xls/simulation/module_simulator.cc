@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -28,16 +29,19 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/codegen/flattening.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/value.h"
@@ -45,6 +49,7 @@
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/module_testbench_thread.h"
 #include "xls/simulation/testbench_signal_capture.h"
+#include "xls/simulation/testbench_stream.h"
 #include "xls/tools/eval_utils.h"
 
 namespace xls {
@@ -745,5 +750,227 @@ absl::StatusOr<Value> ModuleSimulator::RunFunction(
   return RunFunction(kwargs);
 }
 
+absl::StatusOr<std::unique_ptr<ModuleSimulatorSession>>
+ModuleSimulator::CreateSession() const {
+  const ModuleSignatureProto& proto = signature_.proto();
+  if (!proto.has_clock_name() && !proto.has_combinational()) {
+    return absl::InvalidArgumentError("Expected clock in signature");
+  }
+  // The number of cycles from driving an input to capturing its output, and
+  // between consecutive inputs. Reading a value from a stream only completes
+  // once the following value arrives, so each batch is followed by enough idle
+  // inputs to push the last real input one cycle past the latency.
+  int64_t latency = 0;
+  int64_t cycles_per_input = 1;
+  std::optional<PipelineControl> pipeline_control;
+  auto session = absl::WrapUnique(new ModuleSimulatorSession(signature_));
+  if (proto.has_fixed_latency()) {
+    latency = proto.fixed_latency().latency();
+    cycles_per_input = latency + 1;
+    session->idle_cycles_ = 1;
+  } else if (proto.has_pipeline()) {
+    latency = proto.pipeline().latency();
+    if (proto.pipeline().has_pipeline_control()) {
+      pipeline_control = proto.pipeline().pipeline_control();
+    }
+    session->idle_cycles_ = latency + 1;
+  } else if (proto.has_combinational()) {
+    session->idle_cycles_ = 1;
+  } else {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported interface: ", proto.interface_oneof_case()));
+  }
+  for (const PortProto& port : proto.data_ports()) {
+    if (port.width() == 0) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Zero-width port `%s` is not supported in a simulation session",
+          port.name()));
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(session->testbench_,
+                       ModuleTestbench::CreateFromVerilogText(
+                           verilog_text_, file_type_, signature_, simulator_,
+                           /*reset_dut=*/true, includes_,
+                           /*simulation_cycle_limit=*/std::nullopt));
+  ModuleTestbench& tb = *session->testbench_;
+  ModuleSimulatorSession* s = session.get();
+
+  std::vector<DutInput> dut_inputs = DeassertControlSignals();
+  for (const PortProto& input : signature_.data_inputs()) {
+    dut_inputs.push_back(DutInput{input.name(), IsX()});
+  }
+  XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * input_tbt,
+                       tb.CreateThread("input driver", dut_inputs,
+                                       /*wait_until_done=*/false));
+  SequentialBlock& input_seq = input_tbt->MainBlock();
+  if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+    input_seq.Set(pipeline_control->manual().input_name(),
+                  Bits::AllOnes(latency));
+  }
+  SequentialBlock& input_loop = input_seq.RepeatForever();
+  auto add_input_stream = [&](const std::string& port,
+                              int64_t width) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(const TestbenchStream* stream,
+                         tb.CreateInputStream(port, width));
+    input_loop.ReadFromStreamAndSet(port, stream);
+    {
+      absl::MutexLock lock(&s->mutex_);
+      s->input_queues_[port];
+    }
+    s->producers_[port] = [s, port]() { return s->NextInput(port); };
+    return absl::OkStatus();
+  };
+  for (const PortProto& input : signature_.data_inputs()) {
+    XLS_RETURN_IF_ERROR(add_input_stream(input.name(), input.width()));
+  }
+  if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+    s->valid_input_ = pipeline_control->valid().input_name();
+    XLS_RETURN_IF_ERROR(add_input_stream(*s->valid_input_, 1));
+  }
+  input_loop.AdvanceNCycles(cycles_per_input);
+
+  XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * output_tbt,
+                       tb.CreateThread("output capture", /*dut_inputs=*/{}));
+  SequentialBlock& output_seq = output_tbt->MainBlock();
+  if (latency > 0) {
+    output_seq.AdvanceNCycles(latency);
+  }
+  SequentialBlock& output_loop = output_seq.RepeatForever();
+  EndOfCycleEvent& event = output_loop.AtEndOfCycle();
+  for (const PortProto& output : signature_.data_outputs()) {
+    XLS_ASSIGN_OR_RETURN(const TestbenchStream* stream,
+                         tb.CreateOutputStream(output.name(), output.width()));
+    event.CaptureAndWriteToStream(output.name(), stream);
+    {
+      absl::MutexLock lock(&s->mutex_);
+      s->output_queues_[output.name()];
+    }
+    s->consumers_[output.name()] = [s, port = output.name()](const Bits& b) {
+      return s->AddOutput(port, b);
+    };
+  }
+  if (cycles_per_input > 1) {
+    output_loop.AdvanceNCycles(cycles_per_input - 1);
+  }
+
+  s->thread_ = std::make_unique<Thread>([s]() {
+    absl::flat_hash_map<std::string, TestbenchStreamThread::Producer> producers;
+    for (const auto& [name, producer] : s->producers_) {
+      producers.emplace(name, producer);
+    }
+    absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer> consumers;
+    for (const auto& [name, consumer] : s->consumers_) {
+      consumers.emplace(name, consumer);
+    }
+    absl::Status status =
+        s->testbench_->RunWithStreamingIo(producers, consumers);
+    absl::MutexLock lock(&s->mutex_);
+    s->done_ = true;
+    s->status_ = status;
+  });
+  return session;
+}
+
+ModuleSimulatorSession::~ModuleSimulatorSession() {
+  {
+    absl::MutexLock lock(&mutex_);
+    closed_ = true;
+  }
+  // Closing the input streams terminates the simulation.
+  if (thread_ != nullptr) {
+    thread_->Join();
+  }
+}
+
+std::optional<Bits> ModuleSimulatorSession::NextInput(const std::string& port) {
+  absl::MutexLock lock(&mutex_);
+  std::deque<Bits>& queue = input_queues_.at(port);
+  auto has_input_or_is_closed = [&]() { return closed_ || !queue.empty(); };
+  mutex_.Await(absl::Condition(&has_input_or_is_closed));
+  if (queue.empty()) {
+    return std::nullopt;
+  }
+  Bits value = std::move(queue.front());
+  queue.pop_front();
+  return value;
+}
+
+absl::Status ModuleSimulatorSession::AddOutput(const std::string& port,
+                                               const Bits& value) {
+  absl::MutexLock lock(&mutex_);
+  output_queues_.at(port).push_back(value);
+  return absl::OkStatus();
+}
+
+bool ModuleSimulatorSession::HasOutputsOrIsDone() const {
+  return done_ || absl::c_all_of(output_queues_, [](const auto& pair) {
+           return !pair.second.empty();
+         });
+}
+
+void ModuleSimulatorSession::PushInputs(const BitsMap& inputs, bool real) {
+  for (const PortProto& input : signature_.data_inputs()) {
+    input_queues_.at(input.name()).push_back(inputs.at(input.name()));
+  }
+  if (valid_input_.has_value()) {
+    input_queues_.at(*valid_input_).push_back(UBits(real ? 1 : 0, 1));
+  }
+  pending_.push_back(real);
+}
+
+absl::StatusOr<std::vector<ModuleSimulatorSession::BitsMap>>
+ModuleSimulatorSession::RunBatched(absl::Span<const BitsMap> inputs) {
+  for (const BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+  }
+  if (inputs.empty()) {
+    return std::vector<BitsMap>();
+  }
+  BitsMap idle_inputs;
+  for (const PortProto& input : signature_.data_inputs()) {
+    idle_inputs[input.name()] = Bits(input.width());
+  }
+
+  absl::MutexLock lock(&mutex_);
+  for (const BitsMap& input : inputs) {
+    PushInputs(input, /*real=*/true);
+  }
+  for (int64_t i = 0; i < idle_cycles_; ++i) {
+    PushInputs(idle_inputs, /*real=*/false);
+  }
+  // Outputs arrive in input order, including those of the idle cycles of
+  // earlier batches which are discarded.
+  std::vector<BitsMap> outputs;
+  while (outputs.size() < inputs.size()) {
+    mutex_.Await(
+        absl::Condition(this, &ModuleSimulatorSession::HasOutputsOrIsDone));
+    BitsMap output;
+    for (auto& [name, queue] : output_queues_) {
+      if (queue.empty()) {
+        return status_.ok() ? absl::InternalError(
+                                  "Simulation terminated before producing "
+                                  "all outputs")
+                            : status_;
+      }
+      output[name] = std::move(queue.front());
+      queue.pop_front();
+    }
+    bool real = pending_.front();
+    pending_.pop_front();
+    if (real) {
+      outputs.push_back(std::move(output));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<ModuleSimulatorSession::BitsMap>
+ModuleSimulatorSession::RunFunction(const BitsMap& inputs) {
+  XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> outputs, RunBatched({inputs}));
+  XLS_RET_CHECK_EQ(outputs.size(), 1);
+  return outputs[0];
+}
+
 }  // namespace verilog
 }  // namespace xls
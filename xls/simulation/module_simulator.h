@@ -16,17 +16,23 @@
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/value.h"
 #include "xls/simulation/module_testbench.h"
@@ -76,6 +82,8 @@ struct ReadyValidHoldoffs {
   absl::flat_hash_map<std::string, std::vector<int64_t>> ready_holdoffs;
 };
 
+class ModuleSimulatorSession;
+
 // Abstraction for simulating a module described by a SignatureProto using a
 // testbench run under the Verilog simulator.
 class ModuleSimulator {
@@ -135,6 +143,13 @@ class ModuleSimulator {
   // Runs a function with arguments as a Span.
   absl::StatusOr<Value> RunFunction(absl::Span<const Value> inputs) const;
 
+  // Starts a single Verilog simulator process which runs the module on the
+  // inputs of any number of later RunBatched calls on the returned session.
+  // Use this instead of RunBatched when inputs arrive in many separate batches
+  // to avoid compiling and launching the simulation for each one.
+  absl::StatusOr<std::unique_ptr<ModuleSimulatorSession>> CreateSession()
+      const;
+
   // Returns the (System)Verilog testbench for testing the module with the given
   // inputs and expected outputs counts.
   absl::StatusOr<std::string> GenerateProcTestbenchVerilog(
@@ -166,6 +181,79 @@ class ModuleSimulator {
   absl::Span<const VerilogInclude> includes_;
 };
 
+// A running simulation of a module with a function interface (fixed latency,
+// pipelined or combinational) created by ModuleSimulator::CreateSession. The
+// testbench reads the inputs of each cycle from named pipes and writes the
+// outputs to named pipes, blocking the simulation while there are no more
+// inputs, so batches can be fed through a single simulator process.
+//
+// Each batch is followed by idle cycles (with any valid input deasserted)
+// which flush its last inputs through the module.
+class ModuleSimulatorSession {
+ public:
+  using BitsMap = ModuleSimulator::BitsMap;
+
+  // Terminates the simulation.
+  ~ModuleSimulatorSession();
+
+  // Runs the given batch of argument values through the module. Returns an
+  // error if the simulation has terminated.
+  absl::StatusOr<std::vector<BitsMap>> RunBatched(
+      absl::Span<const BitsMap> inputs);
+  absl::StatusOr<BitsMap> RunFunction(const BitsMap& inputs);
+
+ private:
+  friend class ModuleSimulator;
+
+  explicit ModuleSimulatorSession(const ModuleSignature& signature)
+      : signature_(signature) {}
+
+  // Enqueues one cycle's worth of inputs. `real` is false for idle cycles
+  // whose outputs are discarded.
+  void PushInputs(const BitsMap& inputs, bool real)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  bool HasOutputsOrIsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Producer and consumer for the stream of the given port. NextInput blocks
+  // until an input is enqueued and returns std::nullopt once the session is
+  // closed.
+  std::optional<Bits> NextInput(const std::string& port);
+  absl::Status AddOutput(const std::string& port, const Bits& value);
+
+  ModuleSignature signature_;
+  std::unique_ptr<ModuleTestbench> testbench_;
+
+  // The name of the pipeline valid input port, if any.
+  std::optional<std::string> valid_input_;
+
+  // The number of idle cycles which follow each batch.
+  int64_t idle_cycles_ = 0;
+
+  // Producers and consumers for the testbench streams, which are named after
+  // the ports they drive or capture.
+  absl::flat_hash_map<std::string, std::function<std::optional<Bits>()>>
+      producers_;
+  absl::flat_hash_map<std::string, std::function<absl::Status(const Bits&)>>
+      consumers_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::deque<Bits>> input_queues_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::deque<Bits>> output_queues_
+      ABSL_GUARDED_BY(mutex_);
+  // Whether each enqueued cycle whose outputs have not yet been read is a
+  // real input (rather than an idle cycle).
+  std::deque<bool> pending_ ABSL_GUARDED_BY(mutex_);
+  // Set when the session is destroyed to stop feeding the simulation.
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set when the simulation has terminated, with its status.
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+
+  std::unique_ptr<Thread> thread_;
+};
+
 }  // namespace verilog
 }  // namespace xls
 
@@ -15,6 +15,7 @@
 #include "xls/simulation/module_simulator.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -409,6 +410,52 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, FixedLatencySession) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ModuleSimulatorSession> session,
+                           simulator.CreateSession());
+
+  // Batches of different sizes all run through the same simulation.
+  using BitsMap = ModuleSimulator::BitsMap;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BitsMap> outputs,
+      session->RunBatched(
+          {BitsMap{{"x", UBits(44, 8)}}, BitsMap{{"x", UBits(123, 8)}}}));
+  EXPECT_THAT(outputs, ElementsAre(ElementsAre(Pair("out", UBits(88, 8))),
+                                   ElementsAre(Pair("out", UBits(246, 8)))));
+  EXPECT_THAT(session->RunFunction({{"x", UBits(7, 8)}}),
+              IsOkAndHolds(ElementsAre(Pair("out", UBits(14, 8)))));
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_THAT(session->RunFunction({{"x", UBits(i, 8)}}),
+                IsOkAndHolds(ElementsAre(Pair("out", UBits(2 * i, 8)))));
+  }
+}
+
+TEST_P(ModuleSimulatorTest, CombinationalSession) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ModuleSimulatorSession> session,
+                           simulator.CreateSession());
+
+  using BitsMap = ModuleSimulator::BitsMap;
+  for (int64_t batch = 0; batch < 3; ++batch) {
+    std::vector<BitsMap> inputs;
+    for (int64_t i = 0; i < 5; ++i) {
+      inputs.push_back({{"x", UBits(100 + batch, 8)}, {"y", UBits(i, 8)}});
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                             session->RunBatched(inputs));
+    ASSERT_EQ(outputs.size(), inputs.size());
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      EXPECT_THAT(outputs[i],
+                  ElementsAre(Pair("out", UBits(100 + batch - i, 8))));
+    }
+  }
+}
+
 TEST_P(ModuleSimulatorTest, ReadyValidBatched) {
   XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeReadyValidModule());
   ModuleSimulator simulator =
@@ -775,7 +775,7 @@ static std::string GetPipePathMacroName(std::string_view stream_name) {
 }
 
 absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateInputStream(
-    std::string_view name, int64_t width) {
+    std::string_view name, int64_t width, TestbenchStreamEncoding encoding) {
   if (stream_names_.contains(name)) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Already a I/O stream named `%s`", name));
@@ -785,12 +785,13 @@ absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateInputStream(
       new TestbenchStream{.name = std::string{name},
                           .direction = TestbenchStreamDirection::kInput,
                           .path_macro_name = GetPipePathMacroName(name),
-                          .width = width}));
+                          .width = width,
+                          .encoding = encoding}));
   return streams_.back().get();
 }
 
 absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateOutputStream(
-    std::string_view name, int64_t width) {
+    std::string_view name, int64_t width, TestbenchStreamEncoding encoding) {
   if (stream_names_.contains(name)) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Already a I/O stream named `%s`", name));
@@ -800,7 +801,8 @@ absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateOutputStream(
       new TestbenchStream{.name = std::string{name},
                           .direction = TestbenchStreamDirection::kOutput,
                           .path_macro_name = GetPipePathMacroName(name),
-                          .width = width}));
+                          .width = width,
+                          .encoding = encoding}));
   return streams_.back().get();
 }
 
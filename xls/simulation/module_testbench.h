@@ -146,10 +146,14 @@ class ModuleTestbench {
   // Allocate streams for reading and writing values to the testbench. The
   // returned pointer can be passed to SequentialBlock::ReadFromStreamAndSet or
   // EndOfCycleEvent::CaptureAndWriteToStream to connect into the simulation.
+  // Binary encoding is much faster for simulations which stream large amounts
+  // of data but can't detect X values.
   absl::StatusOr<const TestbenchStream*> CreateInputStream(
-      std::string_view name, int64_t width);
+      std::string_view name, int64_t width,
+      TestbenchStreamEncoding encoding = TestbenchStreamEncoding::kText);
   absl::StatusOr<const TestbenchStream*> CreateOutputStream(
-      std::string_view name, int64_t width);
+      std::string_view name, int64_t width,
+      TestbenchStreamEncoding encoding = TestbenchStreamEncoding::kText);
 
  private:
   ModuleTestbench(std::string_view verilog_text, FileType file_type,
@@ -969,6 +969,54 @@ TEST_P(ModuleTestbenchTest, StreamingIo) {
       {{output_stream->name, SequentialConsumer()}}));
 }
 
+TEST_P(ModuleTestbenchTest, StreamingIoBinary) {
+  constexpr int64_t kInputCount = 100000;
+  // Not a multiple of 8 to exercise padding of values to whole bytes.
+  constexpr int64_t kWidth = 44;
+
+  VerilogFile f = NewVerilogFile();
+  Module* m = MakeTwoStageIdentityPipeline(&f, kWidth);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVastModule(
+          m, GetSimulator(), "clk", /*reset=*/std::nullopt,
+          /*includes=*/{}, /*simulation_cycle_limit=*/kInputCount + 10));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const TestbenchStream* input_stream,
+      tb->CreateInputStream("my_input", kWidth,
+                            TestbenchStreamEncoding::kBinary));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const TestbenchStream* output_stream,
+      tb->CreateOutputStream("my_output", kWidth,
+                             TestbenchStreamEncoding::kBinary));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleTestbenchThread * input_thread,
+      tb->CreateThreadDrivingAllInputs("input", /*initial_value=*/ZeroOrX::kX));
+  {
+    SequentialBlock& seq = input_thread->MainBlock();
+    SequentialBlock& loop = seq.Repeat(kInputCount);
+    loop.ReadFromStreamAndSet("in", input_stream).NextCycle();
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * output_thread,
+                           tb->CreateThread("output",
+                                            /*dut_inputs=*/{}));
+  {
+    SequentialBlock& seq = output_thread->MainBlock();
+    seq.NextCycle().NextCycle();
+    SequentialBlock& loop = seq.Repeat(kInputCount);
+    loop.AtEndOfCycle().CaptureAndWriteToStream("out", output_stream);
+  }
+
+  // Start at an offset so values span all of the bytes.
+  constexpr int64_t kOffset = int64_t{0xabc} << 32;
+  XLS_ASSERT_OK(tb->RunWithStreamingIo(
+      {{input_stream->name,
+        SequentialProducer(kWidth, kInputCount, kOffset)}},
+      {{output_stream->name, SequentialConsumer(kOffset)}}));
+}
+
 TEST_P(ModuleTestbenchTest, CycleLimit) {
   VerilogFile f = NewVerilogFile();
   Module* m = MakeTwoStageIdentityPipeline(&f);
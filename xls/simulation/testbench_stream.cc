@@ -14,7 +14,11 @@
 
 #include "xls/simulation/testbench_stream.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
@@ -29,9 +33,14 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/file/file_descriptor.h"
 #include "xls/common/file/named_pipe.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/ir/bits.h"
@@ -42,6 +51,14 @@
 
 namespace xls {
 namespace verilog {
+namespace {
+
+// Returns the number of bytes of each value in a binary stream.
+int64_t BinaryValueByteCount(const TestbenchStream& stream) {
+  return CeilOfRatio(stream.width, int64_t{8});
+}
+
+}  // namespace
 
 /* static */ VastStreamEmitter VastStreamEmitter::Create(
     const TestbenchStream& stream, Module* m) {
@@ -56,6 +73,13 @@ namespace verilog {
   emitter.error_string_ = m->AddReg(
       absl::StrFormat("__%s_error_str", stream.name),
       m->file()->BitVectorType(kStringSize * 8, SourceInfo()), SourceInfo());
+  if (stream.encoding == TestbenchStreamEncoding::kBinary) {
+    emitter.buffer_ = m->AddReg(
+        absl::StrFormat("__%s_buf", stream.name),
+        m->file()->BitVectorType(BinaryValueByteCount(stream) * 8,
+                                 SourceInfo()),
+        SourceInfo());
+  }
   return emitter;
 }
 
@@ -74,8 +98,12 @@ void VastStreamEmitter::EmitOpen(StatementBlock* block) const {
           block->file()->Make<MacroRef>(SourceInfo(), stream_.path_macro_name),
           block->file()->Make<QuotedString>(
               SourceInfo(),
-              stream_.direction == TestbenchStreamDirection::kInput ? "r"
-                                                                    : "w")});
+              absl::StrCat(
+                  stream_.direction == TestbenchStreamDirection::kInput ? "r"
+                                                                        : "w",
+                  stream_.encoding == TestbenchStreamEncoding::kBinary
+                      ? "b"
+                      : ""))});
   block->Add<BlockingAssignment>(SourceInfo(), file_descriptor_, fopen_call);
   Conditional* conditional = block->Add<Conditional>(
       SourceInfo(),
@@ -100,10 +128,43 @@ void VastStreamEmitter::EmitOpen(StatementBlock* block) const {
 }
 
 void VastStreamEmitter::EmitRead(StatementBlock* block, LogicRef* lhs) const {
+  if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+    // Emit code:
+    //
+    //   cnt = $fread(buf, fd);
+    //   if (cnt != <byte count>) begin
+    //     $display("FAILED: ...");
+    //     $finish;
+    //   end
+    //   lhs = buf[<width - 1>:0];
+    SystemFunctionCall* call = block->file()->Make<SystemFunctionCall>(
+        SourceInfo(), "fread",
+        std::vector<Expression*>{buffer_, file_descriptor_});
+    block->Add<BlockingAssignment>(SourceInfo(), count_, call);
+    Conditional* conditional = block->Add<Conditional>(
+        SourceInfo(),
+        block->file()->NotEquals(
+            count_,
+            block->file()->PlainLiteral(BinaryValueByteCount(stream_),
+                                        SourceInfo()),
+            SourceInfo()));
+    conditional->consequent()->Add<Display>(
+        SourceInfo(),
+        std::vector<Expression*>{block->file()->Make<QuotedString>(
+            SourceInfo(),
+            absl::StrFormat("FAILED: $fread of file for stream `%s` failed.",
+                            stream_.name))});
+    conditional->consequent()->Add<Finish>(SourceInfo());
+    block->Add<BlockingAssignment>(
+        SourceInfo(), lhs,
+        block->file()->Slice(buffer_, stream_.width - 1, 0, SourceInfo()));
+    return;
+  }
+
   // Emit code:
   //
   //   cnt = $fscanf(fd, "%x\n", lhs);
-  //   if (cnt == 0) begin
+  //   if (cnt != 1) begin
   //     $display("FAILED: ...");
   //     $finish;
   //   end
@@ -115,8 +176,8 @@ void VastStreamEmitter::EmitRead(StatementBlock* block, LogicRef* lhs) const {
   block->Add<BlockingAssignment>(SourceInfo(), count_, call);
   Conditional* conditional = block->Add<Conditional>(
       SourceInfo(),
-      block->file()->Equals(
-          count_, block->file()->PlainLiteral(0, SourceInfo()), SourceInfo()));
+      block->file()->NotEquals(
+          count_, block->file()->PlainLiteral(1, SourceInfo()), SourceInfo()));
   conditional->consequent()->Add<Display>(
       SourceInfo(),
       std::vector<Expression*>{block->file()->Make<QuotedString>(
@@ -128,10 +189,38 @@ void VastStreamEmitter::EmitRead(StatementBlock* block, LogicRef* lhs) const {
 
 void VastStreamEmitter::EmitWrite(StatementBlock* block,
                                   Expression* value) const {
+  if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+    // Emit code:
+    //
+    //   buf = <value>;
+    //   $fwrite(fd, "%c%c...", buf[<n*8-1>:<n*8-8>], ..., buf[7:0]);
+    //   $fflush(fd);
+    block->Add<BlockingAssignment>(SourceInfo(), buffer_, value);
+    std::string format;
+    std::vector<Expression*> bytes;
+    for (int64_t i = BinaryValueByteCount(stream_) - 1; i >= 0; --i) {
+      format += "%c";
+      bytes.push_back(
+          block->file()->Slice(buffer_, i * 8 + 7, i * 8, SourceInfo()));
+    }
+    std::vector<Expression*> args = {
+        file_descriptor_,
+        block->file()->Make<QuotedString>(SourceInfo(), format)};
+    args.insert(args.end(), bytes.begin(), bytes.end());
+    block->Add<SystemTaskCall>(SourceInfo(), "fwrite", args);
+    block->Add<SystemTaskCall>(SourceInfo(), "fflush",
+                               std::vector<Expression*>{file_descriptor_});
+    return;
+  }
+
   // Emit code:
   //
   //   $fwriteh(fd, <value>);
   //   $fwrite(fd, "\n");
+  //   $fflush(fd);
+  //
+  // The stream is flushed after each value so the reader can consume it
+  // without waiting for the simulation to finish.
   block->Add<SystemTaskCall>(SourceInfo(), "fwriteh",
                              std::vector<Expression*>{file_descriptor_, value});
   block->Add<SystemTaskCall>(
@@ -139,6 +228,8 @@ void VastStreamEmitter::EmitWrite(StatementBlock* block,
       std::vector<Expression*>{
           file_descriptor_,
           block->file()->Make<QuotedString>(SourceInfo(), R"(\n)")});
+  block->Add<SystemTaskCall>(SourceInfo(), "fflush",
+                             std::vector<Expression*>{file_descriptor_});
 }
 
 void VastStreamEmitter::EmitClose(StatementBlock* block) const {
@@ -159,6 +250,10 @@ void TestbenchStreamThread::RunInputStream(
   VLOG(1) << absl::StrFormat("RunInputStream [%s]", stream_.name);
   thread_ = absl::WrapUnique(new Thread([this, producer]() {
     VLOG(1) << absl::StrFormat("Thread for stream `%s` started", stream_.name);
+    if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+      ProduceBinaryValues(producer);
+      return;
+    }
     absl::StatusOr<FileLineWriter> writer =
         FileLineWriter::Create(named_pipe_.path());
     if (!writer.ok()) {
@@ -179,8 +274,13 @@ void TestbenchStreamThread::RunInputStream(
                                  stream_.name,
                                  BitsToString(*bits, FormatPreference::kHex));
       CHECK_EQ(bits->bit_count(), stream_.width);
+      // Flush each value so the testbench can consume it before the producer
+      // returns the next one, which may depend on outputs of the testbench.
       absl::Status write_status =
           writer->WriteLine(BitsToString(*bits, FormatPreference::kPlainHex));
+      if (write_status.ok()) {
+        write_status = writer->Flush();
+      }
       if (!write_status.ok()) {
         VLOG(1) << absl::StrFormat("Writing value to stream `%s` failed: %s",
                                    stream_.name, write_status.message());
@@ -196,6 +296,10 @@ void TestbenchStreamThread::RunOutputStream(
   VLOG(1) << absl::StrFormat("RunOutputStream [%s]", stream_.name);
   thread_ = absl::WrapUnique(new Thread([this, consumer]() {
     VLOG(1) << absl::StrFormat("Thread for stream `%s` started", stream_.name);
+    if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+      ConsumeBinaryValues(consumer);
+      return;
+    }
     absl::StatusOr<FileLineReader> reader =
         FileLineReader::Create(named_pipe_.path());
     if (!reader.ok()) {
@@ -255,6 +359,80 @@ void TestbenchStreamThread::RunOutputStream(
   }));
 }
 
+void TestbenchStreamThread::ProduceBinaryValues(Producer producer) {
+  absl::StatusOr<FileStream> file = FileStream::Open(named_pipe_.path(), "wb");
+  if (!file.ok()) {
+    LOG(ERROR) << absl::StrFormat("Opening stream `%s` failed: %s",
+                                  stream_.name, file.status().message());
+    MaybeSetError(file.status());
+    return;
+  }
+  std::vector<uint8_t> bytes(BinaryValueByteCount(stream_));
+  while (true) {
+    std::optional<Bits> bits = producer();
+    if (!bits.has_value()) {
+      VLOG(1) << absl::StrFormat(
+          "Producer returned std::nullopt for stream `%s`", stream_.name);
+      break;
+    }
+    CHECK_EQ(bits->bit_count(), stream_.width);
+    // Bits are little-endian; the testbench reads the most significant byte
+    // first.
+    bits->ToBytes(absl::MakeSpan(bytes));
+    std::reverse(bytes.begin(), bytes.end());
+    // As for text streams, flush each value so the testbench can consume it
+    // before the producer returns the next one.
+    if (fwrite(bytes.data(), 1, bytes.size(), file->get()) != bytes.size() ||
+        fflush(file->get()) != 0) {
+      absl::Status write_status = ErrnoToStatus(errno);
+      VLOG(1) << absl::StrFormat("Writing value to stream `%s` failed: %s",
+                                 stream_.name, write_status.message());
+      MaybeSetError(write_status);
+      break;
+    }
+  }
+}
+
+void TestbenchStreamThread::ConsumeBinaryValues(Consumer consumer) {
+  absl::StatusOr<FileStream> file = FileStream::Open(named_pipe_.path(), "rb");
+  if (!file.ok()) {
+    LOG(ERROR) << absl::StrFormat("Opening stream `%s` failed: %s",
+                                  stream_.name, file.status().message());
+    MaybeSetError(file.status());
+    return;
+  }
+  std::vector<uint8_t> bytes(BinaryValueByteCount(stream_));
+  while (true) {
+    size_t read = fread(bytes.data(), 1, bytes.size(), file->get());
+    if (read != bytes.size()) {
+      if (ferror(file->get())) {
+        absl::Status read_status = ErrnoToStatus(errno);
+        LOG(ERROR) << absl::StrFormat("Error reading from stream `%s`: %s",
+                                      stream_.name, read_status.message());
+        MaybeSetError(read_status);
+      } else if (read != 0) {
+        LOG(ERROR) << absl::StrFormat(
+            "Stream `%s` ended in the middle of a value", stream_.name);
+        MaybeSetError(absl::DataLossError(absl::StrFormat(
+            "Stream `%s` ended in the middle of a value", stream_.name)));
+      } else {
+        VLOG(1) << absl::StrFormat(
+            "Stream `%s` reached EOF. Pipe has been closed.", stream_.name);
+      }
+      break;
+    }
+    std::reverse(bytes.begin(), bytes.end());
+    absl::Status result =
+        consumer(Bits::FromBytes(bytes, /*bit_count=*/stream_.width));
+    if (!result.ok()) {
+      VLOG(1) << absl::StrFormat(
+          "Consumer for stream `%s` returned an error: %s", stream_.name,
+          result.message());
+      MaybeSetError(result);
+    }
+  }
+}
+
 absl::Status TestbenchStreamThread::Join() {
   thread_->Join();
   return status_;
@@ -37,6 +37,17 @@ namespace verilog {
 // flowing from the testbench.
 enum class TestbenchStreamDirection : int8_t { kInput, kOutput };
 
+// How values are encoded in a stream.
+enum class TestbenchStreamEncoding : int8_t {
+  // One hexadecimal value per line. X values written by the testbench are
+  // detected and reported as errors.
+  kText,
+  // Each value as ceil(width / 8) raw bytes, most significant byte first. Much
+  // cheaper than text to produce and parse on both ends for simulations which
+  // stream large amounts of data, but X values can't be detected.
+  kBinary,
+};
+
 // An abstraction representing a stream for communicating with Verilog
 // testbench.
 struct TestbenchStream {
@@ -50,6 +61,8 @@ struct TestbenchStream {
 
   // The width of the data to read/write to the testbench.
   int64_t width;
+
+  TestbenchStreamEncoding encoding = TestbenchStreamEncoding::kText;
 };
 
 // Class for emitting VAST code for reading and writing values to streams.
@@ -79,6 +92,9 @@ class VastStreamEmitter {
   LogicRef* count_;
   LogicRef* errno_;
   LogicRef* error_string_;
+  // Byte-aligned register holding the value read or written by binary
+  // streams.
+  LogicRef* buffer_ = nullptr;
 };
 
 // A wrapper around a thread which read/writes data via a stream to/from a
@@ -117,6 +133,10 @@ class TestbenchStreamThread {
   TestbenchStreamThread(const TestbenchStream& stream, NamedPipe named_pipe)
       : stream_(stream), named_pipe_(std::move(named_pipe)) {}
 
+  // Loops of the input and output stream threads for binary streams.
+  void ProduceBinaryValues(Producer producer);
+  void ConsumeBinaryValues(Consumer consumer);
+
   // Sets `status_` to the given error status if `status_` does not already hold
   // an error code.
   void MaybeSetError(const absl::Status& status);
@@ -0,0 +1,244 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_prover.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/abstract_node_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/solvers/sat_solver.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls::solvers::sat {
+namespace {
+
+// Evaluator building an and-inverter graph directly as clauses in a
+// SatSolver. Each AND gate gets a fresh variable constrained to equal the
+// conjunction of its inputs; constants are folded and identical gates are
+// shared, so the encoding stays close to the size of the optimized logic.
+class AigEvaluator : public AbstractEvaluator<Literal, AigEvaluator> {
+ public:
+  explicit AigEvaluator(SatSolver* solver)
+      : solver_(solver), true_(PositiveLiteral(solver->NewVariable())) {
+    solver_->AddClause({true_});
+  }
+
+  Literal One() const { return true_; }
+  Literal Zero() const { return sat::Negate(true_); }
+  Literal Not(const Literal& input) const { return sat::Negate(input); }
+  Literal And(const Literal& a, const Literal& b) const {
+    if (a == Zero() || b == Zero() || a == sat::Negate(b)) {
+      return Zero();
+    }
+    if (a == One() || a == b) {
+      return b;
+    }
+    if (b == One()) {
+      return a;
+    }
+    auto [it, inserted] =
+        and_gates_.try_emplace({std::min(a, b), std::max(a, b)}, 0);
+    if (inserted) {
+      Literal gate = PositiveLiteral(solver_->NewVariable());
+      solver_->AddClause({sat::Negate(gate), a});
+      solver_->AddClause({sat::Negate(gate), b});
+      solver_->AddClause({gate, sat::Negate(a), sat::Negate(b)});
+      it->second = gate;
+    }
+    return it->second;
+  }
+  Literal Or(const Literal& a, const Literal& b) const {
+    return Not(And(Not(a), Not(b)));
+  }
+  Literal If(Literal sel, Literal consequent, Literal alternate) const {
+    if (consequent == alternate) {
+      return consequent;
+    }
+    return Or(And(sel, consequent), And(Not(sel), alternate));
+  }
+
+ private:
+  SatSolver* solver_;
+  Literal true_;
+  mutable absl::flat_hash_map<std::pair<Literal, Literal>, Literal> and_gates_;
+};
+
+// Node evaluator giving each leaf bit of a parameter its own free variable.
+class BitBlastingNodeEvaluator : public AbstractNodeEvaluator<AigEvaluator> {
+ public:
+  BitBlastingNodeEvaluator(AigEvaluator& evaluator, SatSolver* solver)
+      : AbstractNodeEvaluator<AigEvaluator>(evaluator), solver_(solver) {}
+
+  absl::Status HandleParam(Param* param) override {
+    XLS_ASSIGN_OR_RETURN(
+        LeafTypeTree<LeafValueT> value,
+        LeafTypeTree<LeafValueT>::CreateFromFunction(
+            param->GetType(),
+            [&](Type* leaf_type) -> absl::StatusOr<LeafValueT> {
+              LeafValueT bits;
+              for (int64_t i = 0; i < leaf_type->GetFlatBitCount(); ++i) {
+                bits.push_back(PositiveLiteral(solver_->NewVariable()));
+              }
+              return bits;
+            }));
+    return SetValue(param, std::move(value));
+  }
+
+ private:
+  SatSolver* solver_;
+};
+
+// Returns a literal which is true iff any bit of `node`'s value is set.
+absl::StatusOr<Literal> AnyBitSet(AigEvaluator& evaluator,
+                                  const BitBlastingNodeEvaluator& visitor,
+                                  Node* node) {
+  XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<AigEvaluator::Vector> value,
+                       visitor.GetCompoundValue(node));
+  Literal result = evaluator.Zero();
+  for (const AigEvaluator::Vector& leaf : value.elements()) {
+    for (Literal bit : leaf) {
+      result = evaluator.Or(result, bit);
+    }
+  }
+  return result;
+}
+
+// Returns a literal which is true iff `subject` violates `p`.
+absl::StatusOr<Literal> NegatedObjective(
+    AigEvaluator& evaluator, const BitBlastingNodeEvaluator& visitor,
+    Node* subject, const z3::Predicate& p) {
+  switch (p.kind()) {
+    case z3::PredicateKind::kEqualToZero:
+      return AnyBitSet(evaluator, visitor, subject);
+    case z3::PredicateKind::kNotEqualToZero: {
+      XLS_ASSIGN_OR_RETURN(Literal any, AnyBitSet(evaluator, visitor, subject));
+      return evaluator.Not(any);
+    }
+    case z3::PredicateKind::kEqualToNode: {
+      XLS_RET_CHECK(subject->GetType()->IsEqualTo(p.node()->GetType()))
+          << subject << " vs " << p.node();
+      XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<AigEvaluator::Vector> a,
+                           visitor.GetCompoundValue(subject));
+      XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<AigEvaluator::Vector> b,
+                           visitor.GetCompoundValue(p.node()));
+      Literal equal = evaluator.One();
+      for (int64_t i = 0; i < a.elements().size(); ++i) {
+        equal = evaluator.And(
+            equal, evaluator.Equals(a.elements()[i], b.elements()[i]));
+      }
+      return evaluator.Not(equal);
+    }
+    case z3::PredicateKind::kUnsignedGreaterOrEqual:
+    case z3::PredicateKind::kUnsignedLessOrEqual: {
+      XLS_ASSIGN_OR_RETURN(AigEvaluator::Span value, visitor.GetValue(subject));
+      XLS_RET_CHECK_EQ(value.size(), p.value().bit_count()) << subject;
+      AigEvaluator::Vector bound = evaluator.BitsToVector(p.value());
+      return p.kind() == z3::PredicateKind::kUnsignedGreaterOrEqual
+                 ? evaluator.ULessThan(value, bound)
+                 : evaluator.ULessThan(bound, value);
+    }
+  }
+  return absl::InternalError("Unknown predicate kind");
+}
+
+absl::StatusOr<absl::flat_hash_map<const Param*, Value>> Counterexample(
+    FunctionBase* f, const BitBlastingNodeEvaluator& visitor,
+    const SatSolver& solver) {
+  absl::flat_hash_map<const Param*, Value> counterexample;
+  for (Param* param : f->params()) {
+    // Parameters outside the cone of the query don't matter.
+    if (!visitor.values().contains(param)) {
+      counterexample[param] = ZeroOfType(param->GetType());
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<AigEvaluator::Vector> bits,
+                         visitor.GetCompoundValue(param));
+    XLS_ASSIGN_OR_RETURN(
+        LeafTypeTree<Value> leaves,
+        (leaf_type_tree::MapIndex<Value, AigEvaluator::Vector>(
+            bits,
+            [&](Type* leaf_type, const AigEvaluator::Vector& leaf,
+                absl::Span<const int64_t> index) -> absl::StatusOr<Value> {
+              if (leaf_type->IsToken()) {
+                return Value::Token();
+              }
+              InlineBitmap bitmap(leaf.size());
+              for (int64_t i = 0; i < leaf.size(); ++i) {
+                bitmap.Set(i, solver.ModelValue(leaf[i]));
+              }
+              return Value(Bits::FromBitmap(std::move(bitmap)));
+            })));
+    XLS_ASSIGN_OR_RETURN(counterexample[param],
+                         LeafTypeTreeToValue(leaves.AsView()));
+  }
+  return counterexample;
+}
+
+}  // namespace
+
+absl::StatusOr<z3::ProverResult> TryProveWithSat(FunctionBase* f,
+                                                  Node* subject,
+                                                  const z3::Predicate& p,
+                                                  absl::Duration timeout) {
+  absl::Time deadline = absl::Now() + timeout;
+  SatSolver solver;
+  AigEvaluator evaluator(&solver);
+  BitBlastingNodeEvaluator visitor(evaluator, &solver);
+  XLS_RETURN_IF_ERROR(subject->Accept(&visitor));
+  if (p.kind() == z3::PredicateKind::kEqualToNode) {
+    XLS_RETURN_IF_ERROR(p.node()->Accept(&visitor));
+  }
+  XLS_ASSIGN_OR_RETURN(Literal violated,
+                       NegatedObjective(evaluator, visitor, subject, p));
+  solver.AddClause({violated});
+
+  switch (solver.Solve(deadline)) {
+    case SatResult::kUnsatisfiable:
+      return z3::ProvenTrue();
+    case SatResult::kSatisfiable:
+      return z3::ProvenFalse{
+          .counterexample = Counterexample(f, visitor, solver),
+          .message = absl::StrFormat(
+              "SAT solver found a counterexample after %d conflicts over %d "
+              "variables",
+              solver.conflict_count(), solver.variable_count())};
+    case SatResult::kUnknown:
+      break;
+  }
+  return absl::DeadlineExceededError("SAT solver timed out");
+}
+
+}  // namespace xls::solvers::sat
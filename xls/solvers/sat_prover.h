@@ -0,0 +1,44 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_SAT_PROVER_H_
+#define XLS_SOLVERS_SAT_PROVER_H_
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls::solvers::sat {
+
+// Attempts to prove node "subject" in function "f" satisfies the given
+// predicate (over all possible inputs) within the duration "timeout", like
+// z3::TryProve.
+//
+// Rather than translating to Z3 bit-vectors, the cone of "subject" (and of the
+// node a kEqualToNode predicate compares against) is bit-blasted into a
+// structurally hashed and-inverter graph whose Tseitin encoding is handed to
+// the embedded CDCL solver. This is usually much faster for bit-level logic
+// such as control paths, comparisons and muxes, and slower for wide
+// arithmetic, so callers choose per query. Array index, slice and update
+// operations are not supported. On timeout, returns a DeadlineExceeded error.
+absl::StatusOr<z3::ProverResult> TryProveWithSat(FunctionBase* f,
+                                                  Node* subject,
+                                                  const z3::Predicate& p,
+                                                  absl::Duration timeout);
+
+}  // namespace xls::solvers::sat
+
+#endif  // XLS_SOLVERS_SAT_PROVER_H_
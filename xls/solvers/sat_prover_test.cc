@@ -0,0 +1,147 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_prover.h"
+
+#include <memory>
+#include <variant>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_ir_translator_matchers.h"
+
+namespace xls::solvers::sat {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using z3::IsProvenFalse;
+using z3::IsProvenTrue;
+using z3::Predicate;
+using z3::ProvenFalse;
+using z3::ProverResult;
+using ::testing::HasSubstr;
+
+class SatProverTest : public IrTestBase {};
+
+TEST_F(SatProverTest, AgreesWithZ3) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  // x + y == y + x, and (x & y) <= x.
+  BValue commuted = fb.Add(y, x);
+  BValue masked = fb.And(x, y);
+  BValue masked_le_x = fb.ULe(masked, x);
+  BValue lt_self = fb.ULt(x, x);
+  BValue sel = fb.Select(fb.BitSlice(x, 0, 1), sum, commuted);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  struct Query {
+    BValue subject;
+    Predicate predicate;
+    bool expected;
+  };
+  Query queries[] = {
+      {sum, Predicate::IsEqualTo(commuted.node()), true},
+      {sel, Predicate::IsEqualTo(sum.node()), true},
+      {sum, Predicate::IsEqualTo(x.node()), false},
+      {masked_le_x, Predicate::NotEqualToZero(), true},
+      {lt_self, Predicate::EqualToZero(), true},
+      {sum, Predicate::EqualToZero(), false},
+      {masked, Predicate::UnsignedLessOrEqual(UBits(0xff, 8)), true},
+      {masked, Predicate::UnsignedGreaterOrEqual(UBits(1, 8)), false},
+  };
+  for (const Query& query : queries) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ProverResult sat_result,
+        TryProveWithSat(f, query.subject.node(), query.predicate,
+                        absl::InfiniteDuration()));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ProverResult z3_result,
+        z3::TryProve(f, query.subject.node(), query.predicate,
+                     absl::InfiniteDuration()));
+    EXPECT_EQ(std::holds_alternative<z3::ProvenTrue>(sat_result),
+              query.expected)
+        << query.subject << " " << query.predicate.ToString();
+    EXPECT_EQ(sat_result.index(), z3_result.index())
+        << query.subject << " " << query.predicate.ToString();
+  }
+}
+
+TEST_F(SatProverTest, CounterexampleViolatesPredicate) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue unused = fb.Param("unused", p->GetBitsType(4));
+  BValue is_magic = fb.Eq(x, fb.Literal(UBits(0x1234, 16)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProverResult result,
+      TryProveWithSat(f, is_magic.node(), Predicate::EqualToZero(),
+                      absl::InfiniteDuration()));
+  ASSERT_THAT(result, IsProvenFalse());
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  XLS_ASSERT_OK(proven_false.counterexample);
+  EXPECT_EQ(proven_false.counterexample->at(x.node()->As<Param>()),
+            Value(UBits(0x1234, 16)));
+  EXPECT_EQ(proven_false.counterexample->at(unused.node()->As<Param>()),
+            Value(UBits(0, 4)));
+}
+
+TEST_F(SatProverTest, TupleEquality) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue y = fb.Param("y", p->GetBitsType(4));
+  BValue a = fb.Tuple({fb.Not(fb.Not(x)), y});
+  BValue b = fb.Tuple({x, y});
+  BValue c = fb.Tuple({y, x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(TryProveWithSat(f, a.node(), Predicate::IsEqualTo(b.node()),
+                              absl::InfiniteDuration()),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(TryProveWithSat(f, a.node(), Predicate::IsEqualTo(c.node()),
+                              absl::InfiniteDuration()),
+              IsOkAndHolds(IsProvenFalse()));
+}
+
+TEST_F(SatProverTest, ArrayIndexIsUnsupported) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetArrayType(4, p->GetBitsType(8)));
+  BValue i = fb.Param("i", p->GetBitsType(2));
+  BValue element = fb.ArrayIndex(a, {i});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(TryProveWithSat(f, element.node(), Predicate::EqualToZero(),
+                              absl::InfiniteDuration()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not supported")));
+}
+
+}  // namespace
+}  // namespace xls::solvers::sat
@@ -0,0 +1,432 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_solver.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace xls::solvers::sat {
+namespace {
+
+// Conflicts between restarts are this times the next term of the Luby
+// sequence.
+constexpr int64_t kRestartBase = 100;
+
+// Deadlines are only checked every this many (a power of two) conflicts.
+constexpr int64_t kDeadlineCheckInterval = 256;
+
+constexpr double kVariableDecay = 0.95;
+constexpr double kClauseDecay = 0.999;
+constexpr double kRescaleLimit = 1e100;
+
+// Returns the `i`th (zero-based) term of the Luby sequence 1 1 2 1 1 2 4 ...
+int64_t Luby(int64_t i) {
+  int64_t size = 1;
+  int64_t sequence = 0;
+  while (size < i + 1) {
+    ++sequence;
+    size = 2 * size + 1;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) >> 1;
+    --sequence;
+    i = i % size;
+  }
+  return int64_t{1} << sequence;
+}
+
+}  // namespace
+
+int32_t SatSolver::NewVariable() {
+  int32_t variable = variable_count();
+  assigns_.push_back(kUnassigned);
+  levels_.push_back(0);
+  reasons_.push_back(-1);
+  saved_phases_.push_back(false);
+  activities_.push_back(0.0);
+  heap_positions_.push_back(-1);
+  seen_.push_back(false);
+  watches_.emplace_back();
+  watches_.emplace_back();
+  HeapInsert(variable);
+  return variable;
+}
+
+void SatSolver::AddClause(absl::Span<const Literal> clause) {
+  CHECK_EQ(DecisionLevel(), 0);
+  if (unsatisfiable_) {
+    return;
+  }
+  std::vector<Literal> literals(clause.begin(), clause.end());
+  std::sort(literals.begin(), literals.end());
+  literals.erase(std::unique(literals.begin(), literals.end()),
+                 literals.end());
+  std::vector<Literal> kept;
+  kept.reserve(literals.size());
+  for (int64_t i = 0; i < literals.size(); ++i) {
+    CHECK_LT(LiteralVariable(literals[i]), variable_count());
+    // Literals of one variable are adjacent after sorting.
+    if ((i + 1 < literals.size() && literals[i + 1] == Negate(literals[i])) ||
+        Value(literals[i]) == kTrue) {
+      return;  // Tautology, or already satisfied.
+    }
+    if (Value(literals[i]) == kUnassigned) {
+      kept.push_back(literals[i]);
+    }
+  }
+  if (kept.empty()) {
+    unsatisfiable_ = true;
+  } else if (kept.size() == 1) {
+    Enqueue(kept[0], -1);
+    if (Propagate() != -1) {
+      unsatisfiable_ = true;
+    }
+  } else {
+    clauses_.push_back(Clause{.literals = std::move(kept)});
+    AttachClause(static_cast<int32_t>(clauses_.size() - 1));
+  }
+}
+
+SatResult SatSolver::Solve(absl::Time deadline) {
+  model_.clear();
+  if (unsatisfiable_ || Propagate() != -1) {
+    unsatisfiable_ = true;
+    return SatResult::kUnsatisfiable;
+  }
+
+  int64_t restart_count = 0;
+  int64_t conflicts_until_restart = kRestartBase * Luby(restart_count);
+  int64_t max_learned =
+      std::max<int64_t>(1000, static_cast<int64_t>(clauses_.size()) / 3);
+  while (true) {
+    int32_t conflict = Propagate();
+    if (conflict != -1) {
+      ++conflict_count_;
+      if (DecisionLevel() == 0) {
+        unsatisfiable_ = true;
+        return SatResult::kUnsatisfiable;
+      }
+      int32_t backtrack_level;
+      std::vector<Literal> learned = Analyze(conflict, &backtrack_level);
+      Backtrack(backtrack_level);
+      if (learned.size() == 1) {
+        Enqueue(learned[0], -1);
+      } else {
+        clauses_.push_back(
+            Clause{.literals = std::move(learned), .learned = true});
+        int32_t clause = static_cast<int32_t>(clauses_.size() - 1);
+        AttachClause(clause);
+        BumpClause(clauses_[clause]);
+        ++learned_count_;
+        Enqueue(clauses_[clause].literals[0], clause);
+      }
+      variable_increment_ /= kVariableDecay;
+      clause_increment_ /= kClauseDecay;
+      --conflicts_until_restart;
+      if (conflict_count_ % kDeadlineCheckInterval == 0 &&
+          absl::Now() >= deadline) {
+        Backtrack(0);
+        return SatResult::kUnknown;
+      }
+      continue;
+    }
+
+    if (conflicts_until_restart <= 0) {
+      Backtrack(0);
+      conflicts_until_restart = kRestartBase * Luby(++restart_count);
+      if (learned_count_ > max_learned) {
+        ReduceLearnedClauses();
+        max_learned += max_learned / 10;
+      }
+      continue;
+    }
+
+    Literal decision = PickBranchLiteral();
+    if (decision == -1) {
+      model_.resize(variable_count());
+      for (int32_t variable = 0; variable < variable_count(); ++variable) {
+        model_[variable] = assigns_[variable] == kTrue;
+      }
+      Backtrack(0);
+      return SatResult::kSatisfiable;
+    }
+    trail_limits_.push_back(static_cast<int32_t>(trail_.size()));
+    Enqueue(decision, -1);
+  }
+}
+
+bool SatSolver::ModelValue(Literal literal) const {
+  CHECK_LT(LiteralVariable(literal), model_.size());
+  return model_[LiteralVariable(literal)] != IsNegated(literal);
+}
+
+int8_t SatSolver::Value(Literal literal) const {
+  int8_t value = assigns_[LiteralVariable(literal)];
+  if (value == kUnassigned) {
+    return kUnassigned;
+  }
+  return value ^ static_cast<int8_t>(IsNegated(literal));
+}
+
+void SatSolver::Enqueue(Literal literal, int32_t reason) {
+  int32_t variable = LiteralVariable(literal);
+  assigns_[variable] = IsNegated(literal) ? kFalse : kTrue;
+  levels_[variable] = DecisionLevel();
+  reasons_[variable] = reason;
+  trail_.push_back(literal);
+}
+
+int32_t SatSolver::Propagate() {
+  while (propagation_head_ < trail_.size()) {
+    Literal false_literal = Negate(trail_[propagation_head_++]);
+    std::vector<int32_t>& watch_list = watches_[false_literal];
+    int64_t kept = 0;
+    for (int64_t i = 0; i < watch_list.size(); ++i) {
+      int32_t clause = watch_list[i];
+      std::vector<Literal>& literals = clauses_[clause].literals;
+      if (clauses_[clause].deleted) {
+        continue;
+      }
+      // Keep the false watch in the second slot; the first is the one implied
+      // if no other literal can be watched.
+      if (literals[0] == false_literal) {
+        std::swap(literals[0], literals[1]);
+      }
+      if (Value(literals[0]) == kTrue) {
+        watch_list[kept++] = clause;
+        continue;
+      }
+      bool moved = false;
+      for (int64_t k = 2; k < literals.size(); ++k) {
+        if (Value(literals[k]) != kFalse) {
+          std::swap(literals[1], literals[k]);
+          watches_[literals[1]].push_back(clause);
+          moved = true;
+          break;
+        }
+      }
+      if (moved) {
+        continue;
+      }
+      watch_list[kept++] = clause;
+      if (Value(literals[0]) == kFalse) {
+        for (++i; i < watch_list.size(); ++i) {
+          watch_list[kept++] = watch_list[i];
+        }
+        watch_list.resize(kept);
+        propagation_head_ = trail_.size();
+        return clause;
+      }
+      Enqueue(literals[0], clause);
+    }
+    watch_list.resize(kept);
+  }
+  return -1;
+}
+
+std::vector<Literal> SatSolver::Analyze(int32_t conflict,
+                                        int32_t* backtrack_level) {
+  // The first literal is filled in with the negated UIP at the end.
+  std::vector<Literal> learned = {-1};
+  int64_t open_paths = 0;
+  Literal implied = -1;
+  int64_t trail_index = static_cast<int64_t>(trail_.size()) - 1;
+  int32_t clause = conflict;
+  do {
+    Clause& reason = clauses_[clause];
+    if (reason.learned) {
+      BumpClause(reason);
+    }
+    // The first literal of a reason is the one it implied.
+    for (int64_t k = implied == -1 ? 0 : 1; k < reason.literals.size(); ++k) {
+      Literal literal = reason.literals[k];
+      int32_t variable = LiteralVariable(literal);
+      if (seen_[variable] || levels_[variable] == 0) {
+        continue;
+      }
+      seen_[variable] = true;
+      BumpVariable(variable);
+      if (levels_[variable] == DecisionLevel()) {
+        ++open_paths;
+      } else {
+        learned.push_back(literal);
+      }
+    }
+    while (!seen_[LiteralVariable(trail_[trail_index])]) {
+      --trail_index;
+    }
+    implied = trail_[trail_index--];
+    clause = reasons_[LiteralVariable(implied)];
+    seen_[LiteralVariable(implied)] = false;
+    --open_paths;
+  } while (open_paths > 0);
+  learned[0] = Negate(implied);
+
+  // Watch the literal of the highest remaining level second, so the clause is
+  // correctly watched after backtracking to that level.
+  *backtrack_level = 0;
+  for (int64_t k = 1; k < learned.size(); ++k) {
+    seen_[LiteralVariable(learned[k])] = false;
+    if (levels_[LiteralVariable(learned[k])] > *backtrack_level) {
+      *backtrack_level = levels_[LiteralVariable(learned[k])];
+      std::swap(learned[1], learned[k]);
+    }
+  }
+  return learned;
+}
+
+void SatSolver::Backtrack(int32_t level) {
+  if (DecisionLevel() <= level) {
+    return;
+  }
+  for (int64_t i = static_cast<int64_t>(trail_.size()) - 1;
+       i >= trail_limits_[level]; --i) {
+    int32_t variable = LiteralVariable(trail_[i]);
+    saved_phases_[variable] = !IsNegated(trail_[i]);
+    assigns_[variable] = kUnassigned;
+    reasons_[variable] = -1;
+    if (heap_positions_[variable] < 0) {
+      HeapInsert(variable);
+    }
+  }
+  trail_.resize(trail_limits_[level]);
+  trail_limits_.resize(level);
+  propagation_head_ = trail_.size();
+}
+
+Literal SatSolver::PickBranchLiteral() {
+  while (!heap_.empty()) {
+    int32_t variable = HeapPop();
+    if (assigns_[variable] == kUnassigned) {
+      Literal literal = PositiveLiteral(variable);
+      return saved_phases_[variable] ? literal : Negate(literal);
+    }
+  }
+  return -1;
+}
+
+void SatSolver::AttachClause(int32_t clause) {
+  const std::vector<Literal>& literals = clauses_[clause].literals;
+  watches_[literals[0]].push_back(clause);
+  watches_[literals[1]].push_back(clause);
+}
+
+void SatSolver::ReduceLearnedClauses() {
+  // Only called at decision level zero, where no learned clause is the reason
+  // for an assignment that conflict analysis could visit.
+  std::vector<int32_t> candidates;
+  for (int32_t clause = 0; clause < clauses_.size(); ++clause) {
+    if (clauses_[clause].learned && !clauses_[clause].deleted &&
+        clauses_[clause].literals.size() > 2) {
+      candidates.push_back(clause);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), [&](int32_t a, int32_t b) {
+    return clauses_[a].activity < clauses_[b].activity;
+  });
+  for (int64_t i = 0; i < candidates.size() / 2; ++i) {
+    Clause& clause = clauses_[candidates[i]];
+    clause.deleted = true;
+    clause.literals = {};
+    --learned_count_;
+  }
+}
+
+void SatSolver::BumpVariable(int32_t variable) {
+  activities_[variable] += variable_increment_;
+  if (activities_[variable] > kRescaleLimit) {
+    for (double& activity : activities_) {
+      activity /= kRescaleLimit;
+    }
+    variable_increment_ /= kRescaleLimit;
+  }
+  if (heap_positions_[variable] >= 0) {
+    HeapSiftUp(heap_positions_[variable]);
+  }
+}
+
+void SatSolver::BumpClause(Clause& clause) {
+  clause.activity += clause_increment_;
+  if (clause.activity > kRescaleLimit) {
+    for (Clause& c : clauses_) {
+      c.activity /= kRescaleLimit;
+    }
+    clause_increment_ /= kRescaleLimit;
+  }
+}
+
+void SatSolver::HeapInsert(int32_t variable) {
+  heap_positions_[variable] = static_cast<int32_t>(heap_.size());
+  heap_.push_back(variable);
+  HeapSiftUp(heap_positions_[variable]);
+}
+
+int32_t SatSolver::HeapPop() {
+  int32_t top = heap_.front();
+  heap_positions_[top] = -1;
+  if (heap_.size() > 1) {
+    heap_.front() = heap_.back();
+    heap_positions_[heap_.front()] = 0;
+    heap_.pop_back();
+    HeapSiftDown(0);
+  } else {
+    heap_.pop_back();
+  }
+  return top;
+}
+
+void SatSolver::HeapSiftUp(int32_t position) {
+  int32_t variable = heap_[position];
+  while (position > 0) {
+    int32_t parent = (position - 1) / 2;
+    if (activities_[heap_[parent]] >= activities_[variable]) {
+      break;
+    }
+    heap_[position] = heap_[parent];
+    heap_positions_[heap_[position]] = position;
+    position = parent;
+  }
+  heap_[position] = variable;
+  heap_positions_[variable] = position;
+}
+
+void SatSolver::HeapSiftDown(int32_t position) {
+  int32_t variable = heap_[position];
+  int32_t size = static_cast<int32_t>(heap_.size());
+  while (2 * position + 1 < size) {
+    int32_t child = 2 * position + 1;
+    if (child + 1 < size &&
+        activities_[heap_[child + 1]] > activities_[heap_[child]]) {
+      ++child;
+    }
+    if (activities_[heap_[child]] <= activities_[variable]) {
+      break;
+    }
+    heap_[position] = heap_[child];
+    heap_positions_[heap_[position]] = position;
+    position = child;
+  }
+  heap_[position] = variable;
+  heap_positions_[variable] = position;
+}
+
+}  // namespace xls::solvers::sat
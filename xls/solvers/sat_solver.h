@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_SAT_SOLVER_H_
+#define XLS_SOLVERS_SAT_SOLVER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace xls::solvers::sat {
+
+// A literal is a variable index and a polarity, encoded as
+// `2 * variable + negated`.
+using Literal = int32_t;
+
+inline Literal PositiveLiteral(int32_t variable) { return 2 * variable; }
+inline Literal Negate(Literal literal) { return literal ^ 1; }
+inline int32_t LiteralVariable(Literal literal) { return literal >> 1; }
+inline bool IsNegated(Literal literal) { return (literal & 1) != 0; }
+
+enum class SatResult { kSatisfiable, kUnsatisfiable, kUnknown };
+
+// A conflict-driven clause-learning SAT solver for the CNF produced by
+// bit-blasting IR. It uses two watched literals per clause, first-UIP
+// learning, VSIDS branching with phase saving and Luby restarts, and
+// periodically discards the least useful half of the learned clauses.
+class SatSolver {
+ public:
+  int32_t NewVariable();
+  int32_t variable_count() const {
+    return static_cast<int32_t>(assigns_.size());
+  }
+
+  // Adds a clause over existing variables. Clauses may be added between calls
+  // to Solve(); everything learned so far is kept.
+  void AddClause(absl::Span<const Literal> clause);
+
+  // Searches for a satisfying assignment, giving up with kUnknown at
+  // `deadline`.
+  SatResult Solve(absl::Time deadline = absl::InfiniteFuture());
+
+  // The value of `literal` in the satisfying assignment found by the last
+  // Solve().
+  bool ModelValue(Literal literal) const;
+
+  int64_t conflict_count() const { return conflict_count_; }
+
+ private:
+  // Truth values, as seen from a literal with `Value(literal)`.
+  enum : int8_t { kFalse = 0, kTrue = 1, kUnassigned = 2 };
+
+  struct Clause {
+    std::vector<Literal> literals;
+    bool learned = false;
+    bool deleted = false;
+    double activity = 0.0;
+  };
+
+  int8_t Value(Literal literal) const;
+  int32_t DecisionLevel() const {
+    return static_cast<int32_t>(trail_limits_.size());
+  }
+
+  // Assigns `literal` true with the given reason clause (or -1).
+  void Enqueue(Literal literal, int32_t reason);
+
+  // Propagates all enqueued assignments, returning a conflicting clause or -1.
+  int32_t Propagate();
+
+  // Derives the first-UIP clause for `conflict`, returning it (asserting
+  // literal first) along with the level to backtrack to.
+  std::vector<Literal> Analyze(int32_t conflict, int32_t* backtrack_level);
+  void Backtrack(int32_t level);
+
+  // Returns the next decision literal, or -1 once all variables are assigned.
+  Literal PickBranchLiteral();
+
+  void AttachClause(int32_t clause);
+  void ReduceLearnedClauses();
+  void BumpVariable(int32_t variable);
+  void BumpClause(Clause& clause);
+
+  // Binary max-heap of unassigned variables ordered by activity.
+  void HeapInsert(int32_t variable);
+  int32_t HeapPop();
+  void HeapSiftUp(int32_t position);
+  void HeapSiftDown(int32_t position);
+
+  std::vector<Clause> clauses_;
+  // The clauses watching each literal, i.e. those to visit when it's false.
+  std::vector<std::vector<int32_t>> watches_;
+
+  std::vector<int8_t> assigns_;
+  std::vector<int32_t> levels_;
+  std::vector<int32_t> reasons_;
+  std::vector<bool> saved_phases_;
+  std::vector<Literal> trail_;
+  std::vector<int32_t> trail_limits_;
+  int64_t propagation_head_ = 0;
+
+  std::vector<double> activities_;
+  double variable_increment_ = 1.0;
+  double clause_increment_ = 1.0;
+  std::vector<int32_t> heap_;
+  std::vector<int32_t> heap_positions_;
+
+  std::vector<bool> seen_;
+  std::vector<bool> model_;
+  bool unsatisfiable_ = false;
+  int64_t conflict_count_ = 0;
+  int64_t learned_count_ = 0;
+};
+
+}  // namespace xls::solvers::sat
+
+#endif  // XLS_SOLVERS_SAT_SOLVER_H_
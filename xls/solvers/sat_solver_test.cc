@@ -0,0 +1,154 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_solver.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls::solvers::sat {
+namespace {
+
+bool SatisfiesAll(const SatSolver& solver,
+                  const std::vector<std::vector<Literal>>& clauses) {
+  for (const std::vector<Literal>& clause : clauses) {
+    bool satisfied = false;
+    for (Literal literal : clause) {
+      satisfied = satisfied || solver.ModelValue(literal);
+    }
+    if (!satisfied) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Adds clauses placing each of `pigeons` pigeons in one of `holes` holes with
+// no two pigeons sharing a hole.
+std::vector<std::vector<Literal>> AddPigeonhole(SatSolver& solver,
+                                                int64_t pigeons,
+                                                int64_t holes) {
+  std::vector<std::vector<Literal>> in_hole(pigeons);
+  for (int64_t p = 0; p < pigeons; ++p) {
+    for (int64_t h = 0; h < holes; ++h) {
+      in_hole[p].push_back(PositiveLiteral(solver.NewVariable()));
+    }
+  }
+  std::vector<std::vector<Literal>> clauses;
+  for (int64_t p = 0; p < pigeons; ++p) {
+    clauses.push_back(in_hole[p]);
+  }
+  for (int64_t h = 0; h < holes; ++h) {
+    for (int64_t p = 0; p < pigeons; ++p) {
+      for (int64_t q = p + 1; q < pigeons; ++q) {
+        clauses.push_back({Negate(in_hole[p][h]), Negate(in_hole[q][h])});
+      }
+    }
+  }
+  for (const std::vector<Literal>& clause : clauses) {
+    solver.AddClause(clause);
+  }
+  return clauses;
+}
+
+TEST(SatSolverTest, EmptyProblemIsSatisfiable) {
+  SatSolver solver;
+  EXPECT_EQ(solver.Solve(), SatResult::kSatisfiable);
+}
+
+TEST(SatSolverTest, UnitClauses) {
+  SatSolver solver;
+  Literal a = PositiveLiteral(solver.NewVariable());
+  Literal b = PositiveLiteral(solver.NewVariable());
+  solver.AddClause({a});
+  solver.AddClause({Negate(a), Negate(b)});
+  ASSERT_EQ(solver.Solve(), SatResult::kSatisfiable);
+  EXPECT_TRUE(solver.ModelValue(a));
+  EXPECT_FALSE(solver.ModelValue(b));
+  EXPECT_TRUE(solver.ModelValue(Negate(b)));
+
+  solver.AddClause({b});
+  EXPECT_EQ(solver.Solve(), SatResult::kUnsatisfiable);
+}
+
+TEST(SatSolverTest, TautologiesAndDuplicates) {
+  SatSolver solver;
+  Literal a = PositiveLiteral(solver.NewVariable());
+  solver.AddClause({a, Negate(a)});
+  solver.AddClause({Negate(a), Negate(a)});
+  ASSERT_EQ(solver.Solve(), SatResult::kSatisfiable);
+  EXPECT_FALSE(solver.ModelValue(a));
+}
+
+TEST(SatSolverTest, EmptyClauseIsUnsatisfiable) {
+  SatSolver solver;
+  solver.NewVariable();
+  solver.AddClause({});
+  EXPECT_EQ(solver.Solve(), SatResult::kUnsatisfiable);
+}
+
+TEST(SatSolverTest, XorChain) {
+  // x0 ^ x1 ^ ... ^ x9 == 1 with x0..x8 forced to 0 requires x9 == 1.
+  SatSolver solver;
+  std::vector<std::vector<Literal>> clauses;
+  std::vector<Literal> x;
+  for (int64_t i = 0; i < 10; ++i) {
+    x.push_back(PositiveLiteral(solver.NewVariable()));
+  }
+  Literal parity = x[0];
+  for (int64_t i = 1; i < x.size(); ++i) {
+    Literal next = PositiveLiteral(solver.NewVariable());
+    clauses.push_back({Negate(next), parity, x[i]});
+    clauses.push_back({Negate(next), Negate(parity), Negate(x[i])});
+    clauses.push_back({next, Negate(parity), x[i]});
+    clauses.push_back({next, parity, Negate(x[i])});
+    parity = next;
+  }
+  clauses.push_back({parity});
+  for (int64_t i = 0; i + 1 < x.size(); ++i) {
+    clauses.push_back({Negate(x[i])});
+  }
+  for (const std::vector<Literal>& clause : clauses) {
+    solver.AddClause(clause);
+  }
+  ASSERT_EQ(solver.Solve(), SatResult::kSatisfiable);
+  EXPECT_TRUE(SatisfiesAll(solver, clauses));
+  EXPECT_TRUE(solver.ModelValue(x.back()));
+}
+
+TEST(SatSolverTest, PigeonholeFits) {
+  SatSolver solver;
+  std::vector<std::vector<Literal>> clauses = AddPigeonhole(solver, 6, 6);
+  ASSERT_EQ(solver.Solve(), SatResult::kSatisfiable);
+  EXPECT_TRUE(SatisfiesAll(solver, clauses));
+}
+
+TEST(SatSolverTest, PigeonholeDoesNotFit) {
+  SatSolver solver;
+  AddPigeonhole(solver, 7, 6);
+  EXPECT_EQ(solver.Solve(), SatResult::kUnsatisfiable);
+  EXPECT_GT(solver.conflict_count(), 0);
+}
+
+TEST(SatSolverTest, DeadlineGivesUp) {
+  SatSolver solver;
+  AddPigeonhole(solver, 13, 12);
+  EXPECT_EQ(solver.Solve(absl::InfinitePast()), SatResult::kUnknown);
+}
+
+}  // namespace
+}  // namespace xls::solvers::sat
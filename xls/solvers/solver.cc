@@ -33,6 +33,7 @@
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/solvers/sat_prover.h"
 #include "xls/solvers/z3_ir_translator.h"
 
 ABSL_FLAG(std::string, subject, "",
@@ -43,6 +44,9 @@ ABSL_FLAG(std::string, other, "",
           "Node for comparison; e.g. when kind is eq_node");
 ABSL_FLAG(int64_t, timeout_ms, 60000,
           "Timeout for proof attempt, in milliseconds");
+ABSL_FLAG(std::string, backend, "z3",
+          "Solver to attempt the proof with; choices: z3 (bit-vector SMT), "
+          "sat (bit-blasted SAT, usually faster for control-heavy logic)");
 
 static constexpr std::string_view kUsage = R"(
 Attempts to prove a property of a node in an XLS IR entry function within a
@@ -57,6 +61,10 @@ Prove that node and.1234 in the entry function is always equal to zero:
 Prove that node and.1234 is equivalent to and.2345:
 
   solver /tmp/my.ir -subject and.1234 -kind eq_node -other and.2345
+
+Prove the same with the bit-blasting SAT backend instead of Z3:
+
+  solver /tmp/my.ir -subject and.1234 -kind eq_zero -backend sat
 )";
 
 namespace xls {
@@ -69,7 +77,8 @@ using ::xls::solvers::z3::ProverResult;
 absl::Status RealMain(std::string_view ir_path,
                       std::string_view subject_node_name,
                       std::string_view predicate_kind,
-                      std::string_view other_node_name, int64_t timeout_ms) {
+                      std::string_view other_node_name, int64_t timeout_ms,
+                      std::string_view backend) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(contents, ir_path));
@@ -87,9 +96,17 @@ absl::Status RealMain(std::string_view ir_path,
         absl::StrFormat("Invalid predicate kind: \"%s\"", predicate_kind));
   }
 
-  XLS_ASSIGN_OR_RETURN(
-      ProverResult proved,
-      solvers::z3::TryProve(f, subject, predicate.value(), timeout));
+  ProverResult proved;
+  if (backend == "z3") {
+    XLS_ASSIGN_OR_RETURN(
+        proved, solvers::z3::TryProve(f, subject, predicate.value(), timeout));
+  } else if (backend == "sat") {
+    XLS_ASSIGN_OR_RETURN(proved, solvers::sat::TryProveWithSat(
+                                     f, subject, predicate.value(), timeout));
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid backend: \"%s\"", backend));
+  }
   std::cout << "Proved " << subject_node_name << " " << predicate->ToString()
             << " holds for all input?" << ": "
             << (std::holds_alternative<ProvenTrue>(proved) ? "true" : "false")
@@ -113,5 +130,6 @@ int main(int argc, char** argv) {
   return xls::ExitStatus(
       xls::RealMain(positional_arguments[0], absl::GetFlag(FLAGS_subject),
                     absl::GetFlag(FLAGS_kind), absl::GetFlag(FLAGS_other),
-                    absl::GetFlag(FLAGS_timeout_ms)));
+                    absl::GetFlag(FLAGS_timeout_ms),
+                    absl::GetFlag(FLAGS_backend)));
 }
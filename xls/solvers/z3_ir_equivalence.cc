@@ -17,11 +17,14 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <random>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -30,6 +33,9 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
@@ -38,13 +44,108 @@
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/cse_pass.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "external/z3/src/api/z3_api.h"
 
 namespace xls::solvers::z3 {
+namespace {
+
+// Removes the nodes which no longer contribute to the result of `f`.
+absl::Status RemoveDeadNodes(Function* f) {
+  for (Node* node : ReverseTopoSort(f)) {
+    if (node->users().empty() && !f->HasImplicitUse(node) &&
+        !OpIsSideEffecting(node->op())) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Interprets `f` on random inputs to group its bits-typed nodes by the values
+// they take, then tries to prove each node equal to the first node of its
+// group. Proofs share a single incremental solver, in which each proven
+// equality is kept to simplify the proofs of its users. Proven nodes are
+// replaced by their group's first node; returns the number replaced.
+absl::StatusOr<int64_t> SweepEquivalentNodes(
+    Function* f, const EquivalenceOptions& options) {
+  CollectingEvaluationObserver observer;
+  std::mt19937_64 rng;
+  for (int64_t i = 0; i < options.simulation_samples; ++i) {
+    absl::StatusOr<InterpreterResult<Value>> result =
+        InterpretFunction(f, RandomFunctionArguments(f, rng), &observer);
+    if (!result.ok()) {
+      // Simulation only finds candidates, so anything it can't evaluate is
+      // just left to the final proof.
+      VLOG(1) << "Not sweeping " << f->name() << ": " << result.status();
+      return 0;
+    }
+  }
+
+  absl::StatusOr<std::unique_ptr<IrTranslator>> translator =
+      IrTranslator::CreateAndTranslate(f);
+  if (!translator.ok()) {
+    VLOG(1) << "Not sweeping " << f->name() << ": " << translator.status();
+    return 0;
+  }
+  (*translator)->SetTimeout(options.sweep_timeout);
+  Z3_context ctx = (*translator)->ctx();
+  Z3_solver solver = CreateSolver(ctx, /*num_threads=*/1);
+  auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+
+  absl::flat_hash_map<std::pair<Type*, std::vector<Value>>, Node*>
+      representatives;
+  std::vector<std::pair<Node*, Node*>> replacements;
+  for (Node* node : TopoSort(f)) {
+    if (OpIsSideEffecting(node->op()) || node == f->return_value() ||
+        !node->GetType()->IsBits() || node->BitCountOrDie() == 0) {
+      continue;
+    }
+    auto values = observer.values().find(node);
+    if (values == observer.values().end()) {
+      continue;
+    }
+    auto [it, inserted] = representatives.try_emplace(
+        std::make_pair(node->GetType(), values->second), node);
+    if (inserted) {
+      continue;
+    }
+    Node* representative = it->second;
+    Z3_ast equal = Z3_mk_eq(ctx, (*translator)->GetTranslation(representative),
+                            (*translator)->GetTranslation(node));
+    Z3_solver_push(ctx, solver);
+    Z3_solver_assert(ctx, solver, Z3_mk_not(ctx, equal));
+    Z3_lbool result = Z3_solver_check(ctx, solver);
+    Z3_solver_pop(ctx, solver, 1);
+    if (result == Z3_L_FALSE) {
+      Z3_solver_assert(ctx, solver, equal);
+      replacements.push_back({node, representative});
+    }
+  }
+
+  // The representative precedes the node in topological order, so replacing
+  // the node can't introduce a cycle.
+  for (const auto& [node, representative] : replacements) {
+    VLOG(3) << "Replacing " << node->GetName() << " with proven equal "
+            << representative->GetName();
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(representative));
+  }
+  return replacements.size();
+}
+
+}  // namespace
 
 absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
                                                  absl::Duration timeout) {
+  return TryProveEquivalence(a, b, EquivalenceOptions(), timeout);
+}
+
+absl::StatusOr<ProverResult> TryProveEquivalence(
+    Function* a, Function* b, const EquivalenceOptions& options,
+    absl::Duration timeout) {
   std::unique_ptr<Package> to_test = std::make_unique<Package>(
       absl::StrFormat("%s_tester", a->package()->name()));
   XLS_ASSIGN_OR_RETURN(
@@ -88,10 +189,35 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
       SourceInfo(), original_result, transformed_result, Op::kEq, "TestCheck",
       to_test_func));
   XLS_RETURN_IF_ERROR(to_test_func->set_return_value(new_ret));
+
+  // Reduce the miter to the parts of the functions which may differ. Merging
+  // may replace the check itself with an identical node, so it's re-read from
+  // the return value.
+  auto check_is_trivial = [&]() {
+    Node* check = to_test_func->return_value();
+    return check->operand(0) == check->operand(1);
+  };
+  if (options.structural_hashing) {
+    XLS_RETURN_IF_ERROR(RunCse(to_test_func, nullptr).status());
+  }
+  if (options.simulation_samples > 0 && !check_is_trivial()) {
+    XLS_ASSIGN_OR_RETURN(int64_t swept,
+                         SweepEquivalentNodes(to_test_func, options));
+    VLOG(1) << "Merged " << swept << " proven equal nodes";
+    if (swept > 0 && options.structural_hashing) {
+      XLS_RETURN_IF_ERROR(RunCse(to_test_func, nullptr).status());
+    }
+  }
+  XLS_RETURN_IF_ERROR(RemoveDeadNodes(to_test_func));
+  if (check_is_trivial()) {
+    return ProvenTrue();
+  }
+  VLOG(1) << "Residual miter has " << to_test_func->node_count() << " nodes";
+
   // Run prover
-  XLS_ASSIGN_OR_RETURN(
-      ProverResult base_result,
-      TryProve(to_test_func, new_ret, Predicate::NotEqualToZero(), timeout));
+  XLS_ASSIGN_OR_RETURN(ProverResult base_result,
+                       TryProve(to_test_func, to_test_func->return_value(),
+                                Predicate::NotEqualToZero(), timeout));
   // remap parameters back tot he originals.
   return std::visit(
       Visitor{
@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 #define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/status.h"
@@ -26,6 +27,25 @@
 
 namespace xls::solvers::z3 {
 
+// Preprocessing applied by TryProveEquivalence() to the combined function (the
+// "miter") before it is handed to Z3. Both steps only merge nodes which are
+// known to be equal, so they never change the result, but for near-identical
+// functions (e.g. before and after optimization) they usually reduce the
+// problem to the parts which actually differ.
+struct EquivalenceOptions {
+  // Merges structurally identical nodes of the two functions.
+  bool structural_hashing = true;
+
+  // Number of random input vectors interpreted to find internal nodes which
+  // may be equal. Candidate pairs are then proven one at a time with a single
+  // incremental solver (SAT sweeping) and merged. Zero disables sweeping.
+  int64_t simulation_samples = 64;
+
+  // Limit on each internal equivalence proof; pairs which can't be proven
+  // within it are left unmerged.
+  absl::Duration sweep_timeout = absl::Milliseconds(500);
+};
+
 // Verify that the original function's behavior stays the same after running
 // 'run_pass' on it. The callback *must* use the provided package and function
 // and not the one passed to this call. The pass may not alter the type
@@ -49,6 +69,9 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
 absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* a, Function* b,
     absl::Duration timeout = absl::InfiniteDuration());
+absl::StatusOr<ProverResult> TryProveEquivalence(
+    Function* a, Function* b, const EquivalenceOptions& options,
+    absl::Duration timeout = absl::InfiniteDuration());
 
 }  // namespace xls::solvers::z3
 
@@ -389,5 +389,59 @@ TEST_F(EquivalenceTest, MultiFunctionDetectsDifference) {
   EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
 }
 
+TEST_F(EquivalenceTest, NearIdenticalFunctionsAreMerged) {
+  // Both functions compute the same 64-bit product, but the second one commutes
+  // one multiply and doubles x differently. Structural hashing merges the
+  // commuted multiply and sweeping proves the doublings equal, so the final
+  // check never has to reason about the multiplies.
+  std::unique_ptr<Package> p = CreatePackage();
+  Function* f1;
+  Function* f2;
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "_1"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(64));
+    BValue y = fb.Param("y", p->GetBitsType(64));
+    BValue shifted = fb.Shll(x, fb.Literal(UBits(1, 64)));
+    fb.UMul(fb.UMul(x, y), shifted);
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.Build());
+  }
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "_2"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(64));
+    BValue y = fb.Param("y", p->GetBitsType(64));
+    BValue doubled = fb.Add(x, x);
+    fb.UMul(fb.UMul(y, x), doubled);
+    XLS_ASSERT_OK_AND_ASSIGN(f2, fb.Build());
+  }
+  EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenTrue()));
+}
+
+TEST_F(EquivalenceTest, SweepingDoesNotMergeRarelyDifferentNodes) {
+  // The functions only differ when x is a single value, which simulation is
+  // vanishingly unlikely to hit, so sweeping must not trust it.
+  std::unique_ptr<Package> p = CreatePackage();
+  Function* f1;
+  Function* f2;
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "_1"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    fb.Add(x, fb.Literal(UBits(1, 32)));
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.Build());
+  }
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "_2"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue magic = fb.Eq(x, fb.Literal(UBits(0x12345678, 32)));
+    fb.Select(magic, /*on_true=*/fb.Literal(UBits(0, 32)),
+              /*on_false=*/fb.Add(x, fb.Literal(UBits(1, 32))));
+    XLS_ASSERT_OK_AND_ASSIGN(f2, fb.Build());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(ProverResult r, TryProveEquivalence(f1, f2));
+  ASSERT_THAT(r, IsProvenFalse());
+  EXPECT_THAT(std::get<ProvenFalse>(r).counterexample,
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(m::Param("x"), Value(UBits(0x12345678, 32))))));
+}
+
 }  // namespace
 }  // namespace xls::solvers::z3
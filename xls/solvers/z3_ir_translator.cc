@@ -1664,10 +1664,12 @@ namespace {
 
 enum class PredicateCombination : std::uint8_t { kDisjunction, kConjunction };
 
-absl::StatusOr<ProverResult> TryProveCombination(
-    FunctionBase* f, std::unique_ptr<IrTranslator> translator,
-    absl::Span<const PredicateOfNode> terms,
+// Combines the negated objectives of the given terms; the combination is
+// satisfiable iff the combination of the terms can be violated.
+absl::StatusOr<Z3_ast> CombinedNegatedObjective(
+    IrTranslator* translator, absl::Span<const PredicateOfNode> terms,
     PredicateCombination predicate_combination) {
+  XLS_RET_CHECK(!terms.empty());
   Z3OpTranslator t(translator->ctx());
   std::optional<Z3_ast> objective;
 
@@ -1678,7 +1680,7 @@ absl::StatusOr<ProverResult> TryProveCombination(
     // Translate the predicate to a term we can throw into the conjunction.
     XLS_ASSIGN_OR_RETURN(Z3_ast objective_term,
                          PredicateToNegatedObjective(term.p, term.subject,
-                                                     value, translator.get()));
+                                                     value, translator));
     XLS_RET_CHECK(objective_term != nullptr);
 
     if (objective.has_value()) {
@@ -1699,13 +1701,21 @@ absl::StatusOr<ProverResult> TryProveCombination(
 
   CHECK(objective.has_value());
   CHECK(objective.value() != nullptr);
+  return objective.value();
+}
 
+// Checks the given negated objective in a new scope of `solver`, returning
+// ProvenTrue if it can't be satisfied.
+absl::StatusOr<ProverResult> CheckNegatedObjective(FunctionBase* f,
+                                                   IrTranslator* translator,
+                                                   Z3_solver solver,
+                                                   Z3_ast objective) {
   Z3_context ctx = translator->ctx();
-  VLOG(1) << "objective:\n" << Z3_ast_to_string(ctx, objective.value());
-  Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
-  auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+  VLOG(1) << "objective:\n" << Z3_ast_to_string(ctx, objective);
+  Z3_solver_push(ctx, solver);
+  auto pop = absl::Cleanup([&] { Z3_solver_pop(ctx, solver, 1); });
 
-  Z3_solver_assert(ctx, solver, objective.value());
+  Z3_solver_assert(ctx, solver, objective);
   Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
 
   VLOG(1) << solvers::z3::SolverResultToString(ctx, solver, satisfiable);
@@ -1742,6 +1752,19 @@ absl::StatusOr<ProverResult> TryProveCombination(
   return absl::InternalError(absl::StrCat("Invalid Z3 result: ", satisfiable));
 }
 
+absl::StatusOr<ProverResult> TryProveCombination(
+    FunctionBase* f, std::unique_ptr<IrTranslator> translator,
+    absl::Span<const PredicateOfNode> terms,
+    PredicateCombination predicate_combination) {
+  XLS_ASSIGN_OR_RETURN(Z3_ast objective,
+                       CombinedNegatedObjective(translator.get(), terms,
+                                                predicate_combination));
+  Z3_context ctx = translator->ctx();
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
+  auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+  return CheckNegatedObjective(f, translator.get(), solver, objective);
+}
+
 }  // namespace
 
 absl::StatusOr<ProverResult> TryProveConjunction(
@@ -1804,6 +1827,58 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                              allow_unsupported);
 }
 
+absl::StatusOr<std::unique_ptr<ProverSession>> ProverSession::Create(
+    FunctionBase* f, bool allow_unsupported) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f, allow_unsupported));
+  return absl::WrapUnique(new ProverSession(f, std::move(translator)));
+}
+
+ProverSession::ProverSession(FunctionBase* f,
+                             std::unique_ptr<IrTranslator> translator)
+    : f_(f),
+      translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), /*num_threads=*/1)) {}
+
+ProverSession::~ProverSession() {
+  Z3_solver_dec_ref(translator_->ctx(), solver_);
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProve(Node* subject,
+                                                     Predicate p) {
+  PredicateOfNode term = {.subject = subject, .p = std::move(p)};
+  return TryProveConjunction(absl::MakeConstSpan(&term, 1));
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProveConjunction(
+    absl::Span<const PredicateOfNode> terms) {
+  XLS_ASSIGN_OR_RETURN(
+      Z3_ast objective,
+      CombinedNegatedObjective(translator_.get(), terms,
+                               PredicateCombination::kConjunction));
+  return CheckNegatedObjective(f_, translator_.get(), solver_, objective);
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProveDisjunction(
+    absl::Span<const PredicateOfNode> terms) {
+  XLS_ASSIGN_OR_RETURN(
+      Z3_ast objective,
+      CombinedNegatedObjective(translator_.get(), terms,
+                               PredicateCombination::kDisjunction));
+  return CheckNegatedObjective(f_, translator_.get(), solver_, objective);
+}
+
+absl::Status ProverSession::Assume(Node* subject, Predicate p) {
+  PredicateOfNode term = {.subject = subject, .p = std::move(p)};
+  XLS_ASSIGN_OR_RETURN(
+      Z3_ast objective,
+      CombinedNegatedObjective(translator_.get(), absl::MakeConstSpan(&term, 1),
+                               PredicateCombination::kConjunction));
+  Z3_context ctx = translator_->ctx();
+  Z3_solver_assert(ctx, solver_, Z3_mk_not(ctx, objective));
+  return absl::OkStatus();
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
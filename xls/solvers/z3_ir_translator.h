@@ -444,6 +444,44 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                                       Predicate p, int64_t rlimit,
                                       bool allow_unsupported = false);
 
+// A long-lived translation of a function for checking many predicates about
+// it. Unlike the TryProve* functions above, which translate the function into
+// a fresh context for every query, the function is translated once and each
+// query is checked in its own scope of a single incremental solver, so queries
+// share the translated ASTs and whatever the solver learned from earlier ones.
+//
+// Nodes must not be removed from the function while the session is alive, and
+// nodes added after its creation can't be the subject of a query.
+class ProverSession {
+ public:
+  static absl::StatusOr<std::unique_ptr<ProverSession>> Create(
+      FunctionBase* f, bool allow_unsupported = false);
+  ~ProverSession();
+
+  // Limits apply to each subsequent query individually.
+  void SetTimeout(absl::Duration timeout) { translator_->SetTimeout(timeout); }
+  void SetRlimit(int64_t rlimit) { translator_->SetRlimit(rlimit); }
+
+  absl::StatusOr<ProverResult> TryProve(Node* subject, Predicate p);
+  absl::StatusOr<ProverResult> TryProveConjunction(
+      absl::Span<const PredicateOfNode> terms);
+  absl::StatusOr<ProverResult> TryProveDisjunction(
+      absl::Span<const PredicateOfNode> terms);
+
+  // Assumes that `p` holds for `subject` in all subsequent queries, e.g. to
+  // check properties under a known precondition.
+  absl::Status Assume(Node* subject, Predicate p);
+
+  IrTranslator* translator() { return translator_.get(); }
+
+ private:
+  ProverSession(FunctionBase* f, std::unique_ptr<IrTranslator> translator);
+
+  FunctionBase* f_;
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+};
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -49,6 +49,7 @@ using solvers::z3::IrTranslator;
 using solvers::z3::Predicate;
 using solvers::z3::PredicateOfNode;
 using solvers::z3::ProverResult;
+using solvers::z3::ProverSession;
 using solvers::z3::TryProve;
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
@@ -2410,5 +2411,42 @@ TEST_F(Z3IrTranslatorTest, HandlesSMulp) {
   EXPECT_THAT(proven, IsProvenTrue());
 }
 
+TEST_F(Z3IrTranslatorTest, ProverSessionChecksManyPredicates) {
+  std::unique_ptr<Package> package = CreatePackage();
+  FunctionBuilder fb(TestName(), package.get());
+  Type* u8 = package->GetBitsType(8);
+  BValue x = fb.Param("x", u8);
+  BValue y = fb.Param("y", u8);
+  BValue x_or_y = fb.Or(x, y);
+  BValue x_and_y = fb.And(x, y);
+  BValue x_ge_y = fb.UGe(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProverSession> session,
+                           ProverSession::Create(f));
+
+  EXPECT_THAT(session->TryProve(x_or_y.node(),
+                                Predicate::UnsignedGreaterOrEqual(UBits(0, 8))),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(session->TryProve(x_and_y.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(IsProvenFalse()));
+  // A failed query leaves no trace on later ones.
+  EXPECT_THAT(session->TryProve(x_or_y.node(), Predicate::IsEqualTo(x.node())),
+              IsOkAndHolds(IsProvenFalse()));
+  std::vector<PredicateOfNode> terms = {
+      {.subject = x_ge_y.node(), .p = Predicate::NotEqualToZero()},
+      {.subject = x_ge_y.node(), .p = Predicate::EqualToZero()}};
+  EXPECT_THAT(session->TryProveDisjunction(terms),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(session->TryProveConjunction(terms),
+              IsOkAndHolds(IsProvenFalse()));
+
+  // Assumptions apply to all later queries.
+  XLS_ASSERT_OK(session->Assume(y.node(), Predicate::EqualToZero()));
+  EXPECT_THAT(session->TryProve(x_or_y.node(), Predicate::IsEqualTo(x.node())),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(session->TryProve(x_ge_y.node(), Predicate::NotEqualToZero()),
+              IsOkAndHolds(IsProvenTrue()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #include "xls/solvers/z3_lec.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <iostream>
@@ -32,10 +33,15 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -124,7 +130,9 @@ absl::Status Lec::Init() {
   Z3_ast x = Z3_mk_const(ctx(), Z3_mk_string_symbol(ctx(), "X"),
                          Z3_mk_bv_sort(ctx(), 1));
   std::vector<Z3_ast> eq_nodes;
-  for (const Node* node : ir_output_nodes_) {
+  for (int64_t node_index = 0; node_index < ir_output_nodes_.size();
+       ++node_index) {
+    const Node* node = ir_output_nodes_[node_index];
     // Extract the individual bits out of each IR output node, and match those
     // up the corresponding netlist bits. The netlist outputs do not contain
     // references to bits that are actually unused, instead having nullptr in
@@ -147,6 +155,8 @@ absl::Status Lec::Init() {
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
         eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        output_bit_eqs_.push_back(OutputBitEq{
+            .node_index = node_index, .bit_index = i, .eq = eq_nodes.back()});
       }
     }
   }
@@ -274,11 +284,13 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   Z3_ast eq_node = Z3_mk_eq(ctx(), constraint_translator->GetReturnNode(),
                             Z3_mk_int(ctx(), 1, Z3_mk_bv_sort(ctx(), 1)));
   Z3_solver_assert(ctx(), solver_.value(), eq_node);
+  constraints_.push_back(eq_node);
   return absl::OkStatus();
 }
 
 bool Lec::Run() {
   LOG(INFO) << "Beginning execution";
+  job_results_.clear();
   satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
@@ -287,11 +299,154 @@ bool Lec::Run() {
   return !satisfiable_;
 }
 
+bool Lec::RunPartitioned(const LecPartitionOptions& options) {
+  LOG(INFO) << "Beginning partitioned execution";
+  if (model_) {
+    Z3_model_dec_ref(ctx(), model_.value());
+    model_.reset();
+  }
+  satisfiable_ = false;
+
+  // Group the compared output bits into jobs; the bits of each node are
+  // contiguous in output_bit_eqs_.
+  std::vector<std::vector<Z3_ast>> job_eqs;
+  job_results_.clear();
+  for (int64_t i = 0; i < output_bit_eqs_.size(); ++i) {
+    const OutputBitEq& bit = output_bit_eqs_[i];
+    const Node* node = ir_output_nodes_[bit.node_index];
+    if (options.partitioning == LecPartitioning::kOutputBit || i == 0 ||
+        output_bit_eqs_[i - 1].node_index != bit.node_index) {
+      job_eqs.emplace_back();
+      job_results_.push_back(LecJobResult{
+          .description =
+              options.partitioning == LecPartitioning::kOutputBit
+                  ? absl::StrFormat("%s[%d]", node->GetName(), bit.bit_index)
+                  : node->GetName()});
+    }
+    job_eqs.back().push_back(bit.eq);
+    ++job_results_.back().bit_count;
+  }
+
+  // Each job proves that its bits can't differ under the constraints, so the
+  // miters are built in the main context before any worker starts.
+  std::vector<Z3_ast> miters;
+  miters.reserve(job_eqs.size());
+  for (const std::vector<Z3_ast>& eqs : job_eqs) {
+    miters.push_back(
+        Z3_mk_not(ctx(), Z3_mk_and(ctx(), eqs.size(), eqs.data())));
+  }
+
+  // Z3 contexts aren't thread-safe, so `mutex` guards all uses of the main
+  // context (translating into or out of it) as well as the cancellation state.
+  absl::Mutex mutex;
+  std::vector<Z3_context> active_contexts;
+  bool counterexample_found = false;
+  std::atomic<int64_t> next_job = 0;
+  auto worker = [&]() {
+    Z3_config config = Z3_mk_config();
+    Z3_context worker_ctx = Z3_mk_context(config);
+    {
+      absl::MutexLock lock(&mutex);
+      active_contexts.push_back(worker_ctx);
+    }
+    while (true) {
+      int64_t job = next_job.fetch_add(1);
+      if (job >= miters.size()) {
+        break;
+      }
+      Z3_solver solver = CreateSolver(worker_ctx, /*num_threads=*/1);
+      {
+        absl::MutexLock lock(&mutex);
+        if (counterexample_found) {
+          Z3_solver_dec_ref(worker_ctx, solver);
+          break;
+        }
+        Z3_solver_assert(worker_ctx, solver,
+                         Z3_translate(ctx(), miters[job], worker_ctx));
+        for (Z3_ast constraint : constraints_) {
+          Z3_solver_assert(worker_ctx, solver,
+                           Z3_translate(ctx(), constraint, worker_ctx));
+        }
+      }
+
+      // Each job's result is only written by the thread which claimed it.
+      absl::Time start = absl::Now();
+      Z3_lbool result = Z3_solver_check(worker_ctx, solver);
+      job_results_[job].solve_time = absl::Now() - start;
+      job_results_[job].result = result;
+      VLOG(1) << "LEC job " << job_results_[job].description << ": "
+              << (result == Z3_L_FALSE  ? "equivalent"
+                  : result == Z3_L_TRUE ? "counterexample"
+                                        : "undetermined")
+              << " in " << job_results_[job].solve_time;
+
+      if (result == Z3_L_TRUE) {
+        absl::MutexLock lock(&mutex);
+        if (!counterexample_found) {
+          counterexample_found = true;
+          Z3_model model = Z3_solver_get_model(worker_ctx, solver);
+          Z3_model_inc_ref(worker_ctx, model);
+          model_ = Z3_model_translate(worker_ctx, model, ctx());
+          Z3_model_inc_ref(ctx(), model_.value());
+          Z3_model_dec_ref(worker_ctx, model);
+          for (Z3_context other : active_contexts) {
+            if (other != worker_ctx) {
+              Z3_interrupt(other);
+            }
+          }
+        }
+      }
+      Z3_solver_dec_ref(worker_ctx, solver);
+    }
+    {
+      absl::MutexLock lock(&mutex);
+      active_contexts.erase(std::find(active_contexts.begin(),
+                                      active_contexts.end(), worker_ctx));
+    }
+    Z3_del_context(worker_ctx);
+    Z3_del_config(config);
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < options.thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  satisfiable_ = counterexample_found;
+  return std::all_of(
+      job_results_.begin(), job_results_.end(),
+      [](const LecJobResult& job) { return job.result == Z3_L_FALSE; });
+}
+
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
-  output.push_back(SolverResultToString(ctx(), solver_.value(),
-                                        satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
-                                        /*hexify=*/true));
+  if (job_results_.empty()) {
+    output.push_back(SolverResultToString(ctx(), solver_.value(),
+                                          satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
+                                          /*hexify=*/true));
+  } else {
+    // The model of a partitioned run comes from a job's solver rather than
+    // solver_, so it's formatted here.
+    std::string result = absl::StrFormat("Solver result; satisfiable: %s\n",
+                                         satisfiable_ ? "true" : "false");
+    if (satisfiable_) {
+      absl::StrAppend(&result, "\n  Model:\n```",
+                      Z3_model_to_string(ctx(), model_.value()), "```");
+    }
+    output.push_back(HexifyOutput(result));
+    for (const LecJobResult& job : job_results_) {
+      output.push_back(absl::StrFormat(
+          "  Job %s (%d bits): %s in %s", job.description, job.bit_count,
+          job.result == Z3_L_FALSE  ? "equivalent"
+          : job.result == Z3_L_TRUE ? "counterexample"
+                                    : "cancelled",
+          absl::FormatDuration(job.solve_time)));
+    }
+  }
   if (satisfiable_) {
     for (const Node* node : ir_output_nodes_) {
       std::pair<std::string, std::string> outputs = GetComparisonStrings(node);
@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,6 +25,8 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
@@ -54,6 +57,34 @@ struct LecParams {
   std::string netlist_module_name;
 };
 
+// How Lec::RunPartitioned() splits the miter into independent solver jobs.
+enum class LecPartitioning {
+  // One job per compared output bit.
+  kOutputBit,
+  // One job per output node, covering all of its compared bits.
+  kOutputNode,
+};
+
+struct LecPartitionOptions {
+  LecPartitioning partitioning = LecPartitioning::kOutputNode;
+
+  // The number of threads (each with its own Z3 context) solving jobs.
+  int64_t thread_count = 1;
+};
+
+// The outcome of a single job of a partitioned LEC run.
+struct LecJobResult {
+  // The output node (and, for per-bit jobs, the bit) covered by the job.
+  std::string description;
+  int64_t bit_count = 0;
+
+  // Z3_L_FALSE if the covered bits are equivalent, Z3_L_TRUE if a
+  // counterexample was found, and Z3_L_UNDEF if the job was cancelled because
+  // another job found a counterexample first.
+  Z3_lbool result = Z3_L_UNDEF;
+  absl::Duration solve_time;
+};
+
 // Class for performing logical equivalence checks between a function specified
 // in XLS IR (perhaps converted from DSLX) and a netlist.
 class Lec {
@@ -82,6 +113,16 @@ class Lec {
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // As Run(), but splits the miter into one job per output node or output bit
+  // and solves the jobs on a pool of threads, each with its own Z3 context.
+  // Jobs can be much cheaper to prove than the monolithic query, as each only
+  // involves its own input cone. The first counterexample found interrupts the
+  // remaining jobs and becomes the model reported by ResultToString().
+  bool RunPartitioned(const LecPartitionOptions& options);
+
+  // The per-job results of the last RunPartitioned() call, in output order.
+  absl::Span<const LecJobResult> job_results() const { return job_results_; }
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -157,6 +198,20 @@ class Lec {
   std::vector<Z3_ast> ir_outputs_;
   std::vector<Z3_ast> netlist_outputs_;
 
+  // The equality of each compared output bit, along with the index of its node
+  // in ir_output_nodes_ and its bit index, for partitioned runs.
+  struct OutputBitEq {
+    int64_t node_index;
+    int64_t bit_index;
+    Z3_ast eq;
+  };
+  std::vector<OutputBitEq> output_bit_eqs_;
+
+  // Constraints asserted by AddConstraints(), re-asserted in each job of a
+  // partitioned run.
+  std::vector<Z3_ast> constraints_;
+  std::vector<LecJobResult> job_results_;
+
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
@@ -14,12 +14,17 @@
 
 #include "xls/solvers/z3_lec.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_replace.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function.h"
@@ -39,6 +44,9 @@ namespace z3 {
 namespace {
 
 using netlist::rtl::Netlist;
+using ::testing::Contains;
+using ::testing::Field;
+using ::testing::HasSubstr;
 
 absl::StatusOr<bool> Match(const std::string& ir_text,
                            const std::string& netlist_text, bool expect_equal) {
@@ -511,6 +519,122 @@ endmodule
   }
 }
 
+// Owns everything a Lec borrows for the partitioned-run tests.
+struct LecFixture {
+  std::unique_ptr<Package> package;
+  netlist::CellLibrary cell_library;
+  std::unique_ptr<Netlist> netlist;
+  std::unique_ptr<Lec> lec;
+};
+
+absl::StatusOr<std::unique_ptr<LecFixture>> CreateLec(
+    const std::string& ir_text, const std::string& netlist_text) {
+  auto fixture = std::make_unique<LecFixture>();
+  XLS_ASSIGN_OR_RETURN(fixture->package, Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(fixture->cell_library, netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(fixture->netlist,
+                       netlist::rtl::Parser::ParseNetlist(
+                           &fixture->cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = fixture->package.get();
+  XLS_ASSIGN_OR_RETURN(params.ir_function,
+                       fixture->package->GetTopAsFunction());
+  params.netlist = fixture->netlist.get();
+  params.netlist_module_name = "main";
+  XLS_ASSIGN_OR_RETURN(fixture->lec, Lec::Create(params));
+  return fixture;
+}
+
+constexpr std::string_view kNotIr = R"(
+package p
+
+top fn main(input: bits[4]) -> bits[4] {
+  ret not.2: bits[4] = not(input)
+}
+)";
+
+// A netlist for kNotIr whose bit 1 is computed by `bit_1_cell`.
+std::string NotNetlist(std::string_view bit_1_cell) {
+  return absl::StrReplaceAll(R"(
+module main ( clk, input_3_, input_2_, input_1_, input_0_, out_3_, out_2_, out_1_, out_0_);
+  input clk, input_3_, input_2_, input_1_, input_0_;
+  output out_3_, out_2_, out_1_, out_0_;
+  wire p0_input_3_, p0_input_2_, p0_input_1_, p0_input_0_,
+       p0_not_2_comb_3_, p0_not_2_comb_2_, p0_not_2_comb_1_, p0_not_2_comb_0_;
+
+  DFF p0_input_reg_3_ ( .D(input_3_), .CLK(clk), .Q(p0_input_3_) );
+  DFF p0_input_reg_2_ ( .D(input_2_), .CLK(clk), .Q(p0_input_2_) );
+  DFF p0_input_reg_1_ ( .D(input_1_), .CLK(clk), .Q(p0_input_1_) );
+  DFF p0_input_reg_0_ ( .D(input_0_), .CLK(clk), .Q(p0_input_0_) );
+
+  INV p0_not_2_3_ ( .A(p0_input_3_), .ZN(p0_not_2_comb_3_) );
+  INV p0_not_2_2_ ( .A(p0_input_2_), .ZN(p0_not_2_comb_2_) );
+  BIT_1_CELL
+  INV p0_not_2_0_ ( .A(p0_input_0_), .ZN(p0_not_2_comb_0_) );
+
+  DFF p0_not_2_reg_3_ (.D(p0_not_2_comb_3_), .CLK(clk), .Q(out_3_));
+  DFF p0_not_2_reg_2_ (.D(p0_not_2_comb_2_), .CLK(clk), .Q(out_2_));
+  DFF p0_not_2_reg_1_ (.D(p0_not_2_comb_1_), .CLK(clk), .Q(out_1_));
+  DFF p0_not_2_reg_0_ (.D(p0_not_2_comb_0_), .CLK(clk), .Q(out_0_));
+endmodule
+)",
+                             {{"BIT_1_CELL", bit_1_cell}});
+}
+
+TEST(Z3LecTest, PartitionedLecProvesEquivalence) {
+  std::string netlist_text =
+      NotNetlist(
+      "INV p0_not_2_1_ ( .A(p0_input_1_), .ZN(p0_not_2_comb_1_) );");
+  for (LecPartitioning partitioning :
+       {LecPartitioning::kOutputBit, LecPartitioning::kOutputNode}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<LecFixture> fixture,
+                             CreateLec(std::string(kNotIr), netlist_text));
+    EXPECT_TRUE(fixture->lec->RunPartitioned(
+        LecPartitionOptions{.partitioning = partitioning, .thread_count = 3}));
+    int64_t expected_jobs =
+        partitioning == LecPartitioning::kOutputBit ? 4 : 1;
+    ASSERT_EQ(fixture->lec->job_results().size(), expected_jobs);
+    for (const LecJobResult& job : fixture->lec->job_results()) {
+      EXPECT_EQ(job.result, Z3_L_FALSE) << job.description;
+      EXPECT_EQ(job.bit_count, 4 / expected_jobs);
+    }
+    EXPECT_THAT(fixture->lec->ResultToString(),
+                HasSubstr("satisfiable: false"));
+  }
+}
+
+TEST(Z3LecTest, PartitionedLecFindsCounterexample) {
+  std::string netlist_text =
+      NotNetlist(
+      "OR p0_not_2_1_ ( .A(p0_input_1_), .B(p0_input_1_), "
+      ".Z(p0_not_2_comb_1_) );");
+  for (int64_t thread_count : {1, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<LecFixture> fixture,
+                             CreateLec(std::string(kNotIr), netlist_text));
+    EXPECT_FALSE(fixture->lec->RunPartitioned(
+        LecPartitionOptions{.partitioning = LecPartitioning::kOutputBit,
+                            .thread_count = thread_count}));
+    EXPECT_THAT(fixture->lec->job_results(),
+                Contains(Field(&LecJobResult::result, Z3_L_TRUE)));
+    if (thread_count == 1) {
+      // Jobs run from the LSB up, so the bit 1 job finds the counterexample
+      // and the jobs for the higher bits are never started.
+      ASSERT_EQ(fixture->lec->job_results().size(), 4);
+      EXPECT_EQ(fixture->lec->job_results()[0].result, Z3_L_FALSE);
+      EXPECT_EQ(fixture->lec->job_results()[1].description, "not.2[1]");
+      EXPECT_EQ(fixture->lec->job_results()[1].result, Z3_L_TRUE);
+      EXPECT_EQ(fixture->lec->job_results()[2].result, Z3_L_UNDEF);
+      EXPECT_EQ(fixture->lec->job_results()[3].result, Z3_L_UNDEF);
+    }
+    std::string result = fixture->lec->ResultToString();
+    EXPECT_THAT(result, HasSubstr("satisfiable: true"));
+    EXPECT_THAT(result, HasSubstr("counterexample"));
+    EXPECT_THAT(result, HasSubstr("Output IR node"));
+  }
+}
+
 }  // namespace
 }  // namespace z3
 }  // namespace solvers
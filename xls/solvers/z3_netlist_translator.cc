@@ -14,6 +14,7 @@
 
 #include "xls/solvers/z3_netlist_translator.h"
 
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <memory>
@@ -34,7 +35,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/netlist/cell_library.h"
-#include "xls/netlist/function_parser.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.h"
 #include "xls/solvers/z3_utils.h"
 #include "external/z3/src/api/z3_api.h"
@@ -46,11 +47,26 @@ namespace z3 {
 using netlist::CellLibraryEntry;
 using netlist::StateTable;
 using netlist::StateTableSignal;
-using netlist::function::Ast;
 using netlist::rtl::Cell;
 using netlist::rtl::Module;
 using netlist::rtl::NetRef;
 
+namespace {
+
+// Evaluates compiled cell functions on single-bit Z3 bit-vectors.
+struct Z3FunctionOps {
+  Z3_context ctx;
+
+  Z3_ast Zero() const { return Z3_mk_int(ctx, 0, Z3_mk_bv_sort(ctx, 1)); }
+  Z3_ast One() const { return Z3_mk_int(ctx, 1, Z3_mk_bv_sort(ctx, 1)); }
+  Z3_ast Not(Z3_ast x) const { return Z3_mk_bvnot(ctx, x); }
+  Z3_ast And(Z3_ast x, Z3_ast y) const { return Z3_mk_bvand(ctx, x, y); }
+  Z3_ast Or(Z3_ast x, Z3_ast y) const { return Z3_mk_bvor(ctx, x, y); }
+  Z3_ast Xor(Z3_ast x, Z3_ast y) const { return Z3_mk_bvxor(ctx, x, y); }
+};
+
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<NetlistTranslator>>
 NetlistTranslator::CreateAndTranslate(
     Z3_context ctx, const Module* module,
@@ -195,8 +211,6 @@ absl::Status NetlistTranslator::Translate() {
 }
 
 absl::Status NetlistTranslator::TranslateCell(const Cell& cell) {
-  using netlist::function::Ast;
-
   // If this cell is actually a reference to a module defined in this netlist,
   // then translate it into Z3-space here and grab its output nodes.
   std::string entry_name = cell.cell_library_entry()->name();
@@ -237,13 +251,11 @@ absl::Status NetlistTranslator::TranslateCell(const Cell& cell) {
     XLS_ASSIGN_OR_RETURN(state_table_values, TranslateStateTable(cell));
   }
 
-  const CellLibraryEntry::OutputPinToFunction& pins =
-      entry->output_pin_to_function();
   for (const auto& output : cell.outputs()) {
-    XLS_ASSIGN_OR_RETURN(Ast ast, netlist::function::Parser::ParseFunction(
-                                      pins.at(output.name)));
-    XLS_ASSIGN_OR_RETURN(Z3_ast result,
-                         TranslateFunction(cell, ast, state_table_values));
+    XLS_ASSIGN_OR_RETURN(const netlist::function::CompiledFunction* function,
+                         entry->GetCompiledFunction(output.name));
+    XLS_ASSIGN_OR_RETURN(
+        Z3_ast result, TranslateFunction(cell, *function, state_table_values));
     translated_[output.netref] = result;
   }
 
@@ -252,67 +264,27 @@ absl::Status NetlistTranslator::TranslateCell(const Cell& cell) {
 
 // After all the above, this is the spot where any _ACTUAL_ translation happens.
 absl::StatusOr<Z3_ast> NetlistTranslator::TranslateFunction(
-    const Cell& cell, netlist::function::Ast ast,
+    const Cell& cell, const netlist::function::CompiledFunction& function,
     const absl::flat_hash_map<std::string, Z3_ast>& state_table_values) {
-  switch (ast.kind()) {
-    case Ast::Kind::kAnd: {
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast lhs,
-          TranslateFunction(cell, ast.children()[0], state_table_values));
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast rhs,
-          TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvand(ctx_, lhs, rhs);
-    }
-    case Ast::Kind::kIdentifier: {
-      for (const auto& input : cell.inputs()) {
-        if (input.name == ast.name()) {
-          return translated_.at(input.netref);
-        }
-      }
-
-      if (state_table_values.contains(ast.name())) {
-        return state_table_values.at(ast.name());
-      }
-
+  // The leading operands are the cell's inputs; any others must be state table
+  // signals.
+  std::vector<Z3_ast> operands;
+  operands.reserve(function.operand_names().size());
+  for (const auto& input : cell.inputs()) {
+    operands.push_back(translated_.at(input.netref));
+  }
+  for (int64_t i = function.input_count(); i < function.operand_names().size();
+       ++i) {
+    const std::string& name = function.operand_names()[i];
+    auto it = state_table_values.find(name);
+    if (it == state_table_values.end()) {
       return absl::NotFoundError(absl::StrFormat(
-          "Identifier \"%s\", was not found in cell %s's inputs.", ast.name(),
+          "Identifier \"%s\", was not found in cell %s's inputs.", name,
           cell.name()));
     }
-    case Ast::Kind::kLiteralOne: {
-      return Z3_mk_int(ctx_, 1, Z3_mk_bv_sort(ctx_, 1));
-    }
-    case Ast::Kind::kLiteralZero: {
-      return Z3_mk_int(ctx_, 0, Z3_mk_bv_sort(ctx_, 1));
-    }
-    case Ast::Kind::kNot: {
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast child,
-          TranslateFunction(cell, ast.children()[0], state_table_values));
-      return Z3_mk_bvnot(ctx_, child);
-    }
-    case Ast::Kind::kOr: {
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast lhs,
-          TranslateFunction(cell, ast.children()[0], state_table_values));
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast rhs,
-          TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvor(ctx_, lhs, rhs);
-    }
-    case Ast::Kind::kXor: {
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast lhs,
-          TranslateFunction(cell, ast.children()[0], state_table_values));
-      XLS_ASSIGN_OR_RETURN(
-          Z3_ast rhs,
-          TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvxor(ctx_, lhs, rhs);
-    }
-    default:
-      return absl::InvalidArgumentError(absl::StrFormat(
-          "Unknown AST kind: %d", static_cast<int>(ast.kind())));
+    operands.push_back(it->second);
   }
+  return function.Evaluate<Z3_ast>(operands, Z3FunctionOps{ctx_});
 }
 
 absl::StatusOr<absl::flat_hash_map<std::string, Z3_ast>>
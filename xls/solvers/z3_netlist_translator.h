@@ -23,7 +23,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "xls/netlist/function_parser.h"
+#include "xls/netlist/compiled_function.h"
 #include "xls/netlist/netlist.h"
 #include "external/z3/src/api/z3.h"  // IWYU pragma: keep
 #include "external/z3/src/api/z3_api.h"
@@ -91,7 +91,8 @@ class NetlistTranslator {
   absl::Status Translate();
   absl::Status TranslateCell(const netlist::rtl::Cell& cell);
   absl::StatusOr<Z3_ast> TranslateFunction(
-      const netlist::rtl::Cell& cell, netlist::function::Ast ast,
+      const netlist::rtl::Cell& cell,
+      const netlist::function::CompiledFunction& function,
       const absl::flat_hash_map<std::string, Z3_ast>& state_table_values);
   absl::StatusOr<absl::flat_hash_map<std::string, Z3_ast>> TranslateStateTable(
       const netlist::rtl::Cell& cell);
@@ -12,15 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <string>
 #include <string_view>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "grpcpp/security/server_credentials.h"
@@ -39,6 +42,10 @@ Launches a XLS synthesis server which serves fake results. The flag
 --max_frequency_ghz is used to determine whether a negative slack value is
 returned in the response.
 
+For load testing clients, --response_delay_ms makes each request take at least
+that long and --max_concurrent_requests rejects requests beyond that many in
+flight with RESOURCE_EXHAUSTED.
+
 Invocation:
 
   fake_synthesis_server --max_frequency_ghz=4.2
@@ -49,6 +56,12 @@ ABSL_FLAG(double, max_frequency_ghz, 1000,
           "The maximum frequency to use for any synthesis request.");
 ABSL_FLAG(bool, serve_errors, false,
           "Whether to serve an error in the response.");
+ABSL_FLAG(int64_t, response_delay_ms, 0,
+          "Time to wait before responding to each request, to simulate "
+          "synthesis latency.");
+ABSL_FLAG(int64_t, max_concurrent_requests, 0,
+          "If positive, requests arriving while this many are already in "
+          "flight fail with RESOURCE_EXHAUSTED.");
 
 namespace xls {
 namespace synthesis {
@@ -57,13 +70,35 @@ namespace {
 // Service implementation that dispatches compile requests.
 class FakeSynthesisServiceImpl : public SynthesisService::Service {
  public:
-  explicit FakeSynthesisServiceImpl(int64_t max_frequency_hz, bool serve_errors)
-      : max_frequency_hz_(max_frequency_hz), serve_errors_(serve_errors) {}
+  FakeSynthesisServiceImpl(int64_t max_frequency_hz, bool serve_errors,
+                           absl::Duration response_delay,
+                           int64_t max_concurrent_requests)
+      : max_frequency_hz_(max_frequency_hz),
+        serve_errors_(serve_errors),
+        response_delay_(response_delay),
+        max_concurrent_requests_(max_concurrent_requests) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
     auto start = absl::Now();
+    {
+      absl::MutexLock lock(&mutex_);
+      ++request_count_;
+      if (max_concurrent_requests_ > 0 &&
+          in_flight_ >= max_concurrent_requests_) {
+        ++rejected_count_;
+        return ::grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                              "Too many concurrent requests");
+      }
+      ++in_flight_;
+      max_in_flight_ = std::max(max_in_flight_, in_flight_);
+      VLOG(1) << "Request " << request_count_ << " for `"
+              << request->top_module_name() << "`; " << in_flight_
+              << " in flight (max " << max_in_flight_ << "), "
+              << rejected_count_ << " rejected";
+    }
+    absl::SleepFor(response_delay_);
 
     result->set_slack_ps(
         request->target_frequency_hz() <= max_frequency_hz_
@@ -75,6 +110,10 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     result->set_netlist("// NETLIST");
     result->set_elapsed_runtime_ms(
         absl::ToInt64Milliseconds(absl::Now() - start));
+    {
+      absl::MutexLock lock(&mutex_);
+      --in_flight_;
+    }
     if (serve_errors_) {
       return ::grpc::Status(grpc::StatusCode::INTERNAL,
                             "Fake synthesis server error");
@@ -85,6 +124,14 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
  private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
+  absl::Duration response_delay_;
+  int64_t max_concurrent_requests_;
+
+  absl::Mutex mutex_;
+  int64_t request_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t rejected_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t max_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 void RealMain() {
@@ -92,8 +139,10 @@ void RealMain() {
       static_cast<int64_t>(1e9 * absl::GetFlag(FLAGS_max_frequency_ghz));
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
-  FakeSynthesisServiceImpl service(max_frequency_hz,
-                                   absl::GetFlag(FLAGS_serve_errors));
+  FakeSynthesisServiceImpl service(
+      max_frequency_hz, absl::GetFlag(FLAGS_serve_errors),
+      absl::Milliseconds(absl::GetFlag(FLAGS_response_delay_ms)),
+      absl::GetFlag(FLAGS_max_concurrent_requests));
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
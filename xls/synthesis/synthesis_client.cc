@@ -14,17 +14,37 @@
 
 #include "xls/synthesis/synthesis_client.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/status.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -39,6 +59,172 @@ static absl::Status GrpcToAbslStatus(const grpc::Status& grpc_status) {
       grpc_status.error_message());
 }
 
+static bool IsTransient(const absl::Status& status) {
+  return absl::IsUnavailable(status) || absl::IsDeadlineExceeded(status) ||
+         absl::IsResourceExhausted(status);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<SynthesisClient>>
+SynthesisClient::Create(SynthesisClientOptions options) {
+  if (options.max_concurrent_requests < 1) {
+    return absl::InvalidArgumentError(
+        "Synthesis client must allow at least one request in flight");
+  }
+  if (options.max_retries < 0) {
+    return absl::InvalidArgumentError(
+        "Synthesis client retry count must be non-negative");
+  }
+  if (options.cache_dir.has_value()) {
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*options.cache_dir));
+  }
+  std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
+  std::shared_ptr<grpc::Channel> channel =
+      grpc::CreateChannel(options.server, creds);
+  return absl::WrapUnique(new SynthesisClient(
+      std::move(options), SynthesisService::NewStub(channel)));
+}
+
+/* static */ std::string SynthesisClient::CacheKey(
+    const CompileRequest& request) {
+  // Serialize deterministically so equal requests hash equally across
+  // processes.
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    request.SerializeToCodedStream(&coded_stream);
+  }
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(serialized.data()),
+         serialized.size(), reinterpret_cast<uint8_t*>(digest.data()));
+  return absl::BytesToHexString({digest.data(), digest.size()});
+}
+
+int64_t SynthesisClient::cache_hits() const {
+  absl::MutexLock lock(&mutex_);
+  return cache_hits_;
+}
+
+int64_t SynthesisClient::server_requests() const {
+  absl::MutexLock lock(&mutex_);
+  return server_requests_;
+}
+
+std::optional<CompileResponse> SynthesisClient::LookUpCache(
+    const std::string& key) {
+  std::filesystem::path path = *options_.cache_dir / absl::StrCat(key, ".pb");
+  if (!FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  CompileResponse response;
+  if (absl::Status status = ParseProtobinFile(path, &response); !status.ok()) {
+    LOG(WARNING) << "Ignoring unreadable synthesis cache entry " << path
+                 << ": " << status;
+    return std::nullopt;
+  }
+  return response;
+}
+
+void SynthesisClient::InsertIntoCache(const std::string& key,
+                                      const CompileResponse& response) {
+  std::filesystem::path path = *options_.cache_dir / absl::StrCat(key, ".pb");
+  absl::Status status =
+      AtomicSetFileContents(path, response.SerializeAsString());
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write synthesis cache entry " << path << ": "
+                 << status;
+  }
+}
+
+absl::StatusOr<CompileResponse> SynthesisClient::SendWithRetries(
+    const CompileRequest& request) {
+  absl::Duration retry_delay = options_.initial_retry_delay;
+  for (int64_t attempt = 0;; ++attempt) {
+    grpc::ClientContext context;
+    if (options_.request_timeout.has_value()) {
+      context.set_deadline(absl::ToChronoTime(
+          absl::Now() + *options_.request_timeout));
+    }
+    CompileResponse response;
+    absl::Status status =
+        GrpcToAbslStatus(stub_->Compile(&context, request, &response));
+    if (status.ok()) {
+      return response;
+    }
+    if (!IsTransient(status) || attempt >= options_.max_retries) {
+      return status;
+    }
+    VLOG(1) << "Retrying synthesis of `" << request.top_module_name()
+            << "` after " << retry_delay << ": " << status;
+    absl::SleepFor(retry_delay);
+    retry_delay *= 2;
+  }
+}
+
+absl::StatusOr<CompileResponse> SynthesisClient::Synthesize(
+    const CompileRequest& request) {
+  std::optional<std::string> key;
+  if (options_.cache_dir.has_value()) {
+    key = CacheKey(request);
+    if (std::optional<CompileResponse> cached = LookUpCache(*key);
+        cached.has_value()) {
+      absl::MutexLock lock(&mutex_);
+      ++cache_hits_;
+      return *std::move(cached);
+    }
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &SynthesisClient::HasFreeSlot));
+    ++in_flight_;
+    ++server_requests_;
+  }
+  absl::StatusOr<CompileResponse> response = SendWithRetries(request);
+  {
+    absl::MutexLock lock(&mutex_);
+    --in_flight_;
+  }
+
+  if (response.ok() && key.has_value()) {
+    InsertIntoCache(*key, *response);
+  }
+  return response;
+}
+
+std::vector<absl::StatusOr<CompileResponse>> SynthesisClient::SynthesizeAll(
+    absl::Span<const CompileRequest> requests) {
+  std::vector<absl::StatusOr<CompileResponse>> results(
+      requests.size(), absl::UnknownError("Request not sent"));
+  absl::Mutex next_mutex;
+  int64_t next = 0;
+  auto worker = [&]() {
+    while (true) {
+      int64_t index;
+      {
+        absl::MutexLock lock(&next_mutex);
+        if (next >= requests.size()) {
+          return;
+        }
+        index = next++;
+      }
+      results[index] = Synthesize(requests[index]);
+    }
+  };
+  int64_t thread_count = std::min<int64_t>(options_.max_concurrent_requests,
+                                           requests.size());
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return results;
+}
+
 // This creates a new channel and stub *each* invocation
 absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server, const CompileRequest& request) {
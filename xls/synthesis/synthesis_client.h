@@ -15,14 +15,102 @@
 #ifndef XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 #define XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/synthesis/synthesis.pb.h"
+#include "xls/synthesis/synthesis_service.grpc.pb.h"
 
 namespace xls {
 namespace synthesis {
 
+struct SynthesisClientOptions {
+  // The gRPC endpoint to send requests to, e.g. "ipv4:///0.0.0.0:10000".
+  std::string server;
+
+  // Maximum number of requests in flight at once, across all threads using
+  // the client.
+  int64_t max_concurrent_requests = 16;
+
+  // Number of times a request failing with UNAVAILABLE, DEADLINE_EXCEEDED or
+  // RESOURCE_EXHAUSTED is retried. Other errors are returned immediately.
+  int64_t max_retries = 3;
+
+  // Delay before the first retry; doubled for each subsequent retry.
+  absl::Duration initial_retry_delay = absl::Milliseconds(100);
+
+  // Deadline of each attempt, if any.
+  std::optional<absl::Duration> request_timeout;
+
+  // If set, successful responses are cached in this directory, keyed by a
+  // hash of the whole request (module text, top module name, target
+  // frequency, ...), and served from it on later requests, including by other
+  // processes.
+  std::optional<std::filesystem::path> cache_dir;
+};
+
+// Client of a `SynthesisService` which shares one channel across requests,
+// bounds the number of requests in flight and retries transient failures.
+// Thread-safe: any number of threads may issue requests concurrently.
+class SynthesisClient {
+ public:
+  static absl::StatusOr<std::unique_ptr<SynthesisClient>> Create(
+      SynthesisClientOptions options);
+
+  // Synthesizes a single request, blocking until a response is received or
+  // retries are exhausted.
+  absl::StatusOr<CompileResponse> Synthesize(const CompileRequest& request);
+
+  // Synthesizes all the given requests with up to `max_concurrent_requests`
+  // in flight. The result at each index corresponds to the request at that
+  // index; a failed request does not prevent the others from completing.
+  std::vector<absl::StatusOr<CompileResponse>> SynthesizeAll(
+      absl::Span<const CompileRequest> requests);
+
+  // Returns the key under which the response to `request` is cached. Equal
+  // requests have equal keys.
+  static std::string CacheKey(const CompileRequest& request);
+
+  // Number of requests served from the cache and sent to the server so far.
+  int64_t cache_hits() const;
+  int64_t server_requests() const;
+
+ private:
+  SynthesisClient(SynthesisClientOptions options,
+                  std::unique_ptr<SynthesisService::Stub> stub)
+      : options_(std::move(options)), stub_(std::move(stub)) {}
+
+  bool HasFreeSlot() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return in_flight_ < options_.max_concurrent_requests;
+  }
+
+  std::optional<CompileResponse> LookUpCache(const std::string& key);
+  void InsertIntoCache(const std::string& key,
+                       const CompileResponse& response);
+
+  // Sends the request to the server, retrying transient failures.
+  absl::StatusOr<CompileResponse> SendWithRetries(
+      const CompileRequest& request);
+
+  const SynthesisClientOptions options_;
+  std::unique_ptr<SynthesisService::Stub> stub_;
+
+  mutable absl::Mutex mutex_;
+  int64_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t cache_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t server_requests_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 // This creates a new channel and stub *each* invocation
 absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server, const CompileRequest& request);
@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/synthesis_client.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOk;
+using status_testing::StatusIs;
+using ::testing::Not;
+
+CompileRequest MakeRequest(std::string_view module_text,
+                           int64_t frequency_hz) {
+  CompileRequest request;
+  request.set_module_text(module_text);
+  request.set_top_module_name("main");
+  request.set_target_frequency_hz(frequency_hz);
+  return request;
+}
+
+// Options for a client of a server which is not running, so only cached
+// requests succeed.
+SynthesisClientOptions UnreachableServerOptions(
+    const std::filesystem::path& cache_dir) {
+  return SynthesisClientOptions{
+      .server = "ipv4:///127.0.0.1:1",
+      .max_concurrent_requests = 2,
+      .max_retries = 0,
+      .request_timeout = absl::Seconds(1),
+      .cache_dir = cache_dir,
+  };
+}
+
+TEST(SynthesisClientTest, CacheKeyCoversWholeRequest) {
+  EXPECT_EQ(SynthesisClient::CacheKey(MakeRequest("module main();", 1000)),
+            SynthesisClient::CacheKey(MakeRequest("module main();", 1000)));
+  EXPECT_NE(SynthesisClient::CacheKey(MakeRequest("module main();", 1000)),
+            SynthesisClient::CacheKey(MakeRequest("module main(); ", 1000)));
+  EXPECT_NE(SynthesisClient::CacheKey(MakeRequest("module main();", 1000)),
+            SynthesisClient::CacheKey(MakeRequest("module main();", 2000)));
+}
+
+TEST(SynthesisClientTest, ServesCachedResponses) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  CompileRequest cached_request = MakeRequest("module main();", 1000);
+  CompileResponse cached_response;
+  cached_response.set_slack_ps(42);
+  XLS_ASSERT_OK(SetProtobinFile(
+      cache_dir.path() /
+          absl::StrCat(SynthesisClient::CacheKey(cached_request), ".pb"),
+      cached_response));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SynthesisClient> client,
+      SynthesisClient::Create(UnreachableServerOptions(cache_dir.path())));
+  std::vector<CompileRequest> requests = {
+      cached_request, MakeRequest("module other();", 1000), cached_request};
+  std::vector<absl::StatusOr<CompileResponse>> responses =
+      client->SynthesizeAll(requests);
+  ASSERT_EQ(responses.size(), 3);
+  XLS_ASSERT_OK(responses[0].status());
+  EXPECT_EQ(responses[0]->slack_ps(), 42);
+  EXPECT_THAT(responses[1].status(), Not(IsOk()));
+  XLS_ASSERT_OK(responses[2].status());
+  EXPECT_EQ(responses[2]->slack_ps(), 42);
+  EXPECT_EQ(client->cache_hits(), 2);
+  EXPECT_EQ(client->server_requests(), 1);
+}
+
+TEST(SynthesisClientTest, RejectsInvalidOptions) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  SynthesisClientOptions options = UnreachableServerOptions(cache_dir.path());
+  options.max_concurrent_requests = 0;
+  EXPECT_THAT(SynthesisClient::Create(options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
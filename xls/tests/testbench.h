@@ -15,6 +15,7 @@
 #ifndef XLS_TOOLS_TESTBENCH_H_
 #define XLS_TOOLS_TESTBENCH_H_
 
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <functional>
@@ -29,6 +30,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/tests/testbench_thread.h"
 
 namespace xls {
@@ -40,10 +42,17 @@ namespace xls {
 // periodically printed to the terminal, as this class' primary use is for
 // exploring large test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// By default, work is parititioned uniformly across threads at startup. This
+// can lead to work imbalance if certain areas of the input space execute faster
+// than others.
+//
+// In batched mode, enabled by passing a compute-actual function that handles a
+// block of inputs and a batch size, the threads instead claim blocks of
+// consecutive indices from a shared counter until the space is exhausted, so
+// faster threads take on more of the work. Each block's actual results are
+// computed by a single call of the batched function, and pass and failure
+// counts are kept per thread and only updated once per block. This is meant
+// for exhaustive sweeps, e.g. of every 32-bit float.
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -76,6 +85,10 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   compute_actual_batch: If given, the function to call to calculate the XLS
+  //                     results of a block of inputs, which enables batched
+  //                     mode (see above). compute_actual is then unused.
+  //   batch_size      : The number of inputs per block in batched mode.
   //
   // All lambdas must be thread-safe.
   //
@@ -90,18 +103,30 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            std::function<void(ShardDataT*, absl::Span<const InputT>,
+                               absl::Span<ResultT>)>
+                compute_actual_batch = nullptr,
+            uint64_t batch_size = 0)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors,
+            compute_actual_batch == nullptr ? 0 : batch_size),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
+        compute_actual_(compute_actual),
+        compute_actual_batch_(compute_actual_batch) {
     this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
-      return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
-          this->index_to_input_, create_shard_, compute_expected_,
-          compute_actual_, this->compare_results_, this->log_errors_);
+      auto thread =
+          std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
+              &this->mutex_, &this->wake_me_, start, end,
+              this->max_failures_, this->index_to_input_, create_shard_,
+              compute_expected_, compute_actual_, this->compare_results_,
+              this->log_errors_);
+      if (compute_actual_batch_ != nullptr) {
+        thread->SetGenerateActualBatch(compute_actual_batch_);
+      }
+      return thread;
     };
   }
 
@@ -109,6 +134,9 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   std::function<std::unique_ptr<ShardDataT>()> create_shard_;
   std::function<ResultT(ShardDataT*, InputT)> compute_expected_;
   std::function<ResultT(ShardDataT*, InputT)> compute_actual_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // Shard-data-less implementation.
@@ -123,23 +151,35 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+                compute_actual_batch = nullptr,
+            uint64_t batch_size = 0)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors,
+            compute_actual_batch == nullptr ? 0 : batch_size),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
+        compute_actual_(compute_actual),
+        compute_actual_batch_(compute_actual_batch) {
     this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
-      return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
-          this->index_to_input_, compute_expected_, compute_actual_,
-          this->compare_results_, this->log_errors_);
+      auto thread =
+          std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
+              &this->mutex_, &this->wake_me_, start, end,
+              this->max_failures_, this->index_to_input_, compute_expected_,
+              compute_actual_, this->compare_results_, this->log_errors_);
+      if (compute_actual_batch_ != nullptr) {
+        thread->SetGenerateActualBatch(compute_actual_batch_);
+      }
+      return thread;
     };
   }
 
  private:
   std::function<ResultT(InputT)> compute_expected_;
   std::function<ResultT(InputT)> compute_actual_;
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // INTERNAL IMPL ---------------------------------
@@ -154,12 +194,14 @@ class TestbenchBase {
       uint64_t start, uint64_t end, uint64_t num_threads, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      uint64_t batch_size)
       : started_(false),
         num_threads_(num_threads),
         start_(start),
         end_(end),
         max_failures_(max_failures),
+        batch_size_(batch_size),
         num_samples_processed_(0),
         index_to_input_(index_to_input),
         compare_results_(compare_results),
@@ -183,24 +225,33 @@ class TestbenchBase {
     mutex_.Lock();
     started_ = true;
 
-    // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
-    for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
+    // Set up all the workers. In batched mode they all share the whole space.
+    if (batch_size_ > 0) {
+      next_index_.store(start_);
+      for (int i = 0; i < num_threads_; i++) {
+        threads_.push_back(thread_create_fn_(start_, end_));
+        threads_.back()->ShareWork(&next_index_, batch_size_);
+        threads_.back()->Run();
       }
+    } else {
+      uint64_t chunk_size = (end_ - start_) / num_threads_;
+      uint64_t chunk_remainder =
+          chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
+      uint64_t first = 0;
+      uint64_t last;
+      for (int i = 0; i < num_threads_; i++) {
+        last = first + chunk_size;
+        // Distribute any remainder evenly amongst the threads.
+        if (chunk_remainder > 0) {
+          last++;
+          chunk_remainder--;
+        }
 
-      threads_.push_back(thread_create_fn_(first, last));
-      threads_.back()->Run();
+        threads_.push_back(thread_create_fn_(first, last));
+        threads_.back()->Run();
 
-      first = last + 1;
+        first = last + 1;
+      }
     }
 
     // Wait for all to be ready.
@@ -273,9 +324,13 @@ class TestbenchBase {
 
   // Prints the current execution status across all threads.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
+    // Get the remainder-adjusted chunk size for this thread. In batched mode
+    // threads share the whole space, so progress is shown as a share of it.
     auto thread_chunk_size = [this](int thread_index) {
       uint64_t total_size = end_ - start_;
+      if (batch_size_ > 0) {
+        return total_size;
+      }
       uint64_t chunk_size = total_size / threads_.size();
       uint64_t remainder =
           chunk_size == 0 ? total_size : total_size % chunk_size;
@@ -334,6 +389,7 @@ class TestbenchBase {
   uint64_t start_;
   uint64_t end_;
   uint64_t max_failures_;
+  uint64_t batch_size_;
   uint64_t num_samples_processed_;
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<bool(ResultT, ResultT)> compare_results_;
@@ -343,6 +399,9 @@ class TestbenchBase {
   std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
 
+  // In batched mode, the next index no thread has claimed yet.
+  std::atomic<uint64_t> next_index_;
+
   // The main thread sleeps while tests are running. As worker threads finish,
   // they'll wake us up via this condvar.
   absl::Mutex mutex_;
@@ -44,6 +44,7 @@
 #include <thread>
 #include <type_traits>
 
+#include "absl/types/span.h"
 #include "xls/tests/testbench.h"
 #include "xls/tests/testbench_builder_utils.h"
 
@@ -56,6 +57,8 @@ class TestbenchBuilder {
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(ShardDataT*, InputT)>;
+  using ComputeBatchFnT = std::function<void(
+      ShardDataT*, absl::Span<const InputT>, absl::Span<ResultT>)>;
   using CreateShardDataFnT = std::function<std::unique_ptr<ShardDataT>()>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
@@ -73,6 +76,15 @@ class TestbenchBuilder {
     return *this;
   }
 
+  // Runs the testbench in batched mode, computing the actual results of
+  // blocks of batch_size inputs with the given function; see Testbench.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn,
+                                            int64_t batch_size = 4096) {
+    compute_actual_batch_ = fn;
+    batch_size_ = batch_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -114,8 +126,10 @@ class TestbenchBuilder {
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
   int64_t max_failures_ = 1;
+  uint64_t batch_size_ = 0;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   CreateShardDataFnT create_shard_data_;
   std::optional<IndexToInputFnT> index_to_input_;
@@ -132,6 +146,8 @@ class TestbenchBuilder<
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(InputT)>;
+  using ComputeBatchFnT =
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
   using PrintInputFnT = std::function<std::string(const InputT&)>;
@@ -145,6 +161,15 @@ class TestbenchBuilder<
     return *this;
   }
 
+  // Runs the testbench in batched mode, computing the actual results of
+  // blocks of batch_size inputs with the given function; see Testbench.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn,
+                                            int64_t batch_size = 4096) {
+    compute_actual_batch_ = fn;
+    batch_size_ = batch_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -186,8 +211,10 @@ class TestbenchBuilder<
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
   int64_t max_failures_ = 1;
+  uint64_t batch_size_ = 0;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   std::optional<IndexToInputFnT> index_to_input_;
   std::optional<PrintInputFnT> print_input_;
@@ -232,7 +259,8 @@ TestbenchBuilder<InputT, ResultT, ShardDataT, EnableT>::Build() {
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, create_shard_data_, this->compute_expected_,
-      this->compute_actual_, compare_results, log_errors);
+      this->compute_actual_, compare_results, log_errors,
+      this->compute_actual_batch_, this->batch_size_);
 }
 
 // Non-shard-data-containing Build() implementation.
@@ -272,7 +300,8 @@ Testbench<InputT, ResultT> TestbenchBuilder<
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, this->compute_expected_, this->compute_actual_,
-      compare_results, log_errors);
+      compare_results, log_errors, this->compute_actual_batch_,
+      this->batch_size_);
 }
 
 }  // namespace xls
@@ -15,16 +15,20 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/thread.h"
 #include "xls/ir/package.h"
 
@@ -82,11 +86,27 @@ class TestbenchThread
 
   void Init() override { shard_data_ = create_shard_fn_(); }
 
+  // Sets the function which generates the actual values of a block of inputs
+  // in batched mode; see ShareWork().
+  void SetGenerateActualBatch(
+      std::function<void(ShardDataT*, absl::Span<const InputT>,
+                         absl::Span<ResultT>)>
+          generate_actual_batch) {
+    generate_actual_batch_ = std::move(generate_actual_batch);
+    this->generate_actual_batch_fn_ = [this](absl::Span<const InputT> inputs,
+                                             absl::Span<ResultT> results) {
+      generate_actual_batch_(shard_data_.get(), inputs, results);
+    };
+  }
+
  private:
   std::unique_ptr<ShardDataT> shard_data_;
   std::function<std::unique_ptr<ShardDataT>()> create_shard_fn_;
   std::function<ResultT(ShardDataT*, InputT)> generate_expected_;
   std::function<ResultT(ShardDataT*, InputT)> generate_actual_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      generate_actual_batch_;
 };
 
 // And the without-shard-data case.
@@ -119,6 +139,14 @@ class TestbenchThread<
     };
   }
 
+  // Sets the function which generates the actual values of a block of inputs
+  // in batched mode; see ShareWork().
+  void SetGenerateActualBatch(
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+          generate_actual_batch) {
+    this->generate_actual_batch_fn_ = std::move(generate_actual_batch);
+  }
+
  private:
   std::function<ResultT(InputT)> generate_expected_;
   std::function<ResultT(InputT)> generate_actual_;
@@ -162,6 +190,20 @@ class TestbenchThreadBase {
     thread_ = std::make_unique<Thread>([this]() { RunInternal(); });
   }
 
+  // Switches the thread to batched mode. Rather than evaluating its own range
+  // one input at a time, the thread repeatedly claims the next 'batch_size'
+  // indices below its end index from 'next_index', which is shared by all the
+  // threads of a testbench, and computes their actual values with one call of
+  // the batched generate-actual function. Threads which finish their batches
+  // faster simply claim more of them. Pass and failure counts are accumulated
+  // per batch, so the shared counters are touched once per batch rather than
+  // once per sample. Must be called before Run(), after the batched function
+  // is set.
+  void ShareWork(std::atomic<uint64_t>* next_index, uint64_t batch_size) {
+    next_index_ = next_index;
+    batch_size_ = batch_size;
+  }
+
   void RunInternal() {
     absl::Status return_status;
     if (cancelled_.load()) {
@@ -177,25 +219,29 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
-        break;
-      }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
+    if (next_index_ != nullptr) {
+      return_status = RunBatches();
+    } else {
+      for (uint64_t i = start_index_; i < end_index_; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if (i % 128 == 0 && cancelled_.load()) {
+          return_status = absl::CancelledError("This thread was cancelled.");
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        if (!compare_results_(expected, actual)) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures_.load()) {
+            return_status = absl::UnknownError("Maximum error count reached.");
+            break;
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
       }
     }
 
@@ -211,6 +257,49 @@ class TestbenchThreadBase {
   // data.
   virtual void Init() {}
 
+  // Evaluates batches of indices claimed from next_index_ until there are none
+  // left; see ShareWork().
+  absl::Status RunBatches() {
+    std::vector<InputT> inputs;
+    std::vector<ResultT> expected;
+    std::vector<ResultT> actual(batch_size_);
+    inputs.reserve(batch_size_);
+    expected.reserve(batch_size_);
+    while (!cancelled_.load(std::memory_order_relaxed)) {
+      uint64_t first =
+          next_index_->fetch_add(batch_size_, std::memory_order_relaxed);
+      if (first >= end_index_) {
+        return absl::OkStatus();
+      }
+      uint64_t count = std::min(batch_size_, end_index_ - first);
+      inputs.clear();
+      expected.clear();
+      for (uint64_t i = first; i < first + count; ++i) {
+        inputs.push_back(index_to_input_(i));
+        expected.push_back(generate_expected_fn_(inputs.back()));
+      }
+      absl::Span<ResultT> batch_actual = absl::MakeSpan(actual).first(count);
+      generate_actual_batch_fn_(inputs, batch_actual);
+
+      uint64_t passes = 0;
+      for (uint64_t i = 0; i < count; ++i) {
+        if (compare_results_(expected[i], batch_actual[i])) {
+          ++passes;
+          continue;
+        }
+        uint64_t failures =
+            num_failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+        log_errors_(first + i, inputs[i], expected[i], batch_actual[i]);
+        if (max_failures_ <= failures) {
+          num_passes_.fetch_add(passes, std::memory_order_relaxed);
+          return absl::UnknownError("Maximum error count reached.");
+        }
+      }
+      num_passes_.fetch_add(passes, std::memory_order_relaxed);
+    }
+    return absl::CancelledError("This thread was cancelled.");
+  }
+
   void Join() {
     if (thread_) {
       thread_->Join();
@@ -260,6 +349,11 @@ class TestbenchThreadBase {
   uint64_t start_index_;
   uint64_t end_index_;
 
+  // Set in batched mode: the next unclaimed index, shared by all threads, and
+  // how many indices are claimed at a time.
+  std::atomic<uint64_t>* next_index_ = nullptr;
+  uint64_t batch_size_ = 0;
+
   // Bookkeeping data.
   uint64_t max_failures_;
   std::atomic<uint64_t> num_passes_;
@@ -268,6 +362,8 @@ class TestbenchThreadBase {
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<ResultT(InputT&)> generate_expected_fn_;
   std::function<ResultT(InputT&)> generate_actual_fn_;
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      generate_actual_batch_fn_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
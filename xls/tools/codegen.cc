@@ -29,11 +29,13 @@
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/combinational_generator.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/pipeline_generator.h"
 #include "xls/codegen/ram_configuration.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
@@ -43,6 +45,8 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/op.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/passes/pass_profile.pb.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -199,6 +203,30 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.set_simulation_macro_name(p.simulation_macro_name());
 
+  if (p.has_block_generation_threads()) {
+    options.block_generation_threads(p.block_generation_threads());
+  }
+
+  options.retime_pipeline_registers(p.retime_pipeline_registers());
+
+  if (!p.rom_init_dir().empty()) {
+    options.rom_init_dir(p.rom_init_dir());
+  }
+  if (p.has_rom_init_threshold()) {
+    options.rom_init_threshold(p.rom_init_threshold());
+  }
+
+  if (!p.verilog_cache_dir().empty()) {
+    // Every option which affects Verilog generation is derived from the flags
+    // proto, so it identifies the cache entries. Options which do not affect
+    // the output are cleared so they do not cause spurious misses.
+    CodegenFlagsProto key_proto = p;
+    key_proto.clear_verilog_cache_dir();
+    key_proto.clear_block_generation_threads();
+    options.verilog_cache_dir(p.verilog_cache_dir());
+    options.verilog_cache_key(key_proto.ShortDebugString());
+  }
+
   std::vector<std::unique_ptr<verilog::RamConfiguration>> ram_configurations;
   ram_configurations.reserve(p.ram_configurations_size());
   for (const std::string& config_text : p.ram_configurations()) {
@@ -248,6 +276,7 @@ absl::StatusOr<PipelineScheduleOrGroup> Schedule(
   if (scheduling_time != nullptr) {
     *scheduling_time = stopwatch->GetElapsedTime();
   }
+  EndMemoryStage("schedule");
   return result;
 }
 
@@ -263,22 +292,25 @@ absl::StatusOr<CodegenResult> CodegenPipeline(
   }
 
   verilog::ModuleGeneratorResult result;
+  verilog::CodegenPassResults pass_results;
   PackagePipelineSchedulesProto package_pipeline_schedules_proto;
   if (std::holds_alternative<PipelineSchedule>(schedules)) {
     const PipelineSchedule& schedule = std::get<PipelineSchedule>(schedules);
     package_pipeline_schedules_proto.mutable_schedules()->insert(
         {schedule.function_base()->name(), schedule.ToProto(*delay_estimator)});
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(
-                    schedule, *p->GetTop(), codegen_options, delay_estimator));
+        result,
+        verilog::ToPipelineModuleText(schedule, *p->GetTop(), codegen_options,
+                                      delay_estimator, &pass_results));
   } else if (std::holds_alternative<PackagePipelineSchedules>(schedules)) {
     const PackagePipelineSchedules& schedule_group =
         std::get<PackagePipelineSchedules>(schedules);
     package_pipeline_schedules_proto =
         PackagePipelineSchedulesToProto(schedule_group, *delay_estimator);
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(
-                    schedule_group, p, codegen_options, delay_estimator));
+        result,
+        verilog::ToPipelineModuleText(schedule_group, p, codegen_options,
+                                      delay_estimator, &pass_results));
   } else {
     LOG(FATAL) << absl::StreamFormat("Unknown schedules type (%d).",
                                      schedules.index());
@@ -287,10 +319,15 @@ absl::StatusOr<CodegenResult> CodegenPipeline(
   if (codegen_time != nullptr) {
     *codegen_time = stopwatch->GetElapsedTime();
   }
+  EndMemoryStage("codegen");
 
+  PassPipelineProfileProto codegen_pass_profile =
+      PassResultsToProfileProto(pass_results);
+  AddBlockSizesToProfile(*p, &codegen_pass_profile);
   return CodegenResult{
       .module_generator_result = result,
       .package_pipeline_schedules_proto = package_pipeline_schedules_proto,
+      .codegen_pass_profile = std::move(codegen_pass_profile),
   };
 }
 
@@ -301,13 +338,20 @@ absl::StatusOr<CodegenResult> CodegenCombinational(
   if (codegen_time != nullptr) {
     stopwatch.emplace();
   }
-  XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult result,
-                       verilog::GenerateCombinationalModule(
-                           *p->GetTop(), codegen_options, delay_estimator));
+  verilog::CodegenPassResults pass_results;
+  XLS_ASSIGN_OR_RETURN(
+      verilog::ModuleGeneratorResult result,
+      verilog::GenerateCombinationalModule(*p->GetTop(), codegen_options,
+                                           delay_estimator, &pass_results));
   if (codegen_time != nullptr) {
     *codegen_time = stopwatch->GetElapsedTime();
   }
-  return CodegenResult{.module_generator_result = result};
+  EndMemoryStage("codegen");
+  PassPipelineProfileProto codegen_pass_profile =
+      PassResultsToProfileProto(pass_results);
+  AddBlockSizesToProfile(*p, &codegen_pass_profile);
+  return CodegenResult{.module_generator_result = result,
+                       .codegen_pass_profile = std::move(codegen_pass_profile)};
 }
 
 absl::StatusOr<CodegenResult> ScheduleAndCodegen(
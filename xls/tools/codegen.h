@@ -21,6 +21,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_profile.pb.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -44,6 +45,9 @@ struct CodegenResult {
   verilog::ModuleGeneratorResult module_generator_result;
   std::optional<PackagePipelineSchedulesProto>
       package_pipeline_schedules_proto = std::nullopt;
+  // Per-pass timing and IR size statistics of the codegen pass pipeline, and
+  // the sizes of the resulting blocks.
+  PassPipelineProfileProto codegen_pass_profile;
 };
 
 absl::StatusOr<CodegenResult> CodegenPipeline(
@@ -159,6 +159,25 @@ ABSL_FLAG(std::string, simulation_macro_name, "SIMULATION",
           "Verilog macro name to use in an `ifdef guard for "
           "simulation-specific constructs such as $display statements. If "
           "prefixed with `!` the polarity of the guard is inverted (`ifndef).");
+ABSL_FLAG(int64_t, block_generation_threads, 1,
+          "Number of threads used to generate and emit the Verilog modules of "
+          "independent blocks, e.g. the blocks of a multi-proc design. The "
+          "output does not depend on the number of threads.");
+ABSL_FLAG(bool, retime_pipeline_registers, false,
+          "If true, pipeline registers are retimed after scheduling to "
+          "balance the delay of the pipeline stages.");
+ABSL_FLAG(std::string, verilog_cache_dir, "",
+          "If non-empty, the Verilog module generated for each block is cached "
+          "in this directory and reused by later invocations when the block "
+          "IR and codegen options are unchanged.");
+ABSL_FLAG(std::string, rom_init_dir, "",
+          "If non-empty, literal arrays of bits with at least "
+          "--rom_init_threshold elements (e.g. ROMs) are written to "
+          "initialization files in this directory and loaded with $readmemh "
+          "rather than being emitted inline.");
+ABSL_FLAG(int64_t, rom_init_threshold, 256,
+          "Minimum number of elements of literal arrays written to "
+          "initialization files when --rom_init_dir is given.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_codegen_rules.bzl,
 //   //xls/build_rules/xls_providers.bzl,
@@ -240,6 +259,11 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   POPULATE_FLAG(flop_outputs);
   POPULATE_FLAG(emit_sv_types);
   POPULATE_FLAG(simulation_macro_name);
+  POPULATE_FLAG(block_generation_threads);
+  POPULATE_FLAG(retime_pipeline_registers);
+  POPULATE_FLAG(verilog_cache_dir);
+  POPULATE_FLAG(rom_init_dir);
+  POPULATE_FLAG(rom_init_threshold);
 
   XLS_ASSIGN_OR_RETURN(
       IOKindProto flop_inputs_kind,
@@ -29,12 +29,14 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/tool_timeout.h"
+#include "xls/ir/binary_package.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_profile.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/tools/codegen.h"
@@ -58,6 +60,15 @@ Emit a feed-forward pipelined module:
        IR_FILE
 )";
 
+ABSL_FLAG(std::string, codegen_pass_profile_path, "",
+          "If specified, write a PassPipelineProfileProto text proto with the "
+          "wall time and node counts of every codegen pass invocation and the "
+          "sizes of the generated blocks to this path. The format matches "
+          "opt_main's --pass_profile_path.");
+ABSL_FLAG(std::string, codegen_pass_profile_csv_path, "",
+          "If specified, write per-pass codegen profile summaries as CSV to "
+          "this path in the format of opt_main's --pass_profile_csv_path.");
+
 namespace xls {
 namespace {
 
@@ -66,9 +77,8 @@ absl::Status RealMain(std::string_view ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p, ReadPackageFile(ir_path));
+  EndMemoryStage("parse");
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -94,6 +104,19 @@ absl::Status RealMain(std::string_view ir_path) {
   std::optional<PackagePipelineSchedulesProto> schedule =
       r.package_pipeline_schedules_proto;
 
+  const std::string& pass_profile_path =
+      absl::GetFlag(FLAGS_codegen_pass_profile_path);
+  if (!pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(pass_profile_path, r.codegen_pass_profile));
+  }
+  const std::string& pass_profile_csv_path =
+      absl::GetFlag(FLAGS_codegen_pass_profile_csv_path);
+  if (!pass_profile_csv_path.empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        pass_profile_csv_path, PassProfileToCsv(r.codegen_pass_profile)));
+  }
+
   if (!absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
     XLS_RETURN_IF_ERROR(
         SetFileContents(absl::GetFlag(FLAGS_output_schedule_ir_path),
@@ -143,7 +166,7 @@ absl::Status RealMain(std::string_view ir_path) {
   } else {
     XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, result.verilog_text));
   }
-  return absl::OkStatus();
+  return WriteProcessMemoryProfile();
 }
 
 }  // namespace
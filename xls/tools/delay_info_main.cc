@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -30,6 +31,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
@@ -41,6 +43,7 @@
 #include "xls/fdo/grpc_synthesizer.h"
 #include "xls/fdo/synthesized_delay_diff_utils.h"
 #include "xls/fdo/synthesizer.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
@@ -88,6 +91,11 @@ ABSL_FLAG(int, abs_delay_diff_min_ps, 0,
           "`compare_to_synthesis` must also be true.");
 ABSL_FLAG(std::optional<int>, stage, std::nullopt,
           "Only analyze the specified, zero-based stage of the pipeline.");
+ABSL_FLAG(int64_t, top_critical_paths, 0,
+          "If positive, emit this many of the longest paths (per stage, if "
+          "--schedule_path is given) instead of just the critical path. Uses "
+          "memory bounded by the number of paths rather than the size of the "
+          "function. Not supported with --compare_to_synthesis.");
 ABSL_FLAG(std::optional<std::string>, proto_out, std::nullopt,
           "File to write a binary xls.DelayInfoProto to containing delay info "
           "of the input.");
@@ -95,6 +103,50 @@ ABSL_FLAG(std::optional<std::string>, proto_out, std::nullopt,
 namespace xls::tools {
 namespace {
 
+// Prints the --top_critical_paths longest paths of `top`, per stage of
+// `schedule` if given, recording the longest of each in `delay_proto`.
+absl::Status EmitTopCriticalPaths(FunctionBase* top,
+                                  const DelayEstimator& delay_estimator,
+                                  const PipelineSchedule* schedule,
+                                  std::optional<int> requested_stage,
+                                  std::optional<DelayInfoProto>& delay_proto) {
+  std::optional<std::function<int64_t(Node*)>> node_stage;
+  if (schedule != nullptr) {
+    node_stage = [&](Node* node) { return schedule->cycle(node); };
+  }
+  std::optional<int64_t> last_stage;
+  int64_t path_index = 0;
+  return AnalyzeTopCriticalPaths(
+      top, absl::GetFlag(FLAGS_top_critical_paths), delay_estimator,
+      [&](int64_t stage,
+          absl::Span<const CriticalPathEntry> critical_path) -> absl::Status {
+        if (requested_stage.has_value() && stage != *requested_stage) {
+          return absl::OkStatus();
+        }
+        path_index = stage == last_stage ? path_index + 1 : 0;
+        last_stage = stage;
+        if (schedule == nullptr) {
+          std::cout << absl::StreamFormat("# Critical path %d:\n", path_index);
+        } else {
+          std::cout << absl::StreamFormat(
+              "# Critical path %d for stage %d:\n", path_index, stage);
+        }
+        std::cout << CriticalPathToString(critical_path) << "\n";
+        if (delay_proto && path_index == 0) {
+          if (schedule == nullptr) {
+            *delay_proto->mutable_combinational_critical_path() =
+                CriticalPathToProto(critical_path);
+          } else {
+            delay_proto->mutable_pipelined_critical_path()
+                ->mutable_stage()
+                ->emplace(stage, CriticalPathToProto(critical_path));
+          }
+        }
+        return absl::OkStatus();
+      },
+      node_stage);
+}
+
 absl::Status RealMain(std::string_view input_path) {
   if (input_path == "-") {
     input_path = "/dev/stdin";
@@ -130,7 +182,23 @@ absl::Status RealMain(std::string_view input_path) {
     delay_proto.emplace();
   }
   std::optional<synthesis::SynthesizedDelayDiff> total_diff;
-  if (absl::GetFlag(FLAGS_schedule_path).empty()) {
+  if (absl::GetFlag(FLAGS_top_critical_paths) > 0) {
+    if (synthesizer) {
+      return absl::InvalidArgumentError(
+          "--top_critical_paths is not supported with --compare_to_synthesis.");
+    }
+    std::optional<PipelineSchedule> schedule;
+    if (!absl::GetFlag(FLAGS_schedule_path).empty()) {
+      XLS_ASSIGN_OR_RETURN(PackagePipelineSchedulesProto proto,
+                           ParseTextProtoFile<PackagePipelineSchedulesProto>(
+                               absl::GetFlag(FLAGS_schedule_path)));
+      XLS_ASSIGN_OR_RETURN(schedule, PipelineSchedule::FromProto(top, proto));
+      XLS_RETURN_IF_ERROR(schedule->Verify());
+    }
+    XLS_RETURN_IF_ERROR(EmitTopCriticalPaths(
+        top, *delay_estimator, schedule.has_value() ? &*schedule : nullptr,
+        absl::GetFlag(FLAGS_stage), delay_proto));
+  } else if (absl::GetFlag(FLAGS_schedule_path).empty()) {
     XLS_ASSIGN_OR_RETURN(
         std::vector<CriticalPathEntry> critical_path,
         AnalyzeCriticalPath(top, /*clock_period_ps=*/std::nullopt,
@@ -99,6 +99,37 @@ not_sum         :     1ps
         optimized_ir,
     )
 
+  def test_top_critical_paths(self):
+    """Test tool with --top_critical_paths, with and without a schedule."""
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    schedule_file = self.create_tempfile(content=NOT_ADD_SCHEDULE)
+
+    output = subprocess.check_output([
+        DELAY_INFO_MAIN_PATH,
+        '--delay_model=unit',
+        '--top_critical_paths=3',
+        ir_file.full_path,
+    ]).decode('utf-8')
+    # Both paths run through `sum` and `not_sum`, from `x` and from `y`.
+    self.assertIn('# Critical path 0:', output)
+    self.assertIn('# Critical path 1:', output)
+    self.assertNotIn('# Critical path 2:', output)
+    self.assertEqual(output.count('2ps (+  1ps): not_sum'), 2)
+
+    output = subprocess.check_output([
+        DELAY_INFO_MAIN_PATH,
+        '--delay_model=unit',
+        '--top_critical_paths=3',
+        f'--schedule_path={schedule_file.full_path}',
+        ir_file.full_path,
+    ]).decode('utf-8')
+    # Paths don't cross stages, so the parameters each end a path in stage 0.
+    self.assertIn('# Critical path 1 for stage 0', output)
+    self.assertNotIn('# Critical path 2 for stage 0', output)
+    self.assertIn('# Critical path 0 for stage 1', output)
+    self.assertNotIn('# Critical path 1 for stage 1', output)
+    self.assertIn('1ps (+  1ps): sum: bits[32] = add', output)
+
 
 if __name__ == '__main__':
   test_base.main()
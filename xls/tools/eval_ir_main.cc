@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -65,8 +66,11 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/memory_usage.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -86,16 +90,20 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/streaming_ir_parser.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/observer.h"
+#include "xls/jit/orc_jit.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
 #include "xls/tools/node_coverage_utils.h"
+#include "xls/tools/value_file.h"
 
 static constexpr std::string_view kUsage = R"(
 Evaluates an IR file with user-specified or random inputs using the IR
@@ -141,6 +149,16 @@ Evaluate IR after every optimization pass:
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
+
+As above, but sharding the evaluation of the inputs across 8 threads:
+
+   eval_ir_main --test_llvm_jit --random_inputs=100 --threads=8 IR_FILE
+
+Evaluate a large file of inputs a chunk at a time, writing the results to a
+file of length-delimited ValueProtos:
+
+   eval_ir_main --streaming --input_file=INPUTS --output_file=RESULTS \
+      --value_file_format=binary_proto IR_FILE
 )";
 
 // LINT.IfChange
@@ -178,6 +196,34 @@ ABSL_FLAG(bool, test_llvm_jit, false,
 ABSL_FLAG(int64_t, llvm_opt_level, 3,
           "The optimization level of the LLVM JIT. Valid values are from 0 (no "
           "optimizations) to 3 (maximum optimizations).");
+ABSL_FLAG(bool, streaming, false,
+          "Read, evaluate and write the inputs of --input_file in chunks "
+          "rather than reading the whole file first, so memory use does not "
+          "depend on the number of inputs. Reading the next chunk and writing "
+          "the results of the previous one overlap with evaluation. With "
+          "--test_llvm_jit the interpreter and JIT results are written chunk "
+          "by chunk. Cannot be specified with --optimize_ir.");
+ABSL_FLAG(std::string, value_file_format, "text",
+          "Format of --input_file, --expected_file and --output_file: 'text' "
+          "or 'binary_proto' (see xls/tools/value_file.h). In binary input "
+          "files each record is a tuple of the arguments of one invocation.");
+ABSL_FLAG(std::string, output_file, "",
+          "With --streaming, the file to write results to, in the format given "
+          "by --value_file_format. Results are printed to stdout otherwise.");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory in which compiled JIT objects are cached "
+          "across invocations. Compilation of unchanged IR is skipped on a "
+          "cache hit.");
+ABSL_FLAG(bool, jit_lazy_compilation, false,
+          "If true, each jitted function is compiled the first time it is "
+          "called rather than up front. Speeds up startup for large packages "
+          "of which only some functions are exercised, at the cost of no "
+          "inlining across functions.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads across which to shard evaluation of the inputs. "
+          "Each thread evaluates a contiguous range of the inputs with its own "
+          "JIT instance sharing the compiled code. Results are printed, and "
+          "node coverage is recorded, as if evaluated on a single thread.");
 ABSL_FLAG(std::string, input_validator_expr, "",
           "DSLX expression to validate randomly-generated inputs. "
           "The expression can reference entry function input arguments "
@@ -358,71 +404,187 @@ absl::StatusOr<InterpreterResult<Value>> RunLlvmInterpreter(
   return InterpreterResult<Value>{std::move(result_value), std::move(events)};
 }
 
-// Evaluates the function with the given ArgSets. Returns an error if the result
-// does not match expectations (if any). 'actual_src' and 'expected_src' are
-// string descriptions of the sources of the actual results and expected
-// results, respectively. These strings are included in error messages.
+// Evaluates the function with the given ArgSets, using `jit` if non-null and
+// the interpreter otherwise, and stores the result of `arg_sets[i]` in
+// `results[i]`.
+absl::Status EvalShard(Function* f, absl::Span<const ArgSet> arg_sets,
+                       FunctionJit* jit,
+                       std::optional<EvaluationObserver*> eval_observer,
+                       absl::Span<absl::StatusOr<Value>> results) {
+  std::optional<RuntimeEvaluationObserverAdapter> adapt;
+  if (jit != nullptr && eval_observer.has_value()) {
+    adapt.emplace(
+        eval_observer.value(),
+        [](int64_t v) -> Node* {
+          return reinterpret_cast<Node*>(static_cast<intptr_t>(v));
+        },
+        jit->runtime());
+    XLS_RETURN_IF_ERROR(jit->SetRuntimeObserver(&adapt.value()));
+  }
+  for (int64_t i = 0; i < arg_sets.size(); ++i) {
+    if (jit != nullptr) {
+      results[i] = DropInterpreterEvents(jit->Run(arg_sets[i].args));
+    } else {
+      // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
+      // resulting events once the JIT fully supports events. Note: This will
+      // require rethinking some of the control flow because event comparison
+      // only makes sense for certain modes (optimize_ir and test_llvm_jit).
+      results[i] = DropInterpreterEvents(
+          InterpretFunction(f, arg_sets[i].args, eval_observer));
+    }
+  }
+  if (adapt.has_value()) {
+    jit->ClearRuntimeObserver();
+  }
+  return absl::OkStatus();
+}
+
+// As EvalShard, but splits the ArgSets into `thread_count` contiguous shards
+// which are evaluated concurrently. Each thread has its own clone of `jit` and
+// its own coverage observer, which is merged into `coverage` once all threads
+// are done, so the results and coverage do not depend on the thread count.
+absl::StatusOr<std::vector<absl::StatusOr<Value>>> EvalOnThreads(
+    Function* f, absl::Span<const ArgSet> arg_sets, FunctionJit* jit,
+    std::optional<CoverageEvalObserver*> coverage, int64_t thread_count) {
+  std::vector<absl::StatusOr<Value>> results(arg_sets.size());
+  thread_count = std::min<int64_t>(thread_count, arg_sets.size());
+  if (thread_count <= 1) {
+    XLS_RETURN_IF_ERROR(
+        EvalShard(f, arg_sets, jit, coverage, absl::MakeSpan(results)));
+    return results;
+  }
+
+  struct Worker {
+    std::unique_ptr<FunctionJit> jit;
+    std::optional<CoverageEvalObserver> coverage;
+    absl::Status status;
+    std::unique_ptr<Thread> thread;
+  };
+  std::vector<Worker> workers(thread_count);
+  const int64_t shard_size =
+      CeilOfRatio<int64_t>(arg_sets.size(), thread_count);
+  for (int64_t w = 0; w < thread_count; ++w) {
+    Worker& worker = workers[w];
+    const int64_t begin = std::min<int64_t>(w * shard_size, arg_sets.size());
+    const int64_t size = std::min<int64_t>(shard_size, arg_sets.size() - begin);
+    if (jit != nullptr) {
+      worker.jit = jit->Clone();
+    }
+    if (coverage.has_value()) {
+      worker.coverage.emplace();
+    }
+    absl::Span<absl::StatusOr<Value>> shard_results =
+        absl::MakeSpan(results).subspan(begin, size);
+    worker.thread = std::make_unique<Thread>(
+        [f, &worker, shard = arg_sets.subspan(begin, size), shard_results]() {
+          std::optional<EvaluationObserver*> observer;
+          if (worker.coverage.has_value()) {
+            observer = &worker.coverage.value();
+          }
+          worker.status = EvalShard(f, shard, worker.jit.get(), observer,
+                                    shard_results);
+        });
+  }
+  for (Worker& worker : workers) {
+    worker.thread->Join();
+  }
+  for (Worker& worker : workers) {
+    XLS_RETURN_IF_ERROR(worker.status);
+    if (worker.coverage.has_value()) {
+      XLS_RETURN_IF_ERROR(worker.coverage->Finalize());
+      XLS_RETURN_IF_ERROR(coverage.value()->Merge(*worker.coverage));
+    }
+  }
+  return results;
+}
+
+// A JIT compiled for evaluating a function, along with the observer which
+// captures its optimized LLVM IR for --use_llvm_jit_interpreter.
+struct EvalJit {
+  EvalIrJitObserver observer{absl::GetFlag(FLAGS_use_llvm_jit_interpreter)};
+  std::unique_ptr<FunctionJit> jit;
+};
+
+// Returns a JIT for `f` if `use_jit` is set, and nullptr otherwise.
+// `observed` indicates whether the JIT is used with a coverage observer.
+absl::StatusOr<std::unique_ptr<EvalJit>> MaybeCreateJit(Function* f,
+                                                        bool use_jit,
+                                                        bool observed) {
+  if (!use_jit) {
+    return nullptr;
+  }
+  auto result = std::make_unique<EvalJit>();
+  // No support for procs yet.
+  XLS_ASSIGN_OR_RETURN(
+      result->jit,
+      FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                          /*include_observer_callbacks=*/observed,
+                          &result->observer));
+  EndMemoryStage("jit_compile");
+  return result;
+}
+
+// Where Eval emits its results.
+struct EvalOutput {
+  // The index of the first of the ArgSets among all of the inputs, used in
+  // error messages.
+  int64_t first_input_index = 0;
+  // If non-null, results are appended here for the caller to write rather than
+  // being printed.
+  std::vector<Value>* results = nullptr;
+};
+
+// Evaluates the function with the given ArgSets, using `jit` if non-null and
+// the interpreter otherwise. Returns an error if the result does not match
+// expectations (if any). 'actual_src' and 'expected_src' are string
+// descriptions of the sources of the actual results and expected results,
+// respectively. These strings are included in error messages.
 absl::StatusOr<std::vector<Value>> Eval(
-    Function* f, absl::Span<const ArgSet> arg_sets, bool use_jit,
-    std::optional<EvaluationObserver*> eval_observer = std::nullopt,
+    Function* f, absl::Span<const ArgSet> arg_sets, EvalJit* jit,
+    std::optional<CoverageEvalObserver*> eval_observer = std::nullopt,
     std::string_view actual_src = "actual",
-    std::string_view expected_src = "expected") {
-  EvalIrJitObserver observer(absl::GetFlag(FLAGS_use_llvm_jit_interpreter));
-  std::unique_ptr<FunctionJit> jit;
-  if (use_jit) {
-    // No support for procs yet.
+    std::string_view expected_src = "expected", EvalOutput output = {}) {
+  // Everything but the LLVM interpreter and injected JIT results is evaluated
+  // up front, possibly on several threads.
+  const bool evaluate_up_front =
+      jit == nullptr ||
+      (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty() &&
+       !absl::GetFlag(FLAGS_use_llvm_jit_interpreter));
+  std::vector<absl::StatusOr<Value>> evaluated;
+  if (evaluate_up_front) {
     XLS_ASSIGN_OR_RETURN(
-        jit, FunctionJit::Create(
-                 f, absl::GetFlag(FLAGS_llvm_opt_level),
-                 /*include_observer_callbacks=*/eval_observer.has_value(),
-                 &observer));
+        evaluated,
+        EvalOnThreads(f, arg_sets, jit == nullptr ? nullptr : jit->jit.get(),
+                      eval_observer, absl::GetFlag(FLAGS_threads)));
   }
 
   std::vector<Value> results;
   for (const ArgSet& arg_set : arg_sets) {
     Value result;
-    if (use_jit) {
-      if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-        if (absl::GetFlag(FLAGS_use_llvm_jit_interpreter)) {
-          XLS_RET_CHECK(!eval_observer)
-              << "Observer not supported with llvm interpreter.";
-          XLS_ASSIGN_OR_RETURN(
-              result, DropInterpreterEvents(RunLlvmInterpreter(
-                          observer.saved_opt_ir(), jit.get(), arg_set.args)));
-        } else {
-          std::optional<RuntimeEvaluationObserverAdapter> adapt;
-          if (eval_observer) {
-            adapt.emplace(
-                eval_observer.value(),
-                [](int64_t v) -> Node* {
-                  return reinterpret_cast<Node*>(static_cast<intptr_t>(v));
-                },
-                jit->runtime());
-            XLS_RETURN_IF_ERROR(jit->SetRuntimeObserver(&adapt.value()));
-          }
-          XLS_ASSIGN_OR_RETURN(result,
-                               DropInterpreterEvents(jit->Run(arg_set.args)));
-          jit->ClearRuntimeObserver();
-        }
-      } else {
-        XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
-                                         FLAGS_test_only_inject_jit_result)));
-      }
+    if (evaluate_up_front) {
+      XLS_ASSIGN_OR_RETURN(result, std::move(evaluated[results.size()]));
+    } else if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+      XLS_RET_CHECK(!eval_observer)
+          << "Observer not supported with llvm interpreter.";
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(RunLlvmInterpreter(
+                                       jit->observer.saved_opt_ir(),
+                                       jit->jit.get(), arg_set.args)));
     } else {
-      // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
-      // resulting events once the JIT fully supports events. Note: This will
-      // require rethinking some of the control flow because event comparison
-      // only makes sense for certain modes (optimize_ir and test_llvm_jit).
-      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(InterpretFunction(
-                                       f, arg_set.args, eval_observer)));
+      XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
+                                       FLAGS_test_only_inject_jit_result)));
+    }
+    if (output.results != nullptr) {
+      output.results->push_back(result);
+    } else {
+      std::cout << result.ToString(FormatPreference::kHex) << '\n';
     }
-    std::cout << result.ToString(FormatPreference::kHex) << '\n';
 
     if (arg_set.expected.has_value()) {
       if (result != *arg_set.expected) {
         return absl::InvalidArgumentError(absl::StrFormat(
             "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
-            results.size(), ArgsToString(arg_set.args), actual_src,
+            output.first_input_index + results.size(),
+            ArgsToString(arg_set.args), actual_src,
             result.ToString(FormatPreference::kHex), expected_src,
             arg_set.expected->ToString(FormatPreference::kHex)));
       }
@@ -432,6 +594,24 @@ absl::StatusOr<std::vector<Value>> Eval(
   return results;
 }
 
+// Evaluates the ArgSets, which must not have expected values, with the
+// interpreter and then checks that `jit` produces the same results.
+absl::Status TestJit(Function* f, absl::Span<ArgSet> arg_sets, EvalJit& jit,
+                     std::optional<CoverageEvalObserver*> coverage,
+                     EvalOutput output = {}) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> interpreter_results,
+                       Eval(f, arg_sets, /*jit=*/nullptr,
+                            /*eval_observer=*/std::nullopt, "actual",
+                            "expected", output));
+  for (int64_t i = 0; i < arg_sets.size(); ++i) {
+    QCHECK(!arg_sets[i].expected.has_value())
+        << "Cannot specify expected values when using --test_llvm_jit";
+    arg_sets[i].expected = interpreter_results[i];
+  }
+  return Eval(f, arg_sets, &jit, coverage, "JIT", "interpreter", output)
+      .status();
+}
+
 // An invariant checker which evaluates the entry function with the given
 // ArgSets. Raises an error if expectations are not matched.
 class EvalInvariantChecker : public OptimizationInvariantChecker {
@@ -447,7 +627,9 @@ class EvalInvariantChecker : public OptimizationInvariantChecker {
                 << results->invocations.back().pass_name << "\n";
     }
     XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
-    XLS_RETURN_IF_ERROR(Eval(f, arg_sets_, use_jit_,
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<EvalJit> jit,
+                         MaybeCreateJit(f, use_jit_, /*observed=*/false));
+    XLS_RETURN_IF_ERROR(Eval(f, arg_sets_, jit.get(),
                              // Runs between passes don't give useful coverage
                              // information.
                              /*eval_observer=*/std::nullopt,
@@ -480,28 +662,21 @@ absl::Status Run(Package* package, absl::Span<const ArgSet> arg_sets_in) {
   if (absl::GetFlag(FLAGS_test_llvm_jit)) {
     QCHECK(!absl::GetFlag(FLAGS_optimize_ir))
         << "Cannot specify both --test_llvm_jit and --optimize_ir";
-    XLS_ASSIGN_OR_RETURN(
-        std::vector<Value> interpreter_results,
-        Eval(f, arg_sets, /*use_jit=*/false, /*eval_observer=*/std::nullopt));
-    for (int64_t i = 0; i < arg_sets.size(); ++i) {
-      QCHECK(!arg_sets[i].expected.has_value())
-          << "Cannot specify expected values when using --test_llvm_jit";
-      arg_sets[i].expected = interpreter_results[i];
-    }
-    XLS_RETURN_IF_ERROR(Eval(f, arg_sets, /*use_jit=*/true,
-                             /*eval_observer=*/cov.observer(), "JIT",
-                             "interpreter")
-                            .status());
-    return absl::OkStatus();
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<EvalJit> jit,
+                         MaybeCreateJit(f, /*use_jit=*/true,
+                                        cov.observer().has_value()));
+    return TestJit(f, absl::MakeSpan(arg_sets), *jit, cov.observer());
   }
 
   // Run the argsets through the IR before any optimizations. Write in the
   // results as the expected values if the expected value is not already
   // set. These expected values are used in any later evaluation after
   // optimizations.
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<Value> results,
-      Eval(f, arg_sets, absl::GetFlag(FLAGS_use_llvm_jit), cov.observer()));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<EvalJit> jit,
+                       MaybeCreateJit(f, absl::GetFlag(FLAGS_use_llvm_jit),
+                                      cov.observer().has_value()));
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> results,
+                       Eval(f, arg_sets, jit.get(), cov.observer()));
   for (int64_t i = 0; i < arg_sets.size(); ++i) {
     if (!arg_sets[i].expected.has_value()) {
       arg_sets[i].expected = results[i];
@@ -522,9 +697,11 @@ absl::Status Run(Package* package, absl::Span<const ArgSet> arg_sets_in) {
     XLS_RETURN_IF_ERROR(
         pipeline->Run(package, OptimizationPassOptions(), &results).status());
 
-    XLS_RETURN_IF_ERROR(Eval(f, arg_sets, absl::GetFlag(FLAGS_use_llvm_jit),
-                             cov.observer(), "after optimizations",
-                             "before optimizations")
+    XLS_ASSIGN_OR_RETURN(jit,
+                         MaybeCreateJit(f, absl::GetFlag(FLAGS_use_llvm_jit),
+                                        cov.observer().has_value()));
+    XLS_RETURN_IF_ERROR(Eval(f, arg_sets, jit.get(), cov.observer(),
+                             "after optimizations", "before optimizations")
                             .status());
   } else {
     XLS_RET_CHECK(!absl::GetFlag(FLAGS_eval_after_each_pass))
@@ -544,6 +721,150 @@ absl::StatusOr<ArgSet> ArgSetFromString(std::string_view args_string) {
   return arg_set;
 }
 
+// Returns the next ArgSet of `inputs`, or std::nullopt at its end. Records of
+// text files are semicolon-separated lists of arguments and those of binary
+// files are tuples of the arguments.
+absl::StatusOr<std::optional<ArgSet>> NextArgSet(ValueFileReader& inputs) {
+  if (inputs.format() == ValueFileFormat::kText) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> line, inputs.NextLine());
+    if (!line.has_value()) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(ArgSet arg_set, ArgSetFromString(*line),
+                         _ << "Invalid line in input file: " << *line);
+    return arg_set;
+  }
+  XLS_ASSIGN_OR_RETURN(std::optional<Value> record, inputs.Next());
+  if (!record.has_value()) {
+    return std::nullopt;
+  }
+  XLS_RET_CHECK(record->IsTuple())
+      << "Binary input records must be tuples of arguments, got: " << *record;
+  return ArgSet{.args = std::vector<Value>(record->elements().begin(),
+                                           record->elements().end())};
+}
+
+// The number of ArgSets held in memory at a time with --streaming.
+constexpr int64_t kStreamingChunkSize = 4096;
+
+// Reads the next chunk of at most kStreamingChunkSize ArgSets from `inputs`,
+// taking their expected values from `expected_file` if non-null.
+absl::StatusOr<std::vector<ArgSet>> ReadChunk(
+    ValueFileReader& inputs, ValueFileReader* expected_file,
+    const std::optional<Value>& expected) {
+  std::vector<ArgSet> chunk;
+  while (chunk.size() < kStreamingChunkSize) {
+    XLS_ASSIGN_OR_RETURN(std::optional<ArgSet> arg_set, NextArgSet(inputs));
+    if (!arg_set.has_value()) {
+      break;
+    }
+    arg_set->expected = expected;
+    if (expected_file != nullptr) {
+      XLS_ASSIGN_OR_RETURN(arg_set->expected, expected_file->Next());
+      if (!arg_set->expected.has_value()) {
+        return absl::InvalidArgumentError(
+            "Number of values in expected file does not match the number of "
+            "inputs.");
+      }
+    }
+    chunk.push_back(*std::move(arg_set));
+  }
+  if (chunk.empty() && expected_file != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Value> extra, expected_file->Next());
+    if (extra.has_value()) {
+      return absl::InvalidArgumentError(
+          "Number of values in expected file does not match the number of "
+          "inputs.");
+    }
+  }
+  return chunk;
+}
+
+absl::Status WriteValues(ValueFileWriter& writer,
+                         absl::Span<const Value> values) {
+  for (const Value& value : values) {
+    XLS_RETURN_IF_ERROR(writer.Write(value));
+  }
+  return absl::OkStatus();
+}
+
+// Evaluates the ArgSets of `inputs` as Run does without --optimize_ir, but a
+// chunk at a time. While a chunk is evaluated the next one is read and parsed,
+// and the results of the previous one are formatted and written, on separate
+// threads.
+absl::Status RunStreaming(Function* f, ValueFileReader& inputs) {
+  XLS_ASSIGN_OR_RETURN(
+      ValueFileFormat format,
+      ValueFileFormatFromString(absl::GetFlag(FLAGS_value_file_format)));
+  std::optional<Value> expected;
+  if (!absl::GetFlag(FLAGS_expected).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        expected, Parser::ParseTypedValue(absl::GetFlag(FLAGS_expected)));
+  }
+  std::unique_ptr<ValueFileReader> expected_file;
+  if (!absl::GetFlag(FLAGS_expected_file).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        expected_file,
+        ValueFileReader::Open(absl::GetFlag(FLAGS_expected_file), format));
+  }
+  std::string output_path = absl::GetFlag(FLAGS_output_file);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ValueFileWriter> writer,
+      ValueFileWriter::Open(output_path.empty() ? "-" : output_path, format));
+
+  ScopedRecordNodeCoverage cov(
+      absl::GetFlag(FLAGS_output_node_coverage_stats_proto),
+      absl::GetFlag(FLAGS_output_node_coverage_stats_textproto));
+  const bool test_jit = absl::GetFlag(FLAGS_test_llvm_jit);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<EvalJit> jit,
+      MaybeCreateJit(f, test_jit || absl::GetFlag(FLAGS_use_llvm_jit),
+                     cov.observer().has_value()));
+
+  XLS_ASSIGN_OR_RETURN(std::vector<ArgSet> chunk,
+                       ReadChunk(inputs, expected_file.get(), expected));
+  std::vector<Value> previous_results;
+  int64_t first_input_index = 0;
+  while (!chunk.empty()) {
+    absl::StatusOr<std::vector<ArgSet>> next_chunk;
+    absl::Status write_status;
+    std::vector<Value> results;
+    absl::Status eval_status;
+    {
+      auto reader_thread = std::make_unique<Thread>([&]() {
+        next_chunk = ReadChunk(inputs, expected_file.get(), expected);
+      });
+      auto writer_thread = std::make_unique<Thread>(
+          [&]() { write_status = WriteValues(*writer, previous_results); });
+      EvalOutput output{.first_input_index = first_input_index,
+                        .results = &results};
+      if (test_jit) {
+        eval_status = TestJit(f, absl::MakeSpan(chunk), *jit, cov.observer(),
+                              output);
+      } else {
+        eval_status = Eval(f, chunk, jit.get(), cov.observer(), "actual",
+                           "expected", output)
+                          .status();
+      }
+      reader_thread->Join();
+      writer_thread->Join();
+    }
+    XLS_RETURN_IF_ERROR(write_status);
+    if (!eval_status.ok()) {
+      // Write the results up to the failure, as Eval would have printed them.
+      XLS_RETURN_IF_ERROR(WriteValues(*writer, results));
+      XLS_RETURN_IF_ERROR(writer->Close());
+      return eval_status;
+    }
+    XLS_RETURN_IF_ERROR(next_chunk.status());
+    first_input_index += chunk.size();
+    chunk = *std::move(next_chunk);
+    previous_results = std::move(results);
+  }
+  XLS_RETURN_IF_ERROR(WriteValues(*writer, previous_results));
+  return writer->Close();
+}
+
 // Converts the given DSLX validation function into IR.
 absl::StatusOr<std::unique_ptr<Package>> ConvertValidator(
     Function* f, std::string_view dslx_stdlib_path,
@@ -631,13 +952,21 @@ absl::Status RealMain(std::string_view input_path,
   if (input_path == "-") {
     input_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents, input_path));
-  if (!absl::GetFlag(FLAGS_top).empty()) {
-    XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
-  }
+  // Only the top function and the functions it calls are parsed.
+  std::string top = absl::GetFlag(FLAGS_top);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      ReadPackageFileForEntity(
+          input_path, top.empty() ? std::nullopt
+                                  : std::make_optional<std::string_view>(top)));
+  EndMemoryStage("parse");
   XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  XLS_ASSIGN_OR_RETURN(
+      ValueFileFormat format,
+      ValueFileFormatFromString(absl::GetFlag(FLAGS_value_file_format)));
+  QCHECK(!absl::GetFlag(FLAGS_streaming) ||
+         !absl::GetFlag(FLAGS_input_file).empty())
+      << "--streaming requires --input_file";
 
   std::vector<ArgSet> arg_sets;
   if (!absl::GetFlag(FLAGS_input).empty()) {
@@ -654,16 +983,22 @@ absl::Status RealMain(std::string_view input_path,
   } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
     QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Cannot specify both --input_file and --random_inputs";
-    absl::StatusOr<std::string> args_input_file =
-        GetFileContents(absl::GetFlag(FLAGS_input_file));
-    QCHECK_OK(args_input_file.status());
-    for (const auto& arg_line : absl::StrSplit(args_input_file.value(), '\n',
-                                               absl::SkipWhitespace())) {
-      absl::StatusOr<ArgSet> arg_set_status = ArgSetFromString(arg_line);
-      QCHECK_OK(arg_set_status.status())
-          << absl::StreamFormat("Invalid line in input file %s: %s",
-                                absl::GetFlag(FLAGS_input_file), arg_line);
-      arg_sets.push_back(arg_set_status.value());
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ValueFileReader> inputs,
+        ValueFileReader::Open(absl::GetFlag(FLAGS_input_file), format));
+    if (absl::GetFlag(FLAGS_streaming)) {
+      XLS_RETURN_IF_ERROR(RunStreaming(f, *inputs));
+      EndMemoryStage("evaluate");
+      return WriteProcessMemoryProfile();
+    }
+    while (true) {
+      absl::StatusOr<std::optional<ArgSet>> arg_set = NextArgSet(*inputs);
+      QCHECK_OK(arg_set.status()) << absl::StreamFormat(
+          "Invalid record in input file %s", absl::GetFlag(FLAGS_input_file));
+      if (!arg_set->has_value()) {
+        break;
+      }
+      arg_sets.push_back(**std::move(arg_set));
     }
   } else {
     QCHECK_NE(absl::GetFlag(FLAGS_random_inputs), 0)
@@ -706,18 +1041,19 @@ absl::Status RealMain(std::string_view input_path,
       arg_set.expected = expected_status.value();
     }
   } else if (!absl::GetFlag(FLAGS_expected_file).empty()) {
-    absl::StatusOr<std::string> expected_file =
-        GetFileContents(absl::GetFlag(FLAGS_expected_file));
-    QCHECK_OK(expected_file.status());
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ValueFileReader> expected_file,
+        ValueFileReader::Open(absl::GetFlag(FLAGS_expected_file), format));
     std::vector<Value> expecteds;
-    for (const auto& expected_line :
-         absl::StrSplit(expected_file.value(), '\n', absl::SkipWhitespace())) {
-      absl::StatusOr<Value> expected_status =
-          Parser::ParseTypedValue(expected_line);
-      QCHECK_OK(expected_status.status())
-          << absl::StreamFormat("Failed to parse line in expected file %s: %s",
-                                expected_line, expected_line);
-      expecteds.push_back(expected_status.value());
+    while (true) {
+      absl::StatusOr<std::optional<Value>> expected = expected_file->Next();
+      QCHECK_OK(expected.status())
+          << absl::StreamFormat("Failed to parse record in expected file %s",
+                                absl::GetFlag(FLAGS_expected_file));
+      if (!expected->has_value()) {
+        break;
+      }
+      expecteds.push_back(**std::move(expected));
     }
     QCHECK_EQ(expecteds.size(), arg_sets.size())
         << "Number of values in expected file does not match the number of "
@@ -727,7 +1063,9 @@ absl::Status RealMain(std::string_view input_path,
     }
   }
 
-  return Run(package.get(), arg_sets);
+  XLS_RETURN_IF_ERROR(Run(package.get(), arg_sets));
+  EndMemoryStage("evaluate");
+  return WriteProcessMemoryProfile();
 }
 
 }  // namespace
@@ -740,10 +1078,21 @@ int main(int argc, char** argv) {
     LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
                                       argv[0]);
   }
+  QCHECK_GE(absl::GetFlag(FLAGS_threads), 1) << "--threads must be positive";
+  QCHECK(absl::GetFlag(FLAGS_output_file).empty() ||
+         absl::GetFlag(FLAGS_streaming))
+      << "--output_file requires --streaming";
+  QCHECK(!absl::GetFlag(FLAGS_streaming) || !absl::GetFlag(FLAGS_optimize_ir))
+      << "Cannot specify both --streaming and --optimize_ir";
   QCHECK(absl::GetFlag(FLAGS_input_validator_expr).empty() ||
          absl::GetFlag(FLAGS_input_validator_path).empty())
       << "At most one one of 'input_validator' or 'input_validator_path' may "
          "be specified.";
+  if (!absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    xls::SetJitObjectCacheDirectory(
+        std::filesystem::path(absl::GetFlag(FLAGS_jit_object_cache_dir)));
+  }
+  xls::SetJitLazyCompilation(absl::GetFlag(FLAGS_jit_lazy_compilation));
   std::string dslx_stdlib_path = absl::GetFlag(FLAGS_dslx_stdlib_path);
 
   std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
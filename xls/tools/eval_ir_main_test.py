@@ -54,6 +54,39 @@ def _value_32_bits(v: int) -> xls_value_pb2.ValueProto:
   )
 
 
+def _delimited(*protos: xls_value_pb2.ValueProto) -> bytes:
+  """Returns the protos as a sequence of length-delimited records."""
+  result = bytearray()
+  for proto in protos:
+    data = proto.SerializeToString()
+    size = len(data)
+    while size >= 0x80:
+      result.append((size & 0x7F) | 0x80)
+      size >>= 7
+    result.append(size)
+    result += data
+  return bytes(result)
+
+
+def _parse_delimited(data: bytes) -> list[xls_value_pb2.ValueProto]:
+  """Returns the protos of a sequence of length-delimited records."""
+  protos = []
+  pos = 0
+  while pos < len(data):
+    size = 0
+    shift = 0
+    while True:
+      byte = data[pos]
+      pos += 1
+      size |= (byte & 0x7F) << shift
+      shift += 7
+      if byte < 0x80:
+        break
+    protos.append(xls_value_pb2.ValueProto.FromString(data[pos : pos + size]))
+    pos += size
+  return protos
+
+
 def parameterized_proc_backends(func):
   return parameterized.named_parameters(
       ('jit', ['--use_llvm_jit']),
@@ -165,6 +198,93 @@ class EvalMainTest(parameterized.TestCase):
         results.decode('utf-8').strip().split('\n'),
     )
 
+  def test_streaming_input_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(
+            ('bits[32]:0x42; bits[32]:0x123', 'bits[32]:0x10; bits[32]:0xf0f')
+        )
+    )
+    results = subprocess.check_output([
+        EVAL_IR_MAIN_PATH,
+        '--streaming',
+        '--input_file=' + input_file.full_path,
+        ir_file.full_path,
+    ])
+    self.assertSequenceEqual(
+        ('bits[32]:0x165', 'bits[32]:0xf1f'),
+        results.decode('utf-8').strip().split('\n'),
+    )
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            '--streaming',
+            '--test_llvm_jit',
+            '--input_file=' + input_file.full_path,
+            ir_file.full_path,
+        ],
+        check=False,
+    )
+    self.assertEqual(comp.returncode, 0)
+
+  def test_streaming_failed_expected_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(
+            ('bits[32]:0x42; bits[32]:0x123', 'bits[32]:0x10; bits[32]:0x00')
+        )
+    )
+    expected_file = self.create_tempfile(
+        content='\n'.join(('bits[32]:0x165', 'bits[32]:0xf1f'))
+    )
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            '--streaming',
+            '--input_file=' + input_file.full_path,
+            '--expected_file=' + expected_file.full_path,
+            ir_file.full_path,
+        ],
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn(
+        'Miscompare for input[1] "bits[32]:0x10; bits[32]:0x0"',
+        comp.stderr.decode('utf-8'),
+    )
+
+  def test_streaming_binary_files(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content=_delimited(
+            xls_value_pb2.ValueProto(
+                tuple=xls_value_pb2.ValueProto.Tuple(
+                    elements=[_value_32_bits(0x42), _value_32_bits(0x123)]
+                )
+            ),
+            xls_value_pb2.ValueProto(
+                tuple=xls_value_pb2.ValueProto.Tuple(
+                    elements=[_value_32_bits(0x10), _value_32_bits(0xF0F)]
+                )
+            ),
+        ),
+        mode='wb',
+    )
+    output_file = self.create_tempfile()
+    subprocess.check_call([
+        EVAL_IR_MAIN_PATH,
+        '--streaming',
+        '--value_file_format=binary_proto',
+        '--input_file=' + input_file.full_path,
+        '--output_file=' + output_file.full_path,
+        ir_file.full_path,
+    ])
+    self.assertSequenceEqual(
+        _parse_delimited(output_file.read_bytes()),
+        [_value_32_bits(0x165), _value_32_bits(0xF1F)],
+    )
+
   def test_input_file_extra_whitespace(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     # Empty lines and extra whitespace in the arg file should be ignored.
@@ -307,6 +427,35 @@ class EvalMainTest(parameterized.TestCase):
         comp.stderr.decode('utf-8'),
     )
 
+  def test_threads_match_single_thread(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    single = subprocess.check_output(
+        [EVAL_IR_MAIN_PATH, '--random_inputs=100', ir_file.full_path]
+    )
+    for backend in ('--use_llvm_jit=true', '--use_llvm_jit=false'):
+      threaded = subprocess.check_output([
+          EVAL_IR_MAIN_PATH,
+          '--random_inputs=100',
+          '--threads=4',
+          backend,
+          ir_file.full_path,
+      ])
+      self.assertEqual(threaded, single)
+
+  def test_test_llvm_jit_with_threads(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run(
+        [
+            EVAL_IR_MAIN_PATH,
+            '--random_inputs=100',
+            '--test_llvm_jit',
+            '--threads=4',
+            ir_file.full_path,
+        ],
+        check=False,
+    )
+    self.assertEqual(comp.returncode, 0)
+
   def test_validator(self):
     # We want to ensure that the output is negative and odd, so the inputs
     # must have different signs and must both be odd.
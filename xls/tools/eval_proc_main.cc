@@ -14,10 +14,17 @@
 
 // Tool to evaluate the behavior of a Proc network.
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <deque>
+#include <filesystem>  // NOLINT
 #include <iostream>
 #include <iterator>
 #include <memory>
@@ -51,8 +58,12 @@
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/file_descriptor.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/memory_usage.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/error_code_to_status.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/tool_timeout.h"
@@ -61,7 +72,11 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/binary_package.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
@@ -77,10 +92,13 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/block_jit.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
 #include "xls/tools/eval_utils.h"
 #include "xls/tools/node_coverage_utils.h"
+#include "xls/tools/value_file.h"
 
 static constexpr std::string_view kUsage = R"(
 Evaluates an IR file containing Procs, or a Block generated from them.
@@ -104,9 +122,26 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * parallel_jit: JIT-backed runtime which ticks procs on a pool of "
+          "worker threads.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.\n"
           " * block_jit: JIT-backed block execution generated from a proc.");
+ABSL_FLAG(int64_t, parallel_threads, 0,
+          "Number of worker threads used by the parallel_jit backend. Zero "
+          "means use the number of available CPUs.");
+ABSL_FLAG(bool, deterministic_parallel, false,
+          "If true the parallel_jit backend ticks procs in the same order as "
+          "serial_jit. Channel traces then match serial_jit exactly.");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory in which compiled JIT objects are cached "
+          "across invocations. Compilation of unchanged IR is skipped on a "
+          "cache hit.");
+ABSL_FLAG(bool, jit_lazy_compilation, false,
+          "If true, each jitted function is compiled the first time it is "
+          "called rather than up front. Speeds up startup for large packages "
+          "of which only some functions are exercised, at the cost of no "
+          "inlining across functions.");
 ABSL_FLAG(std::string, block_signature_proto, "",
           "Path to textproto file containing signature from codegen");
 ABSL_FLAG(int64_t, max_cycles_no_output, 100,
@@ -125,6 +160,13 @@ ABSL_FLAG(
     "For procs, when 'expected_outputs_for_channels' or "
     "'expected_outputs_for_all_channels' are not specified the values of all "
     "the channel are displayed on stdout.");
+ABSL_FLAG(
+    std::string, channel_values_file_format, "text",
+    "Format of the files given in 'inputs_for_channels' and "
+    "'expected_outputs_for_channels': 'text' for one XLS Value in "
+    "human-readable form per line, or 'binary_proto' for a sequence of "
+    "length-delimited ValueProto records. Values are read one at a time, and "
+    "no more are read than can be consumed in the requested ticks.");
 ABSL_FLAG(
     std::string, inputs_for_all_channels, "",
     "Path to file containing inputs for all channels.\n"
@@ -177,9 +219,28 @@ ABSL_FLAG(std::vector<std::string>, model_memories, {},
           "Comma separated list of memory=depth/element_type:initial_value "
           "pairs, for example: "
           "mem=32/bits[32]:0");
+ABSL_FLAG(std::vector<std::string>, model_memory_images, {},
+          "Comma separated list of memory=file pairs initializing memories "
+          "given in --model_memories from raw images. Cell i of a memory of "
+          "width w occupies bytes [i * ceil(w / 8), (i + 1) * ceil(w / 8)) of "
+          "the file in little-endian order; cells beyond the end of the file "
+          "keep the initial value.");
 ABSL_FLAG(bool, fail_on_assert, false,
           "When set to true, the simulation fails on the activation or cycle "
           "in which an assertion fires.");
+ABSL_FLAG(std::optional<std::string>, binary_channel_trace, std::nullopt,
+          "File to write a binary trace of all channel activity to. Much "
+          "cheaper than --trace_channels; use format_channel_trace_main to "
+          "convert it to text. Only supported for procs.");
+ABSL_FLAG(std::optional<std::string>, restore_checkpoint, std::nullopt,
+          "File containing a (binary) ProcRuntimeCheckpointProto to restore "
+          "the proc states and channel contents from before running. Inputs "
+          "given by --inputs_for_channels are replaced by the queue contents "
+          "in the checkpoint. Only supported for procs.");
+ABSL_FLAG(std::optional<std::string>, save_checkpoint, std::nullopt,
+          "File to write a (binary) ProcRuntimeCheckpointProto to capturing "
+          "the proc states and channel contents at the end of the run. Only "
+          "supported for procs.");
 ABSL_FLAG(std::optional<std::string>, output_node_coverage_stats_proto,
           std::nullopt,
           "File to write a (binary) NodeCoverageStatsProto showing which bits "
@@ -215,9 +276,14 @@ static absl::Status LogInterpreterEvents(std::string_view entity_name,
 
 struct EvaluateProcsOptions {
   bool use_jit = false;
+  // Only meaningful if `use_jit` is true.
+  bool use_parallel_runtime = false;
   bool fail_on_assert = false;
   std::vector<int64_t> ticks = {-1};
   std::optional<std::string> top = std::nullopt;
+  std::optional<std::string> restore_checkpoint = std::nullopt;
+  std::optional<std::string> save_checkpoint = std::nullopt;
+  std::optional<std::string> binary_channel_trace = std::nullopt;
 };
 
 static absl::Status EvaluateProcs(
@@ -226,10 +292,15 @@ static absl::Status EvaluateProcs(
     absl::btree_map<std::string, std::vector<Value>>&
         expected_outputs_for_channels,
     const EvaluateProcsOptions& options = {}) {
-  std::unique_ptr<SerialProcRuntime> runtime;
+  std::unique_ptr<ProcRuntime> runtime;
   std::optional<JitRuntime*> jit;
   EvaluatorOptions evaluator_options;
   evaluator_options.set_trace_channels(absl::GetFlag(FLAGS_trace_channels));
+  // Only traces which may be shown need to be recorded.
+  evaluator_options.set_max_trace_verbosity(
+      absl::GetFlag(FLAGS_show_trace)
+          ? absl::GetFlag(FLAGS_max_trace_verbosity)
+          : -1);
   bool uses_observers =
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto).has_value() ||
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto).has_value();
@@ -241,7 +312,17 @@ static absl::Status EvaluateProcs(
     }
   }
   evaluator_options.set_support_observers(uses_observers);
-  if (options.use_jit) {
+  if (options.use_jit && options.use_parallel_runtime) {
+    XLS_ASSIGN_OR_RETURN(
+        runtime,
+        CreateJitParallelProcRuntime(
+            package, evaluator_options,
+            ParallelProcRuntimeOptions{
+                .thread_count = absl::GetFlag(FLAGS_parallel_threads),
+                .deterministic = absl::GetFlag(FLAGS_deterministic_parallel)}));
+    XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
+    jit = &jit_queue->runtime();
+  } else if (options.use_jit) {
     XLS_ASSIGN_OR_RETURN(
         runtime, CreateJitSerialProcRuntime(package, evaluator_options));
     XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
@@ -250,6 +331,7 @@ static absl::Status EvaluateProcs(
     XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(
                                       package, evaluator_options));
   }
+  EndMemoryStage(options.use_jit ? "jit_compile" : "elaborate");
   ScopedRecordNodeCoverage cov(
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto),
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto), jit);
@@ -258,6 +340,11 @@ static absl::Status EvaluateProcs(
     LOG(ERROR) << "Set observer!";
   }
 
+  if (options.binary_channel_trace.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        runtime->StartBinaryChannelTrace(*options.binary_channel_trace));
+  }
+
   ChannelQueueManager& queue_manager = runtime->queue_manager();
   for (const auto& [channel_name, values] : inputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
@@ -281,11 +368,21 @@ static absl::Status EvaluateProcs(
 
   const int64_t trace_per_ticks = absl::GetFlag(FLAGS_trace_per_ticks);
 
+  std::optional<ProcRuntimeCheckpointProto> checkpoint;
+  if (options.restore_checkpoint.has_value()) {
+    checkpoint.emplace();
+    XLS_RETURN_IF_ERROR(
+        ParseProtobinFile(*options.restore_checkpoint, &*checkpoint));
+  }
+
   for (int64_t this_ticks : options.ticks) {
     if (absl::GetFlag(FLAGS_show_trace)) {
       LOG(INFO) << "Resetting proc state";
     }
     runtime->ResetState();
+    if (checkpoint.has_value()) {
+      XLS_RETURN_IF_ERROR(runtime->RestoreCheckpoint(*checkpoint));
+    }
 
     for (int i = 0; this_ticks < 0 || i < this_ticks; i++) {
       if (absl::GetFlag(FLAGS_show_trace) &&
@@ -405,6 +502,12 @@ static absl::Status EvaluateProcs(
   }
   absl::Duration elapsed_time = absl::Now() - start_time;
   LOG(INFO) << "Elapsed time: " << elapsed_time;
+  XLS_RETURN_IF_ERROR(runtime->FlushBinaryChannelTrace());
+  if (options.save_checkpoint.has_value()) {
+    XLS_ASSIGN_OR_RETURN(ProcRuntimeCheckpointProto saved,
+                         runtime->SaveCheckpoint());
+    XLS_RETURN_IF_ERROR(SetProtobinFile(*options.save_checkpoint, saved));
+  }
   bool checked_any_output = false;
   std::vector<std::string> errors;
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
@@ -590,17 +693,63 @@ InterpretBlockSignature(
   return channel_info;
 }
 
+// Model of a RAM attached to the ports of a block. The cells are kept in a
+// flat byte array, each cell holding ceil(width / 8) bytes of the little-endian
+// representation of its bits, so transactions only copy bytes. Cells which
+// have never been written or loaded read as the initial value.
 class MemoryModel {
  public:
   MemoryModel(const std::string& name, size_t size, const Value& initial_value,
               const Value& read_disabled_value, bool show_trace)
       : name_(name),
+        size_(size),
+        bit_count_(initial_value.GetFlatBitCount()),
+        byte_count_(CeilOfRatio(bit_count_, int64_t{8})),
+        initial_value_(initial_value),
         read_disabled_value_(read_disabled_value),
-        show_trace_(show_trace) {
-    cells_.resize(size, initial_value);
+        show_trace_(show_trace),
+        cells_(size * byte_count_),
+        initialized_(size, false),
+        write_data_(byte_count_) {}
+
+  // Initializes the memory from a raw image in `path`. The file is mapped and
+  // copied into the backing store; cell i occupies bytes
+  // [i * ceil(width / 8), (i + 1) * ceil(width / 8)) of the file. Cells beyond
+  // the end of the file keep their initial value.
+  absl::Status LoadImage(const std::filesystem::path& path) {
+    FileDescriptor fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() == -1) {
+      return ErrnoToStatus(errno) << "Failed to open memory image: " << path;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0) {
+      return ErrnoToStatus(errno) << "Failed to stat memory image: " << path;
+    }
+    if (static_cast<size_t>(st.st_size) > cells_.size() ||
+        (byte_count_ != 0 && st.st_size % byte_count_ != 0)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Memory image %s of %d bytes does not fit memory %s of %d cells of "
+          "%d bytes",
+          path.string(), st.st_size, name_, size_, byte_count_));
+    }
+    if (st.st_size == 0) {
+      return absl::OkStatus();
+    }
+    void* data =
+        mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (data == MAP_FAILED) {
+      return ErrnoToStatus(errno) << "Failed to map memory image: " << path;
+    }
+    std::memcpy(cells_.data(), data, st.st_size);
+    munmap(data, st.st_size);
+    if (byte_count_ != 0) {
+      std::fill_n(initialized_.begin(), st.st_size / byte_count_, true);
+    }
+    return absl::OkStatus();
   }
+
   absl::Status Read(int64_t addr) {
-    if (addr < 0 || addr >= cells_.size()) {
+    if (addr < 0 || addr >= size_) {
       return absl::OutOfRangeError(
           absl::StrFormat("Memory %s read out of range at %i", name_, addr));
     }
@@ -608,14 +757,19 @@ class MemoryModel {
       return absl::FailedPreconditionError(
           absl::StrFormat("Memory %s double read in tick at %i", name_, addr));
     }
-    read_this_tick_ = cells_[addr];
+    read_this_tick_ =
+        initialized_[addr]
+            ? Value(Bits::FromBytes(absl::MakeConstSpan(cells_).subspan(
+                                        addr * byte_count_, byte_count_),
+                                    bit_count_))
+            : initial_value_;
     if (show_trace_) {
       LOG(INFO) << "Memory Model: Initiated read " << name_ << "[" << addr
                 << "] = " << read_this_tick_.value();
     }
     return absl::OkStatus();
   }
-  Value GetValueReadLastTick() const {
+  const Value& GetValueReadLastTick() const {
     if (show_trace_) {
       if (read_last_tick_.has_value()) {
         LOG(INFO) << "Memory Model: Got read last value " << name_ << " = "
@@ -630,49 +784,60 @@ class MemoryModel {
   }
   bool DidReadLastTick() const { return read_last_tick_.has_value(); }
   absl::Status Write(int64_t addr, const Value& value) {
-    if (addr < 0 || addr >= cells_.size()) {
+    if (addr < 0 || addr >= size_) {
       return absl::OutOfRangeError(
           absl::StrFormat("Memory %s write out of range at %i", name_, addr));
     }
-    if (write_this_tick_.has_value()) {
+    if (write_addr_this_tick_.has_value()) {
       return absl::FailedPreconditionError(
           absl::StrFormat("Memory %s double write in tick at %i", name_, addr));
     }
-    if (value.GetFlatBitCount() != cells_[0].GetFlatBitCount()) {
+    if (!value.IsBits() || value.bits().bit_count() != bit_count_) {
       return absl::FailedPreconditionError(absl::StrFormat(
           "Memory %s write value at %i with wrong bit count %i, expected %i",
-          name_, addr, value.GetFlatBitCount(), cells_[0].GetFlatBitCount()));
+          name_, addr, value.GetFlatBitCount(), bit_count_));
     }
     if (show_trace_) {
       LOG(INFO) << "Memory Model: Initiated write " << name_ << "[" << addr
                 << "] = " << value;
     }
-    write_this_tick_ = std::make_pair(addr, value);
+    value.bits().ToBytes(absl::MakeSpan(write_data_));
+    write_addr_this_tick_ = addr;
     return absl::OkStatus();
   }
   absl::Status Tick() {
-    if (write_this_tick_.has_value()) {
+    if (write_addr_this_tick_.has_value()) {
+      int64_t addr = *write_addr_this_tick_;
       if (show_trace_) {
-        LOG(INFO) << "Memory Model: Committed write " << name_ << "["
-                  << write_this_tick_->first
-                  << "] = " << write_this_tick_->second;
+        LOG(INFO) << "Memory Model: Committed write " << name_ << "[" << addr
+                  << "] = "
+                  << Value(Bits::FromBytes(write_data_, bit_count_));
       }
-      cells_[write_this_tick_->first] = write_this_tick_->second;
-      write_this_tick_.reset();
+      std::copy(write_data_.begin(), write_data_.end(),
+                cells_.begin() + addr * byte_count_);
+      initialized_[addr] = true;
+      write_addr_this_tick_.reset();
     }
-    read_last_tick_ = read_this_tick_;
+    read_last_tick_ = std::move(read_this_tick_);
     read_this_tick_.reset();
     return absl::OkStatus();
   }
 
  private:
   const std::string name_;
+  const int64_t size_;
+  const int64_t bit_count_;
+  const int64_t byte_count_;
+  const Value initial_value_;
   const Value read_disabled_value_;
-  std::vector<Value> cells_;
-  std::optional<std::pair<int64_t, Value>> write_this_tick_;
+  const bool show_trace_;
+  std::vector<uint8_t> cells_;
+  std::vector<bool> initialized_;
+  // Pending write of this tick, committed by Tick().
+  std::optional<int64_t> write_addr_this_tick_;
+  std::vector<uint8_t> write_data_;
   std::optional<Value> read_this_tick_;
   std::optional<Value> read_last_tick_;
-  const bool show_trace_;
 };
 
 // XLS doesn't have X. Fill with all 1s, as this is generally more likely
@@ -697,6 +862,8 @@ struct RunBlockOptions {
   double prob_input_valid_assert;
   bool show_trace;
   bool fail_on_assert;
+  // Raw images to initialize memory models from, by memory name.
+  absl::flat_hash_map<std::string, std::string> model_memory_images;
 };
 
 // Helper to hold various commonly needed port names for a particular ram.
@@ -811,6 +978,14 @@ static absl::Status RunBlock(
         name, model_pair.first, model_pair.second,
         /*read_disabled_value=*/XsOfType(port->GetType()), options.show_trace);
   }
+  for (const auto& [name, path] : options.model_memory_images) {
+    auto model = model_memories.find(name);
+    if (model == model_memories.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Memory image given for unknown memory %s", name));
+    }
+    XLS_RETURN_IF_ERROR(model->second->LoadImage(path));
+  }
 
   absl::flat_hash_map<std::string, Value> reg_state;
   {
@@ -847,6 +1022,7 @@ static absl::Status RunBlock(
     XLS_ASSIGN_OR_RETURN(jit,
                          kJitBlockEvaluator.GetRuntime(continuation.get()));
   }
+  EndMemoryStage(options.use_jit ? "jit_compile" : "elaborate");
   ScopedRecordNodeCoverage cov(
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto),
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto), jit);
@@ -1151,11 +1327,14 @@ GetValuesForEachChannels(
   absl::flat_hash_map<std::string, std::string> channel_filenames;
   XLS_ASSIGN_OR_RETURN(channel_filenames,
                        ParseChannelFilenames(filenames_for_each_channel));
+  XLS_ASSIGN_OR_RETURN(ValueFileFormat format,
+                       ValueFileFormatFromString(
+                           absl::GetFlag(FLAGS_channel_values_file_format)));
   absl::btree_map<std::string, std::vector<Value>> values_for_channels;
 
   for (const auto& [channel_name, filename] : channel_filenames) {
     XLS_ASSIGN_OR_RETURN(std::vector<Value> values,
-                         ParseValuesFile(filename, total_ticks));
+                         ParseValuesFile(filename, total_ticks, format));
     values_for_channels[channel_name] = values;
   }
   return values_for_channels;
@@ -1219,8 +1398,8 @@ static absl::Status RealMain(
                          ParseMemoryModels(model_memories_text));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_file));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(auto package, ReadPackageFile(ir_file));
+  EndMemoryStage("parse");
 
   if (backend != "block_jit" && backend != "block_interpreter" &&
       !model_memories.empty()) {
@@ -1237,6 +1416,9 @@ static absl::Status RealMain(
         .prob_input_valid_assert = prob_input_valid_assert,
         .show_trace = show_trace,
         .fail_on_assert = fail_on_assert};
+    XLS_ASSIGN_OR_RETURN(
+        block_options.model_memory_images,
+        ParseChannelFilenames(absl::GetFlag(FLAGS_model_memory_images)));
     if (backend == "block_jit") {
       block_options.use_jit = true;
     } else if (backend == "block_interpreter") {
@@ -1246,9 +1428,11 @@ static absl::Status RealMain(
     }
     verilog::ModuleSignatureProto proto;
     CHECK_OK(ParseTextProtoFile(block_signature_proto, &proto));
-    return RunBlock(package.get(), proto, inputs_for_channels,
-                    expected_outputs_for_channels, model_memories,
-                    output_stats_path, block_options);
+    XLS_RETURN_IF_ERROR(RunBlock(package.get(), proto, inputs_for_channels,
+                                 expected_outputs_for_channels, model_memories,
+                                 output_stats_path, block_options));
+    EndMemoryStage("simulation");
+    return WriteProcessMemoryProfile();
   }
 
   // Not block sim
@@ -1256,17 +1440,26 @@ static absl::Status RealMain(
       .fail_on_assert = fail_on_assert,
       .ticks = ticks,
       .top = absl::GetFlag(FLAGS_top),
+      .restore_checkpoint = absl::GetFlag(FLAGS_restore_checkpoint),
+      .save_checkpoint = absl::GetFlag(FLAGS_save_checkpoint),
+      .binary_channel_trace = absl::GetFlag(FLAGS_binary_channel_trace),
   };
 
   if (backend == "serial_jit") {
     evaluate_procs_options.use_jit = true;
+  } else if (backend == "parallel_jit") {
+    evaluate_procs_options.use_jit = true;
+    evaluate_procs_options.use_parallel_runtime = true;
   } else if (backend == "ir_interpreter") {
     evaluate_procs_options.use_jit = false;
   } else {
     LOG(QFATAL) << "Unknown backend type";
   }
-  return EvaluateProcs(package.get(), inputs_for_channels,
-                       expected_outputs_for_channels, evaluate_procs_options);
+  XLS_RETURN_IF_ERROR(EvaluateProcs(package.get(), inputs_for_channels,
+                                    expected_outputs_for_channels,
+                                    evaluate_procs_options));
+  EndMemoryStage("simulation");
+  return WriteProcessMemoryProfile();
 }
 
 }  // namespace
@@ -1279,9 +1472,15 @@ int main(int argc, char* argv[]) {
     LOG(QFATAL) << "One (and only one) IR file must be given.";
   }
 
+  if (!absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    xls::SetJitObjectCacheDirectory(
+        std::filesystem::path(absl::GetFlag(FLAGS_jit_object_cache_dir)));
+  }
+  xls::SetJitLazyCompilation(absl::GetFlag(FLAGS_jit_lazy_compilation));
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter" && backend != "block_jit") {
+  if (backend != "serial_jit" && backend != "parallel_jit" &&
+      backend != "ir_interpreter" && backend != "block_interpreter" &&
+      backend != "block_jit") {
     LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -36,30 +37,32 @@
 #include "xls/ir/value.h"
 #include "xls/ir/xls_value.pb.h"
 #include "xls/tools/proc_channel_values.pb.h"
+#include "xls/tools/value_file.h"
 #include "re2/re2.h"
 
 namespace xls {
 
 absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
-                                                   int64_t max_lines) {
+                                                   int64_t max_lines,
+                                                   ValueFileFormat format) {
   if (max_lines == 0) {
     return std::vector<Value>();
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
+  // Values are read one at a time so that no more of the file than is needed
+  // is ever held in memory.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ValueFileReader> reader,
+                       ValueFileReader::Open(filename, format));
   std::vector<Value> ret;
-  int64_t li = 0;
-  for (const auto& line :
-       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
-    if (0 == (li % 500)) {
-      VLOG(1) << "Parsing values file at line " << li;
+  while (max_lines < 0 || static_cast<int64_t>(ret.size()) < max_lines) {
+    if (0 == (ret.size() % 500)) {
+      VLOG(1) << "Parsing values file at record " << ret.size();
     }
-    li++;
-    XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(line));
-    ret.push_back(std::move(value));
-    if (li == max_lines) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Value> value, reader->Next());
+    if (!value.has_value()) {
       break;
     }
+    ret.push_back(*std::move(value));
   }
   return ret;
 }
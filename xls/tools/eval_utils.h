@@ -28,13 +28,16 @@
 #include "xls/ir/format_preference.h"
 #include "xls/ir/value.h"
 #include "xls/tools/proc_channel_values.pb.h"
+#include "xls/tools/value_file.h"
 
 namespace xls {
 
-// Returns all XLS Values in file.
-// If max_lines is <0 then it is ignored.
-absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
-                                                   int64_t max_lines = -1);
+// Returns all XLS Values in file, which has the given format (see
+// value_file.h). If max_lines is <0 then it is ignored; otherwise no more than
+// the first max_lines values are read.
+absl::StatusOr<std::vector<Value>> ParseValuesFile(
+    std::string_view filename, int64_t max_lines = -1,
+    ValueFileFormat format = ValueFileFormat::kText);
 
 // Returns a string representation of the channels-to-values map. The values are
 // represented in Hex format. For example, given the following
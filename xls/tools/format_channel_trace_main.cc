@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_trace.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/value.h"
+
+static constexpr std::string_view kUsage = R"(
+Converts a binary channel trace written by eval_proc_main's
+--binary_channel_trace flag to text:
+
+   format_channel_trace_main TRACE_FILE
+
+With --compare_to, instead checks that the values sent on each channel match
+those of another binary trace, ignoring tick numbers:
+
+   format_channel_trace_main --compare_to=OTHER_TRACE_FILE TRACE_FILE
+)";
+
+ABSL_FLAG(std::string, format, "default",
+          "Format in which to print values. One of: default, binary, hex, "
+          "signed_decimal, unsigned_decimal, plain_binary, plain_hex.");
+ABSL_FLAG(std::optional<std::string>, compare_to, std::nullopt,
+          "Binary channel trace to compare the values sent on each channel "
+          "against.");
+
+namespace xls {
+namespace {
+
+absl::StatusOr<ChannelTrace> ReadTrace(std::string_view path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return ParseChannelTrace(contents);
+}
+
+// Returns the values sent on each channel, by channel name.
+absl::btree_map<std::string, std::vector<Value>> SentValues(
+    const ChannelTrace& trace) {
+  absl::btree_map<std::string, std::vector<Value>> values;
+  for (const ChannelTraceRecord& record : trace.records) {
+    if (record.op == ChannelTraceOp::kWrite) {
+      values[trace.channel_names[record.channel_index]].push_back(
+          record.value);
+    }
+  }
+  return values;
+}
+
+absl::Status CompareTraces(const ChannelTrace& trace,
+                           const ChannelTrace& other) {
+  absl::btree_map<std::string, std::vector<Value>> values = SentValues(trace);
+  absl::btree_map<std::string, std::vector<Value>> other_values =
+      SentValues(other);
+  for (const std::string& name : trace.channel_names) {
+    const std::vector<Value>& lhs = values[name];
+    const std::vector<Value>& rhs = other_values[name];
+    for (int64_t i = 0; i < lhs.size() && i < rhs.size(); ++i) {
+      if (lhs[i] != rhs[i]) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Value %d sent on channel `%s` differs: %s vs %s", i, name,
+            lhs[i].ToString(), rhs[i].ToString()));
+      }
+    }
+    if (lhs.size() != rhs.size()) {
+      return absl::FailedPreconditionError(
+          absl::StrFormat("Channel `%s` has %d values sent vs %d", name,
+                          lhs.size(), rhs.size()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(std::string_view trace_path) {
+  XLS_ASSIGN_OR_RETURN(FormatPreference format_preference,
+                       FormatPreferenceFromString(absl::GetFlag(FLAGS_format)));
+  XLS_ASSIGN_OR_RETURN(ChannelTrace trace, ReadTrace(trace_path));
+  if (std::optional<std::string> other_path = absl::GetFlag(FLAGS_compare_to);
+      other_path.has_value()) {
+    XLS_ASSIGN_OR_RETURN(ChannelTrace other, ReadTrace(*other_path));
+    if (trace.channel_names != other.channel_names) {
+      return absl::FailedPreconditionError(
+          "Traces are of different proc networks");
+    }
+    return CompareTraces(trace, other);
+  }
+  std::cout << ChannelTraceToString(trace, format_preference);
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s TRACE_FILE",
+                                      argv[0]);
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+}
@@ -22,6 +22,7 @@
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -45,8 +46,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/netlist/cell_library.h"
-#include "xls/netlist/function_extractor.h"
-#include "xls/netlist/lib_parser.h"
+#include "xls/netlist/cell_library_cache.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
@@ -58,6 +58,10 @@
 ABSL_FLAG(std::string, cell_lib_path, "",
           "Path to the cell library. "
           "Either this or cell_proto_path should be set.");
+ABSL_FLAG(std::string, cell_lib_cache_dir, "",
+          "Optional directory in which to cache the cell library extracted "
+          "from --cell_lib_path, so that later runs with an unchanged Liberty "
+          "file skip parsing it.");
 ABSL_FLAG(std::string, cell_proto_path, "",
           "Path to the preprocessed cell library proto. "
           "This is a whole bunch faster than specifying an unprocessed "
@@ -91,6 +95,13 @@ ABSL_FLAG(std::string, schedule_path, "",
           "!IMPORTANT! If the netlist spans multiple stages, a schedule MUST "
           "be specified. Otherwise, mapping IR nodes to netlist cells is "
           "impossible.");
+ABSL_FLAG(std::string, partition, "",
+          "If set, splits the miter into independent solver jobs, one per "
+          "\"output_node\" or \"output_bit\", and solves them on "
+          "--partition_threads threads. The first counterexample found stops "
+          "the remaining jobs; per-job solve times are reported.");
+ABSL_FLAG(int32_t, partition_threads, 1,
+          "Number of threads solving the jobs of a --partition run.");
 ABSL_FLAG(int32_t, timeout_sec, -1,
           "Amount of time to allow for a LEC operation.");
 ABSL_FLAG(bool, auto_stage, false,
@@ -118,12 +129,11 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-  XLS_ASSIGN_OR_RETURN(auto stream,
-                       netlist::cell_lib::CharStream::FromText(lib_text));
-  XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
-                       netlist::function::ExtractFunctions(&stream));
-  return netlist::CellLibrary::FromProto(proto);
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string dir = absl::GetFlag(FLAGS_cell_lib_cache_dir); !dir.empty()) {
+    cache_dir = dir;
+  }
+  return netlist::LoadCellLibrary(cell_lib_path, cache_dir);
 }
 
 // Loads and parses a netlist from a file.
@@ -238,7 +248,8 @@ static absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec,
+    std::optional<solvers::z3::LecPartitionOptions> partition_options) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -296,7 +307,9 @@ static absl::Status RealMain(
   if (timeout_sec != -1) {
     old_action = SetAlarm(timeout_sec);
   }
-  bool equal = lec->Run();
+  bool equal = partition_options.has_value()
+                   ? lec->RunPartitioned(*partition_options)
+                   : lec->Run();
   if (timeout_sec != -1) {
     CancelAlarm(old_action);
   }
@@ -343,9 +356,22 @@ int main(int argc, char* argv[]) {
   QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  std::optional<xls::solvers::z3::LecPartitionOptions> partition_options;
+  std::string partition = absl::GetFlag(FLAGS_partition);
+  if (!partition.empty()) {
+    QCHECK(partition == "output_node" || partition == "output_bit")
+        << "--partition must be \"output_node\" or \"output_bit\".";
+    QCHECK(!auto_stage) << "--partition can't be used with --auto_stage.";
+    partition_options = xls::solvers::z3::LecPartitionOptions{
+        .partitioning = partition == "output_bit"
+                            ? xls::solvers::z3::LecPartitioning::kOutputBit
+                            : xls::solvers::z3::LecPartitioning::kOutputNode,
+        .thread_count = absl::GetFlag(FLAGS_partition_threads)};
+  }
+
   return xls::ExitStatus(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, absl::GetFlag(FLAGS_timeout_sec), partition_options));
 }
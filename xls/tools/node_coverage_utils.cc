@@ -14,6 +14,7 @@
 
 #include "xls/tools/node_coverage_utils.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -116,6 +117,20 @@ absl::Status CoverageEvalObserver::Finalize() {
   return absl::OkStatus();
 }
 
+absl::Status CoverageEvalObserver::Merge(const CoverageEvalObserver& other) {
+  XLS_RET_CHECK(raw_coverage_.empty()) << "Need to call finalize first";
+  XLS_RET_CHECK(other.raw_coverage_.empty()) << "Need to call finalize first";
+  for (const auto& [node, bitmaps] : other.coverage_) {
+    auto [it, inserted] = coverage_.try_emplace(node, bitmaps);
+    if (!inserted) {
+      leaf_type_tree::SimpleUpdateFrom<InlineBitmap, InlineBitmap>(
+          it->second.AsMutableView(), bitmaps.AsView(),
+          [](InlineBitmap& l, const InlineBitmap& r) { l.Union(r); });
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<NodeCoverageStatsProto> CoverageEvalObserver::proto() const {
   XLS_RET_CHECK(raw_coverage_.empty()) << "Need to call finalize first";
   NodeCoverageStatsProto res;
@@ -182,6 +197,39 @@ void CoverageEvalObserver::RecordNodeValue(int64_t node_ptr,
   }
 }
 
+uint8_t* CoverageEvalObserver::GetNodeValueAccumulator(Node* node,
+                                                       int64_t byte_size) {
+  CHECK(jit_);
+  std::vector<uint8_t>& bits = raw_coverage_[node];
+  if (bits.empty()) {
+    // Zero-sized values still need distinct non-null storage.
+    bits.resize(std::max<int64_t>(byte_size, 1), 0);
+  }
+  return bits.data();
+}
+
+void CoverageEvalObserver::SetPaused(bool v) {
+  if (v == paused_) {
+    return;
+  }
+  paused_ = v;
+  if (paused_) {
+    paused_raw_coverage_ = raw_coverage_;
+    return;
+  }
+  // The jitted code holds pointers to the accumulators, so they are restored
+  // in place.
+  for (auto& [node, bits] : raw_coverage_) {
+    auto it = paused_raw_coverage_.find(node);
+    if (it == paused_raw_coverage_.end()) {
+      absl::c_fill(bits, 0);
+    } else {
+      absl::c_copy(it->second, bits.begin());
+    }
+  }
+  paused_raw_coverage_.clear();
+}
+
 ScopedRecordNodeCoverage::~ScopedRecordNodeCoverage() {
   if (!txtproto_ && !binproto_) {
     return;
@@ -48,16 +48,29 @@ class CoverageEvalObserver final : public EvaluationObserver,
     return std::nullopt;
   }
   void RecordNodeValue(int64_t node_ptr, const uint8_t* data) override;
+  // Coverage only needs the OR of the values of each node, so the jitted code
+  // accumulates them directly into `raw_coverage_`.
+  uint8_t* GetNodeValueAccumulator(Node* node, int64_t byte_size) override;
 
   // Prepare for proto conversion.
   absl::Status Finalize();
 
+  // Adds the coverage recorded by `other` to this observer. Both observers
+  // must have been finalized. This is used to combine the coverage recorded by
+  // separate observers for evaluations on different threads.
+  absl::Status Merge(const CoverageEvalObserver& other);
+
   absl::StatusOr<NodeCoverageStatsProto> proto() const;
-  void SetPaused(bool v) { paused_ = v; }
+
+  // While paused, values are not recorded. Values accumulated by the jitted
+  // code while paused are discarded when collection resumes.
+  void SetPaused(bool v);
 
  private:
   absl::flat_hash_map<Node*, LeafTypeTree<InlineBitmap>> coverage_;
   absl::flat_hash_map<Node*, std::vector<uint8_t>> raw_coverage_;
+  // The contents of `raw_coverage_` when collection was paused.
+  absl::flat_hash_map<Node*, std::vector<uint8_t>> paused_raw_coverage_;
   std::optional<JitRuntime*> jit_;
   bool paused_ = false;
 };
@@ -71,7 +84,7 @@ class ScopedRecordNodeCoverage {
         txtproto_(std::move(txtproto)),
         obs_(jit) {}
   ~ScopedRecordNodeCoverage();
-  std::optional<EvaluationObserver*> observer() {
+  std::optional<CoverageEvalObserver*> observer() {
     if (binproto_ || txtproto_) {
       return &obs_;
     }
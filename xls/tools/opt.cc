@@ -27,18 +27,23 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_package.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/optimization_budget.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/optimization_result_cache.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/verifier_checker.h"
 
 namespace xls::tools {
@@ -71,7 +76,7 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
     XLS_ASSIGN_OR_RETURN(pipeline,
                          GetOptimizationPipelineGenerator(options.opt_level)
                              .GeneratePipeline(*options.pass_list));
-    pipeline->AddInvariantChecker<VerifierChecker>();
+    pipeline->AddInvariantChecker<VerifierChecker>(/*incremental=*/true);
   }
   OptimizationPassOptions pass_options;
   pass_options.ir_dump_path = options.ir_dump_path;
@@ -84,17 +89,77 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   pass_options.use_context_narrowing_analysis =
       options.use_context_narrowing_analysis;
   pass_options.bisect_limit = options.bisect_limit;
-  PassResults results;
-  XLS_RETURN_IF_ERROR(pipeline->Run(package, pass_options, &results).status());
+  pass_options.function_pass_threads = options.function_pass_threads;
+  pass_options.streaming_unroll_threshold = options.streaming_unroll_threshold;
+  pass_options.max_context_specializations =
+      options.max_context_specializations;
+  pass_options.context_specialization_time_budget =
+      options.context_specialization_time_budget;
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
+  std::optional<OptimizationBudget> budget;
+  if (options.time_budget.has_value()) {
+    budget.emplace(*options.time_budget);
+    pass_options.budget = &*budget;
+  }
+  std::optional<OptimizationResultCache> result_cache;
+  if (!options.result_cache_dir.empty()) {
+    if (options.bisect_limit.has_value() || options.time_budget.has_value()) {
+      LOG(WARNING) << "Not using the optimization result cache since a bisect "
+                      "limit or time budget is set.";
+    } else {
+      result_cache.emplace(options.result_cache_dir);
+      pass_options.result_cache = &*result_cache;
+    }
+  }
+  PassResults local_results;
+  PassResults* results =
+      options.pass_results != nullptr ? options.pass_results : &local_results;
+  XLS_RETURN_IF_ERROR(pipeline->Run(package, pass_options, results).status());
+  // The pipeline's verifier only re-verifies the nodes changed by each pass, so
+  // verify the whole package once at the end.
+  XLS_RETURN_IF_ERROR(VerifyPackage(package));
+  EndMemoryStage("optimize");
+  if (result_cache.has_value()) {
+    VLOG(1) << absl::StreamFormat(
+        "Optimization result cache %s: %d hits, %d misses",
+        options.result_cache_dir, result_cache->hit_count(),
+        result_cache->miss_count());
+  }
+  if (budget.has_value()) {
+    std::string report = budget->Report();
+    if (!report.empty()) {
+      LOG(WARNING) << "Optimization time budget of "
+                   << absl::FormatDuration(budget->budget())
+                   << " used up; curtailed passes:\n"
+                   << report;
+    }
+    if (options.budget_report != nullptr) {
+      *options.budget_report = std::move(report);
+    }
+  }
   return absl::OkStatus();
 }
 
+namespace {
+
+absl::StatusOr<std::string> OptimizeAndEmit(std::unique_ptr<Package> package,
+                                            const OptOptions& options) {
+  XLS_RETURN_IF_ERROR(OptimizeIrForTop(package.get(), options));
+  if (options.binary_output) {
+    return SerializePackageToBinary(*package);
+  }
+  return package->DumpIr();
+}
+
+}  // namespace
+
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir, options.ir_path));
-  XLS_RETURN_IF_ERROR(OptimizeIrForTop(package.get(), options));
-  return package->DumpIr();
+                       ParsePackageTextOrBinary(ir, options.ir_path));
+  EndMemoryStage("parse");
+  return OptimizeAndEmit(std::move(package), options);
 }
 
 absl::StatusOr<std::string> OptimizeIrForTop(
@@ -103,8 +168,16 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit) {
-  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
+    std::optional<int64_t> bisect_limit, int64_t function_pass_threads,
+    PassResults* pass_results, bool binary_output,
+    std::optional<int64_t> streaming_unroll_threshold,
+    std::optional<int64_t> max_context_specializations,
+    std::optional<absl::Duration> context_specialization_time_budget,
+    std::optional<absl::Duration> time_budget, std::string* budget_report,
+    std::string_view result_cache_dir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ReadPackageFile(input_path));
+  EndMemoryStage("parse");
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
     RamRewritesProto ram_rewrite_proto;
@@ -131,8 +204,17 @@ absl::StatusOr<std::string> OptimizeIrForTop(
       .use_context_narrowing_analysis = use_context_narrowing_analysis,
       .pass_list = std::move(pass_list),
       .bisect_limit = bisect_limit,
+      .function_pass_threads = function_pass_threads,
+      .streaming_unroll_threshold = streaming_unroll_threshold,
+      .max_context_specializations = max_context_specializations,
+      .context_specialization_time_budget = context_specialization_time_budget,
+      .time_budget = time_budget,
+      .budget_report = budget_report,
+      .result_cache_dir = std::string(result_cache_dir),
+      .pass_results = pass_results,
+      .binary_output = binary_output,
   };
-  return OptimizeIrForTop(ir, options);
+  return OptimizeAndEmit(std::move(package), options);
 }
 
 }  // namespace xls::tools
@@ -25,11 +25,13 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 
 // TODO(meheff): 2021-10-04 Remove this header.
 #include "absl/types/span.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls::tools {
 
@@ -48,6 +50,26 @@ struct OptOptions {
   bool use_context_narrowing_analysis;
   std::optional<std::string> pass_list;
   std::optional<int64_t> bisect_limit;
+  int64_t function_pass_threads = 1;
+  std::optional<int64_t> streaming_unroll_threshold = std::nullopt;
+  std::optional<int64_t> max_context_specializations = std::nullopt;
+  std::optional<absl::Duration> context_specialization_time_budget =
+      std::nullopt;
+  // If set, expensive analyses degrade to cheaper ones as this wall-clock
+  // budget for the pipeline is used up.
+  std::optional<absl::Duration> time_budget = std::nullopt;
+  // If non-null, receives a list of the passes curtailed by `time_budget`, one
+  // per line.
+  std::string* budget_report = nullptr;
+  // If non-empty, a directory in which the optimized bodies of functions are
+  // cached by the pre-inlining passes and reused by later runs. Ignored when
+  // `bisect_limit` or `time_budget` is set.
+  std::string result_cache_dir = "";
+  // If non-null, receives the per-invocation statistics of the pipeline run.
+  PassResults* pass_results = nullptr;
+  // If true the optimized IR is returned in the binary package format (see
+  // xls/ir/binary_package.h) rather than as text.
+  bool binary_output = false;
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
@@ -57,7 +79,7 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options);
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
-// returns the resulting optimized IR.
+// returns the resulting optimized IR. `ir` may be textual or binary IR.
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options);
 
@@ -69,7 +91,15 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit);
+    std::optional<int64_t> bisect_limit, int64_t function_pass_threads = 1,
+    PassResults* pass_results = nullptr, bool binary_output = false,
+    std::optional<int64_t> streaming_unroll_threshold = std::nullopt,
+    std::optional<int64_t> max_context_specializations = std::nullopt,
+    std::optional<absl::Duration> context_specialization_time_budget =
+        std::nullopt,
+    std::optional<absl::Duration> time_budget = std::nullopt,
+    std::string* budget_report = nullptr,
+    std::string_view result_cache_dir = "");
 
 }  // namespace xls::tools
 
@@ -35,13 +35,18 @@
 #include "absl/log/log_sink_registry.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/tool_timeout.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/passes/pass_profile.pb.h"
 #include "xls/tools/opt.h"
 
 static constexpr std::string_view kUsage = R"(
@@ -53,7 +58,8 @@ Successfully optimized IR is printed to stdout.
 Expected invocation:
   opt_main <IR file>
 where:
-  - <IR file> is the path to the input IR file. '-' denotes stdin as input.
+  - <IR file> is the path to the input IR file, either textual or binary IR.
+    '-' denotes stdin as input.
 
 Example invocation:
   opt_main path/to/file.ir
@@ -61,6 +67,10 @@ Example invocation:
 
 ABSL_FLAG(std::string, output_path, "-",
           "Output path for the optimized IR file; '-' denotes stdout.");
+ABSL_FLAG(bool, output_binary, false,
+          "Emit the optimized IR in the binary package format rather than as "
+          "text. Binary IR is accepted by opt_main, codegen_main, eval_ir_main "
+          "and eval_proc_main and is much faster to load for large packages.");
 ABSL_FLAG(std::optional<std::string>, alsologto, std::nullopt,
           "Path to write logs to, in addition to stderr.");
 // LINT.IfChange
@@ -109,6 +119,51 @@ ABSL_FLAG(
 ABSL_FLAG(std::optional<int64_t>, passes_bisect_limit, std::nullopt,
           "Number of passes to allow to execute. This can be used as compiler "
           "fuel to ensure the compiler finishes at a particular point.");
+ABSL_FLAG(int64_t, function_pass_threads, 1,
+          "Number of threads on which passes which operate on a single "
+          "function or proc process the functions and procs of the package "
+          "concurrently. Values of one or less run them serially. The "
+          "optimized IR is identical for any thread count.");
+ABSL_FLAG(std::optional<int64_t>, streaming_unroll_threshold, std::nullopt,
+          "If specified, counted for loops with at least this many "
+          "iterations and maps over at least this many elements are unrolled "
+          "one iteration at a time, folding constants and removing dead nodes "
+          "of each iteration before cloning the next. This bounds the size "
+          "of the IR while unrolling large loops.");
+ABSL_FLAG(std::optional<int64_t>, max_context_specializations, std::nullopt,
+          "If specified, context sensitive narrowing computes at most this "
+          "many select-context specializations of each function or proc. "
+          "Only meaningful with --use_context_narrowing_analysis.");
+ABSL_FLAG(std::optional<absl::Duration>, context_specialization_time_budget,
+          std::nullopt,
+          "If specified, context sensitive narrowing starts no new "
+          "select-context specializations of a function or proc once this "
+          "much time has been spent on them (e.g. \"500ms\"). Unlike "
+          "--max_context_specializations this makes the optimized IR depend "
+          "on the speed of the machine.");
+ABSL_FLAG(std::optional<absl::Duration>, time_budget, std::nullopt,
+          "If specified, a wall-clock budget for the optimization pipeline "
+          "(e.g. \"10m\"). As it is used up, passes with expensive analyses "
+          "(context-sensitive range analysis, BDDs) fall back to cheaper ones. "
+          "The pipeline still runs to completion. Makes the optimized IR "
+          "depend on the speed of the machine.");
+ABSL_FLAG(std::string, budget_report_path, "",
+          "If specified, write the list of passes curtailed by --time_budget "
+          "to this path, one per line.");
+ABSL_FLAG(std::string, result_cache_dir, "",
+          "If specified, a directory in which the optimized bodies of "
+          "functions are cached before inlining. Functions whose IR, callees, "
+          "passes and options match an earlier run reuse its result instead "
+          "of being optimized again. The directory may be shared by "
+          "concurrent runs.");
+ABSL_FLAG(std::string, pass_profile_path, "",
+          "If specified, write a PassPipelineProfileProto text proto with the "
+          "wall time, node counts, transformation metrics and peak memory of "
+          "every pass invocation to this path.");
+ABSL_FLAG(std::string, pass_profile_csv_path, "",
+          "If specified, write per-pass profile summaries as CSV to this "
+          "path. Rows are sorted by pass name for diffing across compiler "
+          "versions.");
 ABSL_FLAG(bool, list_passes, false,
           "If passed list the names of all passes and exit.");
 
@@ -176,6 +231,12 @@ absl::Status RealMain(std::string_view input_path) {
   std::optional<std::string> pass_list = absl::GetFlag(FLAGS_passes);
   std::optional<int64_t> bisect_limit =
       absl::GetFlag(FLAGS_passes_bisect_limit);
+  int64_t function_pass_threads = absl::GetFlag(FLAGS_function_pass_threads);
+  std::string pass_profile_path = absl::GetFlag(FLAGS_pass_profile_path);
+  std::string pass_profile_csv_path =
+      absl::GetFlag(FLAGS_pass_profile_csv_path);
+  PassResults pass_results;
+  std::string budget_report;
 
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir,
@@ -190,7 +251,34 @@ absl::Status RealMain(std::string_view input_path) {
           /*ram_rewrites_pb=*/ram_rewrites_pb,
           /*use_context_narrowing_analysis=*/use_context_narrowing_analysis,
           /*pass_list=*/pass_list,
-          /*bisect_limit=*/bisect_limit));
+          /*bisect_limit=*/bisect_limit,
+          /*function_pass_threads=*/function_pass_threads,
+          /*pass_results=*/&pass_results,
+          /*binary_output=*/absl::GetFlag(FLAGS_output_binary),
+          /*streaming_unroll_threshold=*/
+          absl::GetFlag(FLAGS_streaming_unroll_threshold),
+          /*max_context_specializations=*/
+          absl::GetFlag(FLAGS_max_context_specializations),
+          /*context_specialization_time_budget=*/
+          absl::GetFlag(FLAGS_context_specialization_time_budget),
+          /*time_budget=*/absl::GetFlag(FLAGS_time_budget),
+          /*budget_report=*/&budget_report,
+          /*result_cache_dir=*/absl::GetFlag(FLAGS_result_cache_dir)));
+  if (std::string budget_report_path = absl::GetFlag(FLAGS_budget_report_path);
+      !budget_report_path.empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(budget_report_path, budget_report));
+  }
+  if (!pass_profile_path.empty() || !pass_profile_csv_path.empty()) {
+    PassPipelineProfileProto profile = PassResultsToProfileProto(pass_results);
+    if (!pass_profile_path.empty()) {
+      XLS_RETURN_IF_ERROR(SetTextProtoFile(pass_profile_path, profile));
+    }
+    if (!pass_profile_csv_path.empty()) {
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(pass_profile_csv_path, PassProfileToCsv(profile)));
+    }
+  }
+  XLS_RETURN_IF_ERROR(WriteProcessMemoryProfile());
 
   if (output_path == "-") {
     std::cout << opt_ir;
@@ -40,6 +40,12 @@ ABSL_FLAG(int64_t, pipeline_stages, 0,
           "https://google.github.io/xls/scheduling for details.");
 ABSL_FLAG(std::string, delay_model, "",
           "Delay model name to use from registry.");
+ABSL_FLAG(std::string, delay_cache_path, "",
+          "If set, path of a file in which delay estimates are cached by "
+          "operation signature (op, operand and result types, literal "
+          "operands and attributes). The file is created if needed, and can "
+          "be shared by concurrent and later runs of any tool taking "
+          "scheduling options.");
 ABSL_FLAG(int64_t, clock_margin_percent, 0,
           "The percentage of clock period to set aside as a margin to ensure "
           "timing is met. Effectively, this lowers the clock period by this "
@@ -154,10 +160,33 @@ ABSL_FLAG(std::string, fdo_default_driver_cell, "",
           "Cell to assume is driving primary inputs");
 ABSL_FLAG(std::string, fdo_default_load, "",
           "Cell to assume is being driven by primary outputs");
+ABSL_FLAG(int64_t, fdo_max_concurrent_syntheses, 0,
+          "Maximum number of syntheses run concurrently in each FDO "
+          "iteration. Zero means one per available CPU.");
+ABSL_FLAG(std::string, fdo_synthesis_cache_dir, "",
+          "Directory in which synthesized subgraph delays are cached across "
+          "runs, keyed by the synthesizer and synthesis libraries. If empty, "
+          "delays are only reused within a run.");
 // TODO: google/xls#869 - Remove when proc-scoped channels supplant old-style
 // procs.
 ABSL_FLAG(bool, multi_proc, false,
           "If true, schedule all procs and codegen them all.");
+ABSL_FLAG(bool, prune_critical_path_distances, false,
+          "If true, the SDC scheduler only computes critical-path distances "
+          "between pairs of nodes which can violate the clock period being "
+          "scheduled for, rather than between all pairs of nodes. This greatly "
+          "reduces memory use for wide designs, at the cost of recomputing "
+          "the distances whenever a longer clock period is tried.");
+ABSL_FLAG(int64_t, schedule_bounds_threads, 1,
+          "Number of threads used to propagate the ASAP/ALAP bounds which "
+          "seed the min-cut, random and ASAP schedulers. Nodes at the same "
+          "depth are propagated concurrently.");
+ABSL_FLAG(int64_t, schedule_partitions, 1,
+          "If greater than one, the function is split into this many weakly "
+          "coupled regions which are scheduled independently and in parallel "
+          "with the min-cut algorithm, instead of scheduling it as a whole. "
+          "This scales to much larger designs at a small cost in pipeline "
+          "registers.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_providers.bzl,
 //   //docs_src/codegen_options.md
@@ -190,6 +219,7 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(clock_period_ps);
   POPULATE_FLAG(pipeline_stages);
   POPULATE_FLAG(delay_model);
+  POPULATE_FLAG(delay_cache_path);
   POPULATE_FLAG(clock_margin_percent);
   POPULATE_FLAG(period_relaxation_percent);
   POPULATE_FLAG(minimize_clock_on_failure);
@@ -219,7 +249,12 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_synthesis_libraries);
   POPULATE_FLAG(fdo_default_driver_cell);
   POPULATE_FLAG(fdo_default_load);
+  POPULATE_FLAG(fdo_max_concurrent_syntheses);
+  POPULATE_FLAG(fdo_synthesis_cache_dir);
   POPULATE_FLAG(multi_proc);
+  POPULATE_FLAG(prune_critical_path_distances);
+  POPULATE_FLAG(schedule_bounds_threads);
+  POPULATE_FLAG(schedule_partitions);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
 
@@ -0,0 +1,152 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/value_file.h"
+
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_value.pb.h"
+
+namespace xls {
+
+absl::StatusOr<ValueFileFormat> ValueFileFormatFromString(std::string_view s) {
+  if (s == "text") {
+    return ValueFileFormat::kText;
+  }
+  if (s == "binary_proto") {
+    return ValueFileFormat::kBinaryProto;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown value file format '%s'; expected 'text' or 'binary_proto'.",
+      s));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ValueFileReader>>
+ValueFileReader::Open(const std::filesystem::path& path,
+                      ValueFileFormat format) {
+  auto reader = absl::WrapUnique(new ValueFileReader(
+      path == "-" ? std::filesystem::path("/dev/stdin") : path, format));
+  reader->stream_.open(reader->path_, std::ios::binary);
+  if (!reader->stream_) {
+    return absl::NotFoundError(
+        absl::StrCat("Unable to open value file: ", path.string()));
+  }
+  if (format == ValueFileFormat::kBinaryProto) {
+    reader->proto_stream_ =
+        std::make_unique<google::protobuf::io::IstreamInputStream>(
+            &reader->stream_);
+  }
+  return reader;
+}
+
+absl::StatusOr<std::optional<std::string>> ValueFileReader::NextLine() {
+  XLS_RET_CHECK(format_ == ValueFileFormat::kText)
+      << "Lines can only be read from text value files";
+  std::string line;
+  while (std::getline(stream_, line)) {
+    std::string_view stripped = absl::StripAsciiWhitespace(line);
+    if (!stripped.empty()) {
+      ++record_count_;
+      return std::string(stripped);
+    }
+  }
+  if (stream_.bad()) {
+    return absl::DataLossError(
+        absl::StrCat("Error reading value file: ", path_.string()));
+  }
+  return std::nullopt;
+}
+
+absl::StatusOr<std::optional<Value>> ValueFileReader::Next() {
+  if (format_ == ValueFileFormat::kText) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> line, NextLine());
+    if (!line.has_value()) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(*line),
+                         _ << "@ " << path_.string() << " record "
+                           << record_count_);
+    return value;
+  }
+  ValueProto proto;
+  bool clean_eof = false;
+  if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+          &proto, proto_stream_.get(), &clean_eof)) {
+    if (clean_eof) {
+      return std::nullopt;
+    }
+    return absl::DataLossError(
+        absl::StrFormat("Malformed record %d in value file: %s",
+                        record_count_ + 1, path_.string()));
+  }
+  ++record_count_;
+  return Value::FromProto(proto);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ValueFileWriter>>
+ValueFileWriter::Open(const std::filesystem::path& path,
+                      ValueFileFormat format) {
+  auto writer = absl::WrapUnique(new ValueFileWriter(
+      path == "-" ? std::filesystem::path("/dev/stdout") : path, format));
+  writer->stream_.open(writer->path_, std::ios::binary | std::ios::trunc);
+  if (!writer->stream_) {
+    return absl::PermissionDeniedError(
+        absl::StrCat("Unable to open value file for writing: ", path.string()));
+  }
+  return writer;
+}
+
+absl::Status ValueFileWriter::Write(const Value& value) {
+  if (format_ == ValueFileFormat::kText) {
+    stream_ << value.ToString(FormatPreference::kHex) << '\n';
+  } else {
+    XLS_ASSIGN_OR_RETURN(ValueProto proto, value.AsProto());
+    google::protobuf::util::SerializeDelimitedToOstream(proto, &stream_);
+  }
+  if (!stream_) {
+    return absl::DataLossError(
+        absl::StrCat("Error writing value file: ", path_.string()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ValueFileWriter::Close() {
+  stream_.close();
+  if (!stream_) {
+    return absl::DataLossError(
+        absl::StrCat("Error writing value file: ", path_.string()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
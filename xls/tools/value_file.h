@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_VALUE_FILE_H_
+#define XLS_TOOLS_VALUE_FILE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// The format of a file holding a sequence of values.
+enum class ValueFileFormat {
+  // One typed value per line, e.g. "bits[32]:0x42". Blank lines are ignored.
+  kText,
+  // A sequence of length-delimited ValueProto records.
+  kBinaryProto,
+};
+
+// Parses "text" or "binary_proto" as a ValueFileFormat.
+absl::StatusOr<ValueFileFormat> ValueFileFormatFromString(std::string_view s);
+
+// Reads a sequence of values from a file one record at a time, so memory use
+// does not depend on the size of the file. A path of "-" reads stdin.
+class ValueFileReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<ValueFileReader>> Open(
+      const std::filesystem::path& path,
+      ValueFileFormat format = ValueFileFormat::kText);
+
+  // Returns the next value, or std::nullopt at the end of the file.
+  absl::StatusOr<std::optional<Value>> Next();
+
+  // Returns the next non-blank line of a text file, or std::nullopt at the end
+  // of the file. This allows callers to read records of a text format other
+  // than a single value per line.
+  absl::StatusOr<std::optional<std::string>> NextLine();
+
+  ValueFileFormat format() const { return format_; }
+
+  // The number of records returned so far.
+  int64_t record_count() const { return record_count_; }
+
+ private:
+  ValueFileReader(std::filesystem::path path, ValueFileFormat format)
+      : path_(std::move(path)), format_(format) {}
+
+  std::filesystem::path path_;
+  ValueFileFormat format_;
+  std::ifstream stream_;
+  // Only used for binary files.
+  std::unique_ptr<google::protobuf::io::IstreamInputStream> proto_stream_;
+  int64_t record_count_ = 0;
+};
+
+// Writes a sequence of values to a file in the format read by ValueFileReader.
+// A path of "-" writes to stdout.
+class ValueFileWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<ValueFileWriter>> Open(
+      const std::filesystem::path& path,
+      ValueFileFormat format = ValueFileFormat::kText);
+
+  absl::Status Write(const Value& value);
+
+  // Flushes the file, returning an error if any write failed.
+  absl::Status Close();
+
+ private:
+  ValueFileWriter(std::filesystem::path path, ValueFileFormat format)
+      : path_(std::move(path)), format_(format) {}
+
+  std::filesystem::path path_;
+  ValueFileFormat format_;
+  std::ofstream stream_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_VALUE_FILE_H_
@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/value_file.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+
+std::vector<Value> TestValues() {
+  return {Value(UBits(0x42, 32)),
+          Value::Tuple({Value(UBits(1, 1)), Value(UBits(0xabc, 12))}),
+          *Value::UBitsArray({1, 2, 3}, 8)};
+}
+
+absl::StatusOr<std::vector<Value>> ReadAll(ValueFileReader& reader) {
+  std::vector<Value> values;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Value> value, reader.Next());
+    if (!value.has_value()) {
+      return values;
+    }
+    values.push_back(*value);
+  }
+}
+
+TEST(ValueFileTest, ReadsTextLineByLine) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file,
+      TempFile::CreateWithContent(
+          "bits[32]:0x42\n\n  (bits[1]:1, bits[12]:0xabc)  \n"
+          "[bits[8]:1, bits[8]:2, bits[8]:3]"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ValueFileReader> reader,
+                           ValueFileReader::Open(file.path()));
+  EXPECT_THAT(ReadAll(*reader), IsOkAndHolds(TestValues()));
+  EXPECT_EQ(reader->record_count(), 3);
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(ValueFileTest, NextLineSkipsBlankLines) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent("a; b\n \n\nc\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ValueFileReader> reader,
+                           ValueFileReader::Open(file.path()));
+  EXPECT_THAT(reader->NextLine(), IsOkAndHolds(Optional(std::string("a; b"))));
+  EXPECT_THAT(reader->NextLine(), IsOkAndHolds(Optional(std::string("c"))));
+  EXPECT_THAT(reader->NextLine(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(ValueFileTest, MalformedTextValue) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent("bits[32]:0x1\nfoo\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ValueFileReader> reader,
+                           ValueFileReader::Open(file.path()));
+  XLS_EXPECT_OK(reader->Next());
+  EXPECT_FALSE(reader->Next().ok());
+}
+
+TEST(ValueFileTest, RoundTrip) {
+  for (ValueFileFormat format :
+       {ValueFileFormat::kText, ValueFileFormat::kBinaryProto}) {
+    XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ValueFileWriter> writer,
+                             ValueFileWriter::Open(file.path(), format));
+    for (const Value& value : TestValues()) {
+      XLS_ASSERT_OK(writer->Write(value));
+    }
+    XLS_ASSERT_OK(writer->Close());
+
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ValueFileReader> reader,
+                             ValueFileReader::Open(file.path(), format));
+    EXPECT_THAT(ReadAll(*reader), IsOkAndHolds(TestValues()));
+  }
+}
+
+TEST(ValueFileTest, TruncatedBinaryRecord) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ValueFileWriter> writer,
+      ValueFileWriter::Open(file.path(), ValueFileFormat::kBinaryProto));
+  XLS_ASSERT_OK(writer->Write(Value(UBits(0x1234, 16))));
+  XLS_ASSERT_OK(writer->Close());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(file.path()));
+  XLS_ASSERT_OK(SetFileContents(file.path(),
+                                contents.substr(0, contents.size() - 1)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ValueFileReader> reader,
+      ValueFileReader::Open(file.path(), ValueFileFormat::kBinaryProto));
+  EXPECT_THAT(reader->Next(), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ValueFileTest, TextOnlyNextLine) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ValueFileReader> reader,
+      ValueFileReader::Open(file.path(), ValueFileFormat::kBinaryProto));
+  EXPECT_FALSE(reader->NextLine().ok());
+}
+
+TEST(ValueFileTest, FormatFromString) {
+  EXPECT_THAT(ValueFileFormatFromString("text"),
+              IsOkAndHolds(ValueFileFormat::kText));
+  EXPECT_THAT(ValueFileFormatFromString("binary_proto"),
+              IsOkAndHolds(ValueFileFormat::kBinaryProto));
+  EXPECT_THAT(ValueFileFormatFromString("json"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ValueFileTest, MissingFile) {
+  EXPECT_THAT(ValueFileReader::Open("/does/not/exist"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
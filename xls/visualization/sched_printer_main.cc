@@ -15,9 +15,11 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -32,6 +34,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
@@ -55,6 +58,12 @@ static constexpr std::string_view kUsage = R"(
 Dump scheduling result to stdout in Graphviz's dot plain text format.
 Explicitly show the pipeline stage.
 
+For schedules too large to render, --output_format=summary instead prints the
+size, delay and pipeline register width of each stage and its most critical
+nodes, and --output_format=indexed writes one line per node, grouped by stage,
+to --output_path along with an index of where each stage starts in
+<output_path>.index.
+
 Example invocation:
   sched_printer_main --clock_period_ps=500 \
        --pipeline_stages=7 \
@@ -62,6 +71,14 @@ Example invocation:
 )";
 
 ABSL_FLAG(std::string, top, "", "Top entity to use in lieu of the default.");
+ABSL_FLAG(std::string, output_format, "dot",
+          "Format of the output. One of: dot, summary, indexed.");
+ABSL_FLAG(std::string, output_path, "",
+          "File to write the output to instead of stdout. Required for "
+          "--output_format=indexed.");
+ABSL_FLAG(int64_t, top_n_nodes_per_stage, 10,
+          "Number of nodes with the latest arrival time to list per stage with "
+          "--output_format=summary.");
 
 namespace xls {
 namespace {
@@ -103,55 +120,52 @@ void AllocateDigraphNodeId(
 
 using AttributeDict = absl::flat_hash_map<std::string, std::string>;
 
-void AddDigraphNode(std::string* out, int64_t id,
+// The DOT output is written to `out` as it's generated rather than built up in
+// memory, so huge schedules only need memory proportional to the IR.
+void AddDigraphNode(std::ostream& out, int64_t id,
                     AttributeDict* attrs = nullptr) {
-  std::string attrs_flatten;
   if (attrs != nullptr) {
+    out << absl::StreamFormat("  nd_%lld [", id);
     for (const auto& [k, v] : *attrs) {
-      absl::StrAppend(&attrs_flatten, k, "=", v, " ");
+      out << k << "=" << v << " ";
     }
-    absl::StrAppendFormat(out, "  nd_%lld [%s];\n", id, attrs_flatten);
+    out << "];\n";
     return;
   }
-  absl::StrAppendFormat(out, "  nd_%lld;\n", id);
+  out << absl::StreamFormat("  nd_%lld;\n", id);
 }
 
-void AddDigraphEdge(std::string* out, int64_t src_id, int64_t dst_id,
+void AddDigraphEdge(std::ostream& out, int64_t src_id, int64_t dst_id,
                     AttributeDict* attrs = nullptr) {
-  std::string attrs_flatten;
   if (attrs != nullptr) {
+    out << absl::StreamFormat("  nd_%lld -> nd_%lld [", src_id, dst_id);
     for (const auto& [k, v] : *attrs) {
-      absl::StrAppend(&attrs_flatten, k, "=", v, " ");
+      out << k << "=" << v << " ";
     }
-    absl::StrAppendFormat(out, "  nd_%lld -> nd_%lld [%s];\n", src_id, dst_id,
-                          attrs_flatten);
+    out << "];\n";
     return;
   }
-  absl::StrAppendFormat(out, "  nd_%lld -> nd_%lld;\n", src_id, dst_id);
+  out << absl::StreamFormat("  nd_%lld -> nd_%lld;\n", src_id, dst_id);
 }
 
-void AddGrouping(std::string* out, const PipelineSchedule& sched,
+void AddGrouping(std::ostream& out, const PipelineSchedule& sched,
                  const absl::flat_hash_map<Node*, int64_t>& xls_nodes_id,
                  const std::vector<absl::flat_hash_map<Node*, int64_t>>&
                      output_registers_id) {
   int64_t next_id = 0;
-  auto add_subgraph = [&next_id](std::string* out, std::string name,
-                                 int64_t total_bits,
-                                 const std::vector<int64_t>& IDs) {
-    std::string cluster_content;
+  auto add_subgraph = [&next_id, &out](std::string_view name,
+                                       int64_t total_bits,
+                                       const std::vector<int64_t>& IDs) {
+    out << absl::StreamFormat("  subgraph cluster_%lld{\n", next_id++);
     // Add label.
-    absl::StrAppendFormat(&cluster_content,
-                          "    label=\"%s registers\\n%lld bits\"\n", name,
-                          total_bits);
+    out << absl::StreamFormat("    label=\"%s registers\\n%lld bits\"\n", name,
+                              total_bits);
     // Align all the pipeline register nodes.
-    absl::StrAppendFormat(
-        &cluster_content, "    {rank=same %s}\n",
-        absl::StrJoin(IDs, " ", [&](std::string* dst, int64_t id) {
-          absl::StrAppendFormat(dst, "nd_%lld", id);
-        }));
-
-    absl::StrAppendFormat(out, "  subgraph cluster_%lld{\n%s  }\n", next_id++,
-                          cluster_content);
+    out << "    {rank=same";
+    for (int64_t id : IDs) {
+      out << absl::StreamFormat(" nd_%lld", id);
+    }
+    out << "}\n  }\n";
   };
 
   std::vector<int64_t> ids;
@@ -166,7 +180,7 @@ void AddGrouping(std::string* out, const PipelineSchedule& sched,
       total_bits += param->GetType()->GetFlatBitCount();
     }
   }
-  add_subgraph(out, "Parameter", total_bits, ids);
+  add_subgraph("Parameter", total_bits, ids);
 
   // Align return values horizontally.
   {
@@ -179,7 +193,7 @@ void AddGrouping(std::string* out, const PipelineSchedule& sched,
       }
     }
   }
-  add_subgraph(out, "Return value", total_bits, ids);
+  add_subgraph("Return value", total_bits, ids);
 
   // Align pipeline registers nodes, and group them into a subgraph explicitly.
   for (int64_t stage = 0; stage < output_registers_id.size(); ++stage) {
@@ -189,7 +203,7 @@ void AddGrouping(std::string* out, const PipelineSchedule& sched,
       ids.push_back(id);
       total_bits += node->GetType()->GetFlatBitCount();
     }
-    add_subgraph(out, absl::StrFormat("Stage #%lld output ", stage), total_bits,
+    add_subgraph(absl::StrFormat("Stage #%lld output ", stage), total_bits,
                  ids);
   }
 }
@@ -206,24 +220,15 @@ absl::StatusOr<DelayMap> ComputeNodeDelays(
   return result;
 }
 
-std::string GenerateDigraphContents(
-    const PipelineSchedule& sched, const DelayMap& delay_map,
+void WriteDigraphContents(
+    std::ostream& out, const PipelineSchedule& sched,
+    absl::Span<Node* const> topo_sort, const DelayMap& delay_map,
     const std::vector<absl::flat_hash_map<Node*, int64_t>>& output_registers_id,
     const absl::flat_hash_map<Node*, int64_t>& xls_nodes_id,
     const absl::flat_hash_set<Node*>& nodes_on_cp) {
-  absl::flat_hash_map<Node*, int64_t> topo_index;
-  {
-    std::vector<Node*> topo_sort = TopoSort(sched.function_base());
-    for (int64_t i = 0; i < topo_sort.size(); ++i) {
-      topo_index[topo_sort[i]] = i;
-    }
-  }
-
-  std::string contents;
-
   // Add all nodes
   {
-    for (Node* node : TopoSort(sched.function_base())) {
+    for (Node* node : topo_sort) {
       AttributeDict xls_node_attrs;
       xls_node_attrs["shape"] = "record";
       xls_node_attrs["style"] = "rounded";
@@ -237,7 +242,7 @@ std::string GenerateDigraphContents(
           node->GetType()->ToString(), delay_map.at(node));
       xls_node_attrs["color"] = nodes_on_cp.contains(node) ? "red" : "black";
 
-      AddDigraphNode(&contents, xls_nodes_id.at(node), &xls_node_attrs);
+      AddDigraphNode(out, xls_nodes_id.at(node), &xls_node_attrs);
     }
 
     for (int64_t stage = 0; stage < output_registers_id.size(); ++stage) {
@@ -249,14 +254,14 @@ std::string GenerateDigraphContents(
         reg_node_attrs["color"] =
             nodes_on_cp.contains(saved_node) ? "red" : "black";
 
-        AddDigraphNode(&contents, reg_node_id, &reg_node_attrs);
+        AddDigraphNode(out, reg_node_id, &reg_node_attrs);
       }
     }
   }
 
   // Add all edges
   {
-    for (Node* node : TopoSort(sched.function_base())) {
+    for (Node* node : topo_sort) {
       for (Node* operand : node->operands()) {
         int64_t operand_id = -1;
         if (sched.cycle(operand) < sched.cycle(node)) {
@@ -271,8 +276,7 @@ std::string GenerateDigraphContents(
             nodes_on_cp.contains(operand) && nodes_on_cp.contains(node)
                 ? "red"
                 : "black";
-        AddDigraphEdge(&contents, operand_id, xls_nodes_id.at(node),
-                       &edge_attrs);
+        AddDigraphEdge(out, operand_id, xls_nodes_id.at(node), &edge_attrs);
       }
     }
 
@@ -290,26 +294,150 @@ std::string GenerateDigraphContents(
         AttributeDict edge_attrs;
         edge_attrs["color"] =
             nodes_on_cp.contains(saved_node) ? "red" : "black";
-        AddDigraphEdge(&contents, src_id, reg_node_id, &edge_attrs);
+        AddDigraphEdge(out, src_id, reg_node_id, &edge_attrs);
       }
     }
   }
 
-  AddGrouping(&contents, sched, xls_nodes_id, output_registers_id);
-  return contents;
+  AddGrouping(out, sched, xls_nodes_id, output_registers_id);
 }
 
-std::string DumpScheduleResultToDot(
-    const PipelineSchedule& sched, const DelayMap& delay_map,
-    const absl::flat_hash_set<Node*>& nodes_on_cp) {
+void WriteScheduleDot(std::ostream& out, const PipelineSchedule& sched,
+                      absl::Span<Node* const> topo_sort,
+                      const DelayMap& delay_map,
+                      const absl::flat_hash_set<Node*>& nodes_on_cp) {
   std::vector<absl::flat_hash_map<Node*, int64_t>> output_registers_id;
   absl::flat_hash_map<Node*, int64_t> xls_nodes_id;
   AllocateDigraphNodeId(sched, &output_registers_id, &xls_nodes_id);
 
-  std::string contents = GenerateDigraphContents(
-      sched, delay_map, output_registers_id, xls_nodes_id, nodes_on_cp);
+  out << "digraph {\n";
+  WriteDigraphContents(out, sched, topo_sort, delay_map, output_registers_id,
+                       xls_nodes_id, nodes_on_cp);
+  out << "}\n";
+}
 
-  return absl::StrFormat("digraph {\n%s}\n", contents);
+// Per-stage view of a schedule used by the summary and indexed outputs.
+struct StageInfo {
+  // Nodes of the stage in topological order.
+  std::vector<Node*> nodes;
+  // Width of the pipeline registers at the output of the stage.
+  int64_t register_bits = 0;
+};
+
+struct ScheduleInfo {
+  std::vector<StageInfo> stages;
+  // Delay of the longest path ending at each node within its stage.
+  DelayMap arrival_ps;
+};
+
+ScheduleInfo ComputeScheduleInfo(const PipelineSchedule& sched,
+                                 absl::Span<Node* const> topo_sort,
+                                 const DelayMap& delay_map) {
+  ScheduleInfo info;
+  info.stages.resize(sched.length());
+  // Register widths are accumulated as differences at the stage where a value
+  // becomes live out and the stage of its last use, so this is linear in the
+  // number of nodes no matter how many stages a value crosses.
+  std::vector<int64_t> register_bits_delta(sched.length() + 1, 0);
+  for (Node* node : topo_sort) {
+    int64_t stage = sched.cycle(node);
+    info.stages[stage].nodes.push_back(node);
+    int64_t arrival = 0;
+    for (Node* operand : node->operands()) {
+      if (sched.cycle(operand) == stage) {
+        arrival = std::max(arrival, info.arrival_ps.at(operand));
+      }
+    }
+    info.arrival_ps[node] = arrival + delay_map.at(node);
+    int64_t latest_use = stage;
+    for (Node* user : node->users()) {
+      latest_use = std::max(latest_use, sched.cycle(user));
+    }
+    int64_t bit_count = node->GetType()->GetFlatBitCount();
+    register_bits_delta[stage] += bit_count;
+    register_bits_delta[latest_use] -= bit_count;
+  }
+  int64_t register_bits = 0;
+  for (int64_t stage = 0; stage < sched.length(); ++stage) {
+    register_bits += register_bits_delta[stage];
+    info.stages[stage].register_bits = register_bits;
+  }
+  return info;
+}
+
+std::string NodeDescription(Node* node, const DelayMap& delay_map) {
+  return absl::StrFormat("%s (%s, %s, %dps)", node->GetName(),
+                         OpToString(node->op()), node->GetType()->ToString(),
+                         delay_map.at(node));
+}
+
+// Writes one paragraph per stage with its size, delay and register width and
+// the `top_n` nodes with the latest arrival time within the stage.
+void WriteScheduleSummary(std::ostream& out, const ScheduleInfo& info,
+                          const DelayMap& delay_map,
+                          const absl::flat_hash_set<Node*>& nodes_on_cp,
+                          int64_t top_n) {
+  for (int64_t stage = 0; stage < info.stages.size(); ++stage) {
+    const StageInfo& stage_info = info.stages[stage];
+    std::vector<Node*> critical = stage_info.nodes;
+    auto later_arrival = [&](Node* a, Node* b) {
+      return info.arrival_ps.at(a) > info.arrival_ps.at(b);
+    };
+    int64_t count = std::min<int64_t>(top_n, critical.size());
+    std::partial_sort(critical.begin(), critical.begin() + count,
+                      critical.end(), later_arrival);
+    out << absl::StreamFormat(
+        "Stage %d: %d nodes, %dps, %d pipeline register bits\n", stage,
+        stage_info.nodes.size(),
+        critical.empty() ? 0 : info.arrival_ps.at(critical.front()),
+        stage_info.register_bits);
+    for (int64_t i = 0; i < count; ++i) {
+      out << absl::StreamFormat(
+          "  %6dps  %s%s\n", info.arrival_ps.at(critical[i]),
+          NodeDescription(critical[i], delay_map),
+          nodes_on_cp.contains(critical[i]) ? " [critical path]" : "");
+    }
+  }
+}
+
+// Writes one tab-separated line per node, grouped by stage:
+//
+//   stage  name  op  type  delay_ps  arrival_ps  on_critical_path  operands
+//
+// and an index to `index_out` with one line per stage:
+//
+//   stage  byte_offset  byte_size  node_count  register_bits
+//
+// so a viewer can seek straight to any stage of a huge schedule.
+absl::Status WriteIndexedSchedule(
+    std::ostream& out, std::ostream& index_out, const ScheduleInfo& info,
+    const DelayMap& delay_map, const absl::flat_hash_set<Node*>& nodes_on_cp) {
+  int64_t offset = 0;
+  for (int64_t stage = 0; stage < info.stages.size(); ++stage) {
+    const StageInfo& stage_info = info.stages[stage];
+    int64_t stage_size = 0;
+    for (Node* node : stage_info.nodes) {
+      std::string line = absl::StrFormat(
+          "%d\t%s\t%s\t%s\t%d\t%d\t%d\t%s\n", stage, node->GetName(),
+          OpToString(node->op()), node->GetType()->ToString(),
+          delay_map.at(node), info.arrival_ps.at(node),
+          nodes_on_cp.contains(node) ? 1 : 0,
+          absl::StrJoin(node->operands(), ",",
+                        [](std::string* dst, Node* operand) {
+                          absl::StrAppend(dst, operand->GetName());
+                        }));
+      out << line;
+      stage_size += line.size();
+    }
+    index_out << absl::StreamFormat("%d\t%d\t%d\t%d\t%d\n", stage, offset,
+                                    stage_size, stage_info.nodes.size(),
+                                    stage_info.register_bits);
+    offset += stage_size;
+  }
+  if (!out || !index_out) {
+    return absl::InternalError("Failed to write indexed schedule");
+  }
+  return absl::OkStatus();
 }
 
 absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
@@ -382,10 +510,40 @@ absl::Status RealMain(std::string_view ir_path) {
 
   XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
                        ComputeNodeDelays(main, *delay_estimator));
+  std::vector<Node*> topo_sort = TopoSort(main);
+
+  std::string output_path = absl::GetFlag(FLAGS_output_path);
+  std::ofstream output_file;
+  if (!output_path.empty()) {
+    output_file.open(output_path);
+    if (!output_file) {
+      return absl::NotFoundError(
+          absl::StrFormat("Unable to open %s for writing", output_path));
+    }
+  }
+  std::ostream& out = output_path.empty() ? std::cout : output_file;
 
-  std::cout << DumpScheduleResultToDot(schedule, delay_map, nodes_on_cp);
-
-  return absl::OkStatus();
+  std::string output_format = absl::GetFlag(FLAGS_output_format);
+  if (output_format == "dot") {
+    WriteScheduleDot(out, schedule, topo_sort, delay_map, nodes_on_cp);
+    return absl::OkStatus();
+  }
+  ScheduleInfo info = ComputeScheduleInfo(schedule, topo_sort, delay_map);
+  if (output_format == "summary") {
+    WriteScheduleSummary(out, info, delay_map, nodes_on_cp,
+                         absl::GetFlag(FLAGS_top_n_nodes_per_stage));
+    return absl::OkStatus();
+  }
+  if (output_format == "indexed") {
+    if (output_path.empty()) {
+      return absl::InvalidArgumentError(
+          "--output_format=indexed requires --output_path");
+    }
+    std::ofstream index_file(absl::StrCat(output_path, ".index"));
+    return WriteIndexedSchedule(out, index_file, info, delay_map, nodes_on_cp);
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unknown --output_format: %s", output_format));
 }
 
 }  // namespace